@@ -60,6 +60,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <signal.h>
+#include <sys/uio.h>
 
 #if defined(FD_SET_IN_SYS_SELECT_H)
 #  include <sys/select.h>
@@ -72,13 +73,36 @@ struct routem {
 	enum rwhere	r_where;
 	short		r_nl;
 	short		r_first;
+	short		r_eof;		/* connection closed, flush and drop */
+	int		r_len;		/* bytes held in r_buf */
+	int		r_queued;	/* bytes of r_buf in a pending writev */
+	char		*r_buf;		/* DEMUX_BUFSIZE bytes, while connected */
 };
 fd_set readset;
 char   *cookie = 0;
 
+/*
+ * Each connection keeps at most DEMUX_BUFSIZE bytes.  Complete lines are
+ * written out together with those of the other connections ready in the
+ * same pass, DEMUX_IOV pieces per writev(); a partial line is held until
+ * its end arrives, the buffer fills or the connection closes.
+ */
+#define DEMUX_BUFSIZE	16384
+#define DEMUX_IOV	64
+
+/* pieces waiting to be written to stdout or stderr */
+struct pending {
+	int		p_fd;
+	int		p_n;
+	struct iovec	p_iov[DEMUX_IOV];
+	int		p_sock[DEMUX_IOV];
+};
+struct pending pend_out = {1, 0};
+struct pending pend_err = {2, 0};
+
 /**
  * @brief
- *	read data from socket
+ *	Drop a connection and its buffer.
  *
  * @param[in] sock - socket
  * @param[in] prm  - routem structure pointer
@@ -86,53 +110,179 @@ char   *cookie = 0;
  * @return - Void
  *
  */
+static void
+dropit(int sock, struct routem *prm)
+{
+	(void)close(sock);
+	FD_CLR(sock, &readset);
+	free(prm->r_buf);
+	prm->r_buf = NULL;
+	prm->r_len = 0;
+	prm->r_queued = 0;
+	prm->r_where = invalid;
+}
+
+/**
+ * @brief
+ *	Write out the pieces pending for stdout or stderr with as few
+ *	writev() calls as possible, then move what is left of each
+ *	connection buffer to its front, or drop the connection if it
+ *	was closed.
+ *
+ * @param[in] pp     - pieces pending for one of the output files
+ * @param[in] routem - the routem table
+ *
+ * @return - Void
+ *
+ */
+static void
+flushit(struct pending *pp, struct routem *routem)
+{
+	struct iovec	*iov = pp->p_iov;
+	int		niov = pp->p_n;
+	ssize_t		amt;
+	struct routem	*prm;
+	int		i;
+
+	while (niov > 0) {
+		amt = writev(pp->p_fd, iov, niov);
+		if (amt == -1) {
+			if (errno == EINTR)
+				continue;
+			break;		/* nowhere to put the output */
+		}
+		while ((niov > 0) && ((size_t)amt >= iov->iov_len)) {
+			amt -= iov->iov_len;
+			iov++;
+			niov--;
+		}
+		if (niov > 0) {
+			iov->iov_base = (char *)iov->iov_base + amt;
+			iov->iov_len -= amt;
+		}
+	}
+
+	for (i = 0; i < pp->p_n; i++) {
+		prm = routem + pp->p_sock[i];
+		prm->r_len -= prm->r_queued;
+		if (prm->r_len > 0)
+			memmove(prm->r_buf, prm->r_buf + prm->r_queued,
+				prm->r_len);
+		prm->r_queued = 0;
+		if (prm->r_eof)
+			dropit(pp->p_sock[i], prm);
+	}
+	pp->p_n = 0;
+}
+
+/**
+ * @brief
+ *	Queue the complete lines held for a connection, or all it holds
+ *	when its buffer is full or it was closed, for the next writev()
+ *	to the job's output or error.
+ *
+ * @param[in] sock   - socket
+ * @param[in] routem - the routem table
+ *
+ * @return - Void
+ *
+ */
+static void
+queueit(int sock, struct routem *routem)
+{
+	struct routem	*prm = routem + sock;
+	struct pending	*pp;
+	int		len;
+
+	pp = (prm->r_where == old_out) ? &pend_out : &pend_err;
+	for (len = prm->r_len; len > 0; len--) {
+		if (prm->r_buf[len - 1] == '\n')
+			break;
+	}
+	if ((len == 0) && (prm->r_eof || (prm->r_len == DEMUX_BUFSIZE)))
+		len = prm->r_len;
+	if (len == 0) {
+		if (prm->r_eof)
+			dropit(sock, prm);
+		return;
+	}
+
+#ifdef DEBUG
+	{
+		FILE	*fil = (prm->r_where == old_out) ? stdout : stderr;
+		char	*pc = prm->r_buf;
+		char	*nl;
+
+		while (pc < prm->r_buf + len) {
+			nl = memchr(pc, '\n', prm->r_buf + len - pc);
+			if (nl == NULL)
+				nl = prm->r_buf + len - 1;
+			fprintf(fil, "socket %d: %.*s", sock,
+				(int)(nl - pc + 1), pc);
+			pc = nl + 1;
+		}
+		fflush(fil);
+		prm->r_len -= len;
+		memmove(prm->r_buf, prm->r_buf + len, prm->r_len);
+		if (prm->r_eof)
+			dropit(sock, prm);
+		return;
+	}
+#endif /* DEBUG */
+
+	pp->p_iov[pp->p_n].iov_base = prm->r_buf;
+	pp->p_iov[pp->p_n].iov_len = len;
+	pp->p_sock[pp->p_n] = sock;
+	prm->r_queued = len;
+	if (++pp->p_n == DEMUX_IOV)
+		flushit(pp, routem);
+}
+
+/**
+ * @brief
+ *	read data from socket
+ *
+ * @param[in] sock - socket
+ * @param[in] routem - the routem table
+ *
+ * @return - Void
+ *
+ */
 void
-readit(int sock, struct routem *prm)
+readit(int sock, struct routem *routem)
 {
-	int   amt;
-	char  buf[256];
-	FILE *fil;
-	int   i;
-	char *pc;
-
-	if (prm->r_where == old_out)
-		fil = stdout;
-	else
-		fil = stderr;
-
-	i = 0;
-	if ((amt = read(sock, buf, 256)) > 0) {
+	struct routem	*prm = routem + sock;
+	int		amt;
+	int		i;
+
+	if (prm->r_buf == NULL) {
+		if ((prm->r_buf = malloc(DEMUX_BUFSIZE)) == NULL) {
+			dropit(sock, prm);
+			return;
+		}
+		prm->r_len = 0;
+	}
+
+	amt = read(sock, prm->r_buf + prm->r_len, DEMUX_BUFSIZE - prm->r_len);
+	if (amt > 0) {
 		if (prm->r_first == 1) {
 
 			/* first data on connection must be the cookie to validate it */
 
 			i = strlen(cookie);
-			if (strncmp(buf, cookie, i) != 0) {
-				(void)close(sock);
-				prm->r_where = invalid;
-				FD_CLR(sock, &readset);
-			}
 			prm->r_first = 0;
-		}
-		for (pc = buf+i; pc < buf+amt; ++pc) {
-#ifdef DEBUG
-			if (prm->r_nl) {
-				fprintf(fil, "socket %d: ", sock);
-				prm->r_nl = 0;
-			}
-#endif /* DEBUG */
-			putc(*pc, fil);
-			if (*pc == '\n') {
-				prm->r_nl = 1;
-				fflush(fil);
+			if ((amt < i) || (strncmp(prm->r_buf, cookie, i) != 0)) {
+				dropit(sock, prm);
+				return;
 			}
+			amt -= i;
+			memmove(prm->r_buf, prm->r_buf + i, amt);
 		}
+		prm->r_len += amt;
 	} else {
-		close(sock);
-		prm->r_where = invalid;
-		FD_CLR(sock, &readset);
+		prm->r_eof = 1;
 	}
-	return;
+	queueit(sock, routem);
 }
 
 int
@@ -175,6 +325,10 @@ main(int argc, char *argv[])
 		(routem + i)->r_where = invalid;
 		(routem + i)->r_nl    = 1;
 		(routem + i)->r_first = 0;
+		(routem + i)->r_eof   = 0;
+		(routem + i)->r_len   = 0;
+		(routem + i)->r_queued = 0;
+		(routem + i)->r_buf   = NULL;
 	}
 	(routem + main_sock_out)->r_where = new_out;
 	(routem + main_sock_err)->r_where = new_err;
@@ -228,10 +382,11 @@ main(int argc, char *argv[])
 						(routem + newsock)->r_where =  (routem + i)->r_where == new_out ? old_out : old_err;
 						FD_SET(newsock, &readset);
 						(routem + newsock)->r_first = 1;
+						(routem + newsock)->r_eof = 0;
 						break;
 					case old_out:
 					case old_err:
-						readit(i, routem + i);
+						readit(i, routem);
 						break;
 					default:
 						fprintf(stderr, "%s: internal error\n", argv[0]);
@@ -239,7 +394,20 @@ main(int argc, char *argv[])
 				}
 			}
 		}
+		/* write what this pass brought in */
+		flushit(&pend_out, routem);
+		flushit(&pend_err, routem);
+	}
+
+	/* the parent is gone, write out any partial lines still held */
+	for (i = 0; i < maxfd; ++i) {
+		if ((routem + i)->r_buf == NULL)
+			continue;
+		(routem + i)->r_eof = 1;
+		queueit(i, routem);
 	}
+	flushit(&pend_out, routem);
+	flushit(&pend_err, routem);
 	free(routem);
 	return 0;
 }
@@ -64,6 +64,9 @@ char		*id;
 
 int	fire_phasers = 0;
 int	no_obit = 0;
+int	aggr_exit = 0;		/* -e: exit with the worst task status */
+int	nfailed = 0;		/* tasks not spawned or exited non-zero */
+int	worst_exit = 0;		/* highest task exit status seen */
 extern char *get_ecname(int rc);
 
 /**
@@ -146,10 +149,11 @@ wait_for_task(int first, int *nspawned)
 				if (tm_errno) {
 					fprintf(stderr, "error %d on spawn\n",
 						tm_errno);
-					continue;
+					nfailed++;
+					break;
 				}
 				if (no_obit)
-					continue;
+					break;
 
 				rc = tm_obit(*(tid+c), ev+c, events_obit+c);
 				if (rc == TM_SUCCESS) {
@@ -167,7 +171,7 @@ wait_for_task(int first, int *nspawned)
 				} else if (verbose) {
 					fprintf(stderr, "%s: failed to register for task termination notice, task 0x%08X\n", id, c);
 				}
-
+				break;
 
 			} else if (eventpolled == *(events_obit + c)) {
 				/* obit event, task exited */
@@ -177,6 +181,12 @@ wait_for_task(int first, int *nspawned)
 					printf("%s: task 0x%08X exit status %d\n",
 						id, c, *(ev+c));
 				}
+				if (*(ev+c) != 0) {
+					nfailed++;
+					if (*(ev+c) > worst_exit)
+						worst_exit = *(ev+c);
+				}
+				break;
 			}
 		}
 	}
@@ -214,7 +224,7 @@ main(int argc, char *argv[], char *envp[])
 		return 1;
 	}
 #endif
-	while ((c = getopt(argc, argv, "c:n:svo")) != EOF) {
+	while ((c = getopt(argc, argv, "c:n:svoe")) != EOF) {
 		switch (c) {
 			case 'c':
 				ncopies = atoi(optarg);
@@ -237,15 +247,18 @@ main(int argc, char *argv[], char *envp[])
 			case 'o':
 				no_obit = 1;
 				break;
+			case 'e':
+				aggr_exit = 1;	/* exit with worst task status */
+				break;
 			default:
 				err = 1;
 				break;
 		}
 	}
 	if (err || (onenode >= 0 && ncopies >= 0) || (argc == optind)) {
-		fprintf(stderr, "Usage: %s [-c copies][-s][-v][-o]"
+		fprintf(stderr, "Usage: %s [-c copies][-s][-v][-o][-e]"
 			" -- program [args...]\n", argv[0]);
-		fprintf(stderr, "       %s [-n node_index][-s][-v][-o]"
+		fprintf(stderr, "       %s [-n node_index][-s][-v][-o][-e]"
 			" -- program [args...]\n", argv[0]);
 		fprintf(stderr, "       %s --version\n", argv[0]);
 		fprintf(stderr, "Where -c copies =  run a copy "
@@ -255,7 +268,8 @@ main(int argc, char *argv[], char *envp[])
 
 		fprintf(stderr, "      -s = forces synchronous execution,\n");
 		fprintf(stderr, "      -v = forces verbose output.\n");
-		fprintf(stderr, "      -o = no obits are waited for.\n");
+		fprintf(stderr, "      -o = no obits are waited for,\n");
+		fprintf(stderr, "      -e = exit with the highest task exit status.\n");
 
 		exit(1);
 	}
@@ -370,7 +384,35 @@ main(int argc, char *argv[], char *envp[])
 	sigprocmask(SIG_BLOCK, &allsigs, NULL);
 #endif
 
-	for (c = 0; c < (stop-start); ++c) {
+	if (sync == 0) {
+		tm_node_id	*where;
+
+		/* hand all the spawns to MOM at once */
+		where = (tm_node_id *)calloc(stop-start, sizeof(tm_node_id));
+		if (where == NULL) {
+			fprintf(stderr, "%s: out of memory\n", id);
+			return 1;
+		}
+		for (c = 0; c < (stop-start); ++c)
+			where[c] = *(nodelist + (start + c) % numnodes);
+		rc = tm_spawn_multi(argc-optind, argv+optind, NULL,
+			stop-start, where, tid, events_spawn);
+		for (c = 0; c < (stop-start); ++c) {
+			nd = (start + c) % numnodes;
+			if (*(events_spawn + c) == TM_NULL_EVENT) {
+				fprintf(stderr, "%s: spawn failed on node %d err %s\n",
+					id, nd, get_ecname(rc));
+				nfailed++;
+				continue;
+			}
+			if (verbose)
+				printf("%s: spawned task 0x%08X on logical node %d event %d\n", id, c, nd, *(events_spawn+c));
+			++nspawned;
+		}
+		free(where);
+	}
+
+	for (c = 0; (sync != 0) && (c < (stop-start)); ++c) {
 		nd = (start + c) % numnodes;
 		if ((rc = tm_spawn(argc-optind,
 			argv+optind,
@@ -380,6 +422,7 @@ main(int argc, char *argv[], char *envp[])
 			events_spawn + c)) != TM_SUCCESS) {
 			fprintf(stderr, "%s: spawn failed on node %d err %s\n",
 				id, nd, get_ecname(rc));
+			nfailed++;
 		} else {
 			if (verbose)
 				printf("%s: spawned task 0x%08X on logical node %d event %d\n", id, c, nd, *(events_spawn+c));
@@ -408,5 +451,14 @@ main(int argc, char *argv[], char *envp[])
 	 */
 	tm_finalize();
 
+	if (verbose || (aggr_exit && nfailed))
+		printf("%s: %d of %d tasks failed\n", id, nfailed, stop-start);
+	if (aggr_exit) {
+		if (worst_exit > 255)
+			worst_exit = 255;
+		if (nfailed && worst_exit == 0)
+			worst_exit = 1;
+		return worst_exit;
+	}
 	return 0;
 }
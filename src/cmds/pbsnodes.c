@@ -664,7 +664,7 @@ prt_node(struct batch_status *bstat)
 
 	switch (output_format) {
 		case FORMAT_JSON:
-			if (encode_to_json(bstat)) {
+			if (encode_to_json(bstat) || flush_json(stdout)) {
 				fprintf(stderr, "pbsnodes: out of memory\n");
 				exit(1);
 			}
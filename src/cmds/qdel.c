@@ -55,6 +55,262 @@
 #include <pbs_config.h>   /* the master config generated by configure */
 #include <pbs_version.h>
 
+/* job ids sent to the server in one Delete Jobs request */
+#define QDEL_BATCH 1000
+
+#define MAX_TIME_DELAY_LEN 32
+static char warg[MAX_TIME_DELAY_LEN+1];
+static char warg1[MAX_TIME_DELAY_LEN+7];
+
+static int dfltmail = 0;
+static int dfltmailflg = FALSE;
+static int num_deleted = 0;
+static int any_failed = 0;
+
+/**
+ * @brief
+ *	get the default suppress_email value from the server's
+ *	default_qdel_arguments, unless it was given with -W
+ *
+ * @param[in] connect - connection to the server
+ *
+ * @return int
+ * @retval 0	success
+ * @retval !0	the server could not be queried, pbs_errno is set
+ */
+static int
+get_dflt_mail(int connect)
+{
+	struct attrl *attr;
+	struct batch_status *ss = NULL;
+	char *keystr, *valuestr;
+	char *errmsg;
+
+	if (dfltmailflg == TRUE)
+		return 0;
+
+	ss = pbs_statserver(connect, NULL, NULL);
+	if (ss == NULL && pbs_errno != PBSE_NONE) {
+		if ((errmsg = pbs_geterrmsg(connect)) != NULL)
+			fprintf(stderr, "qdel: %s\n", errmsg);
+		else
+			fprintf(stderr, "qdel: Error %d\n", pbs_errno);
+		return pbs_errno;
+	}
+
+	while (ss != NULL && dfltmailflg != TRUE) {
+		attr = ss->attribs;
+		while (attr != NULL) {
+			if (strcmp(attr->name, ATTR_dfltqdelargs) == 0) {
+				if (attr->value != NULL && dfltmailflg != TRUE) {
+					if (parse_equal_string(attr->value, &keystr, &valuestr)) {
+						if (strcmp(keystr, "-Wsuppress_email") == 0) {
+							dfltmail = atol(valuestr);
+							dfltmailflg = TRUE;
+						}
+						else {
+							fprintf(stderr,
+								"qdel: unsupported %s \'%s\'\n",
+								attr->name, attr->value);
+						}
+					}
+				}
+			}
+			attr = attr->next;
+		}
+		ss = ss->next;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	the number of jobs that may still be deleted with a mail to their
+ *	owner; once none are left the extend string asks for no mail
+ *
+ * @par
+ *	When jobs to be deleted are over 1000, mail function is disabled
+ *	by sending the flag below to server via its extend field:
+ *	  "" -- delete a job with a mail
+ *	  "nomail" -- delete a job without sending a mail
+ *	  "force" -- force job to be deleted with a mail
+ *	  "nomailforce" -- force job to be deleted without sending a mail
+ *	  "nomaildeletehist" -- delete history of a job without sending mail
+ *	  "nomailforcedeletehist" -- force delete history of a job without
+ *	  sending mail.
+ *
+ * @return int
+ * @retval number of jobs, or QDEL_BATCH once mail is off
+ */
+static int
+mails_left(void)
+{
+	static int mailoff = 0;
+	int mails;				/* number of emails we can send */
+
+	if (mailoff)
+		return QDEL_BATCH;
+	mails = dfltmail ? dfltmail : 1000;
+	if (num_deleted >= mails) {
+		strcat(warg1, warg);
+		strcpy(warg, warg1);
+		mailoff = 1;
+		return QDEL_BATCH;
+	}
+	return mails - num_deleted;
+}
+
+/**
+ * @brief
+ *	delete one job, following it to the server it moved to when this
+ *	server does not know it
+ *
+ * @param[in] connect - connection to the server named in the job id
+ * @param[in] job_id_out - the job id
+ * @param[in] server_out - the server named in the job id
+ */
+static void
+del_one(int connect, char *job_id_out, char *server_out)
+{
+	int stat;
+	int located = FALSE;
+	int own = 0;
+	char rmt_server[MAXSERVERNAME];
+
+	for (;;) {
+		(void)mails_left();
+		stat = pbs_deljob(connect, job_id_out, warg);
+
+		/*
+		 * The counter num_deleted should not be updated  when a history job is deleted .
+		 */
+		if (pbs_errno != PBSE_HISTJOBDELETED)
+			num_deleted++;
+		if (stat && (pbs_errno != PBSE_UNKJOBID && pbs_errno != PBSE_HISTJOBDELETED)) {
+			prt_job_err("qdel", connect, job_id_out);
+			any_failed = pbs_errno;
+		} else if (stat && (pbs_errno == PBSE_UNKJOBID) && !located) {
+			located = TRUE;
+			if (locate_job(job_id_out, server_out, rmt_server)) {
+				if (own)
+					pbs_disconnect(connect);
+				connect = cnt2server(rmt_server);
+				if (connect <= 0) {
+					fprintf(stderr, "qdel: cannot connect to server %s (errno=%d)\n",
+						pbs_server, pbs_errno);
+					any_failed = pbs_errno;
+					return;
+				}
+				own = 1;
+				if (get_dflt_mail(connect) != 0) {
+					any_failed = pbs_errno;
+					pbs_disconnect(connect);
+					return;
+				}
+				continue;
+			}
+			prt_job_err("qdel", connect, job_id_out);
+			any_failed = pbs_errno;
+		}
+		break;
+	}
+	if (own)
+		pbs_disconnect(connect);
+}
+
+/**
+ * @brief
+ *	delete jobs of the same server with Delete Jobs requests
+ *
+ * @par
+ *	A job the server reports an error for is sent again on its own, so
+ *	it gets the same error message and the same move to another server
+ *	as when qdel deletes one job at a time.  A server that does not know
+ *	the Delete Jobs request has all the jobs sent that way.
+ *
+ * @param[in] server_out - the server of the jobs
+ * @param[in] ids - NULL terminated list of job ids
+ * @param[in] nids - number of jobs in ids
+ *
+ * @return int
+ * @retval 0	done, errors for single jobs are in any_failed
+ * @retval !0	the server cannot be used, stop deleting jobs
+ */
+static int
+del_batch(char *server_out, char **ids, int nids)
+{
+	int connect;
+	int i;
+	int j;
+	int n;
+	char *save;
+	char *errmsg;
+	job_err_info *pje;
+
+	connect = cnt2server(server_out);
+	if (connect <= 0) {
+		fprintf(stderr, "qdel: cannot connect to server %s (errno=%d)\n",
+			pbs_server, pbs_errno);
+		any_failed = pbs_errno;
+		return 0;
+	}
+
+	/* retrieve default: suppress_email from server: default_qdel_arguments */
+	if (get_dflt_mail(connect) != 0) {
+		any_failed = pbs_errno;
+		pbs_disconnect(connect);
+		return 1;
+	}
+
+	for (i = 0; i < nids; i += n) {
+		n = mails_left();
+		if (n > nids - i)
+			n = nids - i;
+		if (n == 1) {
+			del_one(connect, ids[i], server_out);
+			continue;
+		}
+
+		save = ids[i + n];
+		ids[i + n] = NULL;
+		pje = pbs_deljobs(connect, &ids[i], warg);
+		ids[i + n] = save;
+
+		if (pje == NULL) {
+			if (pbs_errno != PBSE_UNKREQ) {
+				if ((errmsg = pbs_geterrmsg(connect)) != NULL)
+					fprintf(stderr, "qdel: %s\n", errmsg);
+				else
+					fprintf(stderr, "qdel: Error %d\n", pbs_errno);
+				any_failed = pbs_errno;
+				break;
+			}
+			/* an older server rejects the request and drops the */
+			/* connection, delete the jobs one at a time	      */
+			pbs_disconnect(connect);
+			connect = cnt2server(server_out);
+			if (connect <= 0) {
+				fprintf(stderr, "qdel: cannot connect to server %s (errno=%d)\n",
+					pbs_server, pbs_errno);
+				any_failed = pbs_errno;
+				return 0;
+			}
+			for (; i < nids; i++)
+				del_one(connect, ids[i], server_out);
+			break;
+		}
+		for (j = 0; j < n; j++) {
+			if (pje[j].errcode == PBSE_NONE)
+				num_deleted++;
+			else if (pje[j].errcode != PBSE_HISTJOBDELETED)
+				del_one(connect, ids[i + j], server_out);
+		}
+		free(pje);
+	}
+
+	pbs_disconnect(connect);
+	return 0;
+}
 
 int
 main(argc, argv, envp) /* qdel */
@@ -64,7 +320,6 @@ char **envp;
 {
 	int c;
 	int errflg=0;
-	int any_failed=0;
 	char *pc;
 
 	int forcedel = FALSE;
@@ -74,20 +329,12 @@ char **envp;
 
 	char job_id_out[PBS_MAXCLTJOBID];
 	char server_out[MAXSERVERNAME];
-	char rmt_server[MAXSERVERNAME];
+	char batch_server[MAXSERVERNAME];
+	static char ids[QDEL_BATCH][PBS_MAXCLTJOBID];
+	char *idp[QDEL_BATCH + 1];
+	int nids;
 
 	char *keystr, *valuestr;
-	int dfltmail = 0;
-	int dfltmailflg = FALSE;
-	int mails;				/* number of emails we can send */
-	int num_deleted = 0;
-	struct attrl *attr;
-	struct batch_status *ss = NULL;
-	char *errmsg;
-
-#define MAX_TIME_DELAY_LEN 32
-	char warg[MAX_TIME_DELAY_LEN+1];
-	char warg1[MAX_TIME_DELAY_LEN+7];
 
 #define GETOPT_ARGS "W:x"
 
@@ -164,103 +411,34 @@ char **envp;
 		exit(1);
 	}
 
-	for (; optind < argc; optind++) {
-		int connect;
-		int stat=0;
-		int located = FALSE;
-
-		strcpy(job_id, argv[optind]);
-		if (get_server(job_id, job_id_out, server_out)) {
-			fprintf(stderr, "qdel: illegally formed job identifier: %s\n", job_id);
-			any_failed = 1;
-			continue;
-		}
-cnt:
-		connect = cnt2server(server_out);
-		if (connect <= 0) {
-			fprintf(stderr, "qdel: cannot connect to server %s (errno=%d)\n",
-				pbs_server, pbs_errno);
-			any_failed = pbs_errno;
-			continue;
-		}
-
-		/* retrieve default: suppress_email from server: default_qdel_arguments */
-		if (dfltmailflg == FALSE) {
-			ss = pbs_statserver(connect, NULL, NULL);
-			if (ss == NULL && pbs_errno != PBSE_NONE) {
-				any_failed = pbs_errno;
-				if ((errmsg = pbs_geterrmsg(connect)) != NULL)
-					fprintf(stderr, "qdel: %s\n", errmsg);
-				else
-					fprintf(stderr, "qdel: Error %d\n", pbs_errno);
-				break;
-			}
-
-			while (ss != NULL && dfltmailflg != TRUE) {
-				attr = ss->attribs;
-				while (attr != NULL) {
-					if (strcmp(attr->name, ATTR_dfltqdelargs) == 0) {
-						if (attr->value != NULL && dfltmailflg != TRUE) {
-							if (parse_equal_string(attr->value, &keystr, &valuestr)) {
-								if (strcmp(keystr, "-Wsuppress_email") == 0) {
-									dfltmail = atol(valuestr);
-									dfltmailflg = TRUE;
-								}
-								else {
-									fprintf(stderr,
-										"qdel: unsupported %s \'%s\'\n",
-										attr->name, attr->value);
-								}
-							}
-						}
-					}
-					attr = attr->next;
-				}
-				ss = ss->next;
-			}
-		}
-
-		/* when jobs to be deleted over 1000, mail function is disabled
-		 * by sending the flag below to server via its extend field:
-		 *   "" -- delete a job with a mail
-		 *   "nomail" -- delete a job without sending a mail
-		 *   "force" -- force job to be deleted with a mail
-		 *   "nomailforce" -- force job to be deleted without sending a mail
-		 *   "nomaildeletehist" -- delete history of a job without sending mail
-		 *   "nomailforcedeletehist" -- force delete history of a job without sending mail.
-		 */
-		mails = dfltmail ? dfltmail : 1000;
-		if (num_deleted == mails) {
-
-			strcat(warg1, warg);
-			strcpy(warg, warg1);
-
-
-		}
-
-
-		stat = pbs_deljob(connect, job_id_out, warg);
-
-		/*
-		 * The counter num_deleted should not be updated  when a history job is deleted .
-		 */
-		if (pbs_errno != PBSE_HISTJOBDELETED)
-			num_deleted++;
-		if (stat && (pbs_errno != PBSE_UNKJOBID && pbs_errno != PBSE_HISTJOBDELETED)) {
-			prt_job_err("qdel", connect, job_id_out);
-			any_failed = pbs_errno;
-		} else if (stat && (pbs_errno == PBSE_UNKJOBID) && !located) {
-			located = TRUE;
-			if (locate_job(job_id_out, server_out, rmt_server)) {
-				pbs_disconnect(connect);
-				strcpy(server_out, rmt_server);
-				goto cnt;
+	/*
+	 * Send the jobs of the command line in Delete Jobs requests, each
+	 * holding a run of job ids of the same server.
+	 */
+	while (optind < argc) {
+		nids = 0;
+		while ((optind < argc) && (nids < QDEL_BATCH)) {
+			snprintf(job_id, sizeof(job_id), "%s", argv[optind]);
+			if (get_server(job_id, job_id_out, server_out)) {
+				fprintf(stderr, "qdel: illegally formed job identifier: %s\n", job_id);
+				any_failed = 1;
+				optind++;
+				continue;
 			}
-			prt_job_err("qdel", connect, job_id_out);
-			any_failed = pbs_errno;
+			if (nids == 0)
+				strcpy(batch_server, server_out);
+			else if (strcmp(batch_server, server_out) != 0)
+				break;
+			strcpy(ids[nids], job_id_out);
+			idp[nids] = ids[nids];
+			nids++;
+			optind++;
 		}
-
-		pbs_disconnect(connect);
+		if (nids == 0)
+			continue;
+		idp[nids] = NULL;
+		if (del_batch(batch_server, idp, nids) != 0)
+			break;
 	}
 
 	/*cleanup security library initializations before exiting*/
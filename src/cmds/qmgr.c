@@ -43,12 +43,16 @@
  *      of each directive is checked and the appropriate request is sent to the
  *      batch server or servers.
  * @par	Synopsis:
- *      qmgr [-a] [-c command] [-e] [-n] [-z] [server...]
+ *      qmgr [-a] [-b] [-c command] [-e] [-n] [-z] [server...]
  *
  * @par Options:
  *      -a      Abort qmgr on any syntax errors or any requests rejected by a
  *              server.
  *
+ *      -b      Send create, delete, set and unset directives read from
+ *              standard input for named queues, nodes and resources to the
+ *              server in bulk, applied in one server transaction.
+ *
  *      -c command
  *              Execute a single command and exit qmgr.
  *
@@ -138,6 +142,17 @@ char *cur_prompt = prompt;
 
 static char hook_tempfile_errmsg[HOOK_MSG_SIZE] = {'\0'};
 
+/* directives queued by the -b option for one Manager Many request */
+#define QMGR_BATCH_MAX 1000
+static struct manage_op batch_ops[QMGR_BATCH_MAX];
+static int batch_nops = 0;
+static struct attropl *batch_attrs[QMGR_BATCH_MAX];	/* attribute lists to free */
+static int batch_nattrs = 0;
+static struct server *batch_svr = NULL;
+
+static int batch_add(int oper, int type, char *names, struct attropl *attribs);
+static int batch_flush(int aopt);
+
 /*
  * This variable represents the use of the -z option on the command line.
  * It is declared here because it must be used by the pstderr routine to
@@ -1106,10 +1121,11 @@ who()
 int
 main(int argc, char **argv)
 {
-	static char opts[] = "ac:enz"; /* See man getopt */
-	static char usage[] = "Usage: qmgr [-a] [-c command] [-e] [-n] [-z] [server...]\n";
+	static char opts[] = "abc:enz"; /* See man getopt */
+	static char usage[] = "Usage: qmgr [-a] [-b] [-c command] [-e] [-n] [-z] [server...]\n";
 	static char usag2[] = "       qmgr --version\n";
 	int aopt = FALSE;		/* -a option */
+	int bopt = FALSE;		/* -b option */
 	int eopt = FALSE;		/* -e option */
 	int nopt = FALSE;		/* -n option */
 	char *copt = NULL;		/* -c command option */
@@ -1141,6 +1157,9 @@ main(int argc, char **argv)
 			case 'a':
 				aopt = TRUE;
 				break;
+			case 'b':
+				bopt = TRUE;
+				break;
 			case 'c':
 				copt = optarg;
 				break;
@@ -1288,7 +1307,16 @@ main(int argc, char **argv)
 				clean_up_and_exit(1);
 
 			if (! nopt && ! errflg) {
-				errflg = execute(aopt, oper, type, name, attribs);
+				if (bopt && (batch_add(oper, type, name, attribs) == 0)) {
+					attribs = NULL;		/* now owned by the batch */
+					if (batch_nops == QMGR_BATCH_MAX)
+						errflg = batch_flush(aopt);
+				} else {
+					/* keep the directives in order */
+					errflg = batch_flush(aopt);
+					if (! (aopt && errflg))
+						errflg = execute(aopt, oper, type, name, attribs);
+				}
 				if (aopt && errflg)
 					clean_up_and_exit(2);
 			}
@@ -1305,6 +1333,11 @@ main(int argc, char **argv)
 				name = NULL;
 			}
 		}
+		if (batch_nops > 0) {
+			errflg = batch_flush(aopt);
+			if (aopt && errflg)
+				clean_up_and_exit(2);
+		}
 	} else {
 		if (eopt)
 			printf("%s\n", copt);
@@ -1786,6 +1819,10 @@ clean_up_and_exit(int exit_val)
 {
 	struct server *cur_svr, *next_svr;
 
+	/* a "quit" directive still applies the directives queued by -b */
+	if (batch_nops > 0)
+		(void)batch_flush(FALSE);
+
 	free(hook_tempdir);
 	free(hook_tempfile);
 	free_objname_list(active_servers);
@@ -2539,6 +2576,168 @@ handle_formula(struct attropl *attribs)
 	return;
 }
 
+/**
+ * @brief
+ *	batch_add - queue a directive for the next Manager Many request
+ *
+ * @par
+ *	Only create, delete, set and unset of explicitly named queues, nodes
+ *	and resources on the one active server are queued; anything else is
+ *	left for execute() after the queued directives have been flushed.
+ *
+ * @param[in] oper      The command.
+ * @param[in] type      The object type.
+ * @param[in] names     The object name list.
+ * @param[in] attribs   The attribute list, owned by the batch on success.
+ *
+ * @return int
+ * @retval 0 directive queued
+ * @retval -1 directive must be executed singly
+ */
+static int
+batch_add(int oper, int type, char *names, struct attropl *attribs)
+{
+	struct objname *name;
+	struct objname *pname;
+	int count = 0;
+
+	if ((oper != MGR_CMD_CREATE) && (oper != MGR_CMD_DELETE) &&
+		(oper != MGR_CMD_SET) && (oper != MGR_CMD_UNSET))
+		return -1;
+	if ((type != MGR_OBJ_QUEUE) && (type != MGR_OBJ_NODE) &&
+		(type != MGR_OBJ_RSC))
+		return -1;
+	if ((active_servers == NULL) || (active_servers->next != NULL) ||
+		(active_servers->svr == NULL))
+		return -1;
+	if ((batch_nops > 0) && (batch_svr != active_servers->svr))
+		return -1;
+
+	name = commalist2objname(names, type);
+	if (name == NULL)
+		return -1;
+	for (pname = name; pname != NULL; pname = pname->next) {
+		if ((pname->svr_name != NULL) || (pname->obj_name == NULL) ||
+			(pname->obj_name[0] == '\0')) {
+			free_objname_list(name);
+			return -1;
+		}
+		count++;
+	}
+	if (batch_nops + count > QMGR_BATCH_MAX) {
+		free_objname_list(name);
+		return -1;
+	}
+
+	for (pname = name; pname != NULL; pname = pname->next) {
+		if ((batch_ops[batch_nops].objname = strdup(pname->obj_name)) == NULL) {
+			free_objname_list(name);
+			return -1;
+		}
+		batch_ops[batch_nops].command = oper;
+		batch_ops[batch_nops].objtype = type;
+		batch_ops[batch_nops].attribs = attribs;
+		batch_nops++;
+	}
+	batch_attrs[batch_nattrs++] = attribs;
+	batch_svr = active_servers->svr;
+	free_objname_list(name);
+	return 0;
+}
+
+/**
+ * @brief
+ *	batch_flush - send the directives queued by batch_add() in one
+ *	Manager Many request and report the per-directive errors
+ *
+ * @par
+ *	A server without Manager Many support is reconnected to and sent the
+ *	directives one at a time with pbs_manager().
+ *
+ * @param[in] aopt      True, if the -a option was given.
+ *
+ * @return int
+ * @retval 0 every directive succeeded (or nothing was queued)
+ * @retval non-zero error code of a failed directive
+ */
+static int
+batch_flush(int aopt)
+{
+	int i;
+	int rc;
+	int err;
+	int reqerr;
+	int error = 0;
+	char *errmsg;
+	char errnomsg[256];
+	job_err_info *errs;
+	struct server *sp = batch_svr;
+
+	if (batch_nops == 0)
+		return 0;
+
+	errs = pbs_manager_many(sp->s_connect, batch_nops, batch_ops, NULL);
+	reqerr = pbs_errno;
+	if ((errs == NULL) && (reqerr == PBSE_UNKREQ)) {
+		/* an older server rejects the request and drops the connection */
+		pbs_disconnect(sp->s_connect);
+		if ((sp->s_connect = cnt2server(sp->s_name)) <= 0) {
+			PSTDERR1("qmgr: cannot connect to server %s\n", sp->s_name)
+			reqerr = PBSE_PROTOCOL;
+		}
+	}
+
+	for (i = 0; i < batch_nops; i++) {
+		errmsg = NULL;
+		if (errs != NULL) {
+			err = errs[i].errcode;
+		} else if (reqerr == PBSE_UNKREQ) {
+			/* older server */
+			rc = pbs_manager(sp->s_connect, batch_ops[i].command,
+				batch_ops[i].objtype, batch_ops[i].objname,
+				batch_ops[i].attribs, NULL);
+			err = rc ? pbs_errno : 0;
+			errmsg = pbs_geterrmsg(sp->s_connect);
+		} else {
+			err = reqerr;
+		}
+		if (err == 0)
+			continue;
+		if (err == PBSE_PROTOCOL) {
+			pstderr("qmgr: Protocol error, server disconnected\n");
+			exit(1);
+		}
+		error = err;
+
+		/* same rule as execute(), see bug 4941 */
+		if (!isatty(0) && (batch_ops[i].command == MGR_CMD_SET) &&
+			(batch_ops[i].objtype == MGR_OBJ_NODE) && (err == PBSE_ATTRRO))
+			continue;
+		if (errmsg == NULL)
+			errmsg = pbse_to_txt(err);
+		if (errmsg != NULL) {
+			if ((strlen(errmsg) + strlen(batch_ops[i].objname) + strlen(Svrname(sp)) + 20) < 256) {
+				sprintf(errnomsg, "qmgr obj=%s svr=%s: %s\n",
+					batch_ops[i].objname, Svrname(sp), errmsg);
+				pstderr(errnomsg);
+			} else
+				pstderr_big(Svrname(sp), batch_ops[i].objname, errmsg);
+		}
+		PSTDERR1("qmgr: Error (%d) returned from server\n", err)
+		if ((errs == NULL) && (aopt || (reqerr != PBSE_UNKREQ)))
+			break;
+	}
+	free(errs);
+
+	for (i = 0; i < batch_nops; i++)
+		free(batch_ops[i].objname);
+	for (i = 0; i < batch_nattrs; i++)
+		PBS_free_aopl(batch_attrs[i]);
+	batch_nops = 0;
+	batch_nattrs = 0;
+	return error;
+}
+
 /**
  * @brief
  * 	execute - contact the server and execute the command
@@ -1414,6 +1414,9 @@ display_statjob(struct batch_status *status, struct batch_status *prtheader, int
 						return 1;
 				if (add_json_node(JSON_OBJECT_END, JSON_NULL, JSON_NOVALUE, NULL, NULL) == NULL)
 					return 1;
+				/* stream each record out rather than holding the whole listing */
+				if (flush_json(stdout))
+					return 1;
 			}
 		} else {
 			if (p->name != NULL) {
@@ -1662,6 +1665,9 @@ display_statque(struct batch_status *status, int prtheader, int full, int alt_op
 						return 1;
 				if (add_json_node(JSON_OBJECT_END, JSON_NULL, JSON_NOVALUE, NULL, NULL) == NULL)
 					return 1;
+				/* stream each record out rather than holding the whole listing */
+				if (flush_json(stdout))
+					return 1;
 			}
 		} else {
 			if (p->name != NULL) {
@@ -54,7 +54,7 @@ CREATE TABLE pbs.info (
     pbs_schema_version TEXT 		NOT NULL
 );
 
-INSERT INTO pbs.info values('1.4.0'); /* schema version */
+INSERT INTO pbs.info values('1.5.0'); /* schema version */
 
 ---------------------- SERVER ------------------------------
 
@@ -206,9 +206,22 @@ ON pbs.job
  */
 CREATE TABLE pbs.job_scr (
     ji_jobid		TEXT		NOT NULL,
-    script		TEXT
+    script		TEXT,
+    scr_hash		TEXT
 );
 CREATE INDEX job_scr_idx ON pbs.job_scr (ji_jobid);
+CREATE INDEX job_scr_hash_idx ON pbs.job_scr (scr_hash);
+
+/*
+ * Table pbs.job_scr_data holds the text of each distinct job script once,
+ * keyed by its hash, with the number of jobs whose script it is
+ */
+CREATE TABLE pbs.job_scr_data (
+    scr_hash		TEXT		NOT NULL,
+    scr_refs		INTEGER		NOT NULL,
+    script		TEXT,
+    CONSTRAINT job_scr_data_pk PRIMARY KEY (scr_hash)
+);
 
 ---------------------- END OF SCHEMA -----------------------
 
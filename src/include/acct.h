@@ -82,6 +82,10 @@ extern "C" {
 
 extern int  acct_open(char *filename);
 extern void acct_close(void);
+extern void acct_hold(int hold);
+#ifndef WIN32
+extern int  acct_async_start(size_t size, unsigned int flush);
+#endif
 extern void account_record(int acctype, job *pjob, char *text);
 extern void write_account_record(int acctype, char *jobid, char *text);
 
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+#ifndef	_ACCT_BIN_H
+#define	_ACCT_BIN_H
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+/*
+ * Binary accounting records, written by the server alongside the text
+ * accounting log when PBS_SERVER_ACCT_BINARY is set, and read by printacct.
+ *
+ * A file starts with the ACCT_BIN_MAGIC bytes, then holds one record per
+ * accounting record.  All integers are little endian.  A string is a u32
+ * length followed by that many bytes, not null terminated.  A record is:
+ *
+ *	u32	length of the rest of the record
+ *	i64	time recorded
+ *	u8	record type, the character of the text record
+ *	str	record id
+ *	u16	mask of the fixed fields present, bit n for field n
+ *	...	each field present in field order, a str or an i64
+ *	u16	number of other key=value pairs
+ *	...	a str key and a str value for each
+ *
+ * A field whose value is not a whole number is kept as a key=value pair.
+ * Words of the text without an '=' are kept as keys with empty values.
+ */
+
+#define ACCT_BIN_MAGIC		"PBSACCT1"
+#define ACCT_BIN_MAGIC_LEN	8
+
+/* fixed fields, the strings first */
+enum acct_bin_field {
+	ACCT_BIN_USER = 0,
+	ACCT_BIN_GROUP,
+	ACCT_BIN_ACCOUNT,
+	ACCT_BIN_PROJECT,
+	ACCT_BIN_JOBNAME,
+	ACCT_BIN_QUEUE,
+	ACCT_BIN_EXEC_HOST,
+	ACCT_BIN_CTIME,		/* the first i64 field */
+	ACCT_BIN_QTIME,
+	ACCT_BIN_ETIME,
+	ACCT_BIN_START,
+	ACCT_BIN_END,
+	ACCT_BIN_SESSION,
+	ACCT_BIN_EXIT_STATUS,
+	ACCT_BIN_RUN_COUNT,
+	ACCT_BIN_NFIELDS
+};
+
+#define ACCT_BIN_FIRST_INT	ACCT_BIN_CTIME
+
+/* the keys of the fixed fields in the text record, in field order */
+#define ACCT_BIN_FIELD_NAMES { \
+	"user", "group", "account", "project", "jobname", "queue", \
+	"exec_host", "ctime", "qtime", "etime", "start", "end", "session", \
+	"Exit_status", "run_count" }
+
+#ifdef	__cplusplus
+}
+#endif
+#endif	/* _ACCT_BIN_H */
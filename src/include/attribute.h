@@ -147,6 +147,17 @@ struct attr_entity {
 	time_t	 ae_newlimittm;	/* time last limit added */
 };
 
+/*
+ * value of a resource (ATR_TYPE_RESC) attribute: the list of resource
+ * entries, kept in name order, and, once the list is long enough, an
+ * array of the same entries in the same order (see resource.h).
+ * rl_head must stay first so that at_list is the list head.
+ */
+struct resc_list {
+	pbs_list_head	   rl_head;	/* list of resource entries */
+	struct resc_index *rl_idx;	/* entries in list order or NULL */
+};
+
 union attrval {
 	int type_int;
 	long type_long;
@@ -170,6 +181,7 @@ union attr_val {	      /* the attribute value	*/
 	short		      at_short;	/* short int; node's state */
 	float		      at_float;	/* floating point vaule */
 	struct attr_entity    at_enty;	/* FGC entity tree head */
+	struct resc_list      at_resc;	/* resource list and its index */
 };
 
 
@@ -249,6 +261,18 @@ typedef struct ecl_attribute_def ecl_attribute_def;
 #define ATR_VFLAG_INDIRECT	0x10	/* indirect pointer to resource */
 #define ATR_VFLAG_TARGET	0x20	/* target of indirect resource  */
 #define ATR_VFLAG_HOOK		0x40	/* value set by a hook script   */
+#define ATR_VFLAG_MODSTAT	0x80	/* modified, status not yet updated */
+#define ATR_VFLAG_MODSAVE	0x100	/* modified, not yet saved to db */
+
+/*
+ * ATR_VFLAG_MODCACHE is set on every change of a value.  The status cache
+ * and the database save each see the change once: whichever clears
+ * ATR_VFLAG_MODCACHE first hands the change on to the other through
+ * ATR_VFLAG_MODSAVE or ATR_VFLAG_MODSTAT, see clear_mod_status() and
+ * clear_mod_save().
+ */
+#define ATR_MOD_STATUS	(ATR_VFLAG_MODCACHE | ATR_VFLAG_MODSTAT)
+#define ATR_MOD_SAVE	(ATR_VFLAG_MODIFY | ATR_VFLAG_MODCACHE | ATR_VFLAG_MODSAVE)
 
 /* Defines for Parent Object type field in the attribute definition	*/
 /* really only used for telling queue types apart			*/
@@ -308,6 +332,8 @@ void free_attrl(struct attrl *at);
 void free_attrl_list(struct attrl *at_list);
 extern void clear_attr(attribute *pattr, attribute_def *pdef);
 extern int  find_attr  (attribute_def *attrdef, char *name, int limit);
+extern int  index_attr_def(attribute_def *attrdef, int limit);
+extern void move_list_attr(attribute *from, attribute *to);
 extern int  recov_attr_fs(int fd, void *parent, attribute_def *padef,
 	attribute *pattr, int limit, int unknown);
 extern void free_null  (attribute *attr);
@@ -317,6 +343,9 @@ extern svrattrl *attrlist_create(char *aname, char *rname, int szval);
 extern void free_svrattrl(svrattrl *pal);
 extern void free_attrlist(pbs_list_head *attrhead);
 extern void free_svrcache(struct attribute *attr);
+extern int update_resc_svrcache(struct attribute *attr);
+extern void clear_mod_status(struct attribute *attr);
+extern void clear_mod_save(struct attribute *attr);
 extern int  attr_atomic_set(svrattrl *plist, attribute *old,
 	attribute *new, attribute_def *pdef, int limit,
 	int unkn, int privil, int *badattr);
@@ -356,6 +385,7 @@ extern int  decode_ll(attribute *patr, char *name, char *rn, char *val);
 extern int  decode_size   (attribute *patr, char *name, char *rn, char *val);
 extern int  decode_str   (attribute *patr, char *name, char *rn, char *val);
 extern int  decode_jobname   (attribute *patr, char *name, char *rn, char *val);
+extern int  decode_vnode_list(attribute *patr, char *name, char *rn, char *val);
 extern int  decode_time  (attribute *patr, char *name, char *rn, char *val);
 extern int  decode_arst  (attribute *patr, char *name, char *rn, char *val);
 extern int  decode_arst_bs  (attribute *patr, char *name, char *rn, char *val);
@@ -386,6 +416,8 @@ extern int encode_size  (attribute *attr, pbs_list_head *phead, char *atname,
 	char *rsname, int mode, svrattrl **rtnl);
 extern int encode_str  (attribute *attr, pbs_list_head *phead, char *atname,
 	char *rsname, int mode, svrattrl **rtnl);
+extern int encode_vnode_list(attribute *attr, pbs_list_head *phead, char *atname,
+	char *rsname, int mode, svrattrl **rtnl);
 extern int encode_time(attribute *attr, pbs_list_head *phead, char *atname,
 	char *rsname, int mode, svrattrl **rtnl);
 extern int encode_arst(attribute *attr, pbs_list_head *phead, char *atname,
@@ -595,6 +627,7 @@ extern int action_resc_resv(attribute *pattr, void *pobject, int actmode);
 /* Functions used to save and recover the attributes from the database */
 extern int encode_attr_db(struct attribute_def *padef, struct attribute *pattr,
 	int numattr, pbs_db_attr_list_t *attr_list, int all);
+extern void unsave_attr_db(struct attribute *pattr, int numattr);
 extern int decode_attr_db(void *parent, pbs_db_attr_list_t *attr_list,
 	struct attribute_def *padef, struct attribute *pattr, int limit, int unknown);
 
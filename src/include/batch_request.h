@@ -207,6 +207,12 @@ struct rq_signal {
 struct rq_status {
 	char    *rq_id;		/* allow mulitple (job) ids */
 	pbs_list_head rq_attr;
+	/* Status Job: the comparisons taken out of rq_attr, the jobs statused
+	 * must meet them, see stat_filter_build()
+	 */
+	pbs_list_head rq_filtattr;
+	struct select_list *rq_filter;
+	struct pbs_queue *rq_filter_que;
 };
 
 /* Select Job  and selstat */
@@ -295,6 +301,62 @@ struct rq_momrestart {
 	unsigned int	rq_port;
 };
 
+/* Modify Jobs - one entry per job in the request */
+struct rq_modifyjobs_entry {
+	char		rq_jid[PBS_MAXSVRJOBID + 1];
+	pbs_list_head	rq_attr;	/* svrattrl */
+};
+
+struct rq_modifyjobs {
+	int				count;
+	struct rq_modifyjobs_entry	*rq_list;
+};
+
+/* Submit Jobs - one entry per job to queue, with its whole script */
+struct rq_submitjobs_entry {
+	char		rq_destin[PBS_MAXDEST + 1];
+	pbs_list_head	rq_attr;	/* svrattrl */
+	long		rq_size;	/* script size, 0 for none */
+	char		*rq_script;
+};
+
+struct rq_submitjobs {
+	int				count;
+	struct rq_submitjobs_entry	*rq_list;
+};
+
+/* Exec Job - Queue Job, Job Script, Job Credential and Commit in one */
+struct rq_execjob {
+	struct rq_queuejob	rq_job;
+	long			rq_size;	/* script size, 0 for none */
+	char			*rq_script;
+	int			rq_credtype;
+	long			rq_credsize;	/* credential size, 0 for none */
+	char			*rq_cred;
+};
+
+/* Manager Many - one Manager request per directive */
+struct rq_managemany {
+	int			count;
+	struct rq_manage	*rq_list;
+};
+
+/* Delete Jobs - the id of each job to delete */
+struct rq_deletejobs_entry {
+	char		rq_jid[PBS_MAXSVRJOBID + 1];
+};
+
+struct rq_deletejobs {
+	int				count;
+	struct rq_deletejobs_entry	*rq_list;
+};
+
+/* Run Jobs - one Run Job entry per job in the request */
+struct rq_runjobs {
+	int			count;
+	struct rq_runjob	*rq_list;
+};
+
 struct rq_cred {
 	char	  rq_jobid[PBS_MAXSVRJOBID + 1];
 	char	  rq_credid[PBS_MAXUSER + 1]; /* contains id specific for the used security mechanism */
@@ -335,6 +397,7 @@ struct batch_request {
 	int	 isrpp;		/* is this message from rpp stream      */
 	int	 rpp_ack;	/* send acks for this? */
 	char	 *rppcmd_msgid; /* msg id with rpp commands */
+	char	 *rq_statkey;	/* key the status reply is kept under, see stat_cache_save() */
 
 	struct batch_reply  rq_reply;	  /* the reply area for this request */
 
@@ -375,12 +438,19 @@ struct batch_request {
 		struct rq_hookfile	rq_hookfile;
 		struct rq_momrestart	rq_momrestart;
 		struct rq_preempt	rq_preempt;
+		struct rq_modifyjobs	rq_modifyjobs;
+		struct rq_runjobs	rq_runjobs;
+		struct rq_submitjobs	rq_submitjobs;
+		struct rq_managemany	rq_managemany;
+		struct rq_deletejobs	rq_deletejobs;
+		struct rq_execjob	rq_execjob;
 		struct rq_cred	        rq_cred;
 	} rq_ind;
 };
 
 
 extern struct batch_request *alloc_br(int type);
+extern struct batch_request *alloc_job_child_br(struct batch_request *, int, job_err_info *);
 extern void  reply_ack(struct batch_request *);
 extern void  req_reject(int code, int aux, struct batch_request *);
 extern void  req_reject_msg(int code, int aux, struct batch_request *, int istcp);
@@ -423,11 +493,17 @@ extern void  req_stat_sched(struct batch_request *req);
 extern void  req_trackjob(struct batch_request *req);
 extern void  req_stat_rsc(struct batch_request *req);
 extern void  req_preemptjobs(struct batch_request *req);
+extern void  req_modifyjobs(struct batch_request *req);
+extern void  req_runjobs(struct batch_request *req);
+extern void  req_submitjobs(struct batch_request *req);
+extern void  req_managemany(struct batch_request *req);
+extern void  req_deletejobs(struct batch_request *req);
 #else
 extern void  req_cpyfile(struct batch_request *req);
 extern void  req_delfile(struct batch_request *req);
 extern void  req_copy_hookfile(struct batch_request *req);
 extern void  req_del_hookfile(struct batch_request *req);
+extern void  req_execjob(struct batch_request *req);
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 extern void req_cred(struct batch_request *preq);
 #endif
@@ -481,6 +557,12 @@ extern int encode_DIS_Cred(int socket, char *, char *, int type, char *, size_t
 extern int dis_request_read(int socket, struct batch_request *);
 extern int dis_reply_read(int socket, struct batch_reply *, int rpp);
 extern int decode_DIS_PreemptJobs(int socket, struct batch_request *);
+extern int decode_DIS_ModifyJobs(int socket, struct batch_request *);
+extern int decode_DIS_RunJobs(int socket, struct batch_request *);
+extern int decode_DIS_SubmitJobs(int socket, struct batch_request *);
+extern int decode_DIS_ManageMany(int socket, struct batch_request *);
+extern int decode_DIS_DeleteJobs(int socket, struct batch_request *);
+extern int decode_DIS_ExecJob(int socket, struct batch_request *);
 
 #ifdef	__cplusplus
 }
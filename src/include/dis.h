@@ -71,6 +71,10 @@ extern "C" {
 #define DIS_NOCOMMIT	10	/* Protocol failure in commit */
 #define DIS_EOF		11	/* End of File */
 
+/* wire formats of a stream, see DIS_tcp_set_fmt() */
+#define DIS_FMT_ASCII	0	/* Data-is-Strings */
+#define DIS_FMT_BINARY	1	/* tagged little-endian integers */
+
 
 unsigned long disrul(int stream, int *retval);
 
@@ -206,8 +210,14 @@ extern void     DIS_tcparray_init(void);
 extern void DIS_tcp_funcs(void);
 extern void DIS_tcp_reset(int fd, int rw);
 extern void DIS_tcp_setup(int fd);
+extern void DIS_tcp_reserve(int nfds);
 extern int  DIS_tcp_wflush(int fd);
 extern void DIS_tcp_release(int fd);
+extern void DIS_tcp_set_fmt(int fd, int fmt);
+extern int  DIS_tcp_set_pipelined(int fd);
+extern size_t DIS_tcp_pending(int fd);
+extern int  DIS_tcp_whold(int fd, int hold);
+extern size_t DIS_tcp_wcommitted(int fd, char **data);
 
 extern void tcp_set_extra(int fd, void *extra);
 extern void *tcp_get_extra(int fd);
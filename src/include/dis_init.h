@@ -36,13 +36,35 @@
  *
  */
 
+#ifndef _DIS_INIT_H
+#define _DIS_INIT_H
 
-extern int (*dis_getc)(int stream);
-extern int (*dis_puts)(int stream, const char *string, size_t count);
-extern int (*dis_gets)(int stream, char *string, size_t count);
-extern int (*disr_skip)(int stream, size_t nskips);
-extern int (*disw_commit)(int stream, int commit);
-extern int (*disr_commit)(int stream, int commit);
+#include <stddef.h>
+
+/*
+ * The transport routines DIS reads and writes through.  They live in the
+ * thread context (see pbs_client_thread.h), like dis_buffer, so a thread
+ * decoding a request off a TCP socket is not switched over to TPP by
+ * another thread of the same process.
+ */
+struct dis_funcs {
+	int (*df_getc)(int stream);
+	int (*df_puts)(int stream, const char *string, size_t count);
+	int (*df_gets)(int stream, char *string, size_t count);
+	int (*df_rskip)(int stream, size_t nskips);
+	int (*df_wcommit)(int stream, int commit);
+	int (*df_rcommit)(int stream, int commit);
+	int (*df_getfmt)(int stream);	/* wire format, NULL if always DIS_FMT_ASCII */
+};
+
+extern struct dis_funcs *__dis_funcs_location(void);
+#define dis_getc	(__dis_funcs_location()->df_getc)
+#define dis_puts	(__dis_funcs_location()->df_puts)
+#define dis_gets	(__dis_funcs_location()->df_gets)
+#define disr_skip	(__dis_funcs_location()->df_rskip)
+#define disw_commit	(__dis_funcs_location()->df_wcommit)
+#define disr_commit	(__dis_funcs_location()->df_rcommit)
+#define dis_getfmt	(__dis_funcs_location()->df_getfmt)
 
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 extern int (*transport_getc)(int stream);
@@ -53,3 +75,4 @@ extern int (*transport_rcommit)(int stream, int commit);
 extern int (*transport_wcommit)(int stream, int commit);
 extern int (*transport_read)(int fd);
 #endif
+#endif	/* _DIS_INIT_H */
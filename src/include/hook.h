@@ -108,6 +108,23 @@ typedef enum hook_user hook_user;
 #define MOM_EVENTS	(HOOK_EVENT_EXECJOB_BEGIN|HOOK_EVENT_EXECJOB_PROLOGUE|HOOK_EVENT_EXECJOB_EPILOGUE|HOOK_EVENT_EXECJOB_END|HOOK_EVENT_EXECJOB_PRETERM|HOOK_EVENT_EXECHOST_PERIODIC|HOOK_EVENT_EXECJOB_LAUNCH|HOOK_EVENT_EXECHOST_STARTUP|HOOK_EVENT_EXECJOB_ATTACH|HOOK_EVENT_EXECJOB_RESIZE|HOOK_EVENT_EXECJOB_ABORT|HOOK_EVENT_EXECJOB_POSTSUSPEND|HOOK_EVENT_EXECJOB_PRERESUME)
 #define USER_MOM_EVENTS	(HOOK_EVENT_EXECJOB_PROLOGUE|HOOK_EVENT_EXECJOB_EPILOGUE|HOOK_EVENT_EXECJOB_PRETERM)
 #define FAIL_ACTION_EVENTS (HOOK_EVENT_EXECJOB_BEGIN|HOOK_EVENT_EXECHOST_STARTUP|HOOK_EVENT_EXECJOB_PROLOGUE)
+
+/* number of event bits above, one hook_stats slot per event */
+#define HOOK_STATS_EVENTS	21
+
+/*
+ * Execution statistics for a hook run under a single event, accumulated
+ * by hook_stats_add() since the daemon started.
+ */
+struct hook_stats {
+	unsigned long	runs;		/* # of times the hook script ran */
+	unsigned long	accepts;	/* # of runs that accepted the event */
+	unsigned long	rejects;	/* # of runs that rejected the event */
+	long long	wall_usec;	/* total wall time of the runs */
+	long long	cpu_usec;	/* total cpu time of the runs */
+	long long	python_usec;	/* part of wall_usec spent in the script */
+};
+
 struct hook {
 	char 		*hook_name;	/* unique name of the hook */
 	hook_type	type;		/* site-defined or pbs builtin */
@@ -152,6 +169,7 @@ struct hook {
 	pbs_list_link	hi_execjob_postsuspend_hooks;
 	pbs_list_link	hi_execjob_preresume_hooks;
 	struct work_task *ptask;		    /* work task pointer, used in periodic hooks */
+	struct hook_stats stats[HOOK_STATS_EVENTS]; /* indexed by event bit */
 };
 
 typedef struct hook hook;
@@ -159,6 +177,7 @@ typedef struct hook hook;
 /* Hook-related files and directories */
 #define	HOOK_FILE_SUFFIX	".HK"	/* hook control file */
 #define	HOOK_SCRIPT_SUFFIX	".PY"	/* hook script file */
+#define	HOOK_BYTECODE_SUFFIX	".PYC"	/* compiled hook script, pbs_python */
 #define	HOOK_REJECT_SUFFIX	".RJ"	/* hook error reject message */
 #define HOOK_TRACKING_SUFFIX	".TR"	/* hook pending action tracking file */
 #define HOOK_BAD_SUFFIX		".BD"	/* a bad (moved out of the way) hook file */
@@ -203,6 +222,7 @@ typedef struct hook hook;
 #define	HOOKATT_FREQ		"freq"
 #define	HOOKATT_FAIL_ACTION	"fail_action"
 #define	HOOKATT_PENDING_DELETE  "pending_delete"
+#define	HOOKATT_STATS		"stats"	/* read-only, only when asked for */
 
 #define	HOOK_PBS_PREFIX		"PBS"  /* valid Hook name prefix for PBS hook */
 
@@ -376,6 +396,8 @@ extern char *hook_freq_as_string(int);
 extern char *hook_order_as_string(short);
 extern char *hook_user_as_string(hook_user);
 extern char *hook_fail_action_as_string(unsigned int);
+extern char *hook_stats_as_string(hook *);
+extern void hook_stats_add(hook *, unsigned int, int, long long, long long, long long);
 
 #ifdef	_WORK_TASK_H
 extern void cleanup_hooks_workdir(struct work_task *);
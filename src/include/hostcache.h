@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+#ifndef _HOSTCACHE_H
+#define _HOSTCACHE_H
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A process-wide cache of host name lookups.  hostcache_addrs() maps a
+ * name to its native IPv4 addresses and hostcache_name() maps an IPv4
+ * address back to a name, each as getaddrinfo() and getnameinfo() would.
+ *
+ * Answers are kept for PBS_HOST_CACHE_TTL seconds, failures for a tenth
+ * of that; with the parameter unset or zero, every call goes to the
+ * resolver.  hostcache_flush() may be called from a signal handler, the
+ * cache is emptied at the next lookup.
+ */
+
+extern int hostcache_addrs(char *, struct in_addr **, int *);
+extern int hostcache_name(struct in_addr, char *, size_t, int);
+extern void hostcache_flush(void);
+
+#ifdef  __cplusplus
+}
+#endif
+#endif	/* _HOSTCACHE_H */
@@ -123,6 +123,28 @@ extern int __pbs_terminate(int, int, char *);
 
 extern preempt_job_info *__pbs_preempt_jobs(int, char **);
 
+extern job_err_info *__pbs_alterjobs(int, struct batch_status *);
+
+extern job_err_info *__pbs_asyrunjobs(int, char **, char **);
+
+extern job_err_info *__pbs_submit_many(int, int, struct attropl **, char **, char **, char *);
+
+extern job_err_info *__pbs_manager_many(int, int, struct manage_op *, char *);
+
+extern job_err_info *__pbs_deljobs(int, char **, char *);
+
+extern int __pbs_alterjob_async(int, char *, struct attrl *, char *);
+
+extern int __pbs_runjob_async(int, char *, char *, char *);
+
+extern int __pbs_deljob_async(int, char *, char *);
+
+extern int __pbs_statjob_async(int, char *, struct attrl *, char *);
+
+extern int __pbs_async_wait(int, int *, struct batch_status **);
+
+extern int __pbs_async_pending(int);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -373,6 +373,12 @@ typedef	struct	hnodent {
 	pbs_list_head	hn_events;	/* pointer to list of events */
 } hnodent;
 
+/* entry of the table mapping a sister's stream to its index in ji_hosts */
+struct stream_hint {
+	int		sh_stream;	/* stream, -1 for an empty slot */
+	int		sh_node;	/* index in ji_hosts */
+};
+
 typedef struct vmpiprocs {
 	tm_node_id	vn_node;	/* user's vnode identifier */
 	hnodent	       *vn_host;	/* parent (host) nodeent entry */
@@ -424,6 +430,7 @@ typedef struct	noderes {
 #define	MOM_SISTER_ERR		0x0004	/* a sisterhood operation failed */
 #define	MOM_NO_PROC		0x0008	/* no procs found for job */
 #define	MOM_RESTART_ACTIVE	0x0010	/* restart in progress */
+#define	MOM_POLL_SAMPLED	0x0020	/* usage sampled, check limits */
 
 
 #define PBS_MAX_POLL_DOWNTIME 300 /* 5 minutes by default */
@@ -441,6 +448,8 @@ struct ajtrk {
 	int trk_exitstat;  /* if executed and exitstat set */
 	int trk_substate; /* sub state    */
 	int trk_stgout; /* stageout status  */
+	int trk_runcount; /* run count of a finished subjob kept in the table */
+	char *trk_exechost; /* exec_host of a finished subjob kept in the table */
 	struct job *trk_psubjob; /* pointer to instantiated subjob */
 };
 
@@ -455,8 +464,19 @@ struct ajtrkhd {
 	struct ajtrk tkm_tbl[1]; /* ptr to array of individual entries     */
 	/* when table is malloced, room for the additional required number */
 	/* of tkm_tbl entries (ct-1) will be included			   */
+	/* followed by one bitmap per job state, see TKM_STATE_MAP()	   */
 };
 
+/*
+ * Each job state has a bitmap of the table entries in that state, kept in
+ * the same allocation after the last tkm_tbl entry.  A subjob state change
+ * flips two bits and cvt_range() skips whole words of unwanted entries.
+ */
+#define TKM_WORDBITS		(sizeof(unsigned long) * 8)
+#define TKM_NWORDS(ct)		(((ct) + TKM_WORDBITS - 1) / TKM_WORDBITS)
+#define TKM_STATE_MAP(t, s)	((unsigned long *)&(t)->tkm_tbl[(t)->tkm_ct] + \
+					(s) * TKM_NWORDS((t)->tkm_ct))
+
 /*
  * Discard Job Structure,  see Server's discard_job function
  *	Used to record which Mom has responded to when we need to tell them
@@ -476,6 +496,7 @@ struct jbdscrd {
 #define TKMFLG_NO_DELETE           0x01
 #define TKMFLG_REVAL_IND_REMAINING 0x02 /* Flag to re-evaluate "array_indices_remaining" */
 #define TKMFLG_CHK_ARRAY           0x04 /* chk_array_doneness() already in call stack*/
+#define TKMFLG_REVAL_STATE_CT      0x08 /* Flag to re-evaluate "array_state_count" */
 
 /*
  * THE JOB
@@ -498,6 +519,20 @@ struct jbdscrd {
  */
 
 
+/*
+ * The stages of a run of a job the server records the time of, see
+ * job_stage_mark().  In the order they are normally reached.
+ */
+enum job_stage {
+	JOB_STAGE_QUEUED,	/* committed into a queue */
+	JOB_STAGE_RUNREQ,	/* run request accepted */
+	JOB_STAGE_SENT,		/* sending to Mother Superior */
+	JOB_STAGE_STARTED,	/* accepted by Mother Superior */
+	JOB_STAGE_RUNNING,	/* session id received from Mother Superior */
+	JOB_STAGE_OBIT,		/* obit received */
+	JOB_STAGE_NUM
+};
+
 #define	JSVERSION_18	800	/* 18 denotes the PBSPro version and it covers the job structure from >= 13.x to <= 18.x */
 #define	JSVERSION	1900	/* 1900 denotes the 19.x.x version */
 #define	ji_taskid	ji_extended.ji_ext.ji_taskidx
@@ -521,6 +556,15 @@ struct job {
 	struct batch_request *ji_rerun_preq;	/* outstanding rerun request */
 #ifndef PBS_MOM
 	struct batch_request *ji_pmt_preq;		/* outstanding preempt job request for deleting jobs */
+	long long	ji_mod_seq;	/* sequence of the last change, see update_mod_seq() */
+	pbs_list_link	ji_statejobs;	/* links to jobs in same state in server */
+	pbs_list_link	ji_questatejobs; /* links to jobs in same state in queue */
+	pbs_list_link	ji_ownerjobs;	/* links to jobs of same owner in server */
+	pbs_list_link	ji_savejobs;	/* links to jobs with a deferred save, see job_save_db() */
+	pbs_list_link	ji_histjobs;	/* links to history jobs by age, see svr_histjob_link() */
+	pbs_list_link	ji_actjobs;	/* links to jobs not history in server, by rank */
+	pbs_list_link	ji_queactjobs;	/* links to jobs not history in queue, by rank */
+	int		ji_savetype;	/* SAVEJOB_ type of the deferred save */
 #endif /* PBS_MOM */
 	int ji_licneed;			/* # of cpu licenses needed by job */
 	int		ji_licalloc;	/* actual # of cpu licenses allocated */
@@ -532,6 +576,8 @@ struct job {
 	time_t		ji_chkptnext;	/* next checkpoint time */
 	time_t		ji_sampletim;	/* last usage sample time, irix only */
 	time_t		ji_polltime;	/* last poll from mom superior */
+	time_t		ji_nextpoll;	/* when usage is next sampled */
+	int		ji_pollint;	/* current usage sample interval */
 	time_t		ji_actalarm;	/* time of site callout alarm */
 	time_t		ji_joinalarm;	/* time of job's sister join job alarm */
 	/* also, time obit sent, all */
@@ -560,6 +606,15 @@ struct job {
 	int		ji_num_assn_vnodes;	/* number of virtual nodes (full count) */
 	tm_event_t	ji_obit;	/* event for end-of-job */
 	hnodent	       *ji_hosts;	/* ptr to job host management stuff */
+	int		ji_evscan;	/* hosts before this have no events */
+	struct stream_hint *ji_strmhint; /* stream to ji_hosts index table */
+	int		ji_strmhintsz;	/* slots in ji_strmhint */
+	u_long		ji_rusedhash;	/* hash of hook resources_used last sent to MS */
+	int		ji_rusedskip;	/* polls skipped since last sent */
+#ifdef NAS /* localmod 015 */
+	u_long		ji_spoolkb;	/* spool usage when last measured, KB */
+	int		ji_spoolmeasured; /* ji_spoolkb still current */
+#endif /* localmod 015 */
 	vmpiprocs      *ji_vnods;	/* ptr to job vnode management stuff */
 	noderes	       *ji_resources;	/* ptr to array of node resources */
 	vmpiprocs      *ji_assn_vnodes;	/* ptr to actual assigned vnodes (for hooks) */
@@ -604,6 +659,7 @@ struct job {
 	int		ji_jdcd_waiting;/* set if waiting on a mom for a response to discard job request */
 	char	       *ji_acctrec;	/* holder for accounting info */
 	char	       *ji_clterrmsg;	/* error message to return to client */
+	struct parsed_execvnode *ji_parsed_ev; /* see update_job_node_rassn() */
 
 	/*
 	 *	The flag ji_newjob is used to ensure that calls to svr_setjobstate
@@ -635,6 +691,9 @@ struct job {
 	struct preempt_ordering	*preempt_order;
 	int			preempt_order_index;
 
+	/* msec of the epoch each job_stage was reached, 0 if not */
+	long long		ji_stagems[JOB_STAGE_NUM];
+
 #endif					/* END SERVER ONLY */
 
 	/*
@@ -745,6 +804,7 @@ typedef struct	pbs_task {
 	int		ti_tmmax;	/* size of ti_tmfd */
 	int		ti_protover;	/* protocol version number */
 	int		ti_flags;	/* task internal flags */
+	int		ti_pidfd;	/* pidfd watching ti_sid, or -1 */
 
 #ifdef WIN32
 	HANDLE		ti_hProc;	/* keep proc handle */
@@ -774,6 +834,7 @@ typedef struct	pbs_task {
 			} ti_ext;
 		} ti_u;
 	} ti_qs;
+	struct taskfix	ti_saved;	/* ti_qs as last written to disk */
 } pbs_task;
 
 /*
@@ -833,6 +894,7 @@ typedef struct	infoent {
 #define	TI_FLAGS_CHKPT		2	/* task has checkpointed */
 #define	TI_FLAGS_ORPHAN		4	/* MOM not parent of task */
 #define	TI_FLAGS_SAVECKP	8	/* save value of CHKPT flag during checkpoint op */
+#define	TI_FLAGS_SAVED		16	/* ti_saved matches the task file */
 
 #define TI_STATE_EMBRYO		0
 #define	TI_STATE_RUNNING	1
@@ -1123,6 +1185,8 @@ extern int   svr_enquejob(job *);
 extern void  svr_evaljobstate(job *, int *, int *, int);
 extern void  set_statechar(job *);
 extern int   svr_setjobstate(job *, int, int);
+extern void  job_stage_mark(job *, enum job_stage);
+extern void  job_stage_log(job *);
 extern int   state_char2int(char);
 extern int   uniq_nameANDfile(char*, char*, char*);
 extern long  determine_accruetype(job *);
@@ -1161,6 +1225,8 @@ extern job  *job_recov_db(char *);
 extern void *job_or_resv_recov_db(char *, int);
 extern int  job_save_db(job *, int);
 extern int   job_or_resv_save_db(void *, int, int);
+extern void  job_save_db_flush(int);
+extern time_t job_save_db_wait(time_t);
 #define job_recov job_recov_db
 #define job_save job_save_db
 #define job_or_resv_save job_or_resv_save_db
@@ -136,6 +136,8 @@ extern int * __pbs_tcperrno_location(void);
 extern char pbs_current_group[];
 
 #define NCONNECTS 50
+struct pbs_async_queue;	/* requests sent by pbs_*_async(), see pbsD_async.c */
+
 struct connect_handle {
 	int		ch_inuse;  /* 1 if in use, 0 otherwis */
 	int		ch_socket; /* file descriptor for the open socket */
@@ -143,6 +145,14 @@ struct connect_handle {
 	int		ch_errno;  /* last error on this connection */
 	char		*ch_errtxt;/* pointer to last server error text	*/
 	pthread_mutex_t ch_mutex;  /* serialize connection between threads */
+	int		ch_idle;   /* 1 if disconnected but kept open for reuse */
+	time_t		ch_idle_since; /* when the connection was last parked */
+	pid_t		ch_pid;    /* process that opened the connection */
+	unsigned int	ch_port;   /* server port, for matching on reuse */
+	char		ch_server[PBS_MAXSERVERNAME + 1]; /* "" if not reusable */
+	char		ch_user[PBS_MAXUSER + 1]; /* user the server authenticated */
+	int		ch_pipelined; /* server answers requests sent ahead in order */
+	struct pbs_async_queue *ch_async; /* outstanding asynchronous requests */
 };
 extern struct connect_handle connection[];
 #define PBS_MAX_CONNECTIONS        5000  /* Max connections in the connections array */
@@ -189,6 +199,11 @@ struct rq_preempt {
 
 typedef struct rq_preempt brp_preempt_jobs;
 
+typedef struct brp_job_errs {	/* per job reply to a multi-job request */
+	int			count;
+	job_err_info		*pje_list;
+} brp_job_errs;
+
 /*
  * the following is the basic Batch Reply structure
  */
@@ -203,6 +218,7 @@ typedef struct rq_preempt brp_preempt_jobs;
 #define BATCH_REPLY_CHOICE_Locate	8	/* locate, see brp_locate */
 #define BATCH_REPLY_CHOICE_RescQuery	9	/* Resource Query         */
 #define BATCH_REPLY_CHOICE_PreemptJobs	10	/* Preempt Job            */
+#define BATCH_REPLY_CHOICE_JobErrs	11	/* per job error codes    */
 
 struct batch_reply {
 	int	brp_code;
@@ -220,6 +236,7 @@ struct batch_reply {
 		char	  brp_locate[PBS_MAXDEST+1];
 		struct brp_rescq brp_rescq;	/* query resource reply */
 		brp_preempt_jobs brp_preempt_jobs;	/* preempt jobs reply */
+		brp_job_errs brp_job_errs;	/* multi-job reply */
 	} brp_un;
 };
 
@@ -297,6 +314,12 @@ struct batch_reply {
 #define PBS_BATCH_ResvOccurEnd	92
 #define PBS_BATCH_PreemptJobs	93
 #define PBS_BATCH_Cred          94
+#define PBS_BATCH_ModifyJobs	95
+#define PBS_BATCH_AsyrunJobs	96
+#define PBS_BATCH_SubmitJobs	97
+#define PBS_BATCH_ManagerMany	98
+#define PBS_BATCH_ExecJob	99
+#define PBS_BATCH_DeleteJobs	100
 
 #define PBS_BATCH_FileOpt_Default	0
 #define PBS_BATCH_FileOpt_OFlg		1
@@ -326,6 +349,9 @@ extern void PBS_free_aopl(struct attropl * aoplp);
 extern void advise(char *, ...);
 extern int PBSD_rdytocmt(int connect, char *jobid, int rpp, char **msgid);
 extern int PBSD_commit(int connect, char *jobid, int rpp, char **msgid);
+extern int PBSD_execjob(int stream, char *jobid, char *destin,
+	struct attropl *attrib, char *script, int credtype, char *cred,
+	int credlen, char **msgid);
 extern int PBSD_jcred(int connect, int type, char *buf, int len, int rpp, char **msgid);
 extern int PBSD_user_migrate(int connect, char *tohost);
 extern int PBSD_jscript(int connect, char *script_file, int rpp, char **msgid);
@@ -353,9 +379,13 @@ extern struct batch_reply *PBSD_rdrpy(int connect);
 extern struct batch_reply *PBSD_rdrpy_sock(int sock, int *rc);
 struct batch_reply *PBSD_rdrpyRPP(int stream);
 extern void PBSD_FreeReply(struct batch_reply *);
+extern job_err_info *PBSD_rdrpy_job_errs(int connect);
+extern int PBSD_async_drain(int connect);
+extern void PBSD_async_free(int connect);
 extern struct batch_status *PBSD_status(int c, int function,
 	char *objid, struct attrl *attrib, char *extend);
 extern preempt_job_info *PBSD_preempt_jobs(int c, char **preempt_jobs_list);
+extern job_err_info *PBSD_modify_jobs(int c, struct batch_status *jobs);
 
 extern struct batch_status *PBSD_status_get(int c);
 extern char * PBSD_queuejob(int c, char *j, char *d,
@@ -372,6 +402,8 @@ extern int encode_DIS_JobFile(int socket, int, char *, int, char *, int);
 extern int encode_DIS_JobId(int socket, char *);
 extern int encode_DIS_Manage(int socket, int cmd, int objt,
 	char *, struct attropl *);
+extern int encode_DIS_ManageMany(int socket, int count, struct manage_op *ops);
+extern int encode_DIS_DeleteJobs(int socket, char **jobids);
 extern int encode_DIS_MessageJob(int socket, char *jid, int fopt, char *m);
 extern int encode_DIS_MoveJob(int socket, char *jid, char *dest);
 extern int encode_DIS_ModifyResv(int socket, char *resv_id, struct attropl *aoplp);
@@ -394,6 +426,13 @@ extern int encode_DIS_attropl(int socket, struct attropl *);
 extern int encode_DIS_CopyHookFile(int, int, char *, int, char *);
 extern int encode_DIS_DelHookFile(int, char *);
 extern int encode_DIS_PreemptJobs(int socket, char **preempt_jobs_list);
+extern int encode_DIS_ModifyJobs(int socket, struct batch_status *jobs);
+extern int encode_DIS_RunJobs(int socket, char **jobids, char **locations);
+extern int encode_DIS_SubmitJobs(int socket, int count, struct attropl **attribs,
+	char **scripts, size_t *script_lens, char **destinations);
+extern int encode_DIS_ExecJob(int socket, char *jid, char *dest,
+	struct attropl *aoplp, char *script, size_t script_len, int credtype,
+	char *cred, size_t cred_len);
 
 extern char *PBSD_submit_resv(int connect, char *resv_id,
 	struct attropl *attrib, char *extend);
@@ -62,6 +62,28 @@ int in_string_list(char *str, char sep, char *string_list);
 
 int copy_file_internal(char *src, char *dst);
 
+/*
+ * pbs_freelist - freed objects of one fixed size type kept for reuse, so
+ * the hot daemon structures are not handed back and forth to malloc.
+ * Not thread safe, a list must only be used by one thread.
+ */
+typedef struct pbs_freelist {
+	char	*fl_name;		/* type name for the statistics */
+	size_t	fl_size;		/* size of an object */
+	int	fl_max;			/* most free objects kept */
+	int	fl_nfree;		/* free objects kept now */
+	void	*fl_free;		/* the free objects, linked through their first word */
+	long	fl_malloc;		/* objects taken from malloc */
+	long	fl_reuse;		/* objects taken from fl_free */
+	struct pbs_freelist *fl_next;	/* next list in freelist_all */
+	int	fl_listed;		/* on freelist_all */
+} pbs_freelist;
+#define PBS_FREELIST_INIT(name, type, max) \
+	{name, sizeof(type), max, 0, NULL, 0, 0, NULL, 0}
+extern pbs_freelist *freelist_all;	/* every list allocated from */
+void *freelist_alloc(pbs_freelist *fl);
+void freelist_free(pbs_freelist *fl, void *obj);
+
 int is_full_path(char *path);
 int file_exists(char *path);
 int is_same_host(char *, char *);
@@ -121,6 +143,18 @@ int get_execvnodes_count(char *);
 /* Free the memory allocated to an unrolled string */
 void free_execvnode_seq(char **ptr);
 
+/*
+ * Leads a host or vnode list condensed into numeric ranges, for example
+ * "%(n[0001-4000]:ncpus=64)" for "(n0001:ncpus=64)+...+(n4000:ncpus=64)"
+ */
+#define VNODE_LIST_CONDENSED	'%'
+
+/* Condense the runs of a '+' separated host or vnode list into ranges */
+char *condense_vnode_list(char *);
+
+/* Expand a list condensed by condense_vnode_list() */
+char *expand_vnode_list(char *);
+
 
 /* pbs_ical specific */
 
@@ -137,6 +171,9 @@ int get_num_occurrences(char *rrule, time_t dtstart, char *tz);
  */
 time_t get_occurrence(char *, time_t, char *, int);
 
+/* Fill an array with the first occurrences of a recurrence rule in one pass */
+int get_occurrences(char *, time_t, char *, int, time_t *);
+
 /*
  * Check if a recurrence rule is valid and consistent.
  * The recurrence rule is verified against a start date and checks
@@ -242,6 +279,8 @@ lock_file(FILE *fp, int op, char *filename, int lock_retry,
 /* RSHD/RCP related */
 /* Size of the buffer used in communication with rshd deamon */
 #define RCP_BUFFER_SIZE 65536
+/* Size of the buffer used by pbs_rcp to move file data */
+#define RCP_XFER_SIZE (1024 * 1024)
 
 
 #define MAXBUFLEN 1024
@@ -76,6 +76,18 @@ extern void	*lim_dup_liminfo(void *);
  */
 extern void	lim_free_liminfo(void *);
 
+/**	@fn unsigned long long lim_fingerprint(void *p, unsigned long long h)
+ *	@brief	hash limit information allocated by lim_alloc_liminfo()
+ *
+ *	@param	p	the limit storage to hash
+ *	@param	h	the fingerprint so far
+ *
+ *	@return		the new fingerprint
+ *
+ *	@par MT-safe:	No
+ */
+extern unsigned long long	lim_fingerprint(void *, unsigned long long);
+
 /**	@fn int has_hardlimits(void *p)
  *	@brief	are any hard limits set?
  *
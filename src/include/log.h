@@ -67,6 +67,9 @@
  */
 #define LOG_BUF_SIZE 4352
 
+/* suffix of the job index written alongside a log file, see pbs_log.c */
+#define LOG_INDEX_SUFFIX ".idx"
+
 /* The following macro assist in sharing code between the Server and Mom */
 #define LOG_EVENT log_event
 
@@ -109,6 +112,11 @@ extern int will_log_event(int type);
 extern void log_suspect_file(const char *func, const char *text, const char *file, struct stat *sb);
 extern int  log_open(char *name, char *directory);
 extern int  log_open_main(char *name, char *directory, int silent);
+#ifndef WIN32
+extern int  log_async_start(size_t size);
+extern void log_async_flush(void);
+extern void log_set_index_owner(void);
+#endif
 extern void log_record(int type, int objclass, int severity, const char *objname, const char *text);
 extern char log_buffer[LOG_BUF_SIZE];
 extern int log_level_2_etype(int level);
@@ -57,6 +57,9 @@ struct var_table {
 	char **v_envp;
 	int    v_ensize;
 	int    v_used;
+	int   *v_hash;		/* v_envp slot + 1 by variable name, or NULL */
+	int    v_hsize;		/* number of v_hash buckets, a power of 2 */
+	int    v_hcount;	/* number of v_hash buckets in use */
 };
 
 /* struct sig_tbl = used to hold map of local signal names to values */
@@ -195,6 +198,7 @@ extern void  mom_deljob(job *);
 extern void  mom_deljob_wait2(job *);
 extern int   send_sisters_deljob_wait(job *);
 extern void  del_job_resc(job *);
+extern void  job_alarm_set(time_t);
 extern int   do_mom_action_script(int, job *, pbs_task *, char *,
 	void(*)(job *, int));
 extern enum  Action_Verb chk_mom_action(enum Action_Event);
@@ -205,6 +209,7 @@ struct passwd	*check_pwd(job *);
 extern char *set_shell(job *, struct passwd *);
 extern void  start_exec(job *);
 extern void  send_obit(job *, int);
+extern void  send_obits_pending(void);
 extern void  send_restart(void);
 extern void  send_wk_job_idle(char *, int);
 extern int   site_job_setup(job *);
@@ -222,7 +227,8 @@ extern void  calc_cpupercent(job *, unsigned long, unsigned long, time_t);
 extern void  dorestrict_user(void);
 extern int   task_save(pbs_task *ptask);
 extern void send_join_job_restart(int, eventent *, int, job *, pbs_list_head *);
-extern int send_resc_used_to_ms(int stream, char *jobid);
+extern eventent *job_pending_event(job *);
+extern int send_resc_used_to_ms(int stream, char *jobid, int force);
 extern int recv_resc_used_from_sister(int stream, char *jobid, int nodeidx);
 extern int  is_comm_up(int);
 
@@ -336,6 +342,7 @@ extern char  *NAS_tmpdirname(job *);
 #endif /* localmod 010 */
 extern char  *jobdirname(char *, char *);
 extern void  rmtmpdir(char *);
+extern pid_t spawn_cleandir(char *);
 extern int local_or_remote(char **);
 extern void add_bad_list(char **, char *, int);
 extern int is_child_path(char *, char *);
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+#ifndef _NAME_IDX_H
+#define _NAME_IDX_H
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+/*
+ * An open-addressed hash index from a null-terminated name (job id,
+ * reservation id, queue or vnode name) to the object it names.
+ *
+ * The index keeps its own copy of each key, so adding a name costs one
+ * allocation but finding one costs none.  Slots are probed linearly in a
+ * table whose size is always a power of two; deleted slots are left as
+ * markers until the table is next rebuilt.  An index created with
+ * create_name_idx_nocase() matches names without regard to case.
+ */
+
+#define NAME_IDX_OP_ADD	0
+#define NAME_IDX_OP_DEL	1
+
+typedef struct name_idx_ent {
+	char		*ne_key;	/* copy of the key, NULL if never used */
+	unsigned int	 ne_hash;	/* hash of ne_key */
+	void		*ne_data;	/* object the key names */
+} name_idx_ent;
+
+typedef struct name_idx {
+	name_idx_ent	*ni_ents;	/* the slots */
+	unsigned int	 ni_size;	/* number of slots, a power of two */
+	unsigned int	 ni_used;	/* slots holding a key */
+	unsigned int	 ni_deleted;	/* slots holding a delete marker */
+	int		 ni_nocase;	/* keys compare case insensitively */
+} name_idx;
+
+extern name_idx *create_name_idx(void);
+extern name_idx *create_name_idx_nocase(void);
+extern void free_name_idx(name_idx *);
+extern void *find_name_idx(name_idx *, char *);
+extern int name_idx_add_del(name_idx *, char *, void *, int);
+
+#ifdef  __cplusplus
+}
+#endif
+#endif	/* _NAME_IDX_H */
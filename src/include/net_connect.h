@@ -66,8 +66,15 @@ typedef unsigned long pbs_net_t;        /* for holding host addresses */
 #define PBS_NET_CONN_FROM_QSUB_DAEMON	0x08
 #define PBS_NET_CONN_FORCE_QSUB_UPDATE	0x10
 #define PBS_NET_CONN_GSSAPIAUTH 0x20
+#define PBS_NET_CONN_BUSY	0x40	/* being read off the poll list */
+#define PBS_NET_CONN_CLOSEPEND	0x80	/* close asked for while busy */
+#define PBS_NET_CONN_PIPELINE	0x100	/* client may send requests ahead of replies */
+#define PBS_NET_CONN_HELD	0x200	/* not polled until its request is answered */
 
 #define	QSUB_DAEMON	"qsub-daemon"
+#define	DIS_BINARY_OFFER	"dis-binary"	/* Connect extend offering, and reply accepting, DIS_FMT_BINARY */
+#define	PIPELINE_OFFER	"pipeline"	/* same, for sending requests ahead of their replies */
+#define	CONNECT_OFFER_SEP	','	/* between the offers in one Connect extend */
 
 /*
  **	Protocol numbers and versions for PBS communications.
@@ -124,6 +131,7 @@ typedef unsigned long pbs_net_t;        /* for holding host addresses */
 #define IS_HOOK_CHECKSUMS		 30 /* mom reports about hooks seen */
 #define IS_HELLO_NO_INVENTORY	31 /* send info about the mom node only */
 #define IS_UPDATE_FROM_HOOK2	32 /* request to update vnodes from a hook running on a parent mom host or an allowed non-parent mom host */
+#define IS_UPDATE_DELTA		33 /* IS_UPDATE2 carrying only the vnode attributes changed since the last one */
 
 #define IS_CMD          40
 #define IS_CMD_REPLY    41
@@ -132,6 +140,12 @@ typedef unsigned long pbs_net_t;        /* for holding host addresses */
 #define HELLO4_vmap_version	 1
 #define HELLO4_running_jobs	 2
 
+/* Bits the Server appends to IS_HELLO and IS_HELLO_NO_INVENTORY */
+#define HELLO_delta_update	 1	/* Server accepts IS_UPDATE_DELTA */
+
+/* Bits Mom appends to IS_UPDATE, IS_UPDATE2 and IS_UPDATE_DELTA */
+#define UPDATE_exec_job		 1	/* Mom accepts PBS_BATCH_ExecJob */
+
 /* return codes for client_to_svr() */
 
 #define PBS_NET_RC_FATAL -1
@@ -180,6 +194,11 @@ conn_t *add_conn(int sock, enum conn_type, pbs_net_t, unsigned int port, int (*r
 conn_t *add_conn_priority(int sock, enum conn_type, pbs_net_t, unsigned int port, int (*ready_func)(int), void (*func)(int), int priority_flag);
 int add_conn_data(int sock, void *data); /* Adds the data to the connection */
 void *get_conn_data(int sock); /* Gets the pointer to the data present with the connection */
+int net_suspend_conn(int sock); /* stop polling the connection while another thread reads it */
+int net_resume_conn(int sock); /* poll the connection again */
+int connect_offer_listed(char *list, char *offer);
+int net_hold_conn(int sock); /* stop polling the connection until its request is answered */
+int net_release_conn(int sock); /* poll a held connection again */
 void close_socket(int sock);
 int  client_to_svr(pbs_net_t, unsigned int port, int);
 int  client_to_svr_extend(pbs_net_t, unsigned int port, int, char*);
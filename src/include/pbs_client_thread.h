@@ -51,6 +51,7 @@ extern "C" {
 #endif
 
 #include <pthread.h>
+#include "dis_init.h"
 
 
 /**
@@ -103,6 +104,8 @@ struct pbs_client_thread_context {
 	*th_errlist;
 	/** pointer to the location for the dis_buffer for each thread */
 	char			*th_dis_buffer;
+	/** the DIS transport routines this thread reads and writes through */
+	struct dis_funcs	th_dis_funcs;
 	/** pointer to the cred_info structure used by pbs_submit_with_cred */
 	void			*th_cred_info;
 	/** used by totpool and usepool functions */
@@ -171,6 +174,10 @@ void free_errlist(struct ecl_attribute_errors * errlist);
 /* function called by daemons to set them to use the unthreaded functions */
 void pbs_client_thread_set_single_threaded_mode(void);
 
+/* give a worker thread of a single threaded daemon a context of its own */
+int pbs_client_thread_init_worker_context(void);
+void pbs_client_thread_destroy_worker_context(void);
+
 
 #ifdef	__cplusplus
 }
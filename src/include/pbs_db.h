@@ -104,6 +104,7 @@ struct pbs_db_connection {
 	int     conn_trx_rollback;      /* rollback flag in case of nested trx */
 	int     conn_result_format;     /* 0 - text, 1 - binary */
 	int     conn_trx_async;		/* 1 - async, 0 - sync, one-shot reset */
+	long long conn_db_usec;		/* usecs spent executing statements */
 	void    *conn_db_err;           /* opaque database error store */
 	void    *conn_data;             /* any other db specific data */
 	void    *conn_resultset;        /* point to any results data */
@@ -1018,6 +1019,59 @@ int resize_buff(pbs_db_sql_buffer_t *dest, int size);
  */
 void pbs_db_reset_obj(pbs_db_obj_info_t *obj);
 
+/**
+ * @brief
+ *	A pool of database connections, one for each thread using it
+ */
+typedef struct pbs_db_pool pbs_db_pool_t;
+
+/**
+ * @brief
+ *	Create a pool of at most size connections to the database on host.
+ *	Connections are made when first asked for.
+ *
+ * @param[in]	host	- The hostname to connect to
+ * @param[in]	timeout	- The connection attempt timeout
+ * @param[in]	size	- Most connections in the pool
+ *
+ * @return      The pool
+ * @retval      NULL - Failure
+ *
+ */
+pbs_db_pool_t *pbs_db_pool_create(char *host, int timeout, int size);
+
+/**
+ * @brief
+ *	Get the connection of the calling thread from the pool, connected
+ *	and with its sqls prepared.
+ *
+ * @param[in]	pool	 - The pool
+ * @param[out]	failcode - Output failure code if any
+ *
+ * @return      The connection
+ * @retval      NULL - Failure
+ *
+ */
+pbs_db_conn_t *pbs_db_pool_get(pbs_db_pool_t *pool, int *failcode);
+
+/**
+ * @brief
+ *	Give the connection of the calling thread back to the pool
+ *
+ * @param[in]	pool - The pool
+ *
+ */
+void pbs_db_pool_put(pbs_db_pool_t *pool);
+
+/**
+ * @brief
+ *	Close all the connections of a pool and free it
+ *
+ * @param[in]	pool - The pool
+ *
+ */
+void pbs_db_pool_destroy(pbs_db_pool_t *pool);
+
 #ifdef	__cplusplus
 }
 #endif
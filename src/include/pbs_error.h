@@ -296,6 +296,7 @@ extern "C" {
 #define PBSE_SCHED_OP_NOT_PERMITTED 15223 /* Operation not permitted on default scheduler */
 #define PBSE_SCHED_PARTITION_ALREADY_EXISTS 15224 /* Partition already exists */
 #define PBSE_INVALID_MAX_JOB_SEQUENCE_ID 15225 /* Invalid max_job_sequence_id < 9999999, or > 999999999999 */
+#define PBSE_MOD_SEQ_STALE 15226	/* changed since sequence older than the deleted objects kept */
 
 /* the following structure is used to tie error number      */
 /* with text to be returned to a client, see svr_messages.c */
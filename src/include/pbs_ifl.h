@@ -303,6 +303,7 @@ extern "C" {
 #define ATTR_license_max	"pbs_license_max"
 #define ATTR_license_linger	"pbs_license_linger_time"
 #define ATTR_license_count	"license_count"
+#define ATTR_nodestate_count	"node_state_count"
 #define ATTR_job_sort_formula	"job_sort_formula"
 #define ATTR_EligibleTimeEnable "eligible_time_enable"
 #define ATTR_resv_retry_init       "reserve_retry_init"
@@ -357,6 +358,7 @@ extern "C" {
 #define ATTR_sched_preempt_prio  "preempt_prio"
 #define ATTR_sched_preempt_order  "preempt_order"
 #define ATTR_sched_preempt_sort  "preempt_sort"
+#define ATTR_sched_cycle_stats  "sched_cycle_stats"
 
 /* additional node "attributes" names */
 
@@ -503,6 +505,35 @@ enum pbs_auth_method {
 #define NOMAIL  			"nomail"
 #define SUPPRESS_EMAIL  		"suppress_email"
 #define DELETEHISTORY		"deletehist"
+
+/*
+ * passed in the extend parameter of pbs_statjob(), pbs_statvnode(),
+ * pbs_statque() and pbs_statresv() followed by a modification sequence,
+ * e.g. "C1234": only the objects changed since that sequence are returned,
+ * each with its current ATTR_mod_seq, and the objects deleted since are
+ * returned with just ATTR_mod_seq and ATTR_mod_deleted.  "C0" returns all
+ * the objects with their ATTR_mod_seq.
+ */
+#define EXTEND_CHANGED_SINCE	'C'
+#define ATTR_mod_seq		"modify_sequence"
+#define ATTR_mod_deleted	"deleted"
+
+/*
+ * passed in the extend parameter of pbs_statjob() by pbs_statjob_page() to
+ * status the jobs of a queue or server a page at a time, see pbs_statjob.3B
+ */
+#define EXTEND_PAGE		'P'
+#define ATTR_status_cursor	"status_cursor"
+#define PBS_STAT_CURSOR_LEN	64
+
+/*
+ * passed last in the extend parameter of pbs_statvnode() and pbs_statque()
+ * followed by a comma separated list of partitions, e.g. "|p1,p2": only the
+ * vnodes or queues in one of those partitions are returned.  An empty list
+ * returns those not in any partition.  Combined with EXTEND_CHANGED_SINCE a
+ * changed object outside the partitions is returned as deleted.
+ */
+#define EXTEND_PARTITION	'|'
 /*
  ** This structure is identical to attropl so they can be used
  ** interchangably.  The op field is not used.
@@ -560,6 +591,19 @@ typedef struct preempt_job_info {
         char	order[PREEMPT_METHOD_HIGH + 1];
 } preempt_job_info;
 
+typedef struct job_err_info {
+	char	job_id[PBS_MAXSVRJOBID + 1];
+	int	errcode;
+} job_err_info;
+
+/* one directive of pbs_manager_many(), as the arguments of pbs_manager() */
+struct manage_op {
+	int		command;
+	int		objtype;
+	char		*objname;
+	struct attropl	*attribs;
+};
+
 /* Resource Reservation Information */
 typedef int	pbs_resource_t;	/* resource reservation handle */
 
@@ -641,6 +685,10 @@ DECLDIR struct batch_status *pbs_statrsc(int, char *, struct attrl *, char *);
 
 DECLDIR struct batch_status *pbs_statjob(int, char *, struct attrl *, char *);
 
+DECLDIR struct batch_status *pbs_statjob_page(int, char *, struct attrl *, char *, int, char *);
+
+DECLDIR struct batch_status *pbs_statjob_filter(int, char *, struct attrl *, struct attropl *, char *);
+
 DECLDIR struct batch_status *pbs_selstat(int, struct attropl *, struct attrl *, char *);
 
 DECLDIR struct batch_status *pbs_statque(int, char *, struct attrl *, char *);
@@ -672,6 +720,28 @@ DECLDIR int pbs_terminate(int, int, char *);
 DECLDIR char *pbs_modify_resv(int, char*, struct attropl *, char *);
 
 DECLDIR preempt_job_info *pbs_preempt_jobs(int, char **);
+
+DECLDIR job_err_info *pbs_alterjobs(int, struct batch_status *);
+
+DECLDIR job_err_info *pbs_asyrunjobs(int, char **, char **);
+
+DECLDIR job_err_info *pbs_submit_many(int, int, struct attropl **, char **, char **, char *);
+
+DECLDIR job_err_info *pbs_manager_many(int, int, struct manage_op *, char *);
+
+DECLDIR job_err_info *pbs_deljobs(int, char **, char *);
+
+DECLDIR int pbs_alterjob_async(int, char *, struct attrl *, char *);
+
+DECLDIR int pbs_runjob_async(int, char *, char *, char *);
+
+DECLDIR int pbs_deljob_async(int, char *, char *);
+
+DECLDIR int pbs_statjob_async(int, char *, struct attrl *, char *);
+
+DECLDIR int pbs_async_wait(int, int *, struct batch_status **);
+
+DECLDIR int pbs_async_pending(int);
 #else
 
 #ifndef __PBS_ERRNO
@@ -737,6 +807,10 @@ extern struct batch_status *pbs_statrsc(int, char *, struct attrl *, char *);
 
 extern struct batch_status *pbs_statjob(int, char *, struct attrl *, char *);
 
+extern struct batch_status *pbs_statjob_page(int, char *, struct attrl *, char *, int, char *);
+
+extern struct batch_status *pbs_statjob_filter(int, char *, struct attrl *, struct attropl *, char *);
+
 extern struct batch_status *pbs_selstat(int, struct attropl *, struct attrl *, char *);
 
 extern struct batch_status *pbs_statque(int, char *, struct attrl *, char *);
@@ -768,6 +842,28 @@ extern int pbs_terminate(int, int, char *);
 extern char *pbs_modify_resv(int, char*, struct attropl *, char *);
 
 extern preempt_job_info *pbs_preempt_jobs(int, char **);
+
+extern job_err_info *pbs_alterjobs(int, struct batch_status *);
+
+extern job_err_info *pbs_asyrunjobs(int, char **, char **);
+
+extern job_err_info *pbs_submit_many(int, int, struct attropl **, char **, char **, char *);
+
+extern job_err_info *pbs_manager_many(int, int, struct manage_op *, char *);
+
+extern job_err_info *pbs_deljobs(int, char **, char *);
+
+extern int pbs_alterjob_async(int, char *, struct attrl *, char *);
+
+extern int pbs_runjob_async(int, char *, char *, char *);
+
+extern int pbs_deljob_async(int, char *, char *);
+
+extern int pbs_statjob_async(int, char *, struct attrl *, char *);
+
+extern int pbs_async_wait(int, int *, struct batch_status **);
+
+extern int pbs_async_pending(int);
 #endif /* _USRDLL */
 
 /* IFL function pointers */
@@ -810,6 +906,17 @@ extern char *(*pfn_pbs_submit_resv)(int, struct attropl *, char *);
 extern int (*pfn_pbs_delresv)(int, char *, char *);
 extern int (*pfn_pbs_terminate)(int, int, char *);
 extern preempt_job_info *(*pfn_pbs_preempt_jobs)(int, char**);
+extern job_err_info *(*pfn_pbs_alterjobs)(int, struct batch_status *);
+extern job_err_info *(*pfn_pbs_asyrunjobs)(int, char **, char **);
+extern job_err_info *(*pfn_pbs_submit_many)(int, int, struct attropl **, char **, char **, char *);
+extern job_err_info *(*pfn_pbs_manager_many)(int, int, struct manage_op *, char *);
+extern job_err_info *(*pfn_pbs_deljobs)(int, char **, char *);
+extern int (*pfn_pbs_alterjob_async)(int, char *, struct attrl *, char *);
+extern int (*pfn_pbs_runjob_async)(int, char *, char *, char *);
+extern int (*pfn_pbs_deljob_async)(int, char *, char *);
+extern int (*pfn_pbs_statjob_async)(int, char *, struct attrl *, char *);
+extern int (*pfn_pbs_async_wait)(int, int *, struct batch_status **);
+extern int (*pfn_pbs_async_pending)(int);
 
 #ifdef	__cplusplus
 }
@@ -239,6 +239,22 @@ struct pbs_config
 	unsigned int pbs_comm_threads;	/* number of threads for router, default 4 */
 	char *pbs_mom_node_name;	/* mom short name used for natural node, default NULL */
 	unsigned int pbs_log_highres_timestamp; /* high resolution logging */
+	unsigned int pbs_server_decode_threads; /* server request decode threads, default 0 */
+	unsigned int pbs_server_job_save_window; /* seconds a job save may wait, default 0 */
+	unsigned int pbs_server_log_async_size; /* KB buffered for the server log writer, default 0 */
+	unsigned int pbs_server_acct_async_size; /* KB buffered for the accounting writer, default 0 */
+	unsigned int pbs_server_thin_subjob_history; /* keep finished subjobs in the array's table only, default 0 */
+	unsigned int pbs_compression_level; /* zlib level for compressed TPP data, 1 (fast) to 9, default 0 = zlib's */
+	unsigned int pbs_conn_reuse; /* idle server connections a client process keeps for reuse, default 0 */
+	unsigned int pbs_log_index; /* write a job index alongside each daemon log, default 0 */
+	unsigned int pbs_server_acct_binary; /* also write binary accounting records, default 0 */
+	unsigned int pbs_host_cache_ttl; /* seconds host lookups are cached, default 0 = not cached */
+	unsigned int pbs_failover_warm_time; /* seconds between readying the datastore for a takeover, default 0 = never */
+	unsigned int pbs_sched_trigger_gap; /* minimum seconds between event triggered scheduling cycles, default 0 */
+	unsigned int pbs_sched_trigger_latency; /* maximum seconds an event trigger is held back, default 0 = the gap */
+	char *pbs_comm_thread_cpus; /* cpu list, or "nic", to bind the router threads to, default NULL = unbound */
+	unsigned int pbs_server_stat_cache_ttl; /* seconds a status reply is served again, default 0 = not */
+	unsigned int pbs_server_acct_async_flush; /* seconds an accounting batch may wait, default 0 */
 #ifdef WIN32
 	char *pbs_conf_remote_viewer; /* Remote viewer client executable for PBS GUI jobs, along with launch options */
 #endif
@@ -301,6 +317,22 @@ extern struct pbs_config pbs_conf;
 #define PBS_CONF_SCHEDULER_MODIFY_EVENT	"PBS_SCHEDULER_MODIFY_EVENT"
 #define PBS_CONF_MOM_NODE_NAME	"PBS_MOM_NODE_NAME"
 #define PBS_CONF_LOG_HIGHRES_TIMESTAMP	"PBS_LOG_HIGHRES_TIMESTAMP"
+#define PBS_CONF_SERVER_DECODE_THREADS	"PBS_SERVER_DECODE_THREADS"
+#define PBS_CONF_SERVER_JOB_SAVE_WINDOW	"PBS_SERVER_JOB_SAVE_WINDOW"
+#define PBS_CONF_SERVER_LOG_ASYNC_SIZE	"PBS_SERVER_LOG_ASYNC_SIZE"
+#define PBS_CONF_SERVER_ACCT_ASYNC_SIZE	"PBS_SERVER_ACCT_ASYNC_SIZE"
+#define PBS_CONF_SERVER_THIN_SUBJOB_HISTORY	"PBS_SERVER_THIN_SUBJOB_HISTORY"
+#define PBS_CONF_COMPRESSION_LEVEL	"PBS_COMPRESSION_LEVEL"
+#define PBS_CONF_CONN_REUSE	"PBS_CONN_REUSE"
+#define PBS_CONF_LOG_INDEX	"PBS_LOG_INDEX"
+#define PBS_CONF_SERVER_ACCT_BINARY	"PBS_SERVER_ACCT_BINARY"
+#define PBS_CONF_HOST_CACHE_TTL	"PBS_HOST_CACHE_TTL"
+#define PBS_CONF_FAILOVER_WARM_TIME	"PBS_FAILOVER_WARM_TIME"
+#define PBS_CONF_SCHED_TRIGGER_GAP	"PBS_SCHED_TRIGGER_GAP"
+#define PBS_CONF_SCHED_TRIGGER_LATENCY	"PBS_SCHED_TRIGGER_LATENCY"
+#define PBS_CONF_COMM_THREAD_CPUS	"PBS_COMM_THREAD_CPUS"
+#define PBS_CONF_SERVER_STAT_CACHE_TTL	"PBS_SERVER_STAT_CACHE_TTL"
+#define PBS_CONF_SERVER_ACCT_ASYNC_FLUSH	"PBS_SERVER_ACCT_ASYNC_FLUSH"
 #ifdef WIN32
 #define PBS_CONF_REMOTE_VIEWER "PBS_REMOTE_VIEWER"	/* Executable for remote viewer application alongwith its launch options, for PBS GUI jobs */
 #endif
@@ -149,6 +149,7 @@ struct mom_svrinfo {
 	int	      msr_jbinxsz;  /* size of job index array */
 	struct job  **msr_jobindx;  /* index array of jobs on this Mom */
 	long	      msr_vnode_pool;/* the pool of vnodes that belong to this Mom */
+	int	      msr_caps;	    /* UPDATE_* bits Mom last reported */
 };
 typedef struct mom_svrinfo mom_svrinfo_t;
 
@@ -237,6 +238,30 @@ struct	resvinfo {
 	struct resvinfo *next;
 };
 
+/*
+ * An exec_vnode string parsed once, so that resources_assigned on the vnodes
+ * can be adjusted at job start and end without tokenizing it again.
+ */
+struct execvnode_resc {
+	struct resource_def	*evr_def;	/* resource definition */
+	char			*evr_str;	/* value as written in exec_vnode */
+	attribute		 evr_val;	/* decoded value */
+};
+
+struct execvnode_chunk {
+	struct pbsnode		*evc_pnode;	/* vnode of the chunk */
+	int			 evc_asgn;	/* ATR_DFLAG_*NASSN accumulated */
+	int			 evc_nresc;	/* number of entries in evc_resc */
+	struct execvnode_resc	*evc_resc;
+};
+
+struct parsed_execvnode {
+	attribute		*pev_attr;	/* attribute the string came from */
+	char			*pev_str;	/* copy of the parsed string */
+	int			 pev_nchunk;	/* number of entries in pev_chunks */
+	struct execvnode_chunk	*pev_chunks;
+};
+
 struct node_req {
 	int	 nr_ppn;	/* processes (tasks) per node */
 	int	 nr_cpp;	/* cpus per process           */
@@ -273,6 +298,7 @@ struct	pbsnode {
 	char			*nd_hostname;	/* ptr to hostname */
 	struct pbssubn		*nd_psn;	/* ptr to list of virt cpus */
 	struct resvinfo		*nd_resvp;
+	struct resvinfo		*nd_seq_resvp;	/* standing resvs using me in any occurrence */
 	long			 nd_nsn;	/* number of VPs  */
 	long			 nd_nsnfree;	/* number of VPs free */
 	long			 nd_ncpus;	/* number of phy cpus on node */
@@ -282,6 +308,8 @@ struct	pbsnode {
 	unsigned short		 nd_accted;	/* resc recorded in job acct */
 	struct pbs_queue	*nd_pque;	/* queue to which it belongs */
 	int			 nd_modified;	/* flag indicating whether state update is required */
+	int			 nd_modlist;	/* on the modified node list */
+	long long		 nd_mod_seq;	/* sequence of the last change */
 	attribute		 nd_attr[ND_ATR_LAST];
 };
 
@@ -390,6 +418,10 @@ enum vnode_degraded_op {
 #define NODE_UPDATE_VNL             0x8  /* this vnode updated in vnl by Mom  */
 #define NODE_UPDATE_CURRENT_AOE     0x10  /* current_aoe attribute to be updated */
 #define NODE_UPDATE_MOM             0x20 /* update only the mom attribute */
+/* the bits that mean the node has to be written to the datastore */
+#define NODE_UPDATE_DB_MASK	(NODE_UPDATE_STATE | NODE_UPDATE_COMMENT | \
+				NODE_UPDATE_OTHERS | NODE_UPDATE_CURRENT_AOE | \
+				NODE_UPDATE_MOM)
 
 
 #define NODE_SAVE_FULL  0
@@ -424,7 +456,12 @@ extern	void vnode_available(struct pbsnode *);
 extern	int find_degraded_occurrence(resc_resv *, struct pbsnode *, enum vnode_degraded_op);
 extern	int find_vnode_in_execvnode(char *, char *);
 extern	void set_vnode_state(struct pbsnode *, unsigned long , enum vnode_state_op);
+extern	void invalidate_node_state_ct(void);
+extern	void update_node_state_ct(attribute *, char *);
 extern	struct resvinfo *find_vnode_in_resvs(struct pbsnode *, enum vnode_degraded_op);
+extern	void index_resv_seq_vnodes(resc_resv *);
+extern	void unindex_resv_seq_vnodes(resc_resv *);
+extern	void unindex_vnode_seq_resvs(struct pbsnode *);
 extern	void free_rinf_list(struct resvinfo *);
 extern	void degrade_offlined_nodes_reservations(void);
 extern	void degrade_downed_nodes_reservations(void);
@@ -434,6 +471,8 @@ extern	int	initialize_pbsnode(struct pbsnode*, char*, int);
 extern	void	initialize_pbssubn(struct pbsnode *, struct pbssubn*, struct prop*);
 extern  struct pbssubn *create_subnode(struct pbsnode *, struct pbssubn *lstsn);
 extern	void	effective_node_delete(struct pbsnode*);
+extern	void	free_parsed_execvnode(struct parsed_execvnode *);
+extern	void	invalidate_parsed_execvnodes(void);
 extern	void	setup_notification(void);
 extern  struct	pbssubn  *find_subnodebyname(char *);
 extern	struct	pbsnode  *find_nodebyname(char *);
@@ -469,6 +508,9 @@ extern 	int	fix_indirectness(resource *, struct pbsnode *, int);
 extern	int	chk_vnode_pool(attribute *, void *, int);
 extern	void	free_pnode(struct pbsnode *);
 extern	int	save_nodes_db(int, void *);
+extern	void	node_mark_modified(struct pbsnode *, int);
+extern	struct pbsnode **get_modified_nodes(int *);
+extern	void	prune_modified_nodes(void);
 extern void	propagate_socket_licensing(mominfo_t *, int);
 
 extern char *msg_daemonname;
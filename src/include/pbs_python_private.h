@@ -171,6 +171,8 @@ extern PyObject * pbs_python_import_name(const char *, const char *);
 
 extern PyObject *pbs_v1_module_init(void);
 extern PyObject *pbs_v1_module_inittab(void);
+extern PyObject *pbs_v1_module_namespace(void);
+extern void pbs_v1_module_clear(void);
 
 /* declrations from pbs_python_svr_internal.c */
 
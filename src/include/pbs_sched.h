@@ -92,6 +92,7 @@ enum sched_atr {
 	SCHED_ATR_preempt_order,
 	SCHED_ATR_preempt_sort,
 	SCHED_ATR_log_events,
+	SCHED_ATR_sched_cycle_stats,
 #include "site_sched_attr_enum.h"
 	/* This must be last */
 	SCHED_ATR_LAST
@@ -107,6 +108,8 @@ typedef struct pbs_sched {
 	pbs_net_t pbs_scheduler_addr;
 	unsigned int pbs_scheduler_port;
 	time_t sch_next_schedule;		/* when to next run scheduler cycle */
+	time_t sch_cycle_start;			/* when the last cycle was started */
+	time_t sch_trigger_first;		/* when the oldest held event trigger was raised */
 	char sc_name[PBS_MAXSCHEDNAME + 1];
 	struct preempt_ordering preempt_order[PREEMPT_ORDER_MAX + 1];
 	/* sched object's attributes  */
@@ -117,6 +120,7 @@ typedef struct pbs_sched {
 extern pbs_sched *dflt_scheduler;
 extern	pbs_list_head	svr_allscheds;
 extern void set_scheduler_flag(int flag, pbs_sched *psched);
+extern time_t sched_trigger_time(pbs_sched *psched);
 extern int find_assoc_sched_jid(char *jid, pbs_sched **target_sched);
 extern int find_assoc_sched_pque(pbs_queue *pq, pbs_sched **target_sched);
 extern pbs_sched *find_sched_from_sock(int sock);
@@ -42,8 +42,9 @@ extern "C" {
 #endif
 
 /*Defines used by port_forwarding.c*/
-/* Max size of buffer to store data*/
-#define PF_BUF_SIZE 8192
+/* Max size of buffer to store data, large enough that a busy X11 or
+ interactive stream is not limited to a few KB per select() pass */
+#define PF_BUF_SIZE 65536
 
 /* Limits the number of simultaneous X applications that a single job
  can run in the background to 24 . 1 socket fd is used for storing
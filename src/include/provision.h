@@ -98,6 +98,8 @@ extern int check_and_enqueue_provisioning(job *, int *);
 
 extern void do_provisioning(struct work_task * wtask);
 
+extern int queue_provisioning(void);
+
 #ifdef __cplusplus
 }
 #endif
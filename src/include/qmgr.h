@@ -391,6 +391,7 @@ void disconnect_from_server();
 "server_name - the name of the server and possibly a port number\n" \
 "server_state - the current state of the server\n" \
 "state_count - total number of jobs in each state\n" \
+"node_state_count - total number of vnodes in each state\n" \
 "total_jobs - total number of jobs managed by the server\n" \
 "PBS_version - the release version of PBS\n" \
 
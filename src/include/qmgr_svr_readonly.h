@@ -50,6 +50,7 @@
 
 ATTR_rescassn,
 ATTR_count,
+ATTR_nodestate_count,
 ATTR_status,
 ATTR_SvrHost,
 ATTR_total,
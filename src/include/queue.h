@@ -158,7 +158,11 @@ struct pbs_queue {
 
 	int	qu_numjobs;			/* current numb jobs in queue */
 	int	qu_njstate[PBS_NUMJOBSTATE];	/* # of jobs per state */
+	pbs_list_head qu_jobs_bystate[PBS_NUMJOBSTATE]; /* jobs per state, by rank */
+	pbs_list_head qu_actjobs;		/* jobs not history, by rank */
 	char	qu_jobstbuf[150];
+	long long qu_mod_seq;			/* sequence of the last change */
+	char	qu_rtnext[PBS_MAXSVRJOBID + 1];	/* job queue_route() resumes at */
 
 	/* the queue attributes */
 
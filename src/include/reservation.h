@@ -219,6 +219,8 @@ struct resc_resv {
 	long			ri_degraded_time;	/* a tentative time to reconfirm the reservation */
 
 	pbsnode_list_t		*ri_pbsnode_list;	/* vnode list associated to the reservation */
+	pbsnode_list_t		*ri_seq_vnodes;		/* vnodes indexed from every occurrence of a standing resv */
+	char			*ri_seq_indexed;	/* execvnodes sequence ri_seq_vnodes was built from */
 
 	/* objects used while altering a reservation. */
 	time_t			ri_alter_stime;		/* start time backup while altering a reservation. */
@@ -228,6 +230,8 @@ struct resc_resv {
 							/* duration backup while altering a standing reservation. */
 	unsigned int		ri_alter_flags;		/* flags used while altering a reservation. */
 
+	long long		ri_mod_seq;		/* sequence of the last change */
+
 	/* Reservation start and end tasks */
 	struct work_task	*resv_start_task;
 	struct work_task	*resv_end_task;
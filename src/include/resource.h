@@ -84,6 +84,21 @@ typedef struct resource {
 	attribute	     rs_value;	/* attribute struct holding value */
 } resource;
 
+/*
+ * Index of the entries of a resource list, an array of pointers to the
+ * entries in the (name) order of the list, so that an entry is found
+ * by a binary search.  It is built once the list holds RESC_INDEX_MIN
+ * entries.  Entries must be added to and removed from a list only with
+ * the functions below so that the index follows the list.
+ */
+#define RESC_INDEX_MIN 16
+
+typedef struct resc_index {
+	int	  rix_nent;	/* number of entries */
+	int	  rix_size;	/* number of slots in rix_ent */
+	resource *rix_ent[1];	/* the entries, in list order */
+} resc_index;
+
 typedef struct resource_def {
 	char   *rs_name;
 	int   (*rs_decode)(attribute *prsc, char *name, char *rn, char *val);
@@ -121,7 +136,10 @@ extern int	     svr_resc_unk;	/* index to "unknown" resource   */
 
 extern resource     *add_resource_entry(attribute *, resource_def *);
 extern resource_def *find_resc_def(resource_def *, char *, int);
+extern int index_resc_def(resource_def *, int);
 extern resource     *find_resc_entry(attribute *, resource_def *);
+extern void          link_resource_entry(attribute *, resource *);
+extern void          unlink_resource_entry(attribute *, resource *);
 extern int          is_builtin(resource_def *rscdef);
 extern int           update_resource_def_file(char *name, resdef_op_t op, int type, int perms);
 extern int           add_resource_def(char *name, int type, int perms);
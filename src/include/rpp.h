@@ -75,6 +75,7 @@ struct tpp_config {
 	void * (*get_ext_auth_data)(int auth_type, int *data_len, char *ebuf, int ebufsz);
 	int    (*validate_ext_auth_data) (int auth_type, void *data, int data_len, char *ebuf, int ebufsz);
 	int    compress;
+	int    compress_level; /* zlib level, 0 for zlib's default */
 	int    tcp_keepalive; /* use keepalive? */
 	int    tcp_keep_idle;
 	int    tcp_keep_intvl;
@@ -82,8 +83,12 @@ struct tpp_config {
 	int    tcp_user_timeout;
 	int    buf_limit_per_conn; /* buffer limit per physical connection */
 	int    force_fault_tolerance; /* by default disabled */
+	char   *thread_cpus; /* cpu list or TPP_THREAD_CPUS_NIC to bind threads to, NULL for none */
 };
 
+/* thread_cpus value binding the threads to the cpus near the network interface */
+#define TPP_THREAD_CPUS_NIC	"nic"
+
 /* rpp node types, leaf and router */
 #define TPP_LEAF_NODE           1  /* leaf node that does not care about TPP_CTL_LEAVE messages from other leaves */
 #define TPP_LEAF_NODE_LISTEN    2  /* leaf node that wants to be notified of TPP_CTL_LEAVE messages from other leaves */
@@ -97,6 +102,7 @@ void (*app_net_restore_handler)(void *data));
 extern void DIS_tpp_setup(int);
 extern void tpp_set_logmask(long logmask);
 extern void set_tpp_funcs(void (*log_fn)(int, const char *, char *));
+extern char *tpp_stats_json(void);
 extern int set_tpp_config(struct pbs_config *pbs_conf,
 	struct tpp_config *tpp_conf, char *nodename,
 	int port, char *routers, int compress, int auth_type,
@@ -131,6 +131,7 @@ enum srv_atr {
 	SRV_ATR_license_max,
 	SRV_ATR_license_linger,
 	SRV_ATR_license_count,
+	SRV_ATR_NodesByState,
 	SRV_ATR_version,
 	SRV_ATR_job_sort_formula,
 	SRV_ATR_EligibleTimeEnable,
@@ -176,6 +177,21 @@ extern long long svr_jobidnumber;
 /* for history jobs*/
 extern long svr_history_enable;
 extern long svr_history_duration;
+/* for the changed since status of jobs, vnodes, queues and reservations */
+extern long long svr_mod_seq;
+extern long long svr_mod_seq_floor;
+extern pbs_list_head svr_mod_seq_deleted;
+
+/*
+ * An object deleted from the server, kept so a changed since status can
+ * tell the client. The oldest are dropped past SVR_MOD_SEQ_DELETED_MAX.
+ */
+struct mod_seq_deleted {
+	pbs_list_link	md_link;
+	long long	md_seq;		/* sequence of the deletion */
+	int		md_objtype;	/* MGR_OBJ_JOB, _NODE, _QUEUE or _RESV */
+	char		*md_name;	/* name of the object */
+};
 
 
 struct server {
@@ -192,6 +208,7 @@ struct server {
 	int	  sv_jobstates[PBS_NUMJOBSTATE];  /* # of jobs per state */
 	char	  sv_jobstbuf[150];
 	char	  sv_license_ct_buf[150]; /* license_count buffer */
+	char	  sv_nodestbuf[400];	/* node_state_count buffer */
 	int	  sv_nseldft;		/* num of elems in sv_seldft	    */
 	key_value_pair *sv_seldft;	/* defelts for job's -l select	    */
 
@@ -210,6 +227,9 @@ struct server {
 
 extern struct server	server;
 extern	pbs_list_head	svr_alljobs;
+extern	pbs_list_head	svr_jobs_bystate[];
+extern	pbs_list_head	svr_histjobs;
+extern	pbs_list_head	svr_actjobs;
 extern	pbs_list_head	svr_newresvs;	/* incomming new reservations */
 extern	pbs_list_head	svr_allresvs;	/* all reservations in server */
 extern  int		svr_ping_rate;	/* time between rounds of ping */
@@ -245,6 +265,8 @@ extern	long	reserve_retry_cutoff;
 
 #define SVR_HOT_CYCLE	15	/* retry mom every n sec on hot start     */
 #define SVR_HOT_LIMIT	300	/* after n seconds, drop out of hot start */
+#define SVR_ROUTE_MSECS	20	/* route from one queue for at most n msec a pass */
+#define SVR_DB_POOL_SIZE 8	/* database connections for threads other than main */
 
 #define PBS_SCHED_DAEMON_NAME "Scheduler"
 #define WALLTIME "walltime"
@@ -267,13 +289,27 @@ enum failover_state {
  * Server job history defines & globals
  */
 #define SVR_CLEAN_JOBHIST_TM		120	/* after 2 minutes, reschedule the work task */
-#define SVR_CLEAN_JOBHIST_SECS	5	/* never spend more than 5 seconds in one sweep to clean hist */
+#define SVR_CLEAN_JOBHIST_MSECS	10	/* never spend more than 10 milliseconds in one sweep to clean hist */
 #define SVR_JOBHIST_DEFAULT		1209600	/* default time period to keep job history: 2 weeks */
 #define SVR_MAX_JOB_SEQ_NUM_DEFAULT	9999999	/* default max job id is 9999999 */
+#define SVR_MOD_SEQ_DELETED_MAX		10000	/* deleted objects kept for a changed since status */
 
 #define VALUE(str) #str
 #define TOSTR(str) VALUE(str)
 
+/*
+ * Objects whose allocations are counted by their alloc/free functions, so
+ * that mem_stats_log() can tell objects leaked off the server lists apart
+ * from objects that are just numerous.
+ */
+enum mem_stats_obj {
+	MEM_STATS_JOB,
+	MEM_STATS_RESV,
+	MEM_STATS_QUEUE,
+	MEM_STATS_NUM
+};
+extern long mem_stats_alloc[MEM_STATS_NUM];
+
 /* function prototypes */
 
 extern int			svr_recov_db(void);
@@ -287,6 +323,9 @@ extern void			set_sched_default(pbs_sched *, int unset_flag, int from_scheduler)
 extern void			set_attr_svr(attribute *pattr, attribute_def *pdef, char *value);
 extern int			license_sanity_check(void);
 extern void			memory_debug_log(struct work_task *ptask);
+extern void			mem_stats_log(void);
+extern void			update_mod_seq(attribute *pattr, int limit, long long *pseq);
+extern void			record_mod_seq_delete(int objtype, char *name);
 
 #ifdef	__cplusplus
 }
@@ -79,6 +79,7 @@ extern "C" {
 
 #define PBS_SVR_PRIVATE		"server_priv"
 #define PBS_ACCT		"accounting"
+#define PBS_ACCT_BIN		"accounting_bin"
 #define PBS_JOBDIR		"jobs"
 #define PBS_USERDIR		"users"
 #define PBS_RESCDEF		"resourcedef"
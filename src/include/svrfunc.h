@@ -59,6 +59,7 @@ extern "C" {
 extern int   check_num_cpus(void);
 extern int   chk_hold_priv(long hold, int priv);
 extern void  close_client(int sfds);
+extern void  pipeline_reply_sent(int sfds);
 extern int   contact_sched(int, char *jobid, pbs_net_t pbs_scheduler_addr, unsigned int pbs_scheduler_port);
 extern void  count_node_cpus(void);
 extern int   ctcpus(char *buf, int *hascpp);
@@ -75,6 +76,14 @@ extern void  process_Dreply(int);
 extern void  process_DreplyRPP(int);
 extern void  process_request(int);
 extern void  process_dis_request(int);
+extern int   init_decode_pool(int);
+extern void  stop_decode_pool(void);
+extern long long req_stats_hook_usec;
+extern long long req_stats_reply_usec;
+extern long long req_stats_now(void);
+extern void  req_stats_log(void);
+extern void  log_tpp_stats(void);
+extern void  req_commit_flush(void);
 extern int   save_flush(void);
 extern void  save_setup(int);
 extern int   save_struct(char *, unsigned int);
@@ -123,6 +132,23 @@ extern int node_delete_db(struct pbsnode *);
 extern int node_recov_db_raw(void *, pbs_list_head *);
 extern int save_attr_db(pbs_db_conn_t *, pbs_db_attr_info_t *,	struct attribute_def *, struct attribute *, int , int);
 extern int recov_attr_db(pbs_db_conn_t *, void *, pbs_db_attr_info_t *, struct attribute_def *, struct attribute *, int , int);
+extern int find_stat_attr(struct attribute_def *, char *, int, int);
+extern int svrcached(struct attribute *, pbs_list_head *, struct attribute_def *);
+
+/* lists of jobs kept by the server, see next_job_in_list() */
+enum job_list {
+	JOB_LIST_ALL,		/* svr_alljobs */
+	JOB_LIST_QUEUE,		/* qu_jobs */
+	JOB_LIST_STATE,		/* svr_jobs_bystate[] */
+	JOB_LIST_QUEUE_STATE,	/* qu_jobs_bystate[] */
+	JOB_LIST_OWNER,		/* find_owner_jobs() */
+	JOB_LIST_ACTIVE,	/* svr_actjobs */
+	JOB_LIST_QUEUE_ACTIVE	/* qu_actjobs */
+};
+extern void svr_jobindex_link(job *, int);
+extern void svr_jobindex_unlink(job *, int);
+extern job *next_job_in_list(job *, enum job_list);
+extern pbs_list_head *find_owner_jobs(char *, int *);
 extern int svr_migrate_data_from_fs(void);
 extern int pbsd_init(int);
 extern int setup_nodes_fs(int);
@@ -146,9 +172,12 @@ extern void reply_preempt_jobs_request(int code, int aux, struct job *pjob);
 extern int find_prov_vnode_list(job *pjob, exec_vnode_listtype *prov_vnodes, char **aoe_name);
 #endif	/* _PROVISION_H */
 
-#if !defined(PBS_MOM) && defined(_AVLTREE_H)
-extern AVL_IX_DESC *AVL_jctx;
-extern AVL_IX_REC  *svr_avlkey_create(const char *keystr);
+#if !defined(PBS_MOM) && defined(_NAME_IDX_H)
+extern name_idx *jobs_idx;
+extern name_idx *resvs_idx;
+extern name_idx *queues_idx;
+extern name_idx *nodes_idx;
+extern void svr_name_idx_oper(name_idx **, char *, void *, int);
 #endif
 
 #ifdef	_RESERVATION_H
@@ -200,6 +229,7 @@ extern int   numindex_to_offset(job *parent, int iindx);
 #ifndef PBS_MOM
 extern void svr_setjob_histinfo(job *pjob, histjob_type type);
 extern void svr_histjob_update(job *pjob, int newstate, int newsubstate);
+extern void svr_histjob_link(job *pjob);
 extern char *form_attr_comment(const char *template, const char *execvnode);
 extern void complete_running(job *);
 extern void am_jobs_add(job *);
@@ -229,6 +259,10 @@ extern void dup_br_for_subjob(struct batch_request *opreq, job *pjob, void (*fun
 extern void set_old_nodes(job *);
 extern int   send_job_exec_update_to_mom(job *, char *, int, struct batch_request *);
 extern int   free_sister_vnodes(job *, char *, char *, int, struct batch_request *);
+extern int   stat_filter_build(struct batch_request *, int *);
+extern int   stat_filter_job(struct batch_request *, job *);
+extern int   stat_filter_subjob(struct batch_request *, job *, int);
+extern void  stat_filter_free(struct batch_request *);
 #ifdef	_WORK_TASK_H
 extern int   send_job(job *, pbs_net_t, int, int, void (*x)(struct work_task *), struct batch_request *);
 extern int   relay_to_mom(job *, struct batch_request *, void (*)(struct work_task *));
@@ -273,6 +307,7 @@ extern void  req_shutdown(struct batch_request *preq);
 extern void  req_signaljob(struct batch_request *preq);
 extern void  req_mvjobfile(struct batch_request *preq);
 extern void  req_stat_node(struct batch_request *preq);
+extern void  stat_cache_save(struct batch_request *preq, char *data, size_t len);
 extern void  req_track(struct batch_request *preq);
 extern void  req_stagein(struct batch_request *preq);
 extern void  req_resvSub(struct batch_request *);
@@ -315,7 +350,7 @@ extern int   job_set_wait(attribute *pattr, void *pjob, int mode);
 #ifdef	_QUEUE_H
 extern int   chk_resc_limits(attribute *, pbs_queue *);
 extern int   set_resc_deflt(void *, int, pbs_queue *);
-extern void  queue_route(pbs_queue *);
+extern int   queue_route(pbs_queue *);
 extern int   que_purge(pbs_queue *pque);
 #endif	/* _QUEUE_H */
 #endif	/* _ATTRIBUTE_H */
@@ -412,6 +447,7 @@ struct	stat_cntl { /* used in req_stat_job */
 
 extern  int 	status_job(job *, struct batch_request *, svrattrl  *, pbs_list_head *, int *);
 extern  int 	status_subjob(job *, struct batch_request *, svrattrl  *, int, pbs_list_head *, int *);
+extern  void	update_job_mod_seq(job *);
 extern	int	stat_to_mom(job *, struct stat_cntl *);
 
 #endif	/* STAT_CNTL */
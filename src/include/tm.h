@@ -97,6 +97,15 @@ tm_spawn(int		 argc,
 	tm_task_id	*tid,
 	tm_event_t	*event);
 
+int
+tm_spawn_multi(int		 argc,
+	char		*argv[],
+	char		*envp[],
+	int		nwhere,
+	tm_node_id	*where,
+	tm_task_id	*tids,
+	tm_event_t	*events);
+
 int
 tm_kill(tm_task_id	tid,
 	int		sig,
@@ -51,6 +51,7 @@
 #include "attribute.h"
 #include "resource.h"
 #include "pbs_error.h"
+#include "name_idx.h"
 
 
 /**
@@ -121,8 +122,10 @@ decode_resc(struct attribute *patr, char *name, char *rescn, char *val)
 		return (PBSE_INTERNAL);
 	if (rescn == NULL)
 		return (PBSE_UNKRESC);
-	if (!(patr->at_flags & ATR_VFLAG_SET))
+	if (!(patr->at_flags & ATR_VFLAG_SET)) {
 		CLEAR_HEAD(patr->at_val.at_list);
+		patr->at_val.at_resc.rl_idx = NULL;
+	}
 
 
 	prdef = find_resc_def(svr_resc_def, rescn, svr_resc_size);
@@ -445,10 +448,103 @@ free_resc(attribute *pattr)
 		(void)free(pr);
 		pr = next;
 	}
+	free(pattr->at_val.at_resc.rl_idx);
 	free_null(pattr);
 	CLEAR_HEAD(pattr->at_val.at_list);
 }
 
+/**
+ * @brief
+ * 	update_resc_svrcache - drop the cached status encoding of the entries
+ *	of a resource list that changed since it was last looked at.
+ *
+ *	A change to the list as a whole (ATR_MOD_STATUS on the attribute)
+ *	drops every entry, as the entries of a copied list are not flagged.
+ *	The ATR_VFLAG_MODCACHE of the entries is cleared, the flags of the
+ *	attribute are left to the caller.
+ *
+ * @param[in] pattr - pointer to attribute structure of type resource
+ *
+ * @return	int
+ * @retval	1	an entry had changed
+ * @retval	0	no entry had changed
+ *
+ */
+
+int
+update_resc_svrcache(attribute *pattr)
+{
+	resource *pr;
+	int	  all;
+	int	  changed = 0;
+
+	all = pattr->at_flags & ATR_MOD_STATUS;
+	for (pr = (resource *)GET_NEXT(pattr->at_val.at_list);
+		pr != NULL;
+		pr = (resource *)GET_NEXT(pr->rs_link)) {
+		if (all || (pr->rs_value.at_flags & ATR_VFLAG_MODCACHE)) {
+			if (pr->rs_value.at_flags & ATR_VFLAG_MODCACHE)
+				changed = 1;
+			free_svrcache(&pr->rs_value);
+			pr->rs_value.at_flags &= ~ATR_VFLAG_MODCACHE;
+		}
+	}
+	return (changed);
+}
+
+/*
+ * Name index of the resource definition list built by index_resc_def().
+ * It is used only while the list head and size it was built for are the
+ * ones passed to find_resc_def().
+ */
+static name_idx *resc_def_idx = NULL;
+static resource_def *resc_def_idx_head = NULL;
+static int resc_def_idx_size = 0;
+
+/**
+ * @brief
+ * 	index_resc_def - (re)build the name index of a resource_def list.
+ *	A daemon calls it again each time resources are defined or deleted.
+ *
+ * @param[in] rscdf - address of the first resource_def of the list
+ * @param[in] limit - number of members in the list
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	out of memory; find_resc_def() scans the list
+ *
+ * @par MT-safe: No
+ */
+int
+index_resc_def(resource_def *rscdf, int limit)
+{
+	name_idx *idx;
+	resource_def *prdef;
+	int i;
+
+	free_name_idx(resc_def_idx);
+	resc_def_idx = NULL;
+	resc_def_idx_head = NULL;
+	resc_def_idx_size = 0;
+
+	if ((idx = create_name_idx_nocase()) == NULL)
+		return -1;
+	for (i = 0, prdef = rscdf; i < limit && prdef != NULL;
+		i++, prdef = prdef->rs_next) {
+		/* a later definition of the same name is never found by a scan */
+		if (find_name_idx(idx, prdef->rs_name) != NULL)
+			continue;
+		if (name_idx_add_del(idx, prdef->rs_name, prdef, NAME_IDX_OP_ADD) != 0) {
+			free_name_idx(idx);
+			return -1;
+		}
+	}
+	resc_def_idx = idx;
+	resc_def_idx_head = rscdf;
+	resc_def_idx_size = limit;
+	return 0;
+}
+
 /**
  * @brief
  * 	find_resc_def - find the resource_def structure for a resource with
@@ -470,6 +566,10 @@ find_resc_def(resource_def *rscdf, char *name, int limit)
 	if (rscdf == NULL || name == NULL)
 		return NULL;
 
+	if ((resc_def_idx != NULL) && (rscdf == resc_def_idx_head) &&
+		(limit == resc_def_idx_size))
+		return ((resource_def *)find_name_idx(resc_def_idx, name));
+
 	while (limit--) {
 		if (strcasecmp(rscdf->rs_name, name) == 0)
 			return (rscdf);
@@ -519,6 +619,87 @@ is_builtin(resource_def *rscdef)
 	return -1;
 }
 
+/**
+ * @brief
+ * 	build_resc_index - build the index of a resource list once the list
+ *	holds RESC_INDEX_MIN entries.  The list is left without an index if
+ *	it is not in name order or if memory is short, it is then searched
+ *	entry by entry.
+ *
+ * @param[in] pattr - pointer to attribute structure
+ *
+ * @return	Void
+ *
+ */
+
+static void
+build_resc_index(attribute *pattr)
+{
+	resc_index *pidx;
+	resource *pr;
+	resource *prev = NULL;
+	int n = 0;
+
+	pr = (resource *)GET_NEXT(pattr->at_val.at_list);
+	while (pr != NULL) {
+		if ((prev != NULL) &&
+			(strcasecmp(prev->rs_defin->rs_name, pr->rs_defin->rs_name) >= 0))
+			return;
+		n++;
+		prev = pr;
+		pr = (resource *)GET_NEXT(pr->rs_link);
+	}
+	if (n < RESC_INDEX_MIN)
+		return;
+
+	pidx = (resc_index *)malloc(sizeof(resc_index) +
+		(2 * n - 1) * sizeof(resource *));
+	if (pidx == NULL)
+		return;
+	pidx->rix_size = 2 * n;
+	pidx->rix_nent = 0;
+	pr = (resource *)GET_NEXT(pattr->at_val.at_list);
+	while (pr != NULL) {
+		pidx->rix_ent[pidx->rix_nent++] = pr;
+		pr = (resource *)GET_NEXT(pr->rs_link);
+	}
+	pattr->at_val.at_resc.rl_idx = pidx;
+}
+
+/**
+ * @brief
+ * 	resc_index_pos - binary search of a resource list index by name
+ *
+ * @param[in] pidx - the index
+ * @param[in] name - resource name
+ *
+ * @return	int
+ * @retval	>=0	position of the entry named name
+ * @retval	<0	-(position at which such an entry would go) - 1
+ *
+ */
+
+static int
+resc_index_pos(resc_index *pidx, char *name)
+{
+	int lo = 0;
+	int hi = pidx->rix_nent - 1;
+	int mid;
+	int i;
+
+	while (lo <= hi) {
+		mid = (lo + hi) / 2;
+		i = strcasecmp(pidx->rix_ent[mid]->rs_defin->rs_name, name);
+		if (i == 0)
+			return mid;
+		else if (i < 0)
+			lo = mid + 1;
+		else
+			hi = mid - 1;
+	}
+	return (-lo - 1);
+}
+
 /**
  * @brief
  * 	find_resc_entry - find a resource (value) entry in a list headed in
@@ -537,6 +718,17 @@ resource *
 find_resc_entry(attribute *pattr, resource_def *rscdf)
 {
 	resource *pr;
+	resc_index *pidx;
+	int i;
+
+	if ((pidx = pattr->at_val.at_resc.rl_idx) != NULL) {
+		i = resc_index_pos(pidx, rscdf->rs_name);
+		if (i < 0)
+			return NULL;
+		if (pidx->rix_ent[i]->rs_defin == rscdf)
+			return (pidx->rix_ent[i]);
+		/* an entry of another definition of that name, search the list */
+	}
 
 	pr = (resource *)GET_NEXT(pattr->at_val.at_list);
 	while (pr != NULL) {
@@ -569,15 +761,22 @@ add_resource_entry(attribute *pattr, resource_def *prdef)
 	int 		 i;
 	resource	*new;
 	resource	*pr;
+	resc_index	*pidx;
 
-	pr = (resource *)GET_NEXT(pattr->at_val.at_list);
-	while (pr != NULL) {
-		i = strcasecmp(pr->rs_defin->rs_name, prdef->rs_name);
-		if (i == 0)	/* found a matching entry */
-			return (pr);
-		else if (i > 0)
-			break;
-		pr = (resource *)GET_NEXT(pr->rs_link);
+	if ((pidx = pattr->at_val.at_resc.rl_idx) != NULL) {
+		i = resc_index_pos(pidx, prdef->rs_name);
+		if (i >= 0)	/* found a matching entry */
+			return (pidx->rix_ent[i]);
+	} else {
+		pr = (resource *)GET_NEXT(pattr->at_val.at_list);
+		while (pr != NULL) {
+			i = strcasecmp(pr->rs_defin->rs_name, prdef->rs_name);
+			if (i == 0)	/* found a matching entry */
+				return (pr);
+			else if (i > 0)
+				break;
+			pr = (resource *)GET_NEXT(pr->rs_link);
+		}
 	}
 	new = (resource *)malloc(sizeof(resource));
 	if (new == NULL) {
@@ -592,13 +791,111 @@ add_resource_entry(attribute *pattr, resource_def *prdef)
 	new->rs_value.at_priv_encoded = 0;
 	prdef->rs_free(&new->rs_value);
 
+	link_resource_entry(pattr, new);
+	pattr->at_flags |= ATR_VFLAG_SET | ATR_VFLAG_MODIFY | ATR_VFLAG_MODCACHE;
+	return (new);
+}
+
+/**
+ * @brief
+ * 	link_resource_entry - link a resource entry that is in no list into
+ *	the resource list headed in an attribute, at its place in the name
+ *	order of the list, and into the index of the list
+ *
+ * @param[in] pattr - pointer to attribute structure
+ * @param[in] prsc - the resource entry
+ *
+ * @return	Void
+ *
+ */
+
+void
+link_resource_entry(attribute *pattr, resource *prsc)
+{
+	int		 i = 0;
+	resource	*pr = NULL;
+	resc_index	*pidx;
+	resc_index	*pnew;
+
+	if ((pidx = pattr->at_val.at_resc.rl_idx) != NULL) {
+		i = resc_index_pos(pidx, prsc->rs_defin->rs_name);
+		if (i < 0)
+			i = -i - 1;
+		if (i < pidx->rix_nent)
+			pr = pidx->rix_ent[i];
+	} else {
+		pr = (resource *)GET_NEXT(pattr->at_val.at_list);
+		while (pr != NULL) {
+			if (strcasecmp(pr->rs_defin->rs_name,
+				prsc->rs_defin->rs_name) >= 0)
+				break;
+			pr = (resource *)GET_NEXT(pr->rs_link);
+		}
+	}
+
 	if (pr != NULL) {
-		insert_link(&pr->rs_link, &new->rs_link, new, LINK_INSET_BEFORE);
+		insert_link(&pr->rs_link, &prsc->rs_link, prsc, LINK_INSET_BEFORE);
 	} else {
-		append_link(&pattr->at_val.at_list, &new->rs_link, new);
+		append_link(&pattr->at_val.at_list, &prsc->rs_link, prsc);
 	}
-	pattr->at_flags |= ATR_VFLAG_SET | ATR_VFLAG_MODIFY | ATR_VFLAG_MODCACHE;
-	return (new);
+
+	if (pidx == NULL) {
+		build_resc_index(pattr);
+		return;
+	}
+	if (pidx->rix_nent == pidx->rix_size) {
+		pnew = (resc_index *)realloc(pidx, sizeof(resc_index) +
+			(2 * pidx->rix_size - 1) * sizeof(resource *));
+		if (pnew == NULL) {
+			/* search the list instead */
+			free(pidx);
+			pattr->at_val.at_resc.rl_idx = NULL;
+			return;
+		}
+		pidx = pnew;
+		pidx->rix_size *= 2;
+		pattr->at_val.at_resc.rl_idx = pidx;
+	}
+	memmove(&pidx->rix_ent[i + 1], &pidx->rix_ent[i],
+		(pidx->rix_nent - i) * sizeof(resource *));
+	pidx->rix_ent[i] = prsc;
+	pidx->rix_nent++;
+}
+
+/**
+ * @brief
+ * 	unlink_resource_entry - unlink a resource entry from the resource list
+ *	headed in an attribute and from the index of the list.  The entry
+ *	itself is not freed.
+ *
+ * @param[in] pattr - pointer to attribute structure
+ * @param[in] prsc - the resource entry
+ *
+ * @return	Void
+ *
+ */
+
+void
+unlink_resource_entry(attribute *pattr, resource *prsc)
+{
+	int		 i;
+	resc_index	*pidx;
+
+	if ((pidx = pattr->at_val.at_resc.rl_idx) != NULL) {
+		i = resc_index_pos(pidx, prsc->rs_defin->rs_name);
+		if ((i < 0) || (pidx->rix_ent[i] != prsc)) {
+			for (i = 0; i < pidx->rix_nent; i++) {
+				if (pidx->rix_ent[i] == prsc)
+					break;
+			}
+		}
+		if (i < pidx->rix_nent) {
+			memmove(&pidx->rix_ent[i], &pidx->rix_ent[i + 1],
+				(pidx->rix_nent - i - 1) * sizeof(resource *));
+			pidx->rix_nent--;
+		}
+	}
+	delete_link(&prsc->rs_link);
 }
 
 /**
@@ -49,6 +49,7 @@
 #include "list_link.h"
 #include "attribute.h"
 #include "pbs_error.h"
+#include "libutil.h"
 
 
 /**
@@ -312,3 +313,86 @@ decode_jobname(attribute *patr, char *name, char *rescn, char *val)
 	}
 	return (decode_str(patr, name, rescn, val));
 }
+
+/**
+ * @brief
+ *	Special function that expands a host or vnode list of a job condensed
+ *	by encode_vnode_list() before calling decode_str
+ *
+ * @param[in] patr - attribute structure
+ * @param[in] name - attribute name
+ * @param[in] rescn - resource name - unused here
+ * @param[in] val - attribute value
+ *
+ * @return  int
+ * @retval  0 if 0k
+ * @retval  >0 error number if error
+ *
+ */
+
+int
+decode_vnode_list(attribute *patr, char *name, char *rescn, char *val)
+{
+	char	*expanded;
+	int	rc;
+
+	if ((val == NULL) || (*val != VNODE_LIST_CONDENSED))
+		return (decode_str(patr, name, rescn, val));
+
+	if ((expanded = expand_vnode_list(val)) == NULL)
+		return (PBSE_BADATVAL);
+	rc = decode_str(patr, name, rescn, expanded);
+	free(expanded);
+	return (rc);
+}
+
+/**
+ * @brief
+ *	Encode a host or vnode list of a job, exec_vnode, exec_host or
+ *	schedselect.  For the database the list is condensed into numeric
+ *	ranges by condense_vnode_list(), so a wide job stores
+ *	"%(n[0001-4000]:ncpus=64)" instead of 4000 chunks.  Any other mode
+ *	encodes the list as is, see encode_str().
+ *
+ * @param[in] attr - ptr to attribute to encode
+ * @param[in] phead - ptr to head of attrlist list
+ * @param[in] atname - attribute name
+ * @param[in] rsname - resource name or null
+ * @param[in] mode - encode mode
+ * @param[out] rtnl - ptr to svrattrl
+ *
+ * @return int
+ * @retval >0 if ok, entry created and linked into list
+ * @retval =0 no value to encode, entry not created
+ * @retval -1 if error
+ *
+ */
+
+int
+encode_vnode_list(attribute *attr, pbs_list_head *phead, char *atname, char *rsname, int mode, svrattrl **rtnl)
+{
+	svrattrl *pal;
+	char *condensed;
+
+	if ((mode != ATR_ENCODE_DB) || !attr || !(attr->at_flags & ATR_VFLAG_SET) ||
+		((condensed = condense_vnode_list(attr->at_val.at_str)) == NULL))
+		return (encode_str(attr, phead, atname, rsname, mode, rtnl));
+
+	pal = attrlist_create(atname, rsname, (int)strlen(condensed)+1);
+	if (pal == NULL) {
+		free(condensed);
+		return (-1);
+	}
+	(void)strcpy(pal->al_value, condensed);
+	free(condensed);
+	pal->al_flags = attr->at_flags;
+	if (phead)
+		append_link(phead, &pal->al_link, pal);
+	if (rtnl)
+		*rtnl = pal;
+
+	if ((phead == NULL) && (rtnl == NULL))
+		free(pal);
+
+	return (1);
+}
@@ -49,6 +49,7 @@
 #include "attribute.h"
 #include "pbs_error.h"
 #include "libpbs.h"
+#include "name_idx.h"
 
 /**
  * @file	attr_func.c
@@ -57,8 +58,12 @@
  *
  * @par Included are:
  *	clear_attr()
+ *	index_attr_def()
+ *	move_list_attr()
  *	find_attr()
  *	free_null()
+ *	clear_mod_status()
+ *	clear_mod_save()
  *	attrlist_alloc()
  *	attrlist_create()
  *	free_attrlist()
@@ -109,12 +114,97 @@ clear_attr(attribute *pattr, struct attribute_def *pdef)
 		CLEAR_HEAD(pattr->at_val.at_list);
 }
 
+/*
+ * Name indexes of the attribute definition arrays registered with
+ * index_attr_def().  They are built by a daemon before it starts any
+ * thread and only read afterwards.
+ */
+#define ATTR_DEF_IDX_MAX 16
+static struct attr_def_idx {
+	struct attribute_def	*adi_def;	/* the definition array */
+	int			 adi_limit;	/* number of entries indexed */
+	name_idx		*adi_idx;	/* name to definition */
+} attr_def_idx[ATTR_DEF_IDX_MAX];
+static int attr_def_nidx = 0;
+
+/**
+ * @brief
+ * 	move_list_attr - move the value of a list (ATR_TYPE_LIST or
+ *	ATR_TYPE_RESC) attribute to another attribute whose list is empty,
+ *	along with the index of a resource list
+ *
+ * @param[in] from - attribute whose list is moved, left empty
+ * @param[in] to - attribute receiving the list
+ *
+ * @return	Void
+ *
+ */
+void
+move_list_attr(attribute *from, attribute *to)
+{
+	list_move(&from->at_val.at_list, &to->at_val.at_list);
+	if (from->at_type == ATR_TYPE_RESC) {
+		to->at_val.at_resc.rl_idx = from->at_val.at_resc.rl_idx;
+		from->at_val.at_resc.rl_idx = NULL;
+	}
+}
+
+/**
+ * @brief
+ * 	index_attr_def - index an array of attribute definitions by name so
+ *	that find_attr() on it does not scan it
+ *
+ * @param[in] attr_def - ptr to attribute definitions
+ * @param[in] limit - size of def array
+ *
+ * @return	int
+ * @retval	0	success, or the array is already indexed
+ * @retval	-1	out of memory or no room for another index; find_attr()
+ *			keeps scanning the array
+ *
+ * @par MT-safe: No
+ */
+int
+index_attr_def(struct attribute_def *attr_def, int limit)
+{
+	name_idx *idx;
+	int i;
+
+	for (i = 0; i < attr_def_nidx; i++) {
+		if (attr_def_idx[i].adi_def == attr_def)
+			return 0;
+	}
+	if (attr_def_nidx == ATTR_DEF_IDX_MAX)
+		return -1;
+
+	if ((idx = create_name_idx_nocase()) == NULL)
+		return -1;
+	for (i = 0; i < limit; i++) {
+		if (attr_def[i].at_name == NULL)
+			continue;
+		/* a later definition of the same name is never found by a scan */
+		if (find_name_idx(idx, attr_def[i].at_name) != NULL)
+			continue;
+		if (name_idx_add_del(idx, attr_def[i].at_name, &attr_def[i],
+			NAME_IDX_OP_ADD) != 0) {
+			free_name_idx(idx);
+			return -1;
+		}
+	}
+	attr_def_idx[attr_def_nidx].adi_def = attr_def;
+	attr_def_idx[attr_def_nidx].adi_limit = limit;
+	attr_def_idx[attr_def_nidx].adi_idx = idx;
+	attr_def_nidx++;
+	return 0;
+}
+
 /**
  * @brief
  * 	find_attr - find attribute definition by name
  *
  *	Searches array of attribute definition strutures to find one
- *	whose name matches the requested name.
+ *	whose name matches the requested name.  Arrays indexed with
+ *	index_attr_def() are looked up in their index.
  *
  * @param[in] attr_def - ptr to attribute definitions
  * @param[in] name - attribute name to find
@@ -130,8 +220,19 @@ int
 find_attr(struct attribute_def *attr_def, char *name, int limit)
 {
 	int index;
+	struct attribute_def *pdef;
 
 	if (attr_def) {
+		for (index = 0; index < attr_def_nidx; index++) {
+			if (attr_def_idx[index].adi_def != attr_def)
+				continue;
+			if ((limit > attr_def_idx[index].adi_limit) || (name == NULL))
+				break;
+			pdef = find_name_idx(attr_def_idx[index].adi_idx, name);
+			if ((pdef == NULL) || (pdef - attr_def >= limit))
+				return (-1);
+			return (pdef - attr_def);
+		}
 		for (index = 0; index < limit; index++) {
 			if (!strcasecmp(attr_def->at_name, name))
 				return (index);
@@ -141,6 +242,45 @@ find_attr(struct attribute_def *attr_def, char *name, int limit)
 	return (-1);
 }
 
+/**
+ * @brief
+ * 	clear_mod_status - the status cache has seen the change of an attribute,
+ *	if the database save has not seen it yet mark it for the save.
+ *
+ * @param[in,out] attr - pointer to attribute structure
+ *
+ * @return	Void
+ *
+ */
+
+void
+clear_mod_status(struct attribute *attr)
+{
+	if (attr->at_flags & ATR_VFLAG_MODCACHE)
+		attr->at_flags |= ATR_VFLAG_MODSAVE;
+	attr->at_flags &= ~ATR_MOD_STATUS;
+}
+
+/**
+ * @brief
+ * 	clear_mod_save - the database save has written the change of an
+ *	attribute, if the status cache has not seen it yet mark it for the
+ *	status.
+ *
+ * @param[in,out] attr - pointer to attribute structure
+ *
+ * @return	Void
+ *
+ */
+
+void
+clear_mod_save(struct attribute *attr)
+{
+	if (attr->at_flags & ATR_VFLAG_MODCACHE)
+		attr->at_flags |= ATR_VFLAG_MODSTAT;
+	attr->at_flags &= ~ATR_MOD_SAVE;
+}
+
 /**
  * @brief
  * 	free_svrcache - free the cached svrattrl entries associated with an attribute
@@ -175,6 +175,9 @@ pbs_connect2mom(char *momhost)
 	connection[conn].ch_errno = 0;
 	connection[conn].ch_socket= sd;
 	connection[conn].ch_errtxt = NULL;
+	connection[conn].ch_idle = 0;
+	connection[conn].ch_pipelined = 0;
+	connection[conn].ch_server[0] = '\0';
 
 	/* setup connection level thread context */
 	if (pbs_client_thread_init_connect_context(conn) != 0) {
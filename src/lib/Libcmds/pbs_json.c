@@ -303,160 +303,237 @@ add_json_node(JsonNodeType ntype, JsonValueType vtype, JsonEscapeType esc_type,
 	return node;
 }
 
+/*
+ * Emitter state.  It lives outside generate_json() so the node list can be
+ * written out and freed piecemeal with flush_json() while a large listing
+ * is still being built, instead of holding every node until the end.
+ */
+static struct {
+	int started;	/* opening brace written */
+	int indent;
+	int prnt_comma;
+	int curnt_arr_lvl;
+	int arr_lvl[ARRAY_NESTING_LEVEL];
+} jstate;
+
 /**
  * @brief
- *	generate_json_node
- *	Takes a JsonNode type link list and file stream as an input.
- * 	Reads the link-list node by node and write the json output
- * 	on the passed file stream.
+ *	reset the emitter for the next document
  *
- * @param[in] stream - fd to which json o/p written
+ * @return	Void
+ */
+static void
+reset_json_state()
+{
+	memset(&jstate, 0, sizeof(jstate));
+}
+
+/**
+ * @brief
+ *	emit_json_node
+ *	Write one node of the list on the passed file stream.
+ *
+ * @param[in] stream - stream to which json o/p written
+ * @param[in] node - node to write
  *
  * @return	int
  * @retval	0	success
  * @retval	1	error
  *
  */
-int
-generate_json(FILE * stream) {
-	int	  indent = 0;
-	int	  prnt_comma = 0;
+static int
+emit_json_node(FILE *stream, JsonNode *node)
+{
 	int	  last_object_value = 0;
 	int	  last_array_value = 0;
-	int	 *arr_lvl = NULL;
-	int	  curnt_arr_lvl= 0;
-	JsonNode *node = NULL;
-	JsonLink *link = head;
+	int	  indent = jstate.indent;
+	int	 *arr_lvl = jstate.arr_lvl;
+	int	  curnt_arr_lvl = jstate.curnt_arr_lvl;
 
-	fprintf(stream, "{");
-	indent += 4;
-	arr_lvl = malloc(ARRAY_NESTING_LEVEL * sizeof(int*));
-	memset(arr_lvl, 0, (ARRAY_NESTING_LEVEL * sizeof(int)));
-
-	while (link) {
-		node = link->node;
-		switch (node->node_type) {
-			case JSON_OBJECT:
-				if (prnt_comma)
-					fprintf(stream, ",\n");
-				else
-					fprintf(stream, "\n");
-				if (arr_lvl[curnt_arr_lvl] == indent)
-					fprintf(stream, "%*.*s{", indent, indent, " ");
-				else
-					fprintf(stream, "%*.*s\"%s\":{", indent, indent, " ", node->key);
-				indent += 4;
-				prnt_comma = 0;
-				/*moving to next node since there's no value associated within an OBJECT type node*/
-				link = link->next;
-				continue;
-
-			case JSON_OBJECT_END:
-				last_object_value = 1;
-				break;
+	switch (node->node_type) {
+		case JSON_OBJECT:
+			if (jstate.prnt_comma)
+				fprintf(stream, ",\n");
+			else
+				fprintf(stream, "\n");
+			if (arr_lvl[curnt_arr_lvl] == indent)
+				fprintf(stream, "%*.*s{", indent, indent, " ");
+			else
+				fprintf(stream, "%*.*s\"%s\":{", indent, indent, " ", node->key);
+			jstate.indent += 4;
+			jstate.prnt_comma = 0;
+			/* there's no value associated within an OBJECT type node */
+			return 0;
 
-			case JSON_ARRAY:
-				if (prnt_comma)
-					fprintf(stream, ",\n");
-				else
-					fprintf(stream, "\n");
-				if (arr_lvl[curnt_arr_lvl] == indent)
-					fprintf(stream, "%*.*s[",indent,indent," ");
-				else
-					fprintf(stream, "%*.*s\"%s\":[", indent, indent, " ", node->key);
-				indent += 4;
-				prnt_comma = 0;
-				arr_lvl[curnt_arr_lvl+1] = indent;
-				curnt_arr_lvl++;
-				break;
+		case JSON_OBJECT_END:
+			last_object_value = 1;
+			break;
 
-			case JSON_ARRAY_END:
-				last_array_value = 1;
-				break;
+		case JSON_ARRAY:
+			if (curnt_arr_lvl + 1 >= ARRAY_NESTING_LEVEL)
+				return 1;
+			if (jstate.prnt_comma)
+				fprintf(stream, ",\n");
+			else
+				fprintf(stream, "\n");
+			if (arr_lvl[curnt_arr_lvl] == indent)
+				fprintf(stream, "%*.*s[",indent,indent," ");
+			else
+				fprintf(stream, "%*.*s\"%s\":[", indent, indent, " ", node->key);
+			indent += 4;
+			jstate.prnt_comma = 0;
+			arr_lvl[curnt_arr_lvl+1] = indent;
+			curnt_arr_lvl++;
+			break;
 
-			case JSON_VALUE:
-				break;
+		case JSON_ARRAY_END:
+			last_array_value = 1;
+			break;
 
-			default:
-				free(arr_lvl);
-				return 1;
-		}
-		switch (node->value_type) {
-			case JSON_STRING:
-				if (prnt_comma)
-					fprintf(stream, ",\n");
-				else
-					fprintf(stream, "\n");
-				if (arr_lvl[curnt_arr_lvl]==indent)
-					fprintf(stream, "%*.*s\"%s\"", indent, indent, " ", show_nonprint_chars(node->value.string));
-				else
-					fprintf(stream, "%*.*s\"%s\":\"%s\"", indent, indent, " ", node->key, show_nonprint_chars(node->value.string));
-				prnt_comma = 1;
-				break;
+		case JSON_VALUE:
+			break;
 
-			case JSON_INT:
-				if (prnt_comma)
-					fprintf(stream, ",\n");
-				else
-					fprintf(stream, "\n");
-
-				if (arr_lvl[curnt_arr_lvl] == indent)
-					fprintf(stream, "%*.*s%ld",indent,indent," ", node->value.inumber);
-				else
-					fprintf(stream, "%*.*s\"%s\":%ld", indent, indent, " ", node->key, node->value.inumber);
-				prnt_comma = 1;
-				break;
-			case JSON_FLOAT:
-				if (prnt_comma)
-					fprintf(stream, ",\n");
-				else
-					fprintf(stream, "\n");
-
-
-				if (arr_lvl[curnt_arr_lvl] == indent)
-					fprintf(stream, "%*.*s%lf",indent,indent," ", node->value.fnumber);
-				else
-					fprintf(stream, "%*.*s\"%s\":%lf", indent, indent, " ", node->key, node->value.fnumber);
-				prnt_comma = 1;
-				break;
-			case JSON_NUMERIC:
-				if (prnt_comma)
-					fprintf(stream, ",\n");
-				else
-					fprintf(stream, "\n");
-
-				if (arr_lvl[curnt_arr_lvl] == indent)
-					fprintf(stream, "%*.*s%s", indent, indent, " ", node->value.string);      /*print the string but type remain same*/
-				else
-					fprintf(stream, "%*.*s\"%s\":%s", indent, indent, " ", node->key, node->value.string); /* print the string but type remain same*/
-				prnt_comma = 1;
-				break;
+		default:
+			return 1;
+	}
+	switch (node->value_type) {
+		case JSON_STRING:
+			if (jstate.prnt_comma)
+				fprintf(stream, ",\n");
+			else
+				fprintf(stream, "\n");
+			if (arr_lvl[curnt_arr_lvl]==indent)
+				fprintf(stream, "%*.*s\"%s\"", indent, indent, " ", show_nonprint_chars(node->value.string));
+			else
+				fprintf(stream, "%*.*s\"%s\":\"%s\"", indent, indent, " ", node->key, show_nonprint_chars(node->value.string));
+			jstate.prnt_comma = 1;
+			break;
 
+		case JSON_INT:
+			if (jstate.prnt_comma)
+				fprintf(stream, ",\n");
+			else
+				fprintf(stream, "\n");
 
-			case JSON_NULL:
-				break;
+			if (arr_lvl[curnt_arr_lvl] == indent)
+				fprintf(stream, "%*.*s%ld",indent,indent," ", node->value.inumber);
+			else
+				fprintf(stream, "%*.*s\"%s\":%ld", indent, indent, " ", node->key, node->value.inumber);
+			jstate.prnt_comma = 1;
+			break;
+		case JSON_FLOAT:
+			if (jstate.prnt_comma)
+				fprintf(stream, ",\n");
+			else
+				fprintf(stream, "\n");
 
-			default:
-				free(arr_lvl);
-				return 1;
-		}
 
-		if (last_array_value) {
-			indent -= 4;
-			fprintf(stream, "\n%*.*s]", indent, indent, " ");
-			last_array_value = 0;
-			curnt_arr_lvl--;
-			prnt_comma = 1;
-		} else if (last_object_value) {
-			indent -= 4;
-			fprintf(stream, "\n%*.*s}", indent, indent, " ");
-			last_object_value = 0;
-			prnt_comma = 1;
+			if (arr_lvl[curnt_arr_lvl] == indent)
+				fprintf(stream, "%*.*s%lf",indent,indent," ", node->value.fnumber);
+			else
+				fprintf(stream, "%*.*s\"%s\":%lf", indent, indent, " ", node->key, node->value.fnumber);
+			jstate.prnt_comma = 1;
+			break;
+		case JSON_NUMERIC:
+			if (jstate.prnt_comma)
+				fprintf(stream, ",\n");
+			else
+				fprintf(stream, "\n");
+
+			if (arr_lvl[curnt_arr_lvl] == indent)
+				fprintf(stream, "%*.*s%s", indent, indent, " ", node->value.string);      /*print the string but type remain same*/
+			else
+				fprintf(stream, "%*.*s\"%s\":%s", indent, indent, " ", node->key, node->value.string); /* print the string but type remain same*/
+			jstate.prnt_comma = 1;
+			break;
+
+
+		case JSON_NULL:
+			break;
+
+		default:
+			return 1;
+	}
+
+	if (last_array_value) {
+		indent -= 4;
+		fprintf(stream, "\n%*.*s]", indent, indent, " ");
+		curnt_arr_lvl--;
+		jstate.prnt_comma = 1;
+	} else if (last_object_value) {
+		indent -= 4;
+		fprintf(stream, "\n%*.*s}", indent, indent, " ");
+		jstate.prnt_comma = 1;
+	}
+	if (indent < 0 || curnt_arr_lvl < 0)
+		return 1;
+	jstate.indent = indent;
+	jstate.curnt_arr_lvl = curnt_arr_lvl;
+	return 0;
+}
+
+/**
+ * @brief
+ *	flush_json
+ *	Write out the nodes added so far on the passed file stream and free
+ *	them, keeping the emitter state so that more nodes can follow.
+ *	Callers producing large listings flush after each record so the
+ *	node list stays the size of one record.
+ *
+ * @param[in] stream - stream to which json o/p written
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	error, the node list is freed and the emitter reset
+ *
+ */
+int
+flush_json(FILE *stream)
+{
+	JsonLink *link;
+
+	if (!jstate.started) {
+		fprintf(stream, "{");
+		jstate.indent = 4;
+		jstate.started = 1;
+	}
+	while ((link = head) != NULL) {
+		if (emit_json_node(stream, link->node)) {
+			free_json_node_list();
+			reset_json_state();
+			return 1;
 		}
-		link = link->next;
+		head = link->next;
+		free_json_node(link->node);
+		free(link);
 	}
-	free(arr_lvl);
-	indent -= 4;
+	prev_link = NULL;
+	return 0;
+}
+
+/**
+ * @brief
+ *	generate_json_node
+ *	Takes a JsonNode type link list and file stream as an input.
+ * 	Reads the link-list node by node and write the json output
+ * 	on the passed file stream, completing any document already begun
+ *	by flush_json().
+ *
+ * @param[in] stream - fd to which json o/p written
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	error
+ *
+ */
+int
+generate_json(FILE * stream) {
+	int	indent;
+
+	if (flush_json(stream))
+		return 1;
+	indent = jstate.indent - 4;
+	reset_json_state();
 	if (indent != 0)
 		return 1;
 	fprintf(stream, "\n}\n");
@@ -61,6 +61,7 @@ extern "C" {
 #include <netinet/in.h>
 #ifndef WIN32
 #include <sys/types.h>
+#include <sys/time.h>
 #include <inttypes.h>
 #endif
 #include "net_connect.h"
@@ -102,6 +103,10 @@ typedef unsigned __int64 uint64_t;
 #define STMT_INSERT_JOBSCR  "insert_jobscr"
 #define STMT_SELECT_JOBSCR  "select_jobscr"
 #define STMT_DELETE_JOBSCR  "delete_jobscr"
+#define STMT_REF_JOBSCR  "ref_jobscr"
+#define STMT_INSERT_JOBSCR_DATA  "insert_jobscr_data"
+#define STMT_UNREF_JOBSCR  "unref_jobscr"
+#define STMT_PRUNE_JOBSCR  "prune_jobscr"
 
 
 
@@ -314,6 +319,7 @@ int pg_db_prepare_sched_sqls(pbs_db_conn_t *conn);
 int pg_db_prepare_que_sqls(pbs_db_conn_t *conn);
 
 void pg_set_error(pbs_db_conn_t *conn, char *msg1, char *msg2);
+void pg_db_add_time(pbs_db_conn_t *conn, struct timeval *start);
 int
 pg_prepare_stmt(pbs_db_conn_t *conn, char *stmt, char *sql,
 	int num_vars);
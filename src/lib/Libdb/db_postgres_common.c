@@ -54,6 +54,7 @@
 #include <sys/wait.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
@@ -108,6 +109,24 @@ pg_set_error(pbs_db_conn_t *conn, char *fnc, char *msg)
 #endif
 }
 
+/**
+ * @brief
+ *	Add the time elapsed since start to the time the connection has
+ *	spent executing statements, see conn_db_usec.
+ *
+ * @param[in]	conn - The connnection handle
+ * @param[in]	start - when the statement was sent
+ */
+void
+pg_db_add_time(pbs_db_conn_t *conn, struct timeval *start)
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	conn->conn_db_usec += (now.tv_sec - start->tv_sec) * 1000000LL +
+		(now.tv_usec - start->tv_usec);
+}
+
 
 /**
  * @brief
@@ -163,7 +182,9 @@ pg_db_cmd(pbs_db_conn_t *conn, char *stmt, int num_vars)
 {
 	PGresult *res;
 	char *rows_affected = NULL;
+	struct timeval start;
 
+	gettimeofday(&start, NULL);
 	res = PQexecPrepared((PGconn*) conn->conn_db_handle,
 		stmt,
 		num_vars,
@@ -171,6 +192,7 @@ pg_db_cmd(pbs_db_conn_t *conn, char *stmt, int num_vars)
 		((pg_conn_data_t *) conn->conn_data)->paramLengths,
 		((pg_conn_data_t *) conn->conn_data)->paramFormats,
 		0);
+	pg_db_add_time(conn, &start);
 	if (PQresultStatus(res) != PGRES_COMMAND_OK) {
 		pg_set_error(conn, "Execution of Prepared statement", stmt);
 		PQclear(res);
@@ -209,6 +231,9 @@ int
 pg_db_query(pbs_db_conn_t *conn, char *stmt, int num_vars,
 	PGresult **res)
 {
+	struct timeval start;
+
+	gettimeofday(&start, NULL);
 	*res = PQexecPrepared((PGconn*) conn->conn_db_handle,
 		stmt,
 		num_vars,
@@ -216,6 +241,7 @@ pg_db_query(pbs_db_conn_t *conn, char *stmt, int num_vars,
 		((pg_conn_data_t *) conn->conn_data)->paramLengths,
 		((pg_conn_data_t *) conn->conn_data)->paramFormats,
 		conn->conn_result_format);
+	pg_db_add_time(conn, &start);
 
 	if (PQresultStatus(*res) != PGRES_TUPLES_OK) {
 		pg_set_error(conn, "Execution of Prepared statement", stmt);
@@ -830,11 +856,14 @@ int pg_db_cmd_ret(pbs_db_conn_t *conn, char *stmt, int num_vars)
 {
 	PGresult *res;
 	char *rows_affected = NULL;
+	struct timeval start;
 
+	gettimeofday(&start, NULL);
 	res = PQexecPrepared((PGconn*) conn->conn_db_handle, stmt, num_vars,
 			((pg_conn_data_t *) conn->conn_data)->paramValues,
 			((pg_conn_data_t *) conn->conn_data)->paramLengths,
 			((pg_conn_data_t *) conn->conn_data)->paramFormats, 0);
+	pg_db_add_time(conn, &start);
 
 	if (PQresultStatus(res) != PGRES_COMMAND_OK) {
 		pg_set_error(conn, "Execution of Prepared statement", stmt);
@@ -395,9 +395,12 @@ int
 pbs_db_begin_trx(pbs_db_conn_t *conn, int isolation_level, int async)
 {
 	PGresult *res;
+	struct timeval start;
 
 	if (conn->conn_trx_nest == 0) {
+		gettimeofday(&start, NULL);
 		res = PQexec((PGconn *) conn->conn_db_handle, "BEGIN");
+		pg_db_add_time(conn, &start);
 		if (PQresultStatus(res) != PGRES_COMMAND_OK) {
 			pg_set_error(conn, "Transaction", "begin");
 			PQclear(res);
@@ -409,8 +412,10 @@ pbs_db_begin_trx(pbs_db_conn_t *conn, int isolation_level, int async)
 			sprintf(conn->conn_sql,
 				"SET LOCAL synchronous_commit TO OFF");
 
+			gettimeofday(&start, NULL);
 			res = PQexec((PGconn *) conn->conn_db_handle,
 				conn->conn_sql);
+			pg_db_add_time(conn, &start);
 			if (PQresultStatus(res) != PGRES_COMMAND_OK) {
 				pg_set_error(conn, "Transaction", conn->conn_sql);
 				PQclear(res);
@@ -449,6 +454,7 @@ pbs_db_end_trx(pbs_db_conn_t *conn, int commit)
 	char str[10] = "END";
 	PGresult *res;
 	int	rc = 0;
+	struct timeval start;
 
 	if (conn->conn_trx_nest == 0)
 		return 0;
@@ -460,7 +466,9 @@ pbs_db_end_trx(pbs_db_conn_t *conn, int commit)
 		if (commit == PBS_DB_ROLLBACK || conn->conn_trx_rollback == 1)
 			strcpy(str, "ROLLBACK");
 
+		gettimeofday(&start, NULL);
 		res = PQexec((PGconn *) conn->conn_db_handle, str);
+		pg_db_add_time(conn, &start);
 		if (PQresultStatus(res) != PGRES_COMMAND_OK) {
 			pg_set_error(conn, "Transaction", str);
 			PQclear(res);
@@ -497,8 +505,11 @@ pbs_db_execute_str(pbs_db_conn_t *conn, char *sql)
 	PGresult *res;
 	char *rows_affected = NULL;
 	int status;
+	struct timeval start;
 
+	gettimeofday(&start, NULL);
 	res = PQexec((PGconn*) conn->conn_db_handle, sql);
+	pg_db_add_time(conn, &start);
 	status = PQresultStatus(res);
 	if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK) {
 		pg_set_error(conn, "Execution of string statement\n", sql);
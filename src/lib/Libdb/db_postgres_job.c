@@ -45,9 +45,13 @@
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
+#include <openssl/evp.h>
 #include "pbs_db.h"
 #include "db_postgres.h"
 
+/* hex digest naming the text of a job script in pbs.job_scr_data */
+#define JOBSCR_HASH_LEN	(2 * 32)
+
 /**
  * @brief
  *	Prepare all the job related sqls. Typically called after connect
@@ -203,12 +207,44 @@ pg_db_prepare_job_sqls(pbs_db_conn_t *conn)
 	 * http://www.postgresql.org/docs/8.3/static/functions-string.html
 	 */
 	snprintf(conn->conn_sql, MAX_SQL_LENGTH, "insert into "
-		"pbs.job_scr (ji_jobid, script) "
+		"pbs.job_scr_data (scr_hash, scr_refs, script) "
+		"values "
+		"($1, 1, encode($2, 'escape'))");
+	if (pg_prepare_stmt(conn, STMT_INSERT_JOBSCR_DATA, conn->conn_sql, 2) != 0)
+		return -1;
+
+	/*
+	 * A job's row in pbs.job_scr names its script by hash; the text is
+	 * held once in pbs.job_scr_data for all jobs with that script, and
+	 * counted so it is removed with the last of them.  Rows saved before
+	 * the scripts were shared hold the text in pbs.job_scr itself.
+	 */
+	snprintf(conn->conn_sql, MAX_SQL_LENGTH, "insert into "
+		"pbs.job_scr (ji_jobid, scr_hash) "
 		"values "
-		"($1, encode($2, 'escape'))");
+		"($1, $2)");
 	if (pg_prepare_stmt(conn, STMT_INSERT_JOBSCR, conn->conn_sql, 2) != 0)
 		return -1;
 
+	snprintf(conn->conn_sql, MAX_SQL_LENGTH, "update pbs.job_scr_data "
+		"set scr_refs = scr_refs + 1 "
+		"where scr_hash = $1");
+	if (pg_prepare_stmt(conn, STMT_REF_JOBSCR, conn->conn_sql, 1) != 0)
+		return -1;
+
+	snprintf(conn->conn_sql, MAX_SQL_LENGTH, "update pbs.job_scr_data "
+		"set scr_refs = scr_refs - 1 "
+		"where scr_hash in "
+		"(select scr_hash from pbs.job_scr where ji_jobid = $1)");
+	if (pg_prepare_stmt(conn, STMT_UNREF_JOBSCR, conn->conn_sql, 1) != 0)
+		return -1;
+
+	snprintf(conn->conn_sql, MAX_SQL_LENGTH, "delete from pbs.job_scr_data "
+		"where scr_refs <= 0 and scr_hash in "
+		"(select scr_hash from pbs.job_scr where ji_jobid = $1)");
+	if (pg_prepare_stmt(conn, STMT_PRUNE_JOBSCR, conn->conn_sql, 1) != 0)
+		return -1;
+
 	/*
 	 * Use the sql decode function to decode the script parameter. Decode
 	 * using 'escape' mode. Decode considers script as encoded TEXT and
@@ -217,9 +253,11 @@ pg_db_prepare_job_sqls(pbs_db_conn_t *conn)
 	 * Refer to the following postgres link for details:
 	 * http://www.postgresql.org/docs/8.3/static/functions-string.html
 	 */
-	snprintf(conn->conn_sql, MAX_SQL_LENGTH, "select decode(script, 'escape')::bytea as script "
-		"from pbs.job_scr "
-		"where ji_jobid = $1");
+	snprintf(conn->conn_sql, MAX_SQL_LENGTH, "select "
+		"decode(coalesce(d.script, s.script), 'escape')::bytea as script "
+		"from pbs.job_scr s left join pbs.job_scr_data d "
+		"on d.scr_hash = s.scr_hash "
+		"where s.ji_jobid = $1");
 	if (pg_prepare_stmt(conn, STMT_SELECT_JOBSCR, conn->conn_sql, 1) != 0)
 		return -1;
 
@@ -586,6 +624,13 @@ pg_db_delete_job(pbs_db_conn_t *conn, pbs_db_obj_info_t *obj)
 	if ((rc = pg_db_cmd(conn, STMT_DELETE_JOB, 1)) == -1)
 		goto err;
 
+	/* release the job's hold on its script before the job's row goes */
+	if (pg_db_cmd(conn, STMT_UNREF_JOBSCR, 1) == -1)
+		goto err;
+
+	if (pg_db_cmd(conn, STMT_PRUNE_JOBSCR, 1) == -1)
+		goto err;
+
 	if (pg_db_cmd(conn, STMT_DELETE_JOBSCR, 1) == -1)
 		goto err;
 
@@ -599,10 +644,46 @@ err:
 	return -1;
 }
 
+/**
+ * @brief
+ *	Compute the hex SHA-256 digest that names a job script
+ *
+ * @param[in]	script - the script
+ * @param[in]	len    - length of script
+ * @param[out]	hash   - buffer of JOBSCR_HASH_LEN + 1 for the digest
+ *
+ * @return      Error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ *
+ */
+static int
+jobscr_hash(char *script, size_t len, char *hash)
+{
+	static char hexdigits[] = "0123456789abcdef";
+	unsigned char md[EVP_MAX_MD_SIZE];
+	unsigned int mdlen = 0;
+	unsigned int i;
+
+	if (EVP_Digest(script, len, md, &mdlen, EVP_sha256(), NULL) != 1)
+		return -1;
+	if (mdlen * 2 > JOBSCR_HASH_LEN)
+		return -1;
+	for (i = 0; i < mdlen; i++) {
+		hash[2 * i] = hexdigits[md[i] >> 4];
+		hash[2 * i + 1] = hexdigits[md[i] & 0xf];
+	}
+	hash[2 * mdlen] = '\0';
+	return 0;
+}
+
 /**
  * @brief
  *	Insert job script
  *
+ *	The text of the script is stored once for all jobs with identical
+ *	scripts, under its hash; the job's own row only names the hash.
+ *
  * @param[in]	conn - Connection handle
  * @param[in]	obj  - Job script object
  * @param[in]	savetype - Just a place holder here. Maintained the same prototype as with
@@ -617,22 +698,50 @@ int
 pg_db_save_jobscr(pbs_db_conn_t *conn, pbs_db_obj_info_t *obj, int savetype)
 {
 	pbs_db_jobscr_info_t *pscr = obj->pbs_db_un.pbs_db_jobscr;
+	char hash[JOBSCR_HASH_LEN + 1];
+	size_t len;
+	int rc;
 
-	SET_PARAM_STR(conn, pscr->ji_jobid, 0);
+	len = (pscr->script) ? strlen(pscr->script) : 0;
+	if (jobscr_hash((pscr->script) ? pscr->script : "", len, hash) != 0)
+		return -1;
 
-	/*
-	 * The script data could contain non-UTF8 characters. We therefore
-	 * consider it binary and encode it into TEXT by using the "encode"
-	 * sql function. The input data to load, therefore, is binary data
-	 * and so we use the function "LOAD_BIN" to load the parameter to
-	 * the prepared statement
-	 */
-	SET_PARAM_BIN(conn, pscr->script, (pscr->script)?strlen(pscr->script):0, 1);
+	if (pbs_db_begin_trx(conn, 0, 0) != 0)
+		goto err;
 
-	if ((pg_db_cmd(conn, STMT_INSERT_JOBSCR, 2)) != 0)
-		return -1;
+	SET_PARAM_STRSZ(conn, hash, JOBSCR_HASH_LEN, 0);
+	if ((rc = pg_db_cmd(conn, STMT_REF_JOBSCR, 1)) == -1)
+		goto err;
+
+	if (rc == 1) {
+		/* first job with this script */
+		SET_PARAM_STRSZ(conn, hash, JOBSCR_HASH_LEN, 0);
+
+		/*
+		 * The script data could contain non-UTF8 characters. We therefore
+		 * consider it binary and encode it into TEXT by using the "encode"
+		 * sql function. The input data to load, therefore, is binary data
+		 * and so we use the function "LOAD_BIN" to load the parameter to
+		 * the prepared statement
+		 */
+		SET_PARAM_BIN(conn, pscr->script, len, 1);
+
+		if (pg_db_cmd(conn, STMT_INSERT_JOBSCR_DATA, 2) != 0)
+			goto err;
+	}
+
+	SET_PARAM_STR(conn, pscr->ji_jobid, 0);
+	SET_PARAM_STRSZ(conn, hash, JOBSCR_HASH_LEN, 1);
+	if (pg_db_cmd(conn, STMT_INSERT_JOBSCR, 2) != 0)
+		goto err;
+
+	if (pbs_db_end_trx(conn, PBS_DB_COMMIT) != 0)
+		goto err;
 
 	return 0;
+err:
+	(void) pbs_db_end_trx(conn, PBS_DB_ROLLBACK);
+	return -1;
 }
 
 /**
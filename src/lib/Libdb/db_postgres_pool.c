@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+
+/**
+ * @file    db_postgres_pool.c
+ *
+ * @brief
+ *      A pool of database connections for the threads of a daemon.
+ *
+ * @par
+ *	A connection may only be used by one thread at a time, so a thread
+ *	that accesses the database besides the main one takes a connection
+ *	of its own from the pool, by calling pbs_db_pool_get().  The thread
+ *	keeps that connection until it calls pbs_db_pool_put() or exits, and
+ *	gets the same connection back on every call in between.  Connections
+ *	are made on first use, with the sqls prepared on each, and are kept
+ *	open across users.  The connect string is built for each connection
+ *	made and freed once it is connected, as for the main connection.
+ *
+ * Included functions are:
+ *	pbs_db_pool_create()
+ *	pbs_db_pool_get()
+ *	pbs_db_pool_put()
+ *	pbs_db_pool_destroy()
+ *	pool_slot_release()
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "pbs_db.h"
+#include "db_postgres.h"
+
+/* a connection of the pool, held by at most one thread */
+struct pool_slot {
+	struct pbs_db_pool	*ps_pool;
+	pbs_db_conn_t		*ps_conn;	/* NULL until first used */
+	int			 ps_inuse;
+};
+
+struct pbs_db_pool {
+	pthread_mutex_t		 pl_mutex;	/* guards ps_inuse and ps_conn */
+	pthread_key_t		 pl_key;	/* slot held by the calling thread */
+	char			*pl_host;
+	int			 pl_timeout;
+	int			 pl_size;
+	struct pool_slot	*pl_slots;
+};
+
+/**
+ * @brief
+ *	Give a slot back to its pool.  Also the destructor of the pool's
+ *	thread key, so a thread that exits holding a slot gives it back.
+ *
+ * @param[in]	arg - the slot
+ *
+ * @return	void
+ */
+static void
+pool_slot_release(void *arg)
+{
+	struct pool_slot *slot = arg;
+	pbs_db_conn_t *conn = slot->ps_conn;
+
+	/* a transaction left open by the thread must not reach the next user */
+	if (conn != NULL) {
+		while (conn->conn_trx_nest > 0)
+			(void) pbs_db_end_trx(conn, PBS_DB_ROLLBACK);
+	}
+
+	pthread_mutex_lock(&slot->ps_pool->pl_mutex);
+	slot->ps_inuse = 0;
+	pthread_mutex_unlock(&slot->ps_pool->pl_mutex);
+}
+
+/**
+ * @brief
+ *	Create a pool of database connections.  No connection is made until
+ *	a thread asks for one.
+ *
+ * @param[in]	host	- host the database runs on, as for
+ *			  pbs_db_init_connection()
+ * @param[in]	timeout	- connection timeout
+ * @param[in]	size	- most connections the pool holds
+ *
+ * @return	the pool
+ * @retval	NULL - out of memory, or size not positive
+ */
+pbs_db_pool_t *
+pbs_db_pool_create(char *host, int timeout, int size)
+{
+	pbs_db_pool_t *pool;
+	int i;
+
+	if (size <= 0)
+		return NULL;
+	if ((pool = calloc(1, sizeof(pbs_db_pool_t))) == NULL)
+		return NULL;
+	if ((pool->pl_slots = calloc(size, sizeof(struct pool_slot))) == NULL) {
+		free(pool);
+		return NULL;
+	}
+	if (host != NULL && (pool->pl_host = strdup(host)) == NULL) {
+		free(pool->pl_slots);
+		free(pool);
+		return NULL;
+	}
+	if (pthread_key_create(&pool->pl_key, pool_slot_release) != 0) {
+		free(pool->pl_host);
+		free(pool->pl_slots);
+		free(pool);
+		return NULL;
+	}
+	pthread_mutex_init(&pool->pl_mutex, NULL);
+	pool->pl_timeout = timeout;
+	pool->pl_size = size;
+	for (i = 0; i < size; i++)
+		pool->pl_slots[i].ps_pool = pool;
+	return pool;
+}
+
+/**
+ * @brief
+ *	Get the calling thread's connection from the pool, taking a free one
+ *	if the thread holds none.  A connection is made, and its sqls
+ *	prepared, on its first use, and made again if it was lost.
+ *
+ * @param[in]	pool	 - the pool
+ * @param[out]	failcode - PBS_DB_SUCCESS, or why no connection was had
+ *			   (PBS_DB_CONNFAILED if every connection is held)
+ *
+ * @return	the connection, for use by the calling thread only
+ * @retval	NULL - failure, see failcode
+ */
+pbs_db_conn_t *
+pbs_db_pool_get(pbs_db_pool_t *pool, int *failcode)
+{
+	struct pool_slot *slot;
+	pbs_db_conn_t *conn;
+	char errmsg[PBS_MAX_DB_CONN_INIT_ERR + 1];
+	int i;
+
+	*failcode = PBS_DB_SUCCESS;
+	slot = pthread_getspecific(pool->pl_key);
+	if (slot == NULL) {
+		pthread_mutex_lock(&pool->pl_mutex);
+		for (i = 0; i < pool->pl_size; i++) {
+			if (pool->pl_slots[i].ps_inuse == 0) {
+				slot = &pool->pl_slots[i];
+				slot->ps_inuse = 1;
+				break;
+			}
+		}
+		pthread_mutex_unlock(&pool->pl_mutex);
+		if (slot == NULL) {
+			*failcode = PBS_DB_CONNFAILED;
+			return NULL;
+		}
+		(void) pthread_setspecific(pool->pl_key, slot);
+	}
+
+	/* the slot is the thread's alone now, connect it outside the lock */
+	conn = slot->ps_conn;
+	if (conn != NULL && pbs_db_is_conn_ok(conn) == 0)
+		return conn;
+	if (conn != NULL) {
+		pbs_db_disconnect(conn);
+		pbs_db_destroy_connection(conn);
+		slot->ps_conn = NULL;
+	}
+
+	conn = pbs_db_init_connection(pool->pl_host, pool->pl_timeout, 0,
+		failcode, errmsg, PBS_MAX_DB_CONN_INIT_ERR);
+	if (conn == NULL) {
+		pbs_db_pool_put(pool);
+		return NULL;
+	}
+	if ((*failcode = pbs_db_connect(conn)) != PBS_DB_SUCCESS) {
+		pbs_db_destroy_connection(conn);
+		pbs_db_pool_put(pool);
+		return NULL;
+	}
+	pbs_db_free_conn_info(conn);
+	if (pbs_db_prepare_sqls(conn) != 0) {
+		pbs_db_disconnect(conn);
+		pbs_db_destroy_connection(conn);
+		pbs_db_pool_put(pool);
+		*failcode = PBS_DB_CONNFAILED;
+		return NULL;
+	}
+	slot->ps_conn = conn;
+	return conn;
+}
+
+/**
+ * @brief
+ *	Give the calling thread's connection back to the pool for another
+ *	thread.  The connection stays open.  Nothing is done if the thread
+ *	holds no connection.
+ *
+ * @param[in]	pool - the pool
+ *
+ * @return	void
+ */
+void
+pbs_db_pool_put(pbs_db_pool_t *pool)
+{
+	struct pool_slot *slot;
+
+	if ((slot = pthread_getspecific(pool->pl_key)) == NULL)
+		return;
+	(void) pthread_setspecific(pool->pl_key, NULL);
+	pool_slot_release(slot);
+}
+
+/**
+ * @brief
+ *	Close every connection of a pool and free it.  The threads using the
+ *	pool must have stopped.
+ *
+ * @param[in]	pool - the pool
+ *
+ * @return	void
+ */
+void
+pbs_db_pool_destroy(pbs_db_pool_t *pool)
+{
+	int i;
+
+	if (pool == NULL)
+		return;
+	(void) pthread_key_delete(pool->pl_key);
+	for (i = 0; i < pool->pl_size; i++) {
+		if (pool->pl_slots[i].ps_conn != NULL) {
+			pbs_db_disconnect(pool->pl_slots[i].ps_conn);
+			pbs_db_destroy_connection(pool->pl_slots[i].ps_conn);
+		}
+	}
+	pthread_mutex_destroy(&pool->pl_mutex);
+	free(pool->pl_slots);
+	free(pool->pl_host);
+	free(pool);
+}
@@ -149,6 +149,7 @@ pbs_db_truncate_all(pbs_db_conn_t *conn)
 		"pbs.queue, "
 		"pbs.resv, "
 		"pbs.job_scr, "
+		"pbs.job_scr_data, "
 		"pbs.job, "
 		"pbs.server");
 
@@ -44,13 +44,11 @@
  * @brief
  *	Routines to read and write down a stream
  */
-int (*dis_getc)(int stream)					= NULL;
-int (*dis_puts)(int stream, const char *string, size_t count)	= NULL;
-int (*dis_gets)(int stream, char *string, size_t count)	= NULL;
 
-int (*disr_skip)(int stream, size_t nskips)			= NULL;
-int (*disw_commit)(int stream, int commit)			= NULL;
-int (*disr_commit)(int stream, int commit)			= NULL;
+/*
+ * dis_getc, dis_puts, dis_gets, disr_skip, disw_commit and disr_commit are
+ * kept per thread in the thread context, see __dis_funcs_location().
+ */
 
 const char *dis_emsg[] = {"No error",
 	"Input value too large to convert to this type",
@@ -85,3 +83,156 @@ dis_init_tables(void)
 		disiui_();
 	init_ulmax();
 }
+
+/*
+ * Binary wire format (DIS_FMT_BINARY), used on streams where both ends have
+ * agreed to it, see DIS_tcp_set_fmt().  An integer is a tag byte followed by
+ * its magnitude as a little-endian integer of 0, 1, 2, 4 or 8 bytes.  The low
+ * nibble of the tag is that width, DIS_BIN_NEG is set for negative values.  A
+ * string is its length encoded that way, followed by the characters.  A
+ * floating point value keeps its Data-is-Strings coefficient, followed by
+ * the exponent as a binary integer (diswsi()).
+ */
+#define DIS_BIN_NEG	0x80
+#define DIS_BIN_WIDTH	0x0f
+
+/**
+ * @brief
+ *	Write an integer in the binary format, without committing it.
+ *
+ * @param[in] stream - stream to write to
+ * @param[in] negate - TRUE if the value is negative
+ * @param[in] value  - magnitude of the value
+ *
+ * @return	int
+ * @retval	DIS_SUCCESS	success
+ * @retval	DIS_PROTO	write failed
+ *
+ */
+int
+diswb_(int stream, int negate, u_Long value)
+{
+	unsigned char	buf[1 + sizeof(u_Long)];
+	unsigned	width;
+	unsigned	i;
+
+	if (value == 0)
+		width = 0;
+	else if (value <= 0xff)
+		width = 1;
+	else if (value <= 0xffff)
+		width = 2;
+	else if (value <= 0xffffffffUL)
+		width = 4;
+	else
+		width = 8;
+
+	buf[0] = width | (negate ? DIS_BIN_NEG : 0);
+	for (i = 1; i <= width; i++) {
+		buf[i] = value & 0xff;
+		value >>= 8;
+	}
+	if ((*dis_puts)(stream, (char *)buf, width + 1) != width + 1)
+		return (DIS_PROTO);
+	return (DIS_SUCCESS);
+}
+
+/**
+ * @brief
+ *	Read an integer in the binary format.
+ *
+ * @param[in]  stream - stream to read from
+ * @param[out] negate - set TRUE if the value is negative
+ * @param[out] value  - magnitude of the value
+ * @param[in]  max    - largest magnitude the caller can hold
+ *
+ * @return	int
+ * @retval	DIS_SUCCESS	success
+ * @retval	DIS_OVERFLOW	magnitude above max, *value set to max
+ * @retval	DIS_PROTO	malformed tag
+ * @retval	DIS_EOD/DIS_EOF	premature end of message or stream
+ *
+ */
+static int
+disrb_(int stream, int *negate, u_Long *value, u_Long max)
+{
+	unsigned char	buf[sizeof(u_Long)];
+	u_Long		locval;
+	unsigned	width;
+	int		c;
+
+	switch (c = (*dis_getc)(stream)) {
+		case -1:
+			return (DIS_EOD);
+		case -2:
+			return (DIS_EOF);
+	}
+	c &= 0xff;	/* getc hands back a plain char, tags are never 0xfe/0xff */
+	width = c & DIS_BIN_WIDTH;
+	if ((c & ~(DIS_BIN_NEG | DIS_BIN_WIDTH)) != 0 ||
+		(width != 0 && width != 1 && width != 2 && width != 4 && width != 8))
+		return (DIS_PROTO);
+	*negate = (c & DIS_BIN_NEG) != 0;
+
+	locval = 0;
+	if (width > 0) {
+		if ((*dis_gets)(stream, (char *)buf, width) != width)
+			return (DIS_EOD);
+		while (width > 0) {
+			width--;
+			locval = (locval << 8) | buf[width];
+		}
+	}
+	if (locval > max) {
+		*value = max;
+		return (DIS_OVERFLOW);
+	}
+	*value = locval;
+	return (DIS_SUCCESS);
+}
+
+/**
+ * @brief
+ *	Binary format counterpart of disrsi_(), for an unsigned magnitude.
+ *
+ * @see disrb_
+ */
+int
+disrbi_(int stream, int *negate, unsigned *value)
+{
+	u_Long	locval;
+	int	rc;
+
+	rc = disrb_(stream, negate, &locval, UINT_MAX);
+	*value = (unsigned)locval;
+	return (rc);
+}
+
+/**
+ * @brief
+ *	Binary format counterpart of disrsl_(), for an unsigned long magnitude.
+ *
+ * @see disrb_
+ */
+int
+disrbl_(int stream, int *negate, unsigned long *value)
+{
+	u_Long	locval;
+	int	rc;
+
+	rc = disrb_(stream, negate, &locval, ULONG_MAX);
+	*value = (unsigned long)locval;
+	return (rc);
+}
+
+/**
+ * @brief
+ *	Binary format counterpart of disrsll_(), for a u_Long magnitude.
+ *
+ * @see disrb_
+ */
+int
+disrbll_(int stream, int *negate, u_Long *value)
+{
+	return (disrb_(stream, negate, value, UlONG_MAX));
+}
@@ -65,6 +65,14 @@ disrsl_(int stream, int *negate, unsigned long *value,
 	unsigned long count, int recursv);
 int disrsll_(int stream,  int  *negate,  u_Long *value, unsigned long count, int recursv);
 int diswui_(int stream, unsigned value);
+int diswb_(int stream, int negate, u_Long value);
+int disrbi_(int stream, int *negate, unsigned *value);
+int disrbl_(int stream, int *negate, unsigned long *value);
+int disrbll_(int stream, int *negate, u_Long *value);
+
+/* is <stream> using the binary wire format (DIS_FMT_BINARY)? */
+#define dis_binary(stream) \
+	(dis_getfmt != NULL && (*dis_getfmt)(stream) == DIS_FMT_BINARY)
 
 extern unsigned dis_dmx10;
 extern double *dis_dp10;
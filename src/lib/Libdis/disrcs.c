@@ -96,7 +96,10 @@ disrcs(int stream, size_t *nchars, int *retval)
 	assert(dis_gets != NULL);
 	assert(disr_commit != NULL);
 
-	locret = disrsi_(stream, &negate, &count, 1, 0);
+	if (dis_binary(stream))
+		locret = disrbi_(stream, &negate, &count);
+	else
+		locret = disrsi_(stream, &negate, &count, 1, 0);
 	locret = negate ? DIS_BADSIGN : locret;
 	if (locret == DIS_SUCCESS) {
 		if (negate)
@@ -213,7 +213,10 @@ disrf(int stream, int *retval)
 
 	dval = 0.0;
 	if ((locret = disrd_(stream, 1, &ndigs, &nskips, &dval, 0)) == DIS_SUCCESS) {
-		locret = disrsi_(stream, &negate, &uexpon, 1, 0);
+		if (dis_binary(stream))
+			locret = disrbi_(stream, &negate, &uexpon);
+		else
+			locret = disrsi_(stream, &negate, &uexpon, 1, 0);
 		if (locret == DIS_SUCCESS) {
 			expon = negate ? nskips - uexpon : nskips + uexpon;
 			if (expon + (int)ndigs > FLT_MAX_10_EXP) {
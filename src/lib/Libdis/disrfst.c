@@ -94,7 +94,10 @@ disrfst(int stream, size_t achars, char *value)
 	assert(dis_gets != NULL);
 	assert(disr_commit != NULL);
 
-	locret = disrsi_(stream, &negate, &count, 1, 0);
+	if (dis_binary(stream))
+		locret = disrbi_(stream, &negate, &count);
+	else
+		locret = disrsi_(stream, &negate, &count, 1, 0);
 	if (locret == DIS_SUCCESS) {
 		if (negate)
 			locret = DIS_BADSIGN;
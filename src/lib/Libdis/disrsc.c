@@ -101,7 +101,11 @@ disrsc(int stream, int *retval)
 	assert(disr_commit != NULL);
 
 	value = 0;
-	switch (locret = disrsi_(stream, &negate, &uvalue, 1, 0)) {
+	if (dis_binary(stream))
+		locret = disrbi_(stream, &negate, &uvalue);
+	else
+		locret = disrsi_(stream, &negate, &uvalue, 1, 0);
+	switch (locret) {
 		case DIS_SUCCESS:
 			if (negate ? -uvalue >= SCHAR_MIN : uvalue <= SCHAR_MAX) {
 				value = negate ? -uvalue : uvalue;
@@ -96,7 +96,11 @@ disrsi(int stream, int *retval)
 	assert(disr_commit != NULL);
 
 	value = 0;
-	switch (locret = disrsi_(stream, &negate, &uvalue, 1, 0)) {
+	if (dis_binary(stream))
+		locret = disrbi_(stream, &negate, &uvalue);
+	else
+		locret = disrsi_(stream, &negate, &uvalue, 1, 0);
+	switch (locret) {
 		case DIS_SUCCESS:
 			if (negate ? uvalue <= (unsigned)-(INT_MIN + 1) + 1 :
 				uvalue <= (unsigned)INT_MAX) {
@@ -96,7 +96,11 @@ disrsl(int stream, int *retval)
 	assert(disr_commit != NULL);
 
 	value = 0;
-	switch (locret = disrsl_(stream, &negate, &uvalue, 1, 0)) {
+	if (dis_binary(stream))
+		locret = disrbl_(stream, &negate, &uvalue);
+	else
+		locret = disrsl_(stream, &negate, &uvalue, 1, 0);
+	switch (locret) {
 		case DIS_SUCCESS:
 			if (negate ? uvalue <= (unsigned long)-(LONG_MIN + 1) + 1 :
 				uvalue <= LONG_MAX) {
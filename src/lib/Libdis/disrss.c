@@ -96,7 +96,11 @@ short disrss(int stream, int *retval)
 	assert(disr_commit != NULL);
 
 	value = 0;
-	switch (locret = disrsi_(stream, &negate, &uvalue, 1, 0)) {
+	if (dis_binary(stream))
+		locret = disrbi_(stream, &negate, &uvalue);
+	else
+		locret = disrsi_(stream, &negate, &uvalue, 1, 0);
+	switch (locret) {
 		case DIS_SUCCESS:
 			if (negate ? -uvalue >= SHRT_MIN : uvalue <= SHRT_MAX) {
 				value = negate ? -uvalue : uvalue;
@@ -92,7 +92,10 @@ disrul(int stream, int *retval)
 
 	assert(disr_commit != NULL);
 
-	locret = disrsl_(stream, &negate, &value, 1, 0);
+	if (dis_binary(stream))
+		locret = disrbl_(stream, &negate, &value);
+	else
+		locret = disrsl_(stream, &negate, &value, 1, 0);
 	if (locret != DIS_SUCCESS) {
 		value = 0;
 	} else if (negate) {
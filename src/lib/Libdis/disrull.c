@@ -96,7 +96,10 @@ disrull(int stream, int *retval)
 	assert(disr_commit != NULL);
 	assert(retval != NULL);
 
-	locret = disrsll_(stream, &negate, &value, 1, 0);
+	if (dis_binary(stream))
+		locret = disrbll_(stream, &negate, &value);
+	else
+		locret = disrsll_(stream, &negate, &value, 1, 0);
 	if (locret != DIS_SUCCESS) {
 		value = 0;
 	} else if (negate) {
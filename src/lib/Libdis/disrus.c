@@ -97,7 +97,10 @@ unsigned short disrus(int stream, int *retval)
 	assert(retval != NULL);
 	assert(disr_commit != NULL);
 
-	locret = disrsi_(stream, &negate, &value, 1, 0);
+	if (dis_binary(stream))
+		locret = disrbi_(stream, &negate, &value);
+	else
+		locret = disrsi_(stream, &negate, &value, 1, 0);
 	if (locret != DIS_SUCCESS) {
 		value = 0;
 	} else if (negate) {
@@ -82,7 +82,10 @@ diswcs(int stream, const char *value, size_t nchars)
 	assert(dis_puts != NULL);
 	assert(nchars <= UINT_MAX);
 
-	retval = diswui_(stream, (unsigned)nchars);
+	if (dis_binary(stream))
+		retval = diswb_(stream, FALSE, nchars);
+	else
+		retval = diswui_(stream, (unsigned)nchars);
 	if (retval == DIS_SUCCESS && nchars > 0 &&
 		(*dis_puts)(stream, value, nchars) != nchars)
 		retval = DIS_PROTO;
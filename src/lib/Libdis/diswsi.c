@@ -103,6 +103,11 @@ diswsi(int stream, int value)
 		uval = value;
 		c = '+';
 	}
+	if (dis_binary(stream)) {
+		retval = diswb_(stream, c == '-', uval);
+		return (((*disw_commit)(stream, retval == DIS_SUCCESS) < 0) ?
+			DIS_NOCOMMIT : retval);
+	}
 	cp = discui_(&dis_buffer[DIS_BUFSIZ], uval, &ndigs);
 	*--cp = c;
 	while (ndigs > 1)
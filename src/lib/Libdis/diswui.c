@@ -90,7 +90,10 @@ diswui(int stream, unsigned value)
 
 	assert(disw_commit != NULL);
 
-	retval = diswui_(stream, value);
+	if (dis_binary(stream))
+		retval = diswb_(stream, FALSE, value);
+	else
+		retval = diswui_(stream, value);
 	return (((*disw_commit)(stream, retval == DIS_SUCCESS) < 0) ?
 		DIS_NOCOMMIT : retval);
 }
@@ -94,6 +94,11 @@ diswul(int stream, unsigned long value)
 	assert(dis_puts != NULL);
 	assert(disw_commit != NULL);
 
+	if (dis_binary(stream)) {
+		retval = diswb_(stream, FALSE, value);
+		return (((*disw_commit)(stream, retval == DIS_SUCCESS) < 0) ?
+			DIS_NOCOMMIT : retval);
+	}
 	cp = discul_(&dis_buffer[DIS_BUFSIZ], value, &ndigs);
 	*--cp = '+';
 	while (ndigs > 1)
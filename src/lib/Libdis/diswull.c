@@ -96,7 +96,11 @@ diswull(int stream, u_Long value)
 	assert(dis_puts != NULL);
 	assert(disw_commit != NULL);
 
-
+	if (dis_binary(stream)) {
+		retval = diswb_(stream, FALSE, value);
+		return (((*disw_commit)(stream, retval == DIS_SUCCESS) < 0) ?
+			DIS_NOCOMMIT : retval);
+	}
 	cp = discull_(&dis_buffer[DIS_BUFSIZ], value, &ndigs);
 	*--cp = '+';
 	while (ndigs > 1)
@@ -68,6 +68,7 @@
  */
 extern void dis_init_tables(void);
 extern long dis_buffsize; /* defn of DIS_BUFSZ in dis headers */
+extern void DIS_tcp_funcs(void);
 
 /**
  * @brief
@@ -171,6 +172,15 @@ static pthread_mutexattr_t attr;
 static struct pbs_client_thread_context
 pbs_client_thread_single_threaded_context;
 
+/**
+ * A worker thread of a single threaded daemon can be given a context of its
+ * own, see pbs_client_thread_init_worker_context().  The key is created
+ * once and stays unset for the daemon's main thread.
+ */
+static pthread_key_t worker_key_tls;
+static pthread_once_t worker_key_once = PTHREAD_ONCE_INIT;
+static int worker_key_created = 0;
+
 /** single threaded mode dummy function definition */
 static int
 __pbs_client_thread_lock_connection_single_threaded(int connect)
@@ -199,6 +209,11 @@ __pbs_client_thread_unlock_connection_single_threaded(int connect)
 struct pbs_client_thread_context *
 __pbs_client_thread_get_context_data_single_threaded(void)
 {
+	struct pbs_client_thread_context *p;
+
+	if (worker_key_created &&
+		((p = pthread_getspecific(worker_key_tls)) != NULL))
+		return p;
 	return &pbs_client_thread_single_threaded_context;
 }
 
@@ -379,6 +394,94 @@ pbs_client_thread_set_single_threaded_mode(void)
 		__pbs_client_thread_destroy_connect_context_single_threaded;
 }
 
+/**
+ * @brief
+ *	Create the key for the worker thread contexts, called once via
+ *	pthread_once from pbs_client_thread_init_worker_context
+ */
+static void
+__init_worker_key(void)
+{
+	if (pthread_key_create(&worker_key_tls, NULL) == 0)
+		worker_key_created = 1;
+}
+
+/**
+ * @brief
+ *	Give the calling thread of a daemon in single threaded mode a context
+ *	of its own
+ *
+ * @par Functionality:
+ *	A daemon that runs a few worker threads beside its main thread, e.g. to
+ *	read and decode requests, calls this in each worker.  The worker then
+ *	has its own dis_buffer, DIS transport routines, pbs_errno and tcp
+ *	timeout, while the main thread keeps using the global context.
+ *	The rest of the single threaded mode is unchanged: the locking
+ *	functions are still empty, so the worker must only touch the streams
+ *	it was handed.
+ *
+ * @return	int
+ * @retval	0 - success
+ * @retval	-1 - failure
+ *
+ * @par Reentrancy:
+ *	MT safe
+ */
+int
+pbs_client_thread_init_worker_context(void)
+{
+	struct pbs_client_thread_context *ptr;
+
+	if ((pthread_once(&worker_key_once, __init_worker_key) != 0) ||
+		(worker_key_created == 0))
+		return -1;
+
+	if (pthread_getspecific(worker_key_tls) != NULL)
+		return 0;
+
+	ptr = calloc(1, sizeof(struct pbs_client_thread_context));
+	if (ptr == NULL)
+		return -1;
+	ptr->th_dis_buffer = calloc(1, dis_buffsize);
+	if (ptr->th_dis_buffer == NULL) {
+		free(ptr);
+		return -1;
+	}
+	ptr->th_pbs_tcp_timeout = PBS_DIS_TCP_TIMEOUT_SHORT;
+	strcpy(ptr->th_pbs_current_user,
+		pbs_client_thread_single_threaded_context.th_pbs_current_user);
+	ptr->th_pbs_mode = 1; /* single threaded */
+
+	if (pthread_setspecific(worker_key_tls, ptr) != 0) {
+		free(ptr->th_dis_buffer);
+		free(ptr);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	Free the context set up by pbs_client_thread_init_worker_context,
+ *	called by the worker thread before it exits
+ *
+ * @return	void
+ */
+void
+pbs_client_thread_destroy_worker_context(void)
+{
+	struct pbs_client_thread_context *ptr;
+
+	if (worker_key_created == 0)
+		return;
+	ptr = pthread_getspecific(worker_key_tls);
+	if (ptr == NULL)
+		return;
+	(void)pthread_setspecific(worker_key_tls, NULL);
+	free(ptr->th_dis_buffer);
+	free(ptr);
+}
+
 
 /* following are the definitions of the actual threaded functions */
 
@@ -629,6 +732,12 @@ __pbs_client_thread_init_thread_context(void)
 		goto err;
 	}
 
+	/*
+	 * each thread has its own DIS transport routines, start with tcp as
+	 * that is what all threads shared before a connection was set up
+	 */
+	DIS_tcp_funcs();
+
 	return 0;
 
 err:
@@ -1316,6 +1425,31 @@ __dis_buffer_location(void)
 	return (p->th_dis_buffer);
 }
 
+/**
+ * @brief
+ *	Returns the address of the DIS transport routines used in dis
+ *	communication.
+ *
+ * @par Functionality:
+ *	This function returns the address of the per thread dis_funcs
+ *	from the TLS by calling @see __pbs_client_thread_get_context_data
+ *
+ * @retval	Address of the dis_funcs from TLS (success)
+ *
+ * @par Side-effects:
+ *	None
+ *
+ * @par Reentrancy:
+ *	Reentrant
+ */
+struct dis_funcs *
+__dis_funcs_location(void)
+{
+	struct pbs_client_thread_context *p =
+		pbs_client_thread_get_context_data();
+	return (&p->th_dis_funcs);
+}
+
 
 /**
  * @brief
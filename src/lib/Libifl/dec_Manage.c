@@ -54,6 +54,9 @@
  *			unsigned int	object type
  *			string		object name
  *			attropl		attributes
+ *
+ * decode_DIS_ManageMany() - decode a Manager Many Batch Request
+ * decode_DIS_DeleteJobs() - decode a Delete Jobs Batch Request
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
@@ -66,6 +69,7 @@
 #include "credential.h"
 #include "batch_request.h"
 #include "dis.h"
+#include <stdlib.h>
 /**
  * @brief
  *	-decode a Manager Batch Request
@@ -107,3 +111,102 @@ decode_DIS_Manage(int sock, struct batch_request *preq)
 	if (rc) return rc;
 	return (decode_DIS_svrattrl(sock, &preq->rq_ind.rq_manager.rq_attr));
 }
+
+/**
+ * @brief
+ *	-decode a Manager Many Batch Request
+ *
+ * @par	Data items are:\n
+ *		unsigned int	number of directives\n
+ *		for each directive, the items of a Manager request
+ *
+ * @param[in] sock - socket descriptor
+ * @param[out] preq - pointer to batch_request structure
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ */
+
+int
+decode_DIS_ManageMany(int sock, struct batch_request *preq)
+{
+	int rc;
+	int i;
+	int count;
+	struct rq_manage *pm;
+
+	preq->rq_ind.rq_managemany.count = 0;
+	preq->rq_ind.rq_managemany.rq_list = NULL;
+
+	count = disrui(sock, &rc);
+	if (rc) return rc;
+	if (count < 0)
+		return DIS_PROTO;
+
+	pm = calloc(count > 0 ? count : 1, sizeof(struct rq_manage));
+	if (pm == NULL)
+		return DIS_NOMALLOC;
+	for (i = 0; i < count; i++)
+		CLEAR_HEAD(pm[i].rq_attr);
+	preq->rq_ind.rq_managemany.rq_list = pm;
+	preq->rq_ind.rq_managemany.count = count;
+
+	for (i = 0; i < count; i++) {
+		pm[i].rq_cmd = disrui(sock, &rc);
+		if (rc) return rc;
+		pm[i].rq_objtype = disrui(sock, &rc);
+		if (rc) return rc;
+		rc = disrfst(sock, PBS_MAXSVRJOBID+1, pm[i].rq_objname);
+		if (rc) return rc;
+		if ((rc = decode_DIS_svrattrl(sock, &pm[i].rq_attr)) != 0)
+			return rc;
+	}
+	return DIS_SUCCESS;
+}
+
+/**
+ * @brief
+ *	-decode a Delete Jobs Batch Request
+ *
+ * @par	Data items are:\n
+ *		unsigned int	number of jobs\n
+ *		string		job id, for each job
+ *
+ * @param[in] sock - socket descriptor
+ * @param[out] preq - pointer to batch_request structure
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ */
+
+int
+decode_DIS_DeleteJobs(int sock, struct batch_request *preq)
+{
+	int rc;
+	int i;
+	int count;
+	struct rq_deletejobs_entry *pdj;
+
+	preq->rq_ind.rq_deletejobs.count = 0;
+	preq->rq_ind.rq_deletejobs.rq_list = NULL;
+
+	count = disrui(sock, &rc);
+	if (rc) return rc;
+	if (count < 0)
+		return DIS_PROTO;
+
+	pdj = calloc(count > 0 ? count : 1, sizeof(struct rq_deletejobs_entry));
+	if (pdj == NULL)
+		return DIS_NOMALLOC;
+	/* hang the list on the request now so free_br() cleans up after a failure */
+	preq->rq_ind.rq_deletejobs.rq_list = pdj;
+	preq->rq_ind.rq_deletejobs.count = count;
+
+	for (i = 0; i < count; i++) {
+		rc = disrfst(sock, PBS_MAXSVRJOBID+1, pdj[i].rq_jid);
+		if (rc) return rc;
+	}
+	return DIS_SUCCESS;
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include "libpbs.h"
+#include "list_link.h"
+#include "server_limits.h"
+#include "attribute.h"
+#include "credential.h"
+#include "batch_request.h"
+#include "dis.h"
+
+/**
+ * @brief Read the modify multiple jobs request.
+ *
+ * @par	Data items are:\n
+ *		unsigned int	number of jobs\n
+ *		for each job:\n
+ *			string		job id\n
+ *			svrattrl	attributes to set on the job
+ *
+ * @param[in] sock - connection identifier
+ * @param[out] preq - batch_request that the information will be read into.
+ *
+ * @return 0 - on success
+ * @return DIS error
+ */
+int
+decode_DIS_ModifyJobs(int sock, struct batch_request *preq)
+{
+	int				rc = 0;
+	int				i = 0;
+	int				count = 0;
+	struct rq_modifyjobs_entry	*pmj = NULL;
+
+	preq->rq_ind.rq_modifyjobs.count = 0;
+	preq->rq_ind.rq_modifyjobs.rq_list = NULL;
+
+	count = disrui(sock, &rc);
+	if (rc)
+		return rc;
+
+	if (count > 0) {
+		pmj = calloc(sizeof(struct rq_modifyjobs_entry), count);
+		if (pmj == NULL)
+			return DIS_NOMALLOC;
+		for (i = 0; i < count; i++)
+			CLEAR_HEAD(pmj[i].rq_attr);
+	}
+
+	/* hang the list on the request now so free_br() cleans up after a failure */
+	preq->rq_ind.rq_modifyjobs.rq_list = pmj;
+	preq->rq_ind.rq_modifyjobs.count = count;
+
+	for (i = 0; i < count; i++) {
+		if ((rc = disrfst(sock, PBS_MAXSVRJOBID + 1, pmj[i].rq_jid)) != 0)
+			return rc;
+		if ((rc = decode_DIS_svrattrl(sock, &pmj[i].rq_attr)) != 0)
+			return rc;
+	}
+
+	return rc;
+}
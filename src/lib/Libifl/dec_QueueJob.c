@@ -46,11 +46,15 @@
  * 			string	job id
  *			string	destination
  *			list of attributes (attropl)
+ *
+ * 	decode_DIS_SubmitJobs() - decode a Submit Jobs Batch Request
+ * 	decode_DIS_ExecJob() - decode an Exec Job Batch Request
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include <sys/types.h>
+#include <stdlib.h>
 #include "libpbs.h"
 #include "list_link.h"
 #include "server_limits.h"
@@ -91,3 +95,143 @@ decode_DIS_QueueJob(int sock, struct batch_request *preq)
 
 	return (decode_DIS_svrattrl(sock, &preq->rq_ind.rq_queuejob.rq_attr));
 }
+
+/**
+ * @brief -
+ *	decode a Submit Jobs Batch Request
+ *
+ * @par	Functionality:
+ *		u int	number of jobs\n
+ *		for each job:\n
+ *			string	destination\n
+ *			list of attributes (attropl)\n
+ *			u int	script size, 0 for none\n
+ *			cnt str	script
+ *
+ * @param[in] sock - socket descriptor
+ * @param[out] preq - pointer to batch_request structure
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+decode_DIS_SubmitJobs(int sock, struct batch_request *preq)
+{
+	int				rc = 0;
+	int				i;
+	int				count;
+	size_t				amt;
+	struct rq_submitjobs_entry	*psj = NULL;
+
+	preq->rq_ind.rq_submitjobs.count = 0;
+	preq->rq_ind.rq_submitjobs.rq_list = NULL;
+
+	count = disrui(sock, &rc);
+	if (rc)
+		return rc;
+
+	if (count > 0) {
+		psj = calloc(sizeof(struct rq_submitjobs_entry), count);
+		if (psj == NULL)
+			return DIS_NOMALLOC;
+		for (i = 0; i < count; i++)
+			CLEAR_HEAD(psj[i].rq_attr);
+	}
+
+	/* hang the list on the request now so free_br() cleans up after a failure */
+	preq->rq_ind.rq_submitjobs.rq_list = psj;
+	preq->rq_ind.rq_submitjobs.count = count;
+
+	for (i = 0; i < count; i++) {
+		if ((rc = disrfst(sock, PBS_MAXDEST + 1, psj[i].rq_destin)) != 0)
+			return rc;
+		if ((rc = decode_DIS_svrattrl(sock, &psj[i].rq_attr)) != 0)
+			return rc;
+		psj[i].rq_size = disrui(sock, &rc);
+		if (rc)
+			return rc;
+		psj[i].rq_script = disrcs(sock, &amt, &rc);
+		if ((rc == 0) && (amt != psj[i].rq_size))
+			rc = DIS_EOD;
+		if (rc)
+			return rc;
+		if (psj[i].rq_size == 0) {
+			free(psj[i].rq_script);
+			psj[i].rq_script = NULL;
+		}
+	}
+
+	return rc;
+}
+
+/**
+ * @brief -
+ *	decode an Exec Job Batch Request
+ *
+ * @par	Functionality:
+ *		string	job id\n
+ *		string	destination\n
+ *		list of attributes (attropl)\n
+ *		u int	script size, 0 for none\n
+ *		cnt str	script\n
+ *		u int	credential type\n
+ *		u int	credential size, 0 for none\n
+ *		cnt str	credential
+ *
+ * @param[in] sock - socket descriptor
+ * @param[out] preq - pointer to batch_request structure
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+decode_DIS_ExecJob(int sock, struct batch_request *preq)
+{
+	int			rc;
+	size_t			amt;
+	struct rq_execjob	*pej = &preq->rq_ind.rq_execjob;
+
+	/* set up everything free_br() looks at before anything can fail */
+	CLEAR_HEAD(pej->rq_job.rq_attr);
+	pej->rq_size = 0;
+	pej->rq_script = NULL;
+	pej->rq_credtype = 0;
+	pej->rq_credsize = 0;
+	pej->rq_cred = NULL;
+
+	rc = disrfst(sock, PBS_MAXSVRJOBID+1, pej->rq_job.rq_jid);
+	if (rc) return rc;
+
+	rc = disrfst(sock, PBS_MAXSVRJOBID+1, pej->rq_job.rq_destin);
+	if (rc) return rc;
+
+	if ((rc = decode_DIS_svrattrl(sock, &pej->rq_job.rq_attr)) != 0)
+		return rc;
+
+	pej->rq_size = disrui(sock, &rc);
+	if (rc)
+		return rc;
+	pej->rq_script = disrcs(sock, &amt, &rc);
+	if ((rc == 0) && (amt != pej->rq_size))
+		rc = DIS_EOD;
+	if (rc)
+		return rc;
+
+	pej->rq_credtype = disrui(sock, &rc);
+	if (rc)
+		return rc;
+	pej->rq_credsize = disrui(sock, &rc);
+	if (rc)
+		return rc;
+	pej->rq_cred = disrcs(sock, &amt, &rc);
+	if ((rc == 0) && (amt != pej->rq_credsize))
+		rc = DIS_EOD;
+
+	return rc;
+}
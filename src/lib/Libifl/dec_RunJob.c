@@ -41,6 +41,7 @@
  * @file	dec_RunJob.c
  * @brief
  * decode_DIS_RunJob() - decode a Run Job batch request
+ * decode_DIS_RunJobs() - decode a multi-job Run Jobs batch request
  *
  *	The batch_request structure must already exist (be allocated by the
  *	caller.   It is assumed that the header fields (protocol type,
@@ -55,6 +56,7 @@
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include <sys/types.h>
+#include <stdlib.h>
 #include "libpbs.h"
 #include "list_link.h"
 #include "server_limits.h"
@@ -103,3 +105,61 @@ decode_DIS_Run(int sock, struct batch_request *preq)
 	preq->rq_ind.rq_run.rq_resch = disrul(sock, &rc);
 	return rc;
 }
+
+/**
+ * @brief-
+ *	decode a Run Jobs batch request
+ *
+ * @par	Data items are:\n
+ *		unsigned int	number of jobs\n
+ *		for each job:\n
+ *			string          job id\n
+ *			string          destination\n
+ *			unsigned int    resource_handle\n
+ *
+ * @param[in] sock - socket descriptor
+ * @param[out] preq - pointer to batch_request structure
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+int
+decode_DIS_RunJobs(int sock, struct batch_request *preq)
+{
+	int		rc = 0;
+	int		i = 0;
+	int		count = 0;
+	struct rq_runjob	*prj = NULL;
+
+	preq->rq_ind.rq_runjobs.count = 0;
+	preq->rq_ind.rq_runjobs.rq_list = NULL;
+
+	count = disrui(sock, &rc);
+	if (rc)
+		return rc;
+
+	if (count > 0) {
+		prj = calloc(sizeof(struct rq_runjob), count);
+		if (prj == NULL)
+			return DIS_NOMALLOC;
+	}
+
+	/* hang the list on the request now so free_br() cleans up after a failure */
+	preq->rq_ind.rq_runjobs.rq_list = prj;
+	preq->rq_ind.rq_runjobs.count = count;
+
+	for (i = 0; i < count; i++) {
+		if ((rc = disrfst(sock, PBS_MAXSVRJOBID + 1, prj[i].rq_jid)) != 0)
+			return rc;
+		prj[i].rq_destin = disrst(sock, &rc);
+		if (rc)
+			return rc;
+		prj[i].rq_resch = disrul(sock, &rc);
+		if (rc)
+			return rc;
+	}
+
+	return rc;
+}
@@ -79,6 +79,9 @@ decode_DIS_Status(int sock, struct batch_request *preq)
 	preq->rq_ind.rq_status.rq_id = NULL;
 
 	CLEAR_HEAD(preq->rq_ind.rq_status.rq_attr);
+	CLEAR_HEAD(preq->rq_ind.rq_status.rq_filtattr);
+	preq->rq_ind.rq_status.rq_filter = NULL;
+	preq->rq_ind.rq_status.rq_filter_que = NULL;
 
 	/*
 	 * call the disrcs function to allocate and return a string of all ids
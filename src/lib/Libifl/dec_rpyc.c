@@ -92,6 +92,7 @@ decode_DIS_replyCmd(int sock, struct batch_reply *reply)
 	int		      rc = 0;
 	size_t		      txtlen;
 	preempt_job_info 	*ppj = NULL;
+	job_err_info 	*pmj = NULL;
 
 	/* first decode "header" consisting of protocol type and version */
 
@@ -256,6 +257,28 @@ decode_DIS_replyCmd(int sock, struct batch_reply *reply)
 
 			break;
 
+		case BATCH_REPLY_CHOICE_JobErrs:
+
+			/* Per Job Errors Reply (Modify Jobs, Run Jobs) */
+			ct = disrui(sock, &rc);
+			reply->brp_un.brp_job_errs.count = ct;
+			if (rc) break;
+
+			pmj = calloc(sizeof(struct job_err_info), ct > 0 ? ct : 1);
+			reply->brp_un.brp_job_errs.pje_list = pmj;
+			if (pmj == NULL)
+				return DIS_NOMALLOC;
+
+			for (i = 0; i < ct; i++) {
+				if ((rc = disrfst(sock, PBS_MAXSVRJOBID + 1, pmj[i].job_id)) != 0)
+					return rc;
+				pmj[i].errcode = disrsi(sock, &rc);
+				if (rc)
+					return rc;
+			}
+
+			break;
+
 		default:
 			return -1;
 	}
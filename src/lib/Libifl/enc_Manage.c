@@ -44,6 +44,9 @@
  *
  *	This request is used for most operations where an object is being
  *	created, deleted, or altered.
+ *
+ * encode_DIS_ManageMany() - encode a Manager Many Batch Request
+ * encode_DIS_DeleteJobs() - encode a Delete Jobs Batch Request
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
@@ -84,3 +87,81 @@ encode_DIS_Manage(int sock, int command, int objtype, char *objname, struct attr
 
 	return (encode_DIS_attropl(sock, aoplp));
 }
+
+/**
+ * @brief
+ *	-encode a Manager Many Batch Request
+ *
+ * @par	Functionality:
+ *		This request carries many Manager directives, applied by the
+ *		server in order in one pass.
+ *
+ * @par Data items are:
+ *		u int	number of directives\n
+ *		for each directive, the items of a Manager request
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] count - number of directives
+ * @param[in] ops - the directives
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+encode_DIS_ManageMany(int sock, int count, struct manage_op *ops)
+{
+	int rc;
+	int i;
+
+	if ((rc = diswui(sock, count)) != 0)
+		return rc;
+	for (i = 0; i < count; i++) {
+		if ((rc = encode_DIS_Manage(sock, ops[i].command, ops[i].objtype,
+			(ops[i].objname != NULL) ? ops[i].objname : "",
+			ops[i].attribs)) != 0)
+			return rc;
+	}
+	return DIS_SUCCESS;
+}
+
+/**
+ * @brief
+ *	-encode a Delete Jobs Batch Request
+ *
+ * @par	Functionality:
+ *		This request carries the ids of many jobs, each deleted by the
+ *		server as a Delete Job request with the same extend would be.
+ *
+ * @par Data items are:
+ *		u int	number of jobs\n
+ *		string	job id, for each job
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] jobids - NULL terminated list of job ids
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+int
+encode_DIS_DeleteJobs(int sock, char **jobids)
+{
+	int rc;
+	int i;
+	int count = 0;
+
+	while (jobids[count] != NULL)
+		count++;
+
+	if ((rc = diswui(sock, count)) != 0)
+		return rc;
+	for (i = 0; i < count; i++) {
+		if ((rc = diswst(sock, jobids[i])) != 0)
+			return rc;
+	}
+	return DIS_SUCCESS;
+}
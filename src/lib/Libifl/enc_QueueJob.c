@@ -49,6 +49,9 @@
  * 			string	job id
  *			string	destination
  *			list of	attribute, see encode_DIS_attropl()
+ *
+ * encode_DIS_SubmitJobs() - encode a Submit Jobs Batch Request
+ * encode_DIS_ExecJob() - encode an Exec Job Batch Request
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
@@ -91,3 +94,116 @@ encode_DIS_QueueJob(int sock, char *jobid, char *destin, struct attropl *aoplp)
 
 	return (encode_DIS_attropl(sock, aoplp));
 }
+
+/**
+ * @brief
+ *	-encode a Submit Jobs Batch Request
+ *
+ * @par	Functionality:
+ *		This request queues many jobs in one go; each entry carries what
+ *		Queue Job, Job Script and Commit would carry for one job.
+ *
+ * @par Data items are:
+ *		u int	number of jobs\n
+ *		for each job:\n
+ *			string	destination\n
+ *			list of	attribute, see encode_DIS_attropl()\n
+ *			u int	script size, 0 for none\n
+ *			cnt str	script
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] count - number of jobs
+ * @param[in] attribs - attribute list of each job
+ * @param[in] scripts - script contents of each job, entries may be NULL
+ * @param[in] script_lens - size of each script
+ * @param[in] destinations - destination queue of each job, may be NULL or
+ *			     hold NULL entries for the default queue
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+encode_DIS_SubmitJobs(int sock, int count, struct attropl **attribs,
+	char **scripts, size_t *script_lens, char **destinations)
+{
+	int	rc;
+	int	i;
+	char	*destin;
+	size_t	len;
+
+	if ((rc = diswui(sock, count)) != 0)
+		return rc;
+
+	for (i = 0; i < count; i++) {
+		destin = (destinations != NULL) ? destinations[i] : NULL;
+		if (destin == NULL)
+			destin = "";
+		len = (scripts[i] != NULL) ? script_lens[i] : 0;
+
+		if (((rc = diswst(sock, destin)) != 0) ||
+			((rc = encode_DIS_attropl(sock, attribs[i])) != 0) ||
+			((rc = diswui(sock, len)) != 0) ||
+			((rc = diswcs(sock, len ? scripts[i] : "", len)) != 0))
+			return rc;
+	}
+
+	return rc;
+}
+
+/**
+ * @brief
+ *	-encode an Exec Job Batch Request
+ *
+ * @par	Functionality:
+ *		Sent by the server to a Mom to start a job in one message; it
+ *		carries what Queue Job, Job Script, Job Credential and Commit
+ *		would carry.
+ *
+ * @par Data items are:
+ *		string	job id\n
+ *		string	destination\n
+ *		list of	attribute, see encode_DIS_attropl()\n
+ *		u int	script size, 0 for none\n
+ *		cnt str	script\n
+ *		u int	credential type\n
+ *		u int	credential size, 0 for none\n
+ *		cnt str	credential
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] jobid - job id
+ * @param[in] destin - destination queue name
+ * @param[in] aoplp - pointer to attropl structure(list)
+ * @param[in] script - job script, may be NULL
+ * @param[in] script_len - size of the script
+ * @param[in] credtype - credential type
+ * @param[in] cred - job credential, may be NULL
+ * @param[in] cred_len - size of the credential
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+encode_DIS_ExecJob(int sock, char *jobid, char *destin, struct attropl *aoplp,
+	char *script, size_t script_len, int credtype, char *cred, size_t cred_len)
+{
+	int	rc;
+
+	if (script == NULL)
+		script_len = 0;
+	if (cred == NULL)
+		cred_len = 0;
+
+	if (((rc = encode_DIS_QueueJob(sock, jobid, destin, aoplp)) != 0) ||
+		((rc = diswui(sock, script_len)) != 0) ||
+		((rc = diswcs(sock, script_len ? script : "", script_len)) != 0) ||
+		((rc = diswui(sock, credtype)) != 0) ||
+		((rc = diswui(sock, cred_len)) != 0) ||
+		((rc = diswcs(sock, cred_len ? cred : "", cred_len)) != 0))
+		return rc;
+
+	return rc;
+}
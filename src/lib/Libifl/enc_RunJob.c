@@ -41,6 +41,7 @@
  * @file	enc_RunJob.c
  * @brief
  * encode_DIS_RunJob() - encode a Run Job Batch Request
+ * encode_DIS_RunJobs() - encode a multi-job Run Jobs Batch Request
  *
  * @par Data items are:
  * 			string		job id
@@ -87,3 +88,45 @@ encode_DIS_Run(int sock, char *id, char *where, unsigned long arg)
 
 	return 0;
 }
+
+/**
+ * @brief encode the Run Jobs request for sending to the server.
+ *
+ * @par	Data items are:\n
+ *		unsigned int	number of jobs\n
+ *		for each job:\n
+ *			string		job id\n
+ *			string		destination\n
+ *			unsigned int	resource handle (currently 0)
+ *
+ * @param[in] sock - socket descriptor for the connection.
+ * @param[in] jobids - NULL terminated list of job ids
+ * @param[in] locations - destination of each job in jobids, may be NULL
+ *			  or hold NULL entries for no destination
+ *
+ * @return - error code while writing data to the socket.
+ */
+int
+encode_DIS_RunJobs(int sock, char **jobids, char **locations)
+{
+	int	rc = 0;
+	int	count = 0;
+	int	i;
+	char	*where;
+
+	while (jobids[count] != NULL)
+		count++;
+
+	if ((rc = diswui(sock, count)) != 0)
+		return rc;
+
+	for (i = 0; i < count; i++) {
+		where = "";
+		if ((locations != NULL) && (locations[i] != NULL))
+			where = locations[i];
+		if ((rc = encode_DIS_Run(sock, jobids[i], where, 0)) != 0)
+			return rc;
+	}
+
+	return rc;
+}
@@ -82,6 +82,7 @@ encode_DIS_reply_inner(int sock, struct batch_reply *reply)
 	struct brp_status  *pstat;
 	svrattrl	   *psvrl;
 	preempt_job_info   *ppj;
+	job_err_info    *pmj;
 
 	int rc;
 
@@ -219,6 +220,23 @@ encode_DIS_reply_inner(int sock, struct batch_reply *reply)
 
 			break;
 
+		case BATCH_REPLY_CHOICE_JobErrs:
+
+			/* Per Job Errors Reply (Modify Jobs, Run Jobs) */
+			ct = reply->brp_un.brp_job_errs.count;
+			pmj = reply->brp_un.brp_job_errs.pje_list;
+
+			if ((rc = diswui(sock, ct)) != 0)
+				return rc;
+
+			for (i = 0; i < ct; i++) {
+				if (((rc = diswst(sock, pmj[i].job_id)) != 0) ||
+					((rc = diswsi(sock, pmj[i].errcode)) != 0))
+						return rc;
+			}
+
+			break;
+
 		default:
 			return -1;
 	}
@@ -41,6 +41,7 @@
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include <ctype.h>
+#include <stdlib.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -49,6 +50,7 @@
 #include <string.h>
 #include "pbs_ifl.h"
 #include "pbs_internal.h"
+#include "hostcache.h"
 
 
 /**
@@ -73,9 +75,8 @@ get_fullhostname(char *shortname, char *namebuf, int bufsize)
 	char           *pcolon = 0;
 	char            extname[PBS_MAXHOSTNAME+1] = {'\0'};
 	char            localname[PBS_MAXHOSTNAME+1] = {'\0'};
-	struct addrinfo *aip, *pai;
-	struct addrinfo hints;
-	struct sockaddr_in *inp;
+	struct in_addr *addrs;
+	int		naddrs;
 
 	if ((pcolon = strchr(shortname, (int)':')) != NULL) {
 		*pcolon = '\0';
@@ -83,20 +84,8 @@ get_fullhostname(char *shortname, char *namebuf, int bufsize)
 			*(pbkslh = pcolon-1) = '\0';
 	}
 
-	memset(&hints, 0, sizeof(struct addrinfo));
-	/*
-	 *	Why do we use AF_UNSPEC rather than AF_INET?  Some
-	 *	implementations of getaddrinfo() will take an IPv6
-	 *	address and map it to an IPv4 one if we ask for AF_INET
-	 *	only.  We don't want that - we want only the addresses
-	 *	that are genuinely, natively, IPv4 so we start with
-	 *	AF_UNSPEC and filter ai_family below.
-	 */
-	hints.ai_family = AF_UNSPEC;
-	hints.ai_socktype = SOCK_STREAM;
-	hints.ai_protocol = IPPROTO_TCP;
-
-	if (getaddrinfo(shortname, NULL, &hints, &pai) != 0)
+	/* only the native IPv4 addresses are returned */
+	if (hostcache_addrs(shortname, &addrs, &naddrs) != 0)
 		return (-1);
 
 	if (pcolon) {
@@ -111,20 +100,16 @@ get_fullhostname(char *shortname, char *namebuf, int bufsize)
 	 *	name its jobs <N>.localhost), so we ignore non-IPv4 addresses,
 	 *	those that aren't invertible, and those on a loopback net.
 	 */
-	for (aip = pai; aip != NULL; aip = aip->ai_next) {
-		if (aip->ai_family != AF_INET)
-			continue;  /* skip non-IPv4 addresses */
-		if (getnameinfo(aip->ai_addr, aip->ai_addrlen, namebuf,
-			bufsize, NULL, 0, 0) != 0)
+	for (i = 0; i < naddrs; i++) {
+		if (hostcache_name(addrs[i], namebuf, bufsize, 0) != 0)
 			continue; /* skip non-invertible addresses */
-		inp = (struct sockaddr_in *) aip->ai_addr;
-		if (ntohl(inp->sin_addr.s_addr) >> 24 != IN_LOOPBACKNET) {
+		if (ntohl(addrs[i].s_addr) >> 24 != IN_LOOPBACKNET) {
 			strncpy(extname, namebuf, (sizeof(extname) - 1));
 			break;          /* skip loopback addresses */
 		} else
 			strncpy(localname, namebuf, (sizeof(localname) - 1));
 	}
-	freeaddrinfo(pai);
+	free(addrs);
 	if (extname[0] == '\0')
 		strncpy(namebuf, localname, bufsize);
 	else
@@ -418,6 +418,211 @@ pbs_preempt_jobs(int c, char **preempt_jobs_list) {
 	return (*pfn_pbs_preempt_jobs)(c, preempt_jobs_list);
 }
 
+/**
+ * @brief
+ *	-Pass-through call to send modify jobs batch request
+ *
+ * @param[in] c - connection handler
+ * @param[in] jobs - list of jobs and the attributes to set on each
+ *
+ * @return      job_err_info *
+ * @retval      job_err_info array       success
+ * @retval      NULL      error
+ *
+ */
+job_err_info *
+pbs_alterjobs(int c, struct batch_status *jobs) {
+	return (*pfn_pbs_alterjobs)(c, jobs);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to send async run jobs batch request
+ *
+ * @param[in] c - connection handler
+ * @param[in] jobids - NULL terminated list of job ids
+ * @param[in] locations - destination of each job, may be NULL
+ *
+ * @return      job_err_info *
+ * @retval      job_err_info array       success
+ * @retval      NULL      error
+ *
+ */
+job_err_info *
+pbs_asyrunjobs(int c, char **jobids, char **locations) {
+	return (*pfn_pbs_asyrunjobs)(c, jobids, locations);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to send submit jobs batch request
+ *
+ * @param[in] c - connection handler
+ * @param[in] count - number of jobs
+ * @param[in] attribs - attribute list of each job
+ * @param[in] scripts - script file of each job, may be NULL
+ * @param[in] destinations - queue of each job, may be NULL
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return      job_err_info *
+ * @retval      job_err_info array       success
+ * @retval      NULL      error
+ *
+ */
+job_err_info *
+pbs_submit_many(int c, int count, struct attropl **attribs, char **scripts,
+	char **destinations, char *extend) {
+	return (*pfn_pbs_submit_many)(c, count, attribs, scripts, destinations, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to send manager many batch request
+ *
+ * @param[in] c - connection handler
+ * @param[in] count - number of directives
+ * @param[in] ops - the directives
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return      job_err_info *
+ * @retval      job_err_info array       success
+ * @retval      NULL      error
+ *
+ */
+job_err_info *
+pbs_manager_many(int c, int count, struct manage_op *ops, char *extend) {
+	return (*pfn_pbs_manager_many)(c, count, ops, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to send delete jobs batch request
+ *
+ * @param[in] c - connection handler
+ * @param[in] jobids - NULL terminated list of job ids
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return      job_err_info *
+ * @retval      job_err_info array       success
+ * @retval      NULL      error
+ *
+ */
+job_err_info *
+pbs_deljobs(int c, char **jobids, char *extend) {
+	return (*pfn_pbs_deljobs)(c, jobids, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to send a modify job request without waiting
+ *	for its reply
+ *
+ * @param[in] c - connection handler
+ * @param[in] jobid - job identifier
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	int
+ * @retval	>0	tag of the request
+ * @retval	-1	error
+ *
+ */
+int
+pbs_alterjob_async(int c, char *jobid, struct attrl *attrib, char *extend) {
+	return (*pfn_pbs_alterjob_async)(c, jobid, attrib, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to send a runjob request without waiting
+ *	for its reply
+ *
+ * @param[in] c - connection handler
+ * @param[in] jobid - job identifier
+ * @param[in] location - string of vnodes/resources to be allocated to the job
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	int
+ * @retval	>0	tag of the request
+ * @retval	-1	error
+ *
+ */
+int
+pbs_runjob_async(int c, char *jobid, char *location, char *extend) {
+	return (*pfn_pbs_runjob_async)(c, jobid, location, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to send a deljob request without waiting
+ *	for its reply
+ *
+ * @param[in] c - connection handler
+ * @param[in] jobid - job identifier
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	int
+ * @retval	>0	tag of the request
+ * @retval	-1	error
+ *
+ */
+int
+pbs_deljob_async(int c, char *jobid, char *extend) {
+	return (*pfn_pbs_deljob_async)(c, jobid, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to send a status job request without waiting
+ *	for its reply
+ *
+ * @param[in] c - connection handler
+ * @param[in] id - job or queue identifier
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	int
+ * @retval	>0	tag of the request
+ * @retval	-1	error
+ *
+ */
+int
+pbs_statjob_async(int c, char *id, struct attrl *attrib, char *extend) {
+	return (*pfn_pbs_statjob_async)(c, id, attrib, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to wait for the oldest asynchronous request
+ *
+ * @param[in] c - connection handler
+ * @param[out] tag - tag of the request completed
+ * @param[out] bstat - status reply of a status request
+ *
+ * @return	int
+ * @retval	>=0	error code of the request
+ * @retval	-1	error
+ *
+ */
+int
+pbs_async_wait(int c, int *tag, struct batch_status **bstat) {
+	return (*pfn_pbs_async_wait)(c, tag, bstat);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to count the outstanding asynchronous requests
+ *
+ * @param[in] c - connection handler
+ *
+ * @return	int
+ *
+ */
+int
+pbs_async_pending(int c) {
+	return (*pfn_pbs_async_pending)(c);
+}
+
 /**
  * @brief
  *	-Pass-through call to send runjob batch request
@@ -80,4 +80,15 @@ char *(*pfn_pbs_submit_resv)(int, struct attropl *, char *) = __pbs_submit_resv;
 int (*pfn_pbs_delresv)(int, char *, char *) = __pbs_delresv;
 int (*pfn_pbs_terminate)(int, int, char *) = __pbs_terminate;
 preempt_job_info *(*pfn_pbs_preempt_jobs)(int, char**) = __pbs_preempt_jobs;
+job_err_info *(*pfn_pbs_alterjobs)(int, struct batch_status *) = __pbs_alterjobs;
+job_err_info *(*pfn_pbs_asyrunjobs)(int, char **, char **) = __pbs_asyrunjobs;
+job_err_info *(*pfn_pbs_submit_many)(int, int, struct attropl **, char **, char **, char *) = __pbs_submit_many;
+job_err_info *(*pfn_pbs_manager_many)(int, int, struct manage_op *, char *) = __pbs_manager_many;
+job_err_info *(*pfn_pbs_deljobs)(int, char **, char *) = __pbs_deljobs;
+int (*pfn_pbs_alterjob_async)(int, char *, struct attrl *, char *) = __pbs_alterjob_async;
+int (*pfn_pbs_runjob_async)(int, char *, char *, char *) = __pbs_runjob_async;
+int (*pfn_pbs_deljob_async)(int, char *, char *) = __pbs_deljob_async;
+int (*pfn_pbs_statjob_async)(int, char *, struct attrl *, char *) = __pbs_statjob_async;
+int (*pfn_pbs_async_wait)(int, int *, struct batch_status **) = __pbs_async_wait;
+int (*pfn_pbs_async_pending)(int) = __pbs_async_pending;
 
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <string.h>
+#include "libpbs.h"
+#include "dis.h"
+
+/**
+ * @brief
+ *	-send a Modify Jobs batch request and read back the per job results
+ *
+ * @param[in] connect - connection handler
+ * @param[in] jobs - list of jobs, each with the attributes to set on it
+ *
+ * @return      job_err_info *
+ * @retval      array with one entry per job (in request order) holding the
+ *		job id and the error code the server returned for that job
+ * @retval      NULL - failure with pbs_errno set.  The per job modifications
+ *		were not done if the failure was in sending the request.
+ *
+ */
+job_err_info *
+PBSD_modify_jobs(int connect, struct batch_status *jobs)
+{
+	int rc = -1;
+	int sock = 0;
+
+	sock = connection[connect].ch_socket;
+	DIS_tcp_setup(sock);
+
+	if ((rc = encode_DIS_ReqHdr(sock, PBS_BATCH_ModifyJobs, pbs_current_user)) ||
+		(rc = encode_DIS_ModifyJobs(sock, jobs)) ||
+		(rc = encode_DIS_ReqExtend(sock, NULL))) {
+		connection[connect].ch_errtxt = strdup(dis_emsg[rc]);
+		if (connection[connect].ch_errtxt == NULL)
+			pbs_errno = PBSE_SYSTEM;
+		else
+			pbs_errno = PBSE_PROTOCOL;
+		return NULL;
+	}
+	if (DIS_tcp_wflush(sock)) {
+		pbs_errno = PBSE_PROTOCOL;
+		return NULL;
+	}
+
+	return PBSD_rdrpy_job_errs(connect);
+}
@@ -115,6 +115,13 @@ PBSD_rdrpy(int c)
 	struct batch_reply *reply;
 	int sock;
 
+	/* replies to outstanding asynchronous requests come first */
+	if (connection[c].ch_async != NULL && PBSD_async_drain(c) != 0) {
+		connection[c].ch_errno = PBSE_PROTOCOL;
+		pbs_errno = PBSE_PROTOCOL;
+		return NULL;
+	}
+
 	/* clear any prior error message */
 
 	if (connection[c].ch_errtxt != NULL) {
@@ -149,6 +156,49 @@ PBSD_rdrpy(int c)
 	return reply;
 }
 
+/**
+ * @brief read the reply to a multi-job request
+ *
+ * @param[in] c - The connection index to read from
+ *
+ * @return job_err_info *
+ * @retval  !NULL - array of the per job results in request order, the
+ *		    caller must free it
+ * @retval   NULL - the request failed as a whole, pbs_errno is set
+ */
+job_err_info *
+PBSD_rdrpy_job_errs(int c)
+{
+	struct batch_reply *reply;
+	job_err_info *pje = NULL;
+	int count;
+
+	reply = PBSD_rdrpy(c);
+	if (reply == NULL) {
+		pbs_errno = PBSE_PROTOCOL;
+		return NULL;
+	}
+
+	if (connection[c].ch_errno != 0 ||
+		reply->brp_choice != BATCH_REPLY_CHOICE_JobErrs) {
+		if (pbs_errno == PBSE_NONE)
+			pbs_errno = PBSE_PROTOCOL;
+		PBSD_FreeReply(reply);
+		return NULL;
+	}
+
+	count = reply->brp_un.brp_job_errs.count;
+	pje = calloc(sizeof(struct job_err_info), count > 0 ? count : 1);
+	if (pje == NULL)
+		pbs_errno = PBSE_SYSTEM;
+	else if (count > 0)
+		memcpy(pje, reply->brp_un.brp_job_errs.pje_list,
+			sizeof(struct job_err_info) * count);
+
+	PBSD_FreeReply(reply);
+	return pje;
+}
+
 /*
  * PBS_FreeReply - Free a batch_reply structure allocated in PBS_rdrpy()
  *
@@ -210,6 +260,8 @@ struct batch_reply *reply;
 		(void)free(reply->brp_un.brp_rescq.brq_down);
 	} else if (reply->brp_choice == BATCH_REPLY_CHOICE_PreemptJobs) {
 		(void)free(reply->brp_un.brp_preempt_jobs.ppj_list);
+	} else if (reply->brp_choice == BATCH_REPLY_CHOICE_JobErrs) {
+		(void)free(reply->brp_un.brp_job_errs.pje_list);
 	}
 
 	(void)free(reply);
@@ -294,6 +294,48 @@ PBSD_commit(int connect, char *jobid, int rpp, char **msgid)
 	return connection[connect].ch_errno;
 }
 
+/**
+ * @brief
+ *	-PBSD_execjob Send a job to a Mom as one Exec Job request, which
+ *	stands for the Queue Job, Job Script, Job Credential and Commit
+ *	requests send_job_exec() would otherwise issue.  The Mom answers it
+ *	once, as it does the Commit.
+ *
+ * @param[in] stream - RPP stream to the Mom
+ * @param[in] jobid - job identifier
+ * @param[in] destin - destination name
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] script - job script, may be NULL
+ * @param[in] credtype - credential type
+ * @param[in] cred - job credential, may be NULL
+ * @param[in] credlen - length of the credential
+ * @param[in,out] msgid - message id
+ *
+ * @return      int
+ * @retval      0               success
+ * @retval      !0(pbs_errno)   failure
+ *
+ */
+
+int
+PBSD_execjob(int stream, char *jobid, char *destin, struct attropl *attrib,
+	char *script, int credtype, char *cred, int credlen, char **msgid)
+{
+	int rc;
+
+	if (((rc = is_compose_cmd(stream, IS_CMD, msgid)) != DIS_SUCCESS) ||
+		(rc = encode_DIS_ReqHdr(stream, PBS_BATCH_ExecJob, pbs_current_user)) ||
+		(rc = encode_DIS_ExecJob(stream, jobid, destin, attrib, script,
+			script ? strlen(script) : 0, credtype, cred, credlen)) ||
+		(rc = encode_DIS_ReqExtend(stream, NULL)))
+		return (pbs_errno = PBSE_PROTOCOL);
+
+	pbs_errno = PBSE_NONE;
+	if (rpp_flush(stream))
+		pbs_errno = PBSE_PROTOCOL;
+	return pbs_errno;
+}
+
 /**
  * @brief
  *	-PBS_scbuf.c Send a chunk of a of the job script to the server.
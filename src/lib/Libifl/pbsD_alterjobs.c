@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+/*	pbsD_alterjobs.c
+ *
+ *	The Modify Jobs request: alter the attributes of many jobs in a
+ *	single round trip to the server.
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdio.h>
+#include "libpbs.h"
+#include "pbs_ecl.h"
+
+/**
+ * @brief
+ *	-Send the Modify Jobs request to the server
+ *
+ * @par
+ *	Each entry in jobs names a job (name) and the attributes to set on it
+ *	(attribs).  The server applies each entry as it would a separate
+ *	pbs_alterjob() call and reports the result of every job.
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobs - list of jobs to alter
+ *
+ * @return      job_err_info *
+ * @retval      array of one entry per job in jobs, in the same order. The
+ *		caller must free it.
+ * @retval      NULL	error, pbs_errno is set
+ *
+ */
+job_err_info *
+__pbs_alterjobs(int c, struct batch_status *jobs)
+{
+	job_err_info *ret = NULL;
+	struct batch_status *bs;
+
+	if (jobs == NULL) {
+		pbs_errno = PBSE_IVALREQ;
+		return NULL;
+	}
+	for (bs = jobs; bs != NULL; bs = bs->next) {
+		if ((bs->name == NULL) || (*bs->name == '\0')) {
+			pbs_errno = PBSE_IVALREQ;
+			return NULL;
+		}
+	}
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	/* lock pthread mutex here for this connection
+	 * blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return NULL;
+
+	ret = PBSD_modify_jobs(c, jobs);
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0) {
+		free(ret);
+		return NULL;
+	}
+
+	return ret;
+}
@@ -0,0 +1,620 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+/*	pbsD_async.c
+ *
+ *	Tagged asynchronous requests: send many requests on one connection
+ *	before reading any reply, and collect the results afterwards.
+ *
+ *	Each pbs_*_async() call sends its request and returns a tag.
+ *	pbs_async_wait() returns the results in the order the requests were
+ *	sent, with the tag of each.  On a connection whose server accepted
+ *	PIPELINE_OFFER the server answers the requests in order, so the
+ *	client never waits on one reply before sending the next request.
+ *	Against a server that did not, each request is answered before
+ *	pbs_*_async() returns and pbs_async_wait() hands back the stored
+ *	result, so callers need not care which kind of server they talk to.
+ *
+ *	A synchronous IFL call made while requests are still outstanding
+ *	first reads their replies, see PBSD_async_drain().
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "libpbs.h"
+#include "dis.h"
+#include "pbs_ecl.h"
+
+/* one request sent and not yet returned by pbs_async_wait() */
+struct async_req {
+	int			ar_tag;
+	int			ar_type;	/* PBS_BATCH_* request type */
+	int			ar_done;	/* reply read, result below */
+	int			ar_errcode;	/* brp_code of the reply */
+	char			*ar_errtxt;	/* server error text, if any */
+	struct batch_status	*ar_bstat;	/* status reply, PBS_BATCH_StatusJob */
+};
+
+struct pbs_async_queue {
+	int			aq_nexttag;
+	int			aq_reading;	/* PBSD_rdrpy() is reading for us */
+	int			aq_head;	/* oldest entry in aq_list */
+	int			aq_count;	/* entries from aq_head on */
+	int			aq_size;
+	struct async_req	*aq_list;
+};
+
+/**
+ * @brief
+ *	Free the result held by a queue entry.
+ *
+ * @param[in] ar - entry
+ */
+static void
+async_req_clear(struct async_req *ar)
+{
+	free(ar->ar_errtxt);
+	ar->ar_errtxt = NULL;
+	pbs_statfree(ar->ar_bstat);
+	ar->ar_bstat = NULL;
+}
+
+/**
+ * @brief
+ *	Append an entry for a request about to be sent on a connection.
+ *
+ * @param[in] c - connection handle, locked
+ * @param[in] type - PBS_BATCH_* request type
+ *
+ * @return struct async_req *
+ * @retval entry, with its tag set
+ * @retval NULL	out of memory, pbs_errno set
+ */
+static struct async_req *
+async_push(int c, int type)
+{
+	struct pbs_async_queue *aq = connection[c].ch_async;
+	struct async_req *ar;
+
+	if (aq == NULL) {
+		if ((aq = calloc(1, sizeof(struct pbs_async_queue))) == NULL) {
+			pbs_errno = PBSE_SYSTEM;
+			return NULL;
+		}
+		aq->aq_nexttag = 1;
+		connection[c].ch_async = aq;
+	}
+
+	if (aq->aq_head + aq->aq_count == aq->aq_size) {
+		if (aq->aq_head > 0) {
+			/* slide the outstanding entries back to the front */
+			memmove(aq->aq_list, aq->aq_list + aq->aq_head,
+				aq->aq_count * sizeof(struct async_req));
+			aq->aq_head = 0;
+		} else {
+			int size = aq->aq_size ? 2 * aq->aq_size : 16;
+			struct async_req *list;
+
+			list = realloc(aq->aq_list, size * sizeof(struct async_req));
+			if (list == NULL) {
+				pbs_errno = PBSE_SYSTEM;
+				return NULL;
+			}
+			aq->aq_list = list;
+			aq->aq_size = size;
+		}
+	}
+
+	ar = &aq->aq_list[aq->aq_head + aq->aq_count];
+	memset(ar, 0, sizeof(struct async_req));
+	ar->ar_tag = aq->aq_nexttag;
+	ar->ar_type = type;
+	aq->aq_nexttag = (aq->aq_nexttag == INT_MAX) ? 1 : aq->aq_nexttag + 1;
+	aq->aq_count++;
+	return ar;
+}
+
+/**
+ * @brief
+ *	Read the reply of the oldest outstanding request on a connection.
+ *
+ * @param[in] c - connection handle, locked
+ * @param[in] ar - its queue entry
+ *
+ * @return int
+ * @retval 0	reply read, result stored in ar
+ * @retval -1	the connection failed, ar holds PBSE_PROTOCOL
+ */
+static int
+async_read(int c, struct async_req *ar)
+{
+	struct pbs_async_queue *aq = connection[c].ch_async;
+	struct batch_reply *reply;
+	int rc = 0;
+
+	aq->aq_reading = 1;
+	if (ar->ar_type == PBS_BATCH_StatusJob) {
+		ar->ar_bstat = PBSD_status_get(c);
+		ar->ar_errcode = connection[c].ch_errno;
+		if (ar->ar_bstat == NULL && ar->ar_errcode == PBSE_NONE)
+			ar->ar_errcode = pbs_errno;
+	} else {
+		reply = PBSD_rdrpy(c);
+		ar->ar_errcode = connection[c].ch_errno;
+		PBSD_FreeReply(reply);
+	}
+	aq->aq_reading = 0;
+
+	if (ar->ar_errcode == PBSE_PROTOCOL)
+		rc = -1;
+	if (connection[c].ch_errtxt != NULL)
+		ar->ar_errtxt = strdup(connection[c].ch_errtxt);
+	ar->ar_done = 1;
+	return rc;
+}
+
+/**
+ * @brief
+ *	Read the replies of all outstanding asynchronous requests on a
+ *	connection, so the next reply read is that of a request sent after
+ *	them.  Called by PBSD_rdrpy() before it reads a reply.
+ *
+ * @par
+ *	Once a reply fails to read, the replies after it cannot be found in
+ *	the stream any more, so every later request fails with PBSE_PROTOCOL
+ *	too.
+ *
+ * @param[in] c - connection handle, locked
+ *
+ * @return int
+ * @retval 0	success, or nothing outstanding
+ * @retval -1	the connection failed
+ */
+int
+PBSD_async_drain(int c)
+{
+	struct pbs_async_queue *aq = connection[c].ch_async;
+	struct async_req *ar;
+	int rc = 0;
+	int i;
+
+	if (aq == NULL || aq->aq_reading)
+		return 0;
+
+	for (i = aq->aq_head; i < aq->aq_head + aq->aq_count; i++) {
+		ar = &aq->aq_list[i];
+		if (ar->ar_done)
+			continue;
+		if (rc == 0)
+			rc = async_read(c, ar);
+		else {
+			ar->ar_errcode = PBSE_PROTOCOL;
+			ar->ar_done = 1;
+		}
+	}
+	return rc;
+}
+
+/**
+ * @brief
+ *	Free the asynchronous request queue of a connection being closed.
+ *
+ * @param[in] c - connection handle
+ */
+void
+PBSD_async_free(int c)
+{
+	struct pbs_async_queue *aq = connection[c].ch_async;
+	int i;
+
+	if (aq == NULL)
+		return;
+	for (i = aq->aq_head; i < aq->aq_head + aq->aq_count; i++)
+		async_req_clear(&aq->aq_list[i]);
+	free(aq->aq_list);
+	free(aq);
+	connection[c].ch_async = NULL;
+}
+
+/**
+ * @brief
+ *	Finish sending an asynchronous request: on a connection that is not
+ *	pipelined, read its reply right away.
+ *
+ * @param[in] c - connection handle, locked
+ * @param[in] ar - entry from async_push()
+ *
+ * @return int
+ * @retval tag of the request
+ */
+static int
+async_sent(int c, struct async_req *ar)
+{
+	int tag = ar->ar_tag;
+
+	if (!connection[c].ch_pipelined)
+		(void)async_read(c, ar);
+	return tag;
+}
+
+/**
+ * @brief
+ *	Drop the entry of a request that could not be sent.
+ *
+ * @param[in] c - connection handle, locked
+ */
+static void
+async_unpush(int c)
+{
+	struct pbs_async_queue *aq = connection[c].ch_async;
+
+	aq->aq_count--;
+	async_req_clear(&aq->aq_list[aq->aq_head + aq->aq_count]);
+}
+
+/**
+ * @brief
+ *	-Send a Modify Job request without waiting for its reply
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobid - job to alter
+ * @param[in] attrib - attributes to set
+ * @param[in] extend - extend string for the request
+ *
+ * @return int
+ * @retval >0	tag of the request, see pbs_async_wait()
+ * @retval -1	error, pbs_errno is set
+ */
+int
+__pbs_alterjob_async(int c, char *jobid, struct attrl *attrib, char *extend)
+{
+	struct attropl *ap = NULL;
+	struct attropl *ap1 = NULL;
+	struct async_req *ar;
+	int rc = -1;
+
+	if ((jobid == NULL) || (*jobid == '\0')) {
+		pbs_errno = PBSE_IVALREQ;
+		return -1;
+	}
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return -1;
+
+	/* copy the attrl to an attropl */
+	for (; attrib != NULL; attrib = attrib->next) {
+		if (ap == NULL)
+			ap1 = ap = MH(struct attropl);
+		else {
+			ap->next = MH(struct attropl);
+			ap = ap->next;
+		}
+		if (ap == NULL) {
+			pbs_errno = PBSE_SYSTEM;
+			goto done;
+		}
+		ap->name = attrib->name;
+		ap->resource = attrib->resource;
+		ap->value = attrib->value;
+		ap->op = SET;
+		ap->next = NULL;
+	}
+
+	/* verify the attributes, if verification is enabled */
+	if (pbs_verify_attributes(c, PBS_BATCH_ModifyJob, MGR_OBJ_JOB,
+		MGR_CMD_SET, ap1) != 0)
+		goto done;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		goto done;
+
+	if ((ar = async_push(c, PBS_BATCH_ModifyJob)) != NULL) {
+		if (PBSD_mgr_put(c, PBS_BATCH_ModifyJob, MGR_CMD_SET, MGR_OBJ_JOB,
+			jobid, ap1, extend, 0, NULL) == 0)
+			rc = async_sent(c, ar);
+		else
+			async_unpush(c);
+	}
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		rc = -1;
+
+done:
+	while (ap1 != NULL) {
+		ap = ap1->next;
+		free(ap1);
+		ap1 = ap;
+	}
+	return rc;
+}
+
+/**
+ * @brief
+ *	-Send a Run Job request without waiting for its reply
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobid - job to run
+ * @param[in] location - where to run it, may be NULL
+ * @param[in] extend - extend string for the request
+ *
+ * @return int
+ * @retval >0	tag of the request, see pbs_async_wait()
+ * @retval -1	error, pbs_errno is set
+ */
+int
+__pbs_runjob_async(int c, char *jobid, char *location, char *extend)
+{
+	struct async_req *ar;
+	int sock;
+	int rc = -1;
+	int err;
+
+	if ((jobid == NULL) || (*jobid == '\0')) {
+		pbs_errno = PBSE_IVALREQ;
+		return -1;
+	}
+	if (location == NULL)
+		location = "";
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return -1;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return -1;
+
+	if ((ar = async_push(c, PBS_BATCH_RunJob)) != NULL) {
+		sock = connection[c].ch_socket;
+		DIS_tcp_setup(sock);
+		if ((err = encode_DIS_ReqHdr(sock, PBS_BATCH_RunJob, pbs_current_user)) ||
+			(err = encode_DIS_Run(sock, jobid, location, 0)) ||
+			(err = encode_DIS_ReqExtend(sock, extend))) {
+			connection[c].ch_errtxt = strdup(dis_emsg[err]);
+			pbs_errno = (connection[c].ch_errtxt == NULL) ? PBSE_SYSTEM : PBSE_PROTOCOL;
+			async_unpush(c);
+		} else if (DIS_tcp_wflush(sock)) {
+			pbs_errno = PBSE_PROTOCOL;
+			async_unpush(c);
+		} else
+			rc = async_sent(c, ar);
+	}
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return -1;
+
+	return rc;
+}
+
+/**
+ * @brief
+ *	-Send a Delete Job request without waiting for its reply
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobid - job to delete
+ * @param[in] extend - extend string for the request
+ *
+ * @return int
+ * @retval >0	tag of the request, see pbs_async_wait()
+ * @retval -1	error, pbs_errno is set
+ */
+int
+__pbs_deljob_async(int c, char *jobid, char *extend)
+{
+	struct async_req *ar;
+	int rc = -1;
+
+	if ((jobid == NULL) || (*jobid == '\0')) {
+		pbs_errno = PBSE_IVALREQ;
+		return -1;
+	}
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return -1;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return -1;
+
+	if ((ar = async_push(c, PBS_BATCH_DeleteJob)) != NULL) {
+		if (PBSD_mgr_put(c, PBS_BATCH_DeleteJob, MGR_CMD_DELETE, MGR_OBJ_JOB,
+			jobid, NULL, extend, 0, NULL) == 0)
+			rc = async_sent(c, ar);
+		else
+			async_unpush(c);
+	}
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return -1;
+
+	return rc;
+}
+
+/**
+ * @brief
+ *	-Send a Status Job request without waiting for its reply
+ *
+ * @param[in] c - connection handle
+ * @param[in] id - job, or queue, to status, or NULL for all jobs
+ * @param[in] attrib - attributes to return, NULL for all
+ * @param[in] extend - extend string for the request
+ *
+ * @return int
+ * @retval >0	tag of the request, see pbs_async_wait()
+ * @retval -1	error, pbs_errno is set
+ */
+int
+__pbs_statjob_async(int c, char *id, struct attrl *attrib, char *extend)
+{
+	struct async_req *ar;
+	int rc = -1;
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return -1;
+
+	/* first verify the attributes, if verification is enabled */
+	if ((pbs_verify_attributes(c, PBS_BATCH_StatusJob,
+		MGR_OBJ_JOB, MGR_CMD_NONE, (struct attropl *) attrib)))
+		return -1;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return -1;
+
+	if ((ar = async_push(c, PBS_BATCH_StatusJob)) != NULL) {
+		if (PBSD_status_put(c, PBS_BATCH_StatusJob, id ? id : "", attrib,
+			extend, 0, NULL) == 0)
+			rc = async_sent(c, ar);
+		else
+			async_unpush(c);
+	}
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return -1;
+
+	return rc;
+}
+
+/**
+ * @brief
+ *	-Wait for the oldest outstanding asynchronous request on a connection
+ *	to complete
+ *
+ * @par
+ *	The server error text of the request is made the one that
+ *	pbs_geterrmsg() returns for the connection.
+ *
+ * @param[in] c - connection handle
+ * @param[out] tag - tag of the request completed
+ * @param[out] bstat - status returned by a pbs_statjob_async() request,
+ *		       or NULL.  May be NULL to discard it.  The caller frees
+ *		       it with pbs_statfree().
+ *
+ * @return int
+ * @retval 0	the request succeeded
+ * @retval >0	the PBSE_ error code the request failed with
+ * @retval -1	nothing is outstanding, pbs_errno is PBSE_NONE, or
+ *		the call failed, pbs_errno is set
+ */
+int
+__pbs_async_wait(int c, int *tag, struct batch_status **bstat)
+{
+	struct pbs_async_queue *aq;
+	struct async_req *ar;
+	int rc;
+
+	if (bstat != NULL)
+		*bstat = NULL;
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return -1;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return -1;
+
+	aq = connection[c].ch_async;
+	if (aq == NULL || aq->aq_count == 0) {
+		(void)pbs_client_thread_unlock_connection(c);
+		pbs_errno = PBSE_NONE;
+		return -1;
+	}
+
+	ar = &aq->aq_list[aq->aq_head];
+	if (!ar->ar_done)
+		(void)async_read(c, ar);
+
+	if (tag != NULL)
+		*tag = ar->ar_tag;
+	if (bstat != NULL) {
+		*bstat = ar->ar_bstat;
+		ar->ar_bstat = NULL;
+	}
+	free(connection[c].ch_errtxt);
+	connection[c].ch_errtxt = ar->ar_errtxt;
+	ar->ar_errtxt = NULL;
+	connection[c].ch_errno = ar->ar_errcode;
+	rc = ar->ar_errcode;
+	async_req_clear(ar);
+
+	aq->aq_head++;
+	if (--aq->aq_count == 0)
+		aq->aq_head = 0;
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return -1;
+
+	pbs_errno = rc;
+	return rc;
+}
+
+/**
+ * @brief
+ *	-Number of asynchronous requests on a connection that
+ *	pbs_async_wait() has not returned yet
+ *
+ * @param[in] c - connection handle
+ *
+ * @return int
+ */
+int
+__pbs_async_pending(int c)
+{
+	if (c < 0 || NCONNECTS <= c || connection[c].ch_async == NULL)
+		return 0;
+	return connection[c].ch_async->aq_count;
+}
@@ -43,6 +43,7 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "libpbs.h"
 #include "dis.h"
 #include "pbs_ecl.h"
@@ -125,3 +126,92 @@ __pbs_asyrunjob(int c, char *jobid, char *location, char *extend)
 
 	return rc;
 }
+
+/**
+ * @brief
+ *	-send async run jobs batch request
+ *
+ * @par
+ *	Each job in jobids is run on the matching entry of locations, just as
+ *	a separate pbs_asyrunjob() call would.  The server reports the result
+ *	of every job.
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobids - NULL terminated list of job identifiers
+ * @param[in] locations - vnodes/resources to be allocated to each job, may be
+ *			  NULL or hold NULL entries for no location
+ *
+ * @return      job_err_info *
+ * @retval      array of one entry per job in jobids, in the same order. The
+ *		caller must free it.
+ * @retval      NULL	error, pbs_errno is set
+ *
+ */
+job_err_info *
+__pbs_asyrunjobs(int c, char **jobids, char **locations)
+{
+	int	rc;
+	int	i;
+	int	sock;
+	job_err_info *ret = NULL;
+
+	if ((jobids == NULL) || (jobids[0] == NULL)) {
+		pbs_errno = PBSE_IVALREQ;
+		return NULL;
+	}
+	for (i = 0; jobids[i] != NULL; i++) {
+		if (*jobids[i] == '\0') {
+			pbs_errno = PBSE_IVALREQ;
+			return NULL;
+		}
+	}
+
+	sock = connection[c].ch_socket;
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return NULL;
+
+	/* setup DIS support routines for following DIS calls */
+
+	DIS_tcp_setup(sock);
+
+	/* send run request */
+
+	if ((rc = encode_DIS_ReqHdr(sock, PBS_BATCH_AsyrunJobs,
+		pbs_current_user)) ||
+		(rc = encode_DIS_RunJobs(sock, jobids, locations)) ||
+		(rc = encode_DIS_ReqExtend(sock, NULL))) {
+		connection[c].ch_errtxt = strdup(dis_emsg[rc]);
+		if (connection[c].ch_errtxt == NULL) {
+			pbs_errno = PBSE_SYSTEM;
+		} else {
+			pbs_errno = PBSE_PROTOCOL;
+		}
+		(void)pbs_client_thread_unlock_connection(c);
+		return NULL;
+	}
+
+	if (DIS_tcp_wflush(sock)) {
+		pbs_errno = PBSE_PROTOCOL;
+		(void)pbs_client_thread_unlock_connection(c);
+		return NULL;
+	}
+
+	/* get reply */
+
+	ret = PBSD_rdrpy_job_errs(c);
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0) {
+		free(ret);
+		return NULL;
+	}
+
+	return ret;
+}
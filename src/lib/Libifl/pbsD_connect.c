@@ -60,6 +60,9 @@
 #include <sys/time.h>
 #include <netinet/in.h>
 #ifndef WIN32
+#include <poll.h>
+#endif
+#ifndef WIN32
 #include <netinet/tcp.h>
 #endif
 #include <arpa/inet.h>
@@ -556,6 +559,333 @@ get_hostsockaddr(char *host, struct sockaddr_in *sap)
 	return -1;
 }
 
+/**
+ * @brief
+ *	Send the PBS_BATCH_Connect request on a new connection and read the
+ *	server's reply.
+ *
+ * @par Functionality:
+ *	Without extend data of its own, the request offers the binary wire
+ *	format (DIS_BINARY_OFFER).  A server that supports it echoes the offer
+ *	back, and both ends switch to DIS_FMT_BINARY after this reply; an
+ *	older server ignores the offer and just acks.
+ *
+ * @param[in]   out - index into the connection table
+ * @param[in]   extend_data - a string to send as "extend" data, or NULL
+ *
+ * @return int
+ * @retval 0	success
+ * @retval -1	error, pbs_errno set
+ */
+static int
+send_connect_request(int out, char *extend_data)
+{
+	int sock = connection[out].ch_socket;
+	char *connect_extend = extend_data;
+	char offers[sizeof(DIS_BINARY_OFFER) + sizeof(PIPELINE_OFFER) + 1];
+	struct batch_reply *reply;
+
+	DIS_tcp_setup(sock);
+	DIS_tcp_set_fmt(sock, DIS_FMT_ASCII);
+	connection[out].ch_pipelined = 0;
+
+#ifndef WIN32
+	if (extend_data == NULL) {
+		snprintf(offers, sizeof(offers), "%s%c%s",
+			DIS_BINARY_OFFER, CONNECT_OFFER_SEP, PIPELINE_OFFER);
+		connect_extend = offers;
+	}
+#endif
+
+	if (encode_DIS_ReqHdr(sock, PBS_BATCH_Connect, pbs_current_user) ||
+		encode_DIS_ReqExtend(sock, connect_extend)) {
+		pbs_errno = PBSE_SYSTEM;
+		return -1;
+	}
+	if (DIS_tcp_wflush(sock)) {
+		pbs_errno = PBSE_SYSTEM;
+		return -1;
+	}
+
+	reply = PBSD_rdrpy(out);
+	if (connect_extend != extend_data && reply != NULL &&
+		reply->brp_code == 0 &&
+		reply->brp_choice == BATCH_REPLY_CHOICE_Text &&
+		reply->brp_un.brp_txt.brp_str != NULL) {
+		if (connect_offer_listed(reply->brp_un.brp_txt.brp_str, DIS_BINARY_OFFER))
+			DIS_tcp_set_fmt(sock, DIS_FMT_BINARY);
+		if (connect_offer_listed(reply->brp_un.brp_txt.brp_str, PIPELINE_OFFER) &&
+			DIS_tcp_set_pipelined(sock) == 0)
+			connection[out].ch_pipelined = 1;
+	}
+	PBSD_FreeReply(reply);
+	return 0;
+}
+
+/*
+ * A parked connection older than this is not reused.  The server drops
+ * connections idle for PBS_NET_MAXCONNECTIDLE, and reusing one just as the
+ * server closes it would fail the caller's next request.
+ */
+#define CONN_REUSE_MAXIDLE	(PBS_NET_MAXCONNECTIDLE / 2)
+
+static int conn_reuse_atexit = 0;
+
+/**
+ * @brief
+ *	Check that nothing is waiting to be read on a connection.  An idle
+ *	connection the server has since closed polls readable (EOF), as does
+ *	one holding the unread reply to an abandoned request.
+ *
+ * @param[in] sock - socket of the connection
+ *
+ * @return int
+ * @retval 1	connection is quiet
+ * @retval 0	connection has data or EOF pending, or is broken
+ */
+static int
+conn_is_quiet(int sock)
+{
+#ifdef WIN32
+	return 0;
+#else
+	struct pollfd pfd;
+
+	if (DIS_tcp_pending(sock) > 0)
+		return 0;
+	pfd.fd = sock;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	return (poll(&pfd, 1, 0) == 0);
+#endif
+}
+
+/**
+ * @brief
+ *	Close a connection and free its table entry.
+ *
+ * @par
+ *	When 'notify' is set, and the connection was opened by this process,
+ *	a Disconnect request is sent first and the server is given the chance
+ *	to close its end.  A forked child only closes its copy of the socket,
+ *	so it never ends a session its parent still holds.
+ *
+ * @param[in] connect - connection index
+ * @param[in] notify - send a Disconnect request first
+ *
+ * @return void
+ */
+static void
+drop_connection(int connect, int notify)
+{
+	int  sock;
+	char x;
+
+	sock = connection[connect].ch_socket;
+
+	if (notify && connection[connect].ch_pid == getpid()) {
+		/* send close-connection message */
+		DIS_tcp_setup(sock);
+		if ((encode_DIS_ReqHdr(sock, PBS_BATCH_Disconnect,
+			pbs_current_user) == 0) &&
+			(DIS_tcp_wflush(sock) == 0)) {
+			for (;;) {	/* wait for server to close connection */
+#ifdef WIN32
+				if (recv(sock, &x, 1, 0) < 1)
+#else
+				if (read(sock, &x, 1) < 1)
+#endif
+					break;
+			}
+		}
+	}
+
+	CS_close_socket(sock);
+	CLOSESOCKET(sock);
+
+	DIS_tcp_release(sock);
+
+	if (connection[connect].ch_errtxt != NULL) {
+		free(connection[connect].ch_errtxt);
+		connection[connect].ch_errtxt = NULL;
+	}
+	PBSD_async_free(connect);
+	connection[connect].ch_errno = 0;
+	connection[connect].ch_idle = 0;
+	connection[connect].ch_inuse = 0;
+}
+
+/**
+ * @brief
+ *	Registered with atexit() once a connection has been parked.  Ends
+ *	the sessions of the connections still idle, as pbs_disconnect()
+ *	would have without reuse.
+ *
+ * @return void
+ */
+static void
+close_idle_connections(void)
+{
+	int i;
+
+	for (i = 1; i < NCONNECTS; i++) {
+		if (connection[i].ch_inuse && connection[i].ch_idle)
+			drop_connection(i, 1);
+	}
+}
+
+/**
+ * @brief
+ *	Keep a connection open for reuse instead of disconnecting it.
+ *
+ * @par
+ *	Only a connection made without extend data, by this process, and
+ *	with no reply left unread, is parked, and only while fewer than
+ *	PBS_CONN_REUSE connections are already idle.
+ *
+ * @param[in] connect - connection index, locked by the caller
+ *
+ * @return int
+ * @retval 0	connection parked
+ * @retval -1	connection must be closed
+ */
+static int
+park_connection(int connect)
+{
+	int i;
+	unsigned int nidle = 0;
+	int rc = -1;
+
+	if (pbs_conf.pbs_conn_reuse == 0 ||
+		connection[connect].ch_server[0] == '\0' ||
+		connection[connect].ch_pid != getpid() ||
+		pbs_async_pending(connect) > 0)
+		return -1;
+
+	if (!conn_is_quiet(connection[connect].ch_socket))
+		return -1;
+
+	if (pbs_client_thread_lock_conntable() != 0)
+		return -1;
+
+	for (i = 1; i < NCONNECTS; i++) {
+		if (connection[i].ch_inuse && connection[i].ch_idle)
+			nidle++;
+	}
+	if (nidle < pbs_conf.pbs_conn_reuse) {
+		if (connection[connect].ch_errtxt != NULL) {
+			free(connection[connect].ch_errtxt);
+			connection[connect].ch_errtxt = NULL;
+		}
+		connection[connect].ch_errno = 0;
+		connection[connect].ch_idle_since = time(NULL);
+		connection[connect].ch_idle = 1;
+		if (!conn_reuse_atexit) {
+			conn_reuse_atexit = 1;
+			(void)atexit(close_idle_connections);
+		}
+		rc = 0;
+	}
+
+	(void)pbs_client_thread_unlock_conntable();
+	return rc;
+}
+
+/**
+ * @brief
+ *	Take over an idle connection to the given server, if one is parked.
+ *
+ * @par
+ *	A candidate that has gone stale, or that the server has closed, is
+ *	closed and the search goes on.  On success the connection is set up
+ *	for the calling thread exactly as a new connection would be.
+ *
+ * @param[in] server_name - server name as returned by PBS_get_server()
+ * @param[in] server_port - server port
+ *
+ * @return int
+ * @retval >= 0	index of the reused connection
+ * @retval -1	no usable idle connection
+ */
+static int
+reuse_connection(char *server_name, unsigned int server_port)
+{
+	int i;
+	int out;
+	pid_t mypid = getpid();
+
+	if (pbs_conf.pbs_conn_reuse == 0)
+		return -1;
+
+	for (;;) {
+		if (pbs_client_thread_lock_conntable() != 0)
+			return -1;
+		out = -1;
+		for (i = 1; i < NCONNECTS; i++) {
+			if (!connection[i].ch_inuse || !connection[i].ch_idle)
+				continue;
+			if (connection[i].ch_pid != mypid ||
+				connection[i].ch_port != server_port ||
+				strcmp(connection[i].ch_server, server_name) != 0 ||
+				strcmp(connection[i].ch_user, pbs_current_user) != 0)
+				continue;
+			connection[i].ch_idle = 0;
+			out = i;
+			break;
+		}
+		(void)pbs_client_thread_unlock_conntable();
+
+		if (out < 0)
+			return -1;
+
+		if ((time(NULL) - connection[out].ch_idle_since) < CONN_REUSE_MAXIDLE &&
+			conn_is_quiet(connection[out].ch_socket))
+			break;
+
+		drop_connection(out, 0);
+	}
+
+	if (pbs_client_thread_init_connect_context(out) != 0) {
+		drop_connection(out, 1);
+		return -1;
+	}
+
+	strcpy(pbs_server, server_name); /* set for error messages from commands */
+	DIS_tcp_setup(connection[out].ch_socket);
+	pbs_tcp_timeout = PBS_DIS_TCP_TIMEOUT_VLONG;	/* set for 3 hours */
+
+	return out;
+}
+
+/**
+ * @brief
+ *	Check whether a Connect extend, or the server's reply to it, lists
+ *	an offer.  Offers are separated by CONNECT_OFFER_SEP.
+ *
+ * @param[in] list - the extend or reply text
+ * @param[in] offer - offer looked for, e.g. DIS_BINARY_OFFER
+ *
+ * @return int
+ * @retval 1	listed
+ * @retval 0	not listed
+ */
+int
+connect_offer_listed(char *list, char *offer)
+{
+	size_t len = strlen(offer);
+	char *p = list;
+
+	while (p != NULL) {
+		if (strncmp(p, offer, len) == 0 &&
+			(p[len] == '\0' || p[len] == CONNECT_OFFER_SEP))
+			return 1;
+		p = strchr(p, CONNECT_OFFER_SEP);
+		if (p != NULL)
+			p++;
+	}
+	return 0;
+}
+
 /**
  * @brief
  *	Makes a PBS_BATCH_Connect request to 'server'.
@@ -578,7 +908,6 @@ __pbs_connect_extend(char *server, char *extend_data)
 	int f;
 	char  *altservers[2];
 	int    have_alt = 0;
-	struct batch_reply	*reply;
 	char server_name[PBS_MAXSERVERNAME+1];
 	unsigned int server_port;
 	struct sockaddr_in sockname;
@@ -609,6 +938,13 @@ __pbs_connect_extend(char *server, char *extend_data)
 		return -1;
 	}
 
+	/* a plain connect may take over a session this process parked */
+	if (extend_data == NULL) {
+		out = reuse_connection(server, server_port);
+		if (out >= 0)
+			return out;
+	}
+
 	if (pbs_conf.pbs_primary && pbs_conf.pbs_secondary) {
 		/* failover configuered ...   */
 		if (hostnmcmp(server, pbs_conf.pbs_primary) == 0) {
@@ -659,6 +995,18 @@ __pbs_connect_extend(char *server, char *extend_data)
 		connection[out].ch_socket= -1;
 		connection[out].ch_errtxt = NULL;
 		connection[out].ch_inuse = 1; /* reserve the socket */
+		connection[out].ch_idle = 0;
+		connection[out].ch_pipelined = 0;
+		connection[out].ch_pid = getpid();
+		connection[out].ch_port = server_port;
+		connection[out].ch_server[0] = '\0';
+		if (extend_data == NULL) {
+			/* only a plain session can be handed to a later connect */
+			snprintf(connection[out].ch_server,
+				sizeof(connection[out].ch_server), "%s", server);
+			snprintf(connection[out].ch_user,
+				sizeof(connection[out].ch_user), "%s", pbs_current_user);
+		}
 		break;
 	}
 
@@ -784,23 +1132,12 @@ __pbs_connect_extend(char *server, char *extend_data)
 #if !defined(PBS_SECURITY ) || (PBS_SECURITY == STD) || (PBS_SECURITY == KRB5)
 
 	DIS_tcp_setup(connection[out].ch_socket);
+	DIS_tcp_set_fmt(connection[out].ch_socket, DIS_FMT_ASCII);
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 	if (getenv("PBSPRO_IGNORE_KERBEROS") || !pbs_gss_can_get_creds()) {
 #endif
-		if ((i = encode_DIS_ReqHdr(connection[out].ch_socket,
-			PBS_BATCH_Connect, pbs_current_user)) ||
-			(i = encode_DIS_ReqExtend(connection[out].ch_socket,
-			extend_data))) {
-			pbs_errno = PBSE_SYSTEM;
+		if (send_connect_request(out, extend_data) != 0)
 			return -1;
-		}
-		if (DIS_tcp_wflush(connection[out].ch_socket)) {
-			pbs_errno = PBSE_SYSTEM;
-			return -1;
-		}
-
-		reply = PBSD_rdrpy(out);
-		PBSD_FreeReply(reply);
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 	}
 #endif
@@ -818,6 +1155,7 @@ __pbs_connect_extend(char *server, char *extend_data)
 		server,
 		server_port,
 		&sockname) == -1) {
+		DIS_tcp_release(connection[out].ch_socket);
 		CLOSESOCKET(connection[out].ch_socket);
 		connection[out].ch_inuse = 0;
 		pbs_errno = PBSE_PERM;
@@ -834,6 +1172,7 @@ __pbs_connect_extend(char *server, char *extend_data)
 	 * Nagle's algorithm is hurting cmd-server communication.
 	 */
 	if (pbs_connection_set_nodelay(out) == -1) {
+		DIS_tcp_release(connection[out].ch_socket);
 		CLOSESOCKET(connection[out].ch_socket);
 		connection[out].ch_inuse = 0;
 		pbs_errno = PBSE_SYSTEM;
@@ -908,13 +1247,11 @@ __pbs_connect(char *server)
 int
 __pbs_disconnect(int connect)
 {
-	int  sock;
-	char x;
-
 	if (connect < 0 || NCONNECTS <= connect)
 		return 0;
 
-	if (!connection[connect].ch_inuse)
+	/* a parked connection no longer belongs to the caller */
+	if (!connection[connect].ch_inuse || connection[connect].ch_idle)
 		return 0;
 
 	/* initialize the thread context data, if not already initialized */
@@ -932,40 +1269,14 @@ __pbs_disconnect(int connect)
 	 * check again to ensure that another racing thread
 	 * had not already closed the connection
 	 */
-	if (!connection[connect].ch_inuse) {
+	if (!connection[connect].ch_inuse || connection[connect].ch_idle) {
 		(void)pbs_client_thread_unlock_connection(connect);
 		return 0;
 	}
 
-	/* send close-connection message */
-
-	sock = connection[connect].ch_socket;
-
-	DIS_tcp_setup(sock);
-	if ((encode_DIS_ReqHdr(sock, PBS_BATCH_Disconnect,
-		pbs_current_user) == 0) &&
-		(DIS_tcp_wflush(sock) == 0)) {
-		for (;;) {	/* wait for server to close connection */
-#ifdef WIN32
-			if (recv(sock, &x, 1, 0) < 1)
-#else
-			if (read(sock, &x, 1) < 1)
-#endif
-				break;
-		}
-	}
-
-	CS_close_socket(sock);
-	CLOSESOCKET(sock);
-
-	DIS_tcp_release(sock);
-
-	if (connection[connect].ch_errtxt != NULL) {
-		free(connection[connect].ch_errtxt);
-		connection[connect].ch_errtxt = NULL;
-	}
-	connection[connect].ch_errno = 0;
-	connection[connect].ch_inuse = 0;
+	/* keep the session for a later connect, or end it */
+	if (park_connection(connect) != 0)
+		drop_connection(connect, 1);
 
 	/* unlock the connection level lock */
 	if (pbs_client_thread_unlock_connection(connect) != 0)
@@ -1027,7 +1338,6 @@ pbs_connect_noblk(char *server, int tout)
 	int n;
 	struct timeval tv;
 	fd_set fdset;
-	struct batch_reply *reply;
 	char server_name[PBS_MAXSERVERNAME+1];
 	unsigned int server_port;
 	struct addrinfo *aip, *pai;
@@ -1076,6 +1386,9 @@ pbs_connect_noblk(char *server, int tout)
 		connection[out].ch_errno = 0;
 		connection[out].ch_socket= -1;
 		connection[out].ch_errtxt = NULL;
+		connection[out].ch_idle = 0;
+		connection[out].ch_pipelined = 0;
+		connection[out].ch_server[0] = '\0'; /* never reused */
 		break;
 	}
 
@@ -1246,20 +1559,8 @@ err:
 	 */
 
 	/* send "dummy" connect message */
-	DIS_tcp_setup(connection[out].ch_socket);
-	if ((i = encode_DIS_ReqHdr(connection[out].ch_socket,
-		PBS_BATCH_Connect, pbs_current_user)) ||
-		(i = encode_DIS_ReqExtend(connection[out].ch_socket,
-		NULL))) {
-		pbs_errno = PBSE_SYSTEM;
+	if (send_connect_request(out, NULL) != 0)
 		return -1;
-	}
-	if (DIS_tcp_wflush(connection[out].ch_socket)) {
-		pbs_errno = PBSE_SYSTEM;
-		return -1;
-	}
-	reply = PBSD_rdrpy(out);
-	PBSD_FreeReply(reply);
 
 	/*do configured authentication (kerberos, pbs_iff, whatever)*/
 
@@ -1271,6 +1572,7 @@ err:
 		server,
 		server_port,
 		&sockname) == -1) {
+		DIS_tcp_release(connection[out].ch_socket);
 		CLOSESOCKET(connection[out].ch_socket);
 		connection[out].ch_inuse = 0;
 		pbs_errno = PBSE_PERM;
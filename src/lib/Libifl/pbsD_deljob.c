@@ -40,12 +40,18 @@
  * @brief
  * Send the Delete Job request to the server
  * really just an instance of the manager request
+ *
+ * and the Delete Jobs request, which deletes many jobs at once
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
 #include "libpbs.h"
+#include "dis.h"
+#include "pbs_ecl.h"
 
 
 /**
@@ -78,3 +84,89 @@ __pbs_deljob(int c, char *jobid, char *extend)
 		aoplp,
 		extend);
 }
+
+/**
+ * @brief
+ *	Send the Delete Jobs request to the server
+ *
+ * @par
+ *	Each job in jobids is deleted as a separate pbs_deljob() call with the
+ *	same extend would delete it.  The server reports the result of every
+ *	job.
+ *
+ * @param[in] c - connection handler
+ * @param[in] jobids - NULL terminated list of job identifiers
+ * @param[in] extend - string to encode req, applied to every job
+ *
+ * @return      job_err_info *
+ * @retval      array of one entry per job in jobids, in the same order. The
+ *		caller must free it.
+ * @retval      NULL	error, pbs_errno is set
+ *
+ */
+job_err_info *
+__pbs_deljobs(int c, char **jobids, char *extend)
+{
+	int	rc;
+	int	i;
+	int	sock;
+	job_err_info *ret = NULL;
+
+	if ((jobids == NULL) || (jobids[0] == NULL)) {
+		pbs_errno = PBSE_IVALREQ;
+		return NULL;
+	}
+	for (i = 0; jobids[i] != NULL; i++) {
+		if (*jobids[i] == '\0') {
+			pbs_errno = PBSE_IVALREQ;
+			return NULL;
+		}
+	}
+
+	sock = connection[c].ch_socket;
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return NULL;
+
+	/* setup DIS support routines for following DIS calls */
+
+	DIS_tcp_setup(sock);
+
+	if ((rc = encode_DIS_ReqHdr(sock, PBS_BATCH_DeleteJobs,
+		pbs_current_user)) ||
+		(rc = encode_DIS_DeleteJobs(sock, jobids)) ||
+		(rc = encode_DIS_ReqExtend(sock, extend))) {
+		connection[c].ch_errtxt = strdup(dis_emsg[rc]);
+		if (connection[c].ch_errtxt == NULL) {
+			pbs_errno = PBSE_SYSTEM;
+		} else {
+			pbs_errno = PBSE_PROTOCOL;
+		}
+		(void)pbs_client_thread_unlock_connection(c);
+		return NULL;
+	}
+
+	if (DIS_tcp_wflush(sock)) {
+		pbs_errno = PBSE_PROTOCOL;
+		(void)pbs_client_thread_unlock_connection(c);
+		return NULL;
+	}
+
+	/* get reply */
+
+	ret = PBSD_rdrpy_job_errs(c);
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0) {
+		free(ret);
+		return NULL;
+	}
+
+	return ret;
+}
@@ -38,12 +38,15 @@
 /**
  * @file	pbs_manager.c
  * @brief
- * Basically a pass-thru to PBS_manager
+ * Basically a pass-thru to PBS_manager, and the Manager Many request
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
 
+#include <string.h>
 #include "libpbs.h"
+#include "dis.h"
+#include "pbs_ecl.h"
 
 
 /**
@@ -74,3 +77,123 @@ __pbs_manager(int c, int command, int objtype, char *objname,
 		attrib,
 		extend);
 }
+
+/**
+ * @brief
+ *	-Send many Manager directives in one Manager Many request
+ *
+ * @par
+ *	The server applies the directives in order, as it would the same
+ *	pbs_manager() calls, and saves what they change to its database in
+ *	one transaction.  Each directive is verified as pbs_manager() does;
+ *	one that fails verification is not sent and its entry carries the
+ *	error.
+ *
+ * @param[in] c - connection handle
+ * @param[in] count - number of directives
+ * @param[in] ops - the directives
+ * @param[in] extend - extend string to encode req
+ *
+ * @return      job_err_info *
+ * @retval      array of one entry per directive, in the same order, with
+ *		the object name and the error code for that directive.  The
+ *		caller must free it.
+ * @retval      NULL	error, pbs_errno is set.  PBSE_UNKREQ means the
+ *		server does not know the request.
+ *
+ */
+job_err_info *
+__pbs_manager_many(int c, int count, struct manage_op *ops, char *extend)
+{
+	int		i;
+	int		n = 0;
+	int		rc;
+	int		sock;
+	int		*idx = NULL;
+	struct manage_op *s_ops = NULL;
+	job_err_info	*ret = NULL;
+	job_err_info	*pje = NULL;
+
+	if ((count <= 0) || (ops == NULL)) {
+		pbs_errno = PBSE_IVALREQ;
+		return NULL;
+	}
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	ret = calloc(count, sizeof(job_err_info));
+	idx = calloc(count, sizeof(int));
+	s_ops = calloc(count, sizeof(struct manage_op));
+	if (!ret || !idx || !s_ops) {
+		pbs_errno = PBSE_SYSTEM;
+		free(ret);
+		ret = NULL;
+		goto done;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (ops[i].objname != NULL)
+			strncpy(ret[i].job_id, ops[i].objname, PBS_MAXSVRJOBID);
+		/* verify the object name if creating a new one */
+		if ((ops[i].command == MGR_CMD_CREATE) &&
+			(pbs_verify_object_name(ops[i].objtype, ops[i].objname) != 0)) {
+			ret[i].errcode = pbs_errno;
+			continue;
+		}
+		/* and its attributes, if verification is enabled */
+		if (pbs_verify_attributes(c, PBS_BATCH_Manager, ops[i].objtype,
+			ops[i].command, ops[i].attribs) != 0) {
+			ret[i].errcode = pbs_errno;
+			continue;
+		}
+		s_ops[n] = ops[i];
+		idx[n++] = i;
+	}
+	pbs_errno = PBSE_NONE;
+	if (n == 0)
+		goto done;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0) {
+		free(ret);
+		ret = NULL;
+		goto done;
+	}
+
+	sock = connection[c].ch_socket;
+	DIS_tcp_setup(sock);
+
+	if ((rc = encode_DIS_ReqHdr(sock, PBS_BATCH_ManagerMany, pbs_current_user)) ||
+		(rc = encode_DIS_ManageMany(sock, n, s_ops)) ||
+		(rc = encode_DIS_ReqExtend(sock, extend))) {
+		connection[c].ch_errtxt = strdup(dis_emsg[rc]);
+		if (connection[c].ch_errtxt == NULL)
+			pbs_errno = PBSE_SYSTEM;
+		else
+			pbs_errno = PBSE_PROTOCOL;
+	} else if (DIS_tcp_wflush(sock)) {
+		pbs_errno = PBSE_PROTOCOL;
+	} else if ((pje = PBSD_rdrpy_job_errs(c)) != NULL) {
+		for (i = 0; i < n; i++)
+			ret[idx[i]].errcode = pje[i].errcode;
+		free(pje);
+	}
+	if (pje == NULL) {
+		free(ret);
+		ret = NULL;
+	}
+
+	/* unlock the thread lock and update the thread context data */
+	if ((pbs_client_thread_unlock_connection(c) != 0) && (ret != NULL)) {
+		free(ret);
+		ret = NULL;
+	}
+
+done:
+	free(idx);
+	free(s_ops);
+	return ret;
+}
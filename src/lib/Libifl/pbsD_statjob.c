@@ -38,12 +38,14 @@
 /**
  * @file	pbs_statjob.c
  *
- * Return the status of a job.
+ * Return the status of a job, of jobs a page at a time, or of the jobs
+ * meeting some criteria.
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include "libpbs.h"
+#include "dis.h"
 #include "pbs_ecl.h"
 
 
@@ -86,3 +88,211 @@ __pbs_statjob(int c, char *id, struct attrl *attrib, char *extend)
 
 	return ret;
 }
+
+/**
+ * @brief
+ *	-Return the status of the jobs of a queue or server a page at a time.
+ *
+ * @par
+ *	The caller starts with an empty cursor and calls again with the cursor
+ *	this returns until it comes back empty.  Each call returns at most
+ *	count jobs (and with 't' in extend their subjobs), possibly none if
+ *	the ones it went over are not to be returned.
+ *
+ * @param[in] c - communication handle
+ * @param[in] id - queue or server, null for all the jobs at the server
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] extend - extend string for req
+ * @param[in] count - number of jobs per page
+ * @param[in,out] cursor - PBS_STAT_CURSOR_LEN buffer, where the next page
+ *			   starts, set to "" after the last page
+ *
+ * @return	structure handle
+ * @retval	pointer to batch_status struct		success
+ * @retval	NULL					error or no jobs in the page,
+ *							pbs_errno is set on error
+ *
+ */
+struct batch_status *
+pbs_statjob_page(int c, char *id, struct attrl *attrib, char *extend, int count, char *cursor)
+{
+	struct batch_status *ret;
+	struct batch_status *pbs;
+	struct batch_status *prev = NULL;
+	struct attrl *pat;
+	char *ext;
+	size_t len;
+
+	if ((count <= 0) || (cursor == NULL)) {
+		pbs_errno = PBSE_IVALREQ;
+		return NULL;
+	}
+
+	len = (extend ? strlen(extend) : 0) + PBS_STAT_CURSOR_LEN + 16;
+	if ((ext = malloc(len)) == NULL) {
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+	if (*cursor != '\0')
+		snprintf(ext, len, "%s%c%d,%s", extend ? extend : "", EXTEND_PAGE, count, cursor);
+	else
+		snprintf(ext, len, "%s%c%d", extend ? extend : "", EXTEND_PAGE, count);
+
+	ret = pbs_statjob(c, id, attrib, ext);
+	free(ext);
+	*cursor = '\0';
+
+	/* take the cursor of the next page off the reply */
+	for (pbs = ret; pbs != NULL; prev = pbs, pbs = pbs->next) {
+		for (pat = pbs->attribs; pat != NULL; pat = pat->next) {
+			if (strcmp(pat->name, ATTR_status_cursor) == 0)
+				break;
+		}
+		if (pat != NULL) {
+			snprintf(cursor, PBS_STAT_CURSOR_LEN, "%s", pat->value);
+			if (prev == NULL)
+				ret = pbs->next;
+			else
+				prev->next = pbs->next;
+			pbs->next = NULL;
+			pbs_statfree(pbs);
+			break;
+		}
+	}
+	return ret;
+}
+
+/**
+ * @brief
+ *	-send a Status Job request whose attribute list carries the operator of
+ *	each entry
+ *
+ * @param[in] c - communication handle
+ * @param[in] id - job id, queue or server
+ * @param[in] attrib - attributes to return (SET) and criteria
+ * @param[in] extend - extend string for req
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	!0	error
+ *
+ */
+static int
+PBSD_status_filter_put(int c, char *id, struct attropl *attrib, char *extend)
+{
+	int rc;
+	int sock;
+
+	sock = connection[c].ch_socket;
+	DIS_tcp_setup(sock);
+
+	if ((rc = encode_DIS_ReqHdr(sock, PBS_BATCH_StatusJob, pbs_current_user)) ||
+		(rc = diswst(sock, id)) ||
+		(rc = encode_DIS_attropl(sock, attrib)) ||
+		(rc = encode_DIS_ReqExtend(sock, extend))) {
+		connection[c].ch_errtxt = strdup(dis_emsg[rc]);
+		if (connection[c].ch_errtxt == NULL)
+			return (pbs_errno = PBSE_SYSTEM);
+		return (pbs_errno = PBSE_PROTOCOL);
+	}
+
+	if (DIS_tcp_wflush(sock))
+		return (pbs_errno = PBSE_PROTOCOL);
+
+	return 0;
+}
+
+/**
+ * @brief
+ *	-Return the status of the jobs meeting some criteria.
+ *
+ * @par
+ *	The criteria are those of pbs_selstat(): each entry of filter compares
+ *	an attribute (or resource) of the job with its value using EQ, NE, GE,
+ *	GT, LE or LT, and a job must meet all of them.  The server checks them
+ *	before it encodes the job, so only the jobs meeting them, with only the
+ *	attributes in attrib, are sent.  Unlike pbs_selstat() this is a Status
+ *	Job request: id, the extend flags and the reply are those of
+ *	pbs_statjob().  A server which does not know the criteria returns them
+ *	as attributes and does not filter.
+ *
+ * @param[in] c - communication handle
+ * @param[in] id - job id, queue or server, null for all the jobs at the server
+ * @param[in] attrib - attributes to return, null for all
+ * @param[in] filter - the criteria, null for none
+ * @param[in] extend - extend string for req
+ *
+ * @return	structure handle
+ * @retval	pointer to batch_status struct		success
+ * @retval	NULL					error or no job meets them,
+ *							pbs_errno is set on error
+ *
+ */
+struct batch_status *
+pbs_statjob_filter(int c, char *id, struct attrl *attrib, struct attropl *filter, char *extend)
+{
+	struct batch_status *ret = NULL;
+	struct attropl *list;
+	struct attrl *pat;
+	struct attropl *pop;
+	int n = 0;
+	int i = 0;
+
+	if (filter == NULL)
+		return pbs_statjob(c, id, attrib, extend);
+
+	for (pop = filter; pop != NULL; pop = pop->next) {
+		if ((pop->op < EQ) || (pop->op > LT) || (pop->name == NULL) ||
+			(pop->value == NULL)) {
+			pbs_errno = PBSE_IVALREQ;
+			return NULL;
+		}
+		n++;
+	}
+	for (pat = attrib; pat != NULL; pat = pat->next)
+		n++;
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	/* first verify the attributes, if verification is enabled */
+	if ((pbs_verify_attributes(c, PBS_BATCH_StatusJob,
+		MGR_OBJ_JOB, MGR_CMD_NONE, (struct attropl *) attrib)) ||
+		(pbs_verify_attributes(c, PBS_BATCH_SelectJobs,
+		MGR_OBJ_JOB, MGR_CMD_NONE, filter)))
+		return NULL;
+
+	/* the attributes to return, then the criteria */
+	if ((list = calloc(n, sizeof(struct attropl))) == NULL) {
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+	for (pat = attrib; pat != NULL; pat = pat->next, i++) {
+		list[i].name = pat->name;
+		list[i].resource = pat->resource;
+		list[i].value = pat->value ? pat->value : "";
+		list[i].op = SET;
+		list[i].next = &list[i + 1];
+	}
+	for (pop = filter; pop != NULL; pop = pop->next, i++) {
+		list[i] = *pop;
+		list[i].next = &list[i + 1];
+	}
+	list[n - 1].next = NULL;
+
+	if (pbs_client_thread_lock_connection(c) != 0) {
+		free(list);
+		return NULL;
+	}
+
+	if (PBSD_status_filter_put(c, id ? id : "", list, extend) == 0)
+		ret = PBSD_status_get(c);
+	free(list);
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return NULL;
+
+	return ret;
+}
@@ -44,14 +44,17 @@
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <strings.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <assert.h>
 #include "libpbs.h"
 #include "credential.h"
 #include "pbs_ecl.h"
 #include "pbs_client_thread.h"
+#include "dis.h"
 
 #include "ticket.h"
 
@@ -243,3 +246,187 @@ error:
 	(void)pbs_client_thread_unlock_connection(c);
 	return NULL;
 }
+
+/**
+ * @brief
+ *	-read a whole job script into memory
+ *
+ * @param[in] script - path of the script
+ * @param[out] len - size of the script
+ *
+ * @return	char *
+ * @retval	malloc'ed script contents	success
+ * @retval	NULL				the script could not be read
+ */
+static char *
+read_script_file(char *script, size_t *len)
+{
+	int		fd;
+	struct stat	sb;
+	char		*buf;
+	size_t		got = 0;
+	ssize_t		cc;
+
+	if ((fd = open(script, O_RDONLY, 0)) < 0)
+		return NULL;
+	if ((fstat(fd, &sb) == -1) || ((buf = malloc(sb.st_size + 1)) == NULL)) {
+		close(fd);
+		return NULL;
+	}
+	while (got < (size_t)sb.st_size) {
+		cc = read(fd, buf + got, sb.st_size - got);
+		if (cc <= 0)
+			break;
+		got += cc;
+	}
+	close(fd);
+	if (got != (size_t)sb.st_size) {
+		free(buf);
+		return NULL;
+	}
+	buf[got] = '\0';
+	*len = got;
+	return buf;
+}
+
+/**
+ * @brief
+ *	-submit a batch of jobs in one request
+ *
+ * @par
+ *	Job i is built from attribs[i], the script file scripts[i] and the
+ *	queue destinations[i], as pbs_submit() would build it.  Every job is
+ *	queued with one Submit Jobs request and one reply instead of the
+ *	Queue Job, Job Script and Commit exchanges of each pbs_submit().
+ *	Jobs whose attributes fail verification, or whose script cannot be
+ *	read, are not sent and carry that error in their result.  Credentials
+ *	set up by pbs_submit_with_cred() are not sent.
+ *
+ * @param[in] c - connection handle
+ * @param[in] count - number of jobs
+ * @param[in] attribs - attribute list of each job
+ * @param[in] scripts - script path of each job, may be NULL or hold NULL or
+ *			empty entries for jobs without a script
+ * @param[in] destinations - queue of each job, may be NULL or hold NULL
+ *			     entries for the default queue
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return      job_err_info *
+ * @retval      array of one entry per job, in the same order, with the new
+ *		job id or the error code of the job.  The caller must free it.
+ * @retval      NULL	error, pbs_errno is set.  A server that predates
+ *			the request rejects it with PBSE_UNKREQ; the jobs
+ *			can then be sent with pbs_submit().
+ *
+ */
+job_err_info *
+__pbs_submit_many(int c, int count, struct attropl **attribs, char **scripts,
+	char **destinations, char *extend)
+{
+	int		i;
+	int		n = 0;
+	int		rc;
+	int		sock;
+	int		*idx = NULL;
+	struct attropl	**s_attr = NULL;
+	char		**s_script = NULL;
+	size_t		*s_len = NULL;
+	char		**s_dest = NULL;
+	struct attropl	*pal;
+	job_err_info	*ret = NULL;
+	job_err_info	*pje = NULL;
+
+	if ((count <= 0) || (attribs == NULL)) {
+		pbs_errno = PBSE_IVALREQ;
+		return NULL;
+	}
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	ret = calloc(count, sizeof(job_err_info));
+	idx = calloc(count, sizeof(int));
+	s_attr = calloc(count, sizeof(struct attropl *));
+	s_script = calloc(count, sizeof(char *));
+	s_len = calloc(count, sizeof(size_t));
+	s_dest = calloc(count, sizeof(char *));
+	if (!ret || !idx || !s_attr || !s_script || !s_len || !s_dest) {
+		pbs_errno = PBSE_SYSTEM;
+		goto done;
+	}
+
+	for (i = 0; i < count; i++) {
+		/* first verify the attributes, if verification is enabled */
+		if (pbs_verify_attributes(c, PBS_BATCH_QueueJob,
+			MGR_OBJ_JOB, MGR_CMD_NONE, attribs[i])) {
+			ret[i].errcode = pbs_errno;
+			continue;
+		}
+		for (pal = attribs[i]; pal; pal = pal->next)
+			pal->op = SET;		/* force operator to SET */
+
+		if ((scripts != NULL) && (scripts[i] != NULL) && (*scripts[i] != '\0')) {
+			s_script[n] = read_script_file(scripts[i], &s_len[n]);
+			if (s_script[n] == NULL) {
+				ret[i].errcode = PBSE_BADSCRIPT;
+				continue;
+			}
+		}
+		s_attr[n] = attribs[i];
+		s_dest[n] = (destinations != NULL) ? destinations[i] : NULL;
+		idx[n++] = i;
+	}
+	pbs_errno = PBSE_NONE;
+	if (n == 0)
+		goto done;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0) {
+		free(ret);
+		ret = NULL;
+		goto done;
+	}
+
+	sock = connection[c].ch_socket;
+	DIS_tcp_setup(sock);
+
+	if ((rc = encode_DIS_ReqHdr(sock, PBS_BATCH_SubmitJobs, pbs_current_user)) ||
+		(rc = encode_DIS_SubmitJobs(sock, n, s_attr, s_script, s_len, s_dest)) ||
+		(rc = encode_DIS_ReqExtend(sock, extend))) {
+		connection[c].ch_errtxt = strdup(dis_emsg[rc]);
+		if (connection[c].ch_errtxt == NULL)
+			pbs_errno = PBSE_SYSTEM;
+		else
+			pbs_errno = PBSE_PROTOCOL;
+	} else if (DIS_tcp_wflush(sock)) {
+		pbs_errno = PBSE_PROTOCOL;
+	} else if ((pje = PBSD_rdrpy_job_errs(c)) != NULL) {
+		for (i = 0; i < n; i++)
+			ret[idx[i]] = pje[i];
+		free(pje);
+	}
+	if (pje == NULL) {
+		free(ret);
+		ret = NULL;
+	}
+
+	/* unlock the thread lock and update the thread context data */
+	if ((pbs_client_thread_unlock_connection(c) != 0) && (ret != NULL)) {
+		free(ret);
+		ret = NULL;
+	}
+
+done:
+	if (s_script != NULL) {
+		for (i = 0; i < n; i++)
+			free(s_script[i]);
+	}
+	free(idx);
+	free(s_attr);
+	free(s_script);
+	free(s_len);
+	free(s_dest);
+	return ret;
+}
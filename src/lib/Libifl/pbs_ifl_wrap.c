@@ -8482,6 +8482,7 @@ SWIG_init(void) {
   SWIG_Python_SetConstant(d, "ATTR_license_max",SWIG_FromCharPtr("pbs_license_max"));
   SWIG_Python_SetConstant(d, "ATTR_license_linger",SWIG_FromCharPtr("pbs_license_linger_time"));
   SWIG_Python_SetConstant(d, "ATTR_license_count",SWIG_FromCharPtr("license_count"));
+  SWIG_Python_SetConstant(d, "ATTR_nodestate_count",SWIG_FromCharPtr("node_state_count"));
   SWIG_Python_SetConstant(d, "ATTR_job_sort_formula",SWIG_FromCharPtr("job_sort_formula"));
   SWIG_Python_SetConstant(d, "ATTR_EligibleTimeEnable",SWIG_FromCharPtr("eligible_time_enable"));
   SWIG_Python_SetConstant(d, "ATTR_resv_retry_init",SWIG_FromCharPtr("reserve_retry_init"));
@@ -8519,6 +8520,7 @@ SWIG_init(void) {
   SWIG_Python_SetConstant(d, "ATTR_sched_preempt_prio",SWIG_FromCharPtr("preempt_prio"));
   SWIG_Python_SetConstant(d, "ATTR_sched_preempt_order",SWIG_FromCharPtr("preempt_order"));
   SWIG_Python_SetConstant(d, "ATTR_sched_preempt_sort",SWIG_FromCharPtr("preempt_sort"));
+  SWIG_Python_SetConstant(d, "ATTR_sched_cycle_stats",SWIG_FromCharPtr("sched_cycle_stats"));
   SWIG_Python_SetConstant(d, "ATTR_NODE_Host",SWIG_FromCharPtr("Host"));
   SWIG_Python_SetConstant(d, "ATTR_NODE_Mom",SWIG_FromCharPtr("Mom"));
   SWIG_Python_SetConstant(d, "ATTR_NODE_Port",SWIG_FromCharPtr("Port"));
@@ -121,7 +121,23 @@ struct pbs_config pbs_conf = {
 	0,					/* default comm logevent mask */
 	4,					/* default number of threads */
 	NULL,					/* mom short name override */
-	0					/* high resolution timestamp logging */
+	0,					/* high resolution timestamp logging */
+	0,					/* no server request decode threads */
+	0,					/* job saves are written at once */
+	0,					/* server logs synchronously */
+	0,					/* server writes accounting synchronously */
+	0,					/* finished subjobs are kept as jobs */
+	0,					/* zlib's default compression level */
+	0,					/* client connections are not reused */
+	0,					/* daemon logs are not indexed */
+	0,					/* no binary accounting records */
+	0,					/* host lookups are not cached */
+	0,					/* datastore not readied for a takeover */
+	0,					/* event triggered cycles are not spaced */
+	0,					/* event triggers held back at most the gap */
+	NULL,					/* router threads are not bound to cpus */
+	0,					/* status replies are not kept */
+	0					/* accounting batches are written at once */
 #ifdef WIN32
 	,NULL					/* remote viewer launcher executable along with launch options */
 #endif
@@ -565,6 +581,70 @@ __pbs_loadconf(int reload)
 				if (sscanf(conf_value, "%u", &uvalue) == 1)
 					pbs_conf.pbs_log_highres_timestamp = ((uvalue > 0) ? 1 : 0);
 			}
+			else if (!strcmp(conf_name, PBS_CONF_SERVER_DECODE_THREADS)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_server_decode_threads = uvalue;
+			}
+			else if (!strcmp(conf_name, PBS_CONF_SERVER_JOB_SAVE_WINDOW)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_server_job_save_window = uvalue;
+			}
+			else if (!strcmp(conf_name, PBS_CONF_SERVER_LOG_ASYNC_SIZE)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_server_log_async_size = uvalue;
+			}
+			else if (!strcmp(conf_name, PBS_CONF_SERVER_ACCT_ASYNC_SIZE)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_server_acct_async_size = uvalue;
+			}
+			else if (!strcmp(conf_name, PBS_CONF_SERVER_THIN_SUBJOB_HISTORY)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_server_thin_subjob_history = ((uvalue > 0) ? 1 : 0);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_COMPRESSION_LEVEL)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_compression_level = ((uvalue <= 9) ? uvalue : 9);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_CONN_REUSE)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_conn_reuse = uvalue;
+			}
+			else if (!strcmp(conf_name, PBS_CONF_LOG_INDEX)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_log_index = ((uvalue > 0) ? 1 : 0);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_SERVER_ACCT_BINARY)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_server_acct_binary = ((uvalue > 0) ? 1 : 0);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_HOST_CACHE_TTL)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_host_cache_ttl = uvalue;
+			}
+			else if (!strcmp(conf_name, PBS_CONF_FAILOVER_WARM_TIME)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_failover_warm_time = uvalue;
+			}
+			else if (!strcmp(conf_name, PBS_CONF_SCHED_TRIGGER_GAP)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_sched_trigger_gap = uvalue;
+			}
+			else if (!strcmp(conf_name, PBS_CONF_SCHED_TRIGGER_LATENCY)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_sched_trigger_latency = uvalue;
+			}
+			else if (!strcmp(conf_name, PBS_CONF_COMM_THREAD_CPUS)) {
+				free(pbs_conf.pbs_comm_thread_cpus);
+				pbs_conf.pbs_comm_thread_cpus = strdup(conf_value);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_SERVER_STAT_CACHE_TTL)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_server_stat_cache_ttl = uvalue;
+			}
+			else if (!strcmp(conf_name, PBS_CONF_SERVER_ACCT_ASYNC_FLUSH)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_server_acct_async_flush = uvalue;
+			}
 #ifdef WIN32
 			else if (!strcmp(conf_name, PBS_CONF_REMOTE_VIEWER)) {
 				free(pbs_conf.pbs_conf_remote_viewer);
@@ -798,6 +878,70 @@ __pbs_loadconf(int reload)
 		if (sscanf(gvalue, "%u", &uvalue) == 1)
 			pbs_conf.pbs_log_highres_timestamp = ((uvalue > 0) ? 1 : 0);
 	}
+	if ((gvalue = getenv(PBS_CONF_SERVER_DECODE_THREADS)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_server_decode_threads = uvalue;
+	}
+	if ((gvalue = getenv(PBS_CONF_SERVER_JOB_SAVE_WINDOW)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_server_job_save_window = uvalue;
+	}
+	if ((gvalue = getenv(PBS_CONF_SERVER_LOG_ASYNC_SIZE)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_server_log_async_size = uvalue;
+	}
+	if ((gvalue = getenv(PBS_CONF_SERVER_ACCT_ASYNC_SIZE)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_server_acct_async_size = uvalue;
+	}
+	if ((gvalue = getenv(PBS_CONF_SERVER_THIN_SUBJOB_HISTORY)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_server_thin_subjob_history = ((uvalue > 0) ? 1 : 0);
+	}
+	if ((gvalue = getenv(PBS_CONF_COMPRESSION_LEVEL)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_compression_level = ((uvalue <= 9) ? uvalue : 9);
+	}
+	if ((gvalue = getenv(PBS_CONF_CONN_REUSE)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_conn_reuse = uvalue;
+	}
+	if ((gvalue = getenv(PBS_CONF_LOG_INDEX)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_log_index = ((uvalue > 0) ? 1 : 0);
+	}
+	if ((gvalue = getenv(PBS_CONF_SERVER_ACCT_BINARY)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_server_acct_binary = ((uvalue > 0) ? 1 : 0);
+	}
+	if ((gvalue = getenv(PBS_CONF_HOST_CACHE_TTL)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_host_cache_ttl = uvalue;
+	}
+	if ((gvalue = getenv(PBS_CONF_FAILOVER_WARM_TIME)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_failover_warm_time = uvalue;
+	}
+	if ((gvalue = getenv(PBS_CONF_SCHED_TRIGGER_GAP)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_sched_trigger_gap = uvalue;
+	}
+	if ((gvalue = getenv(PBS_CONF_SCHED_TRIGGER_LATENCY)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_sched_trigger_latency = uvalue;
+	}
+	if ((gvalue = getenv(PBS_CONF_COMM_THREAD_CPUS)) != NULL) {
+		free(pbs_conf.pbs_comm_thread_cpus);
+		pbs_conf.pbs_comm_thread_cpus = strdup(gvalue);
+	}
+	if ((gvalue = getenv(PBS_CONF_SERVER_STAT_CACHE_TTL)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_server_stat_cache_ttl = uvalue;
+	}
+	if ((gvalue = getenv(PBS_CONF_SERVER_ACCT_ASYNC_FLUSH)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_server_acct_async_flush = uvalue;
+	}
 
 #ifdef WIN32
 	if ((gvalue = getenv(PBS_CONF_REMOTE_VIEWER)) != NULL) {
@@ -3567,6 +3567,7 @@ __DIS_rpp_reset()
 		disr_skip   = (int (*)(int, size_t))__rpp_skip;
 		disr_commit = __rpp_rcommit;
 		disw_commit = __rpp_wcommit;
+		dis_getfmt = NULL;
 	}
 }
 
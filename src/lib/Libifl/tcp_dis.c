@@ -75,6 +75,7 @@
 #include <unistd.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include "libpbs.h"
@@ -90,18 +91,33 @@
 
 #define THE_BUF_SIZE 1024
 
+/*
+ * TCP_READ_MIN is the least free space a read is issued with.  A counted
+ * string of TCP_DIRECT_MIN bytes or more is read straight into the
+ * caller's memory instead of being staged in the read buffer, and a
+ * buffer grown beyond TCP_IDLE_MAX is trimmed back when its connection
+ * is released, so one large job script or qstat -f reply does not pin
+ * megabytes on every descriptor for the life of the daemon.
+ */
+#define TCP_READ_MIN	512
+#define TCP_DIRECT_MIN	(64 * 1024)
+#define TCP_IDLE_MAX	(64 * 1024)
+
 struct tcpdisbuf {
 	size_t	tdis_lead;
 	size_t	tdis_trail;
 	size_t	tdis_eod;
 	size_t	tdis_bufsize;
 	char	*tdis_thebuf;
+	int	tdis_hold;	/* grow instead of flushing, see DIS_tcp_whold() */
 };
 
 struct	tcp_chan {
 	struct	tcpdisbuf	readbuf;
 	struct	tcpdisbuf	writebuf;
 
+	int	fmt;		/* wire format, DIS_FMT_ASCII or DIS_FMT_BINARY */
+	int	pipelined;	/* unread input outlives a message, see DIS_tcp_set_pipelined() */
 	void *extra;
 
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
@@ -209,7 +225,6 @@ struct tcpdisbuf * tcp_get_writebuf(int fd)
  * 	-tcp_pack_buff - pack existing data into front of buffer
  *
  *	Moves "uncommited" data to front of buffer and adjusts pointers.
- *	Does a character by character move since data may over lap.
  * 
  * @param[in] tp - tcp data buffer
  *
@@ -220,17 +235,13 @@ struct tcpdisbuf * tcp_get_writebuf(int fd)
 static void
 tcp_pack_buff(struct tcpdisbuf *tp)
 {
-	size_t amt;
 	size_t start;
-	size_t i;
 
 	start = tp->tdis_trail;
 	if (start != 0) {
-		amt  = tp->tdis_eod - start;
-		for (i=0; i<amt; ++i) {
-			*(tp->tdis_thebuf + i) =
-				*(tp->tdis_thebuf + i + start);
-		}
+		if (tp->tdis_eod > start)
+			memmove(tp->tdis_thebuf, tp->tdis_thebuf + start,
+				tp->tdis_eod - start);
 		tp->tdis_lead  -= start;
 		tp->tdis_trail -= start;
 		tp->tdis_eod   -= start;
@@ -239,54 +250,70 @@ tcp_pack_buff(struct tcpdisbuf *tp)
 
 /**
  * @brief
- * 	-tcp_read - read data from tcp stream to "fill" the buffer
- *	Update the various buffer pointers.
+ * 	-tcp_resize_buff - make room for at least want bytes past the end
+ *	of data in a tcp/dis buffer
  *
- * @param[in] fd - socket descriptor
+ * @par Functionality:
+ *	The buffer grows geometrically, or straight to the size needed when
+ *	that is larger, so filling it with a large message costs a handful
+ *	of reallocs rather than one per THE_BUF_SIZE.
+ *
+ * @param[in] tp - tcp data buffer
+ * @param[in] want - free space needed after tdis_eod
  *
  * @return	int
- * @retval	>0 	number of characters read
- * @retval	0 	if EOD (no data currently avalable)
- * @retval	-1 	if error
- * @retval	-2 	if EOF (stream closed)
+ * @retval	0	success
+ * @retval	-1	realloc failed, buffer left as it was
  */
 
 static int
-tcp_read(int fd)
+tcp_resize_buff(struct tcpdisbuf *tp, size_t want)
 {
-	int i;
-	struct	pollfd pollfds[1];
-	int	timeout;
-	struct	tcpdisbuf	*tp;
-	char   *tmcp;
+	size_t	newsize;
+	char	*tmcp;
 
-	tp = tcp_get_readbuf(fd);
-
-	/* compact (move to the front) the uncommitted data */
-
-	tcp_pack_buff(tp);
+	if (tp->tdis_bufsize - tp->tdis_eod >= want)
+		return 0;
 
-	if ((tp->tdis_bufsize - tp->tdis_eod) < 20) {
+	/* no need to lock mutex here, this is per fd resize */
+	newsize = tp->tdis_bufsize * 2;
+	if (newsize < THE_BUF_SIZE)
+		newsize = THE_BUF_SIZE;
+	if (newsize < tp->tdis_eod + want)
+		newsize = ((tp->tdis_eod + want) / THE_BUF_SIZE + 1) * THE_BUF_SIZE;
+
+	tmcp = (char *)realloc(tp->tdis_thebuf, sizeof(char) * newsize);
+	if (tmcp == NULL)
+		return -1;
+	tp->tdis_thebuf = tmcp;
+	tp->tdis_bufsize = newsize;
+	return 0;
+}
 
-		/* no need to lock mutex here, this is per fd resize */
-		/* needing a larger buffer area for the data */
+/**
+ * @brief
+ * 	-tcp_wait_read - wait for data to arrive on a tcp stream
+ *
+ * @par Functionality:
+ *	We don't want to be locked out by an attack on the port to deny
+ *	service, so the wait is bounded by pbs_tcp_timeout; the network had
+ *	better deliver promptly.
+ *
+ * @param[in] fd - socket descriptor
+ *
+ * @return	int
+ * @retval	>0	data (or EOF) is ready to be read
+ * @retval	0	timed out
+ * @retval	-1	error
+ */
 
-		tp->tdis_bufsize += THE_BUF_SIZE;
-		tmcp = (char *)realloc(tp->tdis_thebuf,
-			sizeof(char)*tp->tdis_bufsize);
-		if (tmcp != NULL) {
-			tp->tdis_thebuf = tmcp;
-		} else {
-			/* realloc failed */
-			return -1;
-		}
-	}
+static int
+tcp_wait_read(int fd)
+{
+	int	i;
+	struct	pollfd pollfds[1];
+	int	timeout;
 
-	/*
-	 * we don't want to be locked out by an attack on the port to
-	 * deny service, so we time out the read, the network had better
-	 * deliver promptly
-	 */
 	do {
 		timeout = pbs_tcp_timeout;
 
@@ -299,6 +326,48 @@ tcp_read(int fd)
 			break;
 	} while ((i == -1) && (errno == EINTR));
 
+	return i;
+}
+
+/**
+ * @brief
+ * 	-tcp_read - read data from tcp stream to "fill" the buffer
+ *	Update the various buffer pointers.
+ *
+ * @par Functionality:
+ *	Uncommitted data is only moved to the front of the buffer when the
+ *	free space behind it is too short for the read; otherwise the read
+ *	simply appends, so a message that arrives in many segments is not
+ *	shuffled down the buffer once per segment.
+ *
+ * @param[in] fd - socket descriptor
+ * @param[in] need - number of bytes the caller is still waiting for
+ *
+ * @return	int
+ * @retval	>0 	number of characters read
+ * @retval	0 	if EOD (no data currently avalable)
+ * @retval	-1 	if error
+ * @retval	-2 	if EOF (stream closed)
+ */
+
+static int
+tcp_read(int fd, size_t need)
+{
+	int i;
+	struct	tcpdisbuf	*tp;
+
+	tp = tcp_get_readbuf(fd);
+
+	if (need < TCP_READ_MIN)
+		need = TCP_READ_MIN;
+	if (tp->tdis_bufsize - tp->tdis_eod < need) {
+		/* compact (move to the front) the uncommitted data */
+		tcp_pack_buff(tp);
+		if (tcp_resize_buff(tp, need) != 0)
+			return -1;
+	}
+
+	i = tcp_wait_read(fd);
 	if ((i == 0) || (i < 0))
 		return i;
 
@@ -451,6 +520,32 @@ DIS_tcp_clear(struct  tcpdisbuf *tp)
 	tp->tdis_lead  = 0;
 	tp->tdis_trail = 0;
 	tp->tdis_eod   = 0;
+	tp->tdis_hold  = 0;
+}
+
+/**
+ * @brief
+ * 	tcp_clear_input - empty the read buffer of a channel between messages
+ *
+ * @par Functionality:
+ *	On a pipelined channel the bytes past the last committed read belong
+ *	to the messages the peer sent next, so only what was consumed is
+ *	dropped.  Anything else starts its next message on an empty buffer.
+ *
+ * @param[in] tcp - tcp channel
+ *
+ * @return	Void
+ */
+static void
+tcp_clear_input(struct tcp_chan *tcp)
+{
+	struct tcpdisbuf *tp = &tcp->readbuf;
+
+	if (tcp->pipelined && tp->tdis_eod > tp->tdis_trail) {
+		tp->tdis_lead = tp->tdis_trail;
+		tcp_pack_buff(tp);
+	} else
+		DIS_tcp_clear(tp);
 }
 
 /**
@@ -466,7 +561,22 @@ DIS_tcp_clear(struct  tcpdisbuf *tp)
 void
 DIS_tcp_reset(int fd, int i)
 {
-	DIS_tcp_clear(i==0 ? tcp_get_readbuf(fd) : tcp_get_writebuf(fd));
+	struct tcp_chan *tcp;
+	int rc;
+
+	if (i != 0) {
+		DIS_tcp_clear(tcp_get_writebuf(fd));
+		return;
+	}
+
+	rc = pbs_client_thread_lock_tcp();
+	assert(rc == 0);
+	tcp = tcparray[fd];
+	rc = pbs_client_thread_unlock_tcp();
+	assert(rc == 0);
+
+	assert(tcp != NULL);
+	tcp_clear_input(tcp);
 }
 
 /**
@@ -487,8 +597,8 @@ tcp_rskip(int fd, size_t ct)
 	struct	tcpdisbuf	*tp;
 
 	tp = tcp_get_readbuf(fd);
-	if (tp->tdis_lead - tp->tdis_eod < ct)
-		ct = tp->tdis_lead - tp->tdis_eod;
+	if (tp->tdis_eod - tp->tdis_lead < ct)
+		ct = tp->tdis_eod - tp->tdis_lead;
 	tp->tdis_lead += ct;
 	return (int)ct;
 }
@@ -515,7 +625,7 @@ tcp_getc(int fd)
 	tp = tcp_get_readbuf(fd);
 	if (tp->tdis_lead >= tp->tdis_eod) {
 		/* not enought data, try to get more */
-		x = tcp_read(fd);
+		x = tcp_read(fd, 1);
 		if (x <= 0)
 			return ((x == -2) ? -2 : -1);	/* Error or EOF */
 	}
@@ -526,6 +636,15 @@ tcp_getc(int fd)
  * @brief
  * 	-tcp_gets - tcp/dis support routine to get a string from read buffer
  *
+ * @par Functionality:
+ *	When TCP_DIRECT_MIN or more bytes of the string have yet to arrive,
+ *	what is buffered is copied out and the rest is read with readv()
+ *	straight into str, with whatever follows it on the wire (the next
+ *	item's header) landing in the read buffer in the same call.  Those
+ *	string bytes never enter the read buffer, so they cannot be re-read
+ *	by an uncommit; DIS readers only uncommit on a decode error, after
+ *	which the connection is abandoned anyway.
+ *
  * @param[in] fd - file descriptor
  * @param[in] str - string to be written
  * @param[in] ct - count
@@ -541,12 +660,45 @@ static int
 tcp_gets(int fd, char *str, size_t ct)
 {
 	int	x;
+	size_t	have;
 	struct	tcpdisbuf	*tp;
+	struct	iovec	iov[2];
+	ssize_t	i;
 
 	tp = tcp_get_readbuf(fd);
+	have = tp->tdis_eod - tp->tdis_lead;
+	if (ct > have && ct - have >= TCP_DIRECT_MIN) {
+		(void)memcpy(str, &tp->tdis_thebuf[tp->tdis_lead], have);
+		tp->tdis_lead = tp->tdis_eod;
+		if (tp->tdis_bufsize - tp->tdis_eod < TCP_READ_MIN) {
+			tcp_pack_buff(tp);
+			(void)tcp_resize_buff(tp, TCP_READ_MIN);
+		}
+		while (have < ct) {
+			x = tcp_wait_read(fd);
+			if (x <= 0)
+				return x;
+			iov[0].iov_base = str + have;
+			iov[0].iov_len = ct - have;
+			iov[1].iov_base = &tp->tdis_thebuf[tp->tdis_eod];
+			iov[1].iov_len = tp->tdis_bufsize - tp->tdis_eod;
+			while ((i = readv(fd, iov, 2)) == -1) {
+				if (errno != EINTR)
+					return -1;
+			}
+			if (i == 0)
+				return -2;	/* EOF */
+			if ((size_t)i > ct - have) {
+				tp->tdis_eod += i - (ct - have);
+				have = ct;
+			} else
+				have += i;
+		}
+		return (int)ct;
+	}
 	while (tp->tdis_eod - tp->tdis_lead < ct) {
 		/* not enought data, try to get more */
-		x = tcp_read(fd);
+		x = tcp_read(fd, ct - (tp->tdis_eod - tp->tdis_lead));
 		if (x <= 0)
 			return x;	/* Error or EOF */
 	}
@@ -573,27 +725,25 @@ static int
 tcp_puts(int fd, const char *str, size_t ct)
 {
 	struct	tcpdisbuf	*tp;
-	char			*tmcp;
 
 	tp = tcp_get_writebuf(fd);
 	if ((tp->tdis_bufsize - tp->tdis_lead) < ct) {
+		if (tp->tdis_hold) {
+			/* keep the whole message in the buffer */
+			tp->tdis_eod = tp->tdis_lead;
+			if (tcp_resize_buff(tp, ct) != 0)
+				return -1;
+			(void)memcpy(&tp->tdis_thebuf[tp->tdis_lead], str, ct);
+			tp->tdis_lead += ct;
+			return ct;
+		}
 		/* not enough room, try to flush committed data */
 		if (__DIS_tcp_wflush(fd) < 0)
 			return -1;		/* error */
 
-		if ((tp->tdis_bufsize - tp->tdis_lead) < ct) {	/* add room */
-
-			/* no need to lock mutex here, per fd resize */
-			size_t	ru = (ct + tp->tdis_lead) / THE_BUF_SIZE;
-
-			tp->tdis_bufsize = (ru + 1) * THE_BUF_SIZE;
-			tmcp = (char *)realloc(tp->tdis_thebuf,
-				sizeof(char)*tp->tdis_bufsize);
-			if (tmcp != NULL)
-				tp->tdis_thebuf = tmcp;
-			else
-				return -1;	/* realloc failed */
-		}
+		/* add room; tdis_eod == tdis_lead after the flush */
+		if (tcp_resize_buff(tp, ct) != 0)
+			return -1;	/* realloc failed */
 	}
 	(void)memcpy(&tp->tdis_thebuf[tp->tdis_lead], str, ct);
 	tp->tdis_lead += ct;
@@ -701,6 +851,184 @@ void
 	return (extra);
 }
 
+/**
+ * @brief
+ * 	tcp_getfmt - gets the wire format of a tcp connection
+ *
+ * @param[in] fd - file descriptor
+ *
+ * @return	int - DIS_FMT_ASCII or DIS_FMT_BINARY
+ *
+ */
+static int
+tcp_getfmt(int fd)
+{
+	int rc;
+	int fmt;
+
+	rc = pbs_client_thread_lock_tcp();
+	assert(rc == 0);
+	fmt = tcparray[fd]->fmt;
+	rc = pbs_client_thread_unlock_tcp();
+	assert(rc == 0);
+
+	return (fmt);
+}
+
+/**
+ * @brief
+ * 	DIS_tcp_set_fmt - sets the wire format of a tcp connection.  Both ends
+ *	switch to DIS_FMT_BINARY right after the PBS_BATCH_Connect reply that
+ *	accepted it, and the format is reset by DIS_tcp_release() on close.
+ *
+ * @param[in] fd - file descriptor, set up by DIS_tcp_setup()
+ * @param[in] fmt - DIS_FMT_ASCII or DIS_FMT_BINARY
+ *
+ */
+void
+DIS_tcp_set_fmt(int fd, int fmt)
+{
+	int rc;
+
+	rc = pbs_client_thread_lock_tcp();
+	assert(rc == 0);
+	if (fd >= 0 && fd < tcparraymax && tcparray[fd] != NULL)
+		tcparray[fd]->fmt = fmt;
+	rc = pbs_client_thread_unlock_tcp();
+	assert(rc == 0);
+}
+
+/**
+ * @brief
+ * 	DIS_tcp_set_pipelined - let a tcp connection carry several messages
+ *	ahead of their readers.  Both ends switch right after the
+ *	PBS_BATCH_Connect reply that accepted PIPELINE_OFFER.  From then on
+ *	the input read past the end of one message is kept for the next one
+ *	instead of being discarded by DIS_tcp_setup() and DIS_tcp_reset().
+ *	DIS_tcp_release() turns it off again on close.
+ *
+ * @param[in] fd - file descriptor, set up by DIS_tcp_setup()
+ *
+ * @return	int
+ * @retval	0	connection is pipelined
+ * @retval	-1	not supported on this connection
+ */
+int
+DIS_tcp_set_pipelined(int fd)
+{
+#if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
+	/* the GSS layer unwraps whole tokens into buffers of its own */
+	return -1;
+#else
+	int rc;
+	int ret = -1;
+
+	rc = pbs_client_thread_lock_tcp();
+	assert(rc == 0);
+	if (fd >= 0 && fd < tcparraymax && tcparray[fd] != NULL) {
+		tcparray[fd]->pipelined = 1;
+		ret = 0;
+	}
+	rc = pbs_client_thread_unlock_tcp();
+	assert(rc == 0);
+	return ret;
+#endif
+}
+
+/**
+ * @brief
+ * 	DIS_tcp_pending - number of bytes read from a tcp connection but not
+ *	yet decoded, the start of the next message on a pipelined one
+ *
+ * @param[in] fd - file descriptor
+ *
+ * @return	size_t
+ */
+size_t
+DIS_tcp_pending(int fd)
+{
+	int rc;
+	size_t pending = 0;
+	struct tcpdisbuf *tp;
+
+	rc = pbs_client_thread_lock_tcp();
+	assert(rc == 0);
+	if (tcparray != NULL && fd >= 0 && fd < tcparraymax && tcparray[fd] != NULL) {
+		tp = &tcparray[fd]->readbuf;
+		pending = tp->tdis_eod - tp->tdis_lead;
+	}
+	rc = pbs_client_thread_unlock_tcp();
+	assert(rc == 0);
+	return pending;
+}
+
+/**
+ * @brief
+ * 	DIS_tcp_whold - keep what is written to a tcp connection in its write
+ *	buffer until DIS_tcp_wflush(), growing the buffer rather than sending
+ *	the start of a large message early.  Used to copy a whole encoded
+ *	message out with DIS_tcp_wcommitted().
+ *
+ * @param[in] fd - file descriptor, set up by DIS_tcp_setup()
+ * @param[in] hold - 1 to hold the output, 0 to flush when full again
+ *
+ * @return	int
+ * @retval	0	done
+ * @retval	-1	not supported on this connection
+ */
+int
+DIS_tcp_whold(int fd, int hold)
+{
+#if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
+	/* the GSS layer wraps the output into buffers of its own */
+	return -1;
+#else
+	int rc;
+	int ret = -1;
+
+	rc = pbs_client_thread_lock_tcp();
+	assert(rc == 0);
+	if (tcparray != NULL && fd >= 0 && fd < tcparraymax && tcparray[fd] != NULL) {
+		tcparray[fd]->writebuf.tdis_hold = hold;
+		ret = 0;
+	}
+	rc = pbs_client_thread_unlock_tcp();
+	assert(rc == 0);
+	return ret;
+#endif
+}
+
+/**
+ * @brief
+ * 	DIS_tcp_wcommitted - the data committed to the write buffer of a tcp
+ *	connection and not yet sent by DIS_tcp_wflush()
+ *
+ * @param[in] fd - file descriptor
+ * @param[out] data - set to the start of the data, valid until the next
+ *		      write or flush on fd
+ *
+ * @return	size_t - number of bytes
+ */
+size_t
+DIS_tcp_wcommitted(int fd, char **data)
+{
+	int rc;
+	size_t committed = 0;
+	struct tcpdisbuf *tp;
+
+	*data = NULL;
+	rc = pbs_client_thread_lock_tcp();
+	assert(rc == 0);
+	if (tcparray != NULL && fd >= 0 && fd < tcparraymax && tcparray[fd] != NULL) {
+		tp = &tcparray[fd]->writebuf;
+		*data = tp->tdis_thebuf;
+		committed = tp->tdis_trail;
+	}
+	rc = pbs_client_thread_unlock_tcp();
+	assert(rc == 0);
+	return committed;
+}
+
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 /**
  * @brief
@@ -736,6 +1064,8 @@ struct gssdis_chan
 void
 DIS_tcp_funcs()
 {
+	dis_getfmt = tcp_getfmt;
+
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 	DIS_gss_funcs();
 
@@ -764,32 +1094,18 @@ DIS_tcp_funcs()
 
 /**
  * @brief
- * 	-DIS_tcp_setup - setup supports routines for dis, "data is strings", to
- * 	use tcp stream I/O.  Also initializes an array of pointers to
- *	buffers and a buffer to be used for the given fd.
+ * 	-tcp_grow_array - make the array of channel pointers big enough to
+ *	hold fd.  The caller holds the tcp lock.
  *
  * @param[in] fd - socket descriptor
- * 
+ *
  * @return	Void
  *
  */
-
-void
-DIS_tcp_setup(int fd)
+static void
+tcp_grow_array(int fd)
 {
-	struct	tcp_chan	*tcp;
 	struct  tcp_chan	**tmpa;
-	int	rc;
-
-	/* check for bad file descriptor */
-	if (fd < 0)
-		return;
-
-	rc = pbs_client_thread_lock_tcp();
-	assert(rc == 0);
-
-	/* set DIS function pointers */
-	DIS_tcp_funcs();
 
 	if (fd >= tcparraymax) {
 		int	hold = tcparraymax;
@@ -811,6 +1127,64 @@ DIS_tcp_setup(int fd)
 				sizeof(struct tcp_chan *));
 		}
 	}
+}
+
+/**
+ * @brief
+ * 	-DIS_tcp_reserve - size the array of channel pointers for every fd
+ *	below nfds up front.  A daemon that reads some sockets from other
+ *	threads calls this first, so a later DIS_tcp_setup() never moves
+ *	the array under them.
+ *
+ * @param[in] nfds - number of file descriptors to make room for
+ *
+ * @return	Void
+ *
+ */
+void
+DIS_tcp_reserve(int nfds)
+{
+	int	rc;
+
+	if (nfds <= 0)
+		return;
+
+	rc = pbs_client_thread_lock_tcp();
+	assert(rc == 0);
+	tcp_grow_array(nfds - 1);
+	rc = pbs_client_thread_unlock_tcp();
+	assert(rc == 0);
+}
+
+/**
+ * @brief
+ * 	-DIS_tcp_setup - setup supports routines for dis, "data is strings", to
+ * 	use tcp stream I/O.  Also initializes an array of pointers to
+ *	buffers and a buffer to be used for the given fd.
+ *
+ * @param[in] fd - socket descriptor
+ * 
+ * @return	Void
+ *
+ */
+
+void
+DIS_tcp_setup(int fd)
+{
+	struct	tcp_chan	*tcp;
+	int	rc;
+
+	/* check for bad file descriptor */
+	if (fd < 0)
+		return;
+
+	rc = pbs_client_thread_lock_tcp();
+	assert(rc == 0);
+
+	/* set DIS function pointers */
+	DIS_tcp_funcs();
+
+	tcp_grow_array(fd);
 	tcp = tcparray[fd];
 	if (tcp == NULL) {
 		tcp = tcparray[fd] =
@@ -823,6 +1197,8 @@ DIS_tcp_setup(int fd)
 		assert(tcp->writebuf.tdis_thebuf != NULL);
 		tcp->writebuf.tdis_bufsize = THE_BUF_SIZE;
 
+		tcp->fmt = DIS_FMT_ASCII;
+		tcp->pipelined = 0;
 		tcp->extra = NULL;
 
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
@@ -849,7 +1225,7 @@ DIS_tcp_setup(int fd)
 	}
 
 	/* initialize read and write buffers */
-	DIS_tcp_clear(&tcp->readbuf);
+	tcp_clear_input(tcp);
 	DIS_tcp_clear(&tcp->writebuf);
 
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
@@ -864,7 +1240,33 @@ DIS_tcp_setup(int fd)
 
 /**
  * @brief
- * 	-DIS_tcp_release - release GSS structures associated with fd
+ * 	-tcp_trim_buff - shrink a buffer a large message left oversized
+ *
+ * @param[in] tp - tcp data buffer, empty
+ *
+ * @return	Void
+ */
+
+static void
+tcp_trim_buff(struct tcpdisbuf *tp)
+{
+	char	*tmcp;
+
+	if (tp->tdis_bufsize <= TCP_IDLE_MAX)
+		return;
+	tmcp = (char *)realloc(tp->tdis_thebuf, THE_BUF_SIZE);
+	if (tmcp != NULL) {
+		tp->tdis_thebuf = tmcp;
+		tp->tdis_bufsize = THE_BUF_SIZE;
+	}
+	DIS_tcp_clear(tp);
+}
+
+/**
+ * @brief
+ * 	-DIS_tcp_release - release GSS structures associated with fd, trim
+ *	its buffers and reset its wire format for the next connection using
+ *	the fd
  *
  * @param[in] fd - socket descriptor
  *
@@ -873,19 +1275,23 @@ DIS_tcp_setup(int fd)
  */
 void DIS_tcp_release(int fd)
 {
-#if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 	int rc;
 	rc = pbs_client_thread_lock_tcp();
 	assert(rc == 0);
 
-	if (tcparray != NULL && tcparray[fd] != NULL) {
+	if (tcparray != NULL && fd >= 0 && fd < tcparraymax && tcparray[fd] != NULL) {
+		tcparray[fd]->fmt = DIS_FMT_ASCII;
+		tcparray[fd]->pipelined = 0;
+		tcp_trim_buff(&tcparray[fd]->readbuf);
+		tcp_trim_buff(&tcparray[fd]->writebuf);
+#if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 		pbs_gss_free_gss_extra(tcparray[fd]->extra);
 		tcparray[fd]->extra = NULL;
 
 		tcparray[fd]->gsschan->gss_extra = NULL;
+#endif
 	}
 
 	rc = pbs_client_thread_unlock_tcp();
 	assert(rc == 0);
-#endif
 }
@@ -63,12 +63,6 @@ int (*transport_read)(int fd);
 
 struct gssdis_chan *(*gss_get_chan)(int stream);
 
-extern int (*dis_getc)(int stream);
-extern int (*dis_puts)(int stream, const char *string, size_t count);
-extern int (*dis_gets)(int stream, char *string, size_t count);
-extern int (*disr_skip)(int stream, size_t nskips);
-extern int (*disw_commit)(int stream, int commit);
-extern int (*disr_commit)(int stream, int commit);
 
 enum TCP_GSS_MSG_TYPES {
         TCP_GSS_CTX = 1, /* starts from 1, zero means EOF */
@@ -791,6 +791,7 @@ DIS_tcp_funcs()
 		disr_skip = tcp_rskip;
 		disr_commit = tcp_rcommit;
 		disw_commit = tcp_wcommit;
+		dis_getfmt = NULL;
 	}
 }
 
@@ -813,34 +813,28 @@ tm_nodeinfo(tm_node_id **list, int *nnodes)
 
 /**
  * @brief
- *	-Starts <argv>[0] with environment <envp> at <where>.
+ *	-Put a TM_SPAWN request for <argv>[0] at <where> in the buffer
+ *	to the local MOM, without flushing it.
  *
  * @param[in] argc - argument count
  * @param[in] argv - argument list
  * @param[in] envp - environment variable list
  * @param[in] where - job relative node
- * @param[out] tid - task id
- * @param[out] event - event info
+ * @param[in] event - event of the request
  *
  * @return	int
  * @retval	TM_SUCCESS	success
  * @retval	TM_ER*		error
  *
  */
-int
-tm_spawn(int argc, char **argv, char **envp, 
-		tm_node_id where, tm_task_id *tid, tm_event_t *event)
+static int
+spawn_request(int argc, char **argv, char **envp,
+		tm_node_id where, tm_event_t event)
 {
 	char		*cp;
 	int		i;
 
-	if (!init_done)
-		return TM_BADINIT;
-	if (argc <= 0 || argv == NULL || argv[0] == NULL || *argv[0] == '\0')
-		return TM_ENOTFOUND;
-
-	*event = new_event();
-	if (startcom(TM_SPAWN, *event) != DIS_SUCCESS)
+	if (startcom(TM_SPAWN, event) != DIS_SUCCESS)
 		return TM_ENOTCONNECTED;
 
 	if (diswsi(local_conn, where) != DIS_SUCCESS)	/* send where */
@@ -871,11 +865,93 @@ tm_spawn(int argc, char **argv, char **envp,
 	}
 	if (diswcs(local_conn, "", 0) != DIS_SUCCESS)
 		return TM_ENOTCONNECTED;
+	return TM_SUCCESS;
+}
+
+/**
+ * @brief
+ *	-Starts <argv>[0] with environment <envp> at <where>.
+ *
+ * @param[in] argc - argument count
+ * @param[in] argv - argument list
+ * @param[in] envp - environment variable list
+ * @param[in] where - job relative node
+ * @param[out] tid - task id
+ * @param[out] event - event info
+ *
+ * @return	int
+ * @retval	TM_SUCCESS	success
+ * @retval	TM_ER*		error
+ *
+ */
+int
+tm_spawn(int argc, char **argv, char **envp, 
+		tm_node_id where, tm_task_id *tid, tm_event_t *event)
+{
+	int		rc;
+
+	if (!init_done)
+		return TM_BADINIT;
+	if (argc <= 0 || argv == NULL || argv[0] == NULL || *argv[0] == '\0')
+		return TM_ENOTFOUND;
+
+	*event = new_event();
+	if ((rc = spawn_request(argc, argv, envp, where, *event)) != TM_SUCCESS)
+		return rc;
 	DIS_tcp_wflush(local_conn);
 	add_event(*event, where, TM_SPAWN, (void *)tid);
 	return TM_SUCCESS;
 }
 
+/**
+ * @brief
+ *	-Starts <argv>[0] with environment <envp> once on each of the
+ *	<nwhere> nodes in <where>.  All the requests go to the local MOM
+ *	in a single write, and she handles them in one pass, rather than
+ *	one tm_spawn() round of the event loop per task.
+ *
+ * @param[in] argc - argument count
+ * @param[in] argv - argument list
+ * @param[in] envp - environment variable list
+ * @param[in] nwhere - number of entries in where, tids and events
+ * @param[in] where - job relative nodes
+ * @param[out] tids - task id of each spawn
+ * @param[out] events - event of each spawn, as for tm_spawn()
+ *
+ * @return	int
+ * @retval	TM_SUCCESS	success, every event is to be polled
+ * @retval	TM_ER*		error, the events of the spawns before the
+ *				failed one stand, the rest are TM_NULL_EVENT
+ *
+ */
+int
+tm_spawn_multi(int argc, char **argv, char **envp, int nwhere,
+		tm_node_id *where, tm_task_id *tids, tm_event_t *events)
+{
+	int		i;
+	int		rc;
+
+	if (!init_done)
+		return TM_BADINIT;
+	if (argc <= 0 || argv == NULL || argv[0] == NULL || *argv[0] == '\0')
+		return TM_ENOTFOUND;
+	if (nwhere <= 0 || where == NULL || tids == NULL || events == NULL)
+		return TM_EBADENVIRONMENT;
+
+	for (i = 0; i < nwhere; i++) {
+		events[i] = new_event();
+		rc = spawn_request(argc, argv, envp, where[i], events[i]);
+		if (rc != TM_SUCCESS) {
+			for (; i < nwhere; i++)
+				events[i] = TM_NULL_EVENT;
+			return rc;
+		}
+		add_event(events[i], where[i], TM_SPAWN, (void *)(tids + i));
+	}
+	DIS_tcp_wflush(local_conn);
+	return TM_SUCCESS;
+}
+
 /**
  * @brief
  *	-Sends a <sig> signal to all the process groups in the task
@@ -50,6 +50,9 @@
  *	log_close()
  *	log_add_debug_info()
  *	log_add_if_info()
+ *	log_async_start()
+ *	log_async_flush()
+ *	log_set_index_owner()
  */
 
 
@@ -70,7 +73,11 @@
 #include <unistd.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <ctype.h>
 #include <pthread.h>
+#ifndef WIN32
+#include <signal.h>
+#endif
 #include "log.h"
 #include "pbs_ifl.h"
 #include "pbs_internal.h"
@@ -107,6 +114,66 @@ static volatile int  log_opened = 0;
 static int	     syslogopen = 0;
 #endif	/* SYSLOG */
 
+#ifndef WIN32
+/*
+ * Asynchronous logging, see log_async_start().
+ *
+ * Records are formatted by the thread logging them and appended to the
+ * active one of two buffers.  The writer thread swaps the buffers and
+ * writes the full one to the log file, so a thread logging a record
+ * waits only for the copy into the buffer, never for the write.  Each
+ * record is kept with the day it was logged, so the log switches at
+ * midnight between the right records.  A record that does not fit in
+ * the active buffer is dropped and counted.
+ */
+struct log_async_rec {
+	int	lr_yday;	/* day of the year the record was logged */
+	int	lr_len;		/* length of the text that follows */
+};
+
+static pthread_mutex_t	log_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	log_async_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t	log_async_thread;
+static size_t		log_async_size = 0;	/* size of each buffer, 0 if not asynchronous */
+static int		log_async_running = 0;	/* the writer thread is running */
+static int		log_async_stop = 0;	/* the writer thread is asked to stop */
+static char		*log_async_buf[2] = {NULL, NULL};
+static int		log_async_active = 0;	/* buffer being appended to */
+static size_t		log_async_used = 0;	/* bytes used in the active buffer */
+static long		log_async_dropped = 0;	/* records dropped since last written */
+static struct sigaction	log_async_old_segv;	/* handlers log_async_crash() chains to */
+static struct sigaction	log_async_old_bus;
+
+/*
+ * Job index, written alongside each log file when PBS_LOG_INDEX is set.
+ *
+ * Each line of the index names a byte range of the log and the jobs
+ * (the part of the job id before the first '.') whose records fall in
+ * it: "<start> <end> <job> <job> ...".  The process that opened the log
+ * gathers the jobs of about LOG_INDEX_BLOCK bytes of records before it
+ * writes a line, and its lines cover the log contiguously up to the end
+ * of its last line.  A forked child writes one line, prefixed with 'c',
+ * for each job record it logs, since it may exit without writing what
+ * it gathered.  A range whose jobs are not known is written with the
+ * job "*".  tracejob reads the ranges for a job plus everything after
+ * the last range written by the owner of the log.
+ */
+#define LOG_INDEX_BLOCK		65536	/* bytes of log per index line */
+#define LOG_INDEX_MAXKEYS	256	/* jobs per index line */
+#define LOG_INDEX_KEYSZ		64	/* longest job id part indexed */
+
+static int	log_index_fd = -1;	/* open index, -1 if not indexing */
+static pid_t	log_index_pid;		/* process that owns the index */
+static off_t	log_index_start;	/* start of the range being gathered */
+static off_t	log_index_end;		/* end of the range being gathered */
+static int	log_index_all;		/* range has a record with an unindexable job */
+static int	log_index_nkeys;
+static char	log_index_keys[LOG_INDEX_MAXKEYS][LOG_INDEX_KEYSZ];
+static char	log_index_name[_POSIX_PATH_MAX + sizeof(LOG_INDEX_SUFFIX)];
+
+static void log_index_record(const char *objname, size_t len);
+#endif
+
 /*
  * the order of these names MUST match the defintions of
  * PBS_EVENTCLASS_* in log.h
@@ -326,6 +393,7 @@ void
 log_atfork_prepare()
 {
 	log_mutex_lock();
+	(void)pthread_mutex_lock(&log_async_mutex);
 }
 
 /**
@@ -336,6 +404,7 @@ log_atfork_prepare()
 void
 log_atfork_parent()
 {
+	(void)pthread_mutex_unlock(&log_async_mutex);
 	log_mutex_unlock();
 }
 
@@ -347,8 +416,574 @@ log_atfork_parent()
 void
 log_atfork_child()
 {
+	/*
+	 * The writer thread is not in the child, and the buffered records
+	 * are written by the parent, so the child logs synchronously.
+	 */
+	log_async_size = 0;
+	log_async_running = 0;
+	log_async_used = 0;
+	log_async_dropped = 0;
+	(void)pthread_mutex_unlock(&log_async_mutex);
 	log_mutex_unlock();
 }
+
+/**
+ * @brief
+ *	Write a buffer of records queued for the writer thread to the log.
+ *	The caller holds the log mutex.
+ *
+ * @param[in]	buf - the records
+ * @param[in]	used - bytes used in buf
+ * @param[in]	dropped - records dropped since the last write
+ *
+ */
+static void
+log_async_write(char *buf, size_t used, long dropped)
+{
+	struct log_async_rec rec;
+	size_t off = 0;
+
+	while (off < used) {
+		memcpy(&rec, buf + off, sizeof(rec));
+		off += sizeof(rec);
+
+		/* Do we need to switch the log? */
+		if (log_auto_switch && (rec.lr_yday != log_open_day)) {
+			log_close(1);
+			log_open(NULL, log_directory);
+		}
+		if (log_opened == 1) {
+			(void)fwrite(buf + off, 1, rec.lr_len, logfile);
+			if (log_index_fd != -1) {
+				/* the object name is the fifth field */
+				char *p = buf + off;
+				char *e = p + rec.lr_len;
+				int f;
+
+				for (f = 0; (f < 4) && (p != NULL); f++) {
+					p = memchr(p, ';', e - p);
+					if (p != NULL)
+						p++;
+				}
+				if (p != NULL)
+					log_index_record(p, rec.lr_len);
+			}
+		}
+		off += rec.lr_len;
+	}
+	if (log_opened == 1) {
+		if (dropped > 0) {
+			time_t now = time(NULL);
+			struct tm ltm;
+			struct tm *ptm = localtime_r(&now, &ltm);
+
+			fprintf(logfile,
+				"%02d/%02d/%04d %02d:%02d:%02d;%04x;%s;%s;%s;%ld log records dropped\n",
+				ptm->tm_mon + 1, ptm->tm_mday, ptm->tm_year + 1900,
+				ptm->tm_hour, ptm->tm_min, ptm->tm_sec,
+				PBSEVENT_SYSTEM, msg_daemonname,
+				class_names[PBS_EVENTCLASS_SERVER], "Log", dropped);
+		}
+		(void)fflush(logfile);
+	}
+}
+
+/**
+ * @brief
+ *	Queue a formatted record for the writer thread.
+ *
+ * @param[in]	yday - day of the year the record was logged
+ * @param[in]	text - the record, with its newline
+ * @param[in]	len - length of text
+ *
+ */
+static void
+log_async_put(int yday, const char *text, int len)
+{
+	struct log_async_rec rec;
+	char *buf;
+
+	(void)pthread_mutex_lock(&log_async_mutex);
+	if (log_async_used + sizeof(rec) + len > log_async_size) {
+		log_async_dropped++;
+	} else {
+		rec.lr_yday = yday;
+		rec.lr_len = len;
+		buf = log_async_buf[log_async_active] + log_async_used;
+		memcpy(buf, &rec, sizeof(rec));
+		memcpy(buf + sizeof(rec), text, len);
+		log_async_used += sizeof(rec) + len;
+	}
+	(void)pthread_cond_signal(&log_async_cond);
+	(void)pthread_mutex_unlock(&log_async_mutex);
+}
+
+/**
+ * @brief
+ *	The writer thread: write the records queued by log_record() until
+ *	asked to stop, then write any left.
+ *
+ * @param[in]	arg - unused
+ *
+ * @return	NULL
+ *
+ */
+static void *
+log_async_writer(void *arg)
+{
+	char *buf;
+	size_t used;
+	long dropped;
+
+	(void)pthread_mutex_lock(&log_async_mutex);
+	for (;;) {
+		while ((log_async_used == 0) && (log_async_dropped == 0) &&
+			!log_async_stop)
+			(void)pthread_cond_wait(&log_async_cond, &log_async_mutex);
+		if ((log_async_used == 0) && (log_async_dropped == 0))
+			break;
+
+		/* swap the buffers so others can log while this one is written */
+		buf = log_async_buf[log_async_active];
+		used = log_async_used;
+		dropped = log_async_dropped;
+		log_async_active ^= 1;
+		log_async_used = 0;
+		log_async_dropped = 0;
+		(void)pthread_mutex_unlock(&log_async_mutex);
+
+		if (log_mutex_lock() == 0) {
+			log_async_write(buf, used, dropped);
+			log_mutex_unlock();
+		}
+
+		(void)pthread_mutex_lock(&log_async_mutex);
+	}
+	(void)pthread_mutex_unlock(&log_async_mutex);
+	return NULL;
+}
+
+/**
+ * @brief
+ *	Write the records queued for the writer thread.  Registered with
+ *	atexit() so records are not lost when a daemon exits.
+ *
+ */
+void
+log_async_flush(void)
+{
+	char *buf;
+	size_t used;
+	long dropped;
+	int locked;
+
+	(void)pthread_mutex_lock(&log_async_mutex);
+	if ((log_async_used == 0) && (log_async_dropped == 0)) {
+		(void)pthread_mutex_unlock(&log_async_mutex);
+		return;
+	}
+	buf = log_async_buf[log_async_active];
+	used = log_async_used;
+	dropped = log_async_dropped;
+	log_async_active ^= 1;
+	log_async_used = 0;
+	log_async_dropped = 0;
+	(void)pthread_mutex_unlock(&log_async_mutex);
+
+	/* the caller may already hold the log mutex */
+	locked = (log_mutex_lock() == 0);
+	log_async_write(buf, used, dropped);
+	if (locked)
+		log_mutex_unlock();
+}
+
+/**
+ * @brief
+ *	On a fatal signal, write the records in the active buffer with
+ *	write(2), then put back the handler the daemon had installed for
+ *	the signal and pass the signal on to it.
+ *
+ * @param[in]	sig - the signal
+ * @param[in]	info - the signal information
+ * @param[in]	ctx - the interrupted context
+ *
+ */
+static void
+log_async_crash(int sig, siginfo_t *info, void *ctx)
+{
+	struct log_async_rec rec;
+	struct sigaction *old;
+	char *buf = log_async_buf[log_async_active];
+	size_t off = 0;
+
+	if ((buf != NULL) && (logfile != NULL)) {
+		while (off + sizeof(rec) <= log_async_used) {
+			memcpy(&rec, buf + off, sizeof(rec));
+			off += sizeof(rec);
+			if (write(fileno(logfile), buf + off, rec.lr_len) == -1)
+				break;
+			off += rec.lr_len;
+		}
+		log_async_used = 0;
+	}
+
+	old = (sig == SIGBUS) ? &log_async_old_bus : &log_async_old_segv;
+	(void)sigaction(sig, old, NULL);
+	if (old->sa_flags & SA_SIGINFO)
+		old->sa_sigaction(sig, info, ctx);
+	else if ((old->sa_handler != SIG_DFL) && (old->sa_handler != SIG_IGN))
+		old->sa_handler(sig);
+	else
+		(void)raise(sig);	/* delivered once this handler returns */
+}
+
+/**
+ * @brief
+ *	Start the writer thread if logging is asynchronous and it is not
+ *	running.
+ *
+ * @return	int
+ * @retval	0	- the writer thread is running
+ * @retval	-1	- it could not be started, logging is synchronous
+ *
+ */
+static int
+log_async_run(void)
+{
+	if (log_async_running)
+		return 0;
+
+	log_async_stop = 0;
+	if (pthread_create(&log_async_thread, NULL, log_async_writer, NULL) != 0) {
+		log_async_size = 0;
+		return -1;
+	}
+	log_async_running = 1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Make logging asynchronous: log_record() queues each record in a
+ *	buffer and a writer thread writes the buffer to the log file.
+ *
+ * @par
+ *	A daemon calls this once it is in the background, since the writer
+ *	thread does not survive a fork.  Children forked later log
+ *	synchronously.  The records queued are written by log_close(), when
+ *	the process exits, and, as far as possible, on SIGSEGV or SIGBUS.
+ *
+ * @param[in]	size - size in bytes of each of the two buffers
+ *
+ * @return	int
+ * @retval	0	- logging is asynchronous
+ * @retval	-1	- logging stays synchronous
+ *
+ * @par MT-safe: No
+ */
+int
+log_async_start(size_t size)
+{
+	struct sigaction act;
+	static int registered = 0;
+
+	if ((size == 0) || log_async_running || (log_opened != 1))
+		return -1;
+
+	if ((log_async_buf[0] = malloc(size)) == NULL)
+		return -1;
+	if ((log_async_buf[1] = malloc(size)) == NULL) {
+		free(log_async_buf[0]);
+		log_async_buf[0] = NULL;
+		return -1;
+	}
+	log_async_size = size;
+	log_async_active = 0;
+	log_async_used = 0;
+	log_async_dropped = 0;
+
+	if (log_async_run() != 0) {
+		free(log_async_buf[0]);
+		free(log_async_buf[1]);
+		log_async_buf[0] = log_async_buf[1] = NULL;
+		return -1;
+	}
+
+	if (!registered) {
+		(void)atexit(log_async_flush);
+		memset(&act, 0, sizeof(act));
+		sigemptyset(&act.sa_mask);
+		act.sa_flags = SA_SIGINFO;
+		act.sa_sigaction = log_async_crash;
+		(void)sigaction(SIGSEGV, &act, &log_async_old_segv);
+		(void)sigaction(SIGBUS, &act, &log_async_old_bus);
+		registered = 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	Write a line to the job index.  If the write fails the index is
+ *	removed, since tracejob reads a log without an index in full, but
+ *	would miss records left out of an index.
+ *
+ * @param[in]	line - the line, with its newline
+ * @param[in]	len - length of line
+ *
+ */
+static void
+log_index_write(const char *line, size_t len)
+{
+	if (write(log_index_fd, line, len) != (ssize_t)len) {
+		(void)unlink(log_index_name);
+		(void)close(log_index_fd);
+		log_index_fd = -1;
+	}
+}
+
+/**
+ * @brief
+ *	Write the range gathered by the owner of the index and start a new
+ *	one where it ends.
+ *
+ */
+static void
+log_index_flush(void)
+{
+	static char line[LOG_INDEX_MAXKEYS * LOG_INDEX_KEYSZ + 64];
+	size_t len;
+	int i;
+
+	if ((log_index_fd == -1) || (log_index_end <= log_index_start))
+		return;
+
+	len = sprintf(line, "%lld %lld", (long long)log_index_start,
+		(long long)log_index_end);
+	if (log_index_all)
+		len += sprintf(line + len, " *");
+	else {
+		for (i = 0; i < log_index_nkeys; i++)
+			len += sprintf(line + len, " %s", log_index_keys[i]);
+	}
+	line[len++] = '\n';
+	log_index_write(line, len);
+
+	log_index_start = log_index_end;
+	log_index_all = 0;
+	log_index_nkeys = 0;
+}
+
+/**
+ * @brief
+ *	Get the part of a record's object name that the index is keyed on:
+ *	the part of a job id before the first '.'.
+ *
+ * @param[in]	objname - the object name, ended by a '\0' or a ';'
+ * @param[out]	key - the key, LOG_INDEX_KEYSZ long
+ *
+ * @return	int
+ * @retval	1	- key is set
+ * @retval	0	- the object is not a job
+ * @retval	-1	- the job id is too long to be indexed
+ *
+ */
+static int
+log_index_key(const char *objname, char *key)
+{
+	int i;
+
+	if (!isdigit((int)*objname))
+		return 0;
+	for (i = 0; objname[i] != '\0' && objname[i] != ';' && objname[i] != '.'; i++) {
+		if (i == LOG_INDEX_KEYSZ - 1)
+			return -1;
+		key[i] = objname[i];
+	}
+	key[i] = '\0';
+	return 1;
+}
+
+/**
+ * @brief
+ *	Add a record just written to the log to the job index.  The caller
+ *	holds the log mutex.
+ *
+ * @param[in]	objname - the record's object name, ended by a '\0' or a ';'
+ * @param[in]	len - length of the record
+ *
+ */
+static void
+log_index_record(const char *objname, size_t len)
+{
+	char key[LOG_INDEX_KEYSZ];
+	off_t end;
+	int rc;
+	int i;
+
+	if (log_index_fd == -1)
+		return;
+	if ((end = ftello(logfile)) == -1)
+		return;
+	rc = log_index_key(objname, key);
+
+	if (getpid() != log_index_pid) {
+		char line[LOG_INDEX_KEYSZ + 64];
+
+		if (rc != 0) {
+			i = snprintf(line, sizeof(line), "c%lld %lld %s\n",
+				(long long)(end - len), (long long)end, (rc > 0) ? key : "*");
+			log_index_write(line, i);
+		}
+		return;
+	}
+
+	if (rc < 0)
+		log_index_all = 1;
+	else if ((rc > 0) && !log_index_all) {
+		for (i = log_index_nkeys - 1; i >= 0; i--) {
+			if (strcmp(log_index_keys[i], key) == 0)
+				break;
+		}
+		if (i < 0) {
+			if (log_index_nkeys == LOG_INDEX_MAXKEYS)
+				log_index_flush();
+			strcpy(log_index_keys[log_index_nkeys++], key);
+		}
+	}
+	log_index_end = end;
+	if (log_index_end - log_index_start >= LOG_INDEX_BLOCK)
+		log_index_flush();
+}
+
+/**
+ * @brief
+ *	Find where the ranges written to an index by the owner of the log
+ *	end, from the last lines of the index.
+ *
+ * @param[in]	fd - the index
+ *
+ * @return	off_t
+ * @retval	the end of the last owner's range, 0 if none is found
+ *
+ */
+static off_t
+log_index_covered(int fd)
+{
+	static char buf[LOG_INDEX_BLOCK + 1];
+	long long start, end;
+	off_t covered = 0;
+	off_t size;
+	off_t from;
+	ssize_t n;
+	char *p;
+	char *nl;
+
+	if ((size = lseek(fd, 0, SEEK_END)) <= 0)
+		return 0;
+	from = (size > LOG_INDEX_BLOCK) ? size - LOG_INDEX_BLOCK : 0;
+	if ((n = pread(fd, buf, size - from, from)) <= 0)
+		return 0;
+	buf[n] = '\0';
+
+	p = buf;
+	if ((from > 0) && ((p = strchr(buf, '\n')) != NULL))
+		p++;
+	/* lines of children start with 'c' and do not scan */
+	for (; (p != NULL) && ((nl = strchr(p, '\n')) != NULL); p = nl + 1) {
+		if ((sscanf(p, "%lld %lld", &start, &end) == 2) && (end > covered))
+			covered = end;
+	}
+	return covered;
+}
+
+/**
+ * @brief
+ *	Open the job index of a log file just opened, if PBS_LOG_INDEX is
+ *	set.  Records written to the log since the index last covered it,
+ *	for instance before a restart, are given a range of unknown jobs.
+ *
+ * @param[in]	filename - the log file
+ * @param[in]	fds - its descriptor
+ *
+ */
+static void
+log_index_open(const char *filename, int fds)
+{
+	struct stat sb;
+	off_t covered;
+	int fd;
+
+	log_index_fd = -1;
+	if (!pbs_conf.pbs_log_index)
+		return;
+	if (fstat(fds, &sb) == -1)
+		return;
+
+	snprintf(log_index_name, sizeof(log_index_name), "%s%s", filename,
+		LOG_INDEX_SUFFIX);
+	if ((fd = open(log_index_name, O_CREAT|O_RDWR|O_APPEND, 0644)) == -1)
+		return;
+	if (fd < 3) {
+		int nfd = fcntl(fd, F_DUPFD, 3);
+
+		(void)close(fd);
+		if ((fd = nfd) == -1)
+			return;
+	}
+
+	covered = log_index_covered(fd);
+	if (covered > sb.st_size) {
+		/* the index is not of this log */
+		if (ftruncate(fd, 0) == -1) {
+			(void)close(fd);
+			return;
+		}
+		covered = 0;
+	}
+
+	log_index_fd = fd;
+	log_index_pid = getpid();
+	log_index_nkeys = 0;
+	log_index_all = 0;
+	log_index_start = log_index_end = sb.st_size;
+	if (covered < sb.st_size) {
+		log_index_start = covered;
+		log_index_all = 1;
+		log_index_flush();
+	}
+}
+
+/**
+ * @brief
+ *	Write what is gathered for the job index and close it.
+ *
+ */
+static void
+log_index_close(void)
+{
+	if (log_index_fd == -1)
+		return;
+	if (getpid() == log_index_pid)
+		log_index_flush();
+	(void)close(log_index_fd);
+	log_index_fd = -1;
+}
+
+/**
+ * @brief
+ *	Make the calling process the owner of the job index of the open
+ *	log.  A daemon that forks to go into the background after opening
+ *	its log calls this in the child, so the child gathers ranges of
+ *	records instead of writing a line for each.
+ *
+ */
+void
+log_set_index_owner(void)
+{
+	log_index_pid = getpid();
+}
 #endif
 
 /**
@@ -592,6 +1227,13 @@ log_open_main(char *filename, char *directory, int silent)
 		(void)setvbuf(logfile, NULL, _IOLBF, 0);	/* set line buffering */
 #endif
 		log_opened = 1;			/* note that file is open */
+#ifndef WIN32
+		log_index_open(filename, fds);
+
+		/* restart the writer thread stopped by log_close() */
+		if (log_async_size > 0)
+			(void)log_async_run();
+#endif
 
 		if (!silent) {
 			log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, "Log", "Log opened");
@@ -890,6 +1532,44 @@ log_record(int eventtype, int objclass, int sev, const char *objname, const char
 	ptm = localtime_r(&now, &ltm);
 #endif
 
+#ifndef WIN32
+	/*
+	 * Asynchronous logging: queue the record for the writer thread.
+	 * A thread already holding the log mutex, such as the writer
+	 * switching the log, logs synchronously as before.
+	 */
+	if (log_async_running && (pthread_getspecific(pbs_log_tls_key) == NULL)) {
+		char abuf[LOG_BUF_SIZE + 256];
+		char *pbuf = abuf;
+		int len;
+
+		if (pbs_conf.locallog == 0 && pbs_conf.syslogfac != 0)
+			return;
+		len = snprintf(abuf, sizeof(abuf),
+			"%02d/%02d/%04d %02d:%02d:%02d%s;%04x;%s;%s;%s;%s\n",
+			ptm->tm_mon + 1, ptm->tm_mday, ptm->tm_year + 1900,
+			ptm->tm_hour, ptm->tm_min, ptm->tm_sec, microsec_buf,
+			eventtype & ~PBSEVENT_FORCE, msg_daemonname,
+			class_names[objclass], objname, text);
+		if (len < 0)
+			return;
+		if (len >= (int)sizeof(abuf)) {
+			if ((pbuf = malloc(len + 1)) == NULL)
+				return;
+			(void)snprintf(pbuf, len + 1,
+				"%02d/%02d/%04d %02d:%02d:%02d%s;%04x;%s;%s;%s;%s\n",
+				ptm->tm_mon + 1, ptm->tm_mday, ptm->tm_year + 1900,
+				ptm->tm_hour, ptm->tm_min, ptm->tm_sec, microsec_buf,
+				eventtype & ~PBSEVENT_FORCE, msg_daemonname,
+				class_names[objclass], objname, text);
+		}
+		log_async_put(ptm->tm_yday, pbuf, len);
+		if (pbuf != abuf)
+			free(pbuf);
+		return;
+	}
+#endif
+
 	/* lock the log mutex */
 	if (log_mutex_lock() != 0)
 		return;
@@ -920,6 +1600,10 @@ log_record(int eventtype, int objclass, int sev, const char *objname, const char
 			     class_names[objclass], objname, text);
 
 		(void)fflush(logfile);
+#ifndef WIN32
+		if (rc > 0)
+			log_index_record(objname, rc);
+#endif
 		if (rc < 0) {
 			rc = errno;
 			clearerr(logfile);
@@ -968,6 +1652,19 @@ log_close(int msg)
 			log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER,
 				LOG_INFO, "Log", "Log closed");
 		}
+#ifndef WIN32
+		/* stop the writer thread, which writes what is queued first */
+		if (log_async_running &&
+			!pthread_equal(pthread_self(), log_async_thread)) {
+			(void)pthread_mutex_lock(&log_async_mutex);
+			log_async_stop = 1;
+			(void)pthread_cond_signal(&log_async_cond);
+			(void)pthread_mutex_unlock(&log_async_mutex);
+			(void)pthread_join(log_async_thread, NULL);
+			log_async_running = 0;
+		}
+		log_index_close();
+#endif
 		(void)fclose(logfile);
 		log_opened = 0;
 	}
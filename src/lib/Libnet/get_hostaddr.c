@@ -37,6 +37,7 @@
  */
 #include <pbs_config.h>   /* the master config generated by configure */
 
+#include <stdlib.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netdb.h>
@@ -48,6 +49,7 @@
 #include "net_connect.h"
 #include "pbs_error.h"
 #include "pbs_internal.h"
+#include "hostcache.h"
 
 #if !defined(H_ERRNO_DECLARED)
 extern int h_errno;
@@ -82,9 +84,8 @@ extern int h_errno;
 pbs_net_t
 get_hostaddr(char *hostname)
 {
-	struct addrinfo *aip, *pai;
-	struct addrinfo hints;
-	struct sockaddr_in *inp;
+	struct in_addr	*addrs;
+	int		naddrs;
 	int		err;
 	pbs_net_t	res;
 
@@ -93,39 +94,20 @@ get_hostaddr(char *hostname)
 		return ((pbs_net_t)0);
 	}
 
-	memset(&hints, 0, sizeof(struct addrinfo));
-	/*
-	 *      Why do we use AF_UNSPEC rather than AF_INET?  Some
-	 *      implementations of getaddrinfo() will take an IPv6
-	 *      address and map it to an IPv4 one if we ask for AF_INET
-	 *      only.  We don't want that - we want only the addresses
-	 *      that are genuinely, natively, IPv4 so we start with
-	 *      AF_UNSPEC and filter ai_family below.
-	 */
-	hints.ai_family = AF_UNSPEC;
-	hints.ai_socktype = SOCK_STREAM;
-	hints.ai_protocol = IPPROTO_TCP;
-	if ((err = getaddrinfo(hostname, NULL, &hints, &pai)) != 0) {
+	/* only the native IPv4 addresses are returned */
+	if ((err = hostcache_addrs(hostname, &addrs, &naddrs)) != 0) {
 		if (err == EAI_AGAIN)
 			pbs_errno = PBS_NET_RC_RETRY;
 		else
 			pbs_errno = PBS_NET_RC_FATAL;
 		return ((pbs_net_t)0);
 	}
-	for (aip = pai; aip != NULL; aip = aip->ai_next) {
-		/* skip non-IPv4 addresses */
-		if (aip->ai_family == AF_INET) {
-			inp = (struct sockaddr_in *) aip->ai_addr;
-			break;
-		}
-	}
-	if (aip == NULL) {
+	if (naddrs == 0) {
 		/* treat no IPv4 addresses as fatal getaddrinfo() failure */
 		pbs_errno = PBS_NET_RC_FATAL;
-		freeaddrinfo(pai);
 		return ((pbs_net_t)0);
 	}
-	res = ntohl(inp->sin_addr.s_addr);
-	freeaddrinfo(pai);
+	res = ntohl(addrs[0].s_addr);
+	free(addrs);
 	return (res);
 }
@@ -0,0 +1,444 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+/**
+ * @file	hostcache.c
+ *
+ * @brief
+ *	A cache of forward and reverse host name lookups shared by the
+ *	server, MoM, pbs_comm and the TPP layer, so that repeated lookups of
+ *	the same hosts do not each go to the resolver.
+ *
+ * Functions included are:
+ *	hostcache_addrs()
+ *	hostcache_name()
+ *	hostcache_flush()
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include "portability.h"
+#include "pbs_internal.h"
+#include "name_idx.h"
+#include "hostcache.h"
+
+/* a map is emptied rather than grown past this many entries */
+#define HOSTCACHE_MAX	10000
+
+typedef struct hostcache_ent {
+	struct hostcache_ent	*hc_next;	/* all entries of a map */
+	time_t			 hc_expires;	/* entry is stale from this time */
+	int			 hc_err;	/* EAI_* code of a failed lookup */
+	int			 hc_naddrs;	/* forward: number of hc_addrs */
+	struct in_addr		*hc_addrs;	/* forward: the addresses */
+	char			*hc_name;	/* reverse: the name */
+} hostcache_ent;
+
+typedef struct hostcache_map {
+	name_idx	*hm_idx;	/* key to hostcache_ent */
+	hostcache_ent	*hm_ents;	/* every entry in hm_idx */
+	int		 hm_nents;	/* length of hm_ents */
+} hostcache_map;
+
+static hostcache_map hostcache_fwd;	/* host name to addresses */
+static hostcache_map hostcache_rev;	/* dotted address to host name */
+static pthread_mutex_t hostcache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t hostcache_once = PTHREAD_ONCE_INIT;
+static volatile sig_atomic_t hostcache_gen;	/* bumped by hostcache_flush */
+static sig_atomic_t hostcache_seen;		/* hostcache_gen at last empty */
+
+/**
+ * @brief
+ *	pthread_atfork() handlers, so a child is never left with the cache
+ *	locked by a thread that does not exist in it.
+ */
+static void
+hostcache_atfork_prepare(void)
+{
+	(void)pthread_mutex_lock(&hostcache_mutex);
+}
+
+static void
+hostcache_atfork_release(void)
+{
+	(void)pthread_mutex_unlock(&hostcache_mutex);
+}
+
+static void
+hostcache_init(void)
+{
+#ifndef WIN32
+	(void)pthread_atfork(hostcache_atfork_prepare, hostcache_atfork_release,
+		hostcache_atfork_release);
+#endif
+}
+
+/**
+ * @brief
+ *	Return how long an answer may be cached, 0 if caching is off.
+ *
+ * @param[in]	err - EAI_* code of the lookup, 0 if it succeeded
+ *
+ * @return	time_t
+ * @retval	seconds the answer stays valid
+ */
+static time_t
+hostcache_ttl(int err)
+{
+	time_t ttl = (time_t)pbs_conf.pbs_host_cache_ttl;
+
+	if ((err == 0) || (ttl == 0))
+		return ttl;
+	/* a temporary failure is always retried */
+	if (err == EAI_AGAIN)
+		return 0;
+	return ((ttl >= 10) ? ttl / 10 : 1);
+}
+
+/**
+ * @brief
+ *	Free every entry of a map and the map's index.
+ *
+ * @param[in]	map - the map to empty
+ */
+static void
+hostcache_empty(hostcache_map *map)
+{
+	hostcache_ent *pe;
+
+	while ((pe = map->hm_ents) != NULL) {
+		map->hm_ents = pe->hc_next;
+		free(pe->hc_addrs);
+		free(pe->hc_name);
+		free(pe);
+	}
+	map->hm_nents = 0;
+	free_name_idx(map->hm_idx);
+	map->hm_idx = NULL;
+}
+
+/**
+ * @brief
+ *	Find the entry for a key, creating an empty, already stale one if
+ *	there is none.  Called with hostcache_mutex held.
+ *
+ * @param[in]	map - the map to look in
+ * @param[in]	key - host name or dotted address
+ * @param[in]	nocase - create the map's index case insensitive
+ *
+ * @return	hostcache_ent *
+ * @retval	the entry
+ * @retval	NULL - out of memory, the answer is not cached
+ */
+static hostcache_ent *
+hostcache_find(hostcache_map *map, char *key, int nocase)
+{
+	hostcache_ent *pe;
+
+	if (hostcache_seen != hostcache_gen) {
+		hostcache_seen = hostcache_gen;
+		hostcache_empty(&hostcache_fwd);
+		hostcache_empty(&hostcache_rev);
+	}
+	if (map->hm_idx != NULL) {
+		if ((pe = find_name_idx(map->hm_idx, key)) != NULL)
+			return pe;
+		if (map->hm_nents >= HOSTCACHE_MAX)
+			hostcache_empty(map);
+	}
+	if (map->hm_idx == NULL) {
+		map->hm_idx = nocase ? create_name_idx_nocase() : create_name_idx();
+		if (map->hm_idx == NULL)
+			return NULL;
+	}
+	if ((pe = calloc(1, sizeof(hostcache_ent))) == NULL)
+		return NULL;
+	if (name_idx_add_del(map->hm_idx, key, pe, NAME_IDX_OP_ADD) != 0) {
+		free(pe);
+		return NULL;
+	}
+	pe->hc_next = map->hm_ents;
+	map->hm_ents = pe;
+	map->hm_nents++;
+	return pe;
+}
+
+/**
+ * @brief
+ *	Look up the native IPv4 addresses of a host.
+ *
+ * @param[in]	host - the host name
+ * @param[out]	paddrs - the addresses, or NULL if unresolved
+ * @param[out]	count - number of addresses
+ *
+ * @return	int
+ * @retval	0 - success
+ * @retval	EAI_* code of getaddrinfo()
+ */
+static int
+hostcache_resolve(char *host, struct in_addr **paddrs, int *count)
+{
+	struct addrinfo *aip, *pai;
+	struct addrinfo hints;
+	int n;
+	int err;
+
+	*paddrs = NULL;
+	*count = 0;
+
+	memset(&hints, 0, sizeof(struct addrinfo));
+	/*
+	 *	Why do we use AF_UNSPEC rather than AF_INET?  Some
+	 *	implementations of getaddrinfo() will take an IPv6
+	 *	address and map it to an IPv4 one if we ask for AF_INET
+	 *	only.  We don't want that - we want only the addresses
+	 *	that are genuinely, natively, IPv4 so we start with
+	 *	AF_UNSPEC and filter ai_family below.
+	 */
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+	if ((err = getaddrinfo(host, NULL, &hints, &pai)) != 0)
+		return err;
+
+	for (n = 0, aip = pai; aip != NULL; aip = aip->ai_next) {
+		if (aip->ai_family == AF_INET)
+			n++;
+	}
+	if (n > 0) {
+		if ((*paddrs = malloc(n * sizeof(struct in_addr))) == NULL) {
+			freeaddrinfo(pai);
+			return EAI_MEMORY;
+		}
+		for (aip = pai; aip != NULL; aip = aip->ai_next) {
+			if (aip->ai_family == AF_INET)
+				(*paddrs)[(*count)++] =
+					((struct sockaddr_in *) aip->ai_addr)->sin_addr;
+		}
+	}
+	freeaddrinfo(pai);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Get the native IPv4 addresses of a host, from the cache if a fresh
+ *	answer is held, in the order getaddrinfo() returned them.
+ *
+ * @param[in]	host - the host name
+ * @param[out]	paddrs - malloc'ed array of addresses for the caller to
+ *			 free, NULL if there are none
+ * @param[out]	count - number of addresses, may be 0 if the host has
+ *			no IPv4 address
+ *
+ * @return	int
+ * @retval	0 - success
+ * @retval	EAI_* code of the (possibly cached) failed lookup
+ *
+ * @par MT-safe: Yes
+ */
+int
+hostcache_addrs(char *host, struct in_addr **paddrs, int *count)
+{
+	hostcache_ent *pe;
+	struct in_addr *addrs;
+	time_t now;
+	int n;
+	int err;
+
+	*paddrs = NULL;
+	*count = 0;
+
+	if (pbs_conf.pbs_host_cache_ttl == 0)
+		return hostcache_resolve(host, paddrs, count);
+
+	(void)pthread_once(&hostcache_once, hostcache_init);
+	now = time(NULL);
+	(void)pthread_mutex_lock(&hostcache_mutex);
+	pe = hostcache_find(&hostcache_fwd, host, 1);
+	if ((pe != NULL) && (pe->hc_expires > now)) {
+		err = pe->hc_err;
+		if ((err == 0) && (pe->hc_naddrs > 0)) {
+			n = pe->hc_naddrs;
+			if ((*paddrs = malloc(n * sizeof(struct in_addr))) == NULL)
+				err = EAI_MEMORY;
+			else {
+				memcpy(*paddrs, pe->hc_addrs, n * sizeof(struct in_addr));
+				*count = n;
+			}
+		}
+		(void)pthread_mutex_unlock(&hostcache_mutex);
+		return err;
+	}
+	(void)pthread_mutex_unlock(&hostcache_mutex);
+
+	/* do not hold the cache while the resolver is asked */
+	err = hostcache_resolve(host, paddrs, count);
+	if ((err == EAI_MEMORY) || (hostcache_ttl(err) == 0))
+		return err;
+
+	addrs = NULL;
+	if (*count > 0) {
+		if ((addrs = malloc(*count * sizeof(struct in_addr))) == NULL)
+			return err;
+		memcpy(addrs, *paddrs, *count * sizeof(struct in_addr));
+	}
+	(void)pthread_mutex_lock(&hostcache_mutex);
+	if ((pe = hostcache_find(&hostcache_fwd, host, 1)) != NULL) {
+		free(pe->hc_addrs);
+		pe->hc_addrs = addrs;
+		pe->hc_naddrs = *count;
+		pe->hc_err = err;
+		pe->hc_expires = now + hostcache_ttl(err);
+	} else
+		free(addrs);
+	(void)pthread_mutex_unlock(&hostcache_mutex);
+	return err;
+}
+
+/**
+ * @brief
+ *	Get the name of an IPv4 address, from the cache if a fresh answer
+ *	is held.  Behaves as getnameinfo() of the address with the given
+ *	flags, of which only NI_NAMEREQD is honoured: without it, an address
+ *	that has no name is returned in numeric form.
+ *
+ * @param[in]	addr - the address, in network order
+ * @param[out]	buf - buffer for the name
+ * @param[in]	len - size of buf
+ * @param[in]	flags - 0 or NI_NAMEREQD
+ *
+ * @return	int
+ * @retval	0 - success
+ * @retval	EAI_* code of the (possibly cached) failed lookup
+ *
+ * @par MT-safe: Yes
+ */
+int
+hostcache_name(struct in_addr addr, char *buf, size_t len, int flags)
+{
+	hostcache_ent *pe;
+	struct sockaddr_in sa;
+	char key[INET_ADDRSTRLEN + 1];
+	char name[NI_MAXHOST + 1];
+	time_t now;
+	int err;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sin_family = AF_INET;
+	sa.sin_addr = addr;
+
+	if (pbs_conf.pbs_host_cache_ttl == 0)
+		return getnameinfo((struct sockaddr *) &sa, sizeof(sa), buf, len,
+			NULL, 0, flags & NI_NAMEREQD);
+
+#ifdef WIN32
+	/* inet_ntoa is thread-safe on windows */
+	strncpy(key, inet_ntoa(addr), sizeof(key) - 1);
+	key[sizeof(key) - 1] = '\0';
+#else
+	if (inet_ntop(AF_INET, (void *) &addr, key, sizeof(key)) == NULL)
+		return EAI_FAIL;
+#endif
+
+	(void)pthread_once(&hostcache_once, hostcache_init);
+	now = time(NULL);
+	(void)pthread_mutex_lock(&hostcache_mutex);
+	pe = hostcache_find(&hostcache_rev, key, 0);
+	if ((pe != NULL) && (pe->hc_expires > now)) {
+		err = pe->hc_err;
+		if (err == 0)
+			strncpy(name, pe->hc_name, sizeof(name) - 1);
+		name[sizeof(name) - 1] = '\0';
+		(void)pthread_mutex_unlock(&hostcache_mutex);
+	} else {
+		(void)pthread_mutex_unlock(&hostcache_mutex);
+
+		/* do not hold the cache while the resolver is asked */
+		err = getnameinfo((struct sockaddr *) &sa, sizeof(sa), name,
+			sizeof(name), NULL, 0, NI_NAMEREQD);
+		if (hostcache_ttl(err) != 0) {
+			(void)pthread_mutex_lock(&hostcache_mutex);
+			if ((pe = hostcache_find(&hostcache_rev, key, 0)) != NULL) {
+				free(pe->hc_name);
+				pe->hc_name = (err == 0) ? strdup(name) : NULL;
+				if ((err == 0) && (pe->hc_name == NULL))
+					pe->hc_expires = 0;
+				else {
+					pe->hc_err = err;
+					pe->hc_expires = now + hostcache_ttl(err);
+				}
+			}
+			(void)pthread_mutex_unlock(&hostcache_mutex);
+		}
+	}
+
+	if (err != 0) {
+		if ((flags & NI_NAMEREQD) || (err == EAI_AGAIN) || (err == EAI_MEMORY))
+			return err;
+		/* no name found, so give the address as getnameinfo() would */
+		strncpy(name, key, sizeof(name) - 1);
+		name[sizeof(name) - 1] = '\0';
+	}
+	if (strlen(name) >= len)
+		return EAI_OVERFLOW;
+	strcpy(buf, name);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Discard every cached answer, as on SIGHUP after the hosts file or
+ *	DNS has been changed.  Only marks the cache, which is emptied at
+ *	the next lookup, so this is safe to call from a signal handler.
+ */
+void
+hostcache_flush(void)
+{
+	hostcache_gen++;
+}
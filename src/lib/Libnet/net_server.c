@@ -69,6 +69,7 @@
 #include "libsec.h"
 #include "pbs_error.h"
 #include "pbs_internal.h"
+#include "hostcache.h"
 #include "list_link.h"
 #include "attribute.h"
 #include "job.h"
@@ -88,6 +89,7 @@
 
 static conn_t **svr_conn;    /* list of pointers to connections indexed by the socket fd. List is dynamically allocated */
 #define CONNS_ARRAY_INCREMENT	100 /* Increases this many more connection pointers when dynamically allocating memory for svr_conn */
+#define ACCEPT_BATCH_MAX	64  /* connections accepted at most each time a main socket is ready */
 static int conns_array_size = 0;  /* Size of the svr_conn list, initialized to 0 */
 pbs_list_head svr_allconns; /* head of the linked list of active connections */
 
@@ -97,6 +99,7 @@ pbs_list_head svr_allconns; /* head of the linked list of active connections */
 int	max_connection = -1;
 static int	num_connections = 0;
 static int	net_is_initialized = 0;
+static int	net_closing_all = 0;	/* net_close() is closing every connection */
 static void	*poll_context;  /* This is the context of the descriptors being polled */
 void 	*priority_context;
 static int      init_poll_context();  /* Initialize the tpp context */
@@ -108,6 +111,7 @@ static char	logbuf[256];
 static int 	connection_find_usable_index(int);
 static int 	connection_find_actual_index(int);
 static void 	accept_conn();
+static int 	accept_one_conn(int);
 static void 	cleanup_conn(int);
 
 extern void DIS_tcp_release(int fd);
@@ -370,8 +374,14 @@ init_network_add(int sd, int (*readyreadfunc)(int), void (*readfunc)(int))
 		return -1;
 	}
 
+#ifndef WIN32
+	/* accept_conn() accepts all pending connections until none are left */
+	if (fcntl(sd, F_SETFL, fcntl(sd, F_GETFL) | O_NONBLOCK) == -1)
+		log_err(errno, __func__, "fcntl(O_NONBLOCK) failed");
+#endif
+
 	/* start listening for connections */
-	if (listen(sd, 256) < 0) {
+	if (listen(sd, SOMAXCONN) < 0) {
 		log_err(errno, __func__ , "listen failed");
 #ifdef WIN32
 		errno = WSAGetLastError();
@@ -411,7 +421,7 @@ connection_idlecheck(void)
 			continue;
 		if ((now - cp->cn_lasttime) <= PBS_NET_MAXCONNECTIDLE)
 			continue;
-		if (cp->cn_authen & PBS_NET_CONN_NOTIMEOUT)
+		if (cp->cn_authen & (PBS_NET_CONN_NOTIMEOUT | PBS_NET_CONN_BUSY | PBS_NET_CONN_HELD))
 			continue; /* do not time-out this connection */
 
 		ipaddr = cp->cn_addr;
@@ -649,6 +659,11 @@ wait_request(time_t waittime, void *priority_context)
  *	function: process_request(socket)Makes a PBS_BATCH_Connect request to
  *	'server'.
  *
+ * @par
+ *	The main socket is non-blocking, so when many clients connect at
+ *	once, up to ACCEPT_BATCH_MAX of the pending connections are accepted
+ *	each time it is ready, instead of one per wait_request().
+ *
  * @param[in]   sd - main socket with connection request pending
  *
  * @return void
@@ -656,14 +671,41 @@ wait_request(time_t waittime, void *priority_context)
  */
 static void
 accept_conn(int sd)
+{
+	int n;
+
+	for (n = 0; n < ACCEPT_BATCH_MAX; n++) {
+		if (accept_one_conn(sd) != 0)
+			break;
+#ifdef WIN32
+		break;	/* the main socket blocks */
+#endif
+	}
+}
+
+/**
+ * @brief
+ *	accept one connection pending on a main socket, see accept_conn().
+ *
+ * @param[in]   sd - main socket with connection request pending
+ *
+ * @return int
+ * @retval 0	- a connection was accepted, or refused, and more may be pending
+ * @retval -1	- none is pending, or the main socket failed
+ */
+static int
+accept_one_conn(int sd)
 {
 	int newsock;
 	struct sockaddr_in from;
 	pbs_socklen_t fromsize;
+#ifndef WIN32
+	int flags;
+#endif
 
 	int idx = connection_find_actual_index(sd);
 	if (idx == -1)
-		return;
+		return -1;
 
 	/* update last-time of main socket */
 
@@ -674,11 +716,25 @@ accept_conn(int sd)
 	if (newsock == -1) {
 #ifdef WIN32
 		errno = WSAGetLastError();
+#else
+		if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+			return -1;	/* no more pending */
+		if (errno == ECONNABORTED)
+			return 0;	/* gone before accepted, look for the next */
 #endif
 		log_err(errno, __func__ , "accept failed");
-		return;
+		return -1;
 	}
 
+#ifndef WIN32
+	/* some systems pass on O_NONBLOCK of the main socket, but
+	 * connections are read and written blocking
+	 */
+	flags = fcntl(newsock, F_GETFL);
+	if ((flags != -1) && (flags & O_NONBLOCK))
+		(void)fcntl(newsock, F_SETFL, flags & ~O_NONBLOCK);
+#endif
+
 	/*
 	 * Disable Nagle's algorithm on this TCP connection to server.
 	 * Nagle's algorithm is hurting cmd-server communication.
@@ -686,7 +742,7 @@ accept_conn(int sd)
 	if (set_nodelay(newsock) == -1) {
 		log_err(errno, __func__, "set_nodelay failed");
 		(void)close(newsock);
-		return;		/* set_nodelay failed */
+		return 0;		/* set_nodelay failed */
 	}
 
 	/* add the new socket to the select set and connection structure */
@@ -696,6 +752,7 @@ accept_conn(int sd)
 		(unsigned int)ntohs(from.sin_port),
 		ready_read_func,
 		read_func[(int)svr_conn[idx]->cn_active]);
+	return 0;
 }
 
 /**
@@ -854,6 +911,153 @@ get_conn_data(int sd)
 	return svr_conn[idx]->cn_data;
 }
 
+/**
+ * @brief
+ *	net_suspend_conn - take a connection off the poll list while some other
+ *	thread reads from it.
+ *
+ * @par Functionality:
+ *	The connection is marked PBS_NET_CONN_BUSY so that it is neither timed
+ *	out by connection_idlecheck() nor polled again until
+ *	net_resume_conn() is called.  Priority sockets are not suspended.
+ *
+ * @param[in]	sd - socket descriptor
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- failure, the connection is left as it was
+ */
+int
+net_suspend_conn(int sd)
+{
+	int idx = connection_find_actual_index(sd);
+
+	if ((idx < 0) || svr_conn[idx]->cn_prio_flag ||
+		(svr_conn[idx]->cn_authen & PBS_NET_CONN_HELD))
+		return -1;
+	if (svr_conn[idx]->cn_authen & PBS_NET_CONN_BUSY)
+		return 0;
+
+	if (tpp_em_del_fd(poll_context, sd) < 0) {
+		int err = errno;
+		snprintf(logbuf, sizeof(logbuf),
+			"could not remove socket %d from poll list", sd);
+		log_err(err, __func__, logbuf);
+		return -1;
+	}
+	svr_conn[idx]->cn_authen |= PBS_NET_CONN_BUSY;
+	return 0;
+}
+
+/**
+ * @brief
+ *	net_resume_conn - put a connection taken off by net_suspend_conn()
+ *	back on the poll list.
+ *
+ * @param[in]	sd - socket descriptor
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- failure or close_conn() was called on the connection
+ *			  while it was suspended, the caller must close it
+ */
+int
+net_resume_conn(int sd)
+{
+	int idx = connection_find_actual_index(sd);
+
+	if (idx < 0)
+		return -1;
+	if ((svr_conn[idx]->cn_authen & PBS_NET_CONN_BUSY) == 0)
+		return 0;
+
+	svr_conn[idx]->cn_authen &= ~PBS_NET_CONN_BUSY;
+	svr_conn[idx]->cn_lasttime = time(NULL);
+	if (tpp_em_add_fd(poll_context, sd, EM_IN | EM_HUP | EM_ERR) < 0) {
+		int err = errno;
+		snprintf(logbuf, sizeof(logbuf),
+			"could not add socket %d to the poll list", sd);
+		log_err(err, __func__, logbuf);
+		return -1;
+	}
+	if (svr_conn[idx]->cn_authen & PBS_NET_CONN_CLOSEPEND)
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	net_hold_conn - take a pipelined connection off the poll list while
+ *	its current request is being answered.
+ *
+ * @par Functionality:
+ *	A client on a PBS_NET_CONN_PIPELINE connection may have sent further
+ *	requests already.  Holding the connection keeps the server from
+ *	reading them until the reply to the current one is out, so replies
+ *	go back in request order even when a request is answered later, for
+ *	instance after a round trip to a mom.  Unlike net_suspend_conn(), a
+ *	held connection can be closed at any time.
+ *
+ * @param[in]	sd - socket descriptor
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- failure, the connection is left as it was
+ */
+int
+net_hold_conn(int sd)
+{
+	int idx = connection_find_actual_index(sd);
+
+	if ((idx < 0) || svr_conn[idx]->cn_prio_flag)
+		return -1;
+	if (svr_conn[idx]->cn_authen & (PBS_NET_CONN_HELD | PBS_NET_CONN_BUSY))
+		return 0;
+
+	if (tpp_em_del_fd(poll_context, sd) < 0) {
+		int err = errno;
+		snprintf(logbuf, sizeof(logbuf),
+			"could not remove socket %d from poll list", sd);
+		log_err(err, __func__, logbuf);
+		return -1;
+	}
+	svr_conn[idx]->cn_authen |= PBS_NET_CONN_HELD;
+	return 0;
+}
+
+/**
+ * @brief
+ *	net_release_conn - put a connection taken off by net_hold_conn() back
+ *	on the poll list.
+ *
+ * @param[in]	sd - socket descriptor
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- failure
+ */
+int
+net_release_conn(int sd)
+{
+	int idx = connection_find_actual_index(sd);
+
+	if (idx < 0)
+		return -1;
+	if ((svr_conn[idx]->cn_authen & PBS_NET_CONN_HELD) == 0)
+		return 0;
+
+	svr_conn[idx]->cn_authen &= ~PBS_NET_CONN_HELD;
+	svr_conn[idx]->cn_lasttime = time(NULL);
+	if (tpp_em_add_fd(poll_context, sd, EM_IN | EM_HUP | EM_ERR) < 0) {
+		int err = errno;
+		snprintf(logbuf, sizeof(logbuf),
+			"could not add socket %d to the poll list", sd);
+		log_err(err, __func__, logbuf);
+		return -1;
+	}
+	return 0;
+}
+
 /**
  * @brief
  *	close_conn - close a connection in the svr_conn array.
@@ -891,6 +1095,19 @@ close_conn(int sd)
 	if (idx == -1)
 		return;
 
+	/*
+	 * another thread is still reading a suspended connection, so the
+	 * socket cannot be closed and reused under it; cut the reader short
+	 * and let net_resume_conn() tell the caller to close it afterward
+	 */
+	if ((svr_conn[idx]->cn_authen & PBS_NET_CONN_BUSY) && !net_closing_all) {
+		svr_conn[idx]->cn_authen |= PBS_NET_CONN_CLOSEPEND;
+#ifndef WIN32
+		(void)shutdown(sd, SHUT_RDWR);
+#endif
+		return;
+	}
+
 	if (svr_conn[idx]->cn_active == FromClientDIS
 		|| svr_conn[idx]->cn_active == ToServerDIS) {
 		DIS_tcp_release(sd);
@@ -942,7 +1159,8 @@ close_conn(int sd)
 static void
 cleanup_conn(int idx)
 {
-	if (tpp_em_del_fd(poll_context, svr_conn[idx]->cn_sock) < 0) {
+	if (((svr_conn[idx]->cn_authen & (PBS_NET_CONN_BUSY | PBS_NET_CONN_HELD)) == 0) &&
+		(tpp_em_del_fd(poll_context, svr_conn[idx]->cn_sock) < 0)) {
 		int err = errno;
 		snprintf(logbuf, sizeof(logbuf),
 			"could not remove socket %d from poll list", svr_conn[idx]->cn_sock);
@@ -997,6 +1215,7 @@ net_close(int but)
 	if (net_is_initialized == 0)
 		return;
 
+	net_closing_all = 1;
 	cp = (conn_t *)GET_NEXT(svr_allconns);
 	while(cp) {
 		int sock = cp->cn_sock;
@@ -1006,6 +1225,7 @@ net_close(int but)
 			close_conn(sock);
 		}
 	}
+	net_closing_all = 0;
 
 	if (but == -1) {
 		tpp_em_destroy(poll_context);
@@ -1053,12 +1273,9 @@ int
 get_connecthost(int sd, char *namebuf, int size)
 {
 	int             i;
-	struct hostent *phe;
 	struct in_addr  addr;
 	int	namesize = 0;
-#if !defined(WIN32)
-	char	dst[INET_ADDRSTRLEN + 1]; /* for inet_ntop */
-#endif
+	char	name[NI_MAXHOST + 1];
 
 	int	idx = connection_find_actual_index(sd);
 	if (idx == -1)
@@ -1067,24 +1284,16 @@ get_connecthost(int sd, char *namebuf, int size)
 	size--;
 	addr.s_addr = htonl(svr_conn[idx]->cn_addr);
 
-	if ((phe = gethostbyaddr((char *) &addr, sizeof(struct in_addr),
-		AF_INET)) == NULL) {
-#if defined(WIN32)
-			/* inet_ntoa is thread-safe on windows */
-			(void)strcpy(namebuf, inet_ntoa(addr));
-#else
-			(void)strcpy(namebuf,
-				inet_ntop(AF_INET, (void *) &addr, dst, INET_ADDRSTRLEN));
-#endif
-	} else {
-		namesize = strlen(phe->h_name);
-		for (i=0; i<size; i++) {
-			*(namebuf+i) = tolower((int)*(phe->h_name+i));
-			if (*(phe->h_name+i) == '\0')
-				break;
-		}
-		*(namebuf+size) = '\0';
+	/* an address with no name is given in numeric form */
+	if (hostcache_name(addr, name, sizeof(name), 0) != 0)
+		return (-1);
+	namesize = strlen(name);
+	for (i=0; i<size; i++) {
+		*(namebuf+i) = tolower((int)*(name+i));
+		if (*(name+i) == '\0')
+			break;
 	}
+	*(namebuf+size) = '\0';
 	if (namesize > size)
 		return (-1);
 
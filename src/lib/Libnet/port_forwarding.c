@@ -36,6 +36,34 @@ int x11_reader_go = 1;
 
 extern int set_nodelay(int fd);
 
+/**
+ * @brief
+ *      Write what is buffered by the peer of socks[n] to socks[n]'s socket.
+ *
+ * @param socks[in] - sockets being forwarded
+ * @param n[in] - index of the socket to write to
+ *
+ * @return int
+ * @retval return value of write(2); the peer's buffer is advanced on success
+ */
+static int
+pf_write_peer(struct pfwdsock *socks, int n)
+{
+	int peer = (socks + n)->peer;
+	int rc;
+
+	rc = write(
+		(socks + n)->sock,
+		(socks + peer)->buff + (socks + peer)->bufwritten,
+		(socks + peer)->bufavail - (socks + peer)->bufwritten);
+	if (rc > 0) {
+		(socks + peer)->bufwritten += rc;
+		if ((socks + peer)->bufwritten == (socks + peer)->bufavail)
+			(socks + peer)->bufavail = (socks + peer)->bufwritten = 0;
+	}
+	return rc;
+}
+
 /**
  * @brief
  *      This function provides the port forwarding feature for forwarding the
@@ -261,17 +289,24 @@ port_forwarder(
 						close((socks + n)->sock);
 						(socks + n)->active = 0;
 					} else{
+						int peer = (socks + n)->peer;
+
 						(socks + n)->bufavail += rc;
+						/*
+						 * Pass it on right away rather than on the next
+						 * pass; a failure is left for the select() below
+						 * to see.
+						 */
+						if ((socks + peer)->active && ((socks + peer)->sock >= 0))
+							(void)pf_write_peer(socks, peer);
 					}
 				}
 			} /* END if rfdset */
-			if (FD_ISSET((socks + n)->sock, &wfdset)) {
-				int peer = (socks + n)->peer;
-
-				rc = write(
-					(socks + n)->sock,
-					(socks + peer)->buff + (socks + peer)->bufwritten,
-					(socks + peer)->bufavail - (socks + peer)->bufwritten);
+			/* the peer's data may already have gone out after its read */
+			if (FD_ISSET((socks + n)->sock, &wfdset) &&
+				((socks + (socks + n)->peer)->bufavail >
+				(socks + (socks + n)->peer)->bufwritten)) {
+				rc = pf_write_peer(socks, n);
 
 				if (rc == -1) {
 					if ((errno == EWOULDBLOCK) || (errno == EAGAIN) || (errno == EINTR) || (errno == EINPROGRESS)) {
@@ -288,8 +323,6 @@ port_forwarder(
 					shutdown((socks + n)->sock, SHUT_RDWR);
 					close((socks + n)->sock);
 					(socks + n)->active = 0;
-				} else{
-					(socks + peer)->bufwritten += rc;
 				}
 			} /* END if wfdset */
 			if (!(socks + n)->listening) {
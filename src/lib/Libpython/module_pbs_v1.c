@@ -605,6 +605,35 @@ ERROR_EXIT:
 }
 
 
+/**
+ * @brief
+ * 	Return the extension module to add to the namespace of a hook script.
+ * 	The module only holds methods and constants, so it is built once per
+ * 	interpreter instead of for every event.
+ *
+ * @return	object
+ * @retval	The module object (borrowed reference)
+ * @retval	NULL	error
+ */
+PyObject *
+pbs_v1_module_namespace(void)
+{
+	if (PyPbsV1ModuleExtension_Obj != NULL)
+		return PyPbsV1ModuleExtension_Obj;
+	return pbs_v1_module_init();
+}
+
+/**
+ * @brief
+ * 	Forget the extension module, called before the interpreter is
+ * 	finalized.
+ */
+void
+pbs_v1_module_clear(void)
+{
+	PyPbsV1ModuleExtension_Obj = NULL;
+}
+
 /**
  * @brief
  * 	The below is for embedded interpreter puts it in the __main__
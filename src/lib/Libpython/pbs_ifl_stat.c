@@ -0,0 +1,521 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+
+/**
+ * @file	pbs_ifl_stat.c
+ * @brief
+ *	The _pbs_ifl_stat module: the status calls of the IFL, handing back
+ *	the batch_status list as Python objects built in one pass in C.  The
+ *	SWIG proxies of _pbs_ifl leave the caller to walk the batch_status
+ *	and attrl lists a node at a time in Python, and to free them.
+ *
+ *	Each status entry is a tuple (name, attribs), where attribs is a list
+ *	of (name, resource, value) tuples in the order the server sent them,
+ *	resource being None for an attribute without one.
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+/* include the pbs_python private file with python dependencies */
+#include <pbs_python_private.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include "pbs_ifl.h"
+#include "pbs_error.h"
+
+#define STAT_PAGE_DFLT	1000	/* jobs per page if not given */
+
+/**
+ * @brief
+ *	Make a str of a C string from the server, None if there isn't one.
+ *
+ * @param[in] s - the string
+ * @param[in] intern - intern the str, for names repeated in every entry
+ *
+ * @return	PyObject *
+ * @retval	new reference	success
+ * @retval	NULL		error, Python exception set
+ */
+static PyObject *
+stat_str(const char *s, int intern)
+{
+	PyObject *o;
+
+	if (s == NULL)
+		Py_RETURN_NONE;
+	o = PyUnicode_DecodeUTF8(s, strlen(s), "surrogateescape");
+	if ((o != NULL) && intern)
+		PyUnicode_InternInPlace(&o);
+	return o;
+}
+
+/**
+ * @brief
+ *	Convert one batch_status entry, not the ones after it.
+ *
+ * @param[in] bs - the entry
+ *
+ * @return	PyObject *
+ * @retval	new reference to a (name, attribs) tuple	success
+ * @retval	NULL				error, Python exception set
+ */
+static PyObject *
+stat_entry(struct batch_status *bs)
+{
+	struct attrl *pal;
+	PyObject *attribs;
+	PyObject *item;
+	Py_ssize_t n = 0;
+	Py_ssize_t i = 0;
+
+	for (pal = bs->attribs; pal != NULL; pal = pal->next)
+		n++;
+	if ((attribs = PyList_New(n)) == NULL)
+		return NULL;
+	for (pal = bs->attribs; pal != NULL; pal = pal->next) {
+		item = Py_BuildValue("(NNN)", stat_str(pal->name, 1),
+			stat_str(pal->resource, 1), stat_str(pal->value, 0));
+		if (item == NULL) {
+			Py_DECREF(attribs);
+			return NULL;
+		}
+		PyList_SET_ITEM(attribs, i++, item);
+	}
+	return Py_BuildValue("(NN)", stat_str(bs->name, 0), attribs);
+}
+
+/**
+ * @brief
+ *	Build the attrl list to ask for from a sequence of attribute names,
+ *	"name" or "name.resource".
+ *
+ * @param[in] seq - the sequence, or None for all the attributes
+ * @param[out] pattr - the list, NULL for all, free with stat_free_attrl()
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	error, Python exception set
+ */
+static int
+stat_make_attrl(PyObject *seq, struct attrl **pattr)
+{
+	PyObject *fast;
+	struct attrl *pal;
+	Py_ssize_t n;
+	Py_ssize_t i;
+	const char *s;
+	char *dot;
+
+	*pattr = NULL;
+	if ((seq == NULL) || (seq == Py_None))
+		return 0;
+	if ((fast = PySequence_Fast(seq, "attribs must be a sequence of str")) == NULL)
+		return -1;
+	n = PySequence_Fast_GET_SIZE(fast);
+	if (n == 0) {
+		Py_DECREF(fast);
+		return 0;
+	}
+	if ((pal = calloc(n, sizeof(struct attrl))) == NULL) {
+		Py_DECREF(fast);
+		PyErr_NoMemory();
+		return -1;
+	}
+	for (i = 0; i < n; i++) {
+		if (i + 1 < n)
+			pal[i].next = &pal[i + 1];
+		if ((s = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(fast, i))) == NULL)
+			break;
+		if ((pal[i].name = strdup(s)) == NULL) {
+			PyErr_NoMemory();
+			break;
+		}
+		if ((dot = strchr(pal[i].name, '.')) != NULL) {
+			*dot = '\0';
+			pal[i].resource = dot + 1;
+		}
+		pal[i].value = "";
+	}
+	Py_DECREF(fast);
+	*pattr = pal;
+	return (i == n) ? 0 : -1;
+}
+
+/**
+ * @brief
+ *	Free what stat_make_attrl() built.
+ *
+ * @param[in] pal - the list
+ */
+static void
+stat_free_attrl(struct attrl *pal)
+{
+	struct attrl *p;
+
+	for (p = pal; p != NULL; p = p->next)
+		free(p->name);
+	free(pal);
+}
+
+/* -----                  the stat_pages iterator                 ----- */
+
+typedef struct {
+	PyObject_HEAD
+	int			sp_conn;	/* connection handle */
+	char			*sp_id;		/* queue or server, or NULL */
+	char			*sp_extend;
+	struct attrl		*sp_attrl;
+	int			sp_count;	/* jobs per page */
+	int			sp_done;	/* last page fetched */
+	char			sp_cursor[PBS_STAT_CURSOR_LEN];
+	struct batch_status	*sp_page;	/* the page being returned */
+	struct batch_status	*sp_next;	/* next entry of the page */
+} StatPages_Object;
+
+static void
+stat_pages_dealloc(StatPages_Object *self)
+{
+	pbs_statfree(self->sp_page);
+	stat_free_attrl(self->sp_attrl);
+	free(self->sp_id);
+	free(self->sp_extend);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+/**
+ * @brief
+ *	Return the next job, fetching the next page when the one held is
+ *	used up.  Only one page is held and converted a job at a time.
+ *
+ * @param[in] self - the iterator
+ *
+ * @return	PyObject *
+ * @retval	new reference to a (name, attribs) tuple	next job
+ * @retval	NULL	no more jobs, or error with a Python exception set
+ */
+static PyObject *
+stat_pages_next(StatPages_Object *self)
+{
+	struct batch_status *bs;
+
+	while (self->sp_next == NULL) {
+		pbs_statfree(self->sp_page);
+		self->sp_page = NULL;
+		if (self->sp_done)
+			return NULL;	/* StopIteration */
+
+		Py_BEGIN_ALLOW_THREADS
+		bs = pbs_statjob_page(self->sp_conn, self->sp_id, self->sp_attrl,
+			self->sp_extend, self->sp_count, self->sp_cursor);
+		Py_END_ALLOW_THREADS
+		if ((bs == NULL) && (pbs_errno != PBSE_NONE)) {
+			self->sp_done = 1;
+			PyErr_Format(PyExc_OSError, "pbs_statjob_page failed, pbs_errno=%d",
+				pbs_errno);
+			return NULL;
+		}
+		if (self->sp_cursor[0] == '\0')
+			self->sp_done = 1;
+		self->sp_page = bs;
+		self->sp_next = bs;
+	}
+	bs = self->sp_next;
+	self->sp_next = bs->next;
+	return stat_entry(bs);
+}
+
+static char stat_pages_doc[] =
+    "stat_pages\n\
+    \titerator over the jobs of pbs_statjob_page(), a page at a time\n\
+    ";
+
+static PyTypeObject StatPages_Type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	/* ob_size*/
+	/* tp_name*/                        "_pbs_ifl_stat.stat_pages",
+	/* tp_basicsize*/                   sizeof(StatPages_Object),
+	/* tp_itemsize*/                    0,
+	/* tp_dealloc*/                     (destructor)stat_pages_dealloc,
+	/* tp_print*/                       0,
+	/* tp_getattr*/                     0,
+	/* tp_setattr*/                     0,
+	/* tp_as_async */		    0,
+	/* tp_repr*/                        0,
+	/* tp_as_number*/                   0,
+	/* tp_as_sequence*/                 0,
+	/* tp_as_mapping*/                  0,
+	/* tp_hash */                       0,
+	/* tp_call*/                        0,
+	/* tp_str*/                         0,
+	/* tp_getattro*/                    0,
+	/* tp_setattro*/                    0,
+	/* tp_as_buffer*/                   0,
+	/* tp_flags*/                       Py_TPFLAGS_DEFAULT,
+	/* tp_doc */                        stat_pages_doc,
+	/* tp_traverse */                   0,
+	/* tp_clear */                      0,
+	/* tp_richcompare */                0,
+	/* tp_weaklistoffset */             0,
+	/* tp_iter */                       PyObject_SelfIter,
+	/* tp_iternext */                   (iternextfunc)stat_pages_next,
+};
+
+/* -----                  module methods                          ----- */
+
+static char stat_meth_stat_doc[] =
+"stat(objtype, conn, id=None, attribs=None, extend=None)\n\
+  where:\n\
+\n\
+   objtype:  \"job\", \"queue\", \"vnode\", \"host\", \"resv\", \"server\",\n\
+             \"sched\" or \"rsc\"\n\
+   conn:     connection handle from pbs_connect()\n\
+   id:       object to status, None for all\n\
+   attribs:  sequence of \"name\" or \"name.resource\" to status, None for all\n\
+   extend:   extend string\n\
+\n\
+  returns:\n\
+         list of (name, [(name, resource, value), ...]); or\n\
+         None on error, see get_errno()\n\
+";
+
+/**
+ * @brief
+ *	Status objects and convert the whole reply in one pass.
+ *
+ * @return	PyObject *
+ * @retval	new reference to the list, or None on an IFL error
+ * @retval	NULL	error, Python exception set
+ */
+static PyObject *
+stat_meth_stat(PyObject *self, PyObject *args, PyObject *kwds)
+{
+	static char *kwlist[] = {"objtype", "conn", "id", "attribs", "extend", NULL};
+	char *objtype = NULL;
+	int conn;
+	char *id = NULL;
+	PyObject *py_attribs = NULL;
+	char *extend = NULL;
+	struct attrl *pal = NULL;
+	struct batch_status *bs_head = NULL;
+	struct batch_status *bs;
+	PyObject *ret;
+	PyObject *item;
+	Py_ssize_t n = 0;
+	Py_ssize_t i = 0;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds,
+		"si|zOz:stat",
+		kwlist,
+		&objtype, &conn, &id, &py_attribs, &extend)) {
+		return NULL;
+	}
+	if (strcmp(objtype, "job") && strcmp(objtype, "queue") &&
+		strcmp(objtype, "vnode") && strcmp(objtype, "host") &&
+		strcmp(objtype, "resv") && strcmp(objtype, "server") &&
+		strcmp(objtype, "sched") && strcmp(objtype, "rsc")) {
+		PyErr_Format(PyExc_ValueError, "bad object type %s", objtype);
+		return NULL;
+	}
+	if (stat_make_attrl(py_attribs, &pal) != 0) {
+		stat_free_attrl(pal);
+		return NULL;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	if (strcmp(objtype, "job") == 0)
+		bs_head = pbs_statjob(conn, id, pal, extend);
+	else if (strcmp(objtype, "queue") == 0)
+		bs_head = pbs_statque(conn, id, pal, extend);
+	else if (strcmp(objtype, "vnode") == 0)
+		bs_head = pbs_statvnode(conn, id, pal, extend);
+	else if (strcmp(objtype, "host") == 0)
+		bs_head = pbs_stathost(conn, id, pal, extend);
+	else if (strcmp(objtype, "resv") == 0)
+		bs_head = pbs_statresv(conn, id, pal, extend);
+	else if (strcmp(objtype, "server") == 0)
+		bs_head = pbs_statserver(conn, pal, extend);
+	else if (strcmp(objtype, "sched") == 0)
+		bs_head = pbs_statsched(conn, pal, extend);
+	else
+		bs_head = pbs_statrsc(conn, id, pal, extend);
+	Py_END_ALLOW_THREADS
+	stat_free_attrl(pal);
+
+	if ((bs_head == NULL) && (pbs_errno != PBSE_NONE))
+		Py_RETURN_NONE;
+
+	for (bs = bs_head; bs != NULL; bs = bs->next)
+		n++;
+	if ((ret = PyList_New(n)) == NULL) {
+		pbs_statfree(bs_head);
+		return NULL;
+	}
+	for (bs = bs_head; bs != NULL; bs = bs->next) {
+		if ((item = stat_entry(bs)) == NULL) {
+			Py_DECREF(ret);
+			pbs_statfree(bs_head);
+			return NULL;
+		}
+		PyList_SET_ITEM(ret, i++, item);
+	}
+	pbs_statfree(bs_head);
+	return ret;
+}
+
+static char stat_meth_statjob_pages_doc[] =
+"statjob_pages(conn, id=None, attribs=None, count=1000, extend=None)\n\
+  where:\n\
+\n\
+   conn:     connection handle from pbs_connect()\n\
+   id:       queue or server, None for all the jobs at the server\n\
+   attribs:  sequence of \"name\" or \"name.resource\" to status, None for all\n\
+   count:    number of jobs per page\n\
+   extend:   extend string\n\
+\n\
+  returns:\n\
+         iterator of (name, [(name, resource, value), ...]), one job at a\n\
+         time; it raises OSError if a page cannot be had\n\
+";
+
+/**
+ * @brief
+ *	Make an iterator over the jobs of pbs_statjob_page().
+ *
+ * @return	PyObject *
+ * @retval	new reference to the iterator
+ * @retval	NULL	error, Python exception set
+ */
+static PyObject *
+stat_meth_statjob_pages(PyObject *self, PyObject *args, PyObject *kwds)
+{
+	static char *kwlist[] = {"conn", "id", "attribs", "count", "extend", NULL};
+	int conn;
+	char *id = NULL;
+	PyObject *py_attribs = NULL;
+	int count = STAT_PAGE_DFLT;
+	char *extend = NULL;
+	StatPages_Object *sp;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds,
+		"i|zOiz:statjob_pages",
+		kwlist,
+		&conn, &id, &py_attribs, &count, &extend)) {
+		return NULL;
+	}
+	if (count <= 0) {
+		PyErr_SetString(PyExc_ValueError, "count must be positive");
+		return NULL;
+	}
+
+	if ((sp = PyObject_New(StatPages_Object, &StatPages_Type)) == NULL)
+		return NULL;
+	sp->sp_conn = conn;
+	sp->sp_count = count;
+	sp->sp_done = 0;
+	sp->sp_cursor[0] = '\0';
+	sp->sp_page = NULL;
+	sp->sp_next = NULL;
+	sp->sp_attrl = NULL;
+	sp->sp_id = id ? strdup(id) : NULL;
+	sp->sp_extend = extend ? strdup(extend) : NULL;
+	if ((id && !sp->sp_id) || (extend && !sp->sp_extend)) {
+		Py_DECREF(sp);
+		return PyErr_NoMemory();
+	}
+	if (stat_make_attrl(py_attribs, &sp->sp_attrl) != 0) {
+		Py_DECREF(sp);
+		return NULL;
+	}
+	return (PyObject *)sp;
+}
+
+static char stat_meth_get_errno_doc[] =
+"get_errno()\n\
+  returns:\n\
+         pbs_errno of the last IFL call of this thread\n\
+";
+
+static PyObject *
+stat_meth_get_errno(PyObject *self, PyObject *args)
+{
+	return PyLong_FromLong(pbs_errno);
+}
+
+static PyMethodDef pbs_ifl_stat_methods[] = {
+	{"stat",
+		(PyCFunction) stat_meth_stat,
+		METH_VARARGS | METH_KEYWORDS, stat_meth_stat_doc},
+	{"statjob_pages",
+		(PyCFunction) stat_meth_statjob_pages,
+		METH_VARARGS | METH_KEYWORDS, stat_meth_statjob_pages_doc},
+	{"get_errno",
+		(PyCFunction) stat_meth_get_errno,
+		METH_NOARGS, stat_meth_get_errno_doc},
+	{NULL, NULL}	/* sentinel */
+};
+
+static char pbs_ifl_stat_module_doc[] =
+    "PBS IFL status calls returning Python objects\n\
+    \t\n\
+    ";
+
+static struct PyModuleDef pbs_ifl_stat_module = {
+	PyModuleDef_HEAD_INIT,
+	"_pbs_ifl_stat",
+	pbs_ifl_stat_module_doc,
+	-1,
+	pbs_ifl_stat_methods
+};
+
+/**
+ * @brief
+ *	Initialize the _pbs_ifl_stat module, for the interpreter's inittab.
+ *
+ * @return	PyObject *
+ * @retval	the module	success
+ * @retval	NULL		error
+ */
+PyObject *
+PyInit__pbs_ifl_stat(void)
+{
+	if (PyType_Ready(&StatPages_Type) < 0)
+		return NULL;
+	return PyModule_Create(&pbs_ifl_stat_module);
+}
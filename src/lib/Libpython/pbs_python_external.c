@@ -55,22 +55,31 @@
 #include <pbs_python_private.h> /* private python file  */
 #include <eval.h>               /* For PyEval_EvalCode  */
 #include <pythonrun.h>          /* For Py_SetPythonHome */
+#include <marshal.h>            /* For the hook bytecode cache */
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <wchar.h>
+#include "hook.h"
 
 extern PyObject* PyInit__pbs_ifl(void);
+extern PyObject* PyInit__pbs_ifl_stat(void);	/* pbs_ifl_stat.c */
 
 static struct _inittab pbs_python_inittab_modules[] = {
 	{PBS_PYTHON_V1_MODULE_EXTENSION_NAME, pbs_v1_module_inittab},
 	{"_pbs_ifl", PyInit__pbs_ifl},
+	{"_pbs_ifl_stat", PyInit__pbs_ifl_stat},
 	{NULL, NULL}                    /* sentinel */
 };
 
 static PyObject *
 _pbs_python_compile_file(const char *file_name,
 	const char *compiled_code_file_name);
+static PyObject *
+_pbs_python_compile_script(const char *file_name,
+	const char *compiled_code_file_name);
 extern int pbs_python_setup_namespace_dict(PyObject *globals);
 
 #endif      /* PYTHON */
@@ -299,6 +308,7 @@ pbs_python_ext_shutdown_interpreter(struct python_interpreter_data *interp_data)
 			/* before finalize clear global python objects */
 			pbs_python_event_unset();  /* clear Python event object */
 			pbs_python_unload_python_types(interp_data);
+			pbs_v1_module_clear();
 			Py_Finalize();
 		}
 		interp_data->destroy_interpreter_data(interp_data);
@@ -430,6 +440,7 @@ pbs_python_ext_quick_shutdown_interpreter(void)
 		PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER,
 		LOG_INFO, "pbs_python_ext_quick_shutdown_interpreter",
 		"--> Stopping Python interpreter <--");
+	pbs_v1_module_clear();
 	Py_Finalize();
 #endif /* PYTHON */
 
@@ -530,6 +541,7 @@ pbs_python_ext_namespace_init(
 #ifdef PYTHON                        /* --- BEGIN PYTHON BLOCK --- */
 
 	PyObject *namespace_dict = NULL;
+	PyObject *ext_module = NULL; /* borrowed */
 
 	namespace_dict = PyDict_New(); /* New Refrence MUST Decref */
 	if (!namespace_dict) {
@@ -550,9 +562,9 @@ pbs_python_ext_namespace_init(
 	/*
 	 * Now, add our extension object/module to the namespace.
 	 */
-	if ((PyDict_SetItemString(namespace_dict,
-		PBS_PYTHON_V1_MODULE_EXTENSION_NAME,
-		pbs_v1_module_init()) == -1)
+	if (((ext_module = pbs_v1_module_namespace()) == NULL) ||
+		(PyDict_SetItemString(namespace_dict,
+		PBS_PYTHON_V1_MODULE_EXTENSION_NAME, ext_module) == -1)
 		) {
 		snprintf(log_buffer, LOG_BUF_SIZE-1, "%s|adding extension object",
 			__func__);
@@ -613,7 +625,7 @@ pbs_python_check_and_compile_script(struct python_interpreter_data *interp_data,
 			break;
 		(void) memcpy(&obuf, &(py_script->cur_sbuf), sizeof(obuf));
 		if (py_script->check_for_recompile) {
-			if ((stat(py_script->path, &nbuf) != 1) &&
+			if ((stat(py_script->path, &nbuf) != -1) &&
 				(nbuf.st_ino   == obuf.st_ino) &&
 				(nbuf.st_size  == obuf.st_size) &&
 				(nbuf.st_mtime == obuf.st_mtime)) {
@@ -640,7 +652,7 @@ pbs_python_check_and_compile_script(struct python_interpreter_data *interp_data,
 				LOG_INFO, interp_data->daemon_name, log_buffer);
 
 		if (!(py_script->py_code_obj =
-			_pbs_python_compile_file(py_script->path,
+			_pbs_python_compile_script(py_script->path,
 			"<embedded code object>"))) {
 			pbs_python_write_error_to_log("Failed to compile script");
 			return -2;
@@ -733,7 +745,7 @@ pbs_python_run_code_in_namespace(struct python_interpreter_data *interp_data,
 				LOG_INFO, interp_data->daemon_name, log_buffer);
 
 		if (!(py_script->py_code_obj =
-			_pbs_python_compile_file(py_script->path,
+			_pbs_python_compile_script(py_script->path,
 			"<embedded code object>"))) {
 			pbs_python_write_error_to_log("Failed to compile script");
 			return -2;
@@ -914,6 +926,150 @@ ERROR_EXIT:
 	return rv;
 }
 
+/*
+ * The pbs_python command runs a MoM hook in a new process for every event,
+ * so it keeps the code object of a hook script in a file next to it,
+ * <hook>HOOK_BYTECODE_SUFFIX, tagged with the interpreter's magic number
+ * and the script's inode, size and mtime.
+ */
+struct hook_bytecode_hdr {
+	long	hb_magic;
+	int64_t	hb_ino;
+	int64_t	hb_size;
+	int64_t	hb_mtime;
+};
+
+/**
+ * @brief
+ *	Return the code object kept in the bytecode file of a hook script,
+ *	if it matches the script.
+ *
+ * @param[in]	bc_name - bytecode file
+ * @param[in]	hdr - header expected for the script as it is now
+ *
+ * @return	PyObject *
+ * @retval	code object, new reference
+ * @retval	NULL	no usable bytecode file
+ */
+static PyObject *
+_pbs_python_read_bytecode(const char *bc_name, struct hook_bytecode_hdr *hdr)
+{
+	struct hook_bytecode_hdr fhdr;
+	struct stat sbuf;
+	char *buf = NULL;
+	PyObject *rv = NULL;
+	ssize_t len;
+	int fd;
+
+	if ((fd = open(bc_name, O_RDONLY | O_NOFOLLOW)) == -1)
+		return NULL;
+	/* only trust a file no one but root could have written */
+	if ((fstat(fd, &sbuf) == -1) || !S_ISREG(sbuf.st_mode) ||
+		(sbuf.st_uid != 0) || (sbuf.st_mode & (S_IWGRP | S_IWOTH)) ||
+		(sbuf.st_size <= sizeof(fhdr)))
+		goto done;
+	if ((read(fd, &fhdr, sizeof(fhdr)) != sizeof(fhdr)) ||
+		(memcmp(&fhdr, hdr, sizeof(fhdr)) != 0))
+		goto done;
+	len = sbuf.st_size - sizeof(fhdr);
+	if ((buf = malloc(len)) == NULL)
+		goto done;
+	if (read(fd, buf, len) != len)
+		goto done;
+	rv = PyMarshal_ReadObjectFromString(buf, len);
+	if ((rv != NULL) && !PyCode_Check(rv))
+		Py_CLEAR(rv);
+	PyErr_Clear();
+done:
+	free(buf);
+	close(fd);
+	return rv;
+}
+
+/**
+ * @brief
+ *	Write the code object of a hook script to its bytecode file.
+ *	Failures are not errors, the script is just compiled again next time.
+ *
+ * @param[in]	bc_name - bytecode file
+ * @param[in]	hdr - header for the script as it is now
+ * @param[in]	code - the code object
+ */
+static void
+_pbs_python_write_bytecode(const char *bc_name, struct hook_bytecode_hdr *hdr,
+	PyObject *code)
+{
+	char tmp_name[MAXPATHLEN + 16];
+	PyObject *data;
+	char *buf;
+	Py_ssize_t len;
+	int fd;
+	int ok;
+
+	if ((data = PyMarshal_WriteObjectToString(code, Py_MARSHAL_VERSION)) == NULL) {
+		PyErr_Clear();
+		return;
+	}
+	if (PyBytes_AsStringAndSize(data, &buf, &len) == -1) {
+		PyErr_Clear();
+		Py_DECREF(data);
+		return;
+	}
+	snprintf(tmp_name, sizeof(tmp_name), "%s.%d", bc_name, (int)getpid());
+	if ((fd = open(tmp_name, O_WRONLY | O_CREAT | O_EXCL, 0600)) == -1) {
+		Py_DECREF(data);
+		return;
+	}
+	ok = (write(fd, hdr, sizeof(*hdr)) == sizeof(*hdr)) &&
+		(write(fd, buf, len) == len);
+	if ((close(fd) != 0) || !ok || (rename(tmp_name, bc_name) == -1))
+		(void)unlink(tmp_name);
+	Py_DECREF(data);
+}
+
+/**
+ * @brief
+ *	Compile a python script, using the bytecode file of a hook script
+ *	when run by the pbs_python command as root.
+ *
+ * @param[in]	file_name - abs file name
+ * @param[in]	compiled_code_file_name - name given to the code object
+ *
+ * @return	PyObject *
+ * @retval	code object, new reference
+ * @retval	NULL	compilation failed
+ */
+static PyObject *
+_pbs_python_compile_script(const char *file_name,
+	const char *compiled_code_file_name)
+{
+	char bc_name[MAXPATHLEN + 1];
+	struct hook_bytecode_hdr hdr;
+	struct stat sbuf;
+	size_t len = strlen(file_name);
+	size_t slen = strlen(HOOK_SCRIPT_SUFFIX);
+	PyObject *rv;
+
+	if (!IS_PBS_PYTHON_CMD(pbs_python_daemon_name) || (geteuid() != 0) ||
+		(len <= slen) || (strcmp(file_name + len - slen, HOOK_SCRIPT_SUFFIX) != 0) ||
+		(stat(file_name, &sbuf) == -1) ||
+		(snprintf(bc_name, sizeof(bc_name), "%.*s%s", (int)(len - slen),
+		file_name, HOOK_BYTECODE_SUFFIX) >= sizeof(bc_name)))
+		return (_pbs_python_compile_file(file_name, compiled_code_file_name));
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.hb_magic = PyImport_GetMagicNumber();
+	hdr.hb_ino = (int64_t)sbuf.st_ino;
+	hdr.hb_size = (int64_t)sbuf.st_size;
+	hdr.hb_mtime = (int64_t)sbuf.st_mtime;
+
+	if ((rv = _pbs_python_read_bytecode(bc_name, &hdr)) != NULL)
+		return rv;
+	if ((rv = _pbs_python_compile_file(file_name, compiled_code_file_name)) != NULL)
+		_pbs_python_write_bytecode(bc_name, &hdr, rv);
+	return rv;
+}
+
 
 #endif /* PYTHON */
 
@@ -76,6 +76,7 @@
 #include "svrfunc.h"
 #include "pbs_ecl.h"
 #include "placementsets.h"
+#include "avltree.h"
 #include "pbs_reliable.h"
 
 
@@ -230,6 +231,8 @@ typedef struct _pbs_resource_value {
 
 static pbs_list_head pbs_resource_value_list;  	/* list of resource */
 						/* values to instantiate */
+static AVL_IX_DESC *pbs_resource_value_idx = NULL; /* the list by */
+						/* py_resource */
 
 static PyObject  *PyPbsV1Module_Obj = NULL; /* pbs.v1 module object */
 
@@ -255,6 +258,8 @@ static PyObject  *py_hook_pbsevent = NULL;
 static PyObject  *py_hook_pbsserver = NULL;
 /* An array of cached Python queue objects managed by the current server */
 static PyObject  **py_hook_pbsque  = NULL;
+/* The pbs_queue each entry of py_hook_pbsque was populated from */
+static pbs_queue **py_hook_pbsque_ptr = NULL;
 static int	py_hook_pbsque_max = 0; /* Max # of entries in py_hook_pbsque */
 static int      hook_pbsevent_accept = TRUE; /* flag to accept/reject event */
 static int      hook_pbsevent_stop_processing = FALSE; /* flag to stop */
@@ -1960,6 +1965,148 @@ py_resource_string_value(pbs_resource_value *resc_val)
 	return PyUnicode_FromString(ret_string);
 }
 
+/**
+ * @brief
+ *	Return the entry of pbs_resource_value_list caching the values of the
+ *	Python resource list object 'py_resource'.
+ *
+ * @param[in]	py_resource - the Python pbs_resource object
+ *
+ * @return	pbs_resource_value *
+ * @retval	NULL	- no values are cached for 'py_resource'
+ */
+static pbs_resource_value *
+find_resource_value(PyObject *py_resource)
+{
+	if (pbs_resource_value_idx == NULL)
+		return NULL;
+	return ((pbs_resource_value *)find_tree(pbs_resource_value_idx,
+		&py_resource));
+}
+
+/**
+ * @brief
+ *	Add 'resc_val' to pbs_resource_value_list and its index.
+ *
+ * @param[in]	resc_val - entry with its py_resource set
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- failure
+ */
+static int
+add_resource_value(pbs_resource_value *resc_val)
+{
+	if (pbs_resource_value_idx == NULL) {
+		pbs_resource_value_idx = create_tree(AVL_NO_DUP_KEYS,
+			sizeof(PyObject *));
+		if (pbs_resource_value_idx == NULL)
+			return -1;
+	}
+	if (tree_add_del(pbs_resource_value_idx, &resc_val->py_resource,
+		resc_val, TREE_OP_ADD) != 0)
+		return -1;
+	if (pbs_resource_value_list.ll_next == NULL)
+		CLEAR_HEAD(pbs_resource_value_list);
+	append_link(&pbs_resource_value_list, &resc_val->all_rescs, resc_val);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Remove 'resc_val' from pbs_resource_value_list and free it.
+ *
+ * @param[in]	resc_val - entry to free
+ */
+static void
+free_resource_value(pbs_resource_value *resc_val)
+{
+	if (pbs_resource_value_idx != NULL)
+		(void)tree_add_del(pbs_resource_value_idx,
+			&resc_val->py_resource, NULL, TREE_OP_DEL);
+	Py_CLEAR(resc_val->py_resource);
+	Py_CLEAR(resc_val->py_resource_str_value);
+	free_attrlist(&resc_val->value_list);
+	delete_link(&resc_val->all_rescs);
+	free(resc_val);
+}
+
+/**
+ * @brief
+ *	Cache the resource value in 'plist' for the resource list object
+ *	'py_resource' of 'py_instance', instead of setting it, so that
+ *	only the resource lists a hook looks at are converted to Python.
+ *	See load_cached_resource_value().
+ *
+ * @param[in]	py_instance - the job, vnode or reservation object
+ * @param[in]	py_resource - its resource list named plist->al_name
+ * @param[in]	plist - <list>, <resource>, <value>
+ *
+ * @return	int
+ * @retval	0	- value cached
+ * @retval	1	- resource list can't be cached, set the value now
+ * @retval	-1	- failure
+ */
+static int
+cache_resource_value(PyObject *py_instance, PyObject *py_resource,
+	svrattrl *plist)
+{
+	pbs_resource_value *resc_val;
+	attribute_def *attr_def_p = NULL;
+	int idx = -1;
+
+	resc_val = find_resource_value(py_resource);
+	if (resc_val == NULL) {
+		if (PyObject_IsInstance(py_instance,
+			pbs_python_types_table[PP_JOB_IDX].t_class)) {
+			idx = find_attr(job_attr_def, plist->al_name, JOB_ATR_LAST);
+			if (idx >= 0)
+				attr_def_p = &job_attr_def[idx];
+		} else if (PyObject_IsInstance(py_instance,
+			pbs_python_types_table[PP_VNODE_IDX].t_class)) {
+			idx = find_attr(node_attr_def, plist->al_name, ND_ATR_LAST);
+			if (idx >= 0)
+				attr_def_p = &node_attr_def[idx];
+		} else if (PyObject_IsInstance(py_instance,
+			pbs_python_types_table[PP_RESV_IDX].t_class)) {
+			idx = find_attr(resv_attr_def, plist->al_name, RESV_ATR_LAST);
+			if (idx >= 0)
+				attr_def_p = &resv_attr_def[idx];
+		}
+		if ((attr_def_p == NULL) || !ATTR_IS_RESC(attr_def_p) ||
+			TYPE_ENTITY(attr_def_p->at_type))
+			return 1;
+
+		resc_val = (pbs_resource_value *)calloc(1,
+			sizeof(pbs_resource_value));
+		if (resc_val == NULL) {
+			log_err(errno, __func__, "calloc failed");
+			return -1;
+		}
+		CLEAR_LINK(resc_val->all_rescs);
+		CLEAR_HEAD(resc_val->value_list);
+		Py_INCREF(py_resource);
+		resc_val->py_resource = py_resource;
+		resc_val->attr_def_p = attr_def_p;
+		if (add_resource_value(resc_val) != 0) {
+			Py_DECREF(py_resource);
+			free(resc_val);
+			return -1;
+		}
+		if (pbs_python_object_set_attr_integral_value(py_resource,
+			PY_RESOURCE_HAS_VALUE, FALSE) == -1) {
+			free_resource_value(resc_val);
+			return -1;
+		}
+	}
+
+	if (add_to_svrattrl_list(&resc_val->value_list, plist->al_name,
+		plist->al_resc, plist->al_value, 0, NULL) != 0)
+		return -1;
+	Py_CLEAR(resc_val->py_resource_str_value);
+	return 0;
+}
+
 /*
  * ---------- ATTRIBUTE CONVERSION HELPER METHODS ------------
  */
@@ -2093,9 +2240,13 @@ pbs_python_populate_attributes_to_python_class(PyObject *py_instance,
 					list_move(&pheadp,
 						&resc_val->value_list);
 
-					append_link(&pbs_resource_value_list,
-						&resc_val->all_rescs,
-						(pbs_resource_value *)resc_val);
+					if (add_resource_value(resc_val) != 0) {
+						LOG_ERROR_ARG2("%s:failed to cache resource <%s>",
+							attr_def_p->at_name, "");
+						free_resource_value(resc_val);
+						ret_rc = -1;
+						continue;
+					}
 					resc_val->py_resource_str_value =
 						py_resource_string_value(resc_val);
 				}
@@ -2299,8 +2450,12 @@ pbs_python_populate_python_class_from_svrattrl(PyObject *py_instance, pbs_list_h
 				pbs_python_write_error_to_log(log_buffer);
 				ret_rc = -1;
 			} else {
-				rc = pbs_python_object_set_attr_string_value(py_attr_resc,
-					plist->al_resc, plist->al_value);
+				/* only set the resource when the hook looks at it */
+				rc = cache_resource_value(py_instance, py_attr_resc,
+					plist);
+				if (rc == 1)
+					rc = pbs_python_object_set_attr_string_value(py_attr_resc,
+						plist->al_resc, plist->al_value);
 				Py_DECREF(py_attr_resc);
 				if (rc == -1) {
 					LOG_ERROR_ARG2("%s:failed to set resource <%s>",
@@ -2510,18 +2665,9 @@ load_cached_resource_value(PyObject *py_resource_match)
 {
 	pbs_resource_value *resc_val = NULL;
 	int rc;
+	int hook_set_mode_orig;
 
-	resc_val = (pbs_resource_value *)GET_NEXT(pbs_resource_value_list);
-	while (resc_val != NULL) {
-
-		if ( (resc_val->py_resource != NULL) &&
-				(py_resource_match == resc_val->py_resource) ) {
-			break;
-		}
-
-		resc_val = (pbs_resource_value *) GET_NEXT(resc_val->all_rescs);
-	}
-
+	resc_val = find_resource_value(py_resource_match);
 	if (resc_val == NULL) {
 		/* no match */
 		return (0);  /* no cached value found */
@@ -2540,20 +2686,18 @@ load_cached_resource_value(PyObject *py_resource_match)
 
 	if (rc == 0) {
 
+		hook_set_mode_orig = hook_set_mode;
 		hook_set_mode = C_MODE;
 		rc = pbs_python_object_set_attr_integral_value(
 			resc_val->py_resource, PY_RESOURCE_HAS_VALUE, TRUE);
-		hook_set_mode = PY_MODE;
+		hook_set_mode = hook_set_mode_orig;
 
 		if (rc == -1) {
 			LOG_ERROR_ARG2("%s:failed to set resource <%s>",
 				resc_val->attr_def_p->at_name,
 				PY_RESOURCE_HAS_VALUE);
 		}
-		Py_DECREF(resc_val->py_resource);
-		free_attrlist(&resc_val->value_list);
-		delete_link(&resc_val->all_rescs);
-		free(resc_val);
+		free_resource_value(resc_val);
 
 	}
 
@@ -3261,6 +3405,10 @@ mark_readonly_exit:
  *	'py_hook_pbsque[]' matching 'que_name' or pque's que_name.
  *	Otherwise, the Python queue object returned is cached in
  *	'py_hook_pbsque[]' array.
+ *	Cached entries are matched by the pbs_queue pointer recorded in
+ *	'py_hook_pbsque_ptr[]' so a lookup does not have to fetch and
+ *	compare the name attribute of each cached Python object. The cache
+ *	only lives for one event, during which queues cannot be deleted.
  *
  * @return	PyObject *	pointer to a Python queue object to map the
  *				queue.
@@ -3300,12 +3448,7 @@ _pps_helper_get_queue(pbs_queue *pque, const char *que_name, char *perf_label)
 
 		for (i=0; (i < py_hook_pbsque_max) && (py_hook_pbsque[i] != NULL);
 			i++) {
-			char *qn;
-
-			qn = pbs_python_object_get_attr_string_value(py_hook_pbsque[i],
-				"name");
-			if( (qn != NULL) && (qn[0] != '\0') && \
-			(strcmp(qn, que->qu_qs.qu_name) == 0) ) {
+			if (py_hook_pbsque_ptr[i] == que) {
 				Py_INCREF(py_hook_pbsque[i]);
 				return py_hook_pbsque[i];
 			}
@@ -3378,12 +3521,28 @@ _pps_helper_get_queue(pbs_queue *pque, const char *que_name, char *perf_label)
 					"Failed to calloc array of cached pbs queue objects");
 				goto ERROR_EXIT;
 			}
+			py_hook_pbsque_ptr = (pbs_queue **)calloc(server.sv_qs.sv_numque,
+				sizeof(pbs_queue *));
+			if (py_hook_pbsque_ptr == NULL) {
+				log_err(errno, __func__,
+					"Failed to calloc array of cached pbs queue objects");
+				free(py_hook_pbsque);
+				py_hook_pbsque = NULL;
+				goto ERROR_EXIT;
+			}
 			py_hook_pbsque_max = server.sv_qs.sv_numque;
 		} else if (server.sv_qs.sv_numque > py_hook_pbsque_max) {
 			PyObject **py_hook_pbsque_tmp;
+			pbs_queue **py_hook_pbsque_ptr_tmp;
+			py_hook_pbsque_ptr_tmp = (pbs_queue **)realloc(py_hook_pbsque_ptr,
+				server.sv_qs.sv_numque*sizeof(pbs_queue *));
+			if (py_hook_pbsque_ptr_tmp != NULL)
+				py_hook_pbsque_ptr = py_hook_pbsque_ptr_tmp;
 			py_hook_pbsque_tmp =  (PyObject **)realloc(py_hook_pbsque,
 				server.sv_qs.sv_numque*sizeof(PyObject *));
-			if (py_hook_pbsque_tmp == NULL) {
+			if ((py_hook_pbsque_tmp == NULL) || (py_hook_pbsque_ptr_tmp == NULL)) {
+				if (py_hook_pbsque_tmp != NULL)
+					py_hook_pbsque = py_hook_pbsque_tmp;
 				log_err(errno, __func__,
 					"Failed to realloc array of cached pbs queue objects");
 				for(i=0; (i < py_hook_pbsque_max) && \
@@ -3392,11 +3551,15 @@ _pps_helper_get_queue(pbs_queue *pque, const char *que_name, char *perf_label)
 				}
 				free(py_hook_pbsque);
 				py_hook_pbsque = NULL;
+				free(py_hook_pbsque_ptr);
+				py_hook_pbsque_ptr = NULL;
+				py_hook_pbsque_max = 0;
 				goto ERROR_EXIT;
 			}
 			py_hook_pbsque = py_hook_pbsque_tmp;
 			for (i=py_hook_pbsque_max; i < server.sv_qs.sv_numque; i++) {
 				py_hook_pbsque[i] = NULL;
+				py_hook_pbsque_ptr[i] = NULL;
 			}
 
 			py_hook_pbsque_max = server.sv_qs.sv_numque;
@@ -3408,6 +3571,7 @@ _pps_helper_get_queue(pbs_queue *pque, const char *que_name, char *perf_label)
 			if (py_hook_pbsque[i] == NULL) {
 				Py_INCREF(py_que);
 				py_hook_pbsque[i] = py_que;
+				py_hook_pbsque_ptr[i] = que;
 				break;
 			}
 		}
@@ -3496,6 +3660,9 @@ _pps_helper_get_server(char *perf_label)
 	update_license_ct(&server.sv_attr[(int)SRV_ATR_license_count],
 		server.sv_license_ct_buf);
 
+	update_node_state_ct(&server.sv_attr[(int)SRV_ATR_NodesByState],
+		server.sv_nodestbuf);
+
 	/* stuff all the attributes */
 	strncpy((char *)hook_debug.objname, SERVER_OBJECT, HOOK_BUF_SIZE-1);
 	snprintf(perf_action, sizeof(perf_action), "%s:%s", HOOK_PERF_POPULATE, hook_debug.objname);
@@ -5184,6 +5351,8 @@ _pbs_python_event_set(unsigned int hook_event, char *req_user, char *req_host,
 		free(resc_val);
 		resc_val = nxp_resc_val;
 	}
+	if (pbs_resource_value_idx != NULL)
+		avl_destroy_index(pbs_resource_value_idx);
 
 	/* py_hook_pbsevent is instantiated in C_MODE so I own it */
 	Py_CLEAR(py_hook_pbsevent);
@@ -5194,6 +5363,7 @@ _pbs_python_event_set(unsigned int hook_event, char *req_user, char *req_host,
 	if (py_hook_pbsque != NULL) {
 		for (i=0; (i < py_hook_pbsque_max) && (py_hook_pbsque[i] != NULL); i++) {
 			Py_CLEAR(py_hook_pbsque[i]);
+			py_hook_pbsque_ptr[i] = NULL;
 		}
 	}
 
@@ -12033,21 +12203,15 @@ pbsv1mod_meth_resource_str_value(PyObject *self, PyObject *args, PyObject *kwds)
 		return NULL;
 	}
 
-	resc_val = (pbs_resource_value *)GET_NEXT(pbs_resource_value_list);
-	while (resc_val != NULL) {
-
-		if ( (resc_val->py_resource != NULL) && \
-				(py_resource_match == resc_val->py_resource) )
-			break;
-
-		resc_val = (pbs_resource_value *) GET_NEXT(resc_val->all_rescs);
-	}
-
+	resc_val = find_resource_value(py_resource_match);
 	if (resc_val == NULL) {
 		/* no match */
 		Py_RETURN_NONE;
 	}
 
+	/* values cached by cache_resource_value() get their string on demand */
+	if (resc_val->py_resource_str_value == NULL)
+		resc_val->py_resource_str_value = py_resource_string_value(resc_val);
 	if (resc_val->py_resource_str_value == NULL) {
 		Py_RETURN_NONE;
 	}
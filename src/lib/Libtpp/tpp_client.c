@@ -151,7 +151,8 @@ static int leaf_addr_count = 0;
  */
 typedef struct {
 	unsigned int sd;     /* the stream to which it belongs */
-	unsigned int seq_no; /* the sequence number being acknowledged */
+	unsigned int seq_first; /* first sequence number of the acked range */
+	unsigned int seq_no; /* the (last) sequence number being acknowledged */
 	time_t ack_time;     /* the latest time at which the ack must be sent out */
 	tpp_que_elem_t *global_ack_node; /*
 					       * pointer to location in a global
@@ -187,10 +188,26 @@ typedef struct {
 				  */
 	tpp_packet_t *data_pkt; /* separate data (from hdr) pkt, mcast case */
 	short retry_count;           /* number of times this data packet was re-sent */
+	long long sent_ms;           /* time of the first send, for the ack latency stats */
+	int retry_slot;              /* slot of the retry wheel holding global_retry_node */
 	tpp_que_elem_t *global_retry_node;
 	tpp_que_elem_t *strm_retry_node;
 } retry_info_t;
-tpp_que_t global_retry_queue; /* global retry queue for all streams */
+
+/*
+ * The global retry list of all streams is indexed by deadline: a wheel of
+ * one second slots, slot (retry_time % TPP_RETRY_WHEEL_SZ) holding the
+ * packets due at that time. Shelving a packet, or moving its deadline, is
+ * then O(1) instead of a walk of a time sorted list. The wheel must be
+ * larger than the longest retry delay used.
+ */
+#define TPP_RETRY_WHEEL_SZ	64
+static tpp_que_t retry_wheel[TPP_RETRY_WHEEL_SZ];
+static time_t retry_wheel_time = 0; /* earliest slot that could hold due packets */
+static int retry_wheel_count = 0;   /* number of packets in the wheel */
+
+/* per leaf seed for the jitter added to router reconnect delays */
+static unsigned int connect_seed = 0;
 
 /*
  * The structure to hold information about the multicast channel
@@ -210,7 +227,7 @@ typedef struct {
  * IO and APP. Some of the fields are set by the APP thread first time and then
  * on accessed/updated by the IO thread.
  */
-typedef struct {
+typedef struct tpp_stream {
 	unsigned char strm_type; /* normal stream or multicast stream */
 
 	unsigned int sd;         /* source stream descriptor, APP thread assigns, IO thread uses */
@@ -228,6 +245,7 @@ typedef struct {
 	short lasterr;            /* updated by IO thread only, for future use */
 
 	short num_unacked_pkts;   /* IO thread - number of unacked packets on wire */
+	short ack_ranges;         /* IO thread - peer accepts ranges of seq numbers in acks */
 
 	tpp_addr_t src_addr;  /* address of the source host */
 	tpp_addr_t dest_addr; /* address of destination host - set by APP thread, read-only by IO thread */
@@ -246,6 +264,8 @@ typedef struct {
 	void (*close_func)(int); /* close function to be called when this stream is closed */
 
 	tpp_que_elem_t *timeout_node; /* pointer to myself in the timeout streams queue */
+
+	struct tpp_stream *dest_hnext; /* next stream in the same destination hash bucket */
 } stream_t;
 
 /* function to delete the user data, registered by dis layer */
@@ -255,22 +275,39 @@ void (*tpp_user_data_del_fnc)(int);
  * Slot structure - Streams are part of an array of slots
  * Using the stream sd, its easy to index into this slotarray to find the
  * stream structure
+ *
+ * The slots are allocated in chunks of TPP_STRM_CHUNK that are never moved
+ * or freed while the library is up, so get_strm_atomic() can index a slot
+ * without taking strmarray_lock. Chunks are only added under the lock, and
+ * a slot's strm is always set before its state is published as busy.
  */
 typedef struct {
 	int slot_state;      /* state of the slot - used, free */
 	stream_t *strm; /* pointer to the stream structure at this slot */
 } stream_slot_t;
-stream_slot_t *strmarray = NULL; /* array of streams */
+#define TPP_STRM_CHUNK		1024
+#define TPP_STRM_MAX_CHUNKS	4096
+#define STRM_SLOT(sd)		(strm_chunks[(sd) / TPP_STRM_CHUNK][(sd) % TPP_STRM_CHUNK])
+static stream_slot_t *strm_chunks[TPP_STRM_MAX_CHUNKS]; /* chunks of stream slots */
 pthread_mutex_t strmarray_lock;       /* global lock for the streams array */
-unsigned int max_strms = 0;           /* total number of streams allocated */
+static pthread_mutex_t mcast_group_lock; /* serializes use of the routers' mcast group slots */
+unsigned int max_strms = 0;           /* total number of stream slots allocated */
 
 /* the following two variables are used to quickly find out a unused slot */
 unsigned int high_sd = UNINITIALIZED_INT; /* the highest stream sd used */
 tpp_que_t freed_sd_queue;            /* last freed stream sd */
 int freed_queue_count = 0;
 
-/* AVL tree of streams - so that we can search faster inside it */
-AVL_IX_DESC *AVL_streams = NULL;
+/*
+ * Hash of the normal streams keyed by destination address, chained through
+ * dest_hnext, so that the streams to a host are found without allocating
+ * a search key. The buckets double when the streams outnumber them twice.
+ * Accessed under strmarray_lock.
+ */
+#define TPP_STRM_HASH_INIT	1024
+static stream_t **strm_dest_hash = NULL;
+static unsigned int strm_dest_hash_sz = 0;	/* number of buckets, a power of 2 */
+static unsigned int strm_dest_count = 0;	/* number of streams in the hash */
 
 /* following common structure is used to do a timed action on a stream */
 typedef struct {
@@ -314,6 +351,9 @@ static int connect_router(tpp_router_t *r);
 static int get_active_router(int index);
 static stream_t *get_strm_atomic(unsigned int sd);
 static stream_t *get_strm(unsigned int sd);
+static unsigned int strm_dest_bucket(tpp_addr_t *addr);
+static int strm_dest_hash_add(stream_t *strm);
+static int strm_dest_hash_del(stream_t *strm);
 static stream_t *alloc_stream(tpp_addr_t *src_addr, tpp_addr_t *dest_addr);
 static void free_stream(unsigned int sd);
 static void free_stream_resources(stream_t *strm);
@@ -324,7 +364,8 @@ static void check_retries(time_t now);
 static void queue_strm_close(stream_t *);
 static void strm_timeout_action(unsigned int sd);
 static void enque_timeout_strm(stream_t *strm);
-static tpp_que_elem_t *enque_retry_sorted(tpp_que_t *q, tpp_packet_t *pkt);
+static int enque_retry(tpp_packet_t *pkt, time_t retry_time);
+static void deque_retry(retry_info_t *rt);
 static void queue_strm_free(unsigned int sd);
 static void act_strm(time_t now, int force);
 static int send_app_strm_close(stream_t *strm, int cmd, int error);
@@ -333,11 +374,13 @@ static int shelve_mcast_pkt(tpp_mcast_pkt_hdr_t *mcast_hdr, int tfd, int seq, tp
 static int queue_ack(stream_t *strm, unsigned char type, unsigned int seq_no_recvd);
 static int send_ack_packet(ack_info_t *ack);
 static int send_retry_packet(tpp_packet_t *pkt);
-static int unshelve_pkt(stream_t *strm, int seq_no_acked);
+static int unshelve_pkt(stream_t *strm, unsigned int seq_first, unsigned int seq_last);
+static long long tpp_time_ms(void);
 static void *add_part_packet(stream_t *strm, void *data, int sz);
 static int send_pkt_to_app(stream_t *strm, unsigned char type, void *data, int sz);
 static stream_t *find_stream_with_dest(tpp_addr_t *dest_addr, unsigned int dest_sd, unsigned int dest_magic);
 static int tpp_send_inner(int sd, void *data, int len, int full_len, int cmprsd_len);
+static int tpp_mcast_send_group(stream_t *mstrm, mcast_data_t *d, tpp_router_t *r, void *data, unsigned int len, unsigned int full_len, unsigned int cmprsd_len);
 static int send_spl_packet(stream_t *strm, int type);
 static void flush_acks(stream_t *strm);
 static void tpp_clr_retry(tpp_packet_t *pkt, stream_t *strm);
@@ -364,7 +407,8 @@ static int tpp_fault_tolerant_mode = 1;
  *	Helper function to get a stream pointer and slot state in an atomic fashion
  *
  * @par Functionality:
- *	Acquire a lock on the strmarray lock and return the stream pointer
+ *	Index into the chunked slot table without taking strmarray_lock and
+ *	return the stream pointer if the slot is busy
  *
  * @param[in] sd - The stream descriptor
  *
@@ -382,13 +426,13 @@ static stream_t *
 get_strm_atomic(unsigned int sd)
 {
 	stream_t *strm = NULL;
+	stream_slot_t *slot;
 
-	tpp_lock(&strmarray_lock);
-	if (sd < max_strms) {
-		if (strmarray[sd].slot_state == TPP_SLOT_BUSY)
-			strm = strmarray[sd].strm;
+	if (sd < __atomic_load_n(&max_strms, __ATOMIC_ACQUIRE)) {
+		slot = &STRM_SLOT(sd);
+		if (__atomic_load_n(&slot->slot_state, __ATOMIC_ACQUIRE) == TPP_SLOT_BUSY)
+			strm = __atomic_load_n(&slot->strm, __ATOMIC_ACQUIRE);
 	}
-	tpp_unlock(&strmarray_lock);
 
 	return strm;
 }
@@ -432,6 +476,126 @@ get_strm(unsigned int sd)
 	return strm;
 }
 
+/**
+ * @brief
+ *	Find the destination hash bucket of an address
+ *
+ * @par Functionality:
+ *	FNV-1a over the ip, port and family fields of the address, masked to
+ *	the current number of buckets.
+ *
+ * @param[in] addr - The destination address
+ *
+ * @return - bucket index into strm_dest_hash
+ *
+ * @par MT-safe: No, call under strmarray_lock
+ *
+ */
+static unsigned int
+strm_dest_bucket(tpp_addr_t *addr)
+{
+	unsigned int hash = 2166136261U;
+	unsigned char *p = (unsigned char *) addr->ip;
+	size_t i;
+
+	for (i = 0; i < sizeof(addr->ip); i++)
+		hash = (hash ^ p[i]) * 16777619U;
+	hash = (hash ^ (unsigned char) (addr->port & 0xff)) * 16777619U;
+	hash = (hash ^ (unsigned char) ((addr->port >> 8) & 0xff)) * 16777619U;
+	hash = (hash ^ (unsigned char) addr->family) * 16777619U;
+
+	return (hash & (strm_dest_hash_sz - 1));
+}
+
+/**
+ * @brief
+ *	Add a stream to the destination hash
+ *
+ * @par Functionality:
+ *	Doubles the number of buckets first if the streams outnumber them
+ *	twice, rehashing the existing chains.
+ *
+ * @param[in] strm - The stream to add
+ *
+ * @return Error code
+ * @retval -1 - Failure (out of memory)
+ * @retval  0 - Success
+ *
+ * @par MT-safe: No, call under strmarray_lock
+ *
+ */
+static int
+strm_dest_hash_add(stream_t *strm)
+{
+	unsigned int b;
+
+	if (strm_dest_count >= 2 * strm_dest_hash_sz) {
+		stream_t **old = strm_dest_hash;
+		unsigned int oldsz = strm_dest_hash_sz;
+		unsigned int newsz = oldsz ? oldsz * 2 : TPP_STRM_HASH_INIT;
+		unsigned int i;
+		stream_t *s;
+		stream_t *nxt;
+
+		strm_dest_hash = calloc(newsz, sizeof(stream_t *));
+		if (strm_dest_hash == NULL) {
+			strm_dest_hash = old;
+			if (old == NULL)
+				return -1;
+		} else {
+			strm_dest_hash_sz = newsz;
+			for (i = 0; i < oldsz; i++) {
+				for (s = old[i]; s; s = nxt) {
+					nxt = s->dest_hnext;
+					b = strm_dest_bucket(&s->dest_addr);
+					s->dest_hnext = strm_dest_hash[b];
+					strm_dest_hash[b] = s;
+				}
+			}
+			free(old);
+		}
+	}
+
+	b = strm_dest_bucket(&strm->dest_addr);
+	strm->dest_hnext = strm_dest_hash[b];
+	strm_dest_hash[b] = strm;
+	strm_dest_count++;
+
+	return 0;
+}
+
+/**
+ * @brief
+ *	Remove a stream from the destination hash
+ *
+ * @param[in] strm - The stream to remove
+ *
+ * @return Error code
+ * @retval -1 - the stream was not in the hash
+ * @retval  0 - Success
+ *
+ * @par MT-safe: No, call under strmarray_lock
+ *
+ */
+static int
+strm_dest_hash_del(stream_t *strm)
+{
+	stream_t **pp;
+
+	if (strm_dest_hash == NULL)
+		return -1;
+
+	for (pp = &strm_dest_hash[strm_dest_bucket(&strm->dest_addr)]; *pp; pp = &(*pp)->dest_hnext) {
+		if (*pp == strm) {
+			*pp = strm->dest_hnext;
+			strm->dest_hnext = NULL;
+			strm_dest_count--;
+			return 0;
+		}
+	}
+	return -1;
+}
+
 /**
  * @brief
  *	Sets the APP handler to be called in case the network connection from
@@ -619,6 +783,7 @@ static int
 connect_router(tpp_router_t *r)
 {
 	tpp_context_t *ctx;
+	int delay;
 
 	/* since we connected we should add a context */
 	if ((ctx = (tpp_context_t *) malloc(sizeof(tpp_context_t))) == NULL) {
@@ -628,8 +793,18 @@ connect_router(tpp_router_t *r)
 	ctx->ptr = r;
 	ctx->type = TPP_ROUTER_NODE;
 
+	/*
+	 * spread reconnects over the whole backoff interval, so that the
+	 * leaves that lost a restarted router do not all come back at once
+	 */
+	delay = r->delay;
+	if (delay > 1) {
+		connect_seed = connect_seed * 1103515245 + 12345;
+		delay = 1 + (connect_seed >> 16) % delay;
+	}
+
 	/* initiate connections to the tpp router (single for now) */
-	if (tpp_transport_connect(r->router_name, tpp_conf->auth_type, r->delay, ctx, &(r->conn_fd)) == -1) {
+	if (tpp_transport_connect(r->router_name, tpp_conf->auth_type, delay, ctx, &(r->conn_fd)) == -1) {
 		snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Connection to pbs_comm %s failed", r->router_name);
 		tpp_log_func(LOG_ERR, NULL, tpp_get_logbuf());
 		return -1;
@@ -673,12 +848,17 @@ tpp_init(struct tpp_config *cnf)
 	int app_fd;
 
 	tpp_conf = cnf;
+	tpp_set_compression_level(tpp_conf->compress_level);
 	if (tpp_conf->node_name == NULL) {
 		snprintf(log_buffer, TPP_LOGBUF_SZ, "TPP leaf node name is NULL");
 		tpp_log_func(LOG_CRIT, NULL, log_buffer);
 		return -1;
 	}
 
+	connect_seed = (unsigned int) time(0) ^ (unsigned int) getpid();
+	for (i = 0; tpp_conf->node_name[i] != '\0'; i++)
+		connect_seed = connect_seed * 31 + (unsigned char) tpp_conf->node_name[i];
+
 	/* before doing anything else, initialize the key to the tls */
 	if (tpp_init_tls_key() != 0) {
 		/* can only use prints since tpp key init failed */
@@ -690,6 +870,7 @@ tpp_init(struct tpp_config *cnf)
 	tpp_log_func(LOG_CRIT, NULL, log_buffer);
 
 	tpp_init_lock(&strmarray_lock);
+	tpp_init_lock(&mcast_group_lock);
 	if (tpp_mbox_init(&app_mbox) != 0) {
 		tpp_log_func(LOG_CRIT, __func__, "Failed to create application mbox");
 		return -1;
@@ -700,13 +881,19 @@ tpp_init(struct tpp_config *cnf)
 
 	/* initialize the retry and ack queues */
 	TPP_QUE_CLEAR(&global_ack_queue);
-	TPP_QUE_CLEAR(&global_retry_queue);
+	for (i = 0; i < TPP_RETRY_WHEEL_SZ; i++) {
+		TPP_QUE_CLEAR(&retry_wheel[i]);
+	}
+	retry_wheel_time = 0;
+	retry_wheel_count = 0;
 	TPP_QUE_CLEAR(&strm_action_queue);
 	TPP_QUE_CLEAR(&freed_sd_queue);
 
-	AVL_streams = create_tree(AVL_DUP_KEYS_OK, sizeof(tpp_addr_t));
-	if (AVL_streams == NULL) {
-		tpp_log_func(LOG_CRIT, __func__, "Failed to create AVL tree for leaves");
+	strm_dest_count = 0;
+	strm_dest_hash_sz = TPP_STRM_HASH_INIT;
+	strm_dest_hash = calloc(strm_dest_hash_sz, sizeof(stream_t *));
+	if (strm_dest_hash == NULL) {
+		tpp_log_func(LOG_CRIT, __func__, "Failed to create hash of streams");
 		return -1;
 	}
 
@@ -778,6 +965,9 @@ tpp_init(struct tpp_config *cnf)
 		routers[i]->state = TPP_ROUTER_STATE_DISCONNECTED;
 		routers[i]->index = i;
 		routers[i]->delay = 0;
+		routers[i]->caps = 0;
+		routers[i]->epoch = 0;
+		routers[i]->mcast_groups = NULL;
 
 		sprintf(tpp_get_logbuf(), "Connecting to pbs_comm %s", routers[i]->router_name);
 		tpp_log_func(LOG_INFO, NULL, tpp_get_logbuf());
@@ -835,7 +1025,6 @@ tpp_open(char *dest_host, unsigned int port)
 	char *dest;
 	tpp_addr_t *addrs, dest_addr;
 	int count;
-	AVL_IX_REC *pkey;
 
 	if ((dest = mk_hostname(dest_host, port)) == NULL) {
 		tpp_log_func(LOG_CRIT, __func__, "Out of memory opening stream");
@@ -861,30 +1050,19 @@ tpp_open(char *dest_host, unsigned int port)
 	 * comes to such a half open stream
 	 */
 
-	if ((pkey = avlkey_create(AVL_streams, &dest_addr))) {
-		if (avl_find_key(pkey, AVL_streams) == AVL_IX_OK) {
-			while (1) {
-				strm = pkey->recptr;
-				if (strm->u_state == TPP_STRM_STATE_OPEN &&
-						strm->t_state == TPP_TRNS_STATE_OPEN &&
-						strm->used_locally == 1) {
-					tpp_unlock(&strmarray_lock);
-					free(pkey);
-
-					TPP_DBPRT(("Stream for dest[%s] returned = %u", dest, strm->sd));
-					free(dest);
-					return strm->sd;
-				}
-
-				if (avl_next_key(pkey, AVL_streams) != AVL_IX_OK)
-					break;
+	for (strm = strm_dest_hash[strm_dest_bucket(&dest_addr)]; strm; strm = strm->dest_hnext) {
+		if (memcmp(&strm->dest_addr, &dest_addr, sizeof(tpp_addr_t)) != 0)
+			continue;
+		if (strm->u_state == TPP_STRM_STATE_OPEN &&
+				strm->t_state == TPP_TRNS_STATE_OPEN &&
+				strm->used_locally == 1) {
+			tpp_unlock(&strmarray_lock);
 
-				if (memcmp(&pkey->key, &dest_addr, sizeof(tpp_addr_t)) != 0)
-					break;
-			}
+			TPP_DBPRT(("Stream for dest[%s] returned = %u", dest, strm->sd));
+			free(dest);
+			return strm->sd;
 		}
 	}
-	free(pkey);
 
 	tpp_unlock(&strmarray_lock);
 
@@ -931,6 +1109,73 @@ get_next_seq(unsigned int seq_no)
 	return seq_no;
 }
 
+/**
+ * @brief
+ *	Current wall clock time in milliseconds, for the ack latency stats
+ *
+ * @return time in milliseconds
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static long long
+tpp_time_ms(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return ((long long) tv.tv_sec * 1000 + tv.tv_usec / 1000);
+}
+
+/**
+ * @brief
+ *	Check whether a sequence number falls in an (inclusive) range of
+ *	sequence numbers, taking the wrap at MAX_SEQ_NUMBER into account.
+ *
+ * @param[in] seq_no - The sequence number to check
+ * @param[in] first  - The first sequence number of the range
+ * @param[in] last   - The last sequence number of the range
+ *
+ * @return 1 if in range, 0 otherwise
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static int
+seq_in_range(unsigned int seq_no, unsigned int first, unsigned int last)
+{
+	if (first <= last)
+		return (seq_no >= first && seq_no <= last);
+	return (seq_no >= first || seq_no <= last);
+}
+
+/**
+ * @brief
+ *	Number of sequence numbers in an (inclusive) range, taking the wrap
+ *	at MAX_SEQ_NUMBER (back to 1) into account.
+ *
+ * @param[in] first  - The first sequence number of the range
+ * @param[in] last   - The last sequence number of the range
+ *
+ * @return - count of sequence numbers
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static unsigned int
+seq_range_count(unsigned int first, unsigned int last)
+{
+	if (first <= last)
+		return last - first + 1;
+	return (MAX_SEQ_NUMBER - first) + last;
+}
+
 /**
  * @brief
  *	Returns the index of the router which has an established TCP connection
@@ -1054,16 +1299,20 @@ tpp_send(int sd, void *data, int len)
 		void *outbuf;
 
 		outbuf = tpp_deflate(data, len, &cmprsd_len);
-		if (outbuf == NULL) {
+		if (outbuf != NULL) {
+			pkt = tpp_cr_pkt(outbuf, cmprsd_len, 0);
+			if (pkt == NULL) {
+				free(outbuf);
+				return -1;
+			}
+		} else if (cmprsd_len != len) {
 			tpp_log_func(LOG_CRIT, __func__, "tpp deflate failed");
 			return -1;
 		}
-		pkt = tpp_cr_pkt(outbuf, cmprsd_len, 0);
-		if (pkt == NULL) {
-			free(outbuf);
-			return -1;
-		}
+		/* else the data does not compress, send it as is */
+	}
 
+	if (pkt) {
 		p = pkt->data;
 		to_send = cmprsd_len;
 	} else {
@@ -1139,7 +1388,7 @@ tpp_send_inner(int sd, void *data, int len, int full_len, int cmprsd_len)
 	strm->send_seq_no = get_next_seq(strm->send_seq_no);
 
 	dhdr.ack_seq = htonl(UNINITIALIZED_INT);
-	dhdr.dup = 0;
+	dhdr.dup = TPP_PKT_ACK_RANGES;
 	dhdr.cmprsd_len = htonl(cmprsd_len);
 	dhdr.totlen = htonl(full_len);
 	memcpy(&dhdr.src_addr, &strm->src_addr, sizeof(tpp_addr_t));
@@ -1345,7 +1594,7 @@ alloc_stream(tpp_addr_t *src_addr, tpp_addr_t *dest_addr)
 		freed_queue_count--;
 	}
 
-	if (freed_sd != UNINITIALIZED_INT && strmarray[freed_sd].slot_state == TPP_SLOT_FREE) {
+	if (freed_sd != UNINITIALIZED_INT && STRM_SLOT(freed_sd).slot_state == TPP_SLOT_FREE) {
 		sd = freed_sd;
 	} else if (high_sd != UNINITIALIZED_INT && max_strms > 0 && high_sd < max_strms - 1) {
 		sd = high_sd + 1;
@@ -1355,15 +1604,17 @@ alloc_stream(tpp_addr_t *src_addr, tpp_addr_t *dest_addr)
 		TPP_DBPRT(("***Searching for a free slot"));
 		/* search for a free sd */
 		for (i = 0; i < max_strms; i++) {
-			if (strmarray[i].slot_state == TPP_SLOT_FREE) {
+			if (STRM_SLOT(i).slot_state == TPP_SLOT_FREE) {
 				sd = i;
 				break;
 			}
 		}
 	}
 
-	if (high_sd == UNINITIALIZED_INT || sd > high_sd) {
-		high_sd = sd; /* remember the max sd used */
+	if (sd >= TPP_STRM_CHUNK * TPP_STRM_MAX_CHUNKS) {
+		tpp_unlock(&strmarray_lock);
+		tpp_log_func(LOG_CRIT, __func__, "Too many streams open");
+		return NULL;
 	}
 
 	strm = calloc(1, sizeof(stream_t));
@@ -1393,31 +1644,24 @@ alloc_stream(tpp_addr_t *src_addr, tpp_addr_t *dest_addr)
 	TPP_QUE_CLEAR(&strm->ack_queue);
 	TPP_QUE_CLEAR(&strm->retry_queue);
 
-	/* set to stream array */
-	if (max_strms == 0 || sd > max_strms - 1) {
-		unsigned int newsize;
-		void *p;
+	/* set to stream array, adding a chunk of slots if needed */
+	if (sd >= max_strms) {
+		stream_slot_t *chunk;
 
-		/* resize strmarray */
-		newsize = sd + 100;
-		p = realloc(strmarray, sizeof(stream_slot_t) * newsize);
-		if (!p) {
+		chunk = calloc(TPP_STRM_CHUNK, sizeof(stream_slot_t));
+		if (!chunk) {
 			free(strm);
 			tpp_unlock(&strmarray_lock);
 			tpp_log_func(LOG_CRIT, __func__, "Out of memory resizing stream array");
 			return NULL;
 		}
-		strmarray = (stream_slot_t *) p;
-		memset(&strmarray[max_strms], 0, (newsize - max_strms) * sizeof(stream_slot_t));
-		max_strms = newsize;
+		strm_chunks[max_strms / TPP_STRM_CHUNK] = chunk;
+		__atomic_store_n(&max_strms, max_strms + TPP_STRM_CHUNK, __ATOMIC_RELEASE);
 	}
 
-	strmarray[sd].slot_state = TPP_SLOT_BUSY;
-	strmarray[sd].strm = strm;
-
 	if (dest_addr) {
-		/* also add stream to the AVL_streams with the dest as key */
-		if (tree_add_del(AVL_streams, &strm->dest_addr, strm, TREE_OP_ADD) != 0) {
+		/* also add stream to the destination hash */
+		if (strm_dest_hash_add(strm) != 0) {
 			sprintf(tpp_get_logbuf(), "Failed to add strm with sd=%u to streams", strm->sd);
 			tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
 			free(strm);
@@ -1426,6 +1670,13 @@ alloc_stream(tpp_addr_t *src_addr, tpp_addr_t *dest_addr)
 		}
 	}
 
+	if (high_sd == UNINITIALIZED_INT || sd > high_sd) {
+		high_sd = sd; /* remember the max sd used */
+	}
+
+	__atomic_store_n(&STRM_SLOT(sd).strm, strm, __ATOMIC_RELEASE);
+	__atomic_store_n(&STRM_SLOT(sd).slot_state, TPP_SLOT_BUSY, __ATOMIC_RELEASE);
+
 	TPP_DBPRT(("*** Allocated new stream, sd=%u, src_magic=%u", strm->sd, strm->src_magic));
 
 	tpp_unlock(&strmarray_lock);
@@ -1509,8 +1760,10 @@ free_routers()
 {
 	int i;
 
-	for (i = 0; i < max_routers; i++)
+	for (i = 0; i < max_routers; i++) {
+		tpp_free_mcast_groups(routers[i]->mcast_groups);
 		free(routers[i]);
+	}
 	free(routers);
 
 	free(tpp_conf->node_name);
@@ -1550,17 +1803,24 @@ tpp_shutdown()
 
 	tpp_lock(&strmarray_lock);
 	for (i = 0; i < max_strms; i++) {
-		if (strmarray[i].slot_state == TPP_SLOT_BUSY) {
-			sd = strmarray[i].strm->sd;
+		if (STRM_SLOT(i).slot_state == TPP_SLOT_BUSY) {
+			sd = STRM_SLOT(i).strm->sd;
 			if (tpp_user_data_del_fnc != NULL)
 				(*tpp_user_data_del_fnc)(sd);
-			free_stream_resources(strmarray[i].strm);
+			free_stream_resources(STRM_SLOT(i).strm);
 			free_stream(sd);
 		}
 	}
+	for (i = 0; i < max_strms / TPP_STRM_CHUNK; i++) {
+		free(strm_chunks[i]);
+		strm_chunks[i] = NULL;
+	}
+	max_strms = 0;
+	free(strm_dest_hash);
+	strm_dest_hash = NULL;
+	strm_dest_hash_sz = 0;
+	strm_dest_count = 0;
 	tpp_unlock(&strmarray_lock);
-	if (strmarray)
-		free(strmarray);
 	tpp_destroy_lock(&strmarray_lock);
 
 	free_routers();
@@ -2152,6 +2412,188 @@ tpp_mcast_notify_members(int mtfd, int cmd)
 	}
 }
 
+/**
+ * @brief
+ *	Send multicast data to the members of a group registered at a router
+ *
+ * @par Functionality
+ *	The member stream infos are hashed, and the group is looked up in the
+ *	router's group slot the hash selects. If that slot does not hold exactly
+ *	these members (or the router connection has been re-established since it
+ *	was registered), the group is (re)registered with the router first. The
+ *	data itself is sent with the group reference and the current sequence
+ *	numbers of the members only; the router expands it to the members.
+ *
+ * @param[in] mstrm - The multicast stream
+ * @param[in] d - Duplicate of the multicast data, seqs are filled in
+ * @param[in] r - The router to send through, must have TPP_CAP_MCAST_GROUPS
+ * @param[in] data - The pointer to the block of data to send
+ * @param[in] len  - Length of the data to send
+ * @param[in] full_len - Total length of the data (in case of chunks)
+ * @param[in] cmprsd_len - Length of compressed data (if compressed)
+ *
+ * @return	Error code
+ * @retval   -1 - Failure
+ * @retval    0 - Success, d is owned by the sent packet
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static int
+tpp_mcast_send_group(stream_t *mstrm, mcast_data_t *d, tpp_router_t *r, void *data, unsigned int len, unsigned int full_len, unsigned int cmprsd_len)
+{
+	stream_t *strm;
+	tpp_mcast_pkt_info_t *members = NULL;
+	unsigned int *seqs = NULL;
+	void *cmpr_buf = NULL;
+	unsigned int cmpr_len = 0;
+	unsigned int members_len = sizeof(tpp_mcast_pkt_info_t) * d->num_fds;
+	unsigned int seqs_len = sizeof(unsigned int) * d->num_fds;
+	unsigned int hash = 2166136261U;
+	unsigned int epoch;
+	unsigned char *p;
+	tpp_mcast_group_t *g;
+	tpp_mcast_group_ref_t ref;
+	tpp_mcast_pkt_hdr_t mhdr;
+	tpp_chunk_t chunks[4];
+	int fd;
+	int i;
+	int rc = -1;
+
+	members = calloc(d->num_fds, sizeof(tpp_mcast_pkt_info_t)); /* zeroed, seq_no is not part of a group */
+	seqs = malloc(seqs_len);
+	if (!members || !seqs) {
+		snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ,
+			"Out of memory allocating mcast group of %d members", d->num_fds);
+		tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
+		goto done;
+	}
+
+	for (i = 0; i < d->num_fds; i++) {
+		strm = get_strm_atomic(d->strms[i]);
+		if (!strm) {
+			snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Stream %d is not open", d->strms[i]);
+			tpp_log_func(LOG_ERR, NULL, tpp_get_logbuf());
+			goto done;
+		}
+
+		members[i].src_sd = htonl(strm->sd);
+		members[i].src_magic = htonl(strm->src_magic);
+		members[i].dest_sd = htonl(strm->dest_sd);
+		memcpy(&members[i].dest_addr, &strm->dest_addr, sizeof(tpp_addr_t));
+
+		seqs[i] = htonl(strm->send_seq_no);
+		d->seqs[i] = strm->send_seq_no; /* store seq in packet for retry case */
+		strm->send_seq_no = get_next_seq(strm->send_seq_no);
+	}
+
+	/* FNV-1a over the member infos */
+	for (p = (unsigned char *) members; p < (unsigned char *) members + members_len; p++)
+		hash = (hash ^ *p) * 16777619U;
+
+	memset(&mhdr, 0, sizeof(tpp_mcast_pkt_hdr_t)); /* only to satisfy valgrind */
+	mhdr.hop = 0;
+	mhdr.num_streams = htonl(d->num_fds);
+	memcpy(&mhdr.src_addr, &mstrm->src_addr, sizeof(tpp_addr_t));
+
+	ref.group = htonl(hash % TPP_MCAST_GROUP_SLOTS);
+	ref.hash = htonl(hash);
+
+	chunks[0].data = &mhdr;
+	chunks[0].len = sizeof(tpp_mcast_pkt_hdr_t);
+	chunks[1].data = &ref;
+	chunks[1].len = sizeof(tpp_mcast_group_ref_t);
+
+	/*
+	 * hold the lock across registration and data send, so that no other
+	 * thread reuses the slot for another group in between
+	 */
+	tpp_lock(&mcast_group_lock);
+
+	fd = r->conn_fd;
+	epoch = r->epoch;
+	if (!r->mcast_groups) {
+		r->mcast_groups = calloc(TPP_MCAST_GROUP_SLOTS, sizeof(tpp_mcast_group_t));
+		if (!r->mcast_groups) {
+			tpp_unlock(&mcast_group_lock);
+			tpp_log_func(LOG_CRIT, __func__, "Out of memory allocating mcast groups");
+			goto done;
+		}
+	}
+	g = &r->mcast_groups[hash % TPP_MCAST_GROUP_SLOTS];
+
+	if (g->epoch != epoch || g->hash != hash || g->num_streams != d->num_fds ||
+		memcmp(g->members, members, members_len) != 0) {
+		mhdr.type = TPP_MCAST_GROUP;
+		mhdr.info_len = htonl(members_len);
+		mhdr.info_cmprsd_len = 0;
+		chunks[2].data = members;
+		chunks[2].len = members_len;
+
+		if (tpp_conf->compress == 1 && members_len > TPP_SEND_SIZE) {
+			cmpr_buf = tpp_deflate(members, members_len, &cmpr_len);
+			if (cmpr_buf) {
+				mhdr.info_cmprsd_len = htonl(cmpr_len);
+				chunks[2].data = cmpr_buf;
+				chunks[2].len = cmpr_len;
+			}
+		}
+
+		TPP_DBPRT(("*** registering mcast group %u, %d members", hash % TPP_MCAST_GROUP_SLOTS, d->num_fds));
+		if (tpp_transport_vsend(fd, chunks, 3) != 0) {
+			tpp_unlock(&mcast_group_lock);
+			tpp_log_func(LOG_ERR, __func__, "tpp_transport_vsend failed registering mcast group");
+			goto done;
+		}
+		free(cmpr_buf);
+		cmpr_buf = NULL;
+
+		free(g->members);
+		g->members = members;
+		members = NULL;
+		g->num_streams = d->num_fds;
+		g->hash = hash;
+		g->epoch = epoch;
+	}
+
+	mhdr.type = TPP_MCAST_GROUP_DATA;
+	mhdr.data_cmprsd_len = htonl(cmprsd_len);
+	mhdr.totlen = htonl(full_len);
+	mhdr.info_len = htonl(seqs_len);
+	mhdr.info_cmprsd_len = 0;
+	chunks[2].data = seqs;
+	chunks[2].len = seqs_len;
+
+	if (tpp_conf->compress == 1 && seqs_len > TPP_SEND_SIZE) {
+		cmpr_buf = tpp_deflate(seqs, seqs_len, &cmpr_len);
+		if (cmpr_buf) {
+			mhdr.info_cmprsd_len = htonl(cmpr_len);
+			chunks[2].data = cmpr_buf;
+			chunks[2].len = cmpr_len;
+		}
+	}
+
+	chunks[3].data = data;
+	chunks[3].len = len;
+
+	TPP_DBPRT(("*** sending mcast to group %u", hash % TPP_MCAST_GROUP_SLOTS));
+	if (tpp_transport_vsend_extra(fd, chunks, 4, d) == 0)
+		rc = 0;
+	else
+		tpp_log_func(LOG_ERR, __func__, "tpp_transport_vsend failed in tpp_mcast_send");
+
+	tpp_unlock(&mcast_group_lock);
+
+done:
+	free(cmpr_buf);
+	free(members);
+	free(seqs);
+	return rc;
+}
+
 /**
  * @brief
  *	Create a multicast packet and send the data to all member streams
@@ -2203,6 +2645,19 @@ tpp_mcast_send(int mtfd, void *data, unsigned int len, unsigned int full_len, un
 		goto err;
 	}
 
+	app_thread_active_router = get_active_router(app_thread_active_router);
+	if (app_thread_active_router == -1) {
+		tpp_log_func(LOG_ERR, __func__, "No active router");
+		goto err;
+	}
+
+	/* large enough sets of streams go as a group, if the router can expand it */
+	if (d->num_fds >= TPP_MCAST_GROUP_MIN && (routers[app_thread_active_router]->caps & TPP_CAP_MCAST_GROUPS)) {
+		if (tpp_mcast_send_group(mstrm, d, routers[app_thread_active_router], data, len, full_len, cmprsd_len) == 0)
+			return len;
+		goto err;
+	}
+
 	minfo_len = sizeof(tpp_mcast_pkt_info_t) * d->num_fds;
 
 #ifdef DEBUG
@@ -2294,12 +2749,6 @@ tpp_mcast_send(int mtfd, void *data, unsigned int len, unsigned int full_len, un
 	chunks[2].len = len;
 	totlen += chunks[2].len;
 
-	app_thread_active_router = get_active_router(app_thread_active_router);
-	if (app_thread_active_router == -1) {
-		tpp_log_func(LOG_ERR, __func__, "No active router");
-		goto err;
-	}
-
 	TPP_DBPRT(("*** sending %d totlen", totlen));
 	if (tpp_transport_vsend_extra(routers[app_thread_active_router]->conn_fd, chunks, 3, d) == 0) {
 		free(minfo_buf);
@@ -2393,12 +2842,12 @@ queue_strm_close(stream_t *strm)
 
 	tpp_lock(&strmarray_lock); /* already under lock, dont need get_strm_atomic */
 
-	if (strmarray[strm->sd].slot_state != TPP_SLOT_BUSY) {
+	if (STRM_SLOT(strm->sd).slot_state != TPP_SLOT_BUSY) {
 		tpp_unlock(&strmarray_lock);
 		return;
 	}
 
-	strmarray[strm->sd].slot_state = TPP_SLOT_DELETED;
+	__atomic_store_n(&STRM_SLOT(strm->sd).slot_state, TPP_SLOT_DELETED, __ATOMIC_RELEASE);
 	TPP_DBPRT(("Marked sd=%u DELETED", strm->sd));
 
 	if ((c = malloc(sizeof(strm_action_info_t))) == NULL) {
@@ -2431,7 +2880,7 @@ queue_strm_close(stream_t *strm)
  * @par Functionality
  *	The slot is not marked free immediately, rather after a period. This is to
  *	ensure that wandering/delayed messages do not cause havoc.
- *	Additionally deletes the stream's entry in the Stream AVL tree. This
+ *	Additionally deletes the stream's entry in the destination hash. This
  *	function is called from both the APP thread and the IO thread, so it
  *	synchronizes using the strmarray_lock mutex.
  *
@@ -2451,7 +2900,7 @@ queue_strm_free(unsigned int sd)
 
 	tpp_lock(&strmarray_lock);
 
-	strm = strmarray[sd].strm;
+	strm = STRM_SLOT(sd).strm;
 
 	flush_acks(strm);
 	free_stream_resources(strm);
@@ -2498,7 +2947,7 @@ strm_timeout_action(unsigned int sd)
 	stream_t *strm;
 
 	tpp_lock(&strmarray_lock);
-	strm = strmarray[sd].strm;
+	strm = STRM_SLOT(sd).strm;
 
 	TPP_DBPRT(("*** sd=%u timed out, closing", sd));
 
@@ -2532,7 +2981,7 @@ enque_timeout_strm(stream_t *strm)
 
 	tpp_lock(&strmarray_lock);
 
-	if (strmarray[strm->sd].slot_state != TPP_SLOT_BUSY) {
+	if (STRM_SLOT(strm->sd).slot_state != TPP_SLOT_BUSY) {
 		tpp_unlock(&strmarray_lock);
 		return;
 	}
@@ -2608,11 +3057,10 @@ send_app_strm_close(stream_t *strm, int cmd, int error)
  *	destination stream descriptor.
  *
  * @par Functionality
- *	Searches the AVL tree of streams based on the destination address.
- *	There could be several entries, since several streams could be open
- *	to the same destination. The AVL search quickly find the first entry
- *	that matches the address. Then on, we serially match the fd of the
- *	destination stream.
+ *	Walks the destination hash bucket of the address. There could be
+ *	several entries, since several streams could be open to the same
+ *	destination, so we serially match the address, the fd and the magic
+ *	of the destination stream.
  *
  * @param[in] dest_addr  - address of the destination
  * @param[in] dest_sd    - The descriptor of the destination stream
@@ -2631,51 +3079,30 @@ send_app_strm_close(stream_t *strm, int cmd, int error)
 static stream_t *
 find_stream_with_dest(tpp_addr_t *dest_addr, unsigned int dest_sd, unsigned int dest_magic)
 {
-	AVL_IX_REC *pkey;
 	stream_t *strm;
 
-	pkey = avlkey_create(AVL_streams, dest_addr);
-	if (pkey == NULL)
-		return NULL;
-
-	if (avl_find_key(pkey, AVL_streams) != AVL_IX_OK) {
-		free(pkey);
-		return NULL;
-	}
-
-	while (1) {
-		strm = pkey->recptr;
+	for (strm = strm_dest_hash[strm_dest_bucket(dest_addr)]; strm; strm = strm->dest_hnext) {
+		if (memcmp(&strm->dest_addr, dest_addr, sizeof(tpp_addr_t)) != 0)
+			continue;
 
 		TPP_DBPRT(("sd=%u, dest_sd=%u, u_state=%d, t-state=%d, dest_magic=%u", strm->sd, strm->dest_sd, strm->u_state, strm->t_state, strm->dest_magic));
-		if (strm->dest_sd == dest_sd && strm->dest_magic == dest_magic) {
-			free(pkey);
+		if (strm->dest_sd == dest_sd && strm->dest_magic == dest_magic)
 			return strm;
-		}
-
-		if (avl_next_key(pkey, AVL_streams) != AVL_IX_OK) {
-			free(pkey);
-			return NULL;
-		}
-
-		if (memcmp(&pkey->key, dest_addr, sizeof(tpp_addr_t)) != 0) {
-			free(pkey);
-			return NULL;
-		}
 	}
 	return NULL;
 }
 
 /**
  * @brief
- *	Queue a retry packet into the retry queue in a
- *	sorted manner.
+ *	Queue a retry packet into the slot of the global retry wheel for the
+ *	given deadline.
  *
- * @param[in] q - Address of the queue to which to insert
- * @param[in] pkt- The retry packet that has to be inserted
+ * @param[in] pkt - The retry packet (with retry info in extra_data)
+ * @param[in] retry_time - The time at which the packet must be resent
  *
- * @return Ptr to the location where it was inserted
- * @retval NULL - If the insertion failed
- * @retval !NULL - The location where the packet was inserted
+ * @return Error code
+ * @retval -1 - Failure
+ * @retval  0 - Success
  *
  * @par Side Effects:
  *	None
@@ -2683,31 +3110,47 @@ find_stream_with_dest(tpp_addr_t *dest_addr, unsigned int dest_sd, unsigned int
  * @par MT-safe: No
  *
  */
-static tpp_que_elem_t *
-enque_retry_sorted(tpp_que_t *q, tpp_packet_t *pkt)
+static int
+enque_retry(tpp_packet_t *pkt, time_t retry_time)
 {
-	tpp_que_elem_t *n = NULL;
-	tpp_packet_t *pkt_queued = NULL;
-	retry_info_t *rt = NULL;
-	time_t time;
+	retry_info_t *rt = (retry_info_t *) pkt->extra_data;
+	int slot = (int) (retry_time % TPP_RETRY_WHEEL_SZ);
 
-	if (!pkt->extra_data)
-		return NULL;
+	if (!rt)
+		return -1;
+
+	if ((rt->global_retry_node = tpp_enque(&retry_wheel[slot], pkt)) == NULL)
+		return -1;
 
-	time = ((retry_info_t *) pkt->extra_data)->retry_time;
+	rt->retry_time = retry_time;
+	rt->retry_slot = slot;
+	if (retry_wheel_count == 0 || retry_time < retry_wheel_time)
+		retry_wheel_time = retry_time;
+	retry_wheel_count++;
 
-	n = TPP_QUE_TAIL(q);
-	while (n) {
-		pkt_queued = TPP_QUE_DATA(n);
-		rt = (retry_info_t *) pkt_queued->extra_data;
-		if (rt->retry_time <= time)
-			break;
-		n = n->prev;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Remove a retry packet from the global retry wheel, if it is queued there
+ *
+ * @param[in] rt - The retry info of the packet
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: No
+ *
+ */
+static void
+deque_retry(retry_info_t *rt)
+{
+	if (rt->global_retry_node) {
+		tpp_que_del_elem(&retry_wheel[rt->retry_slot], rt->global_retry_node);
+		rt->global_retry_node = NULL;
+		retry_wheel_count--;
 	}
-	if (n)
-		return (tpp_que_ins_elem(q, n, pkt, 0));
-	else
-		return (tpp_enque(q, pkt));
 }
 
 /**
@@ -2759,7 +3202,15 @@ shelve_pkt(tpp_packet_t *pkt, tpp_packet_t *data_pkt, time_t retry_time)
 
 			return 0;
 		}
-		rt->retry_time = retry_time;
+		/* move it to the slot of its new deadline */
+		if (rt->global_retry_node) {
+			deque_retry(rt);
+			if (enque_retry(pkt, retry_time) != 0) {
+				tpp_log_func(LOG_CRIT, __func__, "Failed to shelve data packet");
+				return -1;
+			}
+		} else
+			rt->retry_time = retry_time;
 		rt->sent_to_transport = 0;
 		TPP_DBPRT(("Packet already shelved for stream %d, retry_info=%p", sd, rt));
 		return 0;
@@ -2773,21 +3224,21 @@ shelve_pkt(tpp_packet_t *pkt, tpp_packet_t *data_pkt, time_t retry_time)
 
 	rt->data_pkt = data_pkt;
 	rt->acked = 0;
-	rt->retry_time = retry_time;
 	rt->retry_count = 0;
 	rt->sent_to_transport = 0;
+	rt->sent_ms = tpp_time_ms();
 	pkt->extra_data = rt;
 
-	/* enqueue in a time sorted manner */
-	if ((rt->global_retry_node = enque_retry_sorted(&global_retry_queue, pkt)) == NULL) {
+	/* index by deadline globally, the stream's list is only ever searched */
+	if (enque_retry(pkt, retry_time) != 0) {
 		tpp_log_func(LOG_CRIT, __func__, "Failed to shelve data packet");
 		free(rt);
 		pkt->extra_data = NULL;
 		return -1;
 	}
-	if ((rt->strm_retry_node = enque_retry_sorted(&strm->retry_queue, pkt)) == NULL) {
+	if ((rt->strm_retry_node = tpp_enque(&strm->retry_queue, pkt)) == NULL) {
 		tpp_log_func(LOG_CRIT, __func__, "Failed to shelve data packet");
-		tpp_que_del_elem(&global_retry_queue, rt->global_retry_node);
+		deque_retry(rt);
 		free(rt);
 		pkt->extra_data = NULL;
 		return -1;
@@ -2841,7 +3292,7 @@ shelve_mcast_pkt(tpp_mcast_pkt_hdr_t *mcast_hdr, int sd, int seq, tpp_packet_t *
 	indiv_dhdr.seq_no = htonl(seq);
 
 	indiv_dhdr.ack_seq = htonl(UNINITIALIZED_INT);
-	indiv_dhdr.dup = 1;
+	indiv_dhdr.dup = TPP_PKT_DUP | TPP_PKT_ACK_RANGES;
 
 	indiv_dhdr.cmprsd_len = mcast_hdr->data_cmprsd_len;
 	indiv_dhdr.totlen = mcast_hdr->totlen;
@@ -2867,6 +3318,12 @@ shelve_mcast_pkt(tpp_mcast_pkt_hdr_t *mcast_hdr, int sd, int seq, tpp_packet_t *
  * @brief
  *	Queue a acknowledgment packet to be sent out later
  *
+ *	If the peer accepts ranged acks and the sequence number directly follows
+ *	the last one queued for the stream, the queued ack is extended to cover
+ *	it instead, so a burst of packets is acked by a single ack packet. The
+ *	ack still goes out no later than TPP_MAX_ACK_DELAY after the first
+ *	packet of the range was received.
+ *
  * @param[in] strm - Ptr to the stream to which this ack belongs
  * @param[in] type - The type of the incoming packet thats to be acked (unused)
  * @param[in] seq_no_recvd - The sequence number of the packet recvd.
@@ -2885,6 +3342,16 @@ static int
 queue_ack(stream_t *strm, unsigned char type, unsigned int seq_no_recvd)
 {
 	ack_info_t *ack;
+	tpp_que_elem_t *n;
+
+	if (strm->ack_ranges && (n = TPP_QUE_TAIL(&strm->ack_queue))) {
+		ack = TPP_QUE_DATA(n);
+		if (ack && get_next_seq(ack->seq_no) == seq_no_recvd) {
+			TPP_DBPRT(("Extending ack for sd=%u to seq_no=%u-%u", ack->sd, ack->seq_first, seq_no_recvd));
+			ack->seq_no = seq_no_recvd;
+			return 0;
+		}
+	}
 
 	ack = malloc(sizeof(ack_info_t));
 	if (!ack) {
@@ -2895,6 +3362,7 @@ queue_ack(stream_t *strm, unsigned char type, unsigned int seq_no_recvd)
 	ack->sd = strm->sd;
 	ack->ack_time = time(0) + TPP_MAX_ACK_DELAY;
 	TPP_DBPRT(("Queueing ack for received sd=%u seq_no=%u", ack->sd, seq_no_recvd));
+	ack->seq_first = seq_no_recvd;
 	ack->seq_no = seq_no_recvd;
 
 	if ((ack->strm_ack_node = tpp_enque(&strm->ack_queue, ack)) == NULL) {
@@ -2934,8 +3402,8 @@ send_ack_packet(ack_info_t *ack)
 	stream_t *strm;
 
 	tpp_lock(&strmarray_lock);
-	strm = strmarray[ack->sd].strm;
-	if (!strm || strmarray[ack->sd].slot_state == TPP_SLOT_FREE) {
+	strm = STRM_SLOT(ack->sd).strm;
+	if (!strm || STRM_SLOT(ack->sd).slot_state == TPP_SLOT_FREE) {
 		tpp_unlock(&strmarray_lock);
 		return -1;
 	}
@@ -2947,9 +3415,16 @@ send_ack_packet(ack_info_t *ack)
 	dhdr.src_sd = htonl(ack->sd);
 	dhdr.src_magic = htonl(strm->src_magic);
 	dhdr.dest_sd = htonl(strm->dest_sd);
-	dhdr.seq_no = htonl(ack->seq_no); /* seq no to ack */
-	dhdr.ack_seq = dhdr.seq_no; /* same as seq_no */
-	dhdr.dup = 0;
+	if (ack->seq_first != ack->seq_no) {
+		/* a range of acks, from seq_no through ack_seq */
+		dhdr.seq_no = htonl(ack->seq_first);
+		dhdr.ack_seq = htonl(ack->seq_no);
+		dhdr.dup = TPP_PKT_ACK_RANGES;
+	} else {
+		dhdr.seq_no = htonl(ack->seq_no); /* seq no to ack */
+		dhdr.ack_seq = dhdr.seq_no; /* same as seq_no */
+		dhdr.dup = 0;
+	}
 	memcpy(&dhdr.src_addr, &strm->src_addr, sizeof(tpp_addr_t));
 	memcpy(&dhdr.dest_addr, &strm->dest_addr, sizeof(tpp_addr_t));
 
@@ -2962,6 +3437,7 @@ send_ack_packet(ack_info_t *ack)
 		tpp_log_func(LOG_ERR, __func__, "tpp_transport_send failed");
 		return -1;
 	}
+	TPP_STAT_ADD(acks_sent, 1);
 	return 0;
 }
 
@@ -3051,6 +3527,7 @@ send_retry_packet(tpp_packet_t *pkt)
 	 */
 	rt->retry_count++;
 	rt->sent_to_transport = 1;
+	TPP_STAT_ADD(retries, 1);
 
 	if (tpp_transport_send_raw(routers[active_router]->conn_fd, pkt) != 0) {
 		tpp_log_func(LOG_ERR, __func__, "tpp_transport_send_raw failed");
@@ -3092,7 +3569,7 @@ check_pending_acks(time_t now)
 			 * thus get it directly instead of calling get_strm_atomic
 			 */
 			tpp_lock(&strmarray_lock);
-			strm = strmarray[ack->sd].strm;
+			strm = STRM_SLOT(ack->sd).strm;
 			tpp_unlock(&strmarray_lock);
 
 			if (!strm)
@@ -3194,10 +3671,17 @@ act_strm(time_t now, int force)
 
 /**
  * @brief
- *	Walk the sorted global retry queue to send retry packets that have send
- *	time < now
+ *	Walk one slot of the global retry wheel to send the retry packets in it
+ *	that have send time <= now
  *
+ * @param[in] q - The wheel slot
  * @param[in] now - The current time
+ * @param[in,out] count_sent_to_transport - due packets still with the transport
+ *
+ * @return Status
+ * @retval -1 - stop walking, too many packets are still with the transport
+ * @retval  0 - slot has no more due packets
+ * @retval  1 - slot still has due packets, that are with the transport
  *
  * @par Side Effects:
  *	None
@@ -3205,77 +3689,120 @@ act_strm(time_t now, int force)
  * @par MT-safe: No
  *
  */
-static void
-check_retries(time_t now)
+static int
+check_retry_slot(tpp_que_t *q, time_t now, int *count_sent_to_transport)
 {
 	tpp_que_elem_t *n = NULL;
 	int sd;
 	stream_t *strm;
 	tpp_data_pkt_hdr_t *dhdr;
-	int count_sent_to_transport = 0;
+	int pending = 0;
 
-	while ((n = TPP_QUE_NEXT(&global_retry_queue, n))) {
+	while ((n = TPP_QUE_NEXT(q, n))) {
 		tpp_packet_t *pkt;
 		retry_info_t *rt;
 
 		pkt = TPP_QUE_DATA(n);
 		rt = (retry_info_t *) pkt->extra_data;
-		if (rt && (rt->retry_time <= now)) {
-			if (rt->sent_to_transport == 1) {
-				count_sent_to_transport++;
-				if (count_sent_to_transport > 1000) {
-					sprintf(tpp_get_logbuf(),
-					        "Count of sent_to_transport retry packet reached 1000, doing IO now");
-					tpp_log_func(LOG_INFO, __func__, tpp_get_logbuf());
-					break;
-				}
-				continue;
+		if (rt == NULL || rt->retry_time > now)
+			continue; /* due in a later lap of the wheel */
+
+		if (rt->sent_to_transport == 1) {
+			pending = 1;
+			(*count_sent_to_transport)++;
+			if (*count_sent_to_transport > 1000) {
+				sprintf(tpp_get_logbuf(),
+				        "Count of sent_to_transport retry packet reached 1000, doing IO now");
+				tpp_log_func(LOG_INFO, __func__, tpp_get_logbuf());
+				return -1;
 			}
+			continue;
+		}
 
-			dhdr = (tpp_data_pkt_hdr_t *)(pkt->data + sizeof(int));
-			sd = ntohl(dhdr->src_sd);
+		dhdr = (tpp_data_pkt_hdr_t *)(pkt->data + sizeof(int));
+		sd = ntohl(dhdr->src_sd);
 
-			/* get the strm in whatever state it is in */
-			tpp_lock(&strmarray_lock);
-			strm = strmarray[sd].strm;
-			tpp_unlock(&strmarray_lock);
+		/* get the strm in whatever state it is in */
+		tpp_lock(&strmarray_lock);
+		strm = STRM_SLOT(sd).strm;
+		tpp_unlock(&strmarray_lock);
 
-			if (strm && strm->t_state == TPP_TRNS_STATE_OPEN) {
+		if (strm && strm->t_state == TPP_TRNS_STATE_OPEN) {
 
-				TPP_DBPRT(("Sending retry packet for sd=%d seq=%u retry_time=%ld, pkt=%p",
-						sd, ntohl(dhdr->seq_no), rt->retry_time, pkt));
+			TPP_DBPRT(("Sending retry packet for sd=%d seq=%u retry_time=%ld, pkt=%p",
+					sd, ntohl(dhdr->seq_no), rt->retry_time, pkt));
 
-				if (send_retry_packet(pkt) != 0) {
-					sprintf(tpp_get_logbuf(), "Could not send retry, sending net_close for sd=%u", strm->sd);
-					tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
-					send_app_strm_close(strm, TPP_CMD_NET_CLOSE, 0);
-				} else {
-					/*
-					 * in case of non fault tolerant mode
-					 * packet and retry will be deleted in
-					 * postsend handler
-					 */
-					if (tpp_fault_tolerant_mode == 1)
-						rt->retry_time = time(0) + TPP_MAX_RETRY_DELAY;
-				}
-				n = NULL; /* list could be modified by send_retry_packet */
+			if (send_retry_packet(pkt) != 0) {
+				sprintf(tpp_get_logbuf(), "Could not send retry, sending net_close for sd=%u", strm->sd);
+				tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
+				send_app_strm_close(strm, TPP_CMD_NET_CLOSE, 0);
 			} else {
-				/* delete this */
-				n = tpp_que_del_elem(&global_retry_queue, n);
-				rt->global_retry_node = NULL;
-
-				if (strm && rt->strm_retry_node) {
-					tpp_que_del_elem(&strm->retry_queue, rt->strm_retry_node);
-					rt->strm_retry_node = NULL;
+				/*
+				 * in case of non fault tolerant mode
+				 * packet and retry will be deleted in
+				 * postsend handler
+				 */
+				if (tpp_fault_tolerant_mode == 1 && rt->global_retry_node) {
+					deque_retry(rt);
+					enque_retry(pkt, time(0) + TPP_MAX_RETRY_DELAY);
 				}
+			}
+			n = NULL; /* list could be modified by send_retry_packet */
+		} else {
+			/* delete this */
+			n = tpp_que_del_elem(q, n);
+			rt->global_retry_node = NULL;
+			retry_wheel_count--;
 
-				if (rt->sent_to_transport == 0) {
-					tpp_free_pkt(rt->data_pkt); /* for mcast data */
-					tpp_free_pkt(pkt);
-				}
+			if (strm && rt->strm_retry_node) {
+				tpp_que_del_elem(&strm->retry_queue, rt->strm_retry_node);
+				rt->strm_retry_node = NULL;
 			}
-		} else
+
+			if (rt->sent_to_transport == 0) {
+				tpp_free_pkt(rt->data_pkt); /* for mcast data */
+				tpp_free_pkt(pkt);
+			}
+		}
+	}
+	return pending;
+}
+
+/**
+ * @brief
+ *	Walk the slots of the global retry wheel that are due, to send retry
+ *	packets that have send time <= now
+ *
+ * @param[in] now - The current time
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: No
+ *
+ */
+static void
+check_retries(time_t now)
+{
+	int count_sent_to_transport = 0;
+	int rc;
+	time_t t;
+
+	if (retry_wheel_count == 0)
+		return;
+
+	/* every slot is visited once even if we are behind by more than a lap */
+	if (now - retry_wheel_time >= TPP_RETRY_WHEEL_SZ)
+		retry_wheel_time = now - TPP_RETRY_WHEEL_SZ + 1;
+
+	for (t = retry_wheel_time; t <= now; t++) {
+		rc = check_retry_slot(&retry_wheel[t % TPP_RETRY_WHEEL_SZ], now, &count_sent_to_transport);
+		if (rc == -1)
 			break;
+
+		/* slots before the first one still holding due packets are done with */
+		if (rc == 0 && t == retry_wheel_time)
+			retry_wheel_time = t + 1;
 	}
 }
 
@@ -3341,10 +3868,7 @@ del_retries(stream_t *strm)
 
 			rt->strm_retry_node = NULL;
 
-			if (rt->global_retry_node) {
-				tpp_que_del_elem(&global_retry_queue, rt->global_retry_node);
-				rt->global_retry_node = NULL;
-			}
+			deque_retry(rt);
 			rt->acked = 1;
 			if (rt->sent_to_transport == 0) {
 				tpp_free_pkt(rt->data_pkt); /* for mcast packets */
@@ -3406,6 +3930,7 @@ leaf_next_event_expiry(time_t now)
 	ack_info_t *ack;
 	tpp_packet_t *pkt;
 	strm_action_info_t *f;
+	time_t t;
 
 	tpp_lock(&strmarray_lock);
 
@@ -3414,11 +3939,15 @@ leaf_next_event_expiry(time_t now)
 			rc1 = ack->ack_time;
 	}
 
-	if ((n = TPP_QUE_HEAD(&global_retry_queue))) {
-		if ((pkt = TPP_QUE_DATA(n))) {
-			if (pkt->extra_data) {
-				rt = (retry_info_t *) pkt->extra_data;
-				rc2 = rt->retry_time;
+	if (retry_wheel_count > 0) {
+		/* the earliest slot holding packets, could be a later lap */
+		for (t = retry_wheel_time; t < retry_wheel_time + TPP_RETRY_WHEEL_SZ; t++) {
+			if ((n = TPP_QUE_HEAD(&retry_wheel[t % TPP_RETRY_WHEEL_SZ]))) {
+				if ((pkt = TPP_QUE_DATA(n)) && pkt->extra_data) {
+					rt = (retry_info_t *) pkt->extra_data;
+					rc2 = (rt->retry_time < t) ? rt->retry_time : t;
+					break;
+				}
 			}
 		}
 	}
@@ -3446,14 +3975,15 @@ leaf_next_event_expiry(time_t now)
 
 /**
  * @brief
- *	When a prior sent data packet is acked, this function is called to
- *	release it from the list of shelved packets.
+ *	When prior sent data packets are acked, this function is called to
+ *	release them from the list of shelved packets.
  *
  *	Remove from stream's retry queue as well as from the global queue of
  *	retry packets.
  *
- * @param[in] seq_no_acked - The sequence number that was acked
  * @param[in] strm - Pointer to the stream to which ack packet arrived
+ * @param[in] seq_first - The first sequence number that was acked
+ * @param[in] seq_last - The last sequence number that was acked
  *
  * @par Side Effects:
  *	None
@@ -3462,12 +3992,13 @@ leaf_next_event_expiry(time_t now)
  *
  */
 static int
-unshelve_pkt(stream_t *strm, int seq_no_acked)
+unshelve_pkt(stream_t *strm, unsigned int seq_first, unsigned int seq_last)
 {
 	tpp_que_elem_t *n = NULL;
 	retry_info_t *rt;
 	tpp_packet_t *pkt;
 	tpp_data_pkt_hdr_t *dhdr;
+	unsigned int count;
 	/* let go of the hanging data since it is now acked */
 
 	TPP_DBPRT(("release acked: num_unacked = %d", strm->num_unacked_pkts));
@@ -3477,9 +4008,12 @@ unshelve_pkt(stream_t *strm, int seq_no_acked)
 		 * first account for the number of packets on wire
 		 * for flow control
 		 */
-		strm->num_unacked_pkts--;
-		if (strm->num_unacked_pkts < 0)
+		count = seq_range_count(seq_first, seq_last);
+		TPP_STAT_ADD(acks_rcvd, count);
+		if (count >= (unsigned int) strm->num_unacked_pkts)
 			strm->num_unacked_pkts = 0;
+		else
+			strm->num_unacked_pkts -= count;
 		return 0;
 	}
 
@@ -3487,9 +4021,19 @@ unshelve_pkt(stream_t *strm, int seq_no_acked)
 		if ((pkt = TPP_QUE_DATA(n))) {
 			rt = (retry_info_t *) pkt->extra_data;
 			dhdr = (tpp_data_pkt_hdr_t *)(pkt->data + sizeof(int));
-			if (ntohl(dhdr->seq_no) == seq_no_acked) {
+			if (seq_in_range(ntohl(dhdr->seq_no), seq_first, seq_last)) {
 				rt->acked = 1;
-				TPP_DBPRT(("Releasing shelved packet sd=%u seq_no=%d type=%d", strm->sd, seq_no_acked, dhdr->type));
+				TPP_STAT_ADD(acks_rcvd, 1);
+				if (rt->retry_count == 0) {
+					/* resent packets would not say which send got acked */
+					unsigned long long ms = (unsigned long long) (tpp_time_ms() - rt->sent_ms);
+
+					TPP_STAT_ADD(ack_ms_sum, ms);
+					TPP_STAT_ADD(ack_ms_cnt, 1);
+					if (ms > tpp_stats.ack_ms_max)
+						tpp_stats.ack_ms_max = ms;
+				}
+				TPP_DBPRT(("Releasing shelved packet sd=%u seq_no=%u type=%d", strm->sd, ntohl(dhdr->seq_no), dhdr->type));
 
 				strm->num_unacked_pkts--;
 				if (strm->num_unacked_pkts < 0)
@@ -3500,10 +4044,7 @@ unshelve_pkt(stream_t *strm, int seq_no_acked)
 					n = tpp_que_del_elem(&strm->retry_queue, n);
 					rt->strm_retry_node = NULL;
 
-					if (rt->global_retry_node) {
-						tpp_que_del_elem(&global_retry_queue, rt->global_retry_node);
-						rt->global_retry_node = NULL;
-					}
+					deque_retry(rt);
 
 					if (rt->data_pkt) {
 						tpp_free_pkt(rt->data_pkt);
@@ -3511,7 +4052,8 @@ unshelve_pkt(stream_t *strm, int seq_no_acked)
 					}
 					tpp_free_pkt(pkt);
 				} /* else delete will be done by post_send */
-				return 0;
+				if (seq_first == seq_last)
+					return 0;
 			}
 		}
 	}
@@ -3679,7 +4221,7 @@ send_spl_packet(stream_t *strm, int type)
 		strm->send_seq_no = get_next_seq(strm->send_seq_no);
 
 	dhdr.ack_seq = htonl(UNINITIALIZED_INT);
-	dhdr.dup = 0;
+	dhdr.dup = TPP_PKT_ACK_RANGES;
 	memcpy(&dhdr.src_addr, &strm->src_addr, sizeof(tpp_addr_t));
 	memcpy(&dhdr.dest_addr, &strm->dest_addr, sizeof(tpp_addr_t));
 
@@ -3698,46 +4240,6 @@ send_spl_packet(stream_t *strm, int type)
 	return 0;
 }
 
-/**
- * @brief
- *	Helper function to find a key in a stream and match the stream pointers
- *
- * @param[in] strm - The stream to which close packet has to be sent
- *
- * @par Side Effects:
- *	None
- *
- * @par MT-safe: No
- *
- */
-static AVL_IX_REC *
-find_stream_tree_key(stream_t *strm)
-{
-	AVL_IX_REC *pkey;
-
-	pkey = avlkey_create(AVL_streams, &strm->dest_addr);
-	if (pkey == NULL) {
-		sprintf(tpp_get_logbuf(), "Out of memory allocating avlkey for sd=%u", strm->sd);
-		tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
-		return NULL;
-	}
-
-	if (avl_find_key(pkey, AVL_streams) == AVL_IX_OK) {
-		do {
-			stream_t *t_strm;
-
-			t_strm = pkey->recptr;
-			if (strm == t_strm)
-				return pkey;
-
-			if (memcmp(&pkey->key, &strm->dest_addr, sizeof(tpp_addr_t)) != 0)
-				break;
-		} while (avl_next_key(pkey, AVL_streams) == AVL_IX_OK);
-	}
-	free(pkey);
-	return NULL;
-}
-
 /**
  * @brief
  *	Clear all retries, acks and destroy the stream finally
@@ -3773,7 +4275,7 @@ free_stream_resources(stream_t *strm)
 	del_retries(strm);
 	del_acks(strm);
 
-	strmarray[strm->sd].slot_state = TPP_SLOT_DELETED;
+	__atomic_store_n(&STRM_SLOT(strm->sd).slot_state, TPP_SLOT_DELETED, __ATOMIC_RELEASE);
 
 	tpp_unlock(&strmarray_lock);
 
@@ -3809,21 +4311,15 @@ free_stream(unsigned int sd)
 
 	tpp_lock(&strmarray_lock);
 
-	strm = strmarray[sd].strm;
+	strm = STRM_SLOT(sd).strm;
 	if (strm->strm_type != TPP_STRM_MCAST) {
-		AVL_IX_REC *pkey;
-
-		pkey = find_stream_tree_key(strm);
-		if (pkey == NULL) {
+		if (strm_dest_hash_del(strm) != 0) {
 			/* this should not happen ever */
 			sprintf(tpp_get_logbuf(), "Failed finding strm with dest=%s, strm=%p, sd=%u", tpp_netaddr(&strm->dest_addr), strm, strm->sd);
 			tpp_log_func(LOG_ERR, __func__, tpp_get_logbuf());
 			tpp_unlock(&strmarray_lock);
 			return;
 		}
-
-		avl_delete_key(pkey, AVL_streams);
-		free(pkey);
 	}
 
 	/* empty all strm actions from the strm action queue */
@@ -3835,8 +4331,8 @@ free_stream(unsigned int sd)
 		}
 	}
 
-	strmarray[sd].slot_state = TPP_SLOT_FREE;
-	strmarray[sd].strm = NULL;
+	__atomic_store_n(&STRM_SLOT(sd).slot_state, TPP_SLOT_FREE, __ATOMIC_RELEASE);
+	STRM_SLOT(sd).strm = NULL;
 	free(strm);
 
 	if (freed_queue_count < 100) {
@@ -3923,8 +4419,11 @@ leaf_pkt_presend_handler(int tfd, tpp_packet_t *pkt, void *extra)
 
 			/* add an ack packet to the data packet if available */
 			if (ack_no == UNINITIALIZED_INT) {
-				ack_info_t *ack = tpp_deque(&strm->ack_queue);
-				if (ack) {
+				ack_info_t *ack = TPP_QUE_DATA(TPP_QUE_HEAD(&strm->ack_queue));
+
+				/* ack_seq carries a single ack, leave ranges for the ack timer */
+				if (ack && ack->seq_first == ack->seq_no) {
+					tpp_que_del_elem(&strm->ack_queue, ack->strm_ack_node);
 					ack->strm_ack_node = NULL; /* since we dequeued from strm */
 
 					ack_no = ack->seq_no;
@@ -3999,7 +4498,6 @@ leaf_pkt_postsend_handler(int tfd, tpp_packet_t *pkt, void *extra)
 		for (i = 0; i < max_routers; i++) {
 			if (routers[i]->conn_fd == tfd) {
 				routers[i]->state = TPP_ROUTER_STATE_CONNECTED;
-				routers[i]->delay = 0; /* reset connection retry time to 0 */
 				routers[i]->conn_time = time(0); /* record connect time */
 				snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Connected to pbs_comm %s", routers[i]->router_name);
 				tpp_log_func(LOG_CRIT, NULL, tpp_get_logbuf());
@@ -4028,12 +4526,12 @@ leaf_pkt_postsend_handler(int tfd, tpp_packet_t *pkt, void *extra)
 		}
 
 		/* increment number of pkts on the wire, since its not a dup packet */
-		if (data->dup == 0)
+		if ((data->dup & TPP_PKT_DUP) == 0)
 			strm->num_unacked_pkts++;
 
 		/* also shelve the packet now for retrying */
 		if (tpp_fault_tolerant_mode == 1) {
-			data->dup = 1;
+			data->dup |= TPP_PKT_DUP;
 			if (shelve_pkt(pkt, NULL, now + TPP_MAX_RETRY_DELAY) != 0)
 				return -1;
 
@@ -4049,7 +4547,7 @@ leaf_pkt_postsend_handler(int tfd, tpp_packet_t *pkt, void *extra)
 			 * so just fall through to the end
 			 */
 		}
-	} else if (type == TPP_MCAST_DATA) {
+	} else if (type == TPP_MCAST_DATA || type == TPP_MCAST_GROUP_DATA) {
 		/* incr number of unacked packets for each member stream */
 		int i;
 		tpp_mcast_pkt_hdr_t *mcast_hdr = (tpp_mcast_pkt_hdr_t *)(pkt->data + sizeof(int));
@@ -4057,6 +4555,8 @@ leaf_pkt_postsend_handler(int tfd, tpp_packet_t *pkt, void *extra)
 		int info_cmprsd_len = ntohl(mcast_hdr->info_cmprsd_len);
 		int info_len = ntohl(mcast_hdr->info_len);
 		/* int num_streams = ntohl(mcast_hdr->num_streams); */
+		/* a group packet has the group reference ahead of the info */
+		int ref_len = (type == TPP_MCAST_GROUP_DATA) ? sizeof(tpp_mcast_group_ref_t) : 0;
 		void *payload;
 		int payload_len;
 
@@ -4064,11 +4564,11 @@ leaf_pkt_postsend_handler(int tfd, tpp_packet_t *pkt, void *extra)
 		len = ntohl(len); /* overall mcast packet length */
 
 		if (info_cmprsd_len > 0) {
-			payload_len = len - sizeof(tpp_mcast_pkt_hdr_t) - info_cmprsd_len;
-			payload = ((char *) mcast_hdr) + sizeof(tpp_mcast_pkt_hdr_t) + info_cmprsd_len;
+			payload_len = len - sizeof(tpp_mcast_pkt_hdr_t) - ref_len - info_cmprsd_len;
+			payload = ((char *) mcast_hdr) + sizeof(tpp_mcast_pkt_hdr_t) + ref_len + info_cmprsd_len;
 		} else {
-			payload_len = len - sizeof(tpp_mcast_pkt_hdr_t) - info_len;
-			payload = ((char *) mcast_hdr) + sizeof(tpp_mcast_pkt_hdr_t) + info_len;
+			payload_len = len - sizeof(tpp_mcast_pkt_hdr_t) - ref_len - info_len;
+			payload = ((char *) mcast_hdr) + sizeof(tpp_mcast_pkt_hdr_t) + ref_len + info_len;
 		}
 
 		if (tpp_fault_tolerant_mode == 1) {
@@ -4125,7 +4625,7 @@ leaf_pkt_postsend_handler(int tfd, tpp_packet_t *pkt, void *extra)
 		/* let it fall through and free the packet */
 	}
 
-	if (type != TPP_MCAST_DATA)
+	if (type != TPP_MCAST_DATA && type != TPP_MCAST_GROUP_DATA)
 		tpp_clr_retry(pkt, NULL); /* for mcast packet, extra_data is mcast related data */
 
 	tpp_free_pkt(pkt);
@@ -4156,18 +4656,18 @@ check_strm_valid(unsigned int src_sd, tpp_addr_t *dest_addr, int dest_sd)
 {
 	stream_t *strm = NULL;
 
-	if (strmarray == NULL || src_sd >= max_strms) {
+	if (src_sd >= max_strms) {
 		TPP_DBPRT(("Must be data for old instance, ignoring"));
 		return NULL;
 	}
 
-	if (strmarray[src_sd].slot_state != TPP_SLOT_BUSY) {
+	if (STRM_SLOT(src_sd).slot_state != TPP_SLOT_BUSY) {
 		snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Data to sd=%u which is %s", src_sd,
-		         (strmarray[src_sd].slot_state == TPP_SLOT_DELETED ? "deleted":"freed"));
+		         (STRM_SLOT(src_sd).slot_state == TPP_SLOT_DELETED ? "deleted":"freed"));
 		return NULL;
 	}
 
-	strm = strmarray[src_sd].strm;
+	strm = STRM_SLOT(src_sd).strm;
 
 	if (strm->t_state != TPP_TRNS_STATE_OPEN) {
 		snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Data to sd=%u whose transport is not open (t_state=%d)",
@@ -4233,6 +4733,24 @@ leaf_pkt_handler(int tfd, void *data, int len, void *ctx, void *extra)
 			tpp_ctl_pkt_hdr_t *hdr = (tpp_ctl_pkt_hdr_t *) data;
 			int code = hdr->code;
 
+			if (code == TPP_MSG_NOROUTE && ntohl(hdr->src_sd) == UNINITIALIZED_INT && hdr->error_num != 0) {
+				/* not a noroute, but the capabilities of the router */
+				int i;
+
+				for (i = 0; i < max_routers; i++) {
+					if (routers[i]->conn_fd == tfd) {
+						/* a new epoch makes any group registered earlier be registered again */
+						routers[i]->epoch++;
+						routers[i]->caps = (unsigned char) hdr->error_num;
+						snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "pbs_comm %s capabilities 0x%x",
+							routers[i]->router_name, routers[i]->caps);
+						tpp_log_func(LOG_INFO, NULL, tpp_get_logbuf());
+						break;
+					}
+				}
+				return 0;
+			}
+
 			if (code == TPP_MSG_NOROUTE) {
 				unsigned int src_sd = ntohl(hdr->src_sd);
 				strm = get_strm_atomic(src_sd);
@@ -4272,7 +4790,6 @@ leaf_pkt_handler(int tfd, void *data, int len, void *ctx, void *extra)
 
 		case TPP_CTL_LEAVE: {
 			tpp_leave_pkt_hdr_t *hdr = (tpp_leave_pkt_hdr_t *) data;
-			AVL_IX_REC *pkey;
 			tpp_que_t send_close_queue;
 			tpp_addr_t *addrs;
 			int i;
@@ -4286,39 +4803,20 @@ leaf_pkt_handler(int tfd, void *data, int len, void *ctx, void *extra)
 			/* go past the header and point to the list of addresses following it */
 			addrs = (tpp_addr_t *) (((char *) data) + sizeof(tpp_leave_pkt_hdr_t));
 			for(i = 0; i < hdr->num_addrs; i++) {
-				if ((pkey = avlkey_create(AVL_streams, &addrs[i]))) {
-
-					/*
-					 * An avl tree, that allows duplicates, keeps nodes with same
-					 * keys right next to each other, so one find is enough to
-					 * get to the vicinity. Doing avl_next_key continuously as long
-					 * as the keys match, is good enough to find all matching nodes
-					 *
-					 */
-					if (avl_find_key(pkey, AVL_streams) == AVL_IX_OK) {
-						while (1) {
-							strm = pkey->recptr;
-							strm->lasterr = 0;
-
-							/* under lock already, can access directly */
-							if (strmarray[strm->sd].slot_state == TPP_SLOT_BUSY) {
-								if (tpp_enque(&send_close_queue, strm) == NULL) {
-									tpp_log_func(LOG_CRIT, __func__, "Out of memory enqueing to send close queue");
-									tpp_unlock(&strmarray_lock);
-									return -1;
-								}
-							}
-
-							/* if this is the end of the tree, break out */
-							if (avl_next_key(pkey, AVL_streams) != AVL_IX_OK)
-								break;
-
-							/* if the next key in the tree is not the same key, break */
-							if (memcmp(&pkey->key, &addrs[i], sizeof(tpp_addr_t)) != 0)
-								break;
+				/* all streams to this address are in the same hash bucket */
+				for (strm = strm_dest_hash[strm_dest_bucket(&addrs[i])]; strm; strm = strm->dest_hnext) {
+					if (memcmp(&strm->dest_addr, &addrs[i], sizeof(tpp_addr_t)) != 0)
+						continue;
+					strm->lasterr = 0;
+
+					/* under lock already, can access directly */
+					if (STRM_SLOT(strm->sd).slot_state == TPP_SLOT_BUSY) {
+						if (tpp_enque(&send_close_queue, strm) == NULL) {
+							tpp_log_func(LOG_CRIT, __func__, "Out of memory enqueing to send close queue");
+							tpp_unlock(&strmarray_lock);
+							return -1;
 						}
 					}
-					free(pkey);
 				}
 			}
 			tpp_unlock(&strmarray_lock);
@@ -4409,13 +4907,19 @@ leaf_pkt_handler(int tfd, void *data, int len, void *ctx, void *extra)
 			sd = strm->sd;
 
 			if (seq_no_acked != UNINITIALIZED_INT) {
-				unshelve_pkt(strm, seq_no_acked);
+				unsigned int seq_first = seq_no_acked;
+
+				/* a pure ack may cover the range seq_no..ack_seq */
+				if (type != TPP_CLOSE_STRM && sz == 0 && (dup & TPP_PKT_ACK_RANGES))
+					seq_first = seq_no_recvd;
+
+				unshelve_pkt(strm, seq_first, seq_no_acked);
 				/*
 				 * if app u_state == TPP_STRM_STATE_CLOSE means an CLOSE packet was sent out
 				 * and the strm's send_seq_no was the last sequence sent out, and it will not be
 				 * incremented any more. If CLOSE is acked, then queue the stream for deletion
 				 */
-				if (strm->u_state == TPP_STRM_STATE_CLOSE && seq_no_acked == strm->send_seq_no) {
+				if (strm->u_state == TPP_STRM_STATE_CLOSE && seq_in_range(strm->send_seq_no, seq_first, seq_no_acked)) {
 					TPP_DBPRT(("sd=%u PEER acked CLOSE, sending CLOSE to APP", strm->sd));
 					send_pkt_to_app(strm, TPP_CLOSE_STRM, NULL, 0);
 				}
@@ -4425,6 +4929,10 @@ leaf_pkt_handler(int tfd, void *data, int len, void *ctx, void *extra)
 				return 0; /* it is an ack packet, everything is done by now */
 			}
 
+			/* peer tells us it can take ranged acks */
+			if (dup & TPP_PKT_ACK_RANGES)
+				strm->ack_ranges = 1;
+
 			/* always ack data packets, even if duplicate */
 			queue_ack(strm, type, seq_no_recvd);
 
@@ -4488,7 +4996,7 @@ leaf_pkt_handler(int tfd, void *data, int len, void *ctx, void *extra)
 				if ((seq_no_recvd < seq_no_expected && seq_no_diff < MAX_SEQ_NUMBER / 4)
 					|| (seq_no_recvd > seq_no_expected && seq_no_diff > MAX_SEQ_NUMBER / 4)) {
 					/* duplicate packet, drop it, ack was already sent */
-					if (dup > 0) {
+					if (dup & TPP_PKT_DUP) {
 						snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ,
 							"Received duplicate packet with seq_no = %d", seq_no_recvd);
 						tpp_log_func(LOG_DEBUG, NULL, tpp_get_logbuf());
@@ -4614,6 +5122,7 @@ leaf_close_handler(int tfd, int error, void *c, void *extra)
 	last_state = r->state;
 	r->state = TPP_ROUTER_STATE_DISCONNECTED;
 	r->conn_fd = -1;
+	r->caps = 0; /* announced again on the next join */
 
 	if (last_state == TPP_ROUTER_STATE_CONNECTED) {
 		/* log disconnection message */
@@ -4636,20 +5145,20 @@ leaf_close_handler(int tfd, int error, void *c, void *extra)
 				/* send individual net close messages to app */
 				tpp_lock(&strmarray_lock);
 				for (i = 0; i < max_strms; i++) {
-					if (strmarray[i].slot_state == TPP_SLOT_BUSY) {
-						strmarray[i].strm->t_state = TPP_TRNS_STATE_NET_CLOSED;
-						TPP_DBPRT(("net down, sending TPP_CMD_NET_CLOSE sd=%u", strmarray[i].strm->sd));
-						send_app_strm_close(strmarray[i].strm, TPP_CMD_NET_CLOSE, 0);
+					if (STRM_SLOT(i).slot_state == TPP_SLOT_BUSY) {
+						STRM_SLOT(i).strm->t_state = TPP_TRNS_STATE_NET_CLOSED;
+						TPP_DBPRT(("net down, sending TPP_CMD_NET_CLOSE sd=%u", STRM_SLOT(i).strm->sd));
+						send_app_strm_close(STRM_SLOT(i).strm, TPP_CMD_NET_CLOSE, 0);
 					}
 				}
 				tpp_unlock(&strmarray_lock);
 			} else {
 				tpp_lock(&strmarray_lock);
 				for (i = 0; i < max_strms; i++) {
-					if (strmarray[i].slot_state == TPP_SLOT_BUSY) {
-						strmarray[i].strm->t_state = TPP_TRNS_STATE_NET_CLOSED;
-						TPP_DBPRT(("net down, sending TPP_CMD_NET_CLOSE sd=%u", strmarray[i].strm->sd));
-						send_app_strm_close(strmarray[i].strm, TPP_CMD_NET_CLOSE, 0);
+					if (STRM_SLOT(i).slot_state == TPP_SLOT_BUSY) {
+						STRM_SLOT(i).strm->t_state = TPP_TRNS_STATE_NET_CLOSED;
+						TPP_DBPRT(("net down, sending TPP_CMD_NET_CLOSE sd=%u", STRM_SLOT(i).strm->sd));
+						send_app_strm_close(STRM_SLOT(i).strm, TPP_CMD_NET_CLOSE, 0);
 					}
 				}
 				tpp_unlock(&strmarray_lock);
@@ -4661,10 +5170,20 @@ leaf_close_handler(int tfd, int error, void *c, void *extra)
 		}
 	}
 
+	/*
+	 * Back off exponentially while connections keep failing or are dropped
+	 * soon after the join, e.g. when the router refuses joins because many
+	 * leaves are reconnecting to it. Start over once a connection has
+	 * stayed up for a while.
+	 */
+	if (last_state == TPP_ROUTER_STATE_CONNECTED &&
+		(time(0) - r->conn_time) >= TPP_CONNECT_RETRY_MAX)
+		r->delay = 0;
+
 	if (r->delay == 0)
 		r->delay = TPP_CONNNECT_RETRY_MIN;
 	else
-		r->delay += TPP_CONNECT_RETRY_INC;
+		r->delay *= 2;
 
 	if (r->delay > TPP_CONNECT_RETRY_MAX)
 		r->delay = TPP_CONNECT_RETRY_MAX;
@@ -4700,10 +5219,7 @@ tpp_clr_retry(tpp_packet_t *pkt, stream_t *strm)
 {
 	if (pkt->extra_data) {
 		retry_info_t *rt = pkt->extra_data;
-		if (rt->global_retry_node) {
-			tpp_que_del_elem(&global_retry_queue, rt->global_retry_node);
-			rt->global_retry_node = NULL;
-		}
+		deque_retry(rt);
 
 		if (rt->strm_retry_node) {
 			if (strm)
@@ -55,7 +55,9 @@ extern "C" {
 #include "avltree.h"
 #include "log.h"
 
-#if defined (PBS_HAVE_DEVPOLL)
+#if defined (PBS_HAVE_IO_URING)
+#define PBS_USE_IO_URING
+#elif defined (PBS_HAVE_DEVPOLL)
 #define PBS_USE_DEVPOLL
 #elif defined (PBS_HAVE_EPOLL)
 #define PBS_USE_EPOLL
@@ -67,7 +69,13 @@ extern "C" {
 #define PBS_USE_SELECT
 #endif
 
-#if defined (PBS_USE_EPOLL)
+#if defined (PBS_USE_IO_URING)
+
+#include <poll.h>
+#include <stdint.h>
+#include <linux/io_uring.h>
+
+#elif defined (PBS_USE_EPOLL)
 
 #include <sys/epoll.h>
 
@@ -102,6 +110,11 @@ extern "C" {
 #define TPP_CONNNECT_RETRY_MIN	2
 #define TPP_CONNECT_RETRY_INC	2
 #define TPP_CONNECT_RETRY_MAX	10
+/*
+ * joins from directly connected leaves a router accepts per second, further
+ * joins in the same second are refused so the leaves back off and retry
+ */
+#define TPP_MAX_LEAF_JOINS_PER_SEC	512
 #define TPP_THROTTLE_RETRY      5 /* retry time after throttling a packet */
 
 
@@ -134,6 +147,7 @@ typedef struct {
 	char *pos;	/* current position - till which data is consumed */
 	void *extra_data;	/* any additional data */
 	int ref_count;	/* number of accessors */
+	char *pool_blk;	/* data buffer taken from the packet pool, if any */
 } tpp_packet_t;
 
 /*
@@ -194,7 +208,7 @@ typedef struct {
  */
 typedef struct {
 	unsigned char type;        /* type of the packet - TPP_DATA, JOIN etc */
-	unsigned char dup;         /* Is this a duplicate packet? */
+	unsigned char dup;         /* Is this a duplicate packet? (TPP_PKT_* flags) */
 
 	unsigned int src_magic;    /* magic id of source stream */
 	unsigned int cmprsd_len;   /* length of compressed data, 0 if not compressed */
@@ -211,6 +225,15 @@ typedef struct {
 	tpp_addr_t dest_addr; /* dest host address */
 } tpp_data_pkt_hdr_t;
 
+/*
+ * flags carried in the dup field of the data packet header. Older peers only
+ * ever test dup against zero for logging, so the extra bit is ignored by them.
+ */
+#define TPP_PKT_DUP             0x1 /* packet is a resend */
+#define TPP_PKT_ACK_RANGES      0x2 /* on data: sender understands ranged acks,
+				     * on an ack: all of seq_no..ack_seq are acked
+				     */
+
 /*
  * The multicast packet header structure
  */
@@ -238,6 +261,35 @@ typedef struct {
 	tpp_addr_t dest_addr;	/* dest host address of member */
 } tpp_mcast_pkt_info_t;
 
+/*
+ * A multicast group is a set of member streams that a leaf registers once
+ * with the pbs_comm it is connected to (TPP_MCAST_GROUP), so that further
+ * sends to the same set of streams (TPP_MCAST_GROUP_DATA) carry only a
+ * reference to the group and one sequence number per member, instead of
+ * the full member stream info. The reference follows the mcast header in
+ * both packets; in a registration it is followed by the member infos (with
+ * seq_no unset), in a group data packet by the array of member seq numbers
+ * (info_len/info_cmprsd_len of the mcast header describe this array).
+ */
+typedef struct {
+	unsigned int group;	/* slot of the group at the pbs_comm */
+	unsigned int hash;	/* hash of the member infos of the group */
+} tpp_mcast_group_ref_t;
+
+/*
+ * A registered multicast group, as cached at the leaf (per pbs_comm) and
+ * stored at the pbs_comm (per directly connected leaf)
+ */
+typedef struct {
+	unsigned int hash;	/* hash of the member infos */
+	unsigned int epoch;	/* connection epoch the group was registered in (leaf only) */
+	unsigned int num_streams; /* number of member streams, 0 if slot unused */
+	tpp_mcast_pkt_info_t *members; /* member infos, in network byte order */
+} tpp_mcast_group_t;
+
+#define TPP_MCAST_GROUP_SLOTS   16  /* groups registered per leaf connection */
+#define TPP_MCAST_GROUP_MIN     16  /* min members before a group is used */
+
 #define SLOT_INC                1000
 
 #define TPP_SLOT_FREE           0
@@ -255,6 +307,8 @@ enum TPP_MSG_TYPES {
         TPP_MCAST_DATA,
         TPP_GSS_CTX,
         TPP_GSS_WRAP,
+        TPP_MCAST_GROUP,
+        TPP_MCAST_GROUP_DATA,
         TPP_LAST_MSG
 };
 
@@ -262,6 +316,15 @@ enum TPP_MSG_TYPES {
 #define TPP_MSG_UPDATE          2
 #define TPP_MSG_AUTHERR         3
 
+/*
+ * pbs_comm capabilities, announced to a directly connected leaf with a
+ * TPP_MSG_NOROUTE addressed to no stream (src_sd of UNINITIALIZED_INT) and
+ * the capability bits in error_num. Older leaves find no such stream and
+ * ignore the message, whereas an unknown message code would make them drop
+ * the connection.
+ */
+#define TPP_CAP_MCAST_GROUPS    0x1 /* accepts TPP_MCAST_GROUP(_DATA) */
+
 
 #define TPP_STRM_NORMAL         1
 #define TPP_STRM_MCAST          2
@@ -320,6 +383,9 @@ typedef struct {
 	int delay;       /* time delay in re-connecting to the router */
 	int index;		 /* the preference of data going over this connection */
 	AVL_IX_DESC *AVL_my_leaves; /* leaves connected to this router, used by comm only */
+	int caps;        /* TPP_CAP_* announced by router, used by leaf only */
+	unsigned int epoch; /* incremented each time caps are (re)announced */
+	tpp_mcast_group_t *mcast_groups; /* groups registered at router, used by leaf only */
 } tpp_router_t;
 
 /*
@@ -335,6 +401,8 @@ typedef struct {
 
 	int   num_addrs;
 	tpp_addr_t *leaf_addrs; /* list of leaf's addresses */
+
+	tpp_mcast_group_t *mcast_groups; /* groups registered over conn_fd */
 } tpp_leaf_t;
 
 /* routines and headers to manage FIFO queues */
@@ -392,8 +460,45 @@ typedef struct {
 	char tppstaticbuf[TPP_LOGBUF_SZ];
 	void *log_data; /* data created by the logging layer for the TPP threads */
 	void *avl_data; /* data created by the avl tree functions for the TPP threads */
+	tpp_packet_t *pkt_pool; /* free packet structures cached by this thread */
+	int pkt_pool_count;
+	void *buf_pool; /* free small data buffers cached by this thread */
+	int buf_pool_count;
 } tpp_tls_t;
 
+/*
+ * Library wide counters reported by tpp_stats_json(). They are bumped
+ * without taking any lock and only read as a snapshot, so keeping them
+ * costs next to nothing and a dump never stalls the IO threads.
+ */
+typedef struct {
+	unsigned long long pkts_in;	/* packets received on all connections */
+	unsigned long long pkts_out;	/* packets fully written to all connections */
+	unsigned long long bytes_in;
+	unsigned long long bytes_out;
+	unsigned long long send_blocked; /* sends that hit a full socket buffer */
+	unsigned long long retries;	/* data packets re-sent for lack of an ack */
+	unsigned long long acks_sent;	/* standalone ack packets sent */
+	unsigned long long acks_rcvd;	/* data packets acked by the peer */
+	unsigned long long ack_ms_sum;	/* send to ack time of first tries */
+	unsigned long long ack_ms_cnt;
+	unsigned long long ack_ms_max;
+	unsigned long long cmpr_in;	/* bytes handed to deflate */
+	unsigned long long cmpr_out;	/* bytes sent for them */
+	unsigned long long cmpr_skipped; /* deflates abandoned as incompressible */
+} tpp_stats_t;
+
+extern tpp_stats_t tpp_stats;
+
+#if defined(__GNUC__)
+#define TPP_STAT_ADD(f, n) __atomic_fetch_add(&tpp_stats.f, (unsigned long long) (n), __ATOMIC_RELAXED)
+#else
+#define TPP_STAT_ADD(f, n) (tpp_stats.f += (unsigned long long) (n))
+#endif
+
+int tpp_stats_append(char **buf, int *size, int *used, const char *fmt, ...);
+int tpp_transport_stats_json(char **buf, int *size, int *used);
+
 tpp_que_elem_t* tpp_enque(tpp_que_t *l, void *data);
 void *tpp_deque(tpp_que_t *l);
 tpp_que_elem_t* tpp_que_del_elem(tpp_que_t *l, tpp_que_elem_t *n);
@@ -484,6 +589,7 @@ void tpp_add_close_func(int sd, void (*func)(int));
 int tpp_inner_eom(int sd);
 int tpp_set_keep_alive(int fd, struct tpp_config *cnf);
 
+void tpp_set_compression_level(int level);
 void *tpp_deflate(void *inbuf, unsigned int inlen, unsigned int *outlen);
 void *tpp_inflate(void *inbuf, unsigned int inlen, unsigned int totlen);
 void *tpp_multi_deflate_init(int len);
@@ -512,6 +618,7 @@ extern int tpp_dbprt;
 
 void free_router(tpp_router_t *r);
 void free_leaf(tpp_leaf_t *l);
+void tpp_free_mcast_groups(tpp_mcast_group_t *groups);
 
 #ifdef WIN32
 int tr_2_errno(int win_errno);
@@ -523,7 +630,59 @@ int tr_2_errno(int win_errno);
 #define TPP_MAXOPENFD 8192 /*limit for pbs_comm max open files*/
 #define MAX_CON		TPP_MAXOPENFD /* default max connections */
 
-#if defined (PBS_USE_POLL)
+#if defined (PBS_USE_IO_URING)
+
+typedef struct {
+	int fd;
+	int events;
+} em_event_t;
+
+/* per fd registration, indexed by fd */
+typedef struct {
+	int mask;		/* events the fd is monitored for, 0 if not added */
+	unsigned int gen;	/* bumped on every mod/del, stale completions are dropped */
+	int armed;		/* a POLL_ADD is outstanding for (fd, gen) */
+} uring_fd_t;
+
+typedef struct {
+	int ring_fd;
+	unsigned int *sq_head;
+	unsigned int *sq_tail;
+	unsigned int *sq_mask;
+	unsigned int *sq_array;
+	unsigned int sq_entries;
+	struct io_uring_sqe *sqes;
+	unsigned int *cq_head;
+	unsigned int *cq_tail;
+	unsigned int *cq_mask;
+	struct io_uring_cqe *cqes;
+	void *sq_ptr;
+	void *cq_ptr;
+	size_t sq_sz;
+	size_t cq_sz;
+	size_t sqes_sz;
+	unsigned int to_submit;	/* sqes queued but not yet handed to the kernel */
+	uring_fd_t *fds;
+	int fds_sz;
+	uint64_t *rearm;	/* fds that fired in the last wait, armed again on the next */
+	int rearm_cnt;
+	pthread_t owner;	/* thread that last waited, its changes are submitted by its next wait */
+	int has_owner;
+	pthread_mutex_t lock;	/* protects the SQ and the fd table */
+	int max_nfds;
+	pid_t init_pid;
+	em_event_t *events;
+} uring_context_t;
+
+#define EM_GET_FD(ev, i) ev[i].fd
+#define EM_GET_EVENT(ev, i) ev[i].events
+
+#define EM_IN	POLLIN
+#define EM_OUT	POLLOUT
+#define EM_HUP	POLLHUP
+#define EM_ERR	POLLERR
+
+#elif defined (PBS_USE_POLL)
 
 typedef struct {
 	int fd;
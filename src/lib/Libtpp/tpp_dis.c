@@ -585,6 +585,7 @@ DIS_tpp_reset()
 		disr_skip = tppdis_rskip;
 		disr_commit = tppdis_rcommit;
 		disw_commit = tppdis_wcommit;
+		dis_getfmt = NULL;
 	}
 }
 
@@ -870,6 +871,7 @@ set_tpp_config(struct pbs_config *pbs_conf,
 	tpp_conf->node_name = formatted_names;
 	tpp_conf->node_type = TPP_LEAF_NODE;
 	tpp_conf->numthreads = 1;
+	tpp_conf->thread_cpus = NULL;
 
 	/* set authentication method and routines */
 	tpp_conf->auth_type = auth_type;
@@ -888,6 +890,7 @@ set_tpp_config(struct pbs_config *pbs_conf,
 #else
 	tpp_conf->compress = 0;
 #endif
+	tpp_conf->compress_level = pbs_conf->pbs_compression_level;
 
 	/* set default parameters for keepalive */
 	tpp_conf->tcp_keepalive = 1;
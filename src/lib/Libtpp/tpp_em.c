@@ -78,6 +78,12 @@
 #include <sys/eventfd.h>
 #endif
 
+#if defined(PBS_USE_IO_URING)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
 /********************************** START OF MULTIPLEXING CODE *****************************************/
 /**
  * @brief
@@ -109,9 +115,688 @@ tpp_em_wait(void *em_ctx, em_event_t **ev_array, int timeout)
 #endif
 }
 
+/****************************************** Linux io_uring **********************************************/
+
+#if defined(PBS_USE_IO_URING)
+
+/*
+ * io_uring backend. Every monitored fd has a oneshot IORING_OP_POLL_ADD
+ * outstanding in the ring; once it completes the fd is armed again at the
+ * start of the next wait, which keeps the level triggered behavior callers
+ * expect from the epoll backend. Re-arms, adds, mods and deletes made from
+ * the thread that waits on the context are only queued in the submission
+ * ring and get handed to the kernel by the same io_uring_enter() call that
+ * waits for completions, so a busy connection costs one syscall per wakeup.
+ *
+ * The completion user_data carries the fd and a per fd generation number,
+ * which is bumped on every mod/del, so completions of polls that were
+ * modified or removed in the meantime are simply dropped.
+ */
+#define TPP_URING_MIN_ENTRIES	64
+#define TPP_URING_MAX_ENTRIES	4096
+#define TPP_URING_IGNORE	(~((uint64_t) 0))
+#define TPP_URING_DATA(fd, gen)	((((uint64_t) (gen)) << 32) | (uint32_t) (fd))
+#define TPP_URING_FD(data)	((int) ((data) & 0xffffffff))
+#define TPP_URING_GEN(data)	((unsigned int) ((data) >> 32))
+
+static int
+uring_setup(unsigned int entries, struct io_uring_params *p)
+{
+	return (int) syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int
+uring_enter(int ring_fd, unsigned int to_submit, unsigned int min_complete,
+	unsigned int flags, void *arg, size_t argsz)
+{
+	return (int) syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+/**
+ * @brief
+ *	Release the ring mappings and memory of an io_uring context
+ *
+ * @param[in] ctx - The context to free
+ *
+ */
+static void
+uring_free(uring_context_t *ctx)
+{
+	if (ctx->sqes)
+		munmap(ctx->sqes, ctx->sqes_sz);
+	if (ctx->cq_ptr && ctx->cq_ptr != ctx->sq_ptr)
+		munmap(ctx->cq_ptr, ctx->cq_sz);
+	if (ctx->sq_ptr)
+		munmap(ctx->sq_ptr, ctx->sq_sz);
+	if (ctx->ring_fd > -1)
+		close(ctx->ring_fd);
+	free(ctx->fds);
+	free(ctx->rearm);
+	free(ctx->events);
+	free(ctx);
+}
+
+/**
+ * @brief
+ *	Hand all queued submission entries to the kernel without waiting
+ *
+ * @param[in] ctx - The io_uring context, lock held
+ *
+ * @return	Error code
+ * @retval -1	Failure
+ * @retval  0	Success
+ *
+ */
+static int
+uring_submit(uring_context_t *ctx)
+{
+	unsigned int pending;
+	int rc;
+
+	for (;;) {
+		pending = *ctx->sq_tail - __atomic_load_n(ctx->sq_head, __ATOMIC_ACQUIRE);
+		if (pending == 0)
+			return 0;
+		rc = uring_enter(ctx->ring_fd, pending, 0, 0, NULL, 0);
+		if (rc == -1) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		if (rc == 0)
+			return 0;
+	}
+}
+
+/**
+ * @brief
+ *	Get the next free submission entry, flushing the ring if it is full
+ *
+ * @param[in] ctx - The io_uring context, lock held
+ *
+ * @return	The zeroed entry, published by uring_commit()
+ * @retval NULL	Failure
+ *
+ */
+static struct io_uring_sqe *
+uring_get_sqe(uring_context_t *ctx)
+{
+	unsigned int tail = *ctx->sq_tail;
+	unsigned int idx;
+
+	if (tail - __atomic_load_n(ctx->sq_head, __ATOMIC_ACQUIRE) >= ctx->sq_entries) {
+		if (uring_submit(ctx) == -1)
+			return NULL;
+		if (tail - __atomic_load_n(ctx->sq_head, __ATOMIC_ACQUIRE) >= ctx->sq_entries) {
+			errno = EBUSY;
+			return NULL;
+		}
+	}
+	idx = tail & *ctx->sq_mask;
+	memset(&ctx->sqes[idx], 0, sizeof(struct io_uring_sqe));
+	ctx->sq_array[idx] = idx;
+	return &ctx->sqes[idx];
+}
+
+/**
+ * @brief
+ *	Publish the entry returned by the last uring_get_sqe() to the kernel
+ *
+ * @param[in] ctx - The io_uring context, lock held
+ *
+ */
+static void
+uring_commit(uring_context_t *ctx)
+{
+	__atomic_store_n(ctx->sq_tail, *ctx->sq_tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief
+ *	Queue a oneshot poll for fd with its current mask and generation
+ *
+ * @param[in] ctx - The io_uring context, lock held
+ * @param[in] fd - The file descriptor to arm
+ *
+ * @return	Error code
+ * @retval -1	Failure
+ * @retval  0	Success
+ *
+ */
+static int
+uring_arm(uring_context_t *ctx, int fd)
+{
+	struct io_uring_sqe *sqe;
+
+	if ((sqe = uring_get_sqe(ctx)) == NULL)
+		return -1;
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = fd;
+	sqe->poll_events = (unsigned short) ctx->fds[fd].mask;
+	sqe->user_data = TPP_URING_DATA(fd, ctx->fds[fd].gen);
+	uring_commit(ctx);
+	ctx->fds[fd].armed = 1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Cancel the outstanding poll of fd, if any, and bump its generation so
+ *	that a completion already in flight is dropped
+ *
+ * @param[in] ctx - The io_uring context, lock held
+ * @param[in] fd - The file descriptor to disarm
+ *
+ * @return	Error code
+ * @retval -1	Failure
+ * @retval  0	Success
+ *
+ */
+static int
+uring_disarm(uring_context_t *ctx, int fd)
+{
+	struct io_uring_sqe *sqe;
+
+	if (ctx->fds[fd].armed) {
+		if ((sqe = uring_get_sqe(ctx)) == NULL)
+			return -1;
+		sqe->opcode = IORING_OP_POLL_REMOVE;
+		sqe->fd = -1;
+		sqe->addr = TPP_URING_DATA(fd, ctx->fds[fd].gen);
+		sqe->user_data = TPP_URING_IGNORE;
+		uring_commit(ctx);
+		ctx->fds[fd].armed = 0;
+	}
+	ctx->fds[fd].gen++;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Make sure the fd table of the context covers fd
+ *
+ * @param[in] ctx - The io_uring context, lock held
+ * @param[in] fd - The file descriptor
+ *
+ * @return	Error code
+ * @retval -1	Failure
+ * @retval  0	Success
+ *
+ */
+static int
+uring_fd_slot(uring_context_t *ctx, int fd)
+{
+	uring_fd_t *p;
+	int sz;
+
+	if (fd < 0) {
+		errno = EBADF;
+		return -1;
+	}
+	if (fd < ctx->fds_sz)
+		return 0;
+
+	sz = (ctx->fds_sz > 0) ? ctx->fds_sz : TPP_URING_MIN_ENTRIES;
+	while (sz <= fd)
+		sz *= 2;
+	p = realloc(ctx->fds, sz * sizeof(uring_fd_t));
+	if (p == NULL)
+		return -1;
+	memset(p + ctx->fds_sz, 0, (sz - ctx->fds_sz) * sizeof(uring_fd_t));
+	ctx->fds = p;
+	ctx->fds_sz = sz;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Submit the queued entries right away unless the caller is the thread
+ *	that waits on the context, in which case its next wait submits them.
+ *
+ * @param[in] ctx - The io_uring context, lock held
+ *
+ * @return	Error code
+ * @retval -1	Failure
+ * @retval  0	Success
+ *
+ */
+static int
+uring_flush(uring_context_t *ctx)
+{
+	if (!ctx->has_owner || pthread_equal(ctx->owner, pthread_self()))
+		return 0;
+	return uring_submit(ctx);
+}
+
+/**
+ * @brief
+ *	Move completed polls from the completion ring to the event array
+ *
+ * @param[in] ctx - The io_uring context
+ *
+ * @return	Number of events collected
+ *
+ */
+static int
+uring_reap(uring_context_t *ctx)
+{
+	struct io_uring_cqe *cqe;
+	unsigned int head;
+	unsigned int tail;
+	uint64_t data;
+	int fd;
+	int n = 0;
+
+	tpp_lock(&ctx->lock);
+	head = *ctx->cq_head;
+	tail = __atomic_load_n(ctx->cq_tail, __ATOMIC_ACQUIRE);
+	while (head != tail && n < ctx->max_nfds) {
+		cqe = &ctx->cqes[head & *ctx->cq_mask];
+		head++;
+
+		data = cqe->user_data;
+		if (data == TPP_URING_IGNORE)
+			continue;
+		fd = TPP_URING_FD(data);
+		if (fd >= ctx->fds_sz || ctx->fds[fd].mask == 0 || ctx->fds[fd].gen != TPP_URING_GEN(data))
+			continue; /* poll was modified or removed after it was queued */
+
+		ctx->fds[fd].armed = 0;
+		ctx->events[n].fd = fd;
+		ctx->events[n].events = (cqe->res < 0) ? EM_ERR : cqe->res;
+		ctx->rearm[ctx->rearm_cnt++] = data;
+		n++;
+	}
+	__atomic_store_n(ctx->cq_head, head, __ATOMIC_RELEASE);
+	tpp_unlock(&ctx->lock);
+
+	return n;
+}
+
+/**
+ * @brief
+ *	Initialize event monitoring
+ *
+ * @param[in] - max_events - max events that needs to be handled
+ *
+ * @return	Event context
+ * @retval  NULL Failure
+ * @retval !NULL Success
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: yes
+ *
+ */
+void *
+tpp_em_init(int max_events)
+{
+	uring_context_t *ctx;
+	struct io_uring_params p;
+	unsigned int entries;
+	char *sq;
+	char *cq;
+
+	ctx = calloc(1, sizeof(uring_context_t));
+	if (!ctx)
+		return NULL;
+	ctx->ring_fd = -1;
+
+	ctx->events = malloc(sizeof(em_event_t) * max_events);
+	ctx->rearm = malloc(sizeof(uint64_t) * max_events);
+	if (ctx->events == NULL || ctx->rearm == NULL) {
+		uring_free(ctx);
+		return NULL;
+	}
+
+	entries = max_events;
+	if (entries < TPP_URING_MIN_ENTRIES)
+		entries = TPP_URING_MIN_ENTRIES;
+	if (entries > TPP_URING_MAX_ENTRIES)
+		entries = TPP_URING_MAX_ENTRIES;
+
+	memset(&p, 0, sizeof(p));
+	if ((ctx->ring_fd = uring_setup(entries, &p)) == -1) {
+		uring_free(ctx);
+		return NULL;
+	}
+	/* need the timeout/sigmask argument of io_uring_enter and no cqe drops */
+	if (!(p.features & IORING_FEAT_EXT_ARG) || !(p.features & IORING_FEAT_NODROP)) {
+		uring_free(ctx);
+		errno = ENOSYS;
+		return NULL;
+	}
+
+	ctx->sq_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+	ctx->cq_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (ctx->cq_sz > ctx->sq_sz)
+			ctx->sq_sz = ctx->cq_sz;
+		ctx->cq_sz = ctx->sq_sz;
+	}
+
+	sq = mmap(NULL, ctx->sq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ctx->ring_fd, IORING_OFF_SQ_RING);
+	if (sq == MAP_FAILED) {
+		uring_free(ctx);
+		return NULL;
+	}
+	ctx->sq_ptr = sq;
+
+	if (p.features & IORING_FEAT_SINGLE_MMAP)
+		cq = sq;
+	else {
+		cq = mmap(NULL, ctx->cq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ctx->ring_fd, IORING_OFF_CQ_RING);
+		if (cq == MAP_FAILED) {
+			uring_free(ctx);
+			return NULL;
+		}
+	}
+	ctx->cq_ptr = cq;
+
+	ctx->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+	ctx->sqes = mmap(NULL, ctx->sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ctx->ring_fd, IORING_OFF_SQES);
+	if (ctx->sqes == MAP_FAILED) {
+		ctx->sqes = NULL;
+		uring_free(ctx);
+		return NULL;
+	}
+
+	ctx->sq_head = (unsigned int *) (sq + p.sq_off.head);
+	ctx->sq_tail = (unsigned int *) (sq + p.sq_off.tail);
+	ctx->sq_mask = (unsigned int *) (sq + p.sq_off.ring_mask);
+	ctx->sq_array = (unsigned int *) (sq + p.sq_off.array);
+	ctx->sq_entries = p.sq_entries;
+	ctx->cq_head = (unsigned int *) (cq + p.cq_off.head);
+	ctx->cq_tail = (unsigned int *) (cq + p.cq_off.tail);
+	ctx->cq_mask = (unsigned int *) (cq + p.cq_off.ring_mask);
+	ctx->cqes = (struct io_uring_cqe *) (cq + p.cq_off.cqes);
+
+	if (tpp_init_lock(&ctx->lock)) {
+		uring_free(ctx);
+		return NULL;
+	}
+	ctx->max_nfds = max_events;
+	ctx->init_pid = getpid();
+
+	return ((void *) ctx);
+}
+
+/**
+ * @brief
+ *	Destroy event monitoring
+ *
+ * @param[in] ctx - The event monitoring context to destroy
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: yes
+ *
+ */
+void
+tpp_em_destroy(void *em_ctx)
+{
+	uring_context_t *ctx = (uring_context_t *) em_ctx;
+	tpp_destroy_lock(&ctx->lock);
+	uring_free(ctx);
+}
+
+/**
+ * @brief
+ *	Add a file descriptor to the list of descriptors to be monitored for
+ *	events
+ *
+ * @param[in] - em_ctx - The event monitor context
+ * @param[in] - fd - The file descriptor to add to the monitored list
+ * @param[in] - event_mask - A mask of events to monitor the fd for
+ *
+ * @return	Error code
+ * @retval -1	Failure
+ * @retval  0	Success
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+tpp_em_add_fd(void *em_ctx, int fd, int event_mask)
+{
+	uring_context_t *ctx = (uring_context_t *) em_ctx;
+	int rc = -1;
+
+	/*
+	 * if not the process which called em_init, (eg a child process),
+	 * we should not allow manipulating the ring as it is shared with
+	 * the parent process
+	 */
+	if (ctx->init_pid != getpid())
+		return 0;
+
+	tpp_lock(&ctx->lock);
+	if (uring_fd_slot(ctx, fd) == 0) {
+		if (ctx->fds[fd].mask != 0)
+			errno = EEXIST;
+		else {
+			ctx->fds[fd].mask = event_mask;
+			ctx->fds[fd].gen++;
+			if (uring_arm(ctx, fd) == 0 && uring_flush(ctx) == 0)
+				rc = 0;
+			else
+				ctx->fds[fd].mask = 0;
+		}
+	}
+	tpp_unlock(&ctx->lock);
+
+	return rc;
+}
+
+/**
+ * @brief
+ *	Modify a file descriptor to the list of descriptors to be monitored for
+ *	events
+ *
+ * @param[in] - em_ctx - The event monitor context
+ * @param[in] - fd - The file descriptor to add to the monitored list
+ * @param[in] - event_mask - A mask of events to monitor the fd for
+ *
+ * @return	Error code
+ * @retval -1	Failure
+ * @retval  0	Success
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+tpp_em_mod_fd(void *em_ctx, int fd, int event_mask)
+{
+	uring_context_t *ctx = (uring_context_t *) em_ctx;
+	int rc = -1;
+
+	if (ctx->init_pid != getpid())
+		return 0;
+
+	tpp_lock(&ctx->lock);
+	if (fd < 0 || fd >= ctx->fds_sz || ctx->fds[fd].mask == 0)
+		errno = ENOENT;
+	else if (uring_disarm(ctx, fd) == 0) {
+		ctx->fds[fd].mask = event_mask;
+		if (uring_arm(ctx, fd) == 0 && uring_flush(ctx) == 0)
+			rc = 0;
+	}
+	tpp_unlock(&ctx->lock);
+
+	return rc;
+}
+
+/**
+ * @brief
+ *	Remove a file descriptor from the list of descriptors monitored for
+ *	events
+ *
+ * @param[in] - em_ctx - The event monitor context
+ * @param[in] - fd - The file descriptor to add to the monitored list
+ *
+ * @return	Error code
+ * @retval -1	Failure
+ * @retval  0	Success
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+tpp_em_del_fd(void *em_ctx, int fd)
+{
+	uring_context_t *ctx = (uring_context_t *) em_ctx;
+	int rc = -1;
+
+	if (ctx->init_pid != getpid())
+		return 0;
+
+	tpp_lock(&ctx->lock);
+	if (fd < 0 || fd >= ctx->fds_sz || ctx->fds[fd].mask == 0)
+		errno = ENOENT;
+	else {
+		ctx->fds[fd].mask = 0;
+		if (uring_disarm(ctx, fd) == 0 && uring_flush(ctx) == 0)
+			rc = 0;
+	}
+	tpp_unlock(&ctx->lock);
+
+	return rc;
+}
+
+/**
+ * @brief
+ *	Wait for a event to happen on the event context. Waits for the specified
+ *	timeout period.
+ *
+ *	Queued submissions (re-arms of the fds returned by the previous call,
+ *	adds, mods and deletes) are handed to the kernel by the same
+ *	io_uring_enter() that waits. When a sigmask is given they are submitted
+ *	separately first, so that a signal still interrupts the wait with EINTR.
+ *
+ * @param[in] -  em_ctx - The event monitor context
+ * @param[out] - ev_array - Array of events returned
+ * @param[in] - timeout - The timeout in milliseconds to wait for
+ * @param[in] - sigmask - The signal mask to atomically unblock before sleeping
+ *
+ * @return	Number of events returned
+ * @retval -1	Failure
+ * @retval  0	Timeout
+ * @retval >0   Success (some events occured)
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+tpp_em_pwait(void *em_ctx, em_event_t **ev_array, int timeout, const sigset_t *sigmask)
+{
+	uring_context_t *ctx = (uring_context_t *) em_ctx;
+	struct io_uring_getevents_arg arg;
+	struct __kernel_timespec ts;
+	struct timespec now;
+	struct timespec end;
+	unsigned int pending;
+	long long left;
+	int i;
+	int j;
+	int fd;
+	int n;
+	int rc;
+
+	*ev_array = ctx->events;
+
+	if (timeout > 0) {
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		end.tv_sec += timeout / 1000;
+		end.tv_nsec += (long) (timeout % 1000) * 1000000L;
+		if (end.tv_nsec >= 1000000000L) {
+			end.tv_sec++;
+			end.tv_nsec -= 1000000000L;
+		}
+	}
+
+	tpp_lock(&ctx->lock);
+	ctx->owner = pthread_self();
+	ctx->has_owner = 1;
+	/* arm the fds returned last time again, unless they were changed since */
+	for (i = 0; i < ctx->rearm_cnt; i++) {
+		fd = TPP_URING_FD(ctx->rearm[i]);
+		if (fd >= ctx->fds_sz || ctx->fds[fd].mask == 0 || ctx->fds[fd].armed ||
+			ctx->fds[fd].gen != TPP_URING_GEN(ctx->rearm[i]))
+			continue;
+		if (uring_arm(ctx, fd) == -1) {
+			/* keep the rest for the next call */
+			for (j = 0; i < ctx->rearm_cnt; i++, j++)
+				ctx->rearm[j] = ctx->rearm[i];
+			ctx->rearm_cnt = j;
+			tpp_unlock(&ctx->lock);
+			return -1;
+		}
+	}
+	ctx->rearm_cnt = 0;
+	if (sigmask && uring_submit(ctx) == -1) {
+		tpp_unlock(&ctx->lock);
+		return -1;
+	}
+	tpp_unlock(&ctx->lock);
+
+	for (;;) {
+		if ((n = uring_reap(ctx)) > 0 || timeout == 0) {
+			tpp_lock(&ctx->lock);
+			rc = uring_submit(ctx);
+			tpp_unlock(&ctx->lock);
+			return (rc == -1) ? -1 : n;
+		}
+
+		memset(&arg, 0, sizeof(arg));
+		if (sigmask) {
+			arg.sigmask = (uint64_t) (uintptr_t) sigmask;
+			arg.sigmask_sz = _NSIG / 8;
+		}
+		if (timeout > 0) {
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			left = (long long) (end.tv_sec - now.tv_sec) * 1000000000LL + (end.tv_nsec - now.tv_nsec);
+			if (left <= 0) {
+				errno = 0;
+				return 0;
+			}
+			ts.tv_sec = left / 1000000000LL;
+			ts.tv_nsec = left % 1000000000LL;
+			arg.ts = (uint64_t) (uintptr_t) &ts;
+		}
+
+		tpp_lock(&ctx->lock);
+		pending = *ctx->sq_tail - __atomic_load_n(ctx->sq_head, __ATOMIC_ACQUIRE);
+		tpp_unlock(&ctx->lock);
+
+		rc = uring_enter(ctx->ring_fd, pending, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+		if (rc == -1) {
+			if (errno == ETIME) {
+				n = uring_reap(ctx);
+				errno = 0;
+				return n;
+			}
+			return -1;
+		}
+	}
+}
+
 /****************************************** Linux EPOLL ************************************************/
 
-#if defined(PBS_USE_EPOLL)
+#elif defined(PBS_USE_EPOLL)
 /**
  * @brief
  *	Initialize event monitoring
@@ -65,6 +65,7 @@
 #include "rpp.h"
 #include "tpp_common.h"
 #include "tpp_platform.h"
+#include "hostcache.h"
 
 #ifdef WIN32
 
@@ -664,9 +665,11 @@ tpp_sock_resolve_ip(tpp_addr_t *addr, char *host, int len)
 
 	if (addr->family == TPP_ADDR_FAMILY_IPV4) {
 		memcpy(&sa_in.sin_addr, (struct sockaddr_in *) addr->ip, sizeof(sa_in.sin_addr));
-		salen = sizeof(struct sockaddr_in);
-		sa = (struct sockaddr *) &sa_in;
-		sa->sa_family = AF_INET;
+		rc = hostcache_name(sa_in.sin_addr, host, len, 0);
+		if (rc != 0) {
+			TPP_DBPRT(("Error: %s", gai_strerror(rc)));
+		}
+		return rc;
 	} else if (addr->family == TPP_ADDR_FAMILY_IPV6) {
 		memcpy(&sa_in6.sin6_addr, (struct sockaddr_in *) addr->ip, sizeof(sa_in6.sin6_addr));
 		sa = (struct sockaddr *) &sa_in6;
@@ -704,32 +707,22 @@ tpp_sock_resolve_host(char *host, int *count)
 {
 	tpp_addr_t *ips = NULL;
 	void *tmp;
-	int i, j;
-	struct addrinfo *aip, *pai;
-	struct addrinfo hints;
+	int i, j, k;
+	struct in_addr *addrs;
+	int naddrs;
 	int rc = 0;
 
 	errno = 0;
 	*count = 0;
 
-	memset(&hints, 0, sizeof(struct addrinfo));
-	hints.ai_family = AF_INET;
-	hints.ai_socktype = SOCK_STREAM;
-	hints.ai_protocol = IPPROTO_TCP;
-
-	if ((rc = getaddrinfo(host, NULL, &hints, &pai)) != 0) {
+	/* for now only work with IPv4 */
+	if ((rc = hostcache_addrs(host, &addrs, &naddrs)) != 0) {
 		snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Error %d resolving %s\n", rc, host);
 		tpp_log_func(LOG_CRIT, NULL, tpp_get_logbuf());
 		return NULL;
 	}
 
-	*count = 0;
-	for (aip = pai; aip != NULL; aip = aip->ai_next) {
-		if (aip->ai_family == AF_INET) { /* for now only count IPv4 addresses */
-			(*count)++;
-		}
-	}
-
+	*count = naddrs;
 	if (*count == 0) {
 		snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Could not find any usable IP address for host %s", host);
 		tpp_log_func(LOG_CRIT, NULL, tpp_get_logbuf());
@@ -738,40 +731,31 @@ tpp_sock_resolve_host(char *host, int *count)
 
 	ips = calloc(*count, sizeof(tpp_addr_t));
 	if (!ips) {
+		free(addrs);
 		*count = 0;
 		return NULL;
 	}
 
 	i = 0;
-	for (aip = pai; aip != NULL; aip = aip->ai_next) {
-		/* skip non-IPv4 addresses */
-		/*if (aip->ai_family == AF_INET || aip->ai_family == AF_INET6) {*/
-		if (aip->ai_family == AF_INET) { /* for now only work with IPv4 */
-			if (aip->ai_family == AF_INET) {
-				struct sockaddr_in *sa = (struct sockaddr_in *) aip->ai_addr;
-				if (ntohl(sa->sin_addr.s_addr) >> 24 == IN_LOOPBACKNET)
-					continue;
-				memcpy(&ips[i].ip, &sa->sin_addr, sizeof(sa->sin_addr));
-			} else if (aip->ai_family == AF_INET6) {
-				struct sockaddr_in6 *sa6 = (struct sockaddr_in6 *) aip->ai_addr;
-				memcpy(&ips[i].ip, &sa6->sin6_addr, sizeof(sa6->sin6_addr));
-			}
-			ips[i].family = (aip->ai_family == AF_INET6)? TPP_ADDR_FAMILY_IPV6 : TPP_ADDR_FAMILY_IPV4;
-			ips[i].port = 0;
-
-			for(j=0; j < i; j++) {
-				/* check for duplicate ip addresses dont add if duplicate */
-				if (memcmp(&ips[j].ip, &ips[i].ip, sizeof(ips[j].ip)) == 0) {
-					break;
-				}
-			}
-			if (j == i) {
-				/* did not find duplicate so use this slot */
-				i++;
+	for (k = 0; k < naddrs; k++) {
+		if (ntohl(addrs[k].s_addr) >> 24 == IN_LOOPBACKNET)
+			continue;
+		memcpy(&ips[i].ip, &addrs[k], sizeof(addrs[k]));
+		ips[i].family = TPP_ADDR_FAMILY_IPV4;
+		ips[i].port = 0;
+
+		for(j=0; j < i; j++) {
+			/* check for duplicate ip addresses dont add if duplicate */
+			if (memcmp(&ips[j].ip, &ips[i].ip, sizeof(ips[j].ip)) == 0) {
+				break;
 			}
 		}
+		if (j == i) {
+			/* did not find duplicate so use this slot */
+			i++;
+		}
 	}
-	freeaddrinfo(pai);
+	free(addrs);
 
 	if (i == 0) {
 		free(ips);
@@ -100,6 +100,11 @@ AVL_IX_DESC *AVL_cluster_leaves = NULL;
 AVL_IX_DESC *AVL_my_leaves_notify = NULL;
 time_t router_last_leaf_joined = 0;
 
+/* admission control for joins from directly connected leaves */
+static time_t leaf_join_window = 0; /* second the counts below are for */
+static int leaf_join_count = 0;     /* joins accepted in that second */
+static int leaf_join_refused = 0;   /* joins refused in that second */
+
 /* forward declarations */
 static int router_pkt_handler(int phy_fd, void *data, int len, void *c, void *extra);
 static int router_close_handler(int phy_con, int error, void *c, void *extra);
@@ -114,6 +119,287 @@ static int router_post_connect_handler(int tfd, void *data, void *c, void *extra
 /* structure identifying this router */
 static tpp_router_t *this_router = NULL;
 
+/*
+ * Sharded index of the cluster leaves, keyed by leaf address.
+ *
+ * The forwarding paths (TPP_DATA, TPP_CLOSE_STRM, TPP_MCAST_DATA,
+ * TPP_MCAST_GROUP_DATA and TPP_CTL_MSG) only need to map a destination
+ * address to an outgoing fd. They look the leaf up here under the read lock
+ * of the shard that holds the address, so that the transport threads do not
+ * serialize on router_lock. AVL_cluster_leaves remains the authoritative
+ * table and is still maintained under router_lock; the shards are updated
+ * alongside it.
+ *
+ * A leaf's routes (conn_fd and the r[] list) are only changed while holding
+ * the write lock of every shard indexing that leaf, and a leaf is removed
+ * from all its shards before it is freed. Shard locks are always taken in
+ * ascending shard order and are never held while acquiring router_lock.
+ */
+#define TPP_LEAF_SHARDS 64
+#define TPP_LEAF_SHARD_BUCKETS 256
+
+typedef struct leaf_shard_ent {
+	tpp_addr_t addr;
+	tpp_leaf_t *leaf;
+	struct leaf_shard_ent *next;
+} leaf_shard_ent_t;
+
+typedef struct {
+	pthread_rwlock_t lock;
+	leaf_shard_ent_t *bkts[TPP_LEAF_SHARD_BUCKETS];
+} leaf_shard_t;
+
+static leaf_shard_t leaf_shards[TPP_LEAF_SHARDS];
+
+/**
+ * @brief
+ *	Hash a leaf address (FNV-1a over the ip, port and family fields)
+ *
+ * @param[in] addr - address to hash
+ *
+ * @return hash value
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static unsigned int
+leaf_addr_hash(tpp_addr_t *addr)
+{
+	unsigned int hash = 2166136261U;
+	unsigned char *p = (unsigned char *) addr->ip;
+	size_t i;
+
+	for (i = 0; i < sizeof(addr->ip); i++)
+		hash = (hash ^ p[i]) * 16777619U;
+	hash = (hash ^ (unsigned char) (addr->port & 0xff)) * 16777619U;
+	hash = (hash ^ (unsigned char) ((addr->port >> 8) & 0xff)) * 16777619U;
+	hash = (hash ^ (unsigned char) addr->family) * 16777619U;
+
+	return hash;
+}
+
+/**
+ * @brief
+ *	Compare two leaf addresses
+ *
+ * @return 1 if equal, 0 otherwise
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static int
+leaf_addr_equal(tpp_addr_t *a, tpp_addr_t *b)
+{
+	return (memcmp(a->ip, b->ip, sizeof(a->ip)) == 0 &&
+		a->port == b->port && a->family == b->family);
+}
+
+/**
+ * @brief
+ *	Return the bitmask of shards that index any address of the leaf
+ *
+ * @param[in] l - the leaf
+ *
+ * @return bitmask, bit n set for shard n
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static unsigned long long
+leaf_shard_mask(tpp_leaf_t *l)
+{
+	unsigned long long mask = 0;
+	int i;
+
+	for (i = 0; i < l->num_addrs; i++)
+		mask |= 1ULL << (leaf_addr_hash(&l->leaf_addrs[i]) % TPP_LEAF_SHARDS);
+
+	return mask;
+}
+
+/**
+ * @brief
+ *	Write lock (or unlock) the shards given by a bitmask, in ascending order
+ *
+ * @param[in] mask - shards to lock or unlock
+ * @param[in] lock - 1 to write lock, 0 to unlock
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static void
+leaf_shards_wrlock(unsigned long long mask, int lock)
+{
+	int i;
+
+	for (i = 0; i < TPP_LEAF_SHARDS; i++) {
+		if (mask & (1ULL << i)) {
+			if (lock)
+				tpp_wrlock_rwlock(&leaf_shards[i].lock);
+			else
+				tpp_unlock_rwlock(&leaf_shards[i].lock);
+		}
+	}
+}
+
+/**
+ * @brief
+ *	Initialize the leaf shard locks
+ *
+ * @return	Error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ *
+ * @par MT-safe: No
+ *
+ */
+static int
+leaf_shards_init(void)
+{
+	int i;
+
+	memset(leaf_shards, 0, sizeof(leaf_shards));
+	for (i = 0; i < TPP_LEAF_SHARDS; i++) {
+		if (tpp_init_rwlock(&leaf_shards[i].lock) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	Add all addresses of a leaf to the shard index
+ *
+ * @param[in] l - the leaf to add
+ *
+ * @return	Error code
+ * @retval	-1 - Failure (out of memory)
+ * @retval	 0 - Success
+ *
+ * @par MT-safe: Yes (to be called under router_lock)
+ *
+ */
+static int
+leaf_shard_add(tpp_leaf_t *l)
+{
+	unsigned long long mask = leaf_shard_mask(l);
+	leaf_shard_ent_t *ent;
+	unsigned int h;
+	int i;
+	int rc = 0;
+
+	leaf_shards_wrlock(mask, 1);
+	for (i = 0; i < l->num_addrs; i++) {
+		if ((ent = malloc(sizeof(leaf_shard_ent_t))) == NULL) {
+			tpp_log_func(LOG_CRIT, __func__, "Out of memory allocating leaf index entry");
+			rc = -1;
+			break;
+		}
+		h = leaf_addr_hash(&l->leaf_addrs[i]);
+		ent->addr = l->leaf_addrs[i];
+		ent->leaf = l;
+		ent->next = leaf_shards[h % TPP_LEAF_SHARDS].bkts[(h / TPP_LEAF_SHARDS) % TPP_LEAF_SHARD_BUCKETS];
+		leaf_shards[h % TPP_LEAF_SHARDS].bkts[(h / TPP_LEAF_SHARDS) % TPP_LEAF_SHARD_BUCKETS] = ent;
+	}
+	leaf_shards_wrlock(mask, 0);
+
+	return rc;
+}
+
+/**
+ * @brief
+ *	Remove all addresses of a leaf from the shard index. After this returns
+ *	no forwarding thread can reach the leaf, so it may be freed.
+ *
+ * @param[in] l - the leaf to remove
+ *
+ * @par MT-safe: Yes (to be called under router_lock)
+ *
+ */
+static void
+leaf_shard_del(tpp_leaf_t *l)
+{
+	unsigned long long mask = leaf_shard_mask(l);
+	leaf_shard_ent_t **pp;
+	leaf_shard_ent_t *ent;
+	unsigned int h;
+	int i;
+
+	leaf_shards_wrlock(mask, 1);
+	for (i = 0; i < l->num_addrs; i++) {
+		h = leaf_addr_hash(&l->leaf_addrs[i]);
+		pp = &leaf_shards[h % TPP_LEAF_SHARDS].bkts[(h / TPP_LEAF_SHARDS) % TPP_LEAF_SHARD_BUCKETS];
+		while ((ent = *pp)) {
+			if (ent->leaf == l && leaf_addr_equal(&ent->addr, &l->leaf_addrs[i])) {
+				*pp = ent->next;
+				free(ent);
+				break;
+			}
+			pp = &ent->next;
+		}
+	}
+	leaf_shards_wrlock(mask, 0);
+}
+
+/**
+ * @brief
+ *	Set the direct connection fd of a leaf, excluding forwarding readers
+ *
+ * @param[in] l  - the leaf
+ * @param[in] fd - the connection fd, or -1
+ *
+ * @par MT-safe: Yes (to be called under router_lock)
+ *
+ */
+static void
+set_leaf_conn_fd(tpp_leaf_t *l, int fd)
+{
+	unsigned long long mask = leaf_shard_mask(l);
+
+	leaf_shards_wrlock(mask, 1);
+	l->conn_fd = fd;
+	leaf_shards_wrlock(mask, 0);
+}
+
+/**
+ * @brief
+ *	Find the route to a destination leaf for forwarding. Takes only the
+ *	read lock of the shard holding the address, not router_lock.
+ *
+ * @param[in]  dest  - address of the destination leaf
+ * @param[out] found - set to 1 if the leaf is known, 0 otherwise
+ * @param[out] fd    - the fd to send the data on
+ *
+ * @return	The router to send through
+ * @retval	NULL - no route (leaf not found or no connected router)
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static tpp_router_t *
+get_leaf_route(tpp_addr_t *dest, int *found, int *fd)
+{
+	unsigned int h = leaf_addr_hash(dest);
+	leaf_shard_t *shard = &leaf_shards[h % TPP_LEAF_SHARDS];
+	leaf_shard_ent_t *ent;
+	tpp_router_t *r = NULL;
+
+	*found = 0;
+	*fd = -1;
+
+	tpp_rdlock_rwlock(&shard->lock);
+	for (ent = shard->bkts[(h / TPP_LEAF_SHARDS) % TPP_LEAF_SHARD_BUCKETS]; ent; ent = ent->next) {
+		if (leaf_addr_equal(&ent->addr, dest)) {
+			*found = 1;
+			r = get_preferred_router(ent->leaf, this_router, fd);
+			break;
+		}
+	}
+	tpp_unlock_rwlock(&shard->lock);
+
+	return r;
+}
+
 static tpp_router_t *
 alloc_router(char *name, tpp_addr_t *address)
 {
@@ -681,7 +967,11 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 		}
 
 		if (hop == 1) {
-			l->conn_fd = -1; /* reset my direct connection fd to -1 since its closing */
+			set_leaf_conn_fd(l, -1); /* reset my direct connection fd to -1 since its closing */
+
+			/* groups registered over the closing connection go with it */
+			tpp_free_mcast_groups(l->mcast_groups);
+			l->mcast_groups = NULL;
 		}
 
 		if (l->num_routers > 0) {
@@ -692,6 +982,8 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 
 		TPP_DBPRT(("No more pbs_comms to leaf %s, deleting leaf", tpp_netaddr(&l->leaf_addrs[0])));
 
+		leaf_shard_del(l);
+
 		/* delete all of this leaf's addresses from the search tree */
 		for (i = 0; i < l->num_addrs; i++) {
 			rc = tree_add_del(AVL_cluster_leaves, &l->leaf_addrs[i], NULL, TREE_OP_DEL);
@@ -795,6 +1087,8 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 					tree_add_del(AVL_my_leaves_notify, &l->leaf_addrs[0], NULL, TREE_OP_DEL);
 				}
 
+				leaf_shard_del(l);
+
 				for (i = 0; i < l->num_addrs; i++) {
 					rc = tree_add_del(AVL_cluster_leaves, &l->leaf_addrs[i], NULL, TREE_OP_DEL);
 					if (rc != 0) {
@@ -1016,6 +1310,181 @@ router_timer_handler(time_t now)
 	return ret;
 }
 
+/**
+ * @brief
+ *	Deliver a multicast packet to its member streams.
+ *
+ * @par Functionality
+ *	Each member attached to this router gets an individual TPP_DATA packet
+ *	carrying the payload. Members attached to other routers are reached by
+ *	forwarding the multicast packet (mchunks) once to each such router, and
+ *	only if the packet came directly from a leaf (orig_hop == 0).
+ *
+ * @param[in] tfd - The physical connection over which the packet arrived
+ * @param[in] mhdr - The mcast header of the arrived packet
+ * @param[in] orig_hop - The hop count the packet arrived with
+ * @param[in] minfo_base - The (uncompressed) array of member infos
+ * @param[in] num_streams - Number of entries in minfo_base
+ * @param[in] payload - The data to be delivered to each member
+ * @param[in] payload_len - Length of payload
+ * @param[in] mchunks - The multicast packet to forward to other routers
+ * @param[in] num_mchunks - Number of chunks in mchunks
+ *
+ * @return Error code
+ * @retval -1 - Failure, out of memory
+ * @retval  0 - Success
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static int
+mcast_deliver(int tfd, tpp_mcast_pkt_hdr_t *mhdr, unsigned char orig_hop, void *minfo_base, unsigned int num_streams,
+	void *payload, unsigned int payload_len, tpp_chunk_t *mchunks, int num_mchunks)
+{
+	int i, k;
+	tpp_addr_t *src_host = &mhdr->src_addr;
+	int *rlist = NULL;
+	int rsize = 0;
+	int csize = 0;
+	void *tmp;
+	tpp_mcast_pkt_info_t *minfo;
+	tpp_data_pkt_hdr_t shdr;
+	tpp_chunk_t chunks[2];
+	tpp_router_t *target_router = NULL;
+	int target_fd = -1;
+	int found = 0;
+	int already_sent;
+
+	/* set common things here */
+	memset(&shdr, 0, sizeof(tpp_data_pkt_hdr_t)); /* only to satisfy valgrind */
+	shdr.type = TPP_DATA;
+	shdr.ack_seq = htonl(UNINITIALIZED_INT);
+	shdr.dup = 0;
+
+	chunks[0].data = &shdr;
+	chunks[0].len = sizeof(tpp_data_pkt_hdr_t);
+
+	chunks[1].data = payload;
+	chunks[1].len = payload_len;
+
+	/*
+	 * go backwards in an attempt to distribute mcast packet
+	 * first to other routers and then to local nodes
+	 */
+	for (k = num_streams - 1; k >= 0; k--) {
+		tpp_addr_t *dest_host;
+		unsigned int src_sd;
+
+		minfo = (tpp_mcast_pkt_info_t *)(((char *) minfo_base) + k * sizeof(tpp_mcast_pkt_info_t));
+
+		dest_host = &minfo->dest_addr;
+		src_sd = ntohl(minfo->src_sd);
+
+		TPP_DBPRT(("MCAST data on fd=%u", src_sd));
+
+		/* find a router that is still connected */
+		target_router = get_leaf_route(dest_host, &found, &target_fd);
+		if (found == 0) {
+			char msg[TPP_LOGBUF_SZ];
+			snprintf(msg, TPP_LOGBUF_SZ, "pbs_comm:%s: Dest not found at pbs_comm", tpp_netaddr(&this_router->router_addr));
+			log_noroute(src_host, dest_host, src_sd, msg);
+			tpp_send_ctl_msg(tfd, TPP_MSG_NOROUTE, src_host, dest_host, src_sd, 0, msg);
+			continue;
+		}
+
+		if (target_router == NULL) {
+			char msg[TPP_LOGBUF_SZ];
+			snprintf(msg, TPP_LOGBUF_SZ, "pbs_comm:%s: No target pbs_comm found", tpp_netaddr(&this_router->router_addr));
+			log_noroute(src_host, dest_host, src_sd, msg);
+			tpp_send_ctl_msg(tfd, TPP_MSG_NOROUTE, src_host, dest_host, src_sd, 0, msg);
+			continue;
+		}
+
+		if (target_router == this_router) {
+			shdr.src_sd = minfo->src_sd;
+			shdr.src_magic = minfo->src_magic;
+			shdr.dest_sd = minfo->dest_sd;
+			shdr.seq_no = minfo->seq_no;
+			shdr.cmprsd_len = mhdr->data_cmprsd_len;
+			shdr.totlen = mhdr->totlen;
+			memcpy(&shdr.src_addr, &mhdr->src_addr, sizeof(tpp_addr_t));
+			memcpy(&shdr.dest_addr, &minfo->dest_addr, sizeof(tpp_addr_t));
+
+			TPP_DBPRT(("Send mcast indiv packet to %s", tpp_netaddr(&shdr.dest_addr)));
+
+			if (tpp_transport_vsend(target_fd, chunks, 2) != 0) {
+				tpp_log_func(LOG_ERR, __func__, "Failed to send mcast indiv pkt");
+				tpp_transport_close(target_fd);
+				if (rlist)
+					free(rlist);
+				return 0;
+			}
+		} else if (orig_hop == 0) {
+			/* this to list of routers to whom we need to send */
+			if (!rlist) {
+				/* first element */
+				rsize = RLIST_INC;
+				rlist = malloc(sizeof(int) * rsize);
+				if (!rlist) {
+					snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Out of memory allocating pbs_comm list of %lu bytes",
+						(unsigned long)(sizeof(int) * rsize));
+					tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
+					return -1;
+				}
+				csize = 0;
+			}
+
+			/**
+			 * now check list backwards if router already sent to
+			 * rational for checking backwards is that the last router
+			 * that we sent data to, is probably the one that the next
+			 * few nodes are attached to as well.
+			 **/
+			already_sent = 0;
+			for (i = csize - 1; i >= 0; i--) {
+				if (rlist[i] == target_fd) {
+					already_sent = 1;
+					break;
+				}
+			}
+			if (already_sent == 1)
+				continue;
+
+			if (csize == rsize) {
+				/* got to add, but no space */
+				tmp = realloc(rlist, sizeof(int) * (rsize + RLIST_INC));
+				if (!tmp) {
+					free(rlist);
+					snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Out of memory resizing pbs_comm list to %lu bytes",
+						(unsigned long)(sizeof(int) * rsize));
+					tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
+					return -1;
+				}
+				rsize += RLIST_INC;
+				rlist = tmp;
+			}
+			TPP_DBPRT(("Forwarding MCAST to %s", target_router->router_name));
+			if (tpp_transport_vsend(target_fd, mchunks, num_mchunks) != 0) {
+				snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "send failed: errno = %d", errno);
+				tpp_log_func(LOG_ERR, __func__, tpp_get_logbuf());
+
+				tpp_log_func(LOG_ERR, __func__, "Failed to send TPP_MCAST_DATA");
+				tpp_transport_close(target_fd);
+			}
+			/* add this fd to the list of fds already sent to */
+			rlist[csize++] = target_fd;
+		}
+	}
+
+	if (rlist)
+		free(rlist);
+
+	return 0;
+}
+
 /**
  * @brief
  *	Handler function for the router to handle incoming data. When a data
@@ -1045,6 +1514,7 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 	tpp_chunk_t chunks[2];
 	tpp_router_t *target_router = NULL;
 	int target_fd = -1;
+	int found = 0;
 	tpp_addr_t connected_host;
 	tpp_addr_t *addr = tpp_get_connected_host(tfd);
 
@@ -1265,6 +1735,34 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 					}
 				}
 
+				/*
+				 * Limit the rate at which leaves may join directly. When
+				 * a router restarts every leaf reconnects at once, and
+				 * refusing the excess drops those connections, which makes
+				 * the leaves back off and retry at a randomized later time.
+				 */
+				if (hop == 1 && r == this_router) {
+					time_t now = time(0);
+
+					if (now != leaf_join_window) {
+						if (leaf_join_refused > 0) {
+							snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ,
+								"Refused %d leaf joins over the limit of %d per second",
+								leaf_join_refused, TPP_MAX_LEAF_JOINS_PER_SEC);
+							tpp_log_func(LOG_WARNING, NULL, tpp_get_logbuf());
+						}
+						leaf_join_window = now;
+						leaf_join_count = 0;
+						leaf_join_refused = 0;
+					}
+					if (leaf_join_count >= TPP_MAX_LEAF_JOINS_PER_SEC) {
+						leaf_join_refused++;
+						tpp_unlock(&router_lock);
+						return -1;
+					}
+					leaf_join_count++;
+				}
+
 				/* find the leaf */
 				found = 1;
 				l = (tpp_leaf_t *) find_tree(AVL_cluster_leaves, &addrs[0]);
@@ -1308,7 +1806,7 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 						tpp_unlock(&router_lock);
 						return -1;
 					}
-					l->conn_fd = tfd;
+					set_leaf_conn_fd(l, tfd);
 
 					/*
 					 * Set a context only if the JOIN came from a direct connection
@@ -1384,6 +1882,12 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 						tpp_unlock(&router_lock);
 						return -1;
 					}
+
+					/* make the leaf reachable by the forwarding paths */
+					if (leaf_shard_add(l) != 0) {
+						tpp_unlock(&router_lock);
+						return -1;
+					}
 				}
 
 				if (r == this_router) {
@@ -1408,6 +1912,10 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 				}
 
 				if (hop == 1) {
+					/* tell the leaf what this router understands beyond the base protocol */
+					tpp_send_ctl_msg(tfd, TPP_MSG_NOROUTE, &l->leaf_addrs[0], &this_router->router_addr,
+						UNINITIALIZED_INT, TPP_CAP_MCAST_GROUPS, "capabilities");
+
 					/* broadcast to other routers if the hop is 1
 					 * while forwarding to next routers, they will
 					 * see incremented hop and will only update
@@ -1491,28 +1999,183 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 		}
 		break; /* TPP_CTL_LEAVE */
 
+		case TPP_MCAST_GROUP: {
+			/* a leaf registers a multicast group for its later TPP_MCAST_GROUP_DATA */
+			tpp_mcast_pkt_hdr_t *mhdr = (tpp_mcast_pkt_hdr_t *) data;
+			tpp_mcast_group_ref_t *ref = (tpp_mcast_group_ref_t *)((char *) data + sizeof(tpp_mcast_pkt_hdr_t));
+			void *info_start = (char *) ref + sizeof(tpp_mcast_group_ref_t);
+			unsigned int cmprsd_len = ntohl(mhdr->info_cmprsd_len);
+			unsigned int num_streams = ntohl(mhdr->num_streams);
+			unsigned int info_len = ntohl(mhdr->info_len);
+			unsigned int group = ntohl(ref->group);
+			tpp_mcast_group_t *g;
+			tpp_leaf_t *l;
+			void *members;
+
+			if (ctx == NULL || (ctx->type != TPP_LEAF_NODE && ctx->type != TPP_LEAF_NODE_LISTEN) ||
+				group >= TPP_MCAST_GROUP_SLOTS || num_streams == 0 ||
+				info_len != num_streams * sizeof(tpp_mcast_pkt_info_t) ||
+				len < (int) (sizeof(tpp_mcast_pkt_hdr_t) + sizeof(tpp_mcast_group_ref_t) + (cmprsd_len > 0 ? cmprsd_len : info_len))) {
+				snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "tfd=%d, Invalid mcast group registration from %s",
+					tfd, tpp_netaddr(&connected_host));
+				tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
+				return -1;
+			}
+			l = (tpp_leaf_t *) ctx->ptr;
+
+			if (cmprsd_len > 0) {
+				members = tpp_inflate(info_start, cmprsd_len, info_len);
+				if (members == NULL) {
+					tpp_log_func(LOG_CRIT, __func__, "Decompression of mcast group failed");
+					return -1;
+				}
+			} else {
+				members = malloc(info_len);
+				if (members == NULL) {
+					snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Out of memory allocating mcast group of %u bytes", info_len);
+					tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
+					return -1;
+				}
+				memcpy(members, info_start, info_len);
+			}
+
+			if (l->mcast_groups == NULL) {
+				l->mcast_groups = calloc(TPP_MCAST_GROUP_SLOTS, sizeof(tpp_mcast_group_t));
+				if (l->mcast_groups == NULL) {
+					free(members);
+					tpp_log_func(LOG_CRIT, __func__, "Out of memory allocating mcast groups");
+					return -1;
+				}
+			}
+
+			g = &l->mcast_groups[group];
+			free(g->members);
+			g->members = members;
+			g->num_streams = num_streams;
+			g->hash = ntohl(ref->hash);
+
+			snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "tfd=%d, MCAST group %u registered by %s, %u member streams",
+				tfd, group, tpp_netaddr(&mhdr->src_addr), num_streams);
+			tpp_log_func(LOG_DEBUG, NULL, tpp_get_logbuf());
+			return 0;
+		}
+		break; /* TPP_MCAST_GROUP */
+
+		case TPP_MCAST_GROUP_DATA: {
+			/* expand a multicast to a registered group, using the per member seq numbers sent */
+			tpp_mcast_pkt_hdr_t *mhdr = (tpp_mcast_pkt_hdr_t *) data;
+			tpp_mcast_group_ref_t *ref = (tpp_mcast_group_ref_t *)((char *) data + sizeof(tpp_mcast_pkt_hdr_t));
+			void *info_start = (char *) ref + sizeof(tpp_mcast_group_ref_t);
+			unsigned int cmprsd_len = ntohl(mhdr->info_cmprsd_len);
+			unsigned int num_streams = ntohl(mhdr->num_streams);
+			unsigned int info_len = ntohl(mhdr->info_len);
+			unsigned int group = ntohl(ref->group);
+			tpp_mcast_pkt_hdr_t fhdr;
+			tpp_mcast_pkt_info_t *minfo_base;
+			tpp_mcast_group_t *g = NULL;
+			tpp_chunk_t mchunks[3];
+			unsigned int *seqs;
+			unsigned int payload_len;
+			void *payload;
+			unsigned int k;
+			int rc;
+
+			if (ctx == NULL || (ctx->type != TPP_LEAF_NODE && ctx->type != TPP_LEAF_NODE_LISTEN) ||
+				group >= TPP_MCAST_GROUP_SLOTS || info_len != num_streams * sizeof(unsigned int) ||
+				len < (int) (sizeof(tpp_mcast_pkt_hdr_t) + sizeof(tpp_mcast_group_ref_t) + (cmprsd_len > 0 ? cmprsd_len : info_len))) {
+				snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "tfd=%d, Invalid mcast group packet from %s",
+					tfd, tpp_netaddr(&connected_host));
+				tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
+				return -1;
+			}
+
+			if (((tpp_leaf_t *) ctx->ptr)->mcast_groups)
+				g = &((tpp_leaf_t *) ctx->ptr)->mcast_groups[group];
+
+			if (g == NULL || g->num_streams != num_streams || g->hash != ntohl(ref->hash)) {
+				/* the member streams retry the data as individual packets */
+				snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ,
+					"tfd=%d, MCAST packet from %s for unknown group %u, %u member streams, dropped",
+					tfd, tpp_netaddr(&mhdr->src_addr), group, num_streams);
+				tpp_log_func(LOG_ERR, NULL, tpp_get_logbuf());
+				return 0;
+			}
+
+			if (cmprsd_len > 0) {
+				payload_len = len - sizeof(tpp_mcast_pkt_hdr_t) - sizeof(tpp_mcast_group_ref_t) - cmprsd_len;
+				payload = (char *) info_start + cmprsd_len;
+				seqs = tpp_inflate(info_start, cmprsd_len, info_len);
+				if (seqs == NULL) {
+					tpp_log_func(LOG_CRIT, __func__, "Decompression of mcast seqs failed");
+					return -1;
+				}
+			} else {
+				payload_len = len - sizeof(tpp_mcast_pkt_hdr_t) - sizeof(tpp_mcast_group_ref_t) - info_len;
+				payload = (char *) info_start + info_len;
+				seqs = info_start;
+			}
+
+			snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ,
+				"tfd=%d, MCAST packet from %s, group %u, %u member streams, cmprsd_len=%d, info_len=%d, len=%d",
+				tfd, tpp_netaddr(&mhdr->src_addr), group, num_streams, cmprsd_len, info_len, payload_len);
+			tpp_log_func(LOG_INFO, NULL, tpp_get_logbuf());
+
+			minfo_base = malloc(num_streams * sizeof(tpp_mcast_pkt_info_t));
+			if (minfo_base == NULL) {
+				if (cmprsd_len > 0)
+					free(seqs);
+				tpp_log_func(LOG_CRIT, __func__, "Out of memory expanding mcast group");
+				return -1;
+			}
+			memcpy(minfo_base, g->members, num_streams * sizeof(tpp_mcast_pkt_info_t));
+			for (k = 0; k < num_streams; k++)
+				minfo_base[k].seq_no = seqs[k]; /* already in network order */
+
+			if (cmprsd_len > 0)
+				free(seqs);
+
+			/*
+			 * members attached to other routers are reached with a
+			 * regular multicast packet, which every router understands
+			 */
+			memcpy(&fhdr, mhdr, sizeof(tpp_mcast_pkt_hdr_t));
+			fhdr.type = TPP_MCAST_DATA;
+			fhdr.hop = 1;
+			fhdr.info_len = htonl(num_streams * sizeof(tpp_mcast_pkt_info_t));
+			fhdr.info_cmprsd_len = 0;
+
+			mchunks[0].data = &fhdr;
+			mchunks[0].len = sizeof(tpp_mcast_pkt_hdr_t);
+			mchunks[1].data = minfo_base;
+			mchunks[1].len = num_streams * sizeof(tpp_mcast_pkt_info_t);
+			mchunks[2].data = payload;
+			mchunks[2].len = payload_len;
+
+			rc = mcast_deliver(tfd, mhdr, mhdr->hop, minfo_base, num_streams, payload, payload_len, mchunks, 3);
+			free(minfo_base);
+
+			if (rc == 0)
+				tpp_log_func(LOG_INFO, NULL, "mcast done");
+
+			return rc;
+		}
+		break; /* TPP_MCAST_GROUP_DATA */
+
 		case TPP_MCAST_DATA: {
-			int i, k;
 			tpp_addr_t *src_host;
-			int *rlist = NULL;
-			int rsize = 0;
-			int csize = 0;
-			void *tmp;
 
 			/* find the fd to forward to via the associated router */
 			tpp_mcast_pkt_hdr_t *mhdr = (tpp_mcast_pkt_hdr_t *) data;
 			unsigned char orig_hop;
-			tpp_mcast_pkt_info_t *minfo;
 			void *minfo_base = NULL;
 			void *info_start = (char *) data + sizeof(tpp_mcast_pkt_hdr_t);
-			tpp_data_pkt_hdr_t shdr;
 			unsigned int payload_len;
 			void *payload;
 			unsigned int cmprsd_len = ntohl(mhdr->info_cmprsd_len);
 			unsigned int num_streams = ntohl(mhdr->num_streams);
 			unsigned int info_len = ntohl(mhdr->info_len);
 			tpp_chunk_t mchunks[1];
-			int already_sent;
+			int rc;
 
 			if (cmprsd_len > 0) {
 				payload_len = len - sizeof(tpp_mcast_pkt_hdr_t) - cmprsd_len;
@@ -1531,18 +2194,6 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 				tfd, tpp_netaddr(src_host), num_streams, cmprsd_len, info_len, payload_len);
 			tpp_log_func(LOG_INFO, NULL, tpp_get_logbuf());
 
-			/* set common things here */
-			memset(&shdr, 0, sizeof(tpp_data_pkt_hdr_t)); /* only to satisfy valgrind */
-			shdr.type = TPP_DATA;
-			shdr.ack_seq = htonl(UNINITIALIZED_INT);
-			shdr.dup = 0;
-
-			chunks[0].data = &shdr;
-			chunks[0].len = sizeof(tpp_data_pkt_hdr_t);
-
-			chunks[1].data = payload;
-			chunks[1].len = payload_len;
-
 #ifdef PBS_COMPRESSION_ENABLED
 			if (cmprsd_len > 0) {
 				minfo_base = tpp_inflate(info_start, cmprsd_len, info_len);
@@ -1557,141 +2208,20 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 			mchunks[0].data = data;
 			mchunks[0].len = len;
 
-			/*
-			 * go backwards in an attempt to distribute mcast packet
-			 * first to other routers and then to local nodes
-			 */
-			for (k = num_streams - 1; k >= 0; k--) {
-				tpp_addr_t *dest_host;
-				unsigned int src_sd;
-				tpp_leaf_t *l;
-
-				minfo = (tpp_mcast_pkt_info_t *)(((char *) minfo_base) + k * sizeof(tpp_mcast_pkt_info_t));
-
-				dest_host = &minfo->dest_addr;
-				src_sd = ntohl(minfo->src_sd);
+			rc = mcast_deliver(tfd, mhdr, orig_hop, minfo_base, num_streams, payload, payload_len, mchunks, 1);
 
-				TPP_DBPRT(("MCAST data on fd=%u", src_sd));
-
-				tpp_lock(&router_lock);
-				l = find_tree(AVL_cluster_leaves, dest_host);
-				if (l == NULL) {
-					char msg[TPP_LOGBUF_SZ];
-					tpp_unlock(&router_lock);
-					snprintf(msg, TPP_LOGBUF_SZ, "pbs_comm:%s: Dest not found at pbs_comm", tpp_netaddr(&this_router->router_addr));
-					log_noroute(src_host, dest_host, src_sd, msg);
-					tpp_send_ctl_msg(tfd, TPP_MSG_NOROUTE, src_host, dest_host, src_sd, 0, msg);
-					continue;
-				}
-
-				/* find a router that is still connected */
-				target_router = get_preferred_router(l, this_router, &target_fd);
-				tpp_unlock(&router_lock);
-
-				if (target_router == NULL) {
-					char msg[TPP_LOGBUF_SZ];
-					snprintf(msg, TPP_LOGBUF_SZ, "pbs_comm:%s: No target pbs_comm found", tpp_netaddr(&this_router->router_addr));
-					log_noroute(src_host, dest_host, src_sd, msg);
-					tpp_send_ctl_msg(tfd, TPP_MSG_NOROUTE, src_host, dest_host, src_sd, 0, msg);
-					continue;
-				}
-
-				if (target_router == this_router) {
-					shdr.src_sd = minfo->src_sd;
-					shdr.src_magic = minfo->src_magic;
-					shdr.dest_sd = minfo->dest_sd;
-					shdr.seq_no = minfo->seq_no;
-					shdr.cmprsd_len = mhdr->data_cmprsd_len;
-					shdr.totlen = mhdr->totlen;
-					memcpy(&shdr.src_addr, &mhdr->src_addr, sizeof(tpp_addr_t));
-					memcpy(&shdr.dest_addr, &minfo->dest_addr, sizeof(tpp_addr_t));
-
-					TPP_DBPRT(("Send mcast indiv packet to %s", tpp_netaddr(&shdr.dest_addr)));
-
-					if (tpp_transport_vsend(target_fd, chunks, 2) != 0) {
-						tpp_log_func(LOG_ERR, __func__, "Failed to send mcast indiv pkt");
-						tpp_transport_close(target_fd);
-						if (rlist)
-							free(rlist);
-						if (cmprsd_len > 0)
-							free(minfo_base);
-						return 0;
-					}
-				} else if (orig_hop == 0) {
-					/* this to list of routers to whom we need to send */
-					if (!rlist) {
-						/* first element */
-						rsize = RLIST_INC;
-						rlist = malloc(sizeof(int) * rsize);
-						if (!rlist) {
-							if (cmprsd_len > 0)
-								free(minfo_base);
-							snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Out of memory allocating pbs_comm list of %lu bytes",
-								(unsigned long)(sizeof(int) * rsize));
-							tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
-							return -1;
-						}
-						csize = 0;
-					}
-
-					/**
-					 * now check list backwards if router already sent to
-					 * rational for checking backwards is that the last router
-					 * that we sent data to, is probably the one that the next
-					 * few nodes are attached to as well.
-					 **/
-					already_sent = 0;
-					for (i = csize - 1; i >= 0; i--) {
-						if (rlist[i] == target_fd) {
-							already_sent = 1;
-							break;
-						}
-					}
-					if (already_sent == 1)
-						continue;
-
-					if (csize == rsize) {
-						/* got to add, but no space */
-						tmp = realloc(rlist, sizeof(int) * (rsize + RLIST_INC));
-						if (!tmp) {
-							free(rlist);
-							if (cmprsd_len > 0)
-								free(minfo_base);
-							snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Out of memory resizing pbs_comm list to %lu bytes",
-								(unsigned long)(sizeof(int) * rsize));
-							tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
-							return -1;
-						}
-						rsize += RLIST_INC;
-						rlist = tmp;
-					}
-					TPP_DBPRT(("Forwarding MCAST to %s", target_router->router_name));
-					if (tpp_transport_vsend(target_fd, mchunks, 1) != 0) {
-						snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "send failed: errno = %d", errno);
-						tpp_log_func(LOG_ERR, __func__, tpp_get_logbuf());
-
-						tpp_log_func(LOG_ERR, __func__, "Failed to send TPP_MCAST_DATA");
-						tpp_transport_close(target_fd);
-					}
-					/* add this fd to the list of fds already sent to */
-					rlist[csize++] = target_fd;
-				}
-			}
 			if (cmprsd_len > 0)
 				free(minfo_base);
 
-			if (rlist)
-				free(rlist);
-
-			tpp_log_func(LOG_INFO, NULL, "mcast done");
+			if (rc == 0)
+				tpp_log_func(LOG_INFO, NULL, "mcast done");
 
-			return 0;
+			return rc;
 		}
 		break; /* TPP_MCAST_DATA */
 
 		case TPP_DATA:
 		case TPP_CLOSE_STRM: {
-			tpp_leaf_t *l;
 			tpp_addr_t *src_host, *dest_host;
 			unsigned int src_sd;
 			tpp_data_pkt_hdr_t *dhdr = (tpp_data_pkt_hdr_t *) data;
@@ -1700,23 +2230,16 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 			dest_host = &dhdr->dest_addr;
 			src_sd = ntohl(dhdr->src_sd);
 
-			tpp_lock(&router_lock);
-
-			l = find_tree(AVL_cluster_leaves, dest_host);
-			if (l == NULL) {
+			/* find a router that is still connected */
+			target_router = get_leaf_route(dest_host, &found, &target_fd);
+			if (found == 0) {
 				char msg[TPP_LOGBUF_SZ];
-				tpp_unlock(&router_lock);
-
 				snprintf(msg, TPP_LOGBUF_SZ, "tfd=%d, pbs_comm:%s: Dest not found", tfd, tpp_netaddr(&this_router->router_addr));
 				log_noroute(src_host, dest_host, src_sd, msg);
 				tpp_send_ctl_msg(tfd, TPP_MSG_NOROUTE, src_host, dest_host, src_sd, 0, msg);
 				return 0;
 			}
 
-			/* find a router that is still connected */
-			target_router = get_preferred_router(l, this_router, &target_fd);
-
-			tpp_unlock(&router_lock);
 			if (target_router == NULL) {
 				char msg[TPP_LOGBUF_SZ];
 				snprintf(msg, TPP_LOGBUF_SZ, "tfd=%d, pbs_comm:%s: No target pbs_comm found", tfd, tpp_netaddr(&this_router->router_addr));
@@ -1749,7 +2272,6 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 
 		case TPP_CTL_MSG: {
 			tpp_ctl_pkt_hdr_t *ehdr = (tpp_ctl_pkt_hdr_t *) data;
-			tpp_leaf_t *l;
 			int subtype = ehdr->code;
 
 			if (subtype == TPP_MSG_NOROUTE) {
@@ -1763,17 +2285,11 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 				tpp_log_func(LOG_WARNING, __func__, tpp_get_logbuf());
 
 				/* find the fd to forward to via the associated router */
-				tpp_lock(&router_lock);
-
-				l = find_tree(AVL_cluster_leaves, dest_host);
-				if (l == NULL) {
-					tpp_unlock(&router_lock);
-					return 0;
-				}
 				/* find a router that is still connected */
-				target_router = get_preferred_router(l, this_router, &target_fd);
+				target_router = get_leaf_route(dest_host, &found, &target_fd);
+				if (found == 0)
+					return 0;
 
-				tpp_unlock(&router_lock);
 				if (target_router == NULL) {
 					snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "tfd=%d, No connections to send TPP_CTL_NOROUTE", tfd);
 					tpp_log_func(LOG_WARNING, NULL, tpp_get_logbuf());
@@ -1880,6 +2396,7 @@ static tpp_router_t *
 del_router_from_leaf(tpp_leaf_t *l, int tfd)
 {
 	int i;
+	unsigned long long mask;
 	tpp_router_t *r = NULL;
 
 	for (i = 0; i < l->tot_routers; i++) {
@@ -1887,11 +2404,17 @@ del_router_from_leaf(tpp_leaf_t *l, int tfd)
 			((l->r[i]->conn_fd == tfd) || /* router fd matches tfd */
 			(l->conn_fd == tfd && l->r[i]->conn_fd == -1))) {
 			TPP_DBPRT(("Removing pbs_comm %s from leaf %s", l->r[i]->router_name, tpp_netaddr(&l->leaf_addrs[0])));
+			mask = leaf_shard_mask(l);
+			leaf_shards_wrlock(mask, 1);
 			r = l->r[i];
 			l->r[i] = NULL;
 			l->num_routers--;
-			if (l->num_routers == 0)
+			if (l->num_routers == 0) {
 				free(l->r);
+				l->r = NULL;
+				l->tot_routers = 0;
+			}
+			leaf_shards_wrlock(mask, 0);
 			TPP_DBPRT(("pbs_comm count for leaf=%s is %d", tpp_netaddr(&l->leaf_addrs[0]), l->num_routers));
 			return r;
 		}
@@ -1921,6 +2444,8 @@ del_router_from_leaf(tpp_leaf_t *l, int tfd)
 static int
 add_route_to_leaf(tpp_leaf_t *l, tpp_router_t *r, int index)
 {
+	unsigned long long mask;
+
 	/*
 	 * Associate the router with the leaf
 	 *
@@ -1931,6 +2456,10 @@ add_route_to_leaf(tpp_leaf_t *l, tpp_router_t *r, int index)
 	if (index == -1)
 		return -1; /* error - index must be set before calling add route */
 
+	/* keep forwarding threads off the route list while it changes */
+	mask = leaf_shard_mask(l);
+	leaf_shards_wrlock(mask, 1);
+
 	if (index >= l->tot_routers) {
 		int sz;
 		int i;
@@ -1945,6 +2474,8 @@ add_route_to_leaf(tpp_leaf_t *l, tpp_router_t *r, int index)
 	l->r[index] = r;
 	l->num_routers++;
 
+	leaf_shards_wrlock(mask, 0);
+
 #ifdef DEBUG
 	{
 		int i;
@@ -2033,6 +2564,9 @@ tpp_init_router(struct tpp_config *cnf)
 
 	tpp_init_lock(&router_lock);
 
+	if (leaf_shards_init() != 0)
+		return -1;
+
 	AVL_routers = create_tree(AVL_NO_DUP_KEYS, sizeof(tpp_addr_t));
 	if (AVL_routers == NULL) {
 		tpp_log_func(LOG_CRIT, __func__, "Failed to create AVL tree for pbs comms");
@@ -70,6 +70,13 @@
 #include <netdb.h>
 #include <sys/time.h>
 #include <signal.h>
+#ifndef WIN32
+#include <sys/uio.h>
+#endif
+#ifdef linux
+#include <sched.h>
+#include <ifaddrs.h>
+#endif
 
 #include "rpp.h"
 #include "tpp_common.h"
@@ -80,6 +87,23 @@
 #define TPP_CONN_CONNECTING     3 /* Channel is connecting */
 #define TPP_CONN_CONNECTED      4 /* Channel is connected */
 
+#define TPP_PKT_ALIGN           8  /* alignment of packets handed up from the scratch area */
+#define TPP_SEND_IOV_MAX        64 /* max packets gathered into one writev() */
+
+/*
+ * Send scheduling. Packets queued on a connection are split into a control
+ * class (control messages, acks and data packets of up to TPP_SEND_SIZE,
+ * i.e. IS/IM requests, obits, run-job replies) and a bulk class (larger data
+ * and multicast packets, such as job scripts and hook files). Control packets
+ * always go out first; bulk packets are hashed by stream into buckets that
+ * share the rest of the bandwidth by deficit round robin. Only a small window
+ * of packets is committed to the socket ahead of the scheduler, since a
+ * packet that has started going out must complete before any other.
+ */
+#define TPP_SENDQ_FLOWS         16 /* stream buckets of the bulk class */
+#define TPP_SENDQ_QUANTUM       (8 * TPP_SEND_SIZE) /* bytes granted to a bulk bucket per round */
+#define TPP_SENDQ_WINDOW        (8 * TPP_SEND_SIZE) /* max control bytes committed to the socket */
+
 int tpp_going_down = 0;
 
 /*
@@ -186,7 +210,25 @@ typedef struct {
 	conn_param_t *conn_params; /* the connection params */
 
 	unsigned long send_queue_size;  /* total bytes waiting on send queue */
-	tpp_que_t send_queue;      /* queue of pkts to send */
+	tpp_que_t send_queue;      /* queue of pkts committed to the socket, in wire order */
+	unsigned long send_commit_size; /* bytes committed on send_queue */
+
+	tpp_que_t ctl_queue;       /* control class pkts, not yet committed */
+	tpp_que_t bulk_queue[TPP_SENDQ_FLOWS]; /* bulk class pkts, per stream bucket */
+	long bulk_deficit[TPP_SENDQ_FLOWS]; /* deficit round robin counters */
+	int bulk_next;             /* bulk bucket currently being served */
+	int bulk_pkts;             /* pkts waiting in the bulk buckets */
+
+	/* statistics, written by the IO thread only, see tpp_stats_json() */
+	unsigned long send_queue_max;   /* high watermark of send_queue_size */
+	int send_queue_pkts;            /* packets waiting on send queue */
+	unsigned long long pkts_in;
+	unsigned long long pkts_out;
+	unsigned long long bytes_in;
+	unsigned long long bytes_out;
+	unsigned long long send_blocked; /* sends that would have blocked */
+	unsigned long long send_expedited; /* control pkts sent ahead of waiting bulk pkts */
+
 	tpp_packet_t scratch;      /* scratch to work on incoming data */
 	thrd_data_t *td;                  /* connections controller thread */
 
@@ -216,7 +258,12 @@ static int assign_to_worker(int tfd, int delay, thrd_data_t *td);
 static int handle_disconnect(phy_conn_t *conn);
 static void handle_incoming_data(phy_conn_t *conn);
 static void send_data(phy_conn_t *conn);
+#if !defined(WIN32) && !defined(NAS)
+static void send_data_batched(phy_conn_t *conn);
+#endif
 static void free_phy_conn(phy_conn_t *conn);
+static int sched_enque(phy_conn_t *conn, tpp_packet_t *pkt);
+static void sched_commit(phy_conn_t *conn);
 static void handle_cmd(thrd_data_t *td, int tfd, int cmd, void *data);
 static int add_pkts(phy_conn_t *conn);
 static phy_conn_t *get_transport_atomic(int tfd, int *slot_state);
@@ -461,6 +508,174 @@ tpp_cr_server_socket(int port)
 	return sd;
 }
 
+#ifdef linux
+/**
+ * @brief
+ *	Parse a cpu list in the kernel's format, e.g. "0-3,8,10-11"
+ *
+ * @param[in]  list - the cpu list
+ * @param[out] cpus - array receiving the cpu numbers
+ * @param[in]  max  - size of the cpus array
+ *
+ * @return number of cpus stored in cpus, 0 if the list is malformed
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static int
+parse_cpu_list(char *list, int *cpus, int max)
+{
+	int n = 0;
+	char *p = list;
+	char *endp;
+	long lo;
+	long hi;
+
+	while (*p != '\0' && *p != '\n') {
+		lo = strtol(p, &endp, 10);
+		if (endp == p || lo < 0)
+			return 0;
+		hi = lo;
+		p = endp;
+		if (*p == '-') {
+			p++;
+			hi = strtol(p, &endp, 10);
+			if (endp == p || hi < lo)
+				return 0;
+			p = endp;
+		}
+		for (; lo <= hi && n < max; lo++)
+			cpus[n++] = (int) lo;
+		if (*p == ',')
+			p++;
+		else if (*p != '\0' && *p != '\n')
+			return 0;
+	}
+	return n;
+}
+
+/**
+ * @brief
+ *	Find the cpus local to the network interface that carries the
+ *	address of this node, as listed by the kernel in
+ *	/sys/class/net/<interface>/device/local_cpulist
+ *
+ * @param[in]  node_name - the name(s) of this node, as in tpp_config
+ * @param[out] buf       - buffer receiving the cpu list
+ * @param[in]  len       - size of buf
+ *
+ * @return int
+ * @retval  0 - cpu list found
+ * @retval -1 - no interface or cpu list found
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static int
+get_nic_cpu_list(char *node_name, char *buf, int len)
+{
+	struct ifaddrs *ifa_list;
+	struct ifaddrs *ifa;
+	tpp_addr_t *addrs;
+	int count;
+	int i;
+	int rc = -1;
+	char path[256];
+	FILE *fp;
+
+	if ((addrs = tpp_get_addresses(node_name, &count)) == NULL)
+		return -1;
+	if (getifaddrs(&ifa_list) == -1) {
+		free(addrs);
+		return -1;
+	}
+	for (ifa = ifa_list; ifa != NULL && rc != 0; ifa = ifa->ifa_next) {
+		struct sockaddr_in *sin = (struct sockaddr_in *) ifa->ifa_addr;
+
+		if (sin == NULL || sin->sin_family != AF_INET)
+			continue;
+		for (i = 0; i < count; i++) {
+			if (memcmp(&addrs[i].ip, &sin->sin_addr, sizeof(sin->sin_addr)) == 0)
+				break;
+		}
+		if (i == count)
+			continue;
+		snprintf(path, sizeof(path), "/sys/class/net/%s/device/local_cpulist", ifa->ifa_name);
+		if ((fp = fopen(path, "r")) == NULL)
+			continue;
+		if (fgets(buf, len, fp) != NULL)
+			rc = 0;
+		fclose(fp);
+	}
+	freeifaddrs(ifa_list);
+	free(addrs);
+	return rc;
+}
+
+/**
+ * @brief
+ *	Bind the transport threads to the cpus given by conf->thread_cpus
+ *
+ * @par Functionality
+ *	With an explicit cpu list, thread i is bound to the i'th cpu of the
+ *	list, wrapping around if there are more threads than cpus. With
+ *	"nic", all threads are bound to the set of cpus local to the network
+ *	interface carrying this node's address, and the kernel balances them
+ *	within that set. Memory the threads allocate afterwards is then
+ *	placed on their own NUMA node by the kernel's first touch policy.
+ *	Failures are logged and leave the threads unbound.
+ *
+ * @param[in] conf - the tpp configuration
+ *
+ * @par MT-safe: No
+ *
+ */
+static void
+bind_threads(struct tpp_config *conf)
+{
+	char list[256];
+	int cpus[CPU_SETSIZE];
+	int ncpus;
+	int nic;
+	int i;
+	int j;
+	cpu_set_t set;
+
+	nic = (strcmp(conf->thread_cpus, TPP_THREAD_CPUS_NIC) == 0);
+	if (nic) {
+		if (get_nic_cpu_list(conf->node_name, list, sizeof(list)) != 0) {
+			tpp_log_func(LOG_WARNING, __func__,
+				"Could not find the cpus local to the network interface, threads not bound");
+			return;
+		}
+	} else
+		snprintf(list, sizeof(list), "%s", conf->thread_cpus);
+
+	ncpus = parse_cpu_list(list, cpus, CPU_SETSIZE);
+	if (ncpus == 0) {
+		snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Invalid cpu list %s, threads not bound", list);
+		tpp_log_func(LOG_WARNING, __func__, tpp_get_logbuf());
+		return;
+	}
+
+	for (i = 0; i < conf->numthreads; i++) {
+		CPU_ZERO(&set);
+		if (nic) {
+			for (j = 0; j < ncpus; j++)
+				CPU_SET(cpus[j], &set);
+		} else
+			CPU_SET(cpus[i % ncpus], &set);
+		if (pthread_setaffinity_np(thrd_pool[i]->worker_thrd_id, sizeof(set), &set) != 0) {
+			snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Failed to bind thread %d to cpus %s", i, list);
+			tpp_log_func(LOG_WARNING, __func__, tpp_get_logbuf());
+			return;
+		}
+	}
+	snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Bound %d threads to cpus %s", conf->numthreads, list);
+	tpp_log_func(LOG_INFO, NULL, tpp_get_logbuf());
+}
+#endif
+
 /**
  * @brief
  *	Initialize the transport layer.
@@ -637,6 +852,10 @@ tpp_transport_init(struct tpp_config *conf)
 			return -1;
 		}
 	}
+#ifdef linux
+	if (conf->thread_cpus != NULL)
+		bind_threads(conf);
+#endif
 	tpp_log_func(LOG_INFO, NULL, "TPP initialization done");
 
 	return 0;
@@ -717,6 +936,7 @@ static phy_conn_t*
 alloc_conn(int tfd)
 {
 	phy_conn_t *conn;
+	int i;
 
 	conn = calloc(1, sizeof(phy_conn_t));
 	if (!conn) {
@@ -726,8 +946,12 @@ alloc_conn(int tfd)
 	conn->sock_fd = tfd;
 	conn->send_queue_size = 0;
 	conn->extra = NULL;
+	/* initialize the send queues to empty */
 	TPP_QUE_CLEAR(&conn->send_queue);
-	/* initialize the send queue to empty */
+	TPP_QUE_CLEAR(&conn->ctl_queue);
+	for (i = 0; i < TPP_SENDQ_FLOWS; i++) {
+		TPP_QUE_CLEAR(&conn->bulk_queue[i]);
+	}
 
 	/* set to stream array */
 	if (tpp_lock(&cons_array_lock)) {
@@ -1099,6 +1323,206 @@ check_buffer_limits(phy_conn_t *conn)
 	return 0;
 }
 
+/**
+ * @brief
+ *	Find the scheduling class of a packet about to be queued on a
+ *	connection.
+ *
+ * @par Functionality:
+ *	Streams are bucketed by their source and destination descriptors and
+ *	source magic. A data packet whose bucket already has bulk packets
+ *	waiting stays in that bucket, so that the packets of a stream are never
+ *	reordered. Otherwise data and multicast packets larger than
+ *	TPP_SEND_SIZE are bulk, and everything else is control.
+ *
+ * @param[in] conn - The physical connection
+ * @param[in] pkt  - The packet, with its length prefix
+ *
+ * @return  The class
+ * @retval  -1  - control class
+ * @retval  >=0 - bucket of the bulk class
+ *
+ * @par MT-safe: No
+ *
+ */
+static int
+sched_class(phy_conn_t *conn, tpp_packet_t *pkt)
+{
+	tpp_data_pkt_hdr_t dhdr;
+	unsigned char type;
+	int payload;
+	int b;
+
+	if (pkt->len <= (int) sizeof(int))
+		return -1;
+
+	payload = pkt->len - sizeof(int);
+	type = *((unsigned char *) (pkt->data + sizeof(int)));
+
+	if (type == TPP_MCAST_DATA || type == TPP_MCAST_GROUP || type == TPP_MCAST_GROUP_DATA) {
+		/* a multicast spans many streams, keep it behind all of them */
+		if (conn->bulk_pkts > 0 || payload > TPP_SEND_SIZE)
+			return 0;
+		return -1;
+	}
+
+	if ((type != TPP_DATA && type != TPP_CLOSE_STRM) || payload < (int) sizeof(tpp_data_pkt_hdr_t))
+		return -1;
+
+	payload -= sizeof(tpp_data_pkt_hdr_t);
+	if (type == TPP_DATA && payload == 0)
+		return -1; /* acks carry no stream data, let them through */
+
+	memcpy(&dhdr, pkt->data + sizeof(int), sizeof(tpp_data_pkt_hdr_t));
+	b = (ntohl(dhdr.src_sd) * 31 + ntohl(dhdr.dest_sd) * 17 + ntohl(dhdr.src_magic)) % TPP_SENDQ_FLOWS;
+
+	if (TPP_QUE_HEAD(&conn->bulk_queue[b]) || payload > TPP_SEND_SIZE)
+		return b;
+	return -1;
+}
+
+/**
+ * @brief
+ *	Queue a packet on the scheduler of a connection
+ *
+ * @param[in] conn - The physical connection
+ * @param[in] pkt  - The packet to queue
+ *
+ * @return  Error code
+ * @retval  -1 - Out of memory
+ * @retval   0 - Success
+ *
+ * @par MT-safe: No
+ *
+ */
+static int
+sched_enque(phy_conn_t *conn, tpp_packet_t *pkt)
+{
+	int b;
+
+	b = sched_class(conn, pkt);
+	if (b < 0)
+		return (tpp_enque(&conn->ctl_queue, pkt) == NULL) ? -1 : 0;
+
+	if (tpp_enque(&conn->bulk_queue[b], pkt) == NULL)
+		return -1;
+	conn->bulk_pkts++;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Pick the bulk bucket to send from by deficit round robin
+ *
+ * @par Functionality:
+ *	The bucket being served keeps sending while its deficit covers the
+ *	packet at its head, then the next non-empty bucket is granted
+ *	TPP_SENDQ_QUANTUM bytes. An emptied bucket loses its deficit.
+ *
+ * @param[in] conn - The physical connection
+ *
+ * @return  The bucket, whose deficit covers the packet at its head
+ * @retval  -1 - no bulk packets waiting
+ *
+ * @par MT-safe: No
+ *
+ */
+static int
+sched_bulk_pick(phy_conn_t *conn)
+{
+	tpp_packet_t *p;
+	int b;
+
+	if (conn->bulk_pkts == 0)
+		return -1;
+
+	for (;;) {
+		b = conn->bulk_next;
+		p = TPP_QUE_DATA(TPP_QUE_HEAD(&conn->bulk_queue[b]));
+		if (p && conn->bulk_deficit[b] >= p->len)
+			return b;
+		if (p == NULL)
+			conn->bulk_deficit[b] = 0;
+
+		conn->bulk_next = (b + 1) % TPP_SENDQ_FLOWS;
+		if (TPP_QUE_HEAD(&conn->bulk_queue[conn->bulk_next]))
+			conn->bulk_deficit[conn->bulk_next] += TPP_SENDQ_QUANTUM;
+	}
+}
+
+/**
+ * @brief
+ *	Commit packets from the scheduler of a connection to its send queue
+ *
+ * @par Functionality:
+ *	Control packets are committed first, up to TPP_SENDQ_WINDOW bytes. A
+ *	bulk packet is committed only once the send queue has drained, so that
+ *	control packets queued while it waits can still go out ahead of it.
+ *
+ * @param[in] conn - The physical connection
+ *
+ * @par MT-safe: No
+ *
+ */
+static void
+sched_commit(phy_conn_t *conn)
+{
+	tpp_packet_t *p;
+	int b;
+
+	if (TPP_QUE_HEAD(&conn->send_queue) == NULL)
+		conn->send_commit_size = 0;
+
+	while ((p = TPP_QUE_DATA(TPP_QUE_HEAD(&conn->ctl_queue)))) {
+		if (conn->send_commit_size > 0 && conn->send_commit_size + p->len > TPP_SENDQ_WINDOW)
+			return;
+		if (tpp_enque(&conn->send_queue, p) == NULL) {
+			tpp_log_func(LOG_CRIT, __func__, "Out of memory enqueing to send queue");
+			return;
+		}
+		(void) tpp_deque(&conn->ctl_queue);
+		conn->send_commit_size += p->len;
+		if (conn->bulk_pkts > 0)
+			conn->send_expedited++;
+	}
+
+	if (conn->send_commit_size > 0 || (b = sched_bulk_pick(conn)) == -1)
+		return;
+
+	p = TPP_QUE_DATA(TPP_QUE_HEAD(&conn->bulk_queue[b]));
+	if (tpp_enque(&conn->send_queue, p) == NULL) {
+		tpp_log_func(LOG_CRIT, __func__, "Out of memory enqueing to send queue");
+		return;
+	}
+	(void) tpp_deque(&conn->bulk_queue[b]);
+	conn->bulk_pkts--;
+	conn->send_commit_size += p->len;
+	conn->bulk_deficit[b] -= p->len;
+	if (TPP_QUE_HEAD(&conn->bulk_queue[b]) == NULL)
+		conn->bulk_deficit[b] = 0;
+}
+
+/**
+ * @brief
+ *	Account for a packet leaving the send queue of a connection
+ *
+ * @param[in] conn - The physical connection
+ * @param[in] len  - Length the packet was committed with
+ *
+ * @par MT-safe: No
+ *
+ */
+static void
+sched_retire(phy_conn_t *conn, int len)
+{
+	if (conn->send_commit_size > (unsigned long) len)
+		conn->send_commit_size -= len;
+	else
+		conn->send_commit_size = 0;
+	conn->send_queue_size -= len;
+	conn->send_queue_pkts--;
+}
+
 /**
  * @brief
  *	Queue data to be sent out by the IO thread. This function can take a
@@ -1507,11 +1931,14 @@ handle_cmd(thrd_data_t *td, int tfd, int cmd, void *data)
 			tpp_free_pkt(pkt);
 			return;
 		}
-		if (tpp_enque(&conn->send_queue, pkt) == NULL) {
+		if (sched_enque(conn, pkt) != 0) {
 			tpp_log_func(LOG_CRIT, __func__, "Out of memory enqueing to send queue");
 			return;
 		}
 		conn->send_queue_size += pkt->len;
+		conn->send_queue_pkts++;
+		if (conn->send_queue_size > conn->send_queue_max)
+			conn->send_queue_max = conn->send_queue_size;
 
 		/* handle socket add calls */
 		send_data(conn);
@@ -2015,6 +2442,8 @@ handle_incoming_data(phy_conn_t *conn)
 			amt += rc;
 			conn->scratch.pos += rc;
 		}
+		conn->bytes_in += amt;
+		TPP_STAT_ADD(bytes_in, amt);
 		rc = add_pkts(conn);
 		if (rc == -1) {
 			/* a disconnect had happened in the flow, quit this routine */
@@ -2091,12 +2520,26 @@ add_pkts(phy_conn_t *conn)
 		}
 
 		count++;
-		/* coalesce before next packet to maintain alignment */
+		conn->pkts_in++;
+		TPP_STAT_ADD(pkts_in, 1);
 		avl_len = avl_len - pkt_len;
-		memmove(conn->scratch.data, conn->scratch.data + pkt_len, (size_t)avl_len); /* area OVERLAP - use memmove */
-		conn->scratch.pos = conn->scratch.data + avl_len;
+		pkt_start = pkt_start + pkt_len;
+
+		/*
+		 * hand the next packet to the upper layer straight from the
+		 * scratch area, only coalesce if it would start misaligned
+		 */
+		if (avl_len > 0 && ((pkt_start - conn->scratch.data) % TPP_PKT_ALIGN) != 0) {
+			memmove(conn->scratch.data, pkt_start, (size_t)avl_len); /* area OVERLAP - use memmove */
+			pkt_start = conn->scratch.data;
+		}
 	}
 
+	/* move any partial packet left over to the start of the scratch area */
+	if (pkt_start != conn->scratch.data)
+		memmove(conn->scratch.data, pkt_start, (size_t)avl_len); /* area OVERLAP - use memmove */
+	conn->scratch.pos = conn->scratch.data + avl_len;
+
 	if (count > 50) {
 		snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Received many small packets(%d)", count);
 		tpp_log_func(LOG_INFO, __func__, tpp_get_logbuf());
@@ -2104,6 +2547,97 @@ add_pkts(phy_conn_t *conn)
 	return rc;
 }
 
+#if !defined(WIN32) && !defined(NAS)
+/**
+ * @brief
+ *	Send out queued packets of a connection, gathering up to
+ *	TPP_SEND_IOV_MAX packets into each writev() call, so that a burst of
+ *	small packets costs one system call instead of one per packet.
+ *	Stop if sending would block.
+ *
+ *	Only used when no presend handler is registered, since presend
+ *	handlers act on (and may replace or drop) one packet at a time.
+ *
+ * @param[in] conn - The physical connection
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: No
+ *
+ */
+static void
+send_data_batched(phy_conn_t *conn)
+{
+	struct iovec iov[TPP_SEND_IOV_MAX];
+	tpp_que_elem_t *n;
+	tpp_packet_t *p;
+	ssize_t rc;
+	int cnt;
+	int left;
+
+	while (conn->can_send) {
+		sched_commit(conn);
+
+		cnt = 0;
+		n = NULL;
+		while (cnt < TPP_SEND_IOV_MAX && (n = TPP_QUE_NEXT(&conn->send_queue, n))) {
+			p = TPP_QUE_DATA(n);
+			iov[cnt].iov_base = p->pos;
+			iov[cnt].iov_len = p->len - (p->pos - p->data);
+			cnt++;
+		}
+		if (cnt == 0)
+			return;
+
+		rc = tpp_sock_writev(conn->sock_fd, iov, cnt);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EWOULDBLOCK || errno == EAGAIN) {
+				/* set this socket in POLLOUT */
+				if (tpp_em_mod_fd(conn->td->em_context, conn->sock_fd,
+					EM_IN | EM_OUT | EM_HUP | EM_ERR) == -1) {
+					tpp_log_func(LOG_ERR, __func__, "Multiplexing failed");
+					return;
+				}
+
+				/* set to cannot send data any more */
+				conn->can_send = 0;
+				conn->send_blocked++;
+				TPP_STAT_ADD(send_blocked, 1);
+			} else
+				handle_disconnect(conn);
+			return;
+		}
+		TPP_DBPRT(("tfd=%d, sent out %d bytes from %d packets", conn->sock_fd, (int) rc, cnt));
+		conn->bytes_out += rc;
+		TPP_STAT_ADD(bytes_out, rc);
+
+		/* retire the packets that went out completely */
+		while (rc > 0 && (n = TPP_QUE_HEAD(&conn->send_queue))) {
+			p = TPP_QUE_DATA(n);
+			left = p->len - (p->pos - p->data);
+			if (rc < left) {
+				p->pos += rc;
+				break;
+			}
+			rc -= left;
+			sched_retire(conn, p->len);
+			conn->pkts_out++;
+			TPP_STAT_ADD(pkts_out, 1);
+
+			if (the_pkt_postsend_handler)
+				the_pkt_postsend_handler(conn->sock_fd, p, conn->extra);
+			else
+				tpp_free_pkt(p);
+
+			(void) tpp_que_del_elem(&conn->send_queue, n);
+		}
+	}
+}
+#endif
+
 /**
  * @brief
  *	Loop over the list of queued data and send out packet by packet
@@ -2137,12 +2671,20 @@ send_data(phy_conn_t *conn)
 	if (conn->net_state == TPP_CONN_CONNECTING || conn->net_state == TPP_CONN_INITIATING)
 		return;
 
-	n = TPP_QUE_HEAD(&conn->send_queue);
-	p = TPP_QUE_DATA(n);
-
 	if (conn->can_send == 0)
 		return;
 
+#if !defined(WIN32) && !defined(NAS)
+	if (the_pkt_presend_handler == NULL) {
+		send_data_batched(conn);
+		return;
+	}
+#endif
+
+	sched_commit(conn);
+	n = TPP_QUE_HEAD(&conn->send_queue);
+	p = TPP_QUE_DATA(n);
+
 	can_send_more = 1;
 
 	while (p && can_send_more) {
@@ -2153,8 +2695,10 @@ send_data(phy_conn_t *conn)
 			if (the_pkt_presend_handler) {
 				if (the_pkt_presend_handler(conn->sock_fd, p, conn->extra) != 0) {
 					/* handler asked not to send data, skip packet */
-					conn->send_queue_size -= tosend;
+					sched_retire(conn, tosend);
 					(void) tpp_que_del_elem(&conn->send_queue, n);
+					if (TPP_QUE_HEAD(&conn->send_queue) == NULL)
+						sched_commit(conn);
 					n = TPP_QUE_HEAD(&conn->send_queue);
 					p = TPP_QUE_DATA(n);
 					continue;
@@ -2324,6 +2868,8 @@ send_data(phy_conn_t *conn)
 
 					/* set to cannot send data any more */
 					conn->can_send = 0;
+					conn->send_blocked++;
+					TPP_STAT_ADD(send_blocked, 1);
 				} else {
 					handle_disconnect(conn);
 					return;
@@ -2334,10 +2880,14 @@ send_data(phy_conn_t *conn)
 			TPP_DBPRT(("tfd=%d, sending out %d bytes", conn->sock_fd, rc));
 			p->pos += rc;
 			tosend -= rc;
+			conn->bytes_out += rc;
+			TPP_STAT_ADD(bytes_out, rc);
 		}
 
 		if (tosend == 0) {
-			conn->send_queue_size -= p->len;
+			sched_retire(conn, p->len);
+			conn->pkts_out++;
+			TPP_STAT_ADD(pkts_out, 1);
 
 			if (the_pkt_postsend_handler)
 				the_pkt_postsend_handler(conn->sock_fd, p, conn->extra);
@@ -2350,6 +2900,8 @@ send_data(phy_conn_t *conn)
 			 * delete this node and get next node in queue
 			 */
 			(void)tpp_que_del_elem(&conn->send_queue, n);
+			if (TPP_QUE_HEAD(&conn->send_queue) == NULL)
+				sched_commit(conn);
 			n = TPP_QUE_HEAD(&conn->send_queue);
 			p = TPP_QUE_DATA(n);
 		}
@@ -2372,6 +2924,7 @@ static void
 free_phy_conn(phy_conn_t *conn)
 {
 	tpp_packet_t *p = NULL;
+	int i;
 
 	if (!conn)
 		return;
@@ -2385,6 +2938,14 @@ free_phy_conn(phy_conn_t *conn)
 	while ((p = tpp_deque(&conn->send_queue))) {
 		tpp_free_pkt(p);
 	}
+	while ((p = tpp_deque(&conn->ctl_queue))) {
+		tpp_free_pkt(p);
+	}
+	for (i = 0; i < TPP_SENDQ_FLOWS; i++) {
+		while ((p = tpp_deque(&conn->bulk_queue[i]))) {
+			tpp_free_pkt(p);
+		}
+	}
 
 	free(conn->ctx);
 	free(conn->scratch.data);
@@ -2523,3 +3084,56 @@ tpp_transport_set_conn_extra(int tfd, void *extra)
 #endif
 	}
 }
+
+/**
+ * @brief
+ *	Append one JSON line per physical connection to the stats buffer, for
+ *	tpp_stats_json(). The counters are owned by the IO threads and read
+ *	here without stopping them, so a line may be a moment stale.
+ *
+ * @param[in,out] buf  - The stats buffer
+ * @param[in,out] size - The allocated size of buf
+ * @param[in,out] used - The length of the text in buf so far
+ *
+ * @return  Error code
+ * @retval  -1 - Out of memory
+ * @retval   0 - Success
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+tpp_transport_stats_json(char **buf, int *size, int *used)
+{
+	static char *state_names[] = {"unknown", "disconnected", "initiating", "connecting", "connected"};
+	phy_conn_t *conn;
+	int rc = 0;
+	int i;
+
+	if (conns_array == NULL)
+		return 0;
+
+	if (tpp_lock(&cons_array_lock))
+		return -1;
+
+	/* a busy slot's conn is only freed after the slot is cleared under the lock */
+	for (i = 0; i < conns_array_size && rc == 0; i++) {
+		if (conns_array[i].slot_state != TPP_SLOT_BUSY || (conn = conns_array[i].conn) == NULL)
+			continue;
+
+		rc = tpp_stats_append(buf, size, used,
+			"{\"type\":\"tpp_conn\",\"tfd\":%d,\"peer\":\"%s:%d\",\"state\":\"%s\","
+			"\"thread\":%d,\"pkts_in\":%llu,\"pkts_out\":%llu,\"bytes_in\":%llu,\"bytes_out\":%llu,"
+			"\"send_queue_pkts\":%d,\"send_queue_bytes\":%lu,\"send_queue_max\":%lu,\"send_blocked\":%llu,\"send_expedited\":%llu}\n",
+			conn->sock_fd,
+			(conn->conn_params && conn->conn_params->hostname) ? conn->conn_params->hostname : "",
+			conn->conn_params ? conn->conn_params->port : 0,
+			(conn->net_state >= 0 && conn->net_state <= TPP_CONN_CONNECTED) ? state_names[conn->net_state] : "unknown",
+			conn->td ? conn->td->thrd_index : -1,
+			conn->pkts_in, conn->pkts_out, conn->bytes_in, conn->bytes_out,
+			conn->send_queue_pkts, conn->send_queue_size, conn->send_queue_max, conn->send_blocked, conn->send_expedited);
+	}
+
+	tpp_unlock(&cons_array_lock);
+	return rc;
+}
@@ -52,6 +52,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
@@ -89,10 +90,24 @@ long tpp_log_event_mask = 0;
 
 void (*tpp_log_func)(int level, const char *id, char *mess) = NULL;
 
+tpp_stats_t tpp_stats; /* counters reported by tpp_stats_json() */
+
+/*
+ * Each thread keeps a small cache of freed packet structures and of small
+ * data buffers, so that the common small messages do not go through
+ * malloc/free every time. Packets created and freed on the same IO thread
+ * (as with pbs_comm forwarding) are recycled without touching the allocator.
+ */
+#define TPP_PKT_POOL_MAX	256	/* max packets/buffers cached per thread */
+#define TPP_PKT_POOL_BUFSZ	512	/* size of each cached data buffer */
+
 /**
  * @brief
  *	Create a packet structure from the inputs provided
  *
+ *	The packet structure, and for data up to TPP_PKT_POOL_BUFSZ bytes also
+ *	the data buffer, are taken from the calling thread's packet pool if
+ *	available.
  *
  * @param[in] - data - pointer to data buffer (if NULL provided, no copy happens)
  * @param[in] - len  - Lentgh of data buffer
@@ -112,14 +127,36 @@ tpp_packet_t *
 tpp_cr_pkt(void *data, int len, int mk_data)
 {
 	tpp_packet_t *pkt;
+	tpp_tls_t *tls = tpp_get_tls();
 
-	if ((pkt = malloc(sizeof(tpp_packet_t))) == NULL) {
+	if (tls && tls->pkt_pool) {
+		pkt = tls->pkt_pool;
+		tls->pkt_pool = pkt->extra_data;
+		tls->pkt_pool_count--;
+	} else if ((pkt = malloc(sizeof(tpp_packet_t))) == NULL) {
 		tpp_log_func(LOG_CRIT, __func__, "Out of memory allocating packet");
 		return NULL;
 	}
+	pkt->pool_blk = NULL;
 	if (mk_data == 0)
 		pkt->data = data;
-	else {
+	else if (len <= TPP_PKT_POOL_BUFSZ) {
+		if (tls && tls->buf_pool) {
+			pkt->data = tls->buf_pool;
+			tls->buf_pool = *((void **) pkt->data);
+			tls->buf_pool_count--;
+		} else if ((pkt->data = malloc(TPP_PKT_POOL_BUFSZ)) == NULL) {
+			free(pkt);
+			tpp_log_func(LOG_CRIT, __func__, "Out of memory allocating packet data");
+			return NULL;
+		}
+#ifdef DEBUG
+		memset(pkt->data, 0, TPP_PKT_POOL_BUFSZ);
+#endif
+		pkt->pool_blk = pkt->data;
+		if (data)
+			memcpy(pkt->data, data, len);
+	} else {
 #ifdef DEBUG
 		/* use calloc() to satisfy valgrind in debug mode */
 		pkt->data = calloc(len, 1);
@@ -148,6 +185,10 @@ tpp_cr_pkt(void *data, int len, int mk_data)
  * @brief
  *	Free a packet structure
  *
+ *	The packet structure and, if it still owns its pooled data buffer, the
+ *	buffer are returned to the calling thread's packet pool, unless the
+ *	pool is full.
+ *
  * @param[in] - pkt - Ptr to the packet to be freed.
  *
  * @par Side Effects:
@@ -163,11 +204,29 @@ tpp_free_pkt(tpp_packet_t *pkt)
 		pkt->ref_count--;
 
 		if (pkt->ref_count <= 0) {
-			if (pkt->data)
-				free(pkt->data);
+			tpp_tls_t *tls = tpp_get_tls();
+
+			if (pkt->data) {
+				/*
+				 * the data pointer could have been replaced or
+				 * reallocated by upper layers, only pool it back
+				 * if it is still the buffer we handed out
+				 */
+				if (pkt->data == pkt->pool_blk && tls && tls->buf_pool_count < TPP_PKT_POOL_MAX) {
+					*((void **) pkt->data) = tls->buf_pool;
+					tls->buf_pool = pkt->data;
+					tls->buf_pool_count++;
+				} else
+					free(pkt->data);
+			}
 			if (pkt->extra_data)
 				free(pkt->extra_data);
-			free(pkt);
+			if (tls && tls->pkt_pool_count < TPP_PKT_POOL_MAX) {
+				pkt->extra_data = tls->pkt_pool;
+				tls->pkt_pool = pkt;
+				tls->pkt_pool_count++;
+			} else
+				free(pkt);
 		}
 	}
 }
@@ -1038,7 +1097,25 @@ tpp_get_logbuf()
 
 #ifdef PBS_COMPRESSION_ENABLED
 
-#define COMPR_LEVEL Z_DEFAULT_COMPRESSION
+static int compr_level = Z_DEFAULT_COMPRESSION;
+
+/**
+ * @brief
+ *	Set the zlib level TPP compresses data with
+ *
+ * @param[in] level - 1 (fastest) to 9 (smallest), 0 for zlib's default
+ *
+ * @par MT-safe: No
+ *
+ */
+void
+tpp_set_compression_level(int level)
+{
+	if (level >= 1 && level <= 9)
+		compr_level = level;
+	else
+		compr_level = Z_DEFAULT_COMPRESSION;
+}
 
 struct def_ctx {
 	z_stream cmpr_strm;
@@ -1086,7 +1163,7 @@ tpp_multi_deflate_init(int initial_len)
 	ctx->cmpr_strm.zalloc = Z_NULL;
 	ctx->cmpr_strm.zfree = Z_NULL;
 	ctx->cmpr_strm.opaque = Z_NULL;
-	ret = deflateInit(&ctx->cmpr_strm, COMPR_LEVEL);
+	ret = deflateInit(&ctx->cmpr_strm, compr_level);
 	if (ret != Z_OK) {
 		free(ctx->cmpr_buf);
 		free(ctx);
@@ -1188,6 +1265,8 @@ tpp_multi_deflate_done(void *c, unsigned int *cmpr_len)
 	int ret;
 
 	*cmpr_len = ctx->cmpr_strm.total_out;
+	TPP_STAT_ADD(cmpr_in, ctx->cmpr_strm.total_in);
+	TPP_STAT_ADD(cmpr_out, ctx->cmpr_strm.total_out);
 
 	ret = deflateEnd(&ctx->cmpr_strm);
 	free(ctx);
@@ -1204,11 +1283,12 @@ tpp_multi_deflate_done(void *c, unsigned int *cmpr_len)
  *
  * @param[in] inbuf   - Ptr to buffer to compress
  * @param[in] inlen   - The size of input buffer
- * @param[out] outlen - The size of the compressed data
+ * @param[out] outlen - The size of the compressed data, or inlen if
+ *			compressing would not make the data smaller
  *
  * @return      - Ptr to the compressed data buffer
  * @retval  !NULL - Success
- * @retval   NULL - Failure
+ * @retval   NULL - Failure, or data not compressed (*outlen == inlen)
  *
  * @par MT-safe: No
  **/
@@ -1228,7 +1308,7 @@ tpp_deflate(void *inbuf, unsigned int inlen, unsigned int *outlen)
 	strm.zalloc = Z_NULL;
 	strm.zfree = Z_NULL;
 	strm.opaque = Z_NULL;
-	ret = deflateInit(&strm, Z_DEFAULT_COMPRESSION);
+	ret = deflateInit(&strm, compr_level);
 	if (ret != Z_OK) {
 		tpp_log_func(LOG_CRIT, __func__, "Compression failed");
 		return NULL;
@@ -1248,33 +1328,22 @@ tpp_deflate(void *inbuf, unsigned int inlen, unsigned int *outlen)
 		return NULL;
 	}
 
-	/* run deflate() on input until output buffer not full, finish
-	 * compression if all of source has been read in
+	/* run deflate() on input in one go; output that does not fit in
+	 * fewer bytes than the input is not worth sending compressed (and
+	 * a receiver takes data of unchanged length as uncompressed)
 	 */
 
-	strm.avail_out = len;
+	strm.avail_out = len - 1;
 	strm.next_out = data;
-	while (1) {
-		ret = deflate(&strm, Z_FINISH);
-		if (ret == Z_OK && strm.avail_out == 0) {
-			/* more output pending, but no output buffer space */
-			filled = (char *) strm.next_out - (char *) data;
-			len = len * 2;
-			p = realloc(data, len);
-			if (!p) {
-				deflateEnd(&strm);
-				free(data);
-				snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Out of memory allocating deflate buffer %d bytes", len);
-				tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
-				return NULL;
-			}
-			data = p;
-			strm.next_out = (Bytef *)((char *) data + filled);
-			strm.avail_out = len - filled;
-		} else
-			break;
-	}
+	ret = deflate(&strm, Z_FINISH);
 	deflateEnd(&strm); /* clean up */
+	if (ret == Z_OK || ret == Z_BUF_ERROR) {
+		/* more output pending, but no output buffer space */
+		free(data);
+		*outlen = inlen;
+		TPP_STAT_ADD(cmpr_skipped, 1);
+		return NULL;
+	}
 	if (ret != Z_STREAM_END) {
 		free(data);
 		tpp_log_func(LOG_CRIT, __func__, "Compression failed");
@@ -1295,6 +1364,8 @@ tpp_deflate(void *inbuf, unsigned int inlen, unsigned int *outlen)
 	}
 
 	*outlen = filled;
+	TPP_STAT_ADD(cmpr_in, inlen);
+	TPP_STAT_ADD(cmpr_out, filled);
 	return data;
 }
 
@@ -1357,6 +1428,11 @@ tpp_inflate(void *inbuf, unsigned int inlen, unsigned int totlen)
 	return outbuf;
 }
 #else
+void
+tpp_set_compression_level(int level)
+{
+}
+
 void *
 tpp_multi_deflate_init(int initial_len)
 {
@@ -1393,6 +1469,98 @@ tpp_inflate(void *inbuf, unsigned int inlen, unsigned int totlen)
 }
 #endif
 
+/**
+ * @brief Append formatted text to a growing buffer
+ *
+ * @param[in,out] buf  - The buffer, (re)allocated as needed
+ * @param[in,out] size - The allocated size of buf
+ * @param[in,out] used - The length of the text in buf so far
+ * @param[in] fmt      - printf style format of the text to append
+ *
+ * @return - Error code
+ * @retval  0 - Success
+ * @retval -1 - Out of memory
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+tpp_stats_append(char **buf, int *size, int *used, const char *fmt, ...)
+{
+	va_list ap;
+	char *p;
+	int len;
+
+	for (;;) {
+		if (*size - *used > 0) {
+			va_start(ap, fmt);
+			len = vsnprintf(*buf + *used, *size - *used, fmt, ap);
+			va_end(ap);
+			if (len < 0)
+				return -1;
+			if (len < *size - *used) {
+				*used += len;
+				return 0;
+			}
+		}
+		p = realloc(*buf, *size + TPP_LOGBUF_SZ);
+		if (p == NULL) {
+			tpp_log_func(LOG_CRIT, __func__, "Out of memory allocating stats buffer");
+			return -1;
+		}
+		*buf = p;
+		*size += TPP_LOGBUF_SZ;
+	}
+}
+
+/**
+ * @brief Take a snapshot of the TPP statistics in machine readable form
+ *
+ * @par Functionality
+ *	Returns one JSON object per line: first the library wide counters
+ *	(type "tpp_stats"), then one object for every physical connection
+ *	(type "tpp_conn") with its traffic and send queue depth. On pbs_comm
+ *	the connections are the leaves and the other routers, on a leaf they
+ *	are the connections to pbs_comm.
+ *
+ * @return - The newline separated JSON text, to be freed by the caller
+ * @retval  NULL - Out of memory
+ *
+ * @par MT-safe: Yes
+ *
+ */
+char *
+tpp_stats_json(void)
+{
+	tpp_stats_t st;
+	char *buf = NULL;
+	int size = 0;
+	int used = 0;
+
+	memcpy(&st, &tpp_stats, sizeof(st));
+
+	if (tpp_stats_append(&buf, &size, &used,
+		"{\"type\":\"tpp_stats\",\"pkts_in\":%llu,\"pkts_out\":%llu,"
+		"\"bytes_in\":%llu,\"bytes_out\":%llu,\"send_blocked\":%llu,"
+		"\"retries\":%llu,\"acks_sent\":%llu,\"acks_rcvd\":%llu,"
+		"\"ack_ms_avg\":%.1f,\"ack_ms_max\":%llu,"
+		"\"cmpr_in\":%llu,\"cmpr_out\":%llu,\"cmpr_ratio\":%.3f,\"cmpr_skipped\":%llu}\n",
+		st.pkts_in, st.pkts_out, st.bytes_in, st.bytes_out, st.send_blocked,
+		st.retries, st.acks_sent, st.acks_rcvd,
+		st.ack_ms_cnt ? (double) st.ack_ms_sum / st.ack_ms_cnt : 0.0, st.ack_ms_max,
+		st.cmpr_in, st.cmpr_out, st.cmpr_in ? (double) st.cmpr_out / st.cmpr_in : 1.0,
+		st.cmpr_skipped) != 0) {
+		free(buf);
+		return NULL;
+	}
+
+	if (tpp_transport_stats_json(&buf, &size, &used) != 0) {
+		free(buf);
+		return NULL;
+	}
+	return buf;
+}
+
 /**
  * @brief Convenience function to validate a tpp header
  *
@@ -1418,7 +1586,8 @@ tpp_validate_hdr(int tfd, char *pkt_start)
 	type = *((unsigned char *) data);
 
 	if ((data_len < 0 || type >= TPP_LAST_MSG) ||
-		(data_len > TPP_SEND_SIZE && type != TPP_DATA && type != TPP_MCAST_DATA && type != TPP_GSS_WRAP)) {
+		(data_len > TPP_SEND_SIZE && type != TPP_DATA && type != TPP_MCAST_DATA && type != TPP_GSS_WRAP &&
+		type != TPP_MCAST_GROUP && type != TPP_MCAST_GROUP_DATA)) {
 		snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ,
 				 "tfd=%d, Received invalid packet type with type=%d? data_len=%d", tfd, type, data_len);
 		tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
@@ -1742,6 +1911,22 @@ free_router(tpp_router_t *r)
 	}
 }
 
+/*
+ * Convenience function to delete a table of TPP_MCAST_GROUP_SLOTS
+ * multicast groups
+ */
+void
+tpp_free_mcast_groups(tpp_mcast_group_t *groups)
+{
+	int i;
+
+	if (groups) {
+		for (i = 0; i < TPP_MCAST_GROUP_SLOTS; i++)
+			free(groups[i].members);
+		free(groups);
+	}
+}
+
 /*
  * Convenience function to delete information about a leaf
  */
@@ -1752,6 +1937,8 @@ free_leaf(tpp_leaf_t *l)
 		if (l->leaf_addrs)
 			free(l->leaf_addrs);
 
+		tpp_free_mcast_groups(l->mcast_groups);
+
 		free(l);
 	}
 }
@@ -43,7 +43,9 @@
  *	finding in, and removing from entities limits from a data structure.
  *
  *	We will attempt to hide the details of the fgc holding structure,
- *	which for this implementation will be an AVL tree.
+ *	which for this implementation is an AVL tree, walked in key order,
+ *	and a hash index of the same keys, so that finding a key needs
+ *	neither a tree search nor building a key record.
  *
  * More to come.....
  */
@@ -52,6 +54,7 @@
 #include <string.h>
 #include <stdio.h>
 #include "avltree.h"
+#include "name_idx.h"
 #include "pbs_entlim.h"
 #ifdef WIN32
 #include <windows.h>
@@ -61,20 +64,32 @@
 
 static size_t maxkeylen = 0;
 static size_t defkeylen = 0;
+
+/*
+ * the data context: the tree must stay first, the context is passed to
+ * the avl functions as the tree.  ec_idx is NULL if the index could not
+ * be kept, the tree is then searched.
+ */
+typedef struct entlim_ctx {
+	AVL_IX_DESC	 ec_tree;	/* keys in order, for the walks */
+	name_idx	*ec_idx;	/* key string to record */
+} entlim_ctx;
+
 /**
  * @brief
- * 	entlim_initialize_ctx - initialize the data context structure
- *	For now it an AVL Tree
+ * 	entlim_initialize_ctx - initialize the data context structure,
+ *	an AVL Tree and a hash index of its keys
  *
  */
 
 void *
 entlim_initialize_ctx(void)
 {
-	AVL_IX_DESC *ctx;
-	ctx = (AVL_IX_DESC *)malloc(sizeof(AVL_IX_DESC));
+	entlim_ctx *ctx;
+	ctx = (entlim_ctx *)malloc(sizeof(entlim_ctx));
 	if (ctx != NULL) {
-		avl_create_index(ctx, AVL_NO_DUP_KEYS, 0);
+		avl_create_index(&ctx->ec_tree, AVL_NO_DUP_KEYS, 0);
+		ctx->ec_idx = create_name_idx();
 		if (maxkeylen == 0) {
 			defkeylen = sizeof(AVL_IX_REC);
 			maxkeylen = defkeylen;
@@ -83,6 +98,35 @@ entlim_initialize_ctx(void)
 	return ((void *)ctx);
 }
 
+/**
+ * @brief
+ * 	entlim_idx_set - make the hash index of the context map a key string
+ *	to a record, or drop the key from it if the record is NULL.  If the
+ *	index cannot be updated, it is discarded and the tree is searched
+ *	from then on.
+ *
+ * @param[in] keystr - key string
+ * @param[in] recptr - pointer to record or NULL
+ * @param[in] ctx - pointer to the data context
+ *
+ * @return	void
+ */
+
+static void
+entlim_idx_set(const char *keystr, const void *recptr, entlim_ctx *ctx)
+{
+	if (ctx->ec_idx == NULL)
+		return;
+	(void)name_idx_add_del(ctx->ec_idx, (char *)keystr, NULL, NAME_IDX_OP_DEL);
+	if (recptr == NULL)
+		return;
+	if (name_idx_add_del(ctx->ec_idx, (char *)keystr, (void *)recptr,
+		NAME_IDX_OP_ADD) != 0) {
+		free_name_idx(ctx->ec_idx);
+		ctx->ec_idx = NULL;
+	}
+}
+
 /**
  * @brief
  * 	entlim_create_key - create a key to hold the key string used for indexing
@@ -136,6 +180,12 @@ entlim_get(const char *keystr, void *ctx)
 	pbs_entlim_key_t *pkey;
 	void	         *rtn;
 
+	if (((entlim_ctx *)ctx)->ec_idx != NULL) {
+		if ((keystr == NULL) || (*keystr == '\0'))
+			return NULL;
+		return (find_name_idx(((entlim_ctx *)ctx)->ec_idx, (char *)keystr));
+	}
+
 	pkey =  entlim_create_key(keystr);
 	if (pkey == NULL)
 		return NULL;
@@ -173,6 +223,7 @@ entlim_add(const char *keystr, const void *recptr, void *ctx)
 	pkey->recptr = (AVL_RECPOS)recptr;
 
 	if (avl_add_key((AVL_IX_REC *)pkey, (AVL_IX_DESC *)ctx) == AVL_IX_OK) {
+		entlim_idx_set(pkey->key, recptr, (entlim_ctx *)ctx);
 		free(pkey);
 		return 0;
 	} else {
@@ -208,6 +259,7 @@ entlim_replace(const char *keystr, void *recptr, void *ctx,
 		return -1;
 	pkey->recptr = recptr;
 	if (avl_add_key((AVL_IX_REC *)pkey, (AVL_IX_DESC *)ctx) == AVL_IX_OK) {
+		entlim_idx_set(pkey->key, recptr, (entlim_ctx *)ctx);
 		free(pkey);
 		return 0;
 	} else {
@@ -217,6 +269,7 @@ entlim_replace(const char *keystr, void *recptr, void *ctx,
 			void *olddata = pkey->recptr;
 			rc = avl_delete_key((AVL_IX_REC *)pkey, (AVL_IX_DESC *)ctx);
 			if (rc == AVL_IX_OK) {
+				entlim_idx_set(keystr, NULL, (entlim_ctx *)ctx);
 				fr_leaf(olddata);
 				free(pkey);
 				pkey = entlim_create_key(keystr);
@@ -224,6 +277,8 @@ entlim_replace(const char *keystr, void *recptr, void *ctx,
 					return -1;
 				pkey->recptr = recptr;
 				rc = avl_add_key((AVL_IX_REC *)pkey, (AVL_IX_DESC *)ctx);
+				if (rc == AVL_IX_OK)
+					entlim_idx_set(keystr, recptr, (entlim_ctx *)ctx);
 			}
 		}
 		free(pkey);
@@ -263,6 +318,7 @@ entlim_delete(const char *keystr, void *ctx, void free_leaf(void *))
 	prec = pkey->recptr;
 	free(pkey);
 	if (rc == AVL_IX_OK) {
+		entlim_idx_set(keystr, NULL, (entlim_ctx *)ctx);
 		free_leaf(prec);
 		return 0;
 	} else
@@ -334,6 +390,7 @@ entlim_free_ctx(void *ctx, void free_leaf(void *))
 	}
 	free(leaf);
 	avl_destroy_index((AVL_IX_DESC *)ctx);
+	free_name_idx(((entlim_ctx *)ctx)->ec_idx);
 	free(ctx);
 	return 0;
 }
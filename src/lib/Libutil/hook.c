@@ -556,6 +556,91 @@ hook_freq_as_string(int freq)
 	return (freq_str);
 }
 
+/**
+ *
+ * @brief
+ *	Accumulate the outcome and cost of one run of hook 'phook'
+ *	under 'event' into the hook's statistics.
+ *
+ * @param[in,out] phook	- the hook that ran
+ * @param[in]	event	- the single HOOK_EVENT_* the hook ran for
+ * @param[in]	accepted - 1 if the hook accepted the event, 0 if it
+ *			   rejected it, -1 if the outcome is not known
+ * @param[in]	wall_usec - wall time of the run, in microseconds
+ * @param[in]	cpu_usec  - cpu time of the run, in microseconds
+ * @param[in]	python_usec - the part of 'wall_usec' spent running
+ *			      the hook script
+ *
+ * @return void
+ */
+void
+hook_stats_add(hook *phook, unsigned int event, int accepted,
+	long long wall_usec, long long cpu_usec, long long python_usec)
+{
+	struct hook_stats *pstats;
+	int i;
+
+	if ((phook == NULL) || (event == 0))
+		return;
+
+	for (i = 0; (event & 1) == 0; i++)
+		event >>= 1;
+	if (i >= HOOK_STATS_EVENTS)
+		return;
+
+	pstats = &phook->stats[i];
+	pstats->runs++;
+	if (accepted == 1)
+		pstats->accepts++;
+	else if (accepted == 0)
+		pstats->rejects++;
+	pstats->wall_usec += wall_usec;
+	pstats->cpu_usec += cpu_usec;
+	pstats->python_usec += python_usec;
+}
+
+/**
+ *
+ * @brief
+ *	Return the statistics of hook 'phook' for every event it has
+ *	run under, as "<event>: runs=<n> accepts=<n> rejects=<n>
+ *	wall_usec=<n> cpu_usec=<n> python_usec=<n>" entries separated
+ *	by "; ".
+ *
+ * @param[in]	phook - the hook in question
+ *
+ * @return char *
+ * @retval <string>	the statistics, empty if the hook never ran.
+ *
+ * @note
+ *	This returns a static string that will get overwritten on the
+ *	next call to this function.
+ */
+char *
+hook_stats_as_string(hook *phook)
+{
+	static char stats_str[HOOK_STATS_EVENTS * 160];
+	struct hook_stats *pstats;
+	size_t len = 0;
+	int i;
+
+	stats_str[0] = '\0';
+	for (i = 0; i < HOOK_STATS_EVENTS; i++) {
+		pstats = &phook->stats[i];
+		if (pstats->runs == 0)
+			continue;
+		len += snprintf(stats_str + len, sizeof(stats_str) - len,
+			"%s%s: runs=%lu accepts=%lu rejects=%lu wall_usec=%lld "
+			"cpu_usec=%lld python_usec=%lld", (len > 0) ? "; " : "",
+			hook_event_as_string(1 << i), pstats->runs,
+			pstats->accepts, pstats->rejects, pstats->wall_usec,
+			pstats->cpu_usec, pstats->python_usec);
+		if (len >= sizeof(stats_str))
+			break;
+	}
+	return (stats_str);
+}
+
 /*
  *	Sets the hook 'phook's name attribute to string 'newval'.
  *	RETURNS: 0 for success; 1 otherwise with 'msg' of size 'msg_len'
@@ -1039,24 +1039,18 @@ int
 in_string_list(char *str, char sep, char *string_list)
 {
 	char	*p = NULL;
-	char	*p2 = NULL;
-	char	*p_end = NULL;
 	char	*ptoken = NULL;
-	int	found_match = 0;
+	size_t	len;
 
 	if ((str == NULL) || (str[0] == '\0') || (string_list == NULL)) {
 		return (0);
 	}
 
-	p2 = strdup(string_list);
-	if (p2 == NULL) {
-		return (0);
-	}
-
-	p = p2;
-	p_end = p+strlen(string_list);
-
-	while (p < p_end) {
+	/* tokens are compared in place, this is called once per chunk of */
+	/* exec_vnode lists that can run to thousands of entries */
+	len = strlen(str);
+	p = string_list;
+	while (*p != '\0') {
 
 		/* skip past [<sep> ] characters */
 		while ((*p != '\0') &&  ((*p == sep) || (*p == ' '))) {
@@ -1072,18 +1066,10 @@ in_string_list(char *str, char sep, char *string_list)
 		while ((*p != '\0') &&  ((*p != sep) && (*p != ' '))) {
 			p++;
 		}
-		*p = '\0';	/* delimeter value is nulled */
-		if (strcmp(str, ptoken)  == 0) {
-			found_match = 1;
-			break;
-		}
-		p++;
-	}
-
-	if (p2) {
-		(void)free(p2);
+		if (((size_t)(p - ptoken) == len) && (strncmp(str, ptoken, len) == 0))
+			return (1);
 	}
-	return (found_match);
+	return (0);
 }
 
 /**
@@ -1472,6 +1458,65 @@ get_mem_info(void) {
 #endif /* malloc_info */
 #endif /* WIN32 */
 
+pbs_freelist *freelist_all = NULL;
+
+/**
+ * @brief
+ *	Get an object from a freelist, or from malloc if the list is empty
+ *
+ * @param[in]	fl - the freelist of the object's type
+ *
+ * @return void *
+ * @retval NULL - no memory
+ * @note
+ *	The object is not cleared, and must be handed back with
+ *	freelist_free() or free().
+ */
+void *
+freelist_alloc(pbs_freelist *fl)
+{
+	void *obj;
+
+	if (!fl->fl_listed) {
+		fl->fl_next = freelist_all;
+		freelist_all = fl;
+		fl->fl_listed = 1;
+	}
+	if ((obj = fl->fl_free) != NULL) {
+		fl->fl_free = *(void **)obj;
+		fl->fl_nfree--;
+		fl->fl_reuse++;
+		return obj;
+	}
+	if ((obj = malloc(fl->fl_size)) != NULL)
+		fl->fl_malloc++;
+	return obj;
+}
+
+/**
+ * @brief
+ *	Hand an object back to its freelist, or to free() if the list
+ *	already keeps fl_max free objects
+ *
+ * @param[in]	fl - the freelist of the object's type
+ * @param[in]	obj - object from freelist_alloc() or malloc(fl->fl_size)
+ *
+ * @return void
+ */
+void
+freelist_free(pbs_freelist *fl, void *obj)
+{
+	if (obj == NULL)
+		return;
+	if (fl->fl_nfree >= fl->fl_max) {
+		free(obj);
+		return;
+	}
+	*(void **)obj = fl->fl_free;
+	fl->fl_free = obj;
+	fl->fl_nfree++;
+}
+
 /**
  * @brief
  *	Return a copy of 'str' where non-printing characters
@@ -1897,3 +1942,326 @@ delay_query(void)
 #endif /* WIN32 */
 	atexit(create_query_file);
 }
+
+/* the widest number condense_vnode_list() makes a range of */
+#define VNODE_RANGE_WIDTH	18
+
+/**
+ * @brief
+ * 	Length of the term of a host or vnode list starting at str, up to the
+ * 	next '+' outside of parentheses.  A '\\' escapes the next character.
+ *
+ * @param[in] str - start of the term
+ *
+ * @return	size_t - length of the term
+ */
+static size_t
+vnlist_term_len(char *str)
+{
+	char *p = str;
+	int depth = 0;
+
+	for (; *p != '\0'; p++) {
+		if ((*p == '\\') && (p[1] != '\0'))
+			p++;
+		else if (*p == '(')
+			depth++;
+		else if (*p == ')')
+			depth--;
+		else if ((*p == '+') && (depth <= 0))
+			break;
+	}
+	return (p - str);
+}
+
+/**
+ * @brief
+ * 	Check whether a term of a host or vnode list follows the previous one
+ * 	in a range, that is the two differ only in one run of digits of the
+ * 	same width and the number of cur is the number of prev plus one.
+ *
+ * @param[in] prev - the previous term
+ * @param[in] plen - its length
+ * @param[in] cur - the term to check
+ * @param[in] clen - its length
+ * @param[in,out] off - offset of the run of digits, -1 to find it
+ * @param[in,out] width - width of the run of digits
+ *
+ * @return	int
+ * @retval	1	cur follows prev
+ * @retval	0	it does not
+ */
+static int
+vnlist_follows(char *prev, size_t plen, char *cur, size_t clen, long *off, size_t *width)
+{
+	size_t i;
+	size_t w;
+	char pnum[VNODE_RANGE_WIDTH + 1];
+	char cnum[VNODE_RANGE_WIDTH + 1];
+
+	if (plen != clen)
+		return 0;
+	for (i = 0; (i < plen) && (prev[i] == cur[i]); i++)
+		;
+	if ((i == plen) || !isdigit((int)prev[i]) || !isdigit((int)cur[i]))
+		return 0;
+	while ((i > 0) && isdigit((int)prev[i - 1]))
+		i--;
+	for (w = 0; (i + w < plen) && isdigit((int)prev[i + w]); w++)
+		if (!isdigit((int)cur[i + w]))
+			return 0;
+	if ((i + w < clen) && isdigit((int)cur[i + w]))
+		return 0;
+	if ((w > VNODE_RANGE_WIDTH) || (memcmp(prev + i + w, cur + i + w, plen - i - w) != 0))
+		return 0;
+	if ((*off >= 0) && ((*off != (long)i) || (*width != w)))
+		return 0;
+
+	memcpy(pnum, prev + i, w);
+	pnum[w] = '\0';
+	memcpy(cnum, cur + i, w);
+	cnum[w] = '\0';
+	if (strtoul(cnum, NULL, 10) != strtoul(pnum, NULL, 10) + 1)
+		return 0;
+	*off = (long)i;
+	*width = w;
+	return 1;
+}
+
+/**
+ * @brief
+ * 	Copy part of a term of a host or vnode list into a condensed list,
+ * 	escaping the characters that have a meaning there.
+ *
+ * @param[out] out - where to copy to
+ * @param[in] str - the part of the term
+ * @param[in] len - its length
+ *
+ * @return	char * - the end of the copy in out
+ */
+static char *
+vnlist_put_escaped(char *out, char *str, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		if ((str[i] == '\\') || (str[i] == '[') || (str[i] == ']'))
+			*out++ = '\\';
+		*out++ = str[i];
+	}
+	return out;
+}
+
+/**
+ * @brief
+ * 	Condense a '+' separated host or vnode list, an exec_vnode, exec_host
+ * 	or schedselect value, by writing each run of terms that differ only in
+ * 	consecutive numbers as one term with the range of the numbers.  With
+ * 	n0001 to n4000 the exec_vnode
+ * 	(n0001:ncpus=64)+(n0002:ncpus=64)+...+(n4000:ncpus=64)
+ * 	becomes %(n[0001-4000]:ncpus=64).  A '[', ']' or '\\' of the list is
+ * 	escaped by a '\\' in the condensed list.
+ *
+ * @param[in] str - the list
+ *
+ * @return	char *
+ * @retval	the condensed list, VNODE_LIST_CONDENSED first, to be freed by the
+ *		caller
+ * @retval	NULL	the list is not made shorter, or out of memory
+ */
+char *
+condense_vnode_list(char *str)
+{
+	char *out;
+	char *op;
+	char *p;
+	char *q;
+	char *r;
+	size_t len;
+	size_t tlen;
+	size_t qlen;
+	size_t rlen;
+	size_t width = 0;
+	long off;
+	int n;
+
+	if ((str == NULL) || (*str == VNODE_LIST_CONDENSED) || (strchr(str, '+') == NULL))
+		return NULL;
+	len = strlen(str);
+	/* each character escaped at worst */
+	if ((out = malloc(2 * len + 2)) == NULL)
+		return NULL;
+	op = out;
+	*op++ = VNODE_LIST_CONDENSED;
+
+	p = str;
+	while (*p != '\0') {
+		tlen = vnlist_term_len(p);
+
+		/* find the last term of the run starting at p */
+		q = p;
+		qlen = tlen;
+		off = -1;
+		for (n = 1; q[qlen] == '+'; n++) {
+			r = q + qlen + 1;
+			rlen = vnlist_term_len(r);
+			if (!vnlist_follows(q, qlen, r, rlen, &off, &width))
+				break;
+			q = r;
+			qlen = rlen;
+		}
+
+		if (p != str)
+			*op++ = '+';
+		if (n > 1) {
+			op = vnlist_put_escaped(op, p, (size_t)off);
+			*op++ = '[';
+			memcpy(op, p + off, width);
+			op += width;
+			*op++ = '-';
+			memcpy(op, q + off, width);
+			op += width;
+			*op++ = ']';
+			op = vnlist_put_escaped(op, p + off + width, tlen - off - width);
+		} else
+			op = vnlist_put_escaped(op, p, tlen);
+
+		p = q + qlen;
+		if (*p == '+')
+			p++;
+	}
+	*op = '\0';
+
+	if ((size_t)(op - out) >= len) {
+		free(out);
+		return NULL;
+	}
+	return out;
+}
+
+/**
+ * @brief
+ * 	Append to the buffer of expand_vnode_list(), growing it as needed.
+ *
+ * @param[in,out] buf - the buffer
+ * @param[in,out] used - bytes in it
+ * @param[in,out] size - its size
+ * @param[in] str - what to append
+ * @param[in] len - its length
+ * @param[in] unescape - drop the '\\' escapes of str
+ *
+ * @return	int
+ * @retval	0	appended
+ * @retval	-1	out of memory
+ */
+static int
+vnlist_append(char **buf, size_t *used, size_t *size, char *str, size_t len, int unescape)
+{
+	size_t i;
+	char *tmp;
+
+	if (*used + len + 1 > *size) {
+		size_t nsize = (*size * 2 > *used + len + 1) ? *size * 2 : *used + len + 1;
+
+		if ((tmp = realloc(*buf, nsize)) == NULL)
+			return -1;
+		*buf = tmp;
+		*size = nsize;
+	}
+	for (i = 0; i < len; i++) {
+		if (unescape && (str[i] == '\\') && (i + 1 < len))
+			i++;
+		(*buf)[(*used)++] = str[i];
+	}
+	(*buf)[*used] = '\0';
+	return 0;
+}
+
+/**
+ * @brief
+ * 	Expand a host or vnode list condensed by condense_vnode_list() back
+ * 	into its '+' separated terms.
+ *
+ * @param[in] str - the condensed list, VNODE_LIST_CONDENSED first
+ *
+ * @return	char *
+ * @retval	the list, to be freed by the caller
+ * @retval	NULL	str is not a condensed list, or out of memory
+ */
+char *
+expand_vnode_list(char *str)
+{
+	char *buf = NULL;
+	size_t used = 0;
+	size_t size;
+	char *p;
+	char *lo;
+	char *hi;
+	char *end;
+	char *range;
+	size_t tlen;
+	size_t width;
+	unsigned long v;
+	unsigned long first;
+	unsigned long last;
+	char num[VNODE_RANGE_WIDTH + 2];
+
+	if ((str == NULL) || (*str != VNODE_LIST_CONDENSED))
+		return NULL;
+	p = str + 1;
+	/* a condensed list is mostly ranges, start with room to spare */
+	size = 4 * strlen(p) + 1;
+	if ((buf = malloc(size)) == NULL)
+		return NULL;
+	*buf = '\0';
+
+	while (*p != '\0') {
+		tlen = vnlist_term_len(p);
+		end = p + tlen;
+
+		/* the range is the first '[' not escaped */
+		for (range = p; range < end; range++) {
+			if (*range == '\\')
+				range++;
+			else if (*range == '[')
+				break;
+		}
+		if (used > 0 && vnlist_append(&buf, &used, &size, "+", 1, 0) != 0)
+			goto err;
+		if (range >= end) {
+			if (vnlist_append(&buf, &used, &size, p, tlen, 1) != 0)
+				goto err;
+		} else {
+			lo = range + 1;
+			for (width = 0; isdigit((int)lo[width]); width++)
+				;
+			hi = lo + width + 1;
+			if ((width == 0) || (width > VNODE_RANGE_WIDTH) || (lo[width] != '-') ||
+				(strspn(hi, "0123456789") != width) || (hi[width] != ']'))
+				goto err;
+			first = strtoul(lo, NULL, 10);
+			last = strtoul(hi, NULL, 10);
+			if (last < first)
+				goto err;
+			for (v = first; v <= last; v++) {
+				snprintf(num, sizeof(num), "%0*lu", (int)width, v);
+				if (((v > first) &&
+					(vnlist_append(&buf, &used, &size, "+", 1, 0) != 0)) ||
+					(vnlist_append(&buf, &used, &size, p, range - p, 1) != 0) ||
+					(vnlist_append(&buf, &used, &size, num, width, 0) != 0) ||
+					(vnlist_append(&buf, &used, &size, hi + width + 1,
+					end - (hi + width + 1), 1) != 0))
+					goto err;
+			}
+		}
+
+		p = end;
+		if (*p == '+')
+			p++;
+	}
+	return buf;
+
+err:
+	free(buf);
+	return NULL;
+}
@@ -59,6 +59,7 @@
 #include <sys/stat.h>
 #include <pwd.h>
 #include <pthread.h>
+#include <time.h>
 #ifndef WIN32
 #include <dlfcn.h>
 #include <grp.h>
@@ -78,6 +79,78 @@ int (*munge_encode_ptr)(char **, void *, const void *, int); /* MUNGE munge_enco
 int (*munge_decode_ptr)(const char *cred, void *, void **, int *, uid_t *, gid_t *); /* MUNGE munge_decode() function pointer */
 char * (*munge_strerror_ptr) (int); /* MUNGE munge_stderror() function pointer */
 
+#define MUNGE_USER_CACHE_SIZE	64	/* uids remembered by munge_user_lookup() */
+#define MUNGE_USER_CACHE_TTL	60	/* seconds a cached lookup stays valid */
+
+/* user and group names of a uid, as last returned by getpwuid/getgrgid */
+static struct munge_user_cache {
+	uid_t	uid;
+	time_t	expires;
+	char	user[PBS_MAXUSER + 1];
+	char	group[PBS_MAXGRPN + 1];
+} munge_user_cache[MUNGE_USER_CACHE_SIZE];
+static pthread_mutex_t munge_user_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief
+ *      Find the user name and primary group name of a uid.
+ *
+ * @par
+ *	Every MUNGE encode and decode needs these, and on sites where the
+ *	password database is remote (LDAP, NIS) the lookups can cost more
+ *	than the MUNGE round trip itself.  Results are kept for
+ *	MUNGE_USER_CACHE_TTL seconds so that a burst of connections from
+ *	the same user pays for them once.
+ *
+ * @param[in]  uid	user to look up
+ * @param[out] user	user name, at least PBS_MAXUSER + 1 bytes
+ * @param[out] group	group name, at least PBS_MAXGRPN + 1 bytes
+ * @param[in/out] ebuf	Error message is updated here
+ * @param[in] ebufsz	size of the error message buffer
+ *
+ * @return error code
+ * @retval  0 - Success
+ * @retval -1 - Failure
+ */
+static int
+munge_user_lookup(uid_t uid, char *user, char *group, char *ebuf, int ebufsz)
+{
+	struct munge_user_cache *ent;
+	struct passwd *pwent;
+	struct group *grp;
+	time_t now = time(NULL);
+
+	ent = &munge_user_cache[uid % MUNGE_USER_CACHE_SIZE];
+	pthread_mutex_lock(&munge_user_cache_lock);
+	if (ent->expires > now && ent->uid == uid) {
+		strcpy(user, ent->user);
+		strcpy(group, ent->group);
+		pthread_mutex_unlock(&munge_user_cache_lock);
+		return 0;
+	}
+	pthread_mutex_unlock(&munge_user_cache_lock);
+
+	if ((pwent = getpwuid(uid)) == NULL) {
+		snprintf(ebuf, ebufsz, "Failed to obtain user-info for uid = %d", uid);
+		return -1;
+	}
+	snprintf(user, PBS_MAXUSER + 1, "%s", pwent->pw_name);
+
+	if ((grp = getgrgid(pwent->pw_gid)) == NULL) {
+		snprintf(ebuf, ebufsz, "Failed to obtain group-info for gid=%d", pwent->pw_gid);
+		return -1;
+	}
+	snprintf(group, PBS_MAXGRPN + 1, "%s", grp->gr_name);
+
+	pthread_mutex_lock(&munge_user_cache_lock);
+	ent->uid = uid;
+	ent->expires = now + MUNGE_USER_CACHE_TTL;
+	strcpy(ent->user, user);
+	strcpy(ent->group, group);
+	pthread_mutex_unlock(&munge_user_cache_lock);
+	return 0;
+}
+
 /**
  * @brief
  *      Check if libmunge.so shared library is present in the system
@@ -149,10 +222,9 @@ char *
 pbs_get_munge_auth_data(int fromsvr, char *ebuf, int ebufsz)
 {
 	char *cred = NULL;
-	uid_t myrealuid;
-	struct passwd *pwent;
-	struct group *grp;
-	char payload[2 + PBS_MAXUSER + PBS_MAXGRPN + 1] = { '\0' };
+	char user[PBS_MAXUSER + 1];
+	char group[PBS_MAXGRPN + 1];
+	char payload[2 + PBS_MAXUSER + 1 + PBS_MAXGRPN + 1] = { '\0' };
 	int munge_err = 0;
 
 	pthread_once(&munge_init_once, init_munge);
@@ -162,23 +234,13 @@ pbs_get_munge_auth_data(int fromsvr, char *ebuf, int ebufsz)
 		goto err;
 	}
 
-	myrealuid = getuid();
-	pwent = getpwuid(myrealuid);
-	if (pwent == NULL) {
-		snprintf(ebuf, ebufsz, "Failed to obtain user-info for uid = %d", myrealuid);
-		pbs_errno = PBSE_SYSTEM;
-		goto err;
-	}
-
-	grp = getgrgid(pwent->pw_gid);
-	if (grp == NULL) {
-		snprintf(ebuf, ebufsz, "Failed to obtain group-info for gid=%d", pwent->pw_gid);
+	if (munge_user_lookup(getuid(), user, group, ebuf, ebufsz) != 0) {
 		pbs_errno = PBSE_SYSTEM;
 		goto err;
 	}
 
 	/* if the connection is being initiated from server, encode a 1 before the user:grp */
-	snprintf(payload, PBS_MAXUSER + PBS_MAXGRPN + 2, "%c:%s:%s", (fromsvr ? '1' : '0'), pwent->pw_name, grp->gr_name);
+	snprintf(payload, sizeof(payload), "%c:%s:%s", (fromsvr ? '1' : '0'), user, group);
 
 	munge_err = munge_encode_ptr(&cred, NULL, payload, strlen(payload));
 	if (munge_err != 0) {
@@ -214,8 +276,8 @@ pbs_munge_validate(void *auth_data, int *fromsvr, char *ebuf, int ebufsz)
 	uid_t uid;
 	gid_t gid;
 	int recv_len = 0;
-	struct passwd *pwent = NULL;
-	struct group *grp = NULL;
+	char user[PBS_MAXUSER + 1];
+	char group[PBS_MAXGRPN + 1];
 	void *recv_payload = NULL;
 	int munge_err = 0;
 	char *p;
@@ -237,15 +299,8 @@ pbs_munge_validate(void *auth_data, int *fromsvr, char *ebuf, int ebufsz)
 		goto err;
 	}
 
-	if ((pwent = getpwuid(uid)) == NULL) {
-		snprintf(ebuf, ebufsz, "Failed to obtain user-info for uid = %d", uid);
-		goto err;
-	}
-
-	if ((grp = getgrgid(pwent->pw_gid)) == NULL) {
-		snprintf(ebuf, ebufsz, "Failed to obtain group-info for gid=%d", gid);
+	if (munge_user_lookup(uid, user, group, ebuf, ebufsz) != 0)
 		goto err;
-	}
 
 	/* parse the recv_payload past the first two characters */
 	p = (char *) recv_payload;
@@ -254,7 +309,7 @@ pbs_munge_validate(void *auth_data, int *fromsvr, char *ebuf, int ebufsz)
 
 	p = strtok(p + 2, ":");
 
-	if (p && (strncmp(pwent->pw_name, p, PBS_MAXUSER) == 0)) /* inline with current pbs_iff we compare with username only */
+	if (p && (strncmp(user, p, PBS_MAXUSER) == 0)) /* inline with current pbs_iff we compare with username only */
 		rc = 0;
 	else
 		snprintf(ebuf, ebufsz, "User credentials do not match");
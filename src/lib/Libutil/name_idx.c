@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+/**
+ * @file	name_idx.c
+ *
+ * @brief
+ *	An open-addressed hash index keyed by name, used by the server to find
+ *	jobs, reservations, queues and vnodes without allocating on each lookup.
+ *
+ * Functions included are:
+ *	create_name_idx()
+ *	create_name_idx_nocase()
+ *	free_name_idx()
+ *	find_name_idx()
+ *	name_idx_add_del()
+ */
+
+#include <pbs_config.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "name_idx.h"
+
+#define NAME_IDX_INITSIZE	64
+
+/* marks a slot whose key was deleted, so probing continues past it */
+static char name_idx_deleted[] = "";
+
+static unsigned int name_idx_hash(char *, int);
+static name_idx_ent *name_idx_slot(name_idx *, char *, unsigned int);
+static int name_idx_resize(name_idx *, unsigned int);
+
+/**
+ * @brief
+ *	FNV-1a hash of a null-terminated string
+ *
+ * @param[in]	key - string to hash
+ * @param[in]	nocase - fold the key to lower case first
+ *
+ * @return	unsigned int
+ * @retval	the hash value
+ */
+static unsigned int
+name_idx_hash(char *key, int nocase)
+{
+	unsigned int h = 2166136261U;
+
+	if (nocase) {
+		while (*key) {
+			h ^= (unsigned char)tolower((unsigned char)*key++);
+			h *= 16777619U;
+		}
+		return h;
+	}
+	while (*key) {
+		h ^= (unsigned char)*key++;
+		h *= 16777619U;
+	}
+	return h;
+}
+
+/**
+ * @brief
+ *	Find the slot holding a key
+ *
+ * @param[in]	idx  - the index
+ * @param[in]	key  - key to look for
+ * @param[in]	hash - name_idx_hash() of key
+ *
+ * @return	name_idx_ent *
+ * @retval	the slot holding key
+ * @retval	NULL - key is not in the index
+ */
+static name_idx_ent *
+name_idx_slot(name_idx *idx, char *key, unsigned int hash)
+{
+	unsigned int mask = idx->ni_size - 1;
+	unsigned int i;
+	unsigned int n;
+	name_idx_ent *pe;
+
+	for (i = hash & mask, n = 0; n < idx->ni_size; i = (i + 1) & mask, n++) {
+		pe = &idx->ni_ents[i];
+		if (pe->ne_key == NULL)
+			return NULL;
+		if ((pe->ne_key != name_idx_deleted) && (pe->ne_hash == hash) &&
+			((idx->ni_nocase ? strcasecmp(pe->ne_key, key) :
+			strcmp(pe->ne_key, key)) == 0))
+			return pe;
+	}
+	return NULL;
+}
+
+/**
+ * @brief
+ *	Rebuild the index into a table of a new size, dropping delete markers
+ *
+ * @param[in,out]	idx  - the index
+ * @param[in]		size - new number of slots, a power of two
+ *
+ * @return	int
+ * @retval	0  - success
+ * @retval	-1 - out of memory, the index is unchanged
+ */
+static int
+name_idx_resize(name_idx *idx, unsigned int size)
+{
+	name_idx_ent *old = idx->ni_ents;
+	unsigned int oldsize = idx->ni_size;
+	unsigned int mask = size - 1;
+	unsigned int i;
+	unsigned int j;
+
+	idx->ni_ents = calloc(size, sizeof(name_idx_ent));
+	if (idx->ni_ents == NULL) {
+		idx->ni_ents = old;
+		return -1;
+	}
+	idx->ni_size = size;
+	idx->ni_deleted = 0;
+
+	for (i = 0; i < oldsize; i++) {
+		if ((old[i].ne_key == NULL) || (old[i].ne_key == name_idx_deleted))
+			continue;
+		for (j = old[i].ne_hash & mask; idx->ni_ents[j].ne_key != NULL; j = (j + 1) & mask)
+			;
+		idx->ni_ents[j] = old[i];
+	}
+	free(old);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Create an empty name index
+ *
+ * @return	name_idx *
+ * @retval	the new index
+ * @retval	NULL - out of memory
+ *
+ * @par MT-safe: Yes
+ */
+name_idx *
+create_name_idx(void)
+{
+	name_idx *idx;
+
+	idx = malloc(sizeof(name_idx));
+	if (idx == NULL)
+		return NULL;
+
+	idx->ni_ents = calloc(NAME_IDX_INITSIZE, sizeof(name_idx_ent));
+	if (idx->ni_ents == NULL) {
+		free(idx);
+		return NULL;
+	}
+	idx->ni_size = NAME_IDX_INITSIZE;
+	idx->ni_used = 0;
+	idx->ni_deleted = 0;
+	idx->ni_nocase = 0;
+	return idx;
+}
+
+/**
+ * @brief
+ *	Create an empty name index whose keys match without regard to case
+ *
+ * @return	name_idx *
+ * @retval	the new index
+ * @retval	NULL - out of memory
+ *
+ * @par MT-safe: Yes
+ */
+name_idx *
+create_name_idx_nocase(void)
+{
+	name_idx *idx;
+
+	if ((idx = create_name_idx()) != NULL)
+		idx->ni_nocase = 1;
+	return idx;
+}
+
+/**
+ * @brief
+ *	Free a name index and its copies of the keys, but not the objects
+ *	the keys name
+ *
+ * @param[in]	idx - the index to free
+ *
+ * @return	void
+ *
+ * @par MT-safe: Yes
+ */
+void
+free_name_idx(name_idx *idx)
+{
+	unsigned int i;
+
+	if (idx == NULL)
+		return;
+	for (i = 0; i < idx->ni_size; i++) {
+		if ((idx->ni_ents[i].ne_key != NULL) &&
+			(idx->ni_ents[i].ne_key != name_idx_deleted))
+			free(idx->ni_ents[i].ne_key);
+	}
+	free(idx->ni_ents);
+	free(idx);
+}
+
+/**
+ * @brief
+ *	Find the object a name refers to
+ *
+ * @param[in]	idx - the index to search
+ * @param[in]	key - name to look for
+ *
+ * @return	void *
+ * @retval	the data added with the key
+ * @retval	NULL - key is not in the index
+ *
+ * @par MT-safe: Yes
+ */
+void *
+find_name_idx(name_idx *idx, char *key)
+{
+	name_idx_ent *pe;
+
+	if ((idx == NULL) || (key == NULL))
+		return NULL;
+
+	pe = name_idx_slot(idx, key, name_idx_hash(key, idx->ni_nocase));
+	if (pe == NULL)
+		return NULL;
+	return pe->ne_data;
+}
+
+/**
+ * @brief
+ *	Add a key (and its data) to or delete a key from a name index
+ *
+ * @param[in,out]	idx  - the index
+ * @param[in]		key  - name of the object
+ * @param[in]		data - object to add (not required for delete)
+ * @param[in]		op   - Operation to be performed
+ *			 0 - NAME_IDX_OP_ADD
+ *			 1 - NAME_IDX_OP_DEL
+ *
+ * @return	Error code
+ * @retval	-1    - Failure (out of memory, or key already present on add)
+ * @retval	 0    - Success
+ * @retval	 1    - Not found (in case of delete)
+ *
+ * @par MT-safe: Yes
+ */
+int
+name_idx_add_del(name_idx *idx, char *key, void *data, int op)
+{
+	unsigned int hash;
+	unsigned int mask;
+	unsigned int i;
+	name_idx_ent *pe;
+	char *copy;
+
+	if ((idx == NULL) || (key == NULL))
+		return -1;
+
+	hash = name_idx_hash(key, idx->ni_nocase);
+	pe = name_idx_slot(idx, key, hash);
+
+	if (op == NAME_IDX_OP_DEL) {
+		if (pe == NULL)
+			return 1;
+		free(pe->ne_key);
+		pe->ne_key = name_idx_deleted;
+		pe->ne_data = NULL;
+		idx->ni_used--;
+		idx->ni_deleted++;
+		return 0;
+	}
+
+	if (pe != NULL)
+		return -1;
+
+	/* keep at least a quarter of the slots empty so probes stay short */
+	if ((idx->ni_used + idx->ni_deleted + 1) * 4 > idx->ni_size * 3) {
+		if (name_idx_resize(idx, (idx->ni_used + 1) * 2 > idx->ni_size ?
+			idx->ni_size * 2 : idx->ni_size) != 0) {
+			if (idx->ni_used + idx->ni_deleted + 1 >= idx->ni_size)
+				return -1;
+		}
+	}
+
+	if ((copy = strdup(key)) == NULL)
+		return -1;
+
+	mask = idx->ni_size - 1;
+	for (i = hash & mask; ; i = (i + 1) & mask) {
+		pe = &idx->ni_ents[i];
+		if ((pe->ne_key == NULL) || (pe->ne_key == name_idx_deleted))
+			break;
+	}
+	if (pe->ne_key == name_idx_deleted)
+		idx->ni_deleted--;
+	idx->ni_used++;
+	pe->ne_key = copy;
+	pe->ne_hash = hash;
+	pe->ne_data = data;
+	return 0;
+}
@@ -158,9 +158,8 @@ get_num_occurrences(char *rrule, time_t dtstart, char *tz)
  * 	index, and start time. This function assumes that the
  * 	time dtsart passed in is the one to start the occurrence from.
  *
- * @par	NOTE: This function should be made reentrant such that
- * 	it can be looped over without having to loop over every occurrence
- * 	over and over again.
+ * @par	NOTE: Each call walks the recurrence from dtstart up to idx. Callers
+ * 	that need every occurrence should use get_occurrences instead.
  *
  * @param[in] rrule - The recurrence rule as defined by the user
  * @param[in] dtstart - The start time from which to start
@@ -233,6 +232,89 @@ get_occurrence(char *rrule, time_t dtstart, char *tz, int idx)
 #endif
 }
 
+/**
+ * @brief
+ * 	Compute the first 'count' occurrences of a recurrence rule with a single
+ * 	walk of the recurrence, so that occrs[i] is get_occurrence(rrule,
+ * 	dtstart, tz, i + 1).
+ *
+ * @param[in] rrule - The recurrence rule as defined by the user
+ * @param[in] dtstart - The start time from which to start
+ * @param[in] tz - The timezone associated to the recurrence rule
+ * @param[in] count - The number of occurrences to compute
+ * @param[out] occrs - Array of at least count entries to fill
+ *
+ * @return	int
+ * @retval	the number of entries filled; the remaining ones, past the end of
+ * 		the recurrence or of libical's Unix time in 2038, are set to -1
+ * @retval	-1	- the timezone is unknown
+ *
+ */
+int
+get_occurrences(char *rrule, time_t dtstart, char *tz, int count, time_t *occrs)
+{
+	int i;
+
+#ifdef LIBICAL
+	struct icalrecurrencetype rt;
+	struct icaltimetype start;
+	icaltimezone *localzone;
+	struct icaltimetype next;
+	struct icalrecur_iterator_impl *itr;
+	int filled = 0;
+
+	if (rrule == NULL) {
+		for (i = 0; i < count; i++)
+			occrs[i] = dtstart;
+		return count;
+	}
+
+	for (i = 0; i < count; i++)
+		occrs[i] = -1;
+
+	if (tz == NULL)
+		return -1;
+
+	icalerror_clear_errno();
+
+	icalerror_set_error_state(ICAL_PARSE_ERROR, ICAL_ERROR_NONFATAL);
+#ifdef LIBICAL_API2
+	icalerror_set_errors_are_fatal(0);
+#else
+	icalerror_errors_are_fatal = 0;
+#endif
+	localzone = icaltimezone_get_builtin_timezone(tz);
+
+	if (localzone == NULL)
+		return -1;
+
+	rt = icalrecurrencetype_from_string(rrule);
+
+	start = icaltime_from_timet_with_zone(dtstart, 0, NULL);
+	icaltimezone_convert_time(&start, icaltimezone_get_utc_timezone(), localzone);
+
+	itr = (struct icalrecur_iterator_impl*) icalrecur_iterator_new(rt, start);
+	for (i = 0; i < count; i++) {
+		next = icalrecur_iterator_next(itr);
+		if (icaltime_is_null_time(next))
+			break;
+		icaltimezone_convert_time(&next, localzone,
+			icaltimezone_get_utc_timezone());
+		occrs[i] = icaltime_as_timet(next);
+		filled++;
+	}
+	icalrecur_iterator_free(itr);
+
+	return filled;
+
+#else
+
+	for (i = 0; i < count; i++)
+		occrs[i] = dtstart;
+	return count;
+#endif
+}
+
 /**
  * @brief
  * 	Check if a recurrence rule is valid and consistent.
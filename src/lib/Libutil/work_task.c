@@ -51,6 +51,7 @@
 #include "server_limits.h"
 #include "list_link.h"
 #include "work_task.h"
+#include "libutil.h"
 
 
 /* Global Data Items: */
@@ -61,6 +62,127 @@ extern pbs_list_head task_list_event; /* list of tasks responding to an event */
 extern int svr_delay_entry;
 extern time_t	time_now;
 
+/*
+ * Timed tasks are kept on task_list_timed in no particular order, and
+ * ordered by a binary heap of their start times.  Tasks with the same
+ * start time run in the order they were set, as when the list was kept
+ * sorted.
+ */
+struct timed_ent {
+	struct work_task	*te_task;
+	unsigned long		 te_seq;	/* order in which the task was set */
+};
+
+static struct timed_ent	*timed_heap = NULL;
+static int		 timed_heap_size = 0;	/* number of slots */
+static int		 timed_heap_used = 0;	/* slots holding a task */
+static unsigned long	 timed_seq = 0;
+
+/* freed work tasks kept for reuse */
+static pbs_freelist	 work_task_pool =
+	PBS_FREELIST_INIT("work_task", struct work_task, 4096);
+
+#define TIMED_HEAP_INITSIZE	256
+#define TIMED_BEFORE(a, b) \
+	(((a)->te_task->wt_event < (b)->te_task->wt_event) || \
+	(((a)->te_task->wt_event == (b)->te_task->wt_event) && \
+	((a)->te_seq < (b)->te_seq)))
+
+/**
+ * @brief
+ *	Place a heap entry in slot 'i' and record the slot in its task.
+ *
+ * @param[in]	i - slot
+ * @param[in]	pent - entry to place
+ */
+static void
+timed_heap_place(int i, struct timed_ent *pent)
+{
+	timed_heap[i] = *pent;
+	timed_heap[i].te_task->wt_heapidx = i;
+}
+
+/**
+ * @brief
+ *	Restore the heap order around slot 'i', whose entry may be earlier
+ *	than its parent or later than its children.
+ *
+ * @param[in]	i - slot
+ */
+static void
+timed_heap_fix(int i)
+{
+	struct timed_ent ent;
+	int child;
+
+	ent = timed_heap[i];
+	while (i > 0 && TIMED_BEFORE(&ent, &timed_heap[(i - 1) / 2])) {
+		timed_heap_place(i, &timed_heap[(i - 1) / 2]);
+		i = (i - 1) / 2;
+	}
+	while ((child = 2 * i + 1) < timed_heap_used) {
+		if (child + 1 < timed_heap_used &&
+			TIMED_BEFORE(&timed_heap[child + 1], &timed_heap[child]))
+			child++;
+		if (!TIMED_BEFORE(&timed_heap[child], &ent))
+			break;
+		timed_heap_place(i, &timed_heap[child]);
+		i = child;
+	}
+	timed_heap_place(i, &ent);
+}
+
+/**
+ * @brief
+ *	Add a timed task to the heap.
+ *
+ * @param[in]	ptask - the task
+ *
+ * @return int
+ * @retval 0	- success
+ * @retval -1	- out of memory
+ */
+static int
+timed_heap_add(struct work_task *ptask)
+{
+	struct timed_ent *pnew;
+	int size;
+
+	if (timed_heap_used == timed_heap_size) {
+		size = timed_heap_size ? timed_heap_size * 2 : TIMED_HEAP_INITSIZE;
+		pnew = realloc(timed_heap, size * sizeof(struct timed_ent));
+		if (pnew == NULL)
+			return -1;
+		timed_heap = pnew;
+		timed_heap_size = size;
+	}
+	timed_heap[timed_heap_used].te_task = ptask;
+	timed_heap[timed_heap_used].te_seq = timed_seq++;
+	ptask->wt_heapidx = timed_heap_used++;
+	timed_heap_fix(ptask->wt_heapidx);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Remove a task from the heap, if it is there.
+ *
+ * @param[in]	ptask - the task
+ */
+static void
+timed_heap_del(struct work_task *ptask)
+{
+	int i;
+
+	if ((i = ptask->wt_heapidx) < 0)
+		return;
+	ptask->wt_heapidx = -1;
+	if (--timed_heap_used > i) {
+		timed_heap_place(i, &timed_heap[timed_heap_used]);
+		timed_heap_fix(i);
+	}
+}
+
 /**
  *
  * @brief
@@ -82,9 +204,8 @@ extern time_t	time_now;
 struct work_task *set_task(enum work_type type, long event_id, void (*func)(struct work_task *) , void *parm)
 {
 	struct work_task *pnew;
-	struct work_task *pold;
 
-	pnew = (struct work_task *)malloc(sizeof(struct work_task));
+	pnew = (struct work_task *)freelist_alloc(&work_task_pool);
 	if (pnew == NULL)
 		return NULL;
 	CLEAR_LINK(pnew->wt_linkall);
@@ -99,21 +220,16 @@ struct work_task *set_task(enum work_type type, long event_id, void (*func)(stru
 	pnew->wt_parm3 = NULL;
 	pnew->wt_aux   = 0;
 	pnew->wt_aux2  = 0;
+	pnew->wt_heapidx = -1;
 
 	if (type == WORK_Immed)
 		append_link(&task_list_immed, &pnew->wt_linkall, pnew);
 	else if (type == WORK_Timed) {
-		pold = (struct work_task *)GET_NEXT(task_list_timed);
-		while (pold) {
-			if (pold->wt_event > pnew->wt_event)
-				break;
-			pold = (struct work_task *)GET_NEXT(pold->wt_linkall);
+		if (timed_heap_add(pnew) == -1) {
+			freelist_free(&work_task_pool, pnew);
+			return NULL;
 		}
-		if (pold)
-			insert_link(&pold->wt_linkall, &pnew->wt_linkall, pnew,
-				LINK_INSET_BEFORE);
-		else
-			append_link(&task_list_timed, &pnew->wt_linkall, pnew);
+		append_link(&task_list_timed, &pnew->wt_linkall, pnew);
 	} else
 		append_link(&task_list_event, &pnew->wt_linkall, pnew);
 	return (pnew);
@@ -135,12 +251,13 @@ struct work_task *set_task(enum work_type type, long event_id, void (*func)(stru
 void
 dispatch_task(struct work_task *ptask)
 {
+	timed_heap_del(ptask);
 	delete_link(&ptask->wt_linkall);
 	delete_link(&ptask->wt_linkobj);
 	delete_link(&ptask->wt_linkobj2);
 	if (ptask->wt_func)
 		ptask->wt_func(ptask);		/* dispatch process function */
-	(void)free(ptask);
+	freelist_free(&work_task_pool, ptask);
 }
 
 /**
@@ -154,10 +271,11 @@ dispatch_task(struct work_task *ptask)
 void
 delete_task(struct work_task *ptask)
 {
+	timed_heap_del(ptask);
 	delete_link(&ptask->wt_linkobj);
 	delete_link(&ptask->wt_linkobj2);
 	delete_link(&ptask->wt_linkall);
-	(void)free(ptask);
+	freelist_free(&work_task_pool, ptask);
 }
 
 /**
@@ -307,7 +425,8 @@ default_next_task(void)
 	while ((ptask=(struct work_task *)GET_NEXT(task_list_immed)) != NULL)
 		dispatch_task(ptask);
 
-	while ((ptask=(struct work_task *)GET_NEXT(task_list_timed))!=NULL) {
+	while (timed_heap_used > 0) {
+		ptask = timed_heap[0].te_task;
 		if ((delay = ptask->wt_event - time_now) > 0) {
 			if (tilwhen > delay)
 				tilwhen = delay;
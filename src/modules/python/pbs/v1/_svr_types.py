@@ -59,6 +59,7 @@ try:
     if _pbs_v1.get_python_daemon_name() == "pbs_python":
         from _pbs_ifl import *
         from pbs_ifl import *
+        import _pbs_ifl_stat
 except:
     pass
 
@@ -85,6 +86,76 @@ def get_local_nodename():
     return(_pbs_v1.get_local_host_name())
 
 
+#
+# _pbs_stat_set_attrs: set on 'obj' the (name, resource, value) attributes
+#                      returned by _pbs_ifl_stat for an object of 'objtype'
+#                      ("job", "queue", "vnode", "resv" or "server"), and
+#                      write them to the server data file if there is one.
+#                      Returns False if the job is not in 'filter_queue'.
+def _pbs_stat_set_attrs(obj, objtype, attrs, header_str, server_data_fp,
+                        filter_queue=None):
+    for (n, r, v) in attrs:
+
+        if(objtype == "vnode"):
+            if(n == ATTR_NODE_state):
+                v = _pbs_v1.str_to_vnode_state(v)
+            elif(n == ATTR_NODE_ntype):
+                v = _pbs_v1.str_to_vnode_ntype(v)
+            elif(n == ATTR_NODE_Sharing):
+                v = _pbs_v1.str_to_vnode_sharing(v)
+
+        elif(objtype == "job"):
+            if((filter_queue != None) and (n == ATTR_queue) and
+                    (filter_queue != v)):
+                return False
+            if n == ATTR_inter or n == ATTR_block or n == ATTR_X11_port:
+                v = int(pbs_bool(v))
+
+        if(r):
+            pr = getattr(obj, n)
+
+            # instantiate Resource_List object if not set
+            if(pr == None):
+                setattr(obj, n)
+
+            pr = getattr(obj, n)
+            if (pr == None):
+                _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
+                               "pbs_statobj: missing %s" % (n))
+                continue
+
+            vo = getattr(pr, r)
+            if(vo == None):
+                setattr(pr, r, v)
+                if server_data_fp:
+                    server_data_fp.write(
+                        "%s.%s[%s]=%s\n" % (header_str, n, r, v))
+            else:
+                # append value...
+                # example: "select=1:ncpus=1,ncpus=1,nodect=1,place=pack"
+                vl = [vo, v]
+                setattr(pr, r, ",".join(vl))
+                if server_data_fp:
+                    server_data_fp.write("%s.%s[%s]=%s\n" % (
+                        header_str, n, r, ",".join(vl)))
+
+        else:
+            vo = getattr(obj, n)
+
+            if(vo == None):
+                setattr(obj, n, v)
+                if server_data_fp:
+                    server_data_fp.write("%s.%s=%s\n" % (header_str, n, v))
+            else:
+                # append value
+                vl = [vo, v]
+                setattr(obj, n, ",".join(vl))
+                if server_data_fp:
+                    server_data_fp.write("%s.%s=%s\n" %
+                                         (header_str, n, ",".join(vl)))
+    return True
+
+
 #
 # pbs_statobj: general-purpose function that connects to server named
 #           'connect_server' or if None, use "localhost", and depending
@@ -130,19 +201,19 @@ def pbs_statobj(objtype, name=None, connect_server=None, filter_queue=None):
         return None
 
     if(objtype == "job"):
-        bs = pbs_statjob(con, name, None, None)
+        bs = _pbs_ifl_stat.stat("job", con, name)
         header_str = "pbs.server().job(%s)" % (name,)
     elif(objtype == "queue"):
-        bs = pbs_statque(con, name, None, None)
+        bs = _pbs_ifl_stat.stat("queue", con, name)
         header_str = "pbs.server().queue(%s)" % (name,)
     elif(objtype == "vnode"):
-        bs = pbs_statvnode(con, name, None, None)
+        bs = _pbs_ifl_stat.stat("vnode", con, name)
         header_str = "pbs.server().vnode(%s)" % (name,)
     elif(objtype == "resv"):
-        bs = pbs_statresv(con, name, None, None)
+        bs = _pbs_ifl_stat.stat("resv", con, name)
         header_str = "pbs.server().resv(%s)" % (name,)
     elif(objtype == "server"):
-        bs = pbs_statserver(con, None, None)
+        bs = _pbs_ifl_stat.stat("server", con)
         header_str = "pbs.server()"
     else:
         _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
@@ -151,19 +222,18 @@ def pbs_statobj(objtype, name=None, connect_server=None, filter_queue=None):
         _pbs_v1.set_python_mode()
         return None
 
-    b = bs
     obj = None
-    while(b):
+    for (bname, battrs) in (bs or []):
         if(objtype == "job"):
-            obj = _job(b.name, connect_server)
+            obj = _job(bname, connect_server)
         elif(objtype == "queue"):
-            obj = _queue(b.name, connect_server)
+            obj = _queue(bname, connect_server)
         elif(objtype == "vnode"):
-            obj = _vnode(b.name, connect_server)
+            obj = _vnode(bname, connect_server)
         elif(objtype == "resv"):
-            obj = _resv(b.name, connect_server)
+            obj = _resv(bname, connect_server)
         elif(objtype == "server"):
-            obj = _server(b.name, connect_server)
+            obj = _server(bname, connect_server)
         else:
             _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
                            "pbs_statobj: Bad object type %s" % (objtype))
@@ -171,77 +241,11 @@ def pbs_statobj(objtype, name=None, connect_server=None, filter_queue=None):
             _pbs_v1.set_python_mode()
             return None
 
-        a = b.attribs
-
-        while(a):
-            n = a.name
-            r = a.resource
-            v = a.value
-
-            if(objtype == "vnode"):
-                if(n == ATTR_NODE_state):
-                    v = _pbs_v1.str_to_vnode_state(v)
-                elif(n == ATTR_NODE_ntype):
-                    v = _pbs_v1.str_to_vnode_ntype(v)
-                elif(n == ATTR_NODE_Sharing):
-                    v = _pbs_v1.str_to_vnode_sharing(v)
-
-            elif(objtype == "job"):
-                if((filter_queue != None) and (n == ATTR_queue) and
-                        (filter_queue != v)):
-                    pbs_disconnect(con)
-                    _pbs_v1.set_python_mode()
-                    return None
-                if n == ATTR_inter or n == ATTR_block or n == ATTR_X11_port:
-                    v = int(pbs_bool(v))
-
-            if(r):
-                pr = getattr(obj, n)
-
-                # instantiate Resource_List object if not set
-                if(pr == None):
-                    setattr(obj, n)
-
-                pr = getattr(obj, n)
-                if (pr == None):
-                    _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
-                                   "pbs_statobj: missing %s" % (n))
-                    a = a.next
-                    continue
-
-                vo = getattr(pr, r)
-                if(vo == None):
-                    setattr(pr, r, v)
-                    if server_data_fp:
-                        server_data_fp.write(
-                            "%s.%s[%s]=%s\n" % (header_str, n, r, v))
-                else:
-                    # append value...
-                    # example: "select=1:ncpus=1,ncpus=1,nodect=1,place=pack"
-                    vl = [vo, v]
-                    setattr(pr, r, ",".join(vl))
-                    if server_data_fp:
-                        server_data_fp.write("%s.%s[%s]=%s\n" % (
-                            header_str, n, r, ",".join(vl)))
-
-            else:
-                vo = getattr(obj, n)
-
-                if(vo == None):
-                    setattr(obj, n, v)
-                    if server_data_fp:
-                        server_data_fp.write("%s.%s=%s\n" % (header_str, n, v))
-                else:
-                    # append value
-                    vl = [vo, v]
-                    setattr(obj, n, ",".join(vl))
-                    if server_data_fp:
-                        server_data_fp.write("%s.%s=%s\n" %
-                                             (header_str, n, ",".join(vl)))
-
-            a = a.next
-
-        b = b.next
+        if not _pbs_stat_set_attrs(obj, objtype, battrs, header_str,
+                                   server_data_fp, filter_queue):
+            pbs_disconnect(con)
+            _pbs_v1.set_python_mode()
+            return None
 
     pbs_disconnect(con)
     _pbs_v1.set_python_mode()
@@ -789,7 +793,7 @@ _server._connect_server = PbsAttributeDescriptor(
 
 #
 # server: this now gets invoked when pbs.server() is called.
-#        if in "pbs_python" mode, would use _pbs_ifl/pbs_ifl wrapped calls for
+#        if in "pbs_python" mode, would use _pbs_ifl_stat/pbs_ifl calls for
 #        querying the server for data; otherwise, use the builtin server()
 #        function in a server hook.
 #
@@ -984,11 +988,14 @@ class pbs_iter():
                     self.con = -1
                     return None
                 elif(self.type == "queues"):
-                    self.bs = pbs_statque(self.con, None, None, None)
+                    self.bs = iter(_pbs_ifl_stat.stat("queue", self.con)
+                                   or [])
                 elif(self.type == "vnodes"):
-                    self.bs = pbs_statvnode(self.con, None, None, None)
+                    self.bs = iter(_pbs_ifl_stat.stat("vnode", self.con)
+                                   or [])
                 elif(self.type == "resvs"):
-                    self.bs = pbs_statresv(self.con, None, None, None)
+                    self.bs = iter(_pbs_ifl_stat.stat("resv", self.con)
+                                   or [])
                 else:
                     _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
                                    "pbs_iter/init: Bad object iterator type %s"
@@ -1058,13 +1065,18 @@ class pbs_iter():
                     return None
 
                 if(self.type == "jobs"):
-                    self.bs = pbs_statjob(self.con, pbs_filter2, None, None)
+                    # a page of jobs at a time, not all of them at once
+                    self.bs = _pbs_ifl_stat.statjob_pages(self.con,
+                                                          pbs_filter2)
                 elif(self.type == "queues"):
-                    self.bs = pbs_statque(self.con, None, None, None)
+                    self.bs = iter(_pbs_ifl_stat.stat("queue", self.con)
+                                   or [])
                 elif(self.type == "vnodes"):
-                    self.bs = pbs_statvnode(self.con, None, None, None)
+                    self.bs = iter(_pbs_ifl_stat.stat("vnode", self.con)
+                                   or [])
                 elif(self.type == "resvs"):
-                    self.bs = pbs_statresv(self.con, None, None, None)
+                    self.bs = iter(_pbs_ifl_stat.stat("resv", self.con)
+                                   or [])
                 else:
                     _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
                                    "pbs_iter/init: Bad object iterator type %s"
@@ -1116,109 +1128,46 @@ class pbs_iter():
                         raise StopIteration
                     return
 
-                b = self.bs
-                job = None
+                b = next(self.bs, None)
+                if b is None:
+                    self.bs = None
+                    pbs_disconnect(self.con)
+                    self.con = -1
+                    raise StopIteration
+                (bname, battrs) = b
 
                 _pbs_v1.set_c_mode()
 
                 server_data_fp = _pbs_v1.get_server_data_fp()
-                if(b):
-                    if(self.type == "jobs"):
-                        _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
-                                       "pbs_iter/next: pbs_python mode not"
-                                       " supported by NAS local mod")
-                        pbs_disconnect(self.con)
-                        self.con = -1
-                        _pbs_v1.set_python_mode()
-                        raise StopIteration
-                    elif(self.type == "queues"):
-                        obj = _queue(b.name, self._connect_server)
-                        header_str = "pbs.server().queue(%s)" % (b.name,)
-                    elif(self.type == "resvs"):
-                        obj = _resv(b.name, self._connect_server)
-                        header_str = "pbs.server().resv(%s)" % (b.name,)
-                    elif(self.type == "vnodes"):
-                        obj = _vnode(b.name, self._connect_server)
-                        header_str = "pbs.server().vnode(%s)" % (b.name,)
-                    else:
-                        _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
-                                       "pbs_iter/next: Bad object iterator "
-                                       "type %s"
-                                       % (self.type))
-                        pbs_disconnect(self.con)
-                        self.con = -1
-                        _pbs_v1.set_python_mode()
-                        raise StopIteration
+                if(self.type == "jobs"):
+                    _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
+                                   "pbs_iter/next: pbs_python mode not"
+                                   " supported by NAS local mod")
+                    pbs_disconnect(self.con)
+                    self.con = -1
+                    _pbs_v1.set_python_mode()
+                    raise StopIteration
+                elif(self.type == "queues"):
+                    obj = _queue(bname, self._connect_server)
+                    header_str = "pbs.server().queue(%s)" % (bname,)
+                elif(self.type == "resvs"):
+                    obj = _resv(bname, self._connect_server)
+                    header_str = "pbs.server().resv(%s)" % (bname,)
+                elif(self.type == "vnodes"):
+                    obj = _vnode(bname, self._connect_server)
+                    header_str = "pbs.server().vnode(%s)" % (bname,)
+                else:
+                    _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
+                                   "pbs_iter/next: Bad object iterator "
+                                   "type %s"
+                                   % (self.type))
+                    pbs_disconnect(self.con)
+                    self.con = -1
+                    _pbs_v1.set_python_mode()
+                    raise StopIteration
 
-                    a = b.attribs
-
-                    while(a):
-                        n = a.name
-                        r = a.resource
-                        v = a.value
-
-                        if(self.type == "vnodes"):
-                            if(n == ATTR_NODE_state):
-                                v = _pbs_v1.str_to_vnode_state(v)
-                            elif(n == ATTR_NODE_ntype):
-                                v = _pbs_v1.str_to_vnode_ntype(v)
-                            elif(n == ATTR_NODE_Sharing):
-                                v = _pbs_v1.str_to_vnode_sharing(v)
-
-                        if(self.type == "jobs"):
-                            if n == ATTR_inter or n == ATTR_block or \
-                                    n == ATTR_X11_port:
-                                v = int(pbs_bool(v))
-
-                        if(r):
-                            pr = getattr(obj, n)
-
-                            # if resource list does not exist, then set it
-                            if(pr == None):
-                                setattr(obj, n)
-
-                            pr = getattr(obj, n)
-                            if (pr == None):
-                                _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
-                                               "pbs_statobj: missing %s" % (n))
-                                a = a.next
-                                continue
-
-                            vo = getattr(pr, r)
-                            if(vo == None):
-                                setattr(pr, r, v)
-                                if server_data_fp:
-                                    server_data_fp.write(
-                                        "%s.%s[%s]=%s\n" % (header_str, n,
-                                                            r, v))
-                            else:
-                                # append value:
-                                # example: "select=1:ncpus=1,ncpus=1,nodect=1,
-                                # place=pack"
-                                vl = [vo, v]
-                                setattr(pr, r, ",".join(vl))
-                                if server_data_fp:
-                                    server_data_fp.write("%s.%s[%s]=%s\n" % (
-                                        header_str, n, r, ",".join(vl)))
-
-                        else:
-                            vo = getattr(obj, n)
-
-                            if(vo == None):
-                                setattr(obj, n, v)
-                                if server_data_fp:
-                                    server_data_fp.write(
-                                        "%s.%s=%s\n" % (header_str, n, v))
-                            else:
-                                vl = [vo, v]
-                                setattr(obj, n, ",".join(vl))
-                                if server_data_fp:
-                                    server_data_fp.write("%s.%s=%s\n" % (
-                                        header_str, n, ",".join(vl)))
-
-                        a = a.next
-
-                self.bs = b.next
+                _pbs_stat_set_attrs(obj, self.type[:-1], battrs, header_str,
+                                    server_data_fp)
 
                 _pbs_v1.set_python_mode()
                 return obj
@@ -1259,104 +1208,41 @@ class pbs_iter():
                         raise StopIteration
                     return
 
-                b = self.bs
-                job = None
+                b = next(self.bs, None)
+                if b is None:
+                    self.bs = None
+                    pbs_disconnect(self.con)
+                    self.con = -1
+                    raise StopIteration
+                (bname, battrs) = b
 
                 _pbs_v1.set_c_mode()
 
                 server_data_fp = _pbs_v1.get_server_data_fp()
-                if(b):
-                    if(self.type == "jobs"):
-                        obj = _job(b.name, self._connect_server)
-                        header_str = "pbs.server().job(%s)" % (b.name,)
-                    elif(self.type == "queues"):
-                        obj = _queue(b.name, self._connect_server)
-                        header_str = "pbs.server().queue(%s)" % (b.name,)
-                    elif(self.type == "resvs"):
-                        obj = _resv(b.name, self._connect_server)
-                        header_str = "pbs.server().resv(%s)" % (b.name,)
-                    elif(self.type == "vnodes"):
-                        obj = _vnode(b.name, self._connect_server)
-                        header_str = "pbs.server().vnode(%s)" % (b.name,)
-                    else:
-                        _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
-                                       "pbs_iter/next: Bad object"
-                                       " iterator type %s"
-                                       % (self.type))
-                        pbs_disconnect(self.con)
-                        self.con = -1
-                        _pbs_v1.set_python_mode()
-                        raise StopIteration
+                if(self.type == "jobs"):
+                    obj = _job(bname, self._connect_server)
+                    header_str = "pbs.server().job(%s)" % (bname,)
+                elif(self.type == "queues"):
+                    obj = _queue(bname, self._connect_server)
+                    header_str = "pbs.server().queue(%s)" % (bname,)
+                elif(self.type == "resvs"):
+                    obj = _resv(bname, self._connect_server)
+                    header_str = "pbs.server().resv(%s)" % (bname,)
+                elif(self.type == "vnodes"):
+                    obj = _vnode(bname, self._connect_server)
+                    header_str = "pbs.server().vnode(%s)" % (bname,)
+                else:
+                    _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
+                                   "pbs_iter/next: Bad object"
+                                   " iterator type %s"
+                                   % (self.type))
+                    pbs_disconnect(self.con)
+                    self.con = -1
+                    _pbs_v1.set_python_mode()
+                    raise StopIteration
 
-                    a = b.attribs
-
-                    while(a):
-                        n = a.name
-                        r = a.resource
-                        v = a.value
-
-                        if(self.type == "vnodes"):
-                            if(n == ATTR_NODE_state):
-                                v = _pbs_v1.str_to_vnode_state(v)
-                            elif(n == ATTR_NODE_ntype):
-                                v = _pbs_v1.str_to_vnode_ntype(v)
-                            elif(n == ATTR_NODE_Sharing):
-                                v = _pbs_v1.str_to_vnode_sharing(v)
-
-                        if(self.type == "jobs"):
-                            if n == ATTR_inter or n == ATTR_block or \
-                                    n == ATTR_X11_port:
-                                v = int(pbs_bool(v))
-
-                        if(r):
-                            pr = getattr(obj, n)
-
-                            # if resource list does not exist, then set it
-                            if(pr == None):
-                                setattr(obj, n)
-
-                            pr = getattr(obj, n)
-                            if (pr == None):
-                                _pbs_v1.logmsg(_pbs_v1.LOG_DEBUG,
-                                               "pbs_statobj: missing %s" % (n))
-                                a = a.__next__
-                                continue
-
-                            vo = getattr(pr, r)
-                            if(vo == None):
-                                setattr(pr, r, v)
-                                if server_data_fp:
-                                    server_data_fp.write(
-                                        "%s.%s[%s]=%s\n" % (header_str, n, r,
-                                                            v))
-                            else:
-                                # append value:
-                                # example: "select=1:ncpus=1,ncpus=1,nodect=1,
-                                # place=pack"
-                                vl = [vo, v]
-                                setattr(pr, r, ",".join(vl))
-                                if server_data_fp:
-                                    server_data_fp.write("%s.%s[%s]=%s\n" % (
-                                        header_str, n, r, ",".join(vl)))
-
-                        else:
-                            vo = getattr(obj, n)
-
-                            if(vo == None):
-                                setattr(obj, n, v)
-                                if server_data_fp:
-                                    server_data_fp.write(
-                                        "%s.%s=%s\n" % (header_str, n, v))
-                            else:
-                                vl = [vo, v]
-                                setattr(obj, n, ",".join(vl))
-                                if server_data_fp:
-                                    server_data_fp.write("%s.%s=%s\n" % (
-                                        header_str, n, ",".join(vl)))
-
-                        a = a.next
-
-                self.bs = b.next
+                _pbs_stat_set_attrs(obj, self.type[:-1], battrs, header_str,
+                                    server_data_fp)
 
                 _pbs_v1.set_python_mode()
                 return obj
@@ -108,6 +108,11 @@
 #include <syslog.h>
 #include <arpa/inet.h>
 #endif        /* USELOG */
+
+#if defined(HAVE_SENDFILE) && defined(linux) && !defined(CRYPT)
+#include <sys/sendfile.h>
+#define RCP_SENDFILE 1
+#endif
 /**
  * @file	rcp.c
  */
@@ -789,14 +794,39 @@ source(int argc, char *argv[])
 #endif
 		if (response() < 0)
 			goto next;
-		if ((bp = allocbuf(&buffer, fd, RCP_BUFFER_SIZE)) == NULL) {
+		if ((bp = allocbuf(&buffer, fd, RCP_XFER_SIZE)) == NULL) {
 			next:			if (fd > 0)(void)close(fd);
 			continue;
 		}
 
-		/* Keep writing after an error so that we stay sync'd up. */
 		haderr = 0;
-		for (i = 0; i < stb.st_size; i += bp->cnt) {
+		i = 0;
+#ifdef RCP_SENDFILE
+		/*
+		 * Let the kernel move the data straight from the file to
+		 * the connection.  If it cannot, carry on below with the
+		 * buffered copy from wherever sendfile() got to.
+		 */
+		{
+			off_t	off = 0;
+			ssize_t	sent;
+
+			while (off < stb.st_size) {
+				sent = sendfile(rem, fd, &off, stb.st_size - off);
+				if (sent <= 0) {
+					if ((sent == -1) && (errno == EINTR))
+						continue;
+					break;
+				}
+			}
+			if ((off != 0) && (lseek(fd, off, SEEK_SET) == (off_t)-1))
+				haderr = errno;
+			i = off;
+		}
+#endif
+
+		/* Keep writing after an error so that we stay sync'd up. */
+		for (; i < stb.st_size; i += bp->cnt) {
 			amt = bp->cnt;
 			if (i + amt > stb.st_size)
 				amt = (int)(stb.st_size - i);
@@ -1191,7 +1221,7 @@ sink(int argc, char *argv[])
 #else
 		(void)write(rem, "", 1);
 #endif
-		if ((bp = allocbuf(&buffer, ofd, RCP_BUFFER_SIZE)) == NULL) {
+		if ((bp = allocbuf(&buffer, ofd, RCP_XFER_SIZE)) == NULL) {
 			(void)close(ofd);
 			continue;
 		}
@@ -46,6 +46,7 @@
 #include <unistd.h>
 #include <dirent.h>
 #include <pwd.h>
+#include <sys/wait.h>
 #endif
 #include <stdio.h>
 #include <stdlib.h>
@@ -118,6 +119,22 @@ extern useconds_t	alps_release_jitter;
 
 extern char		*path_hooks_workdir;
 
+/*
+ * Obits are queued by send_obit() and sent to the server together, in one
+ * IS_JOBOBIT message, by send_obits_pending() at the end of the main loop.
+ */
+#define OBIT_BATCH_MAX	100
+static struct resc_used_update	*obits_pending = NULL;
+static struct resc_used_update	*obits_pending_last = NULL;
+static int			 obits_pending_count = 0;
+
+/*
+ * With at least JOB_PREFETCH_MIN job files to recover, init_abort_jobs()
+ * first has JOB_PREFETCH_PROCS children read them in parallel.
+ */
+#define JOB_PREFETCH_MIN	32
+#define JOB_PREFETCH_PROCS	8
+
 #ifndef WIN32
 /**
  * @brief
@@ -1253,6 +1270,7 @@ void
 send_obit(job *pjob, int exval)
 {
 	struct resc_used_update rud;
+	struct resc_used_update *prud;
 	pbs_list_head vnl_changes;
 
 #ifndef WIN32
@@ -1369,13 +1387,42 @@ send_obit(job *pjob, int exval)
 			    pjob->ji_wattr[(int)JOB_ATR_Comment].at_val.at_str;
 		}
 #endif
-		/* now send info to server via rpp */
-		send_resc_used(IS_JOBOBIT, 1, &rud);
-		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
-			pjob->ji_qs.ji_jobid, "Obit sent");
+		/* queue the obit to be sent with any others */
+		prud = malloc(sizeof(struct resc_used_update));
+		if (prud != NULL) {
+			*prud = rud;
+			CLEAR_HEAD(prud->ru_attr);
+			list_move(&rud.ru_attr, &prud->ru_attr);
+			prud->ru_pjobid = strdup(rud.ru_pjobid);
+			if (rud.ru_comment != NULL)
+				prud->ru_comment = strdup(rud.ru_comment);
+			if ((prud->ru_pjobid == NULL) ||
+				((rud.ru_comment != NULL) &&
+				(prud->ru_comment == NULL))) {
+				list_move(&prud->ru_attr, &rud.ru_attr);
+				if (prud->ru_pjobid)
+					free(prud->ru_pjobid);
+				free(prud);
+				prud = NULL;
+			}
+		}
+		if (prud != NULL) {
+			if (obits_pending_last != NULL)
+				obits_pending_last->ru_next = prud;
+			else
+				obits_pending = prud;
+			obits_pending_last = prud;
+			if (++obits_pending_count >= OBIT_BATCH_MAX)
+				send_obits_pending();
+		} else {
+			/* now send info to server via rpp */
+			send_resc_used(IS_JOBOBIT, 1, &rud);
+			log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+				pjob->ji_qs.ji_jobid, "Obit sent");
 
-		/* free svrattrl list only */
-		free_attrlist(&rud.ru_attr);
+			/* free svrattrl list only */
+			free_attrlist(&rud.ru_attr);
+		}
 	} else {
 		log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_JOB, LOG_WARNING,
 			pjob->ji_qs.ji_jobid, "Cannot Send Obit");
@@ -1388,11 +1435,41 @@ send_obit(job *pjob, int exval)
 	 **	reply goes back.
 	 */
 	if (pjob->ji_preq) {
+		send_obits_pending();
 		reply_ack(pjob->ji_preq);
 		pjob->ji_preq = NULL;
 	}
 }
 
+/**
+ * @brief
+ * 	Send the obits queued by send_obit() to the server in one message.
+ *
+ * @return Void
+ *
+ */
+
+void
+send_obits_pending(void)
+{
+	struct resc_used_update	*prud;
+
+	if (obits_pending == NULL)
+		return;
+
+	send_resc_used(IS_JOBOBIT, obits_pending_count, obits_pending);
+
+	while ((prud = obits_pending) != NULL) {
+		obits_pending = prud->ru_next;
+		if (server_stream >= 0)
+			log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB,
+				LOG_DEBUG, prud->ru_pjobid, "Obit sent");
+		FREE_RUU(prud)
+	}
+	obits_pending_last = NULL;
+	obits_pending_count = 0;
+}
+
 /**
  * @brief
  * 	Look for job tasks that have terminated (see scan_for_terminating),
@@ -1719,7 +1796,7 @@ end_loop:
 				(void)diswul(stream,
 					resc_used(pjob, "cpupercent", gettime));
 				(void)send_resc_used_to_ms(stream,
-							pjob->ji_qs.ji_jobid);
+							pjob->ji_qs.ji_jobid, 1);
 				(void)rpp_flush(stream);
 				pjob->ji_obit = TM_NULL_EVENT;
 			}
@@ -2084,6 +2161,126 @@ send_restart(void)
 
 }
 
+#ifndef WIN32
+/**
+ * @brief
+ *	Read a file to the end so it is in the page cache.
+ *
+ * @param[in]	path - file to read
+ *
+ * @return	void
+ */
+static void
+prefetch_file(char *path)
+{
+	char	buf[8192];
+	int	fd;
+
+	if ((fd = open(path, O_RDONLY, 0)) == -1)
+		return;
+	while (read(fd, buf, sizeof(buf)) > 0)
+		;
+	(void)close(fd);
+}
+
+/**
+ * @brief
+ *	Bring the job files and task files of mom_priv/jobs into the page
+ *	cache before init_abort_jobs() recovers them one by one.  The files
+ *	are split among up to JOB_PREFETCH_PROCS children which read them at
+ *	the same time, so on a cold cache the recovery waits for the slowest
+ *	share of the reads instead of their sum.  Nothing is parsed here and
+ *	any failure just leaves the reads to the recovery itself.
+ *
+ * @return	void
+ */
+static void
+prefetch_job_files(void)
+{
+	DIR		*dir;
+	DIR		*tdir;
+	struct dirent	*pdirent;
+	char		**names = NULL;
+	char		**tmp;
+	int		nnames = 0;
+	int		maxnames = 0;
+	int		nprocs;
+	int		i, k;
+	int		len;
+	int		suf_len = strlen(JOB_FILE_SUFFIX);
+	pid_t		pids[JOB_PREFETCH_PROCS];
+	char		path[MAXPATHLEN+1];
+	char		*tail;
+
+	if ((dir = opendir(path_jobs)) == NULL)
+		return;
+	while ((pdirent = readdir(dir)) != NULL) {
+		len = strlen(pdirent->d_name);
+		if ((len <= suf_len) ||
+			strcmp(pdirent->d_name + len - suf_len, JOB_FILE_SUFFIX))
+			continue;
+		if (nnames == maxnames) {
+			maxnames = maxnames ? maxnames * 2 : 64;
+			tmp = realloc(names, maxnames * sizeof(char *));
+			if (tmp == NULL)
+				break;
+			names = tmp;
+		}
+		if ((names[nnames] = strdup(pdirent->d_name)) == NULL)
+			break;
+		nnames++;
+	}
+	(void)closedir(dir);
+
+	nprocs = 0;
+	if (nnames >= JOB_PREFETCH_MIN) {
+		for (k = 0; k < JOB_PREFETCH_PROCS; k++) {
+			if ((pids[k] = fork()) == -1)
+				break;
+			nprocs++;
+			if (pids[k] > 0)
+				continue;
+
+			/* child: read every JOB_PREFETCH_PROCS-th job */
+			for (i = k; i < nnames; i += JOB_PREFETCH_PROCS) {
+				snprintf(path, sizeof(path), "%s%s",
+					path_jobs, names[i]);
+				prefetch_file(path);
+
+				/* and the task files of its <prefix>.TK dir */
+				tail = path + strlen(path) - suf_len;
+				strcpy(tail, JOB_TASKDIR_SUFFIX);
+				if ((tdir = opendir(path)) == NULL)
+					continue;
+				strcat(path, "/");
+				tail = path + strlen(path);
+				while ((pdirent = readdir(tdir)) != NULL) {
+					if (pdirent->d_name[0] == '.')
+						continue;
+					snprintf(tail, sizeof(path) - (tail - path),
+						"%s", pdirent->d_name);
+					prefetch_file(path);
+				}
+				(void)closedir(tdir);
+			}
+			_exit(0);
+		}
+	}
+	for (k = 0; k < nprocs; k++)
+		(void)waitpid(pids[k], NULL, 0);
+
+	if (nprocs > 0) {
+		sprintf(log_buffer, "read %d job files with %d processes",
+			nnames, nprocs);
+		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
+			__func__, log_buffer);
+	}
+	for (i = 0; i < nnames; i++)
+		free(names[i]);
+	free(names);
+}
+#endif	/* WIN32 */
+
 /**
  * @brief
  *	On mom initialization, recover all running jobs.
@@ -2123,6 +2320,9 @@ init_abort_jobs(int recover)
 	extern	char	*path_checkpoint;
 	extern	char	*path_spool;
 
+#ifndef WIN32
+	prefetch_job_files();
+#endif
 	dir = opendir(path_jobs);
 	if (dir == NULL) {
 		log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_SERVER, LOG_ALERT,
@@ -2394,6 +2594,10 @@ del_job_hw(job *pjob)
 	clear_cpuset(pjob);
 #endif	/* MOM_CPUSET */
 
+#ifndef	WIN32
+	cgroup_v2_remove(pjob);
+#endif
+
 #if	MOM_BGL
 	(void)job_bgl_delete(pjob);
 #endif	/* MOM_BGL */
@@ -271,6 +271,21 @@ static char expatBuffer[(EXPAT_BUFFER_LEN * sizeof(char))];
 static char *basil_inventory;
 static char *alps_client_out;
 
+/**
+ * The vnodes last generated from an inventory response (basil_inventory),
+ * and the settings they were generated with.  While those settings hold,
+ * a later response that matches basil_inventory apart from its timestamp
+ * is not parsed and the saved vnodes are used again.
+ */
+static vnl_t	*inventory_vnl;
+static int	inventory_ncpus;
+static unsigned long inventory_mem;
+static int	inventory_per_numa;
+static char	*inventory_knl;
+static int	inventory_request;	/* reading a response that may be reused */
+static int	inventory_unchanged;	/* it matched and was not parsed */
+static long long inventory_timestamp;	/* timestamp of the unparsed response */
+
 static char	*requestBuffer;
 static char	*requestBuffer_knl;
 static size_t	requestSize_knl;
@@ -344,6 +359,14 @@ static void store_nids(int, char *, long **, int *);
 static void free_basil_elements_KNL(basil_system_element_t *);
 static void alps_engine_query_KNL(void);
 
+/*
+ * Prototype declarations for reusing an unchanged inventory.
+ */
+static int inventory_same(char *, char *, long long *);
+static int inventory_settings_same(void);
+static void inventory_save(vnl_t *);
+static int inventory_reuse(void);
+
 /**
  * @brief
  *	When DEBUG is defined, log XML parsing messages to MOM log file.
@@ -4408,6 +4431,9 @@ inventory_to_vnodes(basil_response_t *brp)
 	}
 	internal_state_update = UPDATE_MOM_STATE;
 
+	/* keep a copy for when the inventory next comes back unchanged */
+	inventory_save(nv);
+
 	/* merge any existing vnodes into the new set */
 	if (vnlp != NULL) {
 		if (vn_merge(nv, vnlp, NULL) == NULL)
@@ -4942,6 +4968,8 @@ alps_request_parent(int fdin, char *basil_ver)
 			break;
 		}
 		eof = feof(in);
+		if (inventory_request)
+			continue;	/* parsed whole below, unless unchanged */
 		status = XML_Parse(parser, expatBuffer, len, eof);
 		if (status == XML_STATUS_ERROR) {
 			sprintf(ud.error_class, "%s", BASIL_VAL_PERMANENT);
@@ -4953,6 +4981,23 @@ alps_request_parent(int fdin, char *basil_ver)
 	} while (!eof);
 	fclose(in);
 
+	if (inventory_request && (alps_client_out != NULL)) {
+		if ((basil_inventory != NULL) && inventory_same(basil_inventory,
+			alps_client_out, &inventory_timestamp)) {
+			inventory_unchanged = 1;
+		} else {
+			char *xml = alps_client_out + strlen(NODE_TOPOLOGY_TYPE_CRAY);
+
+			status = XML_Parse(parser, xml, strlen(xml), 1);
+			if (status == XML_STATUS_ERROR) {
+				sprintf(ud.error_class, "%s", BASIL_VAL_PERMANENT);
+				sprintf(ud.error_source, "%s", BASIL_VAL_PARSER);
+				sprintf(ud.message, "%s",
+					XML_ErrorString(XML_GetErrorCode(parser)));
+			}
+		}
+	}
+
 	if (*ud.error_class || *ud.error_source) {
 		sprintf(log_buffer, "%s BASIL error from %s: %s",
 			ud.error_class, ud.error_source, ud.message);
@@ -6661,12 +6706,20 @@ alps_inventory(void)
 		BASIL_ATR_PROTOCOL "=\"%s\" "
 		BASIL_ATR_METHOD "=\"" BASIL_VAL_QUERY "\" "
 		BASIL_ATR_TYPE "=\"" BASIL_VAL_INVENTORY "\"/>", basilversion_inventory);
-	if ((brp = alps_request(requestBuffer, basilversion_inventory)) == NULL) {
+	inventory_request = inventory_settings_same();
+	inventory_unchanged = 0;
+	brp = alps_request(requestBuffer, basilversion_inventory);
+	inventory_request = 0;
+	if (brp == NULL) {
 		sprintf(log_buffer, "ALPS inventory request failed.");
 		log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_NODE,
 			LOG_NOTICE, __func__, log_buffer);
 		return -1;
 	}
+	if (inventory_unchanged) {
+		free_basil_response_data(brp);
+		return inventory_reuse();
+	}
 	if (basil_inventory != NULL)
 		free(basil_inventory);
 	basil_inventory = strdup(alps_client_out);
@@ -6680,6 +6733,161 @@ alps_inventory(void)
 	return rc;
 }
 
+/**
+ * @brief
+ * 	Compare two saved inventory responses, ignoring the value of the
+ * 	inventory timestamp attribute, which ALPS sets on each response.
+ *
+ * @param[in] old previous response
+ * @param[in] new latest response
+ * @param[out] ts timestamp of the latest response, 0 if it has none
+ *
+ * @return	int
+ * @retval	1	: the responses match
+ * @retval	0	: they differ
+ */
+static int
+inventory_same(char *old, char *new, long long *ts)
+{
+	char	*op;
+	char	*np;
+	static char tsattr[] = " " BASIL_ATR_TIMESTAMP "=\"";
+
+	*ts = 0;
+	op = strstr(old, tsattr);
+	np = strstr(new, tsattr);
+	if ((op == NULL) || (np == NULL))
+		return ((op == np) && (strcmp(old, new) == 0));
+
+	if (((op - old) != (np - new)) || (strncmp(old, new, op - old) != 0))
+		return 0;
+	op += sizeof(tsattr) - 1;
+	np += sizeof(tsattr) - 1;
+	*ts = atoll(np);
+	if (((op = strchr(op, '"')) == NULL) || ((np = strchr(np, '"')) == NULL))
+		return 0;
+	return (strcmp(op, np) == 0);
+}
+
+/**
+ * @brief
+ * 	Check whether the vnodes saved from the last inventory were generated
+ * 	with the current login node resources, vnode_per_numa_node setting
+ * 	and KNL node list, so they may be reused.
+ *
+ * @return	int
+ * @retval	1	: saved vnodes may be reused
+ * @retval	0	: none saved, or a setting changed
+ */
+static int
+inventory_settings_same(void)
+{
+	extern	int	num_acpus;
+	extern	ulong	totalmem;
+
+	if (inventory_vnl == NULL)
+		return 0;
+	if ((inventory_ncpus != num_acpus) || (inventory_mem != totalmem) ||
+		(inventory_per_numa != vnode_per_numa_node))
+		return 0;
+	if ((inventory_knl == NULL) || (knl_node_list == NULL))
+		return (inventory_knl == knl_node_list);
+	return (strcmp(inventory_knl, knl_node_list) == 0);
+}
+
+/**
+ * @brief
+ * 	Save a copy of the vnodes just generated from the inventory, along
+ * 	with the settings checked by inventory_settings_same().
+ *
+ * @param[in] nv vnodes generated from the inventory
+ *
+ * @return Void
+ */
+static void
+inventory_save(vnl_t *nv)
+{
+	extern	int	num_acpus;
+	extern	ulong	totalmem;
+
+	if (inventory_vnl != NULL) {
+		vnl_free(inventory_vnl);
+		inventory_vnl = NULL;
+	}
+	free(inventory_knl);
+	inventory_knl = NULL;
+
+	if (vnl_alloc(&inventory_vnl) == NULL) {
+		log_err(errno, __func__, "vnl_alloc failed!");
+		return;
+	}
+	if (vn_merge(inventory_vnl, nv, NULL) == NULL) {
+		vnl_free(inventory_vnl);
+		inventory_vnl = NULL;
+		return;
+	}
+	if (knl_node_list != NULL) {
+		if ((inventory_knl = strdup(knl_node_list)) == NULL) {
+			vnl_free(inventory_vnl);
+			inventory_vnl = NULL;
+			return;
+		}
+	}
+	inventory_ncpus = num_acpus;
+	inventory_mem = totalmem;
+	inventory_per_numa = vnode_per_numa_node;
+}
+
+/**
+ * @brief
+ * 	The inventory has not changed since the vnodes were last generated,
+ * 	so use the saved copy instead of parsing it again.
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: failure
+ */
+static int
+inventory_reuse(void)
+{
+	extern	int	internal_state_update;
+	vnl_t		*nv = NULL;
+
+	if (vnl_alloc(&nv) == NULL) {
+		log_err(errno, __func__, "vnl_alloc failed!");
+		return -1;
+	}
+	if (vn_merge(nv, inventory_vnl, NULL) == NULL) {
+		vnl_free(nv);
+		return -1;
+	}
+	nv->vnl_modtime = (inventory_timestamp > 0) ?
+		(long)inventory_timestamp : (long)time(NULL);
+	internal_state_update = UPDATE_MOM_STATE;
+
+	/* merge any existing vnodes into the new set */
+	if (vnlp != NULL) {
+		if (vn_merge(nv, vnlp, NULL) == NULL) {
+			vnl_free(nv);
+			return -1;
+		}
+		vnl_free(vnlp);
+	}
+	vnlp = nv;
+
+	if (knl_node_list) {
+		free(knl_node_list);
+		knl_node_list = NULL;
+	}
+
+	snprintf(log_buffer, sizeof(log_buffer),
+		"ALPS inventory unchanged, reused %lu vnodes",
+		inventory_vnl->vnl_used);
+	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_NODE, LOG_DEBUG,
+		__func__, log_buffer);
+	return 0;
+}
+
 /**
  *
  * @brief System Query handling (for KNL Nodes).
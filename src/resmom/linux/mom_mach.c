@@ -68,6 +68,10 @@
 #include <sys/wait.h>
 #include <syscall.h>
 #include <signal.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
 
 #include "pbs_error.h"
 #include "portability.h"
@@ -85,6 +89,8 @@
 #include "pbs_ifl.h"
 #include "placementsets.h"
 #include "mom_vnode.h"
+#include "work_task.h"
+#include "net_connect.h"
 #ifndef NAS /* localmod 113 */
 #include "hwloc.h"
 #endif /* localmod 113 */
@@ -126,6 +132,24 @@
 #define	TBL_INC 20
 #define CPUT_POSSIBLE_FACTOR 5
 
+/* job cgroups made by mom under CGROUP_V2_ROOT/<prefix> when $cgroup_v2 is set */
+#define	CGROUP_V2_ROOT		"/sys/fs/cgroup"
+#define	CGROUP_V2_PREFIX	"pbspro"
+#define	CGROUP_V2_HOOK_CONFIG	"pbs_cgroups.CF"
+#define	CGROUP_V2_RMDIR_RETRY	5	/* seconds */
+
+/* process table kept from proc connector events when $proc_events is set */
+#define	PROC_EV_HASH	4096
+struct proc_ev {
+	pid_t		pe_pid;
+	pid_t		pe_ppid;
+	pid_t		pe_sid;
+	struct proc_ev	*pe_next;
+};
+static struct proc_ev	*proc_ev_hash[PROC_EV_HASH];
+static int		proc_ev_fd = -1;
+static int		proc_ev_valid = 0;	/* table matches the system */
+
 static char	procfs[] = "/proc";
 static DIR	*pdir = NULL;
 static int	pagesize;
@@ -154,6 +178,7 @@ extern	int	exiting_tasks;
 extern	vnl_t	*vnlp;
 
 extern	time_t	time_now;
+extern	char	*path_hooks;
 
 /*
  ** external functions and data
@@ -222,23 +247,24 @@ ulong	totalmem;
 
 static int	myproc_max = 0;		/* entries in Proc_lnks  */
 pbs_plinks	*Proc_lnks = NULL;	/* process links table head */
+static int	kill_batch_depth = 0;	/* inside kill_batch_begin/end */
+static int	kill_batch_sampled = 0;	/* sample taken for this batch */
 static time_t	sampletime_ceil;
 static time_t	sampletime_floor;
 
-#if	MOM_CPUSET
 typedef int		pidcachetype_t;		/* type of allocatable unit */
 static pidcachetype_t	*pidcache_arena;	/* cache storage area */
 static unsigned int 	pidcache_bitsper = sizeof(pidcachetype_t) * NBBY;
 static int		pidcache_check(pid_t, pidcachetype_t *);
 static pidcachetype_t	*pidcache_create(void);
 static int		pidcache_reset(pidcachetype_t *);
+static int		pidcache_reset_cgroup_v2(pidcachetype_t *);
 static void		pidcache_destroy(void);
 static pidcachetype_t *	pidcache_getarena(void);
 static int		pidcache_insert(pid_t p, pidcachetype_t *set);
 static int		pidcache_needed(void);
 static pid_t		pidcache_pidmax;	/* zero value implies no limit */
 static int		pidcache_test = 0;	/* say PID cache always needed */
-#endif	/* MOM_CPUSET */
 
 /*
  ** local resource array
@@ -5064,6 +5090,292 @@ end_proc(void)
 #endif	/* MOM_BGL */
 }
 
+/**
+ * @brief
+ *	Return the directory holding the cgroup v2 job cgroups,
+ *	CGROUP_V2_ROOT/<prefix>. The prefix is the "cgroup_prefix" of the
+ *	cgroups hook configuration file when there is one, so both agree
+ *	on where the job cgroups are, and CGROUP_V2_PREFIX otherwise.
+ *
+ * @return	char *
+ * @retval	the directory, from a static buffer
+ */
+static char *
+cgroup_v2_base(void)
+{
+	static char	base[MAXPATHLEN/2];
+	char		path[MAXPATHLEN+1];
+	char		prefix[MAXPATHLEN/4];
+	char		buf[8192];
+	char		*p;
+	char		*e;
+	size_t		len;
+	FILE		*fp;
+
+	if (base[0] != '\0')
+		return (base);
+
+	strcpy(prefix, CGROUP_V2_PREFIX);
+	snprintf(path, sizeof(path), "%s/%s", path_hooks, CGROUP_V2_HOOK_CONFIG);
+	if ((fp = fopen(path, "r")) != NULL) {
+		len = fread(buf, 1, sizeof(buf) - 1, fp);
+		fclose(fp);
+		buf[len] = '\0';
+		/* "cgroup_prefix" : "<prefix>" */
+		if (((p = strstr(buf, "\"cgroup_prefix\"")) != NULL) &&
+			((p = strchr(p + 15, '"')) != NULL) &&
+			((e = strchr(++p, '"')) != NULL) &&
+			(e > p) && ((size_t)(e - p) < sizeof(prefix)) &&
+			(memchr(p, '/', e - p) == NULL) && (*p != '.')) {
+			memcpy(prefix, p, e - p);
+			prefix[e - p] = '\0';
+		}
+	}
+	snprintf(base, sizeof(base), "%s/%s", CGROUP_V2_ROOT, prefix);
+	return (base);
+}
+
+/**
+ * @brief
+ *	Write 'value' into the cgroup interface file 'path'.
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	failure, errno set
+ */
+static int
+cgroup_v2_write(char *path, char *value)
+{
+	int	fd;
+	ssize_t	len = strlen(value);
+
+	if ((fd = open(path, O_WRONLY)) == -1)
+		return (-1);
+	if (write(fd, value, len) != len) {
+		int save_errno = errno;
+
+		close(fd);
+		errno = save_errno;
+		return (-1);
+	}
+	return (close(fd));
+}
+
+/**
+ * @brief
+ *	Read a counter of the cgroup v2 cgroup of job 'pjob': the value of
+ *	the line starting with 'key' in interface file 'file', or the first
+ *	value of the file when 'key' is NULL.
+ *
+ * @param[in]	pjob - job in question
+ * @param[in]	file - interface file, e.g. "cpu.stat"
+ * @param[in]	key - the line wanted, or NULL
+ * @param[out]	value - the counter
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	no such cgroup, file or key
+ */
+static int
+cgroup_v2_read(job *pjob, char *file, char *key, unsigned long long *value)
+{
+	char	path[MAXPATHLEN+1];
+	char	line[256];
+	size_t	keylen = (key != NULL) ? strlen(key) : 0;
+	FILE	*fp;
+	int	rc = -1;
+
+	snprintf(path, sizeof(path), "%s/%s/%s", cgroup_v2_base(),
+		pjob->ji_qs.ji_jobid, file);
+	if ((fp = fopen(path, "r")) == NULL)
+		return (-1);
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		if ((key != NULL) &&
+			((strncmp(line, key, keylen) != 0) || (line[keylen] != ' ')))
+			continue;
+		if (sscanf(line + keylen, "%llu", value) == 1)
+			rc = 0;
+		break;
+	}
+	fclose(fp);
+	return (rc);
+}
+
+/**
+ * @brief
+ *	Create the cgroup v2 cgroup of job 'pjob' if it does not exist yet,
+ *	cap its memory at what the job was assigned on this host, and move
+ *	the calling process, which is about to become a task of the job,
+ *	into it. Its children are then accounted in the job cgroup too.
+ *	Does nothing unless $cgroup_v2 is set.
+ *
+ * @param[in]	pjob - job in question
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	failure, message in log_buffer
+ */
+int
+cgroup_v2_attach(job *pjob)
+{
+	char		path[MAXPATHLEN+1];
+	char		val[64];
+	char		*base;
+	long long	mem = 0;
+
+	if (!cgroup_v2)
+		return (0);
+
+	base = cgroup_v2_base();
+	if ((mkdir(base, 0755) == -1) && (errno != EEXIST)) {
+		snprintf(log_buffer, sizeof(log_buffer),
+			"unable to create cgroup %s, errno %d", base, errno);
+		return (-1);
+	}
+	/* let the job cgroups below use the cpu and memory controllers */
+	snprintf(path, sizeof(path), "%s/cgroup.subtree_control", base);
+	(void)cgroup_v2_write(path, "+cpu +memory");
+
+	snprintf(path, sizeof(path), "%s/%s", base, pjob->ji_qs.ji_jobid);
+	if ((mkdir(path, 0755) == -1) && (errno != EEXIST)) {
+		snprintf(log_buffer, sizeof(log_buffer),
+			"unable to create cgroup %s, errno %d", path, errno);
+		return (-1);
+	}
+
+	if (pjob->ji_hosts != NULL)
+		mem = pjob->ji_hosts[pjob->ji_nodeid].hn_nrlimit.rl_mem;
+	if (mem > 0) {
+		snprintf(path, sizeof(path), "%s/%s/memory.max", base,
+			pjob->ji_qs.ji_jobid);
+		snprintf(val, sizeof(val), "%lld", mem << 10);
+		(void)cgroup_v2_write(path, val);
+	}
+
+	snprintf(path, sizeof(path), "%s/%s/cgroup.procs", base,
+		pjob->ji_qs.ji_jobid);
+	snprintf(val, sizeof(val), "%d", (int)getpid());
+	if (cgroup_v2_write(path, val) == -1) {
+		snprintf(log_buffer, sizeof(log_buffer),
+			"unable to attach to cgroup %s, errno %d", path, errno);
+		return (-1);
+	}
+	return (0);
+}
+
+/**
+ * @brief
+ *	Retry removing a job cgroup that still had processes in it.
+ *
+ * @param[in]	ptask - work task, wt_parm1 is the malloc-ed cgroup path
+ *
+ * @return	void
+ */
+static void
+cgroup_v2_rmdir_retry(struct work_task *ptask)
+{
+	char *path = (char *)ptask->wt_parm1;
+
+	if ((rmdir(path) == -1) && (errno != ENOENT)) {
+		sprintf(log_buffer, "unable to remove cgroup %s, errno %d",
+			path, errno);
+		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_WARNING,
+			__func__, log_buffer);
+	}
+	free(path);
+}
+
+/**
+ * @brief
+ *	Kill whatever is left in the cgroup v2 cgroup of job 'pjob' and
+ *	remove the cgroup. Does nothing unless $cgroup_v2 is set.
+ *
+ * @param[in]	pjob - job in question
+ *
+ * @return	void
+ */
+void
+cgroup_v2_remove(job *pjob)
+{
+	char	path[MAXPATHLEN+1];
+	char	kill_path[MAXPATHLEN+1];
+	char	*dup;
+
+	if (!cgroup_v2)
+		return;
+
+	snprintf(path, sizeof(path), "%s/%s", cgroup_v2_base(),
+		pjob->ji_qs.ji_jobid);
+	snprintf(kill_path, sizeof(kill_path), "%s/%s/cgroup.kill",
+		cgroup_v2_base(), pjob->ji_qs.ji_jobid);
+	(void)cgroup_v2_write(kill_path, "1");
+
+	if (rmdir(path) == 0 || errno == ENOENT)
+		return;
+	if ((errno == EBUSY) && ((dup = strdup(path)) != NULL)) {
+		/* the killed processes take a moment to go away */
+		if (set_task(WORK_Timed, time_now + CGROUP_V2_RMDIR_RETRY,
+			cgroup_v2_rmdir_retry, dup) != NULL)
+			return;
+		free(dup);
+	}
+	sprintf(log_buffer, "unable to remove cgroup %s, errno %d", path, errno);
+	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_WARNING,
+		pjob->ji_qs.ji_jobid, log_buffer);
+}
+
+/**
+ * @brief
+ *	Kill every process in the cgroup v2 cgroup of job 'pjob' with one
+ *	write to its cgroup.kill, including processes that left the task
+ *	sessions. Does nothing unless $cgroup_v2 is set.
+ *
+ * @param[in]	pjob - job in question
+ *
+ * @return	int
+ * @retval	0	the cgroup was killed
+ * @retval	-1	$cgroup_v2 is not set or the write failed
+ */
+int
+cgroup_v2_kill(job *pjob)
+{
+	char	path[MAXPATHLEN+1];
+
+	if (!cgroup_v2)
+		return (-1);
+
+	snprintf(path, sizeof(path), "%s/%s/cgroup.kill", cgroup_v2_base(),
+		pjob->ji_qs.ji_jobid);
+	return (cgroup_v2_write(path, "1"));
+}
+
+/**
+ * @brief
+ *	Freeze or thaw the cgroup v2 cgroup of job 'pjob' through its
+ *	cgroup.freeze. A frozen job cannot fork while its tasks are being
+ *	signaled, so a single process sample stays accurate for all of them.
+ *	Does nothing unless $cgroup_v2 is set.
+ *
+ * @param[in]	pjob - job in question
+ * @param[in]	freeze - 1 to freeze, 0 to thaw
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	$cgroup_v2 is not set or the write failed
+ */
+int
+cgroup_v2_freeze(job *pjob, int freeze)
+{
+	char	path[MAXPATHLEN+1];
+
+	if (!cgroup_v2)
+		return (-1);
+
+	snprintf(path, sizeof(path), "%s/%s/cgroup.freeze", cgroup_v2_base(),
+		pjob->ji_qs.ji_jobid);
+	return (cgroup_v2_write(path, freeze ? "1" : "0"));
+}
+
 /**
  * @brief
  *	 Scan a list of tasks and return true if one of them matches sid
@@ -5499,6 +5811,317 @@ mom_do_poll(job *pjob)
 	return (FALSE);
 }
 
+/**
+ * @brief
+ *	Find the entry of process 'pid' in the proc connector table.
+ *
+ * @param[in]	pid - process id
+ *
+ * @return	struct proc_ev *
+ * @retval	entry of pid
+ * @retval	NULL if pid is not in the table
+ */
+static struct proc_ev *
+proc_ev_find(pid_t pid)
+{
+	struct proc_ev	*pe;
+
+	for (pe = proc_ev_hash[pid % PROC_EV_HASH]; pe != NULL; pe = pe->pe_next) {
+		if (pe->pe_pid == pid)
+			return (pe);
+	}
+	return (NULL);
+}
+
+/**
+ * @brief
+ *	Add process 'pid' to the proc connector table, or update its entry.
+ *
+ * @param[in]	pid - process id
+ * @param[in]	ppid - parent process id
+ * @param[in]	sid - session id
+ *
+ * @return	void
+ */
+static void
+proc_ev_add(pid_t pid, pid_t ppid, pid_t sid)
+{
+	struct proc_ev	*pe;
+
+	if ((pe = proc_ev_find(pid)) == NULL) {
+		if ((pe = malloc(sizeof(struct proc_ev))) == NULL) {
+			log_err(errno, __func__, "malloc");
+			proc_ev_valid = 0;
+			return;
+		}
+		pe->pe_pid = pid;
+		pe->pe_next = proc_ev_hash[pid % PROC_EV_HASH];
+		proc_ev_hash[pid % PROC_EV_HASH] = pe;
+	}
+	pe->pe_ppid = ppid;
+	pe->pe_sid = sid;
+}
+
+/**
+ * @brief
+ *	Remove process 'pid' from the proc connector table.
+ *
+ * @param[in]	pid - process id
+ *
+ * @return	void
+ */
+static void
+proc_ev_del(pid_t pid)
+{
+	struct proc_ev	**ppe;
+	struct proc_ev	*pe;
+
+	for (ppe = &proc_ev_hash[pid % PROC_EV_HASH]; (pe = *ppe) != NULL;
+		ppe = &pe->pe_next) {
+		if (pe->pe_pid == pid) {
+			*ppe = pe->pe_next;
+			free(pe);
+			return;
+		}
+	}
+}
+
+/**
+ * @brief
+ *	Read the ppid and session of process 'pid' from /proc/<pid>/stat.
+ *
+ * @param[in]	pid - process id
+ * @param[out]	ppid - parent process id
+ * @param[out]	sid - session id
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	the process is gone or its stat file is unreadable
+ */
+static int
+proc_ev_stat(pid_t pid, pid_t *ppid, pid_t *sid)
+{
+	char	procname[64];
+	FILE	*fd;
+	int	rc;
+
+	sprintf(procname, "/proc/%d/stat", (int)pid);
+	if ((fd = fopen(procname, "r")) == NULL)
+		return (-1);
+	rc = fscanf(fd, "%*d (%*[^)]) %*c %d %*d %d", ppid, sid);
+	fclose(fd);
+	return ((rc == 2) ? 0 : -1);
+}
+
+/**
+ * @brief
+ *	Empty the proc connector table and reload it with every process
+ *	in /proc.  Called when the connector is opened and after events
+ *	were lost.
+ *
+ * @return	void
+ */
+static void
+proc_ev_seed(void)
+{
+	struct proc_ev	*pe;
+	struct dirent	*dent;
+	DIR		*dir;
+	pid_t		ppid, sid;
+	int		i;
+
+	for (i = 0; i < PROC_EV_HASH; i++) {
+		while ((pe = proc_ev_hash[i]) != NULL) {
+			proc_ev_hash[i] = pe->pe_next;
+			free(pe);
+		}
+	}
+	proc_ev_valid = 0;
+	if ((dir = opendir(procfs)) == NULL) {
+		log_err(errno, __func__, "opendir");
+		return;
+	}
+	proc_ev_valid = 1;
+	while ((dent = readdir(dir)) != NULL) {
+		if (!isdigit(dent->d_name[0]))
+			continue;
+		i = atoi(dent->d_name);
+		if (proc_ev_stat((pid_t)i, &ppid, &sid) == 0)
+			proc_ev_add((pid_t)i, ppid, sid);
+	}
+	closedir(dir);
+}
+
+/**
+ * @brief
+ *	Read the pending proc connector messages from 'sd' and apply the
+ *	fork, setsid and exit events in them to the proc connector table.
+ *	Registered with add_conn() for the connector socket; also called
+ *	before the table is used so that it is current.
+ *
+ * @param[in]	sd - the connector socket
+ *
+ * @return	void
+ */
+static void
+proc_ev_read(int sd)
+{
+	char			buf[8192] __attribute__((aligned(NLMSG_ALIGNTO)));
+	struct nlmsghdr		*nlh;
+	struct cn_msg		*cn;
+	struct proc_event	*ev;
+	struct proc_ev		*parent;
+	pid_t			ppid, sid;
+	int			len;
+
+	for (;;) {
+		len = recv(sd, buf, sizeof(buf), MSG_DONTWAIT);
+		if (len == -1) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			if (errno == ENOBUFS) {
+				log_event(PBSEVENT_DEBUG3, 0, LOG_DEBUG, __func__,
+					"proc connector events lost, reloading from /proc");
+				proc_ev_seed();
+				continue;
+			}
+			log_err(errno, __func__, "proc connector recv");
+			close_conn(sd);
+			proc_ev_fd = -1;
+			proc_ev_valid = 0;
+			return;
+		}
+		if (len == 0)
+			break;
+		for (nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, (unsigned int)len);
+			nlh = NLMSG_NEXT(nlh, len)) {
+			if ((nlh->nlmsg_type == NLMSG_ERROR) ||
+				(nlh->nlmsg_type == NLMSG_OVERRUN)) {
+				proc_ev_seed();
+				break;
+			}
+			if (nlh->nlmsg_type == NLMSG_NOOP)
+				continue;
+			cn = NLMSG_DATA(nlh);
+			if ((cn->id.idx != CN_IDX_PROC) || (cn->id.val != CN_VAL_PROC))
+				continue;
+			ev = (struct proc_event *)cn->data;
+			switch (ev->what) {
+				case PROC_EVENT_FORK:
+					/* threads are not processes of their own */
+					if (ev->event_data.fork.child_pid !=
+						ev->event_data.fork.child_tgid)
+						break;
+					ppid = ev->event_data.fork.parent_tgid;
+					parent = proc_ev_find(ppid);
+					if (parent != NULL)
+						sid = parent->pe_sid;
+					else if (proc_ev_stat(ev->event_data.fork.child_pid,
+						&ppid, &sid) == -1)
+						break;
+					proc_ev_add(ev->event_data.fork.child_pid, ppid, sid);
+					break;
+
+				case PROC_EVENT_SID:
+					parent = proc_ev_find(ev->event_data.sid.process_tgid);
+					if (parent != NULL)
+						parent->pe_sid = ev->event_data.sid.process_tgid;
+					break;
+
+				case PROC_EVENT_EXIT:
+					if (ev->event_data.exit.process_pid ==
+						ev->event_data.exit.process_tgid)
+						proc_ev_del(ev->event_data.exit.process_pid);
+					break;
+
+				default:
+					break;
+			}
+		}
+	}
+}
+
+/**
+ * @brief
+ *	Subscribe to the Linux proc connector so that the processes of each
+ *	session can be found without reading all of /proc.  Does nothing
+ *	unless $proc_events is set.  On failure mom keeps reading /proc.
+ *
+ * @return	void
+ */
+static void
+proc_ev_open(void)
+{
+	char			buf[NLMSG_SPACE(sizeof(struct cn_msg) +
+					sizeof(enum proc_cn_mcast_op))]
+					__attribute__((aligned(NLMSG_ALIGNTO)));
+	struct nlmsghdr		*nlh = (struct nlmsghdr *)buf;
+	struct cn_msg		*cn;
+	struct sockaddr_nl	addr;
+	enum proc_cn_mcast_op	op = PROC_CN_MCAST_LISTEN;
+	int			sd;
+
+	if (!proc_events || (proc_ev_fd != -1))
+		return;
+
+	sd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+	if (sd == -1) {
+		log_err(errno, __func__, "proc connector socket");
+		return;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = CN_IDX_PROC;
+	if (bind(sd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+		log_err(errno, __func__, "proc connector bind");
+		close(sd);
+		return;
+	}
+
+	memset(buf, 0, sizeof(buf));
+	nlh->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+	nlh->nlmsg_type = NLMSG_DONE;
+	cn = NLMSG_DATA(nlh);
+	cn->id.idx = CN_IDX_PROC;
+	cn->id.val = CN_VAL_PROC;
+	cn->len = sizeof(op);
+	memcpy(cn->data, &op, sizeof(op));
+	if (send(sd, nlh, nlh->nlmsg_len, 0) == -1) {
+		log_err(errno, __func__, "proc connector listen");
+		close(sd);
+		return;
+	}
+
+	if (add_conn(sd, ChildPipe, (pbs_net_t)0, 0, NULL, proc_ev_read) == NULL) {
+		log_err(-1, __func__, "proc connector add_conn");
+		close(sd);
+		return;
+	}
+	proc_ev_fd = sd;
+	proc_ev_seed();
+	log_event(PBSEVENT_SYSTEM, 0, LOG_INFO, __func__,
+		"tracking processes with proc connector events");
+}
+
+/**
+ * @brief
+ *	Bring the proc connector table up to date.
+ *
+ * @return	int
+ * @retval	1	the table can be used in place of a /proc sample
+ * @retval	0	it cannot; take a sample with mom_get_sample()
+ */
+int
+proc_events_current(void)
+{
+	if (proc_ev_fd == -1)
+		return (0);
+	proc_ev_read(proc_ev_fd);
+	return (proc_ev_valid);
+}
+
 /**
  * @brief
  * 	Setup for polling.
@@ -5520,6 +6143,7 @@ mom_open_poll(void)
 		return (PBSE_SYSTEM);
 	}
 	max_proc = TBL_INC;
+	proc_ev_open();
 
 	return (PBSE_NONE);
 }
@@ -5542,9 +6166,7 @@ mom_get_sample(void)
 	char			procname[384]; /* space for dent->d_name plus extra */
 	struct stat		sb;
 	proc_stat_t		*ps = NULL;
-#if MOM_CPUSET
 	pidcachetype_t		*pidcache = NULL;
-#endif	/* MOM_CPUSET */
 	int			nprocs = 0;
 	int			ncached = 0;
 	int			ncantstat = 0;
@@ -5558,16 +6180,18 @@ mom_get_sample(void)
 	if (pdir == NULL)
 		return PBSE_INTERNAL;
 
-#if MOM_CPUSET
 	if (((pidcache = pidcache_getarena()) == NULL) && pidcache_needed()) {
 		if ((pidcache = pidcache_create()) == NULL)
 			log_err(errno, __func__, "PID cache create");
 		if ((pidcache != NULL) && (ncached = pidcache_reset(pidcache)) == -1) {
+			/* fall back to reading every process in /proc */
 			ncached = 0;
-			log_err(errno, __func__, "PID cache reset");
+			log_event(PBSEVENT_DEBUG3, 0, LOG_DEBUG, __func__,
+				"PID cache reset failed, scanning all of /proc");
+			pidcache_destroy();
+			pidcache = NULL;
 		}
 	}
-#endif /* MOM_CPUSET */
 	rewinddir(pdir);
 	nproc = 0;
 	fd = NULL;
@@ -5590,16 +6214,14 @@ mom_get_sample(void)
 			} else
 				continue;
 		}
-#if MOM_CPUSET
-		{
+		if (pidcache != NULL) {
 			pid_t	p;
 			p = strtol(dent->d_name, NULL, 10);
-			if ((pidcache != NULL) && pidcache_check(p, pidcache) == 0) {
+			if (pidcache_check(p, pidcache) == 0) {
 				nskipped++;
 				continue;
 			}
 		}
-#endif	/* MOM_CPUSET */
 		sprintf(procname, "/proc/%s/stat", dent->d_name);
 
 		if ((fd = fopen(procname, "r")) == NULL) {
@@ -5687,10 +6309,8 @@ mom_get_sample(void)
 		nprocs - 2, ncantstat, nnomem, nskipped,
 		ncached);
 	log_event(PBSEVENT_DEBUG4, 0, LOG_DEBUG, __func__, log_buffer);
-#if MOM_CPUSET
 	if (pidcache != NULL)
 		pidcache_destroy();
-#endif	/* MOM_CPUSET */
 	return (PBSE_NONE);
 }
 
@@ -5722,6 +6342,7 @@ mom_set_use(job *pjob)
 	u_Long 		*lp_sz, lnum_sz;
 	ulong		*lp, lnum, oldcput;
 	long		ncpus_req;
+	unsigned long long cg_val;
 
 	assert(pjob != NULL);
 	at = &pjob->ji_wattr[(int)JOB_ATR_resc_used];
@@ -5770,6 +6391,10 @@ mom_set_use(job *pjob)
 	lp = (ulong *)&pres->rs_value.at_val.at_long;
 	oldcput = *lp;
 	lnum = cput_sum(pjob);
+	/* the job cgroup also counts processes that left the job's sessions */
+	if (cgroup_v2 &&
+		(cgroup_v2_read(pjob, "cpu.stat", "usage_usec", &cg_val) == 0))
+		lnum = (ulong)((double)(cg_val / 1000000) * cputfactor);
 	lnum = MAX(*lp, lnum);
 	if ((pres->rs_value.at_flags & ATR_VFLAG_HOOK) == 0) {
 		/* don't conflict with hook setting a value */
@@ -5821,7 +6446,11 @@ mom_set_use(job *pjob)
 		pres->rs_value.at_val.at_size.atsv_units = ATR_SV_BYTESZ;
 	} else if ((pres->rs_value.at_flags & ATR_VFLAG_HOOK) == 0) {
 		lp_sz = &pres->rs_value.at_val.at_size.atsv_num;
-		lnum_sz = (resi_sum(pjob) + 1023) >> 10; /* as KB */
+		if (cgroup_v2 &&
+			(cgroup_v2_read(pjob, "memory.current", NULL, &cg_val) == 0))
+			lnum_sz = (cg_val + 1023) >> 10; /* as KB */
+		else
+			lnum_sz = (resi_sum(pjob) + 1023) >> 10; /* as KB */
 		*lp_sz = MAX(*lp_sz, lnum_sz);
 	}
 
@@ -5834,7 +6463,9 @@ mom_set_use(job *pjob)
  * 	in a given session.
  *
  *	The PBS_PROC_* macros are defined in resmom/.../mom_mach.h
- *	to refer to the correct machine dependent table.
+ *	to refer to the correct machine dependent table.  When $proc_events
+ *	is set and the proc connector table is current, the session's
+ *	processes are taken from that table instead.
  *	Linkage scope changed from static to default as this gets referred
  *	from scan_for_terminated(), declaration	added in the mom_mach.h.
  *
@@ -5849,6 +6480,7 @@ bld_ptree(pid_t sid)
 {
 	int	myproc_ct;		/* count of processes in a session */
 	int	i, j;
+	struct proc_ev	*pe;
 
 	if (Proc_lnks == NULL) {
 		Proc_lnks = (pbs_plinks *)malloc(TBL_INC * sizeof(pbs_plinks));
@@ -5862,24 +6494,48 @@ bld_ptree(pid_t sid)
 	 */
 
 	myproc_ct = 0;
-	for (i = 0; i < nproc; i++) {
-		if (PBS_PROC_PID(i) <= 1)
-			continue;
-		if ((int)PBS_PROC_SID(i) == sid) {
-			Proc_lnks[myproc_ct].pl_pid = PBS_PROC_PID(i);
-			Proc_lnks[myproc_ct].pl_ppid = PBS_PROC_PPID(i);
-			Proc_lnks[myproc_ct].pl_parent = -1;
-			Proc_lnks[myproc_ct].pl_sib = -1;
-			Proc_lnks[myproc_ct].pl_child = -1;
-			Proc_lnks[myproc_ct].pl_done = 0;
-			if (++myproc_ct == myproc_max) {
-				void * hold;
-
-				myproc_max += TBL_INC;
-				hold = realloc((void *)Proc_lnks,
-					myproc_max*sizeof(pbs_plinks));
-				assert(hold != NULL);
-				Proc_lnks = (pbs_plinks *)hold;
+	if (proc_events_current()) {
+		for (i = 0; i < PROC_EV_HASH; i++) {
+			for (pe = proc_ev_hash[i]; pe != NULL; pe = pe->pe_next) {
+				if ((pe->pe_pid <= 1) || (pe->pe_sid != sid))
+					continue;
+				Proc_lnks[myproc_ct].pl_pid = pe->pe_pid;
+				Proc_lnks[myproc_ct].pl_ppid = pe->pe_ppid;
+				Proc_lnks[myproc_ct].pl_parent = -1;
+				Proc_lnks[myproc_ct].pl_sib = -1;
+				Proc_lnks[myproc_ct].pl_child = -1;
+				Proc_lnks[myproc_ct].pl_done = 0;
+				if (++myproc_ct == myproc_max) {
+					void * hold;
+
+					myproc_max += TBL_INC;
+					hold = realloc((void *)Proc_lnks,
+						myproc_max*sizeof(pbs_plinks));
+					assert(hold != NULL);
+					Proc_lnks = (pbs_plinks *)hold;
+				}
+			}
+		}
+	} else {
+		for (i = 0; i < nproc; i++) {
+			if (PBS_PROC_PID(i) <= 1)
+				continue;
+			if ((int)PBS_PROC_SID(i) == sid) {
+				Proc_lnks[myproc_ct].pl_pid = PBS_PROC_PID(i);
+				Proc_lnks[myproc_ct].pl_ppid = PBS_PROC_PPID(i);
+				Proc_lnks[myproc_ct].pl_parent = -1;
+				Proc_lnks[myproc_ct].pl_sib = -1;
+				Proc_lnks[myproc_ct].pl_child = -1;
+				Proc_lnks[myproc_ct].pl_done = 0;
+				if (++myproc_ct == myproc_max) {
+					void * hold;
+
+					myproc_max += TBL_INC;
+					hold = realloc((void *)Proc_lnks,
+						myproc_max*sizeof(pbs_plinks));
+					assert(hold != NULL);
+					Proc_lnks = (pbs_plinks *)hold;
+				}
 			}
 		}
 	}
@@ -5980,7 +6636,10 @@ kill_session(pid_t sesid, int sig, int dir)
 	if (sesid <= 1)
 		return 0;
 
-	(void)mom_get_sample();
+	if (!proc_events_current() && (!kill_batch_depth || !kill_batch_sampled)) {
+		(void)mom_get_sample();
+		kill_batch_sampled = 1;
+	}
 	ct = bld_ptree(sesid);
 	DBPRT(("%s: bld_ptree %d\n", __func__, ct))
 
@@ -6012,6 +6671,35 @@ kill_session(pid_t sesid, int sig, int dir)
 	return ct;
 }
 
+/**
+ * @brief
+ *	Start a batch of signals, e.g. to all the tasks of a job.  Until the
+ *	matching kill_batch_end(), kill_session() builds its process trees
+ *	from one process sample instead of taking a new one per session.
+ *	Batches may nest.
+ *
+ * @return	void
+ */
+void
+kill_batch_begin(void)
+{
+	if (kill_batch_depth++ == 0)
+		kill_batch_sampled = 0;
+}
+
+/**
+ * @brief
+ *	End a batch of signals started by kill_batch_begin().
+ *
+ * @return	void
+ */
+void
+kill_batch_end(void)
+{
+	if (kill_batch_depth > 0)
+		kill_batch_depth--;
+}
+
 /**
  * @brief
  *	Clean up everything related to polling.
@@ -7812,6 +8500,7 @@ cpuset_free_job_CPUs(job *pjob)
 #endif	/* DEBUG */
 	}
 }
+#endif	/* MOM_CPUSET */
 
 
 /** @fn pidcache_create
@@ -7831,30 +8520,94 @@ cpuset_free_job_CPUs(job *pjob)
  *		information.  A pid_t can take on 1 << (sizeof(pid_t) * NBBY)
  *		possible values, so the pidcachetype_t array's size must be
  *		(1 << (sizeof(pid_t) * NBBY)) / (sizeof(pidcachetype_t) * NBBY)
- *		bytes.
+ *		bytes.  When the kernel's pid_max can be read, the set is
+ *		only made large enough to hold PIDs up to that value.
  */
 static pidcachetype_t *
 pidcache_create(void)
 {
 	unsigned long long	numerator, denominator;
 	unsigned long		setsize;
+	FILE			*fp;
+	long			pid_max = 0;
 
-	numerator = ((unsigned long long) 1 << (sizeof(pid_t) * NBBY));
-	denominator = (unsigned long long)(sizeof(pidcachetype_t) * NBBY);
-	setsize = (unsigned long)((unsigned long long) numerator/denominator);
-	assert(setsize <=
-		((unsigned long long) 1 << (sizeof(pidcachetype_t) * NBBY)));
+	if ((fp = fopen("/proc/sys/kernel/pid_max", "r")) != NULL) {
+		if (fscanf(fp, "%ld", &pid_max) != 1)
+			pid_max = 0;
+		fclose(fp);
+	}
+	if (pid_max > 0) {
+		pidcache_pidmax = (pid_t) pid_max;
+		setsize = (unsigned long)((pid_max / pidcache_bitsper) + 1) *
+			sizeof(pidcachetype_t);
+	} else {
+		numerator = ((unsigned long long) 1 << (sizeof(pid_t) * NBBY));
+		denominator = (unsigned long long)(sizeof(pidcachetype_t) * NBBY);
+		setsize = (unsigned long)((unsigned long long) numerator/denominator);
+		assert(setsize <=
+			((unsigned long long) 1 << (sizeof(pidcachetype_t) * NBBY)));
+	}
 	assert(pidcache_arena == NULL);
 	pidcache_arena = calloc(1, (size_t) setsize);
 	return (pidcache_arena);
 }
 
+/** @fn pidcache_reset_cgroup_v2
+ * @brief	reset pidcache with the PIDs in the cgroup.procs file of the
+ *		cgroup v2 cgroup of each job (see cgroup_v2_attach())
+ *
+ * @return	int
+ * @retval	nprocs	- number of processes cached
+ *		-1	- a job has running tasks but no readable cgroup, so
+ *			  its processes can only be found by reading all of
+ *			  /proc
+ *
+ * @par MT-Safe:	no
+ * @par Side Effects:
+ *	None
+ */
+static int
+pidcache_reset_cgroup_v2(pidcachetype_t *pidcache)
+{
+	extern pbs_list_head	svr_alljobs;
+	job			*pjob;
+	task			*ptask;
+	char			path[MAXPATHLEN+1];
+	char			line[25];
+	FILE			*fd;
+	int			nprocs = 0;
+
+	for (pjob = (job *)GET_NEXT(svr_alljobs); pjob != NULL;
+		pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
+		snprintf(path, sizeof(path), "%s/%s/cgroup.procs",
+			cgroup_v2_base(), pjob->ji_qs.ji_jobid);
+		if ((fd = fopen(path, "r")) == NULL) {
+			for (ptask = (task *)GET_NEXT(pjob->ji_tasks);
+				ptask != NULL;
+				ptask = (task *)GET_NEXT(ptask->ti_jobtask)) {
+				if (ptask->ti_qs.ti_status == TI_STATE_RUNNING)
+					return -1;
+			}
+			continue;
+		}
+		while (fgets(line, sizeof(line), fd) != NULL) {
+			if (pidcache_insert((pid_t) strtol(line, NULL, 10),
+				pidcache))
+				nprocs++;
+		}
+		fclose(fd);
+	}
+	return nprocs;
+}
+
 /** @fn pidcache_reset
- * @brief	reset pidcache with new set of PIDs from /dev/cpuset/PBSPro
+ * @brief	reset pidcache with new set of PIDs from the job cgroups when
+ *		$cgroup_v2 is set, or from /dev/cpuset/PBSPro otherwise
  *
  * @return	int
  * @retval	nprocs	- number of processes cached
- *		-1	- when stat fails to open a cpuset tasks file
+ *		-1	- when stat fails to open a cpuset tasks file, or when
+ *			  the job cgroups cannot account for every job
  *
  * @par MT-Safe:	yes
  * @par Side Effects:
@@ -7863,6 +8616,7 @@ pidcache_create(void)
 static int
 pidcache_reset(pidcachetype_t *pidcache)
 {
+#if	MOM_CPUSET
 	struct dirent		*dent = NULL;
 	pid_t			pid = 0;
 	int			ncantstat = 0;
@@ -7871,7 +8625,12 @@ pidcache_reset(pidcachetype_t *pidcache)
 	char			*p = NULL;
 	int			i = 0;
 	int			nprocs = 0;
+#endif	/* MOM_CPUSET */
+
+	if (cgroup_v2)
+		return (pidcache_reset_cgroup_v2(pidcache));
 
+#if	MOM_CPUSET
 	if (cpusetdir == NULL) {
 		if ((cpusetdir = opendir(cpusetfs)) == NULL) {
 			log_err(errno, __func__, "opendir");
@@ -7905,6 +8664,9 @@ pidcache_reset(pidcachetype_t *pidcache)
 		return -1;
 	else
 		return nprocs;
+#else
+	return -1;
+#endif	/* MOM_CPUSET */
 }
 
 /** @fn pidcache_destroy
@@ -8030,16 +8792,27 @@ pidcache_check(pid_t p, pidcachetype_t *set)
  *		will benefit substantially.  SGI's Ultraviolet is one such
  *		class of systems.  SGI suggested the "/proc/sgi_uv" test below
  *		as the way to tell we're running on a UV.
+ *
+ *		When $cgroup_v2 is set the cache is always used:  it is
+ *		filled from the job cgroups, so each sample only reads the
+ *		/proc entries of job processes.
  */
 static int
 pidcache_needed(void)
 {
+#if	MOM_CPUSET
 	struct stat	sb;
+#endif	/* MOM_CPUSET */
 
+	if (cgroup_v2)
+		return (1);
+#if	MOM_CPUSET
 	if ((stat("/proc/sgi_uv", &sb) == 0) || (pidcache_test == 1))
 		return (1);
-	else
-		return (0);
-}
+#else
+	if (pidcache_test == 1)
+		return (1);
 #endif	/* MOM_CPUSET */
+	return (0);
+}
 #endif	/* PBSMOM_HTUNIT */
@@ -153,6 +153,17 @@ extern int mom_close_poll();		/* Terminate poll ability */
 extern int mach_checkpoint(struct task *, char *path, int abt);
 extern long mach_restart(struct task *, char *path);	/* Restart checkpointed job */
 extern int	set_job(job *, struct startjob_rtn *);
+extern int	cgroup_v2_attach(job *);
+extern void	cgroup_v2_remove(job *);
+extern int	cgroup_v2_kill(job *);
+extern int	cgroup_v2_freeze(job *, int);
+extern void	kill_batch_begin(void);
+extern void	kill_batch_end(void);
+extern int	cgroup_v2;
+extern int	proc_events_current(void);
+extern int	proc_events;
+extern int	task_pidfd;
+extern void	task_pidfd_watch(struct task *);
 extern void	starter_return(int, int, int, struct startjob_rtn *);
 extern void	set_globid(job *, struct startjob_rtn *);
 extern void	mom_topology(void);
@@ -52,6 +52,7 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <sys/resource.h>
+#include <sys/syscall.h>
 #include <sys/param.h>
 #include <sys/utsname.h>
 #include <ctype.h>
@@ -69,6 +70,7 @@
 #include "mom_vnode.h"
 #include "libutil.h"
 #include "work_task.h"
+#include "net_connect.h"
 
 /**
  * @struct
@@ -149,6 +151,23 @@ extern	int		num_pcpus;
 extern	int		svr_delay_entry;
 
 extern	pbs_list_head	task_list_event;
+extern	int		task_pidfd;
+
+/*
+ * Tasks whose top process mom watches with a pidfd, hashed by that pid.
+ * The entry is also the data of the pidfd connection, and is freed when
+ * the connection is closed, either after the exit is handled or when
+ * the task is freed.
+ */
+#define	TASK_PIDFD_HASH	1024
+struct task_pidfd {
+	struct task_pidfd	*tp_next;
+	pid_t			tp_pid;
+	int			tp_fd;
+	pbs_task		*tp_task;
+};
+static struct task_pidfd	*task_pidfd_tab[TASK_PIDFD_HASH];
+static int			task_pidfd_count = 0;
 
 #if	MOM_CPUSET || MOM_ALPS
 extern	char		*path_jobs;
@@ -1988,6 +2007,9 @@ set_job(job *pjob, struct startjob_rtn *sjr)
 		return -2;
 #endif	/* MOM_CPUSET */
 
+	if (cgroup_v2_attach(pjob) < 0)
+		return -2;
+
 #if	MOM_CSA || MOM_ALPS
 	if (job_facility_present && pjob->ji_qs.ji_svrflags & JOB_SVFLG_HERE) {
 
@@ -2403,6 +2425,251 @@ set_shell(job *pjob, struct passwd *pwdp)
 	return (shell);
 }
 
+/**
+ * @brief
+ *	Find the pidfd watch of a task's top process.
+ *
+ * @param[in]	pid - the process id
+ *
+ * @return	struct task_pidfd *
+ * @retval	the watch	found
+ * @retval	NULL		pid not watched
+ *
+ */
+static struct task_pidfd *
+task_pidfd_find(pid_t pid)
+{
+	struct task_pidfd	*tp;
+
+	for (tp = task_pidfd_tab[pid % TASK_PIDFD_HASH]; tp; tp = tp->tp_next) {
+		if (tp->tp_pid == pid)
+			break;
+	}
+	return tp;
+}
+
+/**
+ * @brief
+ *	Close function of a pidfd connection: unhash and free its watch.
+ *
+ * @param[in]	fd - the pidfd
+ *
+ * @return	void
+ *
+ */
+static void
+task_pidfd_close(int fd)
+{
+	struct task_pidfd	*tp;
+	struct task_pidfd	**prev;
+
+	if ((tp = get_conn_data(fd)) == NULL)
+		return;
+	for (prev = &task_pidfd_tab[tp->tp_pid % TASK_PIDFD_HASH]; *prev;
+		prev = &(*prev)->tp_next) {
+		if (*prev == tp) {
+			*prev = tp->tp_next;
+			break;
+		}
+	}
+	if (tp->tp_task != NULL)
+		tp->tp_task->ti_pidfd = -1;
+	task_pidfd_count--;
+	free(tp);
+}
+
+/**
+ * @brief
+ *	Record that the top process of a task has terminated: unless it left
+ *	processes behind in a job being terminated, kill what remains of the
+ *	session and mark the task EXITED for scan_for_exiting().
+ *
+ * @param[in]	pjob - the job
+ * @param[in]	ptask - the task
+ * @param[in]	exiteval - exit value, as computed by scan_for_terminated()
+ *
+ * @return	void
+ *
+ */
+static void
+task_terminated(job *pjob, pbs_task *ptask, int exiteval)
+{
+	DBPRT(("%s: task %8.8X pid %d exit value %d\n", __func__,
+		ptask->ti_qs.ti_task, ptask->ti_qs.ti_sid, exiteval))
+	ptask->ti_qs.ti_exitstat = exiteval;
+	sprintf(log_buffer, "task %8.8X terminated",
+		ptask->ti_qs.ti_task);
+	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+		pjob->ji_qs.ji_jobid, log_buffer);
+
+	/*
+	 ** After the top process(shell) of the TASK exits, check if the
+	 ** JOB_SVFLG_TERMJOB job flag set. If yes, then check for any
+	 ** live process(s) in the session. If found, make the task
+	 ** ORPHAN by setting the flag and delay by kill_delay time. This
+	 ** will be exited in kill_job or by cput_sum() as can not be
+	 ** seen again by scan_for_terminated().
+	 */
+	if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_TERMJOB) {
+		int	n;
+
+		if (!proc_events_current())
+			(void)mom_get_sample();
+		n = bld_ptree(ptask->ti_qs.ti_sid);
+		if (n > 0) {
+			ptask->ti_flags |= TI_FLAGS_ORPHAN;
+			DBPRT(("%s: task %8.8X still has %d active procs\n", __func__,
+				ptask->ti_qs.ti_task, n))
+			return;
+		}
+	}
+
+	kill_session(ptask->ti_qs.ti_sid, SIGKILL, 0);
+	ptask->ti_qs.ti_status = TI_STATE_EXITED;
+	(void)task_save(ptask);
+	exiting_tasks = 1;
+}
+
+/**
+ * @brief
+ *	Convert a wait status into the exit value kept for a task.
+ *
+ * @param[in]	statloc - status from waitpid()
+ *
+ * @return	int
+ *
+ */
+static int
+wait_exiteval(int statloc)
+{
+	if (WIFEXITED(statloc))
+		return (WEXITSTATUS(statloc));
+	else if (WIFSIGNALED(statloc))
+		return (WTERMSIG(statloc) + 0x100);
+	return 1;
+}
+
+/**
+ * @brief
+ *	Reap the top process of a task watched with a pidfd, once it has
+ *	terminated.  Only the usage of that job is updated before the
+ *	zombie goes, and the task is reached through the watch, so neither
+ *	a sample of every job nor a search of every task list is needed.
+ *
+ * @param[in]	tp - the watch
+ *
+ * @return	void
+ *
+ */
+static void
+task_pidfd_reap(struct task_pidfd *tp)
+{
+	pbs_task	*ptask = tp->tp_task;
+	job		*pjob = ptask->ti_job;
+	siginfo_t	si;
+	int		statloc;
+	pid_t		pid;
+
+	/* still a zombie, so its last usage can be read */
+	si.si_pid = 0;
+	if ((waitid(P_PID, tp->tp_pid, &si, WEXITED | WNOHANG | WNOWAIT) == 0) &&
+		(si.si_pid == 0))
+		return;		/* not terminated yet */
+	if (mom_get_sample() == PBSE_NONE)
+		mom_set_use(pjob);
+
+	while (((pid = waitpid(tp->tp_pid, &statloc, WNOHANG)) == -1) &&
+		(errno == EINTR))
+		;
+	if (pid == 0)
+		return;
+	close_conn(tp->tp_fd);	/* frees tp */
+	if (pid == -1) {
+		/* already reaped elsewhere, the exit status is lost */
+		log_err(errno, __func__, "waitpid");
+		return;
+	}
+	task_terminated(pjob, ptask, wait_exiteval(statloc));
+}
+
+/**
+ * @brief
+ *	Read function of a task's pidfd: the process has terminated.
+ *
+ * @param[in]	fd - the pidfd
+ *
+ * @return	void
+ *
+ */
+static void
+task_pidfd_read(int fd)
+{
+	struct task_pidfd	*tp;
+
+	if ((tp = get_conn_data(fd)) == NULL) {
+		close_conn(fd);
+		return;
+	}
+	task_pidfd_reap(tp);
+}
+
+/**
+ * @brief
+ *	With $task_pidfd set, watch the top process of a just started task
+ *	with a pidfd polled along with mom's other connections, so that its
+ *	exit is handled without scanning every job and task.
+ *
+ * @param[in]	ptask - the task, its ti_sid is a child of mom
+ *
+ * @return	void
+ *
+ */
+void
+task_pidfd_watch(pbs_task *ptask)
+{
+#ifdef SYS_pidfd_open
+	static int		unsupported = 0;
+	struct task_pidfd	*tp;
+	int			fd;
+	pid_t			pid = ptask->ti_qs.ti_sid;
+
+	if (!task_pidfd || unsupported || (pid <= 1) || (ptask->ti_pidfd != -1))
+		return;
+
+	if ((fd = (int)syscall(SYS_pidfd_open, pid, 0)) == -1) {
+		if ((errno == ENOSYS) || (errno == EINVAL)) {
+			unsupported = 1;
+			log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_NOTICE,
+				__func__, "pidfd_open not supported, tasks are "
+				"found by scanning jobs");
+		} else if (errno != ESRCH)
+			log_err(errno, __func__, "pidfd_open");
+		return;
+	}
+	(void)fcntl(fd, F_SETFD, FD_CLOEXEC);
+	if ((tp = (struct task_pidfd *)malloc(sizeof(*tp))) == NULL) {
+		log_err(errno, __func__, "malloc");
+		(void)close(fd);
+		return;
+	}
+	if (add_conn(fd, ChildPipe, (pbs_net_t)0, 0, NULL, task_pidfd_read) == NULL) {
+		log_err(-1, __func__, "add_conn");
+		free(tp);
+		(void)close(fd);
+		return;
+	}
+	tp->tp_pid = pid;
+	tp->tp_fd = fd;
+	tp->tp_task = ptask;
+	tp->tp_next = task_pidfd_tab[pid % TASK_PIDFD_HASH];
+	task_pidfd_tab[pid % TASK_PIDFD_HASH] = tp;
+	task_pidfd_count++;
+	ptask->ti_pidfd = fd;
+	(void)add_conn_data(fd, tp);
+	net_add_close_func(fd, task_pidfd_close);
+#endif	/* SYS_pidfd_open */
+}
+
 /**
  *
  * @brief
@@ -2413,6 +2680,8 @@ set_shell(job *pjob, struct passwd *pwdp)
  *	marked as WORK_Deferred_Cmp along with the exit value of the child
  *	process. Otherwise if it's for a job, and that job's
  *	JOB_SVFLAG_TERMJOB is set, then mark the job as exiting.
+ *	Tasks watched with a pidfd are reaped one by one first, and if no
+ *	other child is waiting the whole sample is skipped.
  *
  * @return	Void
  *
@@ -2427,12 +2696,25 @@ scan_for_terminated(void)
 	task		*ptask = NULL;
 	struct work_task *wtask = NULL;
 	int		statloc;
+	struct task_pidfd *tp;
+
+	termin_child = 0;
+
+	while (task_pidfd_count > 0) {
+		siginfo_t	si;
+
+		si.si_pid = 0;
+		if ((waitid(P_ALL, 0, &si, WEXITED | WNOHANG | WNOWAIT) == -1) ||
+			(si.si_pid == 0))
+			return;		/* no child to reap */
+		if ((tp = task_pidfd_find(si.si_pid)) == NULL)
+			break;		/* not watched, do it the long way */
+		task_pidfd_reap(tp);
+	}
 
 	/* update the latest intelligence about the running jobs;         */
 	/* must be done before we reap the zombies, else we lose the info */
 
-	termin_child = 0;
-
 	if (mom_get_sample() == PBSE_NONE) {
 		pjob = (job *)GET_NEXT(svr_alljobs);
 		while (pjob) {
@@ -2444,13 +2726,14 @@ scan_for_terminated(void)
 	/* Now figure out which task(s) have terminated (are zombies) */
 
 	while ((pid = waitpid(-1, &statloc, WNOHANG)) > 0) {
-		if (WIFEXITED(statloc))
-			exiteval = WEXITSTATUS(statloc);
-		else if (WIFSIGNALED(statloc))
-			exiteval = WTERMSIG(statloc) + 0x100;
-		else
-			exiteval = 1;
+		exiteval = wait_exiteval(statloc);
 
+		if ((tp = task_pidfd_find(pid)) != NULL) {
+			ptask = tp->tp_task;
+			close_conn(tp->tp_fd);
+			task_terminated(ptask->ti_job, ptask, exiteval);
+			continue;
+		}
 
 		/* Check for other task lists */
 		wtask = (struct work_task *)GET_NEXT(task_list_event);
@@ -2500,39 +2783,7 @@ scan_for_terminated(void)
 			(void)job_save(pjob, SAVEJOB_QUICK);
 			continue;
 		}
-		DBPRT(("%s: task %8.8X pid %d exit value %d\n", __func__,
-			ptask->ti_qs.ti_task, pid, exiteval))
-		ptask->ti_qs.ti_exitstat = exiteval;
-		sprintf(log_buffer, "task %8.8X terminated",
-			ptask->ti_qs.ti_task);
-		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_DEBUG,
-			pjob->ji_qs.ji_jobid, log_buffer);
-
-		/*
-		 ** After the top process(shell) of the TASK exits, check if the
-		 ** JOB_SVFLG_TERMJOB job flag set. If yes, then check for any
-		 ** live process(s) in the session. If found, make the task
-		 ** ORPHAN by setting the flag and delay by kill_delay time. This
-		 ** will be exited in kill_job or by cput_sum() as can not be
-		 ** seen again by scan_for_terminated().
-		 */
-		if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_TERMJOB) {
-			int	n;
-
-			(void)mom_get_sample();
-			n = bld_ptree(ptask->ti_qs.ti_sid);
-			if (n > 0) {
-				ptask->ti_flags |= TI_FLAGS_ORPHAN;
-				DBPRT(("%s: task %8.8X still has %d active procs\n", __func__,
-					ptask->ti_qs.ti_task, n))
-				continue;
-			}
-		}
-
-		kill_session(ptask->ti_qs.ti_sid, SIGKILL, 0);
-		ptask->ti_qs.ti_status = TI_STATE_EXITED;
-		(void)task_save(ptask);
-		exiting_tasks = 1;
+		task_terminated(pjob, ptask, exiteval);
 	}
 }
 
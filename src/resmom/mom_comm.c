@@ -208,12 +208,16 @@ pbs_jobnodevoid_t	job_free_node = NULL;
 
 /* the following depends on tm_node_id being 0 to n-1 */
 #define TO_PHYNODE(vnode) pjob->ji_vnods[vnode].vn_host->hn_node
+#define	STREAM_HINT_MIN	16	/* hosts in a job before streams are hashed */
+#define	RESC_USED_REFRESH 10	/* polls an unchanged resources_used is skipped */
 
 eventent * event_dup(eventent *ep, job *pjob, hnodent *pnode);
 
 /**
  * @brief
  *	Save the critical information associated with a task to disk.
+ *	The file is only rewritten when ti_qs differs from what was last
+ *	written, as most callers save a task whose state has not changed.
  *
  * @param[in]   ptask - structure handle holding task info to be saved
  *
@@ -232,6 +236,11 @@ task_save(pbs_task *ptask)
 	char	filnam[MAXPATHLEN+1];
 	int	openflags;
 
+	if ((ptask->ti_flags & TI_FLAGS_SAVED) &&
+		memcmp(&ptask->ti_saved, &ptask->ti_qs, sizeof(ptask->ti_qs)) == 0)
+		return (0);
+	ptask->ti_flags &= ~TI_FLAGS_SAVED;
+
 	(void)strcpy(namebuf, path_jobs);      /* job directory path */
 	if (*pjob->ji_qs.ji_fileprefix != '\0')
 		(void)strcat(namebuf, pjob->ji_qs.ji_fileprefix);
@@ -273,9 +282,33 @@ task_save(pbs_task *ptask)
 		}
 	}
 	(void)close(fds);
+	ptask->ti_saved = ptask->ti_qs;
+	ptask->ti_flags |= TI_FLAGS_SAVED;
 	return (0);
 }
 
+/**
+ * @brief
+ *	Note that host 'pnode' of 'pjob' has just been given an event, so
+ *	job_pending_event() must look at it again.
+ *
+ * @param[in] pjob - job pointer to job
+ * @param[in] pnode - hnode pointer to node the event was linked to
+ *
+ * @return void
+ *
+ */
+static void
+event_rescan(job *pjob, hnodent *pnode)
+{
+	if ((pnode >= pjob->ji_hosts) &&
+		(pnode < pjob->ji_hosts + pjob->ji_numnodes)) {
+		if ((int)(pnode - pjob->ji_hosts) < pjob->ji_evscan)
+			pjob->ji_evscan = (int)(pnode - pjob->ji_hosts);
+	} else
+		pjob->ji_evscan = 0;
+}
+
 /**
  * @brief
  *	Duplicate an event and link it to the given nodeent entry.
@@ -300,6 +333,7 @@ event_dup(eventent *ep, job *pjob, hnodent *pnode)
 	CLEAR_LINK(nep->ee_next);
 
 	append_link(&pnode->hn_events, &nep->ee_next, nep);
+	event_rescan(pjob, pnode);
 
 	if (pnode->hn_stream == -1)
 		pnode->hn_stream = rpp_open(pnode->hn_host, pnode->hn_port);
@@ -382,6 +416,7 @@ check:
 	}
 
 	append_link(&pnode->hn_events, &ep->ee_next, ep);
+	event_rescan(pjob, pnode);
 
 	if (pnode->hn_stream == -1)
 		pnode->hn_stream = rpp_open(pnode->hn_host, pnode->hn_port);
@@ -389,6 +424,126 @@ check:
 	return ep;
 }
 
+/**
+ * @brief
+ *	Return the first event still outstanding with any host of 'pjob'.
+ *	The scan starts at ji_evscan, as every host before it is known to
+ *	have no events, and leaves ji_evscan at the host found.  Waiting
+ *	for the replies of all the sisters of a wide job thus costs one
+ *	pass over ji_hosts in total rather than one pass per reply.
+ *
+ * @param[in] pjob - pointer to job structure
+ *
+ * @return eventent *
+ * @retval first outstanding event
+ * @retval NULL when no host has an event left
+ *
+ */
+eventent *
+job_pending_event(job *pjob)
+{
+	eventent	*ep;
+	int		i;
+
+	if ((pjob->ji_evscan < 0) || (pjob->ji_evscan > pjob->ji_numnodes))
+		pjob->ji_evscan = 0;
+	for (i = pjob->ji_evscan; i < pjob->ji_numnodes; i++) {
+		ep = (eventent *)GET_NEXT(pjob->ji_hosts[i].hn_events);
+		if (ep != NULL) {
+			pjob->ji_evscan = i;
+			return ep;
+		}
+	}
+	pjob->ji_evscan = pjob->ji_numnodes;
+	return NULL;
+}
+
+/**
+ * @brief
+ *	(Re)build the table mapping the streams of the hosts of 'pjob' to
+ *	their index in ji_hosts.
+ *
+ * @param[in] pjob - pointer to job structure
+ *
+ * @return void
+ *
+ */
+static void
+build_stream_hint(job *pjob)
+{
+	struct stream_hint	*sh;
+	int			sz, i, h;
+
+	for (sz = 16; sz < 2 * pjob->ji_numnodes; sz <<= 1)
+		;
+	if (pjob->ji_strmhintsz != sz) {
+		sh = realloc(pjob->ji_strmhint, sz * sizeof(struct stream_hint));
+		if (sh == NULL) {
+			free(pjob->ji_strmhint);
+			pjob->ji_strmhint = NULL;
+			pjob->ji_strmhintsz = 0;
+			return;
+		}
+		pjob->ji_strmhint = sh;
+		pjob->ji_strmhintsz = sz;
+	}
+	sh = pjob->ji_strmhint;
+	for (h = 0; h < sz; h++)
+		sh[h].sh_stream = -1;
+	for (i = 0; i < pjob->ji_numnodes; i++) {
+		if (pjob->ji_hosts[i].hn_stream < 0)
+			continue;
+		for (h = pjob->ji_hosts[i].hn_stream & (sz - 1);
+			sh[h].sh_stream != -1; h = (h + 1) & (sz - 1))
+			;
+		sh[h].sh_stream = pjob->ji_hosts[i].hn_stream;
+		sh[h].sh_node = i;
+	}
+}
+
+/**
+ * @brief
+ *	Find the host of 'pjob' a message on 'stream' came from.  For a wide
+ *	job the answer is looked up in ji_strmhint, which is rebuilt when it
+ *	is found to be out of date, so that handling each sister's reply
+ *	does not cost a pass over ji_hosts.
+ *
+ * @param[in] pjob - pointer to job structure
+ * @param[in] stream - stream the message came in on
+ *
+ * @return int
+ * @retval index in ji_hosts
+ * @retval ji_numnodes if no host of the job uses 'stream'
+ *
+ */
+static int
+find_stream_node(job *pjob, int stream)
+{
+	struct stream_hint	*sh = pjob->ji_strmhint;
+	int			mask = pjob->ji_strmhintsz - 1;
+	int			h, i;
+
+	if ((sh != NULL) && (stream >= 0)) {
+		for (h = stream & mask; sh[h].sh_stream != -1; h = (h + 1) & mask) {
+			if (sh[h].sh_stream != stream)
+				continue;
+			i = sh[h].sh_node;
+			if ((i < pjob->ji_numnodes) &&
+				(pjob->ji_hosts[i].hn_stream == stream))
+				return i;
+			break;
+		}
+	}
+
+	for (i = 0; i < pjob->ji_numnodes; i++) {
+		if (pjob->ji_hosts[i].hn_stream == stream)
+			break;
+	}
+	if ((i < pjob->ji_numnodes) && (pjob->ji_numnodes > STREAM_HINT_MIN))
+		build_stream_hint(pjob);
+	return i;
+}
+
 /**
  * @brief
  *	How many bits does it take to represent a number?
@@ -451,6 +606,7 @@ momtask_create(job *pjob)
 	ptask->ti_tmfd = NULL;
 	ptask->ti_protover = -1;
 	ptask->ti_flags = 0;
+	ptask->ti_pidfd = -1;
 	ptask->ti_cput = 0;
 #ifdef WIN32
 	ptask->ti_hProc = NULL;
@@ -634,6 +790,8 @@ task_recov(job *pjob)
 			continue;
 		}
 		pt->ti_qs = task_save;
+		pt->ti_saved = task_save;
+		pt->ti_flags |= TI_FLAGS_SAVED;
 		(void)close(fds);
 
 		if (task_save.ti_sid > 0) {
@@ -675,6 +833,8 @@ task_recov(job *pjob)
 			continue;
 		}
 		pt->ti_qs = task_save;
+		pt->ti_saved = task_save;
+		pt->ti_flags |= TI_FLAGS_SAVED;
 		(void)close(fds);
 	}
 	if (errno != 0 && errno != ENOENT) {
@@ -2728,16 +2888,22 @@ static	char	bail_format[] = "dis read failed: %s";
  *	Send resources_used values to the MS via
  *	'stream' descriptor.
  *
+ *	Unless 'force' is set, nothing is sent when the values are the same
+ *	as the last ones sent for the job, for up to RESC_USED_REFRESH polls
+ *	in a row.  The MS keeps the values it has for this node when none
+ *	follow, as it always has for a sister with no hook-set resources.
+ *
  * @param[in] stream - descriptor pathway to MS.
  * @param[in] jobid - the jobid of the owning job.
+ * @param[in] force - send the values even if they did not change
  *
  * @return  error code
- * @retval -1     error
+ * @retval -1     error, or nothing sent
  * @retval  0     Success
  *
  */
 int
-send_resc_used_to_ms(int stream, char *jobid)
+send_resc_used_to_ms(int stream, char *jobid, int force)
 {
 	attribute		*at;
 	attribute_def		*ad;
@@ -2749,6 +2915,8 @@ send_resc_used_to_ms(int stream, char *jobid)
 	svrattrl		 *psatl;
 	job			*pjob;
 	int			ret;
+	u_long			hash;
+	char			*ch;
 
 	if (jobid == NULL)
 		return (-1);
@@ -2812,6 +2980,24 @@ send_resc_used_to_ms(int stream, char *jobid)
 		return (-1);
 	}
 
+	/* FNV-1a hash of what would be sent */
+	hash = 2166136261UL;
+	for (pal = psatl; pal != NULL; pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+		for (ch = pal->al_resc; *ch != '\0'; ch++)
+			hash = (hash ^ (unsigned char)*ch) * 16777619UL;
+		hash = (hash ^ '=') * 16777619UL;
+		for (ch = pal->al_value; *ch != '\0'; ch++)
+			hash = (hash ^ (unsigned char)*ch) * 16777619UL;
+		hash = (hash ^ ',') * 16777619UL;
+	}
+	if (!force && (hash == pjob->ji_rusedhash) &&
+		(++pjob->ji_rusedskip < RESC_USED_REFRESH)) {
+		free_attrlist(&send_head);
+		return (-1);
+	}
+	pjob->ji_rusedhash = hash;
+	pjob->ji_rusedskip = 0;
+
 	ret = encode_DIS_svrattrl(stream, psatl);
 	free_attrlist(&send_head);
 	if (ret != DIS_SUCCESS)
@@ -3536,13 +3722,10 @@ join_err:
 	 ** reply == 1 means that this is a request to which a reply may happen
 	 */
 	if (reply == 0) {
-		for (nodeidx=0; nodeidx<pjob->ji_numnodes; nodeidx++) {
+		nodeidx = find_stream_node(pjob, stream);
+		if (nodeidx < pjob->ji_numnodes) {
 			np = &pjob->ji_hosts[nodeidx];
-
-			if (np->hn_stream == stream) {
-				np->hn_eof_ts = 0; /* reset down timestamp */
-				break;
-			}
+			np->hn_eof_ts = 0; /* reset down timestamp */
 		}
 		if (nodeidx == pjob->ji_numnodes) {
 			if (pjob->ji_updated)  {
@@ -4212,7 +4395,7 @@ join_err:
 				break;
 			ret = diswul(stream, resc_used(pjob, "cpupercent", gettime));
 
-			send_resc_used_to_ms(stream, jobid);
+			send_resc_used_to_ms(stream, jobid, 0);
 
 			break;
 
@@ -4474,12 +4657,7 @@ join_err:
 							goto err;
 					}
 
-					for (i=0; i<pjob->ji_numnodes; i++) {
-						hnodent *xp = &pjob->ji_hosts[i];
-						if ((ep = (eventent *)GET_NEXT(xp->hn_events))
-							!= NULL)
-							break;
-					}
+					ep = job_pending_event(pjob);
 
 					if (do_tolerate_node_failures(pjob) &&
 					    (nodeidx > 0) && (nodeidx < pjob->ji_numnodes)) {
@@ -4550,12 +4728,7 @@ join_err:
 					}
 					DBPRT(("%s: SETUP_JOB %s from %s OKAY\n", __func__,
 						jobid, np->hn_host))
-					for (i=0; i<pjob->ji_numnodes; i++) {
-						np = &pjob->ji_hosts[i];
-						if ((ep = (eventent *)GET_NEXT(np->hn_events))
-							!= NULL)
-							break;
-					}
+					ep = job_pending_event(pjob);
 
 					if (ep == NULL) {	/* all SETUPs done */
 						/*
@@ -4871,12 +5044,7 @@ join_err:
 					break;
 
 				case	IM_UPDATE_JOB:
-					for (i = 0; i < pjob->ji_numnodes; i++) {
-						hnodent *xp = &pjob->ji_hosts[i];
-						ep = (eventent *)GET_NEXT(xp->hn_events);
-  						if (ep != NULL)
-							break;
-					}
+					ep = job_pending_event(pjob);
 
 					if ((nodeidx > 0) && (nodeidx < pjob->ji_numnodes)) {
 						char *hn;
@@ -4901,12 +5069,7 @@ join_err:
 					break;
 
 				case	IM_EXEC_PROLOGUE:
-					for (i = 0; i < pjob->ji_numnodes; i++) {
-						hnodent *xp = &pjob->ji_hosts[i];
-						ep = (eventent *)GET_NEXT(xp->hn_events);
-  						if (ep != NULL)
-							break;
-					}
+					ep = job_pending_event(pjob);
 
 					if ((nodeidx > 0) && (nodeidx < pjob->ji_numnodes)) {
 						char *hn;
@@ -5002,11 +5165,7 @@ join_err:
 					if (!do_tolerate_node_failures(pjob))
 						break;
 
-					for (i = 0; i < pjob->ji_numnodes; i++) {
-						hnodent *xp = &pjob->ji_hosts[i];
-						if ((ep = (eventent *)GET_NEXT(xp->hn_events)) != NULL)
-							break;
-					}
+					ep = job_pending_event(pjob);
 					if (ep == NULL) {	/* no events */
 						int rcode;
 						int do_break = 0;
@@ -5071,12 +5230,7 @@ join_err:
 					if (!do_tolerate_node_failures(pjob))
 						break;
 
-					for (i = 0; i < pjob->ji_numnodes; i++) {
-						hnodent *xp = &pjob->ji_hosts[i];
-						if ((ep = (eventent *)GET_NEXT(xp->hn_events))
-							!= NULL)
-							break;
-					}
+					ep = job_pending_event(pjob);
 
 #ifndef WIN32
 					if (ep == NULL) {
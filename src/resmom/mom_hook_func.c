@@ -44,6 +44,8 @@
 #include <unistd.h>
 #include <sys/param.h>
 #include <dirent.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 #endif
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -88,6 +90,9 @@
 #define	RESCASSN_NCPUS	"resources_assigned.ncpus"
 #define	RESCASSN_MEM	"resources_assigned.mem"
 #define	RESCASSN_HOST	"resources_assigned.host"
+
+/* seconds past its alarm a background periodic hook may run before mom kills it */
+#define	PERIODIC_HOOK_KILL_GRACE	5
 /* External functions */
 
 /* Local Private Functions */
@@ -211,6 +216,35 @@ run_hook_alarm(void)
 	run_exit = -3;
 }
 
+#ifndef WIN32
+/**
+ * @brief
+ *	Kill a background periodic hook that is still running well past its
+ *	alarm, so that pbs_python being stuck where its own alarm cannot
+ *	interrupt it does not stop the hook from ever running again.
+ *	post_periodic_hook() then handles it as a failed run.
+ *
+ * @param[in]	ptask - work task, wt_parm1 is the hook and wt_parm2 the
+ *			pid of the hook process
+ *
+ * @return none
+ */
+static void
+periodic_hook_watchdog(struct work_task *ptask)
+{
+	hook	*phook = (hook *)ptask->wt_parm1;
+	pid_t	child = (pid_t)(long)ptask->wt_parm2;
+
+	phook->ptask = NULL;
+	snprintf(log_buffer, sizeof(log_buffer),
+		"periodic hook still running %d seconds past its alarm of %d "
+		"seconds, killing it", PERIODIC_HOOK_KILL_GRACE, phook->alarm);
+	log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_HOOK, LOG_ERR,
+		phook->hook_name, log_buffer);
+	(void)kill(-child, SIGKILL);
+}
+#endif
+
 
 /**
  * @brief
@@ -848,6 +882,15 @@ run_hook(hook *phook, unsigned int event_type, mom_hook_input_t *hook_input,
 			}
 		 	if (php)
 				ptask->wt_parm2 = (void *)php;
+			if (event_type == HOOK_EVENT_EXECHOST_PERIODIC) {
+				/* the periodic hook's own alarm, kept apart */
+				/* from that of any other hook running now */
+				phook->ptask = set_task(WORK_Timed,
+					time_now + phook->alarm + PERIODIC_HOOK_KILL_GRACE,
+					periodic_hook_watchdog, phook);
+				if (phook->ptask != NULL)
+					phook->ptask->wt_parm2 = (void *)(long)child;
+			}
 			return (0);	/* no hook output file at this time */
 		} else if (php)
 			php->child = child;
@@ -2899,6 +2942,12 @@ struct work_task *pwt;
 	reboot_cmd[0] = '\0';
 	reject_msg[0] = '\0';
 
+	if (phook->ptask != NULL) {
+		/* the hook finished, disarm its watchdog */
+		delete_task(phook->ptask);
+		phook->ptask = NULL;
+	}
+
 	/* Check hook exit status */
 	if (wstat != 0) {
 		snprintf(log_buffer, LOG_BUF_SIZE-1,
@@ -3568,6 +3617,34 @@ void reply_hook_bg(job *pjob)
 
  }
 
+/**
+ * @brief
+ *	Return the current time in microseconds for the hook statistics,
+ *	and the cpu time so far consumed by reaped children of mom, which
+ *	includes the pbs_python processes that ran hooks in the foreground.
+ *
+ * @param[out]	cpu_usec - children cpu time, in microseconds
+ *
+ * @return	long long
+ */
+static long long
+hook_stats_now(long long *cpu_usec)
+{
+	struct timeval tv;
+#ifndef WIN32
+	struct rusage ru;
+
+	if (getrusage(RUSAGE_CHILDREN, &ru) == 0)
+		*cpu_usec = (long long)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000 +
+			ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+	else
+#endif
+		*cpu_usec = 0;
+
+	gettimeofday(&tv, NULL);
+	return ((long long)tv.tv_sec * 1000000 + tv.tv_usec);
+}
+
 /**
  * @brief
  *	Process hook scripts based on request type.
@@ -3624,6 +3701,10 @@ mom_process_hooks(unsigned int hook_event, char *req_user, char *req_host,
 	mom_process_hooks_params_t *php = NULL;
 	struct work_task task;
 	char		perf_label[MAXBUFLEN];
+	long long	wall_start;
+	long long	cpu_start;
+	long long	python_usec;
+	long long	cpu_now;
 
 	if (hook_input == NULL) {
 		log_err(-1, __func__, "missing input argument to event");
@@ -3817,9 +3898,11 @@ mom_process_hooks(unsigned int hook_event, char *req_user, char *req_host,
 			snprintf(perf_label, sizeof(perf_label), "hook_%s_%s_%d", hook_event_as_string(hook_event), phook->hook_name, getpid());
 
 		hook_perf_stat_start(perf_label, "mom_process_hooks", 1);
+		wall_start = hook_stats_now(&cpu_start);
 		rc = run_hook(phook, hook_event, hook_input,
 			req_user, req_host, php->parent_wait, (void *)post_run_hook,
 			hook_infile, hook_outfile, hook_datafile, MAXPATHLEN+1, php);
+		python_usec = hook_stats_now(&cpu_now) - wall_start;
 		hook_perf_stat_stop(perf_label, "mom_process_hooks", 1);
 
 		if (last_phook != NULL) {
@@ -3870,6 +3953,8 @@ mom_process_hooks(unsigned int hook_event, char *req_user, char *req_host,
 				if (reject_errcode != NULL) {
 					*reject_errcode = PBSE_HOOKERROR;
 				}
+				hook_stats_add(phook, hook_event, 0, python_usec,
+					cpu_now - cpu_start, python_usec);
 				record_job_last_hook_executed(hook_event, phook->hook_name, pjob, hook_outfile);
 				free (php);
 				return (0);
@@ -3894,6 +3979,8 @@ mom_process_hooks(unsigned int hook_event, char *req_user, char *req_host,
 				if (reject_errcode != NULL) {
 					*reject_errcode = PBSE_HOOKERROR;
 				}
+				hook_stats_add(phook, hook_event, 0, python_usec,
+					cpu_now - cpu_start, python_usec);
 				record_job_last_hook_executed(hook_event, phook->hook_name, pjob, hook_outfile);
 				free (php);
 				return (0);
@@ -3903,12 +3990,20 @@ mom_process_hooks(unsigned int hook_event, char *req_user, char *req_host,
 					phook->hook_name);
 				log_event(log_type, log_class,
 					LOG_ERR, log_id, log_buffer);
+				hook_stats_add(phook, hook_event, -1, python_usec,
+					cpu_now - cpu_start, python_usec);
 				free (php);
 				return (-1); /* should not happen */
 		}
 
 		num_run++;
 
+		if ((hook_event == HOOK_EVENT_EXECHOST_PERIODIC) ||
+			(php->parent_wait == 0)) {
+			/* outcome and cost of a background hook are not known here */
+			hook_stats_add(phook, hook_event, -1, python_usec, 0, python_usec);
+		}
+
 		if (hook_event == HOOK_EVENT_EXECHOST_PERIODIC) {
 			/* hook backgrounded */
 			if ((php = duplicate_php(php)) == NULL)
@@ -3921,7 +4016,11 @@ mom_process_hooks(unsigned int hook_event, char *req_user, char *req_host,
 
 		task.wt_parm1 = (void *)phook;
 		task.wt_parm2 = (void *)php;
-		if ((rc = post_run_hook(&task)) != 1) {
+		rc = post_run_hook(&task);
+		hook_stats_add(phook, hook_event, (rc == 1) ? 1 : ((rc == 0) ? 0 : -1),
+			hook_stats_now(&cpu_now) - wall_start, cpu_now - cpu_start,
+			python_usec);
+		if (rc != 1) {
 			/* if a hook is not accepted do not proceed further*/
 			free(php);
 			return rc;
@@ -82,6 +82,9 @@
 #include	<limits.h>
 #include	<sys/types.h>
 #include	<sys/stat.h>
+#if defined(NAS) && defined(linux) /* localmod 015 */
+#include	<sys/inotify.h>
+#endif /* localmod 015 */
 
 #include	"libpbs.h"
 #include	"pbs_ifl.h"
@@ -107,6 +110,7 @@
 #include	"libsec.h"
 #include	"pbs_ecl.h"
 #include	"pbs_internal.h"
+#include	"hostcache.h"
 #if	defined(MOM_CPUSET)
 #include	"mom_vnode.h"
 #endif	/* MOM_CPUSET */
@@ -207,7 +211,9 @@ pid_t		mom_pid;
 int		mom_run_state = 1;
 char		mom_short_name[PBS_MAXHOSTNAME+1];
 int		next_sample_time = MAX_CHECK_POLL_TIME;
+time_t		job_next_alarm = 1;	/* earliest job alarm, 0 if none; 1 looks on the first pass */
 int		max_check_poll = MAX_CHECK_POLL_TIME;
+int		stage_concurrency = 1;	/* parallel copy workers per request */
 int		min_check_poll = MIN_CHECK_POLL_TIME;
 int		inc_check_poll = 20;
 int		num_acpus = 1;
@@ -222,6 +228,7 @@ char	       *path_spool;
 char	       *path_undeliv;
 char	       *path_addconfigs;
 char		path_addconfigs_reserved_prefix[] = "PBS";
+char	       *path_topology;	/* cached hwloc topology, shared with hooks */
 
 char	       *path_hooks;
 char	       *path_hooks_workdir;
@@ -298,6 +305,12 @@ static		resource_def *rdwall;
 int		restart_background = FALSE;
 int		reject_root_scripts = FALSE;
 int		report_hook_checksums = TRUE;
+int		cgroup_v2 = FALSE;	/* mom manages cgroup v2 job cgroups */
+int		proc_events = FALSE;	/* track processes with proc connector */
+int		task_pidfd = FALSE;	/* watch task exits with pidfds */
+char		**status_resources = NULL;	/* resources reported in the node status */
+int		status_resources_interval = 60;	/* seconds between updates of them */
+static time_t	time_status_resources = 0;	/* when they are updated next */
 int		restart_transmogrify = FALSE;
 int		attach_allow = TRUE;
 extern double		wallfactor;
@@ -495,6 +508,7 @@ static handler_ret_t	set_enforcement(char *);
 static handler_ret_t	set_jobdir_root(char *);
 static handler_ret_t	set_kbd_idle(char *);
 static handler_ret_t	set_max_check_poll(char *);
+static handler_ret_t	set_stage_concurrency(char *);
 static handler_ret_t	set_min_check_poll(char *);
 static handler_ret_t	set_momname(char *);
 static handler_ret_t	set_momport(char *);
@@ -513,6 +527,11 @@ static handler_ret_t	setidealload(char *);
 static handler_ret_t	setlogevent(char *);
 static handler_ret_t	set_reject_root_scripts(char *);
 static handler_ret_t	set_report_hook_checksums(char *);
+static handler_ret_t	set_cgroup_v2(char *);
+static handler_ret_t	set_proc_events(char *);
+static handler_ret_t	set_task_pidfd(char *);
+static handler_ret_t	set_status_resources(char *);
+static handler_ret_t	set_status_resources_interval(char *);
 static handler_ret_t	setmaxload(char *);
 static handler_ret_t	set_max_poll_downtime(char *);
 #if	MOM_BGL
@@ -572,6 +591,7 @@ static struct	specials {
 	{ "kbd_idle",			set_kbd_idle },
 	{ "logevent",			setlogevent },
 	{ "max_check_poll",		set_max_check_poll },
+	{ "stage_concurrency",		set_stage_concurrency },
 	{ "max_load",			setmaxload },
 	{ "max_poll_downtime",		set_max_poll_downtime },
 	{ "min_check_poll",		set_min_check_poll },
@@ -589,6 +609,8 @@ static struct	specials {
 	{ "restrict_user_exceptions",	set_restrict_user_exceptions },
 	{ "restrict_user_maxsysid",	set_restrict_user_maxsys },
 	{ "restricted",			restricted },
+	{ "status_resources",		set_status_resources },
+	{ "status_resources_interval",	set_status_resources_interval },
 #ifdef NAS /* localmod 015 */
 	/*
 	 * spool size limit
@@ -602,6 +624,9 @@ static struct	specials {
 	{ "wallmult",			wallmult },
 	{ "reject_root_scripts",	set_reject_root_scripts },
 	{ "report_hook_checksums",	set_report_hook_checksums },
+	{ "cgroup_v2",			set_cgroup_v2 },
+	{ "proc_events",		set_proc_events },
+	{ "task_pidfd",			set_task_pidfd },
 	{ NULL,				NULL }
 };
 
@@ -1027,6 +1052,107 @@ dependent(char *res, struct rm_attribute *attr)
 	return NULL;
 }
 
+/*
+ * Values of dependent() resources asked for without parameters are kept
+ * for queries that follow closely; see rm_cached().
+ */
+#define	RM_CACHE_SIZE	32
+#define	RM_CACHE_TIME	1	/* seconds a dynamic value is reused */
+static struct rm_cache {
+	char	rc_name[64];
+	char	*rc_value;	/* NULL with rc_errno for a failed value */
+	int	rc_errno;
+	time_t	rc_when;
+} rm_cache[RM_CACHE_SIZE];
+static int	rm_cache_next = 0;
+
+/* resources that do not change while mom runs, kept until a HUP */
+static char	*rm_cache_static[] = {
+	"arch", "uname", "ncpus", "physmem", NULL
+};
+
+/**
+ * @brief
+ *	Drop the values kept by rm_cached().
+ *
+ * @return void
+ */
+static void
+rm_cache_clear(void)
+{
+	int	i;
+
+	for (i = 0; i < RM_CACHE_SIZE; i++) {
+		free(rm_cache[i].rc_value);
+		rm_cache[i].rc_value = NULL;
+		rm_cache[i].rc_name[0] = '\0';
+	}
+	rm_cache_next = 0;
+}
+
+/**
+ * @brief
+ *	dependent() for the resource monitor queries and the status sent to
+ *	the server.  A value asked for without parameters is computed at
+ *	most once per RM_CACHE_TIME, and once until the next HUP for the
+ *	resources of rm_cache_static[], so the queries of a scheduling
+ *	cycle or of one connection do not each re-read /proc.
+ *
+ * @param[in] res - resource name
+ * @param[in] attr - parameters of the query, or NULL
+ *
+ * @return	string
+ * @retval	the value, valid until the next call
+ * @retval	NULL	no value, see rm_errno
+ */
+static char *
+rm_cached(char *res, struct rm_attribute *attr)
+{
+	struct rm_cache	*rc;
+	char		*value;
+	time_t		now;
+	int		i;
+	int		keep = 0;
+
+	if ((attr != NULL) || (strlen(res) >= sizeof(rm_cache[0].rc_name)))
+		return (dependent(res, attr));
+
+	for (i = 0; rm_cache_static[i] != NULL; i++) {
+		if (strcmp(rm_cache_static[i], res) == 0) {
+			keep = 1;
+			break;
+		}
+	}
+
+	now = time(NULL);
+	for (i = 0; i < RM_CACHE_SIZE; i++) {
+		rc = &rm_cache[i];
+		if (strcmp(rc->rc_name, res) != 0)
+			continue;
+		if (keep || ((now - rc->rc_when) < RM_CACHE_TIME)) {
+			rm_errno = rc->rc_errno;
+			return (rc->rc_value);
+		}
+		break;
+	}
+	if (i == RM_CACHE_SIZE) {
+		rc = &rm_cache[rm_cache_next];
+		rm_cache_next = (rm_cache_next + 1) % RM_CACHE_SIZE;
+	}
+
+	value = dependent(res, attr);
+
+	free(rc->rc_value);
+	rc->rc_value = NULL;
+	rc->rc_name[0] = '\0';
+	if ((value != NULL) && ((rc->rc_value = strdup(value)) == NULL))
+		return (value);		/* just don't keep it */
+	strcpy(rc->rc_name, res);
+	rc->rc_errno = rm_errno;
+	rc->rc_when = now;
+	return (value);
+}
+
 /**
  * @brief
  *	wrapper function to dep_cleanup
@@ -2173,6 +2299,62 @@ set_report_hook_checksums(char *value)
 	return (set_boolean(__func__, value, &report_hook_checksums));
 }
 
+/**
+ * @brief
+ *	Set the "$cgroup_v2" config option: when true, mom puts the tasks of
+ *	each job in a cgroup v2 cgroup of its own, and reads the job's cpu
+ *	and memory usage from there.
+ *
+ * @param[in]	value - True or False
+ *
+ * @return handler_ret_t
+ * @retval	HANDLER_FAIL(0)		- failure
+ * @retval	HANDLER_SUCCESS(1)	- success
+ */
+static handler_ret_t
+set_cgroup_v2(char *value)
+{
+	return (set_boolean(__func__, value, &cgroup_v2));
+}
+
+/**
+ * @brief
+ *	Set the "$proc_events" config option: when true, mom follows process
+ *	fork, setsid and exit events from the Linux proc connector to know
+ *	the processes of each session without reading all of /proc.
+ *	Takes effect when mom starts.
+ *
+ * @param[in]	value - True or False
+ *
+ * @return handler_ret_t
+ * @retval	HANDLER_FAIL(0)		- failure
+ * @retval	HANDLER_SUCCESS(1)	- success
+ */
+static handler_ret_t
+set_proc_events(char *value)
+{
+	return (set_boolean(__func__, value, &proc_events));
+}
+
+/**
+ * @brief
+ *	Set the "$task_pidfd" config option: when true, mom watches the top
+ *	process of each task it starts with a Linux pidfd and handles its
+ *	exit from that, rather than by sampling and scanning all jobs.
+ *
+ * @param[in] value - boolean string
+ *
+ * @return	handler_ret_t
+ * @retval	HANDLER_SUCCESS	success
+ * @retval	HANDLER_FAIL	failure
+ *
+ */
+static handler_ret_t
+set_task_pidfd(char *value)
+{
+	return (set_boolean(__func__, value, &task_pidfd));
+}
+
 /**
  * @brief
  *	sets log event if host is restricted.
@@ -2986,9 +3168,10 @@ do_mom_action_script(int	ae,	/* index into action table */
 		rc = 1;
 		pjob->ji_momsubt = pi.hProcess;
 		pjob->ji_mompost = post;
-		if (ma->ma_timeout)
+		if (ma->ma_timeout) {
 			pjob->ji_actalarm = time_now + ma->ma_timeout;
-		else
+			job_alarm_set(pjob->ji_actalarm);
+		} else
 			pjob->ji_actalarm = 0;
 		goto done;
 	}
@@ -3277,9 +3460,10 @@ do_mom_action_script(int	ae,	/* index into action table */
 		rc = 1;
 		pjob->ji_momsubt = child;
 		pjob->ji_mompost = post;
-		if (ma->ma_timeout)
+		if (ma->ma_timeout) {
 			pjob->ji_actalarm = time_now + ma->ma_timeout;
-		else
+			job_alarm_set(pjob->ji_actalarm);
+		} else
 			pjob->ji_actalarm = 0;
 		goto done;
 	}
@@ -3319,6 +3503,7 @@ do_mom_action_script(int	ae,	/* index into action table */
 		}
 		ptask->ti_qs.ti_sid = sjr.sj_session;
 		ptask->ti_qs.ti_status = TI_STATE_RUNNING;
+		task_pidfd_watch(ptask);
 		(void)task_save(ptask);
 		/* update the job with the new session id */
 		pjob->ji_wattr[(int)JOB_ATR_session_id].at_val.at_long
@@ -4305,6 +4490,27 @@ set_max_check_poll(char *value)
 	return (set_int(id, value, &max_check_poll));
 }
 
+/**
+ * @brief
+ *      sets the number of file pairs of a single stage-in/stage-out
+ *	request that may be copied at the same time
+ *
+ * @param[in] value - number of concurrent copies, at least 1
+ *
+ * @return      handler_ret_t
+ * @retval      HANDLER_SUCCESS         success
+ * @retval      HANDLER_FAIL            Failure
+ *
+ */
+
+static handler_ret_t
+set_stage_concurrency(char *value)
+{
+	static	char	id[] = "stage_concurrency";
+
+	return (set_int(id, value, &stage_concurrency));
+}
+
 /**
  * @brief
  *      sets minimum poll checks
@@ -4467,6 +4673,60 @@ set_restrict_user_exceptions(char *user_list)
 	return HANDLER_SUCCESS;
 }
 
+/**
+ * @brief
+ *	Set the "$status_resources" config option: the comma separated
+ *	resources in mom's config are evaluated every
+ *	$status_resources_interval seconds and reported as
+ *	resources_available of the natural vnode in the status sent to the
+ *	server, so the scheduler does not need to query them itself.
+ *
+ * @param[in] value - comma separated resource names
+ *
+ * @return	handler_ret_t
+ * @retval	HANDLER_SUCCESS	success
+ * @retval	HANDLER_FAIL	failure
+ *
+ */
+static handler_ret_t
+set_status_resources(char *value)
+{
+	char	**list;
+
+	if ((list = break_comma_list(value)) == NULL) {
+		log_err(errno, __func__, "break_comma_list failed");
+		return HANDLER_FAIL;
+	}
+	free_string_array(status_resources);
+	status_resources = list;
+	time_status_resources = 0;
+
+	return HANDLER_SUCCESS;
+}
+
+/**
+ * @brief
+ *	Set the "$status_resources_interval" config option.
+ *
+ * @param[in] value - seconds, must be positive
+ *
+ * @return	handler_ret_t
+ * @retval	HANDLER_SUCCESS	success
+ * @retval	HANDLER_FAIL	failure
+ *
+ */
+static handler_ret_t
+set_status_resources_interval(char *value)
+{
+	int	ival;
+
+	if (set_int(__func__, value, &ival) != HANDLER_SUCCESS || ival <= 0)
+		return HANDLER_FAIL;
+	status_resources_interval = ival;
+
+	return HANDLER_SUCCESS;
+}
+
 /**
  * @brief
  *	Set the configuration flag that defines whether to get rid of
@@ -4961,6 +5221,7 @@ read_config(char *file)
 	restart_transmogrify = FALSE;
 	attach_allow	     = TRUE;
 	max_check_poll	     = MAX_CHECK_POLL_TIME;
+	stage_concurrency    = 1;
 	min_check_poll	     = MIN_CHECK_POLL_TIME;
 	vnode_additive       = 1;	/* keep vnodes on HUP */
 	joinjob_alarm_time   = -1;
@@ -5692,6 +5953,70 @@ done:
 	return ret_string;
 }
 
+/**
+ * @brief
+ *	Evaluate the $status_resources the way a resource monitor request
+ *	would and set the values that changed on the natural vnode, to be
+ *	sent to the server with the next state update.
+ *
+ * @return	void
+ *
+ */
+static void
+update_status_resources(void)
+{
+	int		i;
+	int		changed = 0;
+	char		*value;
+	char		*old;
+	char		attrbuf[1024];
+	struct config	*ap;
+
+	if (status_resources == NULL)
+		return;
+	if ((vnlp == NULL) && (vnl_alloc(&vnlp) == NULL)) {
+		log_err(errno, __func__, "vnl_alloc failed");
+		return;
+	}
+
+	for (i = 0; status_resources[i] != NULL; i++) {
+		ap = rm_search(config_array, status_resources[i]);
+#ifndef	WIN32
+		(void)alarm(alarm_time);
+#endif
+		rm_errno = PBSE_NONE;
+		if (ap)
+			value = conf_res(ap->c_u.c_value, NULL);
+		else
+			value = rm_cached(status_resources[i], NULL);
+#ifndef	WIN32
+		(void)alarm(0);
+#endif
+		if ((value == NULL) || (*value == '?') || (*value == '\0')) {
+			log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_NODE, LOG_DEBUG, __func__,
+				"no value for status resource %s", status_resources[i]);
+			continue;
+		}
+
+		snprintf(attrbuf, sizeof(attrbuf), "%s.%s", ATTR_rescavail, status_resources[i]);
+		old = vn_exist(vnlp, mom_short_name, attrbuf);
+		if ((old != NULL) && (strcmp(old, value) == 0))
+			continue;
+		if (vn_addvnr(vnlp, mom_short_name, attrbuf, value, 0, 0, NULL) != 0) {
+			log_err(PBSE_SYSTEM, __func__, "vn_addvnr failed");
+			continue;
+		}
+		log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_NODE, LOG_DEBUG, __func__,
+			"%s = %s", attrbuf, value);
+		changed = 1;
+	}
+
+	if (changed) {
+		vnlp->vnl_modtime = time(NULL);
+		internal_state_update = UPDATE_MOM_STATE;
+	}
+}
+
 #ifndef	WIN32
 /**
  * @brief
@@ -5743,6 +6068,8 @@ process_hup(void)
 		log_event(PBSEVENT_SYSTEM, 0, LOG_INFO, __func__, "reset");
 		log_close(1);
 		log_open(log_file, path_log);
+		hostcache_flush();
+		rm_cache_clear();
 
 		if ((num_var_env = setup_env(pbs_conf.pbs_environment)) == -1) {
 			mom_run_state = 0;
@@ -5777,6 +6104,8 @@ process_hup(void)
 
 	cleanup();
 	initialize();
+	/* the vnode list may have been rebuilt without them */
+	time_status_resources = 0;
 
 #if	MOM_CSA || MOM_ALPS /* ALPS needs libjob support */
 	/*
@@ -5827,8 +6156,22 @@ debug_report(void)
 {
 extern void	mom_CPUs_report(void);
 
+	hook	*phook;
+	char	*stats;
+
 	mom_CPUs_report();
 	mom_vnlp_report(vnlp, NULL);
+	log_tpp_stats();
+
+	/* execution statistics of the hooks that have run here */
+	for (phook = (hook *)GET_NEXT(svr_allhooks); phook != NULL;
+		phook = (hook *)GET_NEXT(phook->hi_allhooks)) {
+		stats = hook_stats_as_string(phook);
+		if (*stats == '\0')
+			continue;
+		log_event(PBSEVENT_SYSTEM | PBSEVENT_FORCE, PBS_EVENTCLASS_HOOK,
+			LOG_INFO, phook->hook_name, stats);
+	}
 	do_debug_report = 0;
 }
 
@@ -6066,7 +6409,7 @@ rm_request(int iochan, int version, int tcp)
 					if (ap)		/* static */
 						value = conf_res(ap->c_u.c_value, attr);
 					else		/* dynamic */
-						value = dependent(name, attr);
+						value = rm_cached(name, attr);
 #ifndef	WIN32
 					(void)alarm(0);
 #endif
@@ -6491,6 +6834,15 @@ kill_job(job *pjob, int sig)
 	log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_DEBUG,
 		pjob->ji_qs.ji_jobid, __func__);
 
+	/*
+	 ** With a job cgroup, SIGKILL reaches every process of the job at
+	 ** once; the tasks are still walked below to account for them.
+	 */
+	if (sig == SIGKILL)
+		(void)cgroup_v2_kill(pjob);
+
+	/* signal all the tasks off one process sample */
+	kill_batch_begin();
 	for (ptask=(pbs_task *)GET_NEXT(pjob->ji_tasks);
 		ptask;
 		ptask=(pbs_task *)GET_NEXT(ptask->ti_jobtask)) {
@@ -6524,6 +6876,7 @@ kill_job(job *pjob, int sig)
 				exiting_tasks = 1;
 		}
 	}
+	kill_batch_end();
 
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5) && 0
 	if (cred_by_job(pjob, CRED_DESTROY) != PBS_KRB5_OK) {
@@ -6536,6 +6889,25 @@ kill_job(job *pjob, int sig)
 #endif	/* WIN32 */
 }
 
+/**
+ * @brief
+ *	Note that a job has an alarm (ji_actalarm, ji_joinalarm) due at 'when',
+ *	or, with 'when' of time_now, needs looking at on every pass, as a job
+ *	with a checkpoint active does.  The main loop only walks the job list
+ *	for alarms once the earliest of these has come.
+ *
+ * @param[in] when - time the alarm is due
+ *
+ * @return Void
+ *
+ */
+void
+job_alarm_set(time_t when)
+{
+	if ((job_next_alarm == 0) || (when < job_next_alarm))
+		job_next_alarm = when;
+}
+
 /**
  * @brief
  *	The finish of MOM's main loop
@@ -6565,6 +6937,7 @@ finish_loop(time_t waittime)
 
 		if (exiting_tasks)
 			scan_for_exiting();
+		send_obits_pending();
 		wait_request(1, NULL);
 	}
 #else
@@ -6583,6 +6956,9 @@ finish_loop(time_t waittime)
 		waittime = next_sample_time;
 	DBPRT(("%s: waittime %lu\n", __func__, (unsigned long) waittime))
 
+	/* send the obits queued in this pass in one message */
+	send_obits_pending();
+
 	/* wait for a request to process */
 	if (wait_request(waittime, NULL) != 0)
 		log_err(-1, msg_daemonname, "wait_request failed");
@@ -7032,6 +7408,119 @@ set_spoolsize(char *value)
 	return HANDLER_SUCCESS;
 }
 
+#ifdef linux
+/*
+ * inotify descriptor watching path_spool, so a job's spool usage is only
+ * measured again after its files change.  If the watch cannot be set up,
+ * spool_watch_failed is set and usage is measured on every poll.
+ */
+static int	spool_ifd = -1;
+static int	spool_watch_failed = 0;
+static time_t	spool_watch_time = 0;
+
+/**
+ * @brief
+ *	spool_name_cmp - qsort/bsearch comparison of spool file base names
+ *
+ * @param[in] a - pointer to first name
+ * @param[in] b - pointer to second name
+ *
+ * @return	int
+ * @retval	as strcmp(3)
+ */
+static int
+spool_name_cmp(const void *a, const void *b)
+{
+	return (strcmp(*(char **)a, *(char **)b));
+}
+
+/**
+ * @brief
+ *	spool_watch - read the changes made in the spool directory since the
+ *	last call and mark the jobs whose files changed to be measured again.
+ *	The watch is set up on the first call.
+ *
+ * @return	int
+ * @retval	1	spool is watched, ji_spoolkb of a marked measured job is current
+ * @retval	0	spool cannot be watched, measure every time
+ */
+static int
+spool_watch(void)
+{
+	char	buf[16384] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	char	*names[sizeof(buf) / sizeof(struct inotify_event)];
+	int	nnames;
+	int	all;
+	ssize_t	len;
+	char	*p;
+	char	*dot;
+	char	*key;
+	struct inotify_event *ev;
+	job	*pjob;
+
+	if (spool_watch_failed)
+		return 0;
+
+	if (spool_ifd == -1) {
+		if (((spool_ifd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) == -1) ||
+			(inotify_add_watch(spool_ifd, path_spool, IN_MODIFY |
+			IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO) == -1)) {
+			log_err(errno, __func__,
+				"unable to watch spool, its usage will be polled");
+			if (spool_ifd != -1)
+				(void)close(spool_ifd);
+			spool_ifd = -1;
+			spool_watch_failed = 1;
+			return 0;
+		}
+		/* jobs already here have not been measured against the watch */
+		for (pjob = (job *)GET_NEXT(svr_alljobs); pjob;
+			pjob = (job *)GET_NEXT(pjob->ji_alljobs))
+			pjob->ji_spoolmeasured = 0;
+		spool_watch_time = time_now;
+		return 1;
+	}
+
+	/* once a second is enough, jobs are polled at intervals of seconds */
+	if (spool_watch_time == time_now)
+		return 1;
+	spool_watch_time = time_now;
+
+	while ((len = read(spool_ifd, buf, sizeof(buf))) > 0) {
+		nnames = 0;
+		all = 0;
+		for (p = buf; p < buf + len;
+			p += sizeof(struct inotify_event) + ev->len) {
+			ev = (struct inotify_event *)p;
+			if (ev->mask & IN_Q_OVERFLOW)
+				all = 1;
+			else if ((ev->len > 0) &&
+				((dot = strrchr(ev->name, '.')) != NULL)) {
+				*dot = '\0';	/* leaves the job id or file prefix */
+				names[nnames++] = ev->name;
+			}
+		}
+		if ((nnames == 0) && (all == 0))
+			continue;
+
+		qsort(names, nnames, sizeof(char *), spool_name_cmp);
+		for (pjob = (job *)GET_NEXT(svr_alljobs); pjob;
+			pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
+			if (*pjob->ji_qs.ji_fileprefix != '\0')
+				key = pjob->ji_qs.ji_fileprefix;
+			else
+				key = pjob->ji_qs.ji_jobid;
+			if (all || (bsearch(&key, names, nnames, sizeof(char *),
+				spool_name_cmp) != NULL))
+				pjob->ji_spoolmeasured = 0;
+		}
+	}
+	return 1;
+}
+#else
+#define	spool_watch()	0
+#endif	/* linux */
+
 /**
  * @brief
  *	spool_usage - compute a job's spool usage (in KB)
@@ -7039,6 +7528,8 @@ set_spoolsize(char *value)
  * Returns the sum of the lengths of stdout and stderr in KB, iff they
  * are being written to the $PBS_HOME/spool directory. In all other cases
  * (e.g. interactive jobs, jobs running in a sandbox), returns zero.
+ * While the spool directory is watched, the files are only looked at again
+ * after they change.
  *
  * @param[in] pjob - pointer to job
  *
@@ -7072,6 +7563,9 @@ job	*pjob;
 
 	/* Job is not interactive */
 
+	if (spool_watch() && pjob->ji_spoolmeasured)
+		return (pjob->ji_spoolkb);
+
 	/* Get full pathname of stdout file */
 
 	outpath = std_file_name(pjob, StdOut, &keeping);
@@ -7101,7 +7595,9 @@ job	*pjob;
 		}
 	}
 
-	return ((outsize+errsize)>>10);
+	pjob->ji_spoolkb = (outsize+errsize)>>10;
+	pjob->ji_spoolmeasured = 1;
+	return (pjob->ji_spoolkb);
 }
 
 
@@ -7370,6 +7866,138 @@ mom_over_limit(job *pjob)
 	return (FALSE);
 }
 
+/**
+ * @brief
+ *	Bound the time to the next usage sample of 'pjob' by how soon the
+ *	job could reach limit 'name'.
+ *
+ * @param[in]	pjob - pointer to job
+ * @param[in]	name - name of a walltime, cput, mem or vmem limit
+ * @param[in]	func - gettime() or getsize(), to decode the limit and usage
+ * @param[in]	rate - for time limits, the most the usage grows per second
+ * @param[in]	bound - interval so far
+ *
+ * @return	int
+ * @retval	'bound', or less if the job is close to the limit
+ */
+static int
+poll_limit_bound(job *pjob, char *name, u_long (*func)(resource *),
+	u_long rate, int bound)
+{
+	resource_def	*rd;
+	resource	*plim;
+	resource	*pused;
+	u_long		limit, used, left;
+
+	rd = find_resc_def(svr_resc_def, name, svr_resc_size);
+	if (rd == NULL)
+		return (bound);
+	plim = find_resc_entry(&pjob->ji_wattr[(int)JOB_ATR_resource], rd);
+	if ((plim == NULL) || ((limit = func(plim)) == 0))
+		return (bound);
+	pused = find_resc_entry(&pjob->ji_wattr[(int)JOB_ATR_resc_used], rd);
+	used = (pused != NULL) ? func(pused) : 0;
+	left = (used < limit) ? limit - used : 0;
+
+	if (rate != 0) {
+		/* a time limit: sample at least twice before it can be hit */
+		left = left / rate / 2;
+	} else {
+		/* a size limit: full interval with half of it left, none at 10% */
+		double	frac = (double)left / (double)limit;
+
+		if (frac <= 0.1)
+			left = 0;
+		else if (frac >= 0.5)
+			left = max_check_poll;
+		else
+			left = (u_long)(max_check_poll * (frac - 0.1) / 0.4);
+	}
+	if (left < (u_long)bound)
+		bound = (int)left;
+	return (bound);
+}
+
+/**
+ * @brief
+ *	Decide when to next sample the usage of 'pjob' after a sample was
+ *	just taken, and record it in ji_nextpoll.
+ *
+ *	Each job has its own interval, which grows from min_check_poll to
+ *	max_check_poll by inc_check_poll per sample, as the global one
+ *	does after a job starts.  It is then cut so that a job close to its
+ *	walltime, cput, mem or vmem limit, or to its next checkpoint, is
+ *	sampled often, while a job far from every limit is sampled rarely.
+ *
+ * @param[in]	pjob - pointer to job
+ *
+ * @return	void
+ */
+static void
+set_job_nextpoll(job *pjob)
+{
+	resource_def	*rd;
+	resource	*pres;
+	u_long		ncpus = 1;
+	int		interval;
+
+	if (pjob->ji_pollint < min_check_poll)
+		pjob->ji_pollint = min_check_poll;
+	else if ((pjob->ji_pollint += inc_check_poll) > max_check_poll)
+		pjob->ji_pollint = max_check_poll;
+	interval = pjob->ji_pollint;
+
+	if (pjob->ji_qs.ji_svrflags & (JOB_SVFLG_OVERLMT1 |
+		JOB_SVFLG_OVERLMT2 | JOB_SVFLG_TERMJOB))
+		interval = min_check_poll;
+
+	rd = find_resc_def(svr_resc_def, "ncpus", svr_resc_size);
+	if (rd != NULL) {
+		pres = find_resc_entry(&pjob->ji_wattr[(int)JOB_ATR_resource], rd);
+		if ((pres != NULL) && (pres->rs_value.at_val.at_long > 1))
+			ncpus = (u_long)pres->rs_value.at_val.at_long;
+	}
+	interval = poll_limit_bound(pjob, "walltime", gettime, 1, interval);
+	interval = poll_limit_bound(pjob, "cput", gettime, ncpus, interval);
+	interval = poll_limit_bound(pjob, "mem", getsize, 0, interval);
+	interval = poll_limit_bound(pjob, "vmem", getsize, 0, interval);
+
+	if ((pjob->ji_chkpttype == PBS_CHECKPOINT_CPUT) ||
+		(pjob->ji_chkpttype == PBS_CHECKPOINT_WALLT)) {
+		u_long	used;
+
+		used = resc_used(pjob, (pjob->ji_chkpttype == PBS_CHECKPOINT_CPUT) ?
+			"cput" : "walltime", gettime);
+		if ((u_long)pjob->ji_chkptnext <= used)
+			interval = min_check_poll;
+		else if ((u_long)pjob->ji_chkptnext - used < (u_long)interval)
+			interval = (int)((u_long)pjob->ji_chkptnext - used);
+	}
+
+	if (interval < min_check_poll)
+		interval = min_check_poll;
+	pjob->ji_nextpoll = time_now + interval;
+}
+
+/**
+ * @brief
+ *	Is the usage of 'pjob' due to be sampled?  A sister always samples
+ *	so that its replies to the mother superior's polls are current.
+ *
+ * @param[in]	pjob - pointer to job
+ *
+ * @return	int
+ * @retval	1	sample it now
+ * @retval	0	not yet
+ */
+static int
+job_poll_due(job *pjob)
+{
+	if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_HERE) == 0)
+		return (1);
+	return (pjob->ji_nextpoll <= time_now);
+}
+
 /**
  * @brief
  *	check attr value limits of job
@@ -8707,6 +9335,8 @@ main(int argc, char *argv[])
 	for (i = 0; i < (svr_resc_size - 1); ++i)
 		svr_resc_def[i].rs_next = &svr_resc_def[i+1];
 	/* last entry is left with null pointer */
+	(void)index_resc_def(svr_resc_def, svr_resc_size);
+	(void)index_attr_def(job_attr_def, JOB_ATR_LAST);
 
 
 	/* set up and validate home paths    */
@@ -8727,6 +9357,7 @@ main(int argc, char *argv[])
 	path_spool = mk_dirs("spool/");
 	path_undeliv = mk_dirs("undelivered/");
 	path_addconfigs = mk_dirs("mom_priv/config.d");
+	path_topology = mk_dirs("mom_priv/topology.xml");
 
 	/* open log file while std in,out,err still open, forces to fd 4 */
 #ifdef	WIN32
@@ -9064,6 +9695,7 @@ main(int argc, char *argv[])
 
 		if (fork() > 0)
 			return (0);	/* parent goes away */
+		log_set_index_owner();
 
 		if (setsid() == -1) {
 			log_err(errno, msg_daemonname, "setsid failed");
@@ -9912,6 +10544,11 @@ main(int argc, char *argv[])
 			}
 		}
 
+		if ((status_resources != NULL) && (time_now >= time_status_resources)) {
+			time_status_resources = time_now + status_resources_interval;
+			update_status_resources();
+		}
+
 		/*
 		 * if needed, update server with my state change can be changed in
 		 * check_busy() or query_adp()
@@ -9961,10 +10598,17 @@ main(int argc, char *argv[])
 		 * Also, if this platform supports checkpoint/restart we
 		 * want to minimize the wait time for qhold by using the
 		 * minimum update time if a checkpoint is active.
+		 *
+		 * Nothing to look for until the earliest alarm is due, see
+		 * job_alarm_set(); the walk below sets up the next one.
 		 */
-		for (pjob = (job *)GET_NEXT(svr_alljobs);
-			pjob;
-			pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
+		if ((job_next_alarm != 0) && (job_next_alarm <= time_now))
+			pjob = (job *)GET_NEXT(svr_alljobs);
+		else
+			pjob = NULL;
+		if (pjob != NULL)
+			job_next_alarm = 0;
+		for (; pjob; pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
 			if ((pjob->ji_momsubt != 0) &&
 				(pjob->ji_actalarm != 0) &&
 				(pjob->ji_actalarm < time_now)) {
@@ -9996,8 +10640,14 @@ main(int argc, char *argv[])
 				pjob->ji_joinalarm = 0;
 			}
 
-			if (pjob->ji_flags & MOM_CHKPT_ACTIVE)
+			if (pjob->ji_actalarm != 0 && pjob->ji_momsubt != 0)
+				job_alarm_set(pjob->ji_actalarm);
+			if (pjob->ji_joinalarm != 0)
+				job_alarm_set(pjob->ji_joinalarm);
+			if (pjob->ji_flags & MOM_CHKPT_ACTIVE) {
 				next_sample_time = min_check_poll;
+				job_alarm_set(time_now);
+			}
 		}
 
 		/*
@@ -10047,6 +10697,17 @@ main(int argc, char *argv[])
 		}
 #endif	/* polling stopped check */
 
+		/* no job is due for a usage sample yet */
+		for (; pjob != NULL; pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
+			if ((pjob->ji_qs.ji_substate != JOB_SUBSTATE_RUNNING) ||
+				job_poll_due(pjob))
+				break;
+		}
+		if (pjob == NULL) {
+			time_resc_updated = time_now;
+			continue;
+		}
+
 		/* there are jobs so update status	 */
 		/* if we just got a sample, don't bother */
 		if (time_now > time_last_sample) {
@@ -10099,8 +10760,18 @@ main(int argc, char *argv[])
 			if (pjob->ji_qs.ji_substate != JOB_SUBSTATE_RUNNING)
 				continue;
 
+			if (!job_poll_due(pjob)) {
+				if (pjob->ji_nextpoll - time_now < next_sample_time)
+					next_sample_time = pjob->ji_nextpoll - time_now;
+				continue;
+			}
+
 			/* update information for my tasks */
 			(void)mom_set_use(pjob);
+			pjob->ji_flags |= MOM_POLL_SAMPLED;
+			set_job_nextpoll(pjob);
+			if (pjob->ji_nextpoll - time_now < next_sample_time)
+				next_sample_time = pjob->ji_nextpoll - time_now;
 
 			/* see if need to check point any job */
 			if (pjob->ji_chkpttype == PBS_CHECKPOINT_CPUT) {
@@ -10176,6 +10847,10 @@ main(int argc, char *argv[])
 #endif /* localmod 153 */
 				if (pjob->ji_qs.ji_substate != JOB_SUBSTATE_RUNNING)
 					continue;
+				/* limits are only checked against a new sample */
+				if ((pjob->ji_flags & MOM_POLL_SAMPLED) == 0)
+					continue;
+				pjob->ji_flags &= ~MOM_POLL_SAMPLED;
 				/*
 				 ** Send message to get info from other MOM's
 				 ** if I am Mother Superior for the job and
@@ -11008,6 +11683,168 @@ check_busy(double mla)
 	}
 }
 
+#if !defined(WIN32) && !defined(NAS) /* localmod 113 */
+/**
+ * @brief
+ *	Fold the contents of a file into a topology fingerprint.
+ *
+ * @param[in]	hash - fingerprint so far
+ * @param[in]	path - file to read; a missing file adds nothing
+ *
+ * @return	u_long
+ * @retval	the new fingerprint
+ *
+ */
+static u_long
+fingerprint_file(u_long hash, char *path)
+{
+	int	fd;
+	ssize_t	i, n;
+	char	buf[4096];
+
+	if ((fd = open(path, O_RDONLY)) == -1)
+		return hash;
+	while ((n = read(fd, buf, sizeof(buf))) > 0) {
+		for (i = 0; i < n; i++)
+			hash = (hash ^ (unsigned char)buf[i]) * 16777619UL;
+	}
+	close(fd);
+	return hash;
+}
+
+/**
+ * @brief
+ *	Compute a cheap fingerprint of the hardware hwloc would report:
+ *	the hwloc version, the boot, the online CPUs and NUMA nodes, the
+ *	huge page pool and the PCI devices present.
+ *
+ * @return	u_long
+ * @retval	the fingerprint
+ *
+ */
+static u_long
+topology_fingerprint(void)
+{
+	u_long		hash = 2166136261UL;	/* FNV-1a */
+	char		buf[32];
+	char		*ch;
+	DIR		*dir;
+	struct dirent	*pde;
+
+	sprintf(buf, "%x", hwloc_get_api_version());
+	for (ch = buf; *ch; ch++)
+		hash = (hash ^ (unsigned char)*ch) * 16777619UL;
+	hash = fingerprint_file(hash, "/proc/sys/kernel/random/boot_id");
+	hash = fingerprint_file(hash, "/sys/devices/system/cpu/online");
+	hash = fingerprint_file(hash, "/sys/devices/system/node/online");
+	hash = fingerprint_file(hash, "/proc/sys/vm/nr_hugepages");
+	if ((dir = opendir("/sys/bus/pci/devices")) != NULL) {
+		while ((pde = readdir(dir)) != NULL) {
+			for (ch = pde->d_name; *ch; ch++)
+				hash = (hash ^ (unsigned char)*ch) * 16777619UL;
+			hash = (hash ^ ',') * 16777619UL;
+		}
+		closedir(dir);
+	}
+	return hash;
+}
+
+/**
+ * @brief
+ *	Read the topology cached in path_topology, if it was saved for
+ *	hardware with the given fingerprint.
+ *
+ * @param[in]	fingerprint - fingerprint of the current hardware
+ * @param[out]	len - length of the returned XML, with its ending NUL
+ *
+ * @return	char *
+ * @retval	malloc'ed XML topology
+ * @retval	NULL - no usable cached topology
+ *
+ */
+static char *
+topology_cache_read(u_long fingerprint, int *len)
+{
+	char		path[MAXPATHLEN+1];
+	FILE		*fp;
+	u_long		saved;
+	int		fd;
+	struct stat	sb;
+	char		*xml;
+
+	snprintf(path, sizeof(path), "%s.fingerprint", path_topology);
+	if ((fp = fopen(path, "r")) == NULL)
+		return NULL;
+	if ((fscanf(fp, "%lx", &saved) != 1) || (saved != fingerprint)) {
+		fclose(fp);
+		return NULL;
+	}
+	fclose(fp);
+
+	if ((fd = open(path_topology, O_RDONLY)) == -1)
+		return NULL;
+	if ((fstat(fd, &sb) == -1) || (sb.st_size == 0) ||
+		((xml = malloc(sb.st_size + 1)) == NULL)) {
+		close(fd);
+		return NULL;
+	}
+	if (read(fd, xml, sb.st_size) != sb.st_size) {
+		free(xml);
+		close(fd);
+		return NULL;
+	}
+	close(fd);
+	xml[sb.st_size] = '\0';
+	*len = sb.st_size + 1;
+	return xml;
+}
+
+/**
+ * @brief
+ *	Save the topology and the fingerprint of the hardware it describes
+ *	in path_topology, for the next start or HUP and for hooks.
+ *
+ * @param[in]	fingerprint - fingerprint of the current hardware
+ * @param[in]	xml - XML topology exported by hwloc
+ *
+ * @return	void
+ *
+ */
+static void
+topology_cache_write(u_long fingerprint, char *xml)
+{
+	char	path[MAXPATHLEN+1];
+	char	newpath[MAXPATHLEN+16];
+	FILE	*fp;
+	int	rc;
+
+	snprintf(newpath, sizeof(newpath), "%s.new", path_topology);
+	if ((fp = fopen(newpath, "w")) == NULL) {
+		log_err(errno, __func__, newpath);
+		return;
+	}
+	rc = fputs(xml, fp);
+	if ((fclose(fp) != 0) || (rc == EOF) ||
+		(rename(newpath, path_topology) == -1)) {
+		log_err(errno, __func__, path_topology);
+		(void)unlink(newpath);
+		return;
+	}
+
+	snprintf(path, sizeof(path), "%s.fingerprint", path_topology);
+	snprintf(newpath, sizeof(newpath), "%s.new", path);
+	if ((fp = fopen(newpath, "w")) == NULL) {
+		log_err(errno, __func__, newpath);
+		return;
+	}
+	rc = fprintf(fp, "%lx\n", fingerprint);
+	if ((fclose(fp) != 0) || (rc < 0) || (rename(newpath, path) == -1)) {
+		log_err(errno, __func__, path);
+		(void)unlink(newpath);
+	}
+}
+#endif	/* !WIN32 && !NAS */
+
 /**
  * @fn mom_topology
  * @brief
@@ -11029,6 +11866,10 @@ check_busy(double mla)
  *
  *		On Windows we use native Windows API's to discover the topology
  *
+ *		The hwloc topology is cached in path_topology together with a
+ *		fingerprint of the hardware, and only discovered again when
+ *		the fingerprint changes.
+ *
  * @see	dep_topology()
  *
  */
@@ -11046,8 +11887,16 @@ mom_topology(void)
 
 #ifndef	WIN32
 	hwloc_topology_t topology;
+	u_long fingerprint;
+	int cached = 0;
+
 	ret = 0;
-	if (hwloc_topology_init(&topology) == -1)
+	fingerprint = topology_fingerprint();
+	if ((xmlbuf = topology_cache_read(fingerprint, &xmllen)) != NULL) {
+		cached = 1;
+		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_NODE, LOG_DEBUG,
+			__func__, "using cached topology");
+	} else if (hwloc_topology_init(&topology) == -1)
 		ret = -1;
 	else if ((hwloc_topology_set_flags(topology,
 			HWLOC_TOPOLOGY_FLAG_WHOLE_SYSTEM | HWLOC_TOPOLOGY_FLAG_IO_DEVICES)
@@ -11056,7 +11905,8 @@ mom_topology(void)
 					== -1)) {
 		hwloc_topology_destroy(topology);
 		ret = -1;
-	}
+	} else
+		topology_cache_write(fingerprint, xmlbuf);
 	if (ret < 0) {
 		/* on any failure above, issue log message */
 		log_err(PBSE_SYSTEM, __func__, "topology init/load/export failed");
@@ -11176,8 +12026,12 @@ mom_topology(void)
 	}
 bad:
 #ifndef WIN32
-	hwloc_free_xmlbuffer(topology, xmlbuf);
-	hwloc_topology_destroy(topology);
+	if (cached)
+		free(xmlbuf);
+	else {
+		hwloc_free_xmlbuffer(topology, xmlbuf);
+		hwloc_topology_destroy(topology);
+	}
 #else
 	;
 #endif
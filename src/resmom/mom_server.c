@@ -132,6 +132,9 @@ extern	char	*path_hooks;
 extern	unsigned long	hooks_rescdef_checksum;
 extern	int	report_hook_checksums;
 
+static	int	server_delta_update = 0; /* server accepts IS_UPDATE_DELTA */
+static	vnl_t	*vnlp_sent = NULL;	/* vnode list as last sent to server */
+
 /*
  * Tree search generalized from Knuth (6.2.2) Algorithm T just like
  * the AT&T man page says.
@@ -280,6 +283,37 @@ free_vnodemap(void)
 	}
 }
 
+/**
+ * @brief
+ *	Read the option bits a Server appends to IS_HELLO and
+ *	IS_HELLO_NO_INVENTORY, and forget the vnode list last sent, as
+ *	the next update has to resend it in full.
+ *
+ * @param[in] stream - connection stream
+ *
+ * @return int
+ * @retval DIS_SUCCESS - bits read, or none sent by an older Server
+ * @retval other - DIS error
+ *
+ */
+static int
+read_hello_bits(int stream)
+{
+	int	bits;
+	int	ret;
+
+	bits = disrsi(stream, &ret);
+	if (ret == DIS_EOD) {	/* old server */
+		bits = 0;
+		ret = DIS_SUCCESS;
+	}
+	server_delta_update = (bits & HELLO_delta_update) ? 1 : 0;
+
+	vnl_free(vnlp_sent);
+	vnlp_sent = NULL;
+	return ret;
+}
+
 /**
  * @brief
  *	reply to server
@@ -817,6 +851,8 @@ is_request(int stream, int version)
 			 */
 			server_stream = stream;		/* save stream to server */
 			next_sample_time = min_check_poll;
+			if ((ret = read_hello_bits(stream)) != DIS_SUCCESS)
+				goto err;
 			reply_hello4(stream);
 			internal_state_update = UPDATE_MOM_STATE;
 			state_to_server(UPDATE_VNODES);
@@ -830,6 +866,8 @@ is_request(int stream, int version)
 				internal_state, stream))
 			server_stream = stream;         /* save stream to server */
 			next_sample_time = min_check_poll;
+			if ((ret = read_hello_bits(stream)) != DIS_SUCCESS)
+				goto err;
 			reply_hello4(stream);
 			internal_state_update = UPDATE_MOM_STATE;
 			state_to_server(UPDATE_MOM_ONLY);
@@ -1353,6 +1391,88 @@ hook_requests_to_server_err:
 	return (ret);
 }
 
+/**
+ * @brief
+ *	Make a copy of a vnode list, with the same modification time.
+ *
+ * @param[in]	vnl - vnode list to copy
+ *
+ * @return vnl_t *
+ * @retval the copy
+ * @retval NULL - out of memory
+ *
+ */
+static vnl_t *
+vnl_copy(vnl_t *vnl)
+{
+	vnl_t	*copy = NULL;
+
+	if (vnl_alloc(&copy) == NULL)
+		return NULL;
+	if (vn_merge(copy, vnl, NULL) == NULL) {
+		vnl_free(copy);
+		return NULL;
+	}
+	copy->vnl_modtime = vnl->vnl_modtime;
+	return copy;
+}
+
+/**
+ * @brief
+ *	Build the list of the vnode attributes whose values differ between
+ *	the vnode list last sent to the Server and the current one.
+ *
+ * @param[in]	old - vnode list last sent
+ * @param[in]	cur - current vnode list
+ *
+ * @return vnl_t *
+ * @retval the changed attributes, possibly none
+ * @retval NULL - the lists differ in their vnodes, attribute names or
+ *		  topology, or out of memory; a full update is needed
+ *
+ */
+static vnl_t *
+vnl_delta(vnl_t *old, vnl_t *cur)
+{
+	unsigned long	i, j;
+	vnl_t		*delta = NULL;
+
+	if (old->vnl_used != cur->vnl_used)
+		return NULL;
+	if (vnl_alloc(&delta) == NULL)
+		return NULL;
+	delta->vnl_modtime = cur->vnl_modtime;
+
+	for (i = 0; i < cur->vnl_used; i++) {
+		vnal_t	*curvn = VNL_NODENUM(cur, i);
+		vnal_t	*oldvn = vn_vnode(old, curvn->vnal_id);
+
+		if ((oldvn == NULL) || (oldvn->vnal_used != curvn->vnal_used))
+			goto full;
+		for (j = 0; j < curvn->vnal_used; j++) {
+			vna_t	*pa = VNAL_NODENUM(curvn, j);
+			char	*oldval = attr_exist(oldvn, pa->vna_name);
+
+			if (oldval == NULL)
+				goto full;
+			if (strcmp(oldval, pa->vna_val) == 0)
+				continue;
+			/* licensing is worked out again only on a full update */
+			if (strcasecmp(pa->vna_name, ATTR_NODE_TopologyInfo) == 0)
+				goto full;
+			if (vn_addvnr(delta, curvn->vnal_id, pa->vna_name,
+				pa->vna_val, pa->vna_type, pa->vna_flag,
+				NULL) == -1)
+				goto full;
+		}
+	}
+	return delta;
+
+full:
+	vnl_free(delta);
+	return NULL;
+}
+
 /**
  * @brief
  * 	state_to_server() - if UPDATE_MOM_STATE is set, send state update message to
@@ -1363,7 +1483,9 @@ hook_requests_to_server_err:
  *		UPDATE_MOM_ONLY - update only the info about the mom
  *
  *	If we have placement set information to send, we use IS_UPDATE2;
- *	otherwise, we fall back to IS_UPDATE.
+ *	otherwise, we fall back to IS_UPDATE.  Once the whole vnode list
+ *	has been sent, a Server that accepts it is sent IS_UPDATE_DELTA
+ *	with only the vnode attributes that changed since.
  *
  * @return Void
  *
@@ -1373,6 +1495,7 @@ state_to_server(int what_to_update)
 {
 	int			i, ret;
 	int			use_UPDATE2;
+	vnl_t			*delta = NULL;
 	extern const char *dis_emsg[];
 	extern vnl_t		*vnlp;				/* vnode list */
 	char			*pv;
@@ -1399,7 +1522,14 @@ state_to_server(int what_to_update)
 	else
 		use_UPDATE2 = 0;
 
-	if (use_UPDATE2)
+#if	!MOM_ALPS
+	if (use_UPDATE2 && server_delta_update && (vnlp_sent != NULL))
+		delta = vnl_delta(vnlp_sent, vnlp);
+#endif	/* MOM_ALPS */
+
+	if (delta != NULL)
+		ret = is_compose(server_stream, IS_UPDATE_DELTA);
+	else if (use_UPDATE2)
 		ret = is_compose(server_stream, IS_UPDATE2);
 	else
 		ret = is_compose(server_stream, IS_UPDATE);
@@ -1429,7 +1559,11 @@ state_to_server(int what_to_update)
 
 	if (ret != DIS_SUCCESS)
 		goto err;
-	if (use_UPDATE2) {
+	if (delta != NULL) {
+		ret = vn_encode_DIS(server_stream, delta);	/* changes */
+		if (ret != DIS_SUCCESS)
+			goto err;
+	} else if (use_UPDATE2) {
 #if	MOM_ALPS
 		/*
 		 * This is a workaround for a problem with the reporting of
@@ -1461,12 +1595,27 @@ state_to_server(int what_to_update)
 	if (ret != DIS_SUCCESS)
 		goto err;
 
+	ret = diswsi(server_stream, UPDATE_exec_job);	/* what we accept */
+	if (ret != DIS_SUCCESS)
+		goto err;
+
 	rpp_flush(server_stream);
 	internal_state_update = 0;
+
+	/* remember what the server now has, for the next delta */
+	if ((delta == NULL) || (delta->vnl_used > 0)) {
+		vnl_free(vnlp_sent);
+		vnlp_sent = use_UPDATE2 ? vnl_copy(vnlp) : NULL;
+	} else
+		vnlp_sent->vnl_modtime = vnlp->vnl_modtime;
+	vnl_free(delta);
 	return;
 
 err:
 	log_err(errno, "state_to_server", (char *)dis_emsg[ret]);
+	vnl_free(delta);
+	vnl_free(vnlp_sent);
+	vnlp_sent = NULL;
 	rpp_close(server_stream);
 	server_stream = -1;
 }
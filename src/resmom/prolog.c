@@ -477,7 +477,10 @@ int   pe_io_type;
 
 	run_exit = 0;
 	child = fork();
-	if (child > 0) {	/* parent */
+	if (child == -1) {
+		(void)close(fd_input);
+		return (pelog_err(pjob, pelog, -3, "cannot fork"));
+	} else if (child > 0) {	/* parent */
 		(void)close(fd_input);
 		sprintf(log_buffer, "running %s",
 			which == PE_PROLOGUE ? "prologue" : "epilogue");
@@ -489,7 +492,7 @@ int   pe_io_type;
 		act.sa_flags = 0;
 		sigaction(SIGALRM, &act, 0);
 		alarm(pe_alarm_time);
-		while (wait(&waitst) < 0) {
+		while (waitpid(child, &waitst, 0) < 0) {
 			if (errno != EINTR) {	/* continue loop on signal */
 				run_exit = -3;
 				break;
@@ -143,6 +143,7 @@ extern	int		update_job_launch_delay;
 extern	pbs_list_head	svr_allhooks;
 /* External Functions */
 extern int	is_direct_write(job *, enum job_file, char *, int *);
+extern int	stage_concurrency;
 
 /* Local Data Items */
 char rcperr[MAXPATHLEN] = {'\0'};	/* file to contain rcp error */
@@ -456,13 +457,16 @@ fork_to_user(struct batch_request *preq)
 #endif	/* WIN32 */
 
 
-#define RT_BLK_SZ 65536
+#define RT_BLK_SZ (1024 * 1024)
 /**
  * @brief
  * 	Called when a job is rerun (qrerun) to copy the job's standard out/error
  * 	files back to the Server until job is rescheduled.  Function opens
  * 	the StdOut or StdErr file for the job, reading in blocks of it and
- * 	ships the blocks to the Server.
+ * 	ships the blocks to the Server.  Each block waits for the Server's
+ * 	reply, so blocks are large to keep the round trips for a big output
+ * 	file few.  The blocks go through DIS, which may be wrapped by the
+ * 	security layer, so the file cannot be spliced onto the socket.
  * 	If the file is shipped back to the Server successfully and it was in
  * 	PBS_HOME/spool, it is then deleted.
  *
@@ -480,7 +484,7 @@ static int
 return_file(job *pjob, enum job_file which, int sock)
 {
 	int		      amt;
-	char		      buf[RT_BLK_SZ];
+	char		     *buf;
 	int		      fds;
 	struct batch_request *prq;
 	int		      rc = 0;
@@ -518,6 +522,15 @@ return_file(job *pjob, enum job_file which, int sock)
 		close(fds);
 		return (-1);
 	}
+	if ((buf = malloc(RT_BLK_SZ)) == NULL) {
+		log_err(errno, __func__, "Out of memory");
+		free_br(prq);
+		close(fds);
+		return (-1);
+	}
+#ifdef POSIX_FADV_SEQUENTIAL
+	(void)posix_fadvise(fds, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
 
 	(void)strcpy(prq->rq_host, mom_host);
 	(void)strcpy(prq->rq_ind.rq_jobfile.rq_jobid, pjob->ji_qs.ji_jobid);
@@ -547,6 +560,7 @@ return_file(job *pjob, enum job_file which, int sock)
 		}
 
 	}
+	free(buf);
 	free_br(prq);
 	(void)close(fds);
 
@@ -1074,8 +1088,7 @@ req_modifyjob(struct batch_request *preq)
 			job_attr_def[i].at_free(pattr+i);
 			if ((newattr[i].at_type == ATR_TYPE_LIST) ||
 				(newattr[i].at_type == ATR_TYPE_RESC)) {
-				list_move(&newattr[i].at_val.at_list,
-					&(pattr+i)->at_val.at_list);
+				move_list_attr(&newattr[i], pattr+i);
 			} else {
 				*(pattr+i) = newattr[i];
 			}
@@ -1625,6 +1638,15 @@ do_susres(job *pjob, int which)
 
 #endif /* MOM_ALPS */
 
+#ifndef	WIN32
+	/*
+	 * Freeze the job cgroup first when the job is stopped anyway, so
+	 * nothing forks while the tasks are signaled from one sample.
+	 */
+	if ((which == SUSPEND) && (suspend_signal == SIGSTOP))
+		(void)cgroup_v2_freeze(pjob, 1);
+	kill_batch_begin();
+#endif	/* WIN32 */
 	for (ptask = (pbs_task *)GET_NEXT(pjob->ji_tasks);
 		ptask != NULL;
 		ptask = (pbs_task *)GET_NEXT(ptask->ti_jobtask)) {
@@ -1636,6 +1658,12 @@ do_susres(job *pjob, int which)
 			(which == SUSPEND) ? "suspend" : "resume",
 			ptask->ti_qs.ti_task, rc))
 	}
+#ifndef	WIN32
+	kill_batch_end();
+	/* thaw only once the resume signal is pending in every task */
+	if (which == RESUME)
+		(void)cgroup_v2_freeze(pjob, 0);
+#endif	/* WIN32 */
 #if	MOM_CPUSET
 	if (rc >= 0 && which == SUSPEND)	/* suspend -- get rid of cpuset */
 		rc = suspend_job(pjob);
@@ -1643,6 +1671,9 @@ do_susres(job *pjob, int which)
 	if (rc < 0) {
 		/* error recovery, set things back */
 		err = errno;
+#ifndef	WIN32
+		kill_batch_begin();
+#endif	/* WIN32 */
 		for (ptask = (pbs_task *)GET_NEXT(pjob->ji_tasks);
 			ptask != NULL;
 			ptask = (pbs_task *)GET_NEXT(ptask->ti_jobtask)) {
@@ -1651,6 +1682,11 @@ do_susres(job *pjob, int which)
 			else
 				kill_task(ptask, suspend_signal, 1);
 		}
+#ifndef	WIN32
+		kill_batch_end();
+		if (which == SUSPEND)
+			(void)cgroup_v2_freeze(pjob, 0);
+#endif	/* WIN32 */
 		errno = err;
 		return PBSE_SYSTEM;
 	}
@@ -1906,6 +1942,7 @@ terminate_job(job *pjob, int internal)
 			pjob->ji_qs.ji_svrflags |= JOB_SVFLG_TERMJOB;
 			/* poll ASAP in case job ignores SIGTERM */
 			next_sample_time = min_check_poll;
+			pjob->ji_nextpoll = 0;
 		}
 		if (kill_job(pjob, s) == 0) {
 			/* no processes around, force into exiting */
@@ -3157,6 +3194,361 @@ post_cpyfile(job *pjob, int ev)
 	}
 }
 
+/**
+ * @brief
+ *	stage_pairs - copy the file pairs of a copy files request, or the
+ *	subset of them which falls in one copy worker's slot.
+ *
+ * @par
+ *	Pair number i is handled when (i % nslots) == slot, so a single
+ *	caller passing nslots 1 and slot 0 handles every pair in order.
+ *	As before, a stage-in failure ends the loop.
+ *
+ * @param[in]		preq - pointer to the copy files batch request
+ * @param[in]		rqcpf - the copy files part of the request
+ * @param[in]		dir - STAGE_DIR_IN or STAGE_DIR_OUT
+ * @param[in,out]	stage_inout - per copier staging state
+ * @param[in]		nslots - number of copy workers sharing the pairs
+ * @param[in]		slot - this worker's slot, 0 .. nslots - 1
+ * @param[out]		failed - set to 1 if stage_file returned an error
+ *
+ * @return	int
+ * @retval	number of file pairs attempted
+ *
+ */
+static int
+stage_pairs(struct batch_request *preq, struct rq_cpyfile *rqcpf, int dir,
+	cpy_files *stage_inout, int nslots, int slot, int *failed)
+{
+	struct rqfpair	*pair;
+	char		*prmt;
+	int		rmtflag;
+	int		i = 0;
+	int		num_copies = 0;
+
+	*failed = 0;
+	for (pair=(struct rqfpair *)GET_NEXT(rqcpf->rq_pair);
+		pair != 0;
+		pair = (struct rqfpair *)GET_NEXT(pair->fp_link), i++) {
+		if ((i % nslots) != slot)
+			continue;
+		DBPRT(("%s: local %s remote %s\n", __func__, pair->fp_local, pair->fp_rmt))
+
+		stage_inout->from_spool = 0;
+		prmt = pair->fp_rmt;
+		num_copies++;
+
+		if (local_or_remote(&prmt) == 0) {
+			/* destination host is this host, use cp */
+			rmtflag = 0;
+		} else {
+			/* destination host is another, use (pbs_)rcp */
+			rmtflag = 1;
+		}
+
+		/*
+		 ** Here we break out of the the loop on error.
+		 ** This will only happen on a stagein failure.
+		 */
+		if (stage_file(dir, rmtflag, rqcpf->rq_owner,
+			pair, preq->rq_conn, stage_inout, prmt) != 0) {
+			*failed = 1;
+			break;
+		}
+	}
+	return num_copies;
+}
+
+/*
+ * What a copy worker started by stage_pairs_parallel() writes back to the
+ * staging child, followed by sr_listlen bytes of bad file messages and
+ * sr_fileslen bytes of null terminated names of the files it staged in.
+ */
+struct stage_result {
+	int	sr_copies;
+	int	sr_failed;
+	int	sr_bad_files;
+	int	sr_stageout_failed;
+	int	sr_listlen;
+	int	sr_fileslen;
+};
+
+/**
+ * @brief
+ *	stage_readall - read exactly len bytes from a copy worker's pipe.
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	error or early end of file
+ *
+ */
+static int
+stage_readall(int fd, void *buf, size_t len)
+{
+	char	*p = buf;
+	ssize_t	n;
+
+	while (len > 0) {
+		n = read(fd, p, len);
+		if (n == -1 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return -1;
+		p += n;
+		len -= n;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	stage_writeall - write len bytes to the staging child's pipe.
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	error
+ *
+ */
+static int
+stage_writeall(int fd, void *buf, size_t len)
+{
+	char	*p = buf;
+	ssize_t	n;
+
+	while (len > 0) {
+		n = write(fd, p, len);
+		if (n == -1 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return -1;
+		p += n;
+		len -= n;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	stage_worker_report - send a copy worker's outcome up its pipe.
+ *
+ * @param[in]	fd - write end of the worker's pipe
+ * @param[in]	copies - number of pairs the worker attempted
+ * @param[in]	failed - whether the worker hit a stage-in failure
+ * @param[in]	stage_inout - the worker's staging state
+ *
+ * @return	void
+ *
+ */
+static void
+stage_worker_report(int fd, int copies, int failed, cpy_files *stage_inout)
+{
+	struct stage_result	res;
+	int			i;
+
+	res.sr_copies = copies;
+	res.sr_failed = failed;
+	res.sr_bad_files = stage_inout->bad_files;
+	res.sr_stageout_failed = stage_inout->stageout_failed;
+	res.sr_listlen = stage_inout->bad_list ? strlen(stage_inout->bad_list) : 0;
+	res.sr_fileslen = 0;
+	/* a failed worker has already removed the files it staged in */
+	if (!failed) {
+		for (i = 0; i < stage_inout->file_num; i++)
+			res.sr_fileslen += strlen(stage_inout->file_list[i]) + 1;
+	}
+
+	if (stage_writeall(fd, &res, sizeof(res)) == -1)
+		return;
+	if (res.sr_listlen > 0 &&
+		stage_writeall(fd, stage_inout->bad_list, res.sr_listlen) == -1)
+		return;
+	if (res.sr_fileslen > 0) {
+		for (i = 0; i < stage_inout->file_num; i++) {
+			if (stage_writeall(fd, stage_inout->file_list[i],
+				strlen(stage_inout->file_list[i]) + 1) == -1)
+				return;
+		}
+	}
+}
+
+/**
+ * @brief
+ *	stage_pairs_parallel - copy the file pairs of a copy files request
+ *	using up to $stage_concurrency worker processes at once.
+ *
+ * @par
+ *	Each worker is forked from the staging child, so it already runs as
+ *	the user in the right directory, and handles every nworkers'th pair
+ *	with stage_pairs().  The outcome of each worker is merged into
+ *	stage_inout so that the reply and the exit status of the staging
+ *	child are the same as for a sequential copy.  When stage-in fails in
+ *	one worker, the files staged in by the others are removed, just as a
+ *	sequential stage-in removes everything it copied before the failure.
+ *	A slot whose worker cannot be started is copied by the caller itself.
+ *
+ * @param[in]		preq - pointer to the copy files batch request
+ * @param[in]		rqcpf - the copy files part of the request
+ * @param[in]		dir - STAGE_DIR_IN or STAGE_DIR_OUT
+ * @param[in,out]	stage_inout - staging state of the staging child
+ * @param[in]		nworkers - number of workers to use, at least 2
+ *
+ * @return	int
+ * @retval	number of file pairs attempted
+ *
+ */
+static int
+stage_pairs_parallel(struct batch_request *preq, struct rq_cpyfile *rqcpf,
+	int dir, cpy_files *stage_inout, int nworkers)
+{
+	pid_t			*pids;
+	int			*fds;
+	int			pfd[2];
+	int			slot;
+	int			failed;
+	int			any_failed = 0;
+	int			num_copies = 0;
+	int			i;
+	char			*buf;
+	char			*name;
+	char			**staged = NULL;
+	int			nstaged = 0;
+	struct stage_result	res;
+	cpy_files		mine;
+
+	pids = (pid_t *)calloc(nworkers, sizeof(pid_t));
+	fds = (int *)calloc(nworkers, sizeof(int));
+	if ((pids == NULL) || (fds == NULL)) {
+		free(pids);
+		free(fds);
+		num_copies = stage_pairs(preq, rqcpf, dir, stage_inout, 1, 0, &failed);
+		return num_copies;
+	}
+
+	for (slot = 0; slot < nworkers; slot++) {
+		pids[slot] = -1;
+		fds[slot] = -1;
+		if (pipe(pfd) == -1) {
+			log_err(errno, __func__, "pipe");
+			continue;
+		}
+		pids[slot] = fork();
+		if (pids[slot] == 0) {
+			/* copy worker */
+			for (i = 0; i < slot; i++) {
+				if (fds[i] != -1)
+					close(fds[i]);
+			}
+			close(pfd[0]);
+			mine = *stage_inout;
+			mine.stageout_failed = FALSE;
+			mine.bad_files = 0;
+			mine.file_num = 0;
+			mine.file_max = 0;
+			mine.file_list = NULL;
+			mine.bad_list = NULL;
+			num_copies = stage_pairs(preq, rqcpf, dir, &mine,
+				nworkers, slot, &failed);
+			stage_worker_report(pfd[1], num_copies, failed, &mine);
+			exit(0);
+		}
+		close(pfd[1]);
+		if (pids[slot] == -1) {
+			log_err(errno, __func__, "fork");
+			close(pfd[0]);
+			continue;
+		}
+		fds[slot] = pfd[0];
+	}
+
+	/* copy the slots no worker could be started for */
+	for (slot = 0; slot < nworkers; slot++) {
+		if (pids[slot] != -1)
+			continue;
+		num_copies += stage_pairs(preq, rqcpf, dir, stage_inout,
+			nworkers, slot, &failed);
+		if (failed)
+			any_failed = 1;
+	}
+
+	for (slot = 0; slot < nworkers; slot++) {
+		if (pids[slot] == -1)
+			continue;
+		if (stage_readall(fds[slot], &res, sizeof(res)) == -1) {
+			sprintf(log_buffer, "copy worker %d exited without reporting",
+				(int)pids[slot]);
+			log_err(-1, __func__, log_buffer);
+			add_bad_list(&(stage_inout->bad_list), log_buffer, 2);
+			stage_inout->bad_files = 1;
+			stage_inout->stageout_failed = TRUE;
+			any_failed = 1;
+		} else {
+			num_copies += res.sr_copies;
+			if (res.sr_failed)
+				any_failed = 1;
+			if (res.sr_bad_files)
+				stage_inout->bad_files = 1;
+			if (res.sr_stageout_failed)
+				stage_inout->stageout_failed = TRUE;
+			if (res.sr_listlen > 0 &&
+				(buf = malloc(res.sr_listlen + 1)) != NULL) {
+				if (stage_readall(fds[slot], buf, res.sr_listlen) == 0) {
+					buf[res.sr_listlen] = '\0';
+					add_bad_list(&(stage_inout->bad_list), buf, 0);
+				}
+				free(buf);
+			}
+			if (res.sr_fileslen > 0 &&
+				(buf = malloc(res.sr_fileslen)) != NULL) {
+				if (stage_readall(fds[slot], buf, res.sr_fileslen) == 0) {
+					for (name = buf; name < buf + res.sr_fileslen;
+						name += strlen(name) + 1) {
+						char **tmp;
+
+						tmp = realloc(staged, (nstaged + 1) * sizeof(char *));
+						if (tmp == NULL)
+							break;
+						staged = tmp;
+						if ((staged[nstaged] = strdup(name)) != NULL)
+							nstaged++;
+					}
+				}
+				free(buf);
+			}
+		}
+		close(fds[slot]);
+		while ((waitpid(pids[slot], NULL, 0) == -1) && (errno == EINTR))
+			;
+	}
+
+	/* a stage-in failure removes everything staged in by the others */
+	if (any_failed && (dir == STAGE_DIR_IN)) {
+		for (i = 0; i < stage_inout->file_num; i++) {
+			if (remtree(stage_inout->file_list[i]) != 0 && errno != ENOENT) {
+				char	temp[80 + MAXPATHLEN];
+
+				sprintf(temp, msg_err_unlink, "stage in", stage_inout->file_list[i]);
+				log_err(errno, "req_cpyfile", temp);
+				add_bad_list(&(stage_inout->bad_list), temp, 2);
+			}
+		}
+		for (i = 0; i < nstaged; i++) {
+			if (remtree(staged[i]) != 0 && errno != ENOENT) {
+				char	temp[80 + MAXPATHLEN];
+
+				sprintf(temp, msg_err_unlink, "stage in", staged[i]);
+				log_err(errno, "req_cpyfile", temp);
+				add_bad_list(&(stage_inout->bad_list), temp, 2);
+			}
+		}
+	}
+	for (i = 0; i < nstaged; i++)
+		free(staged[i]);
+	free(staged);
+	free(pids);
+	free(fds);
+	return num_copies;
+}
+
 /**
  * @brief
  * 	req_cpyfile - process the Copy Files request from the server to dispose
@@ -3190,9 +3582,9 @@ req_cpyfile(struct batch_request *preq)
 	int			rc;
 	pid_t			pid;
 	struct rqfpair		*pair;
-	int			rmtflag;
+	int			npairs = 0;
+	int			failed;
 	cpy_files	stage_inout;
-	char			*prmt;
 	char                    dup_rqcpf_jobid[PBS_MAXSVRJOBID+1];
 	struct work_task *wtask = NULL;
 	DBPRT(("%s: entered\n", __func__))
@@ -3342,30 +3734,14 @@ req_cpyfile(struct batch_request *preq)
 	copy_start = time(0);
 	for (pair=(struct rqfpair *)GET_NEXT(rqcpf->rq_pair);
 		pair != 0;
-		pair = (struct rqfpair *)GET_NEXT(pair->fp_link)) {
-		DBPRT(("%s: local %s remote %s\n", __func__, pair->fp_local, pair->fp_rmt))
-
-		stage_inout.from_spool = 0;
-		prmt = pair->fp_rmt;
-		num_copies++;
-
-		if (local_or_remote(&prmt) == 0) {
-			/* destination host is this host, use cp */
-			rmtflag = 0;
-		} else {
-			/* destination host is another, use (pbs_)rcp */
-			rmtflag = 1;
-		}
-
-		rc = stage_file(dir, rmtflag, rqcpf->rq_owner,
-			pair, preq->rq_conn, &stage_inout, prmt);
-		/*
-		 ** Here we break out of the the loop on error.
-		 ** This will only happen on a stagein failure.
-		 */
-		if (rc != 0)
-			break;
-	}
+		pair = (struct rqfpair *)GET_NEXT(pair->fp_link))
+		npairs++;
+	if ((stage_concurrency > 1) && (npairs > 1))
+		num_copies = stage_pairs_parallel(preq, rqcpf, dir, &stage_inout,
+			(npairs < stage_concurrency) ? npairs : stage_concurrency);
+	else
+		num_copies = stage_pairs(preq, rqcpf, dir, &stage_inout,
+			1, 0, &failed);
 	copy_stop = time(0);
 
 	/* If there was a stage in failure, remove the job directory.
@@ -4065,6 +4441,7 @@ local_checkpoint(job *pjob,
 		pjob->ji_preq = preq;
 		if (abort) {
 			pjob->ji_flags |= MOM_CHKPT_ACTIVE;
+			job_alarm_set(time_now);
 			pjob->ji_qs.ji_un.ji_momt.ji_exitstat = JOB_EXEC_CHKP;
 		}
 
@@ -4091,6 +4468,7 @@ local_checkpoint(job *pjob,
 	 */
 	if (abort) {
 		pjob->ji_flags |= MOM_CHKPT_ACTIVE;
+		job_alarm_set(time_now);
 		pjob->ji_qs.ji_un.ji_momt.ji_exitstat = JOB_EXEC_CHKP;
 	}
 	(void)job_save(pjob, SAVEJOB_QUICK);
@@ -4721,6 +5099,27 @@ update_vnodes_on_resourcedef_change(char **deleted_resources)
 	}
 }
 
+/**
+ * @brief
+ *	Remove the bytecode pbs_python keeps for a hook script, so it never
+ *	outlives the script it was compiled from.
+ *
+ * @param[in]	script - path of the hook script
+ */
+static void
+unlink_hook_bytecode(char *script)
+{
+	char	bc_name[MAXPATHLEN+1];
+	size_t	len = strlen(script);
+	size_t	slen = strlen(HOOK_SCRIPT_SUFFIX);
+
+	if ((len <= slen) || (strcmp(script + len - slen, HOOK_SCRIPT_SUFFIX) != 0))
+		return;
+	snprintf(bc_name, sizeof(bc_name), "%.*s%s", (int)(len - slen),
+		script, HOOK_BYTECODE_SUFFIX);
+	(void)unlink(bc_name);
+}
+
 /**
  * @brief
  *	Receive a hook-related file.
@@ -4811,6 +5210,8 @@ req_copy_hookfile(struct batch_request *preq) /* ptr to the decoded request   */
 
 	if (preq->rq_ind.rq_hookfile.rq_sequence == 0) { /* 1st chunk of data */
 		oflag = O_TRUNC|O_RDWR|O_CREAT|O_Sync;
+		if (is_hook_script_file)
+			unlink_hook_bytecode(namebuf);
 	} else {
 		oflag = O_RDWR|O_APPEND|O_CREAT|O_Sync;
 	}
@@ -5029,7 +5430,8 @@ req_del_hookfile(struct batch_request *preq) /* ptr to the decoded request   */
 			preq->rq_ind.rq_hookfile.rq_filename);
 		strcat(p, HOOK_FILE_SUFFIX);
 		if ((phook = find_hook(hook_name)) != NULL) {
-			delete_task_by_parm1(phook, DELETE_ONE);
+			/* a running periodic hook also has a watchdog task */
+			delete_task_by_parm1(phook, DELETE_ALL);
 			log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_HOOK,
 				LOG_INFO, phook->hook_name,
 				"deleted any hook task entry");
@@ -5054,6 +5456,7 @@ req_del_hookfile(struct batch_request *preq) /* ptr to the decoded request   */
 	snprintf(namebuf, sizeof(namebuf), "%s%s", path_hooks,
 		preq->rq_ind.rq_hookfile.rq_filename);
 
+	unlink_hook_bytecode(namebuf);
 	if (unlink(namebuf) < 0) {
 		if (errno != ENOENT) {
 			sprintf(log_buffer,
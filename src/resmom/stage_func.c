@@ -1138,8 +1138,6 @@ rmjobdir(char *jobid, char *jobdir, uid_t uid, gid_t gid)
 	char	sep = '\\';
 #else
 	pid_t	pid = -1;
-	char	*rm = "/bin/rm";
-	char	*rf = "-rf";
 	char	sep = '/';
 #endif
 
@@ -1228,22 +1226,12 @@ rmjobdir(char *jobid, char *jobdir, uid_t uid, gid_t gid)
 		newdir = jobdir;
 	}
 
-	/* fork and exec the cleantmp process */
-	pid = fork();
-	if (pid != 0) {	/* parent or error */
-		int err = errno;
-		if (pbs_jobdir_root[0] == '\0')
-			revert_from_user();
-
-		if (pid < 0)
-			log_err(err, __func__, "fork");
-		return;
-	}
-
-	rpp_terminate();
-	execl(rm, "pbs_cleandir", rf, newdir, NULL);
-	log_err(errno, __func__, "execl");
-	exit(21);
+	/* start the cleantmp process */
+	pid = spawn_cleandir(newdir);
+	if (pid == -1)
+		log_err(errno, __func__, "spawn_cleandir");
+	if (pbs_jobdir_root[0] == '\0')
+		revert_from_user();
 #endif
 }
 
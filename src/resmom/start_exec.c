@@ -59,6 +59,9 @@
 #include <sys/socket.h>
 #include <sys/wait.h>
 #include <netinet/in.h>
+#ifdef HAVE_POSIX_SPAWN
+#include <spawn.h>
+#endif
 #include <fcntl.h>
 
 #if defined(__osf__)
@@ -101,6 +104,7 @@
 
 #define	PIPE_READ_TIMEOUT	5
 #define EXTRA_ENV_PTRS	       32
+#define ENV_HASH_MIN	       32	/* table size before find_env_slot() hashes */
 
 /* Global Variables */
 
@@ -178,6 +182,8 @@ char *variables_else[] = {	/* variables to add, value computed */
 static	int num_var_else = sizeof(variables_else) / sizeof(char *);
 static	void catchinter(int);
 static int find_env_slot(struct var_table *, char *);
+static int env_hash_build(struct var_table *);
+static void env_hash_add(struct var_table *, int);
 
 extern int is_direct_write(job *, enum job_file, char *, int *);
 static int direct_write_possible = 1;
@@ -1043,6 +1049,72 @@ mkjobdir(char *jobid, char *jobdir, uid_t uid, gid_t gid)
 	return 0;
 }
 
+/**
+ * @brief
+ *	spawn_cleandir - start the "pbs_cleandir" process which removes a
+ *	job directory in the background.
+ *
+ * @par
+ *	The child does nothing but exec rm, so where posix_spawn() is
+ *	available it is used rather than fork().  That avoids copying the
+ *	page tables of a MoM with a large heap for each finished job.  The
+ *	rpp/TPP descriptors are close-on-exec, so the child needs none of
+ *	the clean up fork_me() does.
+ *
+ * @param[in] dir - the directory to remove
+ *
+ * @return	pid_t
+ * @retval	pid of the child	success
+ * @retval	-1			failure, errno set
+ *
+ */
+
+pid_t
+spawn_cleandir(char *dir)
+{
+	char	*rm = "/bin/rm";
+	pid_t	pid;
+#ifdef HAVE_POSIX_SPAWN
+	extern char	**environ;
+	char		*argv[4];
+	sigset_t	mask;
+	posix_spawnattr_t attr;
+	int		rc;
+
+	argv[0] = "pbs_cleandir";
+	argv[1] = "-rf";
+	argv[2] = dir;
+	argv[3] = NULL;
+
+	if ((rc = posix_spawnattr_init(&attr)) != 0) {
+		errno = rc;
+		return -1;
+	}
+	sigemptyset(&mask);
+	(void)posix_spawnattr_setsigmask(&attr, &mask);
+	sigfillset(&mask);
+	(void)posix_spawnattr_setsigdefault(&attr, &mask);
+	(void)posix_spawnattr_setflags(&attr,
+		POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+	rc = posix_spawn(&pid, rm, NULL, &attr, argv, environ);
+	(void)posix_spawnattr_destroy(&attr);
+	if (rc != 0) {
+		errno = rc;
+		return -1;
+	}
+#else
+	pid = fork();
+	if (pid != 0)		/* parent or error */
+		return pid;
+
+	rpp_terminate();
+	execl(rm, "pbs_cleandir", "-rf", dir, NULL);
+	log_err(errno, __func__, "execl");
+	exit(21);
+#endif
+	return pid;
+}
+
 /**
  * @brief
  * 	rmtmpdir - remove the temporary directory
@@ -1060,9 +1132,6 @@ rmtmpdir(char *jobid)
 {
 	static	char	rmdir[MAXPATHLEN+1];
 	struct	stat	sb;
-	pid_t	pid;
-	char	*rm = "/bin/rm";
-	char	*rf = "-rf";
 	char	*tmpdir;
 	char	*newdir = rmdir;
 
@@ -1086,20 +1155,9 @@ rmtmpdir(char *jobid)
 		newdir = tmpdir;
 	}
 
-	/* fork and exec the cleantmp process */
-	pid = fork();
-	if (pid < 0) {
-		log_err(errno, __func__, "fork");
-		return;
-	}
-
-	if (pid > 0)		/* parent */
-		return;
-
-	rpp_terminate();
-	execl(rm, "pbs_cleandir", rf, newdir, NULL);
-	log_err(errno, __func__, "execl");
-	exit(21);
+	/* start the cleantmp process */
+	if (spawn_cleandir(newdir) == -1)
+		log_err(errno, __func__, "spawn_cleandir");
 }
 
 /**
@@ -1809,6 +1867,7 @@ record_finish_exec(int sd)
 
 	ptask->ti_qs.ti_sid = sjr.sj_session;
 	ptask->ti_qs.ti_status = TI_STATE_RUNNING;
+	task_pidfd_watch(ptask);
 #ifdef	_SX
 	ptask->ti_qs.ti_u.ti_ext.ti_parent = sjr.sj_parent;
 	ptask->ti_qs.ti_u.ti_ext.ti_jid = sjr.sj_jid;
@@ -4836,6 +4895,7 @@ start_process(task *ptask, char **argv, char **envp, bool nodemux)
 
 		ptask->ti_qs.ti_sid = sjr.sj_session;
 		ptask->ti_qs.ti_status = TI_STATE_RUNNING;
+		task_pidfd_watch(ptask);
 #ifdef	_SX
 		ptask->ti_qs.ti_u.ti_ext.ti_parent = sjr.sj_parent;
 		ptask->ti_qs.ti_u.ti_ext.ti_jid = sjr.sj_jid;
@@ -5344,6 +5404,12 @@ nodes_free(job *pj)
 		free(pj->ji_hosts);
 		pj->ji_hosts = NULL;
 	}
+	if (pj->ji_strmhint) {
+		free(pj->ji_strmhint);
+		pj->ji_strmhint = NULL;
+		pj->ji_strmhintsz = 0;
+	}
+	pj->ji_evscan = 0;
 }
 
 /**
@@ -5549,6 +5615,7 @@ job_nodes_inner(struct job *pjob, hnodent **mynp)
 
 	DBPRT(("- allocating %d hosts and %d procs\n", nmoms, nprocs))
 	pjob->ji_hosts = (hnodent *)calloc(nmoms+1, sizeof(hnodent));
+	pjob->ji_evscan = 0;
 	pjob->ji_vnods = (vmpiprocs *)calloc(nprocs+1, sizeof(vmpiprocs));
 
 	n_assn_vnodes = 0;
@@ -6310,6 +6377,7 @@ start_exec(job *pjob)
 			if (pjob->ji_qs.ji_substate != JOB_SUBSTATE_WAITING_JOIN_JOB) {
 				pjob->ji_qs.ji_substate = JOB_SUBSTATE_WAITING_JOIN_JOB;
 				pjob->ji_joinalarm = time_now + joinjob_alarm_time;
+				job_alarm_set(pjob->ji_joinalarm);
 				sprintf(log_buffer, "job waiting up to %ld secs ($sister_join_job_alarm) for all sister moms to join", joinjob_alarm_time);
 				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_INFO, pjob->ji_qs.ji_jobid, log_buffer);
 				log_buffer[0] = '\0';
@@ -6839,10 +6907,141 @@ open_std_file(job *pjob, enum job_file which, int mode, gid_t exgid)
 	return (fds);
 }
 
+/**
+ * @brief
+ * 	env_name_hash - hash the name part of a "name=value" string
+ *
+ * @param[in] pstr - environment variable
+ * @param[in] len - length of the name, including the '='
+ *
+ * @return	unsigned int
+ * @retval	FNV-1a hash of the name
+ *
+ */
+static unsigned int
+env_name_hash(char *pstr, int len)
+{
+	unsigned int	hash = 2166136261U;
+	int		i;
+
+	for (i = 0; i < len; i++)
+		hash = (hash ^ (unsigned char) pstr[i]) * 16777619U;
+	return hash;
+}
+
+/**
+ * @brief
+ * 	env_name_len - length of the name part of a "name=value" string
+ *	plus one for the '='
+ *
+ * @param[in] pstr - environment variable
+ *
+ * @return	int
+ *
+ */
+static int
+env_name_len(char *pstr)
+{
+	int	len = 1;	/* one extra for '=' */
+
+	while ((*pstr != '=') && (*pstr != '\0')) {
+		++pstr;
+		++len;
+	}
+	return len;
+}
+
+/**
+ * @brief
+ * 	env_hash_insert - put a table slot in the hash index at the bucket
+ *	of its variable name
+ *
+ * @param[in] ptbl - pointer to var_table which holds environment variable for job
+ * @param[in] slot - index of the variable in v_envp
+ *
+ * @return	void
+ *
+ */
+static void
+env_hash_insert(struct var_table *ptbl, int slot)
+{
+	char		*pstr = ptbl->v_envp[slot];
+	unsigned int	 mask = ptbl->v_hsize - 1;
+	unsigned int	 b;
+
+	b = env_name_hash(pstr, env_name_len(pstr)) & mask;
+	while (ptbl->v_hash[b] != 0)
+		b = (b + 1) & mask;
+	ptbl->v_hash[b] = slot + 1;
+	ptbl->v_hcount++;
+}
+
+/**
+ * @brief
+ * 	env_hash_build - (re)build the hash index of the variables in the
+ *	table so that find_env_slot() does not need to scan it.
+ *
+ * @par
+ *	Buckets are looked up by variable name and are only trusted after
+ *	comparing the name in v_envp, so buckets left over from when the table
+ *	was cleared or reallocated are harmless until the next rebuild.
+ *
+ * @param[in] ptbl - pointer to var_table which holds environment variable for job
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	out of memory, v_hash is left NULL
+ *
+ */
+static int
+env_hash_build(struct var_table *ptbl)
+{
+	int	size = 64;
+	int	i;
+
+	free(ptbl->v_hash);
+	ptbl->v_hash = NULL;
+	ptbl->v_hsize = 0;
+	ptbl->v_hcount = 0;
+
+	while (size < ptbl->v_used * 4)
+		size *= 2;
+	if ((ptbl->v_hash = (int *)calloc(size, sizeof(int))) == NULL)
+		return (-1);
+	ptbl->v_hsize = size;
+
+	for (i = 0; i < ptbl->v_used; ++i)
+		env_hash_insert(ptbl, i);
+	return (0);
+}
+
+/**
+ * @brief
+ * 	env_hash_add - add a newly appended table slot to the hash index,
+ *	growing the index when it becomes half full
+ *
+ * @param[in] ptbl - pointer to var_table which holds environment variable for job
+ * @param[in] slot - index of the new variable in v_envp
+ *
+ * @return	void
+ *
+ */
+static void
+env_hash_add(struct var_table *ptbl, int slot)
+{
+	if (ptbl->v_hash == NULL)
+		return;
+	if ((ptbl->v_hcount + 1) * 2 > ptbl->v_hsize)
+		(void)env_hash_build(ptbl);	/* includes the new slot */
+	else
+		env_hash_insert(ptbl, slot);
+}
+
 /**
  * @brief
  * 	find_env_slot - find if the environment variable is already in the table,
  *	If so, replace the existing one with the new one.
+ *	Small tables are scanned, larger ones are looked up in the hash index.
  *
  * @param[in] ptbl - pointer to var_table which holds environment variable for job
  * @param[in] pstr - new environment variable
@@ -6856,13 +7055,27 @@ open_std_file(job *pjob, enum job_file which, int mode, gid_t exgid)
 static int
 find_env_slot(struct var_table *ptbl, char *pstr)
 {
-	int	 i;
-	int	 len = 1;	/* one extra for '=' */
+	int	 	i;
+	int	 	len;
+	unsigned int	mask;
+	unsigned int	b;
 
 	if (pstr == NULL)
 		return (-1);
-	for (i=0; (*(pstr+i) != '=') && (*(pstr+i) != '\0'); ++i)
-		++len;
+	len = env_name_len(pstr);
+
+	if ((ptbl->v_used >= ENV_HASH_MIN) &&
+		((ptbl->v_hash != NULL) || (env_hash_build(ptbl) == 0))) {
+		mask = ptbl->v_hsize - 1;
+		for (b = env_name_hash(pstr, len) & mask; ptbl->v_hash[b] != 0;
+			b = (b + 1) & mask) {
+			i = ptbl->v_hash[b] - 1;
+			if ((i < ptbl->v_used) &&
+				(strncmp(ptbl->v_envp[i], pstr, len) == 0))
+				return (i);
+		}
+		return (-1);
+	}
 
 	for (i=0; i<ptbl->v_used; ++i) {
 		if (strncmp(ptbl->v_envp[i], pstr, len) == 0)
@@ -6942,6 +7155,7 @@ bld_env_variables(struct var_table *vtable, char *name, char *value)
 
 		*(vtable->v_envp + vtable->v_used++) = block;
 		*(vtable->v_envp + vtable->v_used) = NULL;
+		env_hash_add(vtable, vtable->v_used - 1);
 	} else {
 		/* free old value */
 		free(*(vtable->v_envp + i));
@@ -626,26 +626,18 @@ bucket_match(chunk_map **cmap, resource_resv *resresv, schd_error *err)
 	int i;
 	int j;
 	int k;
-	static pbs_bitmap *zeromap = NULL;
 	server_info *sinfo;
 	
 	if (cmap == NULL || resresv == NULL || resresv->select == NULL)
 		return 0;
 
-	if (zeromap == NULL) {
-		zeromap = pbs_bitmap_alloc(NULL, 1);
-		if (zeromap == NULL)
-			return 0;
-	}
-	
 	sinfo = resresv->server;
 
 	for (i = 0; cmap[i] != NULL; i++) {
 		if (cmap[i]->bkt_cnts != NULL) {
-			for (j = 0; cmap[i]->bkt_cnts[j] != NULL; j++) {
+			for (j = 0; cmap[i]->bkt_cnts[j] != NULL; j++)
 				set_working_bucket_to_truth(cmap[i]->bkt_cnts[j]->bkt);
-				pbs_bitmap_assign(cmap[i]->node_bits, zeromap);
-			}
+			pbs_bitmap_clear(cmap[i]->node_bits);
 		}
 	}
 
@@ -52,6 +52,7 @@
  *	shrink_job_algorithm()
  *	is_ok_to_run_STF()
  *	is_ok_to_run()
+ *	check_avail_consumables()
  *	check_avail_resources()
  *	dynamic_avail()
  *	find_counts_elm()
@@ -180,7 +181,8 @@ time_to_ded_boundary(status *policy, resource_resv *njob)
 
 	duration = njob->duration;
 	ded_time = find_next_dedtime(njob->server->server_time);
-	ded = is_ded_time(njob->server->server_time);
+	ded = (njob->server->server_time >= ded_time.from &&
+		njob->server->server_time < ded_time.to);
 	time_left = calc_time_left_STF(njob, &min_time_left);
 
 	if (!ded) {
@@ -381,60 +383,20 @@ shrink_to_minwt(status *policy, server_info *sinfo,
  *
  *	@brief
  *		Shrink upto a run event and see if it can run
- *		Try only upto SHRINK_MAX_RETRY=5 events.
- *		Initially retry_count=SHRINK_MAX_RETRY.
  *	@par Algorithm:
- *		In each iteration:
- *		1.	Calculate job's possible_shrunk_duration. This should be
- *			the duration between min_end_time and last tried event's event_time.
- *			If it is the first event to be tried, possible_shrunk_duration should be
- *			the duration between min_end_time and farthest_event's event_time.
- *		2.	Divide the possible_shrunk_duration into retry_count equal segments.
- *		3.	try shrinking to the last event of the last segment.
- *		4.	If job still can't run, traverse backwards and skip rest of the events in that segment.
- *			and try last event of the next segment.
- *		5.	reduce the retry_count by 1.
- *		Repeat these iterations until either retry_count==0 or job is ok to run.
- *
- *		So what this algorithm does, is:
- *		First try shrinking to the farthest event. If it fails, divide the
- *		possible_shrunk_duration(duration between min_end_time and this event's event_time)
- *		into 5 equal segments. Skip rest of the events in the 5th segment.
- *		Try last event of the 4th segment. If it fails, recalculate possible_shrunk_duration and divide it
- *		into 4 equal segments. Skip rest of the events in the 4th segment.
- *		Try last event of the 3rd segment. If it fails, recalculate possible_shrunk_duration and divide it
- *		into 3 equal segments. Skip rest of the events in the 3rd segment.
- *		Try last event of the 2nd segment. If it fails, recalculate possible_shrunk_duration and divide it
- *		into 2 equal segments. Skip rest of the events in the 2nd segment.
- *		Try last event of the 1st segment.
- *		Example:
- *		The farthest event within job's duration is 100 hours after min_end_time.
- *		Try shrinking to this event's start time i.e. 100 hours.
- *		Let's say shrinking fails, now divide 100 hours into 5 equal segments
- *		of 20 hours each. Skip rest of the events of the last(5th) segment, since
- *		we have tried one event in this segment already. We keep traversing
- *		and skipping events untill we found an event that falls in the
- *		4th segment e.g. within (100-20=80)hours.
- *		Try shrinking to this event's start time say it is: 56 hours.
- *		Let's say shrinking fails, divide 56 hours into 4 equal segments
- *		of 14 hours each. Skip rest of the events of the last(4th) segment, since
- *		we have tried one event in this segment already. We keep traversing
- *		and skipping events untill we found an event that falls in the
- *		3rd segment e.g. within (56-14=42)hours.
- *		Try shrinking to this event's start time say it is: 36 hours.
- *		Let's say shrinking fails, divide 36 hours into 3 equal segments
- *		of 12 hours each. Skip rest of the events of the last(3rd) segment, since
- *		we have tried one event in this segment already. We keep traversing
- *		and skipping events untill we found an event that falls in the
- *		2nd segment e.g. within (36-12=24)hours.
- *		Try shrinking to this event's start time say it is: 20 hours.
- *		Let's say shrinking fails, divide 20 hours into 2 equal segments
- *		of 10 hours each. Skip rest of the events of the last(2nd) segment, since
- *		we have tried one event in this segment already. We keep traversing
- *		and skipping events untill we found an event that falls in the
- *		1st segment e.g. within (20-10=10)hours.
- *		Try shrinking to this event's start time say it is: 6 hours.
- *		If job still can't run, indicate failure.
+ *		Collect the distinct start times of the run events that fall between
+ *		the job's minimum and maximum end times.  Each is a duration the job
+ *		can be shrunk to so it ends before that event starts.
+ *		1.	Try shrinking to the farthest event.  This is the common case
+ *			and needs a single eligibility check.
+ *		2.	If that fails, bisect the remaining events.  A shorter job
+ *			overlaps fewer events, so if the job can run when shrunk to an
+ *			event, it can run when shrunk to any earlier one.  On success
+ *			search the later half, on failure the earlier half.
+ *		So a job costs O(log events) calls to is_ok_to_run() instead of one
+ *		per event, and it is shrunk to the longest duration that will run.
+ *		The caller has already checked that the job can run for its minimum
+ *		duration.
  *
  *	@param[in]	policy	-	policy structure
  *	@param[in]	sinfo	-	server info
@@ -456,18 +418,18 @@ shrink_to_run_event(status *policy, server_info *sinfo,
 	queue_info *qinfo, resource_resv *njob, unsigned int flags, schd_error *err)
 {
 	time_t orig_duration = UNSPECIFIED;
-	time_t possible_shrink_duration = UNSPECIFIED;
-	nspec** ns_arr = NULL;
+	nspec **ns_arr = NULL;
+	nspec **ns_arr_try = NULL;
 	timed_event *te = NULL;
-	timed_event *initial_event = NULL;
-	timed_event *farthest_event = NULL;
-	timed_event *last_skipped_event = NULL;
-	time_t last_tried_event_time = 0;
+	timed_event *first_event = NULL;
+	time_t *event_times = NULL;
 	time_t end_time = 0;
 	time_t min_end_time = 0;
 	time_t servertime_now = 0;
-	unsigned int event_mask;
-	int retry_count = 0;
+	int num_events = 0;
+	int lo;
+	int hi;
+	int mid;
 
 	if (njob == NULL || policy == NULL || sinfo == NULL || err == NULL)
 		return NULL;
@@ -476,64 +438,67 @@ shrink_to_run_event(status *policy, server_info *sinfo,
 	servertime_now = sinfo->server_time;
 	end_time = servertime_now + njob->duration;
 	min_end_time = servertime_now + njob->min_duration;
-	/* Go till farthest event in the event list between job's min and max duration */
-	te = get_next_event(sinfo->calendar);
-	/* Get the front pointer of the event list. It may not always be NULL. */
-	if (te != NULL)
-		initial_event = te->prev;
-	event_mask = TIMED_RUN_EVENT;
-	for (te = find_init_timed_event(te, IGNORE_DISABLED_EVENTS, event_mask);
-		te != NULL && te->event_time < end_time;
-		te = find_next_timed_event(te, IGNORE_DISABLED_EVENTS, event_mask)) {
-		farthest_event = te;
+
+	/* Count the run events between job's min and max end times */
+	first_event = find_init_timed_event(get_next_event(sinfo->calendar),
+		IGNORE_DISABLED_EVENTS, TIMED_RUN_EVENT);
+	for (te = first_event; te != NULL && te->event_time < end_time;
+		te = find_next_timed_event(te, IGNORE_DISABLED_EVENTS, TIMED_RUN_EVENT)) {
+		if (te->event_time >= min_end_time)
+			num_events++;
 	}
+
 	clear_schd_error(err);
 	/* If no events between job's min and max duration, try running with complete duration */
-	if (farthest_event == NULL || farthest_event->event_time < min_end_time)
-		ns_arr = is_ok_to_run(policy, sinfo, qinfo, njob, flags, err);
-	else {
-		/* try shrinking upto the farthest event */
-		end_time = farthest_event->event_time;
-		retry_count = SHRINK_MAX_RETRY;
-		event_mask = TIMED_RUN_EVENT;
-		last_skipped_event = NULL;
-		/* Now, go backwards in the events list */
-		for (te = farthest_event; retry_count != 0;
-			te = find_prev_timed_event(te, IGNORE_DISABLED_EVENTS, event_mask)) {
-			if (te == NULL)
-			{
-				/* If we've reached the end of the list, we're done */
-				if (last_skipped_event == NULL)
-					break;
-				te = last_skipped_event;
-				last_skipped_event = NULL;
-				/* No need to try next segments after this event as there are no events left */
-				retry_count = 0;
-			/* If we have reached the front of event list or if the event is falling before min end time, break. */
-			} else if (te == initial_event || te->event_time < min_end_time)
-				break;
-			/* If no events in this segment, then try last skipped event of the previous segment
-			 * Skip events that fall in the previous segment or if the event time is already tried 
-			 */
-			else if (te->event_time > end_time || te->event_time == last_tried_event_time) {
-				last_skipped_event = te;
-				continue;
-			}
-			/* Shrink job to the start of this event */
-			njob->duration = te->event_time - servertime_now;
+	if (num_events == 0)
+		return is_ok_to_run(policy, sinfo, qinfo, njob, flags, err);
+
+	if ((event_times = malloc(num_events * sizeof(time_t))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	/* The calendar is in time order.  Events starting at the same time
+	 * shrink the job to the same duration, so only keep one of them.
+	 */
+	num_events = 0;
+	for (te = first_event; te != NULL && te->event_time < end_time;
+		te = find_next_timed_event(te, IGNORE_DISABLED_EVENTS, TIMED_RUN_EVENT)) {
+		if (te->event_time >= min_end_time &&
+			(num_events == 0 || event_times[num_events - 1] != te->event_time))
+			event_times[num_events++] = te->event_time;
+	}
+
+	/* try shrinking upto the farthest event */
+	hi = num_events - 1;
+	njob->duration = event_times[hi] - servertime_now;
+	ns_arr = is_ok_to_run(policy, sinfo, qinfo, njob, flags, err);
+
+	if (ns_arr == NULL) {
+		/* event_times[lo] is the latest event the job is known to fit
+		 * before (-1 for its min duration), and event_times[hi] the
+		 * earliest it is known not to.
+		 */
+		lo = -1;
+		while (hi - lo > 1) {
+			mid = lo + (hi - lo) / 2;
+			njob->duration = event_times[mid] - servertime_now;
+			clear_schd_error(err);
+			ns_arr_try = is_ok_to_run(policy, sinfo, qinfo, njob, flags, err);
+			if (ns_arr_try != NULL) {
+				free_nspecs(ns_arr);
+				ns_arr = ns_arr_try;
+				lo = mid;
+			} else
+				hi = mid;
+		}
+		if (ns_arr != NULL) {
+			njob->duration = event_times[lo] - servertime_now;
 			clear_schd_error(err);
-			ns_arr = is_ok_to_run(policy, sinfo, qinfo, njob, flags, err);
-			/* break if success */
-			if (ns_arr != NULL)
-				break;
-			last_skipped_event = NULL;/* This event does not get skipped */
-			last_tried_event_time = te->event_time;
-			/* Shrink end_time to the next segment */
-			possible_shrink_duration = njob->duration - njob->min_duration;
-			end_time = min_end_time + possible_shrink_duration * (retry_count - 1)/retry_count;
-			retry_count--;
 		}
 	}
+	free(event_times);
+
 	if (ns_arr && njob->duration == njob->min_duration)
 		log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_NOTICE, njob->name, 
 			"Considering shrinking job to it's minimum walltime");
@@ -1090,6 +1055,65 @@ is_ok_to_run(status *policy, server_info *sinfo,
 	return ns_arr;
 }
 
+/**
+ * @brief
+ *		check_avail_consumables - fast path of check_avail_resources() for
+ *		a request of only consumable resources, all of which are available.
+ *		Anything else (a non-consumable, an unset or indirect resource, or
+ *		not enough of a resource) is left to the full check, which also
+ *		builds the exact error.
+ *
+ * @param[in]	reslist	-	resources list
+ * @param[in]	reqlist	-	the list of resources requested
+ * @param[in]	flags	-	flags for check_avail_resources()
+ * @param[in]	checklist	-	array of resources to check or NULL for all
+ *
+ * @return	long long
+ * @retval	number of chunks which can be allocated
+ * @retval	-1	: the full check is needed
+ */
+static long long
+check_avail_consumables(schd_resource *reslist, resource_req *reqlist,
+	unsigned int flags, resdef **checklist)
+{
+	resource_req *resreq;
+	schd_resource *res;
+	sch_resource_t avail;
+	long long num_chunk = SCHD_INFINITY;
+	long long cur_chunk;
+
+	for (resreq = reqlist; resreq != NULL; resreq = resreq->next) {
+		if (!resreq->type.is_consumable)
+			return -1;
+		if (checklist != NULL && !resdef_exists_in_array(checklist, resreq->def))
+			continue;
+
+		res = find_resource(reslist, resreq->def);
+		if (res == NULL || res->orig_str_avail == NULL ||
+			res->indirect_res != NULL || !res->type.is_consumable)
+			return -1;
+
+		if (flags & COMPARE_TOTAL)
+			avail = res->avail;
+		else
+			avail = dynamic_avail(res);
+
+		if (avail == SCHD_INFINITY_RES && (flags & UNSET_RES_ZERO))
+			avail = 0;
+
+		if (avail == SCHD_INFINITY_RES || resreq->amount == 0)
+			continue;
+		if (avail < resreq->amount)
+			return -1;
+
+		cur_chunk = avail / resreq->amount;
+		if (cur_chunk < num_chunk || num_chunk == SCHD_INFINITY)
+			num_chunk = cur_chunk;
+	}
+
+	return num_chunk;
+}
+
 /**
  *
  * @brief
@@ -1138,9 +1162,9 @@ check_avail_resources(schd_resource *reslist, resource_req *reqlist,
 	schd_error *prev_err = NULL;
 	schd_error *err;
 	sch_resource_t avail;			/* amount of available resource */
-	schd_resource *fres = false_res();
-	schd_resource *zres = zero_res();
-	schd_resource *ustr = unset_str_res();
+	schd_resource *fres;
+	schd_resource *zres;
+	schd_resource *ustr;
 	char resbuf1[MAX_LOG_SIZE];
 	char resbuf2[MAX_LOG_SIZE];
 	char resbuf3[MAX_LOG_SIZE];
@@ -1157,6 +1181,17 @@ check_avail_resources(schd_resource *reslist, resource_req *reqlist,
 		return -1;
 	}
 
+	/* Most requests checked against a vnode are all consumables which fit */
+	if (!(flags & ONLY_COMP_NONCONS)) {
+		num_chunk = check_avail_consumables(reslist, reqlist, flags, checklist);
+		if (num_chunk != -1)
+			return num_chunk;
+		num_chunk = SCHD_INFINITY;
+	}
+
+	fres = false_res();
+	zres = zero_res();
+	ustr = unset_str_res();
 	if (fres == NULL || zres == NULL || ustr == NULL)
 		return -1;
 
@@ -1378,7 +1413,8 @@ check_ded_time_boundary(resource_resv *resresv)
 	if (ded_time.from == 0 && ded_time.to == 0)
 		return 0;
 
-	ded = is_ded_time(resresv->server->server_time);
+	ded = (resresv->server->server_time >= ded_time.from &&
+		resresv->server->server_time < ded_time.to);
 
 	if (!ded) {
 		if (dedtime_conflict(resresv)) /* has conflict or has no duration */
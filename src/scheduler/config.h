@@ -62,6 +62,13 @@
 #define USAGE_VERSION 2
 #define USAGE_NAME_MAX 50
 
+/* state kept between runs of the scheduler to speed up its first cycle */
+#define WARM_CACHE_FILE "sched_warm_cache"
+#define WARM_CACHE_MAGIC "PBS_WRM!"	/* needs to be 8 chars */
+#define WARM_CACHE_VERSION 1
+#define WARM_CACHE_MAX_STR (16 * 1024 * 1024)	/* sanity bound on string lengths */
+#define WARM_CACHE_MAX_ITEMS (16 * 1024 * 1024)	/* sanity bound on counts */
+
 #define UNKNOWN_GROUP_NAME "unknown"
 
 /* preempt priority values */
@@ -88,10 +95,50 @@
 /* estimate of how long a node will take to provision - used in simulation */
 #define PROVISION_DURATION 600
 
-/* Maximum number of events(reservations or top jobs)
- * around which shrinking of a STF job would be attemtpted,
+/* number of cycles queued job status is refreshed incrementally before
+ * a full re-query of the queue is done (incremental_query)
+ */
+#define INCR_QUERY_FULL_REFRESH 20
+
+/* number of cycles top job start estimates are kept before all of them are
+ * recalculated (incremental_calendar)
+ */
+#define TOPJOB_EST_FULL_REFRESH 20
+
+/* number of cycles the can't run reasons of equivalence classes are kept
+ * before all classes are evaluated again (incremental_equiv_class)
+ */
+#define EQUIV_CLASS_MEMO_FULL_REFRESH 20
+
+/* most cycles in a round of cycles (cycle_time_budget).  The last one runs
+ * to the end of the jobs.
  */
-#define SHRINK_MAX_RETRY 5
+#define CYCLE_ROUND_MAX_CYCLES 50
+
+/* node_eval_threads: upper bound on the worker pool, and the smallest
+ * node array that is worth splitting across the workers
+ */
+#define NODE_EVAL_MAX_THREADS 64
+#define NODE_EVAL_MT_MIN_NODES 512
+
+/* partition_sub_cycles: most partitions scheduled at the same time, and
+ * the seconds a sub-cycle may run past sched_cycle_length before it is
+ * killed
+ */
+#define PARTITION_SUB_CYCLES_MAX 64
+#define SUB_CYCLE_GRACE 60
+
+/* resource lists shorter than this are searched rather than indexed */
+#define RES_INDEX_MIN_LEN 8
+
+/* counts lists shorter than this are searched rather than hashed */
+#define COUNTS_INDEX_MIN_LEN 16
+
+/* number of jobs' attribute updates sent to the server in one request */
+#define JOB_UPDATE_BATCH_SIZE 256
+
+/* number of jobs sent to the server in one run request in throughput mode */
+#define RUN_JOB_BATCH_SIZE 64
 
 /* parsing -
  * names that appear on the left hand side in the sched config file
@@ -116,6 +163,7 @@
 #define PARSE_PRIME_SPILL "prime_spill"
 #define PARSE_RESOURCES "resources"
 #define PARSE_MOM_RESOURCES "mom_resources"
+#define PARSE_MOM_RES_FROM_STATUS "mom_resources_from_status"
 #define PARSE_SMP_CLUSTER_DIST "smp_cluster_dist"
 #define PARSE_PREEMPT_QUEUE_PRIO "preempt_queue_prio"
 #define PARSE_PREEMPT_SUSPEND "preempt_suspend"
@@ -136,6 +184,8 @@
 #define PARSE_SERVER_DYN_RES "server_dyn_res"
 #define PARSE_PEER_QUEUE "peer_queue"
 #define PARSE_PEER_TRANSLATION "peer_translation"
+#define PARSE_PEER_QUERY_REFRESH "peer_query_refresh"
+#define PARSE_PEER_QUERY_STALE "peer_query_stale"
 #define PARSE_NODE_GROUP_KEY "node_group_key"
 #define PARSE_DONT_PREEMPT_STARVING "dont_preempt_starving"
 #define PARSE_ENFORCE_NO_SHARES "fairshare_enforce_no_shares"
@@ -165,6 +215,18 @@
 #define PARSE_RESV_CONFIRM_IGNORE "resv_confirm_ignore"
 #define PARSE_ALLOW_AOE_CALENDAR "allow_aoe_calendar"
 #define PARSE_OPT_BACKFILL_FUZZY_TIME "opt_backfill_fuzzy_time"
+#define PARSE_INCR_QUERY "incremental_query"
+#define PARSE_INCR_CALENDAR "incremental_calendar"
+#define PARSE_INCR_EQUIV_CLASS "incremental_equiv_class"
+#define PARSE_CYCLE_TIME_BUDGET "cycle_time_budget"
+#define PARSE_NODE_EVAL_THREADS "node_eval_threads"
+#define PARSE_PARTITION_SUB_CYCLES "partition_sub_cycles"
+#define PARSE_DYN_RES_REFRESH "server_dyn_res_refresh"
+#define PARSE_DYN_RES_TIMEOUT "server_dyn_res_timeout"
+#define PARSE_DYN_RES_STALE "server_dyn_res_stale"
+#define PARSE_CYCLE_STATS_INTERVAL "cycle_stats_interval"
+#define PARSE_CYCLE_STATS_FILE "cycle_stats_file"
+#define PARSE_EST_START_THRESHOLD "estimated_start_time_threshold"
 
 /* deprecated */
 #define PARSE_PREEMPT_STARVING "preempt_starving"
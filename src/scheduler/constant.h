@@ -85,6 +85,27 @@ enum skip
 	SKIP_NON_NORMAL_JOBS = 2
 };
 
+/* node state bits as a mask (see set_node_info_state()) */
+enum node_state_bits
+{
+	NSTATE_DOWN = 1,
+	NSTATE_FREE = 2,
+	NSTATE_UNKNOWN = 4,
+	NSTATE_SHARING = 8,
+	NSTATE_BUSY = 16,
+	NSTATE_JOB_BUSY = 32,
+	NSTATE_STALE = 64,
+	NSTATE_PROV = 128,
+	NSTATE_EXCL = 256,
+	NSTATE_RESV_EXCL = 512,
+	NSTATE_JOB_EXCL = 1024,
+	NSTATE_SLEEP = 2048,
+	NSTATE_OFFLINE = 4096
+};
+
+/* number of node state strings set_node_info_state() remembers */
+#define NODE_STATE_CACHE_SIZE 8
+
 /* return value of select_index_to_preempt function */
 enum select_job_status
 {
@@ -372,7 +393,8 @@ enum run_update_resresv_flags
 {
 	RURR_NO_FLAGS = 0,
 	RURR_ADD_END_EVENT = 1, /* add end events to calendar for job */
-	RURR_NOPRINT = 2       /* don't print messages */
+	RURR_NOPRINT = 2,      /* don't print messages */
+	RURR_RUN_NOW = 4       /* send the run request now, don't batch it */
 	/* next value 4 */
 };
 
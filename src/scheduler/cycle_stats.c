@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+/**
+ * @file    cycle_stats.c
+ *
+ * @brief
+ * 		cycle_stats.c - time the phases of the scheduling cycle.
+ *
+ *	Each phase keeps a count, the total and longest time spent in it, and
+ *	a histogram of its durations since the scheduler started (or the
+ *	stats were reset on reconfigure).  Every cycle_stats_interval cycles
+ *	they are set on the scheduler's sched object as sched_cycle_stats
+ *	and, if cycle_stats_file is set, written to that file as JSON.
+ *
+ * Functions included are:
+ * 	cycle_phase_start()
+ * 	cycle_phase_stop()
+ * 	reset_cycle_stats()
+ * 	cycle_stats_str()
+ * 	write_cycle_stats_file()
+ * 	publish_cycle_stats()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/time.h>
+#include <pbs_ifl.h>
+#include <log.h>
+#include "cycle_stats.h"
+#include "constant.h"
+#include "config.h"
+#include "data_types.h"
+#include "globals.h"
+#include "fifo.h"
+#include "misc.h"
+
+struct phase_stats {
+	long count;				/* times the phase ran */
+	double total;				/* total seconds */
+	double max;				/* longest run in seconds */
+	long hist[CYCLE_STATS_HIST_SIZE];	/* runs by duration */
+};
+
+static struct phase_stats cstats[CPHASE_NUM];
+static int cycles_since_publish;
+
+/* names used to report the phases */
+static const char *phase_names[CPHASE_NUM] = {
+	"cycle",
+	"query",
+	"sort",
+	"main_loop",
+	"calendar",
+	"preempt",
+	"run_job",
+	"end_cycle"
+};
+
+/**
+ * @brief
+ * 		start timing a phase
+ *
+ * @return	current time in seconds to pass to cycle_phase_stop()
+ */
+double
+cycle_phase_start(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/**
+ * @brief
+ * 		finish timing a phase and add it to the phase's stats
+ *
+ * @param[in]	phase	-	phase which finished
+ * @param[in]	start	-	return value of cycle_phase_start()
+ *
+ * @return	void
+ */
+void
+cycle_phase_stop(enum cycle_phase phase, double start)
+{
+	struct phase_stats *ps;
+	double elapsed;
+	double ms;
+	int b;
+
+	if (phase < 0 || phase >= CPHASE_NUM)
+		return;
+
+	elapsed = cycle_phase_start() - start;
+	/* the clock went backwards */
+	if (elapsed < 0)
+		elapsed = 0;
+
+	ps = &cstats[phase];
+	ps->count++;
+	ps->total += elapsed;
+	if (elapsed > ps->max)
+		ps->max = elapsed;
+
+	ms = elapsed * 1000;
+	for (b = 0; b < CYCLE_STATS_HIST_SIZE - 1 && ms >= 1; b++)
+		ms /= 2;
+	ps->hist[b]++;
+}
+
+/**
+ * @brief
+ * 		reset all the phase timings
+ *
+ * @return	void
+ */
+void
+reset_cycle_stats(void)
+{
+	memset(cstats, 0, sizeof(cstats));
+	cycles_since_publish = 0;
+}
+
+/**
+ * @brief
+ * 		format the phase timings for the sched_cycle_stats attribute
+ *		phase=count:total:max for every phase which ran
+ *
+ * @param[out]	buf	-	buffer to format into
+ * @param[in]	size	-	size of buf
+ *
+ * @return	buf
+ */
+char *
+cycle_stats_str(char *buf, int size)
+{
+	int len = 0;
+	int i;
+
+	buf[0] = '\0';
+	for (i = 0; i < CPHASE_NUM && len < size; i++) {
+		if (cstats[i].count == 0)
+			continue;
+		len += snprintf(buf + len, size - len, "%s%s=%ld:%.3f:%.3f",
+			len > 0 ? " " : "", phase_names[i], cstats[i].count,
+			cstats[i].total, cstats[i].max);
+	}
+
+	return buf;
+}
+
+/**
+ * @brief
+ * 		write the phase timings to a file as JSON.  The file is written
+ *		under a temporary name and renamed so readers never see a partial
+ *		file.
+ *
+ * @param[in]	fname	-	file to write
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
+ */
+static int
+write_cycle_stats_file(char *fname)
+{
+	char tmpname[MAXPATHLEN + 1];
+	FILE *fp;
+	int i;
+	int j;
+
+	snprintf(tmpname, sizeof(tmpname), "%s.tmp", fname);
+	if ((fp = fopen(tmpname, "w")) == NULL) {
+		log_err(errno, __func__, tmpname);
+		return 0;
+	}
+
+	fprintf(fp, "{\n\t\"time\": %ld,\n\t\"phases\": {", (long) time(NULL));
+	for (i = 0; i < CPHASE_NUM; i++) {
+		fprintf(fp, "%s\n\t\t\"%s\": {\"count\": %ld, \"total\": %.6f, \"max\": %.6f, \"histogram_ms\": [",
+			i > 0 ? "," : "", phase_names[i], cstats[i].count, cstats[i].total, cstats[i].max);
+		for (j = 0; j < CYCLE_STATS_HIST_SIZE; j++)
+			fprintf(fp, "%s%ld", j > 0 ? ", " : "", cstats[i].hist[j]);
+		fprintf(fp, "]}");
+	}
+	fprintf(fp, "\n\t}\n}\n");
+
+	if (fclose(fp) != 0 || rename(tmpname, fname) != 0) {
+		log_err(errno, __func__, fname);
+		remove(tmpname);
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		report the phase timings every cycle_stats_interval cycles.  They
+ *		are set on our sched object and written to cycle_stats_file.
+ *		Called once at the end of each scheduling cycle.
+ *
+ * @param[in]	pbs_sd	-	connection descriptor to the pbs server
+ *
+ * @return	void
+ */
+void
+publish_cycle_stats(int pbs_sd)
+{
+	char buf[1024];
+	struct attropl attr;
+
+	if (conf.cycle_stats_interval <= 0)
+		return;
+
+	if (++cycles_since_publish < conf.cycle_stats_interval)
+		return;
+	cycles_since_publish = 0;
+
+	cycle_stats_str(buf, sizeof(buf));
+	log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+
+	if (conf.cycle_stats_file != NULL)
+		write_cycle_stats_file(conf.cycle_stats_file);
+
+	if (pbs_sd < 0 || buf[0] == '\0')
+		return;
+
+	attr.name = ATTR_sched_cycle_stats;
+	attr.resource = NULL;
+	attr.value = buf;
+	attr.op = SET;
+	attr.next = NULL;
+	if (pbs_manager(pbs_sd, MGR_CMD_SET, MGR_OBJ_SCHED, sc_name, &attr, NULL) != 0)
+		log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"Unable to set %s: %s", ATTR_sched_cycle_stats, pbs_geterrmsg(pbs_sd));
+}
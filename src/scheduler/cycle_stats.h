@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+#ifndef	_CYCLE_STATS_H
+#define	_CYCLE_STATS_H
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+/* phases of the scheduling cycle which are timed */
+enum cycle_phase {
+	CPHASE_CYCLE,		/* the whole scheduling_cycle() */
+	CPHASE_QUERY,		/* query_server() */
+	CPHASE_SORT,		/* sort_jobs() */
+	CPHASE_MAIN_LOOP,	/* main_sched_loop() */
+	CPHASE_CALENDAR,	/* add_job_to_calendar() */
+	CPHASE_PREEMPT,		/* find_and_preempt_jobs() */
+	CPHASE_RUN_JOB,		/* run job request round trip to the server */
+	CPHASE_END_CYCLE,	/* end_cycle_tasks() */
+	CPHASE_NUM
+};
+
+/* histogram buckets: <1ms, <2ms, <4ms, ... the last one is open ended */
+#define CYCLE_STATS_HIST_SIZE 16
+
+/*
+ *	cycle_phase_start - start timing a phase
+ */
+double cycle_phase_start(void);
+
+/*
+ *	cycle_phase_stop - add the time since start to a phase
+ */
+void cycle_phase_stop(enum cycle_phase phase, double start);
+
+/*
+ *	publish_cycle_stats - report the phase timings every
+ *			      cycle_stats_interval cycles
+ */
+void publish_cycle_stats(int pbs_sd);
+
+/*
+ *	cycle_stats_str - format the phase timings as phase=count:total:max
+ */
+char *cycle_stats_str(char *buf, int size);
+
+/*
+ *	reset_cycle_stats - reset all the phase timings
+ */
+void reset_cycle_stats(void);
+
+#ifdef	__cplusplus
+}
+#endif
+#endif	/* _CYCLE_STATS_H */
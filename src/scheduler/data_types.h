@@ -61,6 +61,7 @@ extern "C" {
 #include "config.h"
 #include "pbs_bitmap.h"
 #include "pbs_share.h"
+#include "avltree.h"
 #ifdef NAS
 #include "site_queue.h"
 #endif
@@ -98,6 +99,8 @@ struct bucket_bitpool;
 struct chunk_map;
 struct node_bucket_count;
 struct preempt_job_st;
+struct obj_pool;
+struct node_name_index;
 
 
 typedef struct state_count state_count;
@@ -135,6 +138,8 @@ typedef struct bucket_bitpool bucket_bitpool;
 typedef struct chunk_map chunk_map;
 typedef struct node_bucket_count node_bucket_count;
 typedef struct preempt_job_st preempt_job_st;
+typedef struct obj_pool obj_pool;
+typedef struct node_name_index node_name_index;
 
 #ifdef NAS
 /* localmod 034 */
@@ -204,6 +209,7 @@ struct place
 	unsigned int share:1;		/* will share nodes */
 
 	char *group;			/* resource to node group by */
+	int refct;			/* # of owners sharing this spec (see share_place()) */
 };
 
 struct chunk
@@ -220,6 +226,7 @@ struct selspec
 	int total_cpus;			/* # of cpus requested in this select spec */
 	resdef **defs;			/* the resources requested by this select spec*/
 	chunk **chunks;
+	int refct;			/* # of owners sharing this spec (see share_selspec()) */
 };
 
 /* for description of these bits, check the PBS admin guide or scheduler IDS */
@@ -303,6 +310,8 @@ struct server_info
 	unsigned preempt_targets_enable:1;/* if preemptable limit targets are enabled */
 	unsigned use_hard_duration:1;	/* use hard duration when creating the calendar */
 	unsigned pset_metadata_stale:1;	/* The placement set meta data is stale and needs to be regenerated before the next use */
+	unsigned nodes_sort_stale:1;	/* the node arrays need a full sort before they can be re-sorted incrementally */
+	unsigned has_indirect_res:1;	/* some vnode has an indirect resource */
 	char *name;			/* name of server */
 	struct schd_resource *res;	/* list of resources */
 	void *liminfo;			/* limit storage information */
@@ -335,6 +344,15 @@ struct server_info
 	 */
 	int preempt_count[NUM_PPRIO + 1];
 
+	/* running jobs which can be preempted, in the order to preempt them.
+	 * Built by find_jobs_to_preempt() and rebuilt once preempt_gen moves
+	 * past preempt_cands_gen.  preempt_gen is bumped whenever a job starts
+	 * or stops running or a running job's preempt priority is reset.
+	 */
+	resource_resv **preempt_cands;
+	int preempt_cands_gen;
+	int preempt_gen;
+
 	counts *group_counts;		/* group resource and running counts */
 	counts *project_counts;		/* project resource and running counts */
 	counts *user_counts;		/* user resource and running counts */
@@ -374,6 +392,7 @@ struct server_info
 	resresv_set **equiv_classes;
 	node_bucket **buckets;		/* node bucket array */
 	node_info **unordered_nodes;
+	node_name_index *node_idx;	/* name -> node for nodes (shared with dups) */
 	int soft_limit_preempt_bit;	/* Overall preempt bit to mark server is over max run softlimits */
 #ifdef NAS
 	/* localmod 049 */
@@ -500,6 +519,8 @@ struct job_info
 
 	/* job array information */
 	range *queued_subjobs;		/* a list of ranges of queued subjob indices */
+	range *materialized_subjobs;	/* indices of subjobs which exist as their own
+					 * resource_resv (NULL if not yet collected) */
 
 	int accrue_type;		/* type of time job should accrue */
 	time_t eligible_time;		/* eligible time accrued until last cycle */
@@ -534,6 +555,8 @@ struct node_scratch
 	unsigned int to_be_sorted:1;	/* used for sorting of the nodes while
 					 * altering a reservation.
 					 */
+	unsigned int to_resort:1;	/* node is out of place (see resort_changed_nodes()) */
+	unsigned int np_changed:1;	/* node changed (see free_np_cache_for_nodes()) */
 };
 
 struct node_info
@@ -685,9 +708,9 @@ struct resource_resv
 	unsigned	will_use_multinode:1;	/* res resv will use multiple nodes */
 
 	char		*name;			/* name of res resv */
-	char		*user;			/* username of the owner of the res resv */
-	char		*group;			/* exec group of owner of res resv */
-	char		*project;		/* exec project of owner of res resv */
+	char		*user;			/* username of the owner of the res resv (interned) */
+	char		*group;			/* exec group of owner of res resv (interned) */
+	char		*project;		/* exec project of owner of res resv (interned) */
 	char		*nodepart_name;		/* name of node partition to run res resv in */
 
 	long		sch_priority;		/* scheduler priority of res resv */
@@ -722,6 +745,9 @@ struct resource_resv
 	enum site_j_share_type share_type;	/* How resv counts against group share */
 #endif /* localmod 034 */
 	int		resresv_ind;		/* resource_resv index in all_resresv array */
+	sch_resource_t	*sort_keys;		/* job sort key values cached by sort_jobs() */
+	int		num_sort_keys;		/* number of values in sort_keys */
+	unsigned int	sort_key_gen;		/* sort_jobs() call sort_keys were cached for */
 	timed_event 	*run_event;		/* run event in calendar */
 	timed_event	*end_event;		/* end event in calendar */
 };
@@ -761,6 +787,10 @@ struct schd_resource
 	resdef *def;			/* resource definition */
 
 	struct schd_resource *next;	/* next resource in list */
+
+	/* only used on the head of a list - see find_resource() */
+	struct schd_resource **ind_arr;	/* the list indexed by resdef ordinal */
+	int ind_arr_size;		/* 0 not built, -1 list too short to index */
 };
 
 struct resource_req
@@ -779,6 +809,7 @@ struct resdef
 	char *name;			/* name of resource */
 	struct resource_type type;	/* resource type */
 	unsigned int flags;		/* resource flags (see pbs_ifl.h) */
+	int ind;			/* ordinal in allres or -1 */
 };
 
 struct prev_job_info
@@ -801,6 +832,7 @@ struct counts
 	int running;			/* count of running jobs in object */
 	int soft_limit_preempt_bit;	/* Place to store preempt bit if entity is over limits */
 	resource_count *rescts;		/* resources used */
+	struct counts_index *idx;	/* name hash of the list, only on the head */
 	counts *next;
 };
 
@@ -820,6 +852,7 @@ struct fairshare_head
 {
 	group_info *root;			/* root of fairshare tree */
 	time_t last_decay;			/* last time tree was decayed */
+	AVL_IX_DESC *ginfo_idx;			/* name -> group_info of every node in the tree */
 };
 
 /* a path from the root to a group_info in the tree */
@@ -865,20 +898,22 @@ struct resresv_set
 {
 	unsigned can_not_run:1;		/* set can not run */
 	schd_error *err;		/* reason why set can not run*/
-	char *user;			/* user of set, can be NULL */
-	char *group;			/* group of set, can be NULL */
-	char *project;			/* project of set, can be NULL */
+	char *user;			/* user of set (interned), can be NULL */
+	char *group;			/* group of set (interned), can be NULL */
+	char *project;			/* project of set (interned), can be NULL */
 	char *partition;		/* partition of set, can be NULL */
 	selspec *select_spec;		/* select spec of set */
 	place *place_spec;		/* place spec of set */
 	resource_req *req;		/* ATTR_L (qsub -l) resources of set.  Only contains resources on the resources line */
 	queue_info *qinfo;		/* The queue the resresv is in if the queue has nodes associated */
+	char *key;			/* key the set was created under, can be NULL */
 };
 
 struct node_partition
 {
 	unsigned int ok_break:1;	/* OK to break up chunks on this node part */
 	unsigned int excl:1;		/* partition should be allocated exclusively */
+	unsigned int host_max_set:1;	/* host_max has been computed */
 	char *name;			/* res_name=res_val */
 	/* name of resource and value which define the node partition */
 	resdef *def;
@@ -886,6 +921,7 @@ struct node_partition
 	int tot_nodes;		/* the total number of nodes  */
 	int free_nodes;		/* the number of nodes in state Free  */
 	schd_resource *res;		/* total amount of resources in node part */
+	schd_resource *host_max;	/* most of each consumable any one host has */
 	node_info **ninfo_arr;	/* array of pointers to node structures  */
 	node_bucket **bkts;	/* node buckets for node part */
 	int rank;		/* unique numeric identifier for node partition */
@@ -1061,6 +1097,10 @@ struct config
 	unsigned resv_conf_ignore:1;  /* if we want to ignore dedicated time when confirming reservations.  Move to enum if ever expanded */
 	unsigned allow_aoe_calendar:1;        /* allow jobs requesting aoe in calendar*/
 	unsigned logstderr:1;               /* log to stderr as well as log file */
+	unsigned incr_query:1;		/* keep queued job status between cycles */
+	unsigned mom_res_from_status:1;	/* mom_resources come in the node status */
+	unsigned incr_calendar:1;	/* keep top job start estimates between cycles */
+	unsigned incr_equiv_class:1;	/* keep can't run reasons of equiv classes between cycles */
 #ifdef NAS /* localmod 034 */
 	unsigned prime_sto	:1;	/* shares_track_only--no enforce shares */
 	unsigned non_prime_sto:1;
@@ -1088,6 +1128,17 @@ struct config
 	int max_preempt_attempts;		/* max num of preempt attempts per cyc*/
 	int max_jobs_to_check;			/* max number of jobs to check in cyc*/
 	long dflt_opt_backfill_fuzzy;		/* default time for the fuzzy backfill optimization */
+	int node_eval_threads;			/* worker threads for vnode eligibility checks */
+	int partition_sub_cycles;		/* partitions scheduled at the same time */
+	int cycle_stats_interval;		/* cycles between reporting phase timings */
+	int cycle_time_budget;			/* ms a cycle may take before it yields */
+	long est_start_threshold;		/* seconds a top job's estimate may move unsent */
+	int dyn_res_refresh;			/* seconds between background server_dyn_res runs */
+	int dyn_res_timeout;			/* seconds a server_dyn_res program may run */
+	int dyn_res_stale;			/* seconds a cached server_dyn_res value is used */
+	int peer_query_refresh;			/* seconds between peer queue refreshes between cycles */
+	int peer_query_stale;			/* seconds cached peer queue job status is used */
+	char *cycle_stats_file;			/* file to write phase timings to */
 	char ded_prefix[PBS_MAXQUEUENAME +1];	/* prefix to dedicated queues */
 	char pt_prefix[PBS_MAXQUEUENAME +1];	/* prefix to primetime queues */
 	char npt_prefix[PBS_MAXQUEUENAME +1];	/* prefix to non primetime queues */
@@ -1137,6 +1188,7 @@ struct event_list
 	timed_event *events;		/* the calendar of events */
 	timed_event *next_event;	/* the next event to be performed */
 	timed_event *first_run_event;	/* The first run event in the calendar */
+	timed_event *last_added;	/* search hint for add_event() */
 	time_t *current_time;		/* [reference] current time in the calendar */
 };
 
@@ -1192,6 +1244,22 @@ struct resresv_filter {
 	resource_resv *job;
 	schd_error *err;		/* reason why set can not run*/
 };
+
+/* name -> node lookup for a server's nodes (see find_node_info()) */
+struct node_name_index {
+	AVL_IX_DESC *idx;		/* node name -> &inds[i] */
+	int *inds;			/* node_ind of each node */
+	int refct;			/* # of servers sharing the index */
+};
+
+/* pool of fixed size objects carved out of larger slabs (see pool_alloc()) */
+struct obj_pool {
+	size_t obj_size;		/* size of the objects in the pool */
+	int objs_per_slab;		/* number of objects allocated at once */
+	void *free_list;		/* free objects, linked through their first word */
+	int num_slabs;			/* number of slabs allocated */
+	int num_used;			/* number of objects handed out */
+};
 #ifdef	__cplusplus
 }
 #endif
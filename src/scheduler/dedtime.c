@@ -45,7 +45,9 @@
  * Functions included are:
  * 	parse_ded_file()
  * 	cmp_ded_time()
+ * 	build_ded_timeline()
  * 	is_ded_time()
+ * 	find_next_dedtime()
  *
  */
 #include <pbs_config.h>
@@ -62,6 +64,13 @@
 #include "dedtime.h"
 #include "globals.h"
 
+/*
+ * The dedicated times of conf.ded_time with overlapping entries merged, so
+ * both ends are in ascending order and find_next_dedtime() can bisect it.
+ * Rebuilt by build_ded_timeline() whenever conf.ded_time changes.
+ */
+static struct timegap ded_timeline[MAX_DEDTIME_SIZE];
+static int ded_timeline_ct = 0;
 
 /**
  * @brief
@@ -91,6 +100,7 @@ parse_ded_file(char *filename)
 	if ((fp = fopen(filename, "r")) == NULL) {
 		sprintf(log_buffer, "Error opening file %s", filename);
 		log_err(errno, "parse_ded_file", log_buffer);
+		build_ded_timeline();
 		return 1;
 	}
 
@@ -150,6 +160,7 @@ parse_ded_file(char *filename)
 	}
 	/* sort dedtime in ascending order with all 0 elements at the end */
 	qsort(conf.ded_time, MAX_DEDTIME_SIZE, sizeof(struct timegap), cmp_ded_time);
+	build_ded_timeline();
 	fclose(fp);
 	return 0;
 }
@@ -182,6 +193,35 @@ cmp_ded_time(const void *v1, const void *v2)
 		return 0;
 }
 
+/**
+ * @brief
+ * 		build_ded_timeline - merge the sorted conf.ded_time array into the
+ *		timeline of disjoint dedicated times used by find_next_dedtime()
+ *
+ * @return	void
+ *
+ * @par NOTE:
+ *		must be called after every change to conf.ded_time
+ *
+ * @par MT-safe: No
+ */
+void
+build_ded_timeline(void)
+{
+	int i;
+
+	ded_timeline_ct = 0;
+	for (i = 0; i < MAX_DEDTIME_SIZE && conf.ded_time[i].from != 0; i++) {
+		if (ded_timeline_ct > 0 &&
+			conf.ded_time[i].from < ded_timeline[ded_timeline_ct - 1].to) {
+			/* overlaps the previous dedicated time, extend it */
+			if (conf.ded_time[i].to > ded_timeline[ded_timeline_ct - 1].to)
+				ded_timeline[ded_timeline_ct - 1].to = conf.ded_time[i].to;
+		} else
+			ded_timeline[ded_timeline_ct++] = conf.ded_time[i];
+	}
+}
+
 /**
  * @brief
  * 		checks if it is dedicated time at time t
@@ -220,10 +260,21 @@ is_ded_time(time_t t)
  */
 struct timegap find_next_dedtime(time_t t)
 {
-	int i;
+	int lo = 0;
+	int hi = ded_timeline_ct;
+	int mid;
+	struct timegap none = {0, 0};
 
-	for (i = 0; conf.ded_time[i].from != 0 && conf.ded_time[i].to <= t; i++)
-		;
+	/* find the first dedicated time which has not ended by t */
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (ded_timeline[mid].to <= t)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
 
-	return conf.ded_time[i];
+	if (lo == ded_timeline_ct)
+		return none;
+	return ded_timeline[lo];
 }
@@ -58,6 +58,12 @@ int parse_ded_file(char *filename);
  */
 int cmp_ded_time(const void *v1, const void *v2);
 
+/*
+ *	build_ded_timeline - merge conf.ded_time into the sorted timeline
+ *			     searched by find_next_dedtime()
+ */
+void build_ded_timeline(void);
+
 /*
  *      is_ded_time - checks if it is currently dedicated time
  */
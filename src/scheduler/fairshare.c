@@ -45,6 +45,10 @@
  * Functions included are:
  * 	add_child()
  * 	add_unknown()
+ * 	index_group_info()
+ * 	build_group_info_index()
+ * 	free_group_info_index()
+ * 	find_group_info_rec()
  * 	find_group_info()
  * 	find_alloc_ginfo()
  * 	new_group_info()
@@ -130,24 +134,89 @@ add_child(group_info *ginfo, group_info *parent)
  * 		add a ginfo to the "unknown" group
  *
  * @param[in]	ginfo	-	ginfo to add
- * @param[in]	root	-	root of fairshare tree
+ * @param[in]	fhead	-	fairshare tree
  *
  * @return	nothing
  *
  */
 void
-add_unknown(group_info *ginfo, group_info *root)
+add_unknown(group_info *ginfo, fairshare_head *fhead)
 {
 	group_info *unknown;		/* ptr to the "unknown" group */
 
-	unknown = find_group_info("unknown", root);
+	unknown = find_group_info(UNKNOWN_GROUP_NAME, fhead);
 	add_child(ginfo, unknown);
+	index_group_info(ginfo, fhead);
 	calc_fair_share_perc(unknown->child, UNSPECIFIED);
 }
 
 /**
  * @brief
- *		find_group_info - recursive function to find a group_info in the
+ *		index_group_info - add a group_info to the name index of a
+ *			  fairshare tree.  If the index can't be updated,
+ *			  it is dropped and lookups walk the tree.
+ *
+ * @param[in]	ginfo	-	ginfo to add
+ * @param[in]	fhead	-	fairshare tree ginfo is in
+ *
+ * @return	nothing
+ *
+ */
+void
+index_group_info(group_info *ginfo, fairshare_head *fhead)
+{
+	if (ginfo == NULL || ginfo->name == NULL || fhead == NULL || fhead->ginfo_idx == NULL)
+		return;
+
+	if (tree_add_del(fhead->ginfo_idx, ginfo->name, ginfo, TREE_OP_ADD) != 0) {
+		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, ginfo->name,
+			"Unable to index fairshare entity, tree will be searched");
+		free_group_info_index(fhead);
+	}
+}
+
+/**
+ * @brief
+ *		build_group_info_index - add a fairshare subtree to the name index
+ *
+ * @param[in]	root	-	root of the subtree
+ * @param[in]	fhead	-	fairshare tree root is in
+ *
+ * @return	nothing
+ *
+ */
+static void
+build_group_info_index(group_info *root, fairshare_head *fhead)
+{
+	for (; root != NULL && fhead->ginfo_idx != NULL; root = root->sibling) {
+		index_group_info(root, fhead);
+		build_group_info_index(root->child, fhead);
+	}
+}
+
+/**
+ * @brief
+ *		free_group_info_index - free the name index of a fairshare tree
+ *
+ * @param[in]	fhead	-	fairshare tree
+ *
+ * @return	nothing
+ *
+ */
+void
+free_group_info_index(fairshare_head *fhead)
+{
+	if (fhead == NULL || fhead->ginfo_idx == NULL)
+		return;
+
+	avl_destroy_index(fhead->ginfo_idx);
+	free(fhead->ginfo_idx);
+	fhead->ginfo_idx = NULL;
+}
+
+/**
+ * @brief
+ *		find_group_info_rec - recursive function to find a group_info in the
  *			  resgroup tree
  *
  * @param[in]	name	-	name of the ginfo to find
@@ -156,20 +225,43 @@ add_unknown(group_info *ginfo, group_info *root)
  * @return	the found group_info or NULL
  *
  */
-group_info *
-find_group_info(char *name, group_info *root)
+static group_info *
+find_group_info_rec(char *name, group_info *root)
 {
 	group_info *ginfo;		/* the found group */
 	if (root == NULL || name == NULL || !strcmp(name, root->name))
 		return root;
 
-	ginfo = find_group_info(name, root->sibling);
+	ginfo = find_group_info_rec(name, root->sibling);
 	if (ginfo == NULL)
-		ginfo = find_group_info(name, root->child);
+		ginfo = find_group_info_rec(name, root->child);
 
 	return ginfo;
 }
 
+/**
+ * @brief
+ *		find_group_info - find a group_info in the resgroup tree.
+ *			  The name index is used if there is one.
+ *
+ * @param[in]	name	-	name of the ginfo to find
+ * @param[in]	fhead	-	the fairshare tree
+ *
+ * @return	the found group_info or NULL
+ *
+ */
+group_info *
+find_group_info(char *name, fairshare_head *fhead)
+{
+	if (name == NULL || fhead == NULL)
+		return NULL;
+
+	if (fhead->ginfo_idx != NULL)
+		return find_tree(fhead->ginfo_idx, name);
+
+	return find_group_info_rec(name, fhead->root);
+}
+
 /**
  * @brief
  *		find_alloc_ginfo - tries to find a ginfo in the fair share tree.  If it
@@ -177,20 +269,20 @@ find_group_info(char *name, group_info *root)
  *			  add it to the "unknown" group
  *
  * @param[in]	name	-	name of the ginfo to find
- * @param[in]	root	-	root of the fairshare tree
+ * @param[in]	fhead	-	the fairshare tree
  *
  * @return	the found ginfo or the newly allocated ginfo
  *
  */
 group_info *
-find_alloc_ginfo(char *name, group_info *root)
+find_alloc_ginfo(char *name, fairshare_head *fhead)
 {
 	group_info *ginfo;		/* the found group or allocated group */
 
-	if (name == NULL || root == NULL)
+	if (name == NULL || fhead == NULL || fhead->root == NULL)
 		return NULL;
 
-	ginfo = find_group_info(name, root);
+	ginfo = find_group_info(name, fhead);
 
 	if (ginfo == NULL) {
 		if ((ginfo = new_group_info()) == NULL)
@@ -198,7 +290,7 @@ find_alloc_ginfo(char *name, group_info *root)
 
 		ginfo->name = string_dup(name);
 		ginfo->shares = 1;
-		add_unknown(ginfo, root);
+		add_unknown(ginfo, fhead);
 	}
 	return ginfo;
 }
@@ -242,7 +334,7 @@ new_group_info()
  * 		parse the resource group file
  *
  * @param[in]	fname	-	name of the file
- * @param[in]	root	-	root of fairshare tree
+ * @param[in]	fhead	-	fairshare tree
  *
  * @return	success/failure
  *
@@ -255,7 +347,7 @@ new_group_info()
  *
  */
 int
-parse_group(char *fname, group_info *root)
+parse_group(char *fname, fairshare_head *fhead)
 {
 	group_info *ginfo;		/* ptr to parent group */
 	group_info *new_ginfo;	/* used to add each new group */
@@ -292,7 +384,7 @@ parse_group(char *fname, group_info *root)
 				grouptok == NULL || sharestok == NULL) {
 				error = 1;
 			}
-			else if (find_group_info(nametok, root) != NULL) {
+			else if (find_group_info(nametok, fhead) != NULL) {
 				error = 1;
 				sprintf(log_buffer, "entity %s is not unique", nametok);
 				fprintf(stderr, "%s\n", log_buffer);
@@ -301,9 +393,9 @@ parse_group(char *fname, group_info *root)
 			}
 			else {
 				if (!strcmp(grouptok, "root"))
-					ginfo = find_group_info(FAIRSHARE_ROOT_NAME, root);
+					ginfo = find_group_info(FAIRSHARE_ROOT_NAME, fhead);
 				else
-					ginfo = find_group_info(grouptok, root);
+					ginfo = find_group_info(grouptok, fhead);
 
 				if (ginfo != NULL) {
 					shares = strtol(sharestok, &endp, 10);
@@ -317,6 +409,7 @@ parse_group(char *fname, group_info *root)
 							new_ginfo->cresgroup = cgroup;
 							new_ginfo->shares = shares;
 							add_child(new_ginfo, ginfo);
+							index_group_info(new_ginfo, fhead);
 						}
 						else
 							error = 1;
@@ -397,6 +490,11 @@ preload_tree()
 	unknown->cresgroup = 1;
 	unknown->parent = root;
 	add_child(unknown, root);
+
+	if ((head->ginfo_idx = create_tree(AVL_NO_DUP_KEYS, 0)) != NULL) {
+		index_group_info(root, head);
+		index_group_info(unknown, head);
+	}
 	return head;
 }
 
@@ -718,7 +816,7 @@ read_usage(char *filename, int flags, fairshare_head *fhead)
 						error = 1;
 				}
 				if (!error)
-					read_usage_v2(fp, flags, fhead->root);
+					read_usage_v2(fp, flags, fhead);
 			}
 			else
 				error = 1;
@@ -730,7 +828,7 @@ read_usage(char *filename, int flags, fairshare_head *fhead)
 		}
 		else	 { /* original headerless usage file */
 			rewind(fp);
-			read_usage_v1(fp, fhead->root);
+			read_usage_v1(fp, fhead);
 		}
 	}
 
@@ -742,7 +840,7 @@ read_usage(char *filename, int flags, fairshare_head *fhead)
  * 		read version 1 usage file
  *
  * @param[in]	fp	-	the file pointer to the open file
- * @param[in]	root	-	root of the fairshare tree
+ * @param[in]	fhead	-	the fairshare tree
  *
  * @return	int
  *	@retval	1	: success
@@ -750,7 +848,7 @@ read_usage(char *filename, int flags, fairshare_head *fhead)
  *
  */
 int
-read_usage_v1(FILE *fp, group_info *root)
+read_usage_v1(FILE *fp, fairshare_head *fhead)
 {
 	struct group_node_usage_v1 grp;
 	group_info *ginfo;
@@ -761,7 +859,7 @@ read_usage_v1(FILE *fp, group_info *root)
 
 	while (fread(&grp, sizeof(struct group_node_usage_v1), 1, fp)) {
 		if (grp.usage >= 0 && is_valid_pbs_name(grp.name, USAGE_NAME_MAX)) {
-			ginfo = find_alloc_ginfo(grp.name, root);
+			ginfo = find_alloc_ginfo(grp.name, fhead);
 			if (ginfo != NULL) {
 				ginfo->usage = grp.usage;
 				ginfo->temp_usage = grp.usage;
@@ -790,14 +888,14 @@ read_usage_v1(FILE *fp, group_info *root)
  *
  * @param[in]	fp	- the file pointer to the open file
  * @param[in]	flags	- flags to check whether to trim or not.
- * @param[in]	root	- root of the fairshare tree
+ * @param[in]	fhead	- the fairshare tree
  *
  *	@retval 1 success
  *	@retval 0 failure
  *
  */
 int
-read_usage_v2(FILE *fp, int flags, group_info *root)
+read_usage_v2(FILE *fp, int flags, fairshare_head *fhead)
 {
 	struct group_node_usage_v2 grp;
 	group_info *ginfo;
@@ -812,9 +910,9 @@ read_usage_v2(FILE *fp, int flags, group_info *root)
 			 * already in the resource_group file
 			 */
 			if (flags & FS_TRIM)
-				ginfo = find_group_info(grp.name, root);
+				ginfo = find_group_info(grp.name, fhead);
 			else
-				ginfo = find_alloc_ginfo(grp.name, root);
+				ginfo = find_alloc_ginfo(grp.name, fhead);
 
 			if (ginfo != NULL) {
 				ginfo->usage = grp.usage;
@@ -1037,6 +1135,7 @@ new_fairshare_head()
 
 	fhead->root = NULL;
 	fhead->last_decay = 0;
+	fhead->ginfo_idx = NULL;
 
 	return fhead;
 }
@@ -1070,6 +1169,10 @@ dup_fairshare_head(fairshare_head *ofhead)
 		return NULL;
 	}
 
+	if (ofhead->ginfo_idx != NULL &&
+	    (nfhead->ginfo_idx = create_tree(AVL_NO_DUP_KEYS, 0)) != NULL)
+		build_group_info_index(nfhead->root, nfhead);
+
 	return nfhead;
 }
 
@@ -1085,6 +1188,7 @@ free_fairshare_head(fairshare_head *fhead)
 	if (fhead == NULL)
 		return;
 
+	free_group_info_index(fhead);
 	free_fairshare_tree(fhead->root);
 
 	free(fhead);
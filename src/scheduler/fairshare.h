@@ -48,17 +48,16 @@ extern "C" {
 void add_child(group_info *ginfo, group_info *parent);
 
 /*
- *      find_group_info - recursive function to find a ginfo in the
- resgroup tree
+ *      find_group_info - find a ginfo in the resgroup tree
  */
-group_info *find_group_info(char *name, group_info *root);
+group_info *find_group_info(char *name, fairshare_head *fhead);
 
 /*
  *      find_alloc_ginfo - trys to find a ginfo in the fair share tree.  If it
  *                        can not find the ginfo, then allocate a new one and
  *                        add it to the "unknown" group
  */
-group_info *find_alloc_ginfo(char *name, group_info *root);
+group_info *find_alloc_ginfo(char *name, fairshare_head *fhead);
 
 
 /*
@@ -75,7 +74,7 @@ group_info * new_group_info();
  *	parse_group - parse the resource group file
  *
  *	  fname - name of the file
- *	  root  - root of fairshare tree
+ *	  fhead - fairshare tree
  *
  *	return success/failure
  *
@@ -88,7 +87,7 @@ group_info * new_group_info();
  *	  shares  - the amount of shares the user/group has in its resgroup
  *
  */
-int parse_group(char *fname, group_info *root);
+int parse_group(char *fname, fairshare_head *fhead);
 
 /*
  *
@@ -152,12 +151,12 @@ void read_usage(char *filename, int flags, fairshare_head *fhead);
 /*
  *      read_usage_v1 - read version 1 usage file
  */
-int read_usage_v1(FILE *fp, group_info *root);
+int read_usage_v1(FILE *fp, fairshare_head *fhead);
 
 /*
  *      read_usage_v2 - read version 2 usage file
  */
-int read_usage_v2(FILE *fp, int flags, group_info *root);
+int read_usage_v2(FILE *fp, int flags, fairshare_head *fhead);
 
 /*
  *      new_group_path - create a new group_path structure and init it
@@ -241,12 +240,22 @@ void free_fairshare_head(fairshare_head *fhead);
  *	add_unknown - add a ginfo to the "unknown" group
  *
  *	  ginfo - ginfo to add
- *	  root  - root of fairshare tre
+ *	  fhead - fairshare tree
  *
  *	return nothing
  *
  */
-void add_unknown(group_info *ginfo, group_info *root);
+void add_unknown(group_info *ginfo, fairshare_head *fhead);
+
+/*
+ *	index_group_info - add a ginfo to the name index of a fairshare tree
+ */
+void index_group_info(group_info *ginfo, fairshare_head *fhead);
+
+/*
+ *	free_group_info_index - free the name index of a fairshare tree
+ */
+void free_group_info_index(fairshare_head *fhead);
 
 /*
  * 	reset_temp_usage - walk the fairshare tree resetting temp_usage = usage
@@ -44,15 +44,31 @@
  *
  * Functions included are:
  * 	schedinit()
+ * 	save_warm_cache()
+ * 	load_warm_cache()
  * 	update_cycle_status()
  * 	init_scheduling_cycle()
  * 	schedule()
+ * 	cycle_round_free()
+ * 	cycle_round_add()
+ * 	cmp_cycle_round_name()
+ * 	cycle_round_sort()
+ * 	cycle_round_exempt()
+ * 	cycle_round_mark()
  * 	intermediate_schedule()
  * 	scheduling_cycle()
  * 	main_sched_loop()
  * 	end_cycle_tasks()
  * 	update_last_running()
  * 	update_job_can_not_run()
+ * 	queue_run_job()
+ * 	free_pending_runs()
+ * 	flush_run_jobs()
+ * 	send_sub_cycle_run()
+ * 	send_run_request()
+ * 	send_run_job()
+ * 	queue_peer_move()
+ * 	flush_peer_moves()
  * 	run_job()
  * 	run_update_resresv()
  * 	sim_run_update_resresv()
@@ -109,6 +125,8 @@
 #include "resource_resv.h"
 #include "simulate.h"
 #include "node_partition.h"
+#include "cycle_stats.h"
+#include "sub_cycle.h"
 #include "resource.h"
 #include "resource_resv.h"
 #include "pbs_share.h"
@@ -126,6 +144,46 @@
 static prev_job_info *last_running = NULL;
 static int last_running_size = 0;
 
+/* run requests queued by run_job() in throughput mode, see flush_run_jobs() */
+static char *pending_runs_jobids[RUN_JOB_BATCH_SIZE + 1];
+static char *pending_runs_execvnodes[RUN_JOB_BATCH_SIZE];
+static resource_resv *pending_runs_resresv[RUN_JOB_BATCH_SIZE];
+static int pending_runs_ct = 0;
+static int pending_runs_sd = -1;
+
+/* cached peer jobs run_job() moves and runs at the end of the cycle,
+ * see flush_peer_moves()
+ */
+static struct peer_move {
+	resource_resv *rjob;
+	char *dest;		/* queue@localserver */
+	char *execvnode;
+	int throughput;
+} *pending_moves = NULL;
+static int pending_moves_ct = 0;
+static int pending_moves_size = 0;
+
+/*
+ * A round of scheduling cycles (cycle_time_budget).  A cycle which uses up
+ * its budget yields, and the next cycle resumes the round.  It starts from
+ * a fresh query of the server, but passes over the jobs considered earlier
+ * in the round.  The round is over when a cycle gets to the end of the jobs.
+ */
+static struct {
+	char **considered;	/* jobs considered this round, sorted between cycles */
+	int num_considered;
+	int size_considered;
+	char **topjobs;		/* top jobs of this round, sorted between cycles */
+	int num_topjobs;
+	int size_topjobs;
+	int cycles;		/* cycles of the round which have yielded */
+	int yielded;		/* the last cycle yielded */
+} cycle_round;
+static void cycle_round_free(void);
+static void flush_peer_moves(int pbs_sd);
+/* set once the server rejects the Run Jobs request as unknown */
+static int asyrunjobs_unsupported = 0;
+
 #ifdef WIN32
 extern void win_toolong(void);
 #endif
@@ -162,8 +220,18 @@ schedinit(void)
 	PyObject *retval;
 #endif
 
+	/* The queued job cache and the node partition layouts are checked
+	 * against the server's data before use, and are kept across a
+	 * reconfigure so the next cycle is not a cold one.
+	 */
+	free_spec_cache();
+	free_topjob_estimates();
+	free_resresv_set_memo();
+	cycle_round_free();
 	init_config();
 	parse_config(CONFIG_FILE);
+	if (!conf.incr_query)
+		free_job_query_cache();
 
 	parse_holidays(HOLIDAYS_FILE);
 	time(&(cstat.current_time));
@@ -185,7 +253,7 @@ schedinit(void)
 	/* preload the static members to the fairshare tree */
 	conf.fairshare = preload_tree();
 	if (conf.fairshare != NULL) {
-		parse_group(RESGROUP_FILE, conf.fairshare->root);
+		parse_group(RESGROUP_FILE, conf.fairshare);
 		calc_fair_share_perc(conf.fairshare->root->child, UNSPECIFIED);
 		read_usage(USAGE_FILE, 0, conf.fairshare);
 
@@ -275,6 +343,98 @@ schedinit(void)
 	return 0;
 }
 
+/* header of the warm cache file */
+struct warm_cache_header {
+	char tag[8];		/* WARM_CACHE_MAGIC */
+	int version;		/* WARM_CACHE_VERSION */
+};
+
+/**
+ * @brief
+ *		save the state carried between cycles to the warm cache file, so
+ *		the first cycle after a restart of the scheduler can reuse it.
+ *		The file is written under a temporary name and renamed into place.
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
+ */
+int
+save_warm_cache(void)
+{
+	FILE *fp;
+	struct warm_cache_header head;
+	int rc;
+
+	if ((fp = fopen(WARM_CACHE_FILE ".new", "wb")) == NULL) {
+		log_err(errno, __func__, "Error opening " WARM_CACHE_FILE ".new");
+		return 0;
+	}
+
+	memset(&head, 0, sizeof(head));
+	memcpy(head.tag, WARM_CACHE_MAGIC, sizeof(head.tag));
+	head.version = WARM_CACHE_VERSION;
+	rc = write_cache_val(fp, &head, sizeof(head)) &&
+		write_cache_str(fp, pbs_conf.pbs_server_name) &&
+		save_node_partition_layouts(fp) &&
+		save_job_query_cache(fp);
+	if (fclose(fp) != 0)
+		rc = 0;
+
+	if (!rc || rename(WARM_CACHE_FILE ".new", WARM_CACHE_FILE) != 0) {
+		log_err(errno, __func__, "Error writing " WARM_CACHE_FILE);
+		(void) unlink(WARM_CACHE_FILE ".new");
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief
+ *		load the state saved by save_warm_cache() when the scheduler starts.
+ *		The file is removed once read so the state is used at most once.
+ *		Anything which does not match this scheduler's version or server
+ *		is ignored, and the first cycle builds everything from scratch.
+ *
+ * @return	int
+ * @retval	1	: the state was loaded
+ * @retval	0	: no usable warm cache file
+ */
+int
+load_warm_cache(void)
+{
+	FILE *fp;
+	struct warm_cache_header head;
+	char *svr_name = NULL;
+	int rc;
+
+	if ((fp = fopen(WARM_CACHE_FILE, "rb")) == NULL)
+		return 0;
+
+	rc = read_cache_val(fp, &head, sizeof(head)) &&
+		memcmp(head.tag, WARM_CACHE_MAGIC, sizeof(head.tag)) == 0 &&
+		head.version == WARM_CACHE_VERSION &&
+		read_cache_str(fp, &svr_name) &&
+		svr_name != NULL && pbs_conf.pbs_server_name != NULL &&
+		strcmp(svr_name, pbs_conf.pbs_server_name) == 0 &&
+		load_node_partition_layouts(fp) &&
+		(!conf.incr_query || load_job_query_cache(fp));
+	free(svr_name);
+	fclose(fp);
+	(void) unlink(WARM_CACHE_FILE);
+
+	if (!rc) {
+		free_node_partition_layouts();
+		free_job_query_cache();
+		log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_INFO, WARM_CACHE_FILE,
+			"Warm cache file not usable, starting cold");
+		return 0;
+	}
+	log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_INFO, WARM_CACHE_FILE,
+		"Loaded state saved by the previous scheduler");
+	return 1;
+}
+
 /**
  * @brief
  *		update global status structure which holds
@@ -317,6 +477,7 @@ update_cycle_status(struct status *policy, time_t current_time)
 		conf.ded_time[0].from = 0;
 		conf.ded_time[0].to = 0;
 		qsort(conf.ded_time, MAX_DEDTIME_SIZE, sizeof(struct timegap), cmp_ded_time);
+		build_ded_timeline();
 	}
 	policy->is_ded_time = dedtime;
 
@@ -415,7 +576,7 @@ init_scheduling_cycle(status *policy, int pbs_sd, server_info *sinfo)
 			for (i = 0; i < last_running_size ; i++) {
 				if (last_running[i].name != NULL) {
 					user = find_alloc_ginfo(last_running[i].entity_name,
-								sinfo->fairshare->root);
+								sinfo->fairshare);
 
 					if (user != NULL) {
 						for (j = 0; sinfo->running_jobs[j] != NULL &&
@@ -595,6 +756,7 @@ schedule(int cmd, int sd, char *runjobid)
 			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_INFO,
 				  "reconfigure", "Scheduler is reconfiguring");
 			reset_global_resource_ptrs();
+			reset_cycle_stats();
 			if(schedinit() != 0) {
 				return 0;
 			}
@@ -620,6 +782,164 @@ schedule(int cmd, int sd, char *runjobid)
 	return 0;
 }
 
+/**
+ * @brief
+ *		free the state of a round of cycles (cycle_time_budget)
+ *
+ * @return	void
+ */
+static void
+cycle_round_free(void)
+{
+	int i;
+
+	for (i = 0; i < cycle_round.num_considered; i++)
+		free(cycle_round.considered[i]);
+	free(cycle_round.considered);
+	for (i = 0; i < cycle_round.num_topjobs; i++)
+		free(cycle_round.topjobs[i]);
+	free(cycle_round.topjobs);
+	memset(&cycle_round, 0, sizeof(cycle_round));
+}
+
+/**
+ * @brief
+ *		add a job name to a list of a round of cycles.  The list is
+ *		sorted by cycle_round_sort() when the cycle yields.
+ *
+ * @param[in,out]	list	-	the list
+ * @param[in,out]	num	-	number of names in the list
+ * @param[in,out]	size	-	allocated size of the list
+ * @param[in]	name	-	name to add
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
+ */
+static int
+cycle_round_add(char ***list, int *num, int *size, char *name)
+{
+	char *dup;
+
+	if (*num == *size) {
+		int nsize = *size == 0 ? 64 : *size * 2;
+		char **tmp = realloc(*list, nsize * sizeof(char *));
+
+		if (tmp == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		*list = tmp;
+		*size = nsize;
+	}
+	if ((dup = string_dup(name)) == NULL)
+		return 0;
+	(*list)[(*num)++] = dup;
+	return 1;
+}
+
+/**
+ * @brief
+ *		compare two job names for qsort() and bsearch()
+ */
+static int
+cmp_cycle_round_name(const void *v1, const void *v2)
+{
+	return strcmp(*(char * const *) v1, *(char * const *) v2);
+}
+
+/**
+ * @brief
+ *		sort a list of a round of cycles and drop duplicate names
+ *
+ * @param[in,out]	list	-	the list
+ * @param[in,out]	num	-	number of names in the list
+ *
+ * @return	void
+ */
+static void
+cycle_round_sort(char **list, int *num)
+{
+	int i;
+	int j = 0;
+
+	if (*num == 0)
+		return;
+
+	qsort(list, *num, sizeof(char *), cmp_cycle_round_name);
+	for (i = 1; i < *num; i++) {
+		if (strcmp(list[i], list[j]) == 0)
+			free(list[i]);
+		else
+			list[++j] = list[i];
+	}
+	*num = j + 1;
+}
+
+/**
+ * @brief
+ *		is a job considered in every cycle of a round, even if it was
+ *		considered earlier in the round?  Jobs in express queues and
+ *		reservations, preempted and starving jobs, and the top jobs of
+ *		the round are.  Top jobs keep their place in the calendar that way.
+ *
+ * @param[in]	resresv	-	the job
+ *
+ * @return	int
+ * @retval	1	: yes
+ * @retval	0	: no
+ */
+static int
+cycle_round_exempt(resource_resv *resresv)
+{
+	job_info *job = resresv->job;
+
+	if (job == NULL)
+		return 1;
+	if (job->resv != NULL || job->is_preempted || job->is_starving)
+		return 1;
+	if (job->queue != NULL && job->queue->priority >= conf.preempt_queue_prio)
+		return 1;
+	if (cycle_round.num_topjobs > 0 &&
+		bsearch(&resresv->name, cycle_round.topjobs, cycle_round.num_topjobs,
+		sizeof(char *), cmp_cycle_round_name) != NULL)
+		return 1;
+	return 0;
+}
+
+/**
+ * @brief
+ *		resume a round of cycles: jobs considered earlier in the round
+ *		are marked as can not run, so next_job() passes over them.  They
+ *		are not evaluated, so their comments are left alone.
+ *
+ * @param[in]	sinfo	-	the server universe
+ *
+ * @return	void
+ */
+static void
+cycle_round_mark(server_info *sinfo)
+{
+	int i;
+	int skipped = 0;
+
+	for (i = 0; sinfo->jobs[i] != NULL; i++) {
+		resource_resv *resresv = sinfo->jobs[i];
+
+		if (resresv->can_not_run || cycle_round_exempt(resresv))
+			continue;
+		if (bsearch(&resresv->name, cycle_round.considered,
+			cycle_round.num_considered, sizeof(char *),
+			cmp_cycle_round_name) != NULL) {
+			resresv->can_not_run = 1;
+			skipped++;
+		}
+	}
+	log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+		"Resuming cycle %d of a round, %d jobs considered earlier in the round are skipped",
+		cycle_round.cycles + 1, skipped);
+}
+
 /**
  * @brief
  *		intermediate_schedule - responsible for starting/restarting scheduling
@@ -636,9 +956,15 @@ intermediate_schedule(int sd, char *jobid)
 {
 	int ret; /* to re schedule or not */
 	int cycle_cnt = 0; /* count of cycles run */
+	int resume;	/* resume a round of cycles which yielded */
 
 	do {
+		double start;
+
+		start = cycle_phase_start();
 		ret = scheduling_cycle(sd, jobid);
+		cycle_phase_stop(CPHASE_CYCLE, start);
+		publish_cycle_stats(sd);
 
 		/* don't restart cycle if :- */
 
@@ -654,6 +980,13 @@ intermediate_schedule(int sd, char *jobid)
 		if (got_sigpipe)
 			break;
 
+		/* A cycle which used up its cycle_time_budget is resumed right away.
+		 * This is not a restart, the round ends by itself.
+		 */
+		resume = (ret != -1 && cycle_round.yielded);
+		if (resume)
+			continue;
+
 		/* 3) max allowed number of cycles have already been run,
 		 *    there can be total of 1 + MAX_RESTART_CYCLECNT cycles
 		 */
@@ -662,7 +995,7 @@ intermediate_schedule(int sd, char *jobid)
 
 		cycle_cnt++;
 	}
-	while (ret == -1);
+	while (ret == -1 || resume);
 
 	return 0;
 }
@@ -689,10 +1022,14 @@ scheduling_cycle(int sd, char *jobid)
 	int error = 0;			/* error happened, don't run main loop */
 	status *policy;			/* policy structure used for cycle */
 	schd_error *err = NULL;
+	double start;
+	int sub = 0;			/* partitions were scheduled in sub-cycles */
 
 	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
 		  "", "Starting Scheduling Cycle");
 
+	cycle_round.yielded = 0;
+
 	update_cycle_status(&cstat, 0);
 
 #ifdef NAS /* localmod 030 */
@@ -700,9 +1037,13 @@ scheduling_cycle(int sd, char *jobid)
 	do_hard_cycle_interrupt = 0;
 #endif /* localmod 030 */
 	/* create the server / queue / job / node structures */
-	if ((sinfo = query_server(&cstat, sd)) == NULL) {
+	start = cycle_phase_start();
+	sinfo = query_server(&cstat, sd);
+	cycle_phase_stop(CPHASE_QUERY, start);
+	if (sinfo == NULL) {
 		log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_NOTICE,
 			  "", "Problem with creating server data structure");
+		flush_job_updates(sd);
 		end_cycle_tasks(sinfo);
 		return 0;
 	}
@@ -718,6 +1059,7 @@ scheduling_cycle(int sd, char *jobid)
 			 * further in the scheduling cycle since we don't have the up to date
 			 * information about the newly confirmed reservations
 			 */
+			flush_job_updates(sd);
 			end_cycle_tasks(sinfo);
 			/* Problem occurred confirming reservation, retry cycle */
 			if (rc < 0)
@@ -749,6 +1091,7 @@ scheduling_cycle(int sd, char *jobid)
 	if (init_scheduling_cycle(policy, sd, sinfo) == 0) {
 		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
 			sinfo->name, "init_scheduling_cycle failed.");
+		flush_job_updates(sd);
 		end_cycle_tasks(sinfo);
 		return 0;
 	}
@@ -765,8 +1108,30 @@ scheduling_cycle(int sd, char *jobid)
 	}
 
 	/* run loop run */
-	if (error == 0)
-		rc = main_sched_loop(policy, sd, sinfo, &err);
+	if (error == 0) {
+		/* a qrun'd job is always evaluated, and what a qrun cycle does is
+		 * not kept for the next cycle
+		 */
+		if (sinfo->qrun_job == NULL)
+			apply_resresv_set_memo(sinfo);
+		start = cycle_phase_start();
+		sub = partition_sub_cycles(policy, sd, sinfo);
+		if (sub == 0)
+			rc = main_sched_loop(policy, sd, sinfo, &err);
+		else if (sub < 0)
+			rc = -1;
+		cycle_phase_stop(CPHASE_MAIN_LOOP, start);
+		/* what the sub-cycles found is not in this universe */
+		if (sub != 0)
+			free_resresv_set_memo();
+		else if (sinfo->qrun_job == NULL)
+			save_resresv_set_memo(sinfo);
+	}
+
+	/* send the run requests and job attribute updates queued during the cycle */
+	flush_peer_moves(sd);
+	flush_run_jobs(sd);
+	flush_job_updates(sd);
 
 	if (jobid != NULL) {
 		int def_rc = -1;
@@ -863,6 +1228,10 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 	int sort_again = DONT_SORT_JOBS;
 	schd_error *err;
 	schd_error *chk_lim_err;
+	int in_round;			/* cycle is part of a round (cycle_time_budget) */
+	int budget = 0;			/* ms this cycle may take before it yields */
+	int yielded = 0;		/* the cycle used up its budget */
+	double loop_start;
 	
 
 	if (policy == NULL || sinfo == NULL || rerr == NULL)
@@ -872,6 +1241,20 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 	/* calculate the time which we've been in the cycle too long */
 	cycle_end_time = cycle_start_time + sinfo->sched_cycle_len;
 
+	/* Skipping a job which blocks the rest with strict_ordering and no
+	 * backfilling would let the rest run, so such cycles don't yield.  The
+	 * last cycle of a round doesn't yield either.
+	 */
+	in_round = conf.cycle_time_budget > 0 && sinfo->qrun_job == NULL;
+	if (in_round) {
+		if (cycle_round.cycles > 0)
+			cycle_round_mark(sinfo);
+		if (!(policy->strict_ordering && !policy->backfill) &&
+			cycle_round.cycles < CYCLE_ROUND_MAX_CYCLES - 1)
+			budget = conf.cycle_time_budget;
+	}
+	loop_start = cycle_phase_start();
+
 	chk_lim_err = new_schd_error();
 	if(chk_lim_err == NULL)
 		return -1;
@@ -953,7 +1336,13 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 				free_nspecs(ns_arr);
 		}
 		else if (policy->preempting && in_runnable_state(njob) && (!njob -> can_never_run)) {
-			if (find_and_preempt_jobs(policy, sd, njob, sinfo, err) > 0) {
+			int preempt_rc;
+			double start;
+
+			start = cycle_phase_start();
+			preempt_rc = find_and_preempt_jobs(policy, sd, njob, sinfo, err);
+			cycle_phase_stop(CPHASE_PREEMPT, start);
+			if (preempt_rc > 0) {
 				rc = SUCCESS;
 				sort_again = MUST_RESORT_JOBS;
 			}
@@ -987,9 +1376,16 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 			sort_again = SORTED;
 			if (should_backfill_with_job(policy, sinfo, njob, num_topjobs) != 0) {
 #endif
+				double start;
+
+				start = cycle_phase_start();
 				cal_rc = add_job_to_calendar(sd, policy, sinfo, njob, should_use_buckets);
+				cycle_phase_stop(CPHASE_CALENDAR, start);
 
 				if (cal_rc > 0) { /* Success! */
+					if (in_round)
+						(void) cycle_round_add(&cycle_round.topjobs, &cycle_round.num_topjobs,
+							&cycle_round.size_topjobs, njob->name);
 #ifdef NAS /* localmod 034 */
 					switch(bf_rc)
 					{
@@ -1117,6 +1513,18 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 			log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_INFO, "", 
 				"Bailed out of main job loop after checking to see if %d jobs could run.", (i + 1));
 		}
+		if (in_round) {
+			(void) cycle_round_add(&cycle_round.considered, &cycle_round.num_considered,
+				&cycle_round.size_considered, njob->name);
+			if (budget > 0 && !end_cycle &&
+				(cycle_phase_start() - loop_start) * 1000 >= budget) {
+				end_cycle = 1;
+				yielded = 1;
+				log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_INFO, __func__,
+					"Yielding the scheduling cycle after %d jobs: %s of %d ms used up",
+					i + 1, PARSE_CYCLE_TIME_BUDGET, budget);
+			}
+		}
 
 		if (!end_cycle) {
 			if (second_connection != -1) {
@@ -1147,6 +1555,20 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 		send_job_updates(sd, njob);
 	}
 
+	if (in_round) {
+		if (yielded) {
+			cycle_round_sort(cycle_round.considered, &cycle_round.num_considered);
+			cycle_round_sort(cycle_round.topjobs, &cycle_round.num_topjobs);
+			cycle_round.cycles++;
+			cycle_round.yielded = 1;
+		} else {
+			if (cycle_round.cycles > 0)
+				log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+					"Finished a round of %d scheduling cycles", cycle_round.cycles + 1);
+			cycle_round_free();
+		}
+	}
+
 	*rerr = err;
 
 	free_schd_error(chk_lim_err);
@@ -1166,11 +1588,16 @@ void
 end_cycle_tasks(server_info *sinfo)
 {
 	int i;
+	double start;
+
+	start = cycle_phase_start();
 
 	/* keep track of update used resources for fairshare */
 	if (sinfo != NULL && sinfo->policy->fair_share)
 		update_last_running(sinfo);
 
+	log_calendar_stats();
+
 	/* we copied in conf.fairshare into sinfo at the start of the cycle,
 	 * we don't want to free it now, or we'd lose all fairshare data
 	 */
@@ -1178,6 +1605,8 @@ end_cycle_tasks(server_info *sinfo)
 		sinfo->fairshare = NULL;
 		free_server(sinfo);	/* free server and queues and jobs */
 	}
+	age_spec_cache();
+	age_topjob_estimates();
 
 	/* close any open connections to peers */
 	for (i = 0; (i < NUM_PEERS) &&
@@ -1197,6 +1626,7 @@ end_cycle_tasks(server_info *sinfo)
 	}
 
 	got_sigpipe = 0;
+	cycle_phase_stop(CPHASE_END_CYCLE, start);
 	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
 		"", "Leaving Scheduling Cycle");
 }
@@ -1283,16 +1713,422 @@ update_job_can_not_run(int pbs_sd, resource_resv *job, schd_error *err)
 	return ret;
 }
 
+/**
+ * @brief
+ * 		queue an asynchronous run request for a job to be sent to the
+ *		server with the next flush_run_jobs()
+ *
+ * @param[in]	pbs_sd	-	pbs connection descriptor to the LOCAL server
+ * @param[in]	rjob	-	the job to run
+ * @param[in]	execvnode	-	the execvnode to run the job on
+ *
+ * @return	int
+ * @retval	0	: the job was queued (or sent right away)
+ * @retval	!0	: pbs error code from sending the run request
+ */
+static int
+queue_run_job(int pbs_sd, resource_resv *rjob, char *execvnode)
+{
+	char *vn = NULL;
+
+	if (asyrunjobs_unsupported)
+		return pbs_asyrunjob(pbs_sd, rjob->name, execvnode, NULL);
+
+	/* the runs queued so far were for another connection */
+	if (pending_runs_ct > 0 && pbs_sd != pending_runs_sd)
+		flush_run_jobs(pending_runs_sd);
+
+	if (execvnode != NULL) {
+		/* execvnode is create_execvnode()'s static buffer */
+		vn = string_dup(execvnode);
+		if (vn == NULL)
+			return pbs_asyrunjob(pbs_sd, rjob->name, execvnode, NULL);
+	}
+
+	pending_runs_jobids[pending_runs_ct] = rjob->name;
+	pending_runs_execvnodes[pending_runs_ct] = vn;
+	pending_runs_resresv[pending_runs_ct] = rjob;
+	pending_runs_ct++;
+	pending_runs_sd = pbs_sd;
+
+	if (pending_runs_ct >= RUN_JOB_BATCH_SIZE)
+		flush_run_jobs(pbs_sd);
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 		forget the run requests queued by queue_run_job()
+ *
+ * @param[in]	count	-	number of queued requests
+ */
+static void
+free_pending_runs(int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		free(pending_runs_execvnodes[i]);
+		pending_runs_execvnodes[i] = NULL;
+		pending_runs_jobids[i] = NULL;
+		pending_runs_resresv[i] = NULL;
+	}
+}
+
+/**
+ * @brief
+ * 		send the run requests queued by queue_run_job() to the server
+ *
+ * @par
+ *		The jobs were already accounted for as running.  A job the server
+ *		fails to run is handled like a job which could not run: its
+ *		comment is updated and it is not looked at again this cycle.
+ *		If the server does not know the Run Jobs request, each job is
+ *		sent with pbs_asyrunjob() instead.
+ *
+ * @param[in]	pbs_sd	-	server connection descriptor the runs were
+ *				queued for
+ *
+ * @return	int
+ * @retval	1	- success (or nothing to send)
+ * @retval	0	- at least one job failed to run
+ */
+int
+flush_run_jobs(int pbs_sd)
+{
+	job_err_info *pje = NULL;
+	schd_error *err;
+	char buf[MAX_LOG_SIZE];
+	char *errbuf;
+	int count = pending_runs_ct;
+	int errcode;
+	int rc = 1;
+	int i;
+	double start;
+
+	if (count == 0)
+		return 1;
+
+	/* a failure below updates the job, which may flush the job updates
+	 * and come back here.  There is nothing left to send then.
+	 */
+	pending_runs_ct = 0;
+
+	/* our connection to the server is gone, no sense trying to send */
+	if (got_sigpipe || pbs_sd != pending_runs_sd) {
+		free_pending_runs(count);
+		return 0;
+	}
+
+	err = new_schd_error();
+	if (err == NULL) {
+		free_pending_runs(count);
+		return 0;
+	}
+
+	start = cycle_phase_start();
+	pending_runs_jobids[count] = NULL;
+	pje = pbs_asyrunjobs(pbs_sd, pending_runs_jobids, pending_runs_execvnodes);
+	if (pje == NULL && pbs_errno == PBSE_UNKREQ) {
+		asyrunjobs_unsupported = 1;
+		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"Server does not support batched run requests, sending them one job at a time");
+	}
+	cycle_phase_stop(CPHASE_RUN_JOB, start);
+
+	for (i = 0; i < count && !got_sigpipe; i++) {
+		if (pje != NULL) {
+			errcode = pje[i].errcode;
+			errbuf = pbse_to_txt(errcode);
+		} else {
+			start = cycle_phase_start();
+			errcode = pbs_asyrunjob(pbs_sd, pending_runs_jobids[i],
+				pending_runs_execvnodes[i], NULL);
+			cycle_phase_stop(CPHASE_RUN_JOB, start);
+			errbuf = pbs_geterrmsg(pbs_sd);
+		}
+		if (errcode == PBSE_NONE)
+			continue;
+
+		rc = 0;
+		if (errbuf == NULL)
+			errbuf = "";
+		clear_schd_error(err);
+		set_schd_error_codes(err, NOT_RUN, RUN_FAILURE);
+		set_schd_error_arg(err, ARG1, errbuf);
+		snprintf(buf, sizeof(buf), "%d", errcode);
+		set_schd_error_arg(err, ARG2, buf);
+#ifdef NAS /* localmod 031 */
+		set_schd_error_arg(err, ARG3, pending_runs_jobids[i]);
+#endif /* localmod 031 */
+		update_job_can_not_run(pbs_sd, pending_runs_resresv[i], err);
+	}
+
+	free(pje);
+	free_schd_error(err);
+	free_pending_runs(count);
+	return rc;
+}
+
+/**
+ * @brief
+ * 		send a run request a partition sub-cycle passed back.  The job
+ *		is queued for flush_run_jobs() like any job run in throughput
+ *		mode, so a failure updates its comment.
+ *
+ * @param[in]	pbs_sd	-	pbs connection descriptor to the LOCAL server
+ * @param[in]	sinfo	-	the universe the sub-cycle was forked from
+ * @param[in]	jobid	-	the job to run
+ * @param[in]	execvnode	-	the execvnode to run the job on
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	!0	: pbs error code from sending the run request
+ */
+int
+send_sub_cycle_run(int pbs_sd, server_info *sinfo, char *jobid, char *execvnode)
+{
+	resource_resv *rjob;
+	int rc;
+
+	rjob = find_resource_resv(sinfo->jobs, jobid);
+	if (rjob != NULL)
+		return queue_run_job(pbs_sd, rjob, execvnode);
+
+	rc = pbs_asyrunjob(pbs_sd, jobid, execvnode, NULL);
+	if (rc != 0)
+		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_WARNING, jobid,
+			"Failed to run job: %s (%d)", pbs_geterrmsg(pbs_sd), rc);
+	return rc;
+}
+
+/**
+ * @brief
+ * 		send or queue the run request of a job.  A partition sub-cycle
+ *		passes it back to the scheduler which forked it instead.
+ *
+ * @param[in]	pbs_sd	-	pbs connection descriptor to the LOCAL server
+ * @param[in]	rjob	-	the job to run
+ * @param[in]	execvnode	-	the execvnode to run the job on
+ * @param[in]	throughput	-	thoughput mode enabled?
+ * @param[in]	batch	-	in throughput mode, queue the run request
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	!0	: failure
+ */
+static int
+send_run_request(int pbs_sd, resource_resv *rjob, char *execvnode, int throughput, int batch)
+{
+	if (sub_cycle_child())
+		return sub_cycle_put_run(rjob->name, execvnode);
+	if (throughput && batch)
+		return queue_run_job(pbs_sd, rjob, execvnode);
+	if (throughput)
+		return pbs_asyrunjob(pbs_sd, rjob->name, execvnode, NULL);
+	return pbs_runjob(pbs_sd, rjob->name, execvnode, NULL);
+}
+
+/**
+ * @brief
+ * 		send the run request of a job which is on the local server
+ *
+ * @param[in]	pbs_sd	-	pbs connection descriptor to the LOCAL server
+ * @param[in]	rjob	-	the job to run
+ * @param[in]	execvnode	-	the execvnode to run the job on
+ * @param[in]	throughput	-	thoughput mode enabled?
+ * @param[in]	batch	-	in throughput mode, queue the run request to
+ *				be sent with others by flush_run_jobs()
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	!0	: failure
+ */
+static int
+send_run_job(int pbs_sd, resource_resv *rjob, char *execvnode, int throughput, int batch)
+{
+	int rc;
+	double start;
+
+	start = cycle_phase_start();
+	if (rjob->is_shrink_to_fit) {
+		char timebuf[TIMEBUF_SIZE] = {0};
+		rc = 1;
+		/* The job is set to run, update it's walltime only if it is not a foerever job */
+		if (rjob->duration != JOB_INFINITY) {
+			convert_duration_to_str(rjob->duration, timebuf, TIMEBUF_SIZE);
+			rc = update_job_attr(pbs_sd, rjob, ATTR_l, "walltime", timebuf, NULL, UPDATE_NOW);
+		}
+		if (rc > 0) {
+			if (strlen(timebuf) > 0)
+				log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_NOTICE, rjob->name, 
+					"Job will run for duration=%s", timebuf);
+			rc = send_run_request(pbs_sd, rjob, execvnode, throughput, batch);
+		}
+	} else
+		rc = send_run_request(pbs_sd, rjob, execvnode, throughput, batch);
+	cycle_phase_stop(CPHASE_RUN_JOB, start);
+
+	return rc;
+}
+
+/**
+ * @brief
+ * 		queue a job of a cached peer queue to be moved to the local
+ *		server and run by flush_peer_moves()
+ *
+ * @param[in]	rjob	-	the job to move and run
+ * @param[in]	dest	-	queue@localserver to move the job to
+ * @param[in]	execvnode	-	the execvnode to run the job on
+ * @param[in]	throughput	-	thoughput mode enabled?
+ *
+ * @return	int
+ * @retval	1	: the job was queued
+ * @retval	0	: on error
+ */
+static int
+queue_peer_move(resource_resv *rjob, char *dest, char *execvnode, int throughput)
+{
+	struct peer_move *pm;
+
+	if (pending_moves_ct == pending_moves_size) {
+		int size = pending_moves_size == 0 ? RUN_JOB_BATCH_SIZE : pending_moves_size * 2;
+
+		if ((pm = realloc(pending_moves, size * sizeof(struct peer_move))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		pending_moves = pm;
+		pending_moves_size = size;
+	}
+
+	pm = &pending_moves[pending_moves_ct];
+	pm->rjob = rjob;
+	pm->throughput = throughput;
+	pm->dest = string_dup(dest);
+	/* execvnode is create_execvnode()'s static buffer */
+	pm->execvnode = execvnode != NULL ? string_dup(execvnode) : NULL;
+	if (pm->dest == NULL || (execvnode != NULL && pm->execvnode == NULL)) {
+		free(pm->dest);
+		free(pm->execvnode);
+		return 0;
+	}
+	pending_moves_ct++;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		move the peer jobs queued by queue_peer_move() to the local server
+ *		and run them
+ *
+ * @par
+ *		The moves to each peer are sent one after the other on a single
+ *		connection to the peer.  Like with flush_run_jobs(), the jobs were
+ *		already accounted for as running.  A job which fails to move or run
+ *		is handled like a job which could not run.  The run requests go
+ *		through queue_run_job() in throughput mode, so call this before
+ *		flush_run_jobs().
+ *
+ * @param[in]	pbs_sd	-	pbs connection descriptor to the LOCAL server
+ *
+ * @return	void
+ */
+static void
+flush_peer_moves(int pbs_sd)
+{
+	struct {
+		char *server;
+		int sd;
+	} peers[NUM_PEERS];
+	int num_peers = 0;
+	struct peer_move *pm;
+	schd_error *err;
+	char buf[MAX_LOG_SIZE];
+	char *errbuf;
+	char *server;
+	int peer_sd;
+	int count = pending_moves_ct;
+	int rc;
+	int i;
+	int j;
+
+	if (count == 0)
+		return;
+	pending_moves_ct = 0;
+
+	err = new_schd_error();
+	for (i = 0; i < count; i++) {
+		pm = &pending_moves[i];
+		peer_sd = -1;
+		rc = 1;
+		errbuf = NULL;
+
+		if (!got_sigpipe && err != NULL &&
+			(server = find_peer_job_server(pm->rjob->name)) != NULL) {
+			for (j = 0; j < num_peers && strcmp(peers[j].server, server); j++)
+				;
+			if (j == num_peers && num_peers < NUM_PEERS) {
+				peers[j].server = server;
+				peers[j].sd = pbs_connect_noblk(server, 2);
+				num_peers++;
+			}
+			if (j < num_peers)
+				peer_sd = peers[j].sd;
+		}
+
+		if (peer_sd >= 0) {
+			rc = pbs_movejob(peer_sd, pm->rjob->name, pm->dest, NULL);
+			if (rc)
+				errbuf = pbs_geterrmsg(peer_sd);
+			else {
+				/* the job is a local job now, see run_job() */
+				pm->rjob->is_peer_ob = 0;
+				forget_peer_job(pm->rjob->name);
+				rc = send_run_job(pbs_sd, pm->rjob, pm->execvnode, pm->throughput, 1);
+				if (rc)
+					errbuf = pbs_geterrmsg(pbs_sd);
+			}
+		} else if (!got_sigpipe)
+			errbuf = "Can not connect to peer server";
+
+		if (rc && err != NULL && !got_sigpipe) {
+			clear_schd_error(err);
+			set_schd_error_codes(err, NOT_RUN, RUN_FAILURE);
+			set_schd_error_arg(err, ARG1, errbuf != NULL ? errbuf : "");
+			snprintf(buf, sizeof(buf), "%d", pbs_errno);
+			set_schd_error_arg(err, ARG2, buf);
+#ifdef NAS /* localmod 031 */
+			set_schd_error_arg(err, ARG3, pm->rjob->name);
+#endif /* localmod 031 */
+			update_job_can_not_run(pbs_sd, pm->rjob, err);
+		}
+		free(pm->dest);
+		free(pm->execvnode);
+	}
+
+	for (j = 0; j < num_peers; j++)
+		if (peers[j].sd >= 0)
+			pbs_disconnect(peers[j].sd);
+	free_schd_error(err);
+}
+
 /**
  * @brief
  * 		run_job - handle the running of a pbs job.  If it's a peer job
  *	       first move it to the local server and then run it.
- *	       if it's a local job, just run it.
+ *	       if it's a local job, just run it.  A job of a cached peer queue
+ *	       (peer_query_refresh) is moved and run at the end of the cycle
+ *	       unless it has to be run now.
  *
  * @param[in]	pbs_sd	-	pbs connection descriptor to the LOCAL server
  * @param[in]	rjob	-	the job to run
  * @param[in]	execvnode	-	the execvnode to run a multi-node job on
  * @param[in]	throughput	-	thoughput mode enabled?
+ * @param[in]	batch	-	in throughput mode, queue the run request to
+ *				be sent with others by flush_run_jobs()
  * @param[out]	err	-	error struct to return errors
  *
  * @retval	0	: success
@@ -1300,10 +2136,12 @@ update_job_can_not_run(int pbs_sd, resource_resv *job, schd_error *err)
  * @retval -1	: error
  */
 int
-run_job(int pbs_sd, resource_resv *rjob, char *execvnode, int throughput, schd_error *err)
+run_job(int pbs_sd, resource_resv *rjob, char *execvnode, int throughput, int batch, schd_error *err)
 {
 	char buf[100];	/* used to assemble queue@localserver */
 	char *errbuf;		/* comes from pbs_geterrmsg() */
+	char *server;
+	int peer_sd;
 	int rc = 0;
 
 	if (rjob == NULL || rjob->job == NULL || err == NULL)
@@ -1329,7 +2167,21 @@ run_job(int pbs_sd, resource_resv *rjob, char *execvnode, int throughput, schd_e
 				rjob->server->name);
 		}
 
-		rc = pbs_movejob(rjob->job->peer_sd, rjob->name, buf, NULL);
+		if (rjob->job->peer_sd >= 0)
+			rc = pbs_movejob(rjob->job->peer_sd, rjob->name, buf, NULL);
+		else if (batch && queue_peer_move(rjob, buf, execvnode, throughput))
+			return 0;
+		else {
+			/* no connection to the peer is kept for cached peer queues */
+			rc = 1;
+			if ((server = find_peer_job_server(rjob->name)) != NULL &&
+				(peer_sd = pbs_connect_noblk(server, 2)) >= 0) {
+				rc = pbs_movejob(peer_sd, rjob->name, buf, NULL);
+				pbs_disconnect(peer_sd);
+				if (rc == 0)
+					forget_peer_job(rjob->name);
+			}
+		}
 
 		/*
 		 * After successful transfer of the peer job to local server,
@@ -1340,31 +2192,8 @@ run_job(int pbs_sd, resource_resv *rjob, char *execvnode, int throughput, schd_e
 			rjob->is_peer_ob = 0;
 	}
 
-	if (!rc) {
-		if (rjob->is_shrink_to_fit) {
-			char timebuf[TIMEBUF_SIZE] = {0};
-			rc = 1;
-			/* The job is set to run, update it's walltime only if it is not a foerever job */
-			if (rjob->duration != JOB_INFINITY) {
-				convert_duration_to_str(rjob->duration, timebuf, TIMEBUF_SIZE);
-				rc = update_job_attr(pbs_sd, rjob, ATTR_l, "walltime", timebuf, NULL, UPDATE_NOW);
-			}
-			if (rc > 0) {
-				if (strlen(timebuf) > 0)
-					log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_NOTICE, rjob->name, 
-						"Job will run for duration=%s", timebuf);
-				if (throughput)
-					rc = pbs_asyrunjob(pbs_sd, rjob->name, execvnode, NULL);
-				else
-					rc = pbs_runjob(pbs_sd, rjob->name, execvnode, NULL);
-			}
-		} else {
-			if (throughput)
-				rc = pbs_asyrunjob(pbs_sd, rjob->name, execvnode, NULL);
-			else
-				rc = pbs_runjob(pbs_sd, rjob->name, execvnode, NULL);
-		}
-	}
+	if (!rc)
+		rc = send_run_job(pbs_sd, rjob, execvnode, throughput, batch);
 
 	if (rc) {
 		char buf[MAX_LOG_SIZE];
@@ -1606,7 +2435,9 @@ run_update_resresv(status *policy, int pbs_sd, server_info *sinfo,
 					fflush(stdout);
 #endif /* localmod 031 */
 
-					pbsrc = run_job(pbs_sd, rr, execvnode, sinfo->throughput_mode, err);
+					/* a qrun is answered with the result of the run, so don't batch it */
+					pbsrc = run_job(pbs_sd, rr, execvnode, sinfo->throughput_mode,
+						!(flags & RURR_RUN_NOW) && sinfo->qrun_job == NULL, err);
 
 #ifdef NAS_CLUSTER /* localmod 125 */
 					ret = translate_runjob_return_code(pbsrc, resresv);
@@ -1923,12 +2754,13 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 	resource_resv *njob;		/* the topjob in the dup'd universe */
 	resource_resv *bjob;		/* job pointer which becomes the topjob*/
 	resource_resv *tjob;		/* temporary job pointer for job arrays */
-	time_t start_time;		/* calculated start time of topjob */
-	char *exec;			/* used to hold execvnode for topjob */
+	time_t start_time = 0;		/* calculated start time of topjob */
+	char *exec = NULL;		/* used to hold execvnode for topjob */
 	timed_event *te_start;	/* start event for topjob */
 	timed_event *te_end;		/* end event for topjob */
 	timed_event *nexte;
 	char log_buf[MAX_LOG_SIZE];
+	int est_same;			/* server already has this estimate */
 	int i;
 
 	if (policy == NULL || sinfo == NULL ||
@@ -1943,26 +2775,39 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 		if (find_timed_event(nexte, IGNORE_DISABLED_EVENTS, topjob->name, TIMED_NOEVENT, 0) != NULL)
 			return 1;
 	}
-	if ((nsinfo = dup_server_info(sinfo)) == NULL)
-		return 0;
+	/* If nothing the last estimate depends on has changed, we don't need to
+	 * simulate the calendar again.  nsinfo stays NULL in that case.
+	 */
+	nsinfo = NULL;
+	njob = NULL;
+	if (conf.incr_calendar)
+		exec = find_topjob_estimate(sinfo, topjob, use_buckets, &start_time);
+
+	if (exec != NULL)
+		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+			topjob->name, "Reusing the start time estimate of a top job.");
+	else {
+		if ((nsinfo = dup_server_info(sinfo)) == NULL)
+			return 0;
 
-	if ((njob = find_resource_resv_by_indrank(nsinfo->jobs, topjob->rank, topjob->resresv_ind)) == NULL) {
-		free_server(nsinfo);
-		return 0;
-	}
+		if ((njob = find_resource_resv_by_indrank(nsinfo->jobs, topjob->rank, topjob->resresv_ind)) == NULL) {
+			free_server(nsinfo);
+			return 0;
+		}
 
 	
 #ifdef NAS /* localmod 031 */
-	log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
-		   topjob->name, "Estimating the start time for a top job (q=%s schedselect=%.1000s).", topjob->job->queue->name, topjob->job->schedsel);
+		log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+			   topjob->name, "Estimating the start time for a top job (q=%s schedselect=%.1000s).", topjob->job->queue->name, topjob->job->schedsel);
 #else
-	log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
-		topjob->name, "Estimating the start time for a top job.");
+		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+			topjob->name, "Estimating the start time for a top job.");
 #endif /* localmod 031 */
-	if(use_buckets)
-		start_time = calc_run_time(njob->name, nsinfo, SIM_RUN_JOB|USE_BUCKETS);
-	else
-		start_time = calc_run_time(njob->name, nsinfo, SIM_RUN_JOB);
+		if(use_buckets)
+			start_time = calc_run_time(njob->name, nsinfo, SIM_RUN_JOB|USE_BUCKETS);
+		else
+			start_time = calc_run_time(njob->name, nsinfo, SIM_RUN_JOB);
+	}
 
 	if (start_time > 0) {
 		/* If our top job is a job array, we don't backfill around the
@@ -1978,12 +2823,14 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 			}
 
 			/* Can't search by rank, we just created tjob and it has a new rank*/
-			njob = find_resource_resv(nsinfo->jobs, tjob->name);
-			if (njob == NULL) {
-				log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_DEBUG, __func__,
-					"Can't find new subjob in simulated universe");
-				free_server(nsinfo);
-				return 0;
+			if (nsinfo != NULL) {
+				njob = find_resource_resv(nsinfo->jobs, tjob->name);
+				if (njob == NULL) {
+					log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_DEBUG, __func__,
+						"Can't find new subjob in simulated universe");
+					free_server(nsinfo);
+					return 0;
+				}
 			}
 			/* The subjob is just for the calendar, not for running */
 			tjob->can_not_run = 1;
@@ -1993,7 +2840,12 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 
 
 
-		exec = create_execvnode(njob->nspec_arr);
+		if (exec == NULL) {
+			exec = create_execvnode(njob->nspec_arr);
+			/* Our own events aren't in the calendar yet */
+			if (exec != NULL && conf.incr_calendar)
+				save_topjob_estimate(sinfo, topjob, use_buckets, start_time, exec);
+		}
 		if (exec != NULL) {
 #ifdef NAS /* localmod 068 */
 			/* debug dpr - Log vnodes reserved for job */
@@ -2029,6 +2881,19 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 		}
 
 
+		/*
+		 * The server's estimate was read with the job; it is only worth
+		 * replacing if it moved beyond estimated_start_time_threshold.
+		 * A subjob's estimate is kept on its parent array, so always
+		 * send those.
+		 */
+		est_same = !bjob->job->is_subjob &&
+			bjob->job->est_execvnode != NULL &&
+			bjob->job->est_start_time != UNSPECIFIED &&
+			labs((long)(bjob->job->est_start_time - start_time)) <=
+			conf.est_start_threshold &&
+			strcmp(bjob->job->est_execvnode, exec) == 0;
+
 		if (bjob->job->est_execvnode != NULL)
 			free(bjob->job->est_execvnode);
 		bjob->job->est_execvnode = string_dup(exec);
@@ -2050,8 +2915,8 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 		}
 		add_event(sinfo->calendar, te_end);
 
-		if (update_estimated_attrs(pbs_sd, bjob, bjob->job->est_start_time,
-			bjob->job->est_execvnode, 0) <0) {
+		if (!est_same && update_estimated_attrs(pbs_sd, bjob,
+			bjob->job->est_start_time, bjob->job->est_execvnode, 0) < 0) {
 			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING,
 				bjob->name, "Failed to update estimated attrs.");
 		}
@@ -50,6 +50,13 @@ int connector;
  */
 int schedinit(void);
 
+/*
+ *      save_warm_cache - save the state kept between cycles for the next run
+ *      load_warm_cache - load the state saved by the previous run
+ */
+int save_warm_cache(void);
+int load_warm_cache(void);
+
 /*
  *      schedule - this function gets called to start each scheduling cycle
  *                 It will handle the difference cases that caused a
@@ -139,6 +146,7 @@ int sim_run_update_resresv(status *policy, resource_resv *resresv, nspec **ns_ar
  *	  rresv  - the job/reservation to run
  *	  flags  - flags to modify procedure
  *		RURR_ADD_END_EVENT - add an end event to calendar for this job
+ *		RURR_RUN_NOW - don't batch the run request in throughput mode
  *
  *	return 1 for success
  *	return 0 for failure (see pbs_errno for more info)
@@ -174,7 +182,19 @@ int add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo, resource
  *	       first move it to the local server and then run it.
  *	       if it's a local job, just run it.
  */
-int run_job(int pbs_sd, resource_resv *rjob, char *execvnode, int throughput, schd_error *err);
+int run_job(int pbs_sd, resource_resv *rjob, char *execvnode, int throughput, int batch, schd_error *err);
+
+/*
+ *	flush_run_jobs - send the run requests queued by run_job() in
+ *			 throughput mode to the server
+ */
+int flush_run_jobs(int pbs_sd);
+
+/*
+ *	send_sub_cycle_run - send a run request a partition sub-cycle
+ *			     passed back
+ */
+int send_sub_cycle_run(int pbs_sd, server_info *sinfo, char *jobid, char *execvnode);
 
 /*
  *	should_backfill_with_job - should we call add_job_to_calendar() with job
@@ -0,0 +1,718 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+/**
+ * @file    formula.c
+ *
+ * @brief
+ * 		formula.c - compile and evaluate job_sort_formula and fairshare_usage_res
+ *		without the python interpreter.
+ *
+ *	Formulas made only of numbers, consumable resource names, the formula
+ *	keywords (e.g. eligible_time), + - * / // % ** and parentheses are
+ *	compiled once into a postfix program and evaluated natively for each
+ *	job.  Anything else (function calls, comparisons, unknown names, ...)
+ *	is left to python by formula_evaluate().
+ *
+ * Functions included are:
+ * 	new_formula_expr()
+ * 	free_formula_expr()
+ * 	formula_emit()
+ * 	formula_skip_space()
+ * 	formula_parse_expr()
+ * 	formula_parse_term()
+ * 	formula_parse_factor()
+ * 	formula_parse_power()
+ * 	formula_parse_atom()
+ * 	compile_formula()
+ * 	find_compiled_formula()
+ * 	free_formula_cache()
+ * 	formula_rounded()
+ * 	formula_native_evaluate()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <errno.h>
+#include <log.h>
+#include <libutil.h>
+#include <pbs_share.h>
+#include "formula.h"
+#include "constant.h"
+#include "config.h"
+#include "globals.h"
+#include "resource.h"
+#include "resource_resv.h"
+#include "fairshare.h"
+#include "misc.h"
+
+/* operations of a compiled formula */
+enum formula_op {
+	FOP_CONST,		/* push val */
+	FOP_RES,		/* push the amount of def requested */
+	FOP_ELIGIBLE_TIME,
+	FOP_QUEUE_PRIO,
+	FOP_JOB_PRIO,
+	FOP_FSPERC,
+	FOP_TREE_USAGE,
+	FOP_FSFACTOR,
+	FOP_ACCRUE_TYPE,
+	FOP_NEG,
+	FOP_ADD,
+	FOP_SUB,
+	FOP_MUL,
+	FOP_DIV,
+	FOP_FLOORDIV,
+	FOP_MOD,
+	FOP_POW
+};
+
+struct formula_insn {
+	enum formula_op op;
+	double val;		/* FOP_CONST */
+	resdef *def;		/* FOP_RES */
+};
+
+typedef struct formula_expr {
+	struct formula_insn *prog;	/* postfix program */
+	int len;			/* number of instructions */
+	int size;			/* allocated instructions */
+	int depth;			/* current stack depth while compiling */
+	int max_depth;			/* stack needed to evaluate */
+	const char *pos;		/* parse position while compiling */
+	int err;			/* can't be compiled */
+} formula_expr;
+
+/* formula keywords and the operation which gets their value */
+static const struct {
+	const char *name;
+	enum formula_op op;
+} formula_keywords[] = {
+	{FORMULA_ELIGIBLE_TIME, FOP_ELIGIBLE_TIME},
+	{FORMULA_QUEUE_PRIO, FOP_QUEUE_PRIO},
+	{FORMULA_JOB_PRIO, FOP_JOB_PRIO},
+	{FORMULA_FSPERC, FOP_FSPERC},
+	{FORMULA_FSPERC_DEP, FOP_FSPERC},
+	{FORMULA_TREE_USAGE, FOP_TREE_USAGE},
+	{FORMULA_FSFACTOR, FOP_FSFACTOR},
+	{FORMULA_ACCRUE_TYPE, FOP_ACCRUE_TYPE},
+	{NULL, FOP_CONST}
+};
+
+/* compiled formulas by formula string.  A NULL expr means use python */
+#define FORMULA_CACHE_SIZE 4
+static struct {
+	char *formula;
+	formula_expr *expr;
+} formula_cache[FORMULA_CACHE_SIZE];
+static int formula_cache_next;
+
+static formula_expr *formula_parse_expr(formula_expr *fe);
+static formula_expr *formula_parse_factor(formula_expr *fe);
+
+/**
+ * @brief
+ * 		formula_expr constructor
+ *
+ * @return	new formula_expr
+ * @retval	NULL	: malloc failed
+ */
+static formula_expr *
+new_formula_expr(void)
+{
+	formula_expr *fe;
+
+	if ((fe = calloc(1, sizeof(formula_expr))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	return fe;
+}
+
+/**
+ * @brief
+ * 		formula_expr destructor
+ *
+ * @param[in]	fe	-	formula_expr to free
+ *
+ * @return	void
+ */
+static void
+free_formula_expr(formula_expr *fe)
+{
+	if (fe == NULL)
+		return;
+
+	free(fe->prog);
+	free(fe);
+}
+
+/**
+ * @brief
+ * 		append an instruction to a formula being compiled
+ *
+ * @param[in,out]	fe	-	formula being compiled
+ * @param[in]	op	-	operation
+ * @param[in]	val	-	value for FOP_CONST
+ * @param[in]	def	-	resource for FOP_RES
+ *
+ * @return	void
+ */
+static void
+formula_emit(formula_expr *fe, enum formula_op op, double val, resdef *def)
+{
+	struct formula_insn *tmp;
+
+	if (fe->err)
+		return;
+
+	if (fe->len == fe->size) {
+		tmp = realloc(fe->prog, (fe->size * 2 + 8) * sizeof(struct formula_insn));
+		if (tmp == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			fe->err = 1;
+			return;
+		}
+		fe->prog = tmp;
+		fe->size = fe->size * 2 + 8;
+	}
+
+	fe->prog[fe->len].op = op;
+	fe->prog[fe->len].val = val;
+	fe->prog[fe->len].def = def;
+	fe->len++;
+
+	/* operands push one value, binary operators pop one, FOP_NEG neither */
+	if (op <= FOP_ACCRUE_TYPE) {
+		fe->depth++;
+		if (fe->depth > fe->max_depth)
+			fe->max_depth = fe->depth;
+	} else if (op != FOP_NEG)
+		fe->depth--;
+}
+
+/**
+ * @brief
+ * 		skip white space in a formula being compiled
+ *
+ * @param[in,out]	fe	-	formula being compiled
+ *
+ * @return	the next character
+ */
+static char
+formula_skip_space(formula_expr *fe)
+{
+	while (*fe->pos == ' ' || *fe->pos == '\t')
+		fe->pos++;
+
+	return *fe->pos;
+}
+
+/**
+ * @brief
+ * 		parse an atom: a number, a name or a parenthesized expression
+ *
+ * @param[in,out]	fe	-	formula being compiled
+ *
+ * @return	fe
+ */
+static formula_expr *
+formula_parse_atom(formula_expr *fe)
+{
+	const char *start;
+	char *endp;
+	char name[MAX_RES_NAME_SIZE + 1];
+	double val;
+	int len;
+	int i;
+	char c;
+
+	c = formula_skip_space(fe);
+	start = fe->pos;
+
+	if (c == '(') {
+		fe->pos++;
+		formula_parse_expr(fe);
+		if (formula_skip_space(fe) != ')')
+			fe->err = 1;
+		else
+			fe->pos++;
+	} else if (isdigit((int) c) || (c == '.' && isdigit((int) start[1]))) {
+		/* python 3 does not allow leading zeros on integers (e.g. 010) */
+		for (i = 0; isdigit((int) start[i]); i++)
+			;
+		if (start[0] == '0' && i > 1 && start[i] != '.' && start[i] != 'e' && start[i] != 'E') {
+			fe->err = 1;
+			return fe;
+		}
+		/* strtod() also knows hex, python spells that differently */
+		if (start[0] == '0' && (start[1] == 'x' || start[1] == 'X')) {
+			fe->err = 1;
+			return fe;
+		}
+		val = strtod(start, &endp);
+		/* anything glued to the number (1_000, 5j, ...) is python's problem */
+		if (endp == start || isalnum((int) *endp) || *endp == '_' || *endp == '.') {
+			fe->err = 1;
+			return fe;
+		}
+		fe->pos = endp;
+		formula_emit(fe, FOP_CONST, val, NULL);
+	} else if (isalpha((int) c) || c == '_') {
+		for (len = 0; isalnum((int) start[len]) || start[len] == '_'; len++)
+			;
+		if (len > MAX_RES_NAME_SIZE) {
+			fe->err = 1;
+			return fe;
+		}
+		strncpy(name, start, len);
+		name[len] = '\0';
+		fe->pos += len;
+
+		/* keywords take precedence over resources of the same name */
+		for (i = 0; formula_keywords[i].name != NULL; i++) {
+			if (strcmp(formula_keywords[i].name, name) == 0) {
+				formula_emit(fe, formula_keywords[i].op, 0, NULL);
+				return fe;
+			}
+		}
+
+		/* only consumable resources are known to python, anything else
+		 * is a builtin (or a NameError)
+		 */
+		if (consres != NULL) {
+			for (i = 0; consres[i] != NULL; i++) {
+				if (strcmp(consres[i]->name, name) == 0) {
+					formula_emit(fe, FOP_RES, 0, consres[i]);
+					return fe;
+				}
+			}
+		}
+		fe->err = 1;
+	} else
+		fe->err = 1;
+
+	return fe;
+}
+
+/**
+ * @brief
+ * 		parse a power: atom ['**' factor]
+ *
+ * @param[in,out]	fe	-	formula being compiled
+ *
+ * @return	fe
+ */
+static formula_expr *
+formula_parse_power(formula_expr *fe)
+{
+	formula_parse_atom(fe);
+	if (fe->err)
+		return fe;
+
+	if (formula_skip_space(fe) == '*' && fe->pos[1] == '*') {
+		fe->pos += 2;
+		/* ** is right associative and binds less tightly than a unary
+		 * operator on its right (2**-1)
+		 */
+		formula_parse_factor(fe);
+		formula_emit(fe, FOP_POW, 0, NULL);
+	}
+
+	return fe;
+}
+
+/**
+ * @brief
+ * 		parse a factor: ('+'|'-') factor | power
+ *
+ * @param[in,out]	fe	-	formula being compiled
+ *
+ * @return	fe
+ */
+static formula_expr *
+formula_parse_factor(formula_expr *fe)
+{
+	char c;
+
+	c = formula_skip_space(fe);
+	if (c == '-' || c == '+') {
+		fe->pos++;
+		formula_parse_factor(fe);
+		if (c == '-')
+			formula_emit(fe, FOP_NEG, 0, NULL);
+		return fe;
+	}
+
+	return formula_parse_power(fe);
+}
+
+/**
+ * @brief
+ * 		parse a term: factor (('*'|'/'|'//'|'%') factor)*
+ *
+ * @param[in,out]	fe	-	formula being compiled
+ *
+ * @return	fe
+ */
+static formula_expr *
+formula_parse_term(formula_expr *fe)
+{
+	enum formula_op op;
+	char c;
+
+	formula_parse_factor(fe);
+	while (!fe->err) {
+		c = formula_skip_space(fe);
+		if (c == '*' && fe->pos[1] != '*') {
+			op = FOP_MUL;
+			fe->pos++;
+		} else if (c == '/' && fe->pos[1] == '/') {
+			op = FOP_FLOORDIV;
+			fe->pos += 2;
+		} else if (c == '/') {
+			op = FOP_DIV;
+			fe->pos++;
+		} else if (c == '%') {
+			op = FOP_MOD;
+			fe->pos++;
+		} else
+			break;
+		/* augmented assignment (*=, /=, ...) is not an expression */
+		if (*fe->pos == '=') {
+			fe->err = 1;
+			break;
+		}
+		formula_parse_factor(fe);
+		formula_emit(fe, op, 0, NULL);
+	}
+
+	return fe;
+}
+
+/**
+ * @brief
+ * 		parse an expression: term (('+'|'-') term)*
+ *
+ * @param[in,out]	fe	-	formula being compiled
+ *
+ * @return	fe
+ */
+static formula_expr *
+formula_parse_expr(formula_expr *fe)
+{
+	enum formula_op op;
+	char c;
+
+	formula_parse_term(fe);
+	while (!fe->err) {
+		c = formula_skip_space(fe);
+		if (c == '+')
+			op = FOP_ADD;
+		else if (c == '-')
+			op = FOP_SUB;
+		else
+			break;
+		fe->pos++;
+		formula_parse_term(fe);
+		formula_emit(fe, op, 0, NULL);
+	}
+
+	return fe;
+}
+
+/**
+ * @brief
+ * 		compile a formula into a postfix program
+ *
+ * @param[in]	formula	-	the formula
+ *
+ * @return	compiled formula
+ * @retval	NULL	: the formula needs python (or error)
+ */
+static formula_expr *
+compile_formula(char *formula)
+{
+	formula_expr *fe;
+
+	if ((fe = new_formula_expr()) == NULL)
+		return NULL;
+
+	fe->pos = formula;
+	formula_parse_expr(fe);
+	if (!fe->err && formula_skip_space(fe) != '\0')
+		fe->err = 1;
+
+	if (fe->err || fe->len == 0) {
+		log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"Formula can not be compiled, python will be used: %s", formula);
+		free_formula_expr(fe);
+		return NULL;
+	}
+
+	fe->pos = NULL;
+	return fe;
+}
+
+/**
+ * @brief
+ * 		find the compiled version of a formula, compiling it if needed
+ *
+ * @param[in]	formula	-	the formula
+ *
+ * @return	compiled formula
+ * @retval	NULL	: the formula needs python
+ */
+static formula_expr *
+find_compiled_formula(char *formula)
+{
+	int i;
+
+	for (i = 0; i < FORMULA_CACHE_SIZE; i++) {
+		if (formula_cache[i].formula != NULL &&
+		    strcmp(formula_cache[i].formula, formula) == 0)
+			return formula_cache[i].expr;
+	}
+
+	i = formula_cache_next;
+	formula_cache_next = (formula_cache_next + 1) % FORMULA_CACHE_SIZE;
+
+	free(formula_cache[i].formula);
+	free_formula_expr(formula_cache[i].expr);
+	formula_cache[i].expr = NULL;
+	if ((formula_cache[i].formula = string_dup(formula)) == NULL)
+		return NULL;
+	formula_cache[i].expr = compile_formula(formula);
+
+	return formula_cache[i].expr;
+}
+
+/**
+ * @brief
+ * 		free all compiled formulas.  Compiled formulas reference resource
+ *		definitions, so this needs to be called whenever they are freed.
+ *
+ * @return	void
+ */
+void
+free_formula_cache(void)
+{
+	int i;
+
+	for (i = 0; i < FORMULA_CACHE_SIZE; i++) {
+		free(formula_cache[i].formula);
+		formula_cache[i].formula = NULL;
+		free_formula_expr(formula_cache[i].expr);
+		formula_cache[i].expr = NULL;
+	}
+	formula_cache_next = 0;
+}
+
+/**
+ * @brief
+ * 		round a value the way it is when printed into the python
+ *		dictionary formula_evaluate() uses, so both give the same answer
+ *
+ * @param[in]	val	-	the value
+ * @param[in]	digits	-	digits after the decimal point
+ *
+ * @return	rounded value
+ */
+static double
+formula_rounded(double val, int digits)
+{
+	char buf[512];
+
+	snprintf(buf, sizeof(buf), "%.*f", digits, val);
+	return strtod(buf, NULL);
+}
+
+/**
+ * @brief
+ * 		evaluate a formula for a job without python
+ *
+ * @param[in]	formula	-	formula to evaluate
+ * @param[in]	resresv	-	job for special case key words
+ * @param[in]	resreq	-	resources to use when evaluating
+ * @param[out]	ans	-	the answer
+ *
+ * @return	int
+ * @retval	1	: ans is set
+ * @retval	0	: the formula can not be evaluated natively.  This includes
+ *			  runtime errors like division by zero, so python reports them.
+ */
+int
+formula_native_evaluate(char *formula, resource_resv *resresv,
+	resource_req *resreq, sch_resource_t *ans)
+{
+	formula_expr *fe;
+	double stack_buf[32];
+	double *stack;
+	double a;
+	double b;
+	int sp = 0;
+	int i;
+	int ret = 1;
+	resource_req *req;
+	job_info *job;
+
+	if (formula == NULL || resresv == NULL || resresv->job == NULL || ans == NULL)
+		return 0;
+
+	if ((fe = find_compiled_formula(formula)) == NULL)
+		return 0;
+
+	job = resresv->job;
+	if (fe->max_depth > sizeof(stack_buf) / sizeof(stack_buf[0])) {
+		if ((stack = malloc(fe->max_depth * sizeof(double))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+	} else
+		stack = stack_buf;
+
+	for (i = 0; i < fe->len && ret; i++) {
+		struct formula_insn *in = &fe->prog[i];
+
+		switch (in->op) {
+			case FOP_CONST:
+				stack[sp++] = in->val;
+				break;
+			case FOP_RES:
+				req = find_resource_req(resreq, in->def);
+				if (req != NULL)
+					stack[sp++] = formula_rounded(req->amount,
+						float_digits(req->amount, FLOAT_NUM_DIGITS));
+				else
+					stack[sp++] = 0;
+				break;
+			case FOP_ELIGIBLE_TIME:
+				stack[sp++] = job->eligible_time;
+				break;
+			case FOP_QUEUE_PRIO:
+				stack[sp++] = job->queue->priority;
+				break;
+			case FOP_JOB_PRIO:
+				stack[sp++] = job->priority;
+				break;
+			case FOP_FSPERC:
+				stack[sp++] = formula_rounded(job->ginfo->tree_percentage, 6);
+				break;
+			case FOP_TREE_USAGE:
+				stack[sp++] = formula_rounded(job->ginfo->usage_factor, 6);
+				break;
+			case FOP_FSFACTOR:
+				stack[sp++] = formula_rounded(job->ginfo->tree_percentage == 0 ? 0 :
+					pow(2, -(job->ginfo->usage_factor / job->ginfo->tree_percentage)), 6);
+				break;
+			case FOP_ACCRUE_TYPE:
+				stack[sp++] = job->accrue_type;
+				break;
+			case FOP_NEG:
+				stack[sp - 1] = -stack[sp - 1];
+				break;
+			default:
+				b = stack[--sp];
+				a = stack[sp - 1];
+				switch (in->op) {
+					case FOP_ADD:
+						a = a + b;
+						break;
+					case FOP_SUB:
+						a = a - b;
+						break;
+					case FOP_MUL:
+						a = a * b;
+						break;
+					case FOP_DIV:
+						if (b == 0)
+							ret = 0;
+						else
+							a = a / b;
+						break;
+					case FOP_FLOORDIV:
+						if (b == 0)
+							ret = 0;
+						else
+							a = floor(a / b);
+						break;
+					case FOP_MOD:
+						/* python's % takes the sign of the divisor */
+						if (b == 0)
+							ret = 0;
+						else {
+							double m = fmod(a, b);
+							if (m != 0 && ((m < 0) != (b < 0)))
+								m += b;
+							a = m;
+						}
+						break;
+					case FOP_POW:
+						/* python gives a complex number for a negative
+						 * number to a fractional power
+						 */
+						if (a < 0 && b != floor(b))
+							ret = 0;
+						else
+							a = pow(a, b);
+						break;
+					default:
+						ret = 0;
+				}
+				stack[sp - 1] = a;
+		}
+	}
+
+	/* overflow and the like are reported by python */
+	if (ret && (sp != 1 || !isfinite(stack[0])))
+		ret = 0;
+
+	if (ret)
+		*ans = stack[0];
+
+	if (stack != stack_buf)
+		free(stack);
+
+	return ret;
+}
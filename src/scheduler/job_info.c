@@ -42,6 +42,13 @@
  * 		job_info.c - This file contains functions related to job_info structure.
  *
  * Functions included are:
+ * 	free_job_query_cache()
+ * 	save_job_query_cache()
+ * 	load_job_status()
+ * 	load_job_query_cache()
+ * 	forget_peer_job()
+ * 	find_peer_job_server()
+ * 	poll_peer_queues()
  * 	query_jobs()
  * 	query_job()
  * 	new_job_info()
@@ -49,6 +56,7 @@
  * 	set_job_state()
  * 	update_job_attr()
  * 	send_job_updates()
+ * 	flush_job_updates()
  * 	send_attr_updates()
  * 	unset_job_attr()
  * 	update_job_comment()
@@ -59,6 +67,8 @@
  * 	get_preemption_order()
  * 	preempt_job()
  * 	find_and_preempt_jobs()
+ * 	preempt_candidate_filter()
+ * 	find_preempt_candidates()
  * 	find_jobs_to_preempt()
  * 	select_index_to_preempt()
  * 	preempt_level()
@@ -68,6 +78,7 @@
  * 	update_array_on_run()
  * 	is_job_array()
  * 	modify_job_array_for_qrun()
+ * 	collect_materialized_subjobs()
  * 	queue_subjob()
  * 	formula_evaluate()
  * 	make_eligible()
@@ -80,7 +91,15 @@
  * 	check_preempt_targets_for_none()
  * 	is_finished_job()
  * 	preemption_similarity()
+ * 	resresv_node_bits()
+ * 	parse_preempt_targets()
  * 	geteoename()
+ * 	resresv_set_memo_err_ok()
+ * 	resresv_set_memo_fingerprint()
+ * 	cmp_resresv_set_memo()
+ * 	free_resresv_set_memo()
+ * 	apply_resresv_set_memo()
+ * 	save_resresv_set_memo()
  *
  */
 #include <pbs_config.h>
@@ -122,6 +141,9 @@
 #include "resource.h"
 #include "server_info.h"
 #include "attribute.h"
+#include "avltree.h"
+#include "formula.h"
+#include "sub_cycle.h"
 
 #ifdef NAS
 #include "site_code.h"
@@ -493,2074 +515,3697 @@ static struct fc_translation_table fctt[] = {
 #define	ERR2COMMENT(code)	(fctt[(code) - RET_BASE].fc_comment)
 #define	ERR2INFO(code)		(fctt[(code) - RET_BASE].fc_info)
 
+/*
+ * Queued job status carried between cycles when incremental_query is set.
+ * There is one entry per local queue.  The batch_status entries are owned by
+ * the cache and are only replaced when the server reports the job changed
+ * (i.e., its mtime moved past the high water mark of the queue).
+ */
+struct jq_cache {
+	char *qname;			/* name of the queue */
+	struct batch_status *jobs;	/* queued jobs in server order */
+	AVL_IX_DESC *idx;		/* job name -> entry in jobs */
+	long mtime_hwm;			/* largest job mtime seen in the queue */
+	time_t last_update;		/* scheduler time of last refresh */
+	int incr_cycles;		/* incremental refreshes since last full query */
+	time_t next_poll;		/* peer queues: when poll_peer_queues() refreshes it */
+	struct jq_cache *next;
+};
+
+static struct jq_cache *jq_cache_head = NULL;
+
 /**
  * @brief
- * 		create an array of jobs in a specified queue
+ *		free the contents of a queued job cache entry
  *
- * @par NOTE:
- * 		anything reservation related needs to happen in
- *		query_reservations().  Since it is called after us,
- *		reservations aren't available at this point.
+ * @param[in]	jqc	-	cache entry to clear
  *
- * @param[in]	policy	-	policy info
- * @param[in]	pbs_sd	-	connection to pbs_server
- * @param[in]	qinfo	-	queue to get jobs from
- * @param[in]	pjobs   -	possible job array to add too
- * @param[in]	queue_name	-	the name of the queue to query (local/remote)
+ * @return	nothing
+ */
+static void
+clear_jq_cache(struct jq_cache *jqc)
+{
+	if (jqc == NULL)
+		return;
+
+	pbs_statfree(jqc->jobs);
+	jqc->jobs = NULL;
+	if (jqc->idx != NULL) {
+		avl_destroy_index(jqc->idx);
+		free(jqc->idx);
+		jqc->idx = NULL;
+	}
+	jqc->mtime_hwm = 0;
+	jqc->incr_cycles = 0;
+}
+
+/**
+ * @brief
+ *		free the queued job status cache of all queues
  *
- * @return	pointer to the head of a list of jobs
- * @par MT-safe: No
+ * @return	nothing
  */
-resource_resv **
-query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs, char *queue_name)
+void
+free_job_query_cache(void)
 {
-	/* pbs_selstat() takes a linked list of attropl structs which tell it
-	 * what information about what jobs to return.  We want all jobs which are
-	 * in a specified queue
-	 */
-	struct attropl opl = { NULL, ATTR_q, NULL, NULL, EQ };
-	static struct attropl opl2[2] = { { &opl2[1], ATTR_state, NULL, "Q", EQ},
-		{ NULL, ATTR_array, NULL, "True", NE} };
-	static struct attrl *attrib = NULL;
-	int i;
+	struct jq_cache *jqc;
+	struct jq_cache *next;
+
+	for (jqc = jq_cache_head; jqc != NULL; jqc = next) {
+		next = jqc->next;
+		clear_jq_cache(jqc);
+		free(jqc->qname);
+		free(jqc);
+	}
+	jq_cache_head = NULL;
+}
 
-	/* linked list of jobs returned from pbs_selstat() */
-	struct batch_status *jobs;
+/**
+ * @brief
+ *		find the queued job cache entry of a queue and allocate it if
+ *		it does not exist yet
+ *
+ * @param[in]	qname	-	name of the queue
+ *
+ * @return	struct jq_cache *
+ * @retval	NULL	: on error
+ */
+static struct jq_cache *
+find_alloc_jq_cache(char *qname)
+{
+	struct jq_cache *jqc;
 
-	/* current job in jobs linked list */
-	struct batch_status *cur_job;
+	for (jqc = jq_cache_head; jqc != NULL; jqc = jqc->next)
+		if (!strcmp(jqc->qname, qname))
+			return jqc;
 
-	/* array of internal scheduler structures for jobs */
-	resource_resv **resresv_arr;
+	if ((jqc = calloc(1, sizeof(struct jq_cache))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	if ((jqc->qname = string_dup(qname)) == NULL) {
+		free(jqc);
+		return NULL;
+	}
+	jqc->next = jq_cache_head;
+	jq_cache_head = jqc;
 
-	/* current job in resresv_arr array */
-	resource_resv *resresv;
+	return jqc;
+}
 
-	/* number of jobs in resresv_arr */
-	int num_jobs = 0;
-	/* number of jobs in pjobs */
-	int num_prev_jobs;
+/**
+ * @brief
+ *		return the mtime of a job batch_status
+ *
+ * @param[in]	bs	-	job batch_status
+ *
+ * @return	long
+ * @retval	0	: mtime was not returned by the server
+ */
+static long
+bs_job_mtime(struct batch_status *bs)
+{
+	struct attrl *attrp;
 
+	for (attrp = bs->attribs; attrp != NULL; attrp = attrp->next)
+		if (!strcmp(attrp->name, ATTR_mtime))
+			return strtol(attrp->value, NULL, 10);
 
-	/* how starving is a starving job */
-	long starve_num;
+	return 0;
+}
 
-	/* string to look up a group_info */
-	char fairshare_name[100];
+/**
+ * @brief
+ *		bring a cached job batch_status up to date with the passage of time.
+ *		The server computes eligible_time when the job is stat'd, so a job
+ *		accruing eligible time needs its value advanced by the time
+ *		since it was last refreshed.
+ *
+ * @param[in]	bs	-	cached job batch_status
+ * @param[in]	delta	-	time since the cache was last refreshed
+ *
+ * @return	nothing
+ */
+static void
+age_cached_job(struct batch_status *bs, time_t delta)
+{
+	struct attrl *attrp;
+	struct attrl *elig = NULL;
+	int accruing = 0;
+	char timebuf[128];
 
-	/* used to add the resources_used to resource list */
-	resource_req *req;
+	if (delta <= 0)
+		return;
 
-	schd_error *err;
+	for (attrp = bs->attribs; attrp != NULL; attrp = attrp->next) {
+		if (!strcmp(attrp->name, ATTR_accrue_type))
+			accruing = (strtol(attrp->value, NULL, 10) == JOB_ELIGIBLE);
+		else if (!strcmp(attrp->name, ATTR_eligible_time))
+			elig = attrp;
+	}
 
-	/* used for pbs_geterrmsg() */
-	char *errmsg;
+	if (accruing && elig != NULL) {
+		convert_duration_to_str((time_t) res_to_num(elig->value, NULL) + delta,
+			timebuf, sizeof(timebuf));
+		free(elig->value);
+		elig->value = string_dup(timebuf);
+	}
+}
 
-	/* Determine start, end, and duration */
-	resource_req *walltime_req = NULL;
-	resource_req *soft_walltime_req = NULL;
-	time_t start;
-	time_t end;
-	time_t server_time;
-	long duration;
-	char *jobattrs[] = {
-			ATTR_p,
-			ATTR_qtime,
-			ATTR_qrank,
-			ATTR_etime,
-			ATTR_stime,
-			ATTR_N,
-			ATTR_state,
-			ATTR_substate,
-			ATTR_sched_preempted,
-			ATTR_comment,
-			ATTR_released,
-			ATTR_euser,
-			ATTR_egroup,
-			ATTR_project,
-			ATTR_resv_ID,
-			ATTR_altid,
-			ATTR_SchedSelect,
-			ATTR_array_id,
-			ATTR_node_set,
-			ATTR_array,
-			ATTR_array_index,
-			ATTR_topjob_ineligible,
-			ATTR_array_indices_remaining,
-			ATTR_execvnode,
-			ATTR_l,
-			ATTR_rel_list,
-			ATTR_used,
-			ATTR_accrue_type,
-			ATTR_eligible_time,
-			ATTR_estimated,
-			ATTR_c,
-			ATTR_r,
-			NULL
-	};
+/**
+ * @brief
+ *		(re)build the name index of a queued job cache entry
+ *
+ * @param[in]	jqc	-	cache entry
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
+ */
+static int
+index_jq_cache(struct jq_cache *jqc)
+{
+	struct batch_status *bs;
 
-	if (policy == NULL || qinfo == NULL || queue_name == NULL)
-		return pjobs;
+	if (jqc->idx != NULL) {
+		avl_destroy_index(jqc->idx);
+		free(jqc->idx);
+	}
+	if ((jqc->idx = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL)
+		return 0;
 
-	opl.value = queue_name;
+	for (bs = jqc->jobs; bs != NULL; bs = bs->next) {
+		long mtime;
 
-	if (qinfo->is_peer_queue)
-		opl.next = &opl2[0];
+		if (tree_add_del(jqc->idx, bs->name, bs, TREE_OP_ADD) != 0)
+			return 0;
+		mtime = bs_job_mtime(bs);
+		if (mtime > jqc->mtime_hwm)
+			jqc->mtime_hwm = mtime;
+	}
 
-	server_time = qinfo->server->server_time;
+	return 1;
+}
 
-	if (attrib == NULL) {
-		for (i = 0; jobattrs[i] != NULL; i++) {
-			struct attrl *temp_attrl = NULL;
+/**
+ * @brief
+ *		write the queued job cache to the warm cache file.  Cached jobs
+ *		are checked against the server's job ids and mtimes every cycle,
+ *		so they stay valid across a restart of the scheduler.
+ *
+ * @param[in]	fp	-	warm cache file
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: write error
+ */
+int
+save_job_query_cache(FILE *fp)
+{
+	struct jq_cache *jqc;
+	struct batch_status *bs;
+	struct attrl *attrp;
+	int num;
+
+	num = 0;
+	for (jqc = jq_cache_head; jqc != NULL; jqc = jqc->next)
+		if (jqc->idx != NULL)
+			num++;
+	if (!write_cache_val(fp, &num, sizeof(num)))
+		return 0;
 
-			temp_attrl = new_attrl();
-			temp_attrl->name = strdup(jobattrs[i]);
-			temp_attrl->next = attrib;
-			temp_attrl->value = "";
-			attrib = temp_attrl;
-		}
-	}
+	for (jqc = jq_cache_head; jqc != NULL; jqc = jqc->next) {
+		if (jqc->idx == NULL)
+			continue;
+		num = 0;
+		for (bs = jqc->jobs; bs != NULL; bs = bs->next)
+			num++;
+		if (!write_cache_str(fp, jqc->qname) ||
+			!write_cache_val(fp, &jqc->last_update, sizeof(jqc->last_update)) ||
+			!write_cache_val(fp, &jqc->incr_cycles, sizeof(jqc->incr_cycles)) ||
+			!write_cache_val(fp, &num, sizeof(num)))
+			return 0;
 
-	/* get jobs from PBS server */
-	if ((jobs = pbs_selstat(pbs_sd, &opl, attrib, "S")) == NULL) {
-		if (pbs_errno > 0) {
-			errmsg = pbs_geterrmsg(pbs_sd);
-			if (errmsg == NULL)
-				errmsg = "";
-			log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_NOTICE, "job_info", 
-				 "pbs_selstat failed: %s (%d)", errmsg, pbs_errno);
+		for (bs = jqc->jobs; bs != NULL; bs = bs->next) {
+			num = 0;
+			for (attrp = bs->attribs; attrp != NULL; attrp = attrp->next)
+				num++;
+			if (!write_cache_str(fp, bs->name) ||
+				!write_cache_val(fp, &num, sizeof(num)))
+				return 0;
+			for (attrp = bs->attribs; attrp != NULL; attrp = attrp->next)
+				if (!write_cache_str(fp, attrp->name) ||
+					!write_cache_str(fp, attrp->resource) ||
+					!write_cache_str(fp, attrp->value))
+					return 0;
 		}
-		return pjobs;
-	}
-
-	/* count the number of new jobs */
-	cur_job = jobs;
-	while (cur_job != NULL) {
-		num_jobs++;
-		cur_job = cur_job->next;
 	}
 
-	/* if there are previous jobs, count those too */
-	num_prev_jobs = count_array((void **)pjobs);
-	num_jobs += num_prev_jobs;
-
+	return 1;
+}
 
-	/* allocate enough space for all the jobs and the NULL sentinal */
-	if (pjobs != NULL)
-		resresv_arr = (resource_resv **)
-			realloc(pjobs, sizeof(resource_resv*) * (num_jobs + 1));
-	else
-		resresv_arr = (resource_resv **)
-			malloc(sizeof(resource_resv*) * (num_jobs + 1));
+/**
+ * @brief
+ *		read one job batch_status written by save_job_query_cache()
+ *
+ * @param[in]	fp	-	warm cache file
+ *
+ * @return	struct batch_status *
+ * @retval	NULL	: read error or corrupt entry
+ */
+static struct batch_status *
+load_job_status(FILE *fp)
+{
+	struct batch_status *bs;
+	struct attrl *attrp;
+	struct attrl **tail;
+	int num;
+	int i;
 
-	if (resresv_arr == NULL) {
-		log_err(errno, "query_jobs", "Error allocating memory");
-		pbs_statfree(jobs);
+	if ((bs = calloc(1, sizeof(struct batch_status))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
 		return NULL;
 	}
-	resresv_arr[num_prev_jobs] = NULL;
-
-	err = new_schd_error();
-	if(err == NULL) {
-		free_resource_resv_array(resresv_arr);
+	if (!read_cache_str(fp, &bs->name) || bs->name == NULL ||
+		!read_cache_val(fp, &num, sizeof(num)) ||
+		num < 0 || num > WARM_CACHE_MAX_ITEMS) {
+		pbs_statfree(bs);
 		return NULL;
 	}
 
-	i = num_prev_jobs;
-	for (cur_job = jobs; cur_job != NULL; cur_job = cur_job->next) {
-		char *selectspec = NULL;
-		if ((resresv = query_job(cur_job, qinfo->server, err)) ==NULL) {
-			free_schd_error(err);
-			pbs_statfree(jobs);
-			free_resource_resv_array(resresv_arr);
+	tail = &bs->attribs;
+	for (i = 0; i < num; i++) {
+		if ((attrp = calloc(1, sizeof(struct attrl))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			pbs_statfree(bs);
 			return NULL;
 		}
-
-		/* do a validity check to see if the job is sane.  If we're peering and
-		 * we're not a manager at the remote host, we wont have necessary attribs
-		 * like euser and egroup
-		 */
-		if (resresv->is_invalid || !is_resource_resv_valid(resresv, err) ) {
-			schdlogerr(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_DEBUG, resresv->name,
-				"Job is invalid - ignoring for this cycle", err);
-			/* decrement i because we're about to increment it as part of the for()
-			 * header.  We to continue adding valid jobs to our array.  We're
-			 * freeing what we allocated and ignoring this job completely.
-			 */
-			free_resource_resv(resresv);
-			continue;
+		*tail = attrp;
+		tail = &attrp->next;
+		if (!read_cache_str(fp, &attrp->name) || attrp->name == NULL ||
+			!read_cache_str(fp, &attrp->resource) ||
+			!read_cache_str(fp, &attrp->value) || attrp->value == NULL) {
+			pbs_statfree(bs);
+			return NULL;
 		}
+	}
 
-		/* Make sure scheduler does not process a subjob in undesirable state*/
-		if (resresv->job->is_subjob && !resresv->job->is_running && !resresv->job->is_exiting &&
-			!resresv->job->is_suspended && !resresv->job->is_provisioning) {
-			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_RESV, LOG_DEBUG,
-				resresv->name, "Subjob found in undesirable state, ignoring this job");
-			free_resource_resv(resresv);
-			continue;
-		}
+	return bs;
+}
 
-		resresv->job->queue = qinfo;
+/**
+ * @brief
+ *		replace the queued job cache with the one of the warm cache file
+ *
+ * @param[in]	fp	-	warm cache file
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: read error or corrupt file, the cache is left empty
+ */
+int
+load_job_query_cache(FILE *fp)
+{
+	struct jq_cache *jqc;
+	struct batch_status *bs;
+	struct batch_status **tail;
+	char *qname;
+	int num_q;
+	int num_jobs;
+	int i;
+	int j;
 
-#ifdef NAS /* localmod 040 */
-		/* we modify nodect to be the same value for all jobs in queues that are
-		 * configured to ignore nodect key sorting, for two reasons:
-		 * 1. obviously to accomplish ignoring of nodect key sorting
-		 * 2. maintain stability of qsort when comparing with a job in a queue that
-		 *    does not require nodect key sorting
-		 * note that this assumes nodect is used only for sorting
-		 */
-		if (qinfo->ignore_nodect_sort)
-			resresv->job->nodect = 999999;
-#endif /* localmod 040 */
+	free_job_query_cache();
+	if (!read_cache_val(fp, &num_q, sizeof(num_q)) ||
+		num_q < 0 || num_q > WARM_CACHE_MAX_ITEMS)
+		return 0;
 
-		if ((resresv->aoename = getaoename(resresv->select)) != NULL)
-			resresv->is_prov_needed = 1;
-		if ((resresv->eoename = geteoename(resresv->select)) != NULL) {
-			/* job with a power profile can't be checkpointed or suspended */
-			resresv->job->can_checkpoint = 0;
-			resresv->job->can_suspend = 0;
-		}
+	for (i = 0; i < num_q; i++) {
+		if (!read_cache_str(fp, &qname) || qname == NULL)
+			break;
+		jqc = find_alloc_jq_cache(qname);
+		free(qname);
+		if (jqc == NULL || jqc->idx != NULL)
+			break;
+		if (!read_cache_val(fp, &jqc->last_update, sizeof(jqc->last_update)) ||
+			!read_cache_val(fp, &jqc->incr_cycles, sizeof(jqc->incr_cycles)) ||
+			!read_cache_val(fp, &num_jobs, sizeof(num_jobs)) ||
+			num_jobs < 0 || num_jobs > WARM_CACHE_MAX_ITEMS)
+			break;
 
-		if (resresv->select != NULL && resresv->select->chunks != NULL) {
-			/*
-			 * Job is invalid if there are no resources in a chunk.  Usually
-			 * happens because we strip out resources not in conf.res_to_check
-			 */
-			int k;
-			for (k = 0; resresv->select->chunks[k] != NULL; k++)
-				if (resresv->select->chunks[k]->req == NULL) {
-					set_schd_error_codes(err, NEVER_RUN, INVALID_RESRESV);
-					set_schd_error_arg(err, ARG1, "invalid chunk in select");
-					break;
-				}
+		tail = &jqc->jobs;
+		for (j = 0; j < num_jobs; j++) {
+			if ((bs = load_job_status(fp)) == NULL)
+				break;
+			*tail = bs;
+			tail = &bs->next;
 		}
-		if (resresv->place_spec->scatter &&
-			resresv->select->total_chunks >1)
-			resresv->will_use_multinode = 1;
+		if (j < num_jobs || index_jq_cache(jqc) == 0)
+			break;
+	}
 
-		if (resresv->job->is_queued && resresv->nspec_arr != NULL)
-			resresv->job->is_checkpointed = 1;
+	if (i < num_q) {
+		free_job_query_cache();
+		return 0;
+	}
+	return 1;
+}
 
-		/* If we did not wait for mom to start the job (throughput mode),
-		 * it is possible that we’re seeing a running job without a start time set.
-		 * The stime is set when the mom reports back to the server to say the job is running.
-		 */
-		if ((resresv->job->is_running) && (resresv->job->stime == UNSPECIFIED))
-			resresv->job->stime = server_time + 1;
+/**
+ * @brief
+ *		merge the jobs which changed since the last cycle into the
+ *		queued job cache of a queue.
+ *
+ * @param[in]	jqc	-	cache entry to merge into
+ * @param[in]	changed	-	jobs whose mtime is at or past the high water mark
+ * @param[in]	ids	-	ids of all queued jobs in the queue in server order
+ * @param[in]	now	-	current scheduler time
+ *
+ * @return	int
+ * @retval	1	: the cache now matches ids
+ * @retval	0	: a job was found that neither the server reported changed
+ *			  nor the cache knows about.  The caller needs to do a
+ *			  full query.  changed is freed in either case.
+ */
+static int
+merge_jq_cache(struct jq_cache *jqc, struct batch_status *changed, char **ids, time_t now)
+{
+	AVL_IX_DESC *chg_idx;
+	struct batch_status **jobs_arr = NULL;
+	struct batch_status *bs;
+	struct batch_status *next;
+	int num_ids;
+	int i;
+	int rc = 1;
 
-		/* Assumption: Parent job array will be queried before running subjobs.
-		 * This is because the subjobs do not become real jobs until after they are run
-		 * If this assumption is ever proven false, nothing bad will really
-		 * happen.  This is here for consistencies sake mostly.
-		 */
-		if(resresv->job->array_id != NULL)
-			resresv->job->parent_job = find_resource_resv(resresv_arr, resresv->job->array_id);
+	if ((chg_idx = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL) {
+		pbs_statfree(changed);
+		return 0;
+	}
 
-		/* For jobs that have an exec_vnode, we create a "select" based
-		 * on its exec_vnode.  We do this so if we ever need to run the job 
-		 * again, we will replace the job on the exact vnodes/resources it originally used.
-		 */
-		if (resresv->job->is_suspended && resresv->job->resreleased != NULL)
-			/* For jobs that are suspended and have resource_released, the "select" 
-			* we create is based off of resources_released instead of the exec_vnode.
-			*/
-			selectspec = create_select_from_nspec(resresv->job->resreleased);
-		else if (resresv->nspec_arr != NULL)
-			selectspec = create_select_from_nspec(resresv->nspec_arr);
+	for (bs = changed; bs != NULL; bs = bs->next)
+		if (tree_add_del(chg_idx, bs->name, bs, TREE_OP_ADD) != 0)
+			rc = 0;
 
-		if (resresv->nspec_arr != NULL) {
-			resresv->execselect = parse_selspec(selectspec);
-			free(selectspec);
+	num_ids = count_array((void **) ids);
+	if (rc && num_ids > 0) {
+		if ((jobs_arr = malloc(num_ids * sizeof(struct batch_status *))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			rc = 0;
 		}
+	}
 
-		/* Find out if it is a shrink-to-fit job.
-		 * If yes, set the duration to max walltime.
-		 */
-		req = find_resource_req(resresv->resreq, getallres(RES_MIN_WALLTIME));
-		if (req != NULL) {
-			resresv->is_shrink_to_fit = 1;
-			/* Set the min duration */
-			resresv->min_duration = (time_t) req->amount;
-			req = find_resource_req(resresv->resreq, getallres(RES_MAX_WALLTIME));
+	/* Pick each job from the changed set first, and from the cache second.
+	 * Found jobs are removed from the index they came from.  Whatever is
+	 * left in an index afterwards is no longer referenced and is freed below.
+	 */
+	for (i = 0; rc && i < num_ids; i++) {
+		if ((bs = find_tree(chg_idx, ids[i])) != NULL)
+			tree_add_del(chg_idx, ids[i], NULL, TREE_OP_DEL);
+		else if ((bs = find_tree(jqc->idx, ids[i])) != NULL) {
+			tree_add_del(jqc->idx, ids[i], NULL, TREE_OP_DEL);
+			age_cached_job(bs, now - jqc->last_update);
+		} else
+			rc = 0;
+		jobs_arr[i] = bs;
+	}
 
-#ifdef NAS /* localmod 026 */
-			/* if no max_walltime is set then we want to look at what walltime
-			 * is (if it's set at all) - it may be user-specified, queue default,
-			 * queue max, or server max.
-			 */
-			if (req == NULL) {
-				req = find_resource_req(resresv->resreq, getallres(RES_WALLTIME));
+	if (!rc) {
+		pbs_statfree(changed);
+		avl_destroy_index(chg_idx);
+		free(chg_idx);
+		free(jobs_arr);
+		return 0;
+	}
 
-				/* if walltime is set, use it if it's greater than min_walltime */
-				if (req != NULL && resresv->min_duration > req->amount) {
-					req = find_resource_req(resresv->resreq, getallres(RES_MIN_WALLTIME));
-				}
-			}
-#endif /* localmod 026 */
+	for (bs = jqc->jobs; bs != NULL; bs = next) {
+		next = bs->next;
+		if (find_tree(jqc->idx, bs->name) != NULL) {
+			bs->next = NULL;
+			pbs_statfree(bs);
 		}
-
-		if ((req == NULL) || (resresv->job->is_running == 1)) {
-			soft_walltime_req = find_resource_req(resresv->resreq, getallres(RES_SOFT_WALLTIME));
-			walltime_req = find_resource_req(resresv->resreq, getallres(RES_WALLTIME));
-			if (soft_walltime_req != NULL)
-				req = soft_walltime_req;
-			else
-				req = walltime_req;
+	}
+	for (bs = changed; bs != NULL; bs = next) {
+		next = bs->next;
+		if (find_tree(chg_idx, bs->name) != NULL) {
+			bs->next = NULL;
+			pbs_statfree(bs);
 		}
+	}
+	avl_destroy_index(chg_idx);
+	free(chg_idx);
 
-		if (req != NULL)
-			duration = (long)req->amount;
-		else /* set to virtual job infinity: 5 years */
-			duration = JOB_INFINITY;
-
-
-		if (walltime_req != NULL)
-			resresv->hard_duration = (long)walltime_req->amount;
-		else if (resresv->min_duration != UNSPECIFIED)
-			resresv->hard_duration = resresv->min_duration;
-		else
-			resresv->hard_duration = JOB_INFINITY;
+	jqc->jobs = NULL;
+	for (i = num_ids - 1; i >= 0; i--) {
+		jobs_arr[i]->next = jqc->jobs;
+		jqc->jobs = jobs_arr[i];
+	}
+	free(jobs_arr);
 
-		if (resresv->job->stime != UNSPECIFIED &&
-			!(resresv->job->is_queued || resresv->job->is_suspended) &&
-			resresv->ninfo_arr != NULL) {
-			start = resresv->job->stime;
+	return index_jq_cache(jqc);
+}
 
-			/* if a job is exiting, then its end time can be more closely
-			 * estimated by setting it to now + EXITING_TIME
-			 */
-			if (resresv->job->is_exiting)
-				end = server_time + EXITING_TIME;
-			/* Normal Case: Job's end is start + duration and it ends in the future */
-			else if (start + duration >= server_time)
-				end = start + duration;
-			/* Duration has been exceeded - either extend soft_walltime or expect the job to be killed */
-			else {
-				if (soft_walltime_req != NULL) {
-					duration = extend_soft_walltime(resresv, server_time);
-					if (duration > soft_walltime_req->amount) {
-						char timebuf[128];
-						convert_duration_to_str(duration, timebuf, 128);
-						update_job_attr(pbs_sd, resresv, ATTR_estimated, "soft_walltime", timebuf, NULL, UPDATE_NOW);
-					}
-				} else 
-					/* Job has exceeded its walltime.  It'll soon be killed and be put into the exiting state.
-					 * Change the duration of the job to match the current situation and assume it will end in
-					 * now + EXITING_TIME
-					 */
-					duration =  server_time - start + EXITING_TIME;
-				end = start + duration;
-			}
-			resresv->start = start;
-			resresv->end = end;
-		}
-		resresv->duration = duration;
+/**
+ * @brief
+ *		bring a queued job cache entry up to date with a server.  Only the
+ *		jobs which changed since the last refresh are transferred.  The
+ *		rest are kept.  Every INCR_QUERY_FULL_REFRESH refreshes, or if the
+ *		cache is found to be inconsistent with the server, all the jobs
+ *		are queried.
+ *
+ * @param[in]	jqc	-	cache entry
+ * @param[in]	pbs_sd	-	connection to the server
+ * @param[in]	queue_name	-	name of the queue on that server
+ * @param[in]	attrib	-	attributes to query
+ * @param[in]	now	-	time of the refresh
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: error, the cache is left as it was if the server
+ *			  could not be queried
+ *
+ * @par MT-safe: No
+ */
+static int
+refresh_jq_cache(struct jq_cache *jqc, int pbs_sd, char *queue_name, struct attrl *attrib, time_t now)
+{
+	struct batch_status *changed;
+	char **ids;
+	char hwm_str[32];
+	int full;
+	struct attropl opl[4] = {
+		{ &opl[1], ATTR_q, NULL, NULL, EQ },
+		{ &opl[2], ATTR_state, NULL, "Q", EQ },
+		{ NULL, ATTR_array, NULL, "True", NE },
+		{ NULL, ATTR_mtime, NULL, hwm_str, GE }
+	};
 
+	opl[0].value = queue_name;
 
-		if (qinfo->is_peer_queue) {
-			resresv->is_peer_ob = 1;
-			resresv->job->peer_sd = pbs_sd;
-		}
+	full = (jqc->idx == NULL || jqc->incr_cycles >= INCR_QUERY_FULL_REFRESH);
+	while (1) {
+		if (full) {
+			opl[2].next = NULL;
+			changed = pbs_selstat(pbs_sd, opl, attrib, NULL);
+			if (changed == NULL && pbs_errno > 0)
+				break;
 
-		/* if the fairshare entity was not set by query_job(), then check
-		 * if it's 'queue' and if so, set the group info to the queue name
-		 */
-		if (!strcmp(conf.fairshare_ent, "queue")) {
-			if (resresv->server->fairshare !=NULL) {
-				resresv->job->ginfo =
-					find_alloc_ginfo(qinfo->name, resresv->server->fairshare->root);
+			clear_jq_cache(jqc);
+			jqc->jobs = changed;
+			jqc->last_update = now;
+			if (index_jq_cache(jqc) == 0) {
+				clear_jq_cache(jqc);
+				return 0;
 			}
-			else
-				resresv->job->ginfo = NULL;
+			return 1;
 		}
 
-		/* if fairshare_ent is invalid or the job doesn't have one, give a default
-		 * of something most likely unique - egroup:euser
+		/* Get the ids before the changes.  A job which changes in between
+		 * will be picked up in its current form.
 		 */
+		opl[2].next = NULL;
+		ids = pbs_selectjob(pbs_sd, opl, NULL);
+		if (ids == NULL && pbs_errno > 0)
+			break;
 
-		if (resresv->job->ginfo ==NULL) {
-#ifdef NAS /* localmod 058 */
-			sprintf(fairshare_name, "%s:%s:%s", resresv->group, resresv->user,
-				(qinfo->name != NULL ? qinfo->name : ""));
-#else
-			sprintf(fairshare_name, "%s:%s", resresv->group, resresv->user);
-#endif /* localmod 058 */
-			if (resresv->server->fairshare !=NULL) {
-				resresv->job->ginfo = find_alloc_ginfo(fairshare_name,
-					resresv->server->fairshare->root);
-			}
-			else
-				resresv->job->ginfo = NULL;
-		}
-#ifdef NAS /* localmod 034 */
-		if (resresv->job->sh_info == NULL) {
-			sprintf(fairshare_name, "%s:%s", resresv->group, resresv->user);
-			resresv->job->sh_info = site_find_alloc_share(resresv->server,
-								      fairshare_name);
+		sprintf(hwm_str, "%ld", jqc->mtime_hwm);
+		opl[2].next = &opl[3];
+		changed = pbs_selstat(pbs_sd, opl, attrib, NULL);
+		if (changed == NULL && pbs_errno > 0) {
+			free(ids);
+			break;
 		}
-		site_set_share_type(resresv->server, resresv);
-#endif /* localmod 034 */
 
-		/* if the job's fairshare entity has no percentage of the machine,
-		 * the job can not run if enforce_no_shares is set
-		 */
-		if (policy->fair_share && conf.enforce_no_shares) {
-			if (resresv->job->ginfo != NULL &&
-			resresv->job->ginfo->tree_percentage == 0) {
-				set_schd_error_codes(err, NEVER_RUN, NO_FAIRSHARES);
-			}
+		if (merge_jq_cache(jqc, changed, ids, now)) {
+			free(ids);
+			jqc->last_update = now;
+			jqc->incr_cycles++;
+			return 1;
 		}
+		free(ids);
 
-		/* add the resources_used and the resource_list together.  If the resource
-		 * request is not tracked via resources_used, it's most likely a static
-		 * resource like a license which is used for the duration of the job.
-		 * Since the first resource found in the list is returned in the find
-		 * function, if it's in both lists, the one in resources_used will be
-		 * returned first
-		 */
-		req = resresv->job->resused;
+		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_QUEUE, LOG_DEBUG, jqc->qname,
+			"Queued job cache out of date, querying all jobs");
+		full = 1;
+	}
 
-		if (req != NULL) {
-			while (req->next != NULL)
-				req = req->next;
+	return 0;
+}
 
-			req->next = dup_resource_req_list(resresv->resreq);
-		}
-#ifdef NAS /* localmod 034 */
-		site_set_job_share(resresv);
-#endif /* localmod 034 */
+/**
+ * @brief
+ *		get the status of the plain (non-array) queued jobs of a local
+ *		queue.  Only the jobs which changed since the last cycle are
+ *		transferred from the server.  The rest are taken from the cache.
+ *
+ * @param[in]	pbs_sd	-	connection to pbs_server
+ * @param[in]	queue_name	-	name of the queue
+ * @param[in]	attrib	-	attributes to query
+ * @param[in]	now	-	current scheduler time
+ * @param[out]	err	-	set to 1 on error
+ *
+ * @return	struct batch_status *
+ * @retval	list of queued jobs - owned by the cache, do not free
+ * @retval	NULL	: no queued jobs or error
+ *
+ * @par MT-safe: No
+ */
+static struct batch_status *
+stat_queued_jobs_incr(int pbs_sd, char *queue_name, struct attrl *attrib, time_t now, int *err)
+{
+	struct jq_cache *jqc;
 
-		starve_num = job_starving(policy, resresv);
-		if (starve_num)
-			mark_job_starving(resresv, starve_num);
+	*err = 0;
+	if ((jqc = find_alloc_jq_cache(queue_name)) == NULL) {
+		*err = 1;
+		return NULL;
+	}
+	if (!refresh_jq_cache(jqc, pbs_sd, queue_name, attrib, now)) {
+		clear_jq_cache(jqc);
+		*err = 1;
+		return NULL;
+	}
 
-		/* Don't consider a job not in a queued state as runnable */
-		if (!in_runnable_state(resresv))
-			resresv->can_not_run = 1;
+	return jqc->jobs;
+}
 
-#ifdef RESC_SPEC
-		/* search_for_rescspec() sets jinfo->rspec */
-		if (!search_for_rescspec(resresv, qinfo->server->nodes))
-			set_schd_error_codes(err, NOT_RUN, NO_NODE_RESOURCES);
-#endif
+/**
+ * @brief
+ *		get the status of the jobs of a local queue in incremental_query
+ *		mode.  Everything other than plain queued jobs is queried in full
+ *		every cycle.  The cached queued jobs are linked to the end of the list.
+ *
+ * @param[in]	pbs_sd	-	connection to pbs_server
+ * @param[in]	queue_name	-	name of the queue
+ * @param[in]	attrib	-	attributes to query
+ * @param[in]	now	-	current scheduler time
+ * @param[out]	owned	-	part of the returned list owned by the caller
+ * @param[out]	owned_tail	-	last entry of owned to unlink before freeing
+ * @param[out]	err	-	set to 1 on error
+ *
+ * @return	struct batch_status *
+ * @retval	list of jobs in the queue
+ * @retval	NULL	: no jobs or error
+ *
+ * @par MT-safe: No
+ */
+static struct batch_status *
+stat_jobs_incr(int pbs_sd, char *queue_name, struct attrl *attrib, time_t now,
+	struct batch_status **owned, struct batch_status **owned_tail, int *err)
+{
+	struct batch_status *jobs;
+	struct batch_status *qarrays;
+	struct batch_status *cached;
+	struct batch_status *bs;
+	struct attropl opl_notq[2] = {
+		{ &opl_notq[1], ATTR_q, NULL, NULL, EQ },
+		{ NULL, ATTR_state, NULL, "Q", NE }
+	};
+	struct attropl opl_qarr[3] = {
+		{ &opl_qarr[1], ATTR_q, NULL, NULL, EQ },
+		{ &opl_qarr[2], ATTR_state, NULL, "Q", EQ },
+		{ NULL, ATTR_array, NULL, "True", EQ }
+	};
 
-		if (err->error_code != SUCCESS) {
-			update_job_can_not_run(pbs_sd, resresv, err);
-			clear_schd_error(err);
-		}
+	*owned = NULL;
+	*owned_tail = NULL;
+	*err = 0;
+	opl_notq[0].value = queue_name;
+	opl_qarr[0].value = queue_name;
 
-		resresv_arr[i++] = resresv;
-		resresv_arr[i] = NULL;	/* Make array searchable */
+	jobs = pbs_selstat(pbs_sd, opl_notq, attrib, "S");
+	if (jobs == NULL && pbs_errno > 0) {
+		*err = 1;
+		return NULL;
+	}
+	qarrays = pbs_selstat(pbs_sd, opl_qarr, attrib, "S");
+	if (qarrays == NULL && pbs_errno > 0) {
+		pbs_statfree(jobs);
+		*err = 1;
+		return NULL;
+	}
+	cached = stat_queued_jobs_incr(pbs_sd, queue_name, attrib, now, err);
+	if (*err) {
+		pbs_statfree(jobs);
+		pbs_statfree(qarrays);
+		return NULL;
+	}
 
+	if (jobs == NULL)
+		jobs = qarrays;
+	else {
+		for (bs = jobs; bs->next != NULL; bs = bs->next)
+			;
+		bs->next = qarrays;
 	}
-	resresv_arr[i] = NULL;
 
-	pbs_statfree(jobs);
-	free_schd_error(err);
+	if (jobs == NULL)
+		return cached;
 
-	return resresv_arr;
+	for (bs = jobs; bs->next != NULL; bs = bs->next)
+		;
+	bs->next = cached;
+	*owned = jobs;
+	*owned_tail = bs;
+
+	return jobs;
 }
 
 /**
  * @brief
- *		query_job - takes info from a batch_status about a job and
- *			 converts it into a resource_resv struct
+ *		free the part of a job status list which is not owned by the
+ *		incremental_query cache
  *
- *	  @param[in] job - batch_status struct of job
- *	  @param[in] qinfo - queue where job resides
- *	  @param[out] err - returns error info
+ * @param[in]	owned	-	start of the list
+ * @param[in]	owned_tail	-	last entry owned by the caller or NULL if
+ *					the whole list is owned
  *
- *	@return resource_resv
- *	@retval job (may be invalid, if so, err will report why)
- *	@retval  or NULL on error
+ * @return	nothing
  */
+static void
+free_job_stat(struct batch_status *owned, struct batch_status *owned_tail)
+{
+	if (owned_tail != NULL)
+		owned_tail->next = NULL;
+	pbs_statfree(owned);
+}
 
-resource_resv *
-query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
+/**
+ * @brief
+ *		the job attributes the scheduler queries
+ *
+ * @return	struct attrl *
+ * @retval	list of attributes, built on the first call and kept
+ */
+static struct attrl *
+job_stat_attrib(void)
 {
-	resource_resv *resresv;		/* converted job */
-	struct attrl *attrp;		/* list of attributes returned from server */
-	int count;			/* int used in string->int conversion */
-	char *endp;			/* used for strtol() */
-	resource_req *resreq;		/* resource_req list for resources requested  */
+	static struct attrl *attrib = NULL;
+	int i;
+	static char *jobattrs[] = {
+		ATTR_p,
+		ATTR_qtime,
+		ATTR_qrank,
+		ATTR_etime,
+		ATTR_stime,
+		ATTR_N,
+		ATTR_state,
+		ATTR_substate,
+		ATTR_sched_preempted,
+		ATTR_comment,
+		ATTR_released,
+		ATTR_euser,
+		ATTR_egroup,
+		ATTR_project,
+		ATTR_resv_ID,
+		ATTR_altid,
+		ATTR_SchedSelect,
+		ATTR_array_id,
+		ATTR_node_set,
+		ATTR_array,
+		ATTR_array_index,
+		ATTR_topjob_ineligible,
+		ATTR_array_indices_remaining,
+		ATTR_execvnode,
+		ATTR_l,
+		ATTR_rel_list,
+		ATTR_used,
+		ATTR_accrue_type,
+		ATTR_eligible_time,
+		ATTR_estimated,
+		ATTR_c,
+		ATTR_r,
+		ATTR_mtime,
+		NULL
+	};
 
-	if ((resresv = new_resource_resv()) == NULL)
-		return NULL;
+	if (attrib == NULL) {
+		for (i = 0; jobattrs[i] != NULL; i++) {
+			struct attrl *temp_attrl = NULL;
 
-	if ((resresv->job = new_job_info()) ==NULL) {
-		free_resource_resv(resresv);
-		return NULL;
+			temp_attrl = new_attrl();
+			temp_attrl->name = strdup(jobattrs[i]);
+			temp_attrl->next = attrib;
+			temp_attrl->value = "";
+			attrib = temp_attrl;
+		}
 	}
 
-	resresv->name = string_dup(job->name);
-	resresv->rank = get_sched_rank();
+	return attrib;
+}
 
-	attrp = job->attribs;
+/**
+ * @brief
+ *		find the queued job cache entry of a peer queue and allocate it
+ *		if it does not exist yet.  The entry is named remote_queue@remote_server.
+ *
+ * @param[in]	pq	-	peer queue
+ *
+ * @return	struct jq_cache *
+ * @retval	NULL	: on error
+ */
+static struct jq_cache *
+find_alloc_peer_cache(struct peer_queue *pq)
+{
+	char key[PBS_MAXQUEUENAME + PBS_MAXSERVERNAME + 2];
 
-	resresv->server = sinfo;
+	snprintf(key, sizeof(key), "%s@%s", pq->remote_queue, pq->remote_server);
+	return find_alloc_jq_cache(key);
+}
 
-	resresv->is_job = 1;
+/**
+ * @brief
+ *		refresh the queued job cache entry of a peer queue from the peer
+ *
+ * @param[in]	jqc	-	cache entry of the peer queue
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: the peer could not be queried, the cache is left
+ *			  as it was if possible
+ */
+static int
+refresh_peer_cache(struct jq_cache *jqc)
+{
+	char qname[PBS_MAXQUEUENAME + 1];
+	char *server;
+	char *errmsg;
+	int peer_sd;
+	int rc;
 
-	resresv->job->can_checkpoint = 1;	/* default can be checkpointed */
-	resresv->job->can_requeue = 1;		/* default can be requeued */
-	resresv->job->can_suspend = 1;		/* default can be suspended */
+	if ((server = strchr(jqc->qname, '@')) == NULL)
+		return 0;
+	snprintf(qname, sizeof(qname), "%.*s", (int) (server - jqc->qname), jqc->qname);
+	server++;
 
-	/* A Job identifier must be of the form <numeric>.<alpha> or
-	 * <numeric>[<numeric>].<alpha> in the case of job arrays, any other
-	 * form is considered malformed
-	 */
-	resresv->job->job_id = strtol(resresv->name, &endp, 10);
-	if ((*endp != '.') && (*endp != '[')) {
-		set_schd_error_codes(err, NEVER_RUN, ERR_SPECIAL);
-		set_schd_error_arg(err, SPECMSG, "Malformed job identifier");
-		resresv->is_invalid = 1;
+	jqc->next_poll = time(NULL) + conf.peer_query_refresh;
+	if ((peer_sd = pbs_connect_noblk(server, 2)) < 0) {
+		log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_REQUEST, LOG_INFO, jqc->qname,
+			"Can not connect to peer %s", server);
+		return 0;
 	}
 
-	while (attrp != NULL && !resresv->is_invalid) {
-		clear_schd_error(err);
-		if (!strcmp(attrp->name, conf.fairshare_ent)) {
-			if (sinfo->fairshare != NULL) {
-#ifdef NAS /* localmod 059 */
-				/* This is a hack to allow -A specification for testing, but
-				 * ignore most incorrect user -A values
-				 */
-				if (strchr(attrp->value, ':') != NULL) {
-					/* moved to query_jobs() in order to include the queue name
-					 resresv->job->ginfo = find_alloc_ginfo( attrp->value,
-					 sinfo->fairshare->root );
-					 */
-					/* localmod 034 */
-					resresv->job->sh_info = site_find_alloc_share(sinfo,
-						attrp->value);
-				}
-#else
-				resresv->job->ginfo = find_alloc_ginfo(attrp->value,
-					sinfo->fairshare->root);
-#endif /* localmod 059 */
+	rc = refresh_jq_cache(jqc, peer_sd, qname, job_stat_attrib(), time(NULL));
+	if (!rc) {
+		errmsg = pbs_geterrmsg(peer_sd);
+		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_QUEUE, LOG_NOTICE, jqc->qname,
+			"Failed to refresh the job status of peer queue: %s (%d)",
+			errmsg == NULL ? "" : errmsg, pbs_errno);
+	}
+	pbs_disconnect(peer_sd);
+
+	return rc;
+}
+
+/**
+ * @brief
+ *		drop a job from the peer queue caches, once it was moved to the
+ *		local server it is queried there
+ *
+ * @param[in]	jobid	-	job to drop
+ *
+ * @return	nothing
+ */
+void
+forget_peer_job(char *jobid)
+{
+	struct jq_cache *jqc;
+	struct batch_status *bs;
+	struct batch_status *prev;
+
+	for (jqc = jq_cache_head; jqc != NULL; jqc = jqc->next) {
+		if (jqc->idx == NULL || strchr(jqc->qname, '@') == NULL)
+			continue;
+		if (find_tree(jqc->idx, jobid) == NULL)
+			continue;
+		tree_add_del(jqc->idx, jobid, NULL, TREE_OP_DEL);
+		for (prev = NULL, bs = jqc->jobs; bs != NULL; prev = bs, bs = bs->next) {
+			if (!strcmp(bs->name, jobid)) {
+				if (prev == NULL)
+					jqc->jobs = bs->next;
+				else
+					prev->next = bs->next;
+				bs->next = NULL;
+				pbs_statfree(bs);
+				break;
 			}
-			else
-				resresv->job->ginfo = NULL;
-		}
-		if (!strcmp(attrp->name, ATTR_p)) { /* priority */
-			count = strtol(attrp->value, &endp, 10);
-			if (*endp == '\0')
-				resresv->job->priority = count;
-			else
-				resresv->job->priority = -1;
-#ifdef NAS /* localmod 045 */
-			resresv->job->NAS_pri = resresv->job->priority;
-#endif /* localmod 045 */
-		}
-		else if (!strcmp(attrp->name, ATTR_qtime)) { /* queue time */
-			count = strtol(attrp->value, &endp, 10);
-			if (*endp == '\0')
-				resresv->qtime = count;
-			else
-				resresv->qtime = -1;
-		}
-		else if (!strcmp(attrp->name, ATTR_qrank)) { /* queue rank */
-			count = strtol(attrp->value, &endp, 10);
-			if (*endp == '\0')
-				resresv->qrank = count;
-			else
-				resresv->qrank = -1;
-		}
-		else if (!strcmp(attrp->name, ATTR_etime)) { /* eligible time */
-			count = strtol(attrp->value, &endp, 10);
-			if (*endp == '\0')
-				resresv->job->etime = count;
-			else
-				resresv->job->etime = -1;
 		}
-		else if (!strcmp(attrp->name, ATTR_stime)) { /* job start time */
-			count = strtol(attrp->value, &endp, 10);
-			if (*endp == '\0')
-				resresv->job->stime = count;
-			else
-				resresv->job->stime = -1;
-		}
-		else if (!strcmp(attrp->name, ATTR_N))		/* job name (qsub -N) */
-			resresv->job->job_name = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_state)) { /* state of job */
-			if (set_job_state(attrp->value, resresv->job) == 0) {
-				set_schd_error_codes(err, NEVER_RUN, ERR_SPECIAL);
-				set_schd_error_arg(err, SPECMSG, "Job is in an invalid state");
-				resresv->is_invalid = 1;
-			}
+	}
+}
+
+/**
+ * @brief
+ *		find the peer server a job of a peer queue cache is queued at
+ *
+ * @param[in]	jobid	-	job to look for
+ *
+ * @return	char *
+ * @retval	name of the peer server, owned by the cache
+ * @retval	NULL	: the job is not in a peer queue cache
+ */
+char *
+find_peer_job_server(char *jobid)
+{
+	struct jq_cache *jqc;
+	char *server;
+
+	for (jqc = jq_cache_head; jqc != NULL; jqc = jqc->next) {
+		if (jqc->idx == NULL || (server = strchr(jqc->qname, '@')) == NULL)
+			continue;
+		if (find_tree(jqc->idx, jobid) != NULL)
+			return server + 1;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief
+ *		refresh the job status of the peer queues which are due.  This is
+ *		called between cycles so that a slow peer does not hold up the
+ *		cycle, which then reads the peer's jobs from the cache.
+ *
+ * @return	int
+ * @retval	seconds until the next peer queue is due
+ * @retval	-1	: no peer queues are refreshed between cycles
+ *
+ * @par MT-safe: No
+ */
+int
+poll_peer_queues(void)
+{
+	struct jq_cache *jqc;
+	time_t now;
+	int next = -1;
+	int i;
+
+	if (conf.peer_query_refresh <= 0)
+		return -1;
+
+	for (i = 0; i < NUM_PEERS && conf.peer_queues[i].local_queue != NULL; i++) {
+		/* locally-peered queues are queried on the scheduler's connection */
+		if (conf.peer_queues[i].remote_server == NULL)
+			continue;
+		if ((jqc = find_alloc_peer_cache(&conf.peer_queues[i])) == NULL)
+			continue;
+
+		now = time(NULL);
+		if (jqc->next_poll <= now) {
+			refresh_peer_cache(jqc);
+			now = time(NULL);
 		}
-		else if (!strcmp(attrp->name, ATTR_substate)) {
-			if (!strcmp(attrp->value, SUSP_BY_SCHED_SUBSTATE))
-				resresv->job->is_susp_sched = 1;
-			if (!strcmp(attrp->value, PROVISIONING_SUBSTATE))
-				resresv->job->is_provisioning = 1;
+		if (next == -1 || jqc->next_poll - now < next)
+			next = jqc->next_poll > now ? jqc->next_poll - now : 0;
+	}
+
+	return next;
+}
+
+/**
+ * @brief
+ *		get the cached status of the queued jobs of a peer queue.  The
+ *		cache is refreshed here if it was never filled or if it is older
+ *		than peer_query_stale.
+ *
+ * @param[in]	key	-	remote_queue@remote_server
+ *
+ * @return	struct batch_status *
+ * @retval	list of queued jobs - owned by the cache, do not free
+ * @retval	NULL	: no queued jobs or no usable job status
+ *
+ * @par MT-safe: No
+ */
+static struct batch_status *
+stat_peer_jobs_cached(char *key)
+{
+	struct jq_cache *jqc;
+	time_t age;
+
+	if ((jqc = find_alloc_jq_cache(key)) == NULL)
+		return NULL;
+
+	age = time(NULL) - jqc->last_update;
+	if (jqc->idx == NULL || (conf.peer_query_stale > 0 && age > conf.peer_query_stale)) {
+		if (!refresh_peer_cache(jqc)) {
+			if (jqc->idx != NULL)
+				log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_QUEUE, LOG_NOTICE, key,
+					"Peer queue job status is %ld seconds old, ignoring its jobs",
+					(long) age);
+			return NULL;
 		}
-		else if (!strcmp(attrp->name, ATTR_sched_preempted)) {
-			count = strtol(attrp->value, &endp, 10);
-			if (*endp == '\0') {
-				resresv->job->time_preempted = count;
-				resresv->job->is_preempted = 1;
-			}
-		}
-		else if (!strcmp(attrp->name, ATTR_comment))	/* job comment */
-			resresv->job->comment = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_released)) /* resources_released */
-			resresv->job->resreleased = parse_execvnode(attrp->value, sinfo);
-		else if (!strcmp(attrp->name, ATTR_euser))	/* account name */
-			resresv->user = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_egroup))	/* group name */
-			resresv->group = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_project))	/* project name */
-			resresv->project = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_resv_ID))	/* reserve_ID */
-			resresv->job->resv_id = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_altid))    /* vendor ID */
-			resresv->job->alt_id = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_SchedSelect))
-#ifdef NAS /* localmod 031 */
-		{
-			resresv->job->schedsel = string_dup(attrp->value);
-#endif /* localmod 031 */
-
-			resresv->select = parse_selspec(attrp->value);
-#ifdef NAS /* localmod 031 */
-		}
-#endif /* localmod 031 */
-		else if (!strcmp(attrp->name, ATTR_array_id))
-			resresv->job->array_id = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_node_set))
-			resresv->node_set_str = break_comma_list(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_array)) { /* array */
-			if (!strcmp(attrp->value, ATR_TRUE))
-				resresv->job->is_array = 1;
-		}
-		else if (!strcmp(attrp->name, ATTR_array_index)) { /* array_index */
-			count = strtol(attrp->value, &endp, 10);
-			if (*endp == '\0')
-				resresv->job->array_index = count;
-			else
-				resresv->job->array_index = -1;
-
-			resresv->job->is_subjob = 1;
-		}
-		else if (!strcmp(attrp->name, ATTR_topjob_ineligible)) {
-			if (!strcmp(attrp->value, ATR_TRUE))
-				resresv->job->topjob_ineligible = 1;
-		}
-		/* array_indices_remaining */
-		else if (!strcmp(attrp->name, ATTR_array_indices_remaining))
-			resresv->job->queued_subjobs = range_parse(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_execvnode)) { /* where job is running*/
-			/*
-			 * An execvnode may have a vnode chunk in it multiple times.
-			 * parse_execvnode() will return us a nspec array with a nspec per
-			 * chunk.  The rest of the scheduler expects one nspec per vnode.
-			 * This combining of vnode chunks is the job of combine_nspec_array().
-			 */
-			resresv->nspec_arr = parse_execvnode(attrp->value, sinfo);
-			combine_nspec_array(resresv->nspec_arr);
-
-			if (resresv->nspec_arr != NULL)
-				resresv->ninfo_arr = create_node_array_from_nspec(resresv->nspec_arr);
-		}
-		else if (!strcmp(attrp->name, ATTR_l)) { /* resources requested*/
-			resreq = find_alloc_resource_req_by_str(resresv->resreq, attrp->resource);
-			if (resreq == NULL) {
-				free_resource_resv(resresv);
-				return NULL;
-			}
-
-			if (set_resource_req(resreq, attrp->value) != 1) {
-				set_schd_error_codes(err, NEVER_RUN, ERR_SPECIAL);
-				set_schd_error_arg(err, SPECMSG, "Bad requested resource data");
-				resresv->is_invalid = 1;
-			} else {
-				if (resresv->resreq == NULL)
-					resresv->resreq = resreq;
-#ifdef NAS
-				if (!strcmp(attrp->resource, "nodect")) { /* nodect for sort */
-					/* localmod 040 */
-					count = strtol(attrp->value, &endp, 10);
-					if (*endp == '\0')
-						resresv->job->nodect = count;
-					else
-						resresv->job->nodect = 0;
-					/* localmod 034 */
-					resresv->job->accrue_rate = resresv->job->nodect; /* XXX should be SBU rate */
-				}
-#endif
-				if (!strcmp(attrp->resource, "place")) {
-					resresv->place_spec = parse_placespec(attrp->value);
-					if (resresv->place_spec == NULL) {
-						set_schd_error_codes(err, NEVER_RUN, ERR_SPECIAL);
-						set_schd_error_arg(err, SPECMSG, "invalid placement spec");
-						resresv->is_invalid = 1;
-
-					}
-				}
-			}
-		}
-		else if (!strcmp(attrp->name, ATTR_rel_list)) {
-			resreq = find_alloc_resource_req_by_str(resresv->job->resreq_rel, attrp->resource);
-			if (resreq != NULL)
-				set_resource_req(resreq, attrp->value);
-			if (resresv->job->resreq_rel == NULL)
-				resresv->job->resreq_rel = resreq;
-		}
-		else if (!strcmp(attrp->name, ATTR_used)) { /* resources used */
-			resreq =
-				find_alloc_resource_req_by_str(resresv->job->resused, attrp->resource);
-			if (resreq != NULL)
-				set_resource_req(resreq, attrp->value);
-			if (resresv->job->resused ==NULL)
-				resresv->job->resused = resreq;
-		}
-		else if (!strcmp(attrp->name, ATTR_accrue_type)) {
-			count = strtol(attrp->value, &endp, 10);
-			if (*endp == '\0')
-				resresv->job->accrue_type = count;
-			else
-				resresv->job->accrue_type = 0;
-		}
-		else if (!strcmp(attrp->name, ATTR_eligible_time))
-			resresv->job->eligible_time = (time_t) res_to_num(attrp->value, NULL);
-		else if (!strcmp(attrp->name, ATTR_estimated)) {
-			if (!strcmp(attrp->resource, "start_time")) {
-				resresv->job->est_start_time =
-					(time_t) res_to_num(attrp->value, NULL);
-			}
-			else if (!strcmp(attrp->resource, "execvnode"))
-				resresv->job->est_execvnode = string_dup(attrp->value);
-		}
-		else if (!strcmp(attrp->name, ATTR_c)) { /* checkpoint allowed? */
-			if (strcmp(attrp->value, "n") == 0)
-				resresv->job->can_checkpoint = 0;
-		}
-		else if (!strcmp(attrp->name, ATTR_r)) { /* reque allowed ? */
-			if (strcmp(attrp->value, ATR_FALSE) == 0)
-				resresv->job->can_requeue = 0;
-		}
-
-		attrp = attrp->next;
+		age = 0;
 	}
 
-	return resresv;
+	log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_QUEUE, LOG_DEBUG, key,
+		"Using peer queue job status from %ld seconds ago", (long) age);
+
+	return jqc->jobs;
 }
 
 /**
- *	@brief
- *		job_info constructor
+ * @brief
+ * 		create an array of jobs in a specified queue
  *
- * @return job_info *
+ * @par NOTE:
+ * 		anything reservation related needs to happen in
+ *		query_reservations().  Since it is called after us,
+ *		reservations aren't available at this point.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	pbs_sd	-	connection to pbs_server
+ * @param[in]	qinfo	-	queue to get jobs from
+ * @param[in]	pjobs   -	possible job array to add too
+ * @param[in]	queue_name	-	the name of the queue to query (local/remote)
+ *				or remote_queue@remote_server for a peer queue
+ *				whose jobs come from the cache (pbs_sd is -1)
+ *
+ * @return	pointer to the head of a list of jobs
+ * @par MT-safe: No
  */
-job_info *
-new_job_info()
+resource_resv **
+query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs, char *queue_name)
 {
-	job_info *jinfo;
+	/* pbs_selstat() takes a linked list of attropl structs which tell it
+	 * what information about what jobs to return.  We want all jobs which are
+	 * in a specified queue
+	 */
+	struct attropl opl = { NULL, ATTR_q, NULL, NULL, EQ };
+	static struct attropl opl2[2] = { { &opl2[1], ATTR_state, NULL, "Q", EQ},
+		{ NULL, ATTR_array, NULL, "True", NE} };
+	struct attrl *attrib;
+	int i;
 
-	if ((jinfo = (job_info *) malloc(sizeof(job_info))) == NULL) {
-		log_err(errno, "new_job_info", MEM_ERR_MSG);
-		return NULL;
-	}
+	/* linked list of jobs returned from pbs_selstat() */
+	struct batch_status *jobs;
 
-	jinfo->is_queued = 0;
-	jinfo->is_running = 0;
-	jinfo->is_held = 0;
-	jinfo->is_waiting = 0;
-	jinfo->is_transit = 0;
-	jinfo->is_exiting = 0;
-	jinfo->is_suspended = 0;
-	jinfo->is_susp_sched = 0;
-	jinfo->is_userbusy = 0;
-	jinfo->is_begin = 0;
-	jinfo->is_expired = 0;
-	jinfo->is_checkpointed = 0;
-	jinfo->accrue_type=0;
-	jinfo->eligible_time=0;
-	jinfo->can_not_preempt = 0;
-	jinfo->topjob_ineligible = 0;
+	/* part of jobs to free, the rest belongs to the incremental_query cache */
+	struct batch_status *owned = NULL;
+	struct batch_status *owned_tail = NULL;
+	int stat_err = 0;
 
-	jinfo->is_starving = 0;
-	jinfo->is_array = 0;
-	jinfo->is_subjob = 0;
+	/* current job in jobs linked list */
+	struct batch_status *cur_job;
 
-	jinfo->can_checkpoint = 1; /* default can be checkpointed */
-	jinfo->can_requeue = 1;	   /* default can be reuqued */
-	jinfo->can_suspend = 1;    /* default can be suspended */
+	/* array of internal scheduler structures for jobs */
+	resource_resv **resresv_arr;
 
-	jinfo->is_provisioning = 0;
-	jinfo->is_preempted = 0;
+	/* current job in resresv_arr array */
+	resource_resv *resresv;
 
-	jinfo->job_name = NULL;
-	jinfo->comment = NULL;
-	jinfo->job_name = NULL;
-	jinfo->resv_id = NULL;
-	jinfo->alt_id = NULL;
-	jinfo->queue = NULL;
-	jinfo->resv = NULL;
-	jinfo->priority = 0;
-	jinfo->etime = UNSPECIFIED;
-	jinfo->stime = UNSPECIFIED;
-	jinfo->preempt = 0;
-	jinfo->preempt_status = 0;
-	jinfo->peer_sd = -1;
-	jinfo->est_start_time = UNSPECIFIED;
-	jinfo->time_preempted = UNSPECIFIED;
-	jinfo->est_execvnode = NULL;
-	jinfo->resused = NULL;
-	jinfo->ginfo = NULL;
+	/* number of jobs in resresv_arr */
+	int num_jobs = 0;
+	/* number of jobs in pjobs */
+	int num_prev_jobs;
 
-	jinfo->array_id = NULL;
-	jinfo->array_index = UNSPECIFIED;
-	jinfo->queued_subjobs = NULL;
-	jinfo->parent_job = NULL;
-	jinfo->attr_updates = NULL;
-	jinfo->resreleased = NULL;
-	jinfo->resreq_rel = NULL;
 
+	/* how starving is a starving job */
+	long starve_num;
 
-	jinfo->formula_value = 0.0;
+	/* string to look up a group_info */
+	char fairshare_name[100];
 
-#ifdef RESC_SPEC
-	jinfo->rspec = NULL;
-#endif
+	/* used to add the resources_used to resource list */
+	resource_req *req;
 
-#ifdef NAS
-	/* localmod 045 */
-	jinfo->NAS_pri = 0;
-	/* localmod 034 */
-	jinfo->sh_amts = NULL;
-	jinfo->sh_info = NULL;
-	jinfo->accrue_rate = 0;
-	/* localmod 040 */
-	jinfo->nodect = 0;
-	/* localmod 031 */
-	jinfo->schedsel = NULL;
-	/* localmod 053 */
-	jinfo->u_info = NULL;
-#endif
+	schd_error *err;
 
-	return jinfo;
-}
+	/* used for pbs_geterrmsg() */
+	char *errmsg;
 
-/**
- *	@brief
- *		job_info destructor
- *
- * @param[in,out]	jinfo	-	Job Info structure to be freed.
- */
+	/* Determine start, end, and duration */
+	resource_req *walltime_req = NULL;
+	resource_req *soft_walltime_req = NULL;
+	time_t start;
+	time_t end;
+	time_t server_time;
+	long duration;
 
-void
-free_job_info(job_info *jinfo)
-{
-	if (jinfo->comment != NULL)
-		free(jinfo->comment);
+	if (policy == NULL || qinfo == NULL || queue_name == NULL)
+		return pjobs;
 
-	if (jinfo->job_name != NULL)
-		free(jinfo->job_name);
+	opl.value = queue_name;
 
-	if (jinfo->resv_id != NULL)
-		free(jinfo->resv_id);
+	if (qinfo->is_peer_queue)
+		opl.next = &opl2[0];
 
-	if (jinfo->alt_id != NULL)
-		free(jinfo->alt_id);
+	server_time = qinfo->server->server_time;
+	attrib = job_stat_attrib();
 
-	if (jinfo->est_execvnode != NULL)
-		free(jinfo->est_execvnode);
+	/* get jobs from PBS server */
+	if (qinfo->is_peer_queue && pbs_sd < 0)
+		jobs = stat_peer_jobs_cached(queue_name);
+	else if (conf.incr_query && !qinfo->is_peer_queue)
+		jobs = stat_jobs_incr(pbs_sd, queue_name, attrib, server_time,
+			&owned, &owned_tail, &stat_err);
+	else {
+		jobs = pbs_selstat(pbs_sd, &opl, attrib, "S");
+		owned = jobs;
+		stat_err = (jobs == NULL && pbs_errno > 0);
+	}
 
-	if (jinfo->array_id != NULL)
-		free(jinfo->array_id);
+	if (jobs == NULL) {
+		if (stat_err) {
+			errmsg = pbs_geterrmsg(pbs_sd);
+			if (errmsg == NULL)
+				errmsg = "";
+			log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_NOTICE, "job_info", 
+				 "pbs_selstat failed: %s (%d)", errmsg, pbs_errno);
+		}
+		return pjobs;
+	}
 
-	if (jinfo->queued_subjobs != NULL)
-		free_range_list(jinfo->queued_subjobs);
+	/* count the number of new jobs */
+	cur_job = jobs;
+	while (cur_job != NULL) {
+		num_jobs++;
+		cur_job = cur_job->next;
+	}
 
-	free_resource_req_list(jinfo->resused);
+	/* if there are previous jobs, count those too */
+	num_prev_jobs = count_array((void **)pjobs);
+	num_jobs += num_prev_jobs;
 
-	free_attrl_list(jinfo->attr_updates);
 
-	free_resource_req_list(jinfo->resreq_rel);
+	/* allocate enough space for all the jobs and the NULL sentinal */
+	if (pjobs != NULL)
+		resresv_arr = (resource_resv **)
+			realloc(pjobs, sizeof(resource_resv*) * (num_jobs + 1));
+	else
+		resresv_arr = (resource_resv **)
+			malloc(sizeof(resource_resv*) * (num_jobs + 1));
 
-	free_nspecs(jinfo->resreleased);
+	if (resresv_arr == NULL) {
+		log_err(errno, "query_jobs", "Error allocating memory");
+		free_job_stat(owned, owned_tail);
+		return NULL;
+	}
+	resresv_arr[num_prev_jobs] = NULL;
 
-#ifdef RESC_SPEC
-	free_rescspec(jinfo->rspec);
-#endif
-#ifdef NAS
-	/* localmod 034 */
-	if (jinfo->sh_amts)
-		free(jinfo->sh_amts);
+	err = new_schd_error();
+	if(err == NULL) {
+		free_resource_resv_array(resresv_arr);
+		return NULL;
+	}
 
-	/* localmod 031 */
-	if (jinfo->schedsel)
-		free(jinfo->schedsel);
-#endif
+	i = num_prev_jobs;
+	for (cur_job = jobs; cur_job != NULL; cur_job = cur_job->next) {
+		char *selectspec = NULL;
+		if ((resresv = query_job(cur_job, qinfo->server, err)) ==NULL) {
+			free_schd_error(err);
+			free_job_stat(owned, owned_tail);
+			free_resource_resv_array(resresv_arr);
+			return NULL;
+		}
 
-	free(jinfo);
-}
+		/* do a validity check to see if the job is sane.  If we're peering and
+		 * we're not a manager at the remote host, we wont have necessary attribs
+		 * like euser and egroup
+		 */
+		if (resresv->is_invalid || !is_resource_resv_valid(resresv, err) ) {
+			schdlogerr(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_DEBUG, resresv->name,
+				"Job is invalid - ignoring for this cycle", err);
+			/* decrement i because we're about to increment it as part of the for()
+			 * header.  We to continue adding valid jobs to our array.  We're
+			 * freeing what we allocated and ignoring this job completely.
+			 */
+			free_resource_resv(resresv);
+			continue;
+		}
 
+		/* Make sure scheduler does not process a subjob in undesirable state*/
+		if (resresv->job->is_subjob && !resresv->job->is_running && !resresv->job->is_exiting &&
+			!resresv->job->is_suspended && !resresv->job->is_provisioning) {
+			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_RESV, LOG_DEBUG,
+				resresv->name, "Subjob found in undesirable state, ignoring this job");
+			free_resource_resv(resresv);
+			continue;
+		}
 
-/**
- * @brief
- *		set_job_state - set the state flag in a job_info structure
- *			i.e. the is_* bit
- *
- * @param[in]	state	-	the state
- * @param[in,out]	jinfo	-	the job info structure
- *
- * @return	1	-	if state is successfully set
- * @return	0	-	if state is not set
- */
-int
-set_job_state(char *state, job_info *jinfo)
-{
-	if (jinfo == NULL)
-		return 0;
+		resresv->job->queue = qinfo;
 
-	/* turn off all state bits first to make sure only 1 is set at the end */
-	jinfo->is_queued = jinfo->is_running = jinfo->is_transit =
-		jinfo->is_held = jinfo->is_waiting = jinfo->is_exiting =
-		jinfo->is_suspended = jinfo->is_userbusy = jinfo->is_begin =
-		jinfo->is_expired = 0;
+#ifdef NAS /* localmod 040 */
+		/* we modify nodect to be the same value for all jobs in queues that are
+		 * configured to ignore nodect key sorting, for two reasons:
+		 * 1. obviously to accomplish ignoring of nodect key sorting
+		 * 2. maintain stability of qsort when comparing with a job in a queue that
+		 *    does not require nodect key sorting
+		 * note that this assumes nodect is used only for sorting
+		 */
+		if (qinfo->ignore_nodect_sort)
+			resresv->job->nodect = 999999;
+#endif /* localmod 040 */
 
-	switch (state[0]) {
-		case 'Q':
-			jinfo->is_queued = 1;
-			break;
+		if ((resresv->aoename = getaoename(resresv->select)) != NULL)
+			resresv->is_prov_needed = 1;
+		if ((resresv->eoename = geteoename(resresv->select)) != NULL) {
+			/* job with a power profile can't be checkpointed or suspended */
+			resresv->job->can_checkpoint = 0;
+			resresv->job->can_suspend = 0;
+		}
 
-		case 'R':
-			jinfo->is_running = 1;
-			break;
+		if (resresv->select != NULL && resresv->select->chunks != NULL) {
+			/*
+			 * Job is invalid if there are no resources in a chunk.  Usually
+			 * happens because we strip out resources not in conf.res_to_check
+			 */
+			int k;
+			for (k = 0; resresv->select->chunks[k] != NULL; k++)
+				if (resresv->select->chunks[k]->req == NULL) {
+					set_schd_error_codes(err, NEVER_RUN, INVALID_RESRESV);
+					set_schd_error_arg(err, ARG1, "invalid chunk in select");
+					break;
+				}
+		}
+		if (resresv->place_spec->scatter &&
+			resresv->select->total_chunks >1)
+			resresv->will_use_multinode = 1;
 
-		case 'T':
-			jinfo->is_transit = 1;
-			break;
+		if (resresv->job->is_queued && resresv->nspec_arr != NULL)
+			resresv->job->is_checkpointed = 1;
 
-		case 'H':
-			jinfo->is_held = 1;
-			break;
+		/* If we did not wait for mom to start the job (throughput mode),
+		 * it is possible that we’re seeing a running job without a start time set.
+		 * The stime is set when the mom reports back to the server to say the job is running.
+		 */
+		if ((resresv->job->is_running) && (resresv->job->stime == UNSPECIFIED))
+			resresv->job->stime = server_time + 1;
 
-		case 'W':
-			jinfo->is_waiting = 1;
-			break;
+		/* Assumption: Parent job array will be queried before running subjobs.
+		 * This is because the subjobs do not become real jobs until after they are run
+		 * If this assumption is ever proven false, nothing bad will really
+		 * happen.  This is here for consistencies sake mostly.
+		 */
+		if(resresv->job->array_id != NULL)
+			resresv->job->parent_job = find_resource_resv(resresv_arr, resresv->job->array_id);
 
-		case 'E':
-			jinfo->is_exiting = 1;
-			break;
+		/* For jobs that have an exec_vnode, we create a "select" based
+		 * on its exec_vnode.  We do this so if we ever need to run the job 
+		 * again, we will replace the job on the exact vnodes/resources it originally used.
+		 */
+		if (resresv->job->is_suspended && resresv->job->resreleased != NULL)
+			/* For jobs that are suspended and have resource_released, the "select" 
+			* we create is based off of resources_released instead of the exec_vnode.
+			*/
+			selectspec = create_select_from_nspec(resresv->job->resreleased);
+		else if (resresv->nspec_arr != NULL)
+			selectspec = create_select_from_nspec(resresv->nspec_arr);
 
-		case 'S':
-			jinfo->is_suspended = 1;
-			break;
+		if (resresv->nspec_arr != NULL) {
+			resresv->execselect = parse_selspec(selectspec);
+			free(selectspec);
+		}
 
-		case 'U':
-			jinfo->is_userbusy = 1;
-			break;
+		/* Find out if it is a shrink-to-fit job.
+		 * If yes, set the duration to max walltime.
+		 */
+		req = find_resource_req(resresv->resreq, getallres(RES_MIN_WALLTIME));
+		if (req != NULL) {
+			resresv->is_shrink_to_fit = 1;
+			/* Set the min duration */
+			resresv->min_duration = (time_t) req->amount;
+			req = find_resource_req(resresv->resreq, getallres(RES_MAX_WALLTIME));
 
-		case 'B':
-			jinfo->is_begin = 1;
-			break;
+#ifdef NAS /* localmod 026 */
+			/* if no max_walltime is set then we want to look at what walltime
+			 * is (if it's set at all) - it may be user-specified, queue default,
+			 * queue max, or server max.
+			 */
+			if (req == NULL) {
+				req = find_resource_req(resresv->resreq, getallres(RES_WALLTIME));
 
-		case 'X':
-			jinfo->is_expired = 1;
-			break;
+				/* if walltime is set, use it if it's greater than min_walltime */
+				if (req != NULL && resresv->min_duration > req->amount) {
+					req = find_resource_req(resresv->resreq, getallres(RES_MIN_WALLTIME));
+				}
+			}
+#endif /* localmod 026 */
+		}
 
-		default:
-			return 0;
-	}
-	return 1;
-}
+		if ((req == NULL) || (resresv->job->is_running == 1)) {
+			soft_walltime_req = find_resource_req(resresv->resreq, getallres(RES_SOFT_WALLTIME));
+			walltime_req = find_resource_req(resresv->resreq, getallres(RES_WALLTIME));
+			if (soft_walltime_req != NULL)
+				req = soft_walltime_req;
+			else
+				req = walltime_req;
+		}
 
-/**
- * @brief
- * 		update job attributes on the server
- *
- * @param[in]	pbs_sd     -	connection to the pbs_server
- * @param[in]	resresv    -	job to update
- * @param[in]	attr_name  -	the name of the attribute to alter
- * @param[in]	attr_resc  -	resource part of the attribute (if any)
- * @param[in]	attr_value -	the value of the attribute to alter (as a str)
- * @param[in]	extra	-	extra attrl attributes to tag along on the alterjob
- * @param[in]	flags	-	UPDATE_NOW - call send_attr_updates() to update the attribute now
- *			     			UPDATE_LATER - attach attribute change to job to be sent all at once
- *							for the job.  NOTE: Only the jobs that are part
- *							of the server in main_sched_loop() will be updated in this way.
- *
- * @retval	1	attributes were updated or successfully attached to job
- * @retval	0	no attributes were updated for a valid reason
- * @retval -1	no attributes were updated for an error
- *
- */
-int
-update_job_attr(int pbs_sd, resource_resv *resresv, char *attr_name,
-	char *attr_resc, char *attr_value, struct attrl *extra, unsigned int flags)
-{
-	struct attrl *pattr = NULL;
-	struct attrl *pattr2 = NULL;
-	struct attrl *end;
+		if (req != NULL)
+			duration = (long)req->amount;
+		else /* set to virtual job infinity: 5 years */
+			duration = JOB_INFINITY;
 
-	if (resresv == NULL  ||
-		(attr_name == NULL && attr_value == NULL && extra == NULL))
-		return -1;
 
-	if (extra == NULL && (attr_name == NULL || attr_value == NULL))
-		return -1;
+		if (walltime_req != NULL)
+			resresv->hard_duration = (long)walltime_req->amount;
+		else if (resresv->min_duration != UNSPECIFIED)
+			resresv->hard_duration = resresv->min_duration;
+		else
+			resresv->hard_duration = JOB_INFINITY;
 
-	if (!resresv->is_job)
-		return 0;
+		if (resresv->job->stime != UNSPECIFIED &&
+			!(resresv->job->is_queued || resresv->job->is_suspended) &&
+			resresv->ninfo_arr != NULL) {
+			start = resresv->job->stime;
 
-	/* if running in simulation then don't update but simulate that we have*/
-	if (pbs_sd == SIMULATE_SD)
-		return 1;
+			/* if a job is exiting, then its end time can be more closely
+			 * estimated by setting it to now + EXITING_TIME
+			 */
+			if (resresv->job->is_exiting)
+				end = server_time + EXITING_TIME;
+			/* Normal Case: Job's end is start + duration and it ends in the future */
+			else if (start + duration >= server_time)
+				end = start + duration;
+			/* Duration has been exceeded - either extend soft_walltime or expect the job to be killed */
+			else {
+				if (soft_walltime_req != NULL) {
+					duration = extend_soft_walltime(resresv, server_time);
+					if (duration > soft_walltime_req->amount) {
+						char timebuf[128];
+						convert_duration_to_str(duration, timebuf, 128);
+						update_job_attr(pbs_sd, resresv, ATTR_estimated, "soft_walltime", timebuf, NULL, UPDATE_NOW);
+					}
+				} else 
+					/* Job has exceeded its walltime.  It'll soon be killed and be put into the exiting state.
+					 * Change the duration of the job to match the current situation and assume it will end in
+					 * now + EXITING_TIME
+					 */
+					duration =  server_time - start + EXITING_TIME;
+				end = start + duration;
+			}
+			resresv->start = start;
+			resresv->end = end;
+		}
+		resresv->duration = duration;
 
-	/* don't try and update attributes for jobs on peer servers */
-	if (resresv->is_peer_ob)
-		return 0;
 
-	/* if we've received a SIGPIPE, it means our connection to the server
-	 * has gone away.  No need to attempt to contact again
-	 */
-	if (got_sigpipe)
-		return -1;
+		if (qinfo->is_peer_queue) {
+			resresv->is_peer_ob = 1;
+			resresv->job->peer_sd = pbs_sd;
+		}
 
-	if (attr_name == NULL && attr_value == NULL) {
-		end = pattr = dup_attrl_list(extra);
-		if(pattr == NULL)
-			return -1;
-	} else {
-		pattr = new_attrl();
+		/* if the fairshare entity was not set by query_job(), then check
+		 * if it's 'queue' and if so, set the group info to the queue name
+		 */
+		if (!strcmp(conf.fairshare_ent, "queue")) {
+			if (resresv->server->fairshare !=NULL) {
+				resresv->job->ginfo =
+					find_alloc_ginfo(qinfo->name, resresv->server->fairshare);
+			}
+			else
+				resresv->job->ginfo = NULL;
+		}
 
-		if (pattr == NULL)
-			return -1;
-		pattr->name = string_dup(attr_name);
-		pattr->value = string_dup(attr_value);
-		pattr->resource = string_dup(attr_resc);
-		end = pattr;
-		if (extra != NULL) {
-			pattr2 = dup_attrl_list(extra);
-			if (pattr2 == NULL) {
-				free_attrl(pattr);
-				return -1;
+		/* if fairshare_ent is invalid or the job doesn't have one, give a default
+		 * of something most likely unique - egroup:euser
+		 */
+
+		if (resresv->job->ginfo ==NULL) {
+#ifdef NAS /* localmod 058 */
+			sprintf(fairshare_name, "%s:%s:%s", resresv->group, resresv->user,
+				(qinfo->name != NULL ? qinfo->name : ""));
+#else
+			sprintf(fairshare_name, "%s:%s", resresv->group, resresv->user);
+#endif /* localmod 058 */
+			if (resresv->server->fairshare !=NULL) {
+				resresv->job->ginfo = find_alloc_ginfo(fairshare_name,
+					resresv->server->fairshare);
 			}
-			pattr->next = pattr2;
-			/* extra may have been a list, let's find the end */
-			for (end = pattr2; end->next != NULL; end = end ->next)
-				;
+			else
+				resresv->job->ginfo = NULL;
 		}
-	}
+#ifdef NAS /* localmod 034 */
+		if (resresv->job->sh_info == NULL) {
+			sprintf(fairshare_name, "%s:%s", resresv->group, resresv->user);
+			resresv->job->sh_info = site_find_alloc_share(resresv->server,
+								      fairshare_name);
+		}
+		site_set_share_type(resresv->server, resresv);
+#endif /* localmod 034 */
 
-	if(flags & UPDATE_LATER) {
-		end->next = resresv->job->attr_updates;
-		resresv->job->attr_updates = pattr;
+		/* if the job's fairshare entity has no percentage of the machine,
+		 * the job can not run if enforce_no_shares is set
+		 */
+		if (policy->fair_share && conf.enforce_no_shares) {
+			if (resresv->job->ginfo != NULL &&
+			resresv->job->ginfo->tree_percentage == 0) {
+				set_schd_error_codes(err, NEVER_RUN, NO_FAIRSHARES);
+			}
+		}
 
-	}
+		/* add the resources_used and the resource_list together.  If the resource
+		 * request is not tracked via resources_used, it's most likely a static
+		 * resource like a license which is used for the duration of the job.
+		 * Since the first resource found in the list is returned in the find
+		 * function, if it's in both lists, the one in resources_used will be
+		 * returned first
+		 */
+		req = resresv->job->resused;
+
+		if (req != NULL) {
+			while (req->next != NULL)
+				req = req->next;
+
+			req->next = dup_resource_req_list(resresv->resreq);
+		}
+#ifdef NAS /* localmod 034 */
+		site_set_job_share(resresv);
+#endif /* localmod 034 */
+
+		starve_num = job_starving(policy, resresv);
+		if (starve_num)
+			mark_job_starving(resresv, starve_num);
+
+		/* Don't consider a job not in a queued state as runnable */
+		if (!in_runnable_state(resresv))
+			resresv->can_not_run = 1;
+
+#ifdef RESC_SPEC
+		/* search_for_rescspec() sets jinfo->rspec */
+		if (!search_for_rescspec(resresv, qinfo->server->nodes))
+			set_schd_error_codes(err, NOT_RUN, NO_NODE_RESOURCES);
+#endif
+
+		if (err->error_code != SUCCESS) {
+			update_job_can_not_run(pbs_sd, resresv, err);
+			clear_schd_error(err);
+		}
+
+		resresv_arr[i++] = resresv;
+		resresv_arr[i] = NULL;	/* Make array searchable */
 
-	if (pattr != NULL && (flags & UPDATE_NOW)) {
-		int rc;
-		rc = send_attr_updates(pbs_sd, resresv->name, pattr);
-		free_attrl_list(pattr);
-		return rc;
 	}
+	resresv_arr[i] = NULL;
 
-	return 0;
+	free_job_stat(owned, owned_tail);
+	free_schd_error(err);
+
+	return resresv_arr;
 }
 
 /**
  * @brief
- * 		send delayed job attribute updates for job using send_attr_updates().
- *
- * @par
- * 		The main reason to use this function over a direct send_attr_update()
- *      call is so that the job's attr_updates list gets free'd and NULL'd.
- *      We don't want to send the attr updates multiple times
+ *		query_job - takes info from a batch_status about a job and
+ *			 converts it into a resource_resv struct
  *
- * @param[in]	pbs_sd	-	server connection descriptor
- * @param[in]	job	-	job to send attributes to
+ *	  @param[in] job - batch_status struct of job
+ *	  @param[in] qinfo - queue where job resides
+ *	  @param[out] err - returns error info
  *
- * @return	int(ret val from send_attr_updates)
- * @retval	1	- success
- * @retval	0	- failure to update
+ *	@return resource_resv
+ *	@retval job (may be invalid, if so, err will report why)
+ *	@retval  or NULL on error
  */
-int send_job_updates(int pbs_sd, resource_resv *job) {
-	int rc;
-
-	if(job == NULL)
-		return 0;
-
-	rc = send_attr_updates(pbs_sd, job->name, job->job->attr_updates) ;
-
-	free_attrl_list(job->job->attr_updates);
-	job->job->attr_updates = NULL;
-	return rc;
-	}
-/**
- * @brief
- * 		send delayed attributes to the server for a job
- *
- * @param[in]	pbs_sd	-	server connection descriptor
- * @param[in]	job_name	-	name of job for pbs_alterjob()
- * @param[in]	pattr	-	attrl list to update on the server
- *
- * @return	int
- * @retval	1	success
- * @retval	0	failure to update
- */
-int send_attr_updates(int pbs_sd, char *job_name, struct attrl *pattr) {
-	char *errbuf;
-	int one_attr = 0;
-
-	if (job_name == NULL || pattr == NULL)
-		return 0;
-
-	if (pbs_sd == SIMULATE_SD)
-		return 1; /* simulation always successful */
 
-	if (pattr->next == NULL)
-		one_attr = 1;
+resource_resv *
+query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
+{
+	resource_resv *resresv;		/* converted job */
+	struct attrl *attrp;		/* list of attributes returned from server */
+	int count;			/* int used in string->int conversion */
+	char *endp;			/* used for strtol() */
+	resource_req *resreq;		/* resource_req list for resources requested  */
 
-	if (pbs_alterjob(pbs_sd, job_name, pattr, NULL) == 0)
-		return 1;
+	if ((resresv = new_resource_resv()) == NULL)
+		return NULL;
 
-	if (is_finished_job(pbs_errno) == 1) {
-		if (one_attr)
-			log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_INFO, job_name,
-				   "Failed to update attr \'%s\' = %s, Job already finished",
-				   pattr->name, pattr->value);
-		else
-			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_INFO, job_name, 
-				"Failed to update job attributes, Job already finished");
-		return 0;
+	if ((resresv->job = new_job_info()) ==NULL) {
+		free_resource_resv(resresv);
+		return NULL;
 	}
 
-	errbuf = pbs_geterrmsg(pbs_sd);
-	if (errbuf == NULL)
-		errbuf = "";
-	if (one_attr)
-		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING, job_name,
-			   "Failed to update attr \'%s\' = %s: %s (%d)",
-			   pattr->name, pattr->value, errbuf, pbs_errno);
-	else
-		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING, job_name, 
-			"Failed to update job attributes: %s (%d)",
-			errbuf, pbs_errno);
-	return 0;
-}
+	resresv->name = string_dup(job->name);
+	resresv->rank = get_sched_rank();
 
-/**
- *	@brief
- *		unset job attributes on the server
- *
- * @param[in]	pbs_sd	-	connection to the pbs_server
- * @param[in]	resresv	-	job to update
- * @param[in]	attr_name	-	the name of the attribute to unset
- * @param[in]	flags	-	UPDATE_NOW : call send_attr_updates() to update the attribute now
- *			     			UPDATE_LATER - attach attribute change to job to be sent all at once
- *							for the job.  NOTE: Only the jobs that are part
- *							of the server in main_sched_loop() will be updated in this way.
- *
- *	@retval	1	: attributes were unset
- *	@retval	0	: no attributes were unset for a valid reason
- *	@retval -1	: no attributes were unset for an error
- *
- */
-int
-unset_job_attr(int pbs_sd, resource_resv *resresv, char *attr_name, unsigned int flags)
-{
-	return (update_job_attr(pbs_sd, resresv, attr_name, NULL, "", NULL, flags));
+	attrp = job->attribs;
 
-}
+	resresv->server = sinfo;
 
-/**
- * @brief
- *		update_job_comment - update a job's comment attribute.  If the job's
- *			     comment attr is identical, don't update
- *
- * @param[in]	pbs_sd	-	pbs connection descriptor
- * @param[in]	resresv -	the job to update
- * @param[in]	comment -	the comment string
- *
- * @return	int
- * @retval	1	: if the comment was updated
- * @retval	0	: if not
- *
- */
-int
-update_job_comment(int pbs_sd, resource_resv *resresv, char *comment) {
-	int rc = 0;
+	resresv->is_job = 1;
 
-	if (resresv == NULL || comment == NULL)
-		return 0;
+	resresv->job->can_checkpoint = 1;	/* default can be checkpointed */
+	resresv->job->can_requeue = 1;		/* default can be requeued */
+	resresv->job->can_suspend = 1;		/* default can be suspended */
 
-	if (!resresv->is_job || resresv->job ==NULL)
-		return 0;
+	/* A Job identifier must be of the form <numeric>.<alpha> or
+	 * <numeric>[<numeric>].<alpha> in the case of job arrays, any other
+	 * form is considered malformed
+	 */
+	resresv->job->job_id = strtol(resresv->name, &endp, 10);
+	if ((*endp != '.') && (*endp != '[')) {
+		set_schd_error_codes(err, NEVER_RUN, ERR_SPECIAL);
+		set_schd_error_arg(err, SPECMSG, "Malformed job identifier");
+		resresv->is_invalid = 1;
+	}
 
-	/* no need to update the job comment if it is the same */
-	if (resresv->job->comment == NULL ||
-		strcmp(resresv->job->comment, comment)) {
-		if (conf.update_comments) {
-			rc = update_job_attr(pbs_sd, resresv, ATTR_comment, NULL, comment, NULL, UPDATE_LATER);
-			if (rc > 0) {
-				if (resresv->job->comment !=NULL)
-					free(resresv->job->comment);
-				resresv->job->comment = string_dup(comment);
+	while (attrp != NULL && !resresv->is_invalid) {
+		clear_schd_error(err);
+		if (!strcmp(attrp->name, conf.fairshare_ent)) {
+			if (sinfo->fairshare != NULL) {
+#ifdef NAS /* localmod 059 */
+				/* This is a hack to allow -A specification for testing, but
+				 * ignore most incorrect user -A values
+				 */
+				if (strchr(attrp->value, ':') != NULL) {
+					/* moved to query_jobs() in order to include the queue name
+					 resresv->job->ginfo = find_alloc_ginfo( attrp->value,
+					 sinfo->fairshare );
+					 */
+					/* localmod 034 */
+					resresv->job->sh_info = site_find_alloc_share(sinfo,
+						attrp->value);
+				}
+#else
+				resresv->job->ginfo = find_alloc_ginfo(attrp->value,
+					sinfo->fairshare);
+#endif /* localmod 059 */
 			}
+			else
+				resresv->job->ginfo = NULL;
 		}
-	}
-	return rc;
-}
-
-/**
- * @brief
- *		update_jobs_cant_run - update an array of jobs which can not run
- *
- * @param[in]	pbs_sd	-	connection to the PBS server
- * @param[in,out]	resresv_arr	-	the array to update
- * @param[in]	start	-	the job which couldn't run
- * @param[in]	comment	-	the comment to update
- * @param[in]	log_msg	-	the message to log for the job
- *
- * @return nothing
- *
- */
-void
-update_jobs_cant_run(int pbs_sd, resource_resv **resresv_arr,
-	resource_resv *start, struct schd_error *err, int start_where)
-{
-	int i = 0;
-
-	if (resresv_arr == NULL)
-		return;
-
-	/* We are not starting at the front of the array, so we need to find the
-	 * element to start with.
-	 */
-	if (start != NULL) {
-		for (; resresv_arr[i] != NULL && resresv_arr[i] != start; i++)
-			;
-	} else
-		i = 0;
-
-	if (resresv_arr[i] != NULL) {
-		if (start_where == START_BEFORE_JOB)
-			i--;
-		else if (start_where == START_AFTER_JOB)
-			i++;
-
-		for (; resresv_arr[i] != NULL; i++) {
-			if (!resresv_arr[i]->can_not_run) {
-				update_job_can_not_run(pbs_sd, resresv_arr[i], err);
+		if (!strcmp(attrp->name, ATTR_p)) { /* priority */
+			count = strtol(attrp->value, &endp, 10);
+			if (*endp == '\0')
+				resresv->job->priority = count;
+			else
+				resresv->job->priority = -1;
+#ifdef NAS /* localmod 045 */
+			resresv->job->NAS_pri = resresv->job->priority;
+#endif /* localmod 045 */
+		}
+		else if (!strcmp(attrp->name, ATTR_qtime)) { /* queue time */
+			count = strtol(attrp->value, &endp, 10);
+			if (*endp == '\0')
+				resresv->qtime = count;
+			else
+				resresv->qtime = -1;
+		}
+		else if (!strcmp(attrp->name, ATTR_qrank)) { /* queue rank */
+			count = strtol(attrp->value, &endp, 10);
+			if (*endp == '\0')
+				resresv->qrank = count;
+			else
+				resresv->qrank = -1;
+		}
+		else if (!strcmp(attrp->name, ATTR_etime)) { /* eligible time */
+			count = strtol(attrp->value, &endp, 10);
+			if (*endp == '\0')
+				resresv->job->etime = count;
+			else
+				resresv->job->etime = -1;
+		}
+		else if (!strcmp(attrp->name, ATTR_stime)) { /* job start time */
+			count = strtol(attrp->value, &endp, 10);
+			if (*endp == '\0')
+				resresv->job->stime = count;
+			else
+				resresv->job->stime = -1;
+		}
+		else if (!strcmp(attrp->name, ATTR_N))		/* job name (qsub -N) */
+			resresv->job->job_name = string_dup(attrp->value);
+		else if (!strcmp(attrp->name, ATTR_state)) { /* state of job */
+			if (set_job_state(attrp->value, resresv->job) == 0) {
+				set_schd_error_codes(err, NEVER_RUN, ERR_SPECIAL);
+				set_schd_error_arg(err, SPECMSG, "Job is in an invalid state");
+				resresv->is_invalid = 1;
 			}
 		}
-	}
-}
-
-/**
- * @brief
- *		translate failure codes into a comment and log message
- *
- * @param[in]	err	-	error reply structure to translate
- * @param[out]	comment_msg	-	translated comment (may be NULL)
- * @param[out]	log_msg	-	translated log message (may be NULL)
- *
- * @return	int
- * @retval	1	: comment and log messages were set
- * @retval	0	: comment and log messages were not set
+		else if (!strcmp(attrp->name, ATTR_substate)) {
+			if (!strcmp(attrp->value, SUSP_BY_SCHED_SUBSTATE))
+				resresv->job->is_susp_sched = 1;
+			if (!strcmp(attrp->value, PROVISIONING_SUBSTATE))
+				resresv->job->is_provisioning = 1;
+		}
+		else if (!strcmp(attrp->name, ATTR_sched_preempted)) {
+			count = strtol(attrp->value, &endp, 10);
+			if (*endp == '\0') {
+				resresv->job->time_preempted = count;
+				resresv->job->is_preempted = 1;
+			}
+		}
+		else if (!strcmp(attrp->name, ATTR_comment))	/* job comment */
+			resresv->job->comment = string_dup(attrp->value);
+		else if (!strcmp(attrp->name, ATTR_released)) /* resources_released */
+			resresv->job->resreleased = parse_execvnode(attrp->value, sinfo);
+		else if (!strcmp(attrp->name, ATTR_euser))	/* account name */
+			resresv->user = string_intern(attrp->value);
+		else if (!strcmp(attrp->name, ATTR_egroup))	/* group name */
+			resresv->group = string_intern(attrp->value);
+		else if (!strcmp(attrp->name, ATTR_project))	/* project name */
+			resresv->project = string_intern(attrp->value);
+		else if (!strcmp(attrp->name, ATTR_resv_ID))	/* reserve_ID */
+			resresv->job->resv_id = string_dup(attrp->value);
+		else if (!strcmp(attrp->name, ATTR_altid))    /* vendor ID */
+			resresv->job->alt_id = string_dup(attrp->value);
+		else if (!strcmp(attrp->name, ATTR_SchedSelect))
+#ifdef NAS /* localmod 031 */
+		{
+			resresv->job->schedsel = string_dup(attrp->value);
+#endif /* localmod 031 */
+
+			resresv->select = parse_selspec(attrp->value);
+#ifdef NAS /* localmod 031 */
+		}
+#endif /* localmod 031 */
+		else if (!strcmp(attrp->name, ATTR_array_id))
+			resresv->job->array_id = string_dup(attrp->value);
+		else if (!strcmp(attrp->name, ATTR_node_set))
+			resresv->node_set_str = break_comma_list(attrp->value);
+		else if (!strcmp(attrp->name, ATTR_array)) { /* array */
+			if (!strcmp(attrp->value, ATR_TRUE))
+				resresv->job->is_array = 1;
+		}
+		else if (!strcmp(attrp->name, ATTR_array_index)) { /* array_index */
+			count = strtol(attrp->value, &endp, 10);
+			if (*endp == '\0')
+				resresv->job->array_index = count;
+			else
+				resresv->job->array_index = -1;
+
+			resresv->job->is_subjob = 1;
+		}
+		else if (!strcmp(attrp->name, ATTR_topjob_ineligible)) {
+			if (!strcmp(attrp->value, ATR_TRUE))
+				resresv->job->topjob_ineligible = 1;
+		}
+		/* array_indices_remaining */
+		else if (!strcmp(attrp->name, ATTR_array_indices_remaining))
+			resresv->job->queued_subjobs = range_parse(attrp->value);
+		else if (!strcmp(attrp->name, ATTR_execvnode)) { /* where job is running*/
+			/*
+			 * An execvnode may have a vnode chunk in it multiple times.
+			 * parse_execvnode() will return us a nspec array with a nspec per
+			 * chunk.  The rest of the scheduler expects one nspec per vnode.
+			 * This combining of vnode chunks is the job of combine_nspec_array().
+			 */
+			resresv->nspec_arr = parse_execvnode(attrp->value, sinfo);
+			combine_nspec_array(resresv->nspec_arr);
+
+			if (resresv->nspec_arr != NULL)
+				resresv->ninfo_arr = create_node_array_from_nspec(resresv->nspec_arr);
+		}
+		else if (!strcmp(attrp->name, ATTR_l)) { /* resources requested*/
+			resreq = find_alloc_resource_req_by_str(resresv->resreq, attrp->resource);
+			if (resreq == NULL) {
+				free_resource_resv(resresv);
+				return NULL;
+			}
+
+			if (set_resource_req(resreq, attrp->value) != 1) {
+				set_schd_error_codes(err, NEVER_RUN, ERR_SPECIAL);
+				set_schd_error_arg(err, SPECMSG, "Bad requested resource data");
+				resresv->is_invalid = 1;
+			} else {
+				if (resresv->resreq == NULL)
+					resresv->resreq = resreq;
+#ifdef NAS
+				if (!strcmp(attrp->resource, "nodect")) { /* nodect for sort */
+					/* localmod 040 */
+					count = strtol(attrp->value, &endp, 10);
+					if (*endp == '\0')
+						resresv->job->nodect = count;
+					else
+						resresv->job->nodect = 0;
+					/* localmod 034 */
+					resresv->job->accrue_rate = resresv->job->nodect; /* XXX should be SBU rate */
+				}
+#endif
+				if (!strcmp(attrp->resource, "place")) {
+					resresv->place_spec = parse_placespec(attrp->value);
+					if (resresv->place_spec == NULL) {
+						set_schd_error_codes(err, NEVER_RUN, ERR_SPECIAL);
+						set_schd_error_arg(err, SPECMSG, "invalid placement spec");
+						resresv->is_invalid = 1;
+
+					}
+				}
+			}
+		}
+		else if (!strcmp(attrp->name, ATTR_rel_list)) {
+			resreq = find_alloc_resource_req_by_str(resresv->job->resreq_rel, attrp->resource);
+			if (resreq != NULL)
+				set_resource_req(resreq, attrp->value);
+			if (resresv->job->resreq_rel == NULL)
+				resresv->job->resreq_rel = resreq;
+		}
+		else if (!strcmp(attrp->name, ATTR_used)) { /* resources used */
+			resreq =
+				find_alloc_resource_req_by_str(resresv->job->resused, attrp->resource);
+			if (resreq != NULL)
+				set_resource_req(resreq, attrp->value);
+			if (resresv->job->resused ==NULL)
+				resresv->job->resused = resreq;
+		}
+		else if (!strcmp(attrp->name, ATTR_accrue_type)) {
+			count = strtol(attrp->value, &endp, 10);
+			if (*endp == '\0')
+				resresv->job->accrue_type = count;
+			else
+				resresv->job->accrue_type = 0;
+		}
+		else if (!strcmp(attrp->name, ATTR_eligible_time))
+			resresv->job->eligible_time = (time_t) res_to_num(attrp->value, NULL);
+		else if (!strcmp(attrp->name, ATTR_estimated)) {
+			if (!strcmp(attrp->resource, "start_time")) {
+				resresv->job->est_start_time =
+					(time_t) res_to_num(attrp->value, NULL);
+			}
+			else if (!strcmp(attrp->resource, "execvnode"))
+				resresv->job->est_execvnode = string_dup(attrp->value);
+		}
+		else if (!strcmp(attrp->name, ATTR_c)) { /* checkpoint allowed? */
+			if (strcmp(attrp->value, "n") == 0)
+				resresv->job->can_checkpoint = 0;
+		}
+		else if (!strcmp(attrp->name, ATTR_r)) { /* reque allowed ? */
+			if (strcmp(attrp->value, ATR_FALSE) == 0)
+				resresv->job->can_requeue = 0;
+		}
+
+		attrp = attrp->next;
+	}
+
+	return resresv;
+}
+
+/**
+ *	@brief
+ *		job_info constructor
+ *
+ * @return job_info *
+ */
+job_info *
+new_job_info()
+{
+	job_info *jinfo;
+
+	if ((jinfo = (job_info *) malloc(sizeof(job_info))) == NULL) {
+		log_err(errno, "new_job_info", MEM_ERR_MSG);
+		return NULL;
+	}
+
+	jinfo->is_queued = 0;
+	jinfo->is_running = 0;
+	jinfo->is_held = 0;
+	jinfo->is_waiting = 0;
+	jinfo->is_transit = 0;
+	jinfo->is_exiting = 0;
+	jinfo->is_suspended = 0;
+	jinfo->is_susp_sched = 0;
+	jinfo->is_userbusy = 0;
+	jinfo->is_begin = 0;
+	jinfo->is_expired = 0;
+	jinfo->is_checkpointed = 0;
+	jinfo->accrue_type=0;
+	jinfo->eligible_time=0;
+	jinfo->can_not_preempt = 0;
+	jinfo->topjob_ineligible = 0;
+
+	jinfo->is_starving = 0;
+	jinfo->is_array = 0;
+	jinfo->is_subjob = 0;
+
+	jinfo->can_checkpoint = 1; /* default can be checkpointed */
+	jinfo->can_requeue = 1;	   /* default can be reuqued */
+	jinfo->can_suspend = 1;    /* default can be suspended */
+
+	jinfo->is_provisioning = 0;
+	jinfo->is_preempted = 0;
+
+	jinfo->job_name = NULL;
+	jinfo->comment = NULL;
+	jinfo->job_name = NULL;
+	jinfo->resv_id = NULL;
+	jinfo->alt_id = NULL;
+	jinfo->queue = NULL;
+	jinfo->resv = NULL;
+	jinfo->priority = 0;
+	jinfo->etime = UNSPECIFIED;
+	jinfo->stime = UNSPECIFIED;
+	jinfo->preempt = 0;
+	jinfo->preempt_status = 0;
+	jinfo->peer_sd = -1;
+	jinfo->est_start_time = UNSPECIFIED;
+	jinfo->time_preempted = UNSPECIFIED;
+	jinfo->est_execvnode = NULL;
+	jinfo->resused = NULL;
+	jinfo->ginfo = NULL;
+
+	jinfo->array_id = NULL;
+	jinfo->array_index = UNSPECIFIED;
+	jinfo->queued_subjobs = NULL;
+	jinfo->materialized_subjobs = NULL;
+	jinfo->parent_job = NULL;
+	jinfo->attr_updates = NULL;
+	jinfo->resreleased = NULL;
+	jinfo->resreq_rel = NULL;
+
+
+	jinfo->formula_value = 0.0;
+
+#ifdef RESC_SPEC
+	jinfo->rspec = NULL;
+#endif
+
+#ifdef NAS
+	/* localmod 045 */
+	jinfo->NAS_pri = 0;
+	/* localmod 034 */
+	jinfo->sh_amts = NULL;
+	jinfo->sh_info = NULL;
+	jinfo->accrue_rate = 0;
+	/* localmod 040 */
+	jinfo->nodect = 0;
+	/* localmod 031 */
+	jinfo->schedsel = NULL;
+	/* localmod 053 */
+	jinfo->u_info = NULL;
+#endif
+
+	return jinfo;
+}
+
+/**
+ *	@brief
+ *		job_info destructor
  *
+ * @param[in,out]	jinfo	-	Job Info structure to be freed.
+ */
+
+void
+free_job_info(job_info *jinfo)
+{
+	if (jinfo->comment != NULL)
+		free(jinfo->comment);
+
+	if (jinfo->job_name != NULL)
+		free(jinfo->job_name);
+
+	if (jinfo->resv_id != NULL)
+		free(jinfo->resv_id);
+
+	if (jinfo->alt_id != NULL)
+		free(jinfo->alt_id);
+
+	if (jinfo->est_execvnode != NULL)
+		free(jinfo->est_execvnode);
+
+	if (jinfo->array_id != NULL)
+		free(jinfo->array_id);
+
+	if (jinfo->queued_subjobs != NULL)
+		free_range_list(jinfo->queued_subjobs);
+
+	if (jinfo->materialized_subjobs != NULL)
+		free_range_list(jinfo->materialized_subjobs);
+
+	free_resource_req_list(jinfo->resused);
+
+	free_attrl_list(jinfo->attr_updates);
+
+	free_resource_req_list(jinfo->resreq_rel);
+
+	free_nspecs(jinfo->resreleased);
+
+#ifdef RESC_SPEC
+	free_rescspec(jinfo->rspec);
+#endif
+#ifdef NAS
+	/* localmod 034 */
+	if (jinfo->sh_amts)
+		free(jinfo->sh_amts);
+
+	/* localmod 031 */
+	if (jinfo->schedsel)
+		free(jinfo->schedsel);
+#endif
+
+	free(jinfo);
+}
+
+
+/**
+ * @brief
+ *		set_job_state - set the state flag in a job_info structure
+ *			i.e. the is_* bit
+ *
+ * @param[in]	state	-	the state
+ * @param[in,out]	jinfo	-	the job info structure
+ *
+ * @return	1	-	if state is successfully set
+ * @return	0	-	if state is not set
+ */
+int
+set_job_state(char *state, job_info *jinfo)
+{
+	if (jinfo == NULL)
+		return 0;
+
+	/* turn off all state bits first to make sure only 1 is set at the end */
+	jinfo->is_queued = jinfo->is_running = jinfo->is_transit =
+		jinfo->is_held = jinfo->is_waiting = jinfo->is_exiting =
+		jinfo->is_suspended = jinfo->is_userbusy = jinfo->is_begin =
+		jinfo->is_expired = 0;
+
+	switch (state[0]) {
+		case 'Q':
+			jinfo->is_queued = 1;
+			break;
+
+		case 'R':
+			jinfo->is_running = 1;
+			break;
+
+		case 'T':
+			jinfo->is_transit = 1;
+			break;
+
+		case 'H':
+			jinfo->is_held = 1;
+			break;
+
+		case 'W':
+			jinfo->is_waiting = 1;
+			break;
+
+		case 'E':
+			jinfo->is_exiting = 1;
+			break;
+
+		case 'S':
+			jinfo->is_suspended = 1;
+			break;
+
+		case 'U':
+			jinfo->is_userbusy = 1;
+			break;
+
+		case 'B':
+			jinfo->is_begin = 1;
+			break;
+
+		case 'X':
+			jinfo->is_expired = 1;
+			break;
+
+		default:
+			return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief
+ * 		update job attributes on the server
+ *
+ * @param[in]	pbs_sd     -	connection to the pbs_server
+ * @param[in]	resresv    -	job to update
+ * @param[in]	attr_name  -	the name of the attribute to alter
+ * @param[in]	attr_resc  -	resource part of the attribute (if any)
+ * @param[in]	attr_value -	the value of the attribute to alter (as a str)
+ * @param[in]	extra	-	extra attrl attributes to tag along on the alterjob
+ * @param[in]	flags	-	UPDATE_NOW - call send_attr_updates() to update the attribute now
+ *			     			UPDATE_LATER - attach attribute change to job to be sent all at once
+ *							for the job.  NOTE: Only the jobs that are part
+ *							of the server in main_sched_loop() will be updated in this way.
+ *
+ * @retval	1	attributes were updated or successfully attached to job
+ * @retval	0	no attributes were updated for a valid reason
+ * @retval -1	no attributes were updated for an error
+ *
+ */
+int
+update_job_attr(int pbs_sd, resource_resv *resresv, char *attr_name,
+	char *attr_resc, char *attr_value, struct attrl *extra, unsigned int flags)
+{
+	struct attrl *pattr = NULL;
+	struct attrl *pattr2 = NULL;
+	struct attrl *end;
+
+	if (resresv == NULL  ||
+		(attr_name == NULL && attr_value == NULL && extra == NULL))
+		return -1;
+
+	if (extra == NULL && (attr_name == NULL || attr_value == NULL))
+		return -1;
+
+	if (!resresv->is_job)
+		return 0;
+
+	/* if running in simulation then don't update but simulate that we have*/
+	if (pbs_sd == SIMULATE_SD)
+		return 1;
+
+	/* don't try and update attributes for jobs on peer servers */
+	if (resresv->is_peer_ob)
+		return 0;
+
+	/* if we've received a SIGPIPE, it means our connection to the server
+	 * has gone away.  No need to attempt to contact again
+	 */
+	if (got_sigpipe)
+		return -1;
+
+	if (attr_name == NULL && attr_value == NULL) {
+		end = pattr = dup_attrl_list(extra);
+		if(pattr == NULL)
+			return -1;
+	} else {
+		pattr = new_attrl();
+
+		if (pattr == NULL)
+			return -1;
+		pattr->name = string_dup(attr_name);
+		pattr->value = string_dup(attr_value);
+		pattr->resource = string_dup(attr_resc);
+		end = pattr;
+		if (extra != NULL) {
+			pattr2 = dup_attrl_list(extra);
+			if (pattr2 == NULL) {
+				free_attrl(pattr);
+				return -1;
+			}
+			pattr->next = pattr2;
+			/* extra may have been a list, let's find the end */
+			for (end = pattr2; end->next != NULL; end = end ->next)
+				;
+		}
+	}
+
+	if(flags & UPDATE_LATER) {
+		end->next = resresv->job->attr_updates;
+		resresv->job->attr_updates = pattr;
+
+	}
+
+	if (pattr != NULL && (flags & UPDATE_NOW)) {
+		int rc;
+		rc = send_attr_updates(pbs_sd, resresv->name, pattr);
+		free_attrl_list(pattr);
+		return rc;
+	}
+
+	return 0;
+}
+
+/* job attribute updates queued by send_job_updates(), oldest first */
+static struct batch_status *pending_updates = NULL;
+static struct batch_status *pending_updates_tail = NULL;
+static int pending_updates_ct = 0;
+static int pending_updates_sd = -1;
+/* the server does not know pbs_alterjobs(): use one pbs_alterjob() per job */
+static int alterjobs_unsupported = 0;
+
+/**
+ * @brief
+ * 		log a failure to update a job's attributes on the server
+ *
+ * @param[in]	job_name	-	name of the job
+ * @param[in]	pattr	-	attrl list which failed to update
+ * @param[in]	err	-	pbs error code of the failure
+ * @param[in]	errbuf	-	error message of the failure
+ *
+ * @return	void
+ */
+static void
+log_attr_update_failure(char *job_name, struct attrl *pattr, int err, char *errbuf)
+{
+	int one_attr = 0;
+
+	if (pattr->next == NULL)
+		one_attr = 1;
+
+	if (is_finished_job(err) == 1) {
+		if (one_attr)
+			log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_INFO, job_name,
+				   "Failed to update attr \'%s\' = %s, Job already finished",
+				   pattr->name, pattr->value);
+		else
+			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_INFO, job_name, 
+				"Failed to update job attributes, Job already finished");
+		return;
+	}
+
+	if (errbuf == NULL)
+		errbuf = "";
+	if (one_attr)
+		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING, job_name,
+			   "Failed to update attr \'%s\' = %s: %s (%d)",
+			   pattr->name, pattr->value, errbuf, err);
+	else
+		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING, job_name, 
+			"Failed to update job attributes: %s (%d)",
+			errbuf, err);
+}
+
+/**
+ * @brief
+ * 		free the queued job attribute updates
+ *
+ * @return	void
+ */
+static void
+free_pending_updates(void)
+{
+	struct batch_status *bs;
+	struct batch_status *bs_next;
+
+	for (bs = pending_updates; bs != NULL; bs = bs_next) {
+		bs_next = bs->next;
+		free(bs->name);
+		free_attrl_list(bs->attribs);
+		free(bs);
+	}
+	pending_updates = NULL;
+	pending_updates_tail = NULL;
+	pending_updates_ct = 0;
+}
+
+/**
+ * @brief
+ * 		send delayed job attribute updates for job to the server.
+ *
+ * @par
+ * 		The main reason to use this function over a direct send_attr_update()
+ *      call is so that the job's attr_updates list gets free'd and NULL'd.
+ *      We don't want to send the attr updates multiple times
+ *
+ * @par
+ *		The updates are queued and sent to the server JOB_UPDATE_BATCH_SIZE
+ *		jobs at a time with pbs_alterjobs() instead of one pbs_alterjob()
+ *		round trip per job.  Whatever is left is sent by flush_job_updates().
+ *		The updates of a job stay in the order they were queued.
+ *
+ * @param[in]	pbs_sd	-	server connection descriptor
+ * @param[in]	job	-	job to send attributes to
+ *
+ * @return	int
+ * @retval	1	- success (updates were sent or queued)
+ * @retval	0	- failure to update
+ */
+int send_job_updates(int pbs_sd, resource_resv *job) {
+	struct attrl *pattr;
+	int rc;
+
+	if (job == NULL || job->job == NULL || job->job->attr_updates == NULL)
+		return 0;
+
+	if (pbs_sd == SIMULATE_SD) {
+		free_attrl_list(job->job->attr_updates);
+		job->job->attr_updates = NULL;
+		return 1; /* simulation always successful */
+	}
+
+	pattr = job->job->attr_updates;
+	job->job->attr_updates = NULL;
+
+	if (sub_cycle_child()) {
+		rc = sub_cycle_put_update(job->name, pattr, 0) == 0;
+		free_attrl_list(pattr);
+		return rc;
+	}
+
+	return queue_attr_updates(pbs_sd, job->name, pattr);
+}
+
+/**
+ * @brief
+ * 		queue a job's attribute updates to be sent to the server with
+ *		those of other jobs by flush_job_updates()
+ *
+ * @param[in]	pbs_sd	-	server connection descriptor
+ * @param[in]	job_name	-	name of the job
+ * @param[in]	pattr	-	attrl list to update, freed when sent
+ *
+ * @return	int
+ * @retval	1	- success (updates were sent or queued)
+ * @retval	0	- failure to update
+ */
+int
+queue_attr_updates(int pbs_sd, char *job_name, struct attrl *pattr)
+{
+	struct batch_status *bs;
+	int rc = 1;
+
+	if (pbs_sd != pending_updates_sd)
+		flush_job_updates(pending_updates_sd);
+
+	if ((bs = calloc(1, sizeof(struct batch_status))) == NULL ||
+		(bs->name = string_dup(job_name)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(bs);
+		/* send this job's updates on their own */
+		rc = send_attr_updates(pbs_sd, job_name, pattr);
+		free_attrl_list(pattr);
+		return rc;
+	}
+	bs->attribs = pattr;
+
+	if (pending_updates_tail == NULL)
+		pending_updates = bs;
+	else
+		pending_updates_tail->next = bs;
+	pending_updates_tail = bs;
+	pending_updates_ct++;
+	pending_updates_sd = pbs_sd;
+
+	if (pending_updates_ct >= JOB_UPDATE_BATCH_SIZE)
+		rc = flush_job_updates(pbs_sd);
+
+	return rc;
+}
+
+/**
+ * @brief
+ * 		send the job attribute updates queued by send_job_updates()
+ *
+ * @par
+ *		If the server does not know the Modify Jobs request, each job's
+ *		updates are sent with send_attr_updates() instead.
+ *
+ * @param[in]	pbs_sd	-	server connection descriptor the updates were
+ *				queued for
+ *
+ * @return	int
+ * @retval	1	- success (or nothing to send)
+ * @retval	0	- at least one job failed to update
+ */
+int
+flush_job_updates(int pbs_sd)
+{
+	struct batch_status *bs;
+	job_err_info *pmj = NULL;
+	int rc = 1;
+	int i;
+
+	if (pending_updates == NULL)
+		return 1;
+
+	/* our connection to the server is gone, no sense trying to send */
+	if (got_sigpipe || pbs_sd != pending_updates_sd) {
+		free_pending_updates();
+		return 0;
+	}
+
+	if (!alterjobs_unsupported) {
+		pmj = pbs_alterjobs(pbs_sd, pending_updates);
+		if (pmj == NULL && pbs_errno == PBSE_UNKREQ) {
+			alterjobs_unsupported = 1;
+			log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+				"Server does not support batched job updates, sending them one job at a time");
+		}
+	}
+
+	if (pmj != NULL) {
+		for (i = 0, bs = pending_updates; bs != NULL; bs = bs->next, i++) {
+			if (pmj[i].errcode != PBSE_NONE) {
+				log_attr_update_failure(bs->name, bs->attribs,
+					pmj[i].errcode, pbse_to_txt(pmj[i].errcode));
+				rc = 0;
+			}
+		}
+		free(pmj);
+	} else {
+		for (bs = pending_updates; bs != NULL && !got_sigpipe; bs = bs->next) {
+			if (send_attr_updates(pbs_sd, bs->name, bs->attribs) == 0)
+				rc = 0;
+		}
+	}
+
+	free_pending_updates();
+	return rc;
+}
+
+/**
+ * @brief
+ * 		send delayed attributes to the server for a job
+ *
+ * @param[in]	pbs_sd	-	server connection descriptor
+ * @param[in]	job_name	-	name of job for pbs_alterjob()
+ * @param[in]	pattr	-	attrl list to update on the server
+ *
+ * @return	int
+ * @retval	1	success
+ * @retval	0	failure to update
+ */
+int send_attr_updates(int pbs_sd, char *job_name, struct attrl *pattr) {
+	if (job_name == NULL || pattr == NULL)
+		return 0;
+
+	if (pbs_sd == SIMULATE_SD)
+		return 1; /* simulation always successful */
+
+	if (sub_cycle_child())
+		return sub_cycle_put_update(job_name, pattr, 1) == 0;
+
+	if (pbs_alterjob(pbs_sd, job_name, pattr, NULL) == 0)
+		return 1;
+
+	log_attr_update_failure(job_name, pattr, pbs_errno, pbs_geterrmsg(pbs_sd));
+	return 0;
+}
+
+/**
+ *	@brief
+ *		unset job attributes on the server
+ *
+ * @param[in]	pbs_sd	-	connection to the pbs_server
+ * @param[in]	resresv	-	job to update
+ * @param[in]	attr_name	-	the name of the attribute to unset
+ * @param[in]	flags	-	UPDATE_NOW : call send_attr_updates() to update the attribute now
+ *			     			UPDATE_LATER - attach attribute change to job to be sent all at once
+ *							for the job.  NOTE: Only the jobs that are part
+ *							of the server in main_sched_loop() will be updated in this way.
+ *
+ *	@retval	1	: attributes were unset
+ *	@retval	0	: no attributes were unset for a valid reason
+ *	@retval -1	: no attributes were unset for an error
+ *
+ */
+int
+unset_job_attr(int pbs_sd, resource_resv *resresv, char *attr_name, unsigned int flags)
+{
+	return (update_job_attr(pbs_sd, resresv, attr_name, NULL, "", NULL, flags));
+
+}
+
+/**
+ * @brief
+ *		update_job_comment - update a job's comment attribute.  If the job's
+ *			     comment attr is identical, don't update
+ *
+ * @param[in]	pbs_sd	-	pbs connection descriptor
+ * @param[in]	resresv -	the job to update
+ * @param[in]	comment -	the comment string
+ *
+ * @return	int
+ * @retval	1	: if the comment was updated
+ * @retval	0	: if not
+ *
+ */
+int
+update_job_comment(int pbs_sd, resource_resv *resresv, char *comment) {
+	int rc = 0;
+
+	if (resresv == NULL || comment == NULL)
+		return 0;
+
+	if (!resresv->is_job || resresv->job ==NULL)
+		return 0;
+
+	/* no need to update the job comment if it is the same */
+	if (resresv->job->comment == NULL ||
+		strcmp(resresv->job->comment, comment)) {
+		if (conf.update_comments) {
+			rc = update_job_attr(pbs_sd, resresv, ATTR_comment, NULL, comment, NULL, UPDATE_LATER);
+			if (rc > 0) {
+				if (resresv->job->comment !=NULL)
+					free(resresv->job->comment);
+				resresv->job->comment = string_dup(comment);
+			}
+		}
+	}
+	return rc;
+}
+
+/**
+ * @brief
+ *		update_jobs_cant_run - update an array of jobs which can not run
+ *
+ * @param[in]	pbs_sd	-	connection to the PBS server
+ * @param[in,out]	resresv_arr	-	the array to update
+ * @param[in]	start	-	the job which couldn't run
+ * @param[in]	comment	-	the comment to update
+ * @param[in]	log_msg	-	the message to log for the job
+ *
+ * @return nothing
+ *
+ */
+void
+update_jobs_cant_run(int pbs_sd, resource_resv **resresv_arr,
+	resource_resv *start, struct schd_error *err, int start_where)
+{
+	int i = 0;
+
+	if (resresv_arr == NULL)
+		return;
+
+	/* We are not starting at the front of the array, so we need to find the
+	 * element to start with.
+	 */
+	if (start != NULL) {
+		for (; resresv_arr[i] != NULL && resresv_arr[i] != start; i++)
+			;
+	} else
+		i = 0;
+
+	if (resresv_arr[i] != NULL) {
+		if (start_where == START_BEFORE_JOB)
+			i--;
+		else if (start_where == START_AFTER_JOB)
+			i++;
+
+		for (; resresv_arr[i] != NULL; i++) {
+			if (!resresv_arr[i]->can_not_run) {
+				update_job_can_not_run(pbs_sd, resresv_arr[i], err);
+			}
+		}
+	}
+}
+
+/**
+ * @brief
+ *		translate failure codes into a comment and log message
+ *
+ * @param[in]	err	-	error reply structure to translate
+ * @param[out]	comment_msg	-	translated comment (may be NULL)
+ * @param[out]	log_msg	-	translated log message (may be NULL)
+ *
+ * @return	int
+ * @retval	1	: comment and log messages were set
+ * @retval	0	: comment and log messages were not set
+ *
+ */
+int
+translate_fail_code(schd_error *err, char *comment_msg, char *log_msg)
+{
+	int rc = 1;
+	char *pbse;
+	char commentbuf[MAX_LOG_SIZE];
+	char *arg1;
+	char *arg2;
+	char *arg3;
+	char *spec;
+
+	if (err == NULL)
+		return 0;
+
+	if(err->status_code == SCHD_UNKWN) {
+		if(comment_msg != NULL)
+			comment_msg[0] = '\0';
+		if(log_msg != NULL)
+			log_msg[0] = '\0';
+		return 0;
+	}
+
+	if (err->error_code < RET_BASE) {
+		if (err->specmsg != NULL)
+			pbse = err->specmsg;
+		else
+			pbse = pbse_to_txt(err->error_code);
+
+		if (pbse == NULL)
+			pbse = "";
+
+		if (comment_msg != NULL)
+			snprintf(commentbuf, sizeof(commentbuf), "%s", pbse);
+		if (log_msg != NULL)
+			snprintf(log_msg, MAX_LOG_SIZE, "%s", pbse);
+	}
+
+	arg1 = err->arg1;
+	arg2 = err->arg2;
+	arg3 = err->arg3;
+	spec = err->specmsg;
+	if(arg1 == NULL)
+		arg1 = "";
+	if(arg2 == NULL)
+		arg2 = "";
+	if(arg3 == NULL)
+		arg3 = "";
+	if(spec == NULL)
+		spec = "";
+
+	switch (err->error_code) {
+		case ERR_SPECIAL:
+
+			if (comment_msg != NULL)
+				snprintf(commentbuf, sizeof(commentbuf), "%s", spec);
+			if (log_msg != NULL)
+				snprintf(log_msg, MAX_LOG_SIZE, "%s", spec);
+			break;
+
+			/* codes using arg1  */
+		case BACKFILL_CONFLICT:
+		case CANT_PREEMPT_ENOUGH_WORK:
+		case CROSS_DED_TIME_BOUNDRY:
+		case DED_TIME:
+#ifndef NAS /* localmod 031 */
+		case INVALID_NODE_STATE:
+#endif /* localmod 031 */
+		case INVALID_NODE_TYPE:
+		case NODE_GROUP_LIMIT_REACHED:
+		case NODE_HIGH_LOAD:
+		case NODE_JOB_LIMIT_REACHED:
+		case NODE_NOT_EXCL:
+		case NODE_NO_MULT_JOBS:
+		case NODE_PLACE_PACK:
+		case NODE_RESV_ENABLE:
+		case NODE_UNLICENSED:
+		case NODE_USER_LIMIT_REACHED:
+		case NONPRIME_ONLY:
+		case NOT_ENOUGH_NODES_AVAIL:
+		case NO_FAIRSHARES:
+		case NO_NODE_RESOURCES:
+		case NO_SMALL_CPUSETS:
+		case PRIME_ONLY:
+		case QUEUE_GROUP_LIMIT_REACHED:
+		case QUEUE_PROJECT_LIMIT_REACHED:
+		case QUEUE_JOB_LIMIT_REACHED:
+		case QUEUE_NOT_STARTED:
+		case QUEUE_USER_LIMIT_REACHED:
+		case RESERVATION_CONFLICT:
+		case SCHD_ERROR:
+		case SERVER_BYGROUP_JOB_LIMIT_REACHED:
+		case SERVER_BYPROJECT_JOB_LIMIT_REACHED:
+		case SERVER_BYUSER_JOB_LIMIT_REACHED:
+		case SERVER_GROUP_LIMIT_REACHED:
+		case SERVER_PROJECT_LIMIT_REACHED:
+		case SERVER_JOB_LIMIT_REACHED:
+		case SERVER_USER_LIMIT_REACHED:
+		case STRICT_ORDERING:
+		case PROV_DISABLE_ON_SERVER:
+		case PROV_DISABLE_ON_NODE:
+		case PROV_BACKFILL_CONFLICT:
+		case CANT_SPAN_PSET:
+		case IS_MULTI_VNODE:
+		case AOE_NOT_AVALBL:
+		case EOE_NOT_AVALBL:
+		case PROV_RESRESV_CONFLICT:
+		case CROSS_PRIME_BOUNDARY:
+		case NO_FREE_NODES:
+		case NO_TOTAL_NODES:
+		case INVALID_RESRESV:
+		case JOB_UNDER_THRESHOLD:
+#ifdef NAS
+			/* localmod 034 */
+		case GROUP_CPU_SHARE:
+		case GROUP_CPU_INSUFFICIENT:
+			/* localmod 998 */
+		case RESOURCES_INSUFFICIENT:
+#endif
+			if (comment_msg != NULL)
+				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), arg1);
+			if (log_msg != NULL)
+				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), arg1);
+			break;
+
+			/* codes using two arguments */
+#ifdef NAS /* localmod 031 */
+		case INVALID_NODE_STATE:
+#endif /* localmod 031 */
+		case QUEUE_BYGROUP_JOB_LIMIT_REACHED:
+		case QUEUE_BYPROJECT_JOB_LIMIT_REACHED:
+		case QUEUE_BYUSER_JOB_LIMIT_REACHED:
+		case RUN_FAILURE:
+		case NODE_NONEXISTENT:
+		case SET_TOO_SMALL:
+			if (comment_msg != NULL) {
+				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), arg1, arg2);
+			}
+			if (log_msg != NULL) {
+				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), arg1, arg2);
+			}
+			break;
+		/* codes using a resource definition and arg1 */
+		case QUEUE_GROUP_RES_LIMIT_REACHED:
+		case QUEUE_PROJECT_RES_LIMIT_REACHED:
+		case QUEUE_USER_RES_LIMIT_REACHED:
+			if (comment_msg != NULL && err->rdef != NULL)
+				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), arg1, err->rdef->name);
+			if (log_msg != NULL && err->rdef != NULL)
+				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), arg1, err->rdef->name);
+			break;
+
+		/* codes using resource definition in error structure */
+		case SERVER_GROUP_RES_LIMIT_REACHED:
+		case SERVER_PROJECT_RES_LIMIT_REACHED:
+		case SERVER_USER_RES_LIMIT_REACHED:
+		case SERVER_RESOURCE_LIMIT_REACHED:
+			if (comment_msg != NULL && err->rdef != NULL)
+				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), err->rdef->name);
+			if (log_msg != NULL && err->rdef != NULL)
+				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), err->rdef->name);
+			break;
+
+		/* codes using a resource definition and arg1 in a different order */
+		case QUEUE_RESOURCE_LIMIT_REACHED:
+		case INSUFFICIENT_QUEUE_RESOURCE:
+		case INSUFFICIENT_SERVER_RESOURCE:
+		case INSUFFICIENT_RESOURCE:
+			if (comment_msg != NULL && err->rdef != NULL)
+				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), err->rdef->name,
+					arg1);
+			if (log_msg != NULL && err->rdef != NULL)
+				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), err->rdef->name,
+					arg1);
+			break;
+
+		/* codes using arg1, arg3 and resource definition (in a weird order) */
+		case QUEUE_BYGROUP_RES_LIMIT_REACHED:
+		case QUEUE_BYPROJECT_RES_LIMIT_REACHED:
+		case QUEUE_BYUSER_RES_LIMIT_REACHED:
+			if (comment_msg != NULL && err->rdef != NULL)
+				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), arg3, err->rdef->name, arg1);
+			if (log_msg != NULL && err->rdef != NULL)
+				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), arg3, err->rdef->name, arg1);
+			break;
+
+		/* codes using resource definition and arg2 */
+		case SERVER_BYGROUP_RES_LIMIT_REACHED:
+		case SERVER_BYPROJECT_RES_LIMIT_REACHED:
+		case SERVER_BYUSER_RES_LIMIT_REACHED:
+			if (comment_msg != NULL && err->rdef != NULL)
+				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), arg2,
+					err->rdef->name);
+			if (log_msg != NULL && err->rdef != NULL)
+				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), arg2,
+					err->rdef->name);
+			break;
+
+		case RESERVATION_INTERFERENCE:
+			if (*arg1 !='\0') {
+				if (comment_msg != NULL) {
+					sprintf(commentbuf, "%s: %s",
+						ERR2COMMENT(err->error_code), arg1);
+				}
+				if (log_msg != NULL) {
+					snprintf(log_msg, MAX_LOG_SIZE, "%s: %s",
+						ERR2INFO(err->error_code), arg1);
+				}
+			}
+			else  {
+				if (comment_msg != NULL)
+					snprintf(commentbuf, sizeof(commentbuf), "%s", ERR2COMMENT(err->error_code));
+				if (log_msg != NULL)
+					snprintf(log_msg, MAX_LOG_SIZE, "%s", ERR2INFO(err->error_code));
+			}
+			break;
+
+		case NOT_QUEUED:
+		default:
+			rc = 0;
+			if (comment_msg != NULL)
+				commentbuf[0] = '\0';
+			if (log_msg != NULL)
+				log_msg[0] = '\0';
+	}
+
+	if (comment_msg != NULL) {
+		/* snprintf() use MAX_LOG_SIZE because all calls to this function
+		 * pass in comment_msg buffers of size MAX_LOG_SIZE.  This needs to be
+		 * fixed by passing in the size of comment_msg and log_msg (SPID268659)
+		 */
+		switch (err->status_code) {
+			case SCHD_UNKWN:
+			case NOT_RUN:
+				snprintf(comment_msg, MAX_LOG_SIZE, "%s: %.*s",
+					NOT_RUN_PREFIX,
+					(int)(MAX_LOG_SIZE - strlen(NOT_RUN_PREFIX) - 3),
+					commentbuf);
+				break;
+			case NEVER_RUN:
+				snprintf(comment_msg, MAX_LOG_SIZE, "%s: %.*s",
+					NEVER_RUN_PREFIX,
+					(int)(MAX_LOG_SIZE - strlen(NEVER_RUN_PREFIX) - 3),
+					commentbuf);
+				break;
+			default:
+				snprintf(comment_msg, MAX_LOG_SIZE, "%s", commentbuf);
+		}
+	}
+
+	return rc;
+}
+
+/**
+ * @brief resresv_set constructor
+ */
+resresv_set *
+new_resresv_set(void)
+{
+	resresv_set *rset;
+
+	rset = malloc(sizeof(resresv_set));
+	if (rset == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	rset->can_not_run = 0;
+	rset->err = NULL;
+	rset->user = NULL;
+	rset->group = NULL;
+	rset->project = NULL;
+	rset->partition = NULL;
+	rset->place_spec = NULL;
+	rset->req = NULL;
+	rset->select_spec = NULL;
+	rset->qinfo = NULL;
+	rset->key = NULL;
+
+	return rset;
+}
+/**
+ * @brief resresv_set destructor
+ */
+void
+free_resresv_set(resresv_set *rset) {
+	if(rset == NULL)
+		return;
+
+	free_schd_error(rset->err);
+	/* user, group and project are interned */
+	free(rset->partition);
+	free_selspec(rset->select_spec);
+	free_place(rset->place_spec);
+	free_resource_req_list(rset->req);
+	free(rset->key);
+	free(rset);
+}
+/**
+ *  @brief resresv_set array destructor
+ */
+void
+free_resresv_set_array(resresv_set **rsets) {
+	int i;
+
+	if (rsets == NULL)
+		return;
+
+	for (i = 0; rsets[i] != NULL; i++)
+		free_resresv_set(rsets[i]);
+
+	free(rsets);
+}
+
+/**
+ * @brief resresv_set copy constructor
+ */
+resresv_set *
+dup_resresv_set(resresv_set *oset, server_info *nsinfo)
+{
+	resresv_set *rset;
+
+	if (oset == NULL || nsinfo == NULL)
+		return NULL;
+
+	rset = new_resresv_set();
+	if (rset == NULL)
+		return NULL;
+
+	rset->can_not_run = oset->can_not_run;
+
+	rset->err = dup_schd_error(oset->err);
+	if (oset->err != NULL && oset->err == NULL) {
+		free_resresv_set(rset);
+		return NULL;
+	}
+
+	rset->user = oset->user;
+	rset->group = oset->group;
+	rset->project = oset->project;
+	rset->partition = string_dup(oset->partition);
+	if (oset->partition != NULL && rset->partition == NULL) {
+		free_resresv_set(rset);
+		return NULL;
+	}
+	rset->select_spec = share_selspec(oset->select_spec);
+	if (rset->select_spec == NULL) {
+		free_resresv_set(rset);
+		return NULL;
+	}
+	rset->place_spec = share_place(oset->place_spec);
+	if (rset->place_spec == NULL) {
+		free_resresv_set(rset);
+		return NULL;
+	}
+	rset->req = dup_resource_req_list(oset->req);
+	if (oset->req != NULL && rset->req == NULL) {
+		free_resresv_set(rset);
+		return NULL;
+	}
+	if(oset->qinfo != NULL)
+		rset->qinfo = find_queue_info(nsinfo->queues, oset->qinfo->name);
+	rset->key = string_dup(oset->key);
+	if (oset->key != NULL && rset->key == NULL) {
+		free_resresv_set(rset);
+		return NULL;
+	}
+
+	return rset;
+}
+/**
+ * @brief resresv_set array copy constructor
+ */
+resresv_set **
+dup_resresv_set_array(resresv_set **osets, server_info *nsinfo)
+{
+	int i;
+	int len;
+	resresv_set **rsets;
+	if (osets == NULL || nsinfo == NULL)
+		return NULL;
+
+	len = count_array((void **) osets);
+
+	rsets = malloc((len + 1) * sizeof(resresv_set *));
+	if (rsets == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	for (i = 0; osets[i] != NULL; i++) {
+		rsets[i] = dup_resresv_set(osets[i], nsinfo);
+		if (rsets[i] == NULL) {
+			free_resresv_set_array(rsets);
+			return NULL;
+		}
+	}
+	rsets[i] = NULL;
+	return rsets;
+
+}
+
+/**
+ * @brief should a resresv_set use the user
+ * @param sinfo - server info
+ * @param qinfo - queue info
+ * @retval 1 - yes
+ * @retval 0 - no
  */
 int
-translate_fail_code(schd_error *err, char *comment_msg, char *log_msg)
+resresv_set_use_user(server_info *sinfo, queue_info *qinfo)
 {
-	int rc = 1;
-	char *pbse;
-	char commentbuf[MAX_LOG_SIZE];
-	char *arg1;
-	char *arg2;
-	char *arg3;
-	char *spec;
+	if ((sinfo != NULL) && (sinfo->has_user_limit))
+		return 1;
+	if ((qinfo != NULL) && (qinfo->has_user_limit))
+		return 1;
 
-	if (err == NULL)
-		return 0;
 
-	if(err->status_code == SCHD_UNKWN) {
-		if(comment_msg != NULL)
-			comment_msg[0] = '\0';
-		if(log_msg != NULL)
-			log_msg[0] = '\0';
+	return 0;
+}
+
+/**
+ * @brief should a resresv_set use the group
+ * @param sinfo - server info
+ * @param qinfo - queue info
+ * @retval 1 - yes
+ * @retval 0 - no
+ */
+int
+resresv_set_use_grp(server_info *sinfo, queue_info *qinfo)
+{
+	if ((sinfo != NULL) && (sinfo->has_grp_limit))
+		return 1;
+	if ((qinfo != NULL) && (qinfo->has_grp_limit))
+		return 1;
+
+
+	return 0;
+}
+
+/**
+ * @brief should a resresv_set use the project
+ * @param sinfo - server info
+ * @param qinfo - queue info
+ * @retval 1 - yes
+ * @retval 0 - no
+ */
+int
+resresv_set_use_proj(server_info *sinfo, queue_info *qinfo)
+{
+	if ((sinfo != NULL) && (sinfo->has_proj_limit))
+		return 1;
+	if ((qinfo != NULL) && (qinfo->has_proj_limit))
+		return 1;
+
+
+	return 0;
+}
+
+/**
+ * @brief should a resresv_set use the queue
+ * 	A resresv_set should use queue for the following reasons:
+ * 	Hard limits	max_run_res, etc
+ * 	Soft Limits	max_run_res_soft, etc
+ * 	Nodes		Queue has nodes(e.g., node's queue attribute)
+ * 	Dedtime queue 	Queue is a dedicated time queue
+ * 	Primetime	Queue is a primetime queue
+ * 	Non-primetime	Queue is a non-primetime queue
+ * 	Resource limits	Queue has resources_available limits
+ * 	Reservation	Queue is a reservation queue
+ *
+ * @param qinfo - the queue
+ * @retval 1 - yes
+ * @retval 0 - no
+ */
+int
+resresv_set_use_queue(queue_info *qinfo)
+{
+	if (qinfo == NULL)
 		return 0;
-	}
 
-	if (err->error_code < RET_BASE) {
-		if (err->specmsg != NULL)
-			pbse = err->specmsg;
-		else
-			pbse = pbse_to_txt(err->error_code);
+	if (qinfo->has_hard_limit || qinfo->has_soft_limit || qinfo->has_nodes ||
+	    qinfo->is_ded_queue || qinfo->is_prime_queue || qinfo->is_nonprime_queue ||
+	    qinfo->has_resav_limit || qinfo->resv != NULL)
+		return 1;
 
-		if (pbse == NULL)
-			pbse = "";
+	return 0;
+}
 
-		if (comment_msg != NULL)
-			snprintf(commentbuf, sizeof(commentbuf), "%s", pbse);
-		if (log_msg != NULL)
-			snprintf(log_msg, MAX_LOG_SIZE, "%s", pbse);
-	}
+/**
+ * @brief determine which selspec to use from a resource_resv for a resresv_set
+ *
+ * @par Jobs that have an execselect are either running or need to be placed
+ *	back on the nodes they were originally running on (e.g., suspended jobs).
+ *	We need to put them in their own set because they are no longer
+ *	requesting the same resources as jobs with the same select spec.
+ *	They are requesting the resources on each vnode they are running on.
+ *	We don't care about running jobs because the only time they will be
+ *	looked at is if they are requeued.  At that point they are back in
+ *	the queued state and have the same select spec as they originally did.
+ *
+ * @return selspec *
+ * @retval selspec to use
+ * @retval NULL on error
+ */
+selspec *
+resresv_set_which_selspec(resource_resv *resresv)
+{
+	if(resresv == NULL)
+		return NULL;
 
-	arg1 = err->arg1;
-	arg2 = err->arg2;
-	arg3 = err->arg3;
-	spec = err->specmsg;
-	if(arg1 == NULL)
-		arg1 = "";
-	if(arg2 == NULL)
-		arg2 = "";
-	if(arg3 == NULL)
-		arg3 = "";
-	if(spec == NULL)
-		spec = "";
+	if (resresv->job != NULL && !resresv->job->is_running && resresv->execselect != NULL)
+		return resresv->execselect;
 
-	switch (err->error_code) {
-		case ERR_SPECIAL:
+	return resresv->select;
+}
 
-			if (comment_msg != NULL)
-				snprintf(commentbuf, sizeof(commentbuf), "%s", spec);
-			if (log_msg != NULL)
-				snprintf(log_msg, MAX_LOG_SIZE, "%s", spec);
-			break;
+/**
+ * @brief create the list of resources to consider when creating the resresv sets
+ * @param policy[in] - policy info
+ * @param sinfo[in] - server universe
+ * @return resdef **
+ * @retval array of resdefs for creating resresv_set's resources.
+ * @retval NULL on error
+ */
+resdef **
+create_resresv_sets_resdef(status *policy, server_info *sinfo) {
+	resdef **defs;
+	int def_ct;
+	int limres_ct = 0;
+	int i;
+	schd_resource *limres;
+	schd_resource *cur_res;
 
-			/* codes using arg1  */
-		case BACKFILL_CONFLICT:
-		case CANT_PREEMPT_ENOUGH_WORK:
-		case CROSS_DED_TIME_BOUNDRY:
-		case DED_TIME:
-#ifndef NAS /* localmod 031 */
-		case INVALID_NODE_STATE:
-#endif /* localmod 031 */
-		case INVALID_NODE_TYPE:
-		case NODE_GROUP_LIMIT_REACHED:
-		case NODE_HIGH_LOAD:
-		case NODE_JOB_LIMIT_REACHED:
-		case NODE_NOT_EXCL:
-		case NODE_NO_MULT_JOBS:
-		case NODE_PLACE_PACK:
-		case NODE_RESV_ENABLE:
-		case NODE_UNLICENSED:
-		case NODE_USER_LIMIT_REACHED:
-		case NONPRIME_ONLY:
-		case NOT_ENOUGH_NODES_AVAIL:
-		case NO_FAIRSHARES:
-		case NO_NODE_RESOURCES:
-		case NO_SMALL_CPUSETS:
-		case PRIME_ONLY:
-		case QUEUE_GROUP_LIMIT_REACHED:
-		case QUEUE_PROJECT_LIMIT_REACHED:
-		case QUEUE_JOB_LIMIT_REACHED:
-		case QUEUE_NOT_STARTED:
-		case QUEUE_USER_LIMIT_REACHED:
-		case RESERVATION_CONFLICT:
-		case SCHD_ERROR:
-		case SERVER_BYGROUP_JOB_LIMIT_REACHED:
-		case SERVER_BYPROJECT_JOB_LIMIT_REACHED:
-		case SERVER_BYUSER_JOB_LIMIT_REACHED:
-		case SERVER_GROUP_LIMIT_REACHED:
-		case SERVER_PROJECT_LIMIT_REACHED:
-		case SERVER_JOB_LIMIT_REACHED:
-		case SERVER_USER_LIMIT_REACHED:
-		case STRICT_ORDERING:
-		case PROV_DISABLE_ON_SERVER:
-		case PROV_DISABLE_ON_NODE:
-		case PROV_BACKFILL_CONFLICT:
-		case CANT_SPAN_PSET:
-		case IS_MULTI_VNODE:
-		case AOE_NOT_AVALBL:
-		case EOE_NOT_AVALBL:
-		case PROV_RESRESV_CONFLICT:
-		case CROSS_PRIME_BOUNDARY:
-		case NO_FREE_NODES:
-		case NO_TOTAL_NODES:
-		case INVALID_RESRESV:
-		case JOB_UNDER_THRESHOLD:
-#ifdef NAS
-			/* localmod 034 */
-		case GROUP_CPU_SHARE:
-		case GROUP_CPU_INSUFFICIENT:
-			/* localmod 998 */
-		case RESOURCES_INSUFFICIENT:
-#endif
-			if (comment_msg != NULL)
-				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), arg1);
-			if (log_msg != NULL)
-				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), arg1);
-			break;
+	if (policy == NULL || sinfo == NULL)
+		return NULL;
+
+	limres = query_limres();
+	for (cur_res = limres; cur_res != NULL; cur_res = cur_res->next)
+		limres_ct++;
+
+	def_ct = count_array((void **) policy->resdef_to_check);
+	/* 6 for ctime, walltime, max_walltime, min_walltime, preempt_targets (maybe), and NULL*/
+	defs = malloc((def_ct + limres_ct + 6) * sizeof(resdef *));
 
-			/* codes using two arguments */
-#ifdef NAS /* localmod 031 */
-		case INVALID_NODE_STATE:
-#endif /* localmod 031 */
-		case QUEUE_BYGROUP_JOB_LIMIT_REACHED:
-		case QUEUE_BYPROJECT_JOB_LIMIT_REACHED:
-		case QUEUE_BYUSER_JOB_LIMIT_REACHED:
-		case RUN_FAILURE:
-		case NODE_NONEXISTENT:
-		case SET_TOO_SMALL:
-			if (comment_msg != NULL) {
-				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), arg1, arg2);
-			}
-			if (log_msg != NULL) {
-				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), arg1, arg2);
-			}
-			break;
-		/* codes using a resource definition and arg1 */
-		case QUEUE_GROUP_RES_LIMIT_REACHED:
-		case QUEUE_PROJECT_RES_LIMIT_REACHED:
-		case QUEUE_USER_RES_LIMIT_REACHED:
-			if (comment_msg != NULL && err->rdef != NULL)
-				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), arg1, err->rdef->name);
-			if (log_msg != NULL && err->rdef != NULL)
-				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), arg1, err->rdef->name);
-			break;
+	for (i = 0; i < def_ct; i++)
+		defs[i] = policy->resdef_to_check[i];
+	defs[i++] = getallres(RES_CPUT);
+	defs[i++] = getallres(RES_WALLTIME);
+	defs[i++] = getallres(RES_MAX_WALLTIME);
+	defs[i++] = getallres(RES_MIN_WALLTIME);
+	if(sinfo->preempt_targets_enable)
+		defs[i++] = getallres(RES_PREEMPT_TARGETS);
+	defs[i] = NULL;
 
-		/* codes using resource definition in error structure */
-		case SERVER_GROUP_RES_LIMIT_REACHED:
-		case SERVER_PROJECT_RES_LIMIT_REACHED:
-		case SERVER_USER_RES_LIMIT_REACHED:
-		case SERVER_RESOURCE_LIMIT_REACHED:
-			if (comment_msg != NULL && err->rdef != NULL)
-				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), err->rdef->name);
-			if (log_msg != NULL && err->rdef != NULL)
-				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), err->rdef->name);
-			break;
+	for (cur_res = limres; cur_res != NULL; cur_res = cur_res->next) {
+		/* There may be overlap between resdef_to_check and limres */
+		if (!resdef_exists_in_array(defs, cur_res->def)) {
+			defs[i++] = cur_res->def;
+			defs[i] = NULL;
+		}
+	}
 
-		/* codes using a resource definition and arg1 in a different order */
-		case QUEUE_RESOURCE_LIMIT_REACHED:
-		case INSUFFICIENT_QUEUE_RESOURCE:
-		case INSUFFICIENT_SERVER_RESOURCE:
-		case INSUFFICIENT_RESOURCE:
-			if (comment_msg != NULL && err->rdef != NULL)
-				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), err->rdef->name,
-					arg1);
-			if (log_msg != NULL && err->rdef != NULL)
-				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), err->rdef->name,
-					arg1);
-			break;
+	return defs;
+}
 
-		/* codes using arg1, arg3 and resource definition (in a weird order) */
-		case QUEUE_BYGROUP_RES_LIMIT_REACHED:
-		case QUEUE_BYPROJECT_RES_LIMIT_REACHED:
-		case QUEUE_BYUSER_RES_LIMIT_REACHED:
-			if (comment_msg != NULL && err->rdef != NULL)
-				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), arg3, err->rdef->name, arg1);
-			if (log_msg != NULL && err->rdef != NULL)
-				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), arg3, err->rdef->name, arg1);
-			break;
+/**
+ * @brief create a resresv_set based on a resource_resv
+ *
+ * @param[in] policy - policy info
+ * @param[in] sinfo - server info
+ * @param[in] resresv - resresv to create resresv set from
+ *
+ * @return resresv_set **
+ * @retval newly created resresv_set
+ * @retval NULL on error
+ */
+resresv_set *
+create_resresv_set_by_resresv(status *policy, server_info *sinfo, resource_resv *resresv)
+{
+	resresv_set *rset;
+	if (policy == NULL || resresv == NULL)
+		return NULL;
 
-		/* codes using resource definition and arg2 */
-		case SERVER_BYGROUP_RES_LIMIT_REACHED:
-		case SERVER_BYPROJECT_RES_LIMIT_REACHED:
-		case SERVER_BYUSER_RES_LIMIT_REACHED:
-			if (comment_msg != NULL && err->rdef != NULL)
-				snprintf(commentbuf, sizeof(commentbuf), ERR2COMMENT(err->error_code), arg2,
-					err->rdef->name);
-			if (log_msg != NULL && err->rdef != NULL)
-				snprintf(log_msg, MAX_LOG_SIZE, ERR2INFO(err->error_code), arg2,
-					err->rdef->name);
-			break;
+	rset = new_resresv_set();
+	if (rset == NULL)
+		return NULL;
 
-		case RESERVATION_INTERFERENCE:
-			if (*arg1 !='\0') {
-				if (comment_msg != NULL) {
-					sprintf(commentbuf, "%s: %s",
-						ERR2COMMENT(err->error_code), arg1);
-				}
-				if (log_msg != NULL) {
-					snprintf(log_msg, MAX_LOG_SIZE, "%s: %s",
-						ERR2INFO(err->error_code), arg1);
-				}
-			}
-			else  {
-				if (comment_msg != NULL)
-					snprintf(commentbuf, sizeof(commentbuf), "%s", ERR2COMMENT(err->error_code));
-				if (log_msg != NULL)
-					snprintf(log_msg, MAX_LOG_SIZE, "%s", ERR2INFO(err->error_code));
-			}
-			break;
+	if (resresv->is_job && resresv->job != NULL) {
+		if (resresv_set_use_queue(resresv->job->queue))
+			rset->qinfo = resresv->job->queue;
+	}
 
-		case NOT_QUEUED:
-		default:
-			rc = 0;
-			if (comment_msg != NULL)
-				commentbuf[0] = '\0';
-			if (log_msg != NULL)
-				log_msg[0] = '\0';
+	if (resresv_set_use_user(sinfo, rset->qinfo))
+		rset->user = resresv->user;
+	if (resresv_set_use_grp(sinfo, rset->qinfo))
+		rset->group = resresv->group;
+	if (resresv_set_use_proj(sinfo, rset->qinfo))
+		rset->project = resresv->project;
+
+	if (resresv->is_job && resresv->job != NULL) {
+		if (resresv->job->queue->partition != NULL)
+			rset->partition = string_dup(resresv->job->queue->partition);
 	}
 
-	if (comment_msg != NULL) {
-		/* snprintf() use MAX_LOG_SIZE because all calls to this function
-		 * pass in comment_msg buffers of size MAX_LOG_SIZE.  This needs to be
-		 * fixed by passing in the size of comment_msg and log_msg (SPID268659)
-		 */
-		switch (err->status_code) {
-			case SCHD_UNKWN:
-			case NOT_RUN:
-				snprintf(comment_msg, MAX_LOG_SIZE, "%s: %.*s",
-					NOT_RUN_PREFIX,
-					(int)(MAX_LOG_SIZE - strlen(NOT_RUN_PREFIX) - 3),
-					commentbuf);
-				break;
-			case NEVER_RUN:
-				snprintf(comment_msg, MAX_LOG_SIZE, "%s: %.*s",
-					NEVER_RUN_PREFIX,
-					(int)(MAX_LOG_SIZE - strlen(NEVER_RUN_PREFIX) - 3),
-					commentbuf);
-				break;
-			default:
-				snprintf(comment_msg, MAX_LOG_SIZE, "%s", commentbuf);
-		}
+	rset->select_spec = share_selspec(resresv_set_which_selspec(resresv));
+	if (rset->select_spec == NULL) {
+		free_resresv_set(rset);
+		return NULL;
+	}
+	rset->place_spec = share_place(resresv->place_spec);
+	if (rset->place_spec == NULL) {
+		free_resresv_set(rset);
+		return NULL;
 	}
+	/* rset->req may be NULL if the intersection of resresv->resreq and policy->equiv_class_resdef is the NULL set */
+	rset->req = dup_selective_resource_req_list(resresv->resreq, policy->equiv_class_resdef);
+
+
+	return rset;
+}
+
+/**
+ * @brief find the index of a resresv_set by its component parts
+ * @par qinfo, user, group, project, or req can be NULL if the resresv_set does not have one
+ * @param[in] policy - policy info
+ * @param[in] rsets - resresv_sets to search
+ * @param[in] user - user name
+ * @param[in] group - group name
+ * @param[in] project - project name
+ * @param[in] sel - select spec
+ * @param[in] pl - place spec
+ * @param[in] req - list of resources (i.e., qsub -l)
+ * @param[in] qinfo - queue
+ * @return int
+ * @retval index of resresv if found
+ * @retval -1 if not found or on error
+ */
+int
+find_resresv_set(status *policy, resresv_set **rsets, char *user, char *group, char *project, char *partition, selspec *sel, place *pl, resource_req *req, queue_info *qinfo)
+{
+	int i;
+
+	if (rsets == NULL)
+		return -1;
+
+	for (i = 0; rsets[i] != NULL; i++) {
+		if ((qinfo != NULL && rsets[i]->qinfo == NULL) || (qinfo == NULL && rsets[i]->qinfo != NULL))
+			continue;
+		if ((qinfo != NULL && rsets[i]->qinfo != NULL) && cstrcmp(qinfo->name, rsets[i]->qinfo->name) != 0)
+
+			continue;
+		/* user, group and project are interned strings */
+		if (user != rsets[i]->user)
+			continue;
+		if (group != rsets[i]->group)
+			continue;
+		if (project != rsets[i]->project)
+			continue;
+
+		if ((partition != NULL && rsets[i]->partition == NULL) || (partition == NULL && rsets[i]->partition != NULL))
+			continue;
+		if (partition != NULL && cstrcmp(partition, rsets[i]->partition) != 0)
+			continue;
+
+		if (compare_selspec(rsets[i]->select_spec, sel) == 0)
+			continue;
+		if (compare_place(rsets[i]->place_spec, pl) == 0)
+			continue;
+		if (compare_resource_req_list(rsets[i]->req, req, policy->equiv_class_resdef) == 0)
+			continue;
+		/* If we got here, we have found our set */
+		return i;
+	}
+	return -1;
 
-	return rc;
 }
 
-/**
- * @brief resresv_set constructor
- */
-resresv_set *
-new_resresv_set(void)
-{
-	resresv_set *rset;
+/**
+ * @brief find the index of a resresv_set by a resresv inside it
+ * @param[in] policy - policy info
+ * @param[in] rsets - resresv_set array to search
+ * @param[in] resresv - resresv to search for
+ * @return index of resresv
+ */
+int
+find_resresv_set_by_resresv(status *policy, resresv_set **rsets, resource_resv *resresv)
+{
+	char *user = NULL;
+	char *grp = NULL;
+	char *proj = NULL;
+	char *partition = NULL;
+	queue_info *qinfo = NULL;
+	selspec *sspec;
+
+	if (policy == NULL || rsets == NULL || resresv == NULL)
+		return -1;
+
+	if (resresv->is_job && resresv->job != NULL)
+		if (resresv_set_use_queue(resresv->job->queue))
+			qinfo = resresv->job->queue;
+
+	if (resresv_set_use_user(resresv->server, qinfo))
+		user = resresv->user;
+
+	if (resresv_set_use_grp(resresv->server, qinfo))
+		grp = resresv->group;
+
+	if (resresv_set_use_proj(resresv->server, qinfo))
+		proj = resresv->project;
 
-	rset = malloc(sizeof(resresv_set));
-	if (rset == NULL) {
-		log_err(errno, __func__, MEM_ERR_MSG);
-		return NULL;
+	if (resresv->is_job && resresv->job != NULL) {
+		if (resresv->job->queue->partition != NULL)
+			partition = resresv->job->queue->partition;
 	}
 
-	rset->can_not_run = 0;
-	rset->err = NULL;
-	rset->user = NULL;
-	rset->group = NULL;
-	rset->project = NULL;
-	rset->partition = NULL;
-	rset->place_spec = NULL;
-	rset->req = NULL;
-	rset->select_spec = NULL;
-	rset->qinfo = NULL;
+	sspec = resresv_set_which_selspec(resresv);
 
-	return rset;
+	return find_resresv_set(policy, rsets, user, grp, proj, partition, sspec, resresv->place_spec, resresv->resreq, qinfo);
 }
+
 /**
- * @brief resresv_set destructor
+ * @brief append one field of a resresv_set key
+ *
+ * @param[in,out] buf - key being built
+ * @param[in,out] size - allocated size of buf
+ * @param[in] str - field, or NULL if the set does not use it
+ *
+ * @return int
+ * @retval 1 success
+ * @retval 0 error
  */
-void
-free_resresv_set(resresv_set *rset) {
-	if(rset == NULL)
-		return;
-
-	free_schd_error(rset->err);
-	free(rset->user);
-	free(rset->group);
-	free(rset->project);
-	free(rset->partition);
-	free_selspec(rset->select_spec);
-	free_place(rset->place_spec);
-	free_resource_req_list(rset->req);
-	free(rset);
+static int
+add_resresv_set_key(char **buf, int *size, char *str)
+{
+	/* A field which isn't used is different from any value (even "") */
+	if (pbs_strcat(buf, size, str == NULL ? "\002" : str) == NULL)
+		return 0;
+	if (pbs_strcat(buf, size, "\001") == NULL)
+		return 0;
+	return 1;
 }
+
 /**
- *  @brief resresv_set array destructor
+ * @brief append the resources of a resource_req list to a resresv_set key
+ *
+ * @param[in,out] buf - key being built
+ * @param[in,out] size - allocated size of buf
+ * @param[in] req - resource list
+ * @param[in] defs - resources to use in the order to use them, or NULL for all
+ * @param[in] resresv - resresv the key is for
+ *
+ * @return int
+ * @retval 1 success
+ * @retval 0 error
+ *
+ * @par compare_resource_req() never finds resources other than consumables,
+ *	booleans and strings equal.  A resresv requesting one gets a key of
+ *	its own.
  */
-void
-free_resresv_set_array(resresv_set **rsets) {
+static int
+add_resresv_set_req_key(char **buf, int *size, resource_req *req, resdef **defs, resource_resv *resresv)
+{
+	resource_req *cur;
+	char numbuf[64];
 	int i;
 
-	if (rsets == NULL)
-		return;
-
-	for (i = 0; rsets[i] != NULL; i++)
-		free_resresv_set(rsets[i]);
-
-	free(rsets);
+	for (i = 0, cur = req; defs == NULL ? cur != NULL : defs[i] != NULL; i++) {
+		if (defs != NULL)
+			cur = find_resource_req(req, defs[i]);
+		if (cur != NULL) {
+			if (!add_resresv_set_key(buf, size, cur->name))
+				return 0;
+			if (cur->type.is_consumable || cur->type.is_boolean) {
+				snprintf(numbuf, sizeof(numbuf), "%.17g", cur->amount);
+				if (!add_resresv_set_key(buf, size, numbuf))
+					return 0;
+			} else if (cur->type.is_string) {
+				if (!add_resresv_set_key(buf, size, cur->res_str))
+					return 0;
+			} else {
+				snprintf(numbuf, sizeof(numbuf), "\003%d", resresv->rank);
+				if (!add_resresv_set_key(buf, size, numbuf))
+					return 0;
+			}
+		}
+		if (defs == NULL)
+			cur = cur->next;
+	}
+	return 1;
 }
 
 /**
- * @brief resresv_set copy constructor
+ * @brief build the key of the resresv_set a resresv belongs in
+ *
+ * @par Two resresvs with the same key are in the same set as defined by
+ *	find_resresv_set().  The reverse isn't always true (e.g., select specs
+ *	which only differ in the order of their resources).  This only costs
+ *	an extra set.
+ *
+ * @param[in] policy - policy info
+ * @param[in] resresv - resresv to build the key for
+ * @param[in,out] buf - buffer to build the key in (may be realloc()'d)
+ * @param[in,out] size - allocated size of buf
+ *
+ * @return char *
+ * @retval the key (*buf)
+ * @retval NULL on error
  */
-resresv_set *
-dup_resresv_set(resresv_set *oset, server_info *nsinfo)
+static char *
+resresv_set_key(status *policy, resource_resv *resresv, char **buf, int *size)
 {
-	resresv_set *rset;
-
-	if (oset == NULL || nsinfo == NULL)
-		return NULL;
+	queue_info *qinfo = NULL;
+	selspec *sspec;
+	place *pl;
+	char numbuf[64];
+	int i;
 
-	rset = new_resresv_set();
-	if (rset == NULL)
-		return NULL;
+	if (*buf == NULL) {
+		if ((*buf = malloc(256)) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return NULL;
+		}
+		*size = 256;
+	}
+	(*buf)[0] = '\0';
 
-	rset->can_not_run = oset->can_not_run;
+	if (resresv->is_job && resresv->job != NULL)
+		if (resresv_set_use_queue(resresv->job->queue))
+			qinfo = resresv->job->queue;
 
-	rset->err = dup_schd_error(oset->err);
-	if (oset->err != NULL && oset->err == NULL) {
-		free_resresv_set(rset);
+	if (!add_resresv_set_key(buf, size, qinfo == NULL ? NULL : qinfo->name))
 		return NULL;
-	}
-
-	rset->user = string_dup(oset->user);
-	if (oset->user != NULL && rset->user == NULL) {
-		free_resresv_set(rset);
+	if (!add_resresv_set_key(buf, size,
+		resresv_set_use_user(resresv->server, qinfo) ? resresv->user : NULL))
 		return NULL;
-	}
-	rset->group = string_dup(oset->group);
-	if (oset->group != NULL && rset->group == NULL) {
-		free_resresv_set(rset);
+	if (!add_resresv_set_key(buf, size,
+		resresv_set_use_grp(resresv->server, qinfo) ? resresv->group : NULL))
 		return NULL;
-	}
-	rset->project = string_dup(oset->project);
-	if (oset->project != NULL && rset->project == NULL) {
-		free_resresv_set(rset);
+	if (!add_resresv_set_key(buf, size,
+		resresv_set_use_proj(resresv->server, qinfo) ? resresv->project : NULL))
 		return NULL;
-	}
-	rset->partition = string_dup(oset->partition);
-	if (oset->partition != NULL && rset->partition == NULL) {
-		free_resresv_set(rset);
+	if (!add_resresv_set_key(buf, size, (resresv->is_job && resresv->job != NULL) ?
+		resresv->job->queue->partition : NULL))
 		return NULL;
-	}
-	rset->select_spec = dup_selspec(oset->select_spec);
-	if (rset->select_spec == NULL) {
-		free_resresv_set(rset);
+
+	sspec = resresv_set_which_selspec(resresv);
+	if (sspec != NULL && sspec->chunks != NULL) {
+		snprintf(numbuf, sizeof(numbuf), "%d", sspec->total_chunks);
+		if (!add_resresv_set_key(buf, size, numbuf))
+			return NULL;
+		for (i = 0; sspec->chunks[i] != NULL; i++) {
+			chunk *chk = sspec->chunks[i];
+
+			snprintf(numbuf, sizeof(numbuf), "%d:%d", chk->num_chunks, chk->seq_num);
+			if (!add_resresv_set_key(buf, size, numbuf))
+				return NULL;
+			if (chk->str_chunk != NULL) {
+				if (!add_resresv_set_key(buf, size, chk->str_chunk))
+					return NULL;
+			} else if (!add_resresv_set_req_key(buf, size, chk->req, NULL, resresv))
+				return NULL;
+		}
+	} else if (!add_resresv_set_key(buf, size, NULL))
 		return NULL;
-	}
-	rset->place_spec = dup_place(oset->place_spec);
-	if (rset->place_spec == NULL) {
-		free_resresv_set(rset);
+
+	pl = resresv->place_spec;
+	if (pl != NULL) {
+		snprintf(numbuf, sizeof(numbuf), "%d%d%d%d%d%d%d", pl->excl, pl->exclhost,
+			pl->share, pl->free, pl->pack, pl->scatter, pl->vscatter);
+		if (!add_resresv_set_key(buf, size, numbuf) ||
+			!add_resresv_set_key(buf, size, pl->group))
+			return NULL;
+	} else if (!add_resresv_set_key(buf, size, NULL))
 		return NULL;
-	}
-	rset->req = dup_resource_req_list(oset->req);
-	if (oset->req != NULL && rset->req == NULL) {
-		free_resresv_set(rset);
+
+	/* No resources at all is different from no resources we compare */
+	if (resresv->resreq == NULL) {
+		if (!add_resresv_set_key(buf, size, NULL))
+			return NULL;
+	} else if (!add_resresv_set_req_key(buf, size, resresv->resreq, policy->equiv_class_resdef, resresv))
 		return NULL;
-	}
-	if(oset->qinfo != NULL)
-		rset->qinfo = find_queue_info(nsinfo->queues, oset->qinfo->name);
 
-	return rset;
+	return *buf;
 }
+
 /**
- * @brief resresv_set array copy constructor
+ * @brief create equivalence classes based on an array of resresvs
+ * @param[in] policy - policy info
+ * @param[in] sinfo - server universe
+ * @return array of equivalence classes (resresv_sets)
  */
 resresv_set **
-dup_resresv_set_array(resresv_set **osets, server_info *nsinfo)
+create_resresv_sets(status *policy, server_info *sinfo)
 {
 	int i;
+	int j = 0;
+	int cur_ind;
 	int len;
+	int rset_len;
+	resource_resv **resresvs;
 	resresv_set **rsets;
-	if (osets == NULL || nsinfo == NULL)
+	resresv_set **tmp_rset_arr;
+	resresv_set *cur_rset;
+	AVL_IX_DESC *idx;	/* set key -> index into rsets */
+	int *inds;
+	int *found;
+	char *key = NULL;
+	int keysize = 0;
+
+	if (policy == NULL || sinfo == NULL)
 		return NULL;
 
-	len = count_array((void **) osets);
+	resresvs = sinfo->jobs;
 
+	len = count_array((void **) resresvs);
 	rsets = malloc((len + 1) * sizeof(resresv_set *));
 	if (rsets == NULL) {
 		log_err(errno, __func__, MEM_ERR_MSG);
 		return NULL;
 	}
-
-	for (i = 0; osets[i] != NULL; i++) {
-		rsets[i] = dup_resresv_set(osets[i], nsinfo);
-		if (rsets[i] == NULL) {
-			free_resresv_set_array(rsets);
-			return NULL;
-		}
+	inds = malloc((len + 1) * sizeof(int));
+	if (inds == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(rsets);
+		return NULL;
+	}
+	if ((idx = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(rsets);
+		free(inds);
+		return NULL;
 	}
-	rsets[i] = NULL;
-	return rsets;
-
-}
-
-/**
- * @brief should a resresv_set use the user
- * @param sinfo - server info
- * @param qinfo - queue info
- * @retval 1 - yes
- * @retval 0 - no
- */
-int
-resresv_set_use_user(server_info *sinfo, queue_info *qinfo)
-{
-	if ((sinfo != NULL) && (sinfo->has_user_limit))
-		return 1;
-	if ((qinfo != NULL) && (qinfo->has_user_limit))
-		return 1;
-
-
-	return 0;
-}
 
-/**
- * @brief should a resresv_set use the group
- * @param sinfo - server info
- * @param qinfo - queue info
- * @retval 1 - yes
- * @retval 0 - no
- */
-int
-resresv_set_use_grp(server_info *sinfo, queue_info *qinfo)
-{
-	if ((sinfo != NULL) && (sinfo->has_grp_limit))
-		return 1;
-	if ((qinfo != NULL) && (qinfo->has_grp_limit))
-		return 1;
+	rsets[0] = NULL;
 
+	for (i = 0; resresvs[i] != NULL; i++) {
+		if (resresv_set_key(policy, resresvs[i], &key, &keysize) == NULL) {
+			free_resresv_set_array(rsets);
+			rsets = NULL;
+			break;
+		}
+		found = find_tree(idx, key);
 
-	return 0;
-}
+		/* Didn't find the set, create it.*/
+		if (found == NULL) {
+			cur_rset = create_resresv_set_by_resresv(policy, sinfo, resresvs[i]);
+			if (cur_rset == NULL) {
+				free_resresv_set_array(rsets);
+				rsets = NULL;
+				break;
+			}
+			cur_ind = j;
+			inds[j] = j;
+			rsets[j++] = cur_rset;
+			rsets[j] = NULL;
+			if ((cur_rset->key = string_dup(key)) == NULL ||
+				tree_add_del(idx, key, &inds[cur_ind], TREE_OP_ADD) != 0) {
+				free_resresv_set_array(rsets);
+				rsets = NULL;
+				break;
+			}
+		} else {
+			cur_ind = *found;
+			cur_rset = rsets[cur_ind];
+		}
 
-/**
- * @brief should a resresv_set use the project
- * @param sinfo - server info
- * @param qinfo - queue info
- * @retval 1 - yes
- * @retval 0 - no
- */
-int
-resresv_set_use_proj(server_info *sinfo, queue_info *qinfo)
-{
-	if ((sinfo != NULL) && (sinfo->has_proj_limit))
-		return 1;
-	if ((qinfo != NULL) && (qinfo->has_proj_limit))
-		return 1;
+		resresvs[i]->ec_index = cur_ind;
+	}
+	free(key);
+	avl_destroy_index(idx);
+	free(idx);
+	free(inds);
+	if (rsets == NULL)
+		return NULL;
 
+	tmp_rset_arr = realloc(rsets,(j + 1) * sizeof(resresv_set *));
+	if (tmp_rset_arr != NULL)
+		rsets = tmp_rset_arr;
+	rset_len = count_array((void **)rsets);
+	if (rset_len > 0) {
+		log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, 
+			"Number of job equivalence classes: %d", rset_len);
+	}
 
-	return 0;
+	return rsets;
 }
 
+/*
+ * Can't run reasons of equivalence classes kept between cycles
+ * (incremental_equiv_class).  They are only used in a cycle whose universe
+ * has the same fingerprint as the one they were found in, and only saved
+ * if nothing ran or changed during that cycle.
+ */
+struct resresv_set_memo {
+	char *key;			/* resresv_set key of the class */
+	schd_error *err;		/* why the class could not run (rdef is NULL) */
+	char *rdef_name;		/* name of err->rdef, can be NULL */
+};
+static struct {
+	struct resresv_set_memo *entries;	/* sorted by key */
+	int num_entries;
+	unsigned long long fingerprint;	/* universe the entries were found in */
+	int age;			/* cycles the entries have been used */
+	unsigned long long cycle_fingerprint;	/* universe at the start of this cycle */
+	int cycle_valid;		/* cycle_fingerprint is for this cycle */
+} ec_memo;
+
 /**
- * @brief should a resresv_set use the queue
- * 	A resresv_set should use queue for the following reasons:
- * 	Hard limits	max_run_res, etc
- * 	Soft Limits	max_run_res_soft, etc
- * 	Nodes		Queue has nodes(e.g., node's queue attribute)
- * 	Dedtime queue 	Queue is a dedicated time queue
- * 	Primetime	Queue is a primetime queue
- * 	Non-primetime	Queue is a non-primetime queue
- * 	Resource limits	Queue has resources_available limits
- * 	Reservation	Queue is a reservation queue
+ * @brief
+ *		can a can't run reason be kept between cycles?  Only lack of
+ *		resources and limits qualify.  They can't change unless the
+ *		universe does.  Reasons which depend on the time or the calendar
+ *		(dedicated/prime time, reservations, backfilling, strict ordering)
+ *		are evaluated every cycle.
  *
- * @param qinfo - the queue
- * @retval 1 - yes
- * @retval 0 - no
+ * @param[in]	err	-	the reason
+ *
+ * @return	int
+ * @retval	1	: yes
+ * @retval	0	: no
  */
-int
-resresv_set_use_queue(queue_info *qinfo)
+static int
+resresv_set_memo_err_ok(schd_error *err)
 {
-	if (qinfo == NULL)
+	if (err == NULL)
+		return 0;
+	if (err->status_code != NOT_RUN && err->status_code != NEVER_RUN)
 		return 0;
 
-	if (qinfo->has_hard_limit || qinfo->has_soft_limit || qinfo->has_nodes ||
-	    qinfo->is_ded_queue || qinfo->is_prime_queue || qinfo->is_nonprime_queue ||
-	    qinfo->has_resav_limit || qinfo->resv != NULL)
-		return 1;
-
-	return 0;
+	switch (err->error_code) {
+		case INSUFFICIENT_RESOURCE:
+		case INSUFFICIENT_QUEUE_RESOURCE:
+		case INSUFFICIENT_SERVER_RESOURCE:
+		case NOT_ENOUGH_NODES_AVAIL:
+		case NO_NODE_RESOURCES:
+		case NO_FREE_NODES:
+		case NO_TOTAL_NODES:
+		case SET_TOO_SMALL:
+		case CANT_SPAN_PSET:
+		case QUEUE_JOB_LIMIT_REACHED:
+		case SERVER_JOB_LIMIT_REACHED:
+		case SERVER_USER_LIMIT_REACHED:
+		case QUEUE_USER_LIMIT_REACHED:
+		case SERVER_GROUP_LIMIT_REACHED:
+		case QUEUE_GROUP_LIMIT_REACHED:
+		case QUEUE_USER_RES_LIMIT_REACHED:
+		case SERVER_USER_RES_LIMIT_REACHED:
+		case QUEUE_GROUP_RES_LIMIT_REACHED:
+		case SERVER_GROUP_RES_LIMIT_REACHED:
+		case QUEUE_BYGROUP_JOB_LIMIT_REACHED:
+		case QUEUE_BYUSER_JOB_LIMIT_REACHED:
+		case SERVER_BYGROUP_JOB_LIMIT_REACHED:
+		case SERVER_BYUSER_JOB_LIMIT_REACHED:
+		case SERVER_BYGROUP_RES_LIMIT_REACHED:
+		case SERVER_BYUSER_RES_LIMIT_REACHED:
+		case QUEUE_BYGROUP_RES_LIMIT_REACHED:
+		case QUEUE_BYUSER_RES_LIMIT_REACHED:
+		case QUEUE_RESOURCE_LIMIT_REACHED:
+		case SERVER_RESOURCE_LIMIT_REACHED:
+		case SERVER_PROJECT_LIMIT_REACHED:
+		case SERVER_PROJECT_RES_LIMIT_REACHED:
+		case SERVER_BYPROJECT_RES_LIMIT_REACHED:
+		case SERVER_BYPROJECT_JOB_LIMIT_REACHED:
+		case QUEUE_PROJECT_LIMIT_REACHED:
+		case QUEUE_PROJECT_RES_LIMIT_REACHED:
+		case QUEUE_BYPROJECT_RES_LIMIT_REACHED:
+		case QUEUE_BYPROJECT_JOB_LIMIT_REACHED:
+			return 1;
+		default:
+			return 0;
+	}
 }
 
 /**
- * @brief determine which selspec to use from a resource_resv for a resresv_set
+ * @brief
+ *		fingerprint what the can't run reasons kept between cycles depend
+ *		on: the vnodes, the resources, limits and running counts of the
+ *		server and queues, the running jobs and the reservations.  Queued
+ *		jobs are not part of it.  A new job in an existing class doesn't
+ *		change whether the class can run.
  *
- * @par Jobs that have an execselect are either running or need to be placed
- *	back on the nodes they were originally running on (e.g., suspended jobs).
- *	We need to put them in their own set because they are no longer
- *	requesting the same resources as jobs with the same select spec.
- *	They are requesting the resources on each vnode they are running on.
- *	We don't care about running jobs because the only time they will be
- *	looked at is if they are requeued.  At that point they are back in
- *	the queued state and have the same select spec as they originally did.
+ * @param[in]	sinfo	-	the server universe
  *
- * @return selspec *
- * @retval selspec to use
- * @retval NULL on error
+ * @return	the fingerprint
  */
-selspec *
-resresv_set_which_selspec(resource_resv *resresv)
+static unsigned long long
+resresv_set_memo_fingerprint(server_info *sinfo)
 {
-	if(resresv == NULL)
-		return NULL;
-
-	if (resresv->job != NULL && !resresv->job->is_running && resresv->execselect != NULL)
-		return resresv->execselect;
-
-	return resresv->select;
-}
-
-/**
- * @brief create the list of resources to consider when creating the resresv sets
- * @param policy[in] - policy info
- * @param sinfo[in] - server universe
- * @return resdef **
- * @retval array of resdefs for creating resresv_set's resources.
- * @retval NULL on error
- */
-resdef **
-create_resresv_sets_resdef(status *policy, server_info *sinfo) {
-	resdef **defs;
-	int def_ct;
-	int limres_ct = 0;
+	unsigned long long h = FINGERPRINT_INIT;
+	status *policy = sinfo->policy;
+	schd_resource *res;
+	int bits;
 	int i;
-	schd_resource *limres;
-	schd_resource *cur_res;
 
-	if (policy == NULL || sinfo == NULL)
-		return NULL;
+	bits = policy->is_prime | policy->is_ded_time << 1 | policy->backfill << 2 |
+		policy->strict_ordering << 3 | policy->preempting << 4;
+	h = fingerprint_add(h, &bits, sizeof(bits));
 
-	limres = query_limres();
-	for (cur_res = limres; cur_res != NULL; cur_res = cur_res->next)
-		limres_ct++;
+	h = fingerprint_add_nodes(h, sinfo);
 
-	def_ct = count_array((void **) policy->resdef_to_check);
-	/* 6 for ctime, walltime, max_walltime, min_walltime, preempt_targets (maybe), and NULL*/
-	defs = malloc((def_ct + limres_ct + 6) * sizeof(resdef *));
+	h = fingerprint_add(h, &sinfo->sc.running, sizeof(sinfo->sc.running));
+	h = fingerprint_add(h, &sinfo->sc.suspended, sizeof(sinfo->sc.suspended));
+	h = fingerprint_add(h, &sinfo->sc.exiting, sizeof(sinfo->sc.exiting));
+	for (res = sinfo->res; res != NULL; res = res->next) {
+		h = fingerprint_add_str(h, res->name);
+		h = fingerprint_add(h, &res->avail, sizeof(res->avail));
+		h = fingerprint_add(h, &res->assigned, sizeof(res->assigned));
+	}
+	h = lim_fingerprint(sinfo->liminfo, h);
+
+	for (i = 0; sinfo->queues != NULL && sinfo->queues[i] != NULL; i++) {
+		queue_info *qinfo = sinfo->queues[i];
+
+		bits = qinfo->is_started | qinfo->is_exec << 1 | qinfo->is_ok_to_run << 2;
+		h = fingerprint_add_str(h, qinfo->name);
+		h = fingerprint_add(h, &bits, sizeof(bits));
+		h = fingerprint_add(h, &qinfo->sc.running, sizeof(qinfo->sc.running));
+		for (res = qinfo->qres; res != NULL; res = res->next) {
+			h = fingerprint_add_str(h, res->name);
+			h = fingerprint_add(h, &res->avail, sizeof(res->avail));
+			h = fingerprint_add(h, &res->assigned, sizeof(res->assigned));
+		}
+		h = lim_fingerprint(qinfo->liminfo, h);
+	}
 
-	for (i = 0; i < def_ct; i++)
-		defs[i] = policy->resdef_to_check[i];
-	defs[i++] = getallres(RES_CPUT);
-	defs[i++] = getallres(RES_WALLTIME);
-	defs[i++] = getallres(RES_MAX_WALLTIME);
-	defs[i++] = getallres(RES_MIN_WALLTIME);
-	if(sinfo->preempt_targets_enable)
-		defs[i++] = getallres(RES_PREEMPT_TARGETS);
-	defs[i] = NULL;
+	for (i = 0; sinfo->running_jobs != NULL && sinfo->running_jobs[i] != NULL; i++)
+		h = fingerprint_add_str(h, sinfo->running_jobs[i]->name);
 
-	for (cur_res = limres; cur_res != NULL; cur_res = cur_res->next) {
-		/* There may be overlap between resdef_to_check and limres */
-		if (!resdef_exists_in_array(defs, cur_res->def)) {
-			defs[i++] = cur_res->def;
-			defs[i] = NULL;
-		}
+	for (i = 0; sinfo->resvs != NULL && sinfo->resvs[i] != NULL; i++) {
+		resource_resv *resv = sinfo->resvs[i];
+
+		h = fingerprint_add_str(h, resv->name);
+		h = fingerprint_add(h, &resv->start, sizeof(resv->start));
+		h = fingerprint_add(h, &resv->end, sizeof(resv->end));
+		if (resv->resv != NULL)
+			h = fingerprint_add(h, &resv->resv->resv_state, sizeof(resv->resv->resv_state));
 	}
 
-	return defs;
+	return h;
 }
 
 /**
- * @brief create a resresv_set based on a resource_resv
- *
- * @param[in] policy - policy info
- * @param[in] sinfo - server info
- * @param[in] resresv - resresv to create resresv set from
- *
- * @return resresv_set **
- * @retval newly created resresv_set
- * @retval NULL on error
+ * @brief
+ *		compare two kept can't run reasons by key for qsort() and bsearch()
  */
-resresv_set *
-create_resresv_set_by_resresv(status *policy, server_info *sinfo, resource_resv *resresv)
+static int
+cmp_resresv_set_memo(const void *v1, const void *v2)
 {
-	resresv_set *rset;
-	if (policy == NULL || resresv == NULL)
-		return NULL;
-
-	rset = new_resresv_set();
-	if (rset == NULL)
-		return NULL;
-
-	if (resresv->is_job && resresv->job != NULL) {
-		if (resresv_set_use_queue(resresv->job->queue))
-			rset->qinfo = resresv->job->queue;
-	}
-
-	if (resresv_set_use_user(sinfo, rset->qinfo))
-		rset->user = string_dup(resresv->user);
-	if (resresv_set_use_grp(sinfo, rset->qinfo))
-		rset->group = string_dup(resresv->group);
-	if (resresv_set_use_proj(sinfo, rset->qinfo))
-		rset->project = string_dup(resresv->project);
-
-	if (resresv->is_job && resresv->job != NULL) {
-		if (resresv->job->queue->partition != NULL)
-			rset->partition = string_dup(resresv->job->queue->partition);
-	}
-
-	rset->select_spec = dup_selspec(resresv_set_which_selspec(resresv));
-	if (rset->select_spec == NULL) {
-		free_resresv_set(rset);
-		return NULL;
-	}
-	rset->place_spec = dup_place(resresv->place_spec);
-	if (rset->place_spec == NULL) {
-		free_resresv_set(rset);
-		return NULL;
-	}
-	/* rset->req may be NULL if the intersection of resresv->resreq and policy->equiv_class_resdef is the NULL set */
-	rset->req = dup_selective_resource_req_list(resresv->resreq, policy->equiv_class_resdef);
-
-
-	return rset;
+	return strcmp(((const struct resresv_set_memo *) v1)->key,
+		((const struct resresv_set_memo *) v2)->key);
 }
 
 /**
- * @brief find the index of a resresv_set by its component parts
- * @par qinfo, user, group, project, or req can be NULL if the resresv_set does not have one
- * @param[in] policy - policy info
- * @param[in] rsets - resresv_sets to search
- * @param[in] user - user name
- * @param[in] group - group name
- * @param[in] project - project name
- * @param[in] sel - select spec
- * @param[in] pl - place spec
- * @param[in] req - list of resources (i.e., qsub -l)
- * @param[in] qinfo - queue
- * @return int
- * @retval index of resresv if found
- * @retval -1 if not found or on error
+ * @brief
+ *		free the can't run reasons kept between cycles
+ *
+ * @return	void
  */
-int
-find_resresv_set(status *policy, resresv_set **rsets, char *user, char *group, char *project, char *partition, selspec *sel, place *pl, resource_req *req, queue_info *qinfo)
+void
+free_resresv_set_memo(void)
 {
 	int i;
 
-	if (rsets == NULL)
-		return -1;
-
-	for (i = 0; rsets[i] != NULL; i++) {
-		if ((qinfo != NULL && rsets[i]->qinfo == NULL) || (qinfo == NULL && rsets[i]->qinfo != NULL))
-			continue;
-		if ((qinfo != NULL && rsets[i]->qinfo != NULL) && cstrcmp(qinfo->name, rsets[i]->qinfo->name) != 0)
-
-			continue;
-		if ((user != NULL && rsets[i]->user == NULL) || (user == NULL && rsets[i]->user != NULL))
-			continue;
-		if (user != NULL && cstrcmp(user, rsets[i]->user) != 0)
-			continue;
-
-		if ((group != NULL && rsets[i]->group == NULL) || (group == NULL && rsets[i]->group != NULL))
-			continue;
-		if (group != NULL && cstrcmp(group, rsets[i]->group) != 0)
-			continue;
-
-		if ((project != NULL && rsets[i]->project == NULL) || (project == NULL && rsets[i]->project != NULL))
-			continue;
-		if (project != NULL && cstrcmp(project, rsets[i]->project) != 0)
-			continue;
-
-		if ((partition != NULL && rsets[i]->partition == NULL) || (partition == NULL && rsets[i]->partition != NULL))
-			continue;
-		if (partition != NULL && cstrcmp(partition, rsets[i]->partition) != 0)
-			continue;
-
-		if (compare_selspec(rsets[i]->select_spec, sel) == 0)
-			continue;
-		if (compare_place(rsets[i]->place_spec, pl) == 0)
-			continue;
-		if (compare_resource_req_list(rsets[i]->req, req, policy->equiv_class_resdef) == 0)
-			continue;
-		/* If we got here, we have found our set */
-		return i;
+	for (i = 0; i < ec_memo.num_entries; i++) {
+		free(ec_memo.entries[i].key);
+		free_schd_error(ec_memo.entries[i].err);
+		free(ec_memo.entries[i].rdef_name);
 	}
-	return -1;
-
+	free(ec_memo.entries);
+	ec_memo.entries = NULL;
+	ec_memo.num_entries = 0;
+	ec_memo.age = 0;
 }
 
 /**
- * @brief find the index of a resresv_set by a resresv inside it
- * @param[in] policy - policy info
- * @param[in] rsets - resresv_set array to search
- * @param[in] resresv - resresv to search for
- * @return index of resresv
+ * @brief
+ *		mark the equivalence classes which could not run last cycle as
+ *		not able to run this cycle, if nothing they depend on has
+ *		changed since.  Their jobs are then turned away by is_ok_to_run()
+ *		with the same reason as last cycle.  Also takes the fingerprint
+ *		save_resresv_set_memo() compares against at the end of the cycle.
+ *
+ * @param[in]	sinfo	-	the server universe
+ *
+ * @return	int
+ * @retval	number of classes marked
  */
 int
-find_resresv_set_by_resresv(status *policy, resresv_set **rsets, resource_resv *resresv)
+apply_resresv_set_memo(server_info *sinfo)
 {
-	char *user = NULL;
-	char *grp = NULL;
-	char *proj = NULL;
-	char *partition = NULL;
-	queue_info *qinfo = NULL;
-	selspec *sspec;
+	struct resresv_set_memo key;
+	struct resresv_set_memo *ent;
+	resresv_set *rset;
+	schd_error *err;
+	int marked = 0;
+	int num_sets;
+	int i;
 
-	if (policy == NULL || rsets == NULL || resresv == NULL)
-		return -1;
+	ec_memo.cycle_valid = 0;
+	if (!conf.incr_equiv_class || sinfo == NULL || sinfo->equiv_classes == NULL) {
+		free_resresv_set_memo();
+		return 0;
+	}
 
-	if (resresv->is_job && resresv->job != NULL)
-		if (resresv_set_use_queue(resresv->job->queue))
-			qinfo = resresv->job->queue;
+	ec_memo.cycle_fingerprint = resresv_set_memo_fingerprint(sinfo);
+	ec_memo.cycle_valid = 1;
 
-	if (resresv_set_use_user(resresv->server, qinfo))
-		user = resresv->user;
+	if (ec_memo.num_entries == 0)
+		return 0;
+	if (ec_memo.fingerprint != ec_memo.cycle_fingerprint ||
+		ec_memo.age >= EQUIV_CLASS_MEMO_FULL_REFRESH) {
+		free_resresv_set_memo();
+		return 0;
+	}
+	ec_memo.age++;
 
-	if (resresv_set_use_grp(resresv->server, qinfo))
-		grp = resresv->group;
+	for (i = 0; sinfo->equiv_classes[i] != NULL; i++) {
+		rset = sinfo->equiv_classes[i];
+		if (rset->key == NULL || rset->can_not_run)
+			continue;
 
-	if (resresv_set_use_proj(resresv->server, qinfo))
-		proj = resresv->project;
+		key.key = rset->key;
+		ent = bsearch(&key, ec_memo.entries, ec_memo.num_entries,
+			sizeof(struct resresv_set_memo), cmp_resresv_set_memo);
+		if (ent == NULL)
+			continue;
 
-	if (resresv->is_job && resresv->job != NULL) {
-		if (resresv->job->queue->partition != NULL)
-			partition = resresv->job->queue->partition;
+		if ((err = dup_schd_error(ent->err)) == NULL)
+			continue;
+		if (ent->rdef_name != NULL &&
+			(err->rdef = find_resdef(allres, ent->rdef_name)) == NULL) {
+			free_schd_error(err);
+			continue;
+		}
+		rset->can_not_run = 1;
+		rset->err = err;
+		marked++;
 	}
+	num_sets = i;
 
-	sspec = resresv_set_which_selspec(resresv);
+	log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+		"%d of %d job equivalence classes can not run for the same reason as last cycle",
+		marked, num_sets);
 
-	return find_resresv_set(policy, rsets, user, grp, proj, partition, sspec, resresv->place_spec, resresv->resreq, qinfo);
+	return marked;
 }
 
 /**
- * @brief create equivalence classes based on an array of resresvs
- * @param[in] policy - policy info
- * @param[in] sinfo - server universe
- * @return array of equivalence classes (resresv_sets)
+ * @brief
+ *		keep the reasons the equivalence classes could not run this cycle
+ *		for the next one.  They are only kept if the universe is the
+ *		same as at the start of the cycle, e.g., nothing ran or was
+ *		preempted.  Otherwise a class may have failed on what this cycle
+ *		ran, and that is not what the next cycle will see.
+ *
+ * @param[in]	sinfo	-	the server universe at the end of the cycle
+ *
+ * @return	void
  */
-resresv_set **
-create_resresv_sets(status *policy, server_info *sinfo)
+void
+save_resresv_set_memo(server_info *sinfo)
 {
+	struct resresv_set_memo *entries;
+	resresv_set *rset;
+	int age;
+	int len;
 	int i;
 	int j = 0;
-	int cur_ind;
-	int len;
-	int rset_len;
-	resource_resv **resresvs;
-	resresv_set **rsets;
-	resresv_set **tmp_rset_arr;
-	resresv_set *cur_rset;
 
-	if (policy == NULL || sinfo == NULL)
-		return NULL;
+	if (!ec_memo.cycle_valid)
+		return;
+	ec_memo.cycle_valid = 0;
 
-	resresvs = sinfo->jobs;
+	age = ec_memo.age;
+	free_resresv_set_memo();
 
-	len = count_array((void **) resresvs);
-	rsets = malloc((len + 1) * sizeof(resresv_set *));
-	if (rsets == NULL) {
+	if (!conf.incr_equiv_class || sinfo == NULL || sinfo->equiv_classes == NULL)
+		return;
+	if (resresv_set_memo_fingerprint(sinfo) != ec_memo.cycle_fingerprint)
+		return;
+
+	len = count_array((void **) sinfo->equiv_classes);
+	if (len == 0)
+		return;
+	if ((entries = calloc(len, sizeof(struct resresv_set_memo))) == NULL) {
 		log_err(errno, __func__, MEM_ERR_MSG);
-		return NULL;
+		return;
 	}
 
-	rsets[0] = NULL;
-
-	for (i = 0; resresvs[i] != NULL; i++) {
-		cur_ind = find_resresv_set_by_resresv(policy, rsets, resresvs[i]);
-
-		/* Didn't find the set, create it.*/
-		if (cur_ind == -1) {
-			cur_rset = create_resresv_set_by_resresv(policy, sinfo, resresvs[i]);
-			if (cur_rset == NULL) {
-				free_resresv_set_array(rsets);
-				return NULL;
-			}
-			cur_ind = j;
-			rsets[j++] = cur_rset;
-			rsets[j] = NULL;
-		} else
-			cur_rset = rsets[cur_ind];
+	for (i = 0; i < len; i++) {
+		rset = sinfo->equiv_classes[i];
+		if (!rset->can_not_run || rset->key == NULL ||
+			!resresv_set_memo_err_ok(rset->err))
+			continue;
 
-		resresvs[i]->ec_index = cur_ind;
+		entries[j].key = string_dup(rset->key);
+		entries[j].err = dup_schd_error(rset->err);
+		if (rset->err->rdef != NULL)
+			entries[j].rdef_name = string_dup(rset->err->rdef->name);
+		if (entries[j].key == NULL || entries[j].err == NULL ||
+			(rset->err->rdef != NULL && entries[j].rdef_name == NULL)) {
+			free(entries[j].key);
+			free_schd_error(entries[j].err);
+			free(entries[j].rdef_name);
+			memset(&entries[j], 0, sizeof(struct resresv_set_memo));
+			continue;
+		}
+		entries[j].err->rdef = NULL;
+		j++;
 	}
-
-	tmp_rset_arr = realloc(rsets,(j + 1) * sizeof(resresv_set *));
-	if (tmp_rset_arr != NULL)
-		rsets = tmp_rset_arr;
-	rset_len = count_array((void **)rsets);
-	if (rset_len > 0) {
-		log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, 
-			"Number of job equivalence classes: %d", rset_len);
+	if (j == 0) {
+		free(entries);
+		return;
 	}
 
-	return rsets;
+	qsort(entries, j, sizeof(struct resresv_set_memo), cmp_resresv_set_memo);
+	ec_memo.entries = entries;
+	ec_memo.num_entries = j;
+	ec_memo.fingerprint = ec_memo.cycle_fingerprint;
+	ec_memo.age = age;
 }
 
 /**
@@ -2635,13 +4280,14 @@ dup_job_info(job_info *ojinfo, queue_info *nqinfo, server_info *nsinfo)
 	if(njinfo->parent_job != NULL )
 		njinfo->parent_job = find_resource_resv_by_indrank(nqinfo->jobs, ojinfo->parent_job->rank, ojinfo->parent_job->resresv_ind);
 	njinfo->queued_subjobs = dup_range_list(ojinfo->queued_subjobs);
+	njinfo->materialized_subjobs = dup_range_list(ojinfo->materialized_subjobs);
 
 	njinfo->resreleased = dup_nspecs(ojinfo->resreleased, nsinfo->nodes);
 	njinfo->resreq_rel = dup_resource_req_list(ojinfo->resreq_rel);
 
 	if (nqinfo->server->fairshare !=NULL) {
 		njinfo->ginfo = find_group_info(ojinfo->ginfo->name,
-			nqinfo->server->fairshare->root);
+			nqinfo->server->fairshare);
 	}
 	else
 		njinfo->ginfo = NULL;
@@ -2668,6 +4314,62 @@ dup_job_info(job_info *ojinfo, queue_info *nqinfo, server_info *nsinfo)
 	return njinfo;
 }
 
+/* one preempt_targets criterion: either a queue or a resource and value */
+struct preempt_target {
+	char *queue;		/* queue name, NULL for a resource */
+	resdef *def;		/* resource of Resource_List.<res>=value */
+	char *value;		/* value of the resource */
+};
+
+/**
+ * @brief
+ * 		parse the preempt_targets of a job once, so that filtering the
+ * 		running jobs does not redo the string work for each of them
+ *
+ * @param[in]	arglist	-	attribute=value pairs of preempt_targets
+ *
+ * @return	struct preempt_target *
+ * @retval	array terminated by an entry with neither queue nor def,
+ *		the strings point into arglist
+ * @retval	NULL	: on error
+ */
+static struct preempt_target *
+parse_preempt_targets(char **arglist)
+{
+	struct preempt_target *targets;
+	char *p;
+	char *dot;
+	int i;
+	int j;
+
+	if ((targets = calloc(count_array((void **) arglist) + 1, sizeof(struct preempt_target))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	for (i = 0, j = 0; arglist[i] != NULL; i++) {
+		p = strpbrk(arglist[i], ".=");
+		if (p == NULL)
+			continue;
+		/* two valid attributes: queue and Resource_List.<res> */
+		if (!strncasecmp(arglist[i], ATTR_queue, p - arglist[i]))
+			targets[j++].queue = p + 1;
+		else if (!strncasecmp(arglist[i], ATTR_l, p - arglist[i])) {
+			dot = p;
+			p = strpbrk(arglist[i], "=");
+			if (p == NULL)
+				break;
+			*p = '\0';
+			targets[j].def = find_resdef(allres, dot + 1);
+			*p = '=';
+			if (targets[j].def != NULL)
+				targets[j++].value = p + 1;
+		}
+	}
+
+	return targets;
+}
+
 /**
  * @brief
  * 		filter function used with resource_resv_filter
@@ -2679,7 +4381,8 @@ dup_job_info(job_info *ojinfo, queue_info *nqinfo, server_info *nsinfo)
  * @see	resource_resv_filter()
  *
  * @param[in]	job	-	job to consider to include
- * @param[in]	arg	-	attribute=value pairs criteria for inclusion
+ * @param[in]	arg	-	preempt_targets criteria for inclusion from
+ *				parse_preempt_targets()
  *
  * @retval	int
  * @return	1	: If job falls into one of the preempt_targets
@@ -2689,40 +4392,23 @@ int
 preempt_job_set_filter(resource_resv *job, void *arg)
 {
 	resource_req *req;
-	char **arglist;
-	char *p;
-	char *dot;
+	struct preempt_target *targets;
 	int i;
 
 	if (job == NULL || arg == NULL || job->job == NULL ||
 		job->job->queue == NULL || job->job->is_running != 1)
 		return 0;
 
-	arglist = (char **) arg;
+	targets = (struct preempt_target *) arg;
 
-	for (i = 0; arglist[i] != NULL; i++) {
-		p = strpbrk(arglist[i], ".=");
-		if (p != NULL) {
-			/* two valid attributes: queue and Resource_List.<res> */
-			if (!strncasecmp(arglist[i], ATTR_queue, p - arglist[i])) {
-				if (!strcmp(job->job->queue->name, p+1))
-					return 1;
-			}
-			else if (!strncasecmp(arglist[i], ATTR_l, p - arglist[i])) {
-				dot = p;
-				p = strpbrk(arglist[i], "=");
-				if (p == NULL)
-					return 0;
-				else {
-					*p = '\0';
-					req = find_resource_req_by_str(job->resreq, dot+1);
-					*p = '=';
-					if (req != NULL) {
-						if (!strcmp(req->res_str, p+1))
-							return 1;
-					}
-				}
-			}
+	for (i = 0; targets[i].queue != NULL || targets[i].def != NULL; i++) {
+		if (targets[i].queue != NULL) {
+			if (!strcmp(job->job->queue->name, targets[i].queue))
+				return 1;
+		} else {
+			req = find_resource_req(job->resreq, targets[i].def);
+			if (req != NULL && !strcmp(req->res_str, targets[i].value))
+				return 1;
 		}
 	}
 	return 0;
@@ -2877,6 +4563,9 @@ find_and_preempt_jobs(status *policy, int pbs_sd, resource_resv *hjob, server_in
 			}
 		}
 
+		/* the jobs to preempt may include ones whose run is still queued */
+		flush_run_jobs(pbs_sd);
+
 		if ((preempt_jobs_reply = pbs_preempt_jobs(pbs_sd, preempt_jobs_list)) == NULL) {
 			free_string_array(preempt_jobs_list);
 			free(preempted_list);
@@ -2949,7 +4638,7 @@ find_and_preempt_jobs(status *policy, int pbs_sd, resource_resv *hjob, server_in
 
 	if (done) {
 		clear_schd_error(err);
-		ret = run_update_resresv(policy, pbs_sd, sinfo, hjob->job->queue, hjob, NULL, RURR_ADD_END_EVENT, err);
+		ret = run_update_resresv(policy, pbs_sd, sinfo, hjob->job->queue, hjob, NULL, RURR_ADD_END_EVENT | RURR_RUN_NOW, err);
 
 		/* oops... we screwed up.. the high priority job didn't run.  Forget about
 		 * running it now and resume preempted work
@@ -2968,7 +4657,7 @@ find_and_preempt_jobs(status *policy, int pbs_sd, resource_resv *hjob, server_in
 				job = find_resource_resv_by_indrank(sinfo->jobs, preempted_list[i], -1);
 				if (job != NULL && !job->job->is_running) {
 					clear_schd_error(serr);
-					if (run_update_resresv(policy, pbs_sd, sinfo, job->job->queue, job, NULL, RURR_NO_FLAGS, serr) == 0) {
+					if (run_update_resresv(policy, pbs_sd, sinfo, job->job->queue, job, NULL, RURR_RUN_NOW, serr) == 0) {
 						schdlogerr(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_DEBUG, job->name, "Failed to rerun job:", serr);
 					}
 				}
@@ -2991,6 +4680,106 @@ find_and_preempt_jobs(status *policy, int pbs_sd, resource_resv *hjob, server_in
 }
 
 
+/**
+ * @brief
+ *		resource_resv_filter() function to select the running jobs which can
+ *		ever be preempted.  The rest of the checks depend on the high
+ *		priority job and are done by select_index_to_preempt().
+ *
+ * @param[in]	job	-	running job
+ * @param[in]	arg	-	unused
+ *
+ * @return	int
+ * @retval	1	: job can be a preemption candidate
+ * @retval	0	: job can not be preempted
+ */
+static int
+preempt_candidate_filter(resource_resv *job, void *arg)
+{
+	if (job->job == NULL || job->ninfo_arr == NULL)
+		return 0;
+	if (!job->job->is_running || job->job->is_provisioning || job->job->can_not_preempt)
+		return 0;
+	return 1;
+}
+
+/**
+ * @brief
+ *		find the running jobs of a duplicated universe which have a lower
+ *		preempt priority than a high priority job, in the order they should
+ *		be preempted.
+ *
+ * @par
+ *		The candidates are kept on the original server in preemption order
+ *		and only re-sorted when the running jobs or their preempt priorities
+ *		change (see preempt_gen).  Since they are sorted by preempt priority
+ *		first, the candidates for a job are a prefix of the array which is
+ *		found with a binary search.  Simulating preemption only raises the
+ *		preempt priority of the remaining jobs, so jobs outside the prefix
+ *		never become candidates later on.
+ *
+ * @param[in]	sinfo	-	the server
+ * @param[in]	nsinfo	-	duplicate of sinfo to return the jobs from
+ * @param[in]	prio	-	preempt priority of the high priority job
+ * @param[out]	count	-	number of jobs returned
+ *
+ * @return	resource_resv ** (NULL terminated, jobs of nsinfo)
+ * @retval	NULL	: on error
+ * @par NOTE:	returned array is allocated with malloc() --  needs freeing
+ */
+static resource_resv **
+find_preempt_candidates(server_info *sinfo, server_info *nsinfo, int prio, int *count)
+{
+	resource_resv **cands;
+	int num;
+	int lo;
+	int hi;
+	int mid;
+	int i;
+
+	if (sinfo->preempt_cands == NULL || sinfo->preempt_cands_gen != sinfo->preempt_gen) {
+		free(sinfo->preempt_cands);
+		sinfo->preempt_cands = resource_resv_filter(sinfo->running_jobs,
+			count_array((void **) sinfo->running_jobs),
+			preempt_candidate_filter, NULL, NO_FLAGS);
+		if (sinfo->preempt_cands == NULL)
+			return NULL;
+		qsort(sinfo->preempt_cands, count_array((void **) sinfo->preempt_cands),
+			sizeof(resource_resv *), conf.preempt_min_wt_used ?
+			cmp_preempt_stime_asc : cmp_preempt_priority_asc);
+		sinfo->preempt_cands_gen = sinfo->preempt_gen;
+	}
+
+	/* find the first candidate whose preempt priority is not lower than prio */
+	lo = 0;
+	hi = count_array((void **) sinfo->preempt_cands);
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (sinfo->preempt_cands[mid]->job->preempt < prio)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	num = lo;
+
+	if ((cands = malloc((num + 1) * sizeof(resource_resv *))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	for (i = 0; i < num; i++) {
+		cands[i] = find_resource_resv_by_indrank(nsinfo->running_jobs,
+			sinfo->preempt_cands[i]->rank, sinfo->preempt_cands[i]->resresv_ind);
+		if (cands[i] == NULL) {
+			free(cands);
+			return NULL;
+		}
+	}
+	cands[num] = NULL;
+	*count = num;
+
+	return cands;
+}
+
 /**
  * @brief
  * 		find jobs to preempt in order to run a high priority job.
@@ -3048,6 +4837,7 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 	char **preempt_targets_list = NULL;
 	resource_resv **prjobs = NULL;
 	int rjobs_count = 0;
+	pbs_bitmap *hnodes = NULL;
 
 
 	*no_of_jobs = 0;
@@ -3131,9 +4921,11 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 		if(cur_err->status_code == NEVER_RUN)
 			cant_preempt = 1;
 		if (cant_preempt) {
-			translate_fail_code(cur_err, NULL, log_buf);
-			log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_DEBUG, hjob->name, 
-				"Preempt: Can not preempt to run job: %s", log_buf);
+			if (SCHED_WILL_LOG(PBSEVENT_DEBUG)) {
+				translate_fail_code(cur_err, NULL, log_buf);
+				log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_DEBUG, hjob->name,
+					"Preempt: Can not preempt to run job: %s", log_buf);
+			}
 			free_schd_error_list(full_err);
 			return NULL;
 		}
@@ -3175,10 +4967,15 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 
 	if (nsinfo->preempt_targets_enable) {
 		if (preempt_targets_req != NULL) {
-			prjobs = resource_resv_filter(nsinfo->running_jobs,
-				count_array((void **) nsinfo->running_jobs),
-				preempt_job_set_filter,
-				(void *) preempt_targets_list, NO_FLAGS);
+			struct preempt_target *targets;
+
+			if ((targets = parse_preempt_targets(preempt_targets_list)) != NULL) {
+				prjobs = resource_resv_filter(nsinfo->running_jobs,
+					count_array((void **) nsinfo->running_jobs),
+					preempt_job_set_filter,
+					(void *) targets, NO_FLAGS);
+				free(targets);
+			}
 			free_string_array(preempt_targets_list);
 		}
 	}
@@ -3200,25 +4997,31 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 			return NULL;
 		}
 
-	}
-	else {
-		rjobs = nsinfo->running_jobs;
-		rjobs_count = nsinfo->sc.running;
-	}
-
-	/* sort jobs in ascending preemption priority and starttime... we want to preempt them
-	 * from lowest prio to highest
-	 */
-	if (conf.preempt_min_wt_used) {
-		qsort(rjobs, rjobs_count, sizeof(job_info *),
-			cmp_preempt_stime_asc);
-	}
-	else {
-		/* sort jobs in ascending preemption priority... we want to preempt them
+		/* sort jobs in ascending preemption priority and starttime... we want to preempt them
 		 * from lowest prio to highest
 		 */
-		qsort(rjobs, rjobs_count, sizeof(job_info *),
-		cmp_preempt_priority_asc);
+		if (conf.preempt_min_wt_used) {
+			qsort(rjobs, rjobs_count, sizeof(job_info *),
+				cmp_preempt_stime_asc);
+		}
+		else {
+			/* sort jobs in ascending preemption priority... we want to preempt them
+			 * from lowest prio to highest
+			 */
+			qsort(rjobs, rjobs_count, sizeof(job_info *),
+			cmp_preempt_priority_asc);
+		}
+	}
+	else {
+		/* already in preemption order */
+		prjobs = find_preempt_candidates(sinfo, nsinfo, prev_prio, &rjobs_count);
+		if (prjobs == NULL) {
+			free_server(nsinfo);
+			free_schd_error_list(full_err);
+			free(pjobs);
+			return NULL;
+		}
+		rjobs = prjobs;
 	}
 
 	err = dup_schd_error(full_err);	/* only first element */
@@ -3347,9 +5150,11 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 			skipto = 0;
 		}
 
-		translate_fail_code(err, NULL, log_buf);
-		log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG, nhjob->name, 
-			"Simulation: not enough work preempted: %s", log_buf);
+		if (SCHED_WILL_LOG(PBSEVENT_DEBUG2)) {
+			translate_fail_code(err, NULL, log_buf);
+			log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG, nhjob->name,
+				"Simulation: not enough work preempted: %s", log_buf);
+		}
 	}
 
 	pjobs[j] = NULL;
@@ -3388,10 +5193,13 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 			return NULL;
 		}
 
+		/* the high priority job's vnodes are compared against every job */
+		hnodes = resresv_node_bits(nhjob);
+
 		for (j--, i = 0; j >= 0 ; j--) {
 			int remove_job = 0;
 			clear_schd_error(err);
-			if (preemption_similarity(nhjob, pjobs[j], full_err) == 0) {
+			if (preemption_similarity(nhjob, pjobs[j], full_err, hnodes) == 0) {
 				remove_job = 1;
 			} else if ((ns_arr = is_ok_to_run(npolicy, nsinfo,
 				pjobs[j]->job->queue, pjobs[j], NO_ALLPART, err)) != NULL) {
@@ -3411,6 +5219,8 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 			}
 		}
 
+		pbs_bitmap_free(hnodes);
+
 		pjobs_list[i] = 0;
 		/* i == 0 means we removed all the jobs: Should not happen */
 		if (i == 0) {
@@ -3677,6 +5487,9 @@ set_preempt_prio(resource_resv *job, queue_info *qinfo, server_info *sinfo)
 
 	jinfo = job->job;
 
+	if (jinfo->is_running)
+		sinfo->preempt_gen++;
+
 	/* in the case of reseting the value, we need to clear them first */
 	jinfo->preempt = 0;
 	jinfo->preempt_status = 0;
@@ -3785,6 +5598,7 @@ create_subjob_from_array(resource_resv *array, int index, char *subjob_name)
 {
 	resource_resv *subjob;	/* job_info structure for new subjob */
 	range *tmp;			/* a tmp ptr to hold the queued_indices ptr */
+	range *tmp_mat;			/* a tmp ptr to hold the materialized_subjobs ptr */
 
 	if (array == NULL || array->job == NULL)
 		return NULL;
@@ -3795,10 +5609,13 @@ create_subjob_from_array(resource_resv *array, int index, char *subjob_name)
 	/* so we don't dup the queued_indices for the subjob */
 	tmp = array->job->queued_subjobs;
 	array->job->queued_subjobs = NULL;
+	tmp_mat = array->job->materialized_subjobs;
+	array->job->materialized_subjobs = NULL;
 
 	subjob = dup_resource_resv(array, array->server, array->job->queue);
 
 	array->job->queued_subjobs = tmp;
+	array->job->materialized_subjobs = tmp_mat;
 
 	if (subjob == NULL)
 		return NULL;
@@ -3971,6 +5788,46 @@ modify_job_array_for_qrun(server_info *sinfo, char *jobid)
 	return 1;
 }
 
+/**
+ * @brief
+ *		collect the indices of the subjobs of a job array which already
+ *		exist as their own resource_resv in a job list.  This is done once
+ *		per job array so queue_subjob() does not need to search the whole
+ *		job list every time it materializes the next subjob.
+ *
+ * @param[in]	array	-	the job array
+ * @param[in]	jobs	-	the job list to search
+ *
+ * @return	range *
+ * @retval	range of materialized subjob indices (possibly empty)
+ * @retval	NULL	: on error
+ *
+ */
+static range *
+collect_materialized_subjobs(resource_resv *array, resource_resv **jobs)
+{
+	range *r;
+	int i;
+
+	if (array == NULL || array->name == NULL)
+		return NULL;
+
+	if ((r = new_range()) == NULL)
+		return NULL;
+
+	if (jobs == NULL)
+		return r;
+
+	for (i = 0; jobs[i] != NULL; i++) {
+		if (jobs[i]->job != NULL && jobs[i]->job->is_subjob &&
+			jobs[i]->job->array_id != NULL &&
+			strcmp(jobs[i]->job->array_id, array->name) == 0)
+			range_add_value(r, jobs[i]->job->array_index, DISABLE_SUBRANGE_STEPPING);
+	}
+
+	return r;
+}
+
 /**
  * @brief
  *		create a subjob from a job array and queue it
@@ -3986,6 +5843,10 @@ modify_job_array_for_qrun(server_info *sinfo, char *jobid)
  * @note
  * 		subjob will be attached to the server/queue job lists
  *
+ * @note
+ *		The job list is only searched for an existing subjob if its index
+ *		is known to have been materialized already.
+ *
  */
 resource_resv *
 queue_subjob(resource_resv *array, server_info *sinfo,
@@ -4004,9 +5865,15 @@ queue_subjob(resource_resv *array, server_info *sinfo,
 
 	subjob_index = range_next_value(array->job->queued_subjobs, -1);
 	if (subjob_index >= 0) {
+		if (array->job->materialized_subjobs == NULL)
+			array->job->materialized_subjobs =
+				collect_materialized_subjobs(array, sinfo->jobs);
+
 		subjob_name = create_subjob_name(array->name, subjob_index);
 		if (subjob_name != NULL) {
-			if ((rresv = find_resource_resv(sinfo->jobs, subjob_name)) != NULL) {
+			if ((array->job->materialized_subjobs == NULL ||
+				range_contains(array->job->materialized_subjobs, subjob_index)) &&
+				(rresv = find_resource_resv(sinfo->jobs, subjob_name)) != NULL) {
 				free(subjob_name);
 				/* Set tmparr to something so we're not considered an error */
 				tmparr = sinfo->jobs;
@@ -4024,6 +5891,9 @@ queue_subjob(resource_resv *array, server_info *sinfo,
 					sinfo->jobs = tmparr;
 					sinfo->sc.queued++;
 					sinfo->sc.total++;
+					if (array->job->materialized_subjobs != NULL)
+						range_add_value(array->job->materialized_subjobs,
+							subjob_index, DISABLE_SUBRANGE_STEPPING);
 
 					tmparr = add_resresv_to_array(sinfo->all_resresv, rresv, SET_RESRESV_INDEX);
 					if (tmparr != NULL) {
@@ -4052,7 +5922,9 @@ queue_subjob(resource_resv *array, server_info *sinfo,
 /**
  * @brief
  * 		evaluate a math formula for jobs based on their resources
- *		NOTE: currently done through embedded python interpreter
+ *		NOTE: simple arithmetic formulas are evaluated natively by
+ *		formula_native_evaluate(), the rest through the embedded
+ *		python interpreter
  *
  * @param[in]	formula	-	formula to evaluate
  * @param[in]	resresv	-	job for special case key words
@@ -4084,6 +5956,9 @@ formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
 		resresv->job == NULL || consres == NULL)
 		return 0;
 
+	if (formula_native_evaluate(formula, resresv, resreq, &ans))
+		return ans;
+
 	formula_buf_len = sizeof(buf) + strlen(formula) + 1;
 
 	formula_buf = malloc(formula_buf_len);
@@ -4185,6 +6060,11 @@ formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
 sch_resource_t
 formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
 {
+	sch_resource_t ans = 0;
+
+	if (formula_native_evaluate(formula, resresv, resreq, &ans))
+		return ans;
+
 	return 0;
 }
 #endif
@@ -4678,12 +6558,15 @@ is_finished_job(int error)
  * @param[in]	pjob	-	job to see if it is similar to the high priority job
  * @param[in]	full_err	-	list of reasons why hjob can not run right now.  It gets
  *                      		created by passing the RETURN_ALL_ERRS to is_ok_to_run()
+ * @param[in]	hnodes	-	hjob's vnodes from resresv_node_bits(), built once
+ *				for all the jobs compared to hjob.  If NULL
+ *				the vnode lists are searched.
  * @return	int
  * @retval	1	: jobs are similar
  * @retval	0	: jobs are not similar
  */
 int
-preemption_similarity(resource_resv *hjob, resource_resv *pjob, schd_error *full_err)
+preemption_similarity(resource_resv *hjob, resource_resv *pjob, schd_error *full_err, pbs_bitmap *hnodes)
 {
 	schd_error *cur_err;
 	int match = 0;
@@ -4701,7 +6584,7 @@ preemption_similarity(resource_resv *hjob, resource_resv *pjob, schd_error *full
 			case SERVER_USER_RES_LIMIT_REACHED:
 			case SERVER_BYUSER_JOB_LIMIT_REACHED:
 			case SERVER_BYUSER_RES_LIMIT_REACHED:
-				if (strcmp(pjob->user, hjob->user) == 0)
+				if (pjob->user == hjob->user)
 					match = 1;
 				break;
 			case QUEUE_USER_LIMIT_REACHED:
@@ -4709,7 +6592,7 @@ preemption_similarity(resource_resv *hjob, resource_resv *pjob, schd_error *full
 			case QUEUE_BYUSER_JOB_LIMIT_REACHED:
 			case QUEUE_BYUSER_RES_LIMIT_REACHED:
 				if (pjob->job->queue == hjob->job->queue &&
-					strcmp(pjob->user, hjob->user) == 0)
+					pjob->user == hjob->user)
 					match = 1;
 
 				break;
@@ -4717,7 +6600,7 @@ preemption_similarity(resource_resv *hjob, resource_resv *pjob, schd_error *full
 			case SERVER_GROUP_RES_LIMIT_REACHED:
 			case SERVER_BYGROUP_JOB_LIMIT_REACHED:
 			case SERVER_BYGROUP_RES_LIMIT_REACHED:
-				if (strcmp(pjob->group, hjob->group) == 0)
+				if (pjob->group == hjob->group)
 					match = 1;
 				break;
 
@@ -4726,14 +6609,14 @@ preemption_similarity(resource_resv *hjob, resource_resv *pjob, schd_error *full
 			case QUEUE_BYGROUP_JOB_LIMIT_REACHED:
 			case QUEUE_BYGROUP_RES_LIMIT_REACHED:
 				if (pjob->job->queue == hjob->job->queue &&
-					strcmp(pjob->group, hjob->group) == 0)
+					pjob->group == hjob->group)
 					match = 1;
 				break;
 			case SERVER_PROJECT_LIMIT_REACHED:
 			case SERVER_PROJECT_RES_LIMIT_REACHED:
 			case SERVER_BYPROJECT_RES_LIMIT_REACHED:
 			case SERVER_BYPROJECT_JOB_LIMIT_REACHED:
-				if (strcmp(pjob->project, hjob->project) == 0)
+				if (pjob->project == hjob->project)
 					match = 1;
 				break;
 			case QUEUE_PROJECT_LIMIT_REACHED:
@@ -4741,7 +6624,7 @@ preemption_similarity(resource_resv *hjob, resource_resv *pjob, schd_error *full
 			case QUEUE_BYPROJECT_RES_LIMIT_REACHED:
 			case QUEUE_BYPROJECT_JOB_LIMIT_REACHED:
 				if (pjob->job->queue == hjob->job->queue &&
-					strcmp(pjob->project, hjob->project) == 0)
+					pjob->project == hjob->project)
 					match = 1;
 				break;
 			case SERVER_JOB_LIMIT_REACHED:
@@ -4775,7 +6658,13 @@ preemption_similarity(resource_resv *hjob, resource_resv *pjob, schd_error *full
 			case RESERVATION_CONFLICT:
 			case SET_TOO_SMALL:
 
-				if (hjob->ninfo_arr != NULL && pjob->ninfo_arr != NULL) {
+				if (hnodes != NULL && pjob->ninfo_arr != NULL) {
+					for (j = 0; pjob->ninfo_arr[j] != NULL && !match; j++) {
+						if (pjob->ninfo_arr[j]->node_ind >= 0 &&
+							pbs_bitmap_get_bit(hnodes, pjob->ninfo_arr[j]->node_ind))
+							match = 1;
+					}
+				} else if (hjob->ninfo_arr != NULL && pjob->ninfo_arr != NULL) {
 					for (j = 0; hjob->ninfo_arr[j] != NULL && !match; j++) {
 						if (find_node_by_rank(pjob->ninfo_arr, hjob->ninfo_arr[j]->rank) != NULL)
 							match = 1;
@@ -4808,6 +6697,41 @@ preemption_similarity(resource_resv *hjob, resource_resv *pjob, schd_error *full
 	return match;
 }
 
+/**
+ * @brief
+ * 		build a bitmap of the vnodes of a resource resv indexed by node_ind
+ *
+ * @param[in]	resresv	-	the resource resv
+ *
+ * @return	pbs_bitmap *
+ * @retval	bitmap of the vnodes, free with pbs_bitmap_free()
+ * @retval	NULL	: no vnodes, a vnode without a node_ind, or on error
+ */
+pbs_bitmap *
+resresv_node_bits(resource_resv *resresv)
+{
+	pbs_bitmap *bits;
+	int i;
+
+	if (resresv == NULL || resresv->ninfo_arr == NULL || resresv->ninfo_arr[0] == NULL)
+		return NULL;
+
+	if ((bits = pbs_bitmap_alloc(NULL, 1)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	for (i = 0; resresv->ninfo_arr[i] != NULL; i++) {
+		if (resresv->ninfo_arr[i]->node_ind < 0 ||
+			!pbs_bitmap_bit_on(bits, resresv->ninfo_arr[i]->node_ind)) {
+			pbs_bitmap_free(bits);
+			return NULL;
+		}
+	}
+
+	return bits;
+}
+
 /**
  * @brief Create the resources_released and resource_released_list for a job 
  *	    and also set execselect on the job based on resources_released
@@ -4990,40 +6914,40 @@ static int cull_preemptible_jobs(resource_resv *job, void *arg)
 	switch (inp->err->error_code) {
 		case SERVER_USER_RES_LIMIT_REACHED:
 		case SERVER_BYUSER_RES_LIMIT_REACHED:
-			if ((strcmp(job->user, inp->job->user) == 0) &&
+			if ((job->user == inp->job->user) &&
 			    find_resource_req(job->resreq, inp->err->rdef) != NULL)
 				return 1;
 			break;
 		case QUEUE_USER_RES_LIMIT_REACHED:
 		case QUEUE_BYUSER_RES_LIMIT_REACHED:
 			if ((job->job->queue == inp->job->job->queue) &&
-			    (strcmp(job->user, inp->job->user) == 0) &&
+			    (job->user == inp->job->user) &&
 			    find_resource_req(job->resreq, inp->err->rdef) != NULL)
 				return 1;
 			break;
 		case SERVER_GROUP_RES_LIMIT_REACHED:
 		case SERVER_BYGROUP_RES_LIMIT_REACHED:
-			if ((strcmp(job->group, inp->job->group) == 0) &&
+			if ((job->group == inp->job->group) &&
 			    find_resource_req(job->resreq, inp->err->rdef) != NULL)
 				return 1;
 			break;
 		case QUEUE_GROUP_RES_LIMIT_REACHED:
 		case QUEUE_BYGROUP_RES_LIMIT_REACHED:
 			if ((job->job->queue == inp->job->job->queue) &&
-			    (strcmp(job->group, inp->job->group) == 0) &&
+			    (job->group == inp->job->group) &&
 			    find_resource_req(job->resreq, inp->err->rdef) != NULL)
 				return 1;
 			break;
 		case SERVER_PROJECT_RES_LIMIT_REACHED:
 		case SERVER_BYPROJECT_RES_LIMIT_REACHED:
-			if ((strcmp(job->user, inp->job->user) == 0) &&
+			if ((job->user == inp->job->user) &&
 			    find_resource_req(job->resreq, inp->err->rdef) != NULL)
 				return 1;
 			break;
 		case QUEUE_PROJECT_RES_LIMIT_REACHED:
 		case QUEUE_BYPROJECT_RES_LIMIT_REACHED:
 			if ((job->job->queue == inp->job->job->queue) &&
-			    (strcmp(job->project, inp->job->project) == 0) &&
+			    (job->project == inp->job->project) &&
 			    find_resource_req(job->resreq, inp->err->rdef) != NULL)
 				return 1;
 			break;
@@ -5033,35 +6957,35 @@ static int cull_preemptible_jobs(resource_resv *job, void *arg)
 			break;
 		case SERVER_USER_LIMIT_REACHED:
 		case SERVER_BYUSER_JOB_LIMIT_REACHED:
-			if (strcmp(job->user, inp->job->user) == 0)
+			if (job->user == inp->job->user)
 				return 1;
 			break;
 		case QUEUE_USER_LIMIT_REACHED:
 		case QUEUE_BYUSER_JOB_LIMIT_REACHED:
 			if ((job->job->queue == inp->job->job->queue) &&
-			    (strcmp(job->user, inp->job->user) == 0))
+			    (job->user == inp->job->user))
 				return 1;
 			break;
 		case SERVER_GROUP_LIMIT_REACHED:
 		case SERVER_BYGROUP_JOB_LIMIT_REACHED:
-			if (strcmp(job->group, inp->job->group) == 0)
+			if (job->group == inp->job->group)
 				return 1;
 			break;
 		case QUEUE_GROUP_LIMIT_REACHED:
 		case QUEUE_BYGROUP_JOB_LIMIT_REACHED:
 			if((job->job->queue == inp->job->job->queue) &&
-			   (strcmp(job->group, inp->job->group) == 0))
+			   (job->group == inp->job->group))
 				return 1;
 			break;
 		case SERVER_PROJECT_LIMIT_REACHED:
 		case SERVER_BYPROJECT_JOB_LIMIT_REACHED:
-			if (strcmp(job->project, inp->job->project) == 0)
+			if (job->project == inp->job->project)
 				return 1;
 			break;
 		case QUEUE_PROJECT_LIMIT_REACHED:
 		case QUEUE_BYPROJECT_JOB_LIMIT_REACHED:
 			if ((job->job->queue == inp->job->job->queue) &&
-			   (strcmp(job->project, inp->job->project) == 0))
+			   (job->project == inp->job->project))
 				return 1;
 			break;
 		case SERVER_JOB_LIMIT_REACHED:
@@ -49,6 +49,18 @@ extern "C" {
  */
 resource_resv *query_job(struct batch_status *job, server_info *sinfo, schd_error *err);
 
+/* free the queued job status kept between cycles by incremental_query */
+void free_job_query_cache(void);
+
+/* write and read the queued job status cache to and from the warm cache file */
+int save_job_query_cache(FILE *fp);
+int load_job_query_cache(FILE *fp);
+
+/* peer queue job status refreshed between cycles with peer_query_refresh */
+int poll_peer_queues(void);
+char *find_peer_job_server(char *jobid);
+void forget_peer_job(char *jobid);
+
 /* create an array of jobs for a particular queue */
 resource_resv **query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs, char *queue_name);
 
@@ -82,6 +94,12 @@ update_job_attr(int pbs_sd, resource_resv *resresv, char *attr_name,
 /* send delayed job attribute updates for job using send_attr_updates() */
 int send_job_updates(int pbs_sd, resource_resv *job);
 
+/* queue a job's attribute updates to be sent by flush_job_updates() */
+int queue_attr_updates(int pbs_sd, char *job_name, struct attrl *pattr);
+
+/* send the job attribute updates queued by send_job_updates() to the server */
+int flush_job_updates(int pbs_sd);
+
 /* send delayed attributes to the server for a job */
 int send_attr_updates(int pbs_sd, char *job_name, struct attrl *pattr);
 
@@ -351,7 +369,12 @@ int is_finished_job(int error);
  * compare two jobs to see if they overlap using a complete err list as
  * criteria similarity criteria.
  */
-int preemption_similarity(resource_resv *hjob, resource_resv *pjob, schd_error *full_err);
+int preemption_similarity(resource_resv *hjob, resource_resv *pjob, schd_error *full_err, pbs_bitmap *hnodes);
+
+/*
+ * build a bitmap of the vnodes of a resource resv indexed by node_ind
+ */
+pbs_bitmap *resresv_node_bits(resource_resv *resresv);
 
 /* Equivalence class functions*/
 resresv_set *new_resresv_set(void);
@@ -374,6 +397,11 @@ resdef **create_resresv_sets_resdef(status *policy, server_info *sinfo);
 
 /* Create an array of resresv_sets based on sinfo*/
 resresv_set **create_resresv_sets(status *policy, server_info *sinfo);
+
+/* can't run reasons of resresv_sets kept between cycles (incremental_equiv_class) */
+int apply_resresv_set_memo(server_info *sinfo);
+void save_resresv_set_memo(server_info *sinfo);
+void free_resresv_set_memo(void);
 /*
  * This function creates a string and update resources_released job 
  *  attribute.
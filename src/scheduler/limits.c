@@ -45,6 +45,7 @@
  * 	lim_alloc_liminfo()
  * 	lim_dup_liminfo()
  * 	lim_free_liminfo()
+ * 	lim_fingerprint()
  * 	is_reslimattr()
  * 	is_runlimattr()
  * 	is_oldlimattr()
@@ -542,6 +543,42 @@ lim_free_liminfo(void *p)
 	}
 	free(lip);
 }
+
+/**
+ * @brief
+ *		hash the hard and soft limits of a limit info structure into a
+ *		fingerprint
+ *
+ * @param[in]	p	-	limit info structure
+ * @param[in]	h	-	fingerprint so far
+ *
+ * @return	the new fingerprint
+ */
+unsigned long long
+lim_fingerprint(void *p, unsigned long long h)
+{
+	struct limit_info	*lip = p;
+	void			*ctx[2];
+	pbs_entlim_key_t	*pkey;
+	int			i;
+
+	if (lip == NULL)
+		return fingerprint_add_str(h, NULL);
+
+	ctx[0] = LI2RESCTX(lip);
+	ctx[1] = LI2RESCTXSOFT(lip);
+	for (i = 0; i < 2; i++) {
+		if (ctx[i] == NULL)
+			continue;
+		pkey = NULL;
+		while ((pkey = entlim_get_next(pkey, ctx[i])) != NULL) {
+			h = fingerprint_add_str(h, pkey->key);
+			h = fingerprint_add_str(h, pkey->recptr);
+		}
+		h = fingerprint_add(h, &i, sizeof(i));
+	}
+	return h;
+}
 /**
  * @brief
  * 		check attribute has max run result as name
@@ -44,6 +44,7 @@
  *
  * Functions included are:
  * 		string_dup()
+ * 		string_intern()
  * 		concat_str()
  * 		add_str_to_unique_array()
  * 		add_str_to_array()
@@ -57,6 +58,11 @@
  * 		match_string_to_array()
  * 		match_string_array()
  * 		string_array_to_str()
+ * 		partition_extend()
+ * 		write_cache_val()
+ * 		read_cache_val()
+ * 		write_cache_str()
+ * 		read_cache_str()
  * 		string_array_verify()
  * 		calc_used_walltime()
  * 		calc_time_left_STF()
@@ -81,6 +87,8 @@
  * 		res_to_str_c()
  * 		res_to_str_r()
  * 		res_to_str_re()
+ * 		pool_alloc()
+ * 		pool_free()
  *
  */
 #include <pbs_config.h>
@@ -98,6 +106,7 @@
 #include <log.h>
 #include <pbs_share.h>
 #include <libutil.h>
+#include <avltree.h>
 #include "config.h"
 #include "constant.h"
 #include "misc.h"
@@ -135,6 +144,55 @@ string_dup(char *str)
 	return newstr;
 }
 
+/* table of interned strings: string -> its shared copy */
+static AVL_IX_DESC *intern_idx = NULL;
+
+/**
+ * @brief
+ *		string_intern - return the scheduler-wide shared copy of a string
+ *
+ * @par	Strings like job owners, groups and projects repeat across a large
+ *	number of objects and every copy of the universe.  Interning them
+ *	stores each distinct value once, and two interned strings are equal
+ *	if and only if their pointers are equal.
+ *
+ * @param[in]	str	-	string to intern
+ *
+ * @return	char *
+ * @retval	shared copy of str.  It must not be modified or freed.
+ * @retval	NULL	: str is NULL or on error
+ *
+ */
+char *
+string_intern(char *str)
+{
+	char *istr;
+
+	if (str == NULL)
+		return NULL;
+
+	if (intern_idx == NULL) {
+		if ((intern_idx = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return NULL;
+		}
+	}
+
+	if ((istr = find_tree(intern_idx, str)) != NULL)
+		return istr;
+
+	if ((istr = string_dup(str)) == NULL)
+		return NULL;
+
+	if (tree_add_del(intern_idx, istr, istr, TREE_OP_ADD) != 0) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(istr);
+		return NULL;
+	}
+
+	return istr;
+}
+
 /**
  * @brief
  *		concat_str - contactenate up to three strings together in newly
@@ -443,7 +501,7 @@ schdlogerr(int event, int class, int sev, char *name, char *text,
 	if (err == NULL)
 		return;
 
-	if (will_log_event(event)) {
+	if (SCHED_WILL_LOG(event)) {
 		translate_fail_code(err, NULL, logbuf);
 		if (text == NULL)
 			log_event(event, class, sev, name, logbuf);
@@ -665,6 +723,141 @@ string_array_to_str(char **strarr)
 	return arrbuf;
 }
 
+/**
+ * @brief
+ * 		build the extend string to pass to pbs_statvnode() and pbs_statque()
+ * 		so the server only returns the objects in the scheduler's partitions
+ *
+ * @param[in]	partitions	-	partitions of the scheduler
+ *
+ * @return	extend string stored in local static ptr (no need to free)
+ * @retval	NULL	: no filtering possible, query everything
+ *
+ * @par MT-safe:	no
+ *
+ */
+char *
+partition_extend(char **partitions)
+{
+	static char *extbuf = NULL;
+	char *parts;
+
+	/* the default scheduler serves what is not in any partition */
+	if (dflt_sched)
+		parts = "";
+	else if (partitions == NULL || partitions[0] == NULL)
+		return NULL;
+	else
+		parts = string_array_to_str(partitions);
+
+	free(extbuf);
+	if ((extbuf = malloc(strlen(parts) + 2)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	sprintf(extbuf, "%c%s", EXTEND_PARTITION, parts);
+
+	return extbuf;
+}
+
+/**
+ * @brief
+ * 		write a fixed size value to the warm cache file
+ *
+ * @param[in]	fp	-	warm cache file
+ * @param[in]	val	-	value to write
+ * @param[in]	size	-	size of the value
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: write error
+ */
+int
+write_cache_val(FILE *fp, const void *val, size_t size)
+{
+	return fwrite(val, size, 1, fp) == 1;
+}
+
+/**
+ * @brief
+ * 		read a fixed size value from the warm cache file
+ *
+ * @param[in]	fp	-	warm cache file
+ * @param[out]	val	-	value read
+ * @param[in]	size	-	size of the value
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: read error or end of file
+ */
+int
+read_cache_val(FILE *fp, void *val, size_t size)
+{
+	return fread(val, size, 1, fp) == 1;
+}
+
+/**
+ * @brief
+ * 		write a string to the warm cache file as its length followed by
+ * 		its characters.  A NULL string is written as a length of -1.
+ *
+ * @param[in]	fp	-	warm cache file
+ * @param[in]	str	-	string to write, may be NULL
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: write error
+ */
+int
+write_cache_str(FILE *fp, const char *str)
+{
+	int len;
+
+	len = (str == NULL) ? -1 : strlen(str);
+	if (!write_cache_val(fp, &len, sizeof(len)))
+		return 0;
+	if (len > 0 && fwrite(str, len, 1, fp) != 1)
+		return 0;
+	return 1;
+}
+
+/**
+ * @brief
+ * 		read a string written by write_cache_str()
+ *
+ * @param[in]	fp	-	warm cache file
+ * @param[out]	str	-	newly allocated string, NULL if NULL was written
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: read error, corrupt length or out of memory
+ */
+int
+read_cache_str(FILE *fp, char **str)
+{
+	int len;
+
+	*str = NULL;
+	if (!read_cache_val(fp, &len, sizeof(len)))
+		return 0;
+	if (len == -1)
+		return 1;
+	if (len < 0 || len > WARM_CACHE_MAX_STR)
+		return 0;
+
+	if ((*str = malloc(len + 1)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return 0;
+	}
+	if (len > 0 && fread(*str, len, 1, fp) != 1) {
+		free(*str);
+		*str = NULL;
+		return 0;
+	}
+	(*str)[len] = '\0';
+	return 1;
+}
+
 /**
  * @brief
  *		string_array_verify - verify two string arrays are equal
@@ -1660,3 +1853,77 @@ res_to_str_re(void *p, enum resource_fields fld, char **buf,
 	return *buf;
 }
 
+
+/**
+ * @brief
+ *		pool_alloc - allocate a zeroed object out of an object pool
+ *
+ * @par	The structures the scheduler creates by the million every cycle
+ *	(resource_req, schd_resource, nspec) come from pools.  Objects are
+ *	carved out of slabs of objs_per_slab objects and recycled through a
+ *	free list by pool_free().  This replaces most malloc()/free() calls
+ *	with a pointer push/pop and keeps these small objects together instead
+ *	of fragmenting the heap of a long running scheduler.  Slabs are never
+ *	given back, so a pool holds the most objects it ever had in use.
+ *
+ * @param[in,out]	pool	-	pool to allocate from
+ *
+ * @return	void *
+ * @retval	the new object
+ * @retval	NULL	: out of memory
+ *
+ * @par MT-Safe:	no
+ */
+void *
+pool_alloc(obj_pool *pool)
+{
+	void *obj;
+	size_t sz;
+	int i;
+
+	/* objects have to hold the free list link and stay aligned in a slab */
+	sz = (pool->obj_size + sizeof(double) - 1) & ~(sizeof(double) - 1);
+
+	if (pool->free_list == NULL) {
+		char *slab;
+
+		if ((slab = malloc(sz * pool->objs_per_slab)) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return NULL;
+		}
+		for (i = pool->objs_per_slab - 1; i >= 0; i--) {
+			*(void **) (slab + i * sz) = pool->free_list;
+			pool->free_list = slab + i * sz;
+		}
+		pool->num_slabs++;
+	}
+
+	obj = pool->free_list;
+	pool->free_list = *(void **) obj;
+	pool->num_used++;
+	memset(obj, 0, pool->obj_size);
+
+	return obj;
+}
+
+/**
+ * @brief
+ *		pool_free - give an object back to the pool it came from
+ *
+ * @param[in,out]	pool	-	pool obj was allocated from
+ * @param[in]	obj	-	object to free
+ *
+ * @return	void
+ *
+ * @par MT-Safe:	no
+ */
+void
+pool_free(obj_pool *pool, void *obj)
+{
+	if (obj == NULL)
+		return;
+
+	*(void **) obj = pool->free_list;
+	pool->free_list = obj;
+	pool->num_used--;
+}
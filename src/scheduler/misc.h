@@ -41,16 +41,43 @@
 extern "C" {
 #endif
 
+#include <log.h>
 #include "data_types.h"
 #include "server_info.h"
 #include "queue_info.h"
 #include "job_info.h"
 
+/*
+ * Test the event mask before the arguments of a log message are evaluated,
+ * so a suppressed message costs no formatting.  Messages which need work
+ * done ahead of the call, e.g. translate_fail_code(), are guarded with
+ * SCHED_WILL_LOG() by their callers.
+ */
+#define SCHED_WILL_LOG(event) \
+	((((event) & PBSEVENT_FORCE) != 0) || ((*log_event_mask & (event)) != 0))
+
+#define log_event(event, class, sev, name, text) \
+	do { \
+		if (SCHED_WILL_LOG(event)) \
+			(log_event)(event, class, sev, name, text); \
+	} while (0)
+
+#define log_eventf(event, class, sev, name, ...) \
+	do { \
+		if (SCHED_WILL_LOG(event)) \
+			(log_eventf)(event, class, sev, name, __VA_ARGS__); \
+	} while (0)
+
 /*
  *	string_dup - duplicate a string
  */
 char *string_dup(char *str);
 
+/*
+ *	string_intern - return the shared copy of a string
+ */
+char *string_intern(char *str);
+
 /*
  *	concat_str - contactenate up to three strings together in newly
  *		     allocated memory
@@ -149,6 +176,19 @@ enum match_string_array_ret match_string_to_array(char *str, char **strarr);
  */
 char *string_array_to_str(char **strarr);
 
+/*
+ * build the extend string asking the server for the scheduler's partitions
+ */
+char *partition_extend(char **partitions);
+
+/*
+ * read and write values and strings of the warm cache file
+ */
+int write_cache_val(FILE *fp, const void *val, size_t size);
+int read_cache_val(FILE *fp, void *val, size_t size);
+int write_cache_str(FILE *fp, const char *str);
+int read_cache_str(FILE *fp, char **str);
+
 /*
  *      calc_time_left - calculate the remaining time of a job
  */
@@ -280,6 +320,16 @@ add_str_to_array(char ***str_arr, char *str);
 int
 add_str_to_unique_array(char ***str_arr, char *str);
 
+/*
+ *	pool_alloc - allocate a zeroed object out of an object pool
+ */
+void *pool_alloc(obj_pool *pool);
+
+/*
+ *	pool_free - give an object back to the pool it came from
+ */
+void pool_free(obj_pool *pool, void *obj);
+
 #ifdef	__cplusplus
 }
 #endif
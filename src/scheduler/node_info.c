@@ -49,12 +49,17 @@
  * 	free_nodes()
  * 	free_node_info()
  * 	set_node_type()
+ * 	node_state_to_mask()
+ * 	set_node_state_from_mask()
  * 	set_node_info_state()
  * 	remove_node_state()
  * 	add_node_state()
  * 	talk_with_mom()
  * 	node_filter()
  * 	find_node_info()
+ * 	create_node_name_index()
+ * 	share_node_name_index()
+ * 	free_node_name_index()
  * 	find_node_by_host()
  * 	dup_nodes()
  * 	dup_node_info()
@@ -71,9 +76,11 @@
  * 	dup_nspec()
  * 	empty_nspec_array()
  * 	free_nspecs()
+ * 	resort_changed_nodes()
  * 	find_nspec()
  * 	find_nspec_by_rank()
  * 	eval_selspec()
+ * 	log_hostset_fail()
  * 	eval_placement()
  * 	eval_complex_selspec()
  * 	eval_simple_selspec()
@@ -81,7 +88,14 @@
  * 	is_vnode_eligible_chunk()
  * 	resources_avail_on_vnode()
  * 	check_resources_for_node()
+ * 	free_spec_cache_entry()
+ * 	free_spec_cache()
+ * 	age_spec_cache()
+ * 	spec_cache_find()
+ * 	spec_cache_add()
+ * 	parse_placespec_str()
  * 	parse_placespec()
+ * 	parse_selspec_str()
  * 	parse_selspec()
  * 	create_execvnode()
  * 	parse_execvnode()
@@ -109,6 +123,10 @@
  * 	sim_exclhost_func()
  * 	set_current_aoe()
  * 	is_exclhost()
+ * 	node_eval_worker()
+ * 	node_eval_slice()
+ * 	node_eval_pool_start()
+ * 	node_eval_parallel()
  * 	check_node_array_eligibility()
  * 	is_powerok()
  * 	is_eoe_avail_on_vnode()
@@ -127,7 +145,11 @@
 #include <math.h>
 #include <errno.h>
 #include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <pbs_ifl.h>
+#include <pbs_error.h>
 #include <log.h>
 #include <rm.h>
 #include <grunt.h>
@@ -152,6 +174,7 @@
 #include "pbs_share.h"
 #include "pbs_bitmap.h"
 #include "pbs_license.h"
+#include "avltree.h"
 #ifdef NAS
 #include "site_code.h"
 #endif
@@ -160,6 +183,60 @@
 /* name of the last node a job ran on - used in smp_dist = round robin */
 static char last_node_name[PBS_MAXSVRJOBID];
 
+/* nspecs are created by the million, see pool_alloc() */
+static obj_pool nspec_pool = {sizeof(nspec), 1024, NULL, 0, 0};
+
+/*
+ * Worker pool used by check_node_array_eligibility() to run
+ * is_vnode_eligible() over large node arrays in parallel.  The workers only
+ * read the universe and write into their own slice of results[]/errs[].
+ * Everything with side effects (marking nodes, logging) is done by the
+ * main thread afterwards in node array order, so results do not depend on
+ * the number of threads.
+ */
+struct node_eval_pool {
+	pthread_mutex_t lock;
+	pthread_cond_t work_cv;		/* signaled when new work is posted */
+	pthread_cond_t done_cv;		/* signaled when the last worker finishes */
+	pthread_t *tids;
+	int nthreads;			/* number of workers (main thread makes +1) */
+	pid_t pid;			/* process the workers were started in */
+	unsigned long gen;		/* bumped each time work is posted */
+	unsigned long start_gen;	/* gen when the workers were started */
+	int pending;			/* workers still working on this gen */
+	int stop;			/* tell the workers to exit */
+	/* the current unit of work */
+	node_info **ninfo_arr;
+	int num_nodes;
+	resource_resv *resresv;
+	place *pl;
+	signed char *results;		/* 1 eligible, 0 not, -1 not evaluated */
+	schd_error **errs;		/* why results[i] == 0 */
+};
+static struct node_eval_pool nepool = {
+	PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER
+};
+
+/*
+ * Parsed select and place specs by string.  Most jobs share a handful of
+ * specs, so parse_selspec() and parse_placespec() hand out a reference to
+ * the one we already parsed instead of parsing it again.  The cache holds
+ * a reference of its own.  Specs not used for a whole cycle are dropped
+ * by age_spec_cache().
+ */
+struct spec_cache_entry {
+	char *key;			/* 's' or 'p' followed by the spec */
+	void *spec;			/* selspec or place */
+	int last_cycle;			/* last cycle the spec was handed out */
+};
+static struct {
+	AVL_IX_DESC *idx;		/* key -> spec_cache_entry */
+	struct spec_cache_entry **entries;
+	int num_entries;
+	int entries_size;
+	int cycle;
+} spec_cache;
+
 /**
  * @brief
  *      query_nodes - query all the nodes associated with a server
@@ -224,8 +301,14 @@ query_nodes(int pbs_sd, server_info *sinfo)
 		}
 	}
 
-	/* get nodes from PBS server */
-	if ((nodes = pbs_statvnode(pbs_sd, NULL, attrib, NULL)) == NULL) {
+	/* get nodes from PBS server, it leaves out those of other partitions */
+	nodes = pbs_statvnode(pbs_sd, NULL, attrib, partition_extend(sinfo->partitions));
+	if (nodes == NULL && pbs_errno == PBSE_NONE) {
+		log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_SERVER, LOG_INFO, __func__,
+			"No nodes found in partitions serviced by scheduler");
+		return NULL;
+	}
+	if (nodes == NULL) {
 		err = pbs_geterrmsg(pbs_sd);
 		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_NODE, LOG_INFO, "", "Error getting nodes: %s", err);
 		return NULL;
@@ -302,6 +385,15 @@ query_nodes(int pbs_sd, server_info *sinfo)
 	site_vnode_inherit(ninfo_arr);
 #endif /* localmod 062 */
 	resolve_indirect_resources(ninfo_arr);
+	for (i = 0; i < nidx && !sinfo->has_indirect_res; i++) {
+		schd_resource *res;
+
+		for (res = ninfo_arr[i]->res; res != NULL; res = res->next)
+			if (res->indirect_vnode_name != NULL) {
+				sinfo->has_indirect_res = 1;
+				break;
+			}
+	}
 	sinfo->num_nodes = nidx;
 	pbs_statfree(nodes);
 	return ninfo_arr;
@@ -732,24 +824,120 @@ set_node_type(node_info *ninfo, char *ntype)
 	return 1;
 }
 
+/**
+ * @brief
+ * 		get the state bits set_node_info_state() sets as a mask
+ *
+ * @param[in]	ninfo	-	the node
+ *
+ * @return	unsigned int - mask of NSTATE_* bits
+ */
+static unsigned int
+node_state_to_mask(node_info *ninfo)
+{
+	unsigned int mask = 0;
+
+	if (ninfo->is_down)
+		mask |= NSTATE_DOWN;
+	if (ninfo->is_free)
+		mask |= NSTATE_FREE;
+	if (ninfo->is_unknown)
+		mask |= NSTATE_UNKNOWN;
+	if (ninfo->is_sharing)
+		mask |= NSTATE_SHARING;
+	if (ninfo->is_busy)
+		mask |= NSTATE_BUSY;
+	if (ninfo->is_job_busy)
+		mask |= NSTATE_JOB_BUSY;
+	if (ninfo->is_stale)
+		mask |= NSTATE_STALE;
+	if (ninfo->is_provisioning)
+		mask |= NSTATE_PROV;
+	if (ninfo->is_exclusive)
+		mask |= NSTATE_EXCL;
+	if (ninfo->is_resv_exclusive)
+		mask |= NSTATE_RESV_EXCL;
+	if (ninfo->is_job_exclusive)
+		mask |= NSTATE_JOB_EXCL;
+	if (ninfo->is_sleeping)
+		mask |= NSTATE_SLEEP;
+	if (ninfo->is_offline)
+		mask |= NSTATE_OFFLINE;
+
+	return mask;
+}
+
+/**
+ * @brief
+ * 		set a node's state bits from a mask made by node_state_to_mask()
+ *
+ * @param[in,out]	ninfo	-	the node
+ * @param[in]	mask	-	mask of NSTATE_* bits
+ *
+ * @return	void
+ */
+static void
+set_node_state_from_mask(node_info *ninfo, unsigned int mask)
+{
+	ninfo->is_down = (mask & NSTATE_DOWN) ? 1 : 0;
+	ninfo->is_free = (mask & NSTATE_FREE) ? 1 : 0;
+	ninfo->is_unknown = (mask & NSTATE_UNKNOWN) ? 1 : 0;
+	ninfo->is_sharing = (mask & NSTATE_SHARING) ? 1 : 0;
+	ninfo->is_busy = (mask & NSTATE_BUSY) ? 1 : 0;
+	ninfo->is_job_busy = (mask & NSTATE_JOB_BUSY) ? 1 : 0;
+	ninfo->is_stale = (mask & NSTATE_STALE) ? 1 : 0;
+	ninfo->is_provisioning = (mask & NSTATE_PROV) ? 1 : 0;
+	ninfo->is_exclusive = (mask & NSTATE_EXCL) ? 1 : 0;
+	ninfo->is_resv_exclusive = (mask & NSTATE_RESV_EXCL) ? 1 : 0;
+	ninfo->is_job_exclusive = (mask & NSTATE_JOB_EXCL) ? 1 : 0;
+	ninfo->is_sleeping = (mask & NSTATE_SLEEP) ? 1 : 0;
+	/* set_node_info_state() doesn't clear offline */
+	if (mask & NSTATE_OFFLINE)
+		ninfo->is_offline = 1;
+}
+
 /**
  * @brief
  * 		set the node state info bits from a single or comma separated list of
  * 		states.
  *
+ * @par	Almost all nodes are in one of a handful of states, so the masks
+ *	of the last few state strings we parsed are remembered.  A node in
+ *	one of those states gets its bits without parsing the string again.
+ *
  * @param[in]	ninfo	-	the node to set the state
  * @param[in]	state	-	the state string from the server
  *
  * @retval	0	: on success
  * @retval	1	: on failure
+ *
+ * @par MT-safe: No
  */
 int
 set_node_info_state(node_info *ninfo, char *state)
 {
+	static struct {
+		char state[64];
+		int power_provisioning;	/* sleep is ignored if not set */
+		unsigned int mask;
+	} seen[NODE_STATE_CACHE_SIZE];
+	static int num_seen = 0;
+	static int next_seen = 0;
 	char statebuf[256];			/* used to strtok() node states */
 	char *tok;				/* used with strtok() */
+	int power;
+	int unknown = 0;
+	int i;
 
 	if (ninfo != NULL && state != NULL) {
+		power = (ninfo->server != NULL && ninfo->server->power_provisioning);
+		for (i = 0; i < num_seen; i++) {
+			if (seen[i].power_provisioning == power && !strcmp(seen[i].state, state)) {
+				set_node_state_from_mask(ninfo, seen[i].mask);
+				return 0;
+			}
+		}
+
 		/* clear all states */
 		ninfo->is_down = ninfo->is_free = ninfo->is_unknown = 0;
 		ninfo->is_sharing = ninfo->is_busy = ninfo->is_job_busy = 0;
@@ -764,12 +952,29 @@ set_node_info_state(node_info *ninfo, char *state)
 			while (isspace((int) *tok))
 				tok++;
 
-			if (add_node_state(ninfo, tok) == 1)
+			if (add_node_state(ninfo, tok) == 1) {
 				log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_NODE, LOG_INFO,
 					ninfo->name, "Unknown Node State: %s", tok);
+				unknown = 1;
+			}
 
 			tok = strtok(NULL, ",");
 		}
+
+		/* Don't remember states we log about, so we log for every node.
+		 * The starting offline bit is left alone, so only remember states
+		 * which were parsed from a node which wasn't offline already.
+		 */
+		if (!unknown && strlen(state) < sizeof(seen[0].state) &&
+			(ninfo->is_offline == 0 || strstr(state, ND_offline) != NULL)) {
+			i = next_seen;
+			next_seen = (next_seen + 1) % NODE_STATE_CACHE_SIZE;
+			if (num_seen < NODE_STATE_CACHE_SIZE)
+				num_seen++;
+			strcpy(seen[i].state, state);
+			seen[i].power_provisioning = power;
+			seen[i].mask = node_state_to_mask(ninfo);
+		}
 		return 0;
 	}
 
@@ -950,7 +1155,7 @@ talk_with_mom(node_info *ninfo)
 	for (i = 0; i < num_resget; i++)
 		addreq(mom_sd, (char *) res_to_get[i]);
 
-	if (conf.dyn_res_to_get) {
+	if (conf.dyn_res_to_get && !conf.mom_res_from_status) {
 		for (i = 0; conf.dyn_res_to_get[i]; i++)
 			addreq(mom_sd, (char *) conf.dyn_res_to_get[i]);
 	}
@@ -999,7 +1204,7 @@ talk_with_mom(node_info *ninfo)
 		free(mom_ans);
 	mom_ans = NULL;
 
-	if (ret == 0 && conf.dyn_res_to_get) {
+	if (ret == 0 && conf.dyn_res_to_get && !conf.mom_res_from_status) {
 		for (i = 0; conf.dyn_res_to_get[i] && (mom_ans = getreq(mom_sd));  i++) {
 			res = find_alloc_resource_by_str(ninfo->res, conf.dyn_res_to_get[i]);
 			if (res != NULL) {
@@ -1089,6 +1294,9 @@ node_filter(node_info **nodes, int size,
  * @brief
  *		find_node_info - find a node in a node array
  *
+ * @par	If ninfo_arr is its server's node array (sinfo->nodes), the node is
+ *	looked up in the server's node name index.  Other arrays are searched.
+ *
  * @param[in]	nodename	-	the node to find
  * @param[in]	ninfo_arr	-	the array of nodes to look in
  *
@@ -1100,10 +1308,26 @@ node_info *
 find_node_info(node_info **ninfo_arr, char *nodename)
 {
 	int i;
+	server_info *sinfo;
 
 	if (nodename == NULL || ninfo_arr == NULL)
 		return NULL;
 
+	/* The server's own node array can be searched through its index */
+	if (ninfo_arr[0] != NULL && (sinfo = ninfo_arr[0]->server) != NULL &&
+		sinfo->nodes == ninfo_arr && sinfo->node_idx != NULL) {
+		int *ind;
+		node_info **nodes;
+
+		ind = find_tree(sinfo->node_idx->idx, nodename);
+		if (ind == NULL)
+			return NULL;
+		nodes = sinfo->unordered_nodes != NULL ? sinfo->unordered_nodes : sinfo->nodes;
+		if (*ind < sinfo->num_nodes && nodes[*ind] != NULL &&
+			!strcmp(nodes[*ind]->name, nodename))
+			return nodes[*ind];
+	}
+
 	for (i = 0; ninfo_arr[i] != NULL &&
 		strcmp(nodename, ninfo_arr[i]->name) ; i++)
 		;
@@ -1111,6 +1335,100 @@ find_node_info(node_info **ninfo_arr, char *nodename)
 	return ninfo_arr[i];
 }
 
+/**
+ * @brief
+ *		create_node_name_index - index a server's nodes by name
+ *
+ * @par	The index maps a node name to its position in nodes, which becomes
+ *	the node's node_ind.  Node names and node_inds are the same in every
+ *	copy of the universe, so copies share the index
+ *	(see share_node_name_index()).
+ *
+ * @param[in]	nodes	-	the server's nodes in node_ind order
+ *
+ * @return	node_name_index *
+ * @retval	NULL	: on error
+ */
+node_name_index *
+create_node_name_index(node_info **nodes)
+{
+	node_name_index *nidx;
+	int num_nodes;
+	int i;
+
+	if (nodes == NULL)
+		return NULL;
+
+	if ((nidx = malloc(sizeof(node_name_index))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	num_nodes = count_array((void **) nodes);
+	if ((nidx->inds = malloc((num_nodes + 1) * sizeof(int))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(nidx);
+		return NULL;
+	}
+	if ((nidx->idx = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(nidx->inds);
+		free(nidx);
+		return NULL;
+	}
+	nidx->refct = 1;
+
+	for (i = 0; i < num_nodes; i++) {
+		nidx->inds[i] = i;
+		if (tree_add_del(nidx->idx, nodes[i]->name, &nidx->inds[i], TREE_OP_ADD) != 0) {
+			free_node_name_index(nidx);
+			return NULL;
+		}
+	}
+
+	return nidx;
+}
+
+/**
+ * @brief
+ *		share_node_name_index - take another reference to a node name index
+ *
+ * @param[in]	nidx	-	index to share
+ *
+ * @return	nidx
+ */
+node_name_index *
+share_node_name_index(node_name_index *nidx)
+{
+	if (nidx != NULL)
+		nidx->refct++;
+
+	return nidx;
+}
+
+/**
+ * @brief
+ *		free_node_name_index - drop a reference to a node name index
+ *		The index is freed when its last reference is dropped
+ *
+ * @param[in]	nidx	-	index to free
+ *
+ * @return	void
+ */
+void
+free_node_name_index(node_name_index *nidx)
+{
+	if (nidx == NULL)
+		return;
+
+	if (--nidx->refct > 0)
+		return;
+
+	avl_destroy_index(nidx->idx);
+	free(nidx->idx);
+	free(nidx->inds);
+	free(nidx);
+}
+
 /**
  * @brief
  *		find_node_by_host - find a node by its host resource rather then
@@ -1926,7 +2244,8 @@ should_talk_with_mom(node_info *ninfo)
 	if (ninfo->is_sleeping)
 		return 0;
 
-	if (conf.dyn_res_to_get != NULL)
+	/* with mom_resources_from_status, MoM sends them to the server */
+	if (conf.dyn_res_to_get != NULL && !conf.mom_res_from_status)
 		talk = 1;
 
 	if (cstat.smp_dist == SMP_LOWEST_LOAD)
@@ -1967,10 +2286,8 @@ new_nspec()
 {
 	nspec *ns;
 
-	if ((ns = (nspec *) malloc(sizeof(nspec))) == NULL) {
-		log_err(errno, "new_nspec", MEM_ERR_MSG);
+	if ((ns = pool_alloc(&nspec_pool)) == NULL)
 		return NULL;
-	}
 
 	ns->end_of_chunk = 0;
 	ns->seq_num = 0;
@@ -2000,7 +2317,7 @@ free_nspec(nspec *ns)
 	if (ns->resreq != NULL)
 		free_resource_req_list(ns->resreq);
 
-	free(ns);
+	pool_free(&nspec_pool, ns);
 }
 
 /**
@@ -2136,6 +2453,116 @@ free_nspecs(nspec **ns)
 	free(ns);
 }
 
+/**
+ * @brief
+ * 		resort_changed_nodes - re-sort a sorted node array after the
+ *		sort keys of some of its nodes changed
+ *
+ * @par	Running a job only changes the unused resources of the job's own
+ *	nodes.  Instead of sorting the whole array again, take the changed
+ *	nodes out, then put each back in at the place a binary search finds
+ *	for it.  This costs one pass over the array and O(log n) compares
+ *	per changed node instead of O(n log n) compares.
+ *
+ * @par	Only the nodes in changed may have moved.  Sorting on a resource
+ *	can change other nodes too if it is indirect.  Callers have to sort
+ *	the whole array then.
+ *
+ * @param[in,out]	nodes	-	sorted node array to re-sort
+ * @param[in]	num_nodes	-	number of nodes in nodes
+ * @param[in]	changed	-	NULL terminated array of changed nodes (may
+ *				contain nodes which aren't in nodes)
+ * @param[in]	cmp	-	the compare function nodes is sorted by
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+void
+resort_changed_nodes(node_info **nodes, int num_nodes, node_info **changed,
+	int (*cmp)(const void *, const void *))
+{
+	static node_info **moved = NULL;
+	static int *pos = NULL;
+	static int moved_size = 0;
+	int num_changed;
+	int num_moved = 0;
+	int lo, hi, mid;
+	int i, j;
+
+	if (nodes == NULL || changed == NULL || num_nodes <= 1)
+		return;
+
+	num_changed = count_array((void **) changed);
+	if (num_changed == 0)
+		return;
+
+	/* Lots of changed nodes are cheaper to sort with everything else */
+	if (num_changed > num_nodes / 4) {
+		qsort(nodes, num_nodes, sizeof(node_info *), cmp);
+		return;
+	}
+
+	if (num_changed > moved_size) {
+		node_info **tmp_moved;
+		int *tmp_pos;
+
+		tmp_moved = realloc(moved, num_changed * sizeof(node_info *));
+		if (tmp_moved != NULL)
+			moved = tmp_moved;
+		tmp_pos = realloc(pos, num_changed * sizeof(int));
+		if (tmp_pos != NULL)
+			pos = tmp_pos;
+		if (tmp_moved == NULL || tmp_pos == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			qsort(nodes, num_nodes, sizeof(node_info *), cmp);
+			return;
+		}
+		moved_size = num_changed;
+	}
+
+	for (i = 0; i < num_changed; i++)
+		changed[i]->nscr.to_resort = 1;
+
+	/* Take the changed nodes out.  The rest of the array stays sorted. */
+	for (i = 0, j = 0; i < num_nodes; i++) {
+		if (nodes[i]->nscr.to_resort && num_moved < num_changed) {
+			nodes[i]->nscr.to_resort = 0;
+			moved[num_moved++] = nodes[i];
+		} else
+			nodes[j++] = nodes[i];
+	}
+	for (i = 0; i < num_changed; i++)
+		changed[i]->nscr.to_resort = 0;
+
+	if (num_moved == 0)
+		return;
+
+	if (num_moved > 1)
+		qsort(moved, num_moved, sizeof(node_info *), cmp);
+
+	/* Find where each one goes among the nodes which didn't move */
+	for (i = 0; i < num_moved; i++) {
+		lo = 0;
+		hi = j;
+		while (lo < hi) {
+			mid = lo + (hi - lo) / 2;
+			if (cmp(&nodes[mid], &moved[i]) <= 0)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		pos[i] = lo;
+	}
+
+	/* Merge them back in from the end so nothing is overwritten */
+	for (i = num_moved - 1, hi = num_nodes - 1, j--; i >= 0; i--) {
+		while (j >= pos[i])
+			nodes[hi--] = nodes[j--];
+		nodes[hi--] = moved[i];
+	}
+}
+
 /**
  * @brief
  *		find_nspec - find an nspec in an array
@@ -2335,9 +2762,11 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 			}
 		}
 		else {
-			translate_fail_code(err, NULL, reason);
-			log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG, resresv->name, 
-				"Placement set %s is too small: %s", nodepart[i]->name, reason);
+			if (SCHED_WILL_LOG(PBSEVENT_DEBUG3)) {
+				translate_fail_code(err, NULL, reason);
+				log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG, resresv->name,
+					"Placement set %s is too small: %s", nodepart[i]->name, reason);
+			}
 			set_schd_error_codes(err, NOT_RUN, SET_TOO_SMALL);
 			set_schd_error_arg(err, ARG1, "Placement");
 #ifdef NAS /* localmod 031 */
@@ -2389,6 +2818,34 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 	return rc;
 }
 
+/**
+ * @brief
+ * 		log why a host could not satisfy a job.  Nothing is formatted unless
+ * 		the message will be logged.
+ *
+ * @param[in] resresv	-	the resource resv being placed
+ * @param[in] hostset	-	the host which failed
+ * @param[in] err	-	the reason the host failed
+ *
+ * @return nothing
+ */
+static void
+log_hostset_fail(resource_resv *resresv, node_partition *hostset, schd_error *err)
+{
+	char reason[MAX_LOG_SIZE];
+
+	if (!SCHED_WILL_LOG(PBSEVENT_DEBUG3))
+		return;
+
+	if (hostset->free_nodes == 0)
+		strcpy(reason, "No free nodes available");
+	else
+		translate_fail_code(err, NULL, reason);
+
+	log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+		resresv->name, "Insufficient host-level resources %s", reason);
+}
+
 /**
  * @brief
  * 		handle the place spec for vnode placement of chunks
@@ -2424,7 +2881,6 @@ eval_placement(status *policy, selspec *spec, node_info **ninfo_arr, place *pl,
 	int			cur_flt_lic;
 	nspec			**nsa = NULL;
 	nspec			**ns_head = NULL;
-	char			reason[MAX_LOG_SIZE] = {0};
 	resource_req		*req = NULL;
 	schd_resource		*res = NULL;
 	selspec			*dselspec = NULL;
@@ -2597,15 +3053,7 @@ eval_placement(status *policy, selspec *spec, node_info **ninfo_arr, place *pl,
 						}
 					}
 					else {
-						if (hostsets[i]->free_nodes == 0) {
-							strncpy(reason, "No free nodes available", MAX_LOG_SIZE - 1);
-							reason[MAX_LOG_SIZE - 1] = '\0';
-						}
-						else
-							translate_fail_code(err, NULL, reason);
-
-						log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG, 
-							resresv->name, "Insufficient host-level resources %s", reason);
+						log_hostset_fail(resresv, hostsets[i], err);
 						if (failerr->status_code == SCHD_UNKWN)
 							move_schd_error(failerr, err);
 						clear_schd_error(err);
@@ -2664,15 +3112,7 @@ eval_placement(status *policy, selspec *spec, node_info **ninfo_arr, place *pl,
 						}
 					}
 					else {
-						if (hostsets[i]->free_nodes == 0) {
-							strncpy(reason, "No free nodes available", MAX_LOG_SIZE - 1);
-							reason[MAX_LOG_SIZE - 1] = '\0';
-						}
-						else
-							translate_fail_code(err, NULL, reason);
-
-						log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG, 
-							resresv->name, "Insufficient host-level resources %s", reason);
+						log_hostset_fail(resresv, hostsets[i], err);
 
 						if (failerr->status_code == SCHD_UNKWN)
 							move_schd_error(failerr, err);
@@ -2775,15 +3215,7 @@ eval_placement(status *policy, selspec *spec, node_info **ninfo_arr, place *pl,
 						}
 					}
 					else {
-						if (hostsets[i]->free_nodes ==0) {
-							strncpy(reason, "No free nodes available", MAX_LOG_SIZE - 1);
-							reason[MAX_LOG_SIZE - 1] = '\0';
-						}
-						else
-							translate_fail_code(err, NULL, reason);
-
-						log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG,
-							resresv->name, "Insufficient host-level resources %s", reason);
+						log_hostset_fail(resresv, hostsets[i], err);
 #ifdef NAS /* localmod 998 */
 						set_schd_error_codes(err, NOT_RUN, RESOURCES_INSUFFICIENT);
 #else
@@ -2871,6 +3303,7 @@ eval_complex_selspec(status *policy, selspec *spec, node_info **ninfo_arr, place
 	int c;
 	resource_req *req;
 	schd_resource *res;
+	node_info *changed[2] = {NULL, NULL};	/* dup'd node whose resources we just used */
 
 	if (spec == NULL || ninfo_arr == NULL)
 		return 0;
@@ -2949,6 +3382,7 @@ eval_complex_selspec(status *policy, selspec *spec, node_info **ninfo_arr, place
 
 						req = req->next;
 					}
+					changed[0] = (*nsa)->ninfo;
 					/* replace the dup'd node with the real one */
 #ifdef NAS /* localmod 049 */
 					if ((*nsa)->ninfo->rank == resresv->server->nodes_by_NASrank[(*nsa)->ninfo->NASrank]->rank)
@@ -2963,8 +3397,14 @@ eval_complex_selspec(status *policy, selspec *spec, node_info **ninfo_arr, place
 				 * of nodes.
 				 */
 				if (conf.provision_policy != AVOID_PROVISION &&
-					cstat.node_sort[0].res_name != NULL && conf.node_sort_unused)
-					qsort(nodes, tot_nodes, sizeof(node_info *), multi_node_sort);
+					cstat.node_sort[0].res_name != NULL && conf.node_sort_unused &&
+					changed[0] != NULL) {
+					if (resresv->server->has_indirect_res)
+						qsort(nodes, tot_nodes, sizeof(node_info *), multi_node_sort);
+					else
+						resort_changed_nodes(nodes, tot_nodes, changed, multi_node_sort);
+					changed[0] = NULL;
+				}
 			}
 			chunks_needed--;
 		}
@@ -4011,7 +4451,175 @@ compare_place(place *pl1, place *pl2)
 
 /**
  * @brief
- *		parse_placespec - allocate a new place structure and parse
+ *		free a spec_cache_entry and drop the cache's reference to its spec
+ *
+ * @param[in]	ent	-	entry to free
+ *
+ * @return	void
+ */
+static void
+free_spec_cache_entry(struct spec_cache_entry *ent)
+{
+	if (ent == NULL)
+		return;
+
+	if (ent->key[0] == 's')
+		free_selspec(ent->spec);
+	else
+		free_place(ent->spec);
+	free(ent->key);
+	free(ent);
+}
+
+/**
+ * @brief
+ *		free the select and place spec cache
+ *
+ * @par	Parsed specs reference the resource definitions and depend on the
+ *	resources the scheduler is configured to check.  This needs to be
+ *	called whenever either of those change.  Specs which are still in use
+ *	stay valid until their last owner frees them.
+ *
+ * @return	void
+ */
+void
+free_spec_cache(void)
+{
+	int i;
+
+	for (i = 0; i < spec_cache.num_entries; i++)
+		free_spec_cache_entry(spec_cache.entries[i]);
+	free(spec_cache.entries);
+	if (spec_cache.idx != NULL) {
+		avl_destroy_index(spec_cache.idx);
+		free(spec_cache.idx);
+	}
+	spec_cache.idx = NULL;
+	spec_cache.entries = NULL;
+	spec_cache.num_entries = 0;
+	spec_cache.entries_size = 0;
+}
+
+/**
+ * @brief
+ *		drop the specs from the select and place spec cache which
+ *		were not used in the cycle which just ended
+ *
+ * @return	void
+ */
+void
+age_spec_cache(void)
+{
+	int i;
+	int j;
+
+	for (i = 0, j = 0; i < spec_cache.num_entries; i++) {
+		struct spec_cache_entry *ent = spec_cache.entries[i];
+
+		if (ent->last_cycle != spec_cache.cycle) {
+			tree_add_del(spec_cache.idx, ent->key, NULL, TREE_OP_DEL);
+			free_spec_cache_entry(ent);
+		} else
+			spec_cache.entries[j++] = ent;
+	}
+	spec_cache.num_entries = j;
+	spec_cache.cycle++;
+}
+
+/**
+ * @brief
+ *		find a spec in the select and place spec cache
+ *
+ * @param[in]	type	-	's' for a select spec, 'p' for a place spec
+ * @param[in]	str	-	the spec as a string
+ * @param[out]	key	-	the cache key for str (to pass to spec_cache_add())
+ *
+ * @return	void *
+ * @retval	the cached spec (without a new reference)
+ * @retval	NULL	: not found or error (*key is NULL on error)
+ */
+static void *
+spec_cache_find(char type, char *str, char **key)
+{
+	struct spec_cache_entry *ent;
+	size_t len;
+
+	len = strlen(str);
+	if ((*key = malloc(len + 2)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	(*key)[0] = type;
+	memcpy(*key + 1, str, len + 1);
+
+	if (spec_cache.idx == NULL)
+		return NULL;
+
+	if ((ent = find_tree(spec_cache.idx, *key)) == NULL)
+		return NULL;
+
+	ent->last_cycle = spec_cache.cycle;
+	return ent->spec;
+}
+
+/**
+ * @brief
+ *		add a newly parsed spec to the select and place spec cache
+ *
+ * @par	On success, the cache takes its own reference to the spec and
+ *	ownership of key.  On failure, the spec is just not cached.
+ *
+ * @param[in]	key	-	key from spec_cache_find()
+ * @param[in]	spec	-	the parsed spec
+ *
+ * @return	void
+ */
+static void
+spec_cache_add(char *key, void *spec)
+{
+	struct spec_cache_entry *ent;
+
+	if (spec_cache.idx == NULL) {
+		if ((spec_cache.idx = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL) {
+			free(key);
+			return;
+		}
+	}
+	if (spec_cache.num_entries == spec_cache.entries_size) {
+		struct spec_cache_entry **tmp;
+		int sz = spec_cache.entries_size == 0 ? 64 : spec_cache.entries_size * 2;
+
+		if ((tmp = realloc(spec_cache.entries, sz * sizeof(struct spec_cache_entry *))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			free(key);
+			return;
+		}
+		spec_cache.entries = tmp;
+		spec_cache.entries_size = sz;
+	}
+	if ((ent = malloc(sizeof(struct spec_cache_entry))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(key);
+		return;
+	}
+	ent->key = key;
+	ent->spec = spec;
+	ent->last_cycle = spec_cache.cycle;
+	if (tree_add_del(spec_cache.idx, key, ent, TREE_OP_ADD) != 0) {
+		free(key);
+		free(ent);
+		return;
+	}
+	if (key[0] == 's')
+		share_selspec(spec);
+	else
+		share_place(spec);
+	spec_cache.entries[spec_cache.num_entries++] = ent;
+}
+
+/**
+ * @brief
+ *		parse_placespec_str - allocate a new place structure and parse
  *		a placement spec (-l place)
  *
  * @param[in]	place_str	-	placespec as a string
@@ -4020,8 +4628,8 @@ compare_place(place *pl1, place *pl2)
  * @retval	NULL	: invalid placement spec
  *
  */
-place *
-parse_placespec(char *place_str)
+static place *
+parse_placespec_str(char *place_str)
 {
 	/* copy place spec into - max log size should be big enough */
 	char str[MAX_LOG_SIZE];
@@ -4092,6 +4700,44 @@ parse_placespec(char *place_str)
 	return pl;
 }
 
+/**
+ * @brief
+ *		parse_placespec - parse a placement spec (-l place)
+ *
+ * @par	Place specs are shared between all the jobs requesting the same
+ *	string.  The returned spec must not be modified (see dup_place()).
+ *
+ * @param[in]	place_str	-	placespec as a string
+ *
+ * @return	place (free with free_place())
+ * @retval	NULL	: invalid placement spec
+ *
+ */
+place *
+parse_placespec(char *place_str)
+{
+	place *pl;
+	char *key;
+
+	if (place_str == NULL)
+		return NULL;
+
+	if ((pl = spec_cache_find('p', place_str, &key)) != NULL) {
+		free(key);
+		return share_place(pl);
+	}
+
+	pl = parse_placespec_str(place_str);
+	if (key != NULL) {
+		if (pl != NULL)
+			spec_cache_add(key, pl);
+		else
+			free(key);
+	}
+
+	return pl;
+}
+
 /**
  * @brief
  * 		parse a select spec into a selspec structure with
@@ -4107,8 +4753,8 @@ parse_placespec(char *place_str)
  *
  * @par MT-safe: No
  */
-selspec *
-parse_selspec(char *select_spec)
+static selspec *
+parse_selspec_str(char *select_spec)
 {
 	/* select specs can be large.  We need to allocate a buffer large enough
 	 * to handle the spec.  We'll keep it around so we don't have to allocate
@@ -4251,6 +4897,46 @@ parse_selspec(char *select_spec)
 	return spec;
 }
 
+/**
+ * @brief
+ * 		parse a select spec into a selspec structure
+ *
+ * @par	Selspecs are shared between all the jobs and reservations requesting
+ *	the same string.  The returned spec must not be modified (see
+ *	dup_selspec()).
+ *
+ * @param[in]	select_spec	-	the select spec to parse
+ *
+ * @return	selspec* (free with free_selspec())
+ * @retval	NULL	: on error or invalid spec
+ *
+ * @par MT-safe: No
+ */
+selspec *
+parse_selspec(char *select_spec)
+{
+	selspec *spec;
+	char *key;
+
+	if (select_spec == NULL)
+		return NULL;
+
+	if ((spec = spec_cache_find('s', select_spec, &key)) != NULL) {
+		free(key);
+		return share_selspec(spec);
+	}
+
+	spec = parse_selspec_str(select_spec);
+	if (key != NULL) {
+		if (spec != NULL)
+			spec_cache_add(key, spec);
+		else
+			free(key);
+	}
+
+	return spec;
+}
+
 /**
  *	@brief compare two chunks for equality
  *	@param[in] c1 - first chunk
@@ -5068,6 +5754,9 @@ set_res_on_host(char *res_name, char *res_value,
  *		'natural' vnodes are vnodes whose host resource is the
  *		same as its vnode name
  *
+ * @par	With mom_resources_from_status, MoM reports the values on its
+ *	natural vnode, so only the up natural vnodes that have them are used.
+ *
  * @param[in]	ninfo_arr	-	node array to update
  *
  * @return	int
@@ -5090,12 +5779,26 @@ update_mom_resources(node_info **ninfo_arr)
 		return 1;
 
 	for (i = 0; ninfo_arr[i] != NULL && rc; i++) {
-		if (should_talk_with_mom(ninfo_arr[i])) {
-			sprintf(buf, "@%s", ninfo_arr[i]->name);
-			for (j = 0; conf.dyn_res_to_get[j] && rc; j++) {
-				rc = set_res_on_host(conf.dyn_res_to_get[j], buf,
-					ninfo_arr[i]->name, ninfo_arr[i], ninfo_arr);
-			}
+		node_info *ninfo = ninfo_arr[i];
+
+		if (conf.mom_res_from_status) {
+			schd_resource *hostres;
+
+			if (ninfo->is_down || ninfo->is_offline || ninfo->is_sleeping)
+				continue;
+			hostres = find_resource(ninfo->res, getallres(RES_HOST));
+			if (hostres == NULL || !compare_res_to_str(hostres, ninfo->name, CMP_CASELESS))
+				continue;
+		} else if (!should_talk_with_mom(ninfo))
+			continue;
+
+		sprintf(buf, "@%s", ninfo->name);
+		for (j = 0; conf.dyn_res_to_get[j] && rc; j++) {
+			if (conf.mom_res_from_status &&
+				find_resource_by_str(ninfo->res, conf.dyn_res_to_get[j]) == NULL)
+				continue;
+			rc = set_res_on_host(conf.dyn_res_to_get[j], buf,
+				ninfo->name, ninfo, ninfo_arr);
 		}
 	}
 	return rc;
@@ -5756,14 +6459,226 @@ is_exclhost(place *placespec, enum vnode_sharing sharing)
 	return 0;
 }
 
+/**
+ * @brief
+ * 		evaluate one slice of the node array posted to the node_eval_pool
+ *
+ * @param[in]	slice	-	which slice to evaluate
+ * @param[in]	nslices	-	number of slices the array is split into
+ *
+ * @par MT-safe: yes, as long as the universe is not modified while the pool
+ *		 is running
+ *
+ * @return	void
+ */
+static void
+node_eval_slice(int slice, int nslices)
+{
+	int i;
+	int start;
+	int end;
+	schd_error *err = NULL;
+
+	start = (long) nepool.num_nodes * slice / nslices;
+	end = (long) nepool.num_nodes * (slice + 1) / nslices;
+
+	for (i = start; i < end; i++) {
+		node_info *node = nepool.ninfo_arr[i];
+
+		nepool.errs[i] = NULL;
+		nepool.results[i] = -1;
+		if (node->nscr.ineligible)
+			continue;
+
+		/* don't use new_schd_error(), it logs on failure */
+		if (err == NULL) {
+			if ((err = calloc(1, sizeof(schd_error))) == NULL)
+				continue;	/* the main thread will evaluate it */
+			err->status_code = SCHD_UNKWN;
+			err->error_code = SUCCESS;
+		}
+
+		if (is_vnode_eligible(node, nepool.resresv, nepool.pl, err)) {
+			nepool.results[i] = 1;
+			clear_schd_error(err);
+		} else {
+			nepool.results[i] = 0;
+			nepool.errs[i] = err;
+			err = NULL;
+		}
+	}
+	free_schd_error(err);
+}
+
+/**
+ * @brief
+ * 		main loop of a node_eval_pool worker thread
+ *
+ * @param[in]	arg	-	the slice this worker evaluates
+ *
+ * @return	NULL
+ */
+static void *
+node_eval_worker(void *arg)
+{
+	int slice = (int) (long) arg;
+	unsigned long seen;
+
+	pthread_mutex_lock(&nepool.lock);
+	seen = nepool.start_gen;
+	while (1) {
+		while (!nepool.stop && nepool.gen == seen)
+			pthread_cond_wait(&nepool.work_cv, &nepool.lock);
+		if (nepool.stop)
+			break;
+		seen = nepool.gen;
+		pthread_mutex_unlock(&nepool.lock);
+
+		node_eval_slice(slice, nepool.nthreads + 1);
+
+		pthread_mutex_lock(&nepool.lock);
+		if (--nepool.pending == 0)
+			pthread_cond_signal(&nepool.done_cv);
+	}
+	pthread_mutex_unlock(&nepool.lock);
+
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		make sure the node_eval_pool has conf.node_eval_threads workers
+ *
+ * @par	The pool is started lazily because the scheduler forks after it
+ *	reads its configuration and threads do not survive a fork.  It is
+ *	restarted if node_eval_threads changes on reconfigure, and in a
+ *	partition sub-cycle forked by partition_sub_cycles().
+ *
+ * @return	number of worker threads running
+ */
+static int
+node_eval_pool_start(void)
+{
+	int i;
+	int want;
+	sigset_t allsigs;
+	sigset_t oldsigs;
+
+	want = conf.node_eval_threads > 1 ? conf.node_eval_threads - 1 : 0;
+
+	if (nepool.pid == getpid() && nepool.nthreads == want)
+		return nepool.nthreads;
+
+	if (nepool.tids != NULL) {
+		if (nepool.pid == getpid()) {
+			pthread_mutex_lock(&nepool.lock);
+			nepool.stop = 1;
+			pthread_cond_broadcast(&nepool.work_cv);
+			pthread_mutex_unlock(&nepool.lock);
+			for (i = 0; i < nepool.nthreads; i++)
+				pthread_join(nepool.tids[i], NULL);
+		} else {
+			/* forked (e.g., a partition sub-cycle): the workers the
+			 * condition variables knew about are gone
+			 */
+			pthread_mutex_init(&nepool.lock, NULL);
+			pthread_cond_init(&nepool.work_cv, NULL);
+			pthread_cond_init(&nepool.done_cv, NULL);
+		}
+		free(nepool.tids);
+		nepool.tids = NULL;
+	}
+	nepool.nthreads = 0;
+	nepool.stop = 0;
+	nepool.pid = getpid();
+	nepool.start_gen = nepool.gen;
+
+	if (want == 0)
+		return 0;
+
+	if ((nepool.tids = calloc(want, sizeof(pthread_t))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return 0;
+	}
+
+	/* signals are for the main thread only */
+	sigfillset(&allsigs);
+	pthread_sigmask(SIG_BLOCK, &allsigs, &oldsigs);
+	for (i = 0; i < want; i++) {
+		if (pthread_create(&nepool.tids[i], NULL, node_eval_worker, (void *) (long) (i + 1)) != 0) {
+			log_err(errno, __func__, "Failed to create node evaluation thread");
+			break;
+		}
+	}
+	pthread_sigmask(SIG_SETMASK, &oldsigs, NULL);
+	nepool.nthreads = i;
+
+	log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+		"Started %d node evaluation threads", nepool.nthreads + 1);
+
+	return nepool.nthreads;
+}
+
+/**
+ * @brief
+ * 		run is_vnode_eligible() on every node of ninfo_arr in parallel
+ *
+ * @param[in]	ninfo_arr	-	array to check
+ * @param[in]	num_nodes	-	size of ninfo_arr
+ * @param[in]	resresv	-	resresv to check to place on nodes
+ * @param[in]	pl	-	place spec of resresv
+ * @param[out]	results	-	per node result (1 eligible, 0 not, -1 not evaluated)
+ * @param[out]	errs	-	per node error if results[i] is 0
+ *
+ * @return	int
+ * @retval	1	: the nodes were evaluated
+ * @retval	0	: the pool is not available, evaluate serially
+ */
+static int
+node_eval_parallel(node_info **ninfo_arr, int num_nodes, resource_resv *resresv,
+	place *pl, signed char *results, schd_error **errs)
+{
+	if (node_eval_pool_start() == 0)
+		return 0;
+
+	pthread_mutex_lock(&nepool.lock);
+	nepool.ninfo_arr = ninfo_arr;
+	nepool.num_nodes = num_nodes;
+	nepool.resresv = resresv;
+	nepool.pl = pl;
+	nepool.results = results;
+	nepool.errs = errs;
+	nepool.pending = nepool.nthreads;
+	nepool.gen++;
+	pthread_cond_broadcast(&nepool.work_cv);
+	pthread_mutex_unlock(&nepool.lock);
+
+	node_eval_slice(0, nepool.nthreads + 1);
+
+	pthread_mutex_lock(&nepool.lock);
+	while (nepool.pending > 0)
+		pthread_cond_wait(&nepool.done_cv, &nepool.lock);
+	nepool.ninfo_arr = NULL;
+	nepool.results = NULL;
+	nepool.errs = NULL;
+	pthread_mutex_unlock(&nepool.lock);
+
+	return 1;
+}
+
 /**
  * @brief
  * 		check nodes for eligibility and mark them ineligible if not
  *
  * @param[in]	ninfo_arr	-	array to check
  * @param[in]	resresv	-	resresv to check to place on nodes
+ * @param[in]	pl	-	place spec of resresv
  * @param[out]	err	-	error structure
  *
+ * @par	With node_eval_threads set, large arrays are first evaluated in
+ *	parallel by node_eval_parallel().  Nodes are still marked and logged
+ *	here in array order, so the outcome is the same as the serial walk.
+ *
  * @warning
  * 		If an error occurs in this function, no indication will be returned.
  *		This is not a huge concern because, it will just cause more work to be done.
@@ -5774,8 +6689,12 @@ void
 check_node_array_eligibility(node_info **ninfo_arr, resource_resv *resresv, place *pl, schd_error *err)
 {
 	int i, j;
+	int num_nodes = 0;
+	int rc;
 	static char exclerr_buf[MAX_LOG_SIZE] = {0};
 	static schd_error *misc_err = NULL;		/* used to keep err */
+	signed char *results = NULL;	/* from node_eval_parallel() */
+	schd_error **errs = NULL;
 
 	if (ninfo_arr == NULL || resresv == NULL || pl == NULL || err == NULL)
 		return;
@@ -5794,11 +6713,32 @@ check_node_array_eligibility(node_info **ninfo_arr, resource_resv *resresv, plac
 	clear_schd_error(misc_err);
 
 
+	if (conf.node_eval_threads > 1) {
+		num_nodes = count_array((void **) ninfo_arr);
+		if (num_nodes >= NODE_EVAL_MT_MIN_NODES) {
+			results = malloc(num_nodes * sizeof(signed char));
+			errs = malloc(num_nodes * sizeof(schd_error *));
+			if (results == NULL || errs == NULL ||
+			    !node_eval_parallel(ninfo_arr, num_nodes, resresv, pl, results, errs)) {
+				free(results);
+				free(errs);
+				results = NULL;
+				errs = NULL;
+			}
+		}
+	}
+
 	/* Pre-mark all ineligible nodes so we don't need to look at them later */
 	for (i = 0; ninfo_arr[i] != NULL; i++) {
 		if (!ninfo_arr[i]->nscr.ineligible) {
 			clear_schd_error(err);
-			if (is_vnode_eligible(ninfo_arr[i], resresv, pl, err) == 0) {
+			if (results != NULL && results[i] != -1) {
+				rc = results[i];
+				if (rc == 0)
+					move_schd_error(err, errs[i]);
+			} else
+				rc = is_vnode_eligible(ninfo_arr[i], resresv, pl, err);
+			if (rc == 0) {
 				ninfo_arr[i]->nscr.ineligible = 1;
 				if (ninfo_arr[i]->hostset != NULL) {
 					if ((err->error_code == NODE_NOT_EXCL &&
@@ -5827,6 +6767,13 @@ check_node_array_eligibility(node_info **ninfo_arr, resource_resv *resresv, plac
 	 */
 	if (err->status_code == SCHD_UNKWN && misc_err->status_code != SCHD_UNKWN)
 		move_schd_error(err, misc_err);
+
+	if (errs != NULL) {
+		for (i = 0; i < num_nodes; i++)
+			free_schd_error(errs[i]);
+		free(errs);
+	}
+	free(results);
 }
 
 /**
@@ -333,6 +333,23 @@ int compare_place(place *pl1, place *pl2);
  */
 selspec *parse_selspec(char *selspec);
 
+/*
+ *	resort_changed_nodes - re-sort a sorted node array after the sort keys
+ *			       of some of its nodes changed
+ */
+void resort_changed_nodes(node_info **nodes, int num_nodes, node_info **changed,
+	int (*cmp)(const void *, const void *));
+
+/*
+ *	free_spec_cache - free the cache of parsed select and place specs
+ */
+void free_spec_cache(void);
+
+/*
+ *	age_spec_cache - drop the cached specs not used in the last cycle
+ */
+void age_spec_cache(void);
+
 /* compare two selspecs to see if they are equal*/
 int compare_selspec(selspec *sel1, selspec *sel2);
 
@@ -675,6 +692,13 @@ int add_node_events(timed_event *te, void *arg1, void *arg2);
  * Find a node by its hostname
  */
 node_info *find_node_by_host(node_info **ninfo_arr, char *host);
+
+/* index a server's nodes by name for find_node_info() */
+node_name_index *create_node_name_index(node_info **nodes);
+
+node_name_index *share_node_name_index(node_name_index *nidx);
+
+void free_node_name_index(node_name_index *nidx);
 #ifdef	__cplusplus
 }
 #endif
@@ -50,14 +50,23 @@
  * 	dup_node_partition()
  * 	find_node_partition()
  * 	find_node_partition_by_rank()
+ * 	free_node_partition_layouts()
+ * 	prune_node_partition_layouts()
+ * 	save_node_partition_layouts()
+ * 	load_np_layout()
+ * 	load_node_partition_layouts()
  * 	create_node_partitions()
+ * 	create_cached_node_partitions()
  * 	node_partition_update_array()
  * 	node_partition_update()
  * 	new_np_cache()
  * 	free_np_cache_array()
+ * 	np_cache_key_is_stable()
+ * 	free_np_cache_for_nodes()
  * 	free_np_cache()
  * 	find_alloc_np_cache()
  * 	add_np_cache()
+ * 	create_host_max_res()
  * 	resresv_can_fit_nodepart()
  * 	create_specific_nodepart()
  * 	create_placement_sets()
@@ -74,6 +83,7 @@
 #include <log.h>
 #include <pbs_ifl.h>
 #include <pbs_internal.h>
+#include <libutil.h>
 #include "config.h"
 #include "constant.h"
 #include "data_types.h"
@@ -88,6 +98,7 @@
 #include "globals.h"
 #include "sort.h"
 #include "buckets.h"
+#include "avltree.h"
 
 
 /**
@@ -110,12 +121,14 @@ new_node_partition()
 
 	np->ok_break = 1;
 	np->excl = 0;
+	np->host_max_set = 0;
 	np->name = NULL;
 	np->def = NULL;
 	np->res_val = NULL;
 	np->tot_nodes = 0;
 	np->free_nodes = 0;
 	np->res = NULL;
+	np->host_max = NULL;
 	np->ninfo_arr = NULL;
 	np->bkts = NULL;
 
@@ -171,6 +184,9 @@ free_node_partition(node_partition *np)
 	if (np->res != NULL)
 		free_resource_list(np->res);
 
+	if (np->host_max != NULL)
+		free_resource_list(np->host_max);
+
 	if (np->ninfo_arr != NULL)
 		free(np->ninfo_arr);
 
@@ -256,6 +272,9 @@ dup_node_partition(node_partition *onp, server_info *nsinfo)
 	nnp->tot_nodes = onp->tot_nodes;
 	nnp->free_nodes = onp->free_nodes;
 	nnp->res = dup_resource_list(onp->res);
+	if (onp->host_max != NULL)
+		nnp->host_max = dup_resource_list(onp->host_max);
+	nnp->host_max_set = onp->host_max_set;
 #ifdef NAS /* localmod 049 */
 	nnp->ninfo_arr = copy_node_ptr_array(onp->ninfo_arr, nsinfo->nodes, nsinfo);
 #else
@@ -353,252 +372,857 @@ find_node_partition_by_rank(node_partition **np_arr, int rank)
 	return np_arr[i];
 }
 
+/*
+ * Layout of a node partition array: which partitions exist and which nodes
+ * (by position in the node array) belong to each of them.  A layout is all
+ * that node grouping resource values determine.  Everything else about a
+ * partition (free nodes, totals, buckets) comes from the nodes themselves
+ * and is recomputed every time partitions are created from a layout.
+ */
+struct np_layout_part {
+	char *name;		/* partition name: resource=value */
+	int res_i;		/* index of the grouping resource in resnames */
+	char *res_val;		/* value of the grouping resource */
+	int num_nodes;		/* number of nodes in the partition */
+	int size;		/* allocated size of node_ind */
+	int *node_ind;		/* positions of the nodes in the node array */
+};
+
+/*
+ * Layouts of the server's and queues' placement sets are carried between
+ * cycles.  Nodes are queried fresh each cycle, but their grouping resource
+ * values rarely change.  A layout is reused as long as the nodes are the
+ * same nodes in the same order with the same grouping values.
+ */
+struct np_layout {
+	char *tag;		/* owner of the partitions (see create_placement_sets()) */
+	char *resnames;		/* grouping resource names, comma separated */
+	unsigned int flags;	/* NP_* flags the layout was created with */
+	int num_res;		/* number of grouping resources */
+	int num_nodes;		/* number of nodes the layout was created from */
+	char **node_names;	/* names of those nodes */
+	char **node_keys;	/* grouping values of those nodes, NULL for stale nodes */
+	int num_parts;		/* number of partitions */
+	int parts_size;		/* allocated size of parts */
+	struct np_layout_part **parts;
+	int used;		/* used by this cycle's create_placement_sets() */
+	struct np_layout *next;
+};
+
+static struct np_layout *np_layout_head = NULL;
+
 /**
  * @brief
- * 		break apart nodes into partitions
- *		A possible side-effect of this function when multiple identical
- *		resources are defined on an attribute, is that the node
- *		partitions accounting for this node may count this node in the
- *		total count of "free_nodes" for that partition (if the node was
- *		free in the first place). Due to this, incorrect accounting,
- *		the metadata of the node partition may cause eval_selspec to
- *		descend into the node matching code instead of bailing out right
- *		away due to the fact that the node partition has insufficient
- *		resources.
+ *		free a node partition layout
  *
- * @param[in]	policy	-	policy info
- * @param[in]	nodes	-	the nodes which to create partitions from
- * @param[in]	resnames	-	node grouping resource names
- * @param[in]	flags	-	flags which change operations of node partition creation
- *							NP_IGNORE_EXCL - ignore vnodes marked excl
- *	 						NP_CREATE_REST - create a part for vnodes w/ no np resource
- * @param[out]	num_parts	-	the number of partitions created
+ * @param[in]	lay	-	layout to free
  *
- * @return	node_partition ** (NULL terminated node_partition array)
- * @retval	: created node_partition array
- * @retval	: NULL on error
+ * @return	nothing
+ */
+static void
+free_np_layout(struct np_layout *lay)
+{
+	int i;
+
+	if (lay == NULL)
+		return;
+
+	if (lay->parts != NULL) {
+		for (i = 0; i < lay->num_parts; i++) {
+			free(lay->parts[i]->name);
+			free(lay->parts[i]->res_val);
+			free(lay->parts[i]->node_ind);
+			free(lay->parts[i]);
+		}
+		free(lay->parts);
+	}
+	if (lay->node_names != NULL) {
+		for (i = 0; i < lay->num_nodes; i++)
+			free(lay->node_names[i]);
+		free(lay->node_names);
+	}
+	if (lay->node_keys != NULL) {
+		for (i = 0; i < lay->num_nodes; i++)
+			free(lay->node_keys[i]);
+		free(lay->node_keys);
+	}
+	free(lay->tag);
+	free(lay->resnames);
+	free(lay);
+}
+
+/**
+ * @brief
+ *		free the node partition layouts carried between cycles
  *
+ * @return	nothing
  */
-node_partition **
-create_node_partitions(status *policy, node_info **nodes, char **resnames, unsigned int flags, int *num_parts)
+void
+free_node_partition_layouts(void)
 {
-	node_partition **np_arr;
-	node_partition *np;
-	node_partition **tmp_arr;
-	char buf[1024];
-	char *str;
-	int free_str = 0;
-	int np_arr_size = 0;
-	schd_resource *res;
+	struct np_layout *lay;
+	struct np_layout *next;
 
-	int num_nodes;
-	int reslen;
+	for (lay = np_layout_head; lay != NULL; lay = next) {
+		next = lay->next;
+		free_np_layout(lay);
+	}
+	np_layout_head = NULL;
+}
+
+/**
+ * @brief
+ *		free the node partition layouts not used this cycle, those of a
+ *		queue which is gone or no longer has its own placement sets
+ *
+ * @return	nothing
+ */
+static void
+prune_node_partition_layouts(void)
+{
+	struct np_layout *lay;
+	struct np_layout **prev = &np_layout_head;
+
+	while ((lay = *prev) != NULL) {
+		if (lay->used) {
+			lay->used = 0;
+			prev = &lay->next;
+		} else {
+			*prev = lay->next;
+			log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER, LOG_DEBUG, lay->tag,
+				"Freeing unused node partitions for %s", lay->resnames);
+			free_np_layout(lay);
+		}
+	}
+}
+
+/**
+ * @brief
+ *		write the node partition layouts to the warm cache file.  A layout
+ *		only holds node names and grouping values, and is checked against
+ *		the nodes before it is used, so it stays valid across a restart.
+ *
+ * @param[in]	fp	-	warm cache file
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: write error
+ */
+int
+save_node_partition_layouts(FILE *fp)
+{
+	struct np_layout *lay;
+	struct np_layout_part *lp;
+	int num_lay = 0;
 	int i;
 
-	schd_resource *hostres;
-	schd_resource *tmpres;
+	for (lay = np_layout_head; lay != NULL; lay = lay->next)
+		num_lay++;
+	if (!write_cache_val(fp, &num_lay, sizeof(num_lay)))
+		return 0;
 
-	int res_i;		/* index of placement set resource name (resnames) */
-	int val_i;		/* index of placement set resource value */
-	int node_i;		/* index into nodes array */
-	int np_i;		/* index into node partition array we are creating */
+	for (lay = np_layout_head; lay != NULL; lay = lay->next) {
+		if (!write_cache_str(fp, lay->tag) ||
+			!write_cache_str(fp, lay->resnames) ||
+			!write_cache_val(fp, &lay->flags, sizeof(lay->flags)) ||
+			!write_cache_val(fp, &lay->num_res, sizeof(lay->num_res)) ||
+			!write_cache_val(fp, &lay->num_nodes, sizeof(lay->num_nodes)))
+			return 0;
+		for (i = 0; i < lay->num_nodes; i++)
+			if (!write_cache_str(fp, lay->node_names[i]) ||
+				!write_cache_str(fp, lay->node_keys[i]))
+				return 0;
 
-	schd_resource unset_res;
-	char *unsetarr[] = {"\"\"", NULL};
+		if (!write_cache_val(fp, &lay->num_parts, sizeof(lay->num_parts)))
+			return 0;
+		for (i = 0; i < lay->num_parts; i++) {
+			lp = lay->parts[i];
+			if (!write_cache_str(fp, lp->name) ||
+				!write_cache_val(fp, &lp->res_i, sizeof(lp->res_i)) ||
+				!write_cache_str(fp, lp->res_val) ||
+				!write_cache_val(fp, &lp->num_nodes, sizeof(lp->num_nodes)))
+				return 0;
+			if (lp->num_nodes > 0 &&
+				fwrite(lp->node_ind, sizeof(int), lp->num_nodes, fp) != lp->num_nodes)
+				return 0;
+		}
+	}
 
-	resdef *def;
+	return 1;
+}
 
-	queue_info **queues = NULL;
+/**
+ * @brief
+ *		read one layout written by save_node_partition_layouts()
+ *
+ * @param[in]	fp	-	warm cache file
+ *
+ * @return	struct np_layout *
+ * @retval	NULL	: read error or corrupt layout
+ */
+static struct np_layout *
+load_np_layout(FILE *fp)
+{
+	struct np_layout *lay;
+	struct np_layout_part *lp;
+	int i;
+	int j;
 
-	if (nodes == NULL || resnames == NULL)
+	if ((lay = calloc(1, sizeof(struct np_layout))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
 		return NULL;
+	}
 
-	if (nodes[0] != NULL && nodes[0]->server != NULL)
-		queues = nodes[0]->server->queues;
+	if (!read_cache_str(fp, &lay->tag) || lay->tag == NULL ||
+		!read_cache_str(fp, &lay->resnames) || lay->resnames == NULL ||
+		!read_cache_val(fp, &lay->flags, sizeof(lay->flags)) ||
+		!read_cache_val(fp, &lay->num_res, sizeof(lay->num_res)) ||
+		!read_cache_val(fp, &lay->num_nodes, sizeof(lay->num_nodes)) ||
+		lay->num_res <= 0 ||
+		lay->num_nodes <= 0 || lay->num_nodes > WARM_CACHE_MAX_ITEMS) {
+		lay->num_nodes = 0;
+		free_np_layout(lay);
+		return NULL;
+	}
 
-	num_nodes = count_array((void **) nodes);
+	lay->node_names = calloc(lay->num_nodes + 1, sizeof(char *));
+	lay->node_keys = calloc(lay->num_nodes + 1, sizeof(char *));
+	if (lay->node_names == NULL || lay->node_keys == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free_np_layout(lay);
+		return NULL;
+	}
+	for (i = 0; i < lay->num_nodes; i++) {
+		if (!read_cache_str(fp, &lay->node_names[i]) || lay->node_names[i] == NULL ||
+			!read_cache_str(fp, &lay->node_keys[i])) {
+			free_np_layout(lay);
+			return NULL;
+		}
+	}
 
-	if ((np_arr = (node_partition **)
-		malloc((num_nodes + 1) * sizeof(node_partition *))) == NULL) {
-		log_err(errno, "create_node_partitions", MEM_ERR_MSG);
+	if (!read_cache_val(fp, &lay->parts_size, sizeof(lay->parts_size)) ||
+		lay->parts_size < 0 || lay->parts_size > lay->num_nodes) {
+		free_np_layout(lay);
+		return NULL;
+	}
+	if ((lay->parts = calloc(lay->parts_size + 1, sizeof(struct np_layout_part *))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free_np_layout(lay);
+		return NULL;
+	}
+	for (i = 0; i < lay->parts_size; i++) {
+		if ((lp = calloc(1, sizeof(struct np_layout_part))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			break;
+		}
+		lay->parts[lay->num_parts++] = lp;
+		if (!read_cache_str(fp, &lp->name) || lp->name == NULL ||
+			!read_cache_val(fp, &lp->res_i, sizeof(lp->res_i)) ||
+			!read_cache_str(fp, &lp->res_val) || lp->res_val == NULL ||
+			!read_cache_val(fp, &lp->num_nodes, sizeof(lp->num_nodes)) ||
+			lp->res_i < 0 || lp->res_i >= lay->num_res ||
+			lp->num_nodes < 0 || lp->num_nodes > lay->num_nodes)
+			break;
+		lp->size = lp->num_nodes;
+		if ((lp->node_ind = malloc((lp->size + 1) * sizeof(int))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			break;
+		}
+		if (lp->num_nodes > 0 &&
+			fread(lp->node_ind, sizeof(int), lp->num_nodes, fp) != lp->num_nodes)
+			break;
+		for (j = 0; j < lp->num_nodes; j++)
+			if (lp->node_ind[j] < 0 || lp->node_ind[j] >= lay->num_nodes)
+				break;
+		if (j < lp->num_nodes)
+			break;
+	}
+	if (i < lay->parts_size) {
+		free_np_layout(lay);
 		return NULL;
 	}
 
-	np_arr_size = num_nodes;
+	return lay;
+}
 
-	np_i = 0;
-	np_arr[0] = NULL;
+/**
+ * @brief
+ *		replace the node partition layouts with those of the warm cache file
+ *
+ * @param[in]	fp	-	warm cache file
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: read error or corrupt file, no layouts are loaded
+ */
+int
+load_node_partition_layouts(FILE *fp)
+{
+	struct np_layout *lay;
+	struct np_layout **tail;
+	int num_lay;
+	int i;
+
+	free_node_partition_layouts();
+	if (!read_cache_val(fp, &num_lay, sizeof(num_lay)) ||
+		num_lay < 0 || num_lay > WARM_CACHE_MAX_ITEMS)
+		return 0;
+
+	tail = &np_layout_head;
+	for (i = 0; i < num_lay; i++) {
+		if ((lay = load_np_layout(fp)) == NULL) {
+			free_node_partition_layouts();
+			return 0;
+		}
+		*tail = lay;
+		tail = &lay->next;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief
+ *		return the values of a node grouping resource on a node
+ *
+ * @param[in]	ninfo	-	the node
+ * @param[in]	def	-	the node grouping resource
+ * @param[in]	flags	-	NP_CREATE_REST - nodes without the resource get the
+ *						value ""
+ *
+ * @return	char **
+ * @retval	the values of the resource
+ * @retval	NULL	: the node doesn't belong to a partition for def
+ */
+static char **
+node_group_values(node_info *ninfo, resdef *def, unsigned int flags)
+{
+	static char *unsetarr[] = {"\"\"", NULL};
+	schd_resource *res;
+
+	res = find_resource(ninfo->res, def);
+	if (res == NULL)
+		return (flags & NP_CREATE_REST) ? unsetarr : NULL;
+
+	/* Incase of indirect resource, point it to the right place */
+	if (res->indirect_res != NULL)
+		res = res->indirect_res;
+
+	return res->str_avail;
+}
+
+/**
+ * @brief
+ *		build the key of all node grouping resource values of a node
+ *
+ * @param[in]	ninfo	-	the node
+ * @param[in]	defs	-	the node grouping resources
+ * @param[in]	num_defs	-	number of entries in defs
+ * @param[in]	flags	-	flags passed to node_group_values()
+ * @param[in,out]	buf	-	buffer to build the key in (may be realloc()'d)
+ * @param[in,out]	size	-	size of buf
+ *
+ * @return	char *
+ * @retval	the key (*buf)
+ * @retval	NULL	: on error
+ */
+static char *
+node_group_key(node_info *ninfo, resdef **defs, int num_defs, unsigned int flags,
+	char **buf, int *size)
+{
+	char **vals;
+	int i;
+	int j;
+
+	if (*buf == NULL) {
+		if ((*buf = malloc(256)) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return NULL;
+		}
+		*size = 256;
+	}
+	(*buf)[0] = '\0';
+
+	for (i = 0; i < num_defs; i++) {
+		vals = node_group_values(ninfo, defs[i], flags);
+		for (j = 0; vals != NULL && vals[j] != NULL; j++) {
+			if (pbs_strcat(buf, size, vals[j]) == NULL ||
+				pbs_strcat(buf, size, "\001") == NULL)
+				return NULL;
+		}
+		if (pbs_strcat(buf, size, "\002") == NULL)
+			return NULL;
+	}
+	return *buf;
+}
+
+/**
+ * @brief
+ *		add a node to a layout partition, creating the partition if it
+ *		doesn't exist yet
+ *
+ * @param[in,out]	lay	-	layout being built
+ * @param[in]	idx	-	partition name -> layout partition
+ * @param[in]	name	-	partition name
+ * @param[in]	res_i	-	index of the grouping resource
+ * @param[in]	val	-	value of the grouping resource
+ * @param[in]	node_i	-	position of the node
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
+ */
+static int
+add_node_to_layout(struct np_layout *lay, AVL_IX_DESC *idx, char *name,
+	int res_i, char *val, int node_i)
+{
+	struct np_layout_part *lp;
+	struct np_layout_part **tmp_parts;
+	int *tmp_ind;
+
+	lp = find_tree(idx, name);
+	if (lp == NULL) {
+		if (lay->num_parts == lay->parts_size) {
+			tmp_parts = realloc(lay->parts,
+				(lay->parts_size * 2 + 1) * sizeof(struct np_layout_part *));
+			if (tmp_parts == NULL) {
+				log_err(errno, __func__, MEM_ERR_MSG);
+				return 0;
+			}
+			lay->parts = tmp_parts;
+			lay->parts_size = lay->parts_size * 2 + 1;
+		}
+		if ((lp = calloc(1, sizeof(struct np_layout_part))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		lay->parts[lay->num_parts++] = lp;
+		lp->res_i = res_i;
+		lp->name = string_dup(name);
+		lp->res_val = string_dup(val);
+		if (lp->name == NULL || lp->res_val == NULL)
+			return 0;
+		if (tree_add_del(idx, lp->name, lp, TREE_OP_ADD) != 0)
+			return 0;
+	}
+	/* a node with the same value twice is only in the partition once */
+	if (lp->num_nodes > 0 && lp->node_ind[lp->num_nodes - 1] == node_i)
+		return 1;
+
+	if (lp->num_nodes == lp->size) {
+		tmp_ind = realloc(lp->node_ind, (lp->size * 2 + 4) * sizeof(int));
+		if (tmp_ind == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		lp->node_ind = tmp_ind;
+		lp->size = lp->size * 2 + 4;
+	}
+	lp->node_ind[lp->num_nodes++] = node_i;
+
+	return 1;
+}
+
+/**
+ * @brief
+ *		create the layout of the node partitions for an array of nodes
+ *
+ * @param[in]	nodes	-	the nodes to create the layout from
+ * @param[in]	resnames	-	node grouping resource names
+ * @param[in]	defs	-	resource definitions of resnames
+ * @param[in]	flags	-	NP_* flags
+ *
+ * @return	struct np_layout *
+ * @retval	the new layout
+ * @retval	NULL	: on error
+ */
+static struct np_layout *
+create_np_layout(node_info **nodes, char **resnames, resdef **defs, unsigned int flags)
+{
+	struct np_layout *lay;
+	AVL_IX_DESC *idx;
+	char buf[1024];
+	char *str;
+	char **vals;
+	int reslen;
+	int res_i;
+	int node_i;
+	int val_i;
+	int rc = 1;
 
-	if (flags & NP_CREATE_REST) {
-		memset(&unset_res, 0, sizeof(unset_res));
-		unset_res.str_avail = (char **) unsetarr;
-		unset_res.type.is_non_consumable = 1;
-		unset_res.type.is_string = 1;
+	if ((lay = calloc(1, sizeof(struct np_layout))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
 	}
+	lay->flags = flags;
+	lay->num_res = count_array((void **) resnames);
+	lay->num_nodes = count_array((void **) nodes);
 
-	for (res_i = 0; resnames[res_i] != NULL; res_i++) {
-		def = find_resdef(allres, resnames[res_i]);
+	if ((idx = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free_np_layout(lay);
+		return NULL;
+	}
+
+	for (res_i = 0; rc && resnames[res_i] != NULL; res_i++) {
 		reslen = strlen(resnames[res_i]);
-		for (node_i = 0; nodes[node_i] != NULL; node_i++) {
+		for (node_i = 0; rc && nodes[node_i] != NULL; node_i++) {
 			if (nodes[node_i]->is_stale)
 				continue;
 
-			res = find_resource(nodes[node_i]->res, def);
+			/* nodes without the node partition resource are ignored
+			 * unless the NP_CREATE_REST flag is set
+			 */
+			vals = node_group_values(nodes[node_i], defs[res_i], flags);
+			for (val_i = 0; rc && vals != NULL && vals[val_i] != NULL; val_i++) {
+				/* 2: 1 for '=' 1 for '\0' */
+				if (reslen + strlen(vals[val_i]) + 2 < sizeof(buf)) {
+					sprintf(buf, "%s=%s", resnames[res_i], vals[val_i]);
+					str = buf;
+				}
+				else if ((str = concat_str(resnames[res_i], "=", vals[val_i], 0)) == NULL) {
+					rc = 0;
+					break;
+				}
 
-			if (res == NULL && (flags & NP_CREATE_REST)) {
-				unset_res.name = resnames[res_i];
-				res = &unset_res;
+				rc = add_node_to_layout(lay, idx, str, res_i, vals[val_i], node_i);
+				if (str != buf)
+					free(str);
 			}
-			if (res != NULL) {
-				/* Incase of indirect resource, point it to the right place */
-				if (res->indirect_res != NULL)
-					res = res->indirect_res;
-				for (val_i = 0; res->str_avail[val_i] != NULL; val_i++) {
-					/* 2: 1 for '=' 1 for '\0' */
-					if (reslen + strlen(res->str_avail[val_i]) + 2 < 1024) {
-						sprintf(buf, "%s=%s", resnames[res_i], res->str_avail[val_i]);
-						str = buf;
-					}
-					else {
-						str = concat_str(resnames[res_i], "=", res->str_avail[val_i], 0);
-						free_str = 1;
-					}
-					/* If we find the partition, we've already created it - add the node
-					 * to the existing partition.  If we don't find it, we create it.
-					 */
-					np = find_node_partition(np_arr, str);
-					if (np == NULL) {
-						if (np_i >= np_arr_size) {
-							tmp_arr = realloc(np_arr,
-								(np_arr_size * 2 + 1) * sizeof(node_partition *));
-							if (tmp_arr == NULL) {
-								log_err(errno, "create_node_partitions", MEM_ERR_MSG);
-								free_node_partition_array(np_arr);
-								if (free_str == 1)
-									free(str);
-
-								return NULL;
-							}
-							np_arr = tmp_arr;
-							np_arr_size *= 2;
-						}
-
-						np_arr[np_i] = new_node_partition();
-						if (np_arr[np_i] != NULL) {
-							if (free_str) {
-								np_arr[np_i]->name = str;
-								free_str = 0;
-							}
-							else
-								np_arr[np_i]->name = string_dup(str);
-
-							np_arr[np_i]->def = def;
-							np_arr[np_i]->res_val = string_dup(res->str_avail[val_i]);
-							np_arr[np_i]->tot_nodes = 1;
-							if (nodes[node_i]->is_free)
-								np_arr[np_i]->free_nodes = 1;
-							np_arr[np_i]->rank = get_sched_rank();
-
-							if (np_arr[np_i]->res_val == NULL) {
-								np_arr[np_i + 1] = NULL;
-								free_node_partition_array(np_arr);
-								return NULL;
-							}
-
-							np_i++;
-							np_arr[np_i] = NULL;
-						}
-						else {
-							free_node_partition_array(np_arr);
-							return NULL;
-						}
-					}
-					else {
-						np->tot_nodes++;
-						if (nodes[node_i]->is_free)
-							np->free_nodes++;
-					}
-					if (free_str) {
-						free(str);
-						free_str = 0;
-					}
+		}
+	}
 
-				}
-			}
-			/* else we ignore nodes without the node partition resource set
-			 * unless the NP_CREATE_REST flag is set
-			 */
+	avl_destroy_index(idx);
+	free(idx);
+
+	if (!rc) {
+		free_np_layout(lay);
+		return NULL;
+	}
+	return lay;
+}
+
+/**
+ * @brief
+ *		record the names and grouping values of the nodes a layout was
+ *		created from, so the layout can be matched against later cycles
+ *
+ * @param[in,out]	lay	-	the layout
+ * @param[in]	nodes	-	the nodes the layout was created from
+ * @param[in]	defs	-	the node grouping resources
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
+ */
+static int
+set_np_layout_keys(struct np_layout *lay, node_info **nodes, resdef **defs)
+{
+	char *buf = NULL;
+	int size = 0;
+	int i;
+
+	lay->node_names = calloc(lay->num_nodes + 1, sizeof(char *));
+	lay->node_keys = calloc(lay->num_nodes + 1, sizeof(char *));
+	if (lay->node_names == NULL || lay->node_keys == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return 0;
+	}
+
+	for (i = 0; i < lay->num_nodes; i++) {
+		if ((lay->node_names[i] = string_dup(nodes[i]->name)) == NULL)
+			break;
+		if (nodes[i]->is_stale)
+			continue;
+		if (node_group_key(nodes[i], defs, lay->num_res, lay->flags, &buf, &size) == NULL)
+			break;
+		if ((lay->node_keys[i] = string_dup(buf)) == NULL)
+			break;
+	}
+	free(buf);
+
+	return i == lay->num_nodes;
+}
+
+/**
+ * @brief
+ *		check if a layout still describes an array of nodes.  This is the
+ *		case if the nodes are the same nodes in the same order, and each of
+ *		them has the same node grouping resource values as before.
+ *
+ * @param[in]	lay	-	the layout
+ * @param[in]	nodes	-	the nodes
+ * @param[in]	defs	-	the node grouping resources
+ *
+ * @return	int
+ * @retval	1	: the layout can be reused
+ * @retval	0	: the layout needs to be recreated
+ */
+static int
+np_layout_matches(struct np_layout *lay, node_info **nodes, resdef **defs)
+{
+	char *buf = NULL;
+	int size = 0;
+	int i;
+
+	if (lay->node_names == NULL || lay->node_keys == NULL)
+		return 0;
+
+	for (i = 0; i < lay->num_nodes && nodes[i] != NULL; i++) {
+		if (strcmp(lay->node_names[i], nodes[i]->name) != 0)
+			break;
+		if (nodes[i]->is_stale || lay->node_keys[i] == NULL) {
+			if (!nodes[i]->is_stale || lay->node_keys[i] != NULL)
+				break;
+			continue;
 		}
+		if (node_group_key(nodes[i], defs, lay->num_res, lay->flags, &buf, &size) == NULL)
+			break;
+		if (strcmp(lay->node_keys[i], buf) != 0)
+			break;
 	}
+	free(buf);
 
+	return i == lay->num_nodes && nodes[i] == NULL;
+}
 
-	/* now that we have a list of node partitions and number of nodes in each
-	 * lets allocate a node array and fill it
-	 */
+/**
+ * @brief
+ *		create node partitions for an array of nodes from a layout
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	lay	-	layout of the partitions
+ * @param[in]	nodes	-	the nodes the layout describes
+ * @param[in]	defs	-	the node grouping resources
+ *
+ * @return	node_partition ** (NULL terminated node_partition array)
+ * @retval	: created node_partition array
+ * @retval	: NULL on error
+ */
+static node_partition **
+np_layout_to_partitions(status *policy, struct np_layout *lay, node_info **nodes, resdef **defs)
+{
+	node_partition **np_arr;
+	node_partition **tmp_arr;
+	node_partition *np;
+	struct np_layout_part *lp;
+	schd_resource *hostres;
+	schd_resource *tmpres;
+	node_info *ninfo;
+	queue_info **queues = NULL;
+	int np_i;
+	int i;
 
-	for (np_i = 0; np_arr[np_i] != NULL; np_i++) {
-		i = 0;
-		np_arr[np_i]->ok_break = 1;
-		hostres = NULL;
+	if (nodes[0] != NULL && nodes[0]->server != NULL)
+		queues = nodes[0]->server->queues;
 
-		np_arr[np_i]->ninfo_arr =
-			malloc((np_arr[np_i]->tot_nodes + 1) * sizeof(node_info *));
+	if ((np_arr = malloc((lay->num_parts + 1) * sizeof(node_partition *))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	np_arr[0] = NULL;
 
-		if (np_arr[np_i]->ninfo_arr == NULL) {
+	for (np_i = 0; np_i < lay->num_parts; np_i++) {
+		lp = lay->parts[np_i];
+		if ((np = new_node_partition()) == NULL) {
 			free_node_partition_array(np_arr);
 			return NULL;
 		}
+		np_arr[np_i] = np;
+		np_arr[np_i + 1] = NULL;
+
+		np->name = string_dup(lp->name);
+		np->res_val = string_dup(lp->res_val);
+		np->def = defs[lp->res_i];
+		np->rank = get_sched_rank();
+		np->ok_break = 1;
+		np->ninfo_arr = malloc((lp->num_nodes + 1) * sizeof(node_info *));
+		if (np->name == NULL || np->res_val == NULL || np->ninfo_arr == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			free_node_partition_array(np_arr);
+			return NULL;
+		}
+
+		hostres = NULL;
+		for (i = 0; i < lp->num_nodes; i++) {
+			ninfo = nodes[lp->node_ind[i]];
+			if (ninfo->is_free)
+				np->free_nodes++;
+			if (np->ok_break) {
+				tmpres = find_resource(ninfo->res, getallres(RES_HOST));
+				if (tmpres != NULL) {
+					if (hostres == NULL)
+						hostres = tmpres;
+					else if (!compare_res_to_str(hostres, tmpres->str_avail[0], CMP_CASELESS))
+						np->ok_break = 0;
+				}
+			}
+			tmp_arr = add_ptr_to_array(ninfo->np_arr, np);
+			if (tmp_arr == NULL) {
+				np->ninfo_arr[i] = NULL;
+				free_node_partition_array(np_arr);
+				return NULL;
+			}
+			ninfo->np_arr = tmp_arr;
+			np->ninfo_arr[i] = ninfo;
+		}
+		np->ninfo_arr[i] = NULL;
+		np->tot_nodes = lp->num_nodes;
+		np->bkts = create_node_buckets(policy, np->ninfo_arr, queues, NO_PRINT_BUCKETS);
+		node_partition_update(policy, np);
+	}
 
-		np_arr[np_i]->ninfo_arr[0] = NULL;
+	return np_arr;
+}
 
-		for (node_i = 0; nodes[node_i] != NULL &&
-			i < np_arr[np_i]->tot_nodes; node_i++) {
-			if (nodes[node_i]->is_stale)
-				continue;
+/**
+ * @brief
+ *		look up the resource definitions of the node grouping resources
+ *
+ * @param[in]	resnames	-	node grouping resource names
+ *
+ * @return	resdef ** (one entry per name, NULL for names which aren't resources)
+ * @retval	NULL	: on error
+ */
+static resdef **
+find_group_resdefs(char **resnames)
+{
+	resdef **defs;
+	int i;
 
-			res = find_resource(nodes[node_i]->res, np_arr[np_i]->def);
-			if (res == NULL && (flags & NP_CREATE_REST)) {
-				unset_res.name = resnames[res_i];
-				res = &unset_res;
-			}
-			if (res != NULL) {
-				/* Incase of indirect resource, point it to the right place */
-				if (res->indirect_res != NULL)
-					res = res->indirect_res;
-				if (compare_res_to_str(res, np_arr[np_i]->res_val, CMP_CASE)) {
-					if (np_arr[np_i]->ok_break) {
-						tmpres = find_resource(nodes[node_i]->res, getallres(RES_HOST));
-						if (tmpres != NULL) {
-							if (hostres == NULL)
-								hostres = tmpres;
-							else {
-								if (!compare_res_to_str(hostres, tmpres->str_avail[0], CMP_CASELESS))
-									np_arr[np_i]->ok_break = 0;
-							}
-						}
-					}
-					tmp_arr = add_ptr_to_array(nodes[node_i]->np_arr, np_arr[np_i]);
-					if (tmp_arr == NULL) {
-						free_node_partition_array(np_arr);
-						return NULL;
-					}
-					nodes[node_i]->np_arr = tmp_arr;
+	defs = malloc((count_array((void **) resnames) + 1) * sizeof(resdef *));
+	if (defs == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	for (i = 0; resnames[i] != NULL; i++)
+		defs[i] = find_resdef(allres, resnames[i]);
+	defs[i] = NULL;
 
-					np_arr[np_i]->ninfo_arr[i] = nodes[node_i];
-					i++;
-					np_arr[np_i]->ninfo_arr[i] = NULL;
-				}
+	return defs;
+}
+
+/**
+ * @brief
+ * 		break apart nodes into partitions
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	nodes	-	the nodes which to create partitions from
+ * @param[in]	resnames	-	node grouping resource names
+ * @param[in]	flags	-	flags which change operations of node partition creation
+ *							NP_IGNORE_EXCL - ignore vnodes marked excl
+ *	 						NP_CREATE_REST - create a part for vnodes w/ no np resource
+ * @param[out]	num_parts	-	the number of partitions created
+ *
+ * @return	node_partition ** (NULL terminated node_partition array)
+ * @retval	: created node_partition array
+ * @retval	: NULL on error
+ *
+ */
+node_partition **
+create_node_partitions(status *policy, node_info **nodes, char **resnames, unsigned int flags, int *num_parts)
+{
+	node_partition **np_arr = NULL;
+	struct np_layout *lay;
+	resdef **defs;
+
+	if (nodes == NULL || resnames == NULL)
+		return NULL;
+
+	if ((defs = find_group_resdefs(resnames)) == NULL)
+		return NULL;
+
+	if ((lay = create_np_layout(nodes, resnames, defs, flags)) != NULL) {
+		np_arr = np_layout_to_partitions(policy, lay, nodes, defs);
+		if (np_arr != NULL)
+			*num_parts = lay->num_parts;
+		free_np_layout(lay);
+	}
+	free(defs);
+
+	return np_arr;
+}
+
+/**
+ * @brief
+ * 		break apart nodes into partitions, reusing the layout of the
+ *		partitions created for the same owner in an earlier cycle if
+ *		the nodes' grouping resource values haven't changed
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	tag	-	owner of the partitions.  Each owner has one layout.
+ * @param[in]	nodes	-	the nodes which to create partitions from
+ * @param[in]	resnames	-	node grouping resource names
+ * @param[in]	flags	-	flags passed to create_node_partitions()
+ * @param[out]	num_parts	-	the number of partitions created
+ *
+ * @return	node_partition ** (NULL terminated node_partition array)
+ * @retval	: created node_partition array
+ * @retval	: NULL on error
+ */
+node_partition **
+create_cached_node_partitions(status *policy, char *tag, node_info **nodes,
+	char **resnames, unsigned int flags, int *num_parts)
+{
+	node_partition **np_arr = NULL;
+	struct np_layout *lay;
+	struct np_layout *prev = NULL;
+	resdef **defs;
+	char *resstr;
+
+	if (tag == NULL || nodes == NULL || resnames == NULL)
+		return NULL;
+
+	if ((resstr = string_dup(string_array_to_str(resnames))) == NULL)
+		return NULL;
+
+	if ((defs = find_group_resdefs(resnames)) == NULL) {
+		free(resstr);
+		return NULL;
+	}
+
+	for (lay = np_layout_head; lay != NULL; prev = lay, lay = lay->next)
+		if (strcmp(lay->tag, tag) == 0)
+			break;
+
+	if (lay != NULL && (lay->flags != flags || strcmp(lay->resnames, resstr) != 0 ||
+		!np_layout_matches(lay, nodes, defs))) {
+		if (prev == NULL)
+			np_layout_head = lay->next;
+		else
+			prev->next = lay->next;
+		free_np_layout(lay);
+		lay = NULL;
+	}
+
+	if (lay == NULL) {
+		log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER, LOG_DEBUG, tag,
+			"Creating node partitions for %s", resstr);
+		lay = create_np_layout(nodes, resnames, defs, flags);
+		if (lay != NULL) {
+			lay->tag = string_dup(tag);
+			lay->resnames = resstr;
+			resstr = NULL;
+			if (lay->tag == NULL || !set_np_layout_keys(lay, nodes, defs)) {
+				free_np_layout(lay);
+				lay = NULL;
+			}
+			else {
+				lay->next = np_layout_head;
+				np_layout_head = lay;
 			}
 		}
-		/* if multiple resource values are present, tot_nodes may be incorrect.
-		 * recalculating tot_nodes for each node partition.
-		 */
-		np_arr[np_i]->tot_nodes = count_array((void **) np_arr[np_i]->ninfo_arr);
-		np_arr[np_i]->bkts = create_node_buckets(policy, np_arr[np_i]->ninfo_arr, queues, NO_PRINT_BUCKETS);
-		node_partition_update(policy, np_arr[np_i]);
 	}
 
-	*num_parts = np_i;
+	if (lay != NULL) {
+		lay->used = 1;
+		np_arr = np_layout_to_partitions(policy, lay, nodes, defs);
+		if (np_arr != NULL)
+			*num_parts = lay->num_parts;
+	}
+	free(resstr);
+	free(defs);
+
 	return np_arr;
 }
 
@@ -802,6 +1426,99 @@ free_np_cache_array(np_cache **npc_arr)
 	return;
 }
 
+/**
+ * @brief
+ *		np_cache_key_is_stable - is a node array one of the server's or
+ *			queues' node arrays, which last as long as the universe does
+ *
+ * @param[in]	sinfo	-	server universe
+ * @param[in]	ninfo_arr	-	node array an np_cache was created over
+ *
+ * @return	int
+ * @retval	1	: it is
+ * @retval	0	: it is not (e.g. a temporary ordering of nodes)
+ */
+static int
+np_cache_key_is_stable(server_info *sinfo, node_info **ninfo_arr)
+{
+	int i;
+
+	if (ninfo_arr == sinfo->nodes || ninfo_arr == sinfo->unassoc_nodes)
+		return 1;
+
+	for (i = 0; sinfo->queues != NULL && sinfo->queues[i] != NULL; i++) {
+		if (ninfo_arr == sinfo->queues[i]->nodes ||
+			ninfo_arr == sinfo->queues[i]->nodes_in_partition)
+			return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief
+ *		free_np_cache_for_nodes - free the server's np_caches which were
+ *			created over any of the given nodes.  Jobs in queues tied to
+ *			disjoint partitions share no nodes, so running a job in one
+ *			partition keeps the caches of the others.  Caches created over
+ *			temporary node arrays are always freed.
+ *
+ * @param[in,out]	sinfo	-	server universe
+ * @param[in]	nodes	-	the nodes which changed.  NULL frees all caches.
+ *
+ * @return	void
+ */
+void
+free_np_cache_for_nodes(server_info *sinfo, node_info **nodes)
+{
+	np_cache **npc_arr;
+	int i;
+	int j;
+	int k;
+
+	if (sinfo == NULL || sinfo->npc_arr == NULL)
+		return;
+
+	npc_arr = sinfo->npc_arr;
+	if (nodes == NULL) {
+		free_np_cache_array(npc_arr);
+		sinfo->npc_arr = NULL;
+		return;
+	}
+
+	/* A job in a reservation can change the state of the server's node too */
+	for (i = 0; nodes[i] != NULL; i++) {
+		nodes[i]->nscr.np_changed = 1;
+		if (nodes[i]->svr_node != NULL)
+			nodes[i]->svr_node->nscr.np_changed = 1;
+	}
+
+	for (i = 0, j = 0; npc_arr[i] != NULL; i++) {
+		node_info **ninfo_arr = npc_arr[i]->ninfo_arr;
+		int keep = np_cache_key_is_stable(sinfo, ninfo_arr);
+
+		for (k = 0; keep && ninfo_arr[k] != NULL; k++)
+			if (ninfo_arr[k]->nscr.np_changed)
+				keep = 0;
+		if (keep)
+			npc_arr[j++] = npc_arr[i];
+		else
+			free_np_cache(npc_arr[i]);
+	}
+	npc_arr[j] = NULL;
+
+	for (i = 0; nodes[i] != NULL; i++) {
+		nodes[i]->nscr.np_changed = 0;
+		if (nodes[i]->svr_node != NULL)
+			nodes[i]->svr_node->nscr.np_changed = 0;
+	}
+
+	if (j == 0) {
+		free(npc_arr);
+		sinfo->npc_arr = NULL;
+	}
+}
+
 /**
  * @brief
  *		free_np_cache - destructor
@@ -970,6 +1687,95 @@ add_np_cache(np_cache ***npc_arr, np_cache *npc)
 	return 1;
 }
 
+/**
+ * @brief
+ *		find the most of each consumable resource that any one
+ *		host in a node partition has.  A chunk has to fit on a single host,
+ *		so a chunk asking for more than this can never run in the partition.
+ *
+ * @par	A host's amount comes from its host set, which may include vnodes
+ *	outside of the partition.  That only makes it an upper bound, which
+ *	is all that is needed.  A resource which is indirect on any node is
+ *	left unbounded.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	np	-	node partition
+ *
+ * @return	schd_resource *
+ * @retval	list of maximums (avail is the maximum)
+ * @retval	NULL	: no resources to bound or on error
+ */
+static schd_resource *
+create_host_max_res(status *policy, node_partition *np)
+{
+	schd_resource *head = NULL;
+	schd_resource *tail = NULL;
+	schd_resource *hres;
+	schd_resource *res;
+	schd_resource *cur;
+	resdef **defs;
+	int i;
+
+	defs = policy->resdef_to_check;
+	if (defs == NULL || np->ninfo_arr == NULL)
+		return NULL;
+
+	for (i = 0; np->ninfo_arr[i] != NULL; i++) {
+		node_info *ninfo = np->ninfo_arr[i];
+
+		if (ninfo->hostset != NULL && ninfo->hostset->res != NULL)
+			hres = ninfo->hostset->res;
+		else
+			hres = ninfo->res;
+
+		for (res = hres; res != NULL; res = res->next) {
+			if (!res->type.is_consumable || !resdef_exists_in_array(defs, res->def))
+				continue;
+
+			cur = find_resource(head, res->def);
+			if (cur == NULL) {
+				if ((cur = new_resource()) == NULL) {
+					free_resource_list(head);
+					return NULL;
+				}
+				cur->def = res->def;
+				cur->name = res->def->name;
+				cur->type = res->def->type;
+				cur->avail = 0;
+				cur->assigned = 0;
+				if (tail == NULL)
+					head = cur;
+				else {
+					tail->next = cur;
+					reset_resource_index(head);
+				}
+				tail = cur;
+			}
+			if (cur->avail == SCHD_INFINITY_RES)
+				continue;
+			if (res->avail == SCHD_INFINITY_RES) {
+				/* unset on this host: the full checks decide */
+				cur->avail = SCHD_INFINITY_RES;
+				continue;
+			}
+			if (res->avail > cur->avail)
+				cur->avail = res->avail;
+		}
+	}
+
+	/* indirect resources may be shared across hosts */
+	for (i = 0; np->ninfo_arr[i] != NULL; i++) {
+		for (res = np->ninfo_arr[i]->res; res != NULL; res = res->next) {
+			if (res->indirect_vnode_name == NULL && res->indirect_res == NULL)
+				continue;
+			if ((cur = find_resource(head, res->def)) != NULL)
+				cur->avail = SCHD_INFINITY_RES;
+		}
+	}
+
+	return head;
+}
+
 /**
  * @brief
  * 		do an initial check to see if a resresv can fit into a node partition
@@ -1113,6 +1919,32 @@ resresv_can_fit_nodepart(status *policy, node_partition *np, resource_resv *resr
 				return 0;
 		}
 	}
+
+	/* Check 5: Each chunk has to fit on a single host.  The host maximums
+	 *	    do not change during a cycle, so compute them once.
+	 */
+	if (!np->host_max_set) {
+		np->host_max = create_host_max_res(policy, np);
+		np->host_max_set = 1;
+	}
+	if (np->host_max != NULL) {
+		for (i = 0; spec->chunks[i] != NULL; i++) {
+			if (check_avail_resources(np->host_max, spec->chunks[i]->req,
+						(pass_flags & ~UNSET_RES_ZERO) | COMPARE_TOTAL | ONLY_COMP_CONS,
+						policy->resdef_to_check,
+						INSUFFICIENT_RESOURCE, err) == 0) {
+				if ((flags & RETURN_ALL_ERR)) {
+					can_fit = 0;
+					for (; err->next != NULL; err = err->next)
+						;
+					err->next = new_schd_error();
+					prev_err = err;
+					err = err->next;
+				} else
+					return 0;
+			}
+		}
+	}
 	if ((flags & RETURN_ALL_ERR)) {
 		if(prev_err != NULL) {
 			prev_err->next = NULL;
@@ -1216,14 +2048,37 @@ create_placement_sets(status *policy, server_info *sinfo)
 
 	sinfo->allpart = create_specific_nodepart(policy, "all", sinfo->unassoc_nodes);
 	if (sinfo->has_multi_vnode) {
-		sinfo->hostsets = create_node_partitions(policy, sinfo->nodes,
+		sinfo->hostsets = create_cached_node_partitions(policy, "@hostsets", sinfo->nodes,
 			resstr, policy->only_explicit_psets ? NO_FLAGS : NP_CREATE_REST, &num);
 		if (sinfo->hostsets != NULL) {
 			sinfo->num_hostsets = num;
+			/* A node's host set is the one for its (first) host value.
+			 * The host sets already know their nodes, use them rather
+			 * than searching the host sets by name for every node.
+			 */
+			for (i = 0; sinfo->hostsets[i] != NULL; i++) {
+				node_partition *hset = sinfo->hostsets[i];
+				int j;
+
+				for (j = 0; hset->ninfo_arr[j] != NULL; j++) {
+					node_info *ninfo = hset->ninfo_arr[j];
+					schd_resource *hostres;
+
+					if (ninfo->hostset != NULL)
+						continue;
+					hostres = find_resource(ninfo->res, getallres(RES_HOST));
+					if (strcmp(hset->res_val, hostres != NULL ? hostres->str_avail[0] : "\"\"") == 0)
+						ninfo->hostset = hset;
+				}
+			}
+			/* stale nodes are in no host set, but may share a host with one */
 			for (i = 0; sinfo->nodes[i] != NULL; i++) {
 				schd_resource *hostres;
 				char hostbuf[256];
 
+				if (!sinfo->nodes[i]->is_stale)
+					continue;
+
 				hostres = find_resource(sinfo->nodes[i]->res, getallres(RES_HOST));
 				if (hostres != NULL) {
 					snprintf(hostbuf, sizeof(hostbuf), "host=%s", hostres->str_avail[0]);
@@ -1245,8 +2100,8 @@ create_placement_sets(status *policy, server_info *sinfo)
 	}
 
 	if (sinfo->node_group_enable && sinfo->node_group_key != NULL) {
-		sinfo->nodepart = create_node_partitions(policy, sinfo->unassoc_nodes,
-			sinfo->node_group_key,
+		sinfo->nodepart = create_cached_node_partitions(policy, "@server",
+			sinfo->unassoc_nodes, sinfo->node_group_key,
 			policy->only_explicit_psets ? NO_FLAGS : NP_CREATE_REST,
 			&sinfo->num_parts);
 
@@ -1280,8 +2135,8 @@ create_placement_sets(status *policy, server_info *sinfo)
 			else
 				ngkey = sinfo->node_group_key;
 
-			qinfo->nodepart = create_node_partitions(policy, ngroup_nodes,
-				ngkey, policy->only_explicit_psets ? NO_FLAGS : NP_CREATE_REST,
+			qinfo->nodepart = create_cached_node_partitions(policy, qinfo->name,
+				ngroup_nodes, ngkey, policy->only_explicit_psets ? NO_FLAGS : NP_CREATE_REST,
 				&(qinfo->num_parts));
 			if (qinfo->nodepart != NULL) {
 				qsort(qinfo->nodepart, qinfo->num_parts,
@@ -1294,6 +2149,10 @@ create_placement_sets(status *policy, server_info *sinfo)
 			}
 		}
 	}
+
+	/* the layouts of deleted queues would otherwise stay until reconfigure */
+	prune_node_partition_layouts();
+
 	return is_success;
 }
 
@@ -122,6 +122,22 @@ node_partition **copy_node_partition_ptr_array(node_partition **onp_arr, node_pa
 node_partition **create_node_partitions(status *policy, node_info **nodes, char **resnames,
 					unsigned int flags, int *num_parts);
 
+/*
+ *	create_cached_node_partitions - create_node_partitions() for the
+ *		placement sets of the server and queues.  The layout of the
+ *		partitions is kept between cycles under tag and only recreated
+ *		when the nodes or their grouping resource values change.
+ */
+node_partition **create_cached_node_partitions(status *policy, char *tag, node_info **nodes,
+					char **resnames, unsigned int flags, int *num_parts);
+
+/* free the node partition layouts kept by create_cached_node_partitions() */
+void free_node_partition_layouts(void);
+
+/* write and read the node partition layouts to and from the warm cache file */
+int save_node_partition_layouts(FILE *fp);
+int load_node_partition_layouts(FILE *fp);
+
 /*
  *
  *      find_node_partition - find a node partition by name in an array
@@ -167,6 +183,11 @@ np_cache *new_np_cache(void);
  */
 void free_np_cache_array(np_cache **npc_arr);
 
+/*
+ *	free_np_cache_for_nodes - free the server's np_caches built over any of nodes
+ */
+void free_np_cache_for_nodes(server_info *sinfo, node_info **nodes);
+
 /*
  *	free_np_cache - destructor
  */
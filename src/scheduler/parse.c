@@ -348,6 +348,11 @@ parse_config(char *fname)
 						free(conf.fairshare_res);
 					conf.fairshare_res = string_dup(config_value);
 				}
+				else if (!strcmp(config_name, PARSE_CYCLE_STATS_FILE)) {
+					if (conf.cycle_stats_file != NULL)
+						free(conf.cycle_stats_file);
+					conf.cycle_stats_file = string_dup(config_value);
+				}
 				else if (!strcmp(config_name, PARSE_FAIRSHARE_ENT)) {
 					if (strcmp(config_value, ATTR_euser) &&
 						strcmp(config_value, ATTR_egroup) &&
@@ -741,6 +746,74 @@ parse_config(char *fname)
 					conf.max_preempt_attempts = num;
 				else if(!strcmp(config_name, PARSE_OPT_BACKFILL_FUZZY_TIME))
 					conf.dflt_opt_backfill_fuzzy = num;
+				else if (!strcmp(config_name, PARSE_MOM_RES_FROM_STATUS))
+					conf.mom_res_from_status = num ? 1 : 0;
+				else if (!strcmp(config_name, PARSE_INCR_QUERY))
+					conf.incr_query = num ? 1 : 0;
+				else if (!strcmp(config_name, PARSE_INCR_CALENDAR))
+					conf.incr_calendar = num ? 1 : 0;
+				else if (!strcmp(config_name, PARSE_INCR_EQUIV_CLASS))
+					conf.incr_equiv_class = num ? 1 : 0;
+				else if (!strcmp(config_name, PARSE_NODE_EVAL_THREADS)) {
+					if (num < 0 || num > NODE_EVAL_MAX_THREADS)
+						error = 1;
+					else
+						conf.node_eval_threads = num;
+				}
+				else if (!strcmp(config_name, PARSE_PARTITION_SUB_CYCLES)) {
+					if (num < 0 || num > PARTITION_SUB_CYCLES_MAX)
+						error = 1;
+					else
+						conf.partition_sub_cycles = num;
+				}
+				else if (!strcmp(config_name, PARSE_DYN_RES_REFRESH)) {
+					if (num < 0)
+						error = 1;
+					else
+						conf.dyn_res_refresh = num;
+				}
+				else if (!strcmp(config_name, PARSE_DYN_RES_TIMEOUT)) {
+					if (num < 0)
+						error = 1;
+					else
+						conf.dyn_res_timeout = num;
+				}
+				else if (!strcmp(config_name, PARSE_DYN_RES_STALE)) {
+					if (num < 0)
+						error = 1;
+					else
+						conf.dyn_res_stale = num;
+				}
+				else if (!strcmp(config_name, PARSE_PEER_QUERY_REFRESH)) {
+					if (num < 0)
+						error = 1;
+					else
+						conf.peer_query_refresh = num;
+				}
+				else if (!strcmp(config_name, PARSE_PEER_QUERY_STALE)) {
+					if (num < 0)
+						error = 1;
+					else
+						conf.peer_query_stale = num;
+				}
+				else if (!strcmp(config_name, PARSE_CYCLE_TIME_BUDGET)) {
+					if (num < 0)
+						error = 1;
+					else
+						conf.cycle_time_budget = num;
+				}
+				else if (!strcmp(config_name, PARSE_CYCLE_STATS_INTERVAL)) {
+					if (num < 0)
+						error = 1;
+					else
+						conf.cycle_stats_interval = num;
+				}
+				else if (!strcmp(config_name, PARSE_EST_START_THRESHOLD)) {
+					if (num < 0)
+						error = 1;
+					else
+						conf.est_start_threshold = num;
+				}
 				else if (!strcmp(config_name, PARSE_MAX_JOB_CHECK)) {
 					if (!strcmp(config_value, "ALL_JOBS"))
 						conf.max_jobs_to_check = SCHD_INFINITY;
@@ -910,6 +983,10 @@ init_config()
 		free(conf.fairshare_ent);
 		conf.fairshare_ent = NULL;
 	}
+	if (conf.cycle_stats_file != NULL) {
+		free(conf.cycle_stats_file);
+		conf.cycle_stats_file = NULL;
+	}
 	if (conf.res_to_check != NULL)
 		free_string_array(conf.res_to_check);
 	if (conf.dyn_res_to_get != NULL)
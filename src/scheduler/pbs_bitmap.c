@@ -42,6 +42,26 @@
 #include "pbs_bitmap.h"
 
 #define BYTES_TO_BITS(x) ((x) * 8)
+#define BITS_PER_LONG BYTES_TO_BITS(sizeof(unsigned long))
+
+/**
+ * @brief find the lowest on bit of a non-zero word
+ * @param word - the word
+ * @return int - the bit number of the lowest on bit
+ */
+static inline int
+lowest_on_bit(unsigned long word)
+{
+#ifdef __GNUC__
+	return __builtin_ctzl(word);
+#else
+	int i;
+
+	for (i = 0; !(word & (1UL << i)); i++)
+		;
+	return i;
+#endif
+}
 
 
 /**
@@ -72,12 +92,14 @@ pbs_bitmap_alloc(pbs_bitmap *pbm, long num_bits)
 	
 	/* shrinking bitmap, clear previously used bits */
 	if (num_bits < bm->num_bits) {
-		int i;
-		i = num_bits / BYTES_TO_BITS(sizeof(unsigned long)) + 1;
+		long i;
+		i = num_bits / BITS_PER_LONG;
+		if (num_bits % BITS_PER_LONG) {
+			bm->bits[i] &= (1UL << (num_bits % BITS_PER_LONG)) - 1;
+			i++;
+		}
 		for ( ; i < bm->num_longs; i++)
 			bm->bits[i] = 0;
-		for (i = pbs_bitmap_next_on_bit(bm, num_bits); i != -1; i = pbs_bitmap_next_on_bit(bm, i))
-			pbs_bitmap_bit_off(bm, i);
 	}
 
 	/* If we have enough unused bits available, we don't need to allocate */
@@ -215,7 +237,7 @@ pbs_bitmap_next_on_bit(pbs_bitmap *pbm, long start_bit)
 {
 	long long_ind;
 	long bit;
-	int i;
+	unsigned long word;
 	
 	if (pbm == NULL)
 		return -1;
@@ -223,34 +245,19 @@ pbs_bitmap_next_on_bit(pbs_bitmap *pbm, long start_bit)
 	if (start_bit >= pbm->num_bits)
 		return -1;
 	
-	long_ind = start_bit / BYTES_TO_BITS(sizeof(unsigned long));
-	bit = start_bit % BYTES_TO_BITS(sizeof(unsigned long));
-
-	/* special case - look at first long that contains start_bit */
-	if (pbm->bits[long_ind] != 0) {
-		for (i = bit + 1; i < BYTES_TO_BITS(sizeof(unsigned long)); i++) {
-			if (pbm->bits[long_ind] & (1UL << i)) {
-				return (long_ind * BYTES_TO_BITS(sizeof(unsigned long)) + i);
-			}
-		}
+	long_ind = start_bit / BITS_PER_LONG;
+	bit = start_bit % BITS_PER_LONG;
 
-		/* didn't find an on bit after start_bit_index in the long that contained start_bit */
-		if (long_ind < pbm->num_longs) {
-			long_ind++;
-		}
+	/* special case - look at the rest of the long that contains start_bit */
+	if (bit + 1 < BITS_PER_LONG) {
+		word = pbm->bits[long_ind] & (~0UL << (bit + 1));
+		if (word != 0)
+			return (long_ind * BITS_PER_LONG + lowest_on_bit(word));
 	}
 
-	for( ; long_ind < pbm->num_longs && pbm->bits[long_ind] == 0; long_ind++)
-		;
-
-	if (long_ind == pbm->num_longs)
-		return -1;
-
-	for (i = 0 ; i < BYTES_TO_BITS(sizeof(unsigned long)) ; i++) {
-		if (pbm->bits[long_ind] & (1UL << i)) {
-			return (long_ind * BYTES_TO_BITS(sizeof(unsigned long)) + i);
-		}
-	}
+	for (long_ind++; long_ind < pbm->num_longs; long_ind++)
+		if (pbm->bits[long_ind] != 0)
+			return (long_ind * BITS_PER_LONG + lowest_on_bit(pbm->bits[long_ind]));
 
 	return -1;
 }
@@ -271,6 +278,23 @@ pbs_bitmap_first_on_bit(pbs_bitmap *bm)
 	return pbs_bitmap_next_on_bit(bm, 0);
 }
 
+/**
+ * @brief turn all bits off in a bitmap
+ * @param pbm - the bitmap
+ * @return nothing
+ */
+void
+pbs_bitmap_clear(pbs_bitmap *pbm)
+{
+	long i;
+
+	if (pbm == NULL)
+		return;
+
+	for (i = 0; i < pbm->num_longs; i++)
+		pbm->bits[i] = 0;
+}
+
 /**
  * @brief pbs_bitmap version of L = R
  * @param L - bitmap lvalue
@@ -72,6 +72,9 @@ int pbs_bitmap_first_on_bit(pbs_bitmap *bm);
 /* Starting at start_bit get the next on bit */
 int pbs_bitmap_next_on_bit(pbs_bitmap *pbm, long start_bit);
 
+/* Turn all bits off */
+void pbs_bitmap_clear(pbs_bitmap *pbm);
+
 /* pbs_bitmap's version of L = R */
 int pbs_bitmap_assign(pbs_bitmap *L, pbs_bitmap *R);
 
@@ -110,6 +110,7 @@
 #include	"pbs_share.h"
 #include	"config.h"
 #include	"fifo.h"
+#include	"job_info.h"
 #include	"globals.h"
 
 struct		connect_handle connection[NCONNECTS];
@@ -135,6 +136,7 @@ int		pbs_rm_port;
 
 /* if we received a sigpipe, this probably means the server went away. */
 int		got_sigpipe = 0;
+static int	sched_initialized = 0;	/* schedinit() has been done */
 
 /* used in segv restart */
 time_t segv_start_time;
@@ -212,6 +214,10 @@ die(int sig)
 				__func__, "abnormal termination");
 	}
 
+	/* signals are blocked during a cycle, so the caches are consistent */
+	if (sig > 0 && sched_initialized)
+		(void) save_warm_cache();
+
 	{
 		int csret;
 		if ((csret = CS_close_app()) != CS_SUCCESS) {
@@ -1268,6 +1274,8 @@ main(int argc, char *argv[])
 				__func__, log_buffer);
 		exit(1);
 	}
+	(void) load_warm_cache();
+	sched_initialized = 1;
 
 #ifndef	DEBUG
 	if (stalone != 1) {
@@ -1277,6 +1285,7 @@ main(int argc, char *argv[])
 		}
 		else if (pid > 0)               /* parent exits */
 			exit(0);
+		log_set_index_owner();
 
 		if (setsid() == -1) {
 			perror("setsid");
@@ -1401,6 +1410,8 @@ main(int argc, char *argv[])
 	FD_ZERO(&fdset);
 	for (go=1; go;) {
 		int	cmd;
+		int	peer_wait;
+		struct timeval	peer_tv;
 
 		/*
 		 * with TPP, we don't need to drive rpp_io(), so
@@ -1409,8 +1420,19 @@ main(int argc, char *argv[])
 		if (pbs_conf.pbs_use_tcp == 0 && rpp_fd != -1)
 			FD_SET(rpp_fd, &fdset);
 
+		/* refresh the peer queues while waiting for the next cycle,
+		 * a reconfigure must not free their cache mid-refresh
+		 */
+		if (sigprocmask(SIG_BLOCK, &allsigs, &oldsigs) == -1)
+			log_err(errno, __func__, "sigprocmask(SIG_BLOCK)");
+		peer_wait = poll_peer_queues();
+		if (sigprocmask(SIG_SETMASK, &oldsigs, NULL) == -1)
+			log_err(errno, __func__, "sigprocmask(SIG_SETMASK)");
+		peer_tv.tv_sec = peer_wait;
+		peer_tv.tv_usec = 0;
+
 		FD_SET(server_sock, &fdset);
-		if (select(FD_SETSIZE, &fdset, NULL, NULL, NULL) == -1) {
+		if (select(FD_SETSIZE, &fdset, NULL, NULL, peer_wait >= 0 ? &peer_tv : NULL) == -1) {
 			if (errno != EINTR) {
 				log_err(errno, __func__, "select");
 				die(0);
@@ -1473,6 +1495,7 @@ main(int argc, char *argv[])
 		}
 	}
 
+	(void) save_warm_cache();
 	sprintf(log_buffer, "%s normal finish pid %ld", argv[0], (long)pid);
 	log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, __func__, log_buffer);
 	lock_out(lockfds, F_UNLCK);
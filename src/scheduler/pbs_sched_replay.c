@@ -0,0 +1,1517 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+/**
+ * @file    pbs_sched_replay.c
+ *
+ * @brief
+ * 		pbs_sched_replay.c - run scheduling cycles offline against a captured
+ *		snapshot of the server's universe.
+ *
+ *	With -c, the server, scheduler, queue, vnode, job, reservation and
+ *	resource status is captured from a live server into a snapshot file.
+ *	Otherwise the snapshot is loaded and the IFL calls the scheduler makes
+ *	are pointed at stubs: status calls are answered from the snapshot and
+ *	calls which would change the server are printed as the scheduler's
+ *	decisions and reported successful.  The server is never contacted.
+ *	The phase timings of the cycles are printed at the end.
+ *
+ *	With -g, a synthetic snapshot of the given number of vnodes, jobs and
+ *	custom consumable resources is written instead.  With -b, no cycle is
+ *	run: the universe of the snapshot is queried once and the scheduler's
+ *	hot functions are timed against it, one tab separated line per function
+ *	(name, calls, seconds, microseconds per call).  The custom resources of
+ *	a synthetic snapshot are only checked if they are added to the
+ *	resources line of the sched_config.
+ *
+ *	The cycles are run from the current directory (or -d), which must hold
+ *	a sched_priv: sched_config, resource_group, usage etc.  Use a copy,
+ *	the usage file is written at the end of a cycle.  Time dependent
+ *	policy is evaluated at the time of the replay, not of the capture.
+ *
+ * Functions included are:
+ * 	main()
+ * 	capture_snapshot()
+ * 	gen_snapshot()
+ * 	gen_random()
+ * 	gen_object()
+ * 	write_snapshot()
+ * 	write_status()
+ * 	write_value()
+ * 	load_snapshot()
+ * 	read_value()
+ * 	new_snap_status()
+ * 	add_attr()
+ * 	dup_snap_status()
+ * 	dup_status_list()
+ * 	find_attr_value()
+ * 	selected()
+ * 	replay_stat()
+ * 	replay_statserver()
+ * 	replay_statsched()
+ * 	replay_statque()
+ * 	replay_statvnode()
+ * 	replay_statresv()
+ * 	replay_statrsc()
+ * 	replay_selstat()
+ * 	replay_selectjob()
+ * 	replay_runjob()
+ * 	replay_asyrunjobs()
+ * 	replay_alterjob()
+ * 	replay_alterjobs()
+ * 	replay_manager()
+ * 	replay_confirmresv()
+ * 	replay_preempt_jobs()
+ * 	replay_sigjob()
+ * 	replay_movejob()
+ * 	replay_deljob()
+ * 	replay_geterrmsg()
+ * 	replay_ifl()
+ * 	run_bench()
+ * 	bench_report()
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+#include <libpbs.h>
+#include <pbs_ifl.h>
+#include "pbs_error.h"
+#include "pbs_share.h"
+#include "libutil.h"
+#include "data_types.h"
+#include "constant.h"
+#include "config.h"
+#include "fifo.h"
+#include "globals.h"
+#include "cycle_stats.h"
+#include "server_info.h"
+#include "node_info.h"
+#include "buckets.h"
+#include "check.h"
+#include "sort.h"
+#include "simulate.h"
+#include "misc.h"
+#include "pbs_version.h"
+#include "sched_cmds.h"
+#include "log.h"
+
+extern int	second_connection;
+
+/* the descriptor passed to the scheduler in place of a server connection */
+#define REPLAY_SD 0
+
+#define SNAPSHOT_MAGIC "pbs_sched_replay snapshot 1"
+
+/* the object types of a snapshot, in the order they are captured */
+enum snap_obj {
+	SNAP_SERVER,
+	SNAP_SCHED,
+	SNAP_QUEUE,
+	SNAP_VNODE,
+	SNAP_JOB,
+	SNAP_RESV,
+	SNAP_RESOURCE,
+	SNAP_NUM
+};
+
+static char *snap_obj_names[SNAP_NUM] = {
+	"server",
+	"sched",
+	"queue",
+	"vnode",
+	"job",
+	"resv",
+	"resource"
+};
+
+/* the loaded snapshot, one status list per object type */
+static struct batch_status *snap[SNAP_NUM];
+
+/* where the scheduler's decisions are printed */
+static FILE *out;
+
+/* limits and shape of a synthetic snapshot written by -g */
+#define GEN_MAX_RESOURCES	64
+#define GEN_NUM_USERS		10
+#define GEN_NUM_GROUPS		4
+#define GEN_SEED		1
+
+/**
+ * @brief
+ * 		write a value to a snapshot, escaping the backslashes and
+ *		newlines so the value stays on one line
+ *
+ * @param[in]	fp	-	snapshot file
+ * @param[in]	val	-	value to write
+ */
+static void
+write_value(FILE *fp, char *val)
+{
+	for (; val != NULL && *val != '\0'; val++) {
+		if (*val == '\\')
+			fputs("\\\\", fp);
+		else if (*val == '\n')
+			fputs("\\n", fp);
+		else
+			fputc(*val, fp);
+	}
+}
+
+/**
+ * @brief
+ * 		write a status list to a snapshot.  Each object is a line with its
+ *		type and name followed by one tab indented line per attribute:
+ *		name[.resource] = value
+ *
+ * @param[in]	fp	-	snapshot file
+ * @param[in]	type	-	object type of the list
+ * @param[in]	bs	-	status list to write
+ */
+static void
+write_status(FILE *fp, enum snap_obj type, struct batch_status *bs)
+{
+	struct attrl *attr;
+
+	for (; bs != NULL; bs = bs->next) {
+		fprintf(fp, "%s %s\n", snap_obj_names[type], bs->name);
+		for (attr = bs->attribs; attr != NULL; attr = attr->next) {
+			fprintf(fp, "\t%s", attr->name);
+			if (attr->resource != NULL && attr->resource[0] != '\0')
+				fprintf(fp, ".%s", attr->resource);
+			fputs(" = ", fp);
+			write_value(fp, attr->value);
+			fputc('\n', fp);
+		}
+	}
+}
+
+/**
+ * @brief
+ * 		write the status lists of a snapshot to a file and free them
+ *
+ * @param[in]	fname	-	snapshot file to write
+ * @param[in]	bs	-	one status list per object type
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: failure
+ */
+static int
+write_snapshot(char *fname, struct batch_status **bs)
+{
+	FILE *fp;
+	int i;
+
+	if ((fp = fopen(fname, "w")) == NULL) {
+		perror(fname);
+		for (i = 0; i < SNAP_NUM; i++)
+			pbs_statfree(bs[i]);
+		return 1;
+	}
+
+	fprintf(fp, "%s\ntime %ld\n", SNAPSHOT_MAGIC, (long) time(NULL));
+	for (i = 0; i < SNAP_NUM; i++) {
+		write_status(fp, i, bs[i]);
+		pbs_statfree(bs[i]);
+	}
+
+	if (fclose(fp) != 0) {
+		perror(fname);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 		capture the status a scheduling cycle queries from a live server
+ *		into a snapshot file
+ *
+ * @param[in]	server	-	server to capture or NULL for the default
+ * @param[in]	fname	-	snapshot file to write
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: failure
+ */
+static int
+capture_snapshot(char *server, char *fname)
+{
+	struct batch_status *bs[SNAP_NUM];
+	int pbs_sd;
+	int i;
+
+	if ((pbs_sd = pbs_connect(server)) < 0) {
+		fprintf(stderr, "Can't connect to the server\n");
+		return 1;
+	}
+
+	bs[SNAP_SERVER] = pbs_statserver(pbs_sd, NULL, NULL);
+	bs[SNAP_SCHED] = pbs_statsched(pbs_sd, NULL, NULL);
+	bs[SNAP_QUEUE] = pbs_statque(pbs_sd, NULL, NULL, NULL);
+	bs[SNAP_VNODE] = pbs_statvnode(pbs_sd, NULL, NULL, NULL);
+	/* what the scheduler sees: real jobs and the running subjobs */
+	bs[SNAP_JOB] = pbs_selstat(pbs_sd, NULL, NULL, "S");
+	bs[SNAP_RESV] = pbs_statresv(pbs_sd, NULL, NULL, NULL);
+	bs[SNAP_RESOURCE] = pbs_statrsc(pbs_sd, NULL, NULL, "p");
+	pbs_disconnect(pbs_sd);
+
+	if (bs[SNAP_SERVER] == NULL) {
+		fprintf(stderr, "Can't stat the server: %d\n", pbs_errno);
+		for (i = 0; i < SNAP_NUM; i++)
+			pbs_statfree(bs[i]);
+		return 1;
+	}
+
+	return write_snapshot(fname, bs);
+}
+
+/**
+ * @brief
+ * 		undo write_value() in place
+ *
+ * @param[in,out]	val	-	value read from a snapshot
+ */
+static void
+read_value(char *val)
+{
+	char *p;
+
+	for (p = val; *val != '\0'; val++, p++) {
+		if (*val == '\\' && *(val + 1) == 'n') {
+			*p = '\n';
+			val++;
+		} else if (*val == '\\' && *(val + 1) == '\\') {
+			*p = '\\';
+			val++;
+		} else
+			*p = *val;
+	}
+	*p = '\0';
+}
+
+/**
+ * @brief
+ * 		allocate a batch_status the way the IFL does, so pbs_statfree()
+ *		can free it
+ *
+ * @param[in]	name	-	name of the object
+ *
+ * @return	struct batch_status *
+ * @retval	NULL	: out of memory
+ */
+static struct batch_status *
+new_snap_status(char *name)
+{
+	struct batch_status *bs;
+
+	if ((bs = calloc(1, sizeof(struct batch_status))) == NULL)
+		return NULL;
+	if ((bs->name = strdup(name)) == NULL) {
+		free(bs);
+		return NULL;
+	}
+	return bs;
+}
+
+/**
+ * @brief
+ * 		append an attribute to a batch_status
+ *
+ * @param[in,out]	bs	-	object to add to
+ * @param[in,out]	tail	-	last attribute of bs, updated
+ * @param[in]	name	-	attribute name
+ * @param[in]	resc	-	resource name or NULL
+ * @param[in]	val	-	value
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: out of memory
+ */
+static int
+add_attr(struct batch_status *bs, struct attrl **tail, char *name, char *resc, char *val)
+{
+	struct attrl *attr;
+
+	if ((attr = calloc(1, sizeof(struct attrl))) == NULL)
+		return 0;
+	attr->name = strdup(name);
+	attr->resource = strdup(resc != NULL ? resc : "");
+	attr->value = strdup(val != NULL ? val : "");
+	attr->op = SET;
+	if (*tail == NULL)
+		bs->attribs = attr;
+	else
+		(*tail)->next = attr;
+	*tail = attr;
+
+	if (attr->name == NULL || attr->resource == NULL || attr->value == NULL)
+		return 0;
+	return 1;
+}
+
+/**
+ * @brief
+ * 		next number of the pseudo random sequence of a synthetic snapshot.
+ *		The sequence is fixed so the same -g always writes the same snapshot.
+ *
+ * @param[in,out]	seed	-	state of the sequence
+ *
+ * @return	unsigned long
+ */
+static unsigned long
+gen_random(unsigned long *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return (*seed >> 16) & 0x7fff;
+}
+
+/**
+ * @brief
+ * 		append a new object to a status list of a synthetic snapshot
+ *
+ * @param[in,out]	bs	-	one status list per object type
+ * @param[in,out]	tails	-	last object of each list, updated
+ * @param[in]	type	-	object type
+ * @param[in]	name	-	object name
+ *
+ * @return	struct batch_status *
+ * @retval	NULL	: out of memory
+ */
+static struct batch_status *
+gen_object(struct batch_status **bs, struct batch_status **tails,
+	enum snap_obj type, char *name)
+{
+	struct batch_status *obj;
+
+	if ((obj = new_snap_status(name)) == NULL)
+		return NULL;
+	if (tails[type] == NULL)
+		bs[type] = obj;
+	else
+		tails[type]->next = obj;
+	tails[type] = obj;
+	return obj;
+}
+
+/**
+ * @brief
+ * 		write a synthetic snapshot.  The vnodes are of a few different
+ *		sizes, a quarter of the jobs (at most one per vnode) are running and
+ *		the rest are queued with a varying number and size of chunks.  Each
+ *		custom resource is a consumable available on every vnode which about
+ *		half of the queued jobs request.
+ *
+ * @param[in]	spec	-	nodes,jobs,resources
+ * @param[in]	fname	-	snapshot file to write
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: failure
+ */
+static int
+gen_snapshot(char *spec, char *fname)
+{
+	static char *builtins[] = {"cput", "mem", "walltime", "soft_walltime",
+		"ncpus", "arch", "host", "vnode", "aoe", "eoe", "min_walltime",
+		"max_walltime", "preempt_targets", "nodect", "select", "place", NULL};
+	struct batch_status *bs[SNAP_NUM] = {NULL};
+	struct batch_status *tails[SNAP_NUM] = {NULL};
+	struct batch_status *obj;
+	struct attrl *tail;
+	unsigned long seed = GEN_SEED;
+	char select[GEN_MAX_RESOURCES * 32 + 64];
+	char name[PBS_MAXHOSTNAME + 32];
+	char val[256];
+	time_t now;
+	int num_nodes;
+	int num_jobs;
+	int num_res;
+	int num_run;
+	int chunks;
+	int ncpus;
+	int type;
+	int ok = 1;
+	int len;
+	int i;
+	int j;
+	int k;
+
+	if (sscanf(spec, "%d,%d,%d", &num_nodes, &num_jobs, &num_res) != 3 ||
+		num_nodes <= 0 || num_jobs < 0 || num_res < 0 ||
+		num_res > GEN_MAX_RESOURCES) {
+		fprintf(stderr, "Bad synthetic snapshot %s: use nodes,jobs,resources "
+			"with at most %d resources\n", spec, GEN_MAX_RESOURCES);
+		return 1;
+	}
+
+	now = time(NULL);
+	num_run = num_jobs / 4;
+	if (num_run > num_nodes)
+		num_run = num_nodes;
+	sprintf(val, "Transit:0 Queued:%d Held:0 Waiting:0 Running:%d Exiting:0 Begun:0",
+		num_jobs - num_run, num_run);
+
+	if ((obj = gen_object(bs, tails, SNAP_SERVER, "svr")) == NULL)
+		ok = 0;
+	else {
+		tail = NULL;
+		sprintf(name, "%d", num_jobs);
+		ok &= add_attr(obj, &tail, ATTR_total, NULL, name);
+		ok &= add_attr(obj, &tail, ATTR_count, NULL, val);
+		ok &= add_attr(obj, &tail, ATTR_status, NULL, "Active");
+		ok &= add_attr(obj, &tail, ATTR_scheduling, NULL, ATR_TRUE);
+		ok &= add_attr(obj, &tail, ATTR_dfltque, NULL, "workq");
+		ok &= add_attr(obj, &tail, ATTR_version, NULL, PBS_VERSION);
+		ok &= add_attr(obj, &tail, ATTR_DefaultChunk, "ncpus", "1");
+	}
+
+	if (ok && (obj = gen_object(bs, tails, SNAP_SCHED, PBS_DFLT_SCHED_NAME)) == NULL)
+		ok = 0;
+	else if (ok) {
+		tail = NULL;
+		ok &= add_attr(obj, &tail, ATTR_SchedHost, NULL, "h");
+		ok &= add_attr(obj, &tail, ATTR_scheduling, NULL, ATR_TRUE);
+		ok &= add_attr(obj, &tail, ATTR_sched_state, NULL, SC_IDLE);
+		ok &= add_attr(obj, &tail, ATTR_sched_preempt_order, NULL, "SCR");
+		ok &= add_attr(obj, &tail, ATTR_throughput_mode, NULL, ATR_TRUE);
+		ok &= add_attr(obj, &tail, ATTR_sched_cycle_len, NULL, "00:20:00");
+	}
+
+	if (ok && (obj = gen_object(bs, tails, SNAP_QUEUE, "workq")) == NULL)
+		ok = 0;
+	else if (ok) {
+		tail = NULL;
+		sprintf(name, "%d", num_jobs);
+		ok &= add_attr(obj, &tail, ATTR_total, NULL, name);
+		ok &= add_attr(obj, &tail, ATTR_count, NULL, val);
+		ok &= add_attr(obj, &tail, ATTR_qtype, NULL, "Execution");
+		ok &= add_attr(obj, &tail, ATTR_enable, NULL, ATR_TRUE);
+		ok &= add_attr(obj, &tail, ATTR_start, NULL, ATR_TRUE);
+	}
+
+	/* vnodes of 8, 16, 32 and 64 cpus with 4gb of memory per cpu */
+	for (i = 0; ok && i < num_nodes; i++) {
+		sprintf(name, "n%d", i);
+		if ((obj = gen_object(bs, tails, SNAP_VNODE, name)) == NULL) {
+			ok = 0;
+			break;
+		}
+		tail = NULL;
+		ncpus = 8 << (i % 4);
+		ok &= add_attr(obj, &tail, ATTR_NODE_Mom, NULL, name);
+		ok &= add_attr(obj, &tail, ATTR_NODE_Port, NULL, "15002");
+		ok &= add_attr(obj, &tail, ATTR_NODE_state, NULL, ND_free);
+		ok &= add_attr(obj, &tail, ATTR_NODE_ntype, NULL, ND_pbs);
+		sprintf(val, "%d", ncpus);
+		ok &= add_attr(obj, &tail, ATTR_rescavail, "ncpus", val);
+		sprintf(val, "%dgb", ncpus * 4);
+		ok &= add_attr(obj, &tail, ATTR_rescavail, "mem", val);
+		ok &= add_attr(obj, &tail, ATTR_rescavail, "host", name);
+		ok &= add_attr(obj, &tail, ATTR_rescavail, "vnode", name);
+		for (k = 0; k < num_res; k++) {
+			sprintf(val, "bench_res%d", k);
+			ok &= add_attr(obj, &tail, ATTR_rescavail, val, "16");
+		}
+		ok &= add_attr(obj, &tail, ATTR_NODE_Sharing, NULL, ND_Default_Shared);
+		ok &= add_attr(obj, &tail, ATTR_NODE_License, NULL, "l");
+		/* the first num_run vnodes each run one job of 2 cpus */
+		ok &= add_attr(obj, &tail, ATTR_rescassn, "ncpus", i < num_run ? "2" : "0");
+	}
+
+	for (i = 0; ok && i < num_jobs; i++) {
+		sprintf(name, "%d.svr", i + 1);
+		if ((obj = gen_object(bs, tails, SNAP_JOB, name)) == NULL) {
+			ok = 0;
+			break;
+		}
+		tail = NULL;
+		j = gen_random(&seed);
+		sprintf(val, "j%d", i + 1);
+		ok &= add_attr(obj, &tail, ATTR_name, NULL, val);
+		sprintf(val, "u%d@h", j % GEN_NUM_USERS);
+		ok &= add_attr(obj, &tail, ATTR_owner, NULL, val);
+		ok &= add_attr(obj, &tail, ATTR_state, NULL, i < num_run ? "R" : "Q");
+		ok &= add_attr(obj, &tail, ATTR_queue, NULL, "workq");
+		sprintf(val, "u%d", j % GEN_NUM_USERS);
+		ok &= add_attr(obj, &tail, ATTR_euser, NULL, val);
+		sprintf(val, "g%d", j % GEN_NUM_GROUPS);
+		ok &= add_attr(obj, &tail, ATTR_egroup, NULL, val);
+
+		if (i < num_run) {
+			chunks = 1;
+			ncpus = 2;
+		} else {
+			chunks = 1 + gen_random(&seed) % 3;
+			ncpus = 1 << (gen_random(&seed) % 4);
+		}
+		len = sprintf(select, "%d:ncpus=%d:mem=%dgb", chunks, ncpus, ncpus);
+		for (k = 0; i >= num_run && k < num_res; k++) {
+			if (gen_random(&seed) % 2) {
+				len += sprintf(select + len, ":bench_res%d=1", k);
+				sprintf(val, "bench_res%d", k);
+				sprintf(name, "%d", chunks);
+				ok &= add_attr(obj, &tail, ATTR_l, val, name);
+			}
+		}
+		sprintf(val, "%d", chunks * ncpus);
+		ok &= add_attr(obj, &tail, ATTR_l, "ncpus", val);
+		sprintf(val, "%dgb", chunks * ncpus);
+		ok &= add_attr(obj, &tail, ATTR_l, "mem", val);
+		sprintf(val, "%d", chunks);
+		ok &= add_attr(obj, &tail, ATTR_l, "nodect", val);
+		sprintf(val, "%02d:00:00", 1 + (int) (gen_random(&seed) % 4));
+		ok &= add_attr(obj, &tail, ATTR_l, "walltime", val);
+		ok &= add_attr(obj, &tail, ATTR_l, "select", select);
+		ok &= add_attr(obj, &tail, ATTR_l, "place", "free");
+		ok &= add_attr(obj, &tail, ATTR_SchedSelect, NULL, select);
+
+		/* the older jobs sort first on their submission times */
+		sprintf(val, "%ld", (long) (now - num_jobs + i));
+		ok &= add_attr(obj, &tail, ATTR_ctime, NULL, val);
+		ok &= add_attr(obj, &tail, ATTR_qtime, NULL, val);
+		ok &= add_attr(obj, &tail, ATTR_etime, NULL, val);
+		ok &= add_attr(obj, &tail, ATTR_mtime, NULL, val);
+		ok &= add_attr(obj, &tail, ATTR_project, NULL, "_pbs_project_default");
+		if (i < num_run) {
+			sprintf(val, "%ld", (long) (now - 600));
+			ok &= add_attr(obj, &tail, ATTR_stime, NULL, val);
+			sprintf(val, "(n%d:ncpus=2:mem=2gb)", i);
+			ok &= add_attr(obj, &tail, ATTR_execvnode, NULL, val);
+			sprintf(val, "n%d/0*2", i);
+			ok &= add_attr(obj, &tail, ATTR_exechost, NULL, val);
+			ok &= add_attr(obj, &tail, ATTR_used, "walltime", "00:10:00");
+			ok &= add_attr(obj, &tail, ATTR_substate, NULL, "42");
+		} else
+			ok &= add_attr(obj, &tail, ATTR_substate, NULL, "10");
+	}
+
+	for (i = 0; builtins[i] != NULL; i++)
+		;
+	for (k = 0; ok && k < i + num_res; k++) {
+		if (k < i)
+			strcpy(name, builtins[k]);
+		else
+			sprintf(name, "bench_res%d", k - i);
+		if ((obj = gen_object(bs, tails, SNAP_RESOURCE, name)) == NULL) {
+			ok = 0;
+			break;
+		}
+		tail = NULL;
+		if (k >= i || !strcmp(name, "ncpus") || !strcmp(name, "cput") ||
+			!strcmp(name, "walltime") || !strcmp(name, "soft_walltime") ||
+			!strcmp(name, "nodect") || !strcmp(name, "min_walltime") ||
+			!strcmp(name, "max_walltime"))
+			type = ATR_TYPE_LONG;
+		else if (!strcmp(name, "mem"))
+			type = ATR_TYPE_SIZE;
+		else
+			type = ATR_TYPE_STR;
+		sprintf(val, "%d", type);
+		ok &= add_attr(obj, &tail, ATTR_RESC_TYPE, NULL, val);
+		ok &= add_attr(obj, &tail, ATTR_RESC_FLAG, NULL, "0");
+	}
+
+	if (!ok) {
+		fprintf(stderr, "Out of memory writing a synthetic snapshot\n");
+		for (i = 0; i < SNAP_NUM; i++)
+			pbs_statfree(bs[i]);
+		return 1;
+	}
+
+	return write_snapshot(fname, bs);
+}
+
+/**
+ * @brief
+ * 		load a snapshot written by capture_snapshot() or gen_snapshot()
+ *
+ * @param[in]	fname	-	snapshot file
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: failure
+ */
+static int
+load_snapshot(char *fname)
+{
+	struct batch_status *tails[SNAP_NUM] = {NULL};
+	struct batch_status *bs = NULL;
+	struct attrl *tail = NULL;
+	char *buf = NULL;
+	int buf_size = 0;
+	int lineno = 0;
+	char *p;
+	char *val;
+	char *resc;
+	FILE *fp;
+	int i;
+
+	if ((fp = fopen(fname, "r")) == NULL) {
+		perror(fname);
+		return 1;
+	}
+
+	while (pbs_fgets(&buf, &buf_size, fp) != NULL) {
+		lineno++;
+		if ((p = strchr(buf, '\n')) != NULL)
+			*p = '\0';
+		if (lineno == 1) {
+			if (strcmp(buf, SNAPSHOT_MAGIC) != 0)
+				break;
+			continue;
+		}
+		if (buf[0] == '\0' || strncmp(buf, "time ", 5) == 0)
+			continue;
+
+		if (buf[0] == '\t') {
+			/* an attribute of the last object */
+			if (bs == NULL || (val = strstr(buf, " = ")) == NULL)
+				break;
+			*val = '\0';
+			val += 3;
+			read_value(val);
+			if ((resc = strchr(buf + 1, '.')) != NULL)
+				*resc++ = '\0';
+			if (!add_attr(bs, &tail, buf + 1, resc, val))
+				break;
+			continue;
+		}
+
+		/* a new object */
+		if ((p = strchr(buf, ' ')) == NULL)
+			break;
+		*p++ = '\0';
+		for (i = 0; i < SNAP_NUM && strcmp(buf, snap_obj_names[i]) != 0; i++)
+			;
+		if (i == SNAP_NUM || (bs = new_snap_status(p)) == NULL)
+			break;
+		if (tails[i] == NULL)
+			snap[i] = bs;
+		else
+			tails[i]->next = bs;
+		tails[i] = bs;
+		tail = NULL;
+	}
+
+	if (!feof(fp)) {
+		fprintf(stderr, "%s: bad snapshot at line %d\n", fname, lineno);
+		fclose(fp);
+		free(buf);
+		return 1;
+	}
+	fclose(fp);
+	free(buf);
+
+	if (snap[SNAP_SERVER] == NULL) {
+		fprintf(stderr, "%s: no server in snapshot\n", fname);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ * 		copy one snapshot object, keeping only the requested attributes
+ *
+ * @param[in]	obj	-	object to copy
+ * @param[in]	rattrl	-	attributes to keep or NULL for all of them
+ *
+ * @return	struct batch_status *
+ * @retval	NULL	: out of memory
+ */
+static struct batch_status *
+dup_snap_status(struct batch_status *obj, struct attrl *rattrl)
+{
+	struct batch_status *bs;
+	struct attrl *attr;
+	struct attrl *ra;
+	struct attrl *tail = NULL;
+
+	if ((bs = new_snap_status(obj->name)) == NULL)
+		return NULL;
+
+	for (attr = obj->attribs; attr != NULL; attr = attr->next) {
+		if (rattrl != NULL) {
+			for (ra = rattrl; ra != NULL && strcmp(ra->name, attr->name) != 0; ra = ra->next)
+				;
+			if (ra == NULL)
+				continue;
+		}
+		if (!add_attr(bs, &tail, attr->name, attr->resource, attr->value)) {
+			pbs_statfree(bs);
+			return NULL;
+		}
+	}
+	return bs;
+}
+
+/**
+ * @brief
+ * 		copy the objects of a snapshot list as a status call would
+ *		return them
+ *
+ * @param[in]	list	-	snapshot list
+ * @param[in]	id	-	name of the one object to return or NULL for all
+ * @param[in]	rattrl	-	attributes to return or NULL for all of them
+ *
+ * @return	struct batch_status *
+ * @retval	NULL	: no object, pbs_errno is set on error
+ */
+static struct batch_status *
+replay_stat(struct batch_status *list, char *id, struct attrl *rattrl)
+{
+	struct batch_status *head = NULL;
+	struct batch_status *tail = NULL;
+	struct batch_status *bs;
+
+	pbs_errno = PBSE_NONE;
+	for (; list != NULL; list = list->next) {
+		if (id != NULL && id[0] != '\0' && strcmp(id, list->name) != 0)
+			continue;
+		if ((bs = dup_snap_status(list, rattrl)) == NULL) {
+			pbs_statfree(head);
+			pbs_errno = PBSE_SYSTEM;
+			return NULL;
+		}
+		if (tail == NULL)
+			head = bs;
+		else
+			tail->next = bs;
+		tail = bs;
+	}
+	if (head == NULL && id != NULL && id[0] != '\0')
+		pbs_errno = PBSE_UNKJOBID;
+	return head;
+}
+
+/*
+ * The IFL stubs.  The status calls answer from the snapshot, the calls
+ * which would change the server print what they were asked to do and
+ * succeed.
+ */
+static struct batch_status *
+replay_statserver(int c, struct attrl *rattrl, char *extend)
+{
+	return replay_stat(snap[SNAP_SERVER], NULL, rattrl);
+}
+
+static struct batch_status *
+replay_statsched(int c, struct attrl *rattrl, char *extend)
+{
+	return replay_stat(snap[SNAP_SCHED], NULL, rattrl);
+}
+
+static struct batch_status *
+replay_statque(int c, char *id, struct attrl *rattrl, char *extend)
+{
+	return replay_stat(snap[SNAP_QUEUE], id, rattrl);
+}
+
+static struct batch_status *
+replay_statvnode(int c, char *id, struct attrl *rattrl, char *extend)
+{
+	return replay_stat(snap[SNAP_VNODE], id, rattrl);
+}
+
+static struct batch_status *
+replay_statresv(int c, char *id, struct attrl *rattrl, char *extend)
+{
+	return replay_stat(snap[SNAP_RESV], id, rattrl);
+}
+
+static struct batch_status *
+replay_statrsc(int c, char *id, struct attrl *rattrl, char *extend)
+{
+	return replay_stat(snap[SNAP_RESOURCE], id, rattrl);
+}
+
+/**
+ * @brief
+ * 		find the value of an attribute of a snapshot object
+ *
+ * @param[in]	bs	-	object
+ * @param[in]	name	-	attribute name
+ * @param[in]	resc	-	resource name or NULL
+ *
+ * @return	char *
+ * @retval	NULL	: attribute not set
+ */
+static char *
+find_attr_value(struct batch_status *bs, char *name, char *resc)
+{
+	struct attrl *attr;
+
+	for (attr = bs->attribs; attr != NULL; attr = attr->next) {
+		if (strcmp(attr->name, name) != 0)
+			continue;
+		if (resc == NULL || resc[0] == '\0' || strcmp(attr->resource, resc) == 0)
+			return attr->value;
+	}
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		does a job match a select list the way the server's select does.
+ *		Numbers are compared as numbers, everything else as strings.
+ *		An unset attribute only matches NE.
+ *
+ * @param[in]	job	-	job in the snapshot
+ * @param[in]	sel	-	select list
+ * @param[in]	extend	-	extend of the select request
+ *
+ * @return	int
+ * @retval	1	: the job is selected
+ * @retval	0	: it is not
+ */
+static int
+selected(struct batch_status *job, struct attropl *sel, char *extend)
+{
+	char *val;
+	char *endp1;
+	char *endp2;
+	double cmp;
+	char *p;
+	int match;
+
+	/* subjobs are only selected by the scheduler's S extend */
+	if (extend == NULL || strchr(extend, 'S') == NULL) {
+		if ((p = strchr(job->name, '[')) != NULL && p[1] != ']')
+			return 0;
+	}
+
+	for (; sel != NULL; sel = sel->next) {
+		if (strcmp(sel->name, ATTR_q) == 0) {
+			/* the destination is matched against the job's queue */
+			val = find_attr_value(job, ATTR_queue, NULL);
+			p = strchr(sel->value, '@');
+			match = (val != NULL && (p == NULL ?
+				strcmp(val, sel->value) == 0 :
+				(strlen(val) == p - sel->value && strncmp(val, sel->value, p - sel->value) == 0)));
+			if (match != (sel->op != NE))
+				return 0;
+			continue;
+		}
+
+		val = find_attr_value(job, sel->name, sel->resource);
+		if (val == NULL) {
+			if (sel->op != NE)
+				return 0;
+			continue;
+		}
+
+		cmp = strtod(val, &endp1) - strtod(sel->value, &endp2);
+		if (*val == '\0' || *endp1 != '\0' || *sel->value == '\0' || *endp2 != '\0')
+			cmp = strcmp(val, sel->value);
+
+		switch (sel->op) {
+			case EQ:
+				match = (cmp == 0);
+				break;
+			case NE:
+				match = (cmp != 0);
+				break;
+			case GE:
+				match = (cmp >= 0);
+				break;
+			case GT:
+				match = (cmp > 0);
+				break;
+			case LE:
+				match = (cmp <= 0);
+				break;
+			case LT:
+				match = (cmp < 0);
+				break;
+			default:
+				match = 1;
+		}
+		if (!match)
+			return 0;
+	}
+	return 1;
+}
+
+static struct batch_status *
+replay_selstat(int c, struct attropl *sel, struct attrl *rattrl, char *extend)
+{
+	struct batch_status *head = NULL;
+	struct batch_status *tail = NULL;
+	struct batch_status *job;
+	struct batch_status *bs;
+
+	pbs_errno = PBSE_NONE;
+	for (job = snap[SNAP_JOB]; job != NULL; job = job->next) {
+		if (!selected(job, sel, extend))
+			continue;
+		if ((bs = dup_snap_status(job, rattrl)) == NULL) {
+			pbs_statfree(head);
+			pbs_errno = PBSE_SYSTEM;
+			return NULL;
+		}
+		if (tail == NULL)
+			head = bs;
+		else
+			tail->next = bs;
+		tail = bs;
+	}
+	return head;
+}
+
+/**
+ * @brief
+ * 		the select job stub.  Like the IFL, the array and its strings are
+ *		allocated in one block so the caller frees it with one free().
+ */
+static char **
+replay_selectjob(int c, struct attropl *sel, char *extend)
+{
+	struct batch_status *job;
+	char **ids;
+	char *p;
+	size_t len = 0;
+	int count = 0;
+
+	pbs_errno = PBSE_NONE;
+	for (job = snap[SNAP_JOB]; job != NULL; job = job->next) {
+		if (selected(job, sel, extend)) {
+			count++;
+			len += strlen(job->name) + 1;
+		}
+	}
+	if (count == 0)
+		return NULL;
+
+	if ((ids = malloc((count + 1) * sizeof(char *) + len)) == NULL) {
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+	p = (char *)(ids + count + 1);
+	count = 0;
+	for (job = snap[SNAP_JOB]; job != NULL; job = job->next) {
+		if (selected(job, sel, extend)) {
+			strcpy(p, job->name);
+			ids[count++] = p;
+			p += strlen(p) + 1;
+		}
+	}
+	ids[count] = NULL;
+	return ids;
+}
+
+static int
+replay_runjob(int c, char *jobid, char *location, char *extend)
+{
+	fprintf(out, "run %s %s\n", jobid, location != NULL ? location : "");
+	return (pbs_errno = PBSE_NONE);
+}
+
+static job_err_info *
+replay_asyrunjobs(int c, char **jobids, char **locations)
+{
+	job_err_info *pje;
+	int count;
+	int i;
+
+	for (count = 0; jobids[count] != NULL; count++)
+		;
+	if ((pje = calloc(count + 1, sizeof(job_err_info))) == NULL) {
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+	for (i = 0; i < count; i++) {
+		replay_runjob(c, jobids[i], locations != NULL ? locations[i] : NULL, NULL);
+		snprintf(pje[i].job_id, sizeof(pje[i].job_id), "%s", jobids[i]);
+	}
+	return pje;
+}
+
+static int
+replay_alterjob(int c, char *jobid, struct attrl *attrib, char *extend)
+{
+	for (; attrib != NULL; attrib = attrib->next) {
+		fprintf(out, "alter %s %s", jobid, attrib->name);
+		if (attrib->resource != NULL && attrib->resource[0] != '\0')
+			fprintf(out, ".%s", attrib->resource);
+		fprintf(out, " = %s\n", attrib->value != NULL ? attrib->value : "");
+	}
+	return (pbs_errno = PBSE_NONE);
+}
+
+static job_err_info *
+replay_alterjobs(int c, struct batch_status *jobs)
+{
+	struct batch_status *bs;
+	job_err_info *pje;
+	int count = 0;
+	int i;
+
+	for (bs = jobs; bs != NULL; bs = bs->next)
+		count++;
+	if ((pje = calloc(count + 1, sizeof(job_err_info))) == NULL) {
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+	for (i = 0, bs = jobs; bs != NULL; bs = bs->next, i++) {
+		replay_alterjob(c, bs->name, bs->attribs, NULL);
+		snprintf(pje[i].job_id, sizeof(pje[i].job_id), "%s", bs->name);
+	}
+	return pje;
+}
+
+static int
+replay_manager(int c, int command, int objtype, char *objname, struct attropl *attrib, char *extend)
+{
+	for (; attrib != NULL; attrib = attrib->next)
+		fprintf(out, "manager %s %s = %s\n", objname != NULL ? objname : "",
+			attrib->name, attrib->value != NULL ? attrib->value : "");
+	return (pbs_errno = PBSE_NONE);
+}
+
+static int
+replay_confirmresv(int c, char *resvid, char *location, unsigned long start, char *extend)
+{
+	fprintf(out, "confirm %s %s %lu\n", resvid, location != NULL ? location : "", start);
+	return (pbs_errno = PBSE_NONE);
+}
+
+/**
+ * @brief
+ * 		the preempt jobs stub.  Every job is preempted with the first
+ *		method of the scheduler's preempt_order.
+ */
+static preempt_job_info *
+replay_preempt_jobs(int c, char **jobs)
+{
+	preempt_job_info *ppj;
+	struct batch_status *bs;
+	char method = 'S';
+	char *order = NULL;
+	int count;
+	int i;
+
+	bs = snap[SNAP_SCHED];
+	if (sc_name != NULL)
+		for (; bs != NULL && strcmp(bs->name, sc_name) != 0; bs = bs->next)
+			;
+	if (bs != NULL)
+		order = find_attr_value(bs, ATTR_sched_preempt_order, NULL);
+	if (order != NULL && order[0] != '\0')
+		method = order[0];
+
+	for (count = 0; jobs[count] != NULL; count++)
+		;
+	if ((ppj = calloc(count + 1, sizeof(preempt_job_info))) == NULL) {
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+	for (i = 0; i < count; i++) {
+		fprintf(out, "preempt %s %c\n", jobs[i], method);
+		snprintf(ppj[i].job_id, sizeof(ppj[i].job_id), "%s", jobs[i]);
+		ppj[i].order[0] = method;
+	}
+	return ppj;
+}
+
+static int
+replay_sigjob(int c, char *jobid, char *sig, char *extend)
+{
+	fprintf(out, "signal %s %s\n", jobid, sig);
+	return (pbs_errno = PBSE_NONE);
+}
+
+static int
+replay_movejob(int c, char *jobid, char *destin, char *extend)
+{
+	fprintf(out, "move %s %s\n", jobid, destin != NULL ? destin : "");
+	return (pbs_errno = PBSE_NONE);
+}
+
+static int
+replay_deljob(int c, char *jobid, char *extend)
+{
+	fprintf(out, "delete %s\n", jobid);
+	return (pbs_errno = PBSE_NONE);
+}
+
+static char *
+replay_geterrmsg(int c)
+{
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		point the IFL calls the scheduler makes at the replay stubs
+ */
+static void
+replay_ifl(void)
+{
+	pfn_pbs_statserver = replay_statserver;
+	pfn_pbs_statsched = replay_statsched;
+	pfn_pbs_statque = replay_statque;
+	pfn_pbs_statvnode = replay_statvnode;
+	pfn_pbs_statresv = replay_statresv;
+	pfn_pbs_statrsc = replay_statrsc;
+	pfn_pbs_selstat = replay_selstat;
+	pfn_pbs_selectjob = replay_selectjob;
+	pfn_pbs_runjob = replay_runjob;
+	pfn_pbs_asyrunjob = replay_runjob;
+	pfn_pbs_asyrunjobs = replay_asyrunjobs;
+	pfn_pbs_alterjob = replay_alterjob;
+	pfn_pbs_alterjobs = replay_alterjobs;
+	pfn_pbs_manager = replay_manager;
+	pfn_pbs_confirmresv = replay_confirmresv;
+	pfn_pbs_preempt_jobs = replay_preempt_jobs;
+	pfn_pbs_sigjob = replay_sigjob;
+	pfn_pbs_movejob = replay_movejob;
+	pfn_pbs_deljob = replay_deljob;
+	pfn_pbs_geterrmsg = replay_geterrmsg;
+}
+
+/**
+ * @brief
+ * 		print the timing of one function of a benchmark
+ *
+ * @param[in]	name	-	function timed
+ * @param[in]	calls	-	number of calls timed
+ * @param[in]	t1	-	time before the first call
+ * @param[in]	t2	-	time after the last call
+ */
+static void
+bench_report(char *name, long calls, struct timeval *t1, struct timeval *t2)
+{
+	double secs;
+
+	secs = (t2->tv_sec - t1->tv_sec) + (t2->tv_usec - t1->tv_usec) / 1000000.0;
+	fprintf(out, "%s\t%ld\t%.6f\t%.3f\n", name, calls, secs,
+		calls > 0 ? secs * 1000000.0 / calls : 0.0);
+}
+
+/**
+ * @brief
+ * 		time the scheduler's hot functions against the universe of the
+ *		snapshot.  The universe is queried and set up for a cycle once,
+ *		then each function is called on it iterations times.
+ *
+ * @param[in]	iterations	-	number of times to call each function
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: failure
+ */
+static int
+run_bench(int iterations)
+{
+	server_info *sinfo;
+	server_info *nsinfo;
+	status *policy;
+	node_bucket **buckets;
+	timed_event *events;
+	nspec **ns_arr;
+	schd_error *err;
+	resource_resv *job;
+	struct timeval t1;
+	struct timeval t2;
+	long calls;
+	int i;
+	int j;
+	int k;
+
+	if ((err = new_schd_error()) == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	update_cycle_status(&cstat, 0);
+	gettimeofday(&t1, NULL);
+	if ((sinfo = query_server(&cstat, REPLAY_SD)) == NULL) {
+		fprintf(stderr, "Can't query the snapshot's universe\n");
+		free_schd_error(err);
+		return 1;
+	}
+	gettimeofday(&t2, NULL);
+	policy = sinfo->policy;
+	if (init_scheduling_cycle(policy, REPLAY_SD, sinfo) == 0) {
+		fprintf(stderr, "Can't set up the scheduling cycle\n");
+		free_server(sinfo);
+		free_schd_error(err);
+		return 1;
+	}
+
+	fprintf(out, "# bench nodes=%d jobs=%d iterations=%d\n", sinfo->num_nodes,
+		count_array((void **) sinfo->jobs), iterations);
+	fprintf(out, "# function\tcalls\tseconds\tusec_per_call\n");
+	bench_report("query_server", 1, &t1, &t2);
+
+	gettimeofday(&t1, NULL);
+	for (i = 0; i < iterations; i++) {
+		if ((nsinfo = dup_server_info(sinfo)) != NULL)
+			free_server(nsinfo);
+	}
+	gettimeofday(&t2, NULL);
+	bench_report("dup_server_info", iterations, &t1, &t2);
+
+	gettimeofday(&t1, NULL);
+	for (i = 0; i < iterations; i++)
+		sort_jobs(policy, sinfo);
+	gettimeofday(&t2, NULL);
+	bench_report("sort_jobs", iterations, &t1, &t2);
+
+	gettimeofday(&t1, NULL);
+	for (i = 0; i < iterations; i++) {
+		buckets = create_node_buckets(policy, sinfo->nodes, NULL, NO_PRINT_BUCKETS);
+		free_node_bucket_array(buckets);
+	}
+	gettimeofday(&t2, NULL);
+	bench_report("create_node_buckets", iterations, &t1, &t2);
+
+	/* the first chunk of every job against every vnode */
+	calls = 0;
+	gettimeofday(&t1, NULL);
+	for (i = 0; i < iterations; i++) {
+		for (j = 0; sinfo->jobs[j] != NULL; j++) {
+			job = sinfo->jobs[j];
+			if (job->select == NULL || job->select->chunks == NULL ||
+				job->select->chunks[0] == NULL)
+				continue;
+			for (k = 0; sinfo->nodes[k] != NULL; k++) {
+				check_avail_resources(sinfo->nodes[k]->res,
+					job->select->chunks[0]->req, UNSET_RES_ZERO,
+					policy->resdef_to_check, INSUFFICIENT_RESOURCE, err);
+				clear_schd_error(err);
+				calls++;
+			}
+		}
+	}
+	gettimeofday(&t2, NULL);
+	bench_report("check_avail_resources", calls, &t1, &t2);
+
+	/* placing the queued jobs on the vnodes, nothing is allocated */
+	calls = 0;
+	gettimeofday(&t1, NULL);
+	for (i = 0; i < iterations; i++) {
+		for (j = 0; sinfo->jobs[j] != NULL; j++) {
+			job = sinfo->jobs[j];
+			if (!job->job->is_queued || job->select == NULL)
+				continue;
+			ns_arr = NULL;
+			eval_selspec(policy, job->select, job->place_spec, sinfo->nodes,
+				NULL, job, NO_FLAGS, &ns_arr, err);
+			free_nspecs(ns_arr);
+			clear_schd_error(err);
+			calls++;
+		}
+	}
+	gettimeofday(&t2, NULL);
+	bench_report("eval_selspec", calls, &t1, &t2);
+
+	gettimeofday(&t1, NULL);
+	for (i = 0; i < iterations; i++) {
+		events = create_events(sinfo);
+		free_timed_event_list(events);
+	}
+	gettimeofday(&t2, NULL);
+	bench_report("create_events", iterations, &t1, &t2);
+
+	free_server(sinfo);
+	free_schd_error(err);
+	return 0;
+}
+
+/**
+ * @brief
+ * 		The entry point of pbs_sched_replay
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: something is wrong!
+ */
+int
+main(int argc, char *argv[])
+{
+	char *capture = NULL;
+	char *synthetic = NULL;
+	char *server = NULL;
+	char *dir = NULL;
+	char *logdir = NULL;
+	char *outfile = NULL;
+	char buf[1024];
+	struct timeval t1;
+	struct timeval t2;
+	int cycles = 1;
+	int iterations = 0;
+	int errflg = 0;
+	int c;
+	int i;
+
+	/* the real deal or output version and exit? */
+	PRINT_VERSION_AND_EXIT(argc, argv);
+	set_msgdaemonname("pbs_sched_replay");
+
+	while ((c = getopt(argc, argv, "b:c:g:s:I:d:l:n:o:")) != -1)
+		switch (c) {
+			case 'b':
+				iterations = atoi(optarg);
+				if (iterations <= 0)
+					errflg = 1;
+				break;
+			case 'c':
+				capture = optarg;
+				break;
+			case 'g':
+				synthetic = optarg;
+				break;
+			case 's':
+				server = optarg;
+				break;
+			case 'I':
+				sc_name = optarg;
+				break;
+			case 'd':
+				dir = optarg;
+				break;
+			case 'l':
+				logdir = optarg;
+				break;
+			case 'n':
+				cycles = atoi(optarg);
+				if (cycles <= 0)
+					errflg = 1;
+				break;
+			case 'o':
+				outfile = optarg;
+				break;
+			default:
+				errflg = 1;
+		}
+
+	if (errflg || (capture != NULL && synthetic != NULL) ||
+		(capture == NULL && (argc - optind) != 1) ||
+		(capture != NULL && (argc - optind) != 0)) {
+		fprintf(stderr, "Usage: pbs_sched_replay -c snapshot [-s server]\n");
+		fprintf(stderr, "       pbs_sched_replay -g nodes,jobs,resources snapshot\n");
+		fprintf(stderr, "       pbs_sched_replay [-I sched_name] [-d sched_priv] [-l log_dir]\n"
+			"                        [-n cycles | -b iterations] [-o decisions_file] snapshot\n");
+		fprintf(stderr, "       pbs_sched_replay --version\n");
+		exit(1);
+	}
+
+	/* pbs.conf is only needed to find the server and $PBS_EXEC */
+	if (pbs_loadconf(0) <= 0 && capture != NULL)
+		exit(1);
+
+	if (capture != NULL)
+		return capture_snapshot(server, capture);
+	if (synthetic != NULL)
+		return gen_snapshot(synthetic, argv[optind]);
+
+	if (load_snapshot(argv[optind]) != 0)
+		exit(1);
+
+	out = stdout;
+	if (outfile != NULL && (out = fopen(outfile, "w")) == NULL) {
+		perror(outfile);
+		exit(1);
+	}
+
+	if (sc_name == NULL) {
+		sc_name = PBS_DFLT_SCHED_NAME;
+		dflt_sched = 1;
+	}
+
+	if (dir != NULL && chdir(dir) == -1) {
+		perror(dir);
+		exit(1);
+	}
+	if (logdir != NULL && log_open(NULL, logdir) == -1) {
+		fprintf(stderr, "Can't open the log in %s\n", logdir);
+		exit(1);
+	}
+
+	pbs_client_thread_set_single_threaded_mode();
+	if (pbs_client_thread_init_thread_context() != 0) {
+		fprintf(stderr, "Can't initialize the thread context\n");
+		exit(1);
+	}
+
+	/* there is no server to send us commands during the cycle */
+	second_connection = -1;
+	replay_ifl();
+
+	if (schedinit() != 0) {
+		fprintf(stderr, "Can't initialize the scheduler\n");
+		exit(1);
+	}
+
+	if (iterations > 0) {
+		errflg = run_bench(iterations);
+		schedule(SCH_QUIT, REPLAY_SD, NULL);
+		if (logdir != NULL)
+			log_close(1);
+		if (out != stdout)
+			fclose(out);
+		return errflg;
+	}
+
+	for (i = 0; i < cycles; i++) {
+		fprintf(out, "# cycle %d\n", i + 1);
+		gettimeofday(&t1, NULL);
+		schedule(i == 0 ? SCH_SCHEDULE_FIRST : SCH_SCHEDULE_NEW, REPLAY_SD, NULL);
+		gettimeofday(&t2, NULL);
+		fprintf(out, "# cycle %d took %.6f seconds\n", i + 1,
+			(t2.tv_sec - t1.tv_sec) + (t2.tv_usec - t1.tv_usec) / 1000000.0);
+	}
+
+	fprintf(out, "# phases %s\n", cycle_stats_str(buf, sizeof(buf)));
+
+	schedule(SCH_QUIT, REPLAY_SD, NULL);
+	if (logdir != NULL)
+		log_close(1);
+	if (out != stdout)
+		fclose(out);
+
+	return 0;
+}
@@ -1410,6 +1410,7 @@ main(int argc, char *argv[])
 			__func__, log_buffer);
 		exit(1);
 	}
+	(void)load_warm_cache();
 
 #ifndef	DEBUG
 #ifndef WIN32
@@ -1621,6 +1622,7 @@ main(int argc, char *argv[])
 #endif
 }
 
+	(void)save_warm_cache();
 	sprintf(log_buffer, "%s normal finish pid %d", argv[0], pid);
 	log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, __func__, log_buffer);
 
@@ -129,6 +129,10 @@ query_queues(status *policy, int pbs_sd, server_info *sinfo)
 	/* peer server descriptor */
 	int peer_sd = 0;
 
+	/* remote_queue@remote_server of a peer queue read from the cache */
+	char peer_key[PBS_MAXQUEUENAME + PBS_MAXSERVERNAME + 2];
+	char *peer_qname;
+
 	int i, j, qidx;
 	int num_queues = 0;
 
@@ -147,8 +151,9 @@ query_queues(status *policy, int pbs_sd, server_info *sinfo)
 	if(sch_err == NULL)
 		return NULL;
 
-	/* get queue info from PBS server */
-	if ((queues = pbs_statque(pbs_sd, NULL, NULL, NULL)) == NULL) {
+	/* get queue info from PBS server, it leaves out those of other partitions */
+	queues = pbs_statque(pbs_sd, NULL, NULL, partition_extend(sinfo->partitions));
+	if (queues == NULL && pbs_errno != PBSE_NONE) {
 		errmsg = pbs_geterrmsg(pbs_sd);
 		if (errmsg == NULL)
 			errmsg = "";	
@@ -233,10 +238,19 @@ query_queues(status *policy, int pbs_sd, server_info *sinfo)
 					int peer_on = 1;
 
 					if (!strcmp(conf.peer_queues[j].local_queue, qinfo->name)) {
+						peer_qname = conf.peer_queues[j].remote_queue;
 						/* Locally-peered queues reuse the scheduler's connection */
 						if (conf.peer_queues[j].remote_server == NULL) {
 							peer_sd = pbs_sd;
 						}
+						/* the jobs of the peer are refreshed between cycles */
+						else if (conf.peer_query_refresh > 0) {
+							snprintf(peer_key, sizeof(peer_key), "%s@%s",
+								conf.peer_queues[j].remote_queue,
+								conf.peer_queues[j].remote_server);
+							peer_qname = peer_key;
+							peer_sd = -1;
+						}
 						else if ((peer_sd = pbs_connect_noblk(conf.peer_queues[j].remote_server, 2)) < 0) {
 							/* Message was PBSEVENT_SCHED - moved to PBSEVENT_DEBUG2 for
 							 * failover reasons (see bz3002)
@@ -250,7 +264,7 @@ query_queues(status *policy, int pbs_sd, server_info *sinfo)
 								conf.peer_queues[j].peer_sd = peer_sd;
 								qinfo->is_peer_queue = 1;
 								/* get peered jobs */
-								qinfo->jobs = query_jobs(policy, peer_sd, qinfo, qinfo->jobs, conf.peer_queues[j].remote_queue);
+								qinfo->jobs = query_jobs(policy, peer_sd, qinfo, qinfo->jobs, peer_qname);
 						}
 					}
 				}
@@ -976,13 +990,23 @@ dup_queue_info(queue_info *oqinfo, server_info *nsinfo)
 		nqinfo->running_jobs = resource_resv_filter(nqinfo->jobs,
 			nqinfo->sc.total, check_run_job, NULL, 0);
 
+	/* map the subsets over to the new nodes rather than refiltering all */
+	/* of the server's nodes by name for every queue */
+#ifdef NAS /* localmod 049 */
+	if (oqinfo->nodes != NULL)
+		nqinfo->nodes = copy_node_ptr_array(oqinfo->nodes, nsinfo->nodes, nsinfo);
+
+	if (oqinfo->nodes_in_partition != NULL)
+		nqinfo->nodes_in_partition = copy_node_ptr_array(oqinfo->nodes_in_partition,
+			nsinfo->nodes, nsinfo);
+#else
 	if (oqinfo->nodes != NULL)
-		nqinfo->nodes = node_filter(nsinfo->nodes, nsinfo->num_nodes,
-			node_queue_cmp, (void *) nqinfo->name, 0);
+		nqinfo->nodes = copy_node_ptr_array(oqinfo->nodes, nsinfo->nodes);
 
 	if (oqinfo->nodes_in_partition != NULL)
-		nqinfo->nodes_in_partition = node_filter(nsinfo->nodes, nsinfo->num_nodes,
-			node_partition_cmp, (void *) oqinfo->partition, 0);
+		nqinfo->nodes_in_partition = copy_node_ptr_array(oqinfo->nodes_in_partition,
+			nsinfo->nodes);
+#endif /* localmod 049 */
 
 	if (oqinfo->partition != NULL) {
 		nqinfo->partition = string_dup(oqinfo->partition);
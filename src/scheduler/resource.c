@@ -91,6 +91,8 @@
 #include "sort.h"
 #include "parse.h"
 #include "limits_if.h"
+#include "formula.h"
+#include "node_info.h"
 
 
 
@@ -218,6 +220,11 @@ query_resources(int pbs_sd)
 		free_resdef_array(defarr);
 		return NULL;
 	}
+
+	/* used by find_resource() to index resource lists */
+	for (i = 0; defarr[i] != NULL; i++)
+		defarr[i]->ind = i;
+
 	return defarr;
 }
 
@@ -324,6 +331,7 @@ new_resdef(void)
 	}
 
 	newdef->name = NULL;
+	newdef->ind = -1;
 	/* calloc will have zeroed flags and the type structure */
 
 	return newdef;
@@ -574,6 +582,8 @@ reset_global_resource_ptrs(void)
 		boolres = NULL;
 	}
 	update_sorting_defs(SD_FREE);
+	free_formula_cache();
+	free_spec_cache();
 
 	/* The above references into this array.  We now free the memory */
 	if (allres != NULL) {
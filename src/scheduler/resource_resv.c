@@ -76,6 +76,7 @@
  * 	new_place()
  * 	free_place()
  * 	dup_place()
+ * 	share_place()
  * 	new_chunk()
  * 	dup_chunk_array()
  * 	dup_chunk()
@@ -83,6 +84,7 @@
  * 	free_chunk()
  * 	new_selspec()
  * 	dup_selspec()
+ * 	share_selspec()
  * 	free_selspec()
  * 	compare_res_to_str()
  * 	compare_non_consumable()
@@ -116,6 +118,8 @@
 #include "range.h"
 #include "simulate.h"
 
+/* resource_reqs are created by the million, see pool_alloc() */
+static obj_pool resource_req_pool = {sizeof(resource_req), 1024, NULL, 0, 0};
 
 /**
  * @brief
@@ -189,6 +193,9 @@ new_resource_resv()
 	resresv->node_set_str = NULL;
 	resresv->node_set = NULL;
 	resresv->resresv_ind = -1;
+	resresv->sort_keys = NULL;
+	resresv->num_sort_keys = 0;
+	resresv->sort_key_gen = 0;
 	resresv->run_event = NULL;
 	resresv->end_event = NULL;
 
@@ -236,14 +243,7 @@ free_resource_resv(resource_resv *resresv)
 	if (resresv->name != NULL)
 		free(resresv->name);
 
-	if (resresv->user != NULL)
-		free(resresv->user);
-
-	if (resresv->group != NULL)
-		free(resresv->group);
-
-	if (resresv->project != NULL)
-		free(resresv->project);
+	/* user, group and project are interned and are not freed */
 
 	if (resresv->nodepart_name != NULL)
 		free(resresv->nodepart_name);
@@ -284,6 +284,9 @@ free_resource_resv(resource_resv *resresv)
 	if (resresv->node_set != NULL)
 		free(resresv->node_set);
 
+	if (resresv->sort_keys != NULL)
+		free(resresv->sort_keys);
+
 	/* Avoid dangling pointers inside the calendar */
 	if (resresv->run_event != NULL)
 		delete_event(resresv->server, resresv->run_event);
@@ -379,13 +382,13 @@ dup_resource_resv(resource_resv *oresresv,
 	nresresv->server = nsinfo;
 
 	nresresv->name = string_dup(oresresv->name);
-	nresresv->user = string_dup(oresresv->user);
-	nresresv->group = string_dup(oresresv->group);
-	nresresv->project = string_dup(oresresv->project);
+	nresresv->user = oresresv->user;
+	nresresv->group = oresresv->group;
+	nresresv->project = oresresv->project;
 
 	nresresv->nodepart_name = string_dup(oresresv->nodepart_name);
-	nresresv->select = dup_selspec(oresresv->select);
-	nresresv->execselect = dup_selspec(oresresv->execselect);
+	nresresv->select = share_selspec(oresresv->select);
+	nresresv->execselect = share_selspec(oresresv->execselect);
 
 	nresresv->is_invalid = oresresv->is_invalid;
 	nresresv->can_not_fit = oresresv->can_not_fit;
@@ -411,7 +414,7 @@ dup_resource_resv(resource_resv *oresresv,
 
 	nresresv->resreq = dup_resource_req_list(oresresv->resreq);
 
-	nresresv->place_spec = dup_place(oresresv->place_spec);
+	nresresv->place_spec = share_place(oresresv->place_spec);
 
 	nresresv->aoename = string_dup(oresresv->aoename);
 	nresresv->eoename = string_dup(oresresv->eoename);
@@ -917,12 +920,10 @@ new_resource_req()
 {
 	resource_req *resreq;
 
-	if ((resreq = (resource_req *) calloc(1, sizeof(resource_req))) == NULL) {
-		log_err(errno, __func__, MEM_ERR_MSG);
+	if ((resreq = pool_alloc(&resource_req_pool)) == NULL)
 		return NULL;
-	}
 
-	/* member type zero'd by calloc() */
+	/* member type zero'd by pool_alloc() */
 
 	resreq->name = NULL;
 	resreq->res_str = NULL;
@@ -1288,7 +1289,7 @@ free_resource_req(resource_req *req)
 	if (req->res_str != NULL)
 		free(req->res_str);
 
-	free(req);
+	pool_free(&resource_req_pool, req);
 }
 
 /**
@@ -1842,6 +1843,7 @@ new_place()
 	pl->exclhost = 0;
 
 	pl->group = NULL;
+	pl->refct = 1;
 
 	return pl;
 }
@@ -1849,6 +1851,7 @@ new_place()
 /**
  * @brief
  *		free_place - free a placement spec
+ *		The spec is only freed when its last reference is dropped
  *
  * @param[in,out]	pl	-	the placement spec to free
  *
@@ -1861,6 +1864,9 @@ free_place(place *pl)
 	if (pl == NULL)
 		return;
 
+	if (--pl->refct > 0)
+		return;
+
 	if (pl->group != NULL)
 		free(pl->group);
 
@@ -1902,6 +1908,26 @@ dup_place(place *pl)
 	return newpl;
 }
 
+/**
+ * @brief
+ *		share_place - take another reference to a place structure
+ *
+ * @par	Like a selspec, a place is not modified once it has been parsed.
+ *	Callers that modify it must use dup_place() instead.
+ *
+ * @param[in]	pl	-	the place structure to share
+ *
+ * @return	pl
+ */
+place *
+share_place(place *pl)
+{
+	if (pl != NULL)
+		pl->refct++;
+
+	return pl;
+}
+
 /**
  * @brief
  *		new_chunk - constructor for chunk
@@ -2068,6 +2094,7 @@ new_selspec()
 	spec->total_cpus = 0;
 	spec->defs = NULL;
 	spec->chunks = NULL;
+	spec->refct = 1;
 
 	return spec;
 }
@@ -2107,9 +2134,33 @@ dup_selspec(selspec *oldspec)
 	return newspec;
 }
 
+/**
+ * @brief
+ *		share_selspec - take another reference to a selspec
+ *
+ * @par	A selspec is never modified once it has been parsed.  Callers that
+ *	only need to read it (e.g. dup_resource_resv() when copying the universe
+ *	for simulation or preemption) can share the original instead of paying
+ *	for a deep copy of every chunk.  Callers that modify the chunks must
+ *	use dup_selspec() instead.
+ *
+ * @param[in]	spec	-	selspec to share
+ *
+ * @return	spec
+ */
+selspec *
+share_selspec(selspec *spec)
+{
+	if (spec != NULL)
+		spec->refct++;
+
+	return spec;
+}
+
 /**
  * @brief
  *		free_selspec - destructor for selspec
+ *		The spec is only freed when its last reference is dropped
  *
  * @param[in,out]	spec	-	selspec to be freed.
  */
@@ -2119,6 +2170,9 @@ free_selspec(selspec *spec)
 	if (spec == NULL)
 		return;
 
+	if (--spec->refct > 0)
+		return;
+
 	if (spec->defs != NULL)
 		free(spec->defs);
 
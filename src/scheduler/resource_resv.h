@@ -265,6 +265,11 @@ void free_place(place *pl);
  */
 place *dup_place(place *pl);
 
+/*
+ *	share_place - take another reference to a place structure
+ */
+place *share_place(place *pl);
+
 /*
  *	compare_res_to_str - compare a resource structure of type string to
  *			     a character array string
@@ -329,6 +334,11 @@ selspec *new_selspec();
  */
 selspec *dup_selspec(selspec *oldspec);
 
+/*
+ *	share_selspec - take another reference to a selspec
+ */
+selspec *share_selspec(selspec *spec);
+
 /*
  *	free_selspec - destructor for selspec
  */
@@ -50,6 +50,7 @@
  *	new_resv_info()
  *	free_resv_info()
  *	dup_resv_info()
+ *	add_confirmed_resv_to_sim()
  *	check_new_reservations()
  *	disable_reservation_occurrence()
  *	confirm_reservation()
@@ -235,6 +236,17 @@ query_reservations(server_info *sinfo, struct batch_status *resvs)
 
 		/* reservations requesting AOE mark nodes as exclusive */
 		if (resresv->aoename) {
+			place *pl;
+
+			/* parse_placespec() may have handed out a shared spec */
+			if ((pl = dup_place(resresv->place_spec)) == NULL) {
+				free_resource_resv_array(resresv_arr);
+				free_resource_resv(resresv);
+				free_schd_error(err);
+				return NULL;
+			}
+			free_place(resresv->place_spec);
+			resresv->place_spec = pl;
 			resresv->place_spec->share = 0;
 			resresv->place_spec->excl = 1;
 		}
@@ -376,6 +388,8 @@ query_reservations(server_info *sinfo, struct batch_status *resvs)
 				char **execvnode_ptr = NULL;
 				char **tofree = NULL;
 				resource_resv **tmp = NULL;
+				time_t *occr_times = NULL; /* start times of the remaining occurrences */
+				char *prev_xc = NULL; /* execvnode of the previous duplicated occurrence */
 				time_t dtstart;
 				time_t next;
 				char *rrule = NULL;
@@ -450,6 +464,22 @@ query_reservations(server_info *sinfo, struct batch_status *resvs)
 				dtstart = resresv->resv->req_start;
 				tz = resresv->resv->timezone;
 
+				/* Compute the start times of all remaining occurrences at once
+				 * rather than walking the recurrence again for each of them
+				 */
+				occr_times = malloc(sizeof(time_t) *
+					(count >= occr_idx ? count - occr_idx + 1 : 1));
+				if (occr_times == NULL) {
+					log_err(errno, "query_reservations", MEM_ERR_MSG);
+					free_resource_resv_array(resresv_arr);
+					free_execvnode_seq(tofree);
+					free(execvnodes_seq);
+					free(execvnode_ptr);
+					free_schd_error(err);
+					return NULL;
+				}
+				get_occurrences(rrule, dtstart, tz, count - occr_idx + 1, occr_times);
+
 				/* Do not attempt to re-confirm a degraded reservations with a
 				 * retry time in the past that is currently in state running */
 				if (resresv->resv->resv_state == RESV_RUNNING &&
@@ -466,10 +496,10 @@ query_reservations(server_info *sinfo, struct batch_status *resvs)
 					 * The server maintains state of a single reservation object for
 					 * which in the case of a standing reservation, it updates start
 					 * and end times and execvnodes.
-					 * The last argument (j+1) indicates the occurrence index from dtstart
-					 * starting at 1. Returns dtstart if it's an advance reservation.
+					 * occr_times[j] is the occurrence of index (j+1) from dtstart
+					 * starting at 1, or dtstart if it's an advance reservation.
 					 */
-					next = get_occurrence(rrule, dtstart, tz, j + 1);
+					next = occr_times[j];
 
 					/* Duplicate the "master" resv only for subsequent occurrences */
 					if (j == 0)
@@ -484,6 +514,7 @@ query_reservations(server_info *sinfo, struct batch_status *resvs)
 							free_execvnode_seq(tofree);
 							free(execvnodes_seq);
 							free(execvnode_ptr);
+							free(occr_times);
 							free_schd_error(err);
 							return NULL;
 						}
@@ -503,8 +534,23 @@ query_reservations(server_info *sinfo, struct batch_status *resvs)
 						 */
 						release_nodes(resresv_ocr);
 
-						resresv_ocr->nspec_arr = parse_execvnode(
-							execvnode_ptr[degraded_idx-1], sinfo);
+						/* Consecutive occurrences on the same execvnode share one
+						 * string in the unrolled sequence; copy the nspecs of the
+						 * previous occurrence rather than parsing it again
+						 */
+						if (execvnode_ptr[degraded_idx-1] == prev_xc &&
+							resresv_arr[idx-1]->nspec_arr != NULL)
+#ifdef NAS /* localmod 049 */
+							resresv_ocr->nspec_arr = dup_nspecs(
+								resresv_arr[idx-1]->nspec_arr, sinfo->nodes, sinfo);
+#else
+							resresv_ocr->nspec_arr = dup_nspecs(
+								resresv_arr[idx-1]->nspec_arr, sinfo->nodes);
+#endif /* localmod 049 */
+						else
+							resresv_ocr->nspec_arr = parse_execvnode(
+								execvnode_ptr[degraded_idx-1], sinfo);
+						prev_xc = execvnode_ptr[degraded_idx-1];
 						resresv_ocr->ninfo_arr
 						= create_node_array_from_nspec(resresv_ocr->nspec_arr);
 						resresv_ocr->resv->resv_nodes = create_resv_nodes(
@@ -535,6 +581,7 @@ query_reservations(server_info *sinfo, struct batch_status *resvs)
 						free_execvnode_seq(tofree);
 						free(execvnodes_seq);
 						free(execvnode_ptr);
+						free(occr_times);
 						free_schd_error(err);
 						return NULL;
 					}
@@ -548,6 +595,7 @@ query_reservations(server_info *sinfo, struct batch_status *resvs)
 				free_execvnode_seq(tofree);
 				free(execvnodes_seq);
 				free(execvnode_ptr);
+				free(occr_times);
 
 				continue;
 			} else {
@@ -599,9 +647,9 @@ query_resv(struct batch_status *resv, server_info *sinfo)
 
 	while (attrp != NULL) {
 		if (!strcmp(attrp->name, ATTR_resv_owner))
-			advresv->user = string_dup(attrp->value);
+			advresv->user = string_intern(attrp->value);
 		else if (!strcmp(attrp->name, ATTR_egroup))
-			advresv->group = string_dup(attrp->value);
+			advresv->group = string_intern(attrp->value);
 		else if (!strcmp(attrp->name, ATTR_queue))
 			advresv->resv->queuename = string_dup(attrp->value);
 		else if (!strcmp(attrp->name, ATTR_SchedSelect)) {
@@ -861,6 +909,70 @@ dup_resv_info(resv_info *rinfo, server_info *sinfo)
 	return nrinfo;
 }
 
+/**
+ * @brief
+ * 		add the occurrences of a reservation confirmed by
+ *		check_new_reservations() to the simulated universe it was confirmed
+ *		in, so that the next reservations can be confirmed in the same one
+ *
+ * @par
+ *		The simulation is at or past the start of the last occurrence, so
+ *		the occurrences which have not ended yet are run right away instead
+ *		of through their run events.
+ *
+ * @param[in]	nsinfo	-	simulated universe
+ * @param[in]	nresv	-	the reservation in nsinfo
+ * @param[in]	execvnodes	-	execvnode of each occurrence
+ * @param[in]	occr_count	-	number of occurrences
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure, nsinfo can not be used for another reservation
+ */
+static int
+add_confirmed_resv_to_sim(server_info *nsinfo, resource_resv *nresv, char **execvnodes, int occr_count)
+{
+	resource_resv *occr;
+	timed_event *te;
+	int j;
+
+	for (j = 0; j < occr_count; j++) {
+		if (j == 0)
+			occr = nresv;
+		else if ((occr = find_resource_resv_by_time(nsinfo->all_resresv,
+			nresv->name, nresv->resv->occr_start_arr[j])) == NULL)
+			return 0;
+
+		occr->start = nresv->resv->occr_start_arr[j];
+		occr->end = occr->start + occr->duration;
+		occr->resv->resv_state = RESV_CONFIRMED;
+		occr->resv->resv_substate = RESV_CONFIRMED;
+		if (occr->end <= nsinfo->server_time)
+			continue;
+
+		release_nodes(occr);
+		occr->nspec_arr = parse_execvnode(execvnodes[j], nsinfo);
+		occr->ninfo_arr = create_node_array_from_nspec(occr->nspec_arr);
+		occr->resv->resv_nodes = create_resv_nodes(occr->nspec_arr, nsinfo);
+		if (occr->nspec_arr == NULL || occr->ninfo_arr == NULL ||
+			occr->resv->resv_nodes == NULL)
+			return 0;
+
+		if (occr->start > nsinfo->server_time) {
+			if ((te = create_event(TIMED_RUN_EVENT, occr->start, occr, NULL, NULL)) == NULL)
+				return 0;
+			add_event(nsinfo->calendar, te);
+		} else if (sim_run_update_resresv(nsinfo->policy, occr, NULL, NO_ALLPART) <= 0)
+			return 0;
+
+		if ((te = create_event(TIMED_END_EVENT, occr->end, occr, NULL, NULL)) == NULL)
+			return 0;
+		add_event(nsinfo->calendar, te);
+	}
+
+	return 1;
+}
+
 /**
  * @brief
  * 		check for new reservations and handle them
@@ -876,6 +988,12 @@ dup_resv_info(resv_info *rinfo, server_info *sinfo)
  * 		for it. If it fails then we inform the server that the reconfirmation has
  * 		failed. If it succeeds, then the previously allocated resources are freed
  * 		from the real universe and replaced by the newly allocated resources.
+ * @par
+ *  	Reservations to confirm for the first time are checked in order of
+ * 		their start.  Each one which starts no earlier than where the
+ * 		simulation of the one before got to is checked in the same simulated
+ * 		universe, with the reservations confirmed before it added to it.
+ * 		Submitting many reservations at once then costs about one simulation.
  *
  * @param[in]	policy	-	policy info
  * @param[in]	pbs_sd	-	communication descriptor to PBS server
@@ -894,6 +1012,10 @@ check_new_reservations(status *policy, int pbs_sd, resource_resv **resvs, server
 	int		pbsrc = 0;	/* return code from pbs_confirmresv() */
 
 	server_info	*nsinfo = NULL;
+	server_info	*shared_sinfo = NULL;	/* simulation kept for the next resv */
+	int		shared;		/* the resv can use shared_sinfo */
+	int		keep;		/* keep nsinfo as shared_sinfo */
+	int		num_sims = 0;	/* clones of the real universe made */
 	resource_resv	*nresv = NULL;
 	resource_resv	*nresv_copy = NULL;
 	resource_resv	**tmp_resresv = NULL;
@@ -911,7 +1033,7 @@ check_new_reservations(status *policy, int pbs_sd, resource_resv **resvs, server
 	if (resvs == NULL)
 		return 0;
 
-	qsort(sinfo->resvs, sinfo->num_resvs, sizeof(resource_resv*), cmp_resv_state);
+	qsort(sinfo->resvs, sinfo->num_resvs, sizeof(resource_resv*), cmp_resv_confirm);
 
 	for (i = 0; sinfo->resvs[i] != NULL; i++) {
 
@@ -928,13 +1050,35 @@ check_new_reservations(status *policy, int pbs_sd, resource_resv **resvs, server
 		 * respectively confirmed and reconfirmed.
 		 */
 		if (will_confirm(sinfo->resvs[i], sinfo->server_time)) {
-			/* Clone the real universe for simulation scratch work. This universe
-			 * will be garbage collected after simulation completes.
+			/* A new reservation is checked in the simulation of the one before
+			 * if it does not start before where that simulation got to.  The
+			 * others change the real universe in ways the shared simulation
+			 * does not know about, so it is dropped.
 			 */
-			nsinfo = dup_server_info(sinfo);
+			shared = sinfo->resvs[i]->resv->resv_state == RESV_UNCONFIRMED &&
+				sinfo->resvs[i]->resv->resv_substate != RESV_DEGRADED &&
+				sinfo->resvs[i]->resv->resv_substate != RESV_IN_CONFLICT &&
+				sinfo->resvs[i]->resv->req_start != PBS_RESV_FUTURE_SCH;
+			if (shared_sinfo != NULL && (!shared ||
+				sinfo->resvs[i]->resv->req_start < shared_sinfo->server_time)) {
+				free_server(shared_sinfo);
+				shared_sinfo = NULL;
+			}
+			keep = 0;
 
-			if (nsinfo == NULL)
-				return -1;
+			if (shared_sinfo != NULL) {
+				nsinfo = shared_sinfo;
+				shared_sinfo = NULL;
+			} else {
+				/* Clone the real universe for simulation scratch work. This universe
+				 * will be garbage collected after simulation completes.
+				 */
+				nsinfo = dup_server_info(sinfo);
+
+				if (nsinfo == NULL)
+					return -1;
+				num_sims++;
+			}
 
 			/* Resource reservations are ordered by event time, in the case of a
 			 * standing reservation, the first to be found will be the "parent"
@@ -1096,8 +1240,12 @@ check_new_reservations(status *policy, int pbs_sd, resource_resv **resvs, server
 					nresv_copy->resv->resv_substate = RESV_CONFIRMED;
 				}
 				/* increment the count if we successfully processed all occurrences */
-				if (j == occr_count)
+				if (j == occr_count) {
 					count++;
+					if (shared)
+						keep = add_confirmed_resv_to_sim(nsinfo, nresv,
+							occr_execvnodes_arr, occr_count);
+				}
 			}
 			else if (pbsrc == RESV_CONFIRM_FAIL) {
 				/* For a degraded reservation, it had already been confirmed in a
@@ -1131,6 +1279,10 @@ check_new_reservations(status *policy, int pbs_sd, resource_resv **resvs, server
 						nresv_copy->resv->retry_time = sinfo->server_time + 1;
 					}
 				}
+				/* a rejected advance reservation leaves nothing behind in
+				 * the simulation, a standing one leaves its occurrences
+				 */
+				keep = shared && !nresv->resv->is_standing;
 			}
 			/* clean up */
 			free(nresv->resv->occr_start_arr);
@@ -1141,12 +1293,22 @@ check_new_reservations(status *policy, int pbs_sd, resource_resv **resvs, server
 			occr_execvnodes_arr = NULL;
 
 			/* Clean up simulated server info */
-			free_server(nsinfo);
+			if (keep)
+				shared_sinfo = nsinfo;
+			else
+				free_server(nsinfo);
 		}
 		/* Something went wrong with reservation confirmation, retry later */
-		if (pbsrc == RESV_CONFIRM_RETRY)
+		if (pbsrc == RESV_CONFIRM_RETRY) {
+			free_server(shared_sinfo);
 			return -1;
+		}
 	}
+	free_server(shared_sinfo);
+
+	if (count > 1)
+		log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_RESV, LOG_DEBUG, __func__,
+			"Confirmed %d reservations in %d simulations", count, num_sims);
 
 	return count;
 }
@@ -1222,7 +1384,7 @@ confirm_reservation(status *policy, int pbs_sd, resource_resv *unconf_resv, serv
 	resource_resv *nresv_parent = nresv; /* the "original" / parent reservation */
 
 	int confirmd_occr = 0;   /* the number of confirmed occurrence(s) */
-	int j, cur_count;
+	int j;
 
 	int tot_vnodes = 0;   /* total number of vnodes associated to the reservation */
 	int vnodes_down = 0;   /* the number of vnodes that are down */
@@ -1275,6 +1437,10 @@ confirm_reservation(status *policy, int pbs_sd, resource_resv *unconf_resv, serv
 		log_err(errno, "confirm_reservation", MEM_ERR_MSG);
 		return RESV_CONFIRM_FAIL;
 	}
+	/* The start times of all occurrences are computed in one walk of the
+	 * recurrence rule. See the same in query_reservations.
+	 */
+	get_occurrences(rrule, dtstart, tz, occr_count, occr_start_arr);
 
 
 	/* Each reservation attempts to confirm a set of nodes on which to run for
@@ -1294,15 +1460,9 @@ confirm_reservation(status *policy, int pbs_sd, resource_resv *unconf_resv, serv
 	 * be added to the server info such that the duplicated server info has up to
 	 * date information.
 	 */
-	for (j = 0, cur_count = 0; j < occr_count && rconf == RESV_CONFIRM_SUCCESS;
-		j++, cur_count = j) {
-		/* Get the start time of the next occurrence.
-		 * See call to same function in query_reservations for a more in-depth
-		 * description.
-		 */
-		next = get_occurrence(rrule, dtstart, tz, j+1);
-		/* keep track of each occurrence's start time */
-		occr_start_arr[j] = next;
+	for (j = 0; j < occr_count && rconf == RESV_CONFIRM_SUCCESS; j++) {
+		/* Get the start time of the next occurrence */
+		next = occr_start_arr[j];
 
 		/* Processing occurrences of a standing reservation requires duplicating
 		 * the "parent" reservation as template for each occurrence, modifying its
@@ -1567,15 +1727,10 @@ confirm_reservation(status *policy, int pbs_sd, resource_resv *unconf_resv, serv
 				"Reservation is in degraded mode, %d out of %d vnodes are unavailable; %s",
 				vnodes_down, tot_vnodes, names_of_down_vnodes);
 
-			/* we failed to confirm the degraded reservation but we still need to
-			 * set the remaining occurrences start time to avoid looking at them
-			 * in the future. We had set the occr_start_arr times in the main loop
-			 * so we only care about the remaining ones
+			/* we failed to confirm the degraded reservation but the remaining
+			 * occurrences keep the start times set in occr_start_arr up front,
+			 * to avoid looking at them in the future
 			 */
-			for (; cur_count < occr_count; cur_count++) {
-				next = get_occurrence(rrule, dtstart, tz, cur_count + 1);
-				occr_start_arr[cur_count] = next;
-			}
 		}
 	}
 	/* If the (re)confirmation was a success then we update the sequence of
@@ -45,11 +45,17 @@
  * Functions included are:
  * 	query_server()
  * 	query_server_info()
+ * 	run_dyn_res_cmd()
+ * 	dyn_res_worker()
+ * 	dyn_res_pool_update()
+ * 	dyn_res_cached()
  * 	query_server_dyn_res()
  * 	query_sched_obj()
  * 	find_alloc_resource()
  * 	find_alloc_resource_by_str()
  * 	find_resource_by_str()
+ * 	build_resource_index()
+ * 	reset_resource_index()
  * 	find_resource()
  * 	free_server_info()
  * 	free_resource_list()
@@ -82,6 +88,10 @@
  * 	free_counts_list()
  * 	dup_counts()
  * 	dup_counts_list()
+ * 	counts_name_hash()
+ * 	counts_index_add()
+ * 	update_counts_index()
+ * 	reset_counts_index()
  * 	find_counts()
  * 	find_alloc_counts()
  * 	update_counts_on_run()
@@ -114,6 +124,15 @@
 #include <string.h>
 #include <errno.h>
 #include <ctype.h>
+#include <time.h>
+#ifndef WIN32
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
 #include <pbs_ifl.h>
 #include <pbs_error.h>
 #include <log.h>
@@ -148,6 +167,9 @@
 #include "site_code.h"
 #endif
 
+/* schd_resources are created by the million, see pool_alloc() */
+static obj_pool schd_resource_pool = {sizeof(schd_resource), 1024, NULL, 0, 0};
+
 
 /**
  *	@brief
@@ -276,6 +298,11 @@ query_server(status *pol, int pbs_sd)
 		qsort(sinfo->nodes, sinfo->num_nodes, sizeof(node_info *),
 			multi_node_sort);
 
+	/* Positions in sinfo->nodes become node_inds below.  If the index
+	 * can't be created, find_node_info() searches the nodes instead.
+	 */
+	sinfo->node_idx = create_node_name_index(sinfo->nodes);
+
 	/* get the queues */
 	if ((sinfo->queues = query_queues(policy, pbs_sd, sinfo)) == NULL) {
 		pbs_statfree(server);
@@ -668,10 +695,376 @@ query_server_info(status *pol, struct batch_status *server)
 	return sinfo;
 }
 
+#ifndef WIN32
+/*
+ * server_dyn_res values refreshed by a background thread when
+ * server_dyn_res_refresh is set.  The cycle runs a script itself only the
+ * first time it is seen and then reads the last value the thread got.
+ * The entries hold their own copies of the command lines, conf is rebuilt
+ * on reconfigure while the thread may be running a script.
+ */
+struct dyn_res_ent {
+	char *command_line;
+	char value[256];		/* first line of the last successful run */
+	time_t good_time;		/* when value was read, 0 if never */
+	int last_err;			/* errno of the last run, 0 if it succeeded */
+	time_t next_run;		/* when the thread runs it next */
+	int seeded;			/* the cycle ran it once */
+	int running;			/* the thread is running it */
+};
+struct dyn_res_pool {
+	pthread_mutex_t lock;
+	pthread_cond_t cv;		/* signaled when the entries change */
+	pthread_t tid;
+	pid_t pid;			/* process the thread was started in */
+	int started;
+	unsigned long gen;		/* bumped when the entries are rebuilt */
+	int refresh;			/* copy of conf.dyn_res_refresh */
+	int timeout;			/* copy of conf.dyn_res_timeout */
+	int num;
+	struct dyn_res_ent ent[MAX_SERVER_DYN_RES];
+};
+static struct dyn_res_pool drpool = {
+	PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER
+};
+
+/**
+ * @brief
+ * 		run a server_dyn_res program and read the first line of its output
+ *
+ * @param[in]	cmd	-	command line, run by /bin/sh
+ * @param[in]	timeout	-	seconds the program may run, 0 for no limit
+ * @param[out]	buf	-	output
+ * @param[in]	len	-	size of buf
+ * @param[out]	errnum	-	errno on failure, ETIMEDOUT if the program was killed
+ *
+ * @par	This may be called from the server_dyn_res thread, so it does not log.
+ *	The program is run in its own process group so that everything it
+ *	started is killed on timeout.
+ *
+ * @return	int
+ * @retval	number of bytes read into buf
+ * @retval	0	: on error
+ */
+static int
+run_dyn_res_cmd(char *cmd, int timeout, char *buf, int len, int *errnum)
+{
+	int fd[2];
+	int k = 0;
+	int rc;
+	int status;
+	pid_t pid;
+	time_t deadline;
+	struct pollfd pfd;
+
+	*errnum = 0;
+	buf[0] = '\0';
+	deadline = timeout > 0 ? time(NULL) + timeout : 0;
+
+	if (pipe(fd) == -1) {
+		*errnum = errno;
+		return 0;
+	}
+	if ((pid = fork()) == -1) {
+		*errnum = errno;
+		close(fd[0]);
+		close(fd[1]);
+		return 0;
+	}
+	if (pid == 0) {
+		setpgid(0, 0);
+		close(fd[0]);
+		if (fd[1] != STDOUT_FILENO) {
+			dup2(fd[1], STDOUT_FILENO);
+			close(fd[1]);
+		}
+		execl("/bin/sh", "sh", "-c", cmd, (char *) NULL);
+		_exit(127);
+	}
+	close(fd[1]);
+
+	pfd.fd = fd[0];
+	pfd.events = POLLIN;
+	while (k < len - 1) {
+		int wait_ms = -1;
+
+		if (deadline) {
+			time_t now = time(NULL);
+			if (now >= deadline) {
+				*errnum = ETIMEDOUT;
+				break;
+			}
+			wait_ms = (deadline - now) * 1000;
+		}
+		rc = poll(&pfd, 1, wait_ms);
+		if (rc == -1 && errno == EINTR)
+			continue;
+		if (rc == -1) {
+			*errnum = errno;
+			break;
+		}
+		if (rc == 0)
+			continue;	/* deadline is checked at the top */
+		rc = read(fd[0], buf + k, len - 1 - k);
+		if (rc == -1 && errno == EINTR)
+			continue;
+		if (rc <= 0) {
+			if (rc == -1)
+				*errnum = errno;
+			break;
+		}
+		k += rc;
+		buf[k] = '\0';
+		if (strchr(buf, '\n') != NULL)
+			break;
+	}
+	close(fd[0]);
+
+	/* like pclose(), wait for the program, but no longer than the timeout.
+	 * A program that already wrote its line is not failed for lingering.
+	 */
+	while ((rc = waitpid(pid, &status, deadline ? WNOHANG : 0)) == 0) {
+		if (*errnum == ETIMEDOUT || time(NULL) >= deadline) {
+			if (k == 0)
+				*errnum = ETIMEDOUT;
+			kill(-pid, SIGKILL);
+			kill(pid, SIGKILL);
+			waitpid(pid, &status, 0);
+			break;
+		}
+		usleep(10000);
+	}
+
+	if (*errnum != 0)
+		return 0;
+	if (k > 0) {
+		char *nl = strchr(buf, '\n');
+		if (nl != NULL)
+			nl[1] = '\0';
+		k = strlen(buf);
+	}
+
+	return k;
+}
+
+/**
+ * @brief
+ * 		main loop of the server_dyn_res refresh thread
+ *
+ * @param[in]	arg	-	unused
+ *
+ * @return	NULL
+ */
+static void *
+dyn_res_worker(void *arg)
+{
+	int i;
+	int k;
+	int err;
+	char *cmd;
+	unsigned long gen;
+	char buf[256];
+	struct timespec ts;
+
+	pthread_mutex_lock(&drpool.lock);
+	while (drpool.refresh > 0) {
+		time_t now = time(NULL);
+		time_t next = 0;
+		int run = -1;
+
+		for (i = 0; i < drpool.num; i++) {
+			struct dyn_res_ent *ent = &drpool.ent[i];
+			if (!ent->seeded || ent->running)
+				continue;
+			if (ent->next_run <= now) {
+				run = i;
+				break;
+			}
+			if (next == 0 || ent->next_run < next)
+				next = ent->next_run;
+		}
+
+		if (run == -1) {
+			if (next == 0)
+				pthread_cond_wait(&drpool.cv, &drpool.lock);
+			else {
+				ts.tv_sec = next;
+				ts.tv_nsec = 0;
+				pthread_cond_timedwait(&drpool.cv, &drpool.lock, &ts);
+			}
+			continue;
+		}
+
+		if ((cmd = strdup(drpool.ent[run].command_line)) == NULL) {
+			drpool.ent[run].next_run = now + drpool.refresh;
+			continue;
+		}
+		drpool.ent[run].running = 1;
+		gen = drpool.gen;
+		pthread_mutex_unlock(&drpool.lock);
+
+		k = run_dyn_res_cmd(cmd, drpool.timeout, buf, sizeof(buf), &err);
+		free(cmd);
+
+		pthread_mutex_lock(&drpool.lock);
+		if (drpool.gen != gen)
+			continue;	/* the entries were rebuilt while it ran */
+		drpool.ent[run].running = 0;
+		drpool.ent[run].last_err = err;
+		if (k > 0) {
+			strcpy(drpool.ent[run].value, buf);
+			drpool.ent[run].good_time = time(NULL);
+		} else if (err == 0)
+			drpool.ent[run].last_err = EIO;	/* no output */
+		drpool.ent[run].next_run = time(NULL) + drpool.refresh;
+	}
+	drpool.started = 0;
+	pthread_mutex_unlock(&drpool.lock);
+
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		bring the server_dyn_res cache in line with conf and make sure the
+ *		refresh thread is running
+ *
+ * @par	The thread is started lazily because the scheduler forks after it
+ *	reads its configuration and threads do not survive a fork.  It exits
+ *	once server_dyn_res_refresh is unset.
+ *
+ * @return	void
+ */
+static void
+dyn_res_pool_update(void)
+{
+	int i;
+	int num;
+	int changed = 0;
+	sigset_t allsigs;
+	sigset_t oldsigs;
+
+	for (num = 0; num < MAX_SERVER_DYN_RES && conf.dynamic_res[num].res != NULL; num++)
+		;
+
+	pthread_mutex_lock(&drpool.lock);
+	if (drpool.pid != getpid()) {
+		drpool.started = 0;
+		drpool.pid = getpid();
+	}
+
+	if (num != drpool.num)
+		changed = 1;
+	for (i = 0; !changed && i < num; i++)
+		if (strcmp(drpool.ent[i].command_line, conf.dynamic_res[i].command_line))
+			changed = 1;
+	if (changed || drpool.refresh != conf.dyn_res_refresh) {
+		for (i = 0; i < drpool.num; i++)
+			free(drpool.ent[i].command_line);
+		memset(drpool.ent, 0, sizeof(drpool.ent));
+		drpool.num = 0;
+		for (i = 0; i < num; i++) {
+			if ((drpool.ent[i].command_line = string_dup(conf.dynamic_res[i].command_line)) == NULL)
+				break;
+			drpool.num++;
+		}
+		drpool.gen++;
+	}
+	drpool.refresh = conf.dyn_res_refresh;
+	drpool.timeout = conf.dyn_res_timeout;
+	pthread_cond_broadcast(&drpool.cv);
+
+	if (drpool.started || drpool.refresh <= 0) {
+		pthread_mutex_unlock(&drpool.lock);
+		return;
+	}
+
+	/* signals are for the main thread only */
+	sigfillset(&allsigs);
+	pthread_sigmask(SIG_BLOCK, &allsigs, &oldsigs);
+	if (pthread_create(&drpool.tid, NULL, dyn_res_worker, NULL) != 0)
+		log_err(errno, __func__, "Failed to create server_dyn_res thread");
+	else {
+		pthread_detach(drpool.tid);
+		drpool.started = 1;
+		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"Started server_dyn_res refresh thread");
+	}
+	pthread_sigmask(SIG_SETMASK, &oldsigs, NULL);
+	pthread_mutex_unlock(&drpool.lock);
+}
+
+/**
+ * @brief
+ * 		get the value of a server_dyn_res from the cache
+ *
+ * @param[in]	i	-	index into conf.dynamic_res
+ * @param[out]	buf	-	value
+ * @param[in]	len	-	size of buf
+ * @param[out]	errnum	-	errno of the last run, ESTALE if the value is
+ *				older than server_dyn_res_stale
+ *
+ * @par	A server_dyn_res the refresh thread has not run yet is run in the
+ *	calling thread.  If the last run failed, the last good value is used
+ *	until it becomes stale.  Without server_dyn_res_stale, a failure
+ *	sets the resource to 0 like a synchronous run does.
+ *
+ * @return	int
+ * @retval	number of bytes in buf
+ * @retval	0	: no usable value
+ */
+static int
+dyn_res_cached(int i, char *buf, int len, int *errnum)
+{
+	int k;
+	struct dyn_res_ent *ent;
+
+	*errnum = 0;
+	buf[0] = '\0';
+	if (i >= drpool.num)
+		return run_dyn_res_cmd(conf.dynamic_res[i].command_line,
+			conf.dyn_res_timeout, buf, len, errnum);
+
+	ent = &drpool.ent[i];
+	if (!ent->seeded) {
+		/* the thread skips entries that are not seeded, so this is ours */
+		k = run_dyn_res_cmd(ent->command_line, drpool.timeout, buf, len, errnum);
+		pthread_mutex_lock(&drpool.lock);
+		ent->last_err = *errnum;
+		if (k > 0) {
+			snprintf(ent->value, sizeof(ent->value), "%s", buf);
+			ent->good_time = time(NULL);
+		}
+		ent->next_run = time(NULL) + drpool.refresh;
+		ent->seeded = 1;
+		pthread_cond_broadcast(&drpool.cv);
+		pthread_mutex_unlock(&drpool.lock);
+		return k;
+	}
+
+	pthread_mutex_lock(&drpool.lock);
+	if (ent->good_time == 0 || (ent->last_err != 0 && conf.dyn_res_stale <= 0))
+		*errnum = ent->last_err;
+	else if (conf.dyn_res_stale > 0 && time(NULL) - ent->good_time > conf.dyn_res_stale)
+		*errnum = ESTALE;
+	else
+		snprintf(buf, len, "%s", ent->value);
+	pthread_mutex_unlock(&drpool.lock);
+
+	if (*errnum == EIO)
+		*errnum = 0;	/* no output, logged as such */
+
+	return strlen(buf);
+}
+#endif /* WIN32 */
+
 /**
  * @brief
  * 		execute all configured server_dyn_res scripts
  *
+ * @par	With server_dyn_res_refresh set, the values are read from the cache
+ *	kept by the refresh thread instead, see dyn_res_cached().
+ *
  * @param[in]	sinfo	-	server info
  *
  * @retval	0	: on success
@@ -685,10 +1078,11 @@ query_server_dyn_res(server_info *sinfo)
 	char res_zero[] = "0";	/* dynamic res failure implies resource <-0 */
 	char buf[256];		/* buffer for reading from pipe */
 	schd_resource *res;		/* used for updating node resources */
-	FILE *fp;			/* for popen() for res_assn */
 #ifdef WIN32
 	struct  pio_handles	  pio;  /* for win_popen() for res_assn */
 	char			  cmd_line[512];
+#else
+	dyn_res_pool_update();
 #endif
 
 	for (i = 0; (i < MAX_SERVER_DYN_RES) && (conf.dynamic_res[i].res != NULL); i++) {
@@ -727,14 +1121,11 @@ query_server_dyn_res(server_info *sinfo)
 			if (pio.hReadPipe_out != INVALID_HANDLE_VALUE) /* did win_popen() succeed? */
 				win_pclose(&pio);
 #else
-			if (((fp = popen(conf.dynamic_res[i].command_line, "r")) == NULL) ||
-				(fgets(buf, 256, fp) == NULL)) {
-				pipe_err = errno;
-				k = 0;
-			} else
-				k = strlen(buf);
-			if (fp != NULL)
-				pclose(fp);
+			if (conf.dyn_res_refresh > 0)
+				k = dyn_res_cached(i, buf, sizeof(buf), &pipe_err);
+			else
+				k = run_dyn_res_cmd(conf.dynamic_res[i].command_line,
+					conf.dyn_res_timeout, buf, sizeof(buf), &pipe_err);
 #endif
 			if (k > 0) {
 				buf[k] = '\0';
@@ -751,7 +1142,13 @@ query_server_dyn_res(server_info *sinfo)
 					(void) set_resource(res, res_zero, RF_AVAIL);
 				}
 			} else {
-				if (pipe_err != 0)
+				if (pipe_err == ETIMEDOUT)
+					log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
+						"Program %s did not finish in %d seconds", conf.dynamic_res[i].command_line, conf.dyn_res_timeout);
+				else if (pipe_err == ESTALE)
+					log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
+						"Last value from program %s is older than %d seconds", conf.dynamic_res[i].command_line, conf.dyn_res_stale);
+				else if (pipe_err != 0)
 					log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res", 
 						"Can't pipe to program %s: %s", conf.dynamic_res[i].command_line, strerror(pipe_err));
 
@@ -970,8 +1367,10 @@ find_alloc_resource(schd_resource *resplist, resdef *def)
 		resp->type = def->type;
 		resp->name = def->name;
 
-		if (prev != NULL)
+		if (prev != NULL) {
 			prev->next = resp;
+			reset_resource_index(resplist);
+		}
 	}
 
 	return resp;
@@ -1008,8 +1407,10 @@ find_alloc_resource_by_str(schd_resource *resplist, char *name)
 		if ((resp = create_resource(name, NULL, RF_NONE)) == NULL)
 			return NULL;
 
-		if (prev != NULL)
+		if (prev != NULL) {
 			prev->next = resp;
+			reset_resource_index(resplist);
+		}
 	}
 
 	return resp;
@@ -1042,10 +1443,75 @@ find_resource_by_str(schd_resource *reslist, const char *name)
 
 	return resp;
 }
+
+/**
+ * @brief
+ * 		index a resource list by resdef ordinal.  The index is kept on the
+ *		head of the list.  Lists shorter than RES_INDEX_MIN_LEN are marked
+ *		as not worth indexing.
+ *
+ * @param[in,out]	reslist	-	head of the resource list
+ *
+ * @par MT-safe: only if no other thread uses reslist
+ *
+ * @return	void
+ */
+static void
+build_resource_index(schd_resource *reslist)
+{
+	schd_resource *resp;
+	int len = 0;
+	int max_ind = -1;
+
+	for (resp = reslist; resp != NULL; resp = resp->next) {
+		len++;
+		if (resp->def != NULL && resp->def->ind > max_ind)
+			max_ind = resp->def->ind;
+	}
+
+	reslist->ind_arr_size = -1;
+	if (len < RES_INDEX_MIN_LEN || max_ind < 0)
+		return;
+
+	/* don't log on failure, we may be called from a node_eval_threads worker */
+	if ((reslist->ind_arr = calloc(max_ind + 1, sizeof(schd_resource *))) == NULL)
+		return;
+
+	for (resp = reslist; resp != NULL; resp = resp->next) {
+		if (resp->def != NULL && resp->def->ind >= 0 &&
+		    reslist->ind_arr[resp->def->ind] == NULL)
+			reslist->ind_arr[resp->def->ind] = resp;
+	}
+	reslist->ind_arr_size = max_ind + 1;
+}
+
+/**
+ * @brief
+ * 		drop the index of a resource list.  This needs to be called
+ *		whenever a resource is added to the list.
+ *
+ * @param[in,out]	reslist	-	head of the resource list
+ *
+ * @return	void
+ */
+void
+reset_resource_index(schd_resource *reslist)
+{
+	if (reslist == NULL)
+		return;
+
+	free(reslist->ind_arr);
+	reslist->ind_arr = NULL;
+	reslist->ind_arr_size = 0;
+}
+
 /**
  * @brief
  * 		find resource by resource definition
  *
+ * @par	Long lists are indexed by resdef ordinal on first use so node
+ *	resource lookups don't walk the list each time.
+ *
  * @param 	reslist - 	resource list to search
  * @param 	def 	- 	resource definition to search for
  *
@@ -1060,6 +1526,20 @@ find_resource(schd_resource *reslist, resdef *def)
 	if (reslist == NULL || def == NULL)
 		return NULL;
 
+	if (def->ind >= 0) {
+		if (reslist->ind_arr_size == 0)
+			build_resource_index(reslist);
+
+		if (reslist->ind_arr != NULL) {
+			if (def->ind >= reslist->ind_arr_size)
+				return NULL;
+			resp = reslist->ind_arr[def->ind];
+			/* a def from another generation of allres shares this ordinal */
+			if (resp == NULL || resp->def == def)
+				return resp;
+		}
+	}
+
 	resp = reslist;
 
 	while (resp != NULL && resp->def != def)
@@ -1090,6 +1570,8 @@ free_server_info(server_info *sinfo)
 		free(sinfo->all_resresv);
 	if (sinfo->running_jobs != NULL)
 		free(sinfo->running_jobs);
+	if (sinfo->preempt_cands != NULL)
+		free(sinfo->preempt_cands);
 	if (sinfo->exiting_jobs != NULL)
 		free(sinfo->exiting_jobs);
 	/* if we don't have nodes associated with queues, this is a reference */
@@ -1148,6 +1630,7 @@ free_server_info(server_info *sinfo)
 	
 	if(sinfo->unordered_nodes != NULL)
 		free(sinfo->unordered_nodes);
+	free_node_name_index(sinfo->node_idx);
 
 	free_resource_list(sinfo->res);
 #ifdef NAS
@@ -1211,7 +1694,9 @@ free_resource(schd_resource *resp)
 	if (resp->str_assigned != NULL)
 		free(resp->str_assigned);
 
-	free(resp);
+	free(resp->ind_arr);
+
+	pool_free(&schd_resource_pool, resp);
 }
 
 /**
@@ -1259,6 +1744,8 @@ new_server_info(int limallocflag)
 	sinfo->enforce_prmptd_job_resumption = 0;
 	sinfo->use_hard_duration = 0;
 	sinfo->pset_metadata_stale = 0;
+	sinfo->nodes_sort_stale = 1;	/* query changes nodes after sorting them */
+	sinfo->has_indirect_res = 0;
 	sinfo->sched_cycle_len = 0;
 	sinfo->num_parts = 0;
 	sinfo->partitions = NULL;
@@ -1271,6 +1758,9 @@ new_server_info(int limallocflag)
 	sinfo->all_resresv = NULL;
 	sinfo->calendar = NULL;
 	sinfo->running_jobs = NULL;
+	sinfo->preempt_cands = NULL;
+	sinfo->preempt_cands_gen = 0;
+	sinfo->preempt_gen = 0;
 	sinfo->exiting_jobs = NULL;
 	sinfo->nodes = NULL;
 	sinfo->unassoc_nodes = NULL;
@@ -1297,6 +1787,7 @@ new_server_info(int limallocflag)
 	sinfo->equiv_classes = NULL;
 	sinfo->buckets = NULL;
 	sinfo->unordered_nodes = NULL;
+	sinfo->node_idx = NULL;
 	sinfo->num_queues = 0;
 	sinfo->num_nodes = 0;
 	sinfo->num_resvs = 0;
@@ -1327,19 +1818,17 @@ new_server_info(int limallocflag)
  * @return	schd_resource
  * @retval	NULL	: Error
  *
- * @par MT-Safe:	yes
+ * @par MT-Safe:	no
  */
 schd_resource *
 new_resource()
 {
 	schd_resource *resp;		/* the new resource */
 
-	if ((resp = calloc(1,  sizeof(schd_resource))) == NULL) {
-		log_err(errno, "new_resource", MEM_ERR_MSG);
+	if ((resp = pool_alloc(&schd_resource_pool)) == NULL)
 		return NULL;
-	}
 
-	/* member type zero'd by calloc() */
+	/* member type zero'd by pool_alloc() */
 
 	resp->name = NULL;
 	resp->next = NULL;
@@ -1351,6 +1840,8 @@ new_resource()
 	resp->str_assigned = NULL;
 	resp->assigned = RES_DEFAULT_ASSN;
 	resp->avail = RES_DEFAULT_AVAIL;
+	resp->ind_arr = NULL;
+	resp->ind_arr_size = 0;
 
 	return resp;
 }
@@ -1439,6 +1930,7 @@ modify_resource_list(schd_resource *res_list, resource_req *req_list, int type)
 				if (end_res->next == NULL)
 					return 0;
 				end_res = end_res->next;
+				reset_resource_index(res_list);
 			} else {
 				if (type == SCHD_INCR)
 					cur_res->assigned += cur_req->amount;
@@ -1503,6 +1995,7 @@ add_resource_list(status *policy, schd_resource *r1, schd_resource *r2, unsigned
 				if (end_r1->next == NULL)
 					return 0;
 				end_r1 = end_r1->next;
+				reset_resource_index(r1);
 			}
 		} else if (cur_r1->type.is_consumable) {
 			if ((flags & ADD_AVAIL_ASSIGNED)) {
@@ -1544,6 +2037,7 @@ add_resource_list(status *policy, schd_resource *r1, schd_resource *r2, unsigned
 								;
 						end_r1->next = nres;
 						end_r1 = nres;
+						reset_resource_index(r1);
 					} else {
 						nres = false_res();
 						if (nres == NULL)
@@ -1761,8 +2255,12 @@ update_server_on_run(status *policy, server_info *sinfo,
 		}
 	}
 
+	if (resresv->is_resv)
+		sinfo->nodes_sort_stale = 1;
+
 	if (resresv->is_job) {
 		sinfo->sc.running++;
+		sinfo->preempt_gen++;
 		/* note: if job is suspended, counts will get off.
 		 *       sc.queued is not used, and sc.suspended isn't used again
 		 *       after this point
@@ -1781,7 +2279,10 @@ update_server_on_run(status *policy, server_info *sinfo,
 				num_resv_nodes = count_array((void **) resv_nodes);
 				qsort(resv_nodes, num_resv_nodes, sizeof(node_info *),
 					multi_node_sort);
-			} else {
+			} else if (sinfo->nodes_sort_stale || sinfo->has_indirect_res) {
+				/* An indirect resource changes the vnodes pointing to it
+				 * as well as the job's own vnodes.  Sort everything.
+				 */
 				qsort(sinfo->nodes, sinfo->num_nodes, sizeof(node_info *),
 					multi_node_sort);
 
@@ -1790,16 +2291,26 @@ update_server_on_run(status *policy, server_info *sinfo,
 					qsort(sinfo->unassoc_nodes, num_unassoc, sizeof(node_info *),
 						multi_node_sort);
 				}
+				sinfo->nodes_sort_stale = 0;
+			} else {
+				/* Only the job's vnodes changed, move just them */
+				resort_changed_nodes(sinfo->nodes, sinfo->num_nodes,
+					resresv->ninfo_arr, multi_node_sort);
+
+				if (sinfo->nodes != sinfo->unassoc_nodes) {
+					num_unassoc = count_array((void **) sinfo->unassoc_nodes);
+					resort_changed_nodes(sinfo->unassoc_nodes, num_unassoc,
+						resresv->ninfo_arr, multi_node_sort);
+				}
 			}
 		}
 
 		/* We're running a job or reservation, which will affect the cached data.
-		 * We'll flush the cache and rebuild it if needed
+		 * We'll flush the caches over the job's nodes and rebuild them if
+		 * needed.  An indirect resource changes other nodes as well.
 		 */
-		if (sinfo->npc_arr != NULL) {
-			free_np_cache_array(sinfo->npc_arr);
-			sinfo->npc_arr = NULL;
-		}
+		free_np_cache_for_nodes(sinfo,
+			sinfo->has_indirect_res ? NULL : resresv->ninfo_arr);
 
 
 		/* a new job has been run, update running jobs array */
@@ -1879,9 +2390,15 @@ update_server_on_end(status *policy, server_info *sinfo, queue_info *qinfo,
 			return;
 	}
 
+	/* The nodes the resresv ran on get their resources back.  The node
+	 * arrays aren't re-sorted until the next job runs.
+	 */
+	sinfo->nodes_sort_stale = 1;
+
 	if (resresv->is_job) {
 		if (resresv->job->is_running) {
 			sinfo->sc.running--;
+			sinfo->preempt_gen++;
 			remove_resresv_from_array(sinfo->running_jobs, resresv);
 		} else if (resresv->job->is_exiting) {
 			sinfo->sc.exiting--;
@@ -1920,12 +2437,10 @@ update_server_on_end(status *policy, server_info *sinfo, queue_info *qinfo,
 	}
 
 	/* We're ending a job or reservation, which will affect the cached data.
-	 * We'll flush the cache and rebuild it if needed
+	 * We'll flush the caches over its nodes and rebuild them if needed
 	 */
-	if (sinfo->npc_arr != NULL) {
-		free_np_cache_array(sinfo->npc_arr);
-		sinfo->npc_arr = NULL;
-	}
+	free_np_cache_for_nodes(sinfo,
+		sinfo->has_indirect_res ? NULL : resresv->ninfo_arr);
 
 	if (sinfo->has_soft_limit || sinfo->has_hard_limit) {
 		if (resresv->is_job && resresv->job->is_running) {
@@ -2304,6 +2819,8 @@ dup_server_info(server_info *osinfo)
 	nsinfo->enforce_prmptd_job_resumption = osinfo->enforce_prmptd_job_resumption;
 	nsinfo->use_hard_duration = osinfo->use_hard_duration;
 	nsinfo->pset_metadata_stale = osinfo->pset_metadata_stale;
+	nsinfo->nodes_sort_stale = osinfo->nodes_sort_stale;
+	nsinfo->has_indirect_res = osinfo->has_indirect_res;
 	nsinfo->sched_cycle_len = osinfo->sched_cycle_len;
 	nsinfo->partitions = dup_string_array(osinfo->partitions);
 	nsinfo->opt_backfill_fuzzy_time = osinfo->opt_backfill_fuzzy_time;
@@ -2343,6 +2860,7 @@ dup_server_info(server_info *osinfo)
 		nsinfo->unassoc_nodes = nsinfo->nodes;
 	
 	nsinfo->unordered_nodes = dup_unordered_nodes(osinfo->unordered_nodes, nsinfo->nodes);
+	nsinfo->node_idx = share_node_name_index(osinfo->node_idx);
 
 	/* dup the reservations */
 	nsinfo->resvs = dup_resource_resv_array(osinfo->resvs, nsinfo, NULL);
@@ -2697,6 +3215,7 @@ new_counts(void)
 	cts->running = 0;
 	cts->rescts = NULL;
 	cts->soft_limit_preempt_bit = 0;
+	cts->idx = NULL;
 	cts->next = NULL;
 
 	return cts;
@@ -2724,6 +3243,7 @@ free_counts(counts *cts)
 	if (cts->rescts != NULL)
 		free_resource_count_list(cts->rescts);
 
+	reset_counts_index(cts);
 	cts->next = NULL;
 
 	free(cts);
@@ -2822,6 +3342,148 @@ dup_counts_list(counts *ctslist)
 	return nhead;
 }
 
+/* open addressing hash of the names in a counts list */
+struct counts_index {
+	counts **tbl;		/* hash table, size is a power of 2 */
+	int size;		/* size of tbl */
+	int nelem;		/* number of counts in tbl */
+	counts *tail;		/* last indexed element of the list */
+};
+
+/**
+ * @brief
+ * 		hash an entity name for the counts index
+ *
+ * @param[in]	name	-	the name
+ *
+ * @return	hash value
+ */
+static unsigned int
+counts_name_hash(const char *name)
+{
+	unsigned int h = 5381;
+
+	while (*name != '\0')
+		h = h * 33 + (unsigned char) *name++;
+
+	return h;
+}
+
+/**
+ * @brief
+ * 		add a counts structure to the index of its list
+ *
+ * @param[in,out]	ci	-	index to add to
+ * @param[in]	cts	-	counts structure to add
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: malloc failed
+ */
+static int
+counts_index_add(struct counts_index *ci, counts *cts)
+{
+	counts **tmp;
+	counts *cur;
+	unsigned int h;
+	int i;
+
+	/* keep the table at most half full */
+	if ((ci->nelem + 1) * 2 > ci->size) {
+		int nsize = ci->size == 0 ? 64 : ci->size * 2;
+
+		if ((tmp = calloc(nsize, sizeof(counts *))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		for (i = 0; i < ci->size; i++) {
+			if ((cur = ci->tbl[i]) != NULL) {
+				h = counts_name_hash(cur->name) & (nsize - 1);
+				while (tmp[h] != NULL)
+					h = (h + 1) & (nsize - 1);
+				tmp[h] = cur;
+			}
+		}
+		free(ci->tbl);
+		ci->tbl = tmp;
+		ci->size = nsize;
+	}
+
+	h = counts_name_hash(cts->name) & (ci->size - 1);
+	while (ci->tbl[h] != NULL)
+		h = (h + 1) & (ci->size - 1);
+	ci->tbl[h] = cts;
+	ci->nelem++;
+	ci->tail = cts;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		bring the index of a counts list up to date.  Lists only grow at
+ *		their end, so anything after the last indexed element is added.
+ *		The index is built the first time a long list is searched.
+ *
+ * @param[in,out]	ctslist	-	the counts list
+ *
+ * @return	the index
+ * @retval	NULL	: the list is too short to index (or error)
+ */
+static struct counts_index *
+update_counts_index(counts *ctslist)
+{
+	struct counts_index *ci;
+	counts *cur;
+	int len;
+
+	if (ctslist->idx == NULL) {
+		for (len = 0, cur = ctslist; cur != NULL && len < COUNTS_INDEX_MIN_LEN; cur = cur->next)
+			len++;
+		if (cur == NULL)
+			return NULL;
+
+		if ((ci = calloc(1, sizeof(struct counts_index))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return NULL;
+		}
+		ctslist->idx = ci;
+		cur = ctslist;
+	} else {
+		ci = ctslist->idx;
+		cur = ci->tail->next;
+	}
+
+	for (; cur != NULL; cur = cur->next) {
+		if (!counts_index_add(ci, cur)) {
+			reset_counts_index(ctslist);
+			return NULL;
+		}
+	}
+
+	return ci;
+}
+
+/**
+ * @brief
+ * 		reset_counts_index - free the name index of a counts list.  This
+ *		needs to be called if anything but appending changes the list.
+ *
+ * @param[in,out]	ctslist	-	the counts list
+ *
+ * @return	void
+ */
+void
+reset_counts_index(counts *ctslist)
+{
+	if (ctslist == NULL || ctslist->idx == NULL)
+		return;
+
+	free(ctslist->idx->tbl);
+	free(ctslist->idx);
+	ctslist->idx = NULL;
+}
+
 /**
  * @brief
  * 		find_counts - find a counts structure by name
@@ -2837,11 +3499,21 @@ dup_counts_list(counts *ctslist)
 counts *
 find_counts(counts *ctslist, char *name)
 {
+	struct counts_index *ci;
 	counts *cur;
+	unsigned int h;
 
 	if (ctslist == NULL || name == NULL)
 		return NULL;
 
+	if ((ci = update_counts_index(ctslist)) != NULL) {
+		h = counts_name_hash(name) & (ci->size - 1);
+		for (; (cur = ci->tbl[h]) != NULL; h = (h + 1) & (ci->size - 1))
+			if (!strcmp(cur->name, name))
+				return cur;
+		return NULL;
+	}
+
 	cur = ctslist;
 
 	while (cur != NULL && strcmp(cur->name, name))
@@ -2872,25 +3544,30 @@ find_alloc_counts(counts *ctslist, char *name)
 	if (name == NULL)
 		return NULL;
 
-	prev = cur = ctslist;
+	if ((cur = find_counts(ctslist, name)) != NULL)
+		return cur;
 
-	while (cur != NULL && strcmp(cur->name, name)) {
-		prev = cur;
-		cur = cur->next;
-	}
+	/* the index knows the end of the list */
+	if (ctslist != NULL && ctslist->idx != NULL)
+		prev = ctslist->idx->tail;
+	else
+		for (prev = ctslist; prev != NULL && prev->next != NULL; prev = prev->next)
+			;
 
-	if (cur == NULL) {
-		new = new_counts();
+	new = new_counts();
 
-		if (new != NULL)
-			new->name = string_dup(name);
+	if (new != NULL) {
+		new->name = string_dup(name);
+		if (new->name == NULL) {
+			free_counts(new);
+			return NULL;
+		}
+	}
 
-		if (prev != NULL)
-			prev->next = new;
+	if (prev != NULL)
+		prev->next = new;
 
-		return new;
-	} else
-		return cur;
+	return new;
 }
 
 /**
@@ -3009,6 +3686,8 @@ counts_max(counts *cmax, counts *new)
 				return NULL;
 			}
 
+			/* the index lives on the head of the list */
+			reset_counts_index(cmax_head);
 			cur_fmax->next = cmax_head;
 			cmax_head = cur_fmax;
 		} else {
@@ -92,6 +92,11 @@ schd_resource *find_resource_by_str(schd_resource *reslist, const char *name);
  */
 schd_resource *find_resource(schd_resource *reslist, resdef *def);
 
+/*
+ *	reset_resource_index - drop the find_resource() index of a resource list
+ */
+void reset_resource_index(schd_resource *reslist);
+
 /*
  *	free_server_info - free the space used by a server_info structure
  */
@@ -274,6 +279,11 @@ counts *find_counts(counts *ctslist, char *name);
  */
 counts *find_alloc_counts(counts *ctslist, char *name);
 
+/*
+ *      reset_counts_index - free the name index of a counts list
+ */
+void reset_counts_index(counts *ctslist);
+
 /*
  *      update_counts_on_run - update a counts struct on the running of a job
  */
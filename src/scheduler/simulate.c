@@ -56,6 +56,16 @@
  * 	perform_event()
  * 	exists_run_event()
  * 	calc_run_time()
+ * 	fingerprint_add()
+ * 	fingerprint_add_str()
+ * 	fingerprint_add_req()
+ * 	fingerprint_add_nodes()
+ * 	calendar_fingerprint()
+ * 	free_topjob_estimate()
+ * 	free_topjob_estimates()
+ * 	age_topjob_estimates()
+ * 	find_topjob_estimate()
+ * 	save_topjob_estimate()
  * 	create_event_list()
  * 	create_events()
  * 	new_event_list()
@@ -69,6 +79,9 @@
  * 	free_timed_event_list()
  * 	add_event()
  * 	add_timed_event()
+ * 	insert_timed_event()
+ * 	cmp_timed_event_order()
+ * 	log_calendar_stats()
  * 	delete_event()
  * 	create_event()
  * 	determine_event_name()
@@ -130,6 +143,44 @@ static const struct policy_change_func_name policy_change_func_name[] =
 	{NULL, NULL}
 };
 
+/* calendar cost counters for the current cycle - see log_calendar_stats() */
+static struct calendar_stats {
+	unsigned long inserts;		/* events added to a calendar */
+	unsigned long insert_steps;	/* events walked past to add them */
+	unsigned long lookups;		/* find_timed_event() calls */
+	unsigned long lookup_steps;	/* events walked past to find them */
+} cal_stats;
+
+/* an event in the process of being built into a calendar by create_events() */
+struct te_order {
+	timed_event *te;
+	int seq;			/* order the event was created in */
+};
+
+/*
+ * Top job start time estimates kept between cycles (incremental_calendar).
+ * An estimate is reused as long as nothing it was computed from has changed
+ * (see calendar_fingerprint()).  Estimates not used for a whole cycle are
+ * dropped by age_topjob_estimates().
+ */
+struct topjob_estimate {
+	char *name;			/* name of the top job */
+	unsigned long long fingerprint;	/* calendar_fingerprint() when estimated */
+	time_t start;			/* estimated start time */
+	char *exec;			/* estimated execvnode */
+	int last_cycle;			/* last cycle the estimate was used */
+};
+static struct {
+	AVL_IX_DESC *idx;		/* job name -> topjob_estimate */
+	struct topjob_estimate **entries;
+	int num_entries;
+	int entries_size;
+	int cycle;
+} topjob_estimates;
+
+static int cmp_timed_event_order(const void *v1, const void *v2);
+static timed_event *insert_timed_event(timed_event *events, timed_event *te, timed_event *hint);
+
 
 /**
  * @brief
@@ -508,7 +559,9 @@ find_timed_event(timed_event *te_list, int ignore_disabled, char *name,
 	if (te_list == NULL)
 		return NULL;
 
+	cal_stats.lookups++;
 	for (te = te_list; te != NULL; te = find_next_timed_event(te, 0, ALL_MASK)) {
+		cal_stats.lookup_steps++;
 		if (ignore_disabled && te->disabled)
 			continue;
 		found_name = found_type = found_time = 0;
@@ -814,6 +867,372 @@ calc_run_time(char *name, server_info *sinfo, int flags)
 	return event_time;
 }
 
+/**
+ * @brief
+ *		hash a block of memory into a calendar fingerprint (FNV-1a)
+ *
+ * @param[in]	h	-	fingerprint so far
+ * @param[in]	data	-	data to add
+ * @param[in]	len	-	length of data
+ *
+ * @return	the new fingerprint
+ */
+unsigned long long
+fingerprint_add(unsigned long long h, const void *data, size_t len)
+{
+	const unsigned char *p = data;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		h ^= p[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+/**
+ * @brief
+ *		hash a string into a calendar fingerprint.  NULL and "" differ.
+ *
+ * @param[in]	h	-	fingerprint so far
+ * @param[in]	str	-	string to add
+ *
+ * @return	the new fingerprint
+ */
+unsigned long long
+fingerprint_add_str(unsigned long long h, const char *str)
+{
+	if (str == NULL)
+		return fingerprint_add(h, "\002", 1);
+	return fingerprint_add(h, str, strlen(str) + 1);
+}
+
+/**
+ * @brief
+ *		hash a resource_req list into a calendar fingerprint
+ *
+ * @param[in]	h	-	fingerprint so far
+ * @param[in]	req	-	resource list to add
+ *
+ * @return	the new fingerprint
+ */
+static unsigned long long
+fingerprint_add_req(unsigned long long h, resource_req *req)
+{
+	for (; req != NULL; req = req->next) {
+		h = fingerprint_add_str(h, req->name);
+		h = fingerprint_add(h, &req->amount, sizeof(req->amount));
+		h = fingerprint_add_str(h, req->res_str);
+	}
+	return h;
+}
+
+/**
+ * @brief
+ *		hash the state, resources and assignments of the nodes of a
+ *		universe into a fingerprint
+ *
+ * @param[in]	h	-	fingerprint so far
+ * @param[in]	sinfo	-	the server universe
+ *
+ * @return	the new fingerprint
+ */
+unsigned long long
+fingerprint_add_nodes(unsigned long long h, server_info *sinfo)
+{
+	node_info **nodes;
+	int i;
+
+	/* the nodes, in a stable order */
+	nodes = sinfo->unordered_nodes != NULL ? sinfo->unordered_nodes : sinfo->nodes;
+	for (i = 0; nodes != NULL && nodes[i] != NULL; i++) {
+		node_info *ninfo = nodes[i];
+		schd_resource *res;
+		int bits = ninfo->is_down | ninfo->is_free << 1 | ninfo->is_offline << 2 |
+			ninfo->is_unknown << 3 | ninfo->is_exclusive << 4 |
+			ninfo->is_job_exclusive << 5 | ninfo->is_resv_exclusive << 6 |
+			ninfo->is_sharing << 7 | ninfo->is_busy << 8 | ninfo->is_job_busy << 9 |
+			ninfo->is_stale << 10 | ninfo->is_provisioning << 11 |
+			ninfo->is_sleeping << 12 | ninfo->resv_enable << 13 |
+			ninfo->provision_enable << 14 | ninfo->no_multinode_jobs << 15;
+
+		h = fingerprint_add_str(h, ninfo->name);
+		h = fingerprint_add(h, &bits, sizeof(bits));
+		h = fingerprint_add(h, &ninfo->sharing, sizeof(ninfo->sharing));
+		h = fingerprint_add(h, &ninfo->num_jobs, sizeof(ninfo->num_jobs));
+		h = fingerprint_add(h, &ninfo->num_run_resv, sizeof(ninfo->num_run_resv));
+		h = fingerprint_add(h, &ninfo->num_susp_jobs, sizeof(ninfo->num_susp_jobs));
+		h = fingerprint_add_str(h, ninfo->queue_name);
+		h = fingerprint_add_str(h, ninfo->current_aoe);
+		h = fingerprint_add_str(h, ninfo->current_eoe);
+		h = fingerprint_add_str(h, ninfo->nodesig);
+		if (sinfo->policy->load_balancing)
+			h = fingerprint_add(h, &ninfo->loadave, sizeof(ninfo->loadave));
+		for (res = ninfo->res; res != NULL; res = res->next) {
+			h = fingerprint_add(h, &res->avail, sizeof(res->avail));
+			h = fingerprint_add(h, &res->assigned, sizeof(res->assigned));
+		}
+	}
+	return h;
+}
+
+/**
+ * @brief
+ *		fingerprint what a top job's start time estimate is computed from
+ *
+ * @par	That is the job's request, the state and resources of the nodes
+ *	and the calendar events from now until horizon.  Events after the
+ *	end of the estimated run can't change the estimate.  If the
+ *	fingerprint of a later cycle matches, simulating the calendar again
+ *	will come up with the same start time and vnodes.
+ *
+ * @param[in]	sinfo	-	the server universe
+ * @param[in]	resresv	-	the top job
+ * @param[in]	horizon	-	end of the estimated run
+ * @param[in]	use_buckets	-	estimate is made with the bucket algorithm
+ *
+ * @return	the fingerprint
+ */
+static unsigned long long
+calendar_fingerprint(server_info *sinfo, resource_resv *resresv, time_t horizon, int use_buckets)
+{
+	unsigned long long h = FINGERPRINT_INIT;
+	timed_event *te;
+	int i;
+
+	/* the job's request */
+	h = fingerprint_add_str(h, resresv->name);
+	h = fingerprint_add_str(h, resresv->user);
+	h = fingerprint_add_str(h, resresv->group);
+	h = fingerprint_add_str(h, resresv->project);
+	h = fingerprint_add_str(h, resresv->job->queue->name);
+	h = fingerprint_add(h, &resresv->duration, sizeof(resresv->duration));
+	h = fingerprint_add(h, &use_buckets, sizeof(use_buckets));
+	h = fingerprint_add_req(h, resresv->resreq);
+	if (resresv->select != NULL && resresv->select->chunks != NULL) {
+		for (i = 0; resresv->select->chunks[i] != NULL; i++) {
+			chunk *chk = resresv->select->chunks[i];
+			h = fingerprint_add(h, &chk->num_chunks, sizeof(chk->num_chunks));
+			h = fingerprint_add_str(h, chk->str_chunk);
+		}
+	}
+	if (resresv->place_spec != NULL) {
+		place *pl = resresv->place_spec;
+		int bits = pl->free | pl->pack << 1 | pl->scatter << 2 | pl->vscatter << 3 |
+			pl->excl << 4 | pl->exclhost << 5 | pl->share << 6;
+		h = fingerprint_add(h, &bits, sizeof(bits));
+		h = fingerprint_add_str(h, pl->group);
+	}
+
+	h = fingerprint_add_nodes(h, sinfo);
+
+	/* the calendar up to the end of the estimated run */
+	for (te = get_next_event(sinfo->calendar); te != NULL && te->event_time < horizon; te = te->next) {
+		int disabled = te->disabled;
+
+		h = fingerprint_add(h, &te->event_type, sizeof(te->event_type));
+		h = fingerprint_add(h, &te->event_time, sizeof(te->event_time));
+		h = fingerprint_add(h, &disabled, sizeof(disabled));
+		h = fingerprint_add_str(h, te->name);
+		if (te->event_type & (TIMED_RUN_EVENT | TIMED_END_EVENT)) {
+			resource_resv *eresv = (resource_resv *) te->event_ptr;
+
+			for (i = 0; eresv->nspec_arr != NULL && eresv->nspec_arr[i] != NULL; i++) {
+				h = fingerprint_add_str(h, eresv->nspec_arr[i]->ninfo->name);
+				h = fingerprint_add_req(h, eresv->nspec_arr[i]->resreq);
+			}
+		}
+	}
+
+	return h;
+}
+
+/**
+ * @brief
+ *		free a topjob_estimate
+ *
+ * @param[in]	est	-	estimate to free
+ *
+ * @return	void
+ */
+static void
+free_topjob_estimate(struct topjob_estimate *est)
+{
+	if (est == NULL)
+		return;
+
+	free(est->name);
+	free(est->exec);
+	free(est);
+}
+
+/**
+ * @brief
+ *		free the top job estimates kept between cycles
+ *
+ * @return	void
+ */
+void
+free_topjob_estimates(void)
+{
+	int i;
+
+	for (i = 0; i < topjob_estimates.num_entries; i++)
+		free_topjob_estimate(topjob_estimates.entries[i]);
+	free(topjob_estimates.entries);
+	if (topjob_estimates.idx != NULL) {
+		avl_destroy_index(topjob_estimates.idx);
+		free(topjob_estimates.idx);
+	}
+	topjob_estimates.idx = NULL;
+	topjob_estimates.entries = NULL;
+	topjob_estimates.num_entries = 0;
+	topjob_estimates.entries_size = 0;
+}
+
+/**
+ * @brief
+ *		drop the top job estimates which were not used in the cycle
+ *		which just ended.  Every TOPJOB_EST_FULL_REFRESH cycles, drop
+ *		them all.
+ *
+ * @return	void
+ */
+void
+age_topjob_estimates(void)
+{
+	int i;
+	int j;
+
+	if (++topjob_estimates.cycle % TOPJOB_EST_FULL_REFRESH == 0) {
+		free_topjob_estimates();
+		return;
+	}
+
+	for (i = 0, j = 0; i < topjob_estimates.num_entries; i++) {
+		struct topjob_estimate *est = topjob_estimates.entries[i];
+
+		if (est->last_cycle != topjob_estimates.cycle - 1) {
+			tree_add_del(topjob_estimates.idx, est->name, NULL, TREE_OP_DEL);
+			free_topjob_estimate(est);
+		} else
+			topjob_estimates.entries[j++] = est;
+	}
+	topjob_estimates.num_entries = j;
+}
+
+/**
+ * @brief
+ *		find the start time estimate of a top job from an earlier cycle
+ *
+ * @par	The estimate is only returned if nothing it was computed from
+ *	has changed (see calendar_fingerprint()) and it is still in the future.
+ *
+ * @param[in]	sinfo	-	the server universe
+ * @param[in]	resresv	-	the top job
+ * @param[in]	use_buckets	-	estimate with the bucket algorithm
+ * @param[out]	start	-	the estimated start time
+ *
+ * @return	char *
+ * @retval	the estimated execvnode (owned by the estimate cache)
+ * @retval	NULL	: no usable estimate
+ */
+char *
+find_topjob_estimate(server_info *sinfo, resource_resv *resresv, int use_buckets, time_t *start)
+{
+	struct topjob_estimate *est;
+
+	if (sinfo == NULL || resresv == NULL || !resresv->is_job || start == NULL)
+		return NULL;
+
+	if (topjob_estimates.idx == NULL)
+		return NULL;
+
+	if ((est = find_tree(topjob_estimates.idx, resresv->name)) == NULL)
+		return NULL;
+
+	if (est->start <= sinfo->server_time ||
+		est->fingerprint != calendar_fingerprint(sinfo, resresv, est->start + resresv->duration, use_buckets))
+		return NULL;
+
+	est->last_cycle = topjob_estimates.cycle;
+	*start = est->start;
+
+	return est->exec;
+}
+
+/**
+ * @brief
+ *		remember a top job's start time estimate for later cycles
+ *
+ * @par	This needs to be called before the job's own events are added to
+ *	the calendar.  On failure, the estimate is just not kept.
+ *
+ * @param[in]	sinfo	-	the server universe
+ * @param[in]	resresv	-	the top job
+ * @param[in]	use_buckets	-	estimate was made with the bucket algorithm
+ * @param[in]	start	-	the estimated start time
+ * @param[in]	exec	-	the estimated execvnode
+ *
+ * @return	void
+ */
+void
+save_topjob_estimate(server_info *sinfo, resource_resv *resresv, int use_buckets, time_t start, char *exec)
+{
+	struct topjob_estimate *est;
+	char *exec_copy;
+
+	if (sinfo == NULL || resresv == NULL || !resresv->is_job || exec == NULL)
+		return;
+
+	if ((exec_copy = string_dup(exec)) == NULL)
+		return;
+
+	if (topjob_estimates.idx == NULL) {
+		if ((topjob_estimates.idx = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL) {
+			free(exec_copy);
+			return;
+		}
+	}
+
+	if ((est = find_tree(topjob_estimates.idx, resresv->name)) == NULL) {
+		if (topjob_estimates.num_entries == topjob_estimates.entries_size) {
+			struct topjob_estimate **tmp;
+			int sz = topjob_estimates.entries_size == 0 ? 64 : topjob_estimates.entries_size * 2;
+
+			if ((tmp = realloc(topjob_estimates.entries, sz * sizeof(struct topjob_estimate *))) == NULL) {
+				log_err(errno, __func__, MEM_ERR_MSG);
+				free(exec_copy);
+				return;
+			}
+			topjob_estimates.entries = tmp;
+			topjob_estimates.entries_size = sz;
+		}
+		if ((est = calloc(1, sizeof(struct topjob_estimate))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			free(exec_copy);
+			return;
+		}
+		if ((est->name = string_dup(resresv->name)) == NULL) {
+			free(est);
+			free(exec_copy);
+			return;
+		}
+		if (tree_add_del(topjob_estimates.idx, est->name, est, TREE_OP_ADD) != 0) {
+			free_topjob_estimate(est);
+			free(exec_copy);
+			return;
+		}
+		topjob_estimates.entries[topjob_estimates.num_entries++] = est;
+	}
+
+	free(est->exec);
+	est->exec = exec_copy;
+	est->start = start;
+	est->fingerprint = calendar_fingerprint(sinfo, resresv, start + resresv->duration, use_buckets);
+	est->last_cycle = topjob_estimates.cycle;
+}
+
 /**
  * @brief
  * 		create an event_list from running jobs and confirmed resvs
@@ -860,9 +1279,13 @@ create_events(server_info *sinfo)
 	resource_resv	**all = NULL;
 	int		errflag = 0;
 	int		i = 0;
+	int		j = 0;
+	int		num_te = 0;
 	time_t 		end = 0;
 	resource_resv	**all_resresv_copy;
 	int		all_resresv_len;
+	struct te_order	*te_arr;
+	int		num_nodes;
 
 	/* create a temporary copy of all_resresv array which is sorted such that
 	 * the timed events are in the front of the array.
@@ -877,6 +1300,18 @@ create_events(server_info *sinfo)
 	all_resresv_copy[i] = NULL;
 	all = all_resresv_copy;
 
+	/* Each resresv has at most a run and an end event. Each node has at most
+	 * one node up event.  The events are collected and sorted once rather
+	 * than inserting each one into the sorted list.
+	 */
+	num_nodes = count_array((void **)sinfo->nodes);
+	te_arr = malloc((2 * all_resresv_len + num_nodes + 1) * sizeof(struct te_order));
+	if (te_arr == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(all_resresv_copy);
+		return 0;
+	}
+
 	/* sort the all resersv list so all the timed events are in the front */
 	qsort(all, count_array((void **)all), sizeof(resource_resv *), cmp_events);
 
@@ -893,7 +1328,9 @@ create_events(server_info *sinfo)
 				errflag++;
 				break;
 			}
-			events = add_timed_event(events, te);
+			te_arr[num_te].te = te;
+			te_arr[num_te].seq = num_te;
+			num_te++;
 		}
 
 		if (sinfo->use_hard_duration)
@@ -905,7 +1342,9 @@ create_events(server_info *sinfo)
 			errflag++;
 			break;
 		}
-		events = add_timed_event(events, te);
+		te_arr[num_te].te = te;
+		te_arr[num_te].seq = num_te;
+		num_te++;
 	}
 
 	/* for nodes that are in state=sleep add a timed event */
@@ -918,21 +1357,74 @@ create_events(server_info *sinfo)
 				errflag++;
 				break;
 			}
-			events = add_timed_event(events, te);
+			te_arr[num_te].te = te;
+			te_arr[num_te].seq = num_te;
+			num_te++;
 		}
 	}
 
 	/* A malloc error was encountered, free all allocated memory and return */
 	if (errflag > 0) {
-		free_timed_event_list(events);
+		for (j = 0; j < num_te; j++)
+			free_timed_event(te_arr[j].te);
+		free(te_arr);
 		free(all_resresv_copy);
 		return 0;
 	}
 
+	qsort(te_arr, num_te, sizeof(struct te_order), cmp_timed_event_order);
+	for (j = 0; j < num_te; j++) {
+		te_arr[j].te->prev = j > 0 ? te_arr[j - 1].te : NULL;
+		te_arr[j].te->next = j + 1 < num_te ? te_arr[j + 1].te : NULL;
+	}
+	if (num_te > 0)
+		events = te_arr[0].te;
+	cal_stats.inserts += num_te;
+
+	free(te_arr);
 	free(all_resresv_copy);
 	return events;
 }
 
+/**
+ * @brief
+ * 		qsort() comparison function used by create_events().  It orders the
+ *		events exactly as if they had been added one at a time in creation
+ *		order with add_timed_event(): by time, and at the same time all end
+ *		events (the last one added first) before all other events (the
+ *		first one added first).
+ *
+ * @param[in]	v1	-	struct te_order
+ * @param[in]	v2	-	struct te_order
+ *
+ * @return	int
+ * @retval	-1	: v1 comes before v2
+ * @retval	1	: v1 comes after v2
+ * @retval	0	: same event
+ */
+static int
+cmp_timed_event_order(const void *v1, const void *v2)
+{
+	const struct te_order *o1 = v1;
+	const struct te_order *o2 = v2;
+	int end1;
+	int end2;
+
+	if (o1->te->event_time != o2->te->event_time)
+		return o1->te->event_time < o2->te->event_time ? -1 : 1;
+
+	end1 = o1->te->event_type == TIMED_END_EVENT;
+	end2 = o2->te->event_type == TIMED_END_EVENT;
+	if (end1 != end2)
+		return end1 ? -1 : 1;
+
+	if (o1->seq == o2->seq)
+		return 0;
+	if (end1)
+		return o1->seq > o2->seq ? -1 : 1;
+	return o1->seq < o2->seq ? -1 : 1;
+}
+
 /**
  * @brief
  * 		new_event_list() - event_list constructor
@@ -954,6 +1446,7 @@ new_event_list()
 	elist->events = NULL;
 	elist->next_event = NULL;
 	elist->first_run_event = NULL;
+	elist->last_added = NULL;
 	elist->current_time = NULL;
 
 	return elist;
@@ -1431,7 +1924,14 @@ add_event(event_list *calendar, timed_event *te)
 	if (calendar->events == NULL)
 		events_is_null = 1;
 
-	calendar->events = add_timed_event(calendar->events, te);
+	/* Events tend to be added near each other (e.g. a job's start and end
+	 * are added back to back), so start the search where the last one went.
+	 */
+	if (calendar->last_added != NULL)
+		calendar->events = insert_timed_event(calendar->events, te, calendar->last_added);
+	else
+		calendar->events = insert_timed_event(calendar->events, te, calendar->next_event);
+	calendar->last_added = te;
 
 	/* empty event list - the new event is the only event */
 	if (events_is_null)
@@ -1444,9 +1944,13 @@ add_event(event_list *calendar, timed_event *te)
 			if (te->event_time < calendar->next_event->event_time)
 				calendar->next_event = te;
 			else if (te->event_time == calendar->next_event->event_time) {
-				calendar->next_event =
-					find_timed_event(calendar->events, 0, NULL,
-					TIMED_NOEVENT, te->event_time);
+				/* the first event at this time, which te is one of */
+				timed_event *first;
+
+				for (first = te; first->prev != NULL &&
+					first->prev->event_time == te->event_time; first = first->prev)
+					;
+				calendar->next_event = first;
 			}
 		}
 	}
@@ -1482,26 +1986,61 @@ add_event(event_list *calendar, timed_event *te)
  */
 timed_event *
 add_timed_event(timed_event *events, timed_event *te)
+{
+	return insert_timed_event(events, te, events);
+}
+
+/**
+ * @brief
+ * 		insert_timed_event - add an event to a sorted list of events
+ *		starting the search for its place from a hint in the list.
+ *		The event ends up in the same place as if the search had started
+ *		from the head of the list (see add_timed_event()).
+ *
+ * @param	events - event list to add event to
+ * @param 	te     - timed_event to add to list
+ * @param	hint   - event in events to start the search from (or NULL)
+ *
+ * @return	head of timed_event list
+ */
+static timed_event *
+insert_timed_event(timed_event *events, timed_event *te, timed_event *hint)
 {
 	timed_event *eloop;
 	timed_event *eloop_prev = NULL;
+	int is_end;
 
 	if (te == NULL)
 		return events;
 
-	if (events == NULL)
+	cal_stats.inserts++;
+
+	if (events == NULL) {
+		te->next = NULL;
+		te->prev = NULL;
 		return te;
+	}
 
-	for (eloop = events; eloop != NULL; eloop = eloop->next) {
-		if (eloop->event_time > te->event_time)
-			break;
-		if (eloop->event_time == te->event_time &&
-			te->event_type == TIMED_END_EVENT) {
-			break;
-		}
+	if (hint == NULL)
+		hint = events;
 
-		eloop_prev = eloop;
+	/* te goes after every event which is earlier than it.  At the same time,
+	 * end events go before and all other events go after the existing ones.
+	 */
+	is_end = te->event_type == TIMED_END_EVENT;
+#define TE_GOES_AFTER(e) ((e)->event_time < te->event_time || \
+	((e)->event_time == te->event_time && !is_end))
+
+	if (TE_GOES_AFTER(hint)) {
+		for (eloop_prev = hint; eloop_prev->next != NULL &&
+			TE_GOES_AFTER(eloop_prev->next); eloop_prev = eloop_prev->next)
+			cal_stats.insert_steps++;
+	} else {
+		for (eloop_prev = hint->prev; eloop_prev != NULL &&
+			!TE_GOES_AFTER(eloop_prev); eloop_prev = eloop_prev->prev)
+			cal_stats.insert_steps++;
 	}
+#undef TE_GOES_AFTER
 
 	if (eloop_prev == NULL) {
 		te->next = events;
@@ -1510,6 +2049,7 @@ add_timed_event(timed_event *events, timed_event *te)
 		return te;
 	}
 
+	eloop = eloop_prev->next;
 	te->next = eloop;
 	eloop_prev->next = te;
 	te->prev = eloop_prev;
@@ -1519,6 +2059,22 @@ add_timed_event(timed_event *events, timed_event *te)
 	return events;
 }
 
+/**
+ * @brief
+ * 		log and reset the calendar cost counters for this cycle
+ *
+ * @return void
+ */
+void
+log_calendar_stats(void)
+{
+	log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+		"Calendar: %lu inserts (%lu steps), %lu lookups (%lu steps)",
+		cal_stats.inserts, cal_stats.insert_steps,
+		cal_stats.lookups, cal_stats.lookup_steps);
+	memset(&cal_stats, 0, sizeof(cal_stats));
+}
+
 /**
  * @brief
  * 		delete a timed event from an event_list
@@ -1541,9 +2097,13 @@ delete_event(server_info *sinfo, timed_event *e)
 
 	if (calendar->next_event == e)
 		calendar->next_event = e->next;
-	
+
+	if (calendar->last_added == e)
+		calendar->last_added = e->prev != NULL ? e->prev : e->next;
+
+	/* e was the first run event, so the new one can only come after it */
 	if (calendar->first_run_event == e)
-		calendar->first_run_event = find_timed_event(calendar->events, 0, NULL, TIMED_RUN_EVENT, 0);
+		calendar->first_run_event = find_timed_event(e->next, 0, NULL, TIMED_RUN_EVENT, 0);
 
 	if (e->prev == NULL)
 		calendar->events = e->next;
@@ -305,6 +305,11 @@ timed_event *find_event_by_name(timed_event *events, char *name);
  *      \return head of timed_event list
  */
 timed_event *add_timed_event(timed_event *events, timed_event *te);
+
+/*
+ *	log_calendar_stats - log and reset the calendar cost counters
+ */
+void log_calendar_stats(void);
 /*
  *
  *	add_event - add a timed_event to an event list
@@ -345,6 +350,18 @@ create_event(enum timed_event_types event_type,
  */
 time_t calc_run_time(char *job_name, server_info *sinfo, int flags);
 
+/* FNV-1a fingerprints of what cached scheduling results depend on */
+#define FINGERPRINT_INIT 14695981039346656037ULL
+unsigned long long fingerprint_add(unsigned long long h, const void *data, size_t len);
+unsigned long long fingerprint_add_str(unsigned long long h, const char *str);
+unsigned long long fingerprint_add_nodes(unsigned long long h, server_info *sinfo);
+
+/* top job start time estimates kept between cycles (incremental_calendar) */
+char *find_topjob_estimate(server_info *sinfo, resource_resv *resresv, int use_buckets, time_t *start);
+void save_topjob_estimate(server_info *sinfo, resource_resv *resresv, int use_buckets, time_t start, char *exec);
+void age_topjob_estimates(void);
+void free_topjob_estimates(void);
+
 /*
  *
  *	find_event_ptr - find the correct event pointer for the duplicated
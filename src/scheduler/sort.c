@@ -54,6 +54,7 @@
  * 	cmp_preempt_priority_asc()
  * 	cmp_preempt_stime_asc()
  * 	cmp_preemption()
+ * 	cache_job_sort_keys()
  * 	multi_sort()
  * 	cmp_job_sort_formula()
  * 	multi_node_sort()
@@ -68,6 +69,7 @@
  * 	cmp_aoe()
  * 	cmp_job_preemption_time_asc()
  * 	cmp_starving_jobs()
+ * 	cmp_resv_confirm()
  * 	sort_jobs()
  * 	swapfunc()
  * 	med3()
@@ -94,11 +96,15 @@
 #include "server_info.h"
 #include "resource.h"
 #include "constant.h"
+#include "cycle_stats.h"
 
 #ifdef NAS
 #include "site_code.h"
 #endif
 
+/* sort_jobs() call the cached job sort keys are valid for (0 if none) */
+static unsigned int sort_keys_valid_gen = 0;
+static unsigned int sort_keys_next_gen = 0;
 
 
 /**
@@ -514,12 +520,89 @@ multi_sort(resource_resv *r1, resource_resv *r2)
 	int ret = 0;
 	int i;
 
+	/* use the keys cached by sort_jobs() if both jobs have them */
+	if (sort_keys_valid_gen != 0 && r1 != NULL && r2 != NULL &&
+		r1->sort_key_gen == sort_keys_valid_gen &&
+		r2->sort_key_gen == sort_keys_valid_gen) {
+		for (i = 0; i < r1->num_sort_keys && ret == 0; i++) {
+			sch_resource_t v1 = r1->sort_keys[i];
+			sch_resource_t v2 = r2->sort_keys[i];
+
+			if (v1 < v2)
+				ret = (cstat.sort_by[i].order == ASC) ? -1 : 1;
+			else if (v1 > v2)
+				ret = (cstat.sort_by[i].order == ASC) ? 1 : -1;
+		}
+		return ret;
+	}
+
 	for (i = 0; i <= MAX_SORTS && ret == 0 && cstat.sort_by[i].res_name != NULL; i++)
 		ret = resresv_sort_cmp(r1, r2, &cstat.sort_by[i]);
 
 	return ret;
 }
 
+/**
+ * @brief
+ *		cache_job_sort_keys - compute the job_sort_key values of each job
+ *		once, so the comparisons done while sorting do not have to look
+ *		them up again through find_resresv_amount().
+ *
+ * @param[in]	jobs	-	jobs to cache the sort keys of
+ *
+ * @return	unsigned int
+ * @retval	generation the keys were cached for
+ * @retval	0	: no keys were cached
+ *
+ * @note
+ *		A job whose keys could not be cached falls back to
+ *		resresv_sort_cmp() in multi_sort().
+ */
+static unsigned int
+cache_job_sort_keys(resource_resv **jobs)
+{
+	int num_keys;
+	int i, j;
+
+	if (jobs == NULL || cstat.sort_by == NULL)
+		return 0;
+
+	for (num_keys = 0; num_keys <= MAX_SORTS &&
+		cstat.sort_by[num_keys].res_name != NULL; num_keys++)
+		;
+	if (num_keys == 0)
+		return 0;
+
+	if (++sort_keys_next_gen == 0)
+		sort_keys_next_gen = 1;
+
+	for (i = 0; jobs[i] != NULL; i++) {
+		resource_resv *resresv = jobs[i];
+
+		if (resresv->num_sort_keys != num_keys) {
+			sch_resource_t *keys;
+
+			keys = realloc(resresv->sort_keys, num_keys * sizeof(sch_resource_t));
+			if (keys == NULL) {
+				free(resresv->sort_keys);
+				resresv->sort_keys = NULL;
+				resresv->num_sort_keys = 0;
+				resresv->sort_key_gen = 0;
+				continue;
+			}
+			resresv->sort_keys = keys;
+			resresv->num_sort_keys = num_keys;
+		}
+
+		for (j = 0; j < num_keys; j++)
+			resresv->sort_keys[j] = find_resresv_amount(resresv,
+				cstat.sort_by[j].res_name, cstat.sort_by[j].def);
+		resresv->sort_key_gen = sort_keys_next_gen;
+	}
+
+	return sort_keys_next_gen;
+}
+
 /**
  * @brief
  * 		cmp_job_sort_formula - used to sort jobs based on their evaluated
@@ -1263,6 +1346,43 @@ cmp_resv_state(const void *r1, const void *r2)
 		return 0;
 }
 
+/**
+ * @brief
+ * 		cmp_resv_confirm - order reservations for check_new_reservations().
+ *		Reservations being altered come first like with cmp_resv_state().
+ *		The reservations to confirm for the first time are ordered by
+ *		requested start so that they can be confirmed in one simulation.
+ *
+ * @param[in] r1	- reservation to compare.
+ * @param[in] r2	- reservation to compare.
+ *
+ * @return - int
+ * @retval  -1: r1 is confirmed before r2
+ * @retval   0: no preference
+ * @retval   1: r2 is confirmed before r1
+ */
+int
+cmp_resv_confirm(const void *r1, const void *r2)
+{
+	resv_info *resv1;
+	resv_info *resv2;
+	int rc;
+
+	if ((rc = cmp_resv_state(r1, r2)) != 0)
+		return rc;
+
+	resv1 = (*(resource_resv **)r1)->resv;
+	resv2 = (*(resource_resv **)r2)->resv;
+	if (resv1->resv_state != RESV_UNCONFIRMED || resv2->resv_state != RESV_UNCONFIRMED)
+		return 0;
+
+	if (resv1->req_start < resv2->req_start)
+		return -1;
+	if (resv1->req_start > resv2->req_start)
+		return 1;
+	return 0;
+}
+
 /**
  * @brief
  * 		sort_jobs - This function sorts all jobs according to their preemption
@@ -1283,6 +1403,12 @@ sort_jobs(status *policy, server_info *sinfo)
 	int job_index = 0;
 	int index = 0;
 	int count = 0;
+	double start;
+
+	start = cycle_phase_start();
+
+	/* the sort keys can not change while we sort, so only look them up once */
+	sort_keys_valid_gen = cache_job_sort_keys(sinfo->jobs);
 
 	/** sort jobs in such a way that Higher Priority jobs come on top
 	 * followed by preempted jobs and then starving jobs and normal jobs
@@ -1340,4 +1466,8 @@ sort_jobs(status *policy, server_info *sinfo)
 	}
 	else
 		qsort(sinfo->jobs, count_array((void **)sinfo->jobs), sizeof(resource_resv*), cmp_sort);
+
+	sort_keys_valid_gen = 0;
+
+	cycle_phase_stop(CPHASE_SORT, start);
 }
@@ -198,6 +198,11 @@ int cmp_nodes_sort(const void *n1, const void *n2);
  */
 int cmp_resv_state(const void *r1, const void *r2);
 
+/*
+ * cmp_resv_confirm - order reservations to confirm by state and start
+ */
+int cmp_resv_confirm(const void *r1, const void *r2);
+
 /*
  * sort_jobs - This function sorts all jobs according to their preemption
  *             priority, preempted time and fairshare.
@@ -0,0 +1,848 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+/**
+ * @file    sub_cycle.c
+ *
+ * @brief
+ * 		sub_cycle.c - schedule independent partitions in parallel
+ *		sub-cycles (partition_sub_cycles).
+ *
+ *	When the queues with jobs to run are in two or more partitions and
+ *	nothing in the cycle is shared between them, each partition is
+ *	scheduled by main_sched_loop() in a child process forked after the
+ *	universe has been queried.  The child's copy of the universe is the
+ *	partition's slice of it: all jobs of the other partitions are marked
+ *	as not able to run.  The child does not talk to the server.  Its run
+ *	requests and job attribute updates are written to a pipe, and the
+ *	scheduler which forked it sends them to the server as if it had
+ *	made them itself.
+ *
+ * Functions included are:
+ * 	sub_cycle_child()
+ * 	sub_cycle_put_str()
+ * 	sub_cycle_put_run()
+ * 	sub_cycle_put_update()
+ * 	sub_cycle_partitions()
+ * 	sub_cycle_save()
+ * 	sub_cycle_mark()
+ * 	sub_cycle_run()
+ * 	sub_cycle_start()
+ * 	sub_cycle_read()
+ * 	sub_cycle_get_int()
+ * 	sub_cycle_get_str()
+ * 	sub_cycle_replay()
+ * 	sub_cycle_finish()
+ * 	sub_cycle_collect()
+ * 	partition_sub_cycles()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <pbs_ifl.h>
+#include <pbs_error.h>
+#include <libpbs.h>
+#include <libutil.h>
+#include <log.h>
+#include "attribute.h"
+#include "sub_cycle.h"
+#include "constant.h"
+#include "config.h"
+#include "data_types.h"
+#include "globals.h"
+#include "fifo.h"
+#include "job_info.h"
+#include "misc.h"
+#include "resource_resv.h"
+
+extern int second_connection;
+
+/* a partition scheduled in a sub-cycle */
+struct sub_cycle {
+	char *partition;	/* the partition */
+	pid_t pid;		/* child scheduling it, 0 when done, -1 not started */
+	int fd;			/* read end of the child's pipe */
+	char *buf;		/* what the child wrote so far */
+	size_t len;		/* bytes in buf */
+	size_t size;		/* size of buf */
+};
+
+/* a job's can_not_run before the universe was sliced */
+struct sub_cycle_saved {
+	resource_resv *resresv;
+	int can_not_run;
+};
+
+/* in a sub-cycle: where its run requests and job updates are written */
+static FILE *sub_cycle_out = NULL;
+
+/**
+ * @brief
+ * 		is this process a partition sub-cycle?  If it is, nothing may
+ *		be sent to the server, sub_cycle_put_run() and
+ *		sub_cycle_put_update() pass it back instead.
+ *
+ * @return	int
+ * @retval	1	: a sub-cycle
+ * @retval	0	: the scheduler
+ */
+int
+sub_cycle_child(void)
+{
+	return sub_cycle_out != NULL;
+}
+
+/**
+ * @brief
+ * 		write a string to the sub-cycle's pipe: its length with the
+ *		terminating NUL, -1 for NULL, and the string
+ *
+ * @param[in]	str	-	string to write, can be NULL
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
+ */
+static int
+sub_cycle_put_str(char *str)
+{
+	int len = -1;
+
+	if (str != NULL)
+		len = strlen(str) + 1;
+	if (fwrite(&len, sizeof(len), 1, sub_cycle_out) != 1)
+		return 0;
+	if (len > 0 && fwrite(str, len, 1, sub_cycle_out) != 1)
+		return 0;
+	return 1;
+}
+
+/**
+ * @brief
+ * 		pass a run request of a sub-cycle to the scheduler which forked it
+ *
+ * @param[in]	jobid	-	job to run
+ * @param[in]	execvnode	-	the execvnode to run the job on
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: the request could not be written
+ */
+int
+sub_cycle_put_run(char *jobid, char *execvnode)
+{
+	if (fputc('R', sub_cycle_out) == EOF || !sub_cycle_put_str(jobid) ||
+		!sub_cycle_put_str(execvnode))
+		return PBSE_SYSTEM;
+	return 0;
+}
+
+/**
+ * @brief
+ * 		pass job attribute updates of a sub-cycle to the scheduler which
+ *		forked it
+ *
+ * @param[in]	jobid	-	job to update
+ * @param[in]	pattr	-	attrl list to update
+ * @param[in]	now	-	send the updates right away (send_attr_updates())
+ *				instead of with those of other jobs
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: the updates could not be written
+ */
+int
+sub_cycle_put_update(char *jobid, struct attrl *pattr, int now)
+{
+	struct attrl *attr;
+	int count = 0;
+
+	for (attr = pattr; attr != NULL; attr = attr->next)
+		count++;
+
+	if (fputc(now ? 'N' : 'U', sub_cycle_out) == EOF || !sub_cycle_put_str(jobid) ||
+		fwrite(&count, sizeof(count), 1, sub_cycle_out) != 1)
+		return PBSE_SYSTEM;
+
+	for (attr = pattr; attr != NULL; attr = attr->next) {
+		int op = attr->op;
+
+		if (!sub_cycle_put_str(attr->name) || !sub_cycle_put_str(attr->resource) ||
+			!sub_cycle_put_str(attr->value) ||
+			fwrite(&op, sizeof(op), 1, sub_cycle_out) != 1)
+			return PBSE_SYSTEM;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ * 		find the partitions which can be scheduled in sub-cycles.  Only
+ *		what a partition's jobs are placed on may differ between sub-cycles,
+ *		so anything else a job could take from, or be held back by,
+ *		jobs of other partitions keeps the cycle serial.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	sinfo	-	the server universe
+ *
+ * @return	char **
+ * @retval	the partitions with jobs to run
+ * @retval	NULL	: fewer than two, or they are not independent
+ */
+static char **
+sub_cycle_partitions(status *policy, server_info *sinfo)
+{
+	char **parts = NULL;
+	char *why = NULL;
+	schd_resource *res;
+	int preempt = -1;
+	int i;
+
+	if (sinfo->qrun_job != NULL)
+		why = "qrun request";
+	else if (conf.cycle_time_budget > 0)
+		why = "cycle_time_budget is set";
+	else if (conf.max_jobs_to_check != SCHD_INFINITY)
+		why = "max_job_check is set";
+	else if (conf.peer_queues[0].local_queue != NULL)
+		why = "peer queues are configured";
+	else if (!policy->backfill && (policy->strict_ordering || policy->help_starving_jobs))
+		why = "strict ordering without backfilling";
+	else if (sinfo->has_hard_limit || sinfo->has_soft_limit)
+		why = "server limits are set";
+	else if (sinfo->sc.suspended > 0)
+		why = "suspended jobs";
+
+	for (res = sinfo->res; why == NULL && res != NULL; res = res->next) {
+		if (res->type.is_consumable && res->avail != SCHD_INFINITY_RES)
+			why = "consumable server resources are set";
+	}
+
+	for (i = 0; why == NULL && sinfo->jobs[i] != NULL; i++) {
+		resource_resv *job = sinfo->jobs[i];
+		queue_info *qinfo;
+
+		if (job->job == NULL)
+			continue;
+		qinfo = job->job->queue;
+
+		/* a job of any partition may preempt one of another */
+		if (policy->preempting) {
+			if (policy->fair_share || policy->help_starving_jobs || qinfo->has_soft_limit)
+				why = "jobs could preempt";
+			else if (preempt == -1)
+				preempt = job->job->preempt;
+			else if (preempt != job->job->preempt)
+				why = "jobs could preempt";
+			if (why != NULL)
+				break;
+		}
+
+		if (job->can_not_run || !in_runnable_state(job))
+			continue;
+
+		if (qinfo->partition == NULL || qinfo->has_nodes || qinfo->resv != NULL) {
+			why = "a queue with jobs to run is not in a partition of its own";
+			break;
+		}
+		if (add_str_to_unique_array(&parts, qinfo->partition) < 0) {
+			why = "out of memory";
+			break;
+		}
+	}
+
+	if (why == NULL && count_array((void **) parts) < 2)
+		why = "fewer than two partitions have jobs to run";
+
+	if (why != NULL) {
+		log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"Not scheduling partitions in sub-cycles: %s", why);
+		free_string_array(parts);
+		return NULL;
+	}
+
+	return parts;
+}
+
+/**
+ * @brief
+ * 		save every job's can_not_run so the universe can be sliced into
+ *		partitions with sub_cycle_mark()
+ *
+ * @param[in]	sinfo	-	the server universe
+ *
+ * @return	struct sub_cycle_saved *
+ * @retval	array as long as sinfo->jobs
+ * @retval	NULL	: on error
+ */
+static struct sub_cycle_saved *
+sub_cycle_save(server_info *sinfo)
+{
+	struct sub_cycle_saved *saved;
+	int i;
+
+	saved = calloc(count_array((void **) sinfo->jobs) + 1, sizeof(struct sub_cycle_saved));
+	if (saved == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	for (i = 0; sinfo->jobs[i] != NULL; i++) {
+		saved[i].resresv = sinfo->jobs[i];
+		saved[i].can_not_run = sinfo->jobs[i]->can_not_run;
+	}
+
+	return saved;
+}
+
+/**
+ * @brief
+ * 		slice the universe to a partition: only the jobs of its queues
+ *		are left to run
+ *
+ * @param[in]	saved	-	the jobs' can_not_run from sub_cycle_save()
+ * @param[in]	partition	-	the partition
+ *
+ * @return	void
+ */
+static void
+sub_cycle_mark(struct sub_cycle_saved *saved, char *partition)
+{
+	int i;
+
+	for (i = 0; saved[i].resresv != NULL; i++) {
+		resource_resv *job = saved[i].resresv;
+		queue_info *qinfo = job->job != NULL ? job->job->queue : NULL;
+
+		if (qinfo != NULL && qinfo->partition != NULL &&
+			!strcmp(qinfo->partition, partition))
+			job->can_not_run = saved[i].can_not_run;
+		else
+			job->can_not_run = 1;
+	}
+}
+
+/**
+ * @brief
+ * 		the sub-cycle of a partition, in the forked child.  It does not
+ *		return.
+ *
+ * @par	The child exits with 0 when done, 1 if the cycle should be
+ *	restarted and 2 if it could not pass back what it did.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	pbs_sd	-	connection to the server the scheduler holds
+ * @param[in]	sinfo	-	the child's copy of the universe
+ * @param[in]	saved	-	the jobs' can_not_run from sub_cycle_save()
+ * @param[in]	sc	-	the partition
+ * @param[in]	fd	-	write end of the pipe to the scheduler
+ */
+static void
+sub_cycle_run(status *policy, int pbs_sd, server_info *sinfo,
+	struct sub_cycle_saved *saved, struct sub_cycle *sc, int fd)
+{
+	schd_error *err = NULL;
+	int null_fd;
+	int rc;
+
+	if ((sub_cycle_out = fdopen(fd, "w")) == NULL)
+		_exit(2);
+
+	/* the connections are the scheduler's.  Anything sent on them by
+	 * mistake goes nowhere, and the scheduler's commands are left to it.
+	 */
+	if ((null_fd = open("/dev/null", O_RDWR)) != -1) {
+		if (pbs_sd >= 0 && pbs_sd < PBS_MAX_CONNECTIONS)
+			dup2(null_fd, connection[pbs_sd].ch_socket);
+		close(null_fd);
+	}
+	second_connection = -1;
+
+	sub_cycle_mark(saved, sc->partition);
+	rc = main_sched_loop(policy, pbs_sd, sinfo, &err);
+
+	if (fclose(sub_cycle_out) != 0)
+		_exit(2);
+	fflush(NULL);
+	_exit(rc < 0 ? 1 : 0);
+}
+
+/**
+ * @brief
+ * 		fork the sub-cycle of a partition
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	pbs_sd	-	connection to the server
+ * @param[in]	sinfo	-	the server universe
+ * @param[in]	saved	-	the jobs' can_not_run from sub_cycle_save()
+ * @param[in,out]	sc	-	the partition
+ *
+ * @return	int
+ * @retval	1	: the sub-cycle is running
+ * @retval	0	: it could not be started, sc->pid is -1
+ */
+static int
+sub_cycle_start(status *policy, int pbs_sd, server_info *sinfo,
+	struct sub_cycle_saved *saved, struct sub_cycle *sc)
+{
+	int fd[2];
+
+	sc->pid = -1;
+	sc->fd = -1;
+
+	if (pipe(fd) == -1) {
+		log_err(errno, __func__, "pipe failed");
+		return 0;
+	}
+	/* a program the dyn_res thread runs must not hold the pipe open */
+	fcntl(fd[0], F_SETFD, FD_CLOEXEC);
+	fcntl(fd[1], F_SETFD, FD_CLOEXEC);
+
+	/* the child must not write what the scheduler buffered a second time */
+	fflush(NULL);
+
+	if ((sc->pid = fork()) == -1) {
+		log_err(errno, __func__, "fork failed");
+		close(fd[0]);
+		close(fd[1]);
+		return 0;
+	}
+	if (sc->pid == 0) {
+		close(fd[0]);
+		sub_cycle_run(policy, pbs_sd, sinfo, saved, sc, fd[1]);
+	}
+	close(fd[1]);
+	sc->fd = fd[0];
+
+	log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+		"Started sub-cycle of partition %s, pid %d", sc->partition, (int) sc->pid);
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		read what a sub-cycle wrote to its pipe
+ *
+ * @param[in,out]	sc	-	the partition
+ *
+ * @return	int
+ * @retval	1	: read something, or was interrupted
+ * @retval	0	: end of file
+ * @retval	-1	: on error
+ */
+static int
+sub_cycle_read(struct sub_cycle *sc)
+{
+	ssize_t rc;
+
+	if (sc->size - sc->len < 4096) {
+		size_t size = sc->size == 0 ? 8192 : sc->size * 2;
+		char *buf;
+
+		if ((buf = realloc(sc->buf, size)) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return -1;
+		}
+		sc->buf = buf;
+		sc->size = size;
+	}
+
+	rc = read(sc->fd, sc->buf + sc->len, sc->size - sc->len);
+	if (rc == -1 && errno == EINTR)
+		return 1;
+	if (rc == -1) {
+		log_err(errno, __func__, "read failed");
+		return -1;
+	}
+	if (rc == 0)
+		return 0;
+	sc->len += rc;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		take an int out of what a sub-cycle wrote
+ *
+ * @param[in]	sc	-	the partition
+ * @param[in,out]	pos	-	where to take it from, moved past it
+ * @param[out]	val	-	the int
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: the record is not complete
+ */
+static int
+sub_cycle_get_int(struct sub_cycle *sc, size_t *pos, int *val)
+{
+	if (sc->len - *pos < sizeof(int))
+		return 0;
+	memcpy(val, sc->buf + *pos, sizeof(int));
+	*pos += sizeof(int);
+	return 1;
+}
+
+/**
+ * @brief
+ * 		take a string written by sub_cycle_put_str() out of what a
+ *		sub-cycle wrote
+ *
+ * @param[in]	sc	-	the partition
+ * @param[in,out]	pos	-	where to take it from, moved past it
+ * @param[out]	str	-	the string, in sc->buf.  NULL if NULL was written.
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: the record is not complete
+ */
+static int
+sub_cycle_get_str(struct sub_cycle *sc, size_t *pos, char **str)
+{
+	int len;
+
+	if (!sub_cycle_get_int(sc, pos, &len))
+		return 0;
+	if (len < 0) {
+		*str = NULL;
+		return 1;
+	}
+	if (len == 0 || sc->len - *pos < (size_t) len || sc->buf[*pos + len - 1] != '\0')
+		return 0;
+	*str = sc->buf + *pos;
+	*pos += len;
+	return 1;
+}
+
+/**
+ * @brief
+ * 		send the run requests and job updates of a sub-cycle to the
+ *		server, in the order it made them.  An incomplete last record
+ *		of a sub-cycle which was killed is dropped.
+ *
+ * @param[in]	pbs_sd	-	connection to the server
+ * @param[in]	sinfo	-	the server universe
+ * @param[in]	sc	-	the partition
+ *
+ * @return	void
+ */
+static void
+sub_cycle_replay(int pbs_sd, server_info *sinfo, struct sub_cycle *sc)
+{
+	size_t pos = 0;
+	int runs = 0;
+	int updates = 0;
+
+	while (pos < sc->len) {
+		char tag = sc->buf[pos++];
+		char *jobid;
+
+		if (!sub_cycle_get_str(sc, &pos, &jobid) || jobid == NULL)
+			break;
+
+		if (tag == 'R') {
+			char *execvnode;
+
+			if (!sub_cycle_get_str(sc, &pos, &execvnode))
+				break;
+			send_sub_cycle_run(pbs_sd, sinfo, jobid, execvnode);
+			runs++;
+		} else if (tag == 'U' || tag == 'N') {
+			struct attrl *pattr = NULL;
+			struct attrl **tail = &pattr;
+			int count;
+			int op;
+			int i;
+
+			if (!sub_cycle_get_int(sc, &pos, &count))
+				break;
+			for (i = 0; i < count; i++) {
+				char *name;
+				char *resource;
+				char *value;
+
+				if (!sub_cycle_get_str(sc, &pos, &name) ||
+					!sub_cycle_get_str(sc, &pos, &resource) ||
+					!sub_cycle_get_str(sc, &pos, &value) ||
+					!sub_cycle_get_int(sc, &pos, &op))
+					break;
+				if ((*tail = new_attrl()) == NULL)
+					break;
+				(*tail)->name = string_dup(name);
+				(*tail)->resource = string_dup(resource);
+				(*tail)->value = string_dup(value);
+				(*tail)->op = (enum batch_op) op;
+				tail = &(*tail)->next;
+			}
+			if (i < count || pattr == NULL) {
+				free_attrl_list(pattr);
+				break;
+			}
+			if (tag == 'N') {
+				send_attr_updates(pbs_sd, jobid, pattr);
+				free_attrl_list(pattr);
+			} else
+				queue_attr_updates(pbs_sd, jobid, pattr);
+			updates++;
+		} else
+			break;
+	}
+
+	log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+		"Sub-cycle of partition %s: %d run requests, %d job updates",
+		sc->partition, runs, updates);
+}
+
+/**
+ * @brief
+ * 		wait for a sub-cycle to exit and send what it did to the server
+ *
+ * @param[in]	pbs_sd	-	connection to the server
+ * @param[in]	sinfo	-	the server universe
+ * @param[in,out]	sc	-	the partition
+ * @param[in]	kill_it	-	the sub-cycle ran too long, kill it first
+ * @param[out]	recycle	-	set if the cycle should be restarted
+ *
+ * @return	void
+ */
+static void
+sub_cycle_finish(int pbs_sd, server_info *sinfo, struct sub_cycle *sc,
+	int kill_it, int *recycle)
+{
+	int status = 0;
+
+	if (kill_it) {
+		kill(sc->pid, SIGKILL);
+		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING, __func__,
+			"Sub-cycle of partition %s ran past the cycle length, killed",
+			sc->partition);
+	}
+	close(sc->fd);
+	sc->fd = -1;
+
+	while (waitpid(sc->pid, &status, 0) == -1 && errno == EINTR)
+		;
+	if (!kill_it) {
+		if (WIFEXITED(status) && WEXITSTATUS(status) == 1)
+			*recycle = 1;
+		else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING, __func__,
+				"Sub-cycle of partition %s failed", sc->partition);
+	}
+	sc->pid = 0;
+
+	sub_cycle_replay(pbs_sd, sinfo, sc);
+	free(sc->buf);
+	sc->buf = NULL;
+	sc->len = sc->size = 0;
+}
+
+/**
+ * @brief
+ * 		wait until at least one running sub-cycle is done, or the
+ *		deadline passes and all of them are killed
+ *
+ * @param[in]	pbs_sd	-	connection to the server
+ * @param[in]	sinfo	-	the server universe
+ * @param[in,out]	subs	-	the partitions
+ * @param[in]	num	-	number of partitions in subs
+ * @param[in]	deadline	-	when the sub-cycles are killed, 0 for never
+ * @param[out]	recycle	-	set if the cycle should be restarted
+ *
+ * @return	int
+ * @retval	number of sub-cycles which are done
+ */
+static int
+sub_cycle_collect(int pbs_sd, server_info *sinfo, struct sub_cycle *subs,
+	int num, time_t deadline, int *recycle)
+{
+	struct pollfd pfd[PARTITION_SUB_CYCLES_MAX];
+	int idx[PARTITION_SUB_CYCLES_MAX];
+	int done = 0;
+	int npfd;
+	int rc;
+	int i;
+
+	while (done == 0) {
+		int wait_ms = -1;
+
+		for (npfd = 0, i = 0; i < num && npfd < PARTITION_SUB_CYCLES_MAX; i++) {
+			if (subs[i].pid > 0) {
+				pfd[npfd].fd = subs[i].fd;
+				pfd[npfd].events = POLLIN;
+				pfd[npfd].revents = 0;
+				idx[npfd++] = i;
+			}
+		}
+		if (npfd == 0)
+			break;
+
+		if (deadline) {
+			time_t now = time(NULL);
+
+			if (now >= deadline) {
+				for (i = 0; i < npfd; i++)
+					sub_cycle_finish(pbs_sd, sinfo, &subs[idx[i]], 1, recycle);
+				return npfd;
+			}
+			wait_ms = (deadline - now) * 1000;
+		}
+
+		rc = poll(pfd, npfd, wait_ms);
+		if (rc == -1 && errno == EINTR)
+			continue;
+		if (rc == -1) {
+			log_err(errno, __func__, "poll failed");
+			for (i = 0; i < npfd; i++)
+				sub_cycle_finish(pbs_sd, sinfo, &subs[idx[i]], 1, recycle);
+			return npfd;
+		}
+
+		for (i = 0; i < npfd; i++) {
+			if (pfd[i].revents == 0)
+				continue;
+			rc = sub_cycle_read(&subs[idx[i]]);
+			if (rc <= 0) {
+				sub_cycle_finish(pbs_sd, sinfo, &subs[idx[i]], rc < 0, recycle);
+				done++;
+			}
+		}
+	}
+
+	return done;
+}
+
+/**
+ * @brief
+ * 		schedule independent partitions in parallel sub-cycles, at most
+ *		partition_sub_cycles at a time.  A partition whose sub-cycle can
+ *		not be started is scheduled by the scheduler itself afterwards.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	pbs_sd	-	connection to the server
+ * @param[in]	sinfo	-	the server universe
+ *
+ * @return	int
+ * @retval	1	: the partitions were scheduled
+ * @retval	0	: sub-cycles are not used, call main_sched_loop()
+ * @retval	-1	: the partitions were scheduled, the cycle should be restarted
+ */
+int
+partition_sub_cycles(status *policy, int pbs_sd, server_info *sinfo)
+{
+	struct sub_cycle *subs;
+	struct sub_cycle_saved *saved;
+	char **parts;
+	time_t deadline = 0;
+	int recycle = 0;
+	int running = 0;
+	int num;
+	int next;
+	int i;
+
+	if (conf.partition_sub_cycles < 2 || pbs_sd == SIMULATE_SD)
+		return 0;
+
+	if ((parts = sub_cycle_partitions(policy, sinfo)) == NULL)
+		return 0;
+	num = count_array((void **) parts);
+
+	if ((subs = calloc(num, sizeof(struct sub_cycle))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free_string_array(parts);
+		return 0;
+	}
+	if ((saved = sub_cycle_save(sinfo)) == NULL) {
+		free(subs);
+		free_string_array(parts);
+		return 0;
+	}
+
+	log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+		"Scheduling %d partitions in sub-cycles", num);
+
+	if (sinfo->sched_cycle_len > 0)
+		deadline = time(NULL) + sinfo->sched_cycle_len + SUB_CYCLE_GRACE;
+
+	for (i = 0; i < num; i++) {
+		subs[i].partition = parts[i];
+		subs[i].pid = -1;
+		subs[i].fd = -1;
+	}
+
+	for (next = 0; next < num || running > 0;) {
+		while (next < num && running < conf.partition_sub_cycles) {
+			if (sub_cycle_start(policy, pbs_sd, sinfo, saved, &subs[next]))
+				running++;
+			next++;
+		}
+		if (running == 0)
+			continue;
+		running -= sub_cycle_collect(pbs_sd, sinfo, subs, next, deadline, &recycle);
+	}
+
+	/* whatever could not be forked is scheduled here, one after the other */
+	for (i = 0; i < num; i++) {
+		if (subs[i].pid == -1) {
+			schd_error *err = NULL;
+
+			sub_cycle_mark(saved, subs[i].partition);
+			if (main_sched_loop(policy, pbs_sd, sinfo, &err) < 0)
+				recycle = 1;
+			free_schd_error(err);
+		}
+	}
+
+	free(saved);
+	free(subs);
+	free_string_array(parts);
+
+	return recycle ? -1 : 1;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+#ifndef	_SUB_CYCLE_H
+#define	_SUB_CYCLE_H
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <pbs_ifl.h>
+#include "data_types.h"
+
+/*
+ *	partition_sub_cycles - schedule independent partitions in parallel
+ *			       sub-cycles (partition_sub_cycles)
+ */
+int partition_sub_cycles(status *policy, int pbs_sd, server_info *sinfo);
+
+/*
+ *	sub_cycle_child - is this process a sub-cycle of a partition
+ */
+int sub_cycle_child(void);
+
+/*
+ *	sub_cycle_put_run - pass a run request of a sub-cycle to the
+ *			    scheduler which forked it
+ */
+int sub_cycle_put_run(char *jobid, char *execvnode);
+
+/*
+ *	sub_cycle_put_update - pass job attribute updates of a sub-cycle to
+ *			       the scheduler which forked it
+ */
+int sub_cycle_put_update(char *jobid, struct attrl *pattr, int now);
+
+#ifdef	__cplusplus
+}
+#endif
+#endif	/* _SUB_CYCLE_H */
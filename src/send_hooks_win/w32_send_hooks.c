@@ -95,6 +95,7 @@
 #include "pbs_ecl.h"
 #include  "pbs_nodes.h"
 #include "hook_func.h"
+#include "name_idx.h"
 
 
 /* Global Data Items */
@@ -146,7 +147,7 @@ char		*path_svrdb;  /* path to server db */
 char		*path_nodestate; /* path to node state file */
 char		*path_nodes; /* path to nodes file */
 char		*path_resvs; /* path to resvs directory */
-AVL_IX_DESC	*AVL_jctx = NULL; /* used for the jobs AVL tree */
+name_idx	*jobs_idx = NULL; /* used for the job id index */
 /*
  * Used only by the TPP layer, to ping nodes only if the connection to the
  * local router to the server is up.
@@ -46,6 +46,9 @@
  *	acct_open()
  *	acct_record()
  *	acct_close()
+ *	acct_hold()
+ *	acct_async_start()
+ *	acct_bin_record()
  */
 
 
@@ -54,6 +57,10 @@
 #include "portability.h"
 #ifndef  WIN32
 #include <sys/param.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
 #endif
 #include <sys/types.h>
 #include <string.h>
@@ -72,10 +79,12 @@
 #include "pbs_nodes.h"
 #include "log.h"
 #include "acct.h"
+#include "acct_bin.h"
 #include "pbs_license.h"
 #include "server.h"
 #include "svrfunc.h"
 #include "libutil.h"
+#include "pbs_internal.h"
 
 /* Local Data */
 
@@ -83,15 +92,70 @@ static FILE *acctfile;		/* open stream for log file */
 static volatile int acct_opened = 0;
 static int acct_opened_day;
 static int acct_auto_switch = 0;
+static int acct_held = 0;	/* records are not flushed while set */
 static char *acct_buf = 0;
 static int acct_bufsize = PBS_ACCT_MAX_RCD;
 static const char *do_not_emit_alter[] = {ATTR_estimated, ATTR_used, NULL};
 
+#ifndef WIN32
+/*
+ * Asynchronous accounting, see acct_async_start().
+ *
+ * Records are formatted by write_account_record() and appended to the
+ * active one of two buffers.  The writer thread swaps the buffers, then
+ * writes the full one to the accounting file and syncs it to disk, so
+ * the records recorded while the disk is busy are written together.
+ * Unlike log records, accounting records are never dropped: a record
+ * that does not fit waits for the writer thread.  The file mutex is
+ * held while the file is written, and is always taken with the buffer
+ * mutex held so records are written in the order they were recorded.
+ */
+struct acct_async_rec {
+	int	ar_yday;	/* day of the year the record was recorded */
+	int	ar_len;		/* length of the text that follows */
+};
+
+static pthread_mutex_t	acct_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t	acct_file_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	acct_async_cond = PTHREAD_COND_INITIALIZER;	/* records queued */
+static pthread_cond_t	acct_space_cond = PTHREAD_COND_INITIALIZER;	/* buffers swapped */
+static pthread_t	acct_async_thread;
+static size_t		acct_async_size = 0;	/* size of each buffer, 0 if not asynchronous */
+static int		acct_async_running = 0;	/* the writer thread is running */
+static int		acct_async_stop = 0;	/* the writer thread is asked to stop */
+static char		*acct_async_buf[2] = {NULL, NULL};
+static int		acct_async_active = 0;	/* buffer being appended to */
+static size_t		acct_async_used = 0;	/* bytes used in the active buffer */
+static unsigned int	acct_async_flush_secs = 0; /* seconds a batch may wait, 0 to write at once */
+static time_t		acct_async_first = 0;	/* when the first record of the batch was queued */
+static int		acct_async_waiters = 0;	/* records waiting for buffer space */
+
+static int acct_async_run(void);
+
+/* binary accounting records, see acct_bin.h */
+struct acct_bin_kv {
+	char	*kv_key;
+	size_t	kv_klen;
+	char	*kv_val;
+	size_t	kv_vlen;
+	int	kv_field;	/* fixed field it is written as, or -1 */
+};
+
+static FILE		*acct_bin_file = NULL;
+static int		acct_bin_opened_day;
+static char		*acct_bin_buf = NULL;	/* the record being built */
+static size_t		acct_bin_size = 0;
+static size_t		acct_bin_used = 0;
+static struct acct_bin_kv *acct_bin_kv = NULL;	/* words of the record's text */
+static int		acct_bin_nkv = 0;
+#endif
+
 /* Global Data */
 
 extern char *acctlog_spacechar;
 extern attribute_def job_attr_def[];
 extern char *path_acct;
+extern char *path_priv;
 extern int resc_access_perm;
 extern time_t time_now;
 extern struct resc_sum *svr_resc_sum;
@@ -939,6 +1003,7 @@ acct_open(char *filename)
 #endif
 	FILE *newacct;
 	time_t now;
+	struct tm tm;
 	struct tm *ptm;
 
 	if (acct_buf == NULL) {	/* malloc buffer space */
@@ -949,7 +1014,10 @@ acct_open(char *filename)
 
 	if (filename == NULL) {	/* go with default */
 		now = time(0);
-		ptm = localtime(&now);
+		/* also called by the writer thread, so not localtime() */
+		ptm = localtime_r(&now, &tm);
+		if (ptm == NULL)
+			return (-1);
 		(void)sprintf(filen, "%s%04d%02d%02d",
 			path_acct,
 			ptm->tm_year+1900, ptm->tm_mon+1, ptm->tm_mday);
@@ -971,7 +1039,7 @@ acct_open(char *filename)
 	(void)setvbuf(newacct, NULL, _IONBF, 0); /* no buffering to get instant
 						  log*/
 #else
-	(void)setvbuf(newacct, NULL, _IOLBF, 0); /* set line buffering */
+	(void)setvbuf(newacct, NULL, _IOFBF, 0); /* flushed by write_account_record */
 #endif
 
 	if (acct_opened > 0) 		/* if acct was open, close it */
@@ -983,6 +1051,12 @@ acct_open(char *filename)
 	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO,
 		"Act", logmsg);
 
+#ifndef WIN32
+	/* restart the writer thread stopped by acct_close() */
+	if ((acct_async_size > 0) && (acct_async_run() != 0))
+		log_err(-1, __func__, "unable to restart the accounting writer thread, accounting synchronously");
+#endif
+
 	return (0);
 }
 
@@ -996,11 +1070,644 @@ void
 acct_close()
 {
 	if (acct_opened == 1) {
+#ifndef WIN32
+		/* stop the writer thread, which writes what is queued first */
+		if (acct_async_running) {
+			(void)pthread_mutex_lock(&acct_async_mutex);
+			acct_async_stop = 1;
+			(void)pthread_cond_signal(&acct_async_cond);
+			(void)pthread_mutex_unlock(&acct_async_mutex);
+			(void)pthread_join(acct_async_thread, NULL);
+			acct_async_running = 0;
+		}
+#endif
 		(void)fclose(acctfile);
 		acct_opened = 0;
 	}
+#ifndef WIN32
+	if (acct_bin_file != NULL) {
+		(void)fclose(acct_bin_file);
+		acct_bin_file = NULL;
+	}
+#endif
+}
+
+#ifndef WIN32
+/**
+ * @brief
+ *	Write a buffer of records queued for the writer thread to the
+ *	accounting file, and sync the file to disk.  The caller holds the
+ *	file mutex.
+ *
+ * @param[in]	buf - the records
+ * @param[in]	used - bytes used in buf
+ *
+ * @return	void
+ */
+static void
+acct_async_write(char *buf, size_t used)
+{
+	struct acct_async_rec rec;
+	size_t off = 0;
+
+	while (off < used) {
+		memcpy(&rec, buf + off, sizeof(rec));
+		off += sizeof(rec);
+
+		/* Do we need to switch files, acct_open() closes the old one */
+		if (acct_auto_switch && (acct_opened_day != rec.ar_yday)) {
+			if (acct_opened == 1) {
+				(void)fflush(acctfile);
+				(void)fsync(fileno(acctfile));
+			}
+			acct_open(NULL);
+		}
+		if (acct_opened == 1)
+			(void)fwrite(buf + off, 1, rec.ar_len, acctfile);
+		off += rec.ar_len;
+	}
+	if (acct_opened == 1) {
+		(void)fflush(acctfile);
+		(void)fsync(fileno(acctfile));
+	}
+}
+
+/**
+ * @brief
+ *	Queue a formatted record for the writer thread, waiting for it
+ *	while the active buffer is full.  A record larger than a buffer is
+ *	written directly once the records queued before it are written.
+ *
+ * @param[in]	yday - day of the year the record was recorded
+ * @param[in]	head - the time stamp and record type
+ * @param[in]	id - the record id
+ * @param[in]	text - the rest of the record
+ *
+ * @return	void
+ */
+static void
+acct_async_put(int yday, char *head, char *id, char *text)
+{
+	struct acct_async_rec rec;
+	size_t hlen = strlen(head);
+	size_t ilen = strlen(id);
+	size_t tlen = strlen(text);
+	size_t need = sizeof(rec) + hlen + ilen + 1 + tlen + 1;
+	char *buf;
+
+	(void)pthread_mutex_lock(&acct_async_mutex);
+	if (need > acct_async_size) {
+		while (acct_async_used > 0) {
+			acct_async_waiters++;
+			(void)pthread_cond_signal(&acct_async_cond);
+			(void)pthread_cond_wait(&acct_space_cond, &acct_async_mutex);
+			acct_async_waiters--;
+		}
+		(void)pthread_mutex_lock(&acct_file_mutex);
+		if (acct_auto_switch && (acct_opened_day != yday))
+			acct_open(NULL);
+		if (acct_opened == 1) {
+			(void)fprintf(acctfile, "%s%s;%s\n", head, id, text);
+			(void)fflush(acctfile);
+		}
+		(void)pthread_mutex_unlock(&acct_file_mutex);
+		(void)pthread_mutex_unlock(&acct_async_mutex);
+		return;
+	}
+	while (acct_async_used + need > acct_async_size) {
+		acct_async_waiters++;
+		(void)pthread_cond_signal(&acct_async_cond);
+		(void)pthread_cond_wait(&acct_space_cond, &acct_async_mutex);
+		acct_async_waiters--;
+	}
+
+	if (acct_async_used == 0)
+		acct_async_first = time(NULL);
+	rec.ar_yday = yday;
+	rec.ar_len = need - sizeof(rec);
+	buf = acct_async_buf[acct_async_active] + acct_async_used;
+	memcpy(buf, &rec, sizeof(rec));
+	buf += sizeof(rec);
+	memcpy(buf, head, hlen);
+	buf += hlen;
+	memcpy(buf, id, ilen);
+	buf += ilen;
+	*buf++ = ';';
+	memcpy(buf, text, tlen);
+	buf += tlen;
+	*buf = '\n';
+	acct_async_used += need;
+	(void)pthread_cond_signal(&acct_async_cond);
+	(void)pthread_mutex_unlock(&acct_async_mutex);
+}
+
+/**
+ * @brief
+ *	The writer thread: write the records queued by
+ *	write_account_record() until asked to stop, then write any left.
+ *
+ * @param[in]	arg - unused
+ *
+ * @return	NULL
+ */
+static void *
+acct_async_writer(void *arg)
+{
+	char *buf;
+	size_t used;
+
+	(void)pthread_mutex_lock(&acct_async_mutex);
+	for (;;) {
+		while ((acct_async_used == 0) && !acct_async_stop)
+			(void)pthread_cond_wait(&acct_async_cond, &acct_async_mutex);
+		if (acct_async_used == 0)
+			break;
+
+		/*
+		 * With a flush interval, let the batch grow until the interval
+		 * has passed since its first record, the buffer is half full or
+		 * the server waits for space, so it is synced to disk once.
+		 */
+		if (acct_async_flush_secs > 0) {
+			struct timespec ts;
+
+			ts.tv_sec = acct_async_first + acct_async_flush_secs;
+			ts.tv_nsec = 0;
+			while (!acct_async_stop && (acct_async_waiters == 0) &&
+				(acct_async_used <= acct_async_size / 2)) {
+				if (pthread_cond_timedwait(&acct_async_cond,
+					&acct_async_mutex, &ts) == ETIMEDOUT)
+					break;
+			}
+		}
+
+		/* swap the buffers so records can be queued while this one is written */
+		buf = acct_async_buf[acct_async_active];
+		used = acct_async_used;
+		acct_async_active ^= 1;
+		acct_async_used = 0;
+		(void)pthread_mutex_lock(&acct_file_mutex);
+		(void)pthread_cond_broadcast(&acct_space_cond);
+		(void)pthread_mutex_unlock(&acct_async_mutex);
+
+		acct_async_write(buf, used);
+		(void)pthread_mutex_unlock(&acct_file_mutex);
+
+		(void)pthread_mutex_lock(&acct_async_mutex);
+	}
+	(void)pthread_mutex_unlock(&acct_async_mutex);
+	return NULL;
+}
+
+/**
+ * @brief
+ *	Write the records queued for the writer thread.  Registered with
+ *	atexit() so records are not lost when the server exits without
+ *	closing the accounting file.
+ *
+ * @return	void
+ */
+static void
+acct_async_flush(void)
+{
+	char *buf;
+	size_t used;
+
+	(void)pthread_mutex_lock(&acct_async_mutex);
+	if (acct_async_used == 0) {
+		(void)pthread_mutex_unlock(&acct_async_mutex);
+		return;
+	}
+	buf = acct_async_buf[acct_async_active];
+	used = acct_async_used;
+	acct_async_active ^= 1;
+	acct_async_used = 0;
+	(void)pthread_mutex_lock(&acct_file_mutex);
+	(void)pthread_mutex_unlock(&acct_async_mutex);
+
+	acct_async_write(buf, used);
+	(void)pthread_mutex_unlock(&acct_file_mutex);
+}
+
+/**
+ * @brief
+ *	pthread_atfork() handlers: the writer thread is not in a child, so
+ *	a child writes accounting synchronously.
+ */
+static void
+acct_atfork_prepare(void)
+{
+	(void)pthread_mutex_lock(&acct_async_mutex);
+	(void)pthread_mutex_lock(&acct_file_mutex);
+}
+
+static void
+acct_atfork_parent(void)
+{
+	(void)pthread_mutex_unlock(&acct_file_mutex);
+	(void)pthread_mutex_unlock(&acct_async_mutex);
+}
+
+static void
+acct_atfork_child(void)
+{
+	acct_async_size = 0;
+	acct_async_running = 0;
+	acct_async_used = 0;
+	(void)pthread_mutex_unlock(&acct_file_mutex);
+	(void)pthread_mutex_unlock(&acct_async_mutex);
+}
+
+/**
+ * @brief
+ *	Start the writer thread if accounting is asynchronous and it is
+ *	not running.
+ *
+ * @return	int
+ * @retval	0	- the writer thread is running
+ * @retval	-1	- it could not be started, accounting is synchronous
+ */
+static int
+acct_async_run(void)
+{
+	if (acct_async_running)
+		return 0;
+
+	acct_async_stop = 0;
+	if (pthread_create(&acct_async_thread, NULL, acct_async_writer, NULL) != 0) {
+		acct_async_size = 0;
+		return -1;
+	}
+	acct_async_running = 1;
+	return 0;
 }
 
+/**
+ * @brief
+ *	Make accounting asynchronous: write_account_record() queues each
+ *	record in a buffer and a writer thread writes the buffer to the
+ *	accounting file and syncs it to disk.
+ *
+ * @par
+ *	Called once the server is in the background, since the writer
+ *	thread does not survive a fork.  The records queued are written by
+ *	acct_close() and when the server exits.
+ *
+ * @param[in]	size - size in bytes of each of the two buffers
+ * @param[in]	flush - seconds the records of a batch may wait before
+ *			they are written and synced, 0 to write them at once
+ *
+ * @return	int
+ * @retval	0	- accounting is asynchronous
+ * @retval	-1	- accounting stays synchronous
+ *
+ * @par MT-safe: No
+ */
+int
+acct_async_start(size_t size, unsigned int flush)
+{
+	static int registered = 0;
+
+	if ((size == 0) || acct_async_running || (acct_opened != 1))
+		return -1;
+
+	if ((acct_async_buf[0] = malloc(size)) == NULL)
+		return -1;
+	if ((acct_async_buf[1] = malloc(size)) == NULL) {
+		free(acct_async_buf[0]);
+		acct_async_buf[0] = NULL;
+		return -1;
+	}
+	acct_async_size = size;
+	acct_async_flush_secs = flush;
+	acct_async_active = 0;
+	acct_async_used = 0;
+
+	if (acct_async_run() != 0) {
+		free(acct_async_buf[0]);
+		free(acct_async_buf[1]);
+		acct_async_buf[0] = acct_async_buf[1] = NULL;
+		return -1;
+	}
+
+	if (!registered) {
+		(void)atexit(acct_async_flush);
+		(void)pthread_atfork(acct_atfork_prepare, acct_atfork_parent,
+			acct_atfork_child);
+		registered = 1;
+	}
+	return 0;
+}
+#endif
+
+/**
+ * @brief
+ * acct_hold - hold accounting records in the buffer while many are written
+ *	together, and flush them when the hold is released
+ *
+ * @param[in]	hold - 1 to hold the records, 0 to flush them
+ *
+ * @return	void
+ */
+void
+acct_hold(int hold)
+{
+	acct_held = hold;
+#ifndef WIN32
+	if ((hold == 0) && (acct_bin_file != NULL))
+		(void)fflush(acct_bin_file);
+	if (acct_async_running)
+		return;		/* the writer thread flushes */
+#endif
+	if ((hold == 0) && (acct_opened == 1))
+		(void)fflush(acctfile);
+}
+
+#ifndef WIN32
+/**
+ * @brief
+ *	Make room for need more bytes in the binary record buffer.
+ *
+ * @param[in]	need - bytes needed
+ *
+ * @return	int
+ * @retval	0	- there is room
+ * @retval	-1	- out of memory
+ */
+static int
+acct_bin_need(size_t need)
+{
+	char *nb;
+	size_t nsize;
+
+	if (acct_bin_used + need <= acct_bin_size)
+		return 0;
+	nsize = acct_bin_size ? acct_bin_size : 4096;
+	while (acct_bin_used + need > nsize)
+		nsize *= 2;
+	if ((nb = realloc(acct_bin_buf, nsize)) == NULL)
+		return -1;
+	acct_bin_buf = nb;
+	acct_bin_size = nsize;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Append an integer of nbytes bytes, little endian, to the binary
+ *	record buffer.  The caller has made room for it.
+ *
+ * @param[in]	val - the value
+ * @param[in]	nbytes - its size, 1, 2, 4 or 8
+ *
+ * @return	void
+ */
+static void
+acct_bin_put_int(uint64_t val, int nbytes)
+{
+	int i;
+
+	for (i = 0; i < nbytes; i++)
+		acct_bin_buf[acct_bin_used++] = (char)((val >> (8 * i)) & 0xff);
+}
+
+/**
+ * @brief
+ *	Append a length prefixed string to the binary record buffer.
+ *
+ * @param[in]	str - the string, need not be null terminated
+ * @param[in]	len - its length
+ *
+ * @return	int
+ * @retval	0	- appended
+ * @retval	-1	- out of memory
+ */
+static int
+acct_bin_put_str(const char *str, size_t len)
+{
+	if (acct_bin_need(4 + len) != 0)
+		return -1;
+	acct_bin_put_int(len, 4);
+	memcpy(acct_bin_buf + acct_bin_used, str, len);
+	acct_bin_used += len;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Open the binary accounting file for the day of ptm, creating the
+ *	directory and writing the file header if needed.  The file
+ *	already open, if any, is closed.
+ *
+ * @param[in]	ptm - the time of the record to write
+ *
+ * @return	int
+ * @retval	0	- the file is open
+ * @retval	-1	- it could not be opened
+ */
+static int
+acct_bin_open(struct tm *ptm)
+{
+	char filen[_POSIX_PATH_MAX];
+	char logmsg[_POSIX_PATH_MAX+80];
+	FILE *newbin;
+	struct stat sb;
+
+	(void)snprintf(filen, sizeof(filen), "%s%s", path_priv, PBS_ACCT_BIN);
+	if ((mkdir(filen, 0755) == -1) && (errno != EEXIST)) {
+		log_err(errno, __func__, filen);
+		return -1;
+	}
+	(void)snprintf(filen, sizeof(filen), "%s%s/%04d%02d%02d",
+		path_priv, PBS_ACCT_BIN,
+		ptm->tm_year+1900, ptm->tm_mon+1, ptm->tm_mday);
+	if ((newbin = fopen(filen, "a")) == NULL) {
+		log_err(errno, __func__, filen);
+		return -1;
+	}
+	(void)setvbuf(newbin, NULL, _IOFBF, 0);
+	if ((fstat(fileno(newbin), &sb) == 0) && (sb.st_size == 0))
+		(void)fwrite(ACCT_BIN_MAGIC, 1, ACCT_BIN_MAGIC_LEN, newbin);
+
+	if (acct_bin_file != NULL)
+		(void)fclose(acct_bin_file);
+	acct_bin_file = newbin;
+	acct_bin_opened_day = ptm->tm_yday;
+	(void)snprintf(logmsg, sizeof(logmsg), "Binary account file %s opened", filen);
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO,
+		"Act", logmsg);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Split the key=value words of an accounting record's text, as
+ *	quoted by cpy_quote_value(), into acct_bin_kv.
+ *
+ * @param[in]	text - the text of the record
+ *
+ * @return	int
+ * @retval	>=0	- the number of words
+ * @retval	-1	- out of memory
+ */
+static int
+acct_bin_split(char *text)
+{
+	char *p = text;
+	char *e;
+	char q;
+	int n = 0;
+	struct acct_bin_kv *nkv;
+
+	while (*p != '\0') {
+		while (*p == ' ')
+			p++;
+		if (*p == '\0')
+			break;
+		if (n == acct_bin_nkv) {
+			nkv = realloc(acct_bin_kv, (acct_bin_nkv + 64) * sizeof(struct acct_bin_kv));
+			if (nkv == NULL)
+				return -1;
+			acct_bin_kv = nkv;
+			acct_bin_nkv += 64;
+		}
+		acct_bin_kv[n].kv_key = p;
+		while ((*p != '\0') && (*p != ' ') && (*p != '='))
+			p++;
+		acct_bin_kv[n].kv_klen = p - acct_bin_kv[n].kv_key;
+		if (*p != '=') {
+			acct_bin_kv[n].kv_val = p;
+			acct_bin_kv[n].kv_vlen = 0;
+		} else if ((*++p == '"') || (*p == '\'')) {
+			/* the closing quote is the one ending the word */
+			q = *p++;
+			for (e = strchr(p, q); e != NULL; e = strchr(e + 1, q))
+				if ((e[1] == ' ') || (e[1] == '\0'))
+					break;
+			if (e == NULL)
+				e = p + strlen(p);
+			acct_bin_kv[n].kv_val = p;
+			acct_bin_kv[n].kv_vlen = e - p;
+			p = (*e != '\0') ? e + 1 : e;
+		} else {
+			acct_bin_kv[n].kv_val = p;
+			while ((*p != '\0') && (*p != ' '))
+				p++;
+			acct_bin_kv[n].kv_vlen = p - acct_bin_kv[n].kv_val;
+		}
+		acct_bin_kv[n].kv_field = -1;
+		n++;
+	}
+	return n;
+}
+
+/**
+ * @brief
+ *	Write an accounting record to the binary accounting file, in the
+ *	format described in acct_bin.h.  Called by write_account_record()
+ *	when PBS_SERVER_ACCT_BINARY is set.
+ *
+ * @param[in]	acctype - accounting record type
+ * @param[in]	id - accounting record id
+ * @param[in]	text - text of the record
+ * @param[in]	ptm - local time of the record
+ *
+ * @return	void
+ */
+static void
+acct_bin_record(int acctype, char *id, char *text, struct tm *ptm)
+{
+	static const char *fields[] = ACCT_BIN_FIELD_NAMES;
+	long long ival[ACCT_BIN_NFIELDS];
+	unsigned int mask = 0;
+	int nmap = 0;
+	int nw;
+	int i;
+	int f;
+	char *end;
+
+	if ((acct_bin_file == NULL) || (acct_bin_opened_day != ptm->tm_yday)) {
+		if (acct_bin_open(ptm) != 0)
+			return;
+	}
+
+	if ((nw = acct_bin_split(text)) == -1)
+		goto nomem;
+	for (i = 0; i < nw; i++) {
+		for (f = 0; f < ACCT_BIN_NFIELDS; f++) {
+			if ((strlen(fields[f]) == acct_bin_kv[i].kv_klen) &&
+				(strncmp(fields[f], acct_bin_kv[i].kv_key, acct_bin_kv[i].kv_klen) == 0))
+				break;
+		}
+		if ((f == ACCT_BIN_NFIELDS) || (mask & (1 << f))) {
+			nmap++;
+			continue;
+		}
+		if (f >= ACCT_BIN_FIRST_INT) {
+			if (acct_bin_kv[i].kv_vlen == 0) {
+				nmap++;
+				continue;
+			}
+			ival[f] = strtoll(acct_bin_kv[i].kv_val, &end, 10);
+			if (end != acct_bin_kv[i].kv_val + acct_bin_kv[i].kv_vlen) {
+				nmap++;
+				continue;
+			}
+		}
+		acct_bin_kv[i].kv_field = f;
+		mask |= 1 << f;
+	}
+
+	acct_bin_used = 0;
+	if (acct_bin_need(4 + 8 + 1) != 0)
+		goto nomem;
+	acct_bin_used = 4;	/* the length, set below */
+	acct_bin_put_int((uint64_t)time_now, 8);
+	acct_bin_put_int((unsigned char)acctype, 1);
+	if ((acct_bin_put_str(id, strlen(id)) != 0) || (acct_bin_need(2) != 0))
+		goto nomem;
+	acct_bin_put_int(mask, 2);
+	for (f = 0; f < ACCT_BIN_NFIELDS; f++) {
+		if ((mask & (1 << f)) == 0)
+			continue;
+		for (i = 0; acct_bin_kv[i].kv_field != f; i++)
+			;
+		if (f >= ACCT_BIN_FIRST_INT) {
+			if (acct_bin_need(8) != 0)
+				goto nomem;
+			acct_bin_put_int((uint64_t)ival[f], 8);
+		} else if (acct_bin_put_str(acct_bin_kv[i].kv_val, acct_bin_kv[i].kv_vlen) != 0)
+			goto nomem;
+	}
+	if (nmap > 0xffff)
+		nmap = 0xffff;
+	if (acct_bin_need(2) != 0)
+		goto nomem;
+	acct_bin_put_int(nmap, 2);
+	for (i = 0; (i < nw) && (nmap > 0); i++) {
+		if (acct_bin_kv[i].kv_field != -1)
+			continue;
+		if ((acct_bin_put_str(acct_bin_kv[i].kv_key, acct_bin_kv[i].kv_klen) != 0) ||
+			(acct_bin_put_str(acct_bin_kv[i].kv_val, acct_bin_kv[i].kv_vlen) != 0))
+			goto nomem;
+		nmap--;
+	}
+
+	/* now the length of the rest of the record */
+	end = acct_bin_buf;
+	for (i = 0; i < 4; i++)
+		end[i] = (char)(((acct_bin_used - 4) >> (8 * i)) & 0xff);
+
+	(void)fwrite(acct_bin_buf, 1, acct_bin_used, acct_bin_file);
+	if (acct_held == 0)
+		(void)fflush(acct_bin_file);
+	return;
+
+nomem:
+	log_err(errno, __func__, "out of memory, binary accounting record not written");
+}
+#endif
+
 /**
  * @brief
  * write_account_record - write basic accounting record
@@ -1014,12 +1721,34 @@ acct_close()
 void
 write_account_record(int acctype, char *id, char *text)
 {
+	struct tm tm;
 	struct tm *ptm;
 
 	if (acct_opened == 0)
 		return;		/* file not open, don't bother */
 
-	ptm = localtime(&time_now);
+	/* the writer thread may be in localtime_r() in acct_open() */
+	if ((ptm = localtime_r(&time_now, &tm)) == NULL)
+		return;
+	if (text == NULL)
+		text = "";
+
+#ifndef WIN32
+	if (pbs_conf.pbs_server_acct_binary)
+		acct_bin_record(acctype, id, text, ptm);
+
+	if (acct_async_running) {
+		char head[64];
+
+		(void)snprintf(head, sizeof(head),
+			"%02d/%02d/%04d %02d:%02d:%02d;%c;",
+			ptm->tm_mon+1, ptm->tm_mday, ptm->tm_year+1900,
+			ptm->tm_hour, ptm->tm_min, ptm->tm_sec,
+			(char)acctype);
+		acct_async_put(ptm->tm_yday, head, id, text);
+		return;
+	}
+#endif
 
 	/* Do we need to switch files */
 
@@ -1027,14 +1756,14 @@ write_account_record(int acctype, char *id, char *text)
 		acct_close();
 		acct_open(NULL);
 	}
-	if (text == NULL)
-		text = "";
 
 	(void)fprintf(acctfile,
 		"%02d/%02d/%04d %02d:%02d:%02d;%c;%s;%s\n",
 		ptm->tm_mon+1, ptm->tm_mday, ptm->tm_year+1900,
 		ptm->tm_hour, ptm->tm_min, ptm->tm_sec,
 		(char)acctype, id, text);
+	if (acct_held == 0)
+		(void)fflush(acctfile);
 }
 
 /**
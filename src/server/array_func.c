@@ -213,13 +213,17 @@ numindex_to_offset(job *parent, int iindx)
 	int i;
 
 	ptbl = parent->ji_ajtrk;
-	if (ptbl == NULL)
+	if ((ptbl == NULL) || (ptbl->tkm_ct < 1) || (ptbl->tkm_step < 1))
 		return -1;
-	for (i=0; i<ptbl->tkm_ct; i++) {
-		if (ptbl->tkm_tbl[i].trk_index == iindx)
-			return i;
-	}
-	return -1;
+
+	/* the table is built from a single x-y:z range, so index is x + i*z */
+	i = iindx - ptbl->tkm_tbl[0].trk_index;
+	if ((i < 0) || (i % ptbl->tkm_step))
+		return -1;
+	i /= ptbl->tkm_step;
+	if ((i >= ptbl->tkm_ct) || (ptbl->tkm_tbl[i].trk_index != iindx))
+		return -1;
+	return i;
 }
 /**
  * @brief
@@ -234,22 +238,13 @@ numindex_to_offset(job *parent, int iindx)
 int
 subjob_index_to_offset(job *parent, char *index)
 {
-	struct ajtrkhd *ptbl;
-	int i;
 	int nidx;
 
 	if ((index == NULL) || (*index == '\0'))
 		return -1;
 
 	nidx = atoi(index);
-	ptbl = parent->ji_ajtrk;
-	if (ptbl == NULL)
-		return -1;
-	for (i=0; i<ptbl->tkm_ct; i++) {
-		if (ptbl->tkm_tbl[i].trk_index == nidx)
-			return i;
-	}
-	return -1;
+	return numindex_to_offset(parent, nidx);
 }
 /**
  * @brief
@@ -372,6 +367,8 @@ set_subjob_tblstate(job *parent, int offset, int newstate)
 {
 	int  		 oldstate;
 	struct ajtrkhd	*ptbl;
+	unsigned long	 bit;
+	unsigned long	*word;
 
 	if (offset == -1)
 		return;
@@ -392,8 +389,17 @@ set_subjob_tblstate(job *parent, int offset, int newstate)
 	ptbl->tkm_subjsct[oldstate]--;
 	ptbl->tkm_subjsct[newstate]++;
 
-	/* set flags in attribute so stat_job will update the attr string */
-	ptbl->tkm_flags |= TKMFLG_REVAL_IND_REMAINING;
+	bit = 1UL << (offset % TKM_WORDBITS);
+	word = TKM_STATE_MAP(ptbl, oldstate) + offset / TKM_WORDBITS;
+	*word &= ~bit;
+	word = TKM_STATE_MAP(ptbl, newstate) + offset / TKM_WORDBITS;
+	*word |= bit;
+
+	/* set flags in attribute so stat_job will update the attr strings, */
+	/* the remaining indices only change when a subjob enters or leaves Q */
+	ptbl->tkm_flags |= TKMFLG_REVAL_STATE_CT;
+	if ((oldstate == JOB_STATE_QUEUED) || (newstate == JOB_STATE_QUEUED))
+		ptbl->tkm_flags |= TKMFLG_REVAL_IND_REMAINING;
 
 }
 /**
@@ -416,9 +422,12 @@ update_array_indices_remaining_attr(job *parent)
 			pnewstr = "-";
 		job_attr_def[JOB_ATR_array_indices_remaining].at_free(premain);
 		job_attr_def[JOB_ATR_array_indices_remaining].at_decode(premain, 0, 0, pnewstr);
+		ptbl->tkm_flags &= ~TKMFLG_REVAL_IND_REMAINING;
+	}
+	if (ptbl->tkm_flags & TKMFLG_REVAL_STATE_CT) {
 		/* also update value of attribute "array_state_count" */
 		update_subjob_state_ct(parent);
-		ptbl->tkm_flags &= ~TKMFLG_REVAL_IND_REMAINING;
+		ptbl->tkm_flags &= ~TKMFLG_REVAL_STATE_CT;
 	}
 }
 /**
@@ -647,6 +656,7 @@ static struct ajtrkhd *mk_subjob_index_tbl(char *range, int initalstate, int *pb
 	char *eptr;
 	struct ajtrkhd *t;
 	size_t  sz;
+	unsigned long *map;
 
 	i = parse_subjob_index(range, &eptr, &x, &y, &z, &ct);
 	if (i != 0) {
@@ -666,7 +676,8 @@ static struct ajtrkhd *mk_subjob_index_tbl(char *range, int initalstate, int *pb
 		}
 	}
 
-	sz = sizeof(struct ajtrkhd) + ((ct-1) * sizeof(struct ajtrk));
+	sz = sizeof(struct ajtrkhd) + ((ct-1) * sizeof(struct ajtrk)) +
+		PBS_NUMJOBSTATE * TKM_NWORDS(ct) * sizeof(unsigned long);
 	t = (struct ajtrkhd *)malloc(sz);
 
 	if (t == NULL) {
@@ -689,8 +700,17 @@ static struct ajtrkhd *mk_subjob_index_tbl(char *range, int initalstate, int *pb
 		t->tkm_tbl[j].trk_substate  = JOB_SUBSTATE_FINISHED;
 		t->tkm_tbl[j].trk_stgout  = -1;
 		t->tkm_tbl[j].trk_exitstat  = 0;
+		t->tkm_tbl[j].trk_runcount  = 0;
+		t->tkm_tbl[j].trk_exechost  = NULL;
 		t->tkm_tbl[j].trk_psubjob = NULL;
 	}
+	memset(TKM_STATE_MAP(t, 0), 0,
+		PBS_NUMJOBSTATE * TKM_NWORDS(ct) * sizeof(unsigned long));
+	map = TKM_STATE_MAP(t, initalstate);
+	for (j = 0; j < ct / TKM_WORDBITS; j++)
+		map[j] = ~0UL;
+	if (ct % TKM_WORDBITS)
+		map[j] = (1UL << (ct % TKM_WORDBITS)) - 1;
 	return t;
 }
 /**
@@ -727,7 +747,7 @@ setup_arrayjob_attrs(attribute *pattr, void *pobj, int mode)
 
 	if (mode == ATR_ACTION_RECOV) {
 		/* set flags in attribute so stat_job will update the attr string */
-		pjob->ji_ajtrk->tkm_flags |= TKMFLG_REVAL_IND_REMAINING;
+		pjob->ji_ajtrk->tkm_flags |= (TKMFLG_REVAL_IND_REMAINING | TKMFLG_REVAL_STATE_CT);
 
 		return (PBSE_NONE);
 	}
@@ -1068,11 +1088,49 @@ mk_subjob_id(job *parent, int offset)
 	(void)strcat(jid, hold);
 	return jid;
 }
+/**
+ * @brief
+ * 		tkm_next_entry - find the next table entry at or after "from" whose
+ *		bit in a state map is set (want == 1) or clear (want == 0)
+ *
+ * @param[in]	map - state bitmap, see TKM_STATE_MAP()
+ * @param[in]	ct - number of entries in the table
+ * @param[in]	from - first entry to look at
+ * @param[in]	want - 1 to look for a set bit, 0 for a clear bit
+ *
+ * @return	offset of the entry, or ct if there is none
+ */
+static unsigned int
+tkm_next_entry(unsigned long *map, unsigned int ct, unsigned int from, int want)
+{
+	unsigned int  w;
+	unsigned long bits;
+
+	while (from < ct) {
+		w = from / TKM_WORDBITS;
+		bits = want ? map[w] : ~map[w];
+		bits &= ~0UL << (from % TKM_WORDBITS);
+		if (bits == 0) {
+			/* nothing in this word, skip all of it */
+			from = (w + 1) * TKM_WORDBITS;
+			continue;
+		}
+		from = w * TKM_WORDBITS;
+		while ((bits & 1UL) == 0) {
+			bits >>= 1;
+			from++;
+		}
+		break;
+	}
+	return (from < ct ? from : ct);
+}
 /**
  * @brief
  * 		cvt-range - convert entries in subjob index table which are in "state"
  * 		to a range of indices of subjobs.  range will be of form:
  * 		X,X-Y:Z,...
+ *		The entries are found from the state bitmap of the table, so
+ *		the cost follows the number of words and ranges, not entries.
  * @param[in]	t - pointer to subjob index table
  * @param[in]	state -  job state.
  * @return	Pointer to static buffer
@@ -1082,9 +1140,10 @@ char *
 cvt_range(struct ajtrkhd *t, int state)
 {
 	unsigned int f;	/* first of a pair or range   */
-	unsigned int n;  /* next one we are looking at */
-	unsigned int l;
-	int pcomma = 0;
+	unsigned int l;	/* last of a pair or range    */
+	unsigned int ct;
+	unsigned long *map;
+	size_t used = 0;
 	char *b2;
 	static char *buf = NULL;
 	static size_t   buflen = 0;
@@ -1098,50 +1157,36 @@ cvt_range(struct ajtrkhd *t, int state)
 			return NULL;
 	}
 	*buf = '\0';	/* initialize buf to empty */
-	f = 0;
-	while (f < t->tkm_ct) {
+	ct = t->tkm_ct;
+	map = TKM_STATE_MAP(t, state);
+
+	for (f = tkm_next_entry(map, ct, 0, 1); f < ct;
+		f = tkm_next_entry(map, ct, l + 1, 1)) {
 
-		if ((buflen - strlen(buf)) < 20) {
+		/* find the last entry of this run of entries in "state" */
+		l = tkm_next_entry(map, ct, f + 1, 0) - 1;
+
+		if ((buflen - used) < 40) {
 			/* expand buf */
-			buflen += 500;
+			buflen += 500 + buflen / 2;
 			b2 = realloc(buf, buflen);
 			if (b2 == NULL)
 				return NULL;
 			buf = b2;
 		}
 
-		/* find first incompleted entry */
-		if (t->tkm_tbl[f].trk_status == state) {
-			l = f;
-			n = f+1;
-			/* add "f" or ",f" */
-			if (pcomma)
-				sprintf(buf+strlen(buf), ",");
-			else
-				pcomma = 1;
-
-			sprintf(buf+strlen(buf), "%d", t->tkm_tbl[f].trk_index);
-
-			/* find next incomplete entry */
+		/* add "f" or ",f" */
+		if (used)
+			buf[used++] = ',';
+		used += sprintf(buf + used, "%d", t->tkm_tbl[f].trk_index);
 
-			while (n < t->tkm_ct) {
-				if (t->tkm_tbl[n].trk_status == state) {
-					l = n++;
-				} else {
-					break;
-				}
-			}
-			if (l > (f+1)) {
-				if (t->tkm_step > 1)
-					sprintf(buf+strlen(buf), "-%d:%d", t->tkm_tbl[l].trk_index, t->tkm_step);
-				else
-					sprintf(buf+strlen(buf), "-%d", t->tkm_tbl[l].trk_index);
-			} else if (l > f) {
-				sprintf(buf+strlen(buf), ",%d", t->tkm_tbl[l].trk_index);
-			}
-			f = l+1;
-		} else {
-			f++;
+		if (l > (f+1)) {
+			if (t->tkm_step > 1)
+				used += sprintf(buf + used, "-%d:%d", t->tkm_tbl[l].trk_index, t->tkm_step);
+			else
+				used += sprintf(buf + used, "-%d", t->tkm_tbl[l].trk_index);
+		} else if (l > f) {
+			used += sprintf(buf + used, ",%d", t->tkm_tbl[l].trk_index);
 		}
 	}
 
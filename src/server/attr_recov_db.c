@@ -46,8 +46,10 @@
  *
  * Included public functions are:
  *	save_attr_db		Save attributes to the database
+ *	unsave_attr_db		Mark attributes to be written by the next save
  *	recov_attr_db		Read attributes from the database
  *	make_attr		create a svrattrl structure from the attr_name, and values
+ *	find_attr_db		find the index of an attribute recovered from the database
  *	recov_attr_db_raw	Recover the list of attributes from the database without triggering
  *				the action routines
  */
@@ -68,6 +70,7 @@
 #include "svrfunc.h"
 #include "resource.h"
 #include "pbs_db.h"
+#include "name_idx.h"
 
 
 /* Global Variables */
@@ -76,6 +79,86 @@ extern int resc_access_perm;
 extern struct attribute_def	svr_attr_def[];
 extern struct attribute_def	que_attr_def[];
 
+/*
+ * Attribute name to index lookups, one per attribute definition array.
+ * Recovering many objects decodes the same names over and over, so
+ * the definitions are hashed the first time an array is seen rather than
+ * searched linearly for every attribute of every object.
+ */
+#define ATTR_DB_IDX_MAX	16
+static struct attr_db_idx {
+	struct attribute_def	*ai_padef;
+	int			 ai_limit;
+	name_idx		*ai_idx;
+} attr_db_idx[ATTR_DB_IDX_MAX];
+
+/**
+ * @brief
+ *	Find the index of an attribute definition by its name, as find_attr()
+ *	does, through a hash of the names in the definition array.
+ *
+ * @par
+ *	The names are written to the database exactly as they are defined,
+ *	so a name not found in the hash is looked up with find_attr(), which
+ *	also ignores case.  If the hash cannot be built, find_attr() is used.
+ *
+ * @param[in]	padef - attribute definition array
+ * @param[in]	name - name of the attribute
+ * @param[in]	limit - number of definitions in the array
+ *
+ * @return	int
+ * @retval	>=0	index of the attribute definition
+ * @retval	-1	no such attribute
+ *
+ */
+static int
+find_attr_db(struct attribute_def *padef, char *name, int limit)
+{
+	int i;
+	int j;
+	struct attr_db_idx *pai = NULL;
+	void *pdata;
+
+	for (i = 0; i < ATTR_DB_IDX_MAX; i++) {
+		if (attr_db_idx[i].ai_padef == padef &&
+			attr_db_idx[i].ai_limit == limit) {
+			pai = &attr_db_idx[i];
+			break;
+		}
+		if (attr_db_idx[i].ai_padef == NULL) {
+			attr_db_idx[i].ai_idx = create_name_idx();
+			if (attr_db_idx[i].ai_idx == NULL)
+				break;
+			for (j = 0; j < limit; j++) {
+				/* keep the first of any repeated name, as find_attr() */
+				if (find_name_idx(attr_db_idx[i].ai_idx,
+					padef[j].at_name) != NULL)
+					continue;
+				if (name_idx_add_del(attr_db_idx[i].ai_idx,
+					padef[j].at_name, (void *)(long)(j + 1),
+					NAME_IDX_OP_ADD) != 0)
+					break;
+			}
+			if (j < limit) {
+				free_name_idx(attr_db_idx[i].ai_idx);
+				attr_db_idx[i].ai_idx = NULL;
+				break;
+			}
+			attr_db_idx[i].ai_padef = padef;
+			attr_db_idx[i].ai_limit = limit;
+			pai = &attr_db_idx[i];
+			break;
+		}
+	}
+
+	if (pai != NULL) {
+		pdata = find_name_idx(pai->ai_idx, name);
+		if (pdata != NULL)
+			return ((int)(long)pdata - 1);
+	}
+	return (find_attr(padef, name, limit));
+}
+
 /**
  * @brief
  *	Create a svrattrl structure from the attr_name, and values
@@ -178,7 +261,7 @@ encode_attr_db(struct attribute_def *padef, struct attribute *pattr, int numattr
 
 	j = 0;
 	for (i = 0; i < numattr; i++) {
-		if (!((all == 1) || ((pattr+i)->at_flags & (ATR_VFLAG_MODIFY | ATR_VFLAG_MODCACHE))))
+		if (!((all == 1) || ((pattr+i)->at_flags & ATR_MOD_SAVE)))
 			continue;
 
 		rc = (padef+i)->at_encode(pattr+i, &lhead,
@@ -187,7 +270,7 @@ encode_attr_db(struct attribute_def *padef, struct attribute *pattr, int numattr
 		if (rc < 0)
 			return -1;
 
-		(pattr+i)->at_flags &= ~ATR_VFLAG_MODIFY;
+		clear_mod_save(pattr+i);
 	}
 	count = 0;
 	pal = (svrattrl *)GET_NEXT(lhead);
@@ -229,6 +312,28 @@ encode_attr_db(struct attribute_def *padef, struct attribute *pattr, int numattr
 	return 0;
 }
 
+/**
+ * @brief
+ *	Mark the attributes to be written by the next save, after a save that
+ *	encoded them with encode_attr_db() failed.
+ *
+ * @param[in,out] pattr - Address of the parent objects attribute array
+ * @param[in]	numattr - Number of attributes in the list
+ *
+ * @return	void
+ *
+ */
+void
+unsave_attr_db(struct attribute *pattr, int numattr)
+{
+	int i;
+
+	for (i = 0; i < numattr; i++) {
+		if ((pattr+i)->at_flags & ATR_VFLAG_SET)
+			(pattr+i)->at_flags |= ATR_VFLAG_MODSAVE;
+	}
+}
+
 /**
  * @brief
  *	Decode the list of attributes from the database to the regular attribute structure
@@ -323,7 +428,7 @@ decode_attr_db(
 		pal->al_refct = 1;	/* ref count reset to 1 */
 
 		/* find the attribute definition based on the name */
-		index = find_attr(padef, pal->al_name, limit);
+		index = find_attr_db(padef, pal->al_name, limit);
 		if (index < 0) {
 
 			/*
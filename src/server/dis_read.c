@@ -517,11 +517,9 @@ dis_request_read(int sfds, struct batch_request *request)
 	if (rc != 0) {
 		if (rc == DIS_EOF)
 			return EOF;
-		(void)sprintf(log_buffer,
-			"Req Header bad, errno %d, dis error %d",
+		log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
+			"?", "Req Header bad, errno %d, dis error %d",
 			errno, rc);
-		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
-			"?", log_buffer);
 
 		return PBSE_DISPROTO;
 	}
@@ -689,8 +687,32 @@ dis_request_read(int sfds, struct batch_request *request)
 			decode_DIS_PreemptJobs(sfds, request);
 			break;
 
+		case PBS_BATCH_ModifyJobs:
+			rc = decode_DIS_ModifyJobs(sfds, request);
+			break;
+
+		case PBS_BATCH_AsyrunJobs:
+			rc = decode_DIS_RunJobs(sfds, request);
+			break;
+
+		case PBS_BATCH_SubmitJobs:
+			rc = decode_DIS_SubmitJobs(sfds, request);
+			break;
+
+		case PBS_BATCH_ManagerMany:
+			rc = decode_DIS_ManageMany(sfds, request);
+			break;
+
+		case PBS_BATCH_DeleteJobs:
+			rc = decode_DIS_DeleteJobs(sfds, request);
+			break;
+
 #else	/* yes PBS_MOM */
 
+		case PBS_BATCH_ExecJob:
+			rc = decode_DIS_ExecJob(sfds, request);
+			break;
+
 		case PBS_BATCH_CopyHookFile:
 			rc = decode_DIS_CopyHookFile(sfds, request);
 			break;
@@ -715,10 +737,10 @@ dis_request_read(int sfds, struct batch_request *request)
 #endif	/* PBS_MOM */
 
 		default:
-			sprintf(log_buffer, "%s: %d from %s", msg_nosupport,
+			/* log_eventf, not log_buffer, a decode thread may be here */
+			log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
+				"?", "%s: %d from %s", msg_nosupport,
 				request->rq_type, request->rq_user);
-			log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
-				"?", log_buffer);
 			rc = PBSE_UNKREQ;
 			break;
 	}
@@ -726,18 +748,16 @@ dis_request_read(int sfds, struct batch_request *request)
 	if (rc == 0) {	/* Decode the Request Extension, if present */
 		rc = decode_DIS_ReqExtend(sfds, request);
 		if (rc != 0) {
-			(void)sprintf(log_buffer,
-				"Request type: %d Req Extension bad, dis error %d", request->rq_type, rc);
-			log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST,
-				LOG_DEBUG, "?", log_buffer);
+			log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST,
+				LOG_DEBUG, "?",
+				"Request type: %d Req Extension bad, dis error %d",
+				request->rq_type, rc);
 			rc = PBSE_DISPROTO;
 		}
 	} else if (rc != PBSE_UNKREQ) {
-		(void)sprintf(log_buffer,
-			"Req Body bad, dis error %d, type %d",
+		log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST,
+			LOG_DEBUG, "?", "Req Body bad, dis error %d, type %d",
 			rc, request->rq_type);
-		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST,
-			LOG_DEBUG, "?", log_buffer);
 		rc = PBSE_DISPROTO;
 	}
 
@@ -56,6 +56,7 @@
  *	alt_conn
  *	takeover_from_secondary
  *	be_secondary
+ *	warm_datastore
  *
  */
 #include <pbs_config.h>   /* the master config generated by configure */
@@ -75,6 +76,7 @@
 #include "win.h"
 #else
 #include <sys/wait.h>
+#include <dirent.h>
 #endif /* WIN32 */
 #include "server_limits.h"
 #include "credential.h"
@@ -119,6 +121,7 @@ extern char	     server_host[];
 
 extern struct connection *svr_conn;
 extern struct batch_request *saved_takeover_req;
+extern pbs_db_conn_t *svr_db_conn;
 
 int	     pbs_failover_active = 0; /* indicates if Seconary is active */
 /* Private data items */
@@ -128,6 +131,7 @@ static int    Secondary_connection = -1;  /* used by Primary,connection_handle*/
 static int    Secondary_state      = SECONDARY_STATE_noconn;
 static time_t hd_time;
 static int    goidle_ack	   = 0;
+static time_t warm_time	   = 0;   /* when datastore last readied for a takeover */
 static char   msg_takeover[] = "received takeover message from primary, going inactive";
 static char   msg_regfailed[]= "Primary rejected attempt to register as Secondary";
 
@@ -218,6 +222,19 @@ primary_handshake(struct work_task *pwt)
 	/* if connection, send HandShake request to Secondary */
 
 	if (Secondary_connection >= 0) {
+		/*
+		 * keep the write-ahead log short so that a Secondary starting
+		 * the data service on takeover has little to replay
+		 */
+		if ((pbs_conf.pbs_failover_warm_time > 0) &&
+			(pbs_conf.pbs_data_service_host == NULL) &&
+			(svr_db_conn != NULL) &&
+			(time_now >= (warm_time + (time_t)pbs_conf.pbs_failover_warm_time))) {
+			warm_time = time_now;
+			if (pbs_db_execute_str(svr_db_conn, "CHECKPOINT") != 0)
+				log_err(-1, __func__, "datastore checkpoint failed");
+		}
+
 		DBPRT(("Failover: sending handshake\n"))
 		if ((preq = alloc_br(PBS_BATCH_FailOver)) != NULL) {
 			preq->rq_ind.rq_failover = FAILOVER_HandShake;
@@ -1010,6 +1027,75 @@ takeover_from_secondary()
 	return 1;
 }
 
+/**
+ * @brief
+ *		Ask the kernel to read the files of the embedded datastore into
+ *		the page cache so that, should the Secondary take over, starting
+ *		the data service and recovering the server state from it does
+ *		not wait on cold reads of the shared PBS_HOME.
+ *
+ * @par Functionality:
+ *		Walks PBS_HOME/datastore and issues POSIX_FADV_WILLNEED on every
+ *		regular file.  The advice is asynchronous, so the Secondary does
+ *		not block here for the data to arrive.  Nothing is done if the
+ *		datastore is not local (PBS_DATA_SERVICE_HOST set) or the platform
+ *		has no posix_fadvise().
+ *
+ * @see
+ *		be_secondary
+ *
+ * @return: none
+ */
+static void
+warm_datastore(void)
+{
+#if !defined(WIN32) && defined(POSIX_FADV_WILLNEED)
+	char		 dirs[32][MAXPATHLEN + 1];
+	char		 cur[MAXPATHLEN + 1];
+	char		 path[MAXPATHLEN + 1];
+	int		 ndirs = 0;
+	int		 nfiles = 0;
+	int		 fd;
+	DIR		*dirp;
+	struct dirent	*pdirent;
+	struct stat	 sb;
+
+	if (pbs_conf.pbs_data_service_host != NULL)
+		return;
+
+	snprintf(dirs[ndirs++], MAXPATHLEN, "%s/datastore", pbs_conf.pbs_home_path);
+	while (ndirs > 0) {
+		strcpy(cur, dirs[--ndirs]);
+		if ((dirp = opendir(cur)) == NULL)
+			continue;
+		while ((pdirent = readdir(dirp)) != NULL) {
+			if (pdirent->d_name[0] == '.')
+				continue;
+			snprintf(path, MAXPATHLEN, "%s/%s", cur, pdirent->d_name);
+			if (lstat(path, &sb) == -1)
+				continue;
+			if (S_ISDIR(sb.st_mode)) {
+				/* the datastore tree is small and shallow */
+				if (ndirs < (int)(sizeof(dirs) / sizeof(dirs[0])))
+					strcpy(dirs[ndirs++], path);
+				continue;
+			}
+			if (!S_ISREG(sb.st_mode))
+				continue;
+			if ((fd = open(path, O_RDONLY)) == -1)
+				continue;
+			(void)posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+			close(fd);
+			nfiles++;
+		}
+		closedir(dirp);
+	}
+	sprintf(log_buffer, "readied %d datastore files for takeover", nfiles);
+	log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
+		msg_daemonname, log_buffer);
+#endif
+}
+
 /**
  * @brief
  * 		be_secondary - detect if primary is up
@@ -1170,6 +1256,10 @@ be_secondary(time_t delay)
 					sprintf(log_buffer, "Secondary has not received handshake in %ld seconds", time_now - hd_time);
 					log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER,
 						LOG_WARNING, msg_daemonname, log_buffer);
+				} else if ((pbs_conf.pbs_failover_warm_time > 0) &&
+					(time_now >= (warm_time + (time_t)pbs_conf.pbs_failover_warm_time))) {
+					warm_time = time_now;
+					warm_datastore();
 				}
 				break;
 
@@ -71,6 +71,7 @@
  * write_hook_reject_debug_output_and_close
  * write_hook_accept_debug_output_and_close
  * process_hooks
+ * hook_stats_cpu
  * recreate_request
  * add_mom_hook_action
  * delete_mom_hook_action
@@ -107,6 +108,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#include <time.h>
 #include <ctype.h>
 #include <errno.h>
 #include <assert.h>
@@ -2377,6 +2379,14 @@ status_hook(hook *phook, struct batch_request *preq, pbs_list_head *pstathd, cha
 				strcpy(val_str, hook_debug_as_string(phook->debug));
 			} else if (strcmp(pal->al_name, HOOKATT_FAIL_ACTION) == 0) {
 				strcpy(val_str, hook_fail_action_as_string(phook->fail_action));
+			} else if (strcmp(pal->al_name, HOOKATT_STATS) == 0) {
+				/* too long for val_str, and never part of the */
+				/* full listing so "print hook" stays importable */
+				if (attrlist_add(&pstat->brp_attr, pal->al_name,
+					hook_stats_as_string(phook)) != 0)
+					return (PBSE_INTERNAL);
+				pal = (svrattrl *)GET_NEXT(pal->al_link);
+				continue;
 			} else {
 				snprintf(hook_msg, msg_len-1,
 					"unknown hook attribute %s", pal->al_name);
@@ -3832,6 +3842,7 @@ process_hooks(struct batch_request *preq, char *hook_msg, size_t msg_len,
 	int			num_run = 0;
 	int			rc = 1;
 	int			event_initialized = 0;
+	long long		hook_start;
 
 	if (!svr_interp_data.interp_started) {
 		log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_HOOK,
@@ -3935,9 +3946,11 @@ process_hooks(struct batch_request *preq, char *hook_msg, size_t msg_len,
 			num_run++;
 			continue;
 		}
+		hook_start = req_stats_now();
 		rc = server_process_hooks(preq->rq_type, preq->rq_user, preq->rq_host, phook,
 				hook_event, pjob, &req_ptr, hook_msg, msg_len, pyinter_func,
 				&num_run, &event_initialized);
+		req_stats_hook_usec += req_stats_now() - hook_start;
 		if ((rc == 0) || (rc == -1))
 			return (rc);
 	}
@@ -3978,6 +3991,23 @@ process_hooks(struct batch_request *preq, char *hook_msg, size_t msg_len,
  *
  * @par MT-safe: No
  */
+/**
+ * @brief
+ *		Return the cpu time consumed so far by the server process, in
+ *		microseconds, for the hook statistics.
+ *
+ * @return	long long
+ */
+static long long
+hook_stats_cpu(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0)
+		return 0;
+	return ((long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
 int server_process_hooks(int rq_type, char *rq_user, char *rq_host, hook *phook,
 				int hook_event, job *pjob, hook_input_param_t *req_ptr,
 				char *hook_msg, int msg_len, void (*pyinter_func)(void),
@@ -4003,6 +4033,9 @@ int server_process_hooks(int rq_type, char *rq_user, char *rq_host, hook *phook,
 	pbs_list_head 		event_vnode;
 	pbs_list_head 		event_resv;
 	char			perf_label[MAXBUFLEN];
+	long long		wall_start;
+	long long		cpu_start;
+	long long		python_usec = 0;
 
 	if (req_ptr == NULL) {
 		snprintf(log_buffer, sizeof(log_buffer),
@@ -4027,6 +4060,8 @@ int server_process_hooks(int rq_type, char *rq_user, char *rq_host, hook *phook,
 		snprintf(perf_label, sizeof(perf_label), "hook_%s_%s_%d", hook_event_as_string(hook_event), phook->hook_name, mypid);
 
 	hook_perf_stat_start(perf_label, "server_process_hooks", 1);
+	wall_start = req_stats_now();
+	cpu_start = hook_stats_cpu();
 
 	if (suffix_sz == 0)
 		suffix_sz = strlen(HOOK_SCRIPT_SUFFIX);
@@ -4354,7 +4389,9 @@ int server_process_hooks(int rq_type, char *rq_user, char *rq_host, hook *phook,
 	/* let rc pass through */
 	if (rc == 0) {
 		hook_perf_stat_start(perf_label, "run_code", 0);
+		python_usec = req_stats_now();
 		rc = pbs_python_run_code_in_namespace(&svr_interp_data, phook->script, 0);
+		python_usec = req_stats_now() - python_usec;
 		hook_perf_stat_stop(perf_label, "run_code", 0);
 	}
 
@@ -4685,6 +4722,9 @@ int server_process_hooks(int rq_type, char *rq_user, char *rq_host, hook *phook,
 	rc = 1;
 server_process_hooks_exit:
 	hook_perf_stat_stop(perf_label, "server_process_hooks", 1);
+	hook_stats_add(phook, hook_event, (rc == 1) ? 1 : ((rc == 0) ? 0 : -1),
+		req_stats_now() - wall_start, hook_stats_cpu() - cpu_start,
+		python_usec);
 	return (rc);
 }
 
@@ -7634,6 +7674,16 @@ post_server_periodic_hook(struct work_task *ptask)
 /**
  * @brief
  *		Callback function for Timed work tasks to run periodic hooks
+ *
+ * @par
+ *		The hook never runs on the server's main thread: it runs in a
+ *		forked child (pbs_run_periodic_hook on Windows), against the
+ *		child's copy of the vnodes, reservations and jobs, and writes its
+ *		results to a file.  post_server_periodic_hook() applies those
+ *		results once the child exits, so however long the hook takes the
+ *		server only pays for the fork and for applying the results.  A run
+ *		is skipped while the previous one's post processing is pending.
+ *
  * @param[in]	ptask	- work task pointer
  *
  * @return  void
@@ -126,7 +126,7 @@
 #include "pbs_entlim.h"
 
 #ifndef PBS_MOM
-#include "avltree.h"
+#include "name_idx.h"
 #endif
 
 #include "svrfunc.h"
@@ -134,6 +134,7 @@
 #include "credential.h"
 #include "net_connect.h"
 #include "pbs_reliable.h"
+#include "libutil.h"
 
 #if defined(PBS_MOM) && defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 #include "renew_creds.h"
@@ -215,6 +216,8 @@ tasks_free(job *pj)
 				close_conn(tp->ti_tmfd[i]);
 			free(tp->ti_tmfd);
 		}
+		if (tp->ti_pidfd != -1)
+			close_conn(tp->ti_pidfd);
 		delete_link(&tp->ti_jobtask);
 		free(tp);
 		tp = (pbs_task *)GET_NEXT(pj->ji_tasks);
@@ -322,6 +325,9 @@ job_abt(job *pjob, char *text)
 }
 #endif	/* PBS_MOM */
 
+/* freed job structures kept for reuse */
+static pbs_freelist job_pool = PBS_FREELIST_INIT("job", job, 256);
+
 /**
  * @brief
  * 		job_alloc - allocate space for a job structure and initialize working
@@ -339,12 +345,15 @@ job_alloc(void)
 	time_t 	ctm;
 #endif
 
-	pj = (job *)malloc(sizeof(job));
+	pj = (job *)freelist_alloc(&job_pool);
 	if (pj == NULL) {
 		log_err(errno, "job_alloc", "no memory");
 		return NULL;
 	}
 	(void)memset((char *)pj, (int)0, (size_t)sizeof(job));
+#ifndef PBS_MOM
+	mem_stats_alloc[MEM_STATS_JOB]++;
+#endif
 
 	/* explicity setting these licensing parameters just be sure */
 	pj->ji_licneed = -1;	/* indicates uninitialized, invalid value */
@@ -353,6 +362,15 @@ job_alloc(void)
 	CLEAR_LINK(pj->ji_alljobs);
 	CLEAR_LINK(pj->ji_jobque);
 	CLEAR_LINK(pj->ji_unlicjobs);
+#ifndef PBS_MOM
+	CLEAR_LINK(pj->ji_statejobs);
+	CLEAR_LINK(pj->ji_questatejobs);
+	CLEAR_LINK(pj->ji_ownerjobs);
+	CLEAR_LINK(pj->ji_savejobs);
+	CLEAR_LINK(pj->ji_histjobs);
+	CLEAR_LINK(pj->ji_actjobs);
+	CLEAR_LINK(pj->ji_queactjobs);
+#endif
 
 	pj->ji_rerun_preq = NULL;
 
@@ -407,6 +425,7 @@ job_alloc(void)
 	pj->ji_newjob = 0;
 	pj->ji_modified = 0;
 	pj->ji_script = NULL;
+	pj->ji_mod_seq = ++svr_mod_seq;
 #endif
 	pj->ji_qs.ji_jsversion = JSVERSION;
 	pj->ji_momhandle = -1;		/* mark mom connection invalid */
@@ -547,6 +566,12 @@ job_free(job *pj)
 
 		free_job_work_tasks(pj);
 
+		/* a deferred save of a job that is gone is dropped */
+		delete_link(&pj->ji_savejobs);
+		delete_link(&pj->ji_histjobs);
+		delete_link(&pj->ji_actjobs);
+		delete_link(&pj->ji_queactjobs);
+
 		/* free any bad destination structs */
 
 		bp = (badplace *)GET_NEXT(pj->ji_rejectdest);
@@ -565,6 +590,7 @@ job_free(job *pj)
 			job *psubj = pj->ji_ajtrk->tkm_tbl[i].trk_psubjob;
 			if (psubj)
 				psubj->ji_parentaj = NULL;
+			free(pj->ji_ajtrk->tkm_tbl[i].trk_exechost);
 		}
 		free(pj->ji_ajtrk);
 		pj->ji_ajtrk = NULL;
@@ -578,6 +604,7 @@ job_free(job *pj)
 		free(pj->ji_clterrmsg);
 	if (pj->ji_script)
 		free(pj->ji_script);
+	free_parsed_execvnode(pj->ji_parsed_ev);
 
 #else	/* PBS_MOM  Mom Only */
 
@@ -622,7 +649,10 @@ job_free(job *pj)
 	/* They will be freed when the parent is removed           */
 
 	pj->ji_qs.ji_jobid[0] = 'X';	/* as a "freed" marker */
-	free(pj);	/* now free the main structure */
+	freelist_free(&job_pool, pj);	/* now free the main structure */
+#ifndef PBS_MOM
+	mem_stats_alloc[MEM_STATS_JOB]--;
+#endif
 }
 
 /**
@@ -758,6 +788,7 @@ job_purge(job *pjob)
 			   pjob->ji_qs.ji_jobid);
 		reply_preempt_jobs_request(PBSE_INTERNAL, PREEMPT_METHOD_DELETE, pjob);
 	}
+	job_stage_log(pjob);
 #endif
 #ifdef	PBS_MOM
 	delete_link(&pjob->ji_jobque);
@@ -838,6 +869,10 @@ job_purge(job *pjob)
 				pjob->ji_etlimit_decr_queued ? ETLIM_ACC_ALL_MAX : ETLIM_ACC_ALL);
 
 		svr_dequejob(pjob);
+
+		/* a subjob can still be statused through its parent */
+		if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_SubJob) == 0)
+			record_mod_seq_delete(MGR_OBJ_JOB, pjob->ji_qs.ji_jobid);
 	}
 #endif	/* PBS_MOM */
 
@@ -1065,7 +1100,7 @@ job_purge(job *pjob)
  *		hostname. For example, "foo" will match "foo.bar.com", but
  *		"foo.bar" will not match "foo.bar.com".
  *
- *		If server, then search in AVL tree otherwise Linked list.
+ *		If server, then search the job id index otherwise Linked list.
  *
  * @param[in]	jobid - job ID string.
  *
@@ -1078,7 +1113,6 @@ find_job(char *jobid)
 {
 #ifndef PBS_MOM
 	size_t len;
-	AVL_IX_REC *pkey;
 	char *host_dot;
 	char *serv_dot;
 	char *host;
@@ -1160,12 +1194,8 @@ find_job(char *jobid)
 		strcat(buf, server_name);
 	}
 
-	if ((AVL_jctx != NULL) && ((pkey = svr_avlkey_create(buf)) != NULL)) {
-		if (avl_find_key(pkey, AVL_jctx) == AVL_IX_OK)
-			pj = (job *) pkey->recptr;
-		free(pkey);
-		return (pj);
-	}
+	if (jobs_idx != NULL)
+		return ((job *) find_name_idx(jobs_idx, buf));
 #endif
 	pj = (job *)GET_NEXT(svr_alljobs);
 	while (pj != NULL) {
@@ -1456,7 +1486,7 @@ update_resources_list(job *pjob, char *res_list_name,
 		while (pr != NULL) {
 			next = (resource *)GET_NEXT(pr->rs_link);
 			if (pr->rs_defin->rs_flags & (ATR_DFLAG_RASSN | ATR_DFLAG_FNASSN | ATR_DFLAG_ANASSN)) {
-				delete_link(&pr->rs_link);
+				unlink_resource_entry(&pjob->ji_wattr[res_list_index], pr);
 				if (pr->rs_value.at_flags & ATR_VFLAG_INDIRECT)
 					free_str(&pr->rs_value);
 				else
@@ -1588,6 +1618,7 @@ resc_resv_alloc(void)
 		return NULL;
 	}
 	(void)memset((char *)resvp, (int)0, (size_t)sizeof(resc_resv));
+	mem_stats_alloc[MEM_STATS_RESV]++;
 	CLEAR_LINK(resvp->ri_allresvs);
 	CLEAR_HEAD(resvp->ri_svrtask);
 	CLEAR_HEAD(resvp->ri_rejectdest);
@@ -1598,6 +1629,7 @@ resc_resv_alloc(void)
 
 	resvp->ri_qs.ri_rsversion = RSVERSION;
 	job_or_resv_init_wattr((void *)resvp, RESC_RESV_OBJECT);
+	resvp->ri_mod_seq = ++svr_mod_seq;
 
 	return (resvp);
 }
@@ -1623,6 +1655,9 @@ resv_free(resc_resv *presv)
 	struct work_task	*pwt;
 	badplace		*bp;
 
+	/* drop the reservation from the vnode to standing reservation index */
+	unindex_resv_seq_vnodes(presv);
+
 	/* remove any malloc working attribute space */
 
 	for (i=0; i < (int)RESV_ATR_LAST; i++) {
@@ -1651,6 +1686,7 @@ resv_free(resc_resv *presv)
 
 	/* now free the main structure */
 	free(presv);
+	mem_stats_alloc[MEM_STATS_RESV]--;
 }
 
 /**
@@ -1674,6 +1710,12 @@ find_resv(char *resvID)
 
 	if ((at = strchr(resvID, (int)'@')) != 0)
 		*at = '\0';	/* strip of @server_name */
+	if (resvs_idx != NULL) {
+		presv = (resc_resv *) find_name_idx(resvs_idx, resvID);
+		if (at)
+			*at = '@';	/* restore @server_name */
+		return (presv);
+	}
 	presv = (resc_resv *)GET_NEXT(svr_allresvs);
 	while (presv != NULL) {
 		if (!strcmp(resvID, presv->ri_qs.ri_resvID))
@@ -1794,6 +1836,8 @@ resv_purge(resc_resv *presv)
 	 *global lists (svr_allresvs or svr_newresvs) has it
 	 */
 	delete_link(&presv->ri_allresvs);
+	svr_name_idx_oper(&resvs_idx, presv->ri_qs.ri_resvID, presv, NAME_IDX_OP_DEL);
+	record_mod_seq_delete(MGR_OBJ_RESV, presv->ri_qs.ri_resvID);
 
 	/*Release any nodes that were associated to this reservation*/
 	free_resvNodes(presv);
@@ -48,6 +48,9 @@
  * Functions included are:
  *
  *	job_save_db()         -	save job to database
+ *	job_save_db_now()     -	write job to database
+ *	job_save_db_flush()   -	write out the deferred job saves
+ *	job_save_db_wait()    -	time until the deferred job saves are written
  *	job_or_resv_save_db() -	save to database (job/reservation)
  *	job_recov_db()        - recover(read) job from database
  *	job_or_resv_recov_db() -	recover(read) job/reservation from database
@@ -100,6 +103,7 @@
 #include <memory.h>
 #include "libutil.h"
 #include "pbs_db.h"
+#include "pbs_internal.h"
 
 
 #define MAX_SAVE_TRIES 3
@@ -129,6 +133,12 @@ extern int recov_attr_db(pbs_db_conn_t *conn,
 /* global data items */
 extern time_t time_now;
 
+#ifndef PBS_MOM
+/* jobs whose save waits to be written with others, see job_save_db() */
+static pbs_list_head	pending_job_saves;
+static time_t		pending_job_saves_since;
+#endif
+
 #ifndef PBS_MOM
 
 /**
@@ -347,7 +357,7 @@ db_to_svr_resv(resc_resv *presv, pbs_db_resv_info_t *pdresv)
 
 /**
  * @brief
- *		Save job to database
+ *		Write job to database
  *
  * @param[in]	pjob - The job to save
  * @param[in]   updatetype:
@@ -362,8 +372,8 @@ db_to_svr_resv(resc_resv *presv, pbs_db_resv_info_t *pdresv)
  * @retval	 1 - Jobid clash, retry with new jobid
  *
  */
-int
-job_save_db(job *pjob, int updatetype)
+static int
+job_save_db_now(job *pjob, int updatetype)
 {
 	pbs_db_job_info_t dbjob;
 	pbs_db_obj_info_t obj;
@@ -447,6 +457,7 @@ job_save_db(job *pjob, int updatetype)
 			if (updatetype == SAVEJOB_NEW && strstr(conn->conn_db_err, "duplicate key value")) {
 				/* new job has a jobid clash, allow retry with a new jobid */
 				pbs_db_reset_obj(&obj);
+				unsave_attr_db(pjob->ji_wattr, (int)JOB_ATR_LAST);
 				if (pbs_db_end_trx(conn, PBS_DB_COMMIT) != 0)
 					goto db_err;
 
@@ -473,12 +484,139 @@ db_err:
 	(void) pbs_db_end_trx(conn, PBS_DB_ROLLBACK);
 	if (updatetype == SAVEJOB_NEW) {
 		/* database save failed for new job, stay up, */
+		unsave_attr_db(pjob->ji_wattr, (int)JOB_ATR_LAST);
 		return (-1); /* return without calling panic_stop_db */
 	}
 	panic_stop_db(log_buffer);
 	return (-1);
 }
 
+/**
+ * @brief
+ *		Save job to database
+ *
+ * @par
+ *		With PBS_SERVER_JOB_SAVE_WINDOW set in pbs.conf, the save of a job
+ *		already in the database is not written at once but queued, and
+ *		job_save_db_flush() writes all queued saves in one transaction once
+ *		the window has passed.  Saving a queued job again only upgrades the
+ *		queued save, the job is encoded when it is written.  A new job, or
+ *		a save inside a transaction of the caller, is written at once.
+ *
+ * @param[in]	pjob - The job to save
+ * @param[in]   updatetype:
+ *		SAVEJOB_QUICK - Quick update, save only quick save area
+ *		SAVEJOB_FULL  - Update along with attributes
+ *		SAVEJOB_NEW   - Create new job in database (insert)
+ *		SAVEJOB_FULLFORCE - Same as SAVEJOB_FULL
+ *
+ * @return      Error code
+ * @retval	 0 - Success
+ * @retval	-1 - Failure
+ * @retval	 1 - Jobid clash, retry with new jobid
+ *
+ */
+int
+job_save_db(job *pjob, int updatetype)
+{
+	if ((pbs_conf.pbs_server_job_save_window == 0) ||
+		(updatetype == SAVEJOB_NEW) || (pjob->ji_newjob == 1) ||
+		(svr_db_conn->conn_trx_nest > 0))
+		return (job_save_db_now(pjob, updatetype));
+
+	if (pending_job_saves.ll_next == NULL)
+		CLEAR_HEAD(pending_job_saves);
+
+	if (pjob->ji_savejobs.ll_next == &pjob->ji_savejobs) {
+		if (GET_NEXT(pending_job_saves) == NULL)
+			pending_job_saves_since = time_now;
+		append_link(&pending_job_saves, &pjob->ji_savejobs, pjob);
+		pjob->ji_savetype = updatetype;
+	} else if (updatetype != SAVEJOB_QUICK) {
+		if (pjob->ji_savetype == SAVEJOB_QUICK)
+			pjob->ji_savetype = updatetype;
+		else if (updatetype == SAVEJOB_FULLFORCE)
+			pjob->ji_savetype = SAVEJOB_FULLFORCE;
+	}
+	return (0);
+}
+
+/**
+ * @brief
+ *		Write out the job saves queued by job_save_db(), all in one
+ *		transaction.
+ *
+ * @param[in]	force	- if 0, only write them once the save window passed
+ *
+ * @return	void
+ *
+ */
+void
+job_save_db_flush(int force)
+{
+	pbs_db_conn_t *conn = svr_db_conn;
+	job	*pjob;
+	int	 count = 0;
+
+	if ((pending_job_saves.ll_next == NULL) ||
+		(GET_NEXT(pending_job_saves) == NULL))
+		return;
+	if (!force && (time_now <
+		pending_job_saves_since + (time_t)pbs_conf.pbs_server_job_save_window))
+		return;
+
+	if (pbs_db_begin_trx(conn, 0, conn->conn_trx_async) != 0)
+		goto db_err;
+
+	/* each job_save_db_now() nests in the transaction begun here */
+	while ((pjob = (job *)GET_NEXT(pending_job_saves)) != NULL) {
+		delete_link(&pjob->ji_savejobs);
+		(void)job_save_db_now(pjob, pjob->ji_savetype);
+		count++;
+	}
+
+	if (pbs_db_end_trx(conn, PBS_DB_COMMIT) != 0)
+		goto db_err;
+
+	log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER, LOG_DEBUG, __func__,
+		"wrote %d job saves", count);
+	return;
+db_err:
+	sprintf(log_buffer, "Failed to write job saves ");
+	if (conn->conn_db_err != NULL)
+		strncat(log_buffer, conn->conn_db_err, LOG_BUF_SIZE - strlen(log_buffer) - 1);
+	log_err(-1, __func__, log_buffer);
+	(void) pbs_db_end_trx(conn, PBS_DB_ROLLBACK);
+	panic_stop_db(log_buffer);
+}
+
+/**
+ * @brief
+ *		Shorten the time the server may wait for a request so the job
+ *		saves queued by job_save_db() are written when their window ends.
+ *
+ * @param[in]	waittime	- time the server would wait
+ *
+ * @return	time_t
+ * @retval	the time to wait
+ *
+ */
+time_t
+job_save_db_wait(time_t waittime)
+{
+	time_t	delay;
+
+	if ((pending_job_saves.ll_next == NULL) ||
+		(GET_NEXT(pending_job_saves) == NULL))
+		return (waittime);
+
+	delay = pending_job_saves_since +
+		(time_t)pbs_conf.pbs_server_job_save_window - time_now;
+	if (delay < 0)
+		delay = 0;
+	return ((delay < waittime) ? delay : waittime);
+}
+
 /**
  * @brief
  *	Utility function called inside job_recov_db
@@ -627,6 +765,7 @@ resv_save_db(resc_resv *presv, int updatetype)
 			if (updatetype == SAVERESV_NEW && strstr(conn->conn_db_err, "duplicate key value")) {
 				/* new id clash, allow retry with a new */
 				pbs_db_reset_obj(&obj);
+				unsave_attr_db(presv->ri_wattr, (int)RESV_ATR_LAST);
 				resv_attr_def[(int)RESV_ATR_queue].at_free(
 						&presv->ri_wattr[(int)RESV_ATR_queue]);
 				if (pbs_db_end_trx(conn, PBS_DB_COMMIT) != 0)
@@ -651,6 +790,7 @@ db_err:
 	(void) pbs_db_end_trx(conn, PBS_DB_ROLLBACK);
 	if (updatetype == SAVERESV_NEW) {
 		/* database save failed for new resv, stay up, */
+		unsave_attr_db(presv->ri_wattr, (int)RESV_ATR_LAST);
 		return (-1); /* return without calling panic_stop_db */
 	}
 	panic_stop_db(log_buffer);
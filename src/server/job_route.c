@@ -45,6 +45,7 @@
  *	job_route() - attempt to route a job to a new destination.
  *	add_dest()	- Add an entry to the list of bad destinations for a job.
  *	is_bad_dest()	- Check the job for a match of dest in the list of rejected destinations.
+ *	route_dest_closed()	- check if no job of the batch being routed can enter a destination.
  *	default_router()	- basic function for "routing" jobs.
  *	queue_route()	- route any "ready" jobs in a specific queue
  */
@@ -56,6 +57,7 @@
 
 #ifndef WIN32
 #include <sys/param.h>
+#include <sys/time.h>
 #endif
 
 #include "pbs_ifl.h"
@@ -92,6 +94,15 @@
 
 /* Global Data */
 
+/*
+ * While queue_route() routes a batch of jobs from route_batch_que, an
+ * entry of route_batch_closed is set once the destination of that index
+ * rejected a job for a reason of its own, see route_dest_closed().
+ */
+static pbs_queue	*route_batch_que = NULL;
+static char		*route_batch_closed = NULL;
+static int		 route_batch_ndest = 0;
+
 extern char	*msg_badstate;
 extern char	*msg_routexceed;
 extern char	*msg_routebad;
@@ -157,6 +168,33 @@ is_bad_dest(job	*jobp, char *dest)
 }
 
 
+/**
+ * @brief
+ * 		Check, or remember, whether a destination of the routing queue
+ * 		whose batch queue_route() is routing takes no job at all.  A queue
+ * 		that is disabled or full stays so for the rest of the batch (it
+ * 		has to be enabled, or have jobs leave it, by some other request),
+ * 		so once one job is rejected so the others need not be checked.
+ *
+ * @param[in]	qp - the routing queue
+ * @param[in]	idx - index of the destination in route_destinations
+ * @param[in]	err - 0 to check, else the error the destination returned
+ *
+ * @return	int
+ * @retval	1	- the destination takes no job in this batch
+ * @retval	0	- it may take the job
+ */
+static int
+route_dest_closed(struct pbs_queue *qp, int idx, int err)
+{
+	if ((qp != route_batch_que) || (idx < 0) || (idx >= route_batch_ndest))
+		return 0;
+
+	if ((err == PBSE_QUNOENB) || (err == PBSE_MAXQUED))
+		route_batch_closed[idx] = 1;
+	return (route_batch_closed[idx]);
+}
+
 /**
  * @brief
  * 		default_router - basic function for "routing" jobs.
@@ -216,6 +254,13 @@ default_router(job *jobp, struct pbs_queue *qp, long retry_time)
 		if (is_bad_dest(jobp, destination))
 			continue;
 
+		/* taken no other job of this batch, try again later */
+		if (route_dest_closed(qp, jobp->ji_lastdest - 1, 0)) {
+			jobp->ji_retryok = 1;
+			continue;
+		}
+
+		pbs_errno = PBSE_NONE;
 		switch (svr_movejob(jobp, destination, NULL)) {
 
 			case -1:		/* permanent failure */
@@ -228,6 +273,7 @@ default_router(job *jobp, struct pbs_queue *qp, long retry_time)
 
 			case 1:		/* failed, but try destination again */
 				jobp->ji_retryok = 1;
+				(void)route_dest_closed(qp, jobp->ji_lastdest - 1, pbs_errno);
 				break;
 		}
 	}
@@ -353,31 +399,93 @@ job_route(job *jobp)
  *		Transiting state is less than the max_running limit, then
  *		attempt to route it.
  *
+ *		The jobs are routed as a batch: their saves are written in one
+ *		transaction, a destination found closed is not checked again
+ *		for the other jobs, and after SVR_ROUTE_MSECS the rest is left
+ *		for the next pass of the main loop, which resumes at the job
+ *		recorded in qu_rtnext.
+ *
  * @see
  * 		main
  *
  * @param[in]	pque	- PBS queue.
  *
- * @return	void
+ * @return	int
+ * @retval	1	- stopped for time with jobs left to route
+ * @retval	0	- all ready jobs were tried
  */
 
-void
+int
 queue_route(pbs_queue *pque)
 {
 	job *nxjb;
 	job *pjob;
 	int  rc;
+	int  n = 0;
+	int  in_trx = 0;
+	struct timeval	begin_time;
+	struct timeval	end_time;
+	long		elapsed;
+	attribute	*pattr = &pque->qu_attr[(int)QR_ATR_RouteDestin];
+
+	gettimeofday(&begin_time, NULL);
+
+	route_batch_que = pque;
+	route_batch_ndest = 0;
+	if ((pattr->at_flags & ATR_VFLAG_SET) && (pattr->at_val.at_arst->as_usedptr > 0)) {
+		route_batch_closed = calloc(pattr->at_val.at_arst->as_usedptr, 1);
+		if (route_batch_closed != NULL)
+			route_batch_ndest = pattr->at_val.at_arst->as_usedptr;
+	}
 
-
-	pjob = (job *)GET_NEXT(pque->qu_jobs);
+	pjob = NULL;
+	if (pque->qu_rtnext[0] != '\0') {
+		pjob = find_job(pque->qu_rtnext);
+		if ((pjob != NULL) && (pjob->ji_qhdr != pque))
+			pjob = NULL;
+		pque->qu_rtnext[0] = '\0';
+	}
+	if (pjob == NULL)
+		pjob = (job *)GET_NEXT(pque->qu_jobs);
 	while (pjob) {
 		nxjb = (job *)GET_NEXT(pjob->ji_jobque);
 		if (pjob->ji_qs.ji_un.ji_routet.ji_rteretry <= time_now) {
+			if ((n == 0) && (pbs_db_begin_trx(svr_db_conn, 0, 0) == 0))
+				in_trx = 1;
 			if ((rc = job_route(pjob)) == PBSE_ROUTEREJ)
 				job_abt(pjob, msg_routebad);
 			else if (rc == PBSE_ROUTEEXPD)
 				job_abt(pjob, msg_routexceed);
+
+			/* check if we spent too long hogging the pbs_server process here */
+			if ((++n % 16) == 0) {
+				gettimeofday(&end_time, NULL);
+				elapsed = (end_time.tv_sec - begin_time.tv_sec) * 1000 +
+					(end_time.tv_usec - begin_time.tv_usec) / 1000;
+				if ((elapsed >= SVR_ROUTE_MSECS) && (nxjb != NULL)) {
+					strcpy(pque->qu_rtnext, nxjb->ji_qs.ji_jobid);
+					break;
+				}
+			}
 		}
 		pjob = nxjb;
 	}
+
+	free(route_batch_closed);
+	route_batch_closed = NULL;
+	route_batch_ndest = 0;
+	route_batch_que = NULL;
+
+	if (in_trx && (pbs_db_end_trx(svr_db_conn, PBS_DB_COMMIT) != 0)) {
+		sprintf(log_buffer, "Failed to save routed jobs ");
+		if (svr_db_conn->conn_db_err != NULL)
+			strncat(log_buffer, svr_db_conn->conn_db_err,
+				LOG_BUF_SIZE - strlen(log_buffer) - 1);
+		log_err(-1, __func__, log_buffer);
+		(void) pbs_db_end_trx(svr_db_conn, PBS_DB_ROLLBACK);
+		panic_stop_db(log_buffer);
+		return 0;
+	}
+
+	return (pque->qu_rtnext[0] != '\0');
 }
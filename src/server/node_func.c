@@ -64,6 +64,9 @@
  *								node type (cluster/time-shared) into an int variable
  * 	save_nodes_db() 		-    		used to update the nodes file when certain changes
  *								occur to the server's internal nodes list
+ *	node_mark_modified()	-	set nd_modified bits and put the node on the modified node list
+ *	get_modified_nodes()	-	the nodes that may need to be written to the db
+ *	prune_modified_nodes()	-	drop the nodes that were written from the modified node list
  *	free_prop_list()		-	For each element of a null terminated prop list call free
  *								to clean up any string buffer that hangs from the element.
  *	subnode_delete()		-	delete the specified subnode by marking it deleted
@@ -131,6 +134,7 @@
 #include "queue.h"
 #include "reservation.h"
 #include "pbs_nodes.h"
+#include "name_idx.h"
 #include "svrfunc.h"
 #include "pbs_error.h"
 #include "log.h"
@@ -158,7 +162,6 @@ extern unsigned int pbs_rm_port;
 extern mominfo_time_t  mominfo_time;
 extern char	*resc_in_err;
 extern char	server_host[];
-extern AVL_IX_DESC *node_tree;
 extern int write_single_node_mom_attr(struct pbsnode *np);
 
 extern struct python_interpreter_data  svr_interp_data;
@@ -173,6 +176,17 @@ extern int write_single_node_state(struct pbsnode *np);
 
 static void	remove_node_topology(char *);
 
+/*
+ * Nodes with NODE_UPDATE_DB_MASK bits set in nd_modified since they were
+ * last written, so save_nodes_db() and write_node_state() only visit them
+ * rather than every node.  If the list could not be grown, modified_lost
+ * is set and every node is visited until the list is rebuilt.
+ */
+static struct pbsnode **modified_nodes = NULL;
+static int modified_num = 0;
+static int modified_size = 0;
+static int modified_lost = 0;
+
 /**
  * @brief
  * 		find_nodebyname() - find a node host by its name
@@ -193,10 +207,10 @@ char *nodename;
 		nodename++;	/* skip over leading paren */
 	if ((pslash = strchr(nodename, (int)'/')) != NULL)
 		*pslash = '\0';
-	if (node_tree == NULL)
+	if (nodes_idx == NULL)
 		return NULL;
 
-	return ((struct pbsnode *) find_tree(node_tree, nodename));
+	return ((struct pbsnode *) find_name_idx(nodes_idx, nodename));
 }
 
 
@@ -287,27 +301,27 @@ chk_characteristic(struct pbsnode *pnode, int *pneed_todo)
 	if (tmp != old_state) {
 		if (tmp & INUSE_DELETED && !(old_state & INUSE_DELETED)) {
 			*pneed_todo |= WRITE_NEW_NODESFILE; /*node being deleted*/
-			pnode->nd_modified |= NODE_UPDATE_OTHERS;
+			node_mark_modified(pnode, NODE_UPDATE_OTHERS);
 			deleted = 1; /* no need to update other attributes */
 		} else {
 			if (tmp & INUSE_OFFLINE && !(old_state & INUSE_OFFLINE)) {
 				*pneed_todo |= WRITENODE_STATE; /*marked offline */
-				pnode->nd_modified |= NODE_UPDATE_STATE;
+				node_mark_modified(pnode, NODE_UPDATE_STATE);
 			}
 
 			if (!(tmp & INUSE_OFFLINE) && old_state & INUSE_OFFLINE) {
 				*pneed_todo |= WRITENODE_STATE; /*removed offline*/
-				pnode->nd_modified |= NODE_UPDATE_STATE;
+				node_mark_modified(pnode, NODE_UPDATE_STATE);
 			}
 
 			if (tmp & INUSE_OFFLINE_BY_MOM && !(old_state & INUSE_OFFLINE_BY_MOM)) {
 				*pneed_todo |= WRITENODE_STATE; /*marked offline */
-				pnode->nd_modified |= NODE_UPDATE_STATE;
+				node_mark_modified(pnode, NODE_UPDATE_STATE);
 			}
 
 			if (!(tmp & INUSE_OFFLINE_BY_MOM) && old_state & INUSE_OFFLINE_BY_MOM) {
 				*pneed_todo |= WRITENODE_STATE; /*removed offline*/
-				pnode->nd_modified |= NODE_UPDATE_STATE;
+				node_mark_modified(pnode, NODE_UPDATE_STATE);
 			}
 		}
 	}
@@ -315,14 +329,14 @@ chk_characteristic(struct pbsnode *pnode, int *pneed_todo)
 	if (!deleted) {
 		if (pnode->nd_attr[ND_ATR_Comment].at_flags & ATR_VFLAG_MODIFY) {
 			*pneed_todo |= WRITENODE_STATE;
-			pnode->nd_modified |= NODE_UPDATE_COMMENT;
+			node_mark_modified(pnode, NODE_UPDATE_COMMENT);
 		}
 
 		for (i = 0; i < ND_ATR_LAST; i++) {
 			if ((i != ND_ATR_Comment && i != ND_ATR_state) &&
 				(pnode->nd_attr[i].at_flags & ATR_VFLAG_MODIFY)) {
 				*pneed_todo |= WRITE_NEW_NODESFILE;
-				pnode->nd_modified |= NODE_UPDATE_OTHERS;
+				node_mark_modified(pnode, NODE_UPDATE_OTHERS);
 				break;
 			}
 		}
@@ -371,17 +385,15 @@ status_nodeattrib(svrattrl *pal, attribute_def *padef, struct pbsnode *pnode, in
 		nth = 0;
 		while (pal) {
 			++nth;
-			index = find_attr(padef, pal->al_name, limit);
+			index = find_stat_attr(padef, pal->al_name, limit, nth);
 			if (index < 0) {
 				*bad = nth;	/* name in this position not found */
 				rc = PBSE_UNKNODEATR;
 				break;
 			}
 			if ((padef+index)->at_flags & priv) {
-				rc = (padef+index)->at_encode(&pnode->nd_attr[index],
-					phead,
-					(padef+index)->at_name, NULL,
-					ATR_ENCODE_CLIENT, NULL);
+				rc = svrcached(&pnode->nd_attr[index], phead,
+					padef+index);
 				if (rc < 0) {
 					rc = -rc;
 					break;
@@ -398,10 +410,8 @@ status_nodeattrib(svrattrl *pal, attribute_def *padef, struct pbsnode *pnode, in
 		 */
 		for (index = 0; index < limit; index++) {
 			if ((padef+index)->at_flags & priv) {
-				rc = (padef+index)->at_encode(
-					&pnode->nd_attr[index],
-					phead, (padef+index)->at_name,
-					NULL, ATR_ENCODE_CLIENT, NULL);
+				rc = svrcached(&pnode->nd_attr[index], phead,
+					padef+index);
 				if (rc < 0) {
 					rc = -rc;
 					break;
@@ -468,15 +478,18 @@ initialize_pbsnode(struct pbsnode *pnode, char *pname, int ntype)
 	pnode->nd_ntype   = ntype;
 	pnode->nd_nsn     = 0;
 	pnode->nd_nsnfree = 0;
+	pnode->nd_mod_seq = ++svr_mod_seq;
 	pnode->nd_written = 0;
 	pnode->nd_ncpus	  = 1;
 	pnode->nd_psn     = NULL;
 	pnode->nd_hostname= NULL;
 	pnode->nd_state = INUSE_UNKNOWN | INUSE_DOWN;
 	pnode->nd_resvp   = NULL;
+	pnode->nd_seq_resvp = NULL;
 	pnode->nd_pque	  = NULL;
 	pnode->nd_nummoms = 0;
 	pnode->nd_modified = 0;
+	pnode->nd_modlist = 0;
 	pnode->nd_moms    = (struct mominfo **)calloc(1, sizeof(struct mominfo *));
 	if (pnode->nd_moms == NULL)
 		return (PBSE_SYSTEM);
@@ -653,7 +666,7 @@ remove_mom_from_vnodes(mominfo_t *pmom)
 				}
 				pnode->nd_moms[imom] = NULL;
 				--pnode->nd_nummoms;
-				pnode->nd_modified = NODE_UPDATE_OTHERS; /* since we modified nd_nummoms, flag for save */
+				node_mark_modified(pnode, NODE_UPDATE_OTHERS); /* since we modified nd_nummoms, flag for save */
 				/* remove (decr) Mom host from Mom attrbute */
 				(void)node_attr_def[(int)ND_ATR_Mom].at_set(
 					&pnode->nd_attr[(int)ND_ATR_Mom],
@@ -677,7 +690,17 @@ remove_mom_from_vnodes(mominfo_t *pmom)
 void
 free_pnode(struct pbsnode *pnode)
 {
+	int i;
+
 	if (pnode) {
+		if (pnode->nd_modlist) {
+			for (i = 0; i < modified_num; i++) {
+				if (modified_nodes[i] == pnode) {
+					modified_nodes[i] = modified_nodes[--modified_num];
+					break;
+				}
+			}
+		}
 		(void)free(pnode->nd_name);
 		(void)free(pnode->nd_hostname);
 		(void)free(pnode->nd_moms);
@@ -714,6 +737,12 @@ effective_node_delete(struct pbsnode *pnode)
 
 	lic_released = release_node_lic(pnode);
 
+	unindex_vnode_seq_resvs(pnode);
+	invalidate_parsed_execvnodes();
+
+	if (pnode->nd_name != NULL)
+		record_mod_seq_delete(MGR_OBJ_NODE, pnode->nd_name);
+
         /* free attributes */
 
 	for (i=0; i<ND_ATR_LAST; i++) {
@@ -760,9 +789,9 @@ effective_node_delete(struct pbsnode *pnode)
 
 	remove_node_topology(pnode->nd_name);
 
-	/* delete the node from the node tree as well as the node array */
-	if (node_tree != NULL) {
-		tree_add_del(node_tree, pnode->nd_name, NULL, TREE_OP_DEL);
+	/* delete the node from the node index as well as the node array */
+	if (nodes_idx != NULL) {
+		name_idx_add_del(nodes_idx, pnode->nd_name, NULL, NAME_IDX_OP_DEL);
 	}
 
 	for (iht=pnode->nd_arr_index + 1; iht < svr_totnodes; iht++) {
@@ -771,6 +800,7 @@ effective_node_delete(struct pbsnode *pnode)
 		pbsndlist[iht - 1]->nd_arr_index--;
 	}
 	svr_totnodes--;
+	invalidate_node_state_ct();
 	free_pnode(pnode);
 	if (lic_released)
 		license_more_nodes();
@@ -872,7 +902,112 @@ static char *nodeerrtxt = "Node description file update failed";
 
 /**
  * @brief
- *		Static function to update the specified mom in the db. If the
+ *		Set bits in nd_modified of a node and put the node on the
+ *		modified node list, so the next save_nodes_db() or
+ *		write_node_state() writes it.  Use this rather than setting
+ *		nd_modified directly.
+ *
+ * @param[in,out]	pnode	-	the node
+ * @param[in]	flags	-	NODE_UPDATE_* bits to set
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+void
+node_mark_modified(struct pbsnode *pnode, int flags)
+{
+	struct pbsnode **tmp;
+
+	if (pnode == NULL)
+		return;
+
+	pnode->nd_modified |= flags;
+	if (pnode->nd_modlist || !(pnode->nd_modified & NODE_UPDATE_DB_MASK))
+		return;
+
+	if (modified_num == modified_size) {
+		int newsize = modified_size ? modified_size * 2 : 64;
+
+		tmp = realloc(modified_nodes, newsize * sizeof(struct pbsnode *));
+		if (tmp == NULL) {
+			log_err(errno, __func__, "Out of memory, all nodes will be checked");
+			modified_lost = 1;
+			return;
+		}
+		modified_nodes = tmp;
+		modified_size = newsize;
+	}
+	modified_nodes[modified_num++] = pnode;
+	pnode->nd_modlist = 1;
+}
+
+/**
+ * @brief
+ *		Get the nodes that may need to be written to the db.
+ *
+ * @param[out]	num	-	number of nodes returned
+ *
+ * @return	array of nodes, valid until the next node_mark_modified()
+ *		or prune_modified_nodes().  All of pbsndlist if the modified
+ *		node list is incomplete.
+ *
+ * @par MT-safe: No
+ */
+struct pbsnode **
+get_modified_nodes(int *num)
+{
+	if (modified_lost) {
+		*num = svr_totnodes;
+		return pbsndlist;
+	}
+	*num = modified_num;
+	return modified_nodes;
+}
+
+/**
+ * @brief
+ *		Drop the nodes that no longer have anything to write from the
+ *		modified node list.  If the list was incomplete, rebuild it from
+ *		all the nodes.
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+void
+prune_modified_nodes(void)
+{
+	int i;
+	int j;
+	struct pbsnode *np;
+
+	if (modified_lost) {
+		modified_lost = 0;
+		for (i = 0; i < modified_num; i++)
+			modified_nodes[i]->nd_modlist = 0;
+		modified_num = 0;
+		for (i = 0; i < svr_totnodes; i++) {
+			np = pbsndlist[i];
+			if (!(np->nd_state & INUSE_DELETED))
+				node_mark_modified(np, 0);
+		}
+		return;
+	}
+
+	for (i = 0, j = 0; i < modified_num; i++) {
+		np = modified_nodes[i];
+		if ((np->nd_modified & NODE_UPDATE_DB_MASK) && !(np->nd_state & INUSE_DELETED))
+			modified_nodes[j++] = np;
+		else
+			np->nd_modlist = 0;
+	}
+	modified_num = j;
+}
+
+/**
+ * @brief
+ *		Static function to update the specified node in the db. If the
  *		NODE_UPDATE_OTHERS flag is set: for each node, it also calls
  *		the "write_single_node_state" function to update the state and
  *		comment of the node.  If the NODE_UPDATE_MOM flag is set, it
@@ -885,8 +1020,10 @@ static char *nodeerrtxt = "Node description file update failed";
  *		This ensures the nodes which belong only one mom are loaded first, and
  *		the nodes with multi moms are loaded later.
  *
+ * @param[in]	np	-	the node
+ *
  * @see
- * 		save_nodes_db, save_nodes_db_inner
+ * 		save_nodes_db_mom, save_nodes_db_inner
  *
  * @return	error code
  * @retval	-1 - Failure
@@ -894,58 +1031,77 @@ static char *nodeerrtxt = "Node description file update failed";
  *
  */
 static int
-save_nodes_db_mom(mominfo_t *pmom)
+save_node_db_modified(struct pbsnode *np)
 {
-	struct pbsnode *np;
-	pbs_list_head wrtattr;
-	mom_svrinfo_t *psvrm;
 	int	isoff;
 	int	hascomment;
-	int	nchild;
 
-	CLEAR_HEAD(wrtattr);
-
-	if (pmom == NULL)
-		return -1;
+	if (np == NULL)
+		return 0;
 
-	psvrm = (mom_svrinfo_t *) pmom->mi_data;
-	for (nchild = 0; nchild < psvrm->msr_numvnds; ++nchild) {
-		np = psvrm->msr_children[nchild];
-		if (np == NULL)
-			continue;
+	if (np->nd_state & INUSE_DELETED) {
+		/* this shouldn't happen, if it does, ignore it */
+		return 0;
+	}
 
-		if (np->nd_state & INUSE_DELETED) {
-			/* this shouldn't happen, if it does, ignore it */
-			continue;
+	if (np->nd_modified & NODE_UPDATE_OTHERS) {
+		DBPRT(("Saving node %s into the database\n", np->nd_name))
+		if (node_save_db(np) != 0) {
+			log_event(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
+				LOG_WARNING, "nodes", nodeerrtxt);
+			return (-1);
 		}
+		/*
+		 * node record were deleted
+		 * so add state and comments only if set.
+		 * The node is already on the modified node list.
+		 */
+		isoff = np->nd_state &
+			(INUSE_OFFLINE | INUSE_OFFLINE_BY_MOM | INUSE_SLEEP);
 
-		if (np->nd_modified & NODE_UPDATE_OTHERS) {
-			DBPRT(("Saving node %s into the database\n", np->nd_name))
-			if (node_save_db(np) != 0) {
-				log_event(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
-					LOG_WARNING, "nodes", nodeerrtxt);
-				return (-1);
-			}
-			/*
-			 * node record were deleted
-			 * so add state and comments only if set
-			 */
-			isoff = np->nd_state &
-				(INUSE_OFFLINE | INUSE_OFFLINE_BY_MOM | INUSE_SLEEP);
+		hascomment = (np->nd_attr[(int) ND_ATR_Comment].at_flags &
+			(ATR_VFLAG_SET | ATR_VFLAG_DEFLT)) == ATR_VFLAG_SET;
 
-			hascomment = (np->nd_attr[(int) ND_ATR_Comment].at_flags &
-				(ATR_VFLAG_SET | ATR_VFLAG_DEFLT)) == ATR_VFLAG_SET;
+		if (isoff)
+			np->nd_modified |= NODE_UPDATE_STATE;
 
-			if (isoff)
-				np->nd_modified |= NODE_UPDATE_STATE;
+		if (hascomment)
+			np->nd_modified |= NODE_UPDATE_COMMENT;
 
-			if (hascomment)
-				np->nd_modified |= NODE_UPDATE_COMMENT;
+		write_single_node_state(np);
+	} else if (np->nd_modified & NODE_UPDATE_MOM) {
+		write_single_node_mom_attr(np);
+	}
 
-			write_single_node_state(np);
-		} else if (np->nd_modified & NODE_UPDATE_MOM) {
-			write_single_node_mom_attr(np);
-		}
+	return 0;
+}
+
+/**
+ * @brief
+ *		Static function to update the vnodes of the specified mom in the
+ *		db, see save_node_db_modified().
+ *
+ * @see
+ * 		save_nodes_db
+ *
+ * @return	error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ *
+ */
+static int
+save_nodes_db_mom(mominfo_t *pmom)
+{
+	mom_svrinfo_t *psvrm;
+	int	nchild;
+
+	if (pmom == NULL)
+		return -1;
+
+	psvrm = (mom_svrinfo_t *) pmom->mi_data;
+	for (nchild = 0; nchild < psvrm->msr_numvnds; ++nchild) {
+		if (save_node_db_modified(psvrm->msr_children[nchild]) == -1)
+			return -1;
 	}
 
 	return 0;
@@ -953,10 +1109,11 @@ save_nodes_db_mom(mominfo_t *pmom)
 
 /**
  * @brief
- *		Static function to update all the nodes in the db
+ *		Static function to update all the modified nodes in the db.
+ *		Only the nodes on the modified node list are visited.
  *
  * @see
- * 		save_nodes_db_mom
+ * 		save_node_db_modified
  *
  * @return	error code
  * @retval	-1 - Failure
@@ -967,29 +1124,53 @@ static int
 save_nodes_db_inner(void)
 {
 	int i;
-	pbs_list_head wrtattr;
-	mominfo_t *pmom;
+	int num;
+	struct pbsnode **nodes;
 
-	/* for each Mom ... */
-	CLEAR_HEAD(wrtattr);
-
-	for (i = 0; i < mominfo_array_size; ++i) {
-		pmom = mominfo_array[i];
-		if (pmom == NULL)
-			continue;
-
-		if(save_nodes_db_mom(pmom) == -1)
+	nodes = get_modified_nodes(&num);
+	for (i = 0; i < num; ++i) {
+		if (save_node_db_modified(nodes[i]) == -1)
 			return -1;
 	}
 	return 0;
 }
 
+/**
+ * @brief
+ *		Clear the modified bits of a node once it has been saved.
+ *
+ * @param[in,out]	np	-	the node
+ * @param[in]	rscdef	-	node_group_key resource definition or NULL
+ *
+ * @return	void
+ */
+static void
+clear_node_saved(struct pbsnode *np, resource_def *rscdef)
+{
+	int num;
+	resource *resc;
+
+	if (np == NULL || (np->nd_state & INUSE_DELETED))
+		return;
+
+	np->nd_modified &= ~(NODE_UPDATE_OTHERS | NODE_UPDATE_STATE | NODE_UPDATE_COMMENT);
+
+	for (num = 0; num < ND_ATR_LAST; num++)
+		np->nd_attr[num].at_flags &= ~ATR_VFLAG_MODIFY;
+
+	if (rscdef != NULL) {
+		if ((resc = find_resc_entry(&np->nd_attr[ND_ATR_ResourceAvail], rscdef)))
+			resc->rs_value.at_flags &= ~ATR_VFLAG_MODIFY;
+	}
+}
+
 /**
  * @brief
  *		When called, this function will update
  *		all the nodes in the db. It will update the mominfo_time to the db
  *		and save all the nodes which has the NODE_UPDATE_OTHERS flag set. It
- *		saves the nodes by calling a helper function save_nodes_db_inner.
+ *		saves the nodes by calling a helper function save_nodes_db_inner,
+ *		which only visits the nodes on the modified node list.
  *
  *  	The updates are done under a single transaction.
  *  	Upon successful conclusion the transaction is commited.
@@ -1006,16 +1187,14 @@ save_nodes_db_inner(void)
 int
 save_nodes_db(int changemodtime, void *p)
 {
-	struct pbsnode  *np;
 	pbs_db_mominfo_time_t mom_tm;
 	pbs_db_obj_info_t obj;
 	int           num;
-	attribute    *pattr;
-	resource     *resc;
 	char         *rname;
 	resource_def *rscdef;
 	int	i;
 	mominfo_t    *pmom = (mominfo_t *) p;
+	struct pbsnode **nodes;
 
 	DBPRT(("%s: entered\n", __func__))
 
@@ -1062,8 +1241,8 @@ save_nodes_db(int changemodtime, void *p)
 		goto db_err;
 
 	/*
-	 * Clear the ATR_VFLAG_MODIFY bit on each node attribute
-	 * and on the node_group_key resource, for those nodes
+	 * Clear the ATR_VFLAG_MODIFY bit on each attribute of the saved
+	 * nodes and on the node_group_key resource, for those nodes
 	 * that possess a node_group_key resource
 	 */
 
@@ -1078,27 +1257,19 @@ save_nodes_db(int changemodtime, void *p)
 	else
 		rscdef = NULL;
 
-	for (i=0; i<svr_totnodes; i++) {
-		np = pbsndlist[i];
-		if (np->nd_state & INUSE_DELETED)
-			continue;
-
-		/* reset only after transaction is committed */
-		np->nd_modified &= ~(NODE_UPDATE_OTHERS | NODE_UPDATE_STATE | NODE_UPDATE_COMMENT);
-
-		for (num=0; num<ND_ATR_LAST; num++) {
-
-			np->nd_attr[num].at_flags &= ~ATR_VFLAG_MODIFY;
-
-			if (num == ND_ATR_ResourceAvail)
-				if (rname != NULL && rscdef != NULL) {
-					pattr = &np->nd_attr[ND_ATR_ResourceAvail];
-					if ((resc = find_resc_entry(pattr, rscdef)))
-						resc->rs_value.at_flags &= ~ATR_VFLAG_MODIFY;
-				}
+	/* reset only after transaction is committed */
+	if (pmom) {
+		mom_svrinfo_t *psvrm = (mom_svrinfo_t *) pmom->mi_data;
 
-		}
+		for (i = 0; i < psvrm->msr_numvnds; i++)
+			clear_node_saved(psvrm->msr_children[i], rscdef);
+	} else {
+		nodes = get_modified_nodes(&num);
+		for (i = 0; i < num; i++)
+			clear_node_saved(nodes[i], rscdef);
 	}
+	prune_modified_nodes();
+
 	return (0);
 
 db_err:
@@ -1467,7 +1638,7 @@ setup_nodes_fs(int preprocess)
 			}
 			if (sharing_val != VNS_UNSET) {
 				np->nd_attr[ND_ATR_Sharing].at_val.at_long =sharing_val;
-				np->nd_attr[ND_ATR_Sharing].at_flags = ATR_VFLAG_SET | ATR_VFLAG_DEFLT;
+				np->nd_attr[ND_ATR_Sharing].at_flags = ATR_VFLAG_SET | ATR_VFLAG_DEFLT | ATR_VFLAG_MODCACHE;
 			}
 
 		}
@@ -52,9 +52,17 @@
  * 	post_discard_job()
  * 	momptr_down()
  * 	ping_a_mom()
+ * 	account_node_state()
+ * 	invalidate_node_state_ct()
+ * 	update_node_state_ct()
  * 	set_vnode_state()
  * 	vnode_available()
  * 	vnode_unavailable()
+ * 	add_resv_seq_vnode()
+ * 	index_resv_seq_vnodes()
+ * 	unindex_resv_seq_vnodes()
+ * 	unindex_vnode_seq_resvs()
+ * 	append_resvinfo()
  * 	find_vnode_in_resvs()
  * 	find_degraded_occurrence()
  * 	free_rinf_list()
@@ -79,6 +87,7 @@
  * 	check_and_set_multivnode()
  * 	compare_short_hostname()
  * 	mom_running_jobs()
+ * 	drop_current_hook_sends()
  * 	is_request()
  * 	write_single_node_state()
  * 	write_node_state()
@@ -100,6 +109,12 @@
  * 	free_nodes()
  * 	free_resvNodes()
  * 	adj_resc_on_node()
+ * 	free_parsed_execvnode()
+ * 	invalidate_parsed_execvnodes()
+ * 	parse_execvnode()
+ * 	adj_resc_assigned()
+ * 	adj_parsed_execvnode()
+ * 	update_job_node_rassn()
  * 	update_node_rassn()
  * 	mark_node_down()
  * 	momptr_offline_by_mom()
@@ -194,6 +209,7 @@ static int	 cvt_overflow(size_t, size_t);
 static int	 cvt_realloc(char **, size_t *, char **, size_t *);
 
 static void set_resv_for_degrade(struct pbsnode *pnode, resc_resv *presv);
+static int resv_seq_index_incomplete = 0; /* some standing resv could not be indexed */
 extern time_t	 time_now;
 extern int	 server_init_type;
 
@@ -207,6 +223,14 @@ extern struct	license_used  usedlicenses;
 extern int tpp_network_up; /* from pbsd_main.c - used only in case of TPP */
 extern struct work_task *global_ping_task;
 
+/*
+ * The periodic pings are sent in slices of at least PING_SLICE_MIN Moms,
+ * spread over the ping period, so that a large number of Moms are not
+ * pinged, and do not reply, all at once.
+ */
+#define PING_SLICE_MIN	512
+static int ping_slice_next = 0;	/* first Mom of the next slice */
+
 extern pbs_list_head svr_unlicensedjobs;
 
 extern unsigned int pbs_mom_port;
@@ -1279,6 +1303,15 @@ ping_a_mom(mominfo_t *pmom, int force_hello, int once)
 		if (ret != DIS_SUCCESS)
 			goto err;
 	}
+	if ((com == IS_HELLO) || (com == IS_HELLO_NO_INVENTORY)) {
+		/*
+		 ** Tell MOM which updates we accept.
+		 ** Old versions of MOM will ignore extra data.
+		 */
+		ret = diswsi(psvrmom->msr_stream, HELLO_delta_update);
+		if (ret != DIS_SUCCESS)
+			goto err;
+	}
 
 	if (rpp_flush(psvrmom->msr_stream) == 0) {
 
@@ -1343,6 +1376,15 @@ ping_flush_mcast(int mtfd, int com)
 		if (ret != DIS_SUCCESS)
 			goto err;
 	}
+	if ((com == IS_HELLO) || (com == IS_HELLO_NO_INVENTORY)) {
+		/*
+		 ** Tell MOM which updates we accept.
+		 ** Old versions of MOM will ignore extra data.
+		 */
+		ret = diswsi(mtfd, HELLO_delta_update);
+		if (ret != DIS_SUCCESS)
+			goto err;
+	}
 
 	if (rpp_flush(mtfd) == 0) {
 		/*
@@ -1429,6 +1471,121 @@ ping_a_mom_mcast(mominfo_t *pmom, int force_hello, int mtfd_ishello, int mtfd_is
 	}
 }
 
+/*
+ * Number of vnodes in each state, reported through the server's
+ * node_state_count attribute.  A vnode is counted once under every state
+ * bit it has set, or under "free" if it has none.  set_vnode_state() keeps
+ * the counts current; adding or deleting vnodes marks them stale and they
+ * are rebuilt from pbsndlist the next time they are reported.
+ */
+static struct node_state_ct {
+	unsigned long	 nsc_bit;
+	char		*nsc_name;
+	int		 nsc_count;
+} node_state_ct[] = {
+	{INUSE_FREE,		ND_free,		0},
+	{INUSE_JOB,		ND_jobbusy,		0},
+	{INUSE_JOBEXCL,		ND_job_exclusive,	0},
+	{INUSE_RESVEXCL,	ND_resv_exclusive,	0},
+	{INUSE_BUSY,		ND_busy,		0},
+	{INUSE_OFFLINE,		ND_offline,		0},
+	{INUSE_DOWN,		ND_down,		0},
+	{INUSE_STALE,		ND_Stale,		0},
+	{INUSE_UNKNOWN,		ND_state_unknown,	0},
+	{INUSE_UNRESOLVABLE,	ND_unresolvable,	0},
+	{INUSE_INIT,		ND_Initializing,	0},
+	{INUSE_PROV,		ND_prov,		0},
+	{INUSE_WAIT_PROV,	ND_wait_prov,		0},
+	{INUSE_MAINTENANCE,	ND_maintenance,		0},
+	{INUSE_SLEEP,		ND_sleep,		0}
+};
+#define NUM_NODE_STATE_CT (sizeof(node_state_ct) / sizeof(node_state_ct[0]))
+static int node_state_ct_stale = 1;
+
+/**
+ * @brief
+ * 		account_node_state - add a vnode with the given state to, or remove
+ * 		it from, the per state vnode counts
+ *
+ * @param[in]	state	- the vnode's state bits
+ * @param[in]	delta	- 1 to add the vnode, -1 to remove it
+ *
+ * @return	void
+ */
+static void
+account_node_state(unsigned long state, int delta)
+{
+	int i;
+
+	if (state & INUSE_DELETED)
+		return;
+	state &= INUSE_SUBNODE_MASK;
+	/* offline_by_mom is shown as offline, so count it as such */
+	if (state & INUSE_OFFLINE_BY_MOM)
+		state = (state & ~INUSE_OFFLINE_BY_MOM) | INUSE_OFFLINE;
+
+	if (state == INUSE_FREE) {
+		node_state_ct[0].nsc_count += delta;
+		return;
+	}
+	for (i = 1; i < NUM_NODE_STATE_CT; i++) {
+		if (state & node_state_ct[i].nsc_bit)
+			node_state_ct[i].nsc_count += delta;
+	}
+}
+
+/**
+ * @brief
+ * 		invalidate_node_state_ct - mark the per state vnode counts stale so
+ * 		they are rebuilt from the vnode list before they are next reported.
+ * 		Called when vnodes are added or deleted.
+ *
+ * @return	void
+ */
+void
+invalidate_node_state_ct(void)
+{
+	node_state_ct_stale = 1;
+}
+
+/**
+ * @brief
+ * 		update_node_state_ct - update the server's node_state_count
+ * 		attribute from the per state vnode counts
+ *
+ * @param[out]	pattr	- the server's node_state_count attribute
+ * @param[out]	buf	- buffer holding the attribute's string value
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+void
+update_node_state_ct(attribute *pattr, char *buf)
+{
+	int  i;
+	char newbuf[sizeof(server.sv_nodestbuf)];
+
+	if (node_state_ct_stale) {
+		for (i = 0; i < NUM_NODE_STATE_CT; i++)
+			node_state_ct[i].nsc_count = 0;
+		for (i = 0; i < svr_totnodes; i++)
+			account_node_state(pbsndlist[i]->nd_state, 1);
+		node_state_ct_stale = 0;
+	}
+
+	newbuf[0] = '\0';
+	for (i = 0; i < NUM_NODE_STATE_CT; i++)
+		sprintf(newbuf + strlen(newbuf), "%s:%d ", node_state_ct[i].nsc_name,
+			node_state_ct[i].nsc_count);
+	pattr->at_val.at_str = buf;
+	/* only a change of the counts invalidates the cached encoding */
+	if (((pattr->at_flags & ATR_VFLAG_SET) == 0) || (strcmp(buf, newbuf) != 0)) {
+		strcpy(buf, newbuf);
+		pattr->at_flags |= ATR_VFLAG_SET | ATR_VFLAG_MODCACHE;
+	}
+}
+
 /**
  * @brief
  * 		Change the state of a vnode. See pbs_nodes.h for definition of node's
@@ -1476,6 +1633,11 @@ set_vnode_state(struct pbsnode *pnode, unsigned long state_bits, enum vnode_stat
 			pnode->nd_state = state_bits;
 	}
 
+	if (!node_state_ct_stale && (nd_prev_state != pnode->nd_state)) {
+		account_node_state(nd_prev_state, -1);
+		account_node_state(pnode->nd_state, 1);
+	}
+
 	DBPRT(("%s(%5s): Requested state transition 0x%lx --> 0x%lx\n", __func__, pnode->nd_name,
 		nd_prev_state, pnode->nd_state))
 
@@ -1818,10 +1980,267 @@ vnode_unavailable(struct pbsnode *np, int account_vnode)
 
 /**
  * @brief
- * 		Search all reservations for an associated node that matches the one
- * 		passed as argument.
+ * 		Add a standing reservation to the index of a vnode, and the vnode to
+ * 		the reservation's back list, unless already present.
+ *
+ * @param[in,out]	presv	- the standing reservation
+ * @param[in,out]	np	- the vnode appearing in one of its occurrences
  *
- * @param[in]	np	-	The node to find in the reservations list
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- out of memory
+ *
+ * @par MT-safe: No
+ */
+static int
+add_resv_seq_vnode(resc_resv *presv, struct pbsnode *np)
+{
+	struct resvinfo *rp;
+	pbsnode_list_t *pl;
+
+	/* entries for one reservation are added consecutively */
+	if (np->nd_seq_resvp != NULL && np->nd_seq_resvp->resvp == presv)
+		return 0;
+
+	if ((rp = malloc(sizeof(struct resvinfo))) == NULL)
+		return -1;
+	if ((pl = malloc(sizeof(pbsnode_list_t))) == NULL) {
+		free(rp);
+		return -1;
+	}
+	rp->resvp = presv;
+	rp->next = np->nd_seq_resvp;
+	np->nd_seq_resvp = rp;
+
+	pl->vnode = np;
+	pl->next = presv->ri_seq_vnodes;
+	presv->ri_seq_vnodes = pl;
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 		Index the vnodes of every occurrence of a standing reservation so that
+ * 		a vnode going down finds the reservations it affects without parsing
+ * 		the execvnodes sequence of every reservation on the server.
+ * 		The index is rebuilt only when the sequence has changed since it was
+ * 		last built.
+ *
+ * @see
+ * 		assign_resv_resc and find_vnode_in_resvs
+ *
+ * @param[in,out]	presv	- the reservation to index
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+void
+index_resv_seq_vnodes(resc_resv *presv)
+{
+	char *execvnodes;
+	char *seq_copy;
+	char **execvnodes_seq;
+	char **tofree = NULL;
+	char *execvncopy;
+	char *chunk;
+	char *last;
+	char *vname;
+	int hasprn;
+	int nelem;
+	struct key_value_pair *pkvp;
+	struct pbsnode *np;
+	int i;
+
+	if (presv == NULL)
+		return;
+
+	if (presv->ri_wattr[RESV_ATR_resv_standing].at_val.at_long == 0)
+		return;
+
+	if ((presv->ri_wattr[RESV_ATR_resv_execvnodes].at_flags & ATR_VFLAG_SET) == 0) {
+		unindex_resv_seq_vnodes(presv);
+		return;
+	}
+	execvnodes = presv->ri_wattr[RESV_ATR_resv_execvnodes].at_val.at_str;
+
+	if (presv->ri_seq_indexed != NULL &&
+		strcmp(presv->ri_seq_indexed, execvnodes) == 0)
+		return;
+
+	unindex_resv_seq_vnodes(presv);
+
+	if ((seq_copy = strdup(execvnodes)) == NULL)
+		goto err;
+	execvnodes_seq = unroll_execvnode_seq(seq_copy, &tofree);
+	if (execvnodes_seq == NULL || tofree == NULL) {
+		free(execvnodes_seq);
+		free(seq_copy);
+		goto err;
+	}
+	free(execvnodes_seq);
+
+	/* tofree holds each distinct execvnode of the sequence once */
+	for (i = 0; tofree[i] != NULL; i++) {
+		if ((execvncopy = strdup(tofree[i])) == NULL)
+			break;
+		for (chunk = parse_plus_spec_r(execvncopy, &last, &hasprn);
+			chunk != NULL;
+			chunk = parse_plus_spec_r(last, &last, &hasprn)) {
+			if (parse_node_resc(chunk, &vname, &nelem, &pkvp) != 0)
+				continue;
+			if ((np = find_nodebyname(vname)) == NULL)
+				continue;
+			if (add_resv_seq_vnode(presv, np) != 0)
+				break;
+		}
+		free(execvncopy);
+		if (chunk != NULL)
+			break;
+	}
+	if (tofree[i] != NULL) {
+		free_execvnode_seq(tofree);
+		free(seq_copy);
+		goto err;
+	}
+	free_execvnode_seq(tofree);
+	free(seq_copy);
+
+	if ((presv->ri_seq_indexed = strdup(execvnodes)) == NULL)
+		goto err;
+	return;
+
+err:
+	log_err(errno, __func__, "could not index the vnodes of the reservation");
+	unindex_resv_seq_vnodes(presv);
+	resv_seq_index_incomplete = 1;
+}
+
+/**
+ * @brief
+ * 		Remove a reservation from the index of every vnode of its occurrences.
+ *
+ * @param[in,out]	presv	- the reservation being removed or reindexed
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+void
+unindex_resv_seq_vnodes(resc_resv *presv)
+{
+	pbsnode_list_t *pl;
+	struct resvinfo *rp;
+	struct resvinfo *prev;
+
+	if (presv == NULL)
+		return;
+
+	while ((pl = presv->ri_seq_vnodes) != NULL) {
+		for (prev = NULL, rp = pl->vnode->nd_seq_resvp; rp;
+			prev = rp, rp = rp->next) {
+			if (rp->resvp == presv) {
+				if (prev == NULL)
+					pl->vnode->nd_seq_resvp = rp->next;
+				else
+					prev->next = rp->next;
+				free(rp);
+				break;
+			}
+		}
+		presv->ri_seq_vnodes = pl->next;
+		free(pl);
+	}
+	free(presv->ri_seq_indexed);
+	presv->ri_seq_indexed = NULL;
+}
+
+/**
+ * @brief
+ * 		Remove a vnode that is being deleted from the occurrence index of the
+ * 		standing reservations that reference it.
+ *
+ * @param[in,out]	np	- the vnode being deleted
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+void
+unindex_vnode_seq_resvs(struct pbsnode *np)
+{
+	struct resvinfo *rp;
+	pbsnode_list_t *pl;
+	pbsnode_list_t *prev;
+
+	if (np == NULL)
+		return;
+
+	while ((rp = np->nd_seq_resvp) != NULL) {
+		for (prev = NULL, pl = rp->resvp->ri_seq_vnodes; pl;
+			prev = pl, pl = pl->next) {
+			if (pl->vnode == np) {
+				if (prev == NULL)
+					rp->resvp->ri_seq_vnodes = pl->next;
+				else
+					prev->next = pl->next;
+				free(pl);
+				break;
+			}
+		}
+		np->nd_seq_resvp = rp->next;
+		free(rp);
+	}
+}
+
+/**
+ * @brief
+ * 		Append a reservation to the resvinfo list being built by
+ * 		find_vnode_in_resvs.
+ *
+ * @param[in,out]	head	- head of the list
+ * @param[in,out]	tail	- last element of the list
+ * @param[in]	presv	- the reservation to append
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- out of memory
+ *
+ * @par MT-safe: No
+ */
+static int
+append_resvinfo(struct resvinfo **head, struct resvinfo **tail, resc_resv *presv)
+{
+	struct resvinfo *rinfp;
+
+	if ((rinfp = malloc(sizeof(struct resvinfo))) == NULL) {
+		log_err(PBSE_SYSTEM, __func__,
+			"could not allocate memory to create a resvinfo list");
+		return -1;
+	}
+	rinfp->resvp = presv;
+	rinfp->next = NULL;
+	if (*tail == NULL)
+		*head = rinfp;
+	else
+		(*tail)->next = rinfp;
+	*tail = rinfp;
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 		Find the reservations associated to the node passed as argument.
+ *
+ * 		Advance reservations are taken from the node's nd_resvp list and
+ * 		standing reservations from its nd_seq_resvp index, so only those
+ * 		reservations are examined rather than every reservation on the server.
+ * 		If the index could not be built for some reservation, standing
+ * 		reservations are found by walking all reservations as before.
+ *
+ * @param[in]	np	-	The node to search for
  * @param[in]	vnode_degraded_op	-	To indicate whether to set the degraded time on
  * 										the reservation or not.
  *
@@ -1838,65 +2257,45 @@ vnode_unavailable(struct pbsnode *np, int account_vnode)
 struct resvinfo *
 find_vnode_in_resvs(struct pbsnode *np, enum vnode_degraded_op degraded_op)
 {
-	struct resvinfo *rinfp;
-	struct resvinfo *parent_rinfp;
+	struct resvinfo *head = NULL;
+	struct resvinfo *tail = NULL;
+	struct resvinfo *rp;
+	struct resvinfo *seen;
 	resc_resv *presv;
-	pbsnode_list_t *pl;
-	int match = 0;
-	int is_degraded = 0;
 
 	if (np == NULL)
 		return NULL;
 
-	/* Walk all reservations and check if the node is associated to an
-	 * occurrence of a standing reservation
-	 *
-	 * While walking the reservation's list, we create a resv info linked list
-	 * that contains all reservations on which the node appears
+	/* Advance reservations: the node carries a resvinfo for each reservation
+	 * it is allocated to. Set the degraded time to be the start time of the
+	 * reservation.
 	 */
-	rinfp = malloc(sizeof(struct resvinfo));
-	if (!rinfp)
-		return NULL;
-
-	rinfp->resvp = NULL;
-	rinfp->next = NULL;
-
-	parent_rinfp = rinfp;
+	for (rp = np->nd_resvp; rp; rp = rp->next) {
+		presv = rp->resvp;
+		if (presv->ri_wattr[RESV_ATR_resv_standing].at_val.at_long != 0)
+			continue;
+		/* a vnode holding several chunks of a reservation is listed once */
+		for (seen = head; seen; seen = seen->next) {
+			if (seen->resvp == presv)
+				break;
+		}
+		if (seen != NULL)
+			continue;
+		presv->ri_degraded_time = presv->ri_wattr[RESV_ATR_start].at_val.at_long;
+		if (append_resvinfo(&head, &tail, presv) != 0)
+			return head;
+	}
 
-	for (presv = (resc_resv *) GET_NEXT(svr_allresvs); presv != NULL;
-		presv = (resc_resv *) GET_NEXT(presv->ri_allresvs)) {
-		/* When processing an advance reservation, set the degraded time to be
-		 * the start time of the reservation and process the next reservation
-		 */
-		if (presv->ri_wattr[RESV_ATR_resv_standing].at_val.at_long == 0) {
-			for (pl = presv->ri_pbsnode_list; pl; pl=pl->next) {
-				if (np == pl->vnode)
-					break;
-			}
-			if (!pl)
+	/* Standing reservations: only those having the node in an occurrence
+	 * need their sequence searched for the degraded occurrence
+	 */
+	if (resv_seq_index_incomplete) {
+		for (presv = (resc_resv *) GET_NEXT(svr_allresvs); presv != NULL;
+			presv = (resc_resv *) GET_NEXT(presv->ri_allresvs)) {
+			if (presv->ri_wattr[RESV_ATR_resv_standing].at_val.at_long == 0)
 				continue;
-
-			presv->ri_degraded_time = presv->ri_wattr[RESV_ATR_start].at_val.at_long;
-			if (!match) {
-				rinfp->resvp = presv;
-				rinfp->next = NULL;
-				match = 1;
-			} else {
-				rinfp->next = malloc(sizeof(struct resvinfo));
-				if (!rinfp->next) {
-					log_err(PBSE_SYSTEM, __func__,
-						"could not allocate memory to create a resvinfo list");
-					break;
-				}
-				rinfp = rinfp->next;
-				rinfp->resvp = presv;
-				rinfp->next = NULL;
-			}
-		} else { /* Standing Reservation */
-			/* If the sequence of execvnodes of the considered standing reservation
-			 * isn't set, process the next element. Note that this should never
-			 * happen as the reservation should have been confirmed and the nodes
-			 * been assigned to it
+			/* Note that this should never happen as the reservation should
+			 * have been confirmed and the nodes been assigned to it
 			 */
 			if ((presv->ri_wattr[RESV_ATR_resv_execvnodes].at_flags
 				& ATR_VFLAG_SET) == 0) {
@@ -1904,41 +2303,25 @@ find_vnode_in_resvs(struct pbsnode *np, enum vnode_degraded_op degraded_op)
 					presv->ri_qs.ri_resvID, "Reservation's execvnodes_seq are corrupted");
 				continue;
 			}
-			is_degraded = find_degraded_occurrence(presv, np, degraded_op);
-
-			/* If no occurrence is degraded move on to the next reservation */
-			if (is_degraded == 0)
+			if (find_degraded_occurrence(presv, np, degraded_op) == 0)
 				continue;
-
-			/* Add the reservation to the constructed linked list to which this
-			 * node is associated
-			 */
-			if (!match) {
-				rinfp->resvp = presv;
-				rinfp->next = NULL;
-				match = 1;
-			} else {
-				rinfp->next = malloc(sizeof(struct resvinfo));
-				if (!rinfp->next) {
-					log_err(PBSE_SYSTEM, __func__,
-						"could not allocate memory to create a resvinfo list");
-					break;
-				}
-				rinfp = rinfp->next;
-				rinfp->resvp = presv;
-				rinfp->next = NULL;
-			}
+			if (append_resvinfo(&head, &tail, presv) != 0)
+				break;
+		}
+	} else {
+		for (rp = np->nd_seq_resvp; rp; rp = rp->next) {
+			presv = rp->resvp;
+			if ((presv->ri_wattr[RESV_ATR_resv_execvnodes].at_flags
+				& ATR_VFLAG_SET) == 0)
+				continue;
+			if (find_degraded_occurrence(presv, np, degraded_op) == 0)
+				continue;
+			if (append_resvinfo(&head, &tail, presv) != 0)
+				break;
 		}
 	}
 
-	/* no reservations are associated to this vnode */
-	if (!match) {
-		free(rinfp);
-		rinfp = NULL;
-		parent_rinfp = NULL;
-	}
-
-	return parent_rinfp;
+	return head;
 }
 
 /**
@@ -1973,6 +2356,7 @@ find_degraded_occurrence(resc_resv *presv, struct pbsnode *np,
 	long dtstart;
 	long occr_time;
 	long curr_degraded_time;
+	time_t *occr_times = NULL;
 	int ridx;
 	int ridx_adjusted;
 	int rcount;
@@ -2017,9 +2401,18 @@ find_degraded_occurrence(resc_resv *presv, struct pbsnode *np,
 			occr_found = 1;
 			if (degraded_op == Set_Degraded_Time) {
 				/* we keep track of the occurrence time to determine the earliest
-				 * degraded time
+				 * degraded time. The times of the remaining occurrences are
+				 * computed together the first time one is needed.
 				 */
-				occr_time = get_occurrence(rrule, dtstart, tz, j);
+				if (occr_times == NULL &&
+					(occr_times = malloc(sizeof(time_t) *
+					(rcount_adjusted - ridx_adjusted + 1))) != NULL)
+					get_occurrences(rrule, dtstart, tz,
+						rcount_adjusted - ridx_adjusted + 1, occr_times);
+				if (occr_times != NULL)
+					occr_time = occr_times[j - 1];
+				else
+					occr_time = get_occurrence(rrule, dtstart, tz, j);
 
 				/* Set the degraded start time to the earliest occurrence
 				 * with unavailable nodes. We do not check for
@@ -2049,6 +2442,7 @@ find_degraded_occurrence(resc_resv *presv, struct pbsnode *np,
 		}
 	}
 	/* clean up unrolled execvnodes sequence helpers */
+	free(occr_times);
 	free(execvnodes_seq);
 	execvnodes_seq = NULL;
 	free(short_execvnodes_seq);
@@ -2472,6 +2866,7 @@ stat_update(int stream)
 					/* this causes a save of the job */
 					svr_setjobstate(pjob, JOB_STATE_RUNNING,
 						JOB_SUBSTATE_RUNNING);
+					job_stage_mark(pjob, JOB_STAGE_RUNNING);
 					/*
 					 * If JOB_DEPEND_TYPE_BEFORESTART dependency is set for the current job
 					 * then release the after dependency for its childs as the current job
@@ -2497,9 +2892,14 @@ stat_update(int stream)
 				/* if something other than the session id */
 				/* or resources_used was modified         */
 
+				/* resources_used is marked not to be saved on  */
+				/* modify (ATR_DFLAG_NOSAVM); it is written by */
+				/* the next save made for another reason       */
+
 				pjob->ji_wattr[(int)JOB_ATR_session_id].at_flags &= ~ATR_VFLAG_MODIFY;
 				for (i = 0; i < JOB_ATR_LAST; ++i) {
-					if (pjob->ji_wattr[i].at_flags & ATR_VFLAG_MODIFY) {
+					if ((pjob->ji_wattr[i].at_flags & ATR_VFLAG_MODIFY) &&
+						((job_attr_def[i].at_flags & ATR_DFLAG_NOSAVM) == 0)) {
 						job_save(pjob, SAVEJOB_FULL);
 						break;
 					}
@@ -2522,6 +2922,10 @@ stat_update(int stream)
  *
  *		Decode the message into a resc_used_update structure and call
  *		job_obit() to start the end of job procedures
+ * @par
+ *		A message may hold the obits of many jobs.  They are processed
+ *		in one database transaction, and the accounting records they
+ *		write are flushed once at the end.
  * @see
  * 		is_request
  *
@@ -2535,11 +2939,18 @@ recv_job_obit(int stream)
 {
 	int njobs;
 	int rc;
+	int in_trx = 0;
 
 	njobs = disrui(stream, &rc);	/* number of jobs in update */
 	if (rc)
 		return;
 
+	if (njobs > 1) {
+		if (pbs_db_begin_trx(svr_db_conn, 0, 0) == 0)
+			in_trx = 1;
+		acct_hold(1);
+	}
+
 	while (njobs--) {
 		struct resc_used_update *prused;
 
@@ -2575,6 +2986,17 @@ recv_job_obit(int stream)
 		}
 
 	}
+
+	acct_hold(0);
+	if (in_trx && (pbs_db_end_trx(svr_db_conn, PBS_DB_COMMIT) != 0)) {
+		sprintf(log_buffer, "Failed to write job obits ");
+		if (svr_db_conn->conn_db_err != NULL)
+			strncat(log_buffer, svr_db_conn->conn_db_err,
+				LOG_BUF_SIZE - strlen(log_buffer) - 1);
+		log_err(-1, __func__, log_buffer);
+		(void) pbs_db_end_trx(svr_db_conn, PBS_DB_ROLLBACK);
+		panic_stop_db(log_buffer);
+	}
 }
 
 /**
@@ -2920,6 +3342,8 @@ deallocate_job_from_node(job *pjob, struct pbsnode *pnode)
 			}
 			free(jp);
 			jp = NULL;
+			/* the jobs attribute is encoded from the subnodes */
+			pnode->nd_attr[(int)ND_ATR_jobs].at_flags |= ATR_VFLAG_MODCACHE;
 		}
 		if (np->jobs == NULL) {
 			np->inuse &= ~(INUSE_JOB|INUSE_JOBEXCL);
@@ -3298,7 +3722,10 @@ mark_nodes_unknown(int all)
  * @brief
  * 		Send a ping to any node that is in an unknown stat.
  * @par
- *		If wt_parm1 is NULL, set up a worktask to ping again.
+ *		If called from a work task, only the next slice of the Moms is
+ *		pinged and a worktask is set up to ping the slice after it, so
+ *		that every Mom is pinged once in each ping_nodes_rate seconds.
+ *		Otherwise all the Moms are pinged once.
  *
  * @param[in]	ptask	-	work task structure.
  *
@@ -3309,11 +3736,31 @@ ping_nodes(struct work_task *ptask)
 {
 	int	i;
 	int	once = 0;
+	int	first = 0;
+	int	last = mominfo_array_size;
+	int	nslices = 1;
+	int	delay = ping_nodes_rate;
 
 	DBPRT(("%s: entered\n", __func__))
 
 	if (!ptask)
 		once = 1; /* not main ping series, just an one shot ping for any new devices */
+	else {
+		nslices = (mominfo_array_size + PING_SLICE_MIN - 1) / PING_SLICE_MIN;
+		if (nslices > ping_nodes_rate)
+			nslices = ping_nodes_rate;
+		if (nslices > 1) {
+			delay = ping_nodes_rate / nslices;
+			if (ping_slice_next >= mominfo_array_size)
+				ping_slice_next = 0;
+			first = ping_slice_next;
+			last = first + (mominfo_array_size + nslices - 1) / nslices;
+			if (last > mominfo_array_size)
+				last = mominfo_array_size;
+			ping_slice_next = last;
+		} else
+			ping_slice_next = 0;
+	}
 
 	if (pbs_conf.pbs_use_tcp == 1) {
 		/*
@@ -3348,7 +3795,7 @@ ping_nodes(struct work_task *ptask)
 				return;
 			}
 
-			for (i = 0; i < mominfo_array_size; i++) {
+			for (i = first; i < last; i++) {
 				if (mominfo_array[i]) {
 					ping_a_mom_mcast(mominfo_array[i], 0,
 						mtfd_ishello, mtfd_isnull,
@@ -3365,7 +3812,7 @@ ping_nodes(struct work_task *ptask)
 			tpp_mcast_close(mtfd_ishello_no_inv);
 		}
 	} else {
-		for (i = 0; i < mominfo_array_size; i++) {
+		for (i = first; i < last; i++) {
 			if (mominfo_array[i]) {
 				ping_a_mom(mominfo_array[i], 0, once);
 			}
@@ -3373,7 +3820,7 @@ ping_nodes(struct work_task *ptask)
 	}
 
 	if (ptask != NULL)
-		global_ping_task = set_task(WORK_Timed, time_now + ping_nodes_rate, ping_nodes, NULL);
+		global_ping_task = set_task(WORK_Timed, time_now + delay, ping_nodes, NULL);
 }
 
 /**
@@ -3562,6 +4009,7 @@ cross_link_mom_vnode(struct pbsnode *pnode, mominfo_t *pmom)
 			&tmpmom, INCR);
 		if (pnode->nd_modified != NODE_UPDATE_OTHERS)
 			pnode->nd_modified = NODE_UPDATE_MOM; /* since we modified nd_nummoms, save it */
+		node_mark_modified(pnode, 0);
 		node_attr_def[(int) ND_ATR_Mom].at_free(&tmpmom);
 	}
 
@@ -3614,6 +4062,8 @@ cross_link_mom_vnode(struct pbsnode *pnode, mominfo_t *pmom)
  * @param[out] from_hook - set non-zero if request coming from hook
  *			  Normally set to 1 for regular vnoded request;
  *			  2 for qmgr-like (non-vnoded) request.
+ * @param[in]  partial - true if pvnal holds only the attributes Mom changed
+ *			 (IS_UPDATE_DELTA), so those it leaves out are kept
  *
  * @return int
  * @retval	zero	- ok
@@ -3622,7 +4072,7 @@ cross_link_mom_vnode(struct pbsnode *pnode, mominfo_t *pmom)
  * @par MT-safe: No
  */
 static int
-update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from_hook)
+update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from_hook, int partial)
 {
 	int bad;
 	int i;
@@ -3789,7 +4239,7 @@ update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from
 	 *	the default setting if Mom no longer sends anything
 	 */
 
-	if (!from_hook) {
+	if (!from_hook && !partial) {
 		for (i = 0; i < ND_ATR_LAST; ++i) {
 			/* if this vnode has been updated earlier in this update2 */
 			/* then don't free anything but topology */
@@ -3817,7 +4267,7 @@ update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from
 		if ((pnode->nd_modified & NODE_UPDATE_VNL) == 0) {
 			pnode->nd_attr[(int)ND_ATR_Sharing].at_val.at_long = VNS_DFLT_SHARED;
 			pnode->nd_attr[(int)ND_ATR_Sharing].at_flags =
-				(ATR_VFLAG_SET |ATR_VFLAG_DEFLT);
+				(ATR_VFLAG_SET |ATR_VFLAG_DEFLT | ATR_VFLAG_MODCACHE);
 		}
 		(void)release_node_lic(pnode);
 	}
@@ -4498,6 +4948,49 @@ err:
 }
 
 
+/**
+ * @brief
+ * 		Drop pending sends of hook files a mom reported, by checksum,
+ *		to already have in their current version.
+ *
+ * @par
+ *		Every mom gets all the hook files queued for sending when the
+ *		server starts, before the mom has had a chance to report its
+ *		hook checksums. Dropping the sends the report shows are not
+ *		needed means only moms with differing hook files get them,
+ *		instead of all moms getting everything again.
+ *		Nothing is dropped while a delete of the hook is pending, so
+ *		that a delete followed by a re-send still completes.
+ *
+ * @param[in] pmom    - the mom that reported the checksums
+ * @param[in] hname   - the hook, or PBS_RESCDEF
+ * @param[in] current - the MOM_HOOK_ACTION_SEND_* flags of the files
+ *			the mom has in their current version
+ *
+ * @return none
+ */
+static void
+drop_current_hook_sends(mominfo_t *pmom, char *hname, unsigned int current)
+{
+	mom_hook_action_t *pact;
+
+	if (current == 0)
+		return;
+
+	pact = find_mom_hook_action(pmom->mi_action, pmom->mi_num_action,
+		hname);
+	if ((pact == NULL) || ((pact->action & current) == 0) ||
+		(pact->action & (MOM_HOOK_ACTION_DELETE|MOM_HOOK_ACTION_DELETE_RESCDEF)))
+		return;
+
+	snprintf(log_buffer, sizeof(log_buffer),
+		"mom %s already has the current hook files, not resending",
+		pmom->mi_host);
+	log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_HOOK, LOG_INFO, hname,
+		log_buffer);
+	delete_pending_mom_hook_action(pmom, hname, pact->action & current);
+}
+
 /**
  * @brief
  * 		Input is coming from another server (MOM) over a DIS rpp stream.
@@ -4761,9 +5254,11 @@ found:
 
 		case IS_UPDATE:
 		case IS_UPDATE2:
+		case IS_UPDATE_DELTA:
 			if (psvrmom->msr_vnode_pool != 0) {
 				sprintf(log_buffer, "POOL: IS_UPDATE%c received",
-					(command == IS_UPDATE)?' ':'2');
+					(command == IS_UPDATE)?' ':
+					((command == IS_UPDATE2)?'2':'D'));
 				log_event(PBSEVENT_DEBUG4, PBS_EVENTCLASS_NODE,
 					LOG_INFO, pmom->mi_host, log_buffer);
 			}
@@ -4772,8 +5267,10 @@ found:
 			made_new_vnodes = 0;
 			if (command == IS_UPDATE) {
 				DBPRT(("%s: IS_UPDATE %s\n", __func__, pmom->mi_host))
-			} else {
+			} else if (command == IS_UPDATE2) {
 				DBPRT(("%s: IS_UPDATE2 %s\n", __func__, pmom->mi_host))
+			} else {
+				DBPRT(("%s: IS_UPDATE_DELTA %s\n", __func__, pmom->mi_host))
 			}
 
 			set_all_state(pmom, 0, INUSE_BUSY|INUSE_UNKNOWN, NULL,
@@ -4840,7 +5337,8 @@ found:
 
 			if ((psvrmom->msr_state & INUSE_MARKEDDOWN) == 0) {
 				sprintf(log_buffer, "update%c state:%d ncpus:%ld",
-					command==IS_UPDATE ? ' ' : '2',
+					command==IS_UPDATE ? ' ' :
+					(command==IS_UPDATE2 ? '2' : 'D'),
 					s, psvrmom->msr_pcpus);
 				log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_NODE,
 					LOG_INFO, pmom->mi_host, log_buffer);
@@ -4870,7 +5368,7 @@ found:
 						/* unset or ATR_VFLAG_DEFLT is set */
 						np->nd_attr[(int)ND_ATR_Sharing].at_val.at_long = (long)VNS_DFLT_SHARED;
 						np->nd_attr[(int)ND_ATR_Sharing].at_flags =
-							ATR_VFLAG_SET|ATR_VFLAG_DEFLT;
+							ATR_VFLAG_SET|ATR_VFLAG_DEFLT|ATR_VFLAG_MODCACHE;
 					}
 
 
@@ -4962,7 +5460,7 @@ found:
 						vnal_t	*vnrlp;
 						vnrlp = VNL_NODENUM(vnlp, i);
 						/* create vnode */
-						(void)update2_to_vnode(vnrlp, cr_node, pmom, &made_new_vnodes, 0);
+						(void)update2_to_vnode(vnrlp, cr_node, pmom, &made_new_vnodes, 0, 0);
 						for (j = 0; j < vnrlp->vnal_used; j++) {
 							vna_t	*psrp;
 
@@ -5008,6 +5506,37 @@ found:
 				vnlp = NULL;
 			}
 
+			/*
+			 * UPDATE_DELTA message - the vnodes Mom last sent in
+			 * UPDATE2 are unchanged but for the attributes listed,
+			 * so nothing is marked stale or reset to its default.
+			 */
+
+			if (command == IS_UPDATE_DELTA) {
+				vnlp = vn_decode_DIS(stream, &ret);
+				if (ret != DIS_SUCCESS)
+					goto err;
+				if (vnlp == NULL) {
+					sprintf(log_buffer, "vn_decode_DIS vn failed");
+					log_err(-1, __func__, log_buffer);
+				} else if (vnlp->vnl_modtime >= pmom->mi_modtime) {
+					pmom->mi_modtime = vnlp->vnl_modtime;
+					sprintf(log_buffer, "Mom reporting changes to %lu vnodes", vnlp->vnl_used);
+					log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_NODE, LOG_INFO, pmom->mi_host, log_buffer);
+
+					for (i = 0; i < vnlp->vnl_used; i++) {
+						if (update2_to_vnode(VNL_NODENUM(vnlp, i), 0, pmom, &made_new_vnodes, 0, 1) == PBSE_UNKNODE) {
+							/* vnode gone here, get the whole list again */
+							psvrmom->msr_state |= INUSE_NEEDS_HELLO_PING;
+						}
+					}
+					for (i = 0; i < psvrmom->msr_numvnds; ++i)
+						(psvrmom->msr_children[i])->nd_modified &= ~NODE_UPDATE_VNL;
+				}
+				vnl_free(vnlp);
+				vnlp = NULL;
+			}
+
 			/*read mom's pbs_version data if appended*/
 
 			val = disrst(stream, &ret);
@@ -5015,10 +5544,18 @@ found:
 				DBPRT(("mom's pbs_version %s ", val))
 				free(psvrmom->msr_pbs_ver);
 				psvrmom->msr_pbs_ver = val;
+
+				/* and the requests it accepts, none from an older Mom */
+				psvrmom->msr_caps = disrsi(stream, &ret);
+				if (ret == DIS_EOD)
+					psvrmom->msr_caps = 0;
+				else if (ret != DIS_SUCCESS)
+					goto err;
 			} else if (ret == DIS_EOD) {
 				/*found no appended version data*/
 				free(psvrmom->msr_pbs_ver);
 				psvrmom->msr_pbs_ver = strdup("unavailable");
+				psvrmom->msr_caps = 0;
 			} else
 				goto err;
 
@@ -5407,7 +5944,7 @@ found:
 				vnrlp = VNL_NODENUM(vnlp, i);
 				/* update vnode */
 				made_new_vnodes = 0;
-				if (update2_to_vnode(vnrlp, cr_node, pmom, &made_new_vnodes, (command == IS_UPDATE_FROM_HOOK2)?2:1) == PBSE_PERM) {
+				if (update2_to_vnode(vnrlp, cr_node, pmom, &made_new_vnodes, (command == IS_UPDATE_FROM_HOOK2)?2:1, 0) == PBSE_PERM) {
 					break; /* encountered a bad permission */
 				}
 			}
@@ -5449,6 +5986,7 @@ found:
 				unsigned long chksum_py;
 				unsigned long chksum_cf;
 				unsigned int  haction;
+				unsigned int  hcurrent;
 
 				haction = 0;
 				/* hook name */
@@ -5550,6 +6088,19 @@ found:
 						hname, haction);
 				}
 
+				/* the files that matched need not be sent */
+				hcurrent = 0;
+				if ((phook->hook_control_checksum > 0) &&
+					(phook->hook_control_checksum == chksum_hk))
+					hcurrent |= MOM_HOOK_ACTION_SEND_ATTRS;
+				if ((phook->hook_script_checksum > 0) &&
+					(phook->hook_script_checksum == chksum_py))
+					hcurrent |= MOM_HOOK_ACTION_SEND_SCRIPT;
+				if ((phook->hook_config_checksum > 0) &&
+					(phook->hook_config_checksum == chksum_cf))
+					hcurrent |= MOM_HOOK_ACTION_SEND_CONFIG;
+				drop_current_hook_sends(pmom, hname, hcurrent);
+
 				if (add_to_svrattrl_list(&reported_hooks, hname,
 					NULL, NULL, 0, NULL) == -1) {
 					log_event(PBSEVENT_DEBUG3,
@@ -5586,6 +6137,9 @@ found:
 					add_pending_mom_hook_action(pmom,
 						PBS_RESCDEF,
 						MOM_HOOK_ACTION_SEND_RESCDEF);
+			} else if (hook_rescdef_checksum > 0) {
+				drop_current_hook_sends(pmom, PBS_RESCDEF,
+					MOM_HOOK_ACTION_SEND_RESCDEF);
 			}
 
 			/* Look for mom hooks known to the server that are */
@@ -5684,6 +6238,9 @@ write_single_node_state(struct pbsnode *np)
 
 	DBPRT(("write_single_node_state: entered\n"))
 
+	if (!(np->nd_modified & (NODE_UPDATE_STATE | NODE_UPDATE_COMMENT | NODE_UPDATE_CURRENT_AOE)))
+		return 0;
+
 	isoff = np->nd_state & (INUSE_OFFLINE | INUSE_OFFLINE_BY_MOM | INUSE_SLEEP);
 
 	if (isoff) {
@@ -5851,7 +6408,7 @@ write_single_node_mom_attr(struct pbsnode *np)
  * 		Save node states/comments to the database.
  *
  * @par
- *		This function loops through the node list
+ *		This function loops through the modified node list
  *  	and updates the state/comment to the
  *  	respective attributes in the DB.
  *
@@ -5861,7 +6418,9 @@ void
 write_node_state()
 {
 	struct pbsnode *np;
+	struct pbsnode **nodes;
 	int i;
+	int num;
 
 	DBPRT(("write_node_state: entered\n"))
 
@@ -5872,8 +6431,9 @@ write_node_state()
 	 **	The only state that carries forward is if the
 	 **	node has been marked offline.
 	 */
-	for (i = 0; i < svr_totnodes; i++) {
-		np = pbsndlist[i];
+	nodes = get_modified_nodes(&num);
+	for (i = 0; i < num; i++) {
+		np = nodes[i];
 
 		if (np->nd_state & INUSE_DELETED)
 			continue;
@@ -5891,6 +6451,7 @@ write_node_state()
 	}
 	if (pbs_db_end_trx(svr_db_conn, PBS_DB_COMMIT) != 0)
 		goto db_err;
+	prune_modified_nodes();
 
 	return;
 
@@ -7481,6 +8042,8 @@ set_nodes(void *pobj, int objtype, char *execvnod_in, char **execvnod_out, char
 						pnode->nd_nsnfree))
 				}
 			}
+			/* the jobs attribute is encoded from the subnodes */
+			pnode->nd_attr[(int)ND_ATR_jobs].at_flags |= ATR_VFLAG_MODCACHE;
 			share_node = pnode->nd_attr[(int)ND_ATR_Sharing].at_val.at_long;
 			if (share_node == (int)VNS_FORCE_EXCL || share_node == (int)VNS_FORCE_EXCLHOST) {
 				set_vnode_state(pnode, INUSE_JOBEXCL, Nd_State_Or);
@@ -7595,6 +8158,8 @@ set_nodes(void *pobj, int objtype, char *execvnod_in, char **execvnod_out, char
 				rp->next = (phowl + i)->hw_pnd->nd_resvp;
 				(phowl + i)->hw_pnd->nd_resvp = rp;
 				rp->resvp = presv;
+				/* the resv attribute is encoded from nd_resvp */
+				(phowl + i)->hw_pnd->nd_attr[(int)ND_ATR_resvs].at_flags |= ATR_VFLAG_MODCACHE;
 
 				/* create a backlink from the reservation to the vnode */
 				tmp_pl = malloc(sizeof(pbsnode_list_t));
@@ -7721,6 +8286,8 @@ free_nodes(job *pjob)
 					}
 					free(jp);
 					jp = NULL;
+					/* the jobs attribute is encoded from the subnodes */
+					pnode->nd_attr[(int)ND_ATR_jobs].at_flags |= ATR_VFLAG_MODCACHE;
 					DBPRT(("%s: upping free count to %ld\n", __func__,
 						pnode->nd_nsnfree))
 				}
@@ -7816,6 +8383,8 @@ free_resvNodes(resc_resv *presv)
 			else
 				prev->next = rinfp->next;
 			free(rinfp);
+			/* the resv attribute is encoded from nd_resvp */
+			pnode->nd_attr[(int)ND_ATR_resvs].at_flags |= ATR_VFLAG_MODCACHE;
 			break;
 		}
 	}
@@ -7968,6 +8537,233 @@ adj_resc_on_node(char *noden, int aflag, enum batch_op op, resource_def *prdef,
 	return rc;
 }
 
+/**
+ * @brief
+ * 		Free a parsed exec_vnode and its decoded resource values.
+ *
+ * @param[in]	pev	- parsed exec_vnode, may be NULL
+ *
+ * @return	void
+ */
+void
+free_parsed_execvnode(struct parsed_execvnode *pev)
+{
+	struct execvnode_chunk *pc;
+	int i;
+	int j;
+
+	if (pev == NULL)
+		return;
+
+	for (i = 0; i < pev->pev_nchunk; i++) {
+		pc = &pev->pev_chunks[i];
+		for (j = 0; j < pc->evc_nresc; j++) {
+			pc->evc_resc[j].evr_def->rs_free(&pc->evc_resc[j].evr_val);
+			free(pc->evc_resc[j].evr_str);
+		}
+		free(pc->evc_resc);
+	}
+	free(pev->pev_chunks);
+	free(pev->pev_str);
+	free(pev);
+}
+
+/**
+ * @brief
+ * 		Drop the parsed exec_vnode of every job.  Called before a vnode or a
+ * 		resource definition the parsed forms may point to goes away.
+ *
+ * @return	void
+ */
+void
+invalidate_parsed_execvnodes(void)
+{
+	job *pjob;
+
+	for (pjob = (job *)GET_NEXT(svr_alljobs); pjob != NULL;
+		pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
+		free_parsed_execvnode(pjob->ji_parsed_ev);
+		pjob->ji_parsed_ev = NULL;
+	}
+}
+
+/**
+ * @brief
+ * 		Parse an exec_vnode string into vnode pointers and decoded values of
+ * 		the resources to accumulate in the vnodes' resources_assigned.
+ *
+ * @param[in]	pexech	- exec_vnode style attribute to parse
+ *
+ * @return	struct parsed_execvnode *
+ * @retval	the parsed form, to be freed with free_parsed_execvnode()
+ * @retval	NULL	- the string does not parse, names an unknown vnode or
+ *			  resource, or memory ran out; the caller falls back to the
+ *			  string
+ */
+static struct parsed_execvnode *
+parse_execvnode(attribute *pexech)
+{
+	struct parsed_execvnode *pev;
+	struct execvnode_chunk *pc;
+	struct execvnode_chunk *tmpc;
+	struct execvnode_resc *pr;
+	resource_def *prdef;
+	struct key_value_pair *pkvp;
+	char *chunk;
+	char *noden;
+	int nelem;
+	int size = 0;
+	int asgn = ATR_DFLAG_ANASSN | ATR_DFLAG_FNASSN;
+	int rc;
+	int j;
+
+	if ((pev = calloc(1, sizeof(struct parsed_execvnode))) == NULL)
+		return NULL;
+	pev->pev_attr = pexech;
+	if ((pev->pev_str = strdup(pexech->at_val.at_str)) == NULL)
+		goto err;
+
+	for (chunk = parse_plus_spec(pexech->at_val.at_str, &rc);
+		chunk != NULL; chunk = parse_plus_spec(NULL, &rc)) {
+		if (parse_node_resc(chunk, &noden, &nelem, &pkvp) != 0)
+			goto err;
+		if (pev->pev_nchunk == size) {
+			size = size ? size * 2 : 8;
+			tmpc = realloc(pev->pev_chunks, size * sizeof(struct execvnode_chunk));
+			if (tmpc == NULL)
+				goto err;
+			pev->pev_chunks = tmpc;
+		}
+		pc = &pev->pev_chunks[pev->pev_nchunk++];
+		pc->evc_asgn = asgn;
+		pc->evc_nresc = 0;
+		pc->evc_resc = NULL;
+		if ((pc->evc_pnode = find_nodebyname(noden)) == NULL)
+			goto err;
+		if (nelem > 0 &&
+			(pc->evc_resc = calloc(nelem, sizeof(struct execvnode_resc))) == NULL)
+			goto err;
+		for (j = 0; j < nelem; ++j) {
+			prdef = find_resc_def(svr_resc_def, pkvp[j].kv_keyw, svr_resc_size);
+			if (prdef == NULL)
+				goto err;
+			/* skip all non-consumable resources (e.g. aoe) */
+			if ((prdef->rs_flags & asgn) == 0)
+				continue;
+			pr = &pc->evc_resc[pc->evc_nresc];
+			pr->evr_def = prdef;
+			if ((pr->evr_str = strdup(pkvp[j].kv_val)) == NULL)
+				goto err;
+			pc->evc_nresc++;
+			if (prdef->rs_decode(&pr->evr_val, ATTR_rescassn, prdef->rs_name,
+				pr->evr_str) != 0)
+				goto err;
+		}
+		asgn = ATR_DFLAG_ANASSN;
+	}
+	if (rc != 0 || pev->pev_nchunk == 0)
+		goto err;
+
+	return pev;
+
+err:
+	free_parsed_execvnode(pev);
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		Add or subtract a value to a resource of a resources_assigned
+ * 		attribute of the server or a queue.
+ *
+ * @param[in,out]	pattr	- the resources_assigned attribute
+ * @param[in]	prdef	- the resource
+ * @param[in]	pval	- the decoded value
+ * @param[in]	op	- INCR or DECR
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- the resource entry could not be added
+ */
+static int
+adj_resc_assigned(attribute *pattr, resource_def *prdef, attribute *pval,
+	enum batch_op op)
+{
+	resource *pr;
+
+	pr = find_resc_entry(pattr, prdef);
+	if (pr == NULL) {
+		pr = add_resource_entry(pattr, prdef);
+		if (pr == NULL)
+			return -1;
+	}
+	prdef->rs_set(&pr->rs_value, pval, op);
+	if (op == DECR) {
+		check_for_negative_resource(prdef, pr, NULL);
+	}
+	pattr->at_flags |= ATR_VFLAG_MODCACHE;
+	return 0;
+}
+
+/**
+ * @brief
+ * 		Adjust the resources_assigned of the vnodes of a parsed exec_vnode,
+ * 		and of the server and queue when asked.
+ *
+ * @param[in]	pev	- the parsed exec_vnode
+ * @param[in]	op	- INCR or DECR
+ * @param[in,out]	sysru	- server resources_assigned or NULL
+ * @param[in,out]	queru	- queue resources_assigned or NULL
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	!=0	- failure code
+ */
+static int
+adj_parsed_execvnode(struct parsed_execvnode *pev, enum batch_op op,
+	attribute *sysru, attribute *queru)
+{
+	struct execvnode_chunk *pc;
+	struct execvnode_resc *pr;
+	resource *presc;
+	attribute *pattr;
+	int rc;
+	int i;
+	int j;
+
+	for (i = 0; i < pev->pev_nchunk; i++) {
+		pc = &pev->pev_chunks[i];
+		pattr = &pc->evc_pnode->nd_attr[(int)ND_ATR_ResourceAssn];
+		for (j = 0; j < pc->evc_nresc; j++) {
+			pr = &pc->evc_resc[j];
+			if ((presc = find_resc_entry(pattr, pr->evr_def)) == NULL) {
+				presc = add_resource_entry(pattr, pr->evr_def);
+				if (presc == NULL)
+					return PBSE_INTERNAL;
+			}
+			if ((presc->rs_value.at_flags & ATR_VFLAG_INDIRECT) &&
+				(*presc->rs_value.at_val.at_str == '@')) {
+				/* indirect reference to another vnode */
+				rc = adj_resc_on_node(presc->rs_value.at_val.at_str + 1,
+					pc->evc_asgn, op, pr->evr_def, pr->evr_str, 1);
+			} else {
+				rc = pr->evr_def->rs_set(&presc->rs_value, &pr->evr_val, op);
+				if (op == DECR)
+					check_for_negative_resource(pr->evr_def, presc,
+						pc->evc_pnode->nd_name);
+			}
+			if (rc != 0)
+				return rc;
+
+			if (sysru && adj_resc_assigned(sysru, pr->evr_def, &pr->evr_val, op) != 0)
+				return PBSE_INTERNAL;
+			if (queru && adj_resc_assigned(queru, pr->evr_def, &pr->evr_val, op) != 0)
+				return PBSE_INTERNAL;
+		}
+	}
+	return 0;
+}
+
 /**
  * @brief
  * 		update the resources assigned at the vnode level
@@ -7982,6 +8778,10 @@ adj_resc_on_node(char *noden, int aflag, enum batch_op op, resource_def *prdef,
  *		name and a key_value_pair array of resources and values.  For each
  *		resource, the corresponding resource (if present) in the vnodes's
  *		resources_assigned is adjusted.
+ * @par
+ *		For a job, the string is parsed once into pjob->ji_parsed_ev and that
+ *		form is used as long as the string is unchanged, so the adjustments
+ *		at job start and at job end do not tokenize it again.
  *
  * @param[in]	pjob	- job to update
  * @param[in]	pexech	- exec_vnode string
@@ -8005,6 +8805,7 @@ update_job_node_rassn(job *pjob, attribute *pexech, enum batch_op op)
 	resource	*pr = NULL;
 	attribute	tmpattr;
 	int		nchunk = 0;
+	struct parsed_execvnode *pev = NULL;
 
 	/* Parse the exec_vnode string */
 
@@ -8031,9 +8832,23 @@ update_job_node_rassn(job *pjob, attribute *pexech, enum batch_op op)
 			pc++;
 		}
 	}
-	chunk = parse_plus_spec(pexech->at_val.at_str, &rc);
-	if (rc != 0)
-		return;
+	if (pjob != NULL) {
+		pev = pjob->ji_parsed_ev;
+		if ((pev == NULL) || (pev->pev_attr != pexech) ||
+			(strcmp(pev->pev_str, pexech->at_val.at_str) != 0)) {
+			free_parsed_execvnode(pev);
+			pev = pjob->ji_parsed_ev = parse_execvnode(pexech);
+		}
+	}
+	if (pev != NULL) {
+		if (adj_parsed_execvnode(pev, op, sysru, queru) != 0)
+			return;
+		chunk = NULL;
+	} else {
+		chunk = parse_plus_spec(pexech->at_val.at_str, &rc);
+		if (rc != 0)
+			return;
+	}
 	while (chunk) {
 		if (parse_node_resc(chunk, &noden, &nelem, &pkvp) == 0) {
 			for (j=0; j<nelem; ++j) {
@@ -8056,35 +8871,13 @@ update_job_node_rassn(job *pjob, attribute *pexech, enum batch_op op)
 						return;
 				}
 
-				if (sysru) {
-					pr = find_resc_entry(sysru, prdef);
-					if (pr == NULL) {
-						pr = add_resource_entry(sysru, prdef);
-						if (pr == NULL)
-							return;
-					}
-					prdef->rs_set(&pr->rs_value, &tmpattr, op);
-					if (op == DECR) {
-						check_for_negative_resource(prdef, pr, NULL);
-					}
-					sysru->at_flags |= ATR_VFLAG_MODCACHE;
-				}
+				if (sysru && adj_resc_assigned(sysru, prdef, &tmpattr, op) != 0)
+					return;
 
 				/* update queue attribute of resources assigned */
 
-				if (queru) {
-					pr = find_resc_entry(queru, prdef);
-					if (pr == NULL) {
-						pr = add_resource_entry(queru, prdef);
-						if (pr == NULL)
-							return;
-					}
-					prdef->rs_set(&pr->rs_value, &tmpattr, op);
-					if (op == DECR) {
-						check_for_negative_resource(prdef, pr, NULL);
-					}
-					queru->at_flags |= ATR_VFLAG_MODCACHE;
-				}
+				if (queru && adj_resc_assigned(queru, prdef, &tmpattr, op) != 0)
+					return;
 
 			}
 		} else {
@@ -8206,7 +8999,7 @@ mark_node_offline_by_mom(char *nodename, char *why)
 	if ((pnode = find_nodebyname(nodename)) != NULL) {
 		/* XXXX fix see momptr_down() XXXX */
 		momptr_offline_by_mom(pnode->nd_moms[0], why);
-		pnode->nd_modified |= (NODE_UPDATE_STATE|NODE_UPDATE_COMMENT);
+		node_mark_modified(pnode, NODE_UPDATE_STATE|NODE_UPDATE_COMMENT);
 		write_node_state();
 	}
 }
@@ -8254,7 +9047,7 @@ clear_node_offline_by_mom(char *nodename, char *why)
 	if ((pnode = find_nodebyname(nodename)) != NULL) {
 		/* XXXX fix see momptr_down() XXXX */
 		momptr_clear_offline_by_mom(pnode->nd_moms[0], why);
-		pnode->nd_modified |= (NODE_UPDATE_STATE|NODE_UPDATE_COMMENT);
+		node_mark_modified(pnode, NODE_UPDATE_STATE|NODE_UPDATE_COMMENT);
 		write_node_state();
 	}
 }
@@ -8650,7 +9443,7 @@ set_last_used_time_node(void *pobj, int type)
 				snprintf(str_val, sizeof(str_val), "%d", time_int_val);
 				set_attr_svr(&(pnode->nd_attr[(int)ND_ATR_last_used_time]),
 						&node_attr_def[(int) ND_ATR_last_used_time], str_val);
-				pnode->nd_modified = NODE_UPDATE_OTHERS;
+				node_mark_modified(pnode, NODE_UPDATE_OTHERS);
 				if(svr_chngNodesfile == 0)
 					svr_chngNodesfile = 1; /*make sure nodes are saved to the database during shutdown*/
 			}
@@ -59,6 +59,8 @@
  * 	PbsCommHandler()
  * 	stop_me()
  * 	hup_me()
+ * 	stats_me()
+ * 	log_tpp_stats()
  * 	lock_out()
  * 	set_limits()
  * 	log_tppmsg()
@@ -86,6 +88,7 @@
 #include "log.h"
 #include "rpp.h"
 #include "tpp_common.h"
+#include "hostcache.h"
 #include "server_limits.h"
 #include "pbs_version.h"
 
@@ -104,6 +107,7 @@ char	        primary_host[PBS_MAXHOSTNAME+1];   /* host_name of primary */
 static int stalone = 0;	/* is program running not as a service ? */
 static int get_out = 0;
 static int hupped = 0;
+static int stats_requested = 0;
 
 /*
  * Server failover role
@@ -484,6 +488,44 @@ hup_me(int sig)
 	log_err(-1, __func__, buf);
 }
 
+/**
+ * @brief
+ * 		USR1 handler for the pbs_comm daemon
+ *
+ * 		Sets a global variable for the main loop to log the TPP
+ * 		statistics, see log_tpp_stats()
+ *
+ * @param[in]	sig	- not used
+ *
+ * @return	void
+ */
+static void
+stats_me(int sig)
+{
+	stats_requested = 1;
+}
+
+/**
+ * @brief
+ * 		Log a snapshot of the TPP router statistics, one JSON object
+ * 		per log line, regardless of the log event mask
+ *
+ * @return	void
+ */
+static void
+log_tpp_stats(void)
+{
+	char *buf;
+	char *line;
+	char *saveptr = NULL;
+
+	if ((buf = tpp_stats_json()) == NULL)
+		return;
+	for (line = strtok_r(buf, "\n", &saveptr); line; line = strtok_r(NULL, "\n", &saveptr))
+		log_event(PBSEVENT_SYSTEM | PBSEVENT_FORCE, PBS_EVENTCLASS_TPP, LOG_INFO, "tpp_stats", line);
+	free(buf);
+}
+
 /**
  * @brief
  * 		lock out the lockfile for this daemon
@@ -772,6 +814,7 @@ go_to_background()
 	if (rc > 0)
 		exit(0); /* parent goes away, allowing booting to continue */
 
+	log_set_index_owner();
 	lock_out(lockfds, F_WRLCK);
 	if ((sid = setsid()) == -1) {
 		fprintf(stderr, "pbs_comm: setsid failed");
@@ -1138,18 +1181,20 @@ main(int argc, char **argv)
 		log_err(errno, __func__, "sigaction for PIPE");
 		return (2);
 	}
-	if (sigaction(SIGUSR1, &act, &oact) != 0) {
-		log_err(errno, __func__, "sigaction for USR1");
-		return (2);
-	}
 	if (sigaction(SIGUSR2, &act, &oact) != 0) {
 		log_err(errno, __func__, "sigaction for USR2");
 		return (2);
 	}
+	act.sa_handler = stats_me;
+	if (sigaction(SIGUSR1, &act, &oact) != 0) {
+		log_err(errno, __func__, "sigaction for USR1");
+		return (2);
+	}
 #endif 	/* WIN32 */
 
 	conf.node_type = TPP_ROUTER_NODE;
 	conf.numthreads = numthreads;
+	conf.thread_cpus = pbs_conf.pbs_comm_thread_cpus;
 
 	if ((rpp_fd = tpp_init_router(&conf)) == -1) {
 		log_err(-1, __func__, "tpp init failed\n");
@@ -1167,6 +1212,7 @@ main(int argc, char **argv)
 			int new_logevent;
 
 			hupped = 0; /* reset back */
+			hostcache_flush();
 			memcpy(&pbs_conf_bak, &pbs_conf, sizeof(struct pbs_config));
 
 			if (pbs_loadconf(1) == 0) {
@@ -1184,6 +1230,11 @@ main(int argc, char **argv)
 			}
 		}
 
+		if (stats_requested == 1) {
+			stats_requested = 0;
+			log_tpp_stats();
+		}
+
 		sleep(3);
 	}
 
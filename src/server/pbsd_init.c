@@ -48,6 +48,7 @@
  *	pbsd_init_job()
  *	pbsd_init_reque()
  *	catch_child()
+ *	catch_usr1()
  *	change_logs()
  *	stop_me()
  *	chk_save_file()
@@ -112,7 +113,7 @@
 #include "pbs_nodes.h"
 #include "tracking.h"
 #include "provision.h"
-#include "avltree.h"
+#include "name_idx.h"
 #include "svrfunc.h"
 #include "acct.h"
 #include "pbs_version.h"
@@ -123,6 +124,7 @@
 #include "hook.h"
 #include "hook_func.h"
 #include "pbs_share.h"
+#include "hostcache.h"
 
 #ifndef SIGKILL
 /* there is some weid stuff in gcc include files signal.h & sys/params.h */
@@ -221,6 +223,7 @@ extern job * job_recov_db_spl(pbs_db_job_info_t *dbjob);
 static void  catch_child(int);
 static void  init_abt_job(job *);
 static void  change_logs(int);
+static void  catch_usr1(int);
 int   chk_save_file(char *filename);
 static void  need_y_response(int, char *);
 static int   pbsd_init_job(job *pjob, int type);
@@ -424,6 +427,9 @@ pbsd_init(int type)
 		return (-1);
 
 #ifndef WIN32
+	/* log_open() has already read the old TZ, take the one just set */
+	tzset();
+
 	i = getgid();
 	(void)setgroups(1, (gid_t *)&i);	/* secure suppl. groups */
 
@@ -596,10 +602,12 @@ pbsd_init(int type)
 		log_err(errno, __func__, "sigaction for PIPE");
 		return (2);
 	}
+	act.sa_handler = catch_usr1;
 	if (sigaction(SIGUSR1, &act, &oact) != 0) {
 		log_err(errno, __func__, "sigaction for USR1");
 		return (2);
 	}
+	act.sa_handler = SIG_IGN;
 	if (sigaction(SIGUSR2, &act, &oact) != 0) {
 		log_err(errno, __func__, "sigaction for USR2");
 		return (2);
@@ -645,6 +653,13 @@ pbsd_init(int type)
 
 	time_now = time(NULL);
 
+	/*
+	 * The modification sequences of the objects are not saved, so start
+	 * past anything a client may have been given by an earlier server.
+	 */
+	svr_mod_seq = (long long) time_now * 1000000;
+	svr_mod_seq_floor = svr_mod_seq;
+
 	rc = setup_resc(1);
 	if (rc != 0) {
 		/* log_buffer set in setup_resc */
@@ -868,6 +883,16 @@ pbsd_init(int type)
 	had = server.sv_qs.sv_numque;
 	server.sv_qs.sv_numque = 0;
 
+	/* create the queue and reservation name indexes before recovery */
+	if ((queues_idx == NULL) && ((queues_idx = create_name_idx()) == NULL)) {
+		log_err(-1, __func__, "Creating index for queue-lookup failed!");
+		return (-1);
+	}
+	if ((resvs_idx == NULL) && ((resvs_idx = create_name_idx()) == NULL)) {
+		log_err(-1, __func__, "Creating index for resv-lookup failed!");
+		return (-1);
+	}
+
 	/* start a transaction */
 	if (pbs_db_begin_trx(conn, 0, 0) != 0)
 		return (-1);
@@ -963,6 +988,8 @@ pbsd_init(int type)
 			set_old_subUniverse(presv);
 
 			append_link(&svr_allresvs, &presv->ri_allresvs, presv);
+			svr_name_idx_oper(&resvs_idx, presv->ri_qs.ri_resvID,
+				presv, NAME_IDX_OP_ADD);
 			if (attach_queue_to_reservation(presv)) {
 
 				/* reservation needed queue; failed to find it */
@@ -987,14 +1014,12 @@ pbsd_init(int type)
 	/*
 	 * 9. If not "create" or "clean" recovery, recover the jobs.
 	 *    If a create or clean recovery, delete any jobs.
-	 *    Before job creation/recovery, create the AVL tree.
+	 *    Before job creation/recovery, create the job id index.
 	 */
-	AVL_jctx = (AVL_IX_DESC *) malloc(sizeof(AVL_IX_DESC));
-	if (AVL_jctx == NULL) {
-		log_err(-1, __func__, "Creating AVL tree for job-lookup failed!");
+	if ((jobs_idx == NULL) && ((jobs_idx = create_name_idx()) == NULL)) {
+		log_err(-1, __func__, "Creating index for job-lookup failed!");
 		return (-1);
 	}
-	avl_create_index(AVL_jctx, AVL_NO_DUP_KEYS, 0);
 
 	server.sv_qs.sv_numjobs = 0;
 
@@ -1980,11 +2005,29 @@ catch_child(int sig)
 	reap_child_flag = 1;
 }
 
+/**
+ * @brief
+ *		Set a flag for the main loop to log the request and TPP statistics,
+ *		see req_stats_log() and log_tpp_stats().
+ *
+ * @param[in]	sig	- not used in fun.
+ *
+ * @return	void
+ */
+static void
+catch_usr1(int sig)
+{
+	extern int req_stats_flag;
+
+	req_stats_flag = 1;
+}
+
 /**
  * @brief
  * 		change_logs - signal handler for SIGHUP
  *		Causes the accounting file and log file to be closed and reopened.
- *		Thus the old one can be renamed.
+ *		Thus the old one can be renamed.  Cached host lookups are
+ *		discarded as well.
  *
  * @param[in]	sig	- not used in fun.
  *
@@ -1998,6 +2041,7 @@ change_logs(int sig)
 	log_open(log_file, path_log);
 	(void)acct_open(acct_file);
 	rpp_dbprt = 1 - rpp_dbprt;	/* toggle debug prints for RPP */
+	hostcache_flush();
 }
 
 /**
@@ -122,6 +122,7 @@
 #include "credential.h"
 #include "batch_request.h"
 #include "avltree.h"
+#include "name_idx.h"
 #include "pbs_nodes.h"
 #include "svrfunc.h"
 #include "tracking.h"
@@ -184,6 +185,7 @@ static void log_tppmsg(int level, const char *objname, char *mess);
 /* Global Data Items */
 
 pbs_db_conn_t *svr_db_conn = NULL; /* server's global database connection pointer */
+pbs_db_pool_t *svr_db_pool = NULL; /* connections for threads other than main */
 pbs_db_conn_t *conn = NULL;  /* pointer to work out a valid connection - later assigned to svr_db_conn */
 
 int		stalone = 0;	/* is program running not as a service ? */
@@ -263,6 +265,7 @@ char	       *pbs_server_name;
 char		server_name[PBS_MAXSERVERNAME+1]; /* host_name[:service|port] */
 char		server_host[PBS_MAXHOSTNAME+1];	  /* host_name of this svr */
 int		reap_child_flag = 0;
+int		req_stats_flag = 0;	/* SIGUSR1, log request statistics */
 time_t		secondary_delay = 30;
 struct server	server;		/* the server structure */
 pbs_sched	*dflt_scheduler = NULL; /* the default scheduler */
@@ -276,6 +279,9 @@ int             ping_nodes_rate = SVR_DEFAULT_PING_RATE; /* time between ping no
 pbs_list_head	svr_deferred_req;
 pbs_list_head	svr_queues;            /* list of queues                   */
 pbs_list_head	svr_alljobs;           /* list of all jobs in server       */
+pbs_list_head	svr_jobs_bystate[PBS_NUMJOBSTATE]; /* jobs per state, by rank */
+pbs_list_head	svr_histjobs;          /* history jobs, by history timestamp */
+pbs_list_head	svr_actjobs;           /* jobs not history, by rank */
 pbs_list_head	svr_newjobs;           /* list of incomming new jobs       */
 pbs_list_head	svr_allresvs;          /* all reservations in server */
 pbs_list_head	svr_newresvs;          /* temporary list for new resv jobs */
@@ -312,7 +318,9 @@ struct batch_request	*saved_takeover_req=NULL;
 struct python_interpreter_data  svr_interp_data;
 int svr_unsent_qrun_req = 0;	/* Set to 1 for scheduling unsent qrun requests */
 
-AVL_IX_DESC *AVL_jctx = NULL;
+name_idx *jobs_idx = NULL;	/* job id to job */
+name_idx *resvs_idx = NULL;	/* reservation id to reservation */
+name_idx *queues_idx = NULL;	/* queue name to queue */
 
 #ifdef WIN32
 void WINAPI PbsServerMain(DWORD dwArgc, LPTSTR *rgszArgv);
@@ -421,6 +429,7 @@ go_to_background()
 	if (rc > 0)
 		exit(0); /* parent goes away, allowing booting to continue */
 
+	log_set_index_owner();
 	lock_out(lockfds, F_WRLCK);
 	if ((sid = setsid()) == -1) {
 		log_err(errno, msg_daemonname, "setsid failed");
@@ -1271,9 +1280,14 @@ main(int argc, char **argv)
 	CLEAR_HEAD(task_list_event);
 	CLEAR_HEAD(svr_queues);
 	CLEAR_HEAD(svr_alljobs);
+	for (i = 0; i < PBS_NUMJOBSTATE; i++)
+		CLEAR_HEAD(svr_jobs_bystate[i]);
+	CLEAR_HEAD(svr_histjobs);
+	CLEAR_HEAD(svr_actjobs);
 	CLEAR_HEAD(svr_newjobs);
 	CLEAR_HEAD(svr_allresvs);
 	CLEAR_HEAD(svr_newresvs);
+	CLEAR_HEAD(svr_mod_seq_deleted);
 	CLEAR_HEAD(svr_deferred_req);
 	CLEAR_HEAD(svr_unlicensedjobs);
 	CLEAR_HEAD(svr_allhooks);
@@ -1329,6 +1343,18 @@ main(int argc, char **argv)
 		svr_resc_def[i].rs_next = &svr_resc_def[i+1];
 	/* last entry is left with null pointer */
 
+	/*
+	 * index the resource and attribute definitions by name, failure
+	 * only means find_resc_def() and find_attr() scan them instead
+	 */
+	(void)index_resc_def(svr_resc_def, svr_resc_size);
+	(void)index_attr_def(job_attr_def, JOB_ATR_LAST);
+	(void)index_attr_def(svr_attr_def, SRV_ATR_LAST);
+	(void)index_attr_def(que_attr_def, QA_ATR_LAST);
+	(void)index_attr_def(node_attr_def, ND_ATR_LAST);
+	(void)index_attr_def(resv_attr_def, RESV_ATR_LAST);
+	(void)index_attr_def(sched_attr_def, SCHED_ATR_LAST);
+
 	/* save original environment in case we re-exec */
 	origevp = environ;
 
@@ -1673,6 +1699,15 @@ try_db_again:
 		stop_db();
 		return -1;
 	}
+
+	/* threads connect to the same dataservice, once they need to */
+	svr_db_pool = pbs_db_pool_create(svr_db_conn->conn_host,
+		svr_db_conn->conn_timeout, SVR_DB_POOL_SIZE);
+	if (svr_db_pool == NULL) {
+		log_err(errno, msg_daemonname, "Failed to create dataservice connection pool");
+		stop_db();
+		return -1;
+	}
 	/* database connection code end */
 
 	/* Curses! pbsd_init() calls validate_job_formula() (in svr_recov()) */
@@ -1789,6 +1824,9 @@ try_db_again:
 		return (3);
 	}
 
+	/* a failure here only means requests are read on the main thread */
+	(void)init_decode_pool(pbs_conf.pbs_server_decode_threads);
+
 	if (pbs_conf.pbs_use_tcp == 1) {
 		char *nodename = NULL;
 
@@ -1960,6 +1998,19 @@ try_db_again:
 	/* setup the periodic ping_nodes functionality */
 	setup_ping(0);
 
+#ifndef WIN32
+	/* now in the background, let a thread write the log if configured */
+	if (pbs_conf.pbs_server_log_async_size > 0) {
+		if (log_async_start((size_t)pbs_conf.pbs_server_log_async_size * 1024) != 0)
+			log_err(-1, msg_daemonname, "unable to start the log writer thread, logging synchronously");
+	}
+	if (pbs_conf.pbs_server_acct_async_size > 0) {
+		if (acct_async_start((size_t)pbs_conf.pbs_server_acct_async_size * 1024,
+			pbs_conf.pbs_server_acct_async_flush) != 0)
+			log_err(-1, msg_daemonname, "unable to start the accounting writer thread, accounting synchronously");
+	}
+#endif
+
 	/*
 	 * Now at last, we are read to do some batch work, the
 	 * following section constitutes the "main" loop of the server
@@ -2045,6 +2096,17 @@ try_db_again:
 		/* first process any task whose time delay has expired */
 		waittime = next_task();
 
+		if (req_stats_flag) {
+			req_stats_flag = 0;
+			req_stats_log();
+			mem_stats_log();
+			log_tpp_stats();
+		}
+
+		/* write the job saves whose window has passed */
+		job_save_db_flush(0);
+		waittime = job_save_db_wait(waittime);
+
 		if (*state == SV_STATE_RUN) {	/* In normal Run State */
 
 			if (first_run) {
@@ -2089,14 +2151,16 @@ try_db_again:
 					}
 					psched->svr_do_schedule = SCH_SCHEDULE_NULL;
 				} else if (((svr_unsent_qrun_req) || ((psched->svr_do_schedule != SCH_SCHEDULE_NULL) &&
-					psched->sch_attr[(int)SCHED_ATR_scheduling].at_val.at_long))
+					psched->sch_attr[(int)SCHED_ATR_scheduling].at_val.at_long &&
+					sched_trigger_time(psched) <= time_now))
 					&& can_schedule()) {
 					/*
 					 * If svr_unsent_qrun_req is set to one there are pending qrun
 					 * request, then do schedule_jobs irrespective of the server scheduling
 					 * state.
 					 * If svr_unsent_qrun_req is not set then do the existing checking and do
-					 * scheduling only if server scheduling is turned on.
+					 * scheduling only if server scheduling is turned on and
+					 * any event trigger is no longer held back.
 					 */
 
 					psched->sch_next_schedule = time_now +
@@ -2128,8 +2192,10 @@ try_db_again:
 
 		pque = (pbs_queue *)GET_NEXT(svr_queues);
 		while (pque) {
-			if (pque->qu_qs.qu_type == QTYPE_RoutePush)
-				queue_route(pque);
+			/* don't wait for requests while jobs are left to route */
+			if ((pque->qu_qs.qu_type == QTYPE_RoutePush) &&
+				queue_route(pque))
+				waittime = 0;
 			pque = (pbs_queue *)GET_NEXT(pque->qu_link);
 		}
 
@@ -2146,6 +2212,9 @@ try_db_again:
 			reap_child();
 #endif	/* WIN32 */
 
+		/* write the jobs committed since the last wait, and reply */
+		req_commit_flush();
+
 		/* wait for a request and process it */
 		if (wait_request(waittime, priority_context) != 0) {
 			log_err(-1, msg_daemonname, "wait_requst failed");
@@ -2175,6 +2244,8 @@ try_db_again:
 	}
 	DBPRT(("Server out of main loop, state is %ld\n", *state))
 
+	req_commit_flush();
+
 	svr_save_db(&server, SVR_SAVE_FULL);	/* final recording of server */
 	track_save(NULL);	/* save tracking data	     */
 
@@ -2185,6 +2256,7 @@ try_db_again:
 		if (pjob->ji_modified)
 			(void)job_save(pjob, SAVEJOB_FULLFORCE);
 	}
+	job_save_db_flush(1);
 
 	/* save any reservations that need saving */
 	for (presv = (resc_resv *)GET_NEXT(svr_allresvs);
@@ -2259,19 +2331,20 @@ try_db_again:
 	pbs_python_ext_shutdown_interpreter(&svr_interp_data); /* stop python if started */
 
 	shutdown_ack();
+	stop_decode_pool();	/* before the connections it reads go */
 	net_close(-1);		/* close all network connections */
 	rpp_shutdown();
 
 	/*
-	 * SERVER is going to be shutdown, delete AVL tree using
-	 * avl_destroy_index() which was created in pbsd_init.c
-	 * by avl_create_index().
+	 * SERVER is going to be shutdown, free the name indexes
+	 * which were created in pbsd_init.c.
 	 */
-	if (AVL_jctx != NULL) {
-		avl_destroy_index(AVL_jctx);
-		free(AVL_jctx);
-		AVL_jctx = NULL;
-	}
+	free_name_idx(jobs_idx);
+	jobs_idx = NULL;
+	free_name_idx(resvs_idx);
+	resvs_idx = NULL;
+	free_name_idx(queues_idx);
+	queues_idx = NULL;
 
 	{
 		int csret;
@@ -2389,10 +2462,16 @@ next_task()
 
 	for (psched = (pbs_sched*) GET_NEXT(svr_allscheds); psched; psched = (pbs_sched*) GET_NEXT(psched->sc_link)) {
 		time_t delay;
+		time_t due;
 		if ((delay = psched->sch_next_schedule - time_now) <= 0)
 			set_scheduler_flag(SCH_SCHEDULE_TIME, psched);
 		else if (delay < tilwhen)
 			tilwhen = delay;
+
+		/* wake up when a held back event trigger falls due */
+		if ((due = sched_trigger_time(psched)) > time_now &&
+			due - time_now < tilwhen)
+			tilwhen = due - time_now;
 	}
 
 	next_sync_mom_hookfiles();
@@ -3062,6 +3141,8 @@ stop_db()
 {
 	char *db_err = NULL;
 
+	pbs_db_pool_destroy(svr_db_pool);
+	svr_db_pool = NULL;
 	pbs_db_disconnect(svr_db_conn);
 	pbs_db_destroy_connection(svr_db_conn);
 	svr_db_conn = NULL;
@@ -54,11 +54,26 @@
  *	pbs_crypt_des()
  *	get_credential()
  *	process_request()
+ *	process_read_request()
+ *	decode_thread()
+ *	decode_pool_queue()
+ *	decode_pool_done()
+ *	decode_pool_atfork_child()
+ *	init_decode_pool()
+ *	stop_decode_pool()
  *	set_to_non_blocking()
  *	clear_non_blocking()
+ *	req_stats_now()
+ *	req_stats_add()
+ *	req_stats_log()
+ *	log_tpp_stats()
  *	dispatch_request()
+ *	dispatch_request_type()
  *	close_client()
+ *	pipeline_task()
+ *	pipeline_reply_sent()
  *	alloc_br()
+ *	alloc_job_child_br()
  *	close_quejob()
  *	free_rescrq()
  *	arrayfree()
@@ -66,6 +81,10 @@
  *	decode_DIS_PySpawn()
  *	free_br()
  *	freebr_manage()
+ *	freebr_modifyjobs()
+ *	freebr_runjobs()
+ *	freebr_submitjobs()
+ *	freebr_managemany()
  *	freebr_cpyfile()
  *	freebr_cpyfile_cred()
  *	parse_servername()
@@ -88,6 +107,9 @@
 #include <grp.h>
 #include <pwd.h>
 #include <dlfcn.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/socket.h>
 #endif
 #include <ctype.h>
 #include "libpbs.h"
@@ -109,6 +131,18 @@
 #include "pbs_nodes.h"
 #include "svrfunc.h"
 #include "pbs_sched.h"
+#include "pbs_client_thread.h"
+#include "work_task.h"
+#include "libutil.h"
+
+/*
+ * The server can read and decode requests from client connections on a
+ * few threads, see init_decode_pool().  Not with kerberos, whose ready
+ * function and per connection contexts are only safe on the main thread.
+ */
+#if !defined(PBS_MOM) && !defined(WIN32) && !(defined(PBS_SECURITY) && (PBS_SECURITY == KRB5))
+#define SVR_DECODE_POOL
+#endif
 
 /* global data items */
 
@@ -127,13 +161,25 @@ extern char  *msg_auth_request;
 
 extern int    is_local_root(char *, char *);
 extern void   req_stat_hook(struct batch_request *);
+#ifdef SVR_DECODE_POOL
+extern int    max_connection;
+#endif
 
 /* Private functions local to this file */
 
+static void process_read_request(int sfds, conn_t *conn, struct batch_request *request, int rc);
+
 static void freebr_manage(struct rq_manage *);
+#ifndef PBS_MOM
+static void freebr_modifyjobs(struct rq_modifyjobs *);
+static void freebr_runjobs(struct rq_runjobs *);
+static void freebr_submitjobs(struct rq_submitjobs *);
+static void freebr_managemany(struct rq_managemany *);
+#endif
 static void freebr_cpyfile(struct rq_cpyfile *);
 static void freebr_cpyfile_cred(struct rq_cpyfile_cred *);
 static void close_quejob(int sfds);
+static void dispatch_request_type(int sfds, struct batch_request *request);
 
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 int req_gss_auth(struct batch_request *preq);
@@ -272,6 +318,354 @@ err:
 	return rc;
 }
 
+#ifdef SVR_DECODE_POOL
+/*
+ * Requests read off client connections by the decode threads.  The main
+ * thread takes the connection off the poll list and queues it on
+ * decode_todo; a decode thread moves it to decode_active while it reads
+ * the request, then to decode_done, and writes a byte down decode_pipe.
+ * The main thread wakes up on the other end of the pipe in wait_request()
+ * and goes on with the request in process_read_request() as before, so
+ * the server data is still only touched by the main thread.
+ */
+struct decode_work {
+	pbs_list_link		 dw_link;
+	int			 dw_sock;	/* connection being read */
+	struct batch_request	*dw_req;	/* request read into */
+	int			 dw_rc;		/* return of dis_request_read() */
+};
+
+static pthread_mutex_t	decode_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	decode_cond = PTHREAD_COND_INITIALIZER;
+static pbs_list_head	decode_todo;
+static pbs_list_head	decode_active;
+static pbs_list_head	decode_done;
+static pthread_t	*decode_threads = NULL;
+static int		decode_nthreads = 0;	/* 0 - read on the main thread */
+static int		decode_stop = 0;
+static int		decode_pipe[2] = {-1, -1};
+static int		decode_maxfd = 0;	/* tcp channels reserved below */
+
+/**
+ * @brief
+ * 		decode_thread - body of a decode thread: read the requests queued
+ *		by decode_pool_queue() until stop_decode_pool() is called.
+ *
+ * @param[in]	arg	- unused
+ *
+ * @return	NULL
+ */
+static void *
+decode_thread(void *arg)
+{
+	sigset_t		allsigs;
+	struct decode_work	*pw;
+	int			have_context;
+	ssize_t			wrote;
+
+	/* signals are for the main thread */
+	sigfillset(&allsigs);
+	(void)pthread_sigmask(SIG_BLOCK, &allsigs, NULL);
+
+	/* own dis_buffer, transport and pbs_errno, see pbs_client_thread.c */
+	have_context = (pbs_client_thread_init_worker_context() == 0);
+	if (!have_context)
+		log_err(-1, __func__, "unable to set up thread context");
+
+	pthread_mutex_lock(&decode_mutex);
+	while (!decode_stop) {
+		pw = (struct decode_work *)GET_NEXT(decode_todo);
+		if (pw == NULL) {
+			pthread_cond_wait(&decode_cond, &decode_mutex);
+			continue;
+		}
+		delete_link(&pw->dw_link);
+		append_link(&decode_active, &pw->dw_link, pw);
+		pthread_mutex_unlock(&decode_mutex);
+
+		if (have_context)
+			pw->dw_rc = dis_request_read(pw->dw_sock, pw->dw_req);
+		else
+			pw->dw_rc = PBSE_SYSTEM;
+
+		pthread_mutex_lock(&decode_mutex);
+		delete_link(&pw->dw_link);
+		append_link(&decode_done, &pw->dw_link, pw);
+		/* a full pipe already has the main thread coming */
+		wrote = write(decode_pipe[1], "", 1);
+		(void)wrote;
+	}
+	pthread_mutex_unlock(&decode_mutex);
+
+	pbs_client_thread_destroy_worker_context();
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		decode_pool_queue - hand the reading of a request over to the
+ *		decode threads.
+ *
+ * @param[in]	sfds	- client connection with a request to read
+ * @param[in]	request	- request to read into
+ *
+ * @return	int
+ * @retval	0	- queued, the connection is off the poll list until
+ *			  decode_pool_done() gets it back
+ * @retval	-1	- not queued, read it on the main thread
+ */
+static int
+decode_pool_queue(int sfds, struct batch_request *request)
+{
+	struct decode_work	*pw;
+
+	if ((decode_nthreads == 0) || (sfds >= decode_maxfd))
+		return -1;
+
+	if ((pw = (struct decode_work *)malloc(sizeof(struct decode_work))) == NULL)
+		return -1;
+
+	/* priority connections are never suspended */
+	if (net_suspend_conn(sfds) != 0) {
+		free(pw);
+		return -1;
+	}
+
+	CLEAR_LINK(pw->dw_link);
+	pw->dw_sock = sfds;
+	pw->dw_req = request;
+	pw->dw_rc = 0;
+
+	pthread_mutex_lock(&decode_mutex);
+	append_link(&decode_todo, &pw->dw_link, pw);
+	pthread_cond_signal(&decode_cond);
+	pthread_mutex_unlock(&decode_mutex);
+	return 0;
+}
+
+/**
+ * @brief
+ * 		decode_pool_done - connection function of the decode pipe: process
+ *		every request the decode threads have finished reading.
+ *
+ * @param[in]	fd	- read end of the decode pipe
+ */
+static void
+decode_pool_done(int fd)
+{
+	char			buf[64];
+	struct decode_work	*pw;
+	struct batch_request	*request;
+	conn_t			*conn;
+	int			sfds;
+	int			rc;
+
+	while (read(fd, buf, sizeof(buf)) > 0)
+		;
+
+	for (;;) {
+		pthread_mutex_lock(&decode_mutex);
+		pw = (struct decode_work *)GET_NEXT(decode_done);
+		if (pw != NULL)
+			delete_link(&pw->dw_link);
+		pthread_mutex_unlock(&decode_mutex);
+		if (pw == NULL)
+			break;
+
+		sfds = pw->dw_sock;
+		request = pw->dw_req;
+		rc = pw->dw_rc;
+		free(pw);
+
+		time_now = time(NULL);
+
+		/* fails too if the connection was closed while being read */
+		if ((net_resume_conn(sfds) != 0) || ((conn = get_conn(sfds)) == NULL)) {
+			close_client(sfds);
+			free_br(request);
+			continue;
+		}
+		process_read_request(sfds, conn, request, rc);
+	}
+}
+
+/**
+ * @brief
+ * 		decode_pool_atfork_child - a forked child has none of the decode
+ *		threads, so it reads whatever it reads on its only thread.
+ */
+static void
+decode_pool_atfork_child(void)
+{
+	decode_nthreads = 0;
+}
+
+/**
+ * @brief
+ * 		init_decode_pool - start the threads that read and decode requests
+ *		from client connections, see PBS_SERVER_DECODE_THREADS.
+ *
+ * @par Functionality:
+ *		Only the reading of the request is done by the threads.  The
+ *		request is then processed and replied to by the main thread as
+ *		before, as the server's job, node and queue data has no locking.
+ *		Must be called after init_network(), with the signals blocked.
+ *
+ * @param[in]	nthreads	- number of threads, 0 for none
+ *
+ * @return	int
+ * @retval	0	- success, or no threads asked for
+ * @retval	-1	- failure, requests are read on the main thread
+ */
+int
+init_decode_pool(int nthreads)
+{
+	static int	atfork_set = 0;
+	conn_t		*conn;
+	int		i;
+	int		rc;
+
+	if ((nthreads <= 0) || (decode_nthreads > 0))
+		return 0;
+
+	CLEAR_HEAD(decode_todo);
+	CLEAR_HEAD(decode_active);
+	CLEAR_HEAD(decode_done);
+	decode_stop = 0;
+
+	if (pipe(decode_pipe) == -1) {
+		log_err(errno, __func__, "pipe");
+		return -1;
+	}
+	for (i = 0; i < 2; i++) {
+		(void)fcntl(decode_pipe[i], F_SETFL,
+			fcntl(decode_pipe[i], F_GETFL) | O_NONBLOCK);
+		(void)fcntl(decode_pipe[i], F_SETFD, FD_CLOEXEC);
+	}
+	conn = add_conn(decode_pipe[0], ChildPipe, (pbs_net_t)0,
+		(unsigned int)0, NULL, decode_pool_done);
+	if (conn == NULL) {
+		log_err(-1, __func__, "unable to add decode pipe to connection table");
+		(void)close(decode_pipe[0]);
+		(void)close(decode_pipe[1]);
+		return -1;
+	}
+	conn->cn_authen |= PBS_NET_CONN_AUTHENTICATED | PBS_NET_CONN_NOTIMEOUT;
+
+	/* the threads set up tcp channels, which must never be moved under them */
+	decode_maxfd = max_connection;
+	DIS_tcp_reserve(decode_maxfd);
+
+	if ((decode_threads = (pthread_t *)calloc(nthreads, sizeof(pthread_t))) == NULL) {
+		log_err(errno, __func__, msg_err_malloc);
+		close_conn(decode_pipe[0]);
+		(void)close(decode_pipe[1]);
+		return -1;
+	}
+	for (i = 0; i < nthreads; i++) {
+		if ((rc = pthread_create(&decode_threads[i], NULL, decode_thread, NULL)) != 0) {
+			log_err(rc, __func__, "pthread_create");
+			break;
+		}
+	}
+	if (i == 0) {
+		free(decode_threads);
+		decode_threads = NULL;
+		close_conn(decode_pipe[0]);
+		(void)close(decode_pipe[1]);
+		return -1;
+	}
+	decode_nthreads = i;
+
+	if (!atfork_set) {
+		if (pthread_atfork(NULL, NULL, decode_pool_atfork_child) != 0)
+			log_err(errno, __func__, "pthread_atfork");
+		atfork_set = 1;
+	}
+
+	log_eventf(PBSEVENT_SYSTEM | PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, msg_daemonname, "%d request decode threads started",
+		decode_nthreads);
+	return 0;
+}
+
+/**
+ * @brief
+ * 		stop_decode_pool - stop and join the decode threads, dropping any
+ *		request not processed yet.  Called before net_close() at shutdown,
+ *		the dropped requests' connections are closed there.
+ */
+void
+stop_decode_pool(void)
+{
+	struct decode_work	*pw;
+	pbs_list_head		*lists[3];
+	int			i;
+
+	if (decode_nthreads == 0)
+		return;
+
+	pthread_mutex_lock(&decode_mutex);
+	decode_stop = 1;
+	/* cut short any read still in progress */
+	pw = (struct decode_work *)GET_NEXT(decode_active);
+	while (pw != NULL) {
+		(void)shutdown(pw->dw_sock, SHUT_RDWR);
+		pw = (struct decode_work *)GET_NEXT(pw->dw_link);
+	}
+	pthread_cond_broadcast(&decode_cond);
+	pthread_mutex_unlock(&decode_mutex);
+
+	for (i = 0; i < decode_nthreads; i++)
+		(void)pthread_join(decode_threads[i], NULL);
+	free(decode_threads);
+	decode_threads = NULL;
+	decode_nthreads = 0;
+
+	lists[0] = &decode_todo;
+	lists[1] = &decode_active;
+	lists[2] = &decode_done;
+	for (i = 0; i < 3; i++) {
+		while ((pw = (struct decode_work *)GET_NEXT(*lists[i])) != NULL) {
+			delete_link(&pw->dw_link);
+			free_br(pw->dw_req);
+			free(pw);
+		}
+	}
+	(void)close(decode_pipe[1]);
+	decode_pipe[1] = -1;
+}
+#elif !defined(PBS_MOM)
+/**
+ * @brief
+ * 		init_decode_pool - requests are always read on the main thread
+ *		in this build.
+ *
+ * @param[in]	nthreads	- number of threads asked for
+ *
+ * @return	int
+ * @retval	0	- always
+ */
+int
+init_decode_pool(int nthreads)
+{
+	if (nthreads > 0)
+		log_event(PBSEVENT_SYSTEM | PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
+			LOG_NOTICE, msg_daemonname,
+			"request decode threads are not supported in this build");
+	return 0;
+}
+
+/**
+ * @brief
+ * 		stop_decode_pool - nothing to stop, see init_decode_pool().
+ */
+void
+stop_decode_pool(void)
+{
+}
+#endif	/* SVR_DECODE_POOL */
+
 /*
 * @brief
  * 		process_request - process an request from the network:
@@ -289,9 +683,6 @@ process_request(int sfds)
 	int		      rc;
 	struct batch_request *request;
 	conn_t		     *conn;
-#ifndef PBS_MOM
-	int		     access_by_krb;
-#endif
 
 
 	time_now = time(NULL);
@@ -334,6 +725,11 @@ process_request(int sfds)
 #ifndef PBS_MOM
 
 	if (conn->cn_active == FromClientDIS) {
+#ifdef SVR_DECODE_POOL
+		/* a decode thread reads it and hands it back to process_read_request() */
+		if (decode_pool_queue(sfds, request) == 0)
+			return;
+#endif
 		rc = dis_request_read(sfds, request);
 	} else {
 		log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_REQUEST, LOG_ERR,
@@ -346,6 +742,28 @@ process_request(int sfds)
 	rc = dis_request_read(sfds, request);
 #endif	/* PBS_MOM */
 
+	process_read_request(sfds, conn, request, rc);
+}
+
+/**
+ * @brief
+ * 		process_read_request - second half of process_request(), called
+ *		once the request has been read from the connection, either
+ *		directly or by a decode thread.
+ *
+ * @param[in]	sfds	- file descriptor (socket) the request came on
+ * @param[in]	conn	- connection of sfds
+ * @param[in]	request	- the request read
+ * @param[in]	rc	- return value of dis_request_read()
+ */
+
+static void
+process_read_request(int sfds, conn_t *conn, struct batch_request *request, int rc)
+{
+#ifndef PBS_MOM
+	int		     access_by_krb;
+#endif
+
 	if (rc == -1) {		/* End of file */
 		close_client(sfds);
 		free_br(request);
@@ -521,6 +939,7 @@ process_request(int sfds)
 	if (server.sv_attr[(int)SRV_ATR_State].at_val.at_long > SV_STATE_RUN) {
 		switch (request->rq_type) {
 			case PBS_BATCH_AsyrunJob:
+			case PBS_BATCH_AsyrunJobs:
 			case PBS_BATCH_JobCred:
 			case PBS_BATCH_UserCred:
 			case PBS_BATCH_UserMigrate:
@@ -528,6 +947,7 @@ process_request(int sfds)
 			case PBS_BATCH_QueueJob:
 			case PBS_BATCH_RunJob:
 			case PBS_BATCH_StageIn:
+			case PBS_BATCH_SubmitJobs:
 			case PBS_BATCH_jobscript:
 				req_reject(PBSE_SVRDOWN, 0, request);
 				return;
@@ -557,6 +977,12 @@ process_request(int sfds)
 			   ATR_DFLAG_SvWR | ATR_DFLAG_MOM;
 #endif
 
+#ifndef PBS_MOM
+	/* read no further request from a pipelined client until this is answered */
+	if (conn->cn_authen & PBS_NET_CONN_PIPELINE)
+		(void)net_hold_conn(sfds);
+#endif
+
 	/*
 	 * dispatch the request to the correct processing function.
 	 * The processing function must call reply_send() to free
@@ -635,8 +1061,155 @@ clear_non_blocking(conn_t *conn)
 #endif /* WIN32 */
 	}
 }
+
+/*
+ * Per request type cost of dispatching requests, see req_stats_log().
+ * All times are in microseconds and include any local request dispatched
+ * while handling the request.
+ */
+#define REQ_STATS_TYPES		(PBS_BATCH_Cred + 1)
+#define REQ_STATS_BUCKETS	7	/* <100us <1ms <10ms <100ms <1s <10s more */
+
+struct req_stats {
+	unsigned long	rs_count;
+	long long	rs_usec;	/* wall time */
+	long long	rs_max_usec;	/* longest request */
+	long long	rs_cpu_usec;	/* cpu time of the main thread */
+	long long	rs_db_usec;	/* executing database statements */
+	long long	rs_hook_usec;	/* running hooks */
+	long long	rs_reply_usec;	/* encoding and writing replies */
+	unsigned long	rs_hist[REQ_STATS_BUCKETS];
+};
+
+static struct req_stats req_stats[REQ_STATS_TYPES];
+long long req_stats_hook_usec = 0;	/* added to by process_hooks() */
+long long req_stats_reply_usec = 0;	/* added to by dis_reply_write() */
+
+/**
+ * @brief
+ *		Return a monotonic time in microseconds, for measuring how long
+ *		something took.
+ *
+ * @return	long long
+ */
+long long
+req_stats_now(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+		return 0;
+	return ((long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000);
+}
+
+/**
+ * @brief
+ *		Return the cpu time used by the calling thread in microseconds.
+ *
+ * @return	long long
+ */
+static long long
+req_stats_cpu(void)
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+		return ((long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000);
+#endif
+	return 0;
+}
+
+/**
+ * @brief
+ *		Account for one dispatched request.
+ *
+ * @param[in]	type	- the request type
+ * @param[in]	usec	- wall time taken
+ * @param[in]	cpu	- cpu time taken
+ * @param[in]	db	- time spent in the database
+ * @param[in]	hook	- time spent running hooks
+ * @param[in]	reply	- time spent sending the reply
+ */
+static void
+req_stats_add(int type, long long usec, long long cpu, long long db,
+	long long hook, long long reply)
+{
+	struct req_stats *prs;
+	long long lim;
+	int i;
+
+	if (type < 0 || type >= REQ_STATS_TYPES)
+		return;
+	prs = &req_stats[type];
+	prs->rs_count++;
+	prs->rs_usec += usec;
+	if (usec > prs->rs_max_usec)
+		prs->rs_max_usec = usec;
+	prs->rs_cpu_usec += cpu;
+	prs->rs_db_usec += db;
+	prs->rs_hook_usec += hook;
+	prs->rs_reply_usec += reply;
+	for (i = 0, lim = 100; i < REQ_STATS_BUCKETS - 1 && usec >= lim; i++)
+		lim *= 10;
+	prs->rs_hist[i]++;
+}
+
+/**
+ * @brief
+ *		Log the cost of the requests dispatched since the server started,
+ *		one line per request type seen.  Called from the main loop when
+ *		the server is sent SIGUSR1.
+ */
+void
+req_stats_log(void)
+{
+	struct req_stats *prs;
+	int i;
+
+	for (i = 0; i < REQ_STATS_TYPES; i++) {
+		prs = &req_stats[i];
+		if (prs->rs_count == 0)
+			continue;
+		snprintf(log_buffer, LOG_BUF_SIZE,
+			"type %d count %lu avg %lldus max %lldus cpu %lldus "
+			"db %lldus hook %lldus reply %lldus "
+			"hist %lu/%lu/%lu/%lu/%lu/%lu/%lu",
+			i, prs->rs_count, prs->rs_usec / (long long)prs->rs_count,
+			prs->rs_max_usec, prs->rs_cpu_usec, prs->rs_db_usec,
+			prs->rs_hook_usec, prs->rs_reply_usec,
+			prs->rs_hist[0], prs->rs_hist[1], prs->rs_hist[2],
+			prs->rs_hist[3], prs->rs_hist[4], prs->rs_hist[5],
+			prs->rs_hist[6]);
+		log_event(PBSEVENT_SYSTEM | PBSEVENT_FORCE, PBS_EVENTCLASS_SERVER,
+			LOG_INFO, "req_stats", log_buffer);
+	}
+}
 #endif	/* !PBS_MOM */
 
+/**
+ * @brief
+ *		Log a snapshot of the TPP statistics of this daemon, one JSON
+ *		object per line, see tpp_stats_json().  Called from the main
+ *		loop of the server on SIGUSR1 and of MoM on SIGUSR2.
+ */
+void
+log_tpp_stats(void)
+{
+	char *buf;
+	char *line;
+	char *saveptr = NULL;
+
+	if (pbs_conf.pbs_use_tcp == 0)
+		return;
+	if ((buf = tpp_stats_json()) == NULL)
+		return;
+	for (line = strtok_r(buf, "\n", &saveptr); line; line = strtok_r(NULL, "\n", &saveptr))
+		log_event(PBSEVENT_SYSTEM | PBSEVENT_FORCE, PBS_EVENTCLASS_TPP,
+			LOG_INFO, "tpp_stats", line);
+	free(buf);
+}
+
 /**
  * @brief
  * 		Determine the request type and invoke the corresponding
@@ -645,6 +1218,9 @@ clear_non_blocking(conn_t *conn)
  *		The function will perform the request action and return the
  *		reply.  The function MUST also reply and free the request by calling
  *		reply_send().
+ * @par
+ *		The server accounts the cost of each request by type, see
+ *		req_stats_log().
  *
  * @param[in]	sfds	- socket connection
  * @param[in]	request - the request information
@@ -652,6 +1228,36 @@ clear_non_blocking(conn_t *conn)
 
 void
 dispatch_request(int sfds, struct batch_request *request)
+{
+#ifndef PBS_MOM
+	int		type = request->rq_type; /* request is freed by the reply */
+	long long	start = req_stats_now();
+	long long	cpu = req_stats_cpu();
+	long long	db = svr_db_conn ? svr_db_conn->conn_db_usec : 0;
+	long long	hook = req_stats_hook_usec;
+	long long	reply = req_stats_reply_usec;
+
+	dispatch_request_type(sfds, request);
+
+	req_stats_add(type, req_stats_now() - start, req_stats_cpu() - cpu,
+		(svr_db_conn ? svr_db_conn->conn_db_usec : 0) - db,
+		req_stats_hook_usec - hook, req_stats_reply_usec - reply);
+#else
+	dispatch_request_type(sfds, request);
+#endif
+}
+
+/**
+ * @brief
+ * 		Invoke the function for the type of the request, see
+ *		dispatch_request().
+ *
+ * @param[in]	sfds	- socket connection
+ * @param[in]	request - the request information
+ */
+
+static void
+dispatch_request_type(int sfds, struct batch_request *request)
 {
 
 	conn_t *conn = NULL;
@@ -754,6 +1360,24 @@ dispatch_request(int sfds, struct batch_request *request)
 				net_add_close_func(sfds, (void (*)(int))0);
 			break;
 
+#ifdef PBS_MOM
+		case PBS_BATCH_ExecJob:
+			/* only the server sends this, over its stream to us */
+			if (!rpp) {
+				req_reject(PBSE_IVALREQ, 0, request);
+				close_client(sfds);
+				break;
+			}
+			log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_INFO,
+				request->rq_ind.rq_execjob.rq_job.rq_jid,
+				"exec job request received");
+			request->rpp_ack = 0;
+			rpp_add_close_func(sfds, close_quejob);
+			req_execjob(request);
+			rpp_add_close_func(sfds, (void (*)(int))0);
+			break;
+#endif
+
 		case PBS_BATCH_DeleteJob:
 			log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_INFO,
 				request->rq_ind.rq_delete.rq_objname,
@@ -789,6 +1413,26 @@ dispatch_request(int sfds, struct batch_request *request)
 			req_preemptjobs(request);
 			break;
 
+		case PBS_BATCH_ModifyJobs:
+			req_modifyjobs(request);
+			break;
+
+		case PBS_BATCH_AsyrunJobs:
+			req_runjobs(request);
+			break;
+
+		case PBS_BATCH_SubmitJobs:
+			/* as for Queue Job, a job left half built when the */
+			/* connection closes is cleaned up by close_quejob  */
+			if (rpp) {
+				req_reject(PBSE_IVALREQ, 0, request);
+				break;
+			}
+			net_add_close_func(sfds, close_quejob);
+			req_submitjobs(request);
+			net_add_close_func(sfds, (void (*)(int))0);
+			break;
+
 		case PBS_BATCH_LocateJob:
 			req_locatejob(request);
 			break;
@@ -797,6 +1441,14 @@ dispatch_request(int sfds, struct batch_request *request)
 			req_manager(request);
 			break;
 
+		case PBS_BATCH_ManagerMany:
+			req_managemany(request);
+			break;
+
+		case PBS_BATCH_DeleteJobs:
+			req_deletejobs(request);
+			break;
+
 		case PBS_BATCH_RelnodesJob:
 			req_relnodesjob(request);
 			break;
@@ -1080,6 +1732,61 @@ close_client(int sfds)
 	}
 }
 
+#ifndef PBS_MOM
+/**
+ * @brief
+ * 		pipeline_task - work task that goes on with a request a pipelined
+ *		client sent ahead, when it was read along with the previous one.
+ *
+ * @param[in]	ptask	- work task, wt_event holds the connection socket
+ */
+static void
+pipeline_task(struct work_task *ptask)
+{
+	int sfds = (int)ptask->wt_event;
+	conn_t *conn = get_conn(sfds);
+
+	/* the connection may be gone, or the request read off the poll list */
+	if ((conn == NULL) || (conn->cn_active != FromClientDIS) ||
+		((conn->cn_authen & PBS_NET_CONN_PIPELINE) == 0) ||
+		(conn->cn_authen & (PBS_NET_CONN_HELD | PBS_NET_CONN_BUSY)) ||
+		(DIS_tcp_pending(sfds) == 0))
+		return;
+
+	process_request(sfds);
+}
+
+/**
+ * @brief
+ * 		pipeline_reply_sent - the reply to the request in progress on a
+ *		connection has been sent.  On a pipelined connection, poll the
+ *		client again for its next request, and go on at once with one
+ *		that has already been read along with the last.
+ *
+ * @param[in]	sfds	- connection socket
+ */
+void
+pipeline_reply_sent(int sfds)
+{
+	conn_t *conn = get_conn(sfds);
+
+	if ((conn == NULL) || ((conn->cn_authen & PBS_NET_CONN_PIPELINE) == 0))
+		return;
+
+	if (net_release_conn(sfds) != 0) {
+		close_client(sfds);
+		return;
+	}
+
+	/* nothing polls readable for input that is already buffered */
+	if (DIS_tcp_pending(sfds) > 0)
+		(void)set_task(WORK_Immed, (long)sfds, pipeline_task, NULL);
+}
+#endif	/* PBS_MOM */
+
+/* freed batch_request structures kept for reuse */
+static pbs_freelist br_pool = PBS_FREELIST_INIT("batch_request", struct batch_request, 1024);
+
 /**
  * @brief
  * 		alloc_br - allocate and clear a batch_request structure
@@ -1094,7 +1801,7 @@ struct batch_request *alloc_br(int type)
 {
 	struct batch_request *req;
 
-	req= (struct batch_request *)malloc(sizeof(struct batch_request));
+	req= (struct batch_request *)freelist_alloc(&br_pool);
 	if (req== NULL)
 		log_err(errno, "alloc_br", msg_err_malloc);
 	else {
@@ -1113,6 +1820,45 @@ struct batch_request *alloc_br(int type)
 	return (req);
 }
 
+/**
+ * @brief
+ * 		alloc_job_child_br - allocate a per job child of a multi-job request
+ *		The child carries the identity of the parent and records its
+ *		result into the parent's per job error list, see reply_send().
+ *
+ * @param[in]	opreq	- the multi-job (parent) request
+ * @param[in]	type	- type of the child request
+ * @param[in]	slot	- entry of the parent's reply list for this job
+ *
+ * @return	batch_request *
+ * @retval	NULL	- error
+ */
+
+struct batch_request *
+alloc_job_child_br(struct batch_request *opreq, int type, job_err_info *slot)
+{
+	struct batch_request *npreq;
+
+	npreq = alloc_br(type);
+	if (npreq == NULL)
+		return NULL;
+
+	npreq->rq_perm    = opreq->rq_perm;
+	npreq->rq_fromsvr = opreq->rq_fromsvr;
+	npreq->rq_conn    = opreq->rq_conn;
+	npreq->rq_orgconn = opreq->rq_orgconn;
+	npreq->rq_time    = opreq->rq_time;
+	strcpy(npreq->rq_user, opreq->rq_user);
+	strcpy(npreq->rq_host, opreq->rq_host);
+	npreq->rq_extend  = opreq->rq_extend;
+
+	npreq->rq_extra = (void *) slot;
+	npreq->rq_parentbr = opreq;
+	opreq->rq_refct++;
+
+	return npreq;
+}
+
 /**
  * @brief
  * 		close_quejob - locate and deal with the new job that was being received
@@ -1347,6 +2093,28 @@ free_br(struct batch_request *preq)
 		 * decrement the reference count in the parent and when it
 		 * goes to zero,  reply_send() it
 		 */
+		/* a Modify Jobs child was handed its own attributes */
+		if (preq->rq_parentbr->rq_type == PBS_BATCH_ModifyJobs)
+			free_attrlist(&preq->rq_ind.rq_modify.rq_attr);
+		/* and a Run Jobs child its own destination */
+		else if ((preq->rq_parentbr->rq_type == PBS_BATCH_AsyrunJobs) &&
+			(preq->rq_ind.rq_run.rq_destin != NULL))
+			free(preq->rq_ind.rq_run.rq_destin);
+		/* and a Submit Jobs child its job's attributes or script */
+		else if (preq->rq_parentbr->rq_type == PBS_BATCH_SubmitJobs) {
+			if (preq->rq_type == PBS_BATCH_QueueJob)
+				free_attrlist(&preq->rq_ind.rq_queuejob.rq_attr);
+			else if (preq->rq_type == PBS_BATCH_jobscript)
+				free(preq->rq_ind.rq_jobfile.rq_data);
+		}
+		/* and an Exec Job child its job's attributes */
+		else if ((preq->rq_parentbr->rq_type == PBS_BATCH_ExecJob) &&
+			(preq->rq_type == PBS_BATCH_QueueJob))
+			free_attrlist(&preq->rq_ind.rq_queuejob.rq_attr);
+		/* and a Manager Many child its directive's attributes */
+		else if (preq->rq_parentbr->rq_type == PBS_BATCH_ManagerMany)
+			free_attrlist(&preq->rq_ind.rq_manager.rq_attr);
+
 		if (preq->rq_parentbr->rq_refct > 0) {
 			if (--preq->rq_parentbr->rq_refct == 0)
 				reply_send(preq->rq_parentbr);
@@ -1355,7 +2123,7 @@ free_br(struct batch_request *preq)
 		if (preq->rppcmd_msgid)
 			free(preq->rppcmd_msgid);
 
-		(void)free(preq);
+		freelist_free(&br_pool, preq);
 		return;
 	}
 
@@ -1366,6 +2134,8 @@ free_br(struct batch_request *preq)
 	 */
 	if (preq->rq_extend)
 		(void)free(preq->rq_extend);
+	if (preq->rq_statkey)
+		free(preq->rq_statkey);
 
 	switch (preq->rq_type) {
 		case PBS_BATCH_QueueJob:
@@ -1425,6 +2195,11 @@ free_br(struct batch_request *preq)
 			if (preq->rq_ind.rq_status.rq_id)
 				free(preq->rq_ind.rq_status.rq_id);
 			free_attrlist(&preq->rq_ind.rq_status.rq_attr);
+			free_attrlist(&preq->rq_ind.rq_status.rq_filtattr);
+#ifndef PBS_MOM
+			if (preq->rq_type == PBS_BATCH_StatusJob)
+				stat_filter_free(preq);
+#endif
 			break;
 		case PBS_BATCH_CopyFiles:
 		case PBS_BATCH_DelFiles:
@@ -1442,6 +2217,11 @@ free_br(struct batch_request *preq)
 			if (preq->rq_ind.rq_cred.rq_cred_data)
 				free(preq->rq_ind.rq_cred.rq_cred_data);
 			break;
+		case PBS_BATCH_ExecJob:
+			free_attrlist(&preq->rq_ind.rq_execjob.rq_job.rq_attr);
+			free(preq->rq_ind.rq_execjob.rq_script);
+			free(preq->rq_ind.rq_execjob.rq_cred);
+			break;
 
 #ifndef PBS_MOM		/* Server Only */
 
@@ -1472,11 +2252,26 @@ free_br(struct batch_request *preq)
 			free(preq->rq_ind.rq_preempt.ppj_list);
 			free(preq->rq_reply.brp_un.brp_preempt_jobs.ppj_list);
 			break;
+		case PBS_BATCH_ModifyJobs:
+			freebr_modifyjobs(&preq->rq_ind.rq_modifyjobs);
+			break;
+		case PBS_BATCH_AsyrunJobs:
+			freebr_runjobs(&preq->rq_ind.rq_runjobs);
+			break;
+		case PBS_BATCH_SubmitJobs:
+			freebr_submitjobs(&preq->rq_ind.rq_submitjobs);
+			break;
+		case PBS_BATCH_ManagerMany:
+			freebr_managemany(&preq->rq_ind.rq_managemany);
+			break;
+		case PBS_BATCH_DeleteJobs:
+			free(preq->rq_ind.rq_deletejobs.rq_list);
+			break;
 #endif /* PBS_MOM */
 	}
 	if (preq->rppcmd_msgid)
 		free(preq->rppcmd_msgid);
-	(void)free(preq);
+	freelist_free(&br_pool, preq);
 }
 /**
  * @brief
@@ -1489,6 +2284,81 @@ freebr_manage(struct rq_manage *pmgr)
 {
 	free_attrlist(&pmgr->rq_attr);
 }
+#ifndef PBS_MOM
+/**
+ * @brief
+ * 		free the per job attribute lists of a Modify Jobs request
+ *
+ * @param[in]	pmj - rq_modifyjobs structure to free.
+ */
+static void
+freebr_modifyjobs(struct rq_modifyjobs *pmj)
+{
+	int i;
+
+	for (i = 0; i < pmj->count; i++)
+		free_attrlist(&pmj->rq_list[i].rq_attr);
+	free(pmj->rq_list);
+	pmj->rq_list = NULL;
+	pmj->count = 0;
+}
+
+/**
+ * @brief
+ * 		free the destinations left in a Run Jobs request
+ *
+ * @param[in]	prj - rq_runjobs structure to free.
+ */
+static void
+freebr_runjobs(struct rq_runjobs *prj)
+{
+	int i;
+
+	for (i = 0; i < prj->count; i++)
+		free(prj->rq_list[i].rq_destin);
+	free(prj->rq_list);
+	prj->rq_list = NULL;
+	prj->count = 0;
+}
+
+/**
+ * @brief
+ * 		free the attributes and scripts left in a Submit Jobs request
+ *
+ * @param[in]	psj - rq_submitjobs structure to free.
+ */
+static void
+freebr_submitjobs(struct rq_submitjobs *psj)
+{
+	int i;
+
+	for (i = 0; i < psj->count; i++) {
+		free_attrlist(&psj->rq_list[i].rq_attr);
+		free(psj->rq_list[i].rq_script);
+	}
+	free(psj->rq_list);
+	psj->rq_list = NULL;
+	psj->count = 0;
+}
+
+/**
+ * @brief
+ * 		free the attributes left in a Manager Many request
+ *
+ * @param[in]	pmm - rq_managemany structure to free.
+ */
+static void
+freebr_managemany(struct rq_managemany *pmm)
+{
+	int i;
+
+	for (i = 0; i < pmm->count; i++)
+		free_attrlist(&pmm->rq_list[i].rq_attr);
+	free(pmm->rq_list);
+	pmm->rq_list = NULL;
+	pmm->count = 0;
+}
+#endif
 /**
  * @brief
  * 		remove all the rqfpair and free their memory
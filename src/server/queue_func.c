@@ -76,6 +76,8 @@
 #include "sched_cmds.h"
 #include "pbs_db.h"
 #include "pbs_nodes.h"
+#include "name_idx.h"
+#include "svrfunc.h"
 #include <memory.h>
 #include "pbs_sched.h"
 
@@ -117,13 +119,19 @@ que_alloc(char *name)
 		return NULL;
 	}
 	(void)memset((char *)pq, (int)0, (size_t)sizeof(pbs_queue));
+	mem_stats_alloc[MEM_STATS_QUEUE]++;
 	pq->qu_qs.qu_type = QTYPE_Unset;
 	CLEAR_HEAD(pq->qu_jobs);
+	CLEAR_HEAD(pq->qu_actjobs);
+	for (i = 0; i < PBS_NUMJOBSTATE; i++)
+		CLEAR_HEAD(pq->qu_jobs_bystate[i]);
 	CLEAR_LINK(pq->qu_link);
 
 	snprintf(pq->qu_qs.qu_name, sizeof(pq->qu_qs.qu_name), "%s", name);
 	append_link(&svr_queues, &pq->qu_link, pq);
+	svr_name_idx_oper(&queues_idx, pq->qu_qs.qu_name, pq, NAME_IDX_OP_ADD);
 	server.sv_qs.sv_numque++;
+	pq->qu_mod_seq = ++svr_mod_seq;
 
 	/* set the working attributes to "unspecified" */
 
@@ -174,7 +182,9 @@ que_free(pbs_queue *pq)
 
 	server.sv_qs.sv_numque--;
 	delete_link(&pq->qu_link);
+	svr_name_idx_oper(&queues_idx, pq->qu_qs.qu_name, pq, NAME_IDX_OP_DEL);
 	(void)free((char *)pq);
+	mem_stats_alloc[MEM_STATS_QUEUE]--;
 }
 
 
@@ -241,6 +251,7 @@ que_purge(pbs_queue *pque)
 			while (pjob) {
 				nxpjob = (job *)GET_NEXT(pjob->ji_jobque);
 				delete_link(&pjob->ji_jobque);
+				delete_link(&pjob->ji_questatejobs);
 				--pque->qu_numjobs;
 				--pque->qu_njstate[pjob->ji_qs.ji_state];
 				pjob->ji_qhdr = NULL;
@@ -261,6 +272,7 @@ que_purge(pbs_queue *pque)
 			pque->qu_qs.qu_name);
 		log_err(errno, "queue_purge", log_buffer);
 	}
+	record_mod_seq_delete(MGR_OBJ_QUEUE, pque->qu_qs.qu_name);
 	que_free(pque);
 
 	return (0);
@@ -287,6 +299,12 @@ find_queuebyname(char *quename)
 	pc = strchr(qname, (int)'@');	/* strip off server (fragment) */
 	if (pc)
 		*pc = '\0';
+	if (queues_idx != NULL) {
+		pque = (pbs_queue *) find_name_idx(queues_idx, qname);
+		if (pc)
+			*pc = '@';	/* restore '@' server portion */
+		return (pque);
+	}
 	pque = (pbs_queue *)GET_NEXT(svr_queues);
 	while (pque != NULL) {
 		if (strcmp(qname, pque->qu_qs.qu_name) == 0)
@@ -175,6 +175,11 @@ dis_reply_write(int sfds, struct batch_request *preq)
 {
 	int rc;
 	struct batch_reply *preply = &preq->rq_reply;
+#ifndef PBS_MOM
+	long long start = req_stats_now();
+	char *data;
+	size_t len;
+#endif
 
 	if (preq->isrpp) {
 		rc = encode_DIS_replyRPP(sfds, preq->rppcmd_msgid, preply);
@@ -186,12 +191,31 @@ dis_reply_write(int sfds, struct batch_request *preq)
 		pbs_tcp_errno = 0;
 		DIS_tcp_setup(sfds);		/* setup for DIS over tcp */
 
+#ifndef PBS_MOM
+		/* a status reply to keep is held whole for stat_cache_save() */
+		if ((preq->rq_statkey != NULL) && (DIS_tcp_whold(sfds, 1) != 0)) {
+			free(preq->rq_statkey);
+			preq->rq_statkey = NULL;
+		}
+#endif
 		rc = encode_DIS_reply(sfds, preply);
+#ifndef PBS_MOM
+		if (preq->rq_statkey != NULL) {
+			(void)DIS_tcp_whold(sfds, 0);
+			if (rc == 0) {
+				len = DIS_tcp_wcommitted(sfds, &data);
+				stat_cache_save(preq, data, len);
+			}
+		}
+#endif
 	}
 
 	if (rc == 0) {
 		DIS_wflush(sfds, preq->isrpp);
 	}
+#ifndef PBS_MOM
+	req_stats_reply_usec += req_stats_now() - start;
+#endif
 
 	if (rc) {
 		char hn[PBS_MAXHOSTNAME+1];
@@ -239,7 +263,19 @@ reply_send(struct batch_request *request)
 
 	/* if this is a child request, just move the error to the parent */
 
-	if (request->rq_parentbr) {
+	if (request->rq_parentbr &&
+		request->rq_parentbr->rq_reply.brp_choice == BATCH_REPLY_CHOICE_JobErrs) {
+		/* a multi-job child records its result in its slot of the reply */
+		if (request->rq_extra != NULL) {
+			job_err_info *slot = (job_err_info *)request->rq_extra;
+
+			slot->errcode = request->rq_reply.brp_code;
+			/* and a job queued by Submit Jobs its new job id */
+			if ((request->rq_reply.brp_choice == BATCH_REPLY_CHOICE_Queue) ||
+				(request->rq_reply.brp_choice == BATCH_REPLY_CHOICE_Commit))
+				strcpy(slot->job_id, request->rq_reply.brp_un.brp_jid);
+		}
+	} else if (request->rq_parentbr) {
 		if ((request->rq_parentbr->rq_reply.brp_choice == BATCH_REPLY_CHOICE_NULL) && (request->rq_parentbr->rq_reply.brp_code == 0)) {
 			request->rq_parentbr->rq_reply.brp_code = request->rq_reply.brp_code;
 			request->rq_parentbr->rq_reply.brp_auxcode = request->rq_reply.brp_auxcode;
@@ -297,6 +333,10 @@ reply_send(struct batch_request *request)
 		 */
 		if (rc == PBSE_NONE) {
 			rc = dis_reply_write(sfds, request);
+#ifndef PBS_MOM
+			if ((rc == 0) && !request->isrpp)
+				pipeline_reply_sent(sfds);
+#endif
 		}
 	}
 
@@ -377,6 +417,10 @@ reply_free(struct batch_reply *prep)
 		(void)free(prep->brp_un.brp_rescq.brq_alloc);
 		(void)free(prep->brp_un.brp_rescq.brq_resvd);
 		(void)free(prep->brp_un.brp_rescq.brq_down);
+	} else if (prep->brp_choice == BATCH_REPLY_CHOICE_JobErrs) {
+		(void)free(prep->brp_un.brp_job_errs.pje_list);
+		prep->brp_un.brp_job_errs.pje_list = NULL;
+		prep->brp_un.brp_job_errs.count = 0;
 	}
 	prep->brp_choice = BATCH_REPLY_CHOICE_NULL;
 }
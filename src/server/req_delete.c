@@ -46,6 +46,7 @@
  *	check_deletehistoryjob()
  *	issue_delete()
  *	req_deletejob()
+ *	req_deletejobs()
  *	req_deletejob2()
  *	req_deleteReservation()
  *	post_delete_route()
@@ -82,6 +83,7 @@
 #include "log.h"
 #include "pbs_nodes.h"
 #include "svrfunc.h"
+#include "pbs_db.h"
 
 
 /* Global Data Items: */
@@ -186,7 +188,9 @@ acct_del_write(char *jid, job *pjob, struct batch_request *preq, int nomail)
 				check_block(pjob, log_buffer);
 		}
 
-		if (preq->rq_parentbr == NULL && nomail == 0 &&
+		if ((preq->rq_parentbr == NULL ||
+			preq->rq_parentbr->rq_type == PBS_BATCH_DeleteJobs) &&
+			nomail == 0 &&
 			svr_chk_owner(preq, pjob) != 0 &&
 			qdel_mail != 0) {
 			svr_mailowner_id(jid, pjob,
@@ -600,6 +604,86 @@ req_deletejob(struct batch_request *preq)
 
 	return;
 }
+
+/**
+ * @brief
+ * 		req_deletejobs - service the Delete Jobs Request, used by qdel to
+ *		delete many jobs in one request.
+ *
+ * @par	Functionality:
+ *		Each job is handed to req_deletejob() as a child Delete Job
+ *		request sharing this request's extend, so permissions, hooks,
+ *		mail and the signal to MOM are those of the jobs deleted one at a
+ *		time.  reply_send() records each child's error code in the job's
+ *		slot of this request's reply, which is sent once the last child is
+ *		done.  What the deletions save to or purge from the database is
+ *		committed in one transaction, and their accounting records are
+ *		flushed together.
+ *
+ * @param[in]	preq	- the request
+ */
+void
+req_deletejobs(struct batch_request *preq)
+{
+	int i;
+	int in_trx = 0;
+	int count = preq->rq_ind.rq_deletejobs.count;
+	struct rq_deletejobs_entry *pdj = preq->rq_ind.rq_deletejobs.rq_list;
+	job_err_info *pje;
+	struct batch_request *npreq;
+
+	pje = calloc(sizeof(job_err_info), count > 0 ? count : 1);
+	if (pje == NULL) {
+		req_reject(PBSE_SYSTEM, 0, preq);
+		return;
+	}
+	preq->rq_reply.brp_choice = BATCH_REPLY_CHOICE_JobErrs;
+	preq->rq_reply.brp_un.brp_job_errs.pje_list = pje;
+	preq->rq_reply.brp_un.brp_job_errs.count = count;
+
+	sprintf(log_buffer, "delete jobs request received for %d jobs", count);
+	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_INFO,
+		preq->rq_user, log_buffer);
+
+	/* hold a reference so a child finishing early can't send the reply */
+	++preq->rq_refct;
+
+	if (count > 1) {
+		if (pbs_db_begin_trx(svr_db_conn, 0, 0) == 0)
+			in_trx = 1;
+		acct_hold(1);
+	}
+
+	for (i = 0; i < count; i++) {
+		strcpy(pje[i].job_id, pdj[i].rq_jid);
+
+		npreq = alloc_job_child_br(preq, PBS_BATCH_DeleteJob, &pje[i]);
+		if (npreq == NULL) {
+			pje[i].errcode = PBSE_SYSTEM;
+			continue;
+		}
+		npreq->rq_ind.rq_delete.rq_cmd = MGR_CMD_DELETE;
+		npreq->rq_ind.rq_delete.rq_objtype = MGR_OBJ_JOB;
+		strcpy(npreq->rq_ind.rq_delete.rq_objname, pdj[i].rq_jid);
+		CLEAR_HEAD(npreq->rq_ind.rq_delete.rq_attr);
+		req_deletejob(npreq);
+	}
+
+	if (count > 1)
+		acct_hold(0);
+	if (in_trx && (pbs_db_end_trx(svr_db_conn, PBS_DB_COMMIT) != 0)) {
+		sprintf(log_buffer, "Failed to save deleted jobs ");
+		if (svr_db_conn->conn_db_err != NULL)
+			strncat(log_buffer, svr_db_conn->conn_db_err,
+				LOG_BUF_SIZE - strlen(log_buffer) - 1);
+		log_err(-1, __func__, log_buffer);
+		(void) pbs_db_end_trx(svr_db_conn, PBS_DB_ROLLBACK);
+		panic_stop_db(log_buffer);
+	}
+
+	if (--preq->rq_refct == 0)
+		reply_send(preq);
+}
 /**
  * @brief
  * 		req_deletejob2 - service the Delete Job Request
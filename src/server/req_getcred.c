@@ -54,6 +54,7 @@
 #include "credential.h"
 #include "net_connect.h"
 #include "batch_request.h"
+#include "dis.h"
 #include "pbs_share.h"
 
 
@@ -94,7 +95,33 @@ req_connect(struct batch_request *preq)
 
 	if ((conn->cn_authen &
 		(PBS_NET_CONN_AUTHENTICATED|PBS_NET_CONN_FROM_PRIVIL))==0) {
-		reply_ack(preq);
+		int sock = preq->rq_conn;
+		int binary = 0;
+		int pipeline = 0;
+		char accepted[sizeof(DIS_BINARY_OFFER) + sizeof(PIPELINE_OFFER) + 1];
+
+		if (preq->rq_extend != NULL) {
+			binary = connect_offer_listed(preq->rq_extend, DIS_BINARY_OFFER);
+			/* keeps the input read ahead from here on */
+			pipeline = connect_offer_listed(preq->rq_extend, PIPELINE_OFFER) &&
+				(DIS_tcp_set_pipelined(sock) == 0);
+		}
+
+		if (binary || pipeline) {
+			snprintf(accepted, sizeof(accepted), "%s%s%s",
+				binary ? DIS_BINARY_OFFER : "",
+				(binary && pipeline) ? "," : "",
+				pipeline ? PIPELINE_OFFER : "");
+
+			/* the accepted offers are used from the next request on */
+			if (reply_text(preq, PBSE_NONE, accepted) == 0) {
+				if (binary)
+					DIS_tcp_set_fmt(sock, DIS_FMT_BINARY);
+				if (pipeline && (conn = get_conn(sock)) != NULL)
+					conn->cn_authen |= PBS_NET_CONN_PIPELINE;
+			}
+		} else
+			reply_ack(preq);
 	} else
 		req_reject(PBSE_BADCRED, 0, preq);
 }
@@ -52,6 +52,8 @@
  * 	rel_resc()
  * 	on_exitrerun_msg()
  * 	conn_to_mom_failed()
+ * 	set_exit_substate()
+ * 	stagein_in_sandbox()
  * 	on_job_exit()
  * 	on_job_rerun()
  * 	setrerun()
@@ -699,6 +701,66 @@ conn_to_mom_failed(job *pjob, void(*func)(struct work_task *))
 	return;
 }
 
+/**
+ * @brief
+ * 		set_exit_substate - advance an exiting job to the next end of job
+ *		phase in memory only.  Used when a phase has nothing to ask of Mom,
+ *		so on recovery the job simply goes through that phase again.
+ *
+ * @param[in,out]	pjob	- job structure
+ * @param[in]	newsubstate	- next exiting substate
+ */
+static void
+set_exit_substate(job *pjob, int newsubstate)
+{
+	pjob->ji_qs.ji_substate = newsubstate;
+	pjob->ji_wattr[(int)JOB_ATR_substate].at_val.at_long = newsubstate;
+	pjob->ji_wattr[(int)JOB_ATR_substate].at_flags |= ATR_VFLAG_MODCACHE;
+}
+
+/**
+ * @brief
+ * 		stagein_in_sandbox - check whether all of the job's stage-in files
+ *		are within its "sandbox=PRIVATE" staging and execution directory.
+ *		Mom skips such files on a Delete Files request and removes them
+ *		with the directory when the job is deleted, so the request need
+ *		not be sent.
+ *
+ * @param[in]	pjob	- job structure
+ *
+ * @return	int
+ * @retval	1	- every stage-in file is relative to the sandbox
+ * @retval	0	- no private sandbox, or a file may lie outside it
+ */
+static int
+stagein_in_sandbox(job *pjob)
+{
+	int		      i;
+	attribute	     *pattr;
+	struct array_strings *parst;
+	char		     *plocal;
+
+	pattr = &pjob->ji_wattr[(int)JOB_ATR_sandbox];
+	if (((pattr->at_flags & ATR_VFLAG_SET) == 0) ||
+		(strcasecmp(pattr->at_val.at_str, "PRIVATE") != 0))
+		return (0);
+
+	pattr = &pjob->ji_wattr[(int)JOB_ATR_stagein];
+	if ((pattr->at_flags & ATR_VFLAG_SET) == 0)
+		return (1);
+	parst = pattr->at_val.at_arst;
+	for (i = 0; i < parst->as_usedptr; ++i) {
+		plocal = parst->as_string[i];
+		if ((*plocal == '/') || (*plocal == '\\') ||
+			((*plocal != '\0') && (plocal[1] == ':')))
+			return (0);
+		/* be conservative, ".." might escape the sandbox */
+		if (strstr(plocal, "..") != NULL)
+			return (0);
+	}
+	return (1);
+}
+
 /**
  * @brief
  * 		continue post-execution processing of a job that terminated.
@@ -710,6 +772,10 @@ conn_to_mom_failed(job *pjob, void(*func)(struct work_task *))
  *		the first time in for the job substate.  Otherwise it is with the reply
  *		given by MOM.
  *
+ *		A phase with nothing to ask of MOM (no files to stage out, no staged
+ *		in files to delete) is passed through in the same call without a
+ *		save, so a job without stage-out costs one Delete Job round trip.
+ *
  *		NOTE:
  *		On the initial work task (WORK_Immed), the wt_parm1 is a job pointer.
  *		On a call-back work task (WORK_Deferred_Reply) generated by
@@ -816,11 +882,8 @@ on_job_exit(struct work_task *ptask)
 					}
 
 				} else {		/* no files to copy, any to delete? */
-					(void)svr_setjobstate(pjob, JOB_STATE_EXITING,
-						JOB_SUBSTATE_STAGEDEL);
-					ptask = set_task(WORK_Immed, 0, on_job_exit, pjob);
-					append_link(&pjob->ji_svrtask, &ptask->wt_linkobj, ptask);
-					return;
+					set_exit_substate(pjob, JOB_SUBSTATE_STAGEDEL);
+					goto StageDel;
 				}
 			}
 
@@ -871,14 +934,16 @@ on_job_exit(struct work_task *ptask)
 			/* NO BREAK - FALL INTO THE NEXT CASE */
 
 		case JOB_SUBSTATE_STAGEDEL:
+StageDel:
 
 			if (ptask->wt_type != WORK_Deferred_Reply) { /* first time in */
 
 				/* Build list of files which were staged-in so they can
-				 * can be deleted.
+				 * can be deleted, unless Mom removes them with the sandbox.
 				 */
 
-				preq = cpy_stage(preq, pjob, JOB_ATR_stagein, 0);
+				if (stagein_in_sandbox(pjob) == 0)
+					preq = cpy_stage(preq, pjob, JOB_ATR_stagein, 0);
 
 				if (preq) {		/* have files to delete		*/
 
@@ -908,11 +973,8 @@ on_job_exit(struct work_task *ptask)
 
 				} else {		/* preq == 0, no files to delete   */
 
-					(void)svr_setjobstate(pjob, JOB_STATE_EXITING,
-						JOB_SUBSTATE_EXITED);
-					ptask = set_task(WORK_Immed, 0, on_job_exit, pjob);
-					append_link(&pjob->ji_svrtask, &ptask->wt_linkobj, ptask);
-					return;
+					set_exit_substate(pjob, JOB_SUBSTATE_EXITED);
+					goto Exited;
 				}
 			}
 
@@ -966,6 +1028,7 @@ on_job_exit(struct work_task *ptask)
 
 
 		case JOB_SUBSTATE_EXITED:
+Exited:
 
 			if (ptask->wt_type != WORK_Deferred_Reply) { /* first time in */
 
@@ -1751,6 +1814,8 @@ job_obit(struct resc_used_update *pruu, int stream)
 		pjob->ji_qs.ji_substate);
 	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_INFO,
 		pruu->ru_pjobid, log_buffer);
+	if (pjob->ji_stagems[JOB_STAGE_OBIT] == 0)
+		job_stage_mark(pjob, JOB_STAGE_OBIT);
 
 	if (pjob->ji_qs.ji_state != JOB_STATE_RUNNING) {
 		DBPRT(("%s: job %s not in running state!\n",
@@ -67,6 +67,7 @@
  *
  *	mgr_node_create()	- top level function for creating a node
  *	req_manager()		- process manager request (top level)
+ *	req_managemany()	- process many manager directives in one pass
  *
  *	warnings_update()	- add node to a warnings array if warning justified
  *
@@ -106,6 +107,7 @@
 #include "pbs_error.h"
 #include "log.h"
 #include "pbs_nodes.h"
+#include "name_idx.h"
 #include "svrfunc.h"
 #include "pbs_ifl.h"
 #include "batch_request.h"
@@ -129,7 +131,7 @@
 struct work_task *global_ping_task = NULL;
 pntPBS_IP_LIST pbs_iplist = NULL;
 
-AVL_IX_DESC *node_tree = NULL;
+name_idx *nodes_idx = NULL;
 AVL_IX_DESC *hostaddr_tree = NULL;
 
 /* Global Data Items: */
@@ -1214,7 +1216,7 @@ mgr_unset_attr(attribute *pattr, attribute_def *pdef, int limit, svrattrl *plist
 									resource *nresc;
 									if ((nresc = find_resc_entry((pattr+i), prsdef)) != NULL) {
 										nresc->rs_defin->rs_free(&nresc->rs_value);
-										delete_link(&nresc->rs_link);
+										unlink_resource_entry(pattr+i, nresc);
 										free(nresc);
 										nresc = (resource *)GET_NEXT((pattr+i)->at_val.at_list);
 										if (nresc == NULL)
@@ -1227,7 +1229,7 @@ mgr_unset_attr(attribute *pattr, attribute_def *pdef, int limit, svrattrl *plist
 					}
 					prsdef->rs_free(&presc->rs_value);
 				}
-				delete_link(&presc->rs_link);
+				unlink_resource_entry(pattr+index, presc);
 				free(presc);
 				presc = NULL;
 			}
@@ -3083,6 +3085,7 @@ create_pbs_node2(char *objname, svrattrl *plist, int perms, int *bad, struct pbs
 			pnode->nd_index = svr_totnodes;
 			pnode->nd_arr_index = svr_totnodes; /* this is only in mem, not from db */
 			pbsndlist[svr_totnodes++] = pnode;
+			invalidate_node_state_ct();
 		} else {
 			free_pnode(pnode);
 			free(pname);
@@ -3104,10 +3107,10 @@ create_pbs_node2(char *objname, svrattrl *plist, int perms, int *bad, struct pbs
 			return (PBSE_SYSTEM);
 		}
 
-		/* create node tree if not already done */
-		if (node_tree == NULL ) {
-			node_tree = create_tree(AVL_NO_DUP_KEYS, 0);
-			if (node_tree == NULL ) {
+		/* create node index if not already done */
+		if (nodes_idx == NULL) {
+			nodes_idx = create_name_idx();
+			if (nodes_idx == NULL) {
 				svr_totnodes--;
 				free_pnode(pnode);
 				free(pname);
@@ -3115,8 +3118,8 @@ create_pbs_node2(char *objname, svrattrl *plist, int perms, int *bad, struct pbs
 			}
 		}
 
-		/* add to node tree */
-		if (tree_add_del(node_tree, pname, pnode, TREE_OP_ADD) != 0) {
+		/* add to node index */
+		if (name_idx_add_del(nodes_idx, pname, pnode, NAME_IDX_OP_ADD) != 0) {
 			svr_totnodes--;
 			free_pnode(pnode);
 			free(pname);
@@ -3349,7 +3352,7 @@ create_pbs_node2(char *objname, svrattrl *plist, int perms, int *bad, struct pbs
 	 * Therefore, we need to set the flag "NODE_UPDATE_OTHERS" so that a later
 	 * call to save_nodes_db will save this node as well.
 	 */
-	pnode->nd_modified = NODE_UPDATE_OTHERS;
+	node_mark_modified(pnode, NODE_UPDATE_OTHERS);
 
 	if (rtnpnode != NULL)
 		*rtnpnode = pnode;
@@ -4313,10 +4316,12 @@ mgr_resource_delete(struct batch_request *preq)
 			else {
 				svr_resc_def = svr_rd->rs_next;
 			}
+			invalidate_parsed_execvnodes();
 			free(prdef->rs_name);
 			free(prdef);
 			prdef = NULL;
 			svr_resc_size--;
+			(void)index_resc_def(svr_resc_def, svr_resc_size);
 			break;
 		}
 	}
@@ -4719,7 +4724,7 @@ mgr_resource_unset(struct batch_request *preq)
 				if (i == SRV_ATR_resource_assn) {
 					if (server.sv_attr[i].at_flags & ATR_VFLAG_SET) {
 						presc->rs_defin->rs_free(&presc->rs_value);
-						delete_link(&presc->rs_link);
+						unlink_resource_entry(&server.sv_attr[i], presc);
 						free(presc);
 						presc = (resource *)GET_NEXT(server.sv_attr[i].at_val.at_list);
 						if (presc == NULL)
@@ -4749,7 +4754,7 @@ mgr_resource_unset(struct batch_request *preq)
 			q_attr = &pq_list[q_count]->qu_attr[QE_ATR_ResourceAssn];
 			presc = get_resource(q_attr, prdef);
 			presc->rs_defin->rs_free(&presc->rs_value);
-			delete_link(&presc->rs_link);
+			unlink_resource_entry(q_attr, presc);
 			free(presc);
 			presc = (resource *)GET_NEXT(q_attr->at_val.at_list);
 			if (presc == NULL)
@@ -5048,6 +5053,95 @@ req_manager(struct batch_request *preq)
 	}
 }
 
+/**
+ * @brief
+ * 		req_managemany - service the Manager Many request, used by qmgr to
+ *		send many create, delete, set and unset directives in one request.
+ *
+ * @par	Functionality:
+ *		Each directive is handed to req_manager() as a child Manager
+ *		request, in order, so permissions, checks and logging are those of
+ *		the same directives sent one at a time.  reply_send() records each
+ *		child's error code in the directive's slot of this request's reply,
+ *		which is sent once the last child is done.  What the directives
+ *		save to the database is committed in one transaction.  Hook
+ *		directives and import/export are not accepted in the request, as
+ *		qmgr sends those with the files they need.
+ *
+ * @param[in]	preq	- the request
+ */
+void
+req_managemany(struct batch_request *preq)
+{
+	int i;
+	int in_trx = 0;
+	int count = preq->rq_ind.rq_managemany.count;
+	struct rq_manage *pm = preq->rq_ind.rq_managemany.rq_list;
+	job_err_info *pje;
+	struct batch_request *npreq;
+
+	pje = calloc(sizeof(job_err_info), count > 0 ? count : 1);
+	if (pje == NULL) {
+		req_reject(PBSE_SYSTEM, 0, preq);
+		return;
+	}
+	preq->rq_reply.brp_choice = BATCH_REPLY_CHOICE_JobErrs;
+	preq->rq_reply.brp_un.brp_job_errs.pje_list = pje;
+	preq->rq_reply.brp_un.brp_job_errs.count = count;
+
+	/* hold a reference so a child finishing early can't send the reply */
+	++preq->rq_refct;
+
+	if (count > 1) {
+		if (pbs_db_begin_trx(svr_db_conn, 0, 0) == 0)
+			in_trx = 1;
+	}
+
+	for (i = 0; i < count; i++) {
+		strcpy(pje[i].job_id, pm[i].rq_objname);
+		switch (pm[i].rq_cmd) {
+			case MGR_CMD_CREATE:
+			case MGR_CMD_DELETE:
+			case MGR_CMD_SET:
+			case MGR_CMD_UNSET:
+				break;
+			default:
+				pje[i].errcode = PBSE_IVALREQ;
+				continue;
+		}
+		if ((pm[i].rq_objtype == MGR_OBJ_SITE_HOOK) ||
+			(pm[i].rq_objtype == MGR_OBJ_PBS_HOOK)) {
+			pje[i].errcode = PBSE_IVALREQ;
+			continue;
+		}
+
+		npreq = alloc_job_child_br(preq, PBS_BATCH_Manager, &pje[i]);
+		if (npreq == NULL) {
+			pje[i].errcode = PBSE_SYSTEM;
+			continue;
+		}
+		npreq->rq_ind.rq_manager.rq_cmd = pm[i].rq_cmd;
+		npreq->rq_ind.rq_manager.rq_objtype = pm[i].rq_objtype;
+		strcpy(npreq->rq_ind.rq_manager.rq_objname, pm[i].rq_objname);
+		/* the child owns the attributes from here on, see free_br() */
+		list_move(&pm[i].rq_attr, &npreq->rq_ind.rq_manager.rq_attr);
+		req_manager(npreq);
+	}
+
+	if (in_trx && (pbs_db_end_trx(svr_db_conn, PBS_DB_COMMIT) != 0)) {
+		sprintf(log_buffer, "Failed to save manager directives ");
+		if (svr_db_conn->conn_db_err != NULL)
+			strncat(log_buffer, svr_db_conn->conn_db_err,
+				LOG_BUF_SIZE - strlen(log_buffer) - 1);
+		log_err(-1, __func__, log_buffer);
+		(void) pbs_db_end_trx(svr_db_conn, PBS_DB_ROLLBACK);
+		panic_stop_db(log_buffer);
+	}
+
+	if (--preq->rq_refct == 0)
+		reply_send(preq);
+}
+
 /**
  * @brief
  * 		manager_oper_chk - check the @host part of a manager or operator acl
@@ -5224,7 +5318,7 @@ svr_max_conc_prov_action(attribute *new, void *pobj, int act)
 
 	/* pick a few if size is increased */
 	if (server.sv_provtracksize < max_concurrent_prov)
-		set_task(WORK_Immed, 0, do_provisioning, NULL);
+		(void)queue_provisioning();
 
 	rc = resize_prov_table(max_concurrent_prov);
 
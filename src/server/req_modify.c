@@ -44,12 +44,15 @@
  * Included funtions are:
  *	post_modify_req()
  *	req_modifyjob()
+ *	req_modifyjobs()
  *	find_name_in_svrattrl()
  *	modify_job_attr()
  */
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include "libpbs.h"
 #include <signal.h>
@@ -416,6 +419,63 @@ req_modifyjob(struct batch_request *preq)
 	reply_ack(preq);
 }
 
+/**
+ * @brief
+ * 		Service the Modify Jobs Request, used by the scheduler to send the
+ * 		attribute updates of many jobs (e.g. comments) in one round trip.
+ *
+ * @par	Functionality:
+ *		Each job in the request is handed to req_modifyjob() as a child
+ *		Modify Job request, so permissions, hooks and the relay to MOM work
+ *		exactly as if the jobs had been altered one at a time.  As each child
+ *		is replied to, reply_send() records its error code in the job's slot
+ *		of this request's reply.  The reply is sent once the last child is
+ *		done.
+ *
+ * @param[in] preq - pointer to batch request from client
+ */
+void
+req_modifyjobs(struct batch_request *preq)
+{
+	int i;
+	int count = preq->rq_ind.rq_modifyjobs.count;
+	struct rq_modifyjobs_entry *pent = preq->rq_ind.rq_modifyjobs.rq_list;
+	job_err_info *pmj;
+	struct batch_request *npreq;
+
+	pmj = calloc(sizeof(job_err_info), count > 0 ? count : 1);
+	if (pmj == NULL) {
+		req_reject(PBSE_SYSTEM, 0, preq);
+		return;
+	}
+	preq->rq_reply.brp_choice = BATCH_REPLY_CHOICE_JobErrs;
+	preq->rq_reply.brp_un.brp_job_errs.pje_list = pmj;
+	preq->rq_reply.brp_un.brp_job_errs.count = count;
+
+	/* hold a reference so a child finishing early can't send the reply */
+	++preq->rq_refct;
+
+	for (i = 0; i < count; i++) {
+		strcpy(pmj[i].job_id, pent[i].rq_jid);
+
+		npreq = alloc_job_child_br(preq, PBS_BATCH_ModifyJob, &pmj[i]);
+		if (npreq == NULL) {
+			pmj[i].errcode = PBSE_SYSTEM;
+			continue;
+		}
+		npreq->rq_ind.rq_modify.rq_cmd = MGR_CMD_SET;
+		npreq->rq_ind.rq_modify.rq_objtype = MGR_OBJ_JOB;
+		strcpy(npreq->rq_ind.rq_modify.rq_objname, pent[i].rq_jid);
+		/* the child owns the attributes from here on, see free_br() */
+		list_move(&pent[i].rq_attr, &npreq->rq_ind.rq_modify.rq_attr);
+
+		req_modifyjob(npreq);
+	}
+
+	if (--preq->rq_refct == 0)
+		reply_send(preq);
+}
+
 /**
  * @brief
  * 		Returns the svrattrl entry matching attribute 'name', or NULL if not found.
@@ -464,10 +524,11 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 	int	   modified = 0;
 	attribute *newattr;
 	attribute *pre_copy;
-	attribute *attr_save;
+	attribute *attr_save = NULL;
 	attribute *pattr;
 	resource  *prc;
 	int	   rc;
+	int	   has_action = 0;
 	int	   newstate = -1;
 	int	   newsubstate = -1;
 	long	   newaccruetype = -1;
@@ -502,14 +563,29 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 	}
 	attr_atomic_copy(pre_copy, newattr, job_attr_def, JOB_ATR_LAST);
 
-	attr_save = calloc(JOB_ATR_LAST, sizeof(attribute));
-	if (attr_save == NULL) {
-		attr_atomic_kill(newattr, job_attr_def, JOB_ATR_LAST);
-		attr_atomic_kill(pre_copy, job_attr_def, JOB_ATR_LAST);
-		return PBSE_SYSTEM;
+	/*
+	 * The job's attributes are saved so they can be put back if an action
+	 * function fails.  Updates from Mom, typically resources_used only,
+	 * call no action function, so the copy is made only when one will be
+	 * called.
+	 */
+	for (i = 0; i < JOB_ATR_LAST; i++) {
+		if ((newattr[i].at_flags & ATR_VFLAG_MODIFY) &&
+			job_attr_def[i].at_action) {
+			has_action = 1;
+			break;
+		}
 	}
+	if (has_action) {
+		attr_save = calloc(JOB_ATR_LAST, sizeof(attribute));
+		if (attr_save == NULL) {
+			attr_atomic_kill(newattr, job_attr_def, JOB_ATR_LAST);
+			attr_atomic_kill(pre_copy, job_attr_def, JOB_ATR_LAST);
+			return PBSE_SYSTEM;
+		}
 
-	attr_atomic_copy(attr_save, pattr, job_attr_def, JOB_ATR_LAST);
+		attr_atomic_copy(attr_save, pattr, job_attr_def, JOB_ATR_LAST);
+	}
 
 	/* If resource limits are being changed ... */
 
@@ -603,7 +679,8 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 
 	if (rc) {
 		attr_atomic_kill(newattr, job_attr_def, JOB_ATR_LAST);
-		attr_atomic_kill(attr_save, job_attr_def, JOB_ATR_LAST);
+		if (attr_save)
+			attr_atomic_kill(attr_save, job_attr_def, JOB_ATR_LAST);
 		attr_atomic_kill(pre_copy, job_attr_def, JOB_ATR_LAST);
 		return (rc);
 	}
@@ -631,8 +708,7 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 			job_attr_def[i].at_free(&pattr[i]);
 			if ((pre_copy[i].at_type == ATR_TYPE_LIST) ||
 				(pre_copy[i].at_type == ATR_TYPE_RESC)) {
-				list_move(&pre_copy[i].at_val.at_list,
-					  &pattr[i].at_val.at_list);
+				move_list_attr(&pre_copy[i], &pattr[i]);
 			} else {
 				pattr[i] = pre_copy[i];
 			}
@@ -684,8 +760,7 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 				default:
 					if ((newattr[i].at_type == ATR_TYPE_LIST) ||
 					    (newattr[i].at_type == ATR_TYPE_RESC)) {
-						list_move(&newattr[i].at_val.at_list,
-							  &pattr[i].at_val.at_list);
+						move_list_attr(&newattr[i], &pattr[i]);
 					} else {
 						pattr[i] = newattr[i];
 					}
@@ -707,7 +782,8 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 
 	free(newattr);
 	free(pre_copy);
-	attr_atomic_kill(attr_save, job_attr_def, JOB_ATR_LAST);
+	if (attr_save)
+		attr_atomic_kill(attr_save, job_attr_def, JOB_ATR_LAST);
 	return (0);
 }
 
@@ -995,7 +1071,7 @@ modify_resv_attr(resc_resv *presv, svrattrl *plist, int perm, int *bad)
 		if (newattr[i].at_flags & ATR_VFLAG_MODIFY) {
 			resv_attr_def[i].at_free(pattr+i);
 			if ((newattr[i].at_type == ATR_TYPE_LIST) || (newattr[i].at_type == ATR_TYPE_RESC)) {
-				list_move(&newattr[i].at_val.at_list, &(pattr+i)->at_val.at_list);
+				move_list_attr(&newattr[i], pattr+i);
 			} else {
 				*(pattr+i) = newattr[i];
 			}
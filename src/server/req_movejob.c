@@ -253,6 +253,11 @@ req_orderjob(struct batch_request *req)
 	} else {
 		swap_link(&pjob1->ji_jobque,  &pjob2->ji_jobque);
 		swap_link(&pjob1->ji_alljobs, &pjob2->ji_alljobs);
+		/* the state and owner lists may not hold both, relink by rank */
+		svr_jobindex_unlink(pjob1, 1);
+		svr_jobindex_unlink(pjob2, 1);
+		svr_jobindex_link(pjob1, pjob1->ji_qs.ji_state);
+		svr_jobindex_link(pjob2, pjob2->ji_qs.ji_state);
 	}
 
 	/* need to update disk copy of both jobs to save new order */
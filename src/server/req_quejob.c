@@ -50,6 +50,13 @@
  *	req_jobscript()
  *	req_mvjobfile()
  *	req_commit()
+ *	commit_save()
+ *	commit_finish()
+ *	commit_one()
+ *	req_commit_flush()
+ *	req_submitjobs()
+ *	execjob_child()
+ *	req_execjob()
  *	locate_new_job()
  *	req_resvSub()
  *	get_queue_for_reservation()
@@ -100,6 +107,7 @@
 #include "net_connect.h"
 #include "pbs_error.h"
 #include "pbs_nodes.h"
+#include "name_idx.h"
 #include "svrfunc.h"
 #include "sched_cmds.h"
 #include "log.h"
@@ -196,6 +204,12 @@ static	void	handle_qmgr_reply_to_resvQcreate(struct work_task *);
 static	int	get_queue_for_reservation(resc_resv *);
 static	int	ignore_attr(char *);
 static	int	validate_place_req_of_job_in_reservation(job *pj);
+static	void	commit_one(struct batch_request *preq, job *pj);
+
+/* Commit requests waiting for req_commit_flush() to write their jobs */
+#define COMMIT_BATCH_MAX	256
+static struct batch_request *commit_pend[COMMIT_BATCH_MAX];
+static int commit_npend = 0;
 
 /* To generate the job/resv id's locally */
 static long long get_next_svr_sequence_id(void);
@@ -1793,17 +1807,13 @@ req_commit(struct batch_request *preq)
 	int			newstate;
 	int			newsub;
 	resc_resv	*presv;
-	pbs_queue	*pque;
 	int			rc;
-	pbs_db_jobscr_info_t	jobscr;
-	pbs_db_obj_info_t	obj;
 	long			time_msec;
 #ifdef	WIN32
 	struct	_timeb		tval;
 #else
 	struct timeval		tval;
 #endif
-	pbs_db_conn_t		*conn = (pbs_db_conn_t *) svr_db_conn;
 #endif
 
 	pj = locate_new_job(preq, preq->rq_ind.rq_commit);
@@ -1920,7 +1930,7 @@ req_commit(struct batch_request *preq)
 		req_reject(rc, 0, preq);
 		return;
 	}
-	account_jobstr2(pj, PBS_ACCT_QUEUE);
+	job_stage_mark(pj, JOB_STAGE_QUEUED);
 
 	if (pj->ji_resvp) {
 		/*we are supposedly dealing with a reservation job:
@@ -1945,46 +1955,83 @@ req_commit(struct batch_request *preq)
 		}
 		delete_link(&presv->ri_allresvs);
 		append_link(&svr_allresvs, &presv->ri_allresvs, presv);
+		svr_name_idx_oper(&resvs_idx, presv->ri_qs.ri_resvID,
+			presv, NAME_IDX_OP_ADD);
 		set_scheduler_flag(SCH_SCHEDULE_NEW, dflt_scheduler);
 		Update_Resvstate_if_resv(pj);
 	}
 
-	/* save job and job script within single transaction */
-	pbs_db_begin_trx(conn, 0, 0);
-
-	/* Make things faster by writing job only once here  - at commit time */
-	if (job_or_resv_save((void *) pj, SAVEJOB_NEW, JOB_OBJECT)) {
-		(void) pbs_db_end_trx(conn, PBS_DB_ROLLBACK);
-		job_purge(pj);
-		req_reject(PBSE_SAVE_ERR, 0, preq);
+	/*
+	 * A job committed by a client is written to the datastore together
+	 * with the others committed in the same pass of the main loop, see
+	 * req_commit_flush().  A child of a Submit Jobs request must be
+	 * answered before its parent goes on, so it is written now.
+	 */
+	if ((preq->rq_parentbr == NULL) &&
+		(commit_npend < COMMIT_BATCH_MAX)) {
+		commit_pend[commit_npend++] = preq;
 		return;
 	}
+	commit_one(preq, pj);
+#endif		/* PBS_SERVER */
+}
+
+#ifndef PBS_MOM
+/**
+ * @brief
+ *		Write a committed job and its script to the datastore, inside the
+ *		transaction of the caller.
+ *
+ * @param[in]	pj	- the job
+ *
+ * @return	int
+ * @retval	0		- success
+ * @retval	PBSE_SAVE_ERR	- the job could not be saved
+ * @retval	PBSE_SYSTEM	- the job script could not be saved
+ */
+static int
+commit_save(job *pj)
+{
+	pbs_db_jobscr_info_t	jobscr;
+	pbs_db_obj_info_t	obj;
+
+	/* Make things faster by writing job only once here  - at commit time */
+	if (job_or_resv_save((void *) pj, SAVEJOB_NEW, JOB_OBJECT))
+		return PBSE_SAVE_ERR;
 
 	strcpy(jobscr.ji_jobid, pj->ji_qs.ji_jobid);
 	jobscr.script = pj->ji_script;
 	obj.pbs_db_obj_type = PBS_DB_JOBSCR;
 	obj.pbs_db_un.pbs_db_jobscr = &jobscr;
 
-	if (pbs_db_save_obj(conn, &obj, PBS_INSERT_DB) != 0) {
-		job_purge(pj);
-		req_reject(PBSE_SYSTEM, 0, preq);
-		(void) pbs_db_end_trx(conn, PBS_DB_ROLLBACK);
-		return;
-	}
-	if (pj->ji_script) {
-		free(pj->ji_script);
-		pj->ji_script = NULL;
-	}
+	if (pbs_db_save_obj(svr_db_conn, &obj, PBS_INSERT_DB) != 0)
+		return PBSE_SYSTEM;
 
 	/* Now, no need to save server here because server
 	   has already saved in the get_next_svr_sequence_id() */
+	return 0;
+}
 
+/**
+ * @brief
+ *		Finish the commit of a job once it is in the datastore: record it
+ *		in the accounting log, route it if it went to a started routing
+ *		queue, and reply to the client with the job id.
+ *
+ * @param[in]	preq	- the Commit request
+ * @param[in]	pj	- the job
+ */
+static void
+commit_finish(struct batch_request *preq, job *pj)
+{
+	int		rc;
+	pbs_queue	*pque;
 
-	if (pbs_db_end_trx(conn, PBS_DB_COMMIT) != 0) {
-		job_purge(pj);
-		req_reject(PBSE_SYSTEM, 0, preq);
-		return;
+	if (pj->ji_script) {
+		free(pj->ji_script);
+		pj->ji_script = NULL;
 	}
+	account_jobstr2(pj, PBS_ACCT_QUEUE);
 
 	/*
 	 * if the job went into a Route (push) queue that has been started,
@@ -2027,9 +2074,306 @@ req_commit(struct batch_request *preq)
 
 	if ((pj->ji_qs.ji_svrflags & JOB_SVFLG_HERE) == 0)
 		issue_track(pj);	/* notify creator where job is */
-#endif		/* PBS_SERVER */
 }
 
+/**
+ * @brief
+ *		Write a committed job and its script to the datastore in a
+ *		transaction of its own, and finish its commit.
+ *
+ * @param[in]	preq	- the Commit request
+ * @param[in]	pj	- the job
+ */
+static void
+commit_one(struct batch_request *preq, job *pj)
+{
+	int		rc;
+	pbs_db_conn_t	*conn = (pbs_db_conn_t *) svr_db_conn;
+
+	/* save job and job script within single transaction */
+	pbs_db_begin_trx(conn, 0, 0);
+	if ((rc = commit_save(pj)) != 0) {
+		(void) pbs_db_end_trx(conn, PBS_DB_ROLLBACK);
+		job_purge(pj);
+		req_reject(rc, 0, preq);
+		return;
+	}
+	if (pbs_db_end_trx(conn, PBS_DB_COMMIT) != 0) {
+		job_purge(pj);
+		req_reject(PBSE_SYSTEM, 0, preq);
+		return;
+	}
+	commit_finish(preq, pj);
+}
+
+/**
+ * @brief
+ *		Write the jobs committed since the last call to the datastore in
+ *		one transaction, and finish each commit.
+ *
+ * @par Functionality:
+ *		Called from the main loop before it waits for requests, so the
+ *		jobs committed by all clients in one pass are written together and
+ *		their replies go out in the order the commits were read.  The
+ *		accounting records of the batch are held and written together too.
+ *		If the transaction fails, each job is written again on its own so
+ *		that only a job which cannot be saved is rejected.  A job deleted
+ *		before its commit was written is rejected as unknown.
+ */
+void
+req_commit_flush(void)
+{
+	struct batch_request	*batch[COMMIT_BATCH_MAX];
+	job			*pjs[COMMIT_BATCH_MAX];
+	int			 count = commit_npend;
+	int			 i;
+	int			 rc = 0;
+	pbs_db_conn_t		*conn = (pbs_db_conn_t *) svr_db_conn;
+
+	if (count == 0)
+		return;
+	memcpy(batch, commit_pend, count * sizeof(batch[0]));
+	commit_npend = 0;
+
+	for (i = 0; i < count; i++) {
+		pjs[i] = find_job(batch[i]->rq_ind.rq_commit);
+		if ((pjs[i] == NULL) || (pjs[i]->ji_newjob == 0)) {
+			pjs[i] = NULL;
+			req_reject(PBSE_UNKJOBID, 0, batch[i]);
+		}
+	}
+
+	if (pbs_db_begin_trx(conn, 0, 0) != 0)
+		rc = PBSE_SYSTEM;
+	for (i = 0; (rc == 0) && (i < count); i++) {
+		if (pjs[i] != NULL)
+			rc = commit_save(pjs[i]);
+	}
+	if (rc == 0)
+		rc = pbs_db_end_trx(conn, PBS_DB_COMMIT);
+	else
+		(void) pbs_db_end_trx(conn, PBS_DB_ROLLBACK);
+
+	if (rc != 0) {
+		log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_NOTICE,
+			__func__, "saving %d committed jobs together failed, "
+			"saving them one at a time", count);
+		for (i = 0; i < count; i++) {
+			if (pjs[i] == NULL)
+				continue;
+			/* the rolled back insert must be written in full again */
+			pjs[i]->ji_newjob = 1;
+			unsave_attr_db(pjs[i]->ji_wattr, (int)JOB_ATR_LAST);
+			commit_one(batch[i], pjs[i]);
+		}
+		return;
+	}
+
+	acct_hold(1);
+	for (i = 0; i < count; i++) {
+		if (pjs[i] != NULL)
+			commit_finish(batch[i], pjs[i]);
+	}
+	acct_hold(0);
+	if (count > 1)
+		log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
+			__func__, "saved %d committed jobs together", count);
+}
+#endif	/* PBS_MOM */
+
+#ifndef PBS_MOM
+/**
+ * @brief
+ * 		Service the Submit Jobs Request, used by pbs_submit_many() to queue a
+ * 		batch of jobs in one round trip.
+ *
+ * @par	Functionality:
+ *		Each job is handed to req_quejob(), req_jobscript() and req_commit()
+ *		as child requests, so permissions, limits, hooks and logging are
+ *		exactly those of a job submitted on its own.  The server replies to
+ *		these synchronously, so reply_send() has recorded each step's result
+ *		(and the new job id) in the job's slot of this request's reply
+ *		before the next step is taken.  A job that fails after it was queued
+ *		is purged at once, so the next job's script cannot be attached to it.
+ *
+ * @param[in] preq - pointer to batch request from client
+ */
+void
+req_submitjobs(struct batch_request *preq)
+{
+	int i;
+	int count = preq->rq_ind.rq_submitjobs.count;
+	struct rq_submitjobs_entry *pent = preq->rq_ind.rq_submitjobs.rq_list;
+	job_err_info *pje;
+	struct batch_request *npreq;
+	job *pj;
+
+	pje = calloc(sizeof(job_err_info), count > 0 ? count : 1);
+	if (pje == NULL) {
+		req_reject(PBSE_SYSTEM, 0, preq);
+		return;
+	}
+	preq->rq_reply.brp_choice = BATCH_REPLY_CHOICE_JobErrs;
+	preq->rq_reply.brp_un.brp_job_errs.pje_list = pje;
+	preq->rq_reply.brp_un.brp_job_errs.count = count;
+
+	/* hold a reference so a child finishing early can't send the reply */
+	++preq->rq_refct;
+
+	for (i = 0; i < count; i++) {
+		/* each child overwrites this with its own result */
+		pje[i].errcode = PBSE_SYSTEM;
+		npreq = alloc_job_child_br(preq, PBS_BATCH_QueueJob, &pje[i]);
+		if (npreq == NULL)
+			continue;
+		strcpy(npreq->rq_ind.rq_queuejob.rq_destin, pent[i].rq_destin);
+		/* the child owns the attributes from here on, see free_br() */
+		list_move(&pent[i].rq_attr, &npreq->rq_ind.rq_queuejob.rq_attr);
+		req_quejob(npreq);
+
+		if ((pje[i].errcode == PBSE_NONE) && (pent[i].rq_script != NULL)) {
+			pje[i].errcode = PBSE_SYSTEM;
+			npreq = alloc_job_child_br(preq, PBS_BATCH_jobscript, &pje[i]);
+			if (npreq != NULL) {
+				npreq->rq_ind.rq_jobfile.rq_sequence = 0;
+				npreq->rq_ind.rq_jobfile.rq_type = JScript;
+				npreq->rq_ind.rq_jobfile.rq_size = pent[i].rq_size;
+				strcpy(npreq->rq_ind.rq_jobfile.rq_jobid, pje[i].job_id);
+				npreq->rq_ind.rq_jobfile.rq_data = pent[i].rq_script;
+				pent[i].rq_script = NULL;
+				req_jobscript(npreq);
+			}
+		}
+
+		if (pje[i].errcode == PBSE_NONE) {
+			pje[i].errcode = PBSE_SYSTEM;
+			npreq = alloc_job_child_br(preq, PBS_BATCH_Commit, &pje[i]);
+			if (npreq != NULL) {
+				strcpy(npreq->rq_ind.rq_commit, pje[i].job_id);
+				req_commit(npreq);
+			}
+		}
+
+		if (pje[i].errcode != PBSE_NONE) {
+			pj = locate_new_job(preq, NULL);
+			if (pj != NULL) {
+				delete_link(&pj->ji_alljobs);
+				job_purge(pj);
+			}
+		}
+	}
+
+	if (--preq->rq_refct == 0)
+		reply_send(preq);
+}
+#endif	/* PBS_MOM */
+
+#ifdef PBS_MOM
+/**
+ * @brief
+ * 		Allocate one step of an Exec Job request.  The steps look up the
+ * 		new job by the stream it arrives on, so they are marked as coming
+ * 		over one as the Exec Job did.
+ *
+ * @param[in]	preq	- the Exec Job request
+ * @param[in]	type	- type of the step
+ *
+ * @return	batch_request *
+ * @retval	NULL	- error, recorded in the reply of preq
+ */
+static struct batch_request *
+execjob_child(struct batch_request *preq, int type)
+{
+	struct batch_request *npreq;
+
+	npreq = alloc_job_child_br(preq, type, NULL);
+	if (npreq == NULL) {
+		preq->rq_reply.brp_code = PBSE_SYSTEM;
+		return NULL;
+	}
+	npreq->isrpp = preq->isrpp;
+	return npreq;
+}
+
+/**
+ * @brief
+ * 		Service the Exec Job Request, which the server sends in place of
+ * 		Queue Job, Job Script, Job Credential and Commit to start a small
+ * 		job in one message, see send_job_exec().
+ *
+ * @par	Functionality:
+ *		Each step is handed to its usual handler as a child request, so the
+ *		job is set up exactly as if the requests had come one by one.  On a
+ *		stream only a failure is replied to, and reply_send() records it in
+ *		this request, so a step is only taken while that is still clear.
+ *		The hold on this request is dropped just before the Commit, so the
+ *		single reply goes out from req_commit(), before the job is started.
+ *
+ * @param[in] preq - pointer to batch request from the server
+ */
+void
+req_execjob(struct batch_request *preq)
+{
+	struct rq_execjob	*pej = &preq->rq_ind.rq_execjob;
+	struct batch_request	*npreq;
+	job			*pj;
+
+	/* hold a reference so a child finishing early can't send the reply */
+	++preq->rq_refct;
+
+	npreq = execjob_child(preq, PBS_BATCH_QueueJob);
+	if (npreq != NULL) {
+		strcpy(npreq->rq_ind.rq_queuejob.rq_jid, pej->rq_job.rq_jid);
+		strcpy(npreq->rq_ind.rq_queuejob.rq_destin, pej->rq_job.rq_destin);
+		/* the child owns the attributes from here on, see free_br() */
+		list_move(&pej->rq_job.rq_attr, &npreq->rq_ind.rq_queuejob.rq_attr);
+		req_quejob(npreq);
+	}
+
+	/* the script and credential stay with this request, see free_br() */
+	if ((preq->rq_reply.brp_code == PBSE_NONE) && (pej->rq_size > 0)) {
+		npreq = execjob_child(preq, PBS_BATCH_jobscript);
+		if (npreq != NULL) {
+			npreq->rq_ind.rq_jobfile.rq_sequence = 0;
+			npreq->rq_ind.rq_jobfile.rq_type = JScript;
+			npreq->rq_ind.rq_jobfile.rq_size = pej->rq_size;
+			strcpy(npreq->rq_ind.rq_jobfile.rq_jobid, pej->rq_job.rq_jid);
+			npreq->rq_ind.rq_jobfile.rq_data = pej->rq_script;
+			req_jobscript(npreq);
+		}
+	}
+
+	if ((preq->rq_reply.brp_code == PBSE_NONE) && (pej->rq_credsize > 0)) {
+		npreq = execjob_child(preq, PBS_BATCH_JobCred);
+		if (npreq != NULL) {
+			npreq->rq_ind.rq_jobcred.rq_type = pej->rq_credtype;
+			npreq->rq_ind.rq_jobcred.rq_size = pej->rq_credsize;
+			npreq->rq_ind.rq_jobcred.rq_data = pej->rq_cred;
+			req_jobcredential(npreq);
+		}
+	}
+
+	if (preq->rq_reply.brp_code == PBSE_NONE) {
+		npreq = execjob_child(preq, PBS_BATCH_Commit);
+		if (npreq != NULL) {
+			strcpy(npreq->rq_ind.rq_commit, pej->rq_job.rq_jid);
+			--preq->rq_refct;
+			req_commit(npreq);
+			return;
+		}
+	}
+
+	pj = locate_new_job(preq, pej->rq_job.rq_jid);
+	if (pj != NULL) {
+		delete_link(&pj->ji_alljobs);
+		job_purge(pj);
+	}
+
+	if (--preq->rq_refct == 0)
+		reply_send(preq);
+}
+#endif	/* PBS_MOM */
+
 /**
  * @brief
  * 		locate_new_job - locate a "new" job which has been set up req_quejob on
@@ -2768,6 +3112,7 @@ req_resvSub(struct batch_request *preq)
 	 * is available for consideration
 	 */
 	append_link(&svr_allresvs, &presv->ri_allresvs, presv);
+	svr_name_idx_oper(&resvs_idx, presv->ri_qs.ri_resvID, presv, NAME_IDX_OP_ADD);
 	if (!is_maintenance)
 		set_scheduler_flag(SCH_SCHEDULE_NEW, dflt_scheduler);
 }
@@ -2865,7 +3210,7 @@ get_queue_for_reservation(resc_resv *presv)
 			&presv->ri_wattr[RESV_ATR_resource],
 			prdef);
 		if (dont_set_in_max[i].ds_rescp)
-			delete_link(&dont_set_in_max[i].ds_rescp->rs_link);
+			unlink_resource_entry(pattr, dont_set_in_max[i].ds_rescp);
 	}
 
 
@@ -2879,10 +3224,7 @@ get_queue_for_reservation(resc_resv *presv)
 
 	for (i=0; i<j; ++i) {
 		if (dont_set_in_max[i].ds_rescp)
-			append_link(
-				&presv->ri_wattr[RESV_ATR_resource].at_val.at_list,
-				&dont_set_in_max[i].ds_rescp->rs_link,
-				dont_set_in_max[i].ds_rescp);
+			link_resource_entry(pattr, dont_set_in_max[i].ds_rescp);
 
 	}
 	if (rc < 0) {
@@ -332,6 +332,8 @@ remove_node_from_resv(resc_resv *presv, struct pbsnode *pnode)
 			else
 				prev->next = rinfp->next;
 			free(rinfp);
+			/* the resv attribute is encoded from nd_resvp */
+			pnode->nd_attr[(int)ND_ATR_resvs].at_flags |= ATR_VFLAG_MODCACHE;
 			break;
 		}
 	}
@@ -477,6 +479,9 @@ assign_resv_resc(resc_resv *presv, char *vnodes, int svr_init)
 			node_str);
 
 		presv->ri_modified = 1;
+
+		/* keep the vnode index of all occurrences in step with the sequence */
+		index_resv_seq_vnodes(presv);
 	}
 
 	return (ret);
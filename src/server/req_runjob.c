@@ -45,6 +45,7 @@
  *	check_and_provision_job()
  *	clear_from_defr()
  *	req_runjob()
+ *	req_runjobs()
  *	req_runjob2()
  *	clear_exec_on_run_fail()
  *	req_stagein()
@@ -630,6 +631,56 @@ req_runjob(struct batch_request *preq)
 		reply_send(preq);
 	return;
 }
+
+/**
+ * @brief
+ * 		req_runjobs - service the Async Run Jobs Request
+ * @par
+ *		Each job in the request is run as if it came in its own Async Run
+ *		Job request.  The reply carries the result of every job.
+ *
+ * @param[in]	preq	-	Run Jobs Request
+ */
+
+void
+req_runjobs(struct batch_request *preq)
+{
+	int i;
+	int count = preq->rq_ind.rq_runjobs.count;
+	struct rq_runjob *prun = preq->rq_ind.rq_runjobs.rq_list;
+	job_err_info *pje;
+	struct batch_request *npreq;
+
+	pje = calloc(sizeof(job_err_info), count > 0 ? count : 1);
+	if (pje == NULL) {
+		req_reject(PBSE_SYSTEM, 0, preq);
+		return;
+	}
+	preq->rq_reply.brp_choice = BATCH_REPLY_CHOICE_JobErrs;
+	preq->rq_reply.brp_un.brp_job_errs.pje_list = pje;
+	preq->rq_reply.brp_un.brp_job_errs.count = count;
+
+	/* hold a reference so a child finishing early can't send the reply */
+	++preq->rq_refct;
+
+	for (i = 0; i < count; i++) {
+		strcpy(pje[i].job_id, prun[i].rq_jid);
+
+		npreq = alloc_job_child_br(preq, PBS_BATCH_AsyrunJob, &pje[i]);
+		if (npreq == NULL) {
+			pje[i].errcode = PBSE_SYSTEM;
+			continue;
+		}
+		npreq->rq_ind.rq_run = prun[i];
+		/* the child owns the destination from here on, see free_br() */
+		prun[i].rq_destin = NULL;
+
+		req_runjob(npreq);
+	}
+
+	if (--preq->rq_refct == 0)
+		reply_send(preq);
+}
 /**
  * @brief
  * 		req_runjob - service the Run Job and Asyc Run Job Requests
@@ -646,6 +697,8 @@ req_runjob2(struct batch_request *preq, job *pjob)
 	char		 *dest;
 	int		 rq_type = 0;
 
+	job_stage_mark(pjob, JOB_STAGE_RUNREQ);
+
 	/* Check if prov is required, if so, reply_ack and let prov finish */
 	/* else follow normal flow */
 	prov_rc = check_and_provision_job(preq, pjob, &need_prov);
@@ -1094,6 +1147,7 @@ svr_strtjob2(job *pjob, struct batch_request *preq)
 		(void)svr_setjobstate(pjob, JOB_STATE_RUNNING,
 			JOB_SUBSTATE_PRERUN);
 
+	job_stage_mark(pjob, JOB_STAGE_SENT);
 
 	if (send_job(pjob, pjob->ji_qs.ji_un.ji_exect.ji_momaddr,
 		pjob->ji_qs.ji_un.ji_exect.ji_momport, MOVE_TYPE_Exec,
@@ -1155,6 +1209,8 @@ complete_running(job *jobp)
 	if (jobp->ji_qs.ji_stime != 0)
 		return;		/* already called for this incarnation */
 
+	job_stage_mark(jobp, JOB_STAGE_STARTED);
+
 	/**
 	 *	For a subjob, insure the parent array's state is set to 'B'
 	 *	and deal with any dependency on the parent.
@@ -56,6 +56,11 @@
  * 	build_selentry()
  * 	build_selist()
  * 	select_subjob()
+ * 	select_index()
+ * 	stat_filter_build()
+ * 	stat_filter_job()
+ * 	stat_filter_subjob()
+ * 	stat_filter_free()
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
@@ -102,6 +107,7 @@ static void free_sellist(struct select_list *pslist);
 static int  sel_attr(attribute *, struct select_list *);
 static int  select_job(job *, struct select_list *, int, int);
 static int  select_subjob(int, struct select_list *);
+static job *select_index(struct select_list *, pbs_queue *, int, int, enum job_list *);
 
 
 /**
@@ -334,6 +340,7 @@ req_selectjobs(struct batch_request *preq)
 	int		    rc;
 	struct select_list *selistp;
 	pbs_sched	   *psched;
+	enum job_list	    which;
 
 	/*
 	 * if the letter T (or t) is in the extend string,  select subjobs
@@ -396,13 +403,12 @@ req_selectjobs(struct batch_request *preq)
 
 	/* now start checking for jobs that match the selection criteria */
 
-	if (pque)
-		pjob = (job *)GET_NEXT(pque->qu_jobs);
-	else
-		pjob = (job *)GET_NEXT(svr_alljobs);
+	pjob = select_index(selistp, pque, dosubjobs, dohistjobs, &which);
 	while (pjob) {
-		if (server.sv_attr[(int)SRV_ATR_query_others].at_val.at_long ||
-			(svr_authorize_jobreq(preq, pjob) == 0)) {
+		/* the owner's jobs can be in other queues */
+		if (((pque == NULL) || (pjob->ji_qhdr == pque)) &&
+			(server.sv_attr[(int)SRV_ATR_query_others].at_val.at_long ||
+			(svr_authorize_jobreq(preq, pjob) == 0))) {
 
 			/* either job owner or has special permission to see job */
 
@@ -447,10 +453,7 @@ req_selectjobs(struct batch_request *preq)
 				}
 			}
 		}
-		if (pque)
-			pjob = (job *)GET_NEXT(pjob->ji_jobque);
-		else
-			pjob = (job *)GET_NEXT(pjob->ji_alljobs);
+		pjob = next_job_in_list(pjob, which);
 	}
 out:
 	free_sellist(selistp);
@@ -460,6 +463,98 @@ out:
 		(void)reply_send(preq);
 }
 
+/**
+ * @brief
+ * 		select_index - pick the shortest list of jobs holding every job that
+ *		can match the selection: the server's or queue's jobs, the jobs in the
+ *		one state selected or the jobs of the one owner selected.  Without
+ *		history jobs, the server's or queue's jobs not history are used
+ *		instead of all of them.  Each job of the list is still checked by
+ *		select_job().
+ * @par
+ *		The state is not used when selecting subjobs, an Array Job matches
+ *		on the state of its subjobs then.
+ *
+ * @param[in]	psel	-	selection list
+ * @param[in]	pque	-	queue selected, NULL for all jobs
+ * @param[in]	dosubjobs	-	subjobs are selected too
+ * @param[in]	dohistjobs	-	history jobs are selected too
+ * @param[out]	which	-	the list picked, for next_job_in_list()
+ *
+ * @return	job *
+ * @retval	first job of the list
+ * @retval	NULL	: no job can match
+ */
+static job *
+select_index(struct select_list *psel, pbs_queue *pque, int dosubjobs, int dohistjobs, enum job_list *which)
+{
+	pbs_list_head *phead;
+	pbs_list_head *pownh;
+	char	      *pc;
+	char	      *owner = NULL;
+	char	       user[PBS_MAXUSER + 1];
+	int	       state = -1;
+	int	       ct;
+	int	       oct;
+
+	for (; psel; psel = psel->sl_next) {
+		if ((psel->sl_atindx == (int)JOB_ATR_state) && (psel->sl_op == EQ) &&
+			(dosubjobs == 0)) {
+			pc = psel->sl_attr.at_val.at_str;
+			if ((pc != NULL) && (pc[0] != '\0') && (pc[1] == '\0') &&
+				((pc = strchr(statechars, (int)pc[0])) != NULL))
+				state = pc - statechars;
+		} else if ((psel->sl_atindx == (int)JOB_ATR_userlst) &&
+			(psel->sl_attr.at_val.at_arst != NULL) &&
+			(psel->sl_attr.at_val.at_arst->as_usedptr == 1)) {
+			owner = psel->sl_attr.at_val.at_arst->as_string[0];
+		}
+	}
+
+	if (pque) {
+		*which = JOB_LIST_QUEUE;
+		phead = &pque->qu_jobs;
+		ct = pque->qu_numjobs;
+		if (!dohistjobs) {
+			*which = JOB_LIST_QUEUE_ACTIVE;
+			phead = &pque->qu_actjobs;
+			ct -= pque->qu_njstate[JOB_STATE_FINISHED] +
+				pque->qu_njstate[JOB_STATE_MOVED];
+		}
+		if ((state >= 0) && (pque->qu_njstate[state] < ct)) {
+			*which = JOB_LIST_QUEUE_STATE;
+			phead = &pque->qu_jobs_bystate[state];
+			ct = pque->qu_njstate[state];
+		}
+	} else {
+		*which = JOB_LIST_ALL;
+		phead = &svr_alljobs;
+		ct = server.sv_qs.sv_numjobs;
+		if (!dohistjobs) {
+			*which = JOB_LIST_ACTIVE;
+			phead = &svr_actjobs;
+			ct -= server.sv_jobstates[JOB_STATE_FINISHED] +
+				server.sv_jobstates[JOB_STATE_MOVED];
+		}
+		if ((state >= 0) && (server.sv_jobstates[state] < ct)) {
+			*which = JOB_LIST_STATE;
+			phead = &svr_jobs_bystate[state];
+			ct = server.sv_jobstates[state];
+		}
+	}
+
+	if (owner != NULL) {
+		get_jobowner(owner, user);
+		if ((pownh = find_owner_jobs(user, &oct)) == NULL)
+			return (NULL);	/* the owner has no jobs */
+		if (oct < ct) {
+			*which = JOB_LIST_OWNER;
+			phead = pownh;
+		}
+	}
+	return ((job *)GET_NEXT(*phead));
+}
+
 /**
  * @brief
  * 		select_job - determine if a single job matches the selection criteria
@@ -843,3 +938,119 @@ select_subjob(int state, struct select_list *psel)
 	}
 	return (1);
 }
+
+/**
+ * @brief
+ * 		stat_filter_build - take the comparisons (EQ, NE, GE, GT, LE or LT)
+ *		out of the attribute list of a Status Job request and build the
+ *		criteria the jobs must meet to be statused, as those of a
+ *		Select-Status request.  What is left of the list are the
+ *		attributes to return.
+ *
+ * @param[in,out]	preq	-	the Status Job request
+ * @param[out]	bad	-	index of the bad criterion in rq_filtattr
+ *
+ * @return	int
+ * @retval	PBSE_NONE	: success, also without criteria
+ * @retval	!0	: error code, as for a Select-Status request
+ */
+int
+stat_filter_build(struct batch_request *preq, int *bad)
+{
+	struct rq_status *prs = &preq->rq_ind.rq_status;
+	svrattrl	 *pal;
+	svrattrl	 *next;
+	char		 *pstate = NULL;
+
+	*bad = 0;
+	for (pal = (svrattrl *)GET_NEXT(prs->rq_attr); pal; pal = next) {
+		next = (svrattrl *)GET_NEXT(pal->al_link);
+		if ((pal->al_op < EQ) || (pal->al_op > LT))
+			continue;
+		delete_link(&pal->al_link);
+		append_link(&prs->rq_filtattr, &pal->al_link, pal);
+	}
+
+	pal = (svrattrl *)GET_NEXT(prs->rq_filtattr);
+	if (pal == NULL)
+		return (PBSE_NONE);
+
+	return (build_selist(pal, preq->rq_perm, &prs->rq_filter,
+		&prs->rq_filter_que, bad, &pstate));
+}
+
+/**
+ * @brief
+ * 		stat_filter_job - does a job meet the criteria of a Status Job
+ *		request?  Any other request statuses every job.
+ *
+ * @param[in]	preq	-	the status request
+ * @param[in]	pjob	-	the job, regular, Array or a subjob with a job
+ *				structure
+ *
+ * @return	int
+ * @retval	1	: the job is to be statused
+ * @retval	0	: it is not
+ */
+int
+stat_filter_job(struct batch_request *preq, job *pjob)
+{
+	struct rq_status *prs = &preq->rq_ind.rq_status;
+
+	if (preq->rq_type != PBS_BATCH_StatusJob)
+		return (1);
+	if ((prs->rq_filter_que != NULL) && (pjob->ji_qhdr != prs->rq_filter_que))
+		return (0);
+	if (prs->rq_filter == NULL)
+		return (1);
+
+	/* a subjob is only looked at as a subjob */
+	return (select_job(pjob, prs->rq_filter,
+		(pjob->ji_qs.ji_svrflags & JOB_SVFLG_SubJob) ? 2 : 0, 1));
+}
+
+/**
+ * @brief
+ * 		stat_filter_subjob - does a subjob without a job structure meet the
+ *		criteria of a Status Job request?  It is compared on its state and
+ *		on the other attributes of its parent.
+ *
+ * @param[in]	preq	-	the status request
+ * @param[in]	parent	-	the Array Job
+ * @param[in]	state	-	state of the subjob
+ *
+ * @return	int
+ * @retval	1	: the subjob is to be statused
+ * @retval	0	: it is not
+ */
+int
+stat_filter_subjob(struct batch_request *preq, job *parent, int state)
+{
+	struct rq_status *prs = &preq->rq_ind.rq_status;
+
+	if (preq->rq_type != PBS_BATCH_StatusJob)
+		return (1);
+	if ((prs->rq_filter_que != NULL) && (parent->ji_qhdr != prs->rq_filter_que))
+		return (0);
+	if (prs->rq_filter == NULL)
+		return (1);
+
+	return (select_job(parent, prs->rq_filter, 1, 1) &&
+		select_subjob(state, prs->rq_filter));
+}
+
+/**
+ * @brief
+ * 		stat_filter_free - free the criteria built by stat_filter_build()
+ *
+ * @param[in,out]	preq	-	the Status Job request
+ *
+ * @return	void
+ */
+void
+stat_filter_free(struct batch_request *preq)
+{
+	free_sellist(preq->rq_ind.rq_status.rq_filter);
+	preq->rq_ind.rq_status.rq_filter = NULL;
+	preq->rq_ind.rq_status.rq_filter_que = NULL;
+}
@@ -682,7 +682,7 @@ void set_admin_suspend(job *pjob, int set_remove_nstate) {
 					if (pnode->nd_attr[(int)ND_ATR_MaintJobs].at_val.at_arst->as_usedptr == 0)
 						set_vnode_state(pnode, ~INUSE_MAINTENANCE, Nd_State_And);
 				}
-				pnode->nd_modified |= NODE_UPDATE_OTHERS; /* force save of attributes */
+				node_mark_modified(pnode, NODE_UPDATE_OTHERS); /* force save of attributes */
 			}
 		}
 		chunk = parse_plus_spec_r(last, &last, &hasprn);
@@ -58,6 +58,19 @@
  * 	status_resv()
  * 	status_resc()
  * 	req_stat_resc()
+ * 	get_changed_since()
+ * 	add_mod_seq()
+ * 	status_deleted()
+ * 	status_all_deleted()
+ * 	subjob_mod_seq()
+ * 	get_stat_page()
+ * 	next_stat_job()
+ * 	add_stat_cursor()
+ * 	find_extend_token()
+ * 	in_stat_partition()
+ * 	stat_cache_key()
+ * 	stat_cache_reply()
+ * 	stat_cache_save()
  *
  */
 #include <pbs_config.h>   /* the master config generated by configure */
@@ -69,6 +82,7 @@
 #include <stdlib.h>
 #include "libpbs.h"
 #include <ctype.h>
+#include "dis.h"
 #include "server_limits.h"
 #include "list_link.h"
 #include "attribute.h"
@@ -87,6 +101,8 @@
 #include "pbs_license.h"
 #include "resource.h"
 #include "pbs_sched.h"
+#include "libutil.h"
+#include "log.h"
 
 
 /* Global Data Items: */
@@ -102,6 +118,7 @@ extern time_t	     time_now;
 extern char	    *msg_init_norerun;
 extern int resc_access_perm;
 extern long svr_history_enable;
+extern int pbs_tcp_errno;
 
 /* Extern Functions */
 
@@ -117,11 +134,535 @@ extern int svr_chk_histjob(job *);
 
 static int bad;
 
+/*
+ * The encoded replies kept for PBS_SERVER_STAT_CACHE_TTL seconds, see
+ * stat_cache_reply().  A key holds everything the reply depends on
+ * besides the state of the objects.
+ */
+#define STAT_CACHE_MAX	16
+
+struct stat_cache_ent {
+	char	*sc_key;	/* see stat_cache_key(), NULL if unused */
+	time_t	 sc_time;	/* when the reply was built */
+	char	*sc_data;	/* the encoded reply */
+	size_t	 sc_len;
+};
+static struct stat_cache_ent stat_cache[STAT_CACHE_MAX];
+
 /* The following private support functions are included */
 
-static int status_que(pbs_queue *, struct batch_request *, pbs_list_head *);
-static int status_node(struct pbsnode *, struct batch_request *, pbs_list_head *);
-static int status_resv(resc_resv *, struct batch_request *, pbs_list_head *);
+static int status_que(pbs_queue *, struct batch_request *, pbs_list_head *, long long);
+static int status_node(struct pbsnode *, struct batch_request *, pbs_list_head *, long long);
+static int status_resv(resc_resv *, struct batch_request *, pbs_list_head *, long long);
+static int get_changed_since(struct batch_request *, long long *);
+static int add_mod_seq(pbs_list_head *, void *, long long);
+static int status_deleted(int, char *, long long, pbs_list_head *);
+static int status_all_deleted(int, long long, pbs_list_head *);
+static long long subjob_mod_seq(job *, int);
+static int get_stat_page(struct batch_request *, int *, unsigned long *, int *);
+static job *next_stat_job(job *, enum job_list);
+static int add_stat_cursor(pbs_list_head *, unsigned long, int);
+static char *find_extend_token(char *, int);
+static int in_stat_partition(struct batch_request *, attribute *);
+static char *stat_cache_key(struct batch_request *);
+static int stat_cache_reply(struct batch_request *);
+
+/**
+ * @brief
+ * 		find_extend_token - find a token in a status request's extend string.
+ *		The EXTEND_PARTITION token is always last and the partition names
+ *		following it are not searched.
+ *
+ * @param[in]	extend	-	the extend string, may be NULL
+ * @param[in]	tok	-	the token character
+ *
+ * @return	char *
+ * @retval	pointer to the token in extend
+ * @retval	NULL	: the token is not present
+ */
+static char *
+find_extend_token(char *extend, int tok)
+{
+	char	*pc;
+	char	*part;
+
+	if ((extend == NULL) || ((pc = strchr(extend, tok)) == NULL))
+		return (NULL);
+	if (tok == EXTEND_PARTITION)
+		return (pc);
+	part = strchr(extend, EXTEND_PARTITION);
+	if ((part != NULL) && (part < pc))
+		return (NULL);
+	return (pc);
+}
+
+/**
+ * @brief
+ * 		in_stat_partition - check an object's partition attribute against the
+ *		EXTEND_PARTITION list of a status request.
+ *
+ * @param[in]	preq	-	the status request
+ * @param[in]	pattr	-	partition attribute of the vnode or queue
+ *
+ * @return	int
+ * @retval	1	: the request has no partition list or the object's partition
+ *			  is in it, or the object has none and the list is empty
+ * @retval	0	: the object is not to be statused
+ */
+static int
+in_stat_partition(struct batch_request *preq, attribute *pattr)
+{
+	char	*list;
+	char	*part;
+	size_t	 len;
+
+	if ((list = find_extend_token(preq->rq_extend, EXTEND_PARTITION)) == NULL)
+		return (1);
+	list++;
+	if (((pattr->at_flags & ATR_VFLAG_SET) == 0) ||
+		(pattr->at_val.at_str == NULL) || (*pattr->at_val.at_str == '\0'))
+		return (*list == '\0');
+
+	part = pattr->at_val.at_str;
+	len = strlen(part);
+	while (*list != '\0') {
+		if ((strncmp(list, part, len) == 0) &&
+			((list[len] == ',') || (list[len] == '\0')))
+			return (1);
+		if ((list = strchr(list, ',')) == NULL)
+			break;
+		list++;
+	}
+	return (0);
+}
+
+/**
+ * @brief
+ * 		stat_cache_key - make the key a status request's reply is kept
+ *		under.  Besides the type, object id, attribute list and extend
+ *		string of the request, the reply depends on the access of the
+ *		client, the wire format of its connection and, for a client
+ *		without manager or operator read access, which user it is.
+ *
+ * @param[in]	preq	-	the status request
+ *
+ * @return	char *
+ * @retval	the key, to be freed by the caller
+ * @retval	NULL	: out of memory
+ */
+static char *
+stat_cache_key(struct batch_request *preq)
+{
+	char	*key = NULL;
+	int	 size = 0;
+	char	 buf[PBS_MAXUSER + PBS_MAXHOSTNAME + 64];
+	svrattrl *pal;
+
+	snprintf(buf, sizeof(buf), "%d %d %d %d\n", preq->rq_type, preq->rq_perm,
+		preq->rq_fromsvr, dis_getfmt ? dis_getfmt(preq->rq_conn) : DIS_FMT_ASCII);
+	if (pbs_strcat(&key, &size, buf) == NULL)
+		return NULL;
+	if ((preq->rq_perm & (ATR_DFLAG_MGRD | ATR_DFLAG_OPRD)) == 0) {
+		snprintf(buf, sizeof(buf), "%s@%s\n", preq->rq_user, preq->rq_host);
+		if (pbs_strcat(&key, &size, buf) == NULL)
+			goto err;
+	}
+	if ((pbs_strcat(&key, &size, preq->rq_ind.rq_status.rq_id) == NULL) ||
+		(pbs_strcat(&key, &size, "\n") == NULL) ||
+		(pbs_strcat(&key, &size, preq->rq_extend) == NULL))
+		goto err;
+	for (pal = (svrattrl *)GET_NEXT(preq->rq_ind.rq_status.rq_attr); pal;
+		pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+		if ((pbs_strcat(&key, &size, "\n") == NULL) ||
+			(pbs_strcat(&key, &size, pal->al_name) == NULL))
+			goto err;
+		if ((pal->al_resc != NULL) &&
+			((pbs_strcat(&key, &size, ".") == NULL) ||
+			(pbs_strcat(&key, &size, pal->al_resc) == NULL)))
+			goto err;
+		/* a criterion of a Status Job request, see stat_filter_build() */
+		if ((pal->al_op >= EQ) && (pal->al_op <= LT)) {
+			snprintf(buf, sizeof(buf), " %d ", (int)pal->al_op);
+			if ((pbs_strcat(&key, &size, buf) == NULL) ||
+				(pbs_strcat(&key, &size, pal->al_value) == NULL))
+				goto err;
+		}
+	}
+	return key;
+
+err:
+	free(key);
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		stat_cache_reply - answer a status request with the reply kept for
+ *		an identical request less than PBS_SERVER_STAT_CACHE_TTL seconds
+ *		ago.  The reply is written as it was encoded then, so none of the
+ *		objects is walked again.  Without one, the request is marked so
+ *		that stat_cache_save() keeps its reply when it is sent.
+ *
+ * @param[in,out]	preq	-	the status request, freed if answered
+ *
+ * @return	int
+ * @retval	1	: the request was answered
+ * @retval	0	: the request is to be processed
+ */
+static int
+stat_cache_reply(struct batch_request *preq)
+{
+	int	 i;
+	int	 sfds = preq->rq_conn;
+	char	*key;
+	struct stat_cache_ent *pent = NULL;
+	time_t	 ttl = (time_t)pbs_conf.pbs_server_stat_cache_ttl;
+
+	if ((ttl == 0) || (sfds < 0) || preq->isrpp || (preq->rq_parentbr != NULL))
+		return 0;
+
+	/* sets dis_getfmt up for the connection */
+	DIS_tcp_setup(sfds);
+	if ((key = stat_cache_key(preq)) == NULL)
+		return 0;
+
+	for (i = 0; i < STAT_CACHE_MAX; i++) {
+		if (stat_cache[i].sc_key == NULL)
+			continue;
+		if ((time_now - stat_cache[i].sc_time) >= ttl) {
+			free(stat_cache[i].sc_key);
+			free(stat_cache[i].sc_data);
+			stat_cache[i].sc_key = NULL;
+			stat_cache[i].sc_data = NULL;
+		} else if (strcmp(stat_cache[i].sc_key, key) == 0)
+			pent = &stat_cache[i];
+	}
+	if (pent == NULL) {
+		preq->rq_statkey = key;
+		return 0;
+	}
+	free(key);
+
+	if ((dis_puts(sfds, pent->sc_data, pent->sc_len) != (int)pent->sc_len) ||
+		(disw_commit(sfds, 1) != 0) ||
+		(DIS_wflush(sfds, 0) != 0)) {
+		log_eventf(PBSEVENT_SYSTEM, PBS_EVENTCLASS_REQUEST, LOG_WARNING,
+			__func__, "status reply failure to %s@%s, errno=%d",
+			preq->rq_user, preq->rq_host, pbs_tcp_errno);
+		close_client(sfds);
+	} else
+		pipeline_reply_sent(sfds);
+	free_br(preq);
+	return 1;
+}
+
+/**
+ * @brief
+ * 		stat_cache_save - keep the encoded reply of a status request marked
+ *		by stat_cache_reply(), in place of the oldest reply kept if all
+ *		the slots are in use.  A reply with an error is not kept.
+ *
+ * @param[in,out]	preq	-	the status request, gives up its key
+ * @param[in]	data	-	the encoded reply
+ * @param[in]	len	-	its length
+ *
+ * @return	void
+ */
+void
+stat_cache_save(struct batch_request *preq, char *data, size_t len)
+{
+	int	 i;
+	char	*copy;
+	struct stat_cache_ent *pent = NULL;
+
+	if ((preq->rq_statkey == NULL) || (preq->rq_reply.brp_code != 0) ||
+		(preq->rq_reply.brp_choice != BATCH_REPLY_CHOICE_Status) || (len == 0))
+		return;
+	if ((copy = malloc(len)) == NULL)
+		return;
+	memcpy(copy, data, len);
+
+	for (i = 0; i < STAT_CACHE_MAX; i++) {
+		if (stat_cache[i].sc_key == NULL) {
+			pent = &stat_cache[i];
+			break;
+		}
+		if ((pent == NULL) || (stat_cache[i].sc_time < pent->sc_time))
+			pent = &stat_cache[i];
+	}
+	free(pent->sc_key);
+	free(pent->sc_data);
+	pent->sc_key = preq->rq_statkey;
+	preq->rq_statkey = NULL;
+	pent->sc_time = time_now;
+	pent->sc_data = copy;
+	pent->sc_len = len;
+}
+
+/**
+ * @brief
+ * 		get_changed_since - get the modification sequence from the
+ *		EXTEND_CHANGED_SINCE token of a status request's extend string.
+ *
+ * @param[in]	preq	-	the status request
+ * @param[out]	since	-	the sequence, -1 if the request wants everything,
+ *				0 for everything with its sequence
+ *
+ * @return	int
+ * @retval	PBSE_NONE	: no error
+ * @retval	PBSE_IVALREQ	: the token is not followed by a number
+ * @retval	PBSE_MOD_SEQ_STALE	: the sequence predates the deletes still
+ *					  remembered, or a restart of the server
+ */
+static int
+get_changed_since(struct batch_request *preq, long long *since)
+{
+	char	*pc;
+	char	*endp;
+
+	*since = -1;
+	if ((pc = find_extend_token(preq->rq_extend, EXTEND_CHANGED_SINCE)) == NULL)
+		return (PBSE_NONE);
+
+	pc++;
+	if (!isdigit((int)*pc))
+		return (PBSE_IVALREQ);
+	*since = strtoll(pc, &endp, 10);
+	if ((*since > 0) && (*since < svr_mod_seq_floor))
+		return (PBSE_MOD_SEQ_STALE);
+	return (PBSE_NONE);
+}
+
+/**
+ * @brief
+ * 		add_mod_seq - add ATTR_mod_seq to the status just appended to a
+ *		status reply.
+ *
+ * @param[in,out]	pstathd	-	head of the status list
+ * @param[in]	last	-	the last status of the list before the object was
+ *				statused, nothing is added if no status followed it
+ * @param[in]	seq	-	modification sequence of the object
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: out of memory
+ */
+static int
+add_mod_seq(pbs_list_head *pstathd, void *last, long long seq)
+{
+	struct brp_status *pstat;
+	attribute	   attr;
+
+	pstat = (struct brp_status *)GET_PRIOR(*pstathd);
+	if ((pstat == NULL) || (pstat == last))
+		return (0);
+
+	attr.at_val.at_ll = seq;
+	attr.at_flags = ATR_VFLAG_SET;
+	if (encode_ll(&attr, &pstat->brp_attr, ATTR_mod_seq, NULL, 0, NULL) == -1)
+		return (PBSE_SYSTEM);
+	return (0);
+}
+
+/**
+ * @brief
+ * 		status_deleted - Build the status reply for a deleted object, which
+ *		has only ATTR_mod_seq and ATTR_mod_deleted.
+ *
+ * @param[in]	objtype	-	MGR_OBJ_* type of the object
+ * @param[in]	name	-	name of the object
+ * @param[in]	seq	-	sequence of the delete
+ * @param[in,out]	pstathd	-	head of list to append status to
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: out of memory
+ */
+static int
+status_deleted(int objtype, char *name, long long seq, pbs_list_head *pstathd)
+{
+	attribute	   attr;
+	struct brp_status *pstat;
+
+	pstat = (struct brp_status *)malloc(sizeof(struct brp_status));
+	if (pstat == NULL)
+		return (PBSE_SYSTEM);
+	pstat->brp_objtype = objtype;
+	(void)strcpy(pstat->brp_objname, name);
+	CLEAR_LINK(pstat->brp_stlink);
+	CLEAR_HEAD(pstat->brp_attr);
+	append_link(pstathd, &pstat->brp_stlink, pstat);
+
+	attr.at_val.at_ll = seq;
+	attr.at_flags = ATR_VFLAG_SET;
+	if (encode_ll(&attr, &pstat->brp_attr, ATTR_mod_seq, NULL, 0, NULL) == -1)
+		return (PBSE_SYSTEM);
+
+	attr.at_val.at_long = 1;
+	attr.at_flags = ATR_VFLAG_SET;
+	if (encode_b(&attr, &pstat->brp_attr, ATTR_mod_deleted, NULL, 0, NULL) == -1)
+		return (PBSE_SYSTEM);
+	return (0);
+}
+
+/**
+ * @brief
+ * 		status_all_deleted - append the status of each object of a type
+ *		deleted after a modification sequence.
+ *
+ * @param[in]	objtype	-	MGR_OBJ_* type of the objects
+ * @param[in]	since	-	the sequence the client last saw
+ * @param[in,out]	pstathd	-	head of list to append status to
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: out of memory
+ */
+static int
+status_all_deleted(int objtype, long long since, pbs_list_head *pstathd)
+{
+	struct mod_seq_deleted *pdel;
+	int			rc;
+
+	if (since == 0)
+		return (0);	/* a client starting over has nothing to delete */
+	for (pdel = (struct mod_seq_deleted *)GET_NEXT(svr_mod_seq_deleted);
+		pdel != NULL;
+		pdel = (struct mod_seq_deleted *)GET_NEXT(pdel->md_link)) {
+		if ((pdel->md_objtype != objtype) || (pdel->md_seq <= since))
+			continue;
+		if ((rc = status_deleted(objtype, pdel->md_name, pdel->md_seq, pstathd)) != 0)
+			return (rc);
+	}
+	return (0);
+}
+
+/**
+ * @brief
+ * 		subjob_mod_seq - the modification sequence of a subjob, which is that
+ *		of its job structure once it has one and that of its parent before.
+ *
+ * @param[in]	pjob	-	the parent Array job
+ * @param[in]	indx	-	offset of the subjob in the parent's tracking table
+ *
+ * @return	long long
+ */
+static long long
+subjob_mod_seq(job *pjob, int indx)
+{
+	job	*psubjob;
+
+	if ((get_subjob_state(pjob, indx) != JOB_STATE_QUEUED) &&
+		(psubjob = pjob->ji_ajtrk->tkm_tbl[indx].trk_psubjob)) {
+		update_job_mod_seq(psubjob);
+		return (psubjob->ji_mod_seq);
+	}
+	update_job_mod_seq(pjob);
+	return (pjob->ji_mod_seq);
+}
+
+/**
+ * @brief
+ * 		get_stat_page - get the page size and the cursor from the EXTEND_PAGE
+ *		token of a status job request's extend string, "P<count>" for the
+ *		first page and "P<count>,<rank>,<n>" for the following ones.
+ * @par
+ *		The cursor is the queue rank of the last job of the previous page and
+ *		how many jobs with that rank it ended with.  Jobs are kept in queue
+ *		rank order, so the next page starts after them even if the job to
+ *		resume from has been deleted since.
+ *
+ * @param[in]	preq	-	the status job request
+ * @param[out]	count	-	jobs per page, 0 if the request is not paged
+ * @param[out]	rank	-	queue rank of the cursor
+ * @param[out]	nrank	-	number of jobs with the cursor rank already returned
+ *
+ * @return	int
+ * @retval	PBSE_NONE	: no error
+ * @retval	PBSE_IVALREQ	: the token is malformed
+ */
+static int
+get_stat_page(struct batch_request *preq, int *count, unsigned long *rank, int *nrank)
+{
+	char	*pc;
+	char	*endp;
+
+	*count = 0;
+	*rank = 0;
+	*nrank = 0;
+	if ((pc = find_extend_token(preq->rq_extend, EXTEND_PAGE)) == NULL)
+		return (PBSE_NONE);
+
+	*count = (int)strtol(pc + 1, &endp, 10);
+	if ((endp == pc + 1) || (*count <= 0))
+		return (PBSE_IVALREQ);
+	if (*endp != ',')
+		return (PBSE_NONE);
+
+	pc = endp + 1;
+	*rank = strtoul(pc, &endp, 10);
+	if ((endp == pc) || (*endp != ','))
+		return (PBSE_IVALREQ);
+	pc = endp + 1;
+	*nrank = (int)strtol(pc, &endp, 10);
+	if ((endp == pc) || (*nrank < 0))
+		return (PBSE_IVALREQ);
+	return (PBSE_NONE);
+}
+
+/**
+ * @brief
+ * 		next_stat_job - the job after pjob in the list of jobs being statused.
+ *
+ * @param[in]	pjob	-	current job
+ * @param[in]	which	-	the queue's or the server's list of all jobs, or
+ *				of the jobs not history
+ *
+ * @return	job *
+ */
+static job *
+next_stat_job(job *pjob, enum job_list which)
+{
+	return (next_job_in_list(pjob, which));
+}
+
+/**
+ * @brief
+ * 		add_stat_cursor - end a page of job status with the cursor of the next
+ *		page, as the ATTR_status_cursor of a status entry for the server.
+ *
+ * @param[in,out]	pstathd	-	head of the status list
+ * @param[in]	rank	-	queue rank of the last job of the page
+ * @param[in]	nrank	-	number of jobs with that rank returned so far
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: out of memory
+ */
+static int
+add_stat_cursor(pbs_list_head *pstathd, unsigned long rank, int nrank)
+{
+	attribute	   attr;
+	struct brp_status *pstat;
+	char		   cursor[PBS_STAT_CURSOR_LEN];
+
+	pstat = (struct brp_status *)malloc(sizeof(struct brp_status));
+	if (pstat == NULL)
+		return (PBSE_SYSTEM);
+	pstat->brp_objtype = MGR_OBJ_SERVER;
+	(void)strcpy(pstat->brp_objname, server_name);
+	CLEAR_LINK(pstat->brp_stlink);
+	CLEAR_HEAD(pstat->brp_attr);
+	append_link(pstathd, &pstat->brp_stlink, pstat);
+
+	snprintf(cursor, sizeof(cursor), "%lu,%d", rank, nrank);
+	attr.at_val.at_str = cursor;
+	attr.at_flags = ATR_VFLAG_SET;
+	if (encode_str(&attr, &pstat->brp_attr, ATTR_status_cursor, NULL, 0, NULL) == -1)
+		return (PBSE_SYSTEM);
+	return (0);
+}
+
 /**
  * @brief
  * 		Support function for req_stat_job() and stat_a_jobidname().
@@ -135,23 +676,34 @@ static int status_resv(resc_resv *, struct batch_request *, pbs_list_head *);
  * @param[in]	pjob	-	pointer to the job to be statused
  * @param[in]	dohistjobs	-	flag to include job if it is a history job
  * @param[in]	dosubjobs	-	flag to expand a Array job to include all subjobs
+ * @param[in]	since	-	only status the job if changed after this
+ *				sequence, -1 to always status it
  *
  * @return	int
  * @retval	PBSE_NONE (0)	: no error
  * @retval	non-zero	: PBS error code to return to client
  */
 static int
-do_stat_of_a_job(struct batch_request *preq, job *pjob, int dohistjobs, int dosubjobs)
+do_stat_of_a_job(struct batch_request *preq, job *pjob, int dohistjobs, int dosubjobs, long long since)
 {
 	int       indx;
 	svrattrl *pal;
 	int       rc;
+	long long seq = -1;
+	void	 *last;
 	struct batch_reply *preply = &preq->rq_reply;
 
 	/* if history job and not asking for them, just return */
 	if ((!dohistjobs) &&
 			((pjob->ji_qs.ji_state == JOB_STATE_FINISHED) ||
 			(pjob->ji_qs.ji_state == JOB_STATE_MOVED))) {
+		/* unless it became history since, then it is gone for the client */
+		if ((since > 0) && ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_SubJob) == 0)) {
+			update_job_mod_seq(pjob);
+			if (pjob->ji_mod_seq > since)
+				return (status_deleted(MGR_OBJ_JOB, pjob->ji_qs.ji_jobid,
+					pjob->ji_mod_seq, &preply->brp_un.brp_status));
+		}
 		return (PBSE_NONE);	/* just return nothing */
 	}
 
@@ -161,12 +713,28 @@ do_stat_of_a_job(struct batch_request *preq, job *pjob, int dohistjobs, int dosu
 
 		pal = (svrattrl *)GET_NEXT(preq->rq_ind.rq_status.rq_attr);
 
-		rc = status_job(pjob, preq, pal, &preply->brp_un.brp_status, &bad);
+		rc = PBSE_NONE;
+		if (since >= 0)
+			update_job_mod_seq(pjob);
+		if ((since < 0) || (pjob->ji_mod_seq > since)) {
+			last = GET_PRIOR(preply->brp_un.brp_status);
+			rc = status_job(pjob, preq, pal, &preply->brp_un.brp_status, &bad);
+			if ((rc == PBSE_NONE) && (since >= 0))
+				rc = add_mod_seq(&preply->brp_un.brp_status, last, pjob->ji_mod_seq);
+		}
 		if (dosubjobs && (pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) &&
 			((rc == PBSE_NONE) || (rc != PBSE_PERM)) && pjob->ji_ajtrk != NULL) {
 
 		    for (indx=0; indx<pjob->ji_ajtrk->tkm_ct; ++indx) {
-			 rc = status_subjob(pjob, preq, pal, indx, &preply->brp_un.brp_status, &bad);
+			    if (since >= 0) {
+				    seq = subjob_mod_seq(pjob, indx);
+				    if (seq <= since)
+					    continue;
+			    }
+			    last = GET_PRIOR(preply->brp_un.brp_status);
+			    rc = status_subjob(pjob, preq, pal, indx, &preply->brp_un.brp_status, &bad);
+			    if ((rc == PBSE_NONE) && (since >= 0))
+				    rc = add_mod_seq(&preply->brp_un.brp_status, last, seq);
 			    if (rc && (rc != PBSE_PERM))
 				break;
 		    }
@@ -190,18 +758,22 @@ do_stat_of_a_job(struct batch_request *preq, job *pjob, int dohistjobs, int dosu
  * @param[in]	name	-	job id to be statused
  * @param[in]	dohistjobs	-	flag to include job if it is a history job
  * @param[in]	dosubjobs	-	flag to expand a Array job to include all subjobs
+ * @param[in]	since	-	only status jobs changed after this sequence,
+ *				-1 to status them all
  *
  * @return	int
  * @retval	PBSE_NONE (0)	: no error
  * @retval	non-zero	: PBS error code to return to client
  */
 static int
-stat_a_jobidname(struct batch_request *preq, char *name, int dohistjobs, int dosubjobs)
+stat_a_jobidname(struct batch_request *preq, char *name, int dohistjobs, int dosubjobs, long long since)
 {
 	int   i, indx, x, y, z;
 	char *pc;
 	char *range;
 	int   rc;
+	long long seq = -1;
+	void *last;
 	job  *pjob;
 	struct batch_reply *preply = &preq->rq_reply;
 	svrattrl	   *pal;
@@ -215,8 +787,16 @@ stat_a_jobidname(struct batch_request *preq, char *name, int dohistjobs, int dos
 		}
 		indx = subjob_index_to_offset(pjob, get_index_from_jid(name));
 		if (indx != -1) {
+			if (since >= 0) {
+				seq = subjob_mod_seq(pjob, indx);
+				if (seq <= since)
+					return (PBSE_NONE);
+			}
 			pal = (svrattrl *)GET_NEXT(preq->rq_ind.rq_status.rq_attr);
+			last = GET_PRIOR(preply->brp_un.brp_status);
 			rc = status_subjob(pjob, preq, pal, indx, &preply->brp_un.brp_status, &bad);
+			if ((rc == PBSE_NONE) && (since >= 0))
+				rc = add_mod_seq(&preply->brp_un.brp_status, last, seq);
 		} else {
 			rc = PBSE_UNKJOBID;
 		}
@@ -229,7 +809,7 @@ stat_a_jobidname(struct batch_request *preq, char *name, int dohistjobs, int dos
 		} else if ((!dohistjobs) && (rc = svr_chk_histjob(pjob))) {
 			return (rc);
 		}
-		return (do_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs));
+		return (do_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs, since));
 	} else {
 		/* range of sub jobs */
 		range = get_index_from_jid(name);
@@ -254,7 +834,17 @@ stat_a_jobidname(struct batch_request *preq, char *name, int dohistjobs, int dos
 					x += z;
 					continue;
 				}
+				if (since >= 0) {
+					seq = subjob_mod_seq(pjob, indx);
+					if (seq <= since) {
+						x += z;
+						continue;
+					}
+				}
+				last = GET_PRIOR(preply->brp_un.brp_status);
 				rc = status_subjob(pjob, preq, pal, indx, &preply->brp_un.brp_status, &bad);
+				if ((rc == PBSE_NONE) && (since >= 0))
+					rc = add_mod_seq(&preply->brp_un.brp_status, last, seq);
 				if (rc && (rc != PBSE_PERM)) {
 					return (rc);
 				}
@@ -279,6 +869,21 @@ stat_a_jobidname(struct batch_request *preq, char *name, int dohistjobs, int dos
  * 		The requested object may be a job id (either a single regular job, an Array
  * 		job, a subjob or a range of subjobs), a comma separated list of the above,
  * 		a queue name or null (or @...) for all jobs in the Server.
+ * @par
+ * 		With EXTEND_CHANGED_SINCE in the extend string only the jobs changed
+ * 		after the given sequence are returned, with their ATTR_mod_seq.  For
+ * 		all jobs in the Server the jobs deleted after it are returned too.
+ * @par
+ * 		With EXTEND_PAGE the jobs of a queue or of the Server are returned a
+ * 		page at a time, so the reply held in memory stays bounded.  A page
+ * 		followed by more jobs ends with the cursor of the next page, see
+ * 		get_stat_page().
+ * @par
+ * 		The comparisons in the attribute list (pbs_statjob_filter()) are the
+ * 		criteria of the jobs to return, as for a Select-Status request.  They
+ * 		are checked by status_job() before anything is encoded.  A job which
+ * 		stops meeting them is not reported as deleted with
+ * 		EXTEND_CHANGED_SINCE.
  *
  * @param[in,out]	preq	-	pointer to the stat job batch request, reply updated
  *
@@ -297,6 +902,27 @@ void req_stat_job(struct batch_request *preq)
 	int		    rc   = 0;
 	int		    type = 0;
 	char		   *pnxtjid = NULL;
+	long long	    since;
+	int		    count;
+	int		    n;
+	unsigned long	    rank;
+	unsigned long	    jrank;
+	int		    nrank;
+	enum job_list	    which;
+
+	if (stat_cache_reply(preq))
+		return;
+
+	if ((rc = stat_filter_build(preq, &bad)) != PBSE_NONE) {
+		reply_badattr(rc, bad, (svrattrl *)GET_NEXT(preq->rq_ind.rq_status.rq_filtattr), preq);
+		return;
+	}
+
+	if (((rc = get_changed_since(preq, &since)) != PBSE_NONE) ||
+		((rc = get_stat_page(preq, &count, &rank, &nrank)) != PBSE_NONE)) {
+		req_reject(rc, 0, preq);
+		return;
+	}
 
 	/* check for any extended flag in the batch request. 't' for
 	 * the sub jobs. If 'x' is there, then check if the server is
@@ -367,7 +993,7 @@ void req_stat_job(struct batch_request *preq)
 		 */
 		pnxtjid = name;
 		while ((name = parse_comma_string_r(&pnxtjid)) != NULL) {
-			if ((rc = stat_a_jobidname(preq, name, dohistjobs, dosubjobs)) == PBSE_NONE)
+			if ((rc = stat_a_jobidname(preq, name, dohistjobs, dosubjobs, since)) == PBSE_NONE)
 				at_least_one_success = 1;
 		}
 		if (at_least_one_success == 1)
@@ -376,19 +1002,61 @@ void req_stat_job(struct batch_request *preq)
 			req_reject(rc, 0, preq);
 		return;
 
-	} else if (type == 2) {
-		pjob = (job *)GET_NEXT(pque->qu_jobs);
-		while (pjob && (rc == PBSE_NONE)) {
-			rc = do_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs);
-			pjob = (job *)GET_NEXT(pjob->ji_jobque);
-		}
 	} else {
-		pjob = (job *)GET_NEXT(svr_alljobs);
+		/*
+		 * Without history jobs, walk only the jobs not history, unless
+		 * the jobs that became history since are to be reported gone.
+		 */
+		if ((dohistjobs == 0) && (since < 0))
+			which = (type == 2) ? JOB_LIST_QUEUE_ACTIVE : JOB_LIST_ACTIVE;
+		else
+			which = (type == 2) ? JOB_LIST_QUEUE : JOB_LIST_ALL;
+		switch (which) {
+			case JOB_LIST_QUEUE_ACTIVE:
+				pjob = (job *)GET_NEXT(pque->qu_actjobs);
+				break;
+			case JOB_LIST_ACTIVE:
+				pjob = (job *)GET_NEXT(svr_actjobs);
+				break;
+			case JOB_LIST_QUEUE:
+				pjob = (job *)GET_NEXT(pque->qu_jobs);
+				break;
+			default:
+				pjob = (job *)GET_NEXT(svr_alljobs);
+		}
+
+		/* skip the jobs of the previous pages */
+		if (count > 0) {
+			n = 0;
+			while (pjob) {
+				jrank = (unsigned long)pjob->ji_wattr[(int)JOB_ATR_qrank].at_val.at_long;
+				if ((jrank > rank) || ((jrank == rank) && (n++ >= nrank)))
+					break;
+				pjob = next_stat_job(pjob, which);
+			}
+		}
+
+		n = 0;
 		while (pjob && (rc == PBSE_NONE)) {
-			rc = do_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs);
-			pjob = (job *)GET_NEXT(pjob->ji_alljobs);
+			if ((count > 0) && (n++ == count))
+				break;
+			rc = do_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs, since);
+			jrank = (unsigned long)pjob->ji_wattr[(int)JOB_ATR_qrank].at_val.at_long;
+			if (jrank == rank)
+				nrank++;
+			else {
+				rank = jrank;
+				nrank = 1;
+			}
+			pjob = next_stat_job(pjob, which);
 		}
 
+		if (rc == PBSE_NONE) {
+			if (pjob != NULL)
+				rc = add_stat_cursor(&preply->brp_un.brp_status, rank, nrank);
+			else if ((type == 3) && (since >= 0))
+				rc = status_all_deleted(MGR_OBJ_JOB, since, &preply->brp_un.brp_status);
+		}
 	}
 
 	if (rc && (rc != PBSE_PERM))
@@ -416,6 +1084,12 @@ req_stat_que(struct batch_request *preq)
 	struct batch_reply *preply;
 	int		    rc   = 0;
 	int		    type = 0;
+	long long	    since;
+
+	if ((rc = get_changed_since(preq, &since)) != PBSE_NONE) {
+		req_reject(rc, 0, preq);
+		return;
+	}
 
 	/*
 	 * first, validate the name of the requested object, either
@@ -443,13 +1117,13 @@ req_stat_que(struct batch_request *preq)
 	CLEAR_HEAD(preply->brp_un.brp_status);
 
 	if (type == 0) {	/* get status of the one named queue */
-		rc = status_que(pque, preq, &preply->brp_un.brp_status);
+		rc = status_que(pque, preq, &preply->brp_un.brp_status, since);
 
 	} else {	/* get status of queues */
 
 		pque = (pbs_queue *)GET_NEXT(svr_queues);
 		while (pque) {
-			rc = status_que(pque, preq, &preply->brp_un.brp_status);
+			rc = status_que(pque, preq, &preply->brp_un.brp_status, since);
 			if (rc != 0) {
 				if (rc == PBSE_PERM)
 					rc = 0;
@@ -458,6 +1132,8 @@ req_stat_que(struct batch_request *preq)
 			}
 			pque = (pbs_queue *)GET_NEXT(pque->qu_link);
 		}
+		if ((rc == 0) && (since >= 0))
+			rc = status_all_deleted(MGR_OBJ_QUEUE, since, &preply->brp_un.brp_status);
 	}
 	if (rc) {
 		(void)reply_free(preply);
@@ -474,6 +1150,8 @@ req_stat_que(struct batch_request *preq)
  * @param[in,out]	pque	-	ptr to que to status
  * @param[in]		preq	-	ptr to the decoded request
  * @param[in,out]	pstathd	-	head of list to append status to
+ * @param[in]		since	-	only status the queue if changed after this
+ *					sequence, -1 to always status it
  *
  * @return	int
  * @retval	0	: success
@@ -481,10 +1159,11 @@ req_stat_que(struct batch_request *preq)
  */
 
 static int
-status_que(pbs_queue *pque, struct batch_request *preq, pbs_list_head *pstathd)
+status_que(pbs_queue *pque, struct batch_request *preq, pbs_list_head *pstathd, long long since)
 {
 	struct brp_status *pstat;
 	svrattrl	  *pal;
+	long		   total;
 
 	if ((preq->rq_perm & ATR_DFLAG_RDACC) == 0)
 		return (PBSE_PERM);
@@ -492,17 +1171,32 @@ status_que(pbs_queue *pque, struct batch_request *preq, pbs_list_head *pstathd)
 	/* ok going to do status, update count and state counts from qu_qs */
 
 	if (!svr_chk_history_conf()) {
-		pque->qu_attr[(int)QA_ATR_TotalJobs].at_val.at_long = pque->qu_numjobs;
+		total = pque->qu_numjobs;
 	} else {
-		pque->qu_attr[(int)QA_ATR_TotalJobs].at_val.at_long = pque->qu_numjobs -
+		total = pque->qu_numjobs -
 			(pque->qu_njstate[JOB_STATE_MOVED] + pque->qu_njstate[JOB_STATE_FINISHED] + pque->qu_njstate[JOB_STATE_EXPIRED]);
 	}
-	pque->qu_attr[(int)QA_ATR_TotalJobs].at_flags |= ATR_VFLAG_SET|ATR_VFLAG_MODCACHE;
+	if ((total != pque->qu_attr[(int)QA_ATR_TotalJobs].at_val.at_long) ||
+		((pque->qu_attr[(int)QA_ATR_TotalJobs].at_flags & ATR_VFLAG_SET) == 0)) {
+		pque->qu_attr[(int)QA_ATR_TotalJobs].at_val.at_long = total;
+		pque->qu_attr[(int)QA_ATR_TotalJobs].at_flags |= ATR_VFLAG_SET|ATR_VFLAG_MODCACHE;
+	}
 
 	update_state_ct(&pque->qu_attr[(int)QA_ATR_JobsByState],
 		pque->qu_njstate,
 		pque->qu_jobstbuf);
 
+	update_mod_seq(pque->qu_attr, QA_ATR_LAST, &pque->qu_mod_seq);
+	if ((since >= 0) && (pque->qu_mod_seq <= since))
+		return (0);
+
+	if (!in_stat_partition(preq, &pque->qu_attr[(int)QA_ATR_partition])) {
+		if (since > 0)
+			return (status_deleted(MGR_OBJ_QUEUE, pque->qu_qs.qu_name,
+				pque->qu_mod_seq, pstathd));
+		return (0);
+	}
+
 	/* allocate status sub-structure and fill in header portion */
 
 	pstat = (struct brp_status *)malloc(sizeof(struct brp_status));
@@ -522,6 +1216,8 @@ status_que(pbs_queue *pque, struct batch_request *preq, pbs_list_head *pstathd)
 		preq->rq_perm, &pstat->brp_attr, &bad))
 		return (PBSE_NOATTR);
 
+	if (since >= 0)
+		return (add_mod_seq(pstathd, NULL, pque->qu_mod_seq));
 	return (0);
 }
 
@@ -547,6 +1243,7 @@ req_stat_node(struct batch_request *preq)
 	int		    rc   = 0;
 	int		    type = 0;
 	int		    i;
+	long long	    since;
 
 	/*
 	 * first, check that the server indeed has a list of nodes
@@ -560,6 +1257,14 @@ req_stat_node(struct batch_request *preq)
 		return;
 	}
 
+	if (stat_cache_reply(preq))
+		return;
+
+	if ((rc = get_changed_since(preq, &since)) != PBSE_NONE) {
+		req_reject(rc, 0, preq);
+		return;
+	}
+
 	resc_access_perm = preq->rq_perm;
 
 	name = preq->rq_ind.rq_status.rq_id;
@@ -579,7 +1284,7 @@ req_stat_node(struct batch_request *preq)
 	CLEAR_HEAD(preply->brp_un.brp_status);
 
 	if (type == 0) {		/* get status of the named node */
-		rc = status_node(pnode, preq, &preply->brp_un.brp_status);
+		rc = status_node(pnode, preq, &preply->brp_un.brp_status, since);
 
 	} else {			/* get status of all nodes */
 
@@ -587,10 +1292,12 @@ req_stat_node(struct batch_request *preq)
 			pnode = pbsndlist[i];
 
 			rc = status_node(pnode, preq,
-				&preply->brp_un.brp_status);
+				&preply->brp_un.brp_status, since);
 			if (rc)
 				break;
 		}
+		if ((rc == 0) && (since >= 0))
+			rc = status_all_deleted(MGR_OBJ_NODE, since, &preply->brp_un.brp_status);
 	}
 
 	if (!rc) {
@@ -616,6 +1323,8 @@ req_stat_node(struct batch_request *preq)
  * @param[in,out]	pnode	-	ptr to node receiving status query
  * @param[in]	preq	-	ptr to the decoded request
  * @param[in,out]	pstathd	-	head of list to append status to
+ * @param[in]	since	-	only status the node if changed after this
+ *				sequence, -1 to always status it
  *
  * @return	int
  * @retval	0	: success
@@ -623,7 +1332,7 @@ req_stat_node(struct batch_request *preq)
  */
 
 static int
-status_node(struct pbsnode *pnode, struct batch_request *preq, pbs_list_head *pstathd)
+status_node(struct pbsnode *pnode, struct batch_request *preq, pbs_list_head *pstathd, long long since)
 {
 	int		   rc = 0;
 	struct brp_status *pstat;
@@ -644,6 +1353,20 @@ status_node(struct pbsnode *pnode, struct batch_request *preq, pbs_list_head *ps
 			ATR_VFLAG_MODCACHE;
 	}
 
+	update_mod_seq(pnode->nd_attr, ND_ATR_LAST, &pnode->nd_mod_seq);
+	if ((since >= 0) && (pnode->nd_mod_seq <= since))
+		return (0);
+
+	/* a changed vnode outside the partitions asked for is gone from the
+	 * client's view, e.g. after having been moved to another partition
+	 */
+	if (!in_stat_partition(preq, &pnode->nd_attr[(int)ND_ATR_partition])) {
+		if (since > 0)
+			return (status_deleted(MGR_OBJ_NODE, pnode->nd_name,
+				pnode->nd_mod_seq, pstathd));
+		return (0);
+	}
+
 	/*node is provisioning - mask out the DOWN/UNKNOWN flags while prov is on*/
 	if (pnode->nd_attr[(int)ND_ATR_state].at_val.at_long &
 		(INUSE_PROV | INUSE_WAIT_PROV)) {
@@ -685,6 +1408,8 @@ status_node(struct pbsnode *pnode, struct batch_request *preq, pbs_list_head *ps
 	if (pnode->nd_attr[(int)ND_ATR_state].at_val.at_long & INUSE_PROV)
 		pnode->nd_attr[(int)ND_ATR_state].at_val.at_long = old_nd_state ;
 
+	if ((rc == 0) && (since >= 0))
+		rc = add_mod_seq(pstathd, NULL, pnode->nd_mod_seq);
 
 	return (rc);
 }
@@ -720,6 +1445,9 @@ req_stat_svr(struct batch_request *preq)
 	update_license_ct(&server.sv_attr[(int)SRV_ATR_license_count],
 		server.sv_license_ct_buf);
 
+	update_node_state_ct(&server.sv_attr[(int)SRV_ATR_NodesByState],
+		server.sv_nodestbuf);
+
 	/* allocate a reply structure and a status sub-structure */
 
 	preply = &preq->rq_reply;
@@ -860,18 +1588,23 @@ update_state_ct(attribute *pattr, int *ct_array, char *buf)
 		"Running", "Exiting", "Expired", "Begun",
 		"Moved", "Finished" };
 	int  index;
+	char newbuf[sizeof(server.sv_jobstbuf)];
 
-	buf[0] = '\0';
+	newbuf[0] = '\0';
 	for (index=0; index < (PBS_NUMJOBSTATE); index++) {
 		if ((index == JOB_STATE_EXPIRED) ||
 			(index == JOB_STATE_MOVED) ||
 			(index == JOB_STATE_FINISHED))
 			continue;	/* skip over Expired/Moved/Finished */
-		sprintf(buf+strlen(buf), "%s:%d ", statename[index],
+		sprintf(newbuf+strlen(newbuf), "%s:%d ", statename[index],
 			*(ct_array + index));
 	}
 	pattr->at_val.at_str = buf;
-	pattr->at_flags |= ATR_VFLAG_SET | ATR_VFLAG_MODCACHE;
+	/* only a change of the counts invalidates the cached encoding */
+	if (((pattr->at_flags & ATR_VFLAG_SET) == 0) || (strcmp(buf, newbuf) != 0)) {
+		strcpy(buf, newbuf);
+		pattr->at_flags |= ATR_VFLAG_SET | ATR_VFLAG_MODCACHE;
+	}
 }
 
 /**
@@ -956,6 +1689,12 @@ req_stat_resv(struct batch_request * preq)
 	resc_resv	   *presv = NULL;
 	int		    rc   = 0;
 	int		    type = 0;
+	long long	    since;
+
+	if ((rc = get_changed_since(preq, &since)) != PBSE_NONE) {
+		req_reject(rc, 0, preq);
+		return;
+	}
 
 	/*
 	 * first, validate the name sent in the request.
@@ -981,20 +1720,22 @@ req_stat_resv(struct batch_request * preq)
 
 	if (type == 0) {
 		/* get status of the specifically named reservation */
-		rc = status_resv(presv, preq, &preply->brp_un.brp_status);
+		rc = status_resv(presv, preq, &preply->brp_un.brp_status, since);
 
 	} else {
 		/* get status of all the reservations */
 
 		presv = (resc_resv *)GET_NEXT(svr_allresvs);
 		while (presv) {
-			rc = status_resv(presv, preq, &preply->brp_un.brp_status);
+			rc = status_resv(presv, preq, &preply->brp_un.brp_status, since);
 			if (rc == PBSE_PERM)
 				rc = 0;
 			if (rc)
 				break;
 			presv = (resc_resv *)GET_NEXT(presv->ri_allresvs);
 		}
+		if ((rc == 0) && (since >= 0))
+			rc = status_all_deleted(MGR_OBJ_RESV, since, &preply->brp_un.brp_status);
 	}
 
 	if (rc == 0)
@@ -1010,6 +1751,8 @@ req_stat_resv(struct batch_request * preq)
  * @param[in]	presv	-	get status for this reservation
  * @param[in]	preq	-	ptr to the decoded request
  * @param[in,out]	pstathd	-	append retrieved status to list
+ * @param[in]	since	-	only status the reservation if changed after this
+ *				sequence, -1 to always status it
  *
  * @return	int
  * @retval	0	: success
@@ -1017,7 +1760,7 @@ req_stat_resv(struct batch_request * preq)
  */
 
 static int
-status_resv(resc_resv *presv, struct batch_request *preq, pbs_list_head *pstathd)
+status_resv(resc_resv *presv, struct batch_request *preq, pbs_list_head *pstathd, long long since)
 {
 	struct brp_status *pstat;
 	svrattrl	  *pal;
@@ -1029,6 +1772,10 @@ status_resv(resc_resv *presv, struct batch_request *preq, pbs_list_head *pstathd
 	 *"quick save" area of the resc_resv structure
 	 */
 
+	update_mod_seq(presv->ri_wattr, RESV_ATR_LAST, &presv->ri_mod_seq);
+	if ((since >= 0) && (presv->ri_mod_seq <= since))
+		return (0);
+
 	/*now allocate status sub-structure and fill header portion*/
 
 	pstat = (struct brp_status *)malloc(sizeof(struct brp_status));
@@ -1047,10 +1794,12 @@ status_resv(resc_resv *presv, struct batch_request *preq, pbs_list_head *pstathd
 	pal = (svrattrl *) GET_NEXT(preq->rq_ind.rq_status.rq_attr);
 
 	if (status_attrib(pal, resv_attr_def, presv->ri_wattr,
-		RESV_ATR_LAST, preq->rq_perm, &pstat->brp_attr, &bad) == 0)
-		return (0);
-	else
+		RESV_ATR_LAST, preq->rq_perm, &pstat->brp_attr, &bad) != 0)
 		return (PBSE_NOATTR);
+
+	if (since >= 0)
+		return (add_mod_seq(pstathd, NULL, presv->ri_mod_seq));
+	return (0);
 }
 
 /**
@@ -85,6 +85,7 @@ extern pbs_list_head svr_deferred_req;
 extern void  est_start_timed_task(struct work_task *);
 extern char	*msg_noloopbackif;
 extern char	*msg_daemonname;
+extern time_t	 time_now;
 
 int scheduler_sock = -1;	/* socket open to scheduler during a cycle */
 int scheduler_sock2 = -1;
@@ -446,6 +447,8 @@ schedule_jobs(pbs_sched *psched)
 				psched->scheduler_sock2 = s;
 		}
 		psched->svr_do_schedule = SCH_SCHEDULE_NULL;
+		psched->sch_cycle_start = time_now;
+		psched->sch_trigger_first = 0;
 
 		set_attr_svr(&(psched->sch_attr[(int) SCHED_ATR_sched_state]), &sched_attr_def[(int) SCHED_ATR_sched_state], SC_SCHEDULING);
 
@@ -582,10 +585,78 @@ was_job_alteredmoved(job *pjob)
 	return 0;
 }
 
+/**
+ * @brief
+ * 		sched_trigger_weight - weight of a scheduling cycle trigger.
+ *		Triggers raised for routine events (submit, end, queue start,
+ *		local move) weigh least and may be held back and coalesced; the
+ *		periodic trigger and commands asking for a cycle now weigh more.
+ *
+ * @param[in]	flag	-	SCH_SCHEDULE_* trigger
+ *
+ * @return	int
+ * @retval	0	: no trigger
+ * @retval	1	: event trigger, may be held back
+ * @retval	2	: periodic trigger
+ * @retval	3	: command trigger
+ */
+static int
+sched_trigger_weight(int flag)
+{
+	switch (flag) {
+		case SCH_SCHEDULE_NULL:
+			return 0;
+		case SCH_SCHEDULE_NEW:
+		case SCH_SCHEDULE_TERM:
+		case SCH_SCHEDULE_STARTQ:
+		case SCH_SCHEDULE_MVLOCAL:
+		case SCH_SCHEDULE_ETE_ON:
+			return 1;
+		case SCH_SCHEDULE_TIME:
+			return 2;
+		default:
+			return 3;
+	}
+}
+
+/**
+ * @brief
+ * 		sched_trigger_time - when the pending trigger of a scheduler may
+ *		start a cycle.  Event triggers are held until PBS_SCHED_TRIGGER_GAP
+ *		seconds after the last cycle started, but no longer than
+ *		PBS_SCHED_TRIGGER_LATENCY seconds after the first of them was
+ *		raised, so a burst of submits or obits is served by one cycle.
+ *
+ * @param[in]	psched	-	scheduler
+ *
+ * @return	time_t
+ * @retval	0	: no trigger pending
+ * @retval	>0	: time the cycle may start, time_now or earlier if due
+ */
+time_t
+sched_trigger_time(pbs_sched *psched)
+{
+	time_t due;
+
+	if (psched->svr_do_schedule == SCH_SCHEDULE_NULL)
+		return 0;
+	if (pbs_conf.pbs_sched_trigger_gap == 0 ||
+		sched_trigger_weight(psched->svr_do_schedule) > 1 ||
+		psched->sch_trigger_first == 0)
+		return time_now;
+
+	due = psched->sch_cycle_start + pbs_conf.pbs_sched_trigger_gap;
+	if (pbs_conf.pbs_sched_trigger_latency > 0 &&
+		psched->sch_trigger_first + pbs_conf.pbs_sched_trigger_latency < due)
+		due = psched->sch_trigger_first + pbs_conf.pbs_sched_trigger_latency;
+	return due;
+}
+
 /**
  * @brief
  * 		set_scheduler_flag - set the flag to call the Scheduler
- *		certain flag values should not be overwritten
+ *		certain flag values should not be overwritten; a pending trigger
+ *		is not replaced by one of lower weight, see sched_trigger_weight()
  *
  * @param[in]	flag	-	pointer to job in question.
  * @parm[in] psched -   pointer to sched object. Then set the flag only for this object.
@@ -614,8 +685,14 @@ set_scheduler_flag(int flag, pbs_sched *psched)
 
 			psched->svr_do_sched_high = flag;
 		}
-		else
+		else if (flag == SCH_SCHEDULE_RESTART_CYCLE ||
+			psched->svr_do_schedule == SCH_SCHEDULE_RESTART_CYCLE ||
+			sched_trigger_weight(flag) >= sched_trigger_weight(psched->svr_do_schedule)) {
+			if (psched->svr_do_schedule == SCH_SCHEDULE_NULL &&
+				sched_trigger_weight(flag) == 1)
+				psched->sch_trigger_first = time_now;
 			psched->svr_do_schedule = flag;
+		}
 		if (single_sched)
 			break;
 	}
@@ -44,9 +44,14 @@
  * 	stat_job.c	-	Functions which support the Status Job Batch Request.
  *
  * Included funtions are:
+ *	svrcached_value()
+ *	svrcached_resc()
  *	svrcached()
+ *	find_stat_attr()
  *	status_attrib()
+ *	update_job_mod_seq()
  *	status_job()
+ *	swap_subjob_value()
  *	status_subjob()
  *
  */
@@ -70,6 +75,8 @@
 #include "svrfunc.h"
 #include "pbs_ifl.h"
 
+/* positions of a status request's attribute list remembered by find_stat_attr() */
+#define STAT_ATTR_HINTS	128
 
 /* Global Data Items: */
 
@@ -80,57 +87,78 @@ extern char	     statechars[];
 
 /**
  * @brief
- * 		svrcached - either link in (to phead) a cached svrattrl struct which is
- *		pointed to by the attribute, or if the cached struct isn't there or
- *		is out of date, then replace it with a new svrattrl structure.
+ * 		svrcached_value - either link in (to phead) a cached svrattrl struct
+ *		which is pointed to by the attribute, or if the cached struct isn't
+ *		there or is out of date, then replace it with a new svrattrl
+ *		structure.
  * @par
  *		When replacing, unlink and delete old one if the reference count goes
  *		to zero.
+ * @par
+ *		Only the encoding of a resource list depends on the privilege of the
+ *		client, so for any other value the encoding cached for managers and
+ *		the one cached for users are one and the same, held by both pointers.
+ *		Every queued job statused by the scheduler and by its owner then
+ *		keeps one copy of each encoded value instead of two.
  *
- * @par[in,out]	pat	-	attribute structure which contains a cached svrattrl struct
+ * @par[in,out]	pat	-	attribute (or resource value) with the cached svrattrl
  * @par[in,out]	phead	-	list of new attribute values
- * @par[in]	pdef	-	attribute for any parent object.
+ * @par[in]	aname	-	attribute name to encode with
+ * @par[in]	rname	-	resource name to encode with, NULL if none
+ * @par[in]	encode	-	encode function of the value
  *
- * @note
- *	If an attribute has the ATR_DFLAG_HIDDEN flag set, then no
- *	need to obtain and cache new svrattrl values.
+ * @return	int
+ * @retval	0	: success
+ * @retval	<0	: negative of the PBSE error of the encode function
  */
 
-static void
-svrcached(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
+static int
+svrcached_value(attribute *pat, pbs_list_head *phead, char *aname, char *rname,
+	int (*encode)(attribute *, pbs_list_head *, char *, char *, int, svrattrl **))
 {
 	svrattrl *working = NULL;
 	svrattrl *wcopy;
 	svrattrl *encoded;
+	svrattrl *other;
+	int	  ncache;
+	int	  rc = 0;
 
-	if (pdef == NULL)
-		return;
-
-	if ((pdef->at_flags & ATR_DFLAG_HIDDEN) &&
-		(server.sv_attr[(int)SRV_ATR_show_hidden_attribs].at_val.at_long == 0)) {
-		return;
-	}
-
-	if (resc_access_perm & PRIV_READ)
+	if (resc_access_perm & PRIV_READ) {
 		encoded = pat->at_priv_encoded;
-	else
+		other = pat->at_user_encoded;
+	} else {
 		encoded = pat->at_user_encoded;
+		other = pat->at_priv_encoded;
+	}
 
-	if (pat->at_flags & ATR_VFLAG_MODCACHE)
+	if (pat->at_flags & ATR_MOD_STATUS)
 		/* free old cache value if the value has changed */
 		free_svrcache(pat);
+	else if ((encoded == NULL) && (other != NULL) &&
+		(pat->at_type != ATR_TYPE_RESC)) {
+		/* the other privilege's encoding is the same, hold it too */
+		if (resc_access_perm & PRIV_READ)
+			pat->at_priv_encoded = other;
+		else
+			pat->at_user_encoded = other;
+		for (working = other; working; working = working->al_sister)
+			working->al_refct++;
+		encoded = other;
+	}
 
-	if ((encoded == NULL) || (pat->at_flags & ATR_VFLAG_MODCACHE)) {
+	if ((encoded == NULL) || (pat->at_flags & ATR_MOD_STATUS)) {
 		if (pat->at_flags & ATR_VFLAG_SET) {
 			/* encode and cache new svrattrl structure */
-			(void)pdef->at_encode(pat, phead, pdef->at_name,
-				NULL, ATR_ENCODE_CLIENT, &working);
+			rc = encode(pat, phead, aname, rname,
+				ATR_ENCODE_CLIENT, &working);
+			if (rc < 0)
+				return (rc);
 			if (resc_access_perm & PRIV_READ)
 				pat->at_priv_encoded = working;
 			else
 				pat->at_user_encoded = working;
 
-			pat->at_flags &= ~ATR_VFLAG_MODCACHE;
+			clear_mod_status(pat);
 			while (working) {
 				working->al_refct++;	/* incr ref count */
 				working = working->al_sister;
@@ -139,8 +167,10 @@ svrcached(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
 	} else {
 		/* can use the existing cached svrattrl struture */
 
+		/* each cache pointer holds a reference, others are replies */
+		ncache = (pat->at_user_encoded == pat->at_priv_encoded) ? 2 : 1;
 		working = encoded;
-		if (working->al_refct < 2) {
+		if (working->al_refct < ncache + 1) {
 			while (working) {
 				CLEAR_LINK(working->al_link);
 				if (phead != NULL)
@@ -170,6 +200,129 @@ svrcached(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
 			}
 		}
 	}
+	return (0);
+}
+
+/**
+ * @brief
+ * 		svrcached_resc - svrcached() for a resource list.  Each resource
+ *		keeps its own cached svrattrl, so a change to one resource, e.g. a
+ *		vnode's resources_assigned.ncpus, re-encodes only that resource.
+ *
+ * @par[in,out]	pat	-	attribute of type ATR_TYPE_RESC
+ * @par[in,out]	phead	-	list of new attribute values
+ * @par[in]	pdef	-	definition of the attribute
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	<0	: negative of the PBSE error of an encode function
+ *
+ * @note
+ *	As in encode_resc(), resc_access_perm decides which resources are
+ *	returned.
+ */
+
+static int
+svrcached_resc(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
+{
+	resource *prsc;
+	int	  rc;
+
+	/* drop the encoding of whatever resources changed */
+	(void)update_resc_svrcache(pat);
+	if (pat->at_flags & ATR_MOD_STATUS) {
+		free_svrcache(pat);
+		clear_mod_status(pat);
+	}
+
+	if ((pat->at_flags & ATR_VFLAG_SET) == 0)
+		return (0);
+
+	for (prsc = (resource *)GET_NEXT(pat->at_val.at_list);
+		prsc != NULL;
+		prsc = (resource *)GET_NEXT(prsc->rs_link)) {
+
+		if ((prsc->rs_defin->rs_flags & resc_access_perm) == 0)
+			continue;
+		if (prsc->rs_value.at_flags & ATR_VFLAG_INDIRECT)
+			rc = svrcached_value(&prsc->rs_value, phead, pdef->at_name,
+				prsc->rs_defin->rs_name, encode_str);
+		else
+			rc = svrcached_value(&prsc->rs_value, phead, pdef->at_name,
+				prsc->rs_defin->rs_name, prsc->rs_defin->rs_encode);
+		if (rc < 0)
+			return (rc);
+	}
+	return (0);
+}
+
+/**
+ * @brief
+ * 		svrcached - add the cached encoding of an attribute to a status
+ *		reply, encoding it again first if it changed, see svrcached_value().
+ *
+ * @par[in,out]	pat	-	attribute structure which contains a cached svrattrl struct
+ * @par[in,out]	phead	-	list of new attribute values
+ * @par[in]	pdef	-	attribute for any parent object.
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	<0	: negative of the PBSE error of the encode function
+ *
+ * @note
+ *	If an attribute has the ATR_DFLAG_HIDDEN flag set, then no
+ *	need to obtain and cache new svrattrl values.
+ */
+
+int
+svrcached(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
+{
+	if (pdef == NULL)
+		return (0);
+
+	if ((pdef->at_flags & ATR_DFLAG_HIDDEN) &&
+		(server.sv_attr[(int)SRV_ATR_show_hidden_attribs].at_val.at_long == 0)) {
+		return (0);
+	}
+
+	if ((pdef->at_type == ATR_TYPE_RESC) && (pdef->at_encode == encode_resc))
+		return (svrcached_resc(pat, phead, pdef));
+	return (svrcached_value(pat, phead, pdef->at_name, NULL, pdef->at_encode));
+}
+
+/**
+ * @brief
+ * 		find_stat_attr - find_attr() for the nth attribute asked for by a
+ *		status request.  The same list is looked up for each object of the
+ *		request, so the index found at that position last time is tried
+ *		before searching the definitions.
+ *
+ * @param[in]	padef	-	attribute definition array
+ * @param[in]	name	-	attribute name asked for
+ * @param[in]	limit	-	limit on size of def array
+ * @param[in]	nth	-	position of the name in the request's list
+ *
+ * @return	int
+ * @retval	index of the attribute definition
+ * @retval	-1	: not found
+ *
+ * @par MT-safe: No
+ */
+int
+find_stat_attr(attribute_def *padef, char *name, int limit, int nth)
+{
+	static int hints[STAT_ATTR_HINTS];
+	int	   index;
+
+	if ((nth >= 0) && (nth < STAT_ATTR_HINTS)) {
+		index = hints[nth];
+		if ((index < limit) && (strcasecmp((padef + index)->at_name, name) == 0))
+			return (index);
+	}
+	index = find_attr(padef, name, limit);
+	if ((index >= 0) && (nth >= 0) && (nth < STAT_ATTR_HINTS))
+		hints[nth] = index;
+	return (index);
 }
 
 /*
@@ -202,13 +355,13 @@ status_attrib(svrattrl *pal, attribute_def *padef, attribute *pattr, int limit,
 	if (pal) {		/* client specified certain attributes */
 		while (pal) {
 			++nth;
-			index = find_attr(padef, pal->al_name, limit);
+			index = find_stat_attr(padef, pal->al_name, limit, nth);
 			if (index < 0) {
 				*bad = nth;
 				return (-1);
 			}
 			if ((padef+index)->at_flags & priv) {
-				svrcached(pattr+index, phead, padef+index);
+				(void)svrcached(pattr+index, phead, padef+index);
 			}
 			pal = (svrattrl *)GET_NEXT(pal->al_link);
 		}
@@ -217,13 +370,40 @@ status_attrib(svrattrl *pal, attribute_def *padef, attribute *pattr, int limit,
 
 		for (index = 0; index < limit; index++) {
 			if ((padef+index)->at_flags & priv) {
-				svrcached(pattr+index, phead, padef+index);
+				(void)svrcached(pattr+index, phead, padef+index);
 			}
 		}
 	}
 	return (0);
 }
 
+/**
+ * @brief
+ * 		update_job_mod_seq - update_mod_seq() for a job.  eligible_time and
+ *		accrue_type are marked modified by every status_job(), they are left
+ *		out so a job isn't seen as changed just for having been statused.
+ *
+ * @param[in,out]	pjob	-	job to update
+ *
+ * @return	void
+ */
+void
+update_job_mod_seq(job *pjob)
+{
+	int	elig_flags;
+	int	atyp_flags;
+
+	elig_flags = pjob->ji_wattr[(int)JOB_ATR_eligible_time].at_flags & ATR_MOD_STATUS;
+	atyp_flags = pjob->ji_wattr[(int)JOB_ATR_accrue_type].at_flags & ATR_MOD_STATUS;
+	pjob->ji_wattr[(int)JOB_ATR_eligible_time].at_flags &= ~ATR_MOD_STATUS;
+	pjob->ji_wattr[(int)JOB_ATR_accrue_type].at_flags &= ~ATR_MOD_STATUS;
+
+	update_mod_seq(pjob->ji_wattr, JOB_ATR_LAST, &pjob->ji_mod_seq);
+
+	pjob->ji_wattr[(int)JOB_ATR_eligible_time].at_flags |= elig_flags;
+	pjob->ji_wattr[(int)JOB_ATR_accrue_type].at_flags |= atyp_flags;
+}
+
 /**
  * @brief
  * 		status_job - Build the status reply for a single job, regular or Array,
@@ -251,12 +431,19 @@ status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *
 	int old_elig_flags = 0;
 	int old_atyp_flags = 0;
 
+	/* before the status clears what changed */
+	update_job_mod_seq(pjob);
+
 	/* see if the client is authorized to status this job */
 
 	if (! server.sv_attr[(int)SRV_ATR_query_others].at_val.at_long)
 		if (svr_authorize_jobreq(preq, pjob))
 			return (PBSE_PERM);
 
+	/* a job not meeting the criteria of the request is left out */
+	if (!stat_filter_job(preq, pjob))
+		return (PBSE_NONE);
+
 	if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) {
 		/* for Array Job, if array_indices_remaining is modified */
 		/* then need to recalculate the string value	     */
@@ -326,6 +513,30 @@ status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *
 	return (0);
 }
 
+/**
+ * @brief
+ * 		swap_subjob_value - exchange the value and flags of an attribute of
+ *		the parent Array Job with those of one of its subjobs, so the
+ *		parent's attribute can be statused for the subjob and put back.
+ *
+ * @param[in,out]	pattr	-	the parent's attribute
+ * @param[in,out]	pval	-	the other value
+ * @param[in,out]	pflags	-	the other flags
+ *
+ * @return	void
+ */
+static void
+swap_subjob_value(attribute *pattr, union attr_val *pval, int *pflags)
+{
+	union attr_val val = pattr->at_val;
+	int flags = pattr->at_flags;
+
+	pattr->at_val = *pval;
+	pattr->at_flags = *pflags | ATR_VFLAG_MODCACHE;
+	*pval = val;
+	*pflags = flags;
+}
+
 /**
  * @brief
  * 		status_subjob - status a single subjob (of an Array Job)
@@ -356,6 +567,15 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 	int		   oldatypflags = 0;
 	int 		   subjob_state = -1;
 	char 		   *old_subjob_comment = NULL;
+	struct ajtrk	   *ptrk;
+	int		   fakeattr[3];
+	union attr_val	   fakeval[3];
+	int		   fakeflags[3];
+	int		   nfake = 0;
+	int		   i;
+
+	/* the parent's attributes are statused for the subjob */
+	update_job_mod_seq(pjob);
 
 	/* see if the client is authorized to status this job */
 
@@ -366,6 +586,10 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 	if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) == 0)
 		return PBSE_IVALREQ;
 
+	/* a subjob not meeting the criteria of the request is left out */
+	if (!stat_filter_subjob(preq, pjob, get_subjob_state(pjob, subj)))
+		return 0;
+
 	/* if subjob job obj exists, use real job structure */
 
 	if ((get_subjob_state(pjob, subj) != JOB_STATE_QUEUED) && (psubjob = pjob->ji_ajtrk->tkm_tbl[subj].trk_psubjob)) {
@@ -456,10 +680,33 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 		/* 	 not correctly check ATR_VFLAG_SET */
 	}
 
+	/* a finished subjob kept only in the table has a few values of its own */
+	ptrk = &pjob->ji_ajtrk->tkm_tbl[subj];
+	if (ptrk->trk_exechost != NULL) {
+		fakeattr[nfake] = (int)JOB_ATR_exec_host;
+		fakeval[nfake].at_str = ptrk->trk_exechost;
+		fakeflags[nfake++] = ATR_VFLAG_SET;
+	}
+	if (ptrk->trk_runcount > 0) {
+		fakeattr[nfake] = (int)JOB_ATR_runcount;
+		fakeval[nfake].at_long = ptrk->trk_runcount;
+		fakeflags[nfake++] = ATR_VFLAG_SET;
+	}
+	if (ptrk->trk_exitstat) {
+		fakeattr[nfake] = (int)JOB_ATR_exit_status;
+		fakeval[nfake].at_long = ptrk->trk_error;
+		fakeflags[nfake++] = ATR_VFLAG_SET;
+	}
+	for (i = 0; i < nfake; i++)
+		swap_subjob_value(&pjob->ji_wattr[fakeattr[i]], &fakeval[i], &fakeflags[i]);
+
 	if (status_attrib(pal, job_attr_def, pjob->ji_wattr, limit,
 		preq->rq_perm, &pstat->brp_attr, bad))
 		rc =  PBSE_NOATTR;
 
+	for (i = 0; i < nfake; i++)
+		swap_subjob_value(&pjob->ji_wattr[fakeattr[i]], &fakeval[i], &fakeflags[i]);
+
 	/* Set the parent state back to what it really is */
 
 	pjob->ji_wattr[(int)JOB_ATR_state].at_val.at_char = realstate;
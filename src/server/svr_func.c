@@ -122,6 +122,7 @@
  * 	execute_python_prov_script()
  * 	start_vnode_provisioning()
  * 	check_and_enqueue_provisioning()
+ * 	queue_provisioning()
  * 	do_provisioning()
  * 	del_prov_vnode_entry()
  * 	action_backfill_depth()
@@ -139,6 +140,9 @@
  * 	keepfiles_action()
  * 	removefiles_action()
  *	are_we_primary()
+ * 	update_mod_seq()
+ * 	record_mod_seq_delete()
+ * 	mem_stats_log()
  */
 #include <pbs_config.h>   /* the master config generated by configure */
 
@@ -230,6 +234,7 @@ int provision_timeout;
  * the top level list of all vnodes queued for provisioning
  */
 pbs_list_head prov_allvnodes;
+static struct work_task *prov_pass_task = NULL;	/* do_provisioning() due */
 
 static int  is_runnable(job *, struct prov_vnode_info *);
 extern void set_srv_prov_attributes();
@@ -247,6 +252,15 @@ long svr_history_duration = SVR_JOBHIST_DEFAULT; /* default 2 weeks */
 /* Added for Trillion Jobid*/
 long long svr_max_job_sequence_id = SVR_MAX_JOB_SEQ_NUM_DEFAULT; /* default max job id 9999999 */
 
+/*
+ * Added for the changed since status: the last modification sequence
+ * given out, the deleted objects and the sequence before the oldest of them
+ */
+long long svr_mod_seq = 0;
+long long svr_mod_seq_floor = 0;
+pbs_list_head svr_mod_seq_deleted;
+static int svr_mod_seq_num_deleted = 0;
+
 /*
  * Added for Node_fail_requeue
  */
@@ -518,10 +532,10 @@ set_resc_assigned(void *pobj, int objtype, enum batch_op op)
 	else if ((objtype == 0) && (pjob->ji_myResv == NULL)) {
 		if (pjob->ji_wattr[(int) JOB_ATR_resc_released].at_flags & ATR_VFLAG_SET)
 			/* This is just the normal case when job was not suspended but trying to run| end */
-			update_node_rassn(&pjob->ji_wattr[(int) JOB_ATR_resc_released], op);
+			update_job_node_rassn(pjob, &pjob->ji_wattr[(int) JOB_ATR_resc_released], op);
 		else
 			/* updating all resources from exec vnode attribute */
-			update_node_rassn(&pjob->ji_wattr[(int) JOB_ATR_exec_vnode], op);
+			update_job_node_rassn(pjob, &pjob->ji_wattr[(int) JOB_ATR_exec_vnode], op);
 		if (pjob->ji_wattr[(int)JOB_ATR_exec_vnode_deallocated].at_flags & ATR_VFLAG_SET) {
 			update_job_node_rassn(pjob, &pjob->ji_wattr[(int) JOB_ATR_exec_vnode_deallocated], op);
 		}
@@ -5369,7 +5383,7 @@ mark_prov_vnode_offline(pbsnode *pnode, char * comment)
 
 
 	/* write the node state and current_aoe */
-	pnode->nd_modified |= (NODE_UPDATE_CURRENT_AOE | NODE_UPDATE_STATE);
+	node_mark_modified(pnode, NODE_UPDATE_CURRENT_AOE | NODE_UPDATE_STATE);
 	write_single_node_state(pnode);
 	pnode->nd_modified &= ~(NODE_UPDATE_CURRENT_AOE | NODE_UPDATE_STATE);
 
@@ -5673,7 +5687,7 @@ is_vnode_prov_done(char * vnode)
 	}
 
 	/* save the state of this node to the nodes file */
-	pnode->nd_modified |= NODE_UPDATE_STATE;
+	node_mark_modified(pnode, NODE_UPDATE_STATE);
 	write_single_node_state(pnode);
 	pnode->nd_modified &= ~NODE_UPDATE_STATE;
 
@@ -5696,7 +5710,7 @@ is_vnode_prov_done(char * vnode)
 	 * to do more prov so start a task for looking at
 	 * other nodes in the provisioning queue
 	 */
-	set_task(WORK_Immed, 0, do_provisioning, NULL);
+	(void)queue_provisioning();
 }
 
 /**
@@ -5875,7 +5889,7 @@ prov_request_deferred(struct work_task *wtask)
 
 
 		/* write the node current_aoe */
-		pnode->nd_modified |= NODE_UPDATE_CURRENT_AOE;
+		node_mark_modified(pnode, NODE_UPDATE_CURRENT_AOE);
 		write_single_node_state(pnode);
 		pnode->nd_modified &= ~NODE_UPDATE_CURRENT_AOE;
 
@@ -5919,7 +5933,7 @@ prov_request_deferred(struct work_task *wtask)
 	 * do more prov so start a task for looking at other
 	 * nodes in the provisioning queue
 	 */
-	set_task(WORK_Immed, 0, do_provisioning, NULL);
+	(void)queue_provisioning();
 }
 
 /**
@@ -6022,7 +6036,7 @@ prov_request_timed(struct work_task *wtask)
 	 * to do more prov so start a task for looking at other nodes
 	 * in the provisioning queue
 	 */
-	set_task(WORK_Immed, 0, do_provisioning, NULL);
+	(void)queue_provisioning();
 }
 
 
@@ -6393,7 +6407,7 @@ start_vnode_provisioning(struct prov_vnode_info * prov_vnode_info)
 
 
 	/* write the node current_aoe */
-	pnode->nd_modified |= NODE_UPDATE_CURRENT_AOE;
+	node_mark_modified(pnode, NODE_UPDATE_CURRENT_AOE);
 	write_single_node_state(pnode);
 	pnode->nd_modified &= ~NODE_UPDATE_CURRENT_AOE;
 
@@ -6496,7 +6510,6 @@ check_and_enqueue_provisioning(job *pjob, int *need_prov)
 	int			i;
 	struct prov_vnode_info	*prov_vnode_info;
 	struct pbsnode		*pnode;
-	struct work_task 	*ptask_start_prov;
 	char			*aoe_req=NULL; /* to point to aoe */
 
 	DBPRT(("%s: Entered\n", __func__))
@@ -6582,14 +6595,11 @@ check_and_enqueue_provisioning(job *pjob, int *need_prov)
 	}
 
 	/*
-	 * then start a immediate work task to start provisioning
-	 * based on max allowed provisioings - start an immediate
-	 * work task repeatable every PROV_POLL interval
+	 * then have do_provisioning() start provisioning based on max
+	 * allowed provisionings; the jobs enqueued before it runs are
+	 * all started in the same pass
 	 */
-	ptask_start_prov = set_task(WORK_Immed, 0,
-		do_provisioning, NULL);
-
-	if (ptask_start_prov == NULL) {
+	if (queue_provisioning() != 0) {
 		free(prov_vnode_list);
 		if (aoe_req)
 			free(aoe_req);
@@ -6610,6 +6620,28 @@ check_and_enqueue_provisioning(job *pjob, int *need_prov)
 }
 
 
+/**
+ * @brief
+ *		Have do_provisioning() run as an immediate work task, unless it
+ *		is already due.  Everything enqueued or finished before it runs
+ *		is then handled in one pass, with one save of the provisioning
+ *		records, instead of one pass per job or per vnode.
+ *
+ * @return	int
+ * @retval	0	: do_provisioning() is due
+ * @retval	-1	: the work task could not be created
+ *
+ * @par MT-safe:	No
+ */
+int
+queue_provisioning(void)
+{
+	if (prov_pass_task != NULL)
+		return 0;
+	prov_pass_task = set_task(WORK_Immed, 0, do_provisioning, NULL);
+	return ((prov_pass_task != NULL) ? 0 : -1);
+}
+
 /**
  * @brief
  *		Starts as many provisioning as possible from the list available
@@ -6643,6 +6675,9 @@ do_provisioning(struct work_task * wtask)
 	struct pbsnode	       *pnode;
 	int 			rc;
 
+	if (wtask == prov_pass_task)
+		prov_pass_task = NULL;
+
 	prov_vnode_info = GET_NEXT(prov_allvnodes);
 
 	/*
@@ -7319,3 +7354,212 @@ void memory_debug_log(struct work_task *ptask) {
 #endif /* malloc_info */
 }
 #endif /* WIN32 */
+
+extern pbs_list_head svr_allhooks;
+
+long mem_stats_alloc[MEM_STATS_NUM];	/* live allocations, by object */
+
+/**
+ * @brief
+ * 		Sum the size of the cached encodings (at_priv_encoded) of an array
+ *		of attributes.
+ *
+ * @param[in]	pattr	-	the attributes
+ * @param[in]	limit	-	number of attributes in the array
+ *
+ * @return	long	- bytes held by the cached encodings
+ */
+static long
+encoded_bytes(attribute *pattr, int limit)
+{
+	svrattrl *pal;
+	long bytes = 0;
+	int i;
+
+	for (i = 0; i < limit; i++) {
+		for (pal = pattr[i].at_priv_encoded; pal != NULL;
+			pal = (svrattrl *)GET_NEXT(pal->al_link))
+			bytes += pal->al_tsize;
+	}
+	return bytes;
+}
+
+/**
+ * @brief
+ * 		Log how many of each kind of server object exist and roughly how
+ *		much memory they hold, one line per kind.  "allocated" is kept up
+ *		by the alloc/free functions, "linked" is what is found on the server
+ *		lists; a growing difference between the two is a leak.  "bytes" is
+ *		the fixed size of the structures, "encoded" the cached status
+ *		encodings hanging off their attributes.  The freelists of the
+ *		hot structures follow, with how often they saved a malloc.
+ *		Called from the main loop when the server is sent SIGUSR1.
+ *
+ * @return	void
+ */
+void
+mem_stats_log(void)
+{
+	job		*pjob;
+	resc_resv	*presv;
+	pbs_queue	*pque;
+	hook		*phook;
+	pbs_freelist	*fl;
+	long		linked = 0;
+	long		history = 0;
+	long		encoded = 0;
+	int		i;
+
+	for (pjob = (job *)GET_NEXT(svr_alljobs); pjob != NULL;
+		pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
+		linked++;
+		if ((pjob->ji_qs.ji_state == JOB_STATE_MOVED) ||
+			(pjob->ji_qs.ji_state == JOB_STATE_FINISHED) ||
+			(pjob->ji_qs.ji_state == JOB_STATE_EXPIRED))
+			history++;
+		encoded += encoded_bytes(pjob->ji_wattr, JOB_ATR_LAST);
+	}
+	snprintf(log_buffer, LOG_BUF_SIZE,
+		"jobs allocated %ld linked %ld history %ld bytes %ld encoded %ld",
+		mem_stats_alloc[MEM_STATS_JOB], linked, history,
+		mem_stats_alloc[MEM_STATS_JOB] * (long)sizeof(job), encoded);
+	log_event(PBSEVENT_SYSTEM | PBSEVENT_FORCE, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "mem_stats", log_buffer);
+
+	linked = encoded = 0;
+	for (presv = (resc_resv *)GET_NEXT(svr_allresvs); presv != NULL;
+		presv = (resc_resv *)GET_NEXT(presv->ri_allresvs)) {
+		linked++;
+		encoded += encoded_bytes(presv->ri_wattr, RESV_ATR_LAST);
+	}
+	snprintf(log_buffer, LOG_BUF_SIZE,
+		"reservations allocated %ld linked %ld bytes %ld encoded %ld",
+		mem_stats_alloc[MEM_STATS_RESV], linked,
+		mem_stats_alloc[MEM_STATS_RESV] * (long)sizeof(resc_resv), encoded);
+	log_event(PBSEVENT_SYSTEM | PBSEVENT_FORCE, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "mem_stats", log_buffer);
+
+	linked = encoded = 0;
+	for (pque = (pbs_queue *)GET_NEXT(svr_queues); pque != NULL;
+		pque = (pbs_queue *)GET_NEXT(pque->qu_link)) {
+		linked++;
+		encoded += encoded_bytes(pque->qu_attr, QA_ATR_LAST);
+	}
+	snprintf(log_buffer, LOG_BUF_SIZE,
+		"queues allocated %ld linked %ld bytes %ld encoded %ld",
+		mem_stats_alloc[MEM_STATS_QUEUE], linked,
+		mem_stats_alloc[MEM_STATS_QUEUE] * (long)sizeof(pbs_queue), encoded);
+	log_event(PBSEVENT_SYSTEM | PBSEVENT_FORCE, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "mem_stats", log_buffer);
+
+	encoded = 0;
+	for (i = 0; i < svr_totnodes; i++)
+		encoded += encoded_bytes(pbsndlist[i]->nd_attr, ND_ATR_LAST);
+	snprintf(log_buffer, LOG_BUF_SIZE,
+		"nodes linked %d bytes %ld encoded %ld", svr_totnodes,
+		svr_totnodes * (long)sizeof(struct pbsnode), encoded);
+	log_event(PBSEVENT_SYSTEM | PBSEVENT_FORCE, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "mem_stats", log_buffer);
+
+	linked = 0;
+	for (phook = (hook *)GET_NEXT(svr_allhooks); phook != NULL;
+		phook = (hook *)GET_NEXT(phook->hi_allhooks))
+		linked++;
+	snprintf(log_buffer, LOG_BUF_SIZE, "hooks linked %ld bytes %ld",
+		linked, linked * (long)sizeof(hook));
+	log_event(PBSEVENT_SYSTEM | PBSEVENT_FORCE, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "mem_stats", log_buffer);
+
+	snprintf(log_buffer, LOG_BUF_SIZE, "server encoded %ld",
+		encoded_bytes(server.sv_attr, SRV_ATR_LAST));
+	log_event(PBSEVENT_SYSTEM | PBSEVENT_FORCE, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "mem_stats", log_buffer);
+
+	for (fl = freelist_all; fl != NULL; fl = fl->fl_next) {
+		snprintf(log_buffer, LOG_BUF_SIZE,
+			"freelist %s size %ld free %d malloc %ld reuse %ld",
+			fl->fl_name, (long)fl->fl_size, fl->fl_nfree,
+			fl->fl_malloc, fl->fl_reuse);
+		log_event(PBSEVENT_SYSTEM | PBSEVENT_FORCE, PBS_EVENTCLASS_SERVER,
+			LOG_INFO, "mem_stats", log_buffer);
+	}
+}
+
+/**
+ * @brief
+ * 		update_mod_seq - give an object the next modification sequence if
+ *		any of its attributes changed since it was last looked at.
+ *
+ * @par
+ *		ATR_MOD_STATUS is set on every change of a value, the status
+ *		cache uses it to know when to encode the value again.  Dropping the
+ *		cached encoding here keeps that working once the flag is cleared, so
+ *		this must be called before the attributes are encoded for a status.
+ *
+ * @param[in,out]	pattr	-	attribute array of the object
+ * @param[in]	limit	-	number of attributes in the array
+ * @param[in,out]	pseq	-	modification sequence of the object
+ *
+ * @return	void
+ */
+void
+update_mod_seq(attribute *pattr, int limit, long long *pseq)
+{
+	int	i;
+	int	changed = 0;
+
+	for (i = 0; i < limit; i++) {
+		/* a resource list also keeps an encoding per resource */
+		if ((pattr[i].at_type == ATR_TYPE_RESC) &&
+			(pattr[i].at_flags & ATR_VFLAG_SET) &&
+			update_resc_svrcache(&pattr[i]))
+			changed = 1;
+		if (pattr[i].at_flags & ATR_MOD_STATUS) {
+			free_svrcache(&pattr[i]);
+			clear_mod_status(&pattr[i]);
+			changed = 1;
+		}
+	}
+	if (changed)
+		*pseq = ++svr_mod_seq;
+}
+
+/**
+ * @brief
+ * 		record_mod_seq_delete - remember an object deleted from the server
+ *		for the changed since status.  Past SVR_MOD_SEQ_DELETED_MAX the
+ *		oldest is forgotten and a client asking for the changes since before
+ *		it is told to status everything again.
+ *
+ * @param[in]	objtype	-	MGR_OBJ_JOB, MGR_OBJ_NODE, MGR_OBJ_QUEUE or MGR_OBJ_RESV
+ * @param[in]	name	-	name of the deleted object
+ *
+ * @return	void
+ */
+void
+record_mod_seq_delete(int objtype, char *name)
+{
+	struct mod_seq_deleted *pdel;
+
+	pdel = malloc(sizeof(struct mod_seq_deleted));
+	if (pdel == NULL || (pdel->md_name = strdup(name)) == NULL) {
+		free(pdel);
+		/* the deletion can't be told, make the clients status everything */
+		log_err(errno, __func__, "no memory");
+		svr_mod_seq_floor = ++svr_mod_seq;
+		return;
+	}
+	CLEAR_LINK(pdel->md_link);
+	pdel->md_seq = ++svr_mod_seq;
+	pdel->md_objtype = objtype;
+	append_link(&svr_mod_seq_deleted, &pdel->md_link, pdel);
+
+	if (++svr_mod_seq_num_deleted > SVR_MOD_SEQ_DELETED_MAX) {
+		pdel = (struct mod_seq_deleted *)GET_NEXT(svr_mod_seq_deleted);
+		delete_link(&pdel->md_link);
+		svr_mod_seq_floor = pdel->md_seq;
+		free(pdel->md_name);
+		free(pdel);
+		svr_mod_seq_num_deleted--;
+	}
+}
@@ -72,17 +72,27 @@
  *		determine_accruetype() - determines accruetype
  *		alter_eligibletime() - resets sampletime of job
  *		eval_chkpnt()	   - insure job checkpoint .ge. queues min. time
+ *		svr_jobindex_link() - link a job into the per state and owner lists
+ *		svr_jobindex_unlink() - unlink a job from those lists
+ *		next_job_in_list() - next job in one of the lists a job is in
+ *		find_owner_jobs()  - list of jobs of an owner
+ *		svr_name_idx_oper() - add/delete an object in a server name index
+ *		svr_histjob_link() - link a history job into the list of them by age
+ *		job_stage_mark()   - record when a job reached a stage of its run
+ *		job_stage_log()    - log the time spent between the stages of a run
  *
  * Private functions
  *		chk_svr_resc_limit() - check job requirements againt queue/server limits
  *		default_std()	   - make the default name for standard out/error
  *		set_deflt_resc()   - set unspecified resource_limit to default values
  *		job_wait_over()	   - event handler for job_set_wait()
+ *		move_state_ct()	   - move a job between server/queue state counts
  */
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #ifndef WIN32
 #include <unistd.h>
+#include <sys/time.h>
 #endif
 #include <fcntl.h>
 #include <assert.h>
@@ -125,6 +135,7 @@
 #include "log.h"
 #include "acct.h"
 #include "avltree.h"
+#include "name_idx.h"
 #include "pbs_nodes.h"
 #include "svrfunc.h"
 #include "sched_cmds.h"
@@ -159,7 +170,15 @@ static void running_jobs_count(struct work_task *);
 
 
 /** For faster job lookup through AVL tree */
-static void svr_avljob_oper(job *pjob, int delkey);
+
+/* jobs of one owner, see svr_jobindex_link() */
+struct owner_jobs {
+	pbs_list_head	oj_jobs;	/* the owner's jobs, by rank */
+	int		oj_ct;		/* number of jobs in oj_jobs */
+};
+static AVL_IX_DESC *owner_jobs_tree = NULL;
+static pbs_list_link *job_list_link(job *, enum job_list);
+static void link_by_qrank(pbs_list_head *, job *, enum job_list);
 
 /* Global Data Items: */
 extern char *msg_noloopbackif;
@@ -202,6 +221,47 @@ extern void free_job_work_tasks(job *);
 static void correct_ct(pbs_queue *);
 #endif 	/* NDEBUG */
 
+/**
+ * @brief
+ * 		move_state_ct - move a job from its current state to newstate in the
+ *		server and queue job state counts, and in the per state job lists.
+ *		These counts are only ever maintained incrementally, here and in
+ *		svr_enquejob()/svr_dequejob(); nothing recounts them on the way to
+ *		a status reply.
+ *
+ * @param[in]	pjob	-	job changing state, ji_qs.ji_state still the old state
+ * @param[in]	newstate	-	state the job is moving to
+ */
+static void
+move_state_ct(job *pjob, int newstate)
+{
+	int oldstate = pjob->ji_qs.ji_state;
+	pbs_queue *pque = pjob->ji_qhdr;
+	int bad_ct = 0;
+
+	if (--server.sv_jobstates[oldstate] < 0)
+		bad_ct = 1;
+	server.sv_jobstates[newstate]++;
+	if (pjob->ji_statejobs.ll_next != &pjob->ji_statejobs) {
+		svr_jobindex_unlink(pjob, 0);
+		svr_jobindex_link(pjob, newstate);
+	}
+	if (pque != NULL) {
+		if (--pque->qu_njstate[oldstate] < 0)
+			bad_ct = 1;
+		pque->qu_njstate[newstate]++;
+	}
+
+#ifndef NDEBUG
+	if (bad_ct) {
+		/* correct_ct() recounts from ji_qs.ji_state, so set it first */
+		pjob->ji_qs.ji_state = newstate;
+		correct_ct(pque);
+		pjob->ji_qs.ji_state = oldstate;
+	}
+#endif	/* NDEBUG */
+}
+
 /**
  * @brief
  * 		clear the default resource from structures
@@ -285,10 +345,12 @@ svr_enquejob(job *pjob)
 			if (is_linked(&svr_alljobs, &pjob->ji_alljobs) == 0) {
 				append_link(&svr_alljobs, &pjob->ji_alljobs, pjob);
 				/**
-				 * Add to AVL tree so that find_job() can return
-				 * faster compared to linked list traverse.
+				 * Add to the job id index so that find_job() can
+				 * return faster compared to linked list traverse.
 				 */
-				svr_avljob_oper(pjob, 0);
+				svr_name_idx_oper(&jobs_idx, pjob->ji_qs.ji_jobid,
+					pjob, NAME_IDX_OP_ADD);
+				svr_jobindex_link(pjob, pjob->ji_qs.ji_state);
 			}
 			server.sv_qs.sv_numjobs++;
 			server.sv_jobstates[pjob->ji_qs.ji_state]++;
@@ -337,10 +399,10 @@ svr_enquejob(job *pjob)
 	}
 
 	/**
-	 * Add to AVL tree so that find_job() can return
+	 * Add to the job id index so that find_job() can return
 	 * faster compared to linked list traverse.
 	 */
-	svr_avljob_oper(pjob, 0);
+	svr_name_idx_oper(&jobs_idx, pjob->ji_qs.ji_jobid, pjob, NAME_IDX_OP_ADD);
 
 	server.sv_qs.sv_numjobs++;
 	server.sv_jobstates[pjob->ji_qs.ji_state]++;
@@ -372,6 +434,8 @@ svr_enquejob(job *pjob)
 
 	pque->qu_numjobs++;
 	pque->qu_njstate[pjob->ji_qs.ji_state]++;
+	svr_jobindex_link(pjob, pjob->ji_qs.ji_state);
+	svr_histjob_link(pjob);
 
 	if ((pjob->ji_qs.ji_state == JOB_STATE_MOVED) ||
 		(pjob->ji_qs.ji_state == JOB_STATE_FINISHED)) {
@@ -537,10 +601,11 @@ svr_dequejob(job *pjob)
 		delete_link(&pjob->ji_unlicjobs);
 
 		/**
-		 * Remove the key from the AVL tree which was
+		 * Remove the key from the job id index which was
 		 * added for faster job search i.e. find_job().
 		 */
-		svr_avljob_oper(pjob, 1);
+		svr_name_idx_oper(&jobs_idx, pjob->ji_qs.ji_jobid, pjob, NAME_IDX_OP_DEL);
+		svr_jobindex_unlink(pjob, 1);
 
 		if (--server.sv_qs.sv_numjobs < 0)
 			bad_ct = 1;
@@ -559,6 +624,7 @@ svr_dequejob(job *pjob)
 
 		if (is_linked(&pque->qu_jobs, &pjob->ji_jobque)) {
 			delete_link(&pjob->ji_jobque);
+			delete_link(&pjob->ji_questatejobs);
 			if (--pque->qu_numjobs < 0)
 				bad_ct = 1;
 			if (--pque->qu_njstate[pjob->ji_qs.ji_state] < 0)
@@ -629,13 +695,9 @@ svr_setjobstate(job *pjob, int newstate, int newsubstate)
 		if ((oldstate = pjob->ji_qs.ji_state) != (long)newstate) {
 
 			changed = 1;
-			server.sv_jobstates[oldstate]--;
-			server.sv_jobstates[newstate]++;
+			move_state_ct(pjob, newstate);
 			if (pque != NULL) {
 
-				pque->qu_njstate[oldstate]--;
-				pque->qu_njstate[newstate]++;
-
 				/*
 				 * if execution queue, and eligability to run
 				 * has improved, kick the scheduler.
@@ -2571,7 +2633,7 @@ correct_ct(pbs_queue *pqj)
 	(void)sprintf(log_buffer, "Job state counts incorrect, server %d: ",
 		server.sv_qs.sv_numjobs);
 	server.sv_qs.sv_numjobs = 0;
-	for (i=0; i<PBS_NUMJOBSTATE-4; ++i) {
+	for (i=0; i<PBS_NUMJOBSTATE; ++i) {
 		pc = log_buffer + strlen(log_buffer);
 		(void)sprintf(pc, "%d ", server.sv_jobstates[i]);
 		server.sv_jobstates[i] = 0;
@@ -2580,7 +2642,7 @@ correct_ct(pbs_queue *pqj)
 		pc = log_buffer + strlen(log_buffer);
 		(void)sprintf(pc, "; queue %s %d: ", pqj->qu_qs.qu_name,
 			pqj->qu_numjobs);
-		for (i=0; i<PBS_NUMJOBSTATE-4; ++i) {
+		for (i=0; i<PBS_NUMJOBSTATE; ++i) {
 			pc = log_buffer + strlen(log_buffer);
 			(void)sprintf(pc, "%d ", pqj->qu_njstate[i]);
 		}
@@ -2591,7 +2653,7 @@ correct_ct(pbs_queue *pqj)
 	for (pque = (pbs_queue *)GET_NEXT(svr_queues); pque;
 		pque = (pbs_queue *)GET_NEXT(pque->qu_link)) {
 		pque->qu_numjobs = 0;
-		for (i=0; i<PBS_NUMJOBSTATE-4; ++i)
+		for (i=0; i<PBS_NUMJOBSTATE; ++i)
 			pque->qu_njstate[i] = 0;
 	}
 
@@ -5020,9 +5082,23 @@ void
 svr_saveorpurge_finjobhist(job *pjob)
 {
 	int flag = 0;
+	int thin = 0;
+	struct ajtrk *ptrk;
 
 	flag = svr_chk_history_conf();
-	if (flag && !pjob->ji_deletehistory) {
+
+	job_stage_log(pjob);
+
+	/*
+	 * The history of a finished subjob may be kept in the tracking
+	 * table of its parent, instead of in the subjob itself.
+	 */
+	if (flag && pbs_conf.pbs_server_thin_subjob_history &&
+		(pjob->ji_qs.ji_svrflags & JOB_SVFLG_SubJob) &&
+		pjob->ji_parentaj && pjob->ji_parentaj->ji_ajtrk)
+		thin = 1;
+
+	if (flag && !pjob->ji_deletehistory && !thin) {
 		svr_setjob_histinfo(pjob, T_FIN_JOB);
 		if (pjob->ji_ajtrk)
 			pjob->ji_ajtrk->tkm_flags &= ~TKMFLG_CHK_ARRAY;
@@ -5050,148 +5126,171 @@ svr_saveorpurge_finjobhist(job *pjob)
 					pjob->ji_qs.ji_substate = JOB_SUBSTATE_FINISHED;
 			}
 		}
+		if (thin && !pjob->ji_deletehistory) {
+			ptrk = &pjob->ji_parentaj->ji_ajtrk->tkm_tbl[pjob->ji_subjindx];
+			ptrk->trk_runcount = pjob->ji_wattr[(int)JOB_ATR_runcount].at_val.at_long;
+			free(ptrk->trk_exechost);
+			ptrk->trk_exechost = NULL;
+			if (pjob->ji_wattr[(int)JOB_ATR_exec_host].at_flags & ATR_VFLAG_SET)
+				ptrk->trk_exechost = strdup(pjob->ji_wattr[(int)JOB_ATR_exec_host].at_val.at_str);
+		}
 		job_purge(pjob);
 	}
 }
 /**
  * @brief
- *		Function name: svr_clean_job_history
- * @par Purpose: Periodically checks for the history jobs in the server and
- *		 purge the history jobs whose history duration exceeds the
- *		 configured job_history_duration server attribute.
- * @par Functionality: It is a work_task and reschedule itself after 2 mins if
- *		 and only if job_history_enable is set.
- *		Output: None
+ * 		histjob_purgeable - whether a job is a history job that
+ *		svr_clean_job_history() purges once its history duration is over.
  *
- * @param[in]	pwt	-	work_task structure
+ * @param[in]	pjob	-	the job
+ *
+ * @return	int
+ * @retval	1	: it is
+ * @retval	0	: it is not
  */
-void
-svr_clean_job_history(struct work_task *pwt)
+static int
+histjob_purgeable(job *pjob)
 {
-	job 	*pjob;
-	job 	*nxpjob = NULL;
-	int 	walltime_used = 0;
-
-	/*
-	 * Keep track of time spent purging jobs, interrupts purge if necessary.
-	 * Timed task in nearby future set if purge took too long.
-	 * Timed task in far future only set if this task completes.
-	 * Autotunes time between job history purges:
-	 * - raised if last purge was short
-	 * - lowered if this purge needs to be interrupted
-	 */
-
-	time_t	begin_time;
-	time_t	end_time;
-	static time_t time_between_tasks = SVR_CLEAN_JOBHIST_TM;
-
-	begin_time = time(NULL);
-	/* Initialize end_time, in case we do not get into the while loop */
-	end_time = begin_time;
+	return ((pjob->ji_qs.ji_state == JOB_STATE_MOVED && pjob->ji_qs.ji_substate == JOB_SUBSTATE_FINISHED) ||
+		(pjob->ji_qs.ji_state == JOB_STATE_FINISHED) ||
+		(pjob->ji_qs.ji_state == JOB_STATE_EXPIRED));
+}
 
-	/*
-	 * Traverse through the SERVER job list and find the history
-	 * jobs (job with state JOB_STATE_MOVED and JOB_STATE_FINISHED)
-	 * which exceed the configured job_history_duration value and
-	 * purge them immediately.
-	 */
-	pjob = (job *)GET_NEXT(svr_alljobs);
+/**
+ * @brief
+ * 		svr_histjob_link - link a history job into svr_histjobs, the list of
+ *		the history jobs svr_clean_job_history() purges, in the order of
+ *		their history timestamps.  New history jobs have the latest time
+ *		stamp, so the list is searched from its end.  A job that is no
+ *		longer to be purged is unlinked.
+ *
+ * @param[in,out]	pjob	-	the job
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+void
+svr_histjob_link(job *pjob)
+{
+	job	*pjcur;
+	long	 stamp;
+	int	 walltime_used;
 
-	while (pjob != NULL) {
-		/* save the next job */
-		nxpjob = (job *)GET_NEXT(pjob->ji_alljobs);
-
-		if ((pjob->ji_qs.ji_state == JOB_STATE_MOVED && pjob->ji_qs.ji_substate == JOB_SUBSTATE_FINISHED) ||
-			(pjob->ji_qs.ji_state == JOB_STATE_FINISHED) ||
-			(pjob->ji_qs.ji_state == JOB_STATE_EXPIRED)) {
-
-			if (!(pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_flags & ATR_VFLAG_SET)) {
-				if (pjob->ji_qs.ji_state == JOB_STATE_MOVED)
-					pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long = time_now;
-				else {
-					if (((walltime_used = get_used_wall(pjob)) == -1) ||
-						!(pjob->ji_wattr[(int) JOB_ATR_stime].at_flags & ATR_VFLAG_SET)) {
-						log_err(-1, "svr_clean_job_history",
-							"Finished job missing start-time/walltime used, cannot clean history");
-						pjob = nxpjob;
-						continue;
-					}
-					pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long =
-						pjob->ji_wattr[(int) JOB_ATR_stime].at_val.at_long + walltime_used;
-				}
-				pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_flags |= ATR_VFLAG_SET | ATR_VFLAG_MODCACHE;
-				pjob->ji_modified = 1;
-				/* save the full job */
-				(void)job_save(pjob, SAVEJOB_FULL);
-			}
+	delete_link(&pjob->ji_histjobs);
+	if (!histjob_purgeable(pjob))
+		return;
 
-			if (time_now >= (pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long
-				+ svr_history_duration)) {
-				job_purge(pjob);
-				pjob = NULL;
+	if (!(pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_flags & ATR_VFLAG_SET)) {
+		if (pjob->ji_qs.ji_state == JOB_STATE_MOVED)
+			pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long = time_now;
+		else {
+			if (((walltime_used = get_used_wall(pjob)) == -1) ||
+				!(pjob->ji_wattr[(int) JOB_ATR_stime].at_flags & ATR_VFLAG_SET)) {
+				log_err(-1, __func__,
+					"Finished job missing start-time/walltime used, cannot clean history");
+				return;
 			}
+			pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long =
+				pjob->ji_wattr[(int) JOB_ATR_stime].at_val.at_long + walltime_used;
 		}
-		/* restore the saved next in pjob */
-		pjob = nxpjob;
+		pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_flags |= ATR_VFLAG_SET | ATR_VFLAG_MODCACHE;
+		pjob->ji_modified = 1;
+		/* save the full job */
+		(void)job_save(pjob, SAVEJOB_FULL);
+	}
+	stamp = pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long;
 
-		/* check if we spent too long hogging the pbs_server process here */
-		end_time = time(NULL);
-		if ((end_time - begin_time) > SVR_CLEAN_JOBHIST_SECS) {
-			/* Apparently the interval between history purges is too long.
-			 * reduce it using factor 0.7
-			 */
-			time_between_tasks = (floor((double)time_between_tasks * 0.7));
+	pjcur = (job *)GET_PRIOR(svr_histjobs);
+	while (pjcur) {
+		if (stamp >= pjcur->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long)
+			break;
+		pjcur = (job *)GET_PRIOR(pjcur->ji_histjobs);
+	}
+	if (pjcur == NULL)
+		insert_link(&svr_histjobs, &pjob->ji_histjobs, pjob, LINK_INSET_AFTER);
+	else
+		insert_link(&pjcur->ji_histjobs, &pjob->ji_histjobs, pjob,
+			LINK_INSET_AFTER);
+}
 
-			/* no use reducing to less than 4 * SVR_CLEAN_JOBHIST_SECS
-			 * since we'll already schedule a continuation task here
-			 */
-			if (time_between_tasks < (4 * SVR_CLEAN_JOBHIST_SECS))
-				time_between_tasks = 4 * SVR_CLEAN_JOBHIST_SECS;
+/**
+ * @brief
+ *		Function name: svr_clean_job_history
+ * @par Purpose: Periodically purges the history jobs whose history duration
+ *		 exceeds the configured job_history_duration server attribute.
+ * @par Functionality: It is a work_task.  History jobs are kept in
+ *		 svr_histjobs in the order they expire, so only the expired ones
+ *		 at the head of the list are looked at.  They are purged in one
+ *		 database transaction for at most SVR_CLEAN_JOBHIST_MSECS, then
+ *		 the task sets itself to continue in a second, letting requests
+ *		 be served in between.  Once none are left, it sets itself for when
+ *		 the next history job expires, at most 2 mins later, if and only if
+ *		 job_history_enable is set.
+ *		Output: None
+ *
+ * @param[in]	pwt	-	work_task structure
+ */
+void
+svr_clean_job_history(struct work_task *pwt)
+{
+	job		*pjob;
+	struct timeval	 begin_time;
+	struct timeval	 end_time;
+	long		 elapsed;
+	time_t		 next;
+	int		 in_trx = 0;
+	int		 n = 0;
+
+	gettimeofday(&begin_time, NULL);
+
+	while ((pjob = (job *)GET_NEXT(svr_histjobs)) != NULL) {
+		if (time_now < (pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long
+			+ svr_history_duration))
+			break;
 
-			/* set up another work task in near future,
-			 * but leave as much time as we spent in this routine for other work first
-			 */
-			if (!set_task(WORK_Timed,
-				(end_time + SVR_CLEAN_JOBHIST_SECS),
-				svr_clean_job_history, NULL)) {
-				log_err(errno,
-					"svr_clean_job_history",
-					"Unable to set task for clean job history");
-					/* on error to set task
-					 * just continue purging the history
-					 */
-			} else
-				/* but if we managed to set a task in near future, return;
-				 * that task will continue where we left off
-				 */
-				return;
-		}
-	} /* end of while loop through jobs */
+		if ((n == 0) && (pbs_db_begin_trx(svr_db_conn, 0, 0) == 0))
+			in_trx = 1;
+		job_purge(pjob);
 
-	/* We purged everything necessary in this task if we get here.
-	 * set up another work task for next time period.
-	 */
-	if (pwt && svr_history_enable) {
-		if (!set_task(WORK_Timed,
-			(time_now + time_between_tasks),
-			svr_clean_job_history, NULL)) {
-			log_err(errno,
-				"svr_clean_job_history",
-				"Unable to set task for clean job history");
+		/* check if we spent too long hogging the pbs_server process here */
+		if ((++n % 16) == 0) {
+			gettimeofday(&end_time, NULL);
+			elapsed = (end_time.tv_sec - begin_time.tv_sec) * 1000 +
+				(end_time.tv_usec - begin_time.tv_usec) / 1000;
+			if (elapsed >= SVR_CLEAN_JOBHIST_MSECS)
+				break;
 		}
 	}
 
-	/* try to move the time between tasks up again
-	 * but only if we spent less than 2/3rds of what we were allowed to spend
-	 * Note the last purge of a chain of purges will often tend to undo part of the lowering
-	 * in the earlier incomplete purges -- that's OK: 0.7*1.1 is still smaller than 1
-	 */
+	if (in_trx && (pbs_db_end_trx(svr_db_conn, PBS_DB_COMMIT) != 0)) {
+		sprintf(log_buffer, "Failed to purge history jobs ");
+		if (svr_db_conn->conn_db_err != NULL)
+			strncat(log_buffer, svr_db_conn->conn_db_err,
+				LOG_BUF_SIZE - strlen(log_buffer) - 1);
+		log_err(-1, __func__, log_buffer);
+		(void) pbs_db_end_trx(svr_db_conn, PBS_DB_ROLLBACK);
+		panic_stop_db(log_buffer);
+		return;
+	}
+
+	if (!pwt || !svr_history_enable)
+		return;
 
-	if ((time_between_tasks < SVR_CLEAN_JOBHIST_TM) &&
-	    ((end_time - begin_time) < floor((double)SVR_CLEAN_JOBHIST_SECS * 2/3))) {
-		time_between_tasks = ceil((double) time_between_tasks * 1.1);
-		if (time_between_tasks > SVR_CLEAN_JOBHIST_TM)
-			time_between_tasks = SVR_CLEAN_JOBHIST_TM;
+	/* continue in a second if interrupted, else when the next job expires */
+	next = time_now + SVR_CLEAN_JOBHIST_TM;
+	if (pjob != NULL) {
+		if (time_now >= (pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long
+			+ svr_history_duration))
+			next = time_now + 1;
+		else if ((pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long
+			+ svr_history_duration) < next)
+			next = pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long
+				+ svr_history_duration;
+	}
+	if (!set_task(WORK_Timed, next, svr_clean_job_history, NULL)) {
+		log_err(errno, __func__,
+			"Unable to set task for clean job history");
 	}
 }
 
@@ -5211,18 +5310,9 @@ svr_clean_job_history(struct work_task *pwt)
 void
 svr_histjob_update(job * pjob, int newstate, int newsubstate)
 {
-	int oldstate = pjob->ji_qs.ji_state;
-	pbs_queue *pque = pjob->ji_qhdr;
-
 	/* update the state count in queue and server */
-	if (oldstate != newstate) {
-		server.sv_jobstates[oldstate]--;
-		server.sv_jobstates[newstate]++;
-		if (pque != NULL) {
-			pque->qu_njstate[oldstate]--;
-			pque->qu_njstate[newstate]++;
-		}
-	}
+	if (pjob->ji_qs.ji_state != newstate)
+		move_state_ct(pjob, newstate);
 	/* set the job state and state char */
 	pjob->ji_qs.ji_state = newstate;
 	pjob->ji_qs.ji_substate = newsubstate;
@@ -5252,6 +5342,9 @@ svr_histjob_update(job * pjob, int newstate, int newsubstate)
 	pjob->ji_wattr[(int)JOB_ATR_substate].at_val.at_long = newsubstate;
 	pjob->ji_wattr[(int)JOB_ATR_substate].at_flags |= ATR_VFLAG_MODCACHE;
 
+	/* keep it where svr_clean_job_history() will find it */
+	svr_histjob_link(pjob);
+
 	/* save the full job */
 	(void)job_save(pjob, SAVEJOB_FULL);
 }
@@ -5557,61 +5650,19 @@ svr_chk_histjob(job *pjob)
 
 /**
  * @brief
- *		Creates the avl key from jobid string.
- *
- * @param[in]	keystr	-	jobid string
- *
- * @see
- * 		svr_enquejob()
- *		svr_dequejob()
- *		find_job()
- *
- * @return	Pointer to AVL_IX_REC record for success.
- * @retval	NULL	: failure.
- *
- * @par	Reentrancy:
- *		MT-unsafe
- *
- */
-AVL_IX_REC *
-svr_avlkey_create(const char *keystr)
-{
-	size_t keylen;
-	AVL_IX_REC *pkey;
-
-	if (keystr == NULL)
-		return NULL;
-
-	keylen = sizeof(AVL_IX_REC) + strlen(keystr) + 1;
-	pkey = malloc(keylen);
-	if (pkey == NULL)
-		return NULL;
-
-	memset((void *)pkey, 0, keylen);
-	(void)strcpy(pkey->key, keystr);
-	return (pkey);
-
-}
-
-/**
- * @brief
- *		Add/Delete the job to/from the AVL tree for faster lookup based
- *		on the boolean value of "delkey" parameter.
+ *		Add/Delete an object to/from one of the server's name indexes
+ *		(jobs_idx, resvs_idx, queues_idx or nodes_idx) based on "op".
  *
  * @par Functionality:
- *		Create the key for the avl record using svr_avlkey_create() and call
- *		avl_add_key()/avl_delete_key() based on the boolean value parameter
- *		i.e. "delkey" to add/delete the job to the AVL tree for faster lookup.
- *		If it fails in the AVL operation, then it destroys the AVL tree and
- *		turns off the global avl switch AVL_jctx, so that SERVER falls back
- *		to regular doubly linked list for lookup.
- *
- * @param[in]	pjob	-	job structure to be operated on.
- * @param[in]	delkey	-	0 to add the key.
- *							1 to delete the key.
+ *		If the index operation fails, the index is freed and the pointer
+ *		to it is set to NULL, so that SERVER falls back to the regular
+ *		doubly linked list (or array) for lookup of that kind of object.
+ *		A delete only removes the key if it still refers to "data".
  *
- * @par	Linkage scope:
- *		static (local)
+ * @param[in,out]	pidx	-	pointer to the index pointer
+ * @param[in]		key	-	name of the object
+ * @param[in]		data	-	the object
+ * @param[in]		op	-	NAME_IDX_OP_ADD or NAME_IDX_OP_DEL
  *
  * @see	svr_enquejob()
  *		svr_dequejob()
@@ -5622,57 +5673,30 @@ svr_avlkey_create(const char *keystr)
  *		MT-unsafe
  *
  */
-static void
-svr_avljob_oper(job *pjob, int delkey)
+void
+svr_name_idx_oper(name_idx **pidx, char *key, void *data, int op)
 {
-	int rc = AVL_IX_OK;
-	AVL_IX_REC *pkey;
-
-	if ((AVL_jctx == NULL) || (pjob == NULL))
+	if ((*pidx == NULL) || (key == NULL))
 		return;
 
-	/** create the avl key using jobid */
-	pkey = svr_avlkey_create(pjob->ji_qs.ji_jobid);
-	if (pkey == NULL) { /** key creation failed */
-		(void) sprintf(log_buffer, "AVL: failed to create job key.");
-		log_event(PBSEVENT_DEBUG4, PBS_EVENTCLASS_JOB, LOG_DEBUG,
-			pjob->ji_qs.ji_jobid, log_buffer);
-		goto AVL_OP_FAIL;
-	}
-
-	/** call avl interface based on the delkey */
-	if (delkey == 0) {
-		pkey->recptr = pjob;
-		rc = avl_add_key(pkey, AVL_jctx);
-	} else {
-		rc = avl_delete_key(pkey, AVL_jctx);
+	if (op == NAME_IDX_OP_DEL) {
+		if (find_name_idx(*pidx, key) == data)
+			(void) name_idx_add_del(*pidx, key, NULL, NAME_IDX_OP_DEL);
+		return;
 	}
-	if (rc != AVL_IX_OK) /** avl operation failed */
-		goto AVL_OP_FAIL;
-
-	/** everything went fine, free() the pkey and return */
-	free(pkey);
-	return;
+	if (name_idx_add_del(*pidx, key, data, NAME_IDX_OP_ADD) == 0)
+		return;
 
-AVL_OP_FAIL:
-	if (pkey) /** free the pkey if valid */
-		free(pkey);
 	/**
-	 * AVL operation failed, free the AVL tree context which was created
-	 * by avl_create_index(), and turn off the AVL context i.e. AVL_jctx
-	 * [global switch] so that SERVER will fall back to use linked list
-	 * for job lookup.
+	 * Index operation failed, free the index and turn it off
+	 * so that SERVER will fall back to use linked list for lookup.
 	 */
-	if (AVL_jctx != NULL) {
-		(void) sprintf(log_buffer,
-			"AVL: %s failed, using LinkedList.",
-			delkey ? "delete" : "insert");
-		log_event(PBSEVENT_DEBUG4, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
-			msg_daemonname, log_buffer);
-		avl_destroy_index(AVL_jctx);
-		free(AVL_jctx);
-		AVL_jctx = NULL;
-	}
+	(void) snprintf(log_buffer, sizeof(log_buffer),
+		"index: insert of %s failed, using LinkedList.", key);
+	log_event(PBSEVENT_DEBUG4, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
+		msg_daemonname, log_buffer);
+	free_name_idx(*pidx);
+	*pidx = NULL;
 }
 
 /**
@@ -6150,3 +6174,294 @@ recreate_exec_vnode_exit:
 
 	return (rc);
 }
+
+/**
+ * @brief
+ * 		job_list_link - the link of a job in one of the lists it is in.
+ *
+ * @param[in]	pjob	-	the job
+ * @param[in]	which	-	which list
+ *
+ * @return	pbs_list_link *
+ */
+static pbs_list_link *
+job_list_link(job *pjob, enum job_list which)
+{
+	switch (which) {
+		case JOB_LIST_QUEUE:
+			return (&pjob->ji_jobque);
+		case JOB_LIST_STATE:
+			return (&pjob->ji_statejobs);
+		case JOB_LIST_QUEUE_STATE:
+			return (&pjob->ji_questatejobs);
+		case JOB_LIST_OWNER:
+			return (&pjob->ji_ownerjobs);
+		case JOB_LIST_ACTIVE:
+			return (&pjob->ji_actjobs);
+		case JOB_LIST_QUEUE_ACTIVE:
+			return (&pjob->ji_queactjobs);
+		default:
+			return (&pjob->ji_alljobs);
+	}
+}
+
+/**
+ * @brief
+ * 		next_job_in_list - the job after pjob in one of the lists it is in.
+ *
+ * @param[in]	pjob	-	the job
+ * @param[in]	which	-	which list
+ *
+ * @return	job *
+ * @retval	NULL	: pjob is the last job of the list
+ */
+job *
+next_job_in_list(job *pjob, enum job_list which)
+{
+	return ((job *)GET_NEXT(*job_list_link(pjob, which)));
+}
+
+/**
+ * @brief
+ * 		link_by_qrank - link a job into one of its lists in queue rank order,
+ *		as svr_enquejob() does for the server and queue lists.  The list is
+ *		searched from its end, where new jobs go.
+ *
+ * @param[in,out]	phead	-	head of the list
+ * @param[in,out]	pjob	-	job to link
+ * @param[in]	which	-	which of the job's links
+ *
+ * @return	void
+ */
+static void
+link_by_qrank(pbs_list_head *phead, job *pjob, enum job_list which)
+{
+	job		*pjcur;
+	unsigned long	 rank;
+
+	rank = (unsigned long)pjob->ji_wattr[(int)JOB_ATR_qrank].at_val.at_long;
+	pjcur = (job *)GET_PRIOR(*phead);
+	while (pjcur) {
+		if (rank >= (unsigned long)pjcur->ji_wattr[(int)JOB_ATR_qrank].at_val.at_long)
+			break;
+		pjcur = (job *)GET_PRIOR(*job_list_link(pjcur, which));
+	}
+	if (pjcur == NULL)
+		insert_link(phead, job_list_link(pjob, which), pjob, LINK_INSET_AFTER);
+	else
+		insert_link(job_list_link(pjcur, which), job_list_link(pjob, which),
+			pjob, LINK_INSET_AFTER);
+}
+
+/**
+ * @brief
+ * 		svr_jobindex_link - link a job into the server's and its queue's list
+ *		of jobs in a state, and into the list of jobs of its owner.  These
+ *		let req_selectjobs() look at only the jobs that can match.  A job
+ *		not in a history state is also kept in the server's and its queue's
+ *		list of such jobs, so status and select without history jobs do not
+ *		walk the history jobs.
+ *
+ * @param[in,out]	pjob	-	job to link
+ * @param[in]	state	-	state the job is in or going to
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+void
+svr_jobindex_link(job *pjob, int state)
+{
+	struct owner_jobs *poj;
+	char		   owner[PBS_MAXUSER + 1];
+
+	if ((state < 0) || (state >= PBS_NUMJOBSTATE))
+		return;
+
+	link_by_qrank(&svr_jobs_bystate[state], pjob, JOB_LIST_STATE);
+	if (pjob->ji_qhdr != NULL)
+		link_by_qrank(&pjob->ji_qhdr->qu_jobs_bystate[state], pjob,
+			JOB_LIST_QUEUE_STATE);
+
+	if ((state == JOB_STATE_FINISHED) || (state == JOB_STATE_MOVED)) {
+		delete_link(&pjob->ji_actjobs);
+		delete_link(&pjob->ji_queactjobs);
+	} else if (pjob->ji_actjobs.ll_next == &pjob->ji_actjobs) {
+		link_by_qrank(&svr_actjobs, pjob, JOB_LIST_ACTIVE);
+		if (pjob->ji_qhdr != NULL)
+			link_by_qrank(&pjob->ji_qhdr->qu_actjobs, pjob,
+				JOB_LIST_QUEUE_ACTIVE);
+	}
+
+	if ((pjob->ji_ownerjobs.ll_next != &pjob->ji_ownerjobs) ||
+		((pjob->ji_wattr[(int)JOB_ATR_job_owner].at_flags & ATR_VFLAG_SET) == 0))
+		return;
+	get_jobowner(pjob->ji_wattr[(int)JOB_ATR_job_owner].at_val.at_str, owner);
+	if (owner_jobs_tree == NULL) {
+		if ((owner_jobs_tree = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL)
+			return;
+	}
+	if ((poj = (struct owner_jobs *)find_tree(owner_jobs_tree, owner)) == NULL) {
+		if ((poj = malloc(sizeof(struct owner_jobs))) == NULL) {
+			log_err(errno, __func__, "no memory");
+			return;
+		}
+		CLEAR_HEAD(poj->oj_jobs);
+		poj->oj_ct = 0;
+		if (tree_add_del(owner_jobs_tree, owner, poj, TREE_OP_ADD) != 0) {
+			free(poj);
+			return;
+		}
+	}
+	link_by_qrank(&poj->oj_jobs, pjob, JOB_LIST_OWNER);
+	poj->oj_ct++;
+}
+
+/**
+ * @brief
+ * 		svr_jobindex_unlink - unlink a job from the lists svr_jobindex_link()
+ *		put it in.  The owner entry is kept for the owner's next jobs.
+ *
+ * @param[in,out]	pjob	-	job to unlink
+ * @param[in]	owner_too	-	also unlink it from its owner's list and the
+ *					lists of jobs not history
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+void
+svr_jobindex_unlink(job *pjob, int owner_too)
+{
+	struct owner_jobs *poj;
+	char		   owner[PBS_MAXUSER + 1];
+
+	delete_link(&pjob->ji_statejobs);
+	delete_link(&pjob->ji_questatejobs);
+
+	if (!owner_too)
+		return;
+	delete_link(&pjob->ji_actjobs);
+	delete_link(&pjob->ji_queactjobs);
+	if (pjob->ji_ownerjobs.ll_next == &pjob->ji_ownerjobs)
+		return;
+	delete_link(&pjob->ji_ownerjobs);
+	if (owner_jobs_tree == NULL)
+		return;
+	get_jobowner(pjob->ji_wattr[(int)JOB_ATR_job_owner].at_val.at_str, owner);
+	if ((poj = (struct owner_jobs *)find_tree(owner_jobs_tree, owner)) != NULL)
+		poj->oj_ct--;
+}
+
+/**
+ * @brief
+ * 		find_owner_jobs - find the list of jobs of an owner.
+ *
+ * @param[in]	owner	-	owner name without @host
+ * @param[out]	ct	-	number of jobs in the list
+ *
+ * @return	pbs_list_head *
+ * @retval	NULL	: the owner has no jobs
+ */
+pbs_list_head *
+find_owner_jobs(char *owner, int *ct)
+{
+	struct owner_jobs *poj = NULL;
+
+	if (owner_jobs_tree != NULL)
+		poj = (struct owner_jobs *)find_tree(owner_jobs_tree, owner);
+	if (poj == NULL) {
+		*ct = 0;
+		return (NULL);
+	}
+	*ct = poj->oj_ct;
+	return (&poj->oj_jobs);
+}
+
+/**
+ * @brief
+ *		Record that a job reached a stage of its run now, and forget the
+ *		later stages an earlier run of the job reached.  The job id
+ *		follows the job through all the daemons' logs; these times give
+ *		the server's part of the breakdown, see job_stage_log().
+ *
+ * @param[in]	pjob	- the job
+ * @param[in]	stage	- the stage reached
+ *
+ * @return	void
+ */
+void
+job_stage_mark(job *pjob, enum job_stage stage)
+{
+	int	i;
+#ifdef	WIN32
+	struct	_timeb	tval;
+
+	_ftime_s(&tval);
+	pjob->ji_stagems[stage] = (tval.time * 1000LL) + tval.millitm;
+#else
+	struct	timeval	tval;
+
+	gettimeofday(&tval, NULL);
+	pjob->ji_stagems[stage] = (tval.tv_sec * 1000LL) + (tval.tv_usec / 1000);
+#endif
+	for (i = stage + 1; i < JOB_STAGE_NUM; i++)
+		pjob->ji_stagems[i] = 0;
+}
+
+/**
+ * @brief
+ *		Log the milliseconds a job took from each recorded stage of its
+ *		last run to the next one, and from the last stage to now.
+ *		Stages not reached, or reached before a server restart, are left
+ *		out.  Called when the job is done, i.e. when it is finished into
+ *		history or purged, whichever comes first; the stages are cleared
+ *		so it is only logged once.
+ *
+ * @param[in]	pjob	- the job
+ *
+ * @return	void
+ */
+void
+job_stage_log(job *pjob)
+{
+	static char *stage_names[JOB_STAGE_NUM] = {
+		"queued", "runrequest", "sent", "started", "running", "obit"
+	};
+	char		msg[LOG_BUF_SIZE];
+	int		len;
+	int		i;
+	long long	prev = 0;
+	long long	now;
+#ifdef	WIN32
+	struct	_timeb	tval;
+
+	_ftime_s(&tval);
+	now = (tval.time * 1000LL) + tval.millitm;
+#else
+	struct	timeval	tval;
+
+	gettimeofday(&tval, NULL);
+	now = (tval.tv_sec * 1000LL) + (tval.tv_usec / 1000);
+#endif
+
+	len = snprintf(msg, sizeof(msg), "Run stages (msec):");
+	for (i = 0; i < JOB_STAGE_NUM; i++) {
+		if (pjob->ji_stagems[i] == 0)
+			continue;
+		if (prev != 0)
+			len += snprintf(msg + len, sizeof(msg) - len, " +%lld %s",
+				pjob->ji_stagems[i] - prev, stage_names[i]);
+		else
+			len += snprintf(msg + len, sizeof(msg) - len, " %s",
+				stage_names[i]);
+		prev = pjob->ji_stagems[i];
+	}
+	if (prev == 0)
+		return;
+	snprintf(msg + len, sizeof(msg) - len, " +%lld done", now - prev);
+	log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_INFO,
+		pjob->ji_qs.ji_jobid, msg);
+	for (i = 0; i < JOB_STAGE_NUM; i++)
+		pjob->ji_stagems[i] = 0;
+}
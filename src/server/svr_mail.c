@@ -48,6 +48,12 @@
  *		write3_smtp_data()
  *		send_mail()
  *		send_mail_detach()
+ *		exec_sendmail()
+ *		mail_read()
+ *		mail_group_send()
+ *		mail_worker()
+ *		mail_worker_start()
+ *		mail_deliver()
  *		svr_mailowner_id()
  *		svr_mailowner()
  *		svr_mailownerResv()
@@ -62,6 +68,15 @@
 #include <unistd.h>
 #include <errno.h>
 #include <sys/types.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#endif
 #include "pbs_ifl.h"
 #include "list_link.h"
 #include "attribute.h"
@@ -78,6 +93,7 @@
 #include "reservation.h"
 #include "server.h"
 #include "rpp.h"
+#include "libutil.h"
 
 
 /* External Functions Called */
@@ -564,14 +580,454 @@ err:
 }
 #endif	/* WIN32 */
 
+#ifndef WIN32
+/*
+ * Mail is handed over a pipe to the mail worker, a child the server forks
+ * once, rather than forking the server for every mail.  The worker gathers
+ * the mail for the same sender and receivers that arrives within
+ * MAIL_COALESCE_TIME seconds into one message and runs sendmail for it.
+ */
+#define MAIL_COALESCE_TIME	2	/* seconds mail waits for more like it */
+#define MAIL_GROUPS_MAX		64	/* receivers that may have mail waiting */
+#define MAIL_BODY_MAX		65536	/* size at which waiting mail is sent */
+
+/* a mail on the pipe: this header, then from, to, subject and body */
+struct mail_rec {
+	int	mr_len[4];	/* length of each string, with its null */
+};
+
+/* the mail waiting in the worker for one sender and receivers */
+struct mail_group {
+	char	*mg_from;
+	char	*mg_to;
+	char	*mg_subject;
+	char	*mg_body;
+	size_t	 mg_bodylen;
+	int	 mg_count;	/* mails gathered */
+	time_t	 mg_first;	/* when the first one arrived */
+};
+
+static int mail_worker_fd = -1;	/* server's end of the pipe */
+
+/**
+ * @brief
+ *	pthread_atfork() child handler: FD_CLOEXEC covers only the children
+ *	that exec, a child of the server that does not (a send_job or hook
+ *	child, a mail sent by a child of its own) must not hold the worker's
+ *	pipe open either, the worker would not see the server go.
+ */
+static void
+mail_worker_atfork_child(void)
+{
+	if (mail_worker_fd != -1) {
+		(void)close(mail_worker_fd);
+		mail_worker_fd = -1;
+	}
+}
+
+/**
+ * @brief
+ * 		run sendmail for one message, piping the To, Subject and body to it
+ *
+ * @param[in]	mailfrom	-	sender of the mail
+ * @param[in]	mailto	-	receivers of the mail
+ * @param[in]	subject	-	subject of the mail
+ * @param[in]	body	-	the body text of the mail message
+ *
+ * @return	int
+ * @retval	0	: sendmail was given the message
+ * @retval	-1	: error
+ */
+static int
+exec_sendmail(char *mailfrom, char *mailto, char *subject, char *body)
+{
+	FILE   *outmail;
+	char   *margs[5];
+	int     mfds[2];
+	pid_t   mcpid;
+
+	/* setup sendmail command line with -f from_whom */
+
+	margs[0] = SENDMAIL_CMD;
+	margs[1] = "-f";
+	margs[2] = mailfrom;
+	margs[3] = mailto;
+	margs[4] = NULL;
+
+	if (pipe(mfds) == -1)
+		return -1;
+
+	mcpid = fork();
+	if (mcpid == 0) {
+		/* this child will be sendmail with its stdin set to the pipe */
+		(void)close(mfds[1]);
+		if (mfds[0] != 0) {
+			(void)close(0);
+			if (dup(mfds[0]) == -1)
+				exit(1);
+		}
+		(void)close(1);
+		(void)close(2);
+		if (execv(SENDMAIL_CMD, margs) == -1)
+			exit(1);
+	}
+	(void)close(mfds[0]);
+	if (mcpid == -1) {/* Error on fork */
+		log_err(errno, __func__, "fork failed\n");
+		(void)close(mfds[1]);
+		return -1;
+	}
+
+	/* write the message on the pipe */
+	outmail = fdopen(mfds[1], "w");
+	if (outmail == NULL) {
+		(void)close(mfds[1]);
+		return -1;
+	}
+
+	/* Pipe in mail headers: To: and Subject: */
+
+	fprintf(outmail, "To: %s\n", mailto);
+	fprintf(outmail, "Subject: %s\n\n", subject);
+	fputs(body, outmail);
+	fclose(outmail);
+	return 0;
+}
+
+/**
+ * @brief
+ * 		read exactly len bytes from the mail pipe
+ *
+ * @param[in]	fd	-	the pipe
+ * @param[out]	buf	-	where to put the bytes
+ * @param[in]	len	-	how many to read
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: end of file or error
+ */
+static int
+mail_read(int fd, void *buf, size_t len)
+{
+	char	*p = buf;
+	ssize_t	 n;
+
+	while (len > 0) {
+		n = read(fd, p, len);
+		if ((n == -1) && (errno == EINTR))
+			continue;
+		if (n <= 0)
+			return -1;
+		p += n;
+		len -= n;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ * 		send the mail gathered for a group and remove it from the list
+ *
+ * @par
+ *		More than one mail goes out as a single message holding each
+ *		body in turn, with the subject of the first.
+ *
+ * @param[in,out]	groups	-	the waiting mail
+ * @param[in,out]	ngroups	-	number of entries in groups
+ * @param[in]	i	-	the entry to send
+ */
+static void
+mail_group_send(struct mail_group *groups, int *ngroups, int i)
+{
+	struct mail_group *pg = &groups[i];
+	char	*subject = pg->mg_subject;
+	char	*more = NULL;
+
+	if ((pg->mg_count > 1) && (pbs_asprintf(&more, "%s and %d more",
+		pg->mg_subject, pg->mg_count - 1) != -1))
+		subject = more;
+	(void)exec_sendmail(pg->mg_from, pg->mg_to, subject, pg->mg_body);
+
+	free(more);
+	free(pg->mg_from);
+	free(pg->mg_to);
+	free(pg->mg_subject);
+	free(pg->mg_body);
+	(*ngroups)--;
+	memmove(pg, pg + 1, (*ngroups - i) * sizeof(struct mail_group));
+}
+
+/**
+ * @brief
+ * 		the mail worker: read mail from the server until it closes the
+ *		pipe, gathering mail for the same sender and receivers, and send
+ *		each group once it has waited MAIL_COALESCE_TIME seconds
+ *
+ * @param[in]	rfd	-	worker's end of the pipe
+ *
+ * @return	void, does not return
+ */
+static void
+mail_worker(int rfd)
+{
+	struct mail_group groups[MAIL_GROUPS_MAX];
+	struct mail_group *pg = NULL;
+	struct mail_rec rec;
+	char	*field[4];
+	char	*nbody;
+	int	 ngroups = 0;
+	int	 eof = 0;
+	int	 i;
+	int	 j;
+	time_t	 now;
+	fd_set	 rset;
+	struct timeval tv;
+	struct timeval *ptv;
+
+	while (!eof) {
+		/* the groups are in order of arrival, wake for the oldest */
+		ptv = NULL;
+		if (ngroups > 0) {
+			now = time(NULL);
+			tv.tv_sec = groups[0].mg_first + MAIL_COALESCE_TIME - now;
+			if (tv.tv_sec < 0)
+				tv.tv_sec = 0;
+			tv.tv_usec = 0;
+			ptv = &tv;
+		}
+		FD_ZERO(&rset);
+		FD_SET(rfd, &rset);
+		i = select(rfd + 1, &rset, NULL, NULL, ptv);
+		if ((i == -1) && (errno != EINTR))
+			eof = 1;
+
+		if ((i > 0) && (mail_read(rfd, &rec, sizeof(rec)) != 0))
+			eof = 1;
+		else if (i > 0) {
+			for (j = 0; j < 4; j++) {
+				field[j] = malloc(rec.mr_len[j]);
+				if ((field[j] == NULL) ||
+					(mail_read(rfd, field[j], rec.mr_len[j]) != 0)) {
+					free(field[j]);
+					eof = 1;
+					break;
+				}
+				field[j][rec.mr_len[j] - 1] = '\0';
+			}
+			if (eof) {
+				while (--j >= 0)
+					free(field[j]);
+				continue;
+			}
+
+			for (i = 0; i < ngroups; i++) {
+				if ((strcmp(groups[i].mg_from, field[0]) == 0) &&
+					(strcmp(groups[i].mg_to, field[1]) == 0))
+					break;
+			}
+			nbody = NULL;
+			if (i < ngroups) {
+				pg = &groups[i];
+				nbody = realloc(pg->mg_body,
+					pg->mg_bodylen + rec.mr_len[3] + 1);
+			}
+			if (nbody != NULL) {
+				/* a blank line between the mails */
+				pg->mg_body = nbody;
+				nbody[pg->mg_bodylen++] = '\n';
+				strcpy(nbody + pg->mg_bodylen, field[3]);
+				pg->mg_bodylen += rec.mr_len[3] - 1;
+				pg->mg_count++;
+				free(field[0]);
+				free(field[1]);
+				free(field[2]);
+				free(field[3]);
+				if (pg->mg_bodylen >= MAIL_BODY_MAX)
+					mail_group_send(groups, &ngroups, i);
+			} else {
+				if (i < ngroups)
+					mail_group_send(groups, &ngroups, i);
+				if (ngroups == MAIL_GROUPS_MAX)
+					mail_group_send(groups, &ngroups, 0);
+				pg = &groups[ngroups++];
+				pg->mg_from = field[0];
+				pg->mg_to = field[1];
+				pg->mg_subject = field[2];
+				pg->mg_body = field[3];
+				pg->mg_bodylen = rec.mr_len[3] - 1;
+				pg->mg_count = 1;
+				pg->mg_first = time(NULL);
+			}
+		}
+
+		/* send what has waited long enough, or all of it at the end */
+		now = time(NULL);
+		while ((ngroups > 0) &&
+			(eof || (groups[0].mg_first + MAIL_COALESCE_TIME <= now)))
+			mail_group_send(groups, &ngroups, 0);
+
+		/* and reap the sendmail children */
+		while (waitpid(-1, NULL, WNOHANG) > 0)
+			;
+	}
+
+	/* the server is gone, send what is left */
+	while (ngroups > 0)
+		mail_group_send(groups, &ngroups, 0);
+	exit(0);
+}
+
+/**
+ * @brief
+ * 		fork the mail worker and keep the writing end of its pipe
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: error
+ */
+static int
+mail_worker_start(void)
+{
+	static int registered = 0;
+	int	pfds[2];
+	pid_t	pid;
+
+	if (!registered) {
+		(void)pthread_atfork(NULL, NULL, mail_worker_atfork_child);
+		registered = 1;
+	}
+	if (pipe(pfds) == -1) {
+		log_err(errno, __func__, "pipe failed");
+		return -1;
+	}
+	pid = fork();
+	if (pid == -1) {
+		log_err(errno, __func__, "fork failed");
+		(void)close(pfds[0]);
+		(void)close(pfds[1]);
+		return -1;
+	}
+	if (pid == 0) {
+		/*
+		 * From here on, we are a child process of the server.
+		 * Fix up file descriptors and signal handlers.
+		 */
+		(void)close(pfds[1]);
+		net_close(-1);
+		if (pfn_rpp_terminate)
+			rpp_terminate();
+
+		/* Unprotect child from being killed by kernel */
+		daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
+
+		/* the worker reaps its own sendmail children */
+		(void)signal(SIGCHLD, SIG_DFL);
+		(void)signal(SIGHUP, SIG_IGN);
+		(void)signal(SIGINT, SIG_DFL);
+		(void)signal(SIGTERM, SIG_DFL);
+		mail_worker(pfds[0]);
+	}
+
+	(void)close(pfds[0]);
+	(void)fcntl(pfds[1], F_SETFD, FD_CLOEXEC);
+	(void)fcntl(pfds[1], F_SETFL, O_NONBLOCK);
+	mail_worker_fd = pfds[1];
+
+	sprintf(log_buffer, "mail worker started, pid %d", (int)pid);
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO,
+		msg_daemonname, log_buffer);
+	return 0;
+}
+
+/**
+ * @brief
+ * 		deliver a mail, through the mail worker when it can take it
+ *
+ * @par
+ *		A mail that does not fit in one write to the pipe, or finds the
+ *		pipe full, is sent the old way by a child of its own.  A worker
+ *		found gone is started again for the next mail.
+ *
+ * @param[in]	mailfrom	-	sender of the mail
+ * @param[in]	mailto	-	receivers of the mail
+ * @param[in]	subject	-	subject of the mail
+ * @param[in]	body	-	the body text of the mail message
+ *
+ * @return	void
+ */
+static void
+mail_deliver(char *mailfrom, char *mailto, char *subject, char *body)
+{
+	struct mail_rec rec;
+	char	 buf[PIPE_BUF];
+	char	*field[4];
+	size_t	 len = sizeof(rec);
+	ssize_t	 n;
+	pid_t	 pid;
+	int	 i;
+
+	field[0] = mailfrom;
+	field[1] = mailto;
+	field[2] = subject;
+	field[3] = body;
+	for (i = 0; i < 4; i++) {
+		rec.mr_len[i] = strlen(field[i]) + 1;
+		len += rec.mr_len[i];
+	}
+
+	/* up to PIPE_BUF bytes are written whole or not at all */
+	if (len <= sizeof(buf)) {
+		if (mail_worker_fd == -1)
+			(void)mail_worker_start();
+		if (mail_worker_fd != -1) {
+			memcpy(buf, &rec, sizeof(rec));
+			len = sizeof(rec);
+			for (i = 0; i < 4; i++) {
+				memcpy(buf + len, field[i], rec.mr_len[i]);
+				len += rec.mr_len[i];
+			}
+			n = write(mail_worker_fd, buf, len);
+			if (n == (ssize_t)len)
+				return;
+			if ((n == -1) && (errno != EAGAIN) && (errno != EINTR)) {
+				log_err(errno, __func__, "mail worker gone");
+				(void)close(mail_worker_fd);
+				mail_worker_fd = -1;
+			}
+		}
+	}
+
+	pid = fork();
+	if (pid == -1) { /* Error on fork */
+		log_err(errno, __func__, "fork failed\n");
+		return;
+	}
+	if (pid > 0)
+		return;		/* its all up to the child now */
+
+	/*
+	 * From here on, we are a child process of the server.
+	 * Fix up file descriptors and signal handlers.
+	 */
+	net_close(-1);
+	if (pfn_rpp_terminate)
+		rpp_terminate();
+
+	/* Unprotect child from being killed by kernel */
+	daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
+
+	exit(exec_sendmail(mailfrom, mailto, subject, body) == 0 ? 0 : 1);
+}
+#endif	/* ! WIN32 */
+
 #define MAIL_ADDR_BUF_LEN 1024
 /**
  * @brief
  * 		Send mail to owner of a job when an event happens that
  *		requires mail, such as the job starts, ends or is aborted.
  *		The event is matched against those requested by the user.
- *		For Unix/Linux, a child is forked to not hold up the Server.  This child
- *		will fork/exec sendmail and pipe the To, Subject and body to it.
+ *		For Unix/Linux, the mail is handed to mail_deliver() so as to not
+ *		hold up the Server.
  *
  * @param[in]	jid	-	the Job ID (string)
  * @param[in]	pjob	-	pointer to the job structure
@@ -595,10 +1051,8 @@ svr_mailowner_id(char *jid, job *pjob, int mailpoint, int force, char *text)
 	extern  char server_host[];
 
 #ifndef WIN32
-	FILE   *outmail;
-	char   *margs[5];
-	int     mfds[2];
-	pid_t   mcpid;
+	char	*subject = NULL;
+	char	*body = NULL;
 #endif
 
 	/* if force is true, force the mail out regardless of mailpoint */
@@ -633,33 +1087,6 @@ svr_mailowner_id(char *jid, job *pjob, int mailpoint, int force, char *text)
 		}
 	}
 
-	/*
-	 * ok, now we will fork a process to do the mailing to not
-	 * hold up the server's other work.
-	 */
-
-#ifndef WIN32
-	mcpid = fork();
-	if (mcpid == -1) { /* Error on fork */
-		log_err(errno, __func__, "fork failed\n");
-		return;
-	}
-	if (mcpid > 0)
-		return;		/* its all up to the child now */
-
-	/*
-	 * From here on, we are a child process of the server.
-	 * Fix up file descriptors and signal handlers.
-	 */
-	net_close(-1);
-	if (pfn_rpp_terminate)
-		rpp_terminate();
-
-	/* Unprotect child from being killed by kernel */
-	daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
-
-#endif	/* ! WIN32 */
-
 	/* Who is mail from, if SVR_ATR_mailfrom not set use default */
 
 	if ((mailfrom = server.sv_attr[(int)SRV_ATR_mailfrom].at_val.at_str)==0)
@@ -743,52 +1170,7 @@ svr_mailowner_id(char *jid, job *pjob, int mailpoint, int force, char *text)
 		text);
 
 #else
-	/* setup sendmail command line with -f from_whom */
-
-	margs[0] = SENDMAIL_CMD;
-	margs[1] = "-f";
-	margs[2] = mailfrom;
-	margs[3] = mailto;
-	margs[4] = NULL;
-
-	if (pipe(mfds) == -1)
-		exit(1);
-
-	mcpid = fork();
-	if(mcpid == 0) {
-		/* this child will be sendmail with its stdin set to the pipe */
-		if (mfds[0] != 0) {
-			(void)close(0);
-			if (dup(mfds[0]) == -1)
-				exit(1);
-		}
-		(void)close(1);
-		(void)close(2);
-		if (execv(SENDMAIL_CMD, margs) == -1)
-			exit(1);
-	}
-	if (mcpid == -1) {/* Error on fork */
-		log_err(errno, __func__, "fork failed\n");
-		(void)close(mfds[0]);
-		exit(1);
-	}
-
-	/* parent (not the real server though) will write body of message on pipe */
-	(void)close(mfds[0]);
-	outmail = fdopen(mfds[1], "w");
-	if (outmail == NULL)
-		exit(1);
-
-	/* Pipe in mail headers: To: and Subject: */
-
-	fprintf(outmail, "To: %s\n", mailto);
-
-	if (pjob)
-		fprintf(outmail, "Subject: PBS JOB %s\n\n", jid);
-	else
-		fprintf(outmail, "Subject: PBS Server on %s\n\n", server_host);
-
-	/* Now pipe in "standard" message */
+	/* Now the "standard" message */
 
 	switch (mailpoint) {
 
@@ -811,17 +1193,21 @@ svr_mailowner_id(char *jid, job *pjob, int mailpoint, int force, char *text)
 	}
 
 	if (pjob) {
-		fprintf(outmail, "PBS Job Id: %s\n", jid);
-		fprintf(outmail, "Job Name:   %s\n",
-			pjob->ji_wattr[(int)JOB_ATR_jobname].at_val.at_str);
+		(void)pbs_asprintf(&subject, "PBS JOB %s", jid);
+		(void)pbs_asprintf(&body, "PBS Job Id: %s\nJob Name:   %s\n%s%s%s%s",
+			jid, pjob->ji_wattr[(int)JOB_ATR_jobname].at_val.at_str,
+			stdmessage ? stdmessage : "", stdmessage ? "\n" : "",
+			text ? text : "", text ? "\n" : "");
+	} else {
+		(void)pbs_asprintf(&subject, "PBS Server on %s", server_host);
+		(void)pbs_asprintf(&body, "%s%s%s%s",
+			stdmessage ? stdmessage : "", stdmessage ? "\n" : "",
+			text ? text : "", text ? "\n" : "");
 	}
-	if (stdmessage)
-		fprintf(outmail, "%s\n", stdmessage);
-	if (text != NULL)
-		fprintf(outmail, "%s\n", text);
-	fclose(outmail);
-
-	exit(0);
+	if ((subject != NULL) && (body != NULL))
+		mail_deliver(mailfrom, mailto, subject, body);
+	free(subject);
+	free(body);
 #endif	/* WIN32 */
 }
 /**
@@ -829,8 +1215,8 @@ svr_mailowner_id(char *jid, job *pjob, int mailpoint, int force, char *text)
  * 		svr_mailowner - Send mail to owner of a job when an event happens that
  *		requires mail, such as the job starts, ends or is aborted.
  *		The event is matched against those requested by the user.
- *		For Unix/Linux, a child is forked to not hold up the Server.  This child
- *		will fork/exec sendmail and pipe the To, Subject and body to it.
+ *		For Unix/Linux, the mail is handed to mail_deliver() so as to not
+ *		hold up the Server.
  *
  * @param[in]	pjob	-	ptr to job (null for server based mail)
  * @param[in]	mailpoint	-	note, single character
@@ -848,8 +1234,8 @@ svr_mailowner(job *pjob, int mailpoint, int force, char *text)
  * 		Send mail to owner of a reservation when an event happens that
  *		requires mail, such as the reservation starts, ends or is aborted.
  *		The event is matched against those requested by the user.
- *		For Unix/Linux, a child is forked to not hold up the Server.  This child
- *		will fork/exec sendmail and pipe the To, Subject and body to it.
+ *		For Unix/Linux, the mail is handed to mail_deliver() so as to not
+ *		hold up the Server.
  *
  * @param[in]	presv	-	pointer to the reservation structure
  * @param[in]	mailpoint	-	which mail event is triggering the send
@@ -870,10 +1256,8 @@ svr_mailownerResv(resc_resv *presv, int mailpoint, int force, char *text)
 	char	*pat;
 	char	*stdmessage = NULL;
 #ifndef WIN32
-	FILE	*outmail;
-	char	*margs[5];
-	int	 mfds[2];
-	pid_t	 mcpid;
+	char	*subject = NULL;
+	char	*body = NULL;
 #endif
 
 	if (force != MAIL_FORCE) {
@@ -900,33 +1284,6 @@ svr_mailownerResv(resc_resv *presv, int mailpoint, int force, char *text)
 			return;
 	}
 
-	/*
-	 * ok, now we will fork a process to do the mailing to not
-	 * hold up the server's other work.
-	 */
-
-#ifndef WIN32
-	mcpid = fork();
-	if (mcpid == -1) { /* Error on fork */
-		log_err(errno, __func__, "fork failed\n");
-		return;
-	}
-	if (mcpid > 0)
-		return;		/* its all up to the child now */
-
-	/*
-	 * From here on, we are a child process of the server.
-	 * Fix up file descriptors and signal handlers.
-	 */
-
-	net_close(-1);
-	rpp_terminate();
-
-	/* Unprotect child from being killed by kernel */
-	daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
-
-#endif	/* ! WIN32 */
-
 	/* Who is mail from, if SVR_ATR_mailfrom not set use default */
 
 	if ((mailfrom = server.sv_attr[(int)SRV_ATR_mailfrom].at_val.at_str)==0)
@@ -996,48 +1353,7 @@ svr_mailownerResv(resc_resv *presv, int mailpoint, int force, char *text)
 		presv->ri_wattr[(int)RESV_ATR_resv_name].at_val.at_str, text);
 #else
 
-	/* setup sendmail command line with -f from_whom */
-
-	margs[0] = SENDMAIL_CMD;
-	margs[1] = "-f";
-	margs[2] = mailfrom;
-	margs[3] = mailto;
-	margs[4] = NULL;
-
-	if (pipe(mfds) == -1)
-		exit(1);
-
-	mcpid = fork();
-	if(mcpid == 0) {
-		/* this child will be sendmail with its stdin set to the pipe */
-		if (mfds[0] != 0) {
-			(void)close(0);
-			if (dup(mfds[0]) == -1)
-				exit(1);
-		}
-		(void)close(1);
-		(void)close(2);
-		if (execv(SENDMAIL_CMD, margs) == -1)
-			exit(1);
-	}
-	if (mcpid == -1) {/* Error on fork */
-		log_err(errno, __func__, "fork failed\n");
-		(void)close(mfds[0]);
-		exit(1);
-	}
-
-	/* parent (not the real server though) will write body of message on pipe */
-	(void)close(mfds[0]);
-	outmail = fdopen(mfds[1], "w");
-	if (outmail == NULL)
-		exit(1);
-
-	/* Pipe in mail headers: To: and Subject: */
-
-	fprintf(outmail, "To: %s\n", mailto);
-	fprintf(outmail, "Subject: PBS RESERVATION %s\n\n", presv->ri_qs.ri_resvID);
-
-	/* Now pipe in "standard" message */
+	/* Now the "standard" message */
 
 	switch (mailpoint) {
 
@@ -1062,15 +1378,16 @@ svr_mailownerResv(resc_resv *presv, int mailpoint, int force, char *text)
 			break;
 	}
 
-	fprintf(outmail, "PBS Reservation Id: %s\n", presv->ri_qs.ri_resvID);
-	fprintf(outmail, "Reservation Name:   %s\n",
-		presv->ri_wattr[(int)RESV_ATR_resv_name].at_val.at_str);
-	if (stdmessage)
-		fprintf(outmail, "%s\n", stdmessage);
-	if (text != NULL)
-		fprintf(outmail, "%s\n", text);
-	fclose(outmail);
-
-	exit(0);
+	(void)pbs_asprintf(&subject, "PBS RESERVATION %s", presv->ri_qs.ri_resvID);
+	(void)pbs_asprintf(&body,
+		"PBS Reservation Id: %s\nReservation Name:   %s\n%s%s%s%s",
+		presv->ri_qs.ri_resvID,
+		presv->ri_wattr[(int)RESV_ATR_resv_name].at_val.at_str,
+		stdmessage ? stdmessage : "", stdmessage ? "\n" : "",
+		text ? text : "", text ? "\n" : "");
+	if ((subject != NULL) && (body != NULL))
+		mail_deliver(mailfrom, mailto, subject, body);
+	free(subject);
+	free(body);
 #endif	/* ! WIN32 */
 }
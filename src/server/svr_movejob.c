@@ -46,6 +46,7 @@
  * 	local_move()
  * 	post_routejob()
  * 	post_movejob()
+ * 	exec_job_oneshot()
  * 	send_job_exec()
  * 	send_job()
  * 	net_move()
@@ -508,6 +509,43 @@ post_movejob(struct work_task *pwt)
 	return;
 }
 
+/**
+ * @brief
+ * 	Decide whether a job can be sent to its Mom as one Exec Job request
+ * 	instead of Queue Job, Job Script, Job Credential and Commit.  That is
+ * 	so for a job on a single host whose script fits in one chunk and
+ * 	which has no output or checkpoint files to take along, provided the
+ * 	Mom has said it accepts the request.
+ *
+ * @param[in]	jobp - pointer to the job being sent
+ * @param[in]	pmom - the Mom it is sent to
+ * @param[in]	hostaddr - the address of the Mom's host, host byte order
+ *
+ * @return int
+ * @retval  1	send it in one request
+ * @retval  0	send it step by step
+ */
+static int
+exec_job_oneshot(job *jobp, mominfo_t *pmom, pbs_net_t hostaddr)
+{
+	attribute *pattr = &jobp->ji_wattr[(int)JOB_ATR_exec_host];
+
+	if ((((mom_svrinfo_t *)(pmom->mi_data))->msr_caps & UPDATE_exec_job) == 0)
+		return 0;
+	if (((pattr->at_flags & ATR_VFLAG_SET) == 0) ||
+		(pattr->at_val.at_str == NULL) ||
+		(strchr(pattr->at_val.at_str, '+') != NULL))
+		return 0;
+	if ((jobp->ji_qs.ji_svrflags & JOB_SVFLG_SCRIPT) &&
+		((jobp->ji_script == NULL) ||
+		(strlen(jobp->ji_script) > SCRIPT_CHUNK_Z)))
+		return 0;
+	if ((jobp->ji_qs.ji_svrflags & JOB_SVFLG_HASRUN) &&
+		(hostaddr != pbs_server_addr))
+		return 0;
+	return 1;
+}
+
 /**
  *
  * @brief
@@ -540,6 +578,7 @@ send_job_exec(job *jobp, pbs_net_t hostaddr, int port, struct batch_request *req
 	struct attropl *pqjatr; /* list (single) of attropl for quejob */
 	int rc;
 	int rpp = 1;
+	int oneshot;
 	char *jobid = NULL;
 	char *msgid = NULL;
 	char *dup_msgid = NULL;
@@ -588,7 +627,17 @@ send_job_exec(job *jobp, pbs_net_t hostaddr, int port, struct batch_request *req
 	(void) strcpy(job_id, jobp->ji_qs.ji_jobid);
 
 	pqjatr = &((svrattrl *) GET_NEXT(attrl))->al_atopl;
-	jobid = PBSD_queuejob(stream, jobp->ji_qs.ji_jobid, destin, pqjatr, NULL, rpp, &msgid);
+	oneshot = exec_job_oneshot(jobp, pmom, hostaddr);
+	if (oneshot) {
+		rc = PBSD_execjob(stream, jobp->ji_qs.ji_jobid, destin, pqjatr,
+			(jobp->ji_qs.ji_svrflags & JOB_SVFLG_SCRIPT) ? jobp->ji_script : NULL,
+			jobp->ji_extended.ji_ext.ji_credtype, credbuf, credlen, &msgid);
+		jobid = (rc == 0) ? "" : NULL;
+		free(credbuf);
+		credbuf = NULL;
+		credlen = 0;
+	} else
+		jobid = PBSD_queuejob(stream, jobp->ji_qs.ji_jobid, destin, pqjatr, NULL, rpp, &msgid);
 	free_attrlist(&attrl);
 	if (jobid == NULL)
 		goto send_err;
@@ -605,6 +654,15 @@ send_job_exec(job *jobp, pbs_net_t hostaddr, int port, struct batch_request *req
 	/* add to pjob->svrtask list so its automatically cleared when job is purged */
 	append_link(&jobp->ji_svrtask, &ptask->wt_linkobj, ptask);
 
+	if (oneshot) {
+		if (jobp->ji_script) {
+			free(jobp->ji_script);
+			jobp->ji_script = NULL;
+		}
+		resc_access_perm = save_resc_access_perm; /* reset back to it's old value */
+		return 2;
+	}
+
 	/* we cannot use the same msgid, since it is not part of the preq,
 	 * make a dup of it, and we can freely free it
 	 */
@@ -628,6 +628,19 @@ vn_addvnr(vnl_t *vnlp, char *id, char *attr, char *attrval,
 	if ((callback != NULL) && (callback(id, attr, attrval) == 0))
 		return (0);
 
+	/* the index was created with string keys */
+	snprintf(rp->key, PBS_MAXHOSTNAME, "%s", id);
+	vnrlp = id2vnrl(vnlp, id, rp);
+
+	/*
+	 *	Merging an unchanged definition, e.g. when the same vnode
+	 *	file is read again, leaves the existing entry as it is.
+	 */
+	if (((vnrp = attr2vnr(vnrlp, attr)) != NULL) &&
+		(vnrp->vna_type == attrtype) && (vnrp->vna_flag == attrflags) &&
+		(strcmp(vnrp->vna_val, attrval) == 0))
+		return (0);
+
 	if ((newname = strdup(attr)) == NULL) {
 		return (-1);
 	} else if ((newval = strdup(attrval)) == NULL) {
@@ -635,9 +648,7 @@ vn_addvnr(vnl_t *vnlp, char *id, char *attr, char *attrval,
 		return (-1);
 	}
 
-	/* the index was created with string keys */
-	snprintf(rp->key, PBS_MAXHOSTNAME, "%s", id);
-	if ((vnrlp = id2vnrl(vnlp, id, rp)) == NULL) {
+	if (vnrlp == NULL) {
 		if ((newid = strdup(id)) == NULL) {
 			free(newval);
 			free(newname);
@@ -664,9 +675,10 @@ vn_addvnr(vnl_t *vnlp, char *id, char *attr, char *attrval,
 		}
 		vnrlp = CURVNLNODE(vnlp);
 		vnrlp->vnal_id = newid;
+		vnrp = NULL;
 	}
 
-	if ((vnrp = attr2vnr(vnrlp, attr)) == NULL) {
+	if (vnrp == NULL) {
 		/*
 		 *	No vnode_attr for this attribute - add one.
 		 */
@@ -1593,6 +1605,28 @@ manage_resc_sum_values(enum resc_sum_action action, resource_def *resc_def, char
 	return (NULL);
 }
 
+/**
+ * @brief
+ *	Append 'str' to the string whose terminating NUL '*end' points at,
+ *	and leave '*end' pointing at the new terminating NUL.  The release
+ *	node functions build exec_vnode/exec_host values one chunk at a time,
+ *	and for a job on thousands of vnodes strcat() would rescan the
+ *	whole value on every append.
+ *
+ * @param[in,out]	end - end of the string being built
+ * @param[in]		str - string to append
+ *
+ * @return none
+ */
+static void
+strcat_end(char **end, char *str)
+{
+	size_t len = strlen(str);
+
+	memcpy(*end, str, len + 1);
+	*end += len;
+}
+
 /*
  * @brief
  *	Initialize the relnodes_input_vnodelist_t structure used as argument to
@@ -1634,6 +1668,9 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 	char	*new_exec_vnode = NULL;
 	char	*new_exec_host = NULL;
 	char	*new_exec_host2 = NULL;
+	char	*new_exec_vnode_end = NULL;
+	char	*new_exec_host_end = NULL;
+	char	*new_exec_host2_end = NULL;
 	char	*new_select = NULL;
 	char	*chunk_buf = NULL;
 	int	chunk_buf_sz = 0;
@@ -1667,7 +1704,9 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 	int		found_paren_dealloc = 0;
 	resource_def	*resc_def = NULL;
 	char		*deallocated_execvnode = NULL;
+	char		*deallocated_execvnode_end = NULL;
 	int		deallocated_execvnode_sz = 0;
+	int		in_vnodelist;
 	char		*extra_res = NULL;
 	resource	*prs;
 	resource_def	*prdefvntype;
@@ -1731,6 +1770,7 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 		goto release_nodeslist_exit;
 	}
 	new_exec_vnode[0] = '\0';
+	new_exec_vnode_end = new_exec_vnode;
 
 	chunk_buf_sz = strlen(exec_vnode) + 1;
 	chunk_buf = (char *) calloc(1, chunk_buf_sz);
@@ -1745,6 +1785,7 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 	 	log_err(-1, __func__, "deallocated_execvnode calloc error");
 		goto release_nodeslist_exit;
 	}
+	deallocated_execvnode_end = deallocated_execvnode;
 
 	if (exec_host != NULL) {
 		new_exec_host = (char *) calloc(1, strlen(exec_host) + 1);
@@ -1753,6 +1794,7 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 			goto release_nodeslist_exit;
 		}
 		new_exec_host[0] = '\0';
+		new_exec_host_end = new_exec_host;
 	}
 
 	if (exec_host2 != NULL) {
@@ -1762,6 +1804,7 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 			goto release_nodeslist_exit;
 		}
 		new_exec_host2[0] = '\0';
+		new_exec_host2_end = new_exec_host2;
 	}
 
 	prdefvntype = find_resc_def(svr_resc_def, "vntype", svr_resc_size);
@@ -1850,9 +1893,11 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 			}
 #endif
 
+			in_vnodelist = (r_input2->vnodelist != NULL) &&
+				in_string_list(noden, '+', r_input2->vnodelist);
+
 			if (is_parent_host_of_node(pnode, parent_mom, ms_fullhost, ms_port) &&
-			     (r_input2->vnodelist != NULL) &&	
-			      in_string_list(noden, '+', r_input2->vnodelist)) {
+			      in_vnodelist) {
 				if ((err_msg != NULL) && (err_msg_sz > 0)) {
         				snprintf(err_msg, err_msg_sz,
 				 		"Can't free '%s' since it's on a primary execution host", noden);
@@ -1861,8 +1906,7 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 				goto release_nodeslist_exit;
 			}
 
-			if ((r_input2->vnodelist != NULL) &&
-			      in_string_list(noden, '+', r_input2->vnodelist) && (pnode != NULL) &&
+			if (in_vnodelist && (pnode != NULL) &&
 				(pnode->nd_attr[ND_ATR_ResourceAvail].at_flags & ATR_VFLAG_SET) != 0) {
 				for (prs = (resource *)GET_NEXT(pnode->nd_attr[ND_ATR_ResourceAvail].at_val.at_list); prs != NULL; prs = (resource *)GET_NEXT(prs->rs_link)) {
 					if ((prdefvntype != NULL) &&
@@ -1894,53 +1938,53 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 			}
 
 			if (is_parent_host_of_node(pnode, parent_mom, ms_fullhost, ms_port) ||
-			     ((r_input2->vnodelist != NULL) && !in_string_list(noden, '+', r_input2->vnodelist))) {
+			     ((r_input2->vnodelist != NULL) && !in_vnodelist)) {
 
 				if (entry > 0) /* there's something put in previously */
-					strcat(new_exec_vnode, "+");
+					strcat_end(&new_exec_vnode_end, "+");
 
 				if (((hasprn > 0) && (paren > 0)) ||
 				     ((hasprn == 0) && (paren == 0))) {
 						 /* at the beginning of chunk for current host */
 					if (!found_paren) {
-						strcat(new_exec_vnode, "(");
+						strcat_end(&new_exec_vnode_end, "(");
 						found_paren = 1;
 
 						if (h_entry > 0) {
 							/* there's already previous exec_host entry */
 							if (new_exec_host != NULL)
-								strcat(new_exec_host, "+");
+								strcat_end(&new_exec_host_end, "+");
 							if (new_exec_host2 != NULL)
-								strcat(new_exec_host2, "+");
+								strcat_end(&new_exec_host2_end, "+");
 						}
 
 						if (new_exec_host != NULL)
-							strcat(new_exec_host, chunk1);
+							strcat_end(&new_exec_host_end, chunk1);
 						if (new_exec_host2 != NULL)
-							strcat(new_exec_host2, chunk2);
+							strcat_end(&new_exec_host2_end, chunk2);
 						h_entry++;
 					}
 				}
 
 				if (!found_paren) {
-					strcat(new_exec_vnode, "(");
+					strcat_end(&new_exec_vnode_end, "(");
 					found_paren = 1;
 
 					if (h_entry > 0) {
 						/* there's already previous exec_host entry */
 						if (new_exec_host != NULL)
-							strcat(new_exec_host, "+");
+							strcat_end(&new_exec_host_end, "+");
 						if (new_exec_host2 != NULL)
-							strcat(new_exec_host2, "+");
+							strcat_end(&new_exec_host2_end, "+");
 					}
 
 					if (new_exec_host != NULL)
-						strcat(new_exec_host, chunk1);
+						strcat_end(&new_exec_host_end, chunk1);
 					if (new_exec_host2 != NULL)
-						strcat(new_exec_host2, chunk2);
+						strcat_end(&new_exec_host2_end, chunk2);
 					h_entry++;
 				}
-				strcat(new_exec_vnode, noden);
+				strcat_end(&new_exec_vnode_end, noden);
 				entry++;
 
 				for (j = 0; j < nelem; ++j) {
@@ -1962,18 +2006,18 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 
 					snprintf(buf, sizeof(buf),
 						":%s=%s", pkvp[j].kv_keyw, pkvp[j].kv_val);
-					strcat(new_exec_vnode, buf);
+					strcat_end(&new_exec_vnode_end, buf);
 				}
 
 				if (paren == 0) { /* have all chunks for current host */
 			
 					if (found_paren) {
-						strcat(new_exec_vnode, ")");
+						strcat_end(&new_exec_vnode_end, ")");
 						found_paren = 0;
 					}
 
 					if (found_paren_dealloc) {
-						strcat(deallocated_execvnode, ")");
+						strcat_end(&deallocated_execvnode_end, ")");
 						found_paren_dealloc = 0;
 					}
 		
@@ -2025,33 +2069,33 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 			} else {
 				if (!is_parent_host_of_node(pnode, parent_mom, ms_fullhost, ms_port)) {
 					if (f_entry > 0) { /* there's something put in previously */
-						strcat(deallocated_execvnode, "+");
+						strcat_end(&deallocated_execvnode_end, "+");
 					}
 
 					if (((hasprn > 0) && (paren > 0)) || ((hasprn == 0) && (paren == 0)) ) {
 						 /* at the beginning of chunk for current host */
 						if (!found_paren_dealloc) {
-							strcat(deallocated_execvnode, "(");
+							strcat_end(&deallocated_execvnode_end, "(");
 							found_paren_dealloc = 1;
 						}
 					}
 
 					if (!found_paren_dealloc) {
-						strcat(deallocated_execvnode, "(");
+						strcat_end(&deallocated_execvnode_end, "(");
 						found_paren_dealloc = 1;
 					}
-					strcat(deallocated_execvnode, chunk_buf);
+					strcat_end(&deallocated_execvnode_end, chunk_buf);
 					f_entry++;
 
 					if (paren == 0) { /* have all chunks for current host */
 
 						if (found_paren) {
-							strcat(new_exec_vnode, ")");
+							strcat_end(&new_exec_vnode_end, ")");
 							found_paren = 0;
 						}
 			
 						if (found_paren_dealloc) {
-							strcat(deallocated_execvnode, ")");
+							strcat_end(&deallocated_execvnode_end, ")");
 							found_paren_dealloc = 0;
 						}
 					}
@@ -2061,11 +2105,11 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 				if (hasprn < 0) {
 					/* matched ')' in chunk, so need to balance the parenthesis */
 					if (found_paren) {
-						strcat(new_exec_vnode, ")");
+						strcat_end(&new_exec_vnode_end, ")");
 						found_paren = 0;
 					}
 					if (found_paren_dealloc) {
-						strcat(deallocated_execvnode, ")");
+						strcat_end(&deallocated_execvnode_end, ")");
 						found_paren_dealloc = 0;
 					}
 
@@ -3269,6 +3313,9 @@ pbs_release_nodes_given_select(relnodes_input_t *r_input, relnodes_input_select_
 	char		*new_exec_vnode = NULL;
 	char		*new_exec_host = NULL;
 	char		*new_exec_host2 = NULL;
+	char		*new_exec_vnode_end = NULL;
+	char		*new_exec_host_end = NULL;
+	char		*new_exec_host2_end = NULL;
 	char		*new_schedselect = NULL;
 	char		*noden;
 	int		nelem;
@@ -3655,6 +3702,7 @@ pbs_release_nodes_given_select(relnodes_input_t *r_input, relnodes_input_select_
 		goto release_nodes_exit;
 	}
 	new_exec_vnode[0] = '\0';
+	new_exec_vnode_end = new_exec_vnode;
 
 	if (r_input->exechost != NULL) {
 		new_exec_host = (char *) calloc(1, strlen(r_input->exechost)+1);
@@ -3663,6 +3711,7 @@ pbs_release_nodes_given_select(relnodes_input_t *r_input, relnodes_input_select_
 			goto release_nodes_exit;
 		}
 		new_exec_host[0] = '\0';
+		new_exec_host_end = new_exec_host;
 	}
 
 	if (r_input->exechost2 != NULL) {
@@ -3672,6 +3721,7 @@ pbs_release_nodes_given_select(relnodes_input_t *r_input, relnodes_input_select_
 			goto release_nodes_exit;
 		}
 		new_exec_host2[0] = '\0';
+		new_exec_host2_end = new_exec_host2;
 	}
 
 	if (r_input2->select_str == NULL) {
@@ -3742,30 +3792,30 @@ pbs_release_nodes_given_select(relnodes_input_t *r_input, relnodes_input_select_
 				new_chunkstr = satisfy_chunk_need(&need, have2, &vnl_good);
 				if (new_chunkstr != NULL) {
 					if (l > 0) {
-						strcat(new_exec_vnode, "+");
+						strcat_end(&new_exec_vnode_end, "+");
 						if (have2->host_chunk[0].str) {
 							if (new_exec_host != NULL)
-								strcat(new_exec_host, "+");
+								strcat_end(&new_exec_host_end, "+");
 						}
 						if (have2->host_chunk[1].str) {
 							if (new_exec_host2 != NULL)
-								strcat(new_exec_host2, "+");
+								strcat_end(&new_exec_host2_end, "+");
 						}
 					}
-					strcat(new_exec_vnode, new_chunkstr);
+					strcat_end(&new_exec_vnode_end, new_chunkstr);
 					free(have2->chunkstr);
 					have2->chunkstr = NULL;
 
 					if (have2->host_chunk[0].str) {
 						if (new_exec_host != NULL)
-							strcat(new_exec_host, have2->host_chunk[0].str);
+							strcat_end(&new_exec_host_end, have2->host_chunk[0].str);
 						free(have2->host_chunk[0].str);
 						have2->host_chunk[0].str = NULL;
 					}
 
 					if (have2->host_chunk[1].str) {
 						if (new_exec_host2 != NULL)
-							strcat(new_exec_host2, have2->host_chunk[1].str);
+							strcat_end(&new_exec_host2_end, have2->host_chunk[1].str);
 						free(have2->host_chunk[1].str);
 						have2->host_chunk[1].str = NULL;
 					}
@@ -91,6 +91,7 @@
 #include "pbs_python.h"
 #include "provision.h"
 #include "pbs_db.h"
+#include "name_idx.h"
 
 
 
@@ -190,7 +191,7 @@ time_t          secondary_delay = 30;
 int		do_sync_mom_hookfiles;
 struct batch_request    *saved_takeover_req;
 struct python_interpreter_data  svr_interp_data;
-AVL_IX_DESC	*AVL_jctx = NULL;
+name_idx	*jobs_idx = NULL; /* used for the job id index */
 /**
  * @file
  * 	Used only by the TPP layer, to ping nodes only if the connection to the
@@ -264,6 +264,12 @@ update_license_ct(attribute *pattr, char *buf)
 	return;
 }
 
+void
+update_node_state_ct(attribute *pattr, char *buf)
+{
+	return;
+}
+
 int
 is_job_array(char *jobid)
 {
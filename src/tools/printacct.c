@@ -0,0 +1,506 @@
+/*
+ * Copyright (C) 1994-2019 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+/**
+ * @file printacct.c
+ *
+ * @brief
+ *	printacct - print the binary accounting records written by the
+ *	server when PBS_SERVER_ACCT_BINARY is set, see acct_bin.h.
+ *
+ * Functions included are:
+ *	get_int()
+ *	get_str()
+ *	decode_record()
+ *	find_field()
+ *	print_str()
+ *	print_record()
+ *	print_columns()
+ *	print_file()
+ *	main()
+ */
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "cmds.h"
+#include "pbs_version.h"
+#include "server_limits.h"
+#include "acct_bin.h"
+
+#define MAX_COLUMNS	64
+
+/* a length prefixed string in a record */
+struct bin_str {
+	const char	*s_str;
+	uint32_t	s_len;
+};
+
+/* a record, pointing into the record buffer */
+struct bin_record {
+	int64_t		r_time;
+	int		r_type;
+	struct bin_str	r_id;
+	unsigned int	r_mask;
+	struct bin_str	r_str[ACCT_BIN_FIRST_INT];
+	int64_t		r_int[ACCT_BIN_NFIELDS];
+	int		r_nmap;
+	struct bin_str	*r_key;
+	struct bin_str	*r_val;
+};
+
+static const char *field_names[] = ACCT_BIN_FIELD_NAMES;
+static struct bin_str *map_key = NULL;
+static struct bin_str *map_val = NULL;
+static int map_size = 0;
+
+/**
+ * @brief
+ *	Get a little endian integer of nbytes bytes from a record.
+ *
+ * @param[in,out]	pp - where to get it, advanced past it
+ * @param[in]	end - end of the record
+ * @param[in]	nbytes - size of the integer
+ * @param[out]	val - the integer
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- the record is too short
+ */
+static int
+get_int(const unsigned char **pp, const unsigned char *end, int nbytes, uint64_t *val)
+{
+	int i;
+
+	if (end - *pp < nbytes)
+		return -1;
+	*val = 0;
+	for (i = 0; i < nbytes; i++)
+		*val |= ((uint64_t)(*pp)[i]) << (8 * i);
+	*pp += nbytes;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Get a length prefixed string from a record.
+ *
+ * @param[in,out]	pp - where to get it, advanced past it
+ * @param[in]	end - end of the record
+ * @param[out]	str - the string
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- the record is too short
+ */
+static int
+get_str(const unsigned char **pp, const unsigned char *end, struct bin_str *str)
+{
+	uint64_t len;
+
+	if ((get_int(pp, end, 4, &len) != 0) || ((uint64_t)(end - *pp) < len))
+		return -1;
+	str->s_str = (const char *)*pp;
+	str->s_len = (uint32_t)len;
+	*pp += len;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Decode a record read after its length.
+ *
+ * @param[in]	buf - the record
+ * @param[in]	len - its length
+ * @param[out]	rec - the decoded record, pointing into buf
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- the record is malformed or out of memory
+ */
+static int
+decode_record(const unsigned char *buf, size_t len, struct bin_record *rec)
+{
+	const unsigned char *p = buf;
+	const unsigned char *end = buf + len;
+	uint64_t val;
+	int f;
+	int i;
+
+	if (get_int(&p, end, 8, &val) != 0)
+		return -1;
+	rec->r_time = (int64_t)val;
+	if (get_int(&p, end, 1, &val) != 0)
+		return -1;
+	rec->r_type = (int)val;
+	if ((get_str(&p, end, &rec->r_id) != 0) || (get_int(&p, end, 2, &val) != 0))
+		return -1;
+	rec->r_mask = (unsigned int)val;
+	for (f = 0; f < ACCT_BIN_NFIELDS; f++) {
+		if ((rec->r_mask & (1 << f)) == 0)
+			continue;
+		if (f < ACCT_BIN_FIRST_INT) {
+			if (get_str(&p, end, &rec->r_str[f]) != 0)
+				return -1;
+		} else {
+			if (get_int(&p, end, 8, &val) != 0)
+				return -1;
+			rec->r_int[f] = (int64_t)val;
+		}
+	}
+	if (get_int(&p, end, 2, &val) != 0)
+		return -1;
+	rec->r_nmap = (int)val;
+	if (rec->r_nmap > map_size) {
+		struct bin_str *nk;
+		struct bin_str *nv;
+
+		if ((nk = realloc(map_key, rec->r_nmap * sizeof(struct bin_str))) == NULL)
+			return -1;
+		map_key = nk;
+		if ((nv = realloc(map_val, rec->r_nmap * sizeof(struct bin_str))) == NULL)
+			return -1;
+		map_val = nv;
+		map_size = rec->r_nmap;
+	}
+	rec->r_key = map_key;
+	rec->r_val = map_val;
+	for (i = 0; i < rec->r_nmap; i++) {
+		if ((get_str(&p, end, &map_key[i]) != 0) ||
+			(get_str(&p, end, &map_val[i]) != 0))
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	Find a fixed field by its name.
+ *
+ * @param[in]	name - the name
+ *
+ * @return	int
+ * @retval	>=0	- the field
+ * @retval	-1	- not a fixed field
+ */
+static int
+find_field(const char *name)
+{
+	int f;
+
+	for (f = 0; f < ACCT_BIN_NFIELDS; f++)
+		if (strcmp(field_names[f], name) == 0)
+			return f;
+	return -1;
+}
+
+/**
+ * @brief
+ *	Print a key=value pair as the text accounting log does, quoting a
+ *	value that contains spaces.
+ *
+ * @param[in]	sep - what to print before it
+ * @param[in]	key - the key
+ * @param[in]	keylen - its length
+ * @param[in]	val - the value
+ *
+ * @return	void
+ */
+static void
+print_str(const char *sep, const char *key, size_t keylen, const struct bin_str *val)
+{
+	const char *quote = "";
+
+	if (memchr(val->s_str, ' ', val->s_len) != NULL)
+		quote = (memchr(val->s_str, '"', val->s_len) != NULL) ? "'" : "\"";
+	if ((val->s_len == 0) && (keylen > 0))
+		printf("%s%.*s", sep, (int)keylen, key);
+	else
+		printf("%s%.*s=%s%.*s%s", sep, (int)keylen, key, quote,
+			(int)val->s_len, val->s_str, quote);
+}
+
+/**
+ * @brief
+ *	Print a record in the format of the text accounting log, with the
+ *	fixed fields first.
+ *
+ * @param[in]	rec - the record
+ *
+ * @return	void
+ */
+static void
+print_record(const struct bin_record *rec)
+{
+	time_t t = (time_t)rec->r_time;
+	struct tm *ptm = localtime(&t);
+	const char *sep = "";
+	int f;
+	int i;
+
+	printf("%02d/%02d/%04d %02d:%02d:%02d;%c;%.*s;",
+		ptm->tm_mon+1, ptm->tm_mday, ptm->tm_year+1900,
+		ptm->tm_hour, ptm->tm_min, ptm->tm_sec,
+		rec->r_type, (int)rec->r_id.s_len, rec->r_id.s_str);
+	for (f = 0; f < ACCT_BIN_NFIELDS; f++) {
+		if ((rec->r_mask & (1 << f)) == 0)
+			continue;
+		if (f < ACCT_BIN_FIRST_INT)
+			print_str(sep, field_names[f], strlen(field_names[f]), &rec->r_str[f]);
+		else
+			printf("%s%s=%lld", sep, field_names[f], (long long)rec->r_int[f]);
+		sep = " ";
+	}
+	for (i = 0; i < rec->r_nmap; i++) {
+		print_str(sep, rec->r_key[i].s_str, rec->r_key[i].s_len, &rec->r_val[i]);
+		sep = " ";
+	}
+	printf("\n");
+}
+
+/**
+ * @brief
+ *	Print the columns asked for of a record, separated by tabs.  The
+ *	column of a key not in the record is empty.
+ *
+ * @param[in]	rec - the record
+ * @param[in]	cols - the column names
+ * @param[in]	colf - the fixed field of each column, or -1
+ * @param[in]	ncols - the number of columns
+ *
+ * @return	void
+ */
+static void
+print_columns(const struct bin_record *rec, char **cols, int *colf, int ncols)
+{
+	size_t len;
+	int c;
+	int i;
+
+	for (c = 0; c < ncols; c++) {
+		if (c > 0)
+			putchar('\t');
+		if (strcmp(cols[c], "time") == 0) {
+			printf("%lld", (long long)rec->r_time);
+		} else if (strcmp(cols[c], "type") == 0) {
+			putchar(rec->r_type);
+		} else if (strcmp(cols[c], "id") == 0) {
+			printf("%.*s", (int)rec->r_id.s_len, rec->r_id.s_str);
+		} else if (colf[c] >= 0) {
+			if ((rec->r_mask & (1 << colf[c])) == 0)
+				continue;
+			if (colf[c] < ACCT_BIN_FIRST_INT)
+				printf("%.*s", (int)rec->r_str[colf[c]].s_len, rec->r_str[colf[c]].s_str);
+			else
+				printf("%lld", (long long)rec->r_int[colf[c]]);
+		} else {
+			len = strlen(cols[c]);
+			for (i = 0; i < rec->r_nmap; i++) {
+				if ((rec->r_key[i].s_len == len) &&
+					(memcmp(rec->r_key[i].s_str, cols[c], len) == 0)) {
+					printf("%.*s", (int)rec->r_val[i].s_len, rec->r_val[i].s_str);
+					break;
+				}
+			}
+		}
+	}
+	putchar('\n');
+}
+
+/**
+ * @brief
+ *	Print the records of a binary accounting file that match the
+ *	record types and id asked for.
+ *
+ * @param[in]	filename - the file
+ * @param[in]	types - record types to print, or NULL for all
+ * @param[in]	id - record id to print, or NULL for all
+ * @param[in]	cols - the columns to print, or NULL for whole records
+ * @param[in]	colf - the fixed field of each column
+ * @param[in]	ncols - the number of columns
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	1	- the file could not be read or is malformed
+ */
+static int
+print_file(const char *filename, const char *types, const char *id,
+	char **cols, int *colf, int ncols)
+{
+	static unsigned char *buf = NULL;
+	static size_t bufsize = 0;
+	unsigned char lenbuf[4];
+	char magic[ACCT_BIN_MAGIC_LEN];
+	struct bin_record rec;
+	size_t len;
+	size_t idlen = (id != NULL) ? strlen(id) : 0;
+	FILE *fp;
+	int rc = 0;
+
+	if ((fp = fopen(filename, "r")) == NULL) {
+		fprintf(stderr, "printacct: %s: %s\n", filename, strerror(errno));
+		return 1;
+	}
+	if ((fread(magic, 1, sizeof(magic), fp) != sizeof(magic)) ||
+		(memcmp(magic, ACCT_BIN_MAGIC, ACCT_BIN_MAGIC_LEN) != 0)) {
+		fprintf(stderr, "printacct: %s: not a binary accounting file\n", filename);
+		fclose(fp);
+		return 1;
+	}
+
+	while (fread(lenbuf, 1, sizeof(lenbuf), fp) == sizeof(lenbuf)) {
+		len = lenbuf[0] | (lenbuf[1] << 8) | (lenbuf[2] << 16) | ((size_t)lenbuf[3] << 24);
+		if (len > bufsize) {
+			unsigned char *nb;
+
+			if ((nb = realloc(buf, len)) == NULL) {
+				fprintf(stderr, "printacct: out of memory\n");
+				rc = 1;
+				break;
+			}
+			buf = nb;
+			bufsize = len;
+		}
+		if ((fread(buf, 1, len, fp) != len) ||
+			(decode_record(buf, len, &rec) != 0)) {
+			fprintf(stderr, "printacct: %s: truncated or malformed record\n", filename);
+			rc = 1;
+			break;
+		}
+		if ((types != NULL) && (strchr(types, rec.r_type) == NULL))
+			continue;
+		if ((id != NULL) && ((rec.r_id.s_len != idlen) ||
+			(memcmp(rec.r_id.s_str, id, idlen) != 0)))
+			continue;
+		if (cols != NULL)
+			print_columns(&rec, cols, colf, ncols);
+		else
+			print_record(&rec);
+	}
+	fclose(fp);
+	return rc;
+}
+
+/**
+ * @brief
+ *	This is main function of printacct.
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: failure
+ */
+int
+main(int argc, char *argv[])
+{
+	char *types = NULL;
+	char *id = NULL;
+	char *cols[MAX_COLUMNS];
+	int colf[MAX_COLUMNS];
+	int ncols = 0;
+	int header = 0;
+	int errflg = 0;
+	int rc = 0;
+	int c;
+	int i;
+	char *tok;
+	char *filename;
+	char path[MAXPATHLEN + 1];
+	struct stat sb;
+
+	/*the real deal or output pbs_version and exit?*/
+	PRINT_VERSION_AND_EXIT(argc, argv);
+
+	while ((c = getopt(argc, argv, "t:j:f:H")) != EOF) {
+		switch (c) {
+			case 't':
+				types = optarg;
+				break;
+			case 'j':
+				id = optarg;
+				break;
+			case 'f':
+				for (tok = strtok(optarg, ","); tok != NULL; tok = strtok(NULL, ",")) {
+					if (ncols == MAX_COLUMNS) {
+						fprintf(stderr, "printacct: at most %d columns\n", MAX_COLUMNS);
+						return 1;
+					}
+					colf[ncols] = find_field(tok);
+					cols[ncols++] = tok;
+				}
+				break;
+			case 'H':
+				header = 1;
+				break;
+			default:
+				errflg = 1;
+		}
+	}
+	if (errflg || (optind == argc)) {
+		fprintf(stderr, "usage: printacct [-t types] [-j id] "
+			"[-f column[,column...] [-H]] file...\n");
+		fprintf(stderr, "       printacct --version\n");
+		return 1;
+	}
+
+	if (header && (ncols > 0)) {
+		for (i = 0; i < ncols; i++)
+			printf("%s%s", (i > 0) ? "\t" : "", cols[i]);
+		printf("\n");
+	}
+
+	for (i = optind; i < argc; i++) {
+		/* a date names the server's file for that day */
+		filename = argv[i];
+		if ((strchr(filename, '/') == NULL) && (stat(filename, &sb) == -1)) {
+			if (pbs_conf.loaded == 0)
+				(void)pbs_loadconf(0);
+			snprintf(path, sizeof(path), "%s/%s/%s/%s",
+				pbs_conf.pbs_home_path, PBS_SVR_PRIVATE, PBS_ACCT_BIN, filename);
+			filename = path;
+		}
+		if (print_file(filename, types, id, (ncols > 0) ? cols : NULL, colf, ncols) != 0)
+			rc = 1;
+	}
+	return rc;
+}
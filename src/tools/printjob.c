@@ -415,13 +415,19 @@ print_db_job(char *id, int no_attributes)
 		attrs = dbjob.attr_list.attributes;
 		if (no_attributes == 0) {
 			int i;
+			char *expanded;
 			printf("--attributes--\n");
 			for (i=0; i< dbjob.attr_list.attr_count; i++) {
 				printf("%s", attrs[i].attr_name);
 				if (attrs[i].attr_resc && attrs[i].attr_resc[0] != 0)
 					printf(".%s", attrs[i].attr_resc);
 				printf(" = ");
-				if (attrs[i].attr_value)
+				/* a host or vnode list is stored condensed, see encode_vnode_list() */
+				if (attrs[i].attr_value &&
+					(expanded = expand_vnode_list(attrs[i].attr_value)) != NULL) {
+					printf("%s", show_nonprint_chars(expanded));
+					free(expanded);
+				} else if (attrs[i].attr_value)
 					printf("%s", show_nonprint_chars(attrs[i].attr_value));
 				printf("\n");
 			}
@@ -45,6 +45,9 @@
  * 	get_cols()
  * 	main()
  * 	parse_log()
+ * 	parse_log_range()
+ * 	parse_log_index()
+ * 	cmp_log_range()
  * 	sort_by_date()
  * 	sort_by_message()
  * 	strip_path()
@@ -64,6 +67,8 @@
 #include <unistd.h>
 #include <ctype.h>
 #include <termios.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #if defined(HAVE_SYS_IOCTL_H)
 #include <sys/ioctl.h>
 #endif
@@ -319,7 +324,8 @@ main(int argc, char *argv[])
 					continue;
 				}
 
-				parse_log(fp, argv[opt], j);
+				if (parse_log_index(filename, fp, argv[opt], j) != 0)
+					parse_log(fp, argv[opt], j);
 
 				fclose(fp);
 			}
@@ -388,6 +394,177 @@ main(int argc, char *argv[])
  */
 void
 parse_log(FILE *fp, char *job, int ind)
+{
+	int lineno = 0;
+
+	parse_log_range(fp, job, ind, -1, &lineno);
+}
+
+/**
+ * @brief
+ *		cmp_log_range - compare function for qsort, orders log ranges by
+ *			their start
+ *
+ * @param[in]	v1	-	log_range structure1
+ * @param[in]	v2	-	log_range structure2
+ *
+ * @return	int
+ * @retval	-1	: v1 starts before v2
+ * @retval	0	: both start at the same offset
+ * @retval	1	: v1 starts after v2
+ */
+int
+cmp_log_range(const void *v1, const void *v2)
+{
+	const struct log_range *r1 = v1;
+	const struct log_range *r2 = v2;
+
+	if (r1->start < r2->start)
+		return -1;
+	else if (r1->start > r2->start)
+		return 1;
+	return 0;
+}
+
+/**
+ * @brief
+ *		parse_log_index - parse out the entries of a log file for a
+ *			specific job using the job index written alongside the log
+ *			(PBS_LOG_INDEX), reading only the ranges of the log the
+ *			index gives for the job and the part of the log after the
+ *			last range the daemon wrote to the index
+ *
+ * @param[in]	filename	-	path of the log file
+ * @param[in]	fp	-	the log file
+ * @param[in]	job	-	the name of the job
+ * @param[in]	ind	-	which log file - index in enum index
+ *
+ * @return	int
+ * @retval	0	: the log was read using its index
+ * @retval	-1	: there is no usable index, the whole log must be read
+ *
+ * @par MT-safe: No
+ */
+int
+parse_log_index(char *filename, FILE *fp, char *job, int ind)
+{
+	static char buf[32768];	/* longest index line is about 16k */
+	char idxname[MAXPATHLEN + 1];
+	char key[64];
+	FILE *ifp;
+	struct log_range *ranges = NULL;
+	struct log_range *tmpr;
+	int nranges = 0;
+	int maxranges = 0;
+	long long start;
+	long long end;
+	off_t covered = 0;
+	struct stat sb;
+	size_t len;
+	char *p;
+	char *tok;
+	int child;
+	int n;
+	int i;
+	int lineno = 0;
+
+	/* the index only has job ids, keyed on the part before the '.' */
+	if (!isdigit((int)*job))
+		return -1;
+	len = strcspn(job, ".");
+	if (len >= sizeof(key))
+		return -1;
+	strncpy(key, job, len);
+	key[len] = '\0';
+
+	snprintf(idxname, sizeof(idxname), "%s%s", filename, LOG_INDEX_SUFFIX);
+	if ((ifp = fopen(idxname, "r")) == NULL)
+		return -1;
+
+	while (fgets(buf, sizeof(buf), ifp) != NULL) {
+		len = strlen(buf);
+		if ((len == 0) || (buf[len - 1] != '\n'))
+			continue;	/* line still being written */
+		p = buf;
+		child = (*p == 'c');
+		if (child)
+			p++;
+		if (sscanf(p, "%lld %lld%n", &start, &end, &n) != 2)
+			continue;
+		if (!child && (end > covered))
+			covered = end;
+		for (tok = strtok(p + n, " \n"); tok != NULL; tok = strtok(NULL, " \n")) {
+			if ((strcmp(tok, key) == 0) || (strcmp(tok, "*") == 0))
+				break;
+		}
+		if (tok == NULL)
+			continue;
+		if (nranges == maxranges) {
+			maxranges = maxranges ? maxranges * 2 : 64;
+			tmpr = realloc(ranges, maxranges * sizeof(struct log_range));
+			if (tmpr == NULL) {
+				free(ranges);
+				fclose(ifp);
+				return -1;
+			}
+			ranges = tmpr;
+		}
+		ranges[nranges].start = start;
+		ranges[nranges].end = end;
+		nranges++;
+	}
+	fclose(ifp);
+
+	if ((fstat(fileno(fp), &sb) == -1) || (covered > sb.st_size)) {
+		/* the index is not of this log */
+		free(ranges);
+		return -1;
+	}
+
+	qsort(ranges, nranges, sizeof(struct log_range), cmp_log_range);
+	for (i = 0; i < nranges; i++) {
+		start = ranges[i].start;
+		end = ranges[i].end;
+		/* merge the ranges that overlap this one */
+		while ((i + 1 < nranges) && (ranges[i + 1].start <= end)) {
+			i++;
+			if (ranges[i].end > end)
+				end = ranges[i].end;
+		}
+		if (fseeko(fp, start, SEEK_SET) == 0)
+			parse_log_range(fp, job, ind, end, &lineno);
+		if (end > covered)
+			covered = end;
+	}
+	free(ranges);
+
+	/* records written after the daemon last wrote to the index */
+	if ((covered < sb.st_size) && (fseeko(fp, covered, SEEK_SET) == 0))
+		parse_log_range(fp, job, ind, -1, &lineno);
+
+	return 0;
+}
+
+/**
+ * @brief
+ *		parse_log_range - parse out entries of a log file for a specific job
+ *		    from the current position of the file up to an offset
+ *
+ * @param[in]	fp	-	the log file
+ * @param[in]	job	-	the name of the job
+ * @param[in]	ind	-	which log file - index in enum index
+ * @param[in]	end	-	offset to stop at, -1 to read to the end of the file
+ * @param[in,out]	lineno	-	number of lines read so far, used to keep
+ *					the order of entries with the same time
+ *
+ *	@return	nothing
+ *	@note
+ *		modifies global variables: loglines, ll_cur_amm, ll_max_amm
+ *
+ * @par MT-safe: No
+ */
+void
+parse_log_range(FILE *fp, char *job, int ind, off_t end, int *lineno)
 {
 	struct log_entry tmp;	/* temporary log entry */
 	char *buf;		/* buffer to read in from file */
@@ -397,7 +574,7 @@ parse_log(FILE *fp, char *job, int ind)
 	int field_count;	/* which field in log entry */
 	int j = 0;
 	struct tm tms;		/* used to convert date to unix date */
-	int lineno = 0;
+	off_t pos;		/* offset of the line being read */
 	int slen;
 	char *pdot;
 	int buf_size = 16384;	/* initial buffer size */
@@ -410,8 +587,9 @@ parse_log(FILE *fp, char *job, int ind)
 	tms.tm_isdst = -1;	/* mktime() will attempt to figure it out */
 
 	strcpy(job_buf, job);
+	pos = ftello(fp);
 
-	while (fgets(buf, buf_size, fp) != NULL) {
+	while (((end < 0) || (pos < end)) && (fgets(buf, buf_size, fp) != NULL)) {
 		while (buf_size == (strlen(buf) + 1)) {
 			buf_size *= 2;
 			tbuf = (char*)realloc(buf, (buf_size + 1) * sizeof(char));
@@ -427,7 +605,8 @@ parse_log(FILE *fp, char *job, int ind)
 		}
 		if (break_fl)
 			break;
-		lineno++;
+		pos += strlen(buf);
+		(*lineno)++;
 		j++;
 		buf[strlen(buf)-1] = '\0';
 		p = strtok(buf, ";");
@@ -563,7 +742,7 @@ parse_log(FILE *fp, char *job, int ind)
 				default:
 					log_lines[ll_cur_amm].log_file = 'U';	/* undefined */
 			}
-			log_lines[ll_cur_amm].lineno = lineno;
+			log_lines[ll_cur_amm].lineno = *lineno;
 			ll_cur_amm++;
 		}
 	}
@@ -106,9 +106,19 @@ struct log_entry
 	/* A=accounting S=server M=Mom L=Scheduler */
 };
 
+/* A byte range of a log file to read, from its job index */
+struct log_range
+{
+	off_t start;
+	off_t end;
+};
+
 /* prototypes */
 int sort_by_date(const void *v1, const void *v2);
 void parse_log(FILE *fp, char *job, int act);
+void parse_log_range(FILE *fp, char *job, int ind, off_t end, int *lineno);
+int parse_log_index(char *filename, FILE *fp, char *job, int ind);
+int cmp_log_range(const void *v1, const void *v2);
 char *strip_path(char *path);
 void free_log_entry(struct log_entry *lg);
 void line_wrap(char *line, int start, int end);
@@ -238,6 +238,7 @@ api_to_cli = {
     ATTR_license_max: 'pbs_license_max',
     ATTR_license_linger: 'pbs_license_linger_time',
     ATTR_license_count: 'license_count',
+    ATTR_nodestate_count: 'node_state_count',
     ATTR_job_sort_formula: 'job_sort_formula',
     ATTR_EligibleTimeEnable: 'eligible_time_enable',
     ATTR_resv_retry_init: 'reserve_retry_init',
@@ -263,6 +263,7 @@ ATTR_license_min = 'pbs_license_min'
 ATTR_license_max = 'pbs_license_max'
 ATTR_license_linger = 'pbs_license_linger_time'
 ATTR_license_count = 'license_count'
+ATTR_nodestate_count = 'node_state_count'
 ATTR_job_sort_formula = 'job_sort_formula'
 ATTR_EligibleTimeEnable = 'eligible_time_enable'
 ATTR_resv_retry_init = 'reserve_retry_init'
@@ -283,6 +284,7 @@ ATTR_rel_list = 'resource_released_list'
 ATTR_released = 'resources_released'
 ATTR_restrict_res_to_release_on_suspend = 'restrict_res_to_release_on_suspend'
 ATTR_sched_preempt_enforce_resumption = 'sched_preempt_enforce_resumption'
+ATTR_sched_cycle_stats = 'sched_cycle_stats'
 ATTR_tolerate_node_failures = 'tolerate_node_failures'
 ATTR_NODE_Host = 'Host'
 ATTR_NODE_Mom = 'Mom'
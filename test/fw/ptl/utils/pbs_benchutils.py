@@ -0,0 +1,235 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+import os
+import json
+import time
+import socket
+import logging
+
+#: Version of the benchmark results schema, bumped on incompatible changes
+BENCH_SCHEMA_VERSION = 1
+
+#: Default tolerance in percent of a benchmark's baseline mean
+BENCH_DFLT_TOLERANCE = 10.0
+
+
+class PbsBenchError(Exception):
+    """
+    Benchmark results that cannot be read or compared
+    """
+    pass
+
+
+class PbsBenchResults(object):
+
+    """
+    Benchmark results in a stable JSON schema::
+
+        {
+          "schema_version": 1,
+          "created": "<ISO 8601 time>",
+          "hostname": "<host the results were loaded on>",
+          "pbs_version": "<version>",
+          "benchmarks": {
+            "<suite>.<testcase>.<measure>": {
+              "unit": "<unit>",
+              "better": "lower" | "higher",
+              "mean": <float>,
+              "std_dev": <float>,
+              "minimum": <float>,
+              "maximum": <float>,
+              "trials": <int>
+            }
+          }
+        }
+
+    Results are loaded from such a file, or from a PTL JSON report
+    (``pbs_benchpress --db-type=json``) where performance tests record their
+    measurements with ``perf_test_result()``.
+    """
+
+    logger = logging.getLogger(__name__)
+
+    def __init__(self, pbs_version=None):
+        self.data = {
+            'schema_version': BENCH_SCHEMA_VERSION,
+            'created': time.strftime('%Y-%m-%dT%H:%M:%S'),
+            'hostname': socket.gethostname(),
+            'pbs_version': pbs_version,
+            'benchmarks': {}
+        }
+
+    @property
+    def benchmarks(self):
+        return self.data['benchmarks']
+
+    def add(self, name, unit, mean, better='lower', std_dev=0.0,
+            minimum=None, maximum=None, trials=1):
+        """
+        Add or replace the result of the benchmark name
+
+        :param name: benchmark name, <suite>.<testcase>.<measure>
+        :type name: str
+        :param unit: unit of the values
+        :type unit: str
+        :param mean: mean of the trials
+        :type mean: int or float
+        :param better: "lower" or "higher", which way is an improvement
+        :type better: str
+        """
+        if better not in ('lower', 'higher'):
+            raise PbsBenchError('%s: better must be lower or higher' % name)
+        self.benchmarks[name] = {
+            'unit': unit,
+            'better': better,
+            'mean': float(mean),
+            'std_dev': float(std_dev),
+            'minimum': float(mean if minimum is None else minimum),
+            'maximum': float(mean if maximum is None else maximum),
+            'trials': int(trials)
+        }
+
+    def add_ptl_report(self, report):
+        """
+        Add the measurements of the test cases of a PTL JSON report
+
+        :param report: the loaded report
+        :type report: dict
+        """
+        if self.data['pbs_version'] is None:
+            self.data['pbs_version'] = report.get('product_version')
+        for (tsname, ts) in report.get('testsuites', {}).items():
+            for (tcname, tc) in ts.get('testcases', {}).items():
+                res = tc.get('results', {})
+                if res.get('status') not in (None, 'PASS'):
+                    continue
+                for m in res.get('measurements', []):
+                    if 'test_measure' not in m or 'test_data' not in m:
+                        continue
+                    td = m['test_data']
+                    name = '.'.join([tsname, tcname, m['test_measure']])
+                    self.add(name, m.get('unit', ''), td['mean'],
+                             better=m.get('better', 'lower'),
+                             std_dev=td.get('std_dev', 0.0),
+                             minimum=td.get('minimum'),
+                             maximum=td.get('maximum'),
+                             trials=len(td.get('trials', [])) or 1)
+
+    @classmethod
+    def load(cls, path):
+        """
+        Load results from a benchmark results file or a PTL JSON report
+
+        :param path: path to the file
+        :type path: str
+        :returns: PbsBenchResults
+        :raises PbsBenchError: the file is neither
+        """
+        try:
+            with open(path) as f:
+                d = json.load(f)
+        except (IOError, OSError, ValueError) as e:
+            raise PbsBenchError('%s: %s' % (path, str(e)))
+        r = cls()
+        if 'schema_version' in d:
+            if d['schema_version'] != BENCH_SCHEMA_VERSION:
+                raise PbsBenchError('%s: unsupported schema version %s' %
+                                    (path, d['schema_version']))
+            r.data = d
+        elif 'testsuites' in d:
+            r.add_ptl_report(d)
+        else:
+            raise PbsBenchError('%s: not benchmark results or a PTL JSON '
+                                'report' % path)
+        return r
+
+    def save(self, path):
+        """
+        Write the results to path in the benchmark results schema
+        """
+        with open(path, 'w') as f:
+            json.dump(self.data, f, indent=2, sort_keys=True)
+            f.write('\n')
+
+    def compare(self, baseline, tolerance=BENCH_DFLT_TOLERANCE):
+        """
+        Compare these results to a baseline
+
+        A benchmark regresses when its mean is worse than the baseline
+        mean by more than tolerance percent of the baseline mean, or more
+        than twice the baseline standard deviation if that is larger, so
+        that noisy benchmarks are not flagged on their noise.
+
+        :param baseline: the baseline results
+        :type baseline: PbsBenchResults
+        :param tolerance: allowed change in percent
+        :type tolerance: float
+        :returns: list of (name, baseline mean, mean, change in percent,
+                  status) sorted by name, status being one of
+                  "REGRESSION", "IMPROVED", "OK", "NEW" or "MISSING"
+        """
+        ret = []
+        base = baseline.benchmarks
+        names = sorted(set(base.keys()) | set(self.benchmarks.keys()))
+        for name in names:
+            if name not in self.benchmarks:
+                ret.append((name, base[name]['mean'], None, None, 'MISSING'))
+                continue
+            if name not in base:
+                ret.append((name, None, self.benchmarks[name]['mean'], None,
+                            'NEW'))
+                continue
+            b = base[name]
+            cur = self.benchmarks[name]['mean']
+            diff = cur - b['mean']
+            if b['better'] == 'higher':
+                diff = -diff
+            allowed = max(abs(b['mean']) * tolerance / 100.0,
+                          2 * b.get('std_dev', 0.0))
+            if b['mean'] != 0:
+                pct = round((cur - b['mean']) * 100.0 / abs(b['mean']), 1)
+            else:
+                pct = None
+            if diff > allowed:
+                status = 'REGRESSION'
+            elif -diff > allowed:
+                status = 'IMPROVED'
+            else:
+                status = 'OK'
+            ret.append((name, b['mean'], cur, pct, status))
+        return ret
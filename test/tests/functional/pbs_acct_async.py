@@ -0,0 +1,162 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestAcctAsync(TestFunctional):
+    """
+    Test the accounting records written by a separate thread, as set by
+    PBS_SERVER_ACCT_ASYNC_SIZE and PBS_SERVER_ACCT_ASYNC_FLUSH in pbs.conf
+    """
+
+    confs = ['PBS_SERVER_ACCT_ASYNC_SIZE', 'PBS_SERVER_ACCT_ASYNC_FLUSH']
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.set_acct_conf(1)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+    def tearDown(self):
+        self.du.unset_pbs_environment(hostname=self.server.hostname,
+                                      environ=['TZ'])
+        self.du.unset_pbs_config(hostname=self.server.hostname,
+                                 confs=self.confs)
+        TestFunctional.tearDown(self)
+        self.server.restart()
+
+    def set_acct_conf(self, size, flush=0):
+        """
+        Restart the server with ``size`` kilobyte accounting buffers
+        and a flush interval of ``flush`` seconds
+        """
+        a = {'PBS_SERVER_ACCT_ASYNC_SIZE': size,
+             'PBS_SERVER_ACCT_ASYNC_FLUSH': flush}
+        self.du.set_pbs_config(hostname=self.server.hostname, confs=a,
+                               append=True)
+        self.server.restart()
+
+    def acct_file(self, t):
+        """
+        Return the contents of the accounting file for the day of the
+        struct_time ``t``
+        """
+        fn = os.path.join(self.server.pbs_conf['PBS_HOME'], 'server_priv',
+                          'accounting', time.strftime('%Y%m%d', t))
+        ret = self.du.cat(hostname=self.server.hostname, filename=fn,
+                          sudo=True, logerr=False)
+        if ret['rc'] != 0:
+            return ''
+        return '\n'.join(ret['out'])
+
+    def test_record_larger_than_buffer(self):
+        """
+        Check a record that does not fit in a 1 kilobyte buffer is
+        written whole and in order with the records around it
+        """
+        jid = self.server.submit(Job(TEST_USER))
+        acct = 'a' * 2000
+        self.server.alterjob(jid, {ATTR_A: acct})
+        self.server.deljob(jid)
+        self.server.accounting_match(';D;' + jid + ';', max_attempts=10)
+        self.server.accounting_match(';A;' + jid + ';Account_Name=' + acct,
+                                     max_attempts=2)
+        q = self.server.accounting_match(';Q;' + jid + ';', n='ALL')
+        a = self.server.accounting_match(';A;' + jid + ';', n='ALL')
+        d = self.server.accounting_match(';D;' + jid + ';', n='ALL')
+        self.assertTrue(q[0] < a[0] < d[0])
+
+    def test_records_kept_across_restart(self):
+        """
+        Check acct_close() drains the queued records when the server
+        stops and acct_open() restarts the writer when it starts again
+        """
+        self.set_acct_conf(64, 30)
+        jid1 = self.server.submit(Job(TEST_USER))
+        self.server.deljob(jid1)
+        self.server.stop()
+        self.server.accounting_match(';D;' + jid1 + ';', max_attempts=2)
+        self.server.start()
+        self.server.log_match('Account file .* opened', regexp=True,
+                              starttime=self.server.ctime)
+        jid2 = self.server.submit(Job(TEST_USER))
+        self.server.deljob(jid2)
+        self.server.restart()
+        self.server.accounting_match(';D;' + jid2 + ';', max_attempts=2)
+
+    def test_flush_interval(self):
+        """
+        Check a record waits for the flush interval before it is written
+        """
+        self.set_acct_conf(64, 10)
+        jid = self.server.submit(Job(TEST_USER))
+        self.server.accounting_match(';Q;' + jid + ';', max_attempts=2,
+                                     interval=1, existence=False)
+        self.server.accounting_match(';Q;' + jid + ';', max_attempts=20,
+                                     interval=1)
+
+    def test_midnight_switch(self):
+        """
+        Give the server a time zone in which midnight is a few seconds
+        away and check the records on either side of it land in the
+        accounting files of their own day
+        """
+        now = int(time.time())
+        # offset east of UTC that puts the server 40s before midnight
+        east = (86400 - 40 - now % 86400) % 86400
+        tz = 'PTL-%02d:%02d:%02d' % (east // 3600, east % 3600 // 60,
+                                     east % 60)
+        self.du.set_pbs_environment(hostname=self.server.hostname,
+                                    environ={'TZ': tz})
+        self.server.restart()
+        before = time.gmtime(now + east)
+        after = time.gmtime(now + east + 86400)
+        jid1 = self.server.submit(Job(TEST_USER))
+        left = now + 45 - time.time()
+        if left > 0:
+            self.logger.info('Waiting %ds for midnight' % left)
+            time.sleep(left)
+        jid2 = self.server.submit(Job(TEST_USER))
+        self.server.stop()
+        day1 = self.acct_file(before)
+        day2 = self.acct_file(after)
+        self.assertIn(';Q;' + jid1 + ';', day1)
+        self.assertNotIn(';Q;' + jid2 + ';', day1)
+        self.assertIn(';Q;' + jid2 + ';', day2)
+        self.assertNotIn(';Q;' + jid1 + ';', day2)
+        self.server.start()
@@ -0,0 +1,96 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestAcctBinary(TestFunctional):
+    """
+    Test the binary accounting records written when PBS_SERVER_ACCT_BINARY
+    is set in pbs.conf, and printacct
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'PBS_SERVER_ACCT_BINARY': 1}
+        self.du.set_pbs_config(hostname=self.server.hostname, confs=a,
+                               append=True)
+        self.server.restart()
+
+    def tearDown(self):
+        self.du.unset_pbs_config(hostname=self.server.hostname,
+                                 confs=['PBS_SERVER_ACCT_BINARY'])
+        TestFunctional.tearDown(self)
+        self.server.restart()
+
+    def printacct(self, args):
+        """
+        Run printacct on today's binary accounting file and return its
+        output lines
+        """
+        cmd = [os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin',
+                            'printacct')] + args + [time.strftime('%Y%m%d')]
+        ret = self.du.run_cmd(self.server.hostname, cmd=cmd, sudo=True)
+        self.assertEqual(ret['rc'], 0, 'printacct failed')
+        return ret['out']
+
+    def test_job_records(self):
+        """
+        Check the queued, started and ended records of a job are written
+        in binary, with the fields printed by printacct matching the
+        text accounting log
+        """
+        a = {'Resource_List.walltime': 10}
+        j = Job(TEST_USER, attrs=a)
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.accounting_match(';E;' + jid + ';', max_attempts=30,
+                                     interval=1)
+
+        types = [l.split(';')[1] for l in self.printacct(['-j', jid])]
+        for t in ['Q', 'S', 'E']:
+            self.assertIn(t, types, 'no %s record for the job' % t)
+
+        out = self.printacct(['-t', 'E', '-j', jid, '-H', '-f',
+                              'id,user,queue,Exit_status,'
+                              'Resource_List.walltime'])
+        self.assertEqual(len(out), 2)
+        self.assertEqual(out[0].split('\t'),
+                         ['id', 'user', 'queue', 'Exit_status',
+                          'Resource_List.walltime'])
+        self.assertEqual(out[1].split('\t'),
+                         [jid, str(TEST_USER), 'workq', '0', '00:00:10'])
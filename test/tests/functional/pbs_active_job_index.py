@@ -0,0 +1,91 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestActiveJobIndex(TestFunctional):
+    """
+    Test that status and select of jobs without history jobs see every
+    job not yet history and none of the history jobs
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'job_history_enable': 'True'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+
+    def test_history_left_out(self):
+        """
+        Finish some jobs, keep others queued, and check qstat and qselect
+        with and without -x across a server restart
+        """
+        done = []
+        for _ in range(3):
+            j = Job(TEST_USER)
+            j.set_sleep_time(1)
+            done.append(self.server.submit(j))
+        for jid in done:
+            self.server.expect(JOB, {'job_state': 'F'}, id=jid, extend='x',
+                               offset=1, interval=1)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        queued = []
+        for _ in range(4):
+            j = Job(TEST_USER)
+            queued.append(self.server.submit(j))
+
+        for _ in range(2):
+            jobs = self.server.status(JOB)
+            self.assertEqual(sorted(j['id'] for j in jobs), sorted(queued))
+            jobs = self.server.status(JOB, id='workq')
+            self.assertEqual(len(jobs), len(queued))
+            jobs = self.server.status(JOB, extend='x')
+            self.assertEqual(len(jobs), len(queued) + len(done))
+            sel = self.server.select()
+            self.assertEqual(sorted(sel), sorted(queued))
+            sel = self.server.select(extend='x')
+            self.assertEqual(len(sel), len(queued) + len(done))
+            self.server.restart()
+
+        # a job that becomes history leaves the jobs statused without -x
+        self.server.delete(queued[0])
+        self.server.expect(JOB, {'job_state': 'F'}, id=queued[0],
+                           extend='x')
+        jobs = self.server.status(JOB)
+        self.assertEqual(sorted(j['id'] for j in jobs), sorted(queued[1:]))
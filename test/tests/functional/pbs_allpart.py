@@ -147,3 +147,28 @@ class TestSchedAllPart(TestFunctional):
             '(R: 3 A: 2 T: 2)'
         a = {'job_state': 'Q', 'comment': m}
         self.server.expect(JOB, a, id=jid)
+
+    def test_chunk_larger_than_any_host(self):
+        """
+        Test that a job is marked as can never run if one of its chunks
+        requests more cpus than any single host has, even though there are
+        enough cpus on the entire complex.  A chunk which fits on a host
+        by spanning its vnodes still runs.
+        """
+        a = {'resources_available.ncpus': 2}
+        self.server.create_vnodes('vn', a, 4, self.mom, sharednode=False,
+                                  vnodes_per_host=2)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        a = {'Resource_List.select': '1:ncpus=5'}
+        j1 = Job(TEST_USER, a)
+        jid1 = self.server.submit(j1)
+        a = {'Resource_List.select': '1:ncpus=4'}
+        j2 = Job(TEST_USER, a)
+        jid2 = self.server.submit(j2)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+
+        m = 'Can Never Run: Insufficient amount of resource: ncpus ' + \
+            '(R: 5 A: 4 T: 4)'
+        a = {'job_state': 'Q', 'comment': m}
+        self.server.expect(JOB, a, id=jid1)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
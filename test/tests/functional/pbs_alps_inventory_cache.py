@@ -0,0 +1,67 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+@tags('cray', 'mom')
+class TestAlpsInventoryCache(TestFunctional):
+    """
+    Test that Mom reuses the vnodes generated from an unchanged ALPS
+    inventory instead of parsing it again
+    """
+
+    def setUp(self):
+        platform = DshUtils().get_platform()
+        if platform != 'cray' and platform != 'craysim':
+            self.skipTest("This is not a cray platform")
+        TestFunctional.setUp(self)
+
+    def test_hup_reuses_inventory(self):
+        """
+        HUP Mom and check the inventory is reused, with the
+        same compute vnodes reported
+        """
+        a = {'resources_available.vntype': 'cray_compute'}
+        before = self.server.filter(VNODE, a)
+        now = int(time.time())
+        self.mom.signal('-HUP')
+        self.mom.log_match('ALPS inventory unchanged, reused',
+                           starttime=now, max_attempts=10)
+        after = self.server.filter(VNODE, a)
+        self.assertEqual(sorted(before.values()), sorted(after.values()))
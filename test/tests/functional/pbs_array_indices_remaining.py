@@ -0,0 +1,79 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestArrayIndicesRemaining(TestFunctional):
+    """
+    Test that array_indices_remaining follows the subjob states of a
+    stepped array job, including across a server restart
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 3},
+                            id=self.mom.shortname)
+
+    def test_remaining_with_holes(self):
+        """
+        Run three subjobs of a 1-399:2 array, delete some queued subjobs
+        and check the remaining range before and after a server restart
+        """
+        j = Job(TEST_USER, attrs={ATTR_J: '1-399:2'})
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'B'}, jid)
+        for i in ['1', '3', '5']:
+            self.server.expect(JOB, {'job_state': 'R'},
+                               jid.replace('[]', '[' + i + ']'))
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.server.expect(JOB, {'array_indices_remaining': '7-399:2'}, jid)
+
+        for i in ['7', '101', '103']:
+            self.server.delete(jid.replace('[]', '[' + i + ']'))
+        remaining = '9-99:2,105-399:2'
+        self.server.expect(JOB, {'array_indices_remaining': remaining}, jid)
+
+        self.server.restart()
+        self.server.expect(JOB, {'array_indices_remaining': remaining}, jid)
+        self.server.expect(JOB, {'job_state': 'Q'},
+                           jid.replace('[]', '[9]'))
+        self.server.expect(JOB, {'job_state': 'X'},
+                           jid.replace('[]', '[101]'))
@@ -0,0 +1,89 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+
+from tests.functional import *
+
+
+class TestChangedSinceStatus(TestFunctional):
+    """
+    Test statusing only the objects changed since a modification sequence
+    """
+
+    def changed_since(self, obj_type, seq):
+        return self.server.status(obj_type, extend='C%d' % seq)
+
+    def test_job_changed_since(self):
+        """
+        Test that only the jobs changed or deleted since a sequence are
+        returned
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jid1 = self.server.submit(Job(TEST_USER))
+        jid2 = self.server.submit(Job(TEST_USER))
+
+        st = self.changed_since(JOB, 0)
+        self.assertEqual(len(st), 2)
+        seq = max([int(s['modify_sequence']) for s in st])
+
+        self.assertEqual(self.changed_since(JOB, seq), [])
+
+        self.server.alterjob(jid1, {'Priority': 10})
+        st = self.changed_since(JOB, seq)
+        self.assertEqual([s['id'] for s in st], [jid1])
+        seq = int(st[0]['modify_sequence'])
+
+        self.server.delete(jid2, wait=True)
+        st = self.changed_since(JOB, seq)
+        self.assertEqual([s['id'] for s in st], [jid2])
+        self.assertEqual(st[0]['deleted'], 'True')
+
+    def test_node_changed_since(self):
+        """
+        Test that a vnode is returned once it changes
+        """
+        st = self.changed_since(NODE, 0)
+        seq = max([int(s['modify_sequence']) for s in st])
+        self.assertEqual(self.changed_since(NODE, seq), [])
+
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'comment': 'changed'}, id=self.mom.shortname)
+        st = self.changed_since(NODE, seq)
+        self.assertEqual(len(st), 1)
+        self.assertEqual(st[0]['comment'], 'changed')
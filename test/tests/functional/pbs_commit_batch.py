@@ -0,0 +1,73 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestCommitBatch(TestFunctional):
+    """
+    Test that jobs committed together by many clients are each queued,
+    accounted for and saved to the datastore
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+    def test_concurrent_submit(self):
+        """
+        Submit jobs from many qsub processes at once, and check that every
+        one gets a job id, is queued with a Q accounting record, and is
+        still there after the server restarts
+        """
+        count = 40
+        qsub = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin',
+                            'qsub')
+        cmd = 'for i in $(seq %d); do %s -- /bin/sleep 1000 & done; wait'
+        rv = self.du.run_cmd(self.server.hostname, cmd % (count, qsub),
+                             runas=TEST_USER, as_script=True)
+        self.assertEqual(rv['rc'], 0)
+        jids = [j for j in rv['out'] if j.strip()]
+        self.assertEqual(len(jids), count)
+
+        self.server.expect(JOB, {'job_state=Q': count}, count=True)
+        for jid in jids:
+            self.server.accounting_match(';Q;%s;' % jid, n='ALL')
+
+        self.server.restart()
+        self.server.expect(JOB, {'job_state=Q': count}, count=True)
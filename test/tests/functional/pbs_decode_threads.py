@@ -0,0 +1,76 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+
+class TestDecodeThreads(TestFunctional):
+    """
+    Test that the server reads requests on decode threads when
+    PBS_SERVER_DECODE_THREADS is set in pbs.conf
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'PBS_SERVER_DECODE_THREADS': 4}
+        self.du.set_pbs_config(hostname=self.server.hostname, confs=a,
+                               append=True)
+        self.server.restart()
+        self.server.log_match('4 request decode threads started')
+
+    def test_submit_stat_delete(self):
+        """
+        Submit, status and delete jobs over several connections at once
+        and check every request is answered
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = [self.server.submit(Job(TEST_USER)) for _ in range(50)]
+        self.server.expect(JOB, {'job_state=Q': 50}, count=True)
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
+        self.server.delete(jids)
+        self.server.expect(JOB, {'job_state=Q': 0}, count=True)
+
+    def test_run_job(self):
+        """
+        Check a job runs and finishes with the decode threads on
+        """
+        j = Job(TEST_USER)
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid, offset=1)
@@ -0,0 +1,79 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestExecJobOneShot(TestFunctional):
+    """
+    Test that the server starts a small single host job by sending it to
+    the mom in one Exec Job request, and a larger one step by step
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+
+    def submit_script(self, body):
+        """
+        Submit a job running body that exits with 0
+        """
+        j = Job(TEST_USER)
+        j.create_script('#!/bin/sh\n%sexit 0\n' % body)
+        return self.server.submit(j)
+
+    def test_small_job_one_request(self):
+        """
+        Check a small job is sent in one request and runs to completion
+        """
+        jid = self.submit_script('echo hello\n')
+        self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 0},
+                           id=jid, extend='x', offset=1)
+        self.mom.log_match(jid + ';exec job request received')
+
+    def test_large_script_step_by_step(self):
+        """
+        Check a job whose script takes more than one chunk is still sent
+        step by step, and runs all the same
+        """
+        jid = self.submit_script('# padding\n' * 8000)
+        self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 0},
+                           id=jid, extend='x', offset=1)
+        self.mom.log_match(jid + ';exec job request received',
+                           existence=False, max_attempts=5)
@@ -0,0 +1,93 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestFastJobExit(TestFunctional):
+    """
+    Test end of job processing for jobs that have nothing to stage out,
+    or whose stage-in files are removed with their private sandbox
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        self.files = []
+
+    def tearDown(self):
+        for f in self.files:
+            self.du.rm(self.server.hostname, f, force=True, sudo=True)
+        TestFunctional.tearDown(self)
+
+    def test_exit_no_stageout(self):
+        """
+        Run jobs that keep their output on the execution host and check
+        each one finishes with an end record
+        """
+        jids = []
+        for _ in range(10):
+            j = Job(TEST_USER, attrs={ATTR_k: 'oe'})
+            j.set_sleep_time(1)
+            jids.append(self.server.submit(j))
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'F', 'substate': 92},
+                               extend='x', id=jid, offset=1)
+            self.server.accounting_match(';E;%s;' % jid, n='ALL')
+
+    def test_exit_sandbox_stagein(self):
+        """
+        Stage a file into a private sandbox and check the job finishes
+        with its output returned
+        """
+        host = self.server.hostname
+        fn = self.du.create_temp_file(asuser=str(TEST_USER), body='stage')
+        self.files.append(fn)
+        a = {ATTR_sandbox: 'PRIVATE',
+             ATTR_stagein: 'data_in@' + host + ':' + fn}
+        j = Job(TEST_USER, attrs=a)
+        j.create_script('#!/bin/sh\ncat data_in\n', hostname=host)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F', 'substate': 92},
+                           extend='x', id=jid, offset=1)
+        self.server.accounting_match(';E;%s;' % jid, n='ALL')
+        job_status = self.server.status(JOB, id=jid, extend='x')
+        out = job_status[0][ATTR_o].split(':')[1]
+        self.files.append(out)
+        self.assertTrue(self.du.isfile(host, path=out, sudo=True))
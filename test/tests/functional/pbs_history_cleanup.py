@@ -0,0 +1,85 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestHistoryCleanup(TestFunctional):
+    """
+    Test the purge of history jobs once their job_history_duration is over
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'job_history_enable': 'True', 'job_history_duration': 5}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+
+    def job_gone(self, jid):
+        """
+        Whether the server no longer knows the job, even as history
+        """
+        try:
+            self.server.status(JOB, 'job_state', id=jid, extend='x')
+        except PbsStatusError as err:
+            #  rc = 153 is for 'Unknown Job Id'
+            self.assertEqual(err.rc, 153)
+            return True
+        return False
+
+    @timeout(400)
+    def test_expired_history_purged(self):
+        """
+        Check finished jobs are purged after job_history_duration
+        """
+        jids = []
+        for _ in range(5):
+            j = Job(TEST_USER)
+            j.set_sleep_time(1)
+            jids.append(self.server.submit(j))
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'F'}, id=jid, extend='x',
+                               offset=1, interval=1)
+
+        # history work task runs at least every two minutes
+        for _ in range(30):
+            if all(self.job_gone(jid) for jid in jids):
+                break
+            time.sleep(5)
+        for jid in jids:
+            self.assertTrue(self.job_gone(jid),
+                            "history job %s was not purged" % jid)
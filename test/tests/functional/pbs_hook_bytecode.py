@@ -0,0 +1,70 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestHookBytecode(TestFunctional):
+    """
+    Test the bytecode pbs_python keeps for MoM hook scripts
+    """
+
+    def run_job_with_hook(self, msg):
+        hook_body = ("import pbs\n"
+                     "e = pbs.event()\n"
+                     "pbs.logjobmsg(e.job.id, '%s')\n" % msg)
+        attr = {'event': 'execjob_begin', 'enabled': 'True'}
+        self.server.create_import_hook('bc_begin', attr, hook_body,
+                                       overwrite=True)
+        j = Job(TEST_USER)
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.mom.log_match("Job;%s;%s" % (jid, msg), max_attempts=10,
+                           interval=2)
+
+    def test_bytecode_kept_and_refreshed(self):
+        """
+        Check the bytecode file is written when a MoM hook runs and not
+        used once the hook script is replaced
+        """
+        self.run_job_with_hook('bytecode first')
+        bc = os.path.join(self.mom.pbs_conf['PBS_HOME'], 'mom_priv',
+                          'hooks', 'bc_begin.PYC')
+        self.assertTrue(self.du.isfile(hostname=self.mom.hostname, path=bc,
+                                       sudo=True))
+        self.run_job_with_hook('bytecode second')
@@ -0,0 +1,74 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestHookLazyResources(TestFunctional):
+    """
+    Test the resource lists of the jobs and vnodes a MoM hook is given are
+    loaded when the hook looks at them
+    """
+
+    def test_resources_read_and_set(self):
+        """
+        Check an execjob_prologue hook sees the job's and its vnode's
+        resources, and that a resource it sets on the vnode reaches the
+        server
+        """
+        a = {'resources_available.ncpus': 2}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.mom.shortname)
+        hook_body = """
+import pbs
+e = pbs.event()
+j = e.job
+pbs.logjobmsg(j.id, 'job ncpus=%s' % j.Resource_List['ncpus'])
+for name, vn in e.vnode_list.items():
+    pbs.logjobmsg(j.id, 'vnode ncpus=%s' %
+                  vn.resources_available['ncpus'])
+    vn.resources_available['ncpus'] = 3
+"""
+        attr = {'event': 'execjob_prologue', 'enabled': 'True'}
+        self.server.create_import_hook('lazy_resc', attr, hook_body)
+        j = Job(TEST_USER, attrs={'Resource_List.ncpus': 1})
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.mom.log_match("Job;%s;job ncpus=1" % jid)
+        self.mom.log_match("Job;%s;vnode ncpus=2" % jid)
+        self.server.expect(NODE, {'resources_available.ncpus': 3},
+                           id=self.mom.shortname)
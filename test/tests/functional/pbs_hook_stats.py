@@ -0,0 +1,75 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestHookStats(TestFunctional):
+    """
+    Test the execution statistics kept for each hook
+    """
+
+    def test_queuejob_stats(self):
+        """
+        Check the stats attribute of a queuejob hook counts the jobs it
+        accepted and rejected, and that print hook does not show it
+        """
+        hook_body = """
+import pbs
+e = pbs.event()
+if e.job.Job_Name == 'rejected':
+    e.reject('rejected by hook')
+e.accept()
+"""
+        attr = {'event': 'queuejob', 'enabled': 'True'}
+        self.server.create_import_hook('stats_hk', attr, hook_body)
+        self.server.submit(Job(TEST_USER))
+        j = Job(TEST_USER, attrs={ATTR_N: 'rejected'})
+        with self.assertRaises(PbsSubmitError):
+            self.server.submit(j)
+        qmgr = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin', 'qmgr')
+        cmd = [qmgr, '-c', 'list hook stats_hk stats']
+        ret = self.du.run_cmd(self.server.hostname, cmd=cmd, sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        out = ' '.join(ret['out'])
+        self.assertIn('queuejob: runs=2 accepts=1 rejects=1', out)
+        cmd = [qmgr, '-c', 'print hook stats_hk']
+        ret = self.du.run_cmd(self.server.hostname, cmd=cmd, sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        self.assertNotIn('stats', ' '.join(ret['out']).replace('stats_hk',
+                                                                ''))
@@ -0,0 +1,65 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestHookSyncDelta(TestFunctional):
+    """
+    Test the server only resends mom hook files a mom does not already have
+    """
+
+    def test_restart_no_resend(self):
+        """
+        Check that after a server restart a mom that reported current hook
+        checksums is not sent the hook files again
+        """
+        hook_body = """
+import pbs
+pbs.event().accept()
+"""
+        a = {'event': 'execjob_begin', 'enabled': 'True'}
+        self.server.create_import_hook('delta_hk', a, hook_body)
+        self.server.manager(MGR_CMD_SET, SERVER, {'log_events': 2047})
+        self.server.log_match("successfully sent hook file .*delta_hk.HK",
+                              regexp=True, max_attempts=30, interval=2)
+        start = int(time.time())
+        self.server.restart()
+        self.server.log_match("delta_hk;mom .* already has the current hook "
+                              "files, not resending", regexp=True,
+                              starttime=start, max_attempts=30, interval=2)
@@ -0,0 +1,106 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestHostCache(TestFunctional):
+    """
+    Test the cache of host name lookups kept by the daemons when
+    PBS_HOST_CACHE_TTL is set in pbs.conf
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'PBS_HOST_CACHE_TTL': 300}
+        self.du.set_pbs_config(hostname=self.server.hostname, confs=a,
+                               append=True)
+        if self.mom.hostname != self.server.hostname:
+            self.du.set_pbs_config(hostname=self.mom.hostname, confs=a,
+                                   append=True)
+        self.restart_daemons()
+
+    def tearDown(self):
+        self.du.unset_pbs_config(hostname=self.server.hostname,
+                                 confs=['PBS_HOST_CACHE_TTL'])
+        if self.mom.hostname != self.server.hostname:
+            self.du.unset_pbs_config(hostname=self.mom.hostname,
+                                     confs=['PBS_HOST_CACHE_TTL'])
+        TestFunctional.tearDown(self)
+        self.restart_daemons()
+
+    def restart_daemons(self):
+        """
+        Restart pbs_comm, the server and the mom so they read pbs.conf
+        """
+        self.comm.restart()
+        self.server.restart()
+        self.mom.restart()
+        self.server.expect(NODE, {'state': 'free'}, id=self.mom.shortname)
+
+    def test_jobs_run_with_cache(self):
+        """
+        Check jobs run with lookups cached, and again after every daemon
+        has been sent SIGHUP to discard the cache
+        """
+        j = Job(TEST_USER)
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid, offset=1)
+
+        self.assertTrue(self.comm.signal('-HUP'))
+        self.assertTrue(self.server.signal('-HUP'))
+        self.assertTrue(self.mom.signal('-HUP'))
+        self.assertTrue(self.comm.isUp())
+        self.assertTrue(self.server.isUp())
+        self.assertTrue(self.mom.isUp())
+
+        j = Job(TEST_USER)
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid, offset=1)
+
+    def test_unknown_host_stays_unknown(self):
+        """
+        Check a vnode cannot be created for a host that does not resolve,
+        whether or not the failed lookup has been cached
+        """
+        for _ in range(2):
+            with self.assertRaises(PbsManagerError):
+                self.server.manager(MGR_CMD_CREATE, NODE, id='nohost.invalid')
+        self.server.expect(NODE, {'state': 'free'}, id=self.mom.shortname)
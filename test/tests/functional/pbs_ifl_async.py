@@ -0,0 +1,115 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+try:
+    from ptl.lib import pbs_ifl
+except ImportError:
+    pbs_ifl = None
+
+
+class TestIflAsync(TestFunctional):
+    """
+    Test the asynchronous IFL calls, pbs_*_async() and pbs_async_wait(),
+    with and without the server pipelining the requests
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        if pbs_ifl is None:
+            self.skipTest('needs the IFL bindings made by pbs_swigify')
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.jids = [self.server.submit(Job(TEST_USER)) for _ in range(3)]
+
+    def check_replies(self, c):
+        """
+        Send several requests ahead of their replies on connection ``c``
+        and check the replies come back in order with their own tags
+        """
+        j1, j2, j3 = self.jids
+        sent = [(pbs_ifl.pbs_statjob_async(c, j1, None, None), 0, j1),
+                (pbs_ifl.pbs_deljob_async(c, j2, None), 0, ''),
+                # must see the delete before it
+                (pbs_ifl.pbs_statjob_async(c, j2, None, None), 1, ''),
+                (pbs_ifl.pbs_statjob_async(c, j3, None, None), 0, j3)]
+        tags = [s[0] for s in sent]
+        self.assertTrue(all(t > 0 for t in tags))
+        self.assertEqual(len(set(tags)), len(tags))
+        self.assertEqual(pbs_ifl.pbs_async_pending(c), len(sent))
+
+        # a synchronous call leaves the outstanding replies queued
+        bs = pbs_ifl.pbs_statserver(c, None, None)
+        self.assertEqual(len(bs), 1)
+        self.assertEqual(pbs_ifl.pbs_async_pending(c), len(sent))
+
+        for tag, failed, name in sent:
+            rc, rtag, rname = pbs_ifl.pbs_py_async_wait(c)
+            self.assertEqual(rtag, tag)
+            if failed:
+                self.assertGreater(rc, 0)
+            else:
+                self.assertEqual(rc, 0)
+                self.assertEqual(rname, name)
+        self.assertEqual(pbs_ifl.pbs_async_pending(c), 0)
+        rc, rtag, rname = pbs_ifl.pbs_py_async_wait(c)
+        self.assertEqual(rc, -1)
+
+    def test_pipelined(self):
+        """
+        Check the replies to requests pipelined on one connection
+        """
+        c = pbs_ifl.pbs_connect(self.server.hostname)
+        self.assertGreater(c, 0)
+        try:
+            self.check_replies(c)
+        finally:
+            pbs_ifl.pbs_disconnect(c)
+
+    def test_not_pipelined(self):
+        """
+        Connect offering only the binary format, as to a server that
+        does not pipeline, and check each call completes in turn with
+        the same results
+        """
+        c = pbs_ifl.pbs_connect_extend(self.server.hostname, 'dis-binary')
+        self.assertGreater(c, 0)
+        try:
+            self.check_replies(c)
+        finally:
+            pbs_ifl.pbs_disconnect(c)
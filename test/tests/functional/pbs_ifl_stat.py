@@ -0,0 +1,118 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestIflStat(TestFunctional):
+    """
+    Test the _pbs_ifl_stat module of pbs_python and the pbs.server()
+    objects built from it in pbs_python mode
+    """
+
+    def run_pbs_python(self, body):
+        """
+        Run a script with pbs_python --hook on the server host, which
+        queries the server for pbs.server(), and return its output lines
+        """
+        fn = self.du.create_temp_file(hostname=self.server.hostname,
+                                      body=body, suffix='.py')
+        inp = self.du.create_temp_file(hostname=self.server.hostname,
+                                       body='pbs.event().type=queuejob\n')
+        cmd = [os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin',
+                            'pbs_python'), '--hook', '-i', inp, fn]
+        ret = self.du.run_cmd(self.server.hostname, cmd=cmd, sudo=True)
+        self.du.rm(hostname=self.server.hostname, path=fn)
+        self.du.rm(hostname=self.server.hostname, path=inp)
+        self.assertEqual(ret['rc'], 0, 'pbs_python failed: %s' % ret['err'])
+        return ret['out']
+
+    def test_stat_and_pages(self):
+        """
+        Check stat() and statjob_pages() return every job with its
+        attributes, a page at a time for the latter
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for _ in range(7):
+            j = Job(TEST_USER, attrs={'Resource_List.ncpus': 1})
+            jids.append(self.server.submit(j))
+        body = """
+import _pbs_ifl_stat
+from _pbs_ifl import pbs_connect, pbs_disconnect
+c = pbs_connect('%s')
+bs = _pbs_ifl_stat.stat('job', c, None, ['job_state', 'Resource_List.ncpus'])
+for (name, attribs) in bs:
+    print('STAT %%s %%s' %% (name, ' '.join(
+        '%%s.%%s=%%s' %% (n, r, v) for (n, r, v) in attribs)))
+for (name, attribs) in _pbs_ifl_stat.statjob_pages(c, None, ['job_state'], 3):
+    print('PAGE %%s' %% name)
+print('NONE %%s' %% (_pbs_ifl_stat.stat('job', c, '999999.nohost') is None))
+pbs_disconnect(c)
+""" % self.server.hostname
+        out = self.run_pbs_python(body)
+        stat = [l.split()[1] for l in out if l.startswith('STAT ')]
+        page = [l.split()[1] for l in out if l.startswith('PAGE ')]
+        self.assertEqual(sorted(stat), sorted(jids))
+        self.assertEqual(sorted(page), sorted(jids))
+        for l in out:
+            if l.startswith('STAT '):
+                self.assertIn('job_state.None=Q', l)
+                self.assertIn('Resource_List.ncpus=1', l)
+        self.assertIn('NONE True', out)
+
+    def test_server_objects(self):
+        """
+        Check pbs.server() in pbs_python mode returns the jobs, queues and
+        vnodes of the server
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j = Job(TEST_USER, attrs={'Resource_List.walltime': 100})
+        jid = self.server.submit(j)
+        body = """
+import pbs
+s = pbs.server()
+print('JOBS %s' % ' '.join(str(j.id) for j in s.jobs()))
+print('QUEUES %s' % ' '.join(str(q.name) for q in s.queues()))
+print('VNODES %s' % ' '.join(str(v.name) for v in s.vnodes()))
+print('WALLTIME %s' % s.job('""" + jid + """').Resource_List['walltime'])
+"""
+        out = self.run_pbs_python(body)
+        self.assertIn('JOBS %s' % jid, out)
+        self.assertIn('QUEUES workq', out)
+        self.assertIn('VNODES %s' % self.mom.shortname, out)
+        self.assertIn('WALLTIME 00:01:40', out)
@@ -0,0 +1,89 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+from tests.functional import *
+
+
+class TestIncrementalCalendar(TestFunctional):
+    """
+    Test that top job start estimates are kept between cycles with
+    incremental_calendar
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SCHED, {'log_events': 2047})
+        a = {'resources_available.ncpus': 2}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.mom.shortname)
+        a = {'strict_ordering': 'True ALL', 'incremental_calendar': 'True'}
+        self.scheduler.set_sched_config(a)
+
+    def test_estimate_reused(self):
+        """
+        Test that a top job's estimate is reused while nothing changes and
+        recalculated when a job ends
+        """
+        a = {'Resource_List.select': '1:ncpus=2',
+             'Resource_List.walltime': 3600}
+        j1 = Job(TEST_USER, a)
+        j1.set_sleep_time(3600)
+        jid1 = self.server.submit(j1)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j2 = Job(TEST_USER, a)
+        jid2 = self.server.submit(j2)
+
+        t = int(time.time())
+        self.scheduler.run_scheduling_cycle()
+        self.scheduler.log_match(jid2 + ";Estimating the start time for "
+                                 "a top job", starttime=t)
+        self.server.expect(JOB, 'estimated.start_time', op=SET, id=jid2)
+        est = self.server.status(JOB, 'estimated.start_time',
+                                 id=jid2)[0]['estimated.start_time']
+
+        t = int(time.time())
+        self.scheduler.run_scheduling_cycle()
+        self.scheduler.log_match(jid2 + ";Reusing the start time estimate "
+                                 "of a top job", starttime=t)
+        self.server.expect(JOB, {'estimated.start_time': est}, id=jid2)
+
+        self.server.delete(jid1, wait=True)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
@@ -0,0 +1,87 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestIncrementalEquivClass(TestFunctional):
+    """
+    Test that the reasons equivalence classes can not run are kept between
+    cycles with incremental_equiv_class
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SCHED, {'log_events': 2047})
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.mom.shortname)
+        self.scheduler.set_sched_config({'incremental_equiv_class': 'True'})
+
+    def test_reason_kept(self):
+        """
+        Test that a class which could not run is not evaluated again while
+        nothing changes, and is once a job ends
+        """
+        a = {'Resource_List.select': '1:ncpus=1'}
+        j1 = Job(TEST_USER, a)
+        j1.set_sleep_time(3600)
+        jid1 = self.server.submit(j1)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j2 = Job(TEST_USER, a)
+        jid2 = self.server.submit(j2)
+
+        t = int(time.time())
+        self.scheduler.run_scheduling_cycle()
+        self.scheduler.log_match(jid2 + ";Insufficient amount of resource",
+                                 starttime=t)
+        self.server.expect(JOB, 'comment', op=SET, id=jid2)
+        comment = self.server.status(JOB, 'comment', id=jid2)[0]['comment']
+
+        t = int(time.time())
+        self.scheduler.run_scheduling_cycle()
+        msg = "1 of [0-9]+ job equivalence classes can not run for the " \
+              "same reason as last cycle"
+        self.scheduler.log_match(msg, regexp=True, starttime=t)
+        self.server.expect(JOB, {'job_state': 'Q', 'comment': comment},
+                           id=jid2)
+
+        self.server.delete(jid1, wait=True)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
@@ -0,0 +1,66 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestJobEnvTable(TestFunctional):
+    """
+    Test that a job started with a large environment gets every variable
+    exactly once, with the PBS values taking precedence
+    """
+
+    def test_many_variables(self):
+        """
+        Submit a job with 500 variables in its variable list, one of them
+        given twice, and check the job environment
+        """
+        env = ['PTLV%d=%d' % (i, i) for i in range(500)]
+        env.append('PTLV7=last')
+        a = {ATTR_v: ','.join(env)}
+        j = Job(TEST_USER, attrs=a)
+        j.create_script(body=['env | grep -c "^PTLV"',
+                              'echo $PTLV0 $PTLV7 $PTLV499',
+                              'echo $PBS_JOBID'])
+        jid = self.server.submit(j)
+        qstat = self.server.status(JOB, ATTR_o, id=jid)
+        job_outfile = qstat[0][ATTR_o].split(':')[1]
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid, offset=1)
+        ret = self.du.cat(hostname=self.server.hostname,
+                          filename=job_outfile, sudo=True)
+        self.assertEqual(ret['out'][:3], ['500', '0 last 499', jid])
@@ -0,0 +1,67 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestJobRecovery(TestFunctional):
+    """
+    Test that jobs and their attributes are recovered from the database
+    when the server restarts
+    """
+
+    def test_recover_attributes(self):
+        """
+        Submit jobs with resources, limits and a variable list, restart
+        the server and check each job comes back as it was
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        a = {'Resource_List.ncpus': 2, 'Resource_List.walltime': '01:00:00',
+             ATTR_p: 5, ATTR_N: 'recov', ATTR_v: 'RECOV_VAR=one'}
+        jids = []
+        for _ in range(50):
+            j = Job(TEST_USER, attrs=a)
+            jids.append(self.server.submit(j))
+        self.server.restart()
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'Q',
+                                     'Resource_List.ncpus': 2,
+                                     'Resource_List.walltime': '01:00:00',
+                                     ATTR_p: 5, ATTR_N: 'recov'}, id=jid)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jids[0])
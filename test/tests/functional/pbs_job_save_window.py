@@ -0,0 +1,95 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+
+from tests.functional import *
+
+
+class TestJobSaveWindow(TestFunctional):
+    """
+    Test that job changes held back by PBS_SERVER_JOB_SAVE_WINDOW in
+    pbs.conf still reach the database
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'PBS_SERVER_JOB_SAVE_WINDOW': 2}
+        self.du.set_pbs_config(hostname=self.server.hostname, confs=a,
+                               append=True)
+        self.server.restart()
+
+    def test_alter_written(self):
+        """
+        Alter jobs several times, wait for the window to pass, then
+        restart the server and check the last values were recovered
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = [self.server.submit(Job(TEST_USER)) for _ in range(20)]
+        for jid in jids:
+            for n in range(3):
+                self.server.alterjob(jid, {ATTR_N: 'name%d' % n})
+        time.sleep(3)
+        self.server.restart()
+        for jid in jids:
+            self.server.expect(JOB, {ATTR_N: 'name2'}, id=jid)
+
+    def test_shutdown_written(self):
+        """
+        Alter a job and stop the server at once, the change is written
+        on the way down
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jid = self.server.submit(Job(TEST_USER))
+        self.server.alterjob(jid, {ATTR_N: 'quick'})
+        self.server.restart()
+        self.server.expect(JOB, {ATTR_N: 'quick'}, id=jid)
+
+    def test_status_before_write(self):
+        """
+        Status a job between its change and the write of the change,
+        the change is still written
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jid = self.server.submit(Job(TEST_USER))
+        time.sleep(3)
+        self.server.alterjob(jid, {ATTR_N: 'seen', ATTR_p: 10})
+        self.server.expect(JOB, {ATTR_N: 'seen', ATTR_p: 10}, id=jid)
+        time.sleep(3)
+        self.server.restart()
+        self.server.expect(JOB, {ATTR_N: 'seen', ATTR_p: 10}, id=jid)
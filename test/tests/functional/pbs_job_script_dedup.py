@@ -0,0 +1,83 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestJobScriptDedup(TestFunctional):
+    """
+    Test that jobs whose scripts are identical share one stored copy of
+    the script without affecting which script each job runs
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+
+    def submit_script(self, code):
+        """
+        Submit a job whose script exits with code
+        """
+        j = Job(TEST_USER)
+        j.create_script('#!/bin/sh\nexit %d\n' % code)
+        return self.server.submit(j)
+
+    def test_shared_script_survives_delete(self):
+        """
+        Check that deleting a job does not remove the script it shares
+        with another job, including after the server reloads its jobs,
+        and that a job with a different script keeps its own
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jid1 = self.submit_script(3)
+        jid2 = self.submit_script(3)
+        jid3 = self.submit_script(4)
+        self.server.delete(jid1)
+        self.server.restart()
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 3},
+                           id=jid2, extend='x', offset=1)
+        self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 4},
+                           id=jid3, extend='x')
+
+        # a later job with the same script takes another reference to it
+        jid4 = self.submit_script(3)
+        self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 3},
+                           id=jid4, extend='x', offset=1)
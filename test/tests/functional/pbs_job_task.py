@@ -95,3 +95,31 @@ class TestJobTask(TestFunctional):
             self.logger.info("job_out=%s" % (job_out,))
 
         self.assertEqual(job_out, "OK")
+
+    def test_pbsdsh_aggregate_exit(self):
+        """
+        This test case validates that pbsdsh -e exits with the highest
+        exit status of its tasks, and pbsdsh without -e exits with 0.
+        """
+
+        job = Job(TEST_USER)
+        script = ['pbsdsh -c 3 -e -- /bin/sh -c "exit 3"',
+                  'echo "EXIT=$?"',
+                  'pbsdsh -c 3 -- /bin/sh -c "exit 3"',
+                  'echo "EXIT=$?"']
+        job.create_script(body=script)
+        jid = self.server.submit(job)
+
+        self.server.expect(JOB, {'job_state': 'F'}, id=jid, extend='x')
+
+        job_status = self.server.status(JOB, id=jid, extend='x')
+        if job_status:
+            job_output_file = job_status[0]['Output_Path'].split(':')[1]
+
+        with open(job_output_file, 'r') as fd:
+            job_out = fd.read()
+            self.logger.info("job_out=%s" % (job_out,))
+
+        self.assertIn("3 of 3 tasks failed", job_out)
+        exits = [l for l in job_out.splitlines() if l.startswith("EXIT=")]
+        self.assertEqual(exits, ["EXIT=3", "EXIT=0"])
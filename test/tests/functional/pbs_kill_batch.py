@@ -0,0 +1,83 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestKillBatch(TestFunctional):
+    """
+    Test signals sent to all the tasks of a job from one process sample
+    """
+
+    script = """#!/bin/sh
+for i in 1 2 3 4; do
+    sleep 1000 &
+done
+sleep 1000
+"""
+
+    def start_job(self):
+        j = Job(TEST_USER)
+        j.create_script(self.script, hostname=self.server.hostname)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        return jid
+
+    def test_suspend_resume(self):
+        """
+        Suspend and resume a job a few times and check it ends up running
+        """
+        jid = self.start_job()
+        for _ in range(3):
+            self.server.sigjob(jid, 'suspend')
+            self.server.expect(JOB, {'job_state': 'S'}, id=jid)
+            self.server.sigjob(jid, 'resume')
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+    def test_delete(self):
+        """
+        Delete several jobs at once and check none of their processes
+        is left on the execution host
+        """
+        jids = [self.start_job() for _ in range(3)]
+        self.server.delete(jids, wait=True)
+        for jid in jids:
+            self.mom.log_match('%s;kill_job' % jid)
+        ret = self.du.run_cmd(self.mom.hostname, ['pgrep', '-u',
+                                                  str(TEST_USER), 'sleep'])
+        self.assertNotEqual(ret['rc'], 0, 'sleep processes left behind')
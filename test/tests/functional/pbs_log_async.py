@@ -0,0 +1,109 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestLogAsync(TestFunctional):
+    """
+    Test the server log written by a separate thread, as set by
+    PBS_SERVER_LOG_ASYNC_SIZE in pbs.conf
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.set_log_size(1024)
+
+    def set_log_size(self, size):
+        """
+        Restart the server with ``size`` kilobyte log buffers
+        """
+        a = {'PBS_SERVER_LOG_ASYNC_SIZE': size}
+        self.du.set_pbs_config(hostname=self.server.hostname, confs=a,
+                               append=True)
+        self.server.restart()
+
+    def tearDown(self):
+        self.du.unset_pbs_config(hostname=self.server.hostname,
+                                 confs=['PBS_SERVER_LOG_ASYNC_SIZE'])
+        TestFunctional.tearDown(self)
+        self.server.restart()
+
+    def test_records_written(self):
+        """
+        Submit jobs and check the server logged each of them
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = [self.server.submit(Job(TEST_USER)) for _ in range(10)]
+        for jid in jids:
+            self.server.log_match(jid + ';Job Queued', max_attempts=10)
+
+    def test_dropped_records_reported(self):
+        """
+        Log far more than two 1 kilobyte buffers hold from a hook and
+        check the records that did not fit are counted in the log, and
+        logging carries on afterwards
+        """
+        self.set_log_size(1)
+        self.server.manager(MGR_CMD_SET, SERVER, {'log_events': 2047})
+        hook_body = """
+import pbs
+for i in range(5000):
+    pbs.logmsg(pbs.LOG_DEBUG, 'flood %d ' % i + 'x' * 400)
+pbs.event().accept()
+"""
+        a = {'event': 'queuejob', 'enabled': 'True'}
+        self.server.create_import_hook('flood', a, hook_body)
+        self.server.submit(Job(TEST_USER))
+        self.server.log_match('Log;[0-9]+ log records dropped', regexp=True,
+                              max_attempts=10)
+        self.server.manager(MGR_CMD_DELETE, HOOK, id='flood')
+        jid = self.server.submit(Job(TEST_USER))
+        self.server.log_match(jid + ';Job Queued', max_attempts=10)
+
+    def test_records_written_on_stop(self):
+        """
+        Check the records logged just before the server stops reach the
+        log
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jid = self.server.submit(Job(TEST_USER))
+        self.server.stop()
+        self.server.log_match(jid + ';Job Queued', max_attempts=2)
+        self.server.log_match('Log closed', max_attempts=2)
+        self.server.start()
@@ -0,0 +1,95 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestLogIndex(TestFunctional):
+    """
+    Test the job index written alongside the daemon logs, as set by
+    PBS_LOG_INDEX in pbs.conf, and its use by tracejob
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'PBS_LOG_INDEX': 1}
+        self.du.set_pbs_config(hostname=self.server.hostname, confs=a,
+                               append=True)
+        self.server.restart()
+
+    def tearDown(self):
+        self.du.unset_pbs_config(hostname=self.server.hostname,
+                                 confs=['PBS_LOG_INDEX'])
+        TestFunctional.tearDown(self)
+        self.server.restart()
+
+    def tracejob_msgs(self, jid):
+        """
+        Return the server log messages tracejob finds for a job
+        """
+        lines = self.server.log_lines(logtype='tracejob', id=jid, n='ALL')
+        return [l for l in lines if ' S ' in l]
+
+    def test_tracejob_with_index(self):
+        """
+        Check the index is written, and tracejob finds the same server
+        records for a job with it as the server log has, including the
+        records written before a server restart
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jid = self.server.submit(Job(TEST_USER))
+        self.server.log_match(jid + ';Job Queued', max_attempts=10)
+        self.server.restart()
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.server.log_match(jid + ';Job Run', max_attempts=10)
+        # later jobs fill more of the log after the job's records
+        for _ in range(20):
+            self.server.submit(Job(TEST_USER))
+
+        idx = os.path.join(self.server.pbs_conf['PBS_HOME'], 'server_logs',
+                           time.strftime('%Y%m%d') + '.idx')
+        self.assertTrue(self.du.isfile(hostname=self.server.hostname,
+                                       path=idx, sudo=True),
+                        'log index not written')
+
+        msgs = self.tracejob_msgs(jid)
+        self.assertTrue([m for m in msgs if 'Job Queued' in m],
+                        'tracejob did not find the queued record')
+        self.assertTrue([m for m in msgs if 'Job Run' in m],
+                        'tracejob did not find the run record')
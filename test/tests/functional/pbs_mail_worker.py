@@ -0,0 +1,140 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+import re
+
+from tests.functional import *
+
+
+class TestMailWorker(TestFunctional):
+    """
+    Test the server's mail worker gathering the mail for the same
+    receivers into one message, with a stand-in for sendmail
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        h = self.server.hostname
+        self.sendmail = self.sendmail_path()
+        self.saved = None
+        if self.du.isfile(h, path=self.sendmail, sudo=True):
+            self.saved = self.sendmail + '.ptl_saved'
+            self.du.run_cmd(h, ['mv', self.sendmail, self.saved], sudo=True)
+        self.out = self.du.create_temp_file(h, prefix='PtlPbsMail')
+        self.du.chmod(h, path=self.out, mode=0o666, sudo=True)
+        # each mail goes into the file after a line with the receivers
+        body = '#!/bin/sh\n'
+        body += 'echo "==== $*" >> %s\n' % self.out
+        body += 'cat >> %s\n' % self.out
+        body += 'exit 0\n'
+        script = self.du.create_temp_file(h, body=body)
+        self.du.run_copy(h, src=script, dest=self.sendmail, mode=0o755,
+                         sudo=True)
+        self.du.rm(h, path=script)
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 4},
+                            id=self.mom.shortname)
+
+    def tearDown(self):
+        h = self.server.hostname
+        self.du.rm(h, path=self.sendmail, sudo=True, force=True)
+        if self.saved:
+            self.du.run_cmd(h, ['mv', self.saved, self.sendmail], sudo=True)
+        self.du.rm(h, path=self.out, sudo=True, force=True)
+        TestFunctional.tearDown(self)
+
+    def sendmail_path(self):
+        """
+        Find the sendmail the server was built to run
+        """
+        srv = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'sbin',
+                           'pbs_server.bin')
+        ret = self.du.run_cmd(self.server.hostname, ['strings', srv])
+        if ret['rc'] == 0:
+            for line in ret['out']:
+                if line.startswith('/') and line.endswith('/sendmail'):
+                    return line
+        return '/usr/sbin/sendmail'
+
+    def read_mails(self):
+        """
+        Return the mails given to the stand-in, a list of the lines of
+        each one
+        """
+        ret = self.du.cat(self.server.hostname, filename=self.out,
+                          sudo=True)
+        mails = []
+        for line in ret['out']:
+            if line.startswith('==== '):
+                mails.append([])
+            elif mails:
+                mails[-1].append(line)
+        return mails
+
+    def test_coalesce(self):
+        """
+        Check the begin mails of jobs run together go out as one message
+        holding each body, with the subject of the first and how many
+        more there are
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for _ in range(3):
+            j = Job(TEST_USER, attrs={ATTR_m: 'b'})
+            jids.append(self.server.submit(j))
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+        # the worker waits a couple of seconds for more mail
+        for _ in range(10):
+            mails = self.read_mails()
+            if mails:
+                break
+            time.sleep(1)
+        time.sleep(3)
+        mails = self.read_mails()
+        self.assertEqual(len(mails), 1, 'mail not gathered: %s' % mails)
+
+        subjects = [l for l in mails[0] if l.startswith('Subject: ')]
+        self.assertEqual(len(subjects), 1)
+        m = re.match(r'Subject: PBS JOB (\S+) and 2 more$', subjects[0])
+        self.assertIsNotNone(m, subjects[0])
+        self.assertIn(m.group(1), jids)
+        for jid in jids:
+            self.assertIn('PBS Job Id: %s' % jid, mails[0])
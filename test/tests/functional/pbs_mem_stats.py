@@ -0,0 +1,81 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestMemStats(TestFunctional):
+    """
+    Test the per object memory accounting the server logs on SIGUSR1
+    """
+
+    def test_job_counts(self):
+        """
+        Check the job allocation count follows submission and deletion,
+        and matches the jobs found on the server's list
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jid1 = self.server.submit(Job(TEST_USER))
+        self.server.submit(Job(TEST_USER))
+        start = int(time.time())
+        self.server.signal('-USR1')
+        self.server.log_match('mem_stats;jobs allocated 2 linked 2 history 0',
+                              starttime=start)
+        self.server.log_match('mem_stats;queues allocated 1 linked 1',
+                              starttime=start)
+
+        self.server.delete(jid1, wait=True)
+        start = int(time.time())
+        self.server.signal('-USR1')
+        self.server.log_match('mem_stats;jobs allocated 1 linked 1 history 0',
+                              starttime=start)
+
+    def test_freelist_reuse(self):
+        """
+        Check a job structure freed by a deletion is reused by the next
+        submission, as reported in the freelist statistics
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jid = self.server.submit(Job(TEST_USER))
+        self.server.delete(jid, wait=True)
+        self.server.submit(Job(TEST_USER))
+        start = int(time.time())
+        self.server.signal('-USR1')
+        self.server.log_match(r'mem_stats;freelist job size \d+ free \d+ '
+                              r'malloc \d+ reuse [1-9]', regexp=True,
+                              starttime=start)
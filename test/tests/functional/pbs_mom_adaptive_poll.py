@@ -0,0 +1,67 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestMomAdaptivePoll(TestFunctional):
+    """
+    Test that mom samples a job close to a limit more often than
+    $max_check_poll
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.mom.add_config({'$min_check_poll': '5',
+                             '$max_check_poll': '120'})
+
+    def test_walltime_near_limit(self):
+        """
+        Check a job is killed soon after it reaches a short walltime
+        limit, even though $max_check_poll is long
+        """
+        j = Job(TEST_USER, attrs={'Resource_List.walltime': '30'})
+        j.set_sleep_time(300)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        stime = int(time.time())
+        self.mom.log_match(jid + ';walltime', starttime=stime - 1,
+                           interval=2, max_attempts=30)
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid, interval=2,
+                           max_attempts=20)
+        self.assertLess(int(time.time()) - stime, 60)
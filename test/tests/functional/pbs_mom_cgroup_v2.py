@@ -0,0 +1,76 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestMomCgroupV2(TestFunctional):
+    """
+    Test the cgroup v2 job cgroups mom manages when $cgroup_v2 is set
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        if not self.du.isfile(hostname=self.mom.shortname,
+                              path='/sys/fs/cgroup/cgroup.controllers'):
+            self.skipTest('no cgroup v2 hierarchy at /sys/fs/cgroup')
+        self.mom.add_config({'$cgroup_v2': 'True'})
+
+    def test_job_cgroup(self):
+        """
+        Check a job runs in its own cgroup capped at its mem, and that the
+        cgroup is removed when the job ends
+        """
+        j = Job(TEST_USER, attrs={'Resource_List.mem': '100mb'})
+        j.set_sleep_time(30)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        cg = os.path.join('/sys/fs/cgroup/pbspro', jid)
+        ret = self.du.cat(self.mom.shortname, os.path.join(cg, 'memory.max'),
+                          sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        self.assertEqual(ret['out'][0], str(100 * 1024 * 1024))
+        ret = self.du.cat(self.mom.shortname,
+                          os.path.join(cg, 'cgroup.procs'), sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        self.assertTrue(len(ret['out']) > 0)
+        self.server.delete(jid, wait=True)
+        # a cgroup still busy when the job ends is removed shortly after
+        time.sleep(6)
+        self.assertFalse(self.du.isdir(hostname=self.mom.shortname, path=cg,
+                                       sudo=True))
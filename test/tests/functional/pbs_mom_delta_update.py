@@ -0,0 +1,68 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestMomDeltaUpdate(TestFunctional):
+    """
+    Test that once Mom has sent her vnodes to the server, her later
+    state updates carry only what changed and leave the vnodes intact
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER, {'log_events': 2047})
+        a = {'resources_available.ncpus': 2}
+        self.server.create_vnodes('vn', a, 3, self.mom, usenatvnode=False)
+
+    def test_delta_after_hup(self):
+        """
+        A HUP makes Mom send her state again, which must be a delta
+        update that keeps the vnodes free and their resources set
+        """
+        start = int(time.time())
+        self.mom.signal('-HUP')
+        self.server.log_match("Mom reporting changes to", starttime=start,
+                              max_attempts=30)
+        self.server.log_match("vnode vn[0] is stale", starttime=start,
+                              existence=False, max_attempts=5)
+        for i in range(3):
+            self.server.expect(VNODE, {'state': 'free',
+                                       'resources_available.ncpus': 2},
+                               id='vn[%d]' % i)
@@ -104,6 +104,33 @@ class TestMomDynRes(TestFunctional):
         self.server.expect(JOB, {'job_state': 'Q', 'comment': c},
                            id=jid, attrop=PTL_AND)
 
+    def test_res_from_status(self):
+        """
+        Test that with mom_resources_from_status the scheduler uses the
+        value MoM reports through $status_resources and does not talk to
+        the MoM to get it
+        """
+        resc_name = ["foo"]
+        resc_type = ["long"]
+        resc_flag = ["h"]
+        script_body = ["/bin/echo 3"]
+
+        self.create_mom_resources(resc_name, resc_type, resc_flag, script_body)
+        self.scheduler.set_sched_config({'mom_resources_from_status': 'True'})
+        self.mom.add_config({'$status_resources': 'foo',
+                             '$status_resources_interval': '5'})
+        self.server.expect(NODE, {'resources_available.foo': 3},
+                           id=self.mom.shortname)
+
+        t = int(time.time())
+        attr = {"Resource_List." + resc_name[0]: 3}
+        j = Job(TEST_USER, attrs=attr)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.scheduler.log_match("Initiating communication with mom",
+                                 starttime=t, existence=False,
+                                 max_attempts=5)
+
     def test_res_string_array_value(self):
         """
         Test for host level string_array resource
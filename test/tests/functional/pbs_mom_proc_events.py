@@ -0,0 +1,69 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestMomProcEvents(TestFunctional):
+    """
+    Test that mom finds the processes of a job from proc connector events
+    when $proc_events is set
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.mom.add_config({'$proc_events': 'True'})
+        self.mom.restart()
+        self.mom.log_match('tracking processes with proc connector events',
+                           starttime=self.server.ctime, max_attempts=10)
+
+    def test_kill_job_children(self):
+        """
+        Check the background children of a deleted job are all killed
+        """
+        script = '#!/bin/sh\nsleep 1237 &\nsleep 1237 &\nwait\n'
+        j = Job(TEST_USER)
+        j.create_script(script)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        cmd = ['pgrep', '-f', 'sleep 1237']
+        self.assertEqual(len(self.du.run_cmd(self.mom.shortname,
+                                             cmd)['out']), 2)
+        self.server.delete(jid, wait=True)
+        self.assertNotEqual(self.du.run_cmd(self.mom.shortname, cmd)['rc'],
+                            0)
@@ -0,0 +1,85 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+from tests.functional import *
+
+
+class TestMomStageConcurrency(TestFunctional):
+    """
+    Test stage-in and stage-out with $stage_concurrency greater than 1
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.mom.add_config({'$stage_concurrency': '3'})
+        self.files = []
+
+    def tearDown(self):
+        for f in self.files:
+            self.du.rm(self.server.hostname, f, force=True, sudo=True)
+        TestFunctional.tearDown(self)
+
+    @skipOnShasta
+    def test_parallel_staging(self):
+        """
+        Stage five files in and back out and check every one is copied
+        """
+        srcs = []
+        for _ in range(5):
+            fn = self.du.create_temp_file(asuser=str(TEST_USER),
+                                          body='stage')
+            srcs.append(fn)
+            self.files += [fn, fn + '_out']
+        host = self.server.hostname
+        stagein = ','.join([os.path.basename(f) + '_in@' + host + ':' + f
+                            for f in srcs])
+        stageout = ','.join([os.path.basename(f) + '_in@' + host + ':' +
+                             f + '_out' for f in srcs])
+        a = {ATTR_stagein: stagein, ATTR_stageout: stageout,
+             ATTR_S: '/bin/bash'}
+        j = Job(TEST_USER, a)
+        j.set_sleep_time(2)
+        stime = int(time.time())
+        jid = self.server.submit(j)
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid, offset=2)
+        self.mom.log_match(jid + ';staged 5 items in', starttime=stime)
+        self.mom.log_match(jid + ';staged 5 items out', starttime=stime)
+        for f in srcs:
+            self.assertTrue(self.du.isfile(host, path=f + '_out',
+                                           sudo=True))
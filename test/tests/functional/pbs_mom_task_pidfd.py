@@ -0,0 +1,67 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+from tests.functional import *
+
+
+class TestMomTaskPidfd(TestFunctional):
+    """
+    Test that mom handles task exits through pidfds when $task_pidfd
+    is set
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.mom.add_config({'$task_pidfd': 'True'})
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+
+    def test_exit_status(self):
+        """
+        Check jobs finish with the exit status of their script
+        """
+        jids = []
+        for code in (0, 3, 7):
+            j = Job(TEST_USER)
+            j.create_script('#!/bin/sh\nsleep 2\nexit %d\n' % code)
+            jids.append((self.server.submit(j), code))
+        for jid, code in jids:
+            self.server.expect(JOB, {'job_state': 'F', 'Exit_status': code},
+                               id=jid, extend='x', offset=2, interval=2)
+            self.mom.log_match(jid + ';task 00000001 terminated')
@@ -0,0 +1,78 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestMomTopologyCache(TestFunctional):
+    """
+    Test that Mom caches the hwloc topology in mom_priv/topology.xml
+    and only discovers it again when the hardware fingerprint changes
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        mom_priv = os.path.join(self.mom.pbs_conf['PBS_HOME'], 'mom_priv')
+        self.topo = os.path.join(mom_priv, 'topology.xml')
+        self.fprint = self.topo + '.fingerprint'
+
+    def test_cached_topology(self):
+        """
+        After a restart Mom uses the cached topology; without the
+        fingerprint file she discovers it again and saves it
+        """
+        self.mom.restart()
+        self.assertTrue(self.du.isfile(hostname=self.mom.shortname,
+                                       path=self.topo, sudo=True))
+        self.assertTrue(self.du.isfile(hostname=self.mom.shortname,
+                                       path=self.fprint, sudo=True))
+
+        start = int(time.time())
+        self.mom.signal('-HUP')
+        self.mom.log_match("using cached topology", starttime=start)
+
+        self.du.rm(hostname=self.mom.shortname, path=self.fprint,
+                   force=True, sudo=True)
+        start = int(time.time())
+        self.mom.signal('-HUP')
+        self.mom.log_match("pcpus=", starttime=start)
+        self.mom.log_match("using cached topology", starttime=start,
+                           existence=False, max_attempts=5)
+        self.assertTrue(self.du.isfile(hostname=self.mom.shortname,
+                                       path=self.fprint, sudo=True))
+        self.server.expect(NODE, {'state': 'free'}, id=self.mom.shortname)
@@ -0,0 +1,100 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+
+from tests.functional import *
+
+
+class TestNameIndex(TestFunctional):
+    """
+    Test that jobs, queues, reservations and vnodes are still found by
+    name after others of their kind are created and deleted
+    """
+
+    def test_job_lookup(self):
+        """
+        Submit and delete many jobs, then check the remaining jobs are
+        found by id and the deleted ones are not
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = [self.server.submit(Job(TEST_USER)) for _ in range(100)]
+        for jid in jids[::2]:
+            self.server.delete(jid)
+        for jid in jids[1::2]:
+            self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
+        for jid in jids[:10:2]:
+            try:
+                self.server.status(JOB, id=jid)
+            except PbsStatusError as e:
+                self.assertIn('Unknown Job Id', e.msg[0])
+            else:
+                self.fail('deleted job %s still found' % jid)
+
+    def test_queue_resv_lookup(self):
+        """
+        Delete and recreate a queue and delete a reservation, then check
+        they are found (or not) by name
+        """
+        a = {'queue_type': 'execution', 'enabled': 'True',
+             'started': 'True'}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='wq1')
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='wq2')
+        self.server.manager(MGR_CMD_DELETE, QUEUE, id='wq1')
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='wq1')
+        j = Job(TEST_USER, attrs={ATTR_queue: 'wq1'})
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {ATTR_queue: 'wq1'}, id=jid)
+
+        r = Reservation(TEST_USER)
+        now = int(time.time())
+        r.set_attributes({'reserve_start': now + 3600,
+                          'reserve_end': now + 7200})
+        rid = self.server.submit(r)
+        self.server.expect(RESV,
+                           {'reserve_state': (MATCH_RE, 'RESV_CONFIRMED|2')},
+                           id=rid)
+        self.server.delete(rid)
+        for _ in range(10):
+            try:
+                self.server.status(RESV, id=rid)
+            except PbsStatusError:
+                break
+            time.sleep(1)
+        else:
+            self.fail('deleted reservation %s still found' % rid)
@@ -0,0 +1,122 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestNodePartitionReuse(TestFunctional):
+    """
+    Test that placement sets kept between scheduling cycles follow changes
+    to the node grouping resource values of the vnodes
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'type': 'string', 'flag': 'h'}
+        self.server.manager(MGR_CMD_CREATE, RSC, a, id='switch')
+        a = {'resources_available.ncpus': 1}
+        self.server.create_vnodes('vnode', a, 4, self.mom,
+                                  sharednode=False)
+        for i, sw in enumerate(['s1', 's1', 's2', 's2']):
+            self.server.manager(MGR_CMD_SET, NODE,
+                                {'resources_available.switch': sw},
+                                id='vnode[%d]' % i)
+        a = {'node_group_key': 'switch', 'node_group_enable': 'True'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        self.server.manager(MGR_CMD_SET, SCHED, {'do_not_span_psets': 'True'},
+                            runas=ROOT_USER)
+
+    def test_pset_follows_key_change(self):
+        """
+        Test that a job which only fits in a placement set created by a
+        change to a vnode's switch runs in the cycle after the change
+        """
+        a = {'Resource_List.select': '3:ncpus=1'}
+        j = Job(TEST_USER, a)
+        jid = self.server.submit(j)
+        c = "Can Never Run: can't fit in the largest placement set, " \
+            "and can't span psets"
+        self.server.expect(JOB, {'comment': c}, id=jid)
+
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.switch': 's1'},
+                            id='vnode[2]')
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R', 'pset': 'switch=s1'},
+                           id=jid)
+
+    def test_pset_unchanged_between_cycles(self):
+        """
+        Test that placement sets reused between cycles still know which
+        of their vnodes are free
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'scheduling': 'False'})
+        a = {'Resource_List.select': '2:ncpus=1'}
+        jids = []
+        for _ in range(3):
+            j = Job(TEST_USER, a)
+            jids.append(self.server.submit(j))
+
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jids[0])
+        self.server.expect(JOB, {'job_state': 'R'}, id=jids[1])
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jids[2])
+
+        self.server.delete(jids[0], wait=True)
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jids[2])
+
+    def test_deleted_queue_layout_freed(self):
+        """
+        Test that the placement sets kept for a queue are freed in the
+        first cycle after the queue is deleted
+        """
+        self.server.manager(MGR_CMD_SET, SCHED, {'log_events': 2047},
+                            runas=ROOT_USER)
+        a = {'queue_type': 'execution', 'enabled': 'True',
+             'started': 'True', 'node_group_key': 'switch'}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='psetq')
+        self.scheduler.run_scheduling_cycle()
+        self.scheduler.log_match('psetq;Creating node partitions for switch')
+
+        t = time.time()
+        self.server.manager(MGR_CMD_DELETE, QUEUE, id='psetq')
+        self.scheduler.run_scheduling_cycle()
+        self.scheduler.log_match(
+            'psetq;Freeing unused node partitions for switch', starttime=t)
@@ -0,0 +1,93 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestNodeRassn(TestFunctional):
+    """
+    Test that resources_assigned on vnodes, server and queue follow jobs
+    across start, suspend, resume and end
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 2,
+             'resources_available.mem': '2gb'}
+        self.server.create_vnodes('vn', a, num=3, mom=self.mom,
+                                  usenatvnode=True)
+
+    def check_assigned(self, ncpus, mem, vnodes):
+        """
+        Check resources_assigned on the given vnodes, the server and workq
+        """
+        for vn in vnodes:
+            self.server.expect(NODE, {'resources_assigned.ncpus': ncpus},
+                               id=vn)
+        total = ncpus * len(vnodes)
+        a = {'resources_assigned.ncpus': total}
+        self.server.expect(SERVER, a)
+        self.server.expect(QUEUE, a, id='workq')
+        if mem is not None:
+            self.server.expect(NODE, {'resources_assigned.mem': mem},
+                               id=vnodes[0])
+
+    def test_multi_chunk_start_suspend_end(self):
+        """
+        Run a job over several vnodes, suspend and resume it, and check
+        resources_assigned is restored to zero once it ends
+        """
+        vnodes = ['vn[0]', 'vn[1]', 'vn[2]']
+        a = {'Resource_List.select': '3:ncpus=2:mem=1gb',
+             'Resource_List.place': 'vscatter'}
+        j = Job(TEST_USER, attrs=a)
+        j.set_sleep_time(20)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.check_assigned(2, '1048576kb', vnodes)
+
+        self.server.sigjob(jid, 'suspend')
+        self.server.expect(JOB, {'job_state': 'S'}, id=jid)
+        self.check_assigned(0, None, vnodes)
+
+        self.server.sigjob(jid, 'resume')
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.check_assigned(2, '1048576kb', vnodes)
+
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid, offset=20)
+        self.check_assigned(0, '0kb', vnodes)
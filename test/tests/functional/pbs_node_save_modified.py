@@ -0,0 +1,90 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestNodeSaveModified(TestFunctional):
+    """
+    Test that the server writes the nodes it changed to the database, and
+    only those, when node state, comments and attributes change
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 1}
+        self.server.create_vnodes('vn', a, 20, self.mom, usenatvnode=False)
+
+    def test_modified_nodes_persist(self):
+        """
+        Offline one vnode, comment another and set a resource on a third,
+        restart the server and check only they kept the change
+        """
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                            id='vn[3]')
+        self.server.manager(MGR_CMD_SET, NODE, {'comment': 'saved'},
+                            id='vn[7]')
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 4}, id='vn[11]')
+        self.server.manager(MGR_CMD_UNSET, NODE, 'comment', id='vn[7]')
+        self.server.manager(MGR_CMD_SET, NODE, {'comment': 'saved again'},
+                            id='vn[7]')
+
+        self.server.restart()
+
+        self.server.expect(NODE, {'state': (MATCH_RE, 'offline')},
+                           id='vn[3]')
+        self.server.expect(NODE, {'comment': 'saved again'}, id='vn[7]')
+        self.server.expect(NODE, {'resources_available.ncpus': 4},
+                           id='vn[11]')
+        self.server.expect(NODE, {'state': 'free',
+                                  'resources_available.ncpus': 1},
+                           id='vn[5]', attrop=PTL_AND)
+
+    def test_offline_cleared_persists(self):
+        """
+        Clearing offline on a vnode after it was saved is written too
+        """
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                            id='vn[2]')
+        self.server.restart()
+        self.server.expect(NODE, {'state': (MATCH_RE, 'offline')},
+                           id='vn[2]')
+        self.server.manager(MGR_CMD_SET, NODE, {'state': (DECR, 'offline')},
+                            id='vn[2]')
+        self.server.restart()
+        self.server.expect(NODE, {'state': 'free'}, id='vn[2]')
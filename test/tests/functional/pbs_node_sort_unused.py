@@ -0,0 +1,76 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+from tests.functional import *
+
+
+class TestNodeSortUnused(TestFunctional):
+    """
+    Test that nodes sorted on unused resources are kept in order as jobs
+    are run within a cycle
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 5}
+        self.server.create_vnodes('vnode', a, 2, self.mom,
+                                  sharednode=False)
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 4}, id='vnode[1]')
+        a = {'node_sort_key': '"ncpus HIGH unused"'}
+        self.scheduler.set_sched_config(a)
+
+    def test_resort_after_run(self):
+        """
+        Test that each job runs on the vnode with the most unused ncpus
+        after the jobs before it ran
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        a = {'Resource_List.select': '1:ncpus=2'}
+        jids = []
+        for _ in range(3):
+            j = Job(TEST_USER, a)
+            jids.append(self.server.submit(j))
+
+        self.scheduler.run_scheduling_cycle()
+        vnodes = ['vnode[0]', 'vnode[1]', 'vnode[0]']
+        for jid, vn in zip(jids, vnodes):
+            self.server.expect(JOB, {'job_state': 'R',
+                                     'exec_vnode': '(%s:ncpus=2)' % vn},
+                               id=jid)
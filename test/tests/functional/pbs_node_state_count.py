@@ -0,0 +1,116 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestNodeStateCount(TestFunctional):
+    """
+    Tests for the server's node_state_count attribute
+    """
+
+    def node_state_counts(self):
+        """
+        Parse the server's node_state_count attribute into a dictionary
+        of state name to number of vnodes
+        """
+        svr = self.server.status(SERVER, ATTR_nodestate_count)
+        counts = {}
+        for s in svr[0][ATTR_nodestate_count].split():
+            state, num = s.split(':')
+            self.assertGreaterEqual(int(num), 0,
+                                    'node state count has negative values')
+            counts[state] = int(num)
+        return counts
+
+    def expected_counts(self):
+        """
+        Count the vnodes in each state from the vnodes' own state
+        attributes
+        """
+        counts = {}
+        for n in self.server.status(NODE, 'state'):
+            for state in n['state'].split(','):
+                counts[state] = counts.get(state, 0) + 1
+        return counts
+
+    def verify_counts(self):
+        """
+        Verify node_state_count agrees with the states of the vnodes
+        """
+        counts = self.node_state_counts()
+        expected = self.expected_counts()
+        for state, num in counts.items():
+            self.assertEqual(num, expected.get(state, 0),
+                             'count of %s vnodes incorrect' % state)
+
+    def test_node_state_count(self):
+        """
+        Verify node_state_count follows vnode state changes, vnode
+        creation and deletion, and a server restart
+        """
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        self.server.expect(NODE, {'state': 'free'}, id=self.mom.shortname)
+        self.verify_counts()
+
+        j = Job(TEST_USER)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.server.expect(NODE, {'state': 'job-busy'},
+                           id=self.mom.shortname)
+        self.verify_counts()
+        self.assertGreaterEqual(self.node_state_counts()['job-busy'], 1)
+
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                            self.mom.shortname)
+        self.verify_counts()
+        self.assertGreaterEqual(self.node_state_counts()['offline'], 1)
+
+        self.server.manager(MGR_CMD_UNSET, NODE, 'state', self.mom.shortname)
+        self.server.delete(jid, wait=True)
+        self.server.expect(NODE, {'state': 'free'}, id=self.mom.shortname)
+        self.verify_counts()
+
+        self.server.manager(MGR_CMD_CREATE, NODE, id='fakenode')
+        self.verify_counts()
+        self.server.manager(MGR_CMD_DELETE, NODE, id='fakenode')
+        self.verify_counts()
+
+        self.server.restart()
+        self.server.expect(NODE, {'state': 'free'}, id=self.mom.shortname)
+        self.verify_counts()
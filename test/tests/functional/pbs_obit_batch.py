@@ -0,0 +1,70 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestObitBatch(TestFunctional):
+    """
+    Test that jobs ending together are all finished when Mom sends
+    their obits to the server in one message
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        self.server.manager(MGR_CMD_SET, NODE, {'resources_available.ncpus':
+                                                20}, id=self.mom.shortname)
+
+    def test_array_ends_together(self):
+        """
+        Run the subjobs of an array together so they end at the same
+        time, and check each is finished and has an end record
+        """
+        j = Job(TEST_USER, attrs={ATTR_J: '1-20'})
+        j.set_sleep_time(5)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F'}, id=jid, extend='x',
+                           offset=5)
+        for i in range(1, 21):
+            sjid = j.create_subjob_id(jid, i)
+            self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 0},
+                               id=sjid, extend='x')
+            self.server.accounting_match(msg=';E;' + re.escape(sjid),
+                                         regexp=True, n='ALL')
@@ -0,0 +1,125 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestPartitionSubCycles(TestFunctional):
+    """
+    Test scheduling independent partitions in parallel sub-cycles
+    (partition_sub_cycles)
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'partition': 'P1,P2',
+             'sched_host': self.server.hostname,
+             'sched_port': '15050'}
+        self.server.manager(MGR_CMD_CREATE, SCHED, a, id='sc1')
+        self.scheds['sc1'].create_scheduler()
+        self.scheds['sc1'].start()
+        self.server.manager(MGR_CMD_SET, SCHED, {'log_events': 2047},
+                            id='sc1')
+        self.scheds['sc1'].set_sched_config({'partition_sub_cycles': 2})
+
+        a = {'resources_available.ncpus': 2}
+        self.server.create_vnodes('vnode', a, 2, self.mom)
+        a = {'queue_type': 'execution', 'started': 'True',
+             'enabled': 'True'}
+        for i in (1, 2):
+            p = {'partition': 'P%d' % i}
+            self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='wq%d' % i)
+            self.server.manager(MGR_CMD_SET, QUEUE, p, id='wq%d' % i)
+            self.server.manager(MGR_CMD_SET, NODE, p,
+                                id='vnode[%d]' % (i - 1))
+
+    def submit_jobs(self):
+        """
+        Submit two jobs to each partition's queue while sc1 is not
+        scheduling, then have sc1 run them in one cycle
+        """
+        self.server.manager(MGR_CMD_SET, SCHED, {'scheduling': 'False'},
+                            id='sc1')
+        jids = {}
+        for q in ('wq1', 'wq2'):
+            jids[q] = []
+            for _ in range(2):
+                j = Job(TEST_USER, attrs={ATTR_queue: q,
+                                          'Resource_List.select':
+                                          '1:ncpus=1'})
+                jids[q].append(self.server.submit(j))
+        self.server.manager(MGR_CMD_SET, SCHED, {'scheduling': 'True'},
+                            id='sc1')
+        for q, vnode in (('wq1', 'vnode[0]'), ('wq2', 'vnode[1]')):
+            for jid in jids[q]:
+                self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+                self.server.expect(JOB, 'exec_vnode', id=jid,
+                                   op=SET)
+                st = self.server.status(JOB, 'exec_vnode', id=jid)
+                self.assertIn(vnode, st[0]['exec_vnode'])
+        return jids
+
+    def test_partitions_in_sub_cycles(self):
+        """
+        Test that the jobs of both partitions are run by sub-cycles, and
+        only on the vnodes of their partition
+        """
+        t = time.time()
+        self.submit_jobs()
+        self.scheds['sc1'].log_match(
+            'Scheduling 2 partitions in sub-cycles', starttime=t)
+        for p in ('P1', 'P2'):
+            self.scheds['sc1'].log_match(
+                'Sub-cycle of partition %s: 2 run requests' % p,
+                starttime=t)
+
+    def test_server_limit_serial(self):
+        """
+        Test that with a server limit set the partitions are scheduled
+        one after the other, and the jobs still run
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'max_run': '[u:PBS_GENERIC=10]'})
+        t = time.time()
+        self.submit_jobs()
+        self.scheds['sc1'].log_match(
+            'Not scheduling partitions in sub-cycles: '
+            'server limits are set', starttime=t)
+        self.scheds['sc1'].log_match(
+            'Scheduling 2 partitions in sub-cycles', starttime=t,
+            existence=False, max_attempts=2)
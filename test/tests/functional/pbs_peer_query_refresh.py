@@ -0,0 +1,105 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestPeerQueryRefresh(TestFunctional):
+    """
+    Tests for peer queues whose jobs are refreshed between cycles
+    (peer_query_refresh)
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        if len(self.servers) != 2:
+            self.skipTest("test requires two servers as input, " +
+                          "use -p servers=<server1:server2>,moms=<server1>")
+        self.peer = self.servers.keys()[1]
+        attr = {'queue_type': 'execution',
+                'started': 'True', 'enabled': 'True'}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, attr, id='p2p')
+        self.servers[self.peer].manager(MGR_CMD_CREATE, QUEUE,
+                                        attr, id='p2p')
+
+    def submit_peer_job(self):
+        """
+        Submit a job to the peer's p2p queue
+        """
+        attr = {ATTR_queue: 'p2p',
+                'Resource_List.select': 'host=%s' % self.moms.keys()[0]}
+        j = Job(TEST_USER, attrs=attr)
+        j.set_sleep_time(300)
+        return self.servers[self.peer].submit(j)
+
+    def test_peer_job_from_cache(self):
+        """
+        Test that a peer job read from the cache is moved and run
+        """
+        attr = {'peer_queue': '\"p2p p2p@' + self.peer + '\"',
+                'peer_query_refresh': 2}
+        self.scheduler.set_sched_config(attr)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'scheduler_iteration': 5})
+
+        jid = self.submit_peer_job()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.servers[self.peer].expect(JOB, {'job_state': 'M'},
+                                       id=jid, extend='x')
+        self.scheduler.log_match('Using peer queue job status from')
+
+    def test_stale_peer_jobs_ignored(self):
+        """
+        Test that the jobs of a peer which can not be reached are left
+        out once their status is older than peer_query_stale
+        """
+        self.server.manager(MGR_CMD_SET, QUEUE, {'started': 'False'},
+                            id='p2p')
+        attr = {'peer_queue': '\"p2p p2p@' + self.peer + '\"',
+                'peer_query_refresh': 2, 'peer_query_stale': 5}
+        self.scheduler.set_sched_config(attr)
+
+        self.submit_peer_job()
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.scheduler.log_match('Using peer queue job status from')
+
+        self.servers[self.peer].stop()
+        time.sleep(6)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.scheduler.log_match('ignoring its jobs')
+        self.servers[self.peer].start()
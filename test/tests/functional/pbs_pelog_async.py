@@ -0,0 +1,78 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestPelogAsync(TestFunctional):
+    """
+    Test that mom keeps serving jobs while a long epilogue runs
+    """
+
+    def tearDown(self):
+        self.mom.delete_pelog()
+        TestFunctional.tearDown(self)
+
+    def test_long_epilogue(self):
+        """
+        Give one job an epilogue that takes 30 seconds and check a job
+        submitted meanwhile starts and ends before it
+        """
+        body = '#!/bin/sh\n[ "$2" = "%s" ] && sleep 30\nexit 0\n' % \
+            str(TEST_USER)
+        self.assertTrue(self.mom.epilogue(body=body))
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 2},
+                            id=self.mom.shortname)
+
+        j1 = Job(TEST_USER)
+        j1.set_sleep_time(1)
+        jid1 = self.server.submit(j1)
+        self.mom.log_match('%s;running epilogue' % jid1)
+
+        j2 = Job(TEST_USER1)
+        j2.set_sleep_time(1)
+        jid2 = self.server.submit(j2)
+        self.server.expect(JOB, {'job_state': 'F'}, extend='x', id=jid2,
+                           max_attempts=20)
+        # the obit of the first job waits for its epilogue
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        self.server.expect(JOB, {'job_state': 'F'}, extend='x', id=jid1,
+                           offset=15)
@@ -0,0 +1,72 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestPeriodicHookWatchdog(TestFunctional):
+    """
+    Test mom enforces the alarm of each exechost_periodic hook on its own
+    """
+
+    def test_stuck_hook_killed(self):
+        """
+        Check a periodic hook that cannot be interrupted by its alarm is
+        killed by mom, while another periodic hook keeps running
+        """
+        stuck_body = """
+import pbs
+import signal
+import time
+signal.signal(signal.SIGALRM, signal.SIG_IGN)
+time.sleep(300)
+"""
+        quick_body = """
+import pbs
+pbs.logmsg(pbs.LOG_DEBUG, 'quick periodic hook ran')
+pbs.event().accept()
+"""
+        a = {'event': 'exechost_periodic', 'enabled': 'True', 'freq': 5,
+             'alarm': 3}
+        self.server.create_import_hook('stuck_hk', a, stuck_body)
+        self.server.create_import_hook('quick_hk', a, quick_body)
+        self.mom.log_match("stuck_hk;periodic hook still running 5 seconds "
+                           "past its alarm of 3 seconds, killing it",
+                           max_attempts=30, interval=2)
+        self.mom.log_match("quick periodic hook ran", max_attempts=10,
+                           interval=2)
@@ -364,6 +364,37 @@ exit 1
         self.server.expect(JOB, {ATTR_state: 'R'}, id=jid2)
         self.server.expect(JOB, {ATTR_state: 'R'}, id=jid3)
 
+    def test_preempt_sort_multiple_high_jobs(self):
+        """
+        Test that high priority jobs considered in the same cycle each
+        preempt the next job in preempt_sort order
+        """
+        a = {ATTR_rescavail + '.ncpus': 3}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+
+        a = {'preempt_sort': 'min_time_since_start'}
+        self.server.manager(MGR_CMD_SET, SCHED, a)
+        jids = []
+        for _ in range(3):
+            j = Job(TEST_USER)
+            jid = self.server.submit(j)
+            self.server.expect(JOB, {ATTR_state: 'R'}, id=jid)
+            jids.append(jid)
+            time.sleep(1)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        hjids = []
+        for _ in range(2):
+            j = Job(TEST_USER, {ATTR_q: 'expressq'})
+            hjids.append(self.server.submit(j))
+        self.scheduler.run_scheduling_cycle()
+
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=jids[0])
+        self.server.expect(JOB, {ATTR_state: 'S'}, id=jids[1])
+        self.server.expect(JOB, {ATTR_state: 'S'}, id=jids[2])
+        for hjid in hjids:
+            self.server.expect(JOB, {ATTR_state: 'R'}, id=hjid)
+
     def test_preempt_retry(self):
         """
         Test that jobs can be successfully preempted after a previously failed
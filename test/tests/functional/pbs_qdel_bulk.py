@@ -0,0 +1,87 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestQdelBulk(TestFunctional):
+    """
+    Test that qdel deletes many jobs with one Delete Jobs request
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'scheduling': 'False', 'log_events': 2047})
+        self.qdel = os.path.join(self.server.pbs_conf['PBS_EXEC'],
+                                 'bin', 'qdel')
+
+    def submit_jobs(self, count):
+        jids = []
+        for _ in range(count):
+            j = Job(TEST_USER)
+            jids.append(self.server.submit(j))
+        return jids
+
+    def test_qdel_many_jobs(self):
+        """
+        Delete 20 queued jobs with one qdel and check they went in a
+        single request
+        """
+        jids = self.submit_jobs(20)
+        ret = self.du.run_cmd(self.server.hostname, [self.qdel] + jids,
+                              runas=TEST_USER)
+        self.assertEqual(ret['rc'], 0)
+        self.server.log_match('delete jobs request received for 20 jobs')
+        for jid in jids:
+            self.server.expect(JOB, 'queue', op=UNSET, id=jid)
+
+    def test_qdel_unknown_job_in_list(self):
+        """
+        An unknown job id among the ones given to qdel is reported as
+        before and does not stop the others from being deleted
+        """
+        jids = self.submit_jobs(4)
+        bad = '999999.' + self.server.hostname
+        ret = self.du.run_cmd(self.server.hostname,
+                              [self.qdel] + jids[:2] + [bad] + jids[2:],
+                              runas=TEST_USER)
+        self.assertNotEqual(ret['rc'], 0)
+        self.assertIn('Unknown Job Id', '\n'.join(ret['err']))
+        for jid in jids:
+            self.server.expect(JOB, 'queue', op=UNSET, id=jid)
@@ -199,3 +199,77 @@ class TestQmgr(TestFunctional):
         is double-quoted correctly
         """
         self.set_and_test_comment("This node isn't good.")
+
+    def test_resource_lookup_after_define_delete(self):
+        """
+        Test that resources defined and deleted through qmgr, and
+        attributes and resources named in a different case, are still
+        found after the definition list changes
+        """
+        names = ['rlookup%d' % i for i in range(20)]
+        for name in names:
+            self.server.manager(MGR_CMD_CREATE, RSC,
+                                {'type': 'long', 'flag': 'q'}, id=name)
+        # delete the first and a middle definition
+        self.server.manager(MGR_CMD_DELETE, RSC, id=names[0])
+        self.server.manager(MGR_CMD_DELETE, RSC, id=names[10])
+        self.server.manager(MGR_CMD_CREATE, RSC,
+                            {'type': 'long', 'flag': 'q'}, id=names[10])
+
+        a = {'resources_available.' + names[15].upper(): 4,
+             'resources_available.' + names[10]: 3}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        self.server.expect(SERVER, {'resources_available.' + names[15]: 4,
+                                    'resources_available.' + names[10]: 3})
+
+        a = {'Resource_List.' + names[15].upper(): 2}
+        j = Job(TEST_USER, a)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'Resource_List.' + names[15]: 2,
+                                 'job_state': 'R'}, id=jid)
+
+        with self.assertRaises(PbsSubmitError):
+            j = Job(TEST_USER, {'Resource_List.' + names[0]: 1})
+            self.server.submit(j)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'Scheduler_Iteration': 55})
+        self.server.expect(SERVER, {'scheduler_iteration': 55})
+
+    def test_unset_many_node_resources(self):
+        """
+        Test that a node with many custom resources reports the right
+        values after some of them are unset and set again
+        """
+        names = ['rmany%02d' % i for i in range(40)]
+        for name in names:
+            self.server.manager(MGR_CMD_CREATE, RSC,
+                                {'type': 'long', 'flag': 'nh'}, id=name)
+        a = {}
+        for i, name in enumerate(names):
+            a['resources_available.' + name] = i
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.mom.shortname)
+
+        for name in names[::3]:
+            self.server.manager(MGR_CMD_UNSET, NODE,
+                                'resources_available.' + name,
+                                id=self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.' + names[3]: 100},
+                            id=self.mom.shortname)
+
+        a = {'Resource_List.' + names[1]: 1, 'Resource_List.' + names[3]: 50}
+        j = Job(TEST_USER, a)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+        rv = self.server.status(NODE, id=self.mom.shortname)
+        for i, name in enumerate(names):
+            key = 'resources_available.' + name
+            if i == 3:
+                self.assertEqual(rv[0][key], '100')
+            elif i % 3 == 0:
+                self.assertNotIn(key, rv[0])
+            else:
+                self.assertEqual(rv[0][key], str(i))
+        self.assertEqual(rv[0]['resources_assigned.' + names[1]], '1')
+        self.assertEqual(rv[0]['resources_assigned.' + names[3]], '50')
@@ -0,0 +1,111 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestQmgrBatch(TestFunctional):
+    """
+    Test the bulk directives sent by qmgr -b
+    """
+
+    def qmgr_b(self, directives):
+        """
+        Feed directives to qmgr -b on standard input and return the
+        run_cmd result
+        """
+        fn = self.du.create_temp_file(body='\n'.join(directives) + '\n')
+        qmgr = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin', 'qmgr')
+        cmd = [qmgr, '-b', '<', fn]
+        ret = self.du.run_cmd(self.server.hostname, cmd=cmd, sudo=True,
+                              as_script=True, logerr=False)
+        os.remove(fn)
+        return ret
+
+    def test_bulk_queues(self):
+        """
+        Create and configure a set of queues in bulk and check each one
+        """
+        d = []
+        for i in range(50):
+            d.append('create queue bq%d queue_type=execution' % i)
+            d.append('set queue bq%d enabled=True' % i)
+            d.append('set queue bq%d max_running=%d' % (i, i + 1))
+        ret = self.qmgr_b(d)
+        self.assertEqual(ret['rc'], 0, 'qmgr -b failed')
+        for i in range(50):
+            a = {'queue_type': 'Execution', 'enabled': 'True',
+                 'max_running': i + 1}
+            self.server.expect(QUEUE, a, id='bq%d' % i, max_attempts=1)
+        d = ['delete queue bq%d' % i for i in range(50)]
+        ret = self.qmgr_b(d)
+        self.assertEqual(ret['rc'], 0, 'qmgr -b delete failed')
+        with self.assertRaises(PbsStatusError):
+            self.server.status(QUEUE, id='bq0', logerr=False)
+
+    def test_bulk_errors(self):
+        """
+        Check a failed directive in a batch is reported against its own
+        object and does not stop the other directives
+        """
+        d = ['create resource bres%d type=long' % i for i in range(5)]
+        d.append('create resource bres0 type=long')
+        d.append('create resource bres9 type=long')
+        ret = self.qmgr_b(d)
+        self.assertNotEqual(ret['rc'], 0)
+        err = '\n'.join(ret['err'])
+        self.assertIn('qmgr obj=bres0', err)
+        self.assertNotIn('obj=bres1', err)
+        for r in ['bres0', 'bres1', 'bres4', 'bres9']:
+            self.server.expect(RSC, {'type': 'long'}, id=r, max_attempts=1)
+
+    def test_mixed_directives(self):
+        """
+        Check directives that cannot be batched are run in order with the
+        batched ones
+        """
+        d = ['create queue mq queue_type=execution',
+             'set server default_queue=mq',
+             'set queue mq enabled=True',
+             'set queue mq started=True']
+        ret = self.qmgr_b(d)
+        self.assertEqual(ret['rc'], 0, 'qmgr -b failed')
+        self.server.expect(SERVER, {'default_queue': 'mq'})
+        self.server.expect(QUEUE, {'enabled': 'True', 'started': 'True'},
+                           id='mq')
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'default_queue': 'workq'})
@@ -105,3 +105,29 @@ class TestQselect(TestFunctional):
         self.assertNotEqual(ret, None)
         self.assertIn('err', ret)
         self.assertIn('qselect: illegal -t value', ret['err'])
+
+    def test_qselect_state_owner_index(self):
+        """
+        Check that selecting on one state or one owner returns every
+        matching job, in queue order, as the jobs change state
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        a = {'Resource_List.select': '1:ncpus=1'}
+        jids = [self.server.submit(Job(TEST_USER, a)) for _ in range(3)]
+        jid4 = self.server.submit(Job(TEST_USER1, a))
+        self.server.holdjob(jids[1])
+        self.server.expect(JOB, {'job_state': 'H'}, id=jids[1])
+
+        self.assertEqual(self.server.select({'job_state': 'Q'}),
+                         [jids[0], jids[2], jid4])
+        self.assertEqual(self.server.select({'job_state': 'H'}), [jids[1]])
+        self.assertEqual(self.server.select({ATTR_u: str(TEST_USER)}), jids)
+        self.assertEqual(self.server.select({ATTR_u: str(TEST_USER1),
+                                             'job_state': 'Q'}), [jid4])
+
+        self.server.rlsjob(jids[1], USER_HOLD)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jids[1])
+        self.assertEqual(self.server.select({'job_state': 'Q'}),
+                         jids + [jid4])
+        self.server.delete(jid4, wait=True)
+        self.assertEqual(self.server.select({ATTR_u: str(TEST_USER1)}), [])
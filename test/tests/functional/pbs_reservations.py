@@ -85,6 +85,55 @@ class TestReservations(TestFunctional):
 
         return self.server.submit(r)
 
+    def test_degrade_only_affected_reservations(self):
+        """
+        Verify that offlining a vnode degrades only the reservations that
+        use it, both before and after a server restart
+        """
+        a = {'resources_available.ncpus': 1}
+        self.server.create_vnodes('vn', a, num=3, mom=self.mom)
+
+        now = int(time.time())
+        rid1 = self.submit_standing_reservation(user=TEST_USER,
+                                                select='1:ncpus=1',
+                                                rrule='FREQ=HOURLY;COUNT=3',
+                                                start=now + 3600,
+                                                end=now + 3900)
+        rid2 = self.submit_standing_reservation(user=TEST_USER,
+                                                select='1:ncpus=1',
+                                                rrule='FREQ=HOURLY;COUNT=3',
+                                                start=now + 3600,
+                                                end=now + 3900)
+        a = {'Resource_List.select': '1:ncpus=1',
+             'reserve_start': now + 3600, 'reserve_end': now + 3900}
+        rid3 = self.server.submit(Reservation(TEST_USER, a))
+
+        confirmed = {'reserve_state': (MATCH_RE, 'RESV_CONFIRMED|2'),
+                     'reserve_substate': 2}
+        vnodes = {}
+        for rid in [rid1, rid2, rid3]:
+            self.server.expect(RESV, confirmed, attrop=PTL_AND, id=rid)
+            self.server.status(RESV, 'resv_nodes', id=rid)
+            vnodes[rid] = self.server.reservations[rid].get_vnodes()[0]
+
+        degraded = {'reserve_substate': 10}
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                            id=vnodes[rid1])
+        self.server.expect(RESV, degraded, id=rid1)
+        self.server.expect(RESV, confirmed, attrop=PTL_AND, id=rid2)
+        self.server.expect(RESV, confirmed, attrop=PTL_AND, id=rid3)
+
+        # the vnode to reservation index is rebuilt on recovery
+        self.server.restart()
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                            id=vnodes[rid2])
+        self.server.expect(RESV, degraded, id=rid2)
+        self.server.expect(RESV, confirmed, attrop=PTL_AND, id=rid3)
+
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                            id=vnodes[rid3])
+        self.server.expect(RESV, degraded, id=rid3)
+
     def test_degraded_standing_reservations(self):
         """
         Verify that degraded standing reservations are reconfirmed on
@@ -0,0 +1,98 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestResvConfirmBatch(TestFunctional):
+
+    """
+    Test that reservations submitted together are confirmed in a
+    shared simulation of the universe
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SCHED, {'log_events': 2047})
+        a = {'resources_available.ncpus': 2}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+
+    def submit_resv(self, start, end, ncpus):
+        """
+        Submit an advance reservation and return its id
+        """
+        a = {'Resource_List.select': '1:ncpus=%d' % ncpus,
+             'reserve_start': start,
+             'reserve_end': end}
+        r = Reservation(TEST_USER, attrs=a)
+        return self.server.submit(r)
+
+    def test_confirm_in_one_simulation(self):
+        """
+        Submit three reservations while scheduling is off.  The first
+        two fit and must be confirmed by one simulation, the third
+        overlaps both and must be denied.
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        now = int(time.time())
+        rid1 = self.submit_resv(now + 3600, now + 7200, 1)
+        rid2 = self.submit_resv(now + 5400, now + 9000, 1)
+        rid3 = self.submit_resv(now + 6000, now + 6600, 1)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+
+        a = {'reserve_state': (MATCH_RE, 'RESV_CONFIRMED|2')}
+        self.server.expect(RESV, a, id=rid1)
+        self.server.expect(RESV, a, id=rid2)
+        self.server.log_match(rid3 + ";Reservation denied")
+        self.scheduler.log_match("Confirmed 2 reservations in 1 simulations")
+
+    def test_back_to_back(self):
+        """
+        A reservation that needs the whole node starting when an earlier
+        one ends must be confirmed in the same simulation as the first.
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        now = int(time.time())
+        rid1 = self.submit_resv(now + 3600, now + 7200, 1)
+        rid2 = self.submit_resv(now + 7200, now + 9000, 2)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+
+        a = {'reserve_state': (MATCH_RE, 'RESV_CONFIRMED|2')}
+        self.server.expect(RESV, a, id=rid1)
+        self.server.expect(RESV, a, id=rid2)
+        self.scheduler.log_match("Confirmed 2 reservations in 1 simulations")
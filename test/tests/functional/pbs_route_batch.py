@@ -0,0 +1,93 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestRouteBatch(TestFunctional):
+    """
+    Test that the jobs of a routing queue are routed in batches, passing
+    over a destination that cannot take any of them
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        a = {'queue_type': 'execution', 'started': 't', 'enabled': 'f'}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='closedq')
+        a = {'queue_type': 'execution', 'started': 't', 'enabled': 't'}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='openq')
+        a = {'queue_type': 'route', 'started': 'f', 'enabled': 't',
+             'route_destinations': 'closedq,openq'}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='routeq')
+
+    def submit_jobs(self, count):
+        """
+        Submit count jobs to the stopped routing queue, then start it
+        """
+        for _ in range(count):
+            j = Job(TEST_USER, attrs={ATTR_queue: 'routeq'})
+            self.server.submit(j)
+        self.server.manager(MGR_CMD_SET, QUEUE, {'started': 't'},
+                            id='routeq')
+
+    def test_route_past_closed_queue(self):
+        """
+        Check every job of a batch goes to the open destination when the
+        first destination is disabled
+        """
+        self.submit_jobs(200)
+        self.server.expect(JOB, {'queue=openq': 200}, count=True)
+        self.server.expect(JOB, {'queue=routeq': 0}, count=True)
+
+    def test_route_to_full_queue(self):
+        """
+        Check that once a destination is full the remaining jobs stay in
+        the routing queue, and are routed when it has room again
+        """
+        a = {'route_retry_time': 1}
+        self.server.manager(MGR_CMD_SET, QUEUE, a, id='routeq')
+        self.server.manager(MGR_CMD_SET, QUEUE, {'max_queuable': 20},
+                            id='openq')
+        self.submit_jobs(50)
+        self.server.expect(JOB, {'queue=openq': 20}, count=True)
+        self.server.expect(JOB, {'queue=routeq': 30}, count=True)
+
+        self.server.manager(MGR_CMD_UNSET, QUEUE, 'max_queuable',
+                            id='openq')
+        self.server.expect(JOB, {'queue=openq': 50}, count=True)
@@ -0,0 +1,85 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+import json
+
+from tests.functional import *
+
+
+class TestSchedCycleStats(TestFunctional):
+    """
+    Test the scheduling cycle phase timings reported by cycle_stats_interval
+    """
+
+    def test_cycle_stats_attribute(self):
+        """
+        Test that the phase timings are set on the sched object and
+        written to cycle_stats_file
+        """
+        self.scheduler.set_sched_config({'cycle_stats_interval': '1',
+                                         'cycle_stats_file':
+                                         'cycle_stats.json'})
+        j = Job(TEST_USER)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.scheduler.run_scheduling_cycle()
+
+        self.server.expect(SCHED, {ATTR_sched_cycle_stats: (MATCH_RE,
+                                   r'cycle=\d+:[\d.]+:[\d.]+')},
+                           id='default')
+        st = self.server.status(SCHED, ATTR_sched_cycle_stats,
+                                id='default')
+        stats = st[0][ATTR_sched_cycle_stats]
+        for phase in ['query', 'sort', 'main_loop', 'run_job', 'end_cycle']:
+            self.assertIn(phase + '=', stats)
+
+        fn = os.path.join(self.server.pbs_conf['PBS_HOME'], 'sched_priv',
+                          'cycle_stats.json')
+        ret = self.du.cat(self.scheduler.hostname, fn, sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        data = json.loads('\n'.join(ret['out']))
+        self.assertGreater(data['phases']['cycle']['count'], 0)
+        self.assertEqual(len(data['phases']['query']['histogram_ms']), 16)
+
+    def test_cycle_stats_off(self):
+        """
+        Test that nothing is reported by default
+        """
+        self.scheduler.run_scheduling_cycle()
+        st = self.server.status(SCHED, id='default')
+        self.assertNotIn(ATTR_sched_cycle_stats, st[0])
@@ -0,0 +1,79 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+from tests.functional import *
+
+
+class TestSchedJobUpdates(TestFunctional):
+    """
+    Test that the scheduler sends its job attribute updates to the server
+    in batched Modify Jobs requests
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER, {'log_events': 2047})
+
+    def test_comments_batched(self):
+        """
+        Test that the comments of jobs which can not run are all set with
+        one Modify Jobs request instead of one Modify Job request per job
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'scheduling': 'False'})
+        j = Job(TEST_USER, {'Resource_List.ncpus': 1})
+        jid = self.server.submit(j)
+        jids = []
+        for _ in range(10):
+            j = Job(TEST_USER, {'Resource_List.ncpus': 1})
+            jids.append(self.server.submit(j))
+
+        t = int(time.time())
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        msg = 'Not Running: Insufficient amount of resource: ncpus'
+        for qjid in jids:
+            self.server.expect(JOB, {'comment': (MATCH_RE, msg)}, id=qjid)
+
+        self.server.log_match('Type 95 request received from Scheduler',
+                              starttime=t)
+        self.server.log_match('Type 11 request received from Scheduler',
+                              starttime=t, existence=False, max_attempts=2)
@@ -0,0 +1,93 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+from tests.functional import *
+
+
+class TestSchedRunJobs(TestFunctional):
+    """
+    Test that the scheduler in throughput mode sends its run requests to
+    the server in batched Run Jobs requests
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 10}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER, {'log_events': 2047})
+        self.server.manager(MGR_CMD_SET, SCHED, {'throughput_mode': 'True'},
+                            runas=ROOT_USER)
+
+    def test_runs_batched(self):
+        """
+        Test that the jobs run in a cycle are all sent with one Run Jobs
+        request instead of one Async Run Job request per job
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'scheduling': 'False'})
+        jids = []
+        for _ in range(10):
+            j = Job(TEST_USER, {'Resource_List.ncpus': 1})
+            jids.append(self.server.submit(j))
+
+        t = int(time.time())
+        self.scheduler.run_scheduling_cycle()
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+        self.server.log_match('Type 96 request received from Scheduler',
+                              starttime=t)
+        self.server.log_match('Type 23 request received from Scheduler',
+                              starttime=t, existence=False, max_attempts=2)
+
+    def test_qrun_not_batched(self):
+        """
+        Test that a qrun job is still run with its own request so the
+        qrun gets the result of the run
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'scheduling': 'False'})
+        j = Job(TEST_USER, {'Resource_List.ncpus': 1})
+        jid = self.server.submit(j)
+
+        t = int(time.time())
+        self.server.runjob(jid)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.server.log_match('Type 96 request received from Scheduler',
+                              starttime=t, existence=False, max_attempts=2)
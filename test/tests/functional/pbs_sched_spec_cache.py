@@ -0,0 +1,77 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+from tests.functional import *
+
+
+class TestSchedSpecCache(TestFunctional):
+    """
+    Test that select specs the scheduler keeps parsed between cycles are
+    parsed again when the resources it checks change
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'type': 'string', 'flag': 'h'}
+        self.server.manager(MGR_CMD_CREATE, RSC, a, id='color')
+        a = {'resources_available.ncpus': 1,
+             'resources_available.color': 'red'}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.mom.shortname)
+
+    def test_spec_reparsed_on_resources_change(self):
+        """
+        Test that a job requesting the same select spec as a job which
+        ran before color was added to the sched_config resources line
+        does not run on a vnode without its color
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        a = {'Resource_List.select': '1:ncpus=1:color=blue'}
+        j = Job(TEST_USER, a)
+        jid1 = self.server.submit(j)
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        self.server.delete(jid1, wait=True)
+
+        self.scheduler.add_resource('color')
+        j = Job(TEST_USER, a)
+        jid2 = self.server.submit(j)
+        self.scheduler.run_scheduling_cycle()
+        c = '.*Insufficient amount of resource: color.*'
+        self.server.expect(JOB, {'job_state': 'Q', 'comment': (MATCH_RE, c)},
+                           id=jid2)
@@ -0,0 +1,94 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestSchedTriggerCoalesce(TestFunctional):
+    """
+    Test that event triggers for a scheduling cycle are held back and
+    coalesced as set by PBS_SCHED_TRIGGER_GAP and PBS_SCHED_TRIGGER_LATENCY
+    in pbs.conf
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'PBS_SCHED_TRIGGER_GAP': 10, 'PBS_SCHED_TRIGGER_LATENCY': 5}
+        self.du.set_pbs_config(hostname=self.server.hostname, confs=a,
+                               append=True)
+        self.server.restart()
+        self.server.manager(MGR_CMD_SET, NODE, {'resources_available.ncpus':
+                                                 100}, id=self.mom.shortname)
+
+    def tearDown(self):
+        self.du.unset_pbs_config(hostname=self.server.hostname,
+                                 confs=['PBS_SCHED_TRIGGER_GAP',
+                                        'PBS_SCHED_TRIGGER_LATENCY'])
+        TestFunctional.tearDown(self)
+        self.server.restart()
+
+    def test_submit_burst(self):
+        """
+        Submit a burst of jobs right after a cycle and check they are all
+        run, by fewer cycles than jobs and within the trigger latency
+        """
+        self.scheduler.run_scheduling_cycle()
+        start = int(time.time())
+        jids = []
+        for _ in range(20):
+            j = Job(TEST_USER)
+            j.set_sleep_time(1000)
+            jids.append(self.server.submit(j))
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid,
+                               max_attempts=15)
+        cycles = self.scheduler.log_match('Starting Scheduling Cycle',
+                                          starttime=start, n='ALL',
+                                          allmatch=True)
+        self.assertLess(len(cycles), len(jids))
+
+    def test_qrun_not_held(self):
+        """
+        Check a qrun right after a cycle is not held back
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j = Job(TEST_USER)
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        self.server.runjob(jid)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid, max_attempts=3)
@@ -0,0 +1,95 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestSchedWarmCache(TestFunctional):
+    """
+    Test that the scheduler saves its state between cycles when it stops
+    and reuses it when it starts again
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SCHED, {'log_events': 2047})
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.mom.shortname)
+        self.scheduler.set_sched_config({'incremental_query': 'True'})
+
+    def test_restart_warm(self):
+        """
+        Test that the queued job cache survives a restart of the scheduler
+        and that jobs queued while it was down are still scheduled
+        """
+        a = {'Resource_List.select': '1:ncpus=1'}
+        j1 = Job(TEST_USER, a)
+        j1.set_sleep_time(1000)
+        jid1 = self.server.submit(j1)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        jid2 = self.server.submit(Job(TEST_USER, a))
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid2)
+
+        self.scheduler.stop()
+        jid3 = self.server.submit(Job(TEST_USER, a))
+        t = int(time.time())
+        self.scheduler.start()
+        self.scheduler.log_match("Loaded state saved by the previous "
+                                 "scheduler", starttime=t)
+
+        self.server.delete(jid1, wait=True)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
+        self.server.delete(jid2, wait=True)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid3)
+
+    def test_corrupt_file(self):
+        """
+        Test that a corrupt warm cache file is ignored
+        """
+        self.scheduler.stop()
+        fn = os.path.join(self.server.pbs_conf['PBS_HOME'], 'sched_priv',
+                          'sched_warm_cache')
+        self.du.run_cmd(self.server.hostname,
+                        ['sh', '-c', 'echo garbage > ' + fn], sudo=True)
+        t = int(time.time())
+        self.scheduler.start()
+        self.scheduler.log_match("Warm cache file not usable, starting cold",
+                                 starttime=t)
+        jid = self.server.submit(Job(TEST_USER))
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
@@ -0,0 +1,97 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestStatCache(TestFunctional):
+    """
+    Test that the server answers identical status requests with the
+    reply it kept when PBS_SERVER_STAT_CACHE_TTL is set in pbs.conf
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'PBS_SERVER_STAT_CACHE_TTL': 20}
+        self.du.set_pbs_config(hostname=self.server.hostname, confs=a,
+                               append=True)
+        self.server.restart()
+
+    def tearDown(self):
+        self.du.unset_pbs_config(hostname=self.server.hostname,
+                                 confs=['PBS_SERVER_STAT_CACHE_TTL'])
+        TestFunctional.tearDown(self)
+        self.server.restart()
+
+    def test_node_status_kept(self):
+        """
+        An identical vnode status is answered with the kept reply until
+        the TTL expires, while a different attribute list is not
+        """
+        node = self.mom.shortname
+        self.server.manager(MGR_CMD_SET, NODE, {'comment': 'one'}, id=node)
+        st = self.server.status(NODE, 'comment', id=node)
+        self.assertEqual(st[0]['comment'], 'one')
+
+        self.server.manager(MGR_CMD_SET, NODE, {'comment': 'two'}, id=node)
+        st = self.server.status(NODE, 'comment', id=node)
+        self.assertEqual(st[0]['comment'], 'one')
+        st = self.server.status(NODE, ['comment', 'state'], id=node)
+        self.assertEqual(st[0]['comment'], 'two')
+
+        time.sleep(21)
+        st = self.server.status(NODE, 'comment', id=node)
+        self.assertEqual(st[0]['comment'], 'two')
+
+    def test_job_status_kept(self):
+        """
+        An identical job status is answered with the kept reply, and
+        the new job is seen once the TTL expires
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jid1 = self.server.submit(Job(TEST_USER))
+        st = self.server.status(JOB, 'job_state')
+        self.assertEqual([j['id'] for j in st], [jid1])
+
+        jid2 = self.server.submit(Job(TEST_USER))
+        st = self.server.status(JOB, 'job_state')
+        self.assertEqual([j['id'] for j in st], [jid1])
+
+        time.sleep(21)
+        st = self.server.status(JOB, 'job_state')
+        self.assertEqual([j['id'] for j in st], [jid1, jid2])
@@ -0,0 +1,72 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+
+from tests.functional import *
+
+
+class TestStatPage(TestFunctional):
+    """
+    Test statusing the jobs at the server a page at a time
+    """
+
+    def test_pages(self):
+        """
+        Test that the pages return each job once, in order, when jobs
+        are deleted between pages
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = [self.server.submit(Job(TEST_USER)) for _ in range(5)]
+
+        seen = []
+        cursor = ''
+        while True:
+            ext = 'P2' if cursor == '' else 'P2,' + cursor
+            st = self.server.status(JOB, extend=ext)
+            cursor = ''
+            for s in st:
+                if 'status_cursor' in s:
+                    cursor = s['status_cursor']
+                else:
+                    seen.append(s['id'])
+            if cursor == '':
+                break
+            if jids[2] not in seen and len(seen) == 2:
+                self.server.delete(jids[2], wait=True)
+        self.assertEqual(seen, jids[:2] + jids[3:])
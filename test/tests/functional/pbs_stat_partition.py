@@ -0,0 +1,99 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestStatPartition(TestFunctional):
+    """
+    Test statusing only the vnodes and queues of some partitions, so that
+    each scheduler of a multisched complex gets only its share
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 1}
+        self.server.create_vnodes('vn', a, 3, self.mom)
+        self.server.manager(MGR_CMD_SET, NODE, {'partition': 'P1'},
+                            id='vn[0]')
+        self.server.manager(MGR_CMD_SET, NODE, {'partition': 'P2'},
+                            id='vn[1]')
+        a = {'queue_type': 'execution', 'enabled': 'True',
+             'started': 'True', 'partition': 'P1'}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='wq1')
+
+    def names(self, st):
+        return sorted([s['id'] for s in st])
+
+    def test_node_partition(self):
+        """
+        Test that only the vnodes of the partitions asked for are returned,
+        and those in none for an empty list
+        """
+        st = self.server.status(NODE, extend='|P1')
+        self.assertEqual(self.names(st), ['vn[0]'])
+        st = self.server.status(NODE, extend='|P2,P1')
+        self.assertEqual(self.names(st), ['vn[0]', 'vn[1]'])
+        st = self.server.status(NODE, extend='|')
+        self.assertNotIn('vn[0]', self.names(st))
+        self.assertNotIn('vn[1]', self.names(st))
+        self.assertIn('vn[2]', self.names(st))
+
+    def test_queue_partition(self):
+        """
+        Test that only the queues of the partitions asked for are returned
+        """
+        st = self.server.status(QUEUE, extend='|P1')
+        self.assertEqual(self.names(st), ['wq1'])
+        st = self.server.status(QUEUE, extend='|')
+        self.assertNotIn('wq1', self.names(st))
+
+    def test_node_leaves_partition(self):
+        """
+        Test that with a changed since sequence a vnode moved out of the
+        partitions is returned as deleted
+        """
+        st = self.server.status(NODE, extend='C0|P1')
+        self.assertEqual(self.names(st), ['vn[0]'])
+        seq = int(st[0]['modify_sequence'])
+
+        self.server.manager(MGR_CMD_SET, NODE, {'partition': 'P3'},
+                            id='vn[0]')
+        st = self.server.status(NODE, extend='C%d|P1' % seq)
+        self.assertEqual(self.names(st), ['vn[0]'])
+        self.assertEqual(st[0]['deleted'], 'True')
@@ -0,0 +1,124 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+try:
+    from ptl.lib import pbs_ifl
+except ImportError:
+    pbs_ifl = None
+
+
+class TestStatjobFilter(TestFunctional):
+    """
+    Test pbs_statjob_filter(), the job status filtered and projected
+    by the server
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        if pbs_ifl is None:
+            self.skipTest('needs the IFL bindings made by pbs_swigify')
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.c = pbs_ifl.pbs_connect(self.server.hostname)
+        self.assertGreater(self.c, 0)
+
+    def tearDown(self):
+        pbs_ifl.pbs_disconnect(self.c)
+        TestFunctional.tearDown(self)
+
+    def statjob_filter(self, attrib, filt, id=None):
+        """
+        Call pbs_statjob_filter() and return the jobs as dictionaries
+        """
+        u = self.server.utils
+        bs = pbs_ifl.pbs_statjob_filter(self.c, id,
+                                        u.convert_to_attrl(attrib),
+                                        u.dict_to_attropl(filt), None)
+        if isinstance(bs, list):
+            return bs
+        ret = u.batch_status_to_dictlist(bs)
+        pbs_ifl.pbs_statfree(bs)
+        return ret
+
+    def test_filter_and_project(self):
+        """
+        Check only the matching jobs are returned, with only the
+        projected attributes
+        """
+        a = {'Resource_List.ncpus': 1, ATTR_N: 'small'}
+        j1 = self.server.submit(Job(TEST_USER, attrs=a))
+        a = {'Resource_List.ncpus': 4, ATTR_N: 'big'}
+        j2 = self.server.submit(Job(TEST_USER, attrs=a))
+        a = {'Resource_List.ncpus': 4, ATTR_N: 'held', ATTR_h: None}
+        j3 = self.server.submit(Job(TEST_USER, attrs=a))
+
+        jobs = self.statjob_filter([ATTR_N],
+                                   {'Resource_List.ncpus': (GE, 2),
+                                    ATTR_state: (EQ, 'Q')})
+        self.assertEqual([j['id'] for j in jobs], [j2])
+        self.assertEqual(jobs[0][ATTR_N], 'big')
+        self.assertNotIn(ATTR_state, jobs[0])
+        self.assertNotIn('Resource_List.ncpus', jobs[0])
+
+        jobs = self.statjob_filter([ATTR_N],
+                                   {'Resource_List.ncpus': (LT, 4)})
+        self.assertEqual([j['id'] for j in jobs], [j1])
+
+        # a named job which does not match is left out
+        jobs = self.statjob_filter([ATTR_N], {ATTR_state: (EQ, 'H')}, j1)
+        self.assertEqual(jobs, [])
+        jobs = self.statjob_filter(None, {ATTR_state: (EQ, 'H')})
+        self.assertEqual([j['id'] for j in jobs], [j3])
+
+        # with no criteria it is pbs_statjob()
+        jobs = self.statjob_filter([ATTR_N], None)
+        self.assertEqual(len(jobs), 3)
+
+    def test_bad_criteria(self):
+        """
+        Check a criterion on an unknown attribute is refused
+        """
+        self.server.submit(Job(TEST_USER))
+        u = self.server.utils
+        bs = pbs_ifl.pbs_statjob_filter(self.c, None, None,
+                                        u.dict_to_attropl(
+                                            {'no_such_attr': (EQ, 'x')}),
+                                        None)
+        self.assertFalse(bs)
+        self.assertTrue(pbs_ifl.pbs_geterrmsg(self.c))
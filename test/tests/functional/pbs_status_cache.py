@@ -0,0 +1,86 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+
+from tests.functional import *
+
+
+class TestStatusCache(TestFunctional):
+    """
+    Test that the cached status of vnodes and of their resources follows
+    changes to them
+    """
+
+    def test_vnode_resource_change(self):
+        """
+        Status a vnode, change one of its resources and check the new
+        value is reported while the other resources stay as they were
+        """
+        vn = self.mom.shortname
+        a = {'resources_available.ncpus': 4}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=vn)
+        self.server.expect(NODE, a, id=vn)
+        mem = self.server.status(NODE, 'resources_available.mem', id=vn)
+        a = {'resources_available.ncpus': 2}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=vn)
+        self.server.expect(NODE, a, id=vn)
+        if 'resources_available.mem' in mem[0]:
+            self.server.expect(NODE, {'resources_available.mem':
+                                      mem[0]['resources_available.mem']},
+                               id=vn)
+
+    def test_vnode_assigned_change(self):
+        """
+        Run a job on a vnode and check resources_assigned and jobs of the
+        vnode are updated in its status, also after the job ends
+        """
+        vn = self.mom.shortname
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 2}, id=vn)
+        self.server.expect(NODE, {'resources_assigned.ncpus': 0}, id=vn)
+        j = Job(TEST_USER, attrs={'Resource_List.select': '1:ncpus=1'})
+        j.set_sleep_time(5)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.server.expect(NODE, {'resources_assigned.ncpus': 1,
+                                  'jobs': (MATCH_RE, jid.split('.')[0])},
+                           id=vn)
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid, offset=5)
+        self.server.expect(NODE, {'resources_assigned.ncpus': 0}, id=vn)
+        self.server.expect(NODE, 'jobs', op=UNSET, id=vn)
@@ -0,0 +1,79 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestStatusCacheShare(TestFunctional):
+    """
+    Test that job status stays right for managers and users when the
+    encoding of an attribute is cached once for both
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+    def stat_both(self, jid, attr):
+        """
+        Status the job as a manager and as its owner, return both values
+        """
+        mgr = self.server.status(JOB, attr, id=jid, runas=ROOT_USER)
+        usr = self.server.status(JOB, attr, id=jid, runas=TEST_USER)
+        return (mgr[0].get(attr), usr[0].get(attr))
+
+    def test_alter_seen_by_both(self):
+        """
+        Status a job as each, alter it, and check both see the change,
+        over several rounds of status in alternating order
+        """
+        j = Job(TEST_USER, attrs={ATTR_N: 'first'})
+        jid = self.server.submit(j)
+        self.assertEqual(self.stat_both(jid, ATTR_N), ('first', 'first'))
+
+        for name in ['second', 'third']:
+            self.server.alterjob(jid, {ATTR_N: name}, runas=TEST_USER)
+            self.assertEqual(self.stat_both(jid, ATTR_N), (name, name))
+            self.assertEqual(self.stat_both(jid, ATTR_N), (name, name))
+
+        # a resource list is still encoded for each privilege
+        a = {'Resource_List.walltime': '00:10:00'}
+        self.server.alterjob(jid, a, runas=TEST_USER)
+        mgr, usr = self.stat_both(jid, 'Resource_List.walltime')
+        self.assertEqual(mgr, '00:10:00')
+        self.assertEqual(usr, '00:10:00')
@@ -325,6 +325,36 @@ class TestSTF(TestFunctional):
         attr = {'Resource_List.walltime': (GE, '00:10:00')}
         self.server.expect(JOB, attr, id=jid)
 
+    def test_shrink_to_longest_fit(self):
+        """
+        Test that a STF job is shrunk to the latest reservation it can
+        finish before.  Create 16 reservations 30 min apart, with R14
+        having ncpus=3 and all others having ncpus=2.  The job can run
+        until R14 starts, 7 hours from now, but not until R15.
+        """
+        a = {'resources_available.ncpus': 3}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.mom.shortname)
+
+        now = int(time.time())
+        resv_dur = 600
+
+        for i in range(1, 17):
+            resv_start = now + i * 1800
+            self.submit_resv(resv_start, 3 if i == 14 else 2, resv_dur)
+
+        a = {'Resource_List.max_walltime': '10:00:00',
+             'Resource_List.min_walltime': '00:10:00'}
+        j = Job(TEST_USER, attrs=a)
+
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+        attr = {'Resource_List.walltime': (LE, '07:00:00')}
+        self.server.expect(JOB, attr, id=jid)
+
+        attr = {'Resource_List.walltime': (GT, '06:30:00')}
+        self.server.expect(JOB, attr, id=jid)
+
     def test_t_4_3_6(self):
         """
         Test shrink to fit by creating one reservation having ncpus=1,
@@ -715,3 +745,34 @@ class TestSTF(TestFunctional):
 
         self.server.expect(JOB, 'Resource_List.min_walltime', op=SET)
         self.server.expect(JOB, 'Resource_List.max_walltime', op=SET)
+
+    def test_overlapping_dedicated_times(self):
+        """
+        Set two overlapping dedicated times, the first one started 20
+        minutes ago and ends in 1 hour, the second one starts in 30 minutes
+        and ends in 2 hours.  Submit a dedicated time queue job that can run
+        for as short as 1 minute and as long as 20 hours.  Expect the job to
+        be shrunk to the end of the combined dedicated time, not the end
+        of the first entry.
+        """
+        qname = 'ded_time'
+
+        a = {'queue_type': 'execution', 'enabled': 'True', 'started': 'True'}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, qname)
+        now = int(time.time())
+        self.scheduler.add_dedicated_time(start=now - 1200, end=now + 3600,
+                                          hup=False)
+        self.scheduler.add_dedicated_time(start=now + 1800, end=now + 7200)
+
+        a = {'queue': 'ded_time',
+             'Resource_List.max_walltime': '20:00:00',
+             'Resource_List.min_walltime': '00:01:00'}
+        j = Job(TEST_USER, attrs=a)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+        attr = {'Resource_List.walltime': (GT, '01:30:00')}
+        self.server.expect(JOB, attr, id=jid)
+
+        attr = {'Resource_List.walltime': (LE, '02:00:00')}
+        self.server.expect(JOB, attr, id=jid)
@@ -607,6 +607,55 @@ class TestServerDynRes(TestFunctional):
         self.du.chmod(path=fp, mode=0o744, sudo=True)
         self.check_access_log(fp, exist=False)
 
+    def test_res_refresh(self):
+        """
+        Test that with server_dyn_res_refresh the value of a server_dyn_res
+        is refreshed in the background and the cycle uses the latest one
+        """
+        valfile = self.du.create_temp_file(body='4')
+        self.dirnames.append(valfile)
+        self.scheduler.set_sched_config({'server_dyn_res_refresh': 2})
+        resname = ["foobar"]
+        restype = ["long"]
+        resval = ['/bin/cat ' + valfile]
+        self.setup_dyn_res(resname, restype, resval)
+        self.scheduler.log_match("Started server_dyn_res refresh thread",
+                                 level=logging.DEBUG)
+
+        a = {'Resource_List.foobar': 6}
+        j = Job(TEST_USER, attrs=a)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
+
+        newval = self.du.create_temp_file(body='8')
+        self.du.run_copy(src=newval, dest=valfile, sudo=True)
+        self.du.rm(path=newval, force=True)
+        time.sleep(3)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+    def test_res_timeout(self):
+        """
+        Test that a server_dyn_res program running longer than
+        server_dyn_res_timeout is killed and the resource is set to 0
+        """
+        self.scheduler.set_sched_config({'server_dyn_res_timeout': 2})
+        resname = ["foobar"]
+        restype = ["long"]
+        resval = ['sleep 30; echo 4']
+        filenames = self.setup_dyn_res(resname, restype, resval)
+
+        a = {'Resource_List.foobar': 1}
+        j = Job(TEST_USER, attrs=a)
+        jid = self.server.submit(j)
+        self.scheduler.log_match("%s did not finish in 2 seconds"
+                                 % filenames[0], level=logging.DEBUG)
+
+        job_comment = "Can Never Run: Insufficient amount of server resource:"
+        job_comment += " foobar (R: 1 A: 0 T: 0)"
+        a = {'job_state': 'Q', 'comment': job_comment}
+        self.server.expect(JOB, a, id=jid, attrop=PTL_AND)
+
     def tearDown(self):
         # removing all files creating in test
         if len(self.dirnames) != 0:
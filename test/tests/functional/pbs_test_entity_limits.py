@@ -846,3 +846,32 @@ class TestEntityLimits(TestFunctional):
                                             e.msg[0])
         else:
             self.assertFalse(True, "Job violating limits got submitted.")
+
+    def test_server_many_user_limits_queued(self):
+        """
+        Test queued_jobs_threshold for user TEST_USER at the server level
+        when the limit is set among the limits of many other users, and
+        that the queued count survives a change of the limits.
+        """
+        users = ["[u:limuser%d=%d]" % (i, i + 1) for i in range(500)]
+        users.append("[u:" + str(TEST_USER) + "=" + str(self.limit) + "]")
+        a = {"queued_jobs_threshold": ",".join(users)}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        a = {'scheduling': 'False'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+
+        for _ in range(self.limit):
+            self.server.submit(Job(TEST_USER))
+
+        errmsg = "qsub: Maximum number of jobs in 'Q' state for user " + \
+            str(TEST_USER) + ' already in complex'
+        with self.assertRaises(PbsSubmitError) as e:
+            self.server.submit(Job(TEST_USER))
+        self.assertEqual(e.exception.msg[0], errmsg)
+
+        # raise the limit of another user; the count is kept
+        a = {"queued_jobs_threshold": (INCR, "[u:limuser3=40]")}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        with self.assertRaises(PbsSubmitError) as e:
+            self.server.submit(Job(TEST_USER))
+        self.assertEqual(e.exception.msg[0], errmsg)
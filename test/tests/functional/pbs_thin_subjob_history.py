@@ -0,0 +1,82 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestThinSubjobHistory(TestFunctional):
+    """
+    Test the history of finished subjobs kept in the tracking table of
+    their array job, as set by PBS_SERVER_THIN_SUBJOB_HISTORY in pbs.conf
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'PBS_SERVER_THIN_SUBJOB_HISTORY': 1}
+        self.du.set_pbs_config(hostname=self.server.hostname, confs=a,
+                               append=True)
+        self.server.restart()
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+
+    def tearDown(self):
+        self.du.unset_pbs_config(hostname=self.server.hostname,
+                                 confs=['PBS_SERVER_THIN_SUBJOB_HISTORY'])
+        TestFunctional.tearDown(self)
+        self.server.restart()
+
+    def test_finished_subjob_status(self):
+        """
+        Check a finished subjob still shows its state, execution host,
+        run count and exit status
+        """
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        j = Job(TEST_USER, attrs={
+            ATTR_J: '1-3', 'Resource_List.select': 'ncpus=1'})
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        subjid_1 = j.create_subjob_id(jid, 1)
+        self.server.expect(JOB, {'job_state': 'F'}, jid, extend='x',
+                           offset=3, interval=1)
+        a = {'job_state': 'X',
+             'exec_host': (MATCH_RE, self.mom.shortname),
+             'run_count': 1,
+             'Exit_status': 0,
+             'comment': (MATCH_RE, 'Subjob finished')}
+        self.server.expect(JOB, a, subjid_1, extend='x', max_attempts=1)
@@ -0,0 +1,73 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+
+
+from tests.functional import *
+
+
+class TestTppStats(TestFunctional):
+    """
+    Test the TPP statistics snapshot logged by the daemons on demand
+    """
+
+    def test_server_stats(self):
+        """
+        Signal the server with SIGUSR1 and check the TPP counters and the
+        connection to pbs_comm are logged as JSON
+        """
+        self.server.signal('-USR1')
+        self.server.log_match('tpp_stats;{"type":"tpp_stats","pkts_in":')
+        self.server.log_match('tpp_stats;{"type":"tpp_conn",')
+
+    def test_comm_stats(self):
+        """
+        Signal pbs_comm with SIGUSR1 and check it logs its TPP counters
+        and a line for each leaf connected to it
+        """
+        self.comm.signal('-USR1')
+        self.comm.log_match('tpp_stats;{"type":"tpp_stats","pkts_in":')
+        self.comm.log_match('"type":"tpp_conn",.*"state":"connected"',
+                            regexp=True)
+
+    def test_mom_stats(self):
+        """
+        Signal MoM with SIGUSR2 and check the TPP counters are logged
+        """
+        self.mom.signal('-USR2')
+        self.mom.log_match('tpp_stats;{"type":"tpp_stats","pkts_in":')
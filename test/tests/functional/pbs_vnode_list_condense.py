@@ -0,0 +1,71 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestVnodeListCondense(TestFunctional):
+    """
+    Test that the host and vnode lists of a wide job, stored in the
+    database condensed into ranges, are recovered unchanged
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 1}
+        self.server.create_vnodes('vn', a, 12, self.mom)
+
+    def test_recover_wide_job(self):
+        """
+        Run a job on every vnode, restart the server and check the
+        job's exec_vnode, exec_host and schedselect
+        """
+        j = Job(TEST_USER, {'Resource_List.select': '12:ncpus=1',
+                            'Resource_List.place': 'vscatter'})
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        attrs = ['exec_vnode', 'exec_host', 'schedselect']
+        before = self.server.status(JOB, attrs, id=jid)[0]
+        self.assertEqual(before['exec_vnode'].count('+'), 11)
+
+        self.server.restart()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        after = self.server.status(JOB, attrs, id=jid)[0]
+        for a in attrs:
+            self.assertEqual(before[a], after[a])
+        self.server.deljob(jid, wait=True)
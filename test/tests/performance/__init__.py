@@ -65,10 +65,14 @@ class TestPerformance(PBSTestSuite):
             if not isinstance(res, (int, float)):
                 raise self.failureException("Test result must be int or float")
 
-    def perf_test_result(self, result, test_measure, unit):
+    def perf_test_result(self, result, test_measure, unit, better=None):
         """
         Add test results to json file. If a multiple trial values are passed
         calculate mean,std_dev,min,max for the list.
+
+        :param better: "lower" or "higher", which way the result improves,
+                       recorded for pbs_benchcompare. Defaults to lower.
+        :type better: str or None
         """
         self.check_value(result)
         if isinstance(result, list) and len(result) > 1:
@@ -92,6 +96,8 @@ class TestPerformance(PBSTestSuite):
                                        "minimum": min_res,
                                        "maximum": max_res,
                                        "trials": trial_data}}
+            if better:
+                test_data["better"] = better
             return self.set_test_measurements(test_data)
         else:
             variance = 0
@@ -104,6 +110,8 @@ class TestPerformance(PBSTestSuite):
                                      "std_dev": variance,
                                      "minimum": result,
                                      "maximum": result}}
+            if better:
+                testdic["better"] = better
             return self.set_test_measurements(testdic)
 
     pass
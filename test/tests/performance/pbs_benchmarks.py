@@ -0,0 +1,169 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2019 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.performance import *
+
+
+class TestBenchmarks(TestPerformance):
+    """
+    Standard throughput and latency benchmarks, recorded with
+    perf_test_result() so that a JSON report of a run
+    (pbs_benchpress --db-type=json) can be compared against a stored
+    baseline with pbs_benchcompare.
+
+    Test Params: 'bench_njobs': jobs per scenario, default 1000
+                 'bench_nvnodes': vnodes of the obit storm, default 500
+                 'bench_trials': trials per scenario, default 3
+    """
+
+    def setUp(self):
+        TestPerformance.setUp(self)
+        self.njobs = int(self.conf.get('bench_njobs', 1000))
+        self.nvnodes = int(self.conf.get('bench_nvnodes', 500))
+        self.trials = int(self.conf.get('bench_trials', 3))
+        self.set_test_measurements({'test_config': {
+            'bench_njobs': self.njobs,
+            'bench_nvnodes': self.nvnodes,
+            'bench_trials': self.trials}})
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+    def submit_n(self, n, attrs=None):
+        """
+        Submit n jobs and return their ids
+        """
+        jids = []
+        for _ in range(n):
+            j = Job(TEST_USER, attrs=attrs)
+            jids.append(self.server.submit(j))
+        return jids
+
+    @timeout(3600)
+    def test_submit_rate(self):
+        """
+        Rate at which a single client submits jobs
+        """
+        rates = []
+        for _ in range(self.trials):
+            t = time.time()
+            self.submit_n(self.njobs)
+            rates.append(self.njobs / (time.time() - t))
+            self.server.cleanup_jobs()
+        self.perf_test_result(rates, 'submit_rate', 'jobs/sec',
+                              better='higher')
+
+    @timeout(3600)
+    def test_stat_latency(self):
+        """
+        Time to status all the attributes of every job
+        """
+        self.submit_n(self.njobs)
+        lat = []
+        for _ in range(self.trials):
+            t = time.time()
+            self.server.status(JOB)
+            lat.append(time.time() - t)
+        self.perf_test_result(lat, 'stat_latency', 'sec')
+
+    @timeout(3600)
+    def test_cycle_time(self):
+        """
+        Duration of a scheduling cycle considering bench_njobs jobs that
+        cannot run
+        """
+        # no 2 cpu vnode, the jobs are considered but never run
+        a = {'Resource_List.select': '1:ncpus=2'}
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 1},
+                            id=self.mom.shortname)
+        self.submit_n(self.njobs, a)
+        cycles = []
+        for _ in range(self.trials):
+            t = int(time.time())
+            self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+            self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+            self.scheduler.log_match('Leaving Scheduling Cycle', starttime=t,
+                                     max_attempts=300, interval=3)
+            c = self.scheduler.cycles(lastN=1)[0]
+            cycles.append(c.end - c.start)
+        self.perf_test_result(cycles, 'cycle_time', 'sec')
+
+    @timeout(3600)
+    def test_obit_storm(self):
+        """
+        Rate at which the server processes the end of bench_njobs short
+        jobs started together on bench_nvnodes vnodes
+        """
+        a = {'resources_available.ncpus': 1}
+        self.server.create_vnodes('vn', a, self.nvnodes, self.mom,
+                                  sharednode=False)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        rates = []
+        done = 0
+        for _ in range(self.trials):
+            j = {'Resource_List.select': '1:ncpus=1'}
+            jids = []
+            for _ in range(self.njobs):
+                job = Job(TEST_USER, attrs=j)
+                job.set_sleep_time(1)
+                jids.append(self.server.submit(job))
+            done += self.njobs
+            t = time.time()
+            self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+            self.server.expect(JOB, {'job_state=F': done}, extend='x',
+                               interval=5, max_attempts=720,
+                               trigger_sched_cycle=False)
+            rates.append(self.njobs / (time.time() - t))
+            self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.perf_test_result(rates, 'obit_storm_rate', 'jobs/sec',
+                              better='higher')
+
+    @timeout(3600)
+    def test_mom_start_latency(self):
+        """
+        Time from running a job to the server seeing it running on MoM
+        """
+        lat = []
+        for _ in range(max(self.trials, 10)):
+            jid = self.submit_n(1)[0]
+            t = time.time()
+            self.server.runjob(jid)
+            self.server.expect(JOB, {'job_state': 'R', 'substate': 42},
+                               id=jid, interval=0.1, max_attempts=600)
+            lat.append(time.time() - t)
+            self.server.deljob(jid, wait=True)
+        self.perf_test_result(lat, 'mom_start_latency', 'sec')
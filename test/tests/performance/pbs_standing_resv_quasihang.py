@@ -99,3 +99,35 @@ class StandingResvQuasihang(TestPerformance):
         self.logger.info("pbs_rstat took %d seconds to return\n",
                          (now2 - now1))
         self.perf_test_result((now2 - now1), "pbs_rstat_return_time", "sec")
+
+    @timeout(6000)
+    def test_time_to_confirm_and_schedule(self):
+        """
+        This test case submits a standing reservation with 2000 instances
+        and measures the time the scheduler takes to confirm it and then to
+        run a cycle with all of its occurrences in its view.
+        """
+        start = int(time.time()) + 3600
+        attrs = {'Resource_List.select': "64:ncpus=2",
+                 'reserve_start': start,
+                 'reserve_duration': 2000,
+                 'reserve_timezone': self.tzone,
+                 'reserve_rrule': "FREQ=HOURLY;BYHOUR=1,2,3,4,5;COUNT=2000"}
+
+        now1 = time.time()
+        rid = self.server.submit(Reservation(TEST_USER, attrs))
+        attrs = {'reserve_state': (MATCH_RE, 'RESV_CONFIRMED|2')}
+        self.server.expect(RESV, attrs, id=rid, interval=1)
+        now2 = time.time()
+        self.logger.info("Reservation confirmed in %.2f seconds",
+                         (now2 - now1))
+        self.perf_test_result((now2 - now1), "resv_confirm_time", "sec")
+
+        now1 = time.time()
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.scheduler.log_match("Leaving Scheduling Cycle",
+                                 starttime=int(now1), interval=1)
+        now2 = time.time()
+        self.logger.info("Scheduling cycle took %.2f seconds",
+                         (now2 - now1))
+        self.perf_test_result((now2 - now1), "sched_cycle_time", "sec")